@@ -12,12 +12,17 @@ SHAPE_ORDERING = [
     'obj',
     'ply',
     'serialized',
+    'bundle',
     'cube'
     'sphere',
+    'sphereset',
     'disk',
     'cylinder',
     'bsplinecurve',
     'linearcurve',
+    'subdivision',
+    'lod',
+    'lazy',
     'rectangle',
     'shapegroup',
     'instance'
@@ -33,6 +38,7 @@ BSDF_ORDERING = [
     'plastic',
     'roughplastic',
     'measured',
+    'hair',
     'bumpmap',
     'normalmap',
     'blendbsdf',
@@ -52,19 +58,27 @@ EMITTER_ORDERING = [
     'constant',
     'envmap',
     'spot',
-    'projector'
+    'projector',
+    'volumelight',
+    'pointarray'
 ]
 
 SENSOR_ORDERING = [
     'orthographic',
     'perspective',
-    'thinlens'
+    'thinlens',
+    'meterarray',
+    'spherical',
+    'fisheye'
 ]
 
 TEXTURE_ORDERING = [
+    'atlas',
     'bitmap',
     'checkerboard',
+    'merged',
     'mesh_attribute',
+    'noise',
     'volume'
 ]
 
@@ -82,16 +96,22 @@ SAMPLER_ORDERING = [
     'stratified',
     'multijitter',
     'orthogonal',
-    'ldsampler'
+    'ldsampler',
+    'sobol',
+    'philox'
 ]
 
 INTEGRATOR_ORDERING = [
     'direct',
     'path',
+    'wavefront',
     'aov',
     'volpath',
     'volpathmis',
+    'bdpt',
+    'sppm',
     '../src/python/python/ad/integrators/prb.py',
+    'prb_native',
     '../src/python/python/ad/integrators/prb_basic.py',
     '../src/python/python/ad/integrators/direct_reparam.py',
     '../src/python/python/ad/integrators/emission_reparam.py',
@@ -126,7 +146,9 @@ PHASE_ORDERING = [
 
 VOLUME_ORDERING = [
     'constvolume',
-    'gridvolume'
+    'gridvolume',
+    'sparsegridvolume',
+    'gridsequencevolume'
 ]
 
 
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <mitsuba/core/platform.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Bump allocator for short-lived temporary allocations
+ *
+ * Memory is handed out from a list of large chunks by incrementing an offset,
+ * and it is never returned individually. Instead, the arena is rewound to a
+ * previous position via \ref rewind() (or a \ref Scope) once all allocations
+ * made after that position are dead. This makes the allocation of per-sample
+ * temporaries of scalar variants (e.g. the subpaths of the bidirectional path
+ * tracer) essentially free and avoids the contention of the global heap when
+ * rendering with many threads.
+ *
+ * Each thread has its own arena (see \ref thread_arena()), which must only be
+ * used by that thread.
+ */
+class MI_EXPORT_LIB MemoryArena {
+public:
+    /// Position within the arena (see \ref mark() and \ref rewind())
+    struct Mark {
+        size_t chunk;
+        size_t offset;
+    };
+
+    /// RAII-style class that rewinds the arena to its position at construction
+    class Scope {
+    public:
+        Scope(MemoryArena &arena = MemoryArena::thread_arena())
+            : m_arena(arena), m_mark(arena.mark()) { }
+        ~Scope() { m_arena.rewind(m_mark); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        MemoryArena &m_arena;
+        Mark m_mark;
+    };
+
+    /// Create an arena that allocates chunks of (at least) \c chunk_size bytes
+    MemoryArena(size_t chunk_size = 64 * 1024) : m_chunk_size(chunk_size) { }
+
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    /// Allocate \c size bytes aligned to \c align (a power of two)
+    void *alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (likely(m_chunk < m_chunks.size())) {
+            const Chunk &chunk = m_chunks[m_chunk];
+            uintptr_t base = (uintptr_t) chunk.data.get(),
+                      ptr  = (base + m_offset + align - 1) & ~(uintptr_t) (align - 1);
+            if (likely(ptr + size <= base + chunk.size)) {
+                m_offset = ptr + size - base;
+                return (void *) ptr;
+            }
+        }
+        return alloc_slow(size, align);
+    }
+
+    /// Allocate an uninitialized array of \c count instances of \c T
+    template <typename T> T *alloc(size_t count) {
+        return (T *) alloc(count * sizeof(T), alignof(T));
+    }
+
+    /// Return the current position of the arena
+    Mark mark() const { return Mark{ m_chunk, m_offset }; }
+
+    /**
+     * \brief Release all allocations made since \c mark was taken
+     *
+     * Rewinding to the beginning of the arena additionally merges the
+     * chunks into a single one, whose size suffices for the peak usage.
+     */
+    void rewind(const Mark &mark) {
+        m_chunk  = mark.chunk;
+        m_offset = mark.offset;
+        if (unlikely(m_chunk == 0 && m_offset == 0 && m_chunks.size() > 1))
+            consolidate();
+    }
+
+    /// Release all allocations (equivalent to rewinding to the beginning)
+    void reset() { rewind(Mark{ 0, 0 }); }
+
+    /// Return the total size of the chunks allocated by the arena (in bytes)
+    size_t capacity() const;
+
+    /// Return the arena of the calling thread
+    static MemoryArena &thread_arena();
+
+private:
+    void *alloc_slow(size_t size, size_t align);
+    void consolidate();
+
+private:
+    struct Chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    std::vector<Chunk> m_chunks;
+    size_t m_chunk = 0;
+    size_t m_offset = 0;
+    size_t m_chunk_size;
+};
+
+/**
+ * \brief STL-compatible allocator that draws memory from a \ref MemoryArena
+ *
+ * Deallocation does nothing, the memory is reclaimed when the arena is
+ * rewound. By default, the arena of the calling thread is used.
+ */
+template <typename T> struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() : arena(&MemoryArena::thread_arena()) { }
+    ArenaAllocator(MemoryArena &arena) : arena(&arena) { }
+    template <typename T2>
+    ArenaAllocator(const ArenaAllocator<T2> &other) : arena(other.arena) { }
+
+    T *allocate(size_t count) { return arena->template alloc<T>(count); }
+    void deallocate(T *, size_t) { }
+
+    template <typename T2> bool operator==(const ArenaAllocator<T2> &other) const {
+        return arena == other.arena;
+    }
+    template <typename T2> bool operator!=(const ArenaAllocator<T2> &other) const {
+        return arena != other.arena;
+    }
+
+    MemoryArena *arena;
+};
+
+/// Vector whose storage is allocated from the arena of the calling thread
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+NAMESPACE_END(mitsuba)
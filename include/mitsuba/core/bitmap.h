@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/properties.h>
@@ -179,6 +180,45 @@ public:
         Unpremultiply
     };
 
+    /// Compression method used when writing OpenEXR files
+    enum class EXRCompression : uint32_t {
+        /**
+         * Lossless PIZ compression, or DWAB compression when a positive
+         * quality level is passed to \ref write() (default)
+         */
+        Default,
+
+        /// No compression
+        None,
+
+        /// Lossless run-length encoding
+        RLE,
+
+        /// Lossless zlib compression of individual scanlines
+        ZIPS,
+
+        /// Lossless zlib compression of blocks of 16 scanlines
+        ZIP,
+
+        /// Lossless wavelet compression
+        PIZ,
+
+        /// Lossy 24-bit float compression (lossless for half channels)
+        PXR24,
+
+        /// Lossy 4x4 block compression of half channels
+        B44,
+
+        /// Like \ref B44, but compresses flat regions further
+        B44A,
+
+        /// Lossy DCT compression of half channels in blocks of 32 scanlines
+        DWAA,
+
+        /// Lossy DCT compression of half channels in blocks of 256 scanlines
+        DWAB
+    };
+
 
     // ======================================================================
     //! @{ \name Constructors
@@ -233,6 +273,9 @@ public:
     /**
      * \brief Load a bitmap from a given filename
      *
+     * PFM and OpenEXR files are read from a read-only memory mapping of the
+     * file, which avoids intermediate copies of their pixel data.
+     *
      * \param path
      *    Name of the file to be loaded
      *
@@ -315,6 +358,27 @@ public:
     /// Set the a \ref Properties object containing the image metadata
     void set_metadata(const Properties &metadata) { m_metadata = metadata; }
 
+    /// Return the compression method used when writing OpenEXR files
+    EXRCompression exr_compression() const { return m_exr_compression; }
+
+    /// Set the compression method used when writing OpenEXR files
+    void set_exr_compression(EXRCompression value) { m_exr_compression = value; }
+
+    /**
+     * \brief Specify the precision of a channel in OpenEXR files
+     *
+     * By default, every channel is stored with the bitmap's component format.
+     * This function overrides the format of the channel with the given name
+     * (\c Float16, \c Float32 or \c UInt32), and the OpenEXR library
+     * converts the samples while writing. This can e.g. be used to store
+     * albedo and normal AOVs in half precision alongside single precision
+     * depth and positions.
+     */
+    void set_exr_channel_format(const std::string &name, Struct::Type type);
+
+    /// Return the format of a channel in OpenEXR files (see \ref set_exr_channel_format())
+    Struct::Type exr_channel_format(const std::string &name) const;
+
     /// Clear the bitmap to zero
     void clear();
 
@@ -348,7 +412,9 @@ public:
      *            compressor, with higher values corresponding to a lower quality.
      *            A value of 45 is recommended as the default for lossy compression.
      *            The default argument (-1) causes the implementation to switch
-     *            to the lossless PIZ compressor.</li>
+     *            to the lossless PIZ compressor. When a compression method
+     *            was chosen via \ref set_exr_compression(), this parameter
+     *            only specifies the level of the DWAA and DWAB compressors.</li>
      *    </ul>
      */
     void write(Stream *stream, FileFormat format = FileFormat::Auto,
@@ -378,13 +444,22 @@ public:
      *            compressor, with higher values corresponding to a lower quality.
      *            A value of 45 is recommended as the default for lossy compression.
      *            The default argument (-1) causes the implementation to switch
-     *            to the lossless PIZ compressor.</li>
+     *            to the lossless PIZ compressor. When a compression method
+     *            was chosen via \ref set_exr_compression(), this parameter
+     *            only specifies the level of the DWAA and DWAB compressors.</li>
      *    </ul>
      */
     void write(const fs::path &path, FileFormat format = FileFormat::Auto,
                int quality = -1) const;
 
-    /// Equivalent to \ref write(), but executes asynchronously on a different thread
+    /**
+     * \brief Equivalent to \ref write(), but executes asynchronously on a
+     * different thread
+     *
+     * The image is submitted to the global \ref BitmapWriter, which blocks
+     * when too many writes are pending. The bitmap must not be modified until
+     * the write has completed (see \ref BitmapWriter::flush()).
+     */
     void write_async(const fs::path &path, FileFormat format = FileFormat::Auto,
                      int quality = -1) const;
 
@@ -652,6 +727,9 @@ public:
      bool m_premultiplied_alpha;
      bool m_owns_data;
      Properties m_metadata;
+     EXRCompression m_exr_compression = EXRCompression::Default;
+     std::vector<std::pair<std::string, Struct::Type>> m_exr_channel_formats;
+     MemoryRecord m_memory { MemoryCategory::Bitmap };
 };
 
 
@@ -726,6 +804,7 @@ void accumulate_2d(ConstT source,
 
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::PixelFormat value);
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value);
+extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::EXRCompression value);
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::AlphaTransform value);
 
 NAMESPACE_END(mitsuba)
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/thread.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Service that encodes and writes bitmaps on background threads
+ *
+ * Write requests are placed into a bounded queue that is processed by a fixed
+ * number of worker threads. When the queue is full, \ref write() blocks until
+ * a worker takes on the next request. This provides back-pressure and bounds
+ * the memory held by images waiting to be written, e.g. when an animation
+ * with many AOVs per frame is rendered from Python.
+ *
+ * \ref Bitmap::write_async(), \ref Film::write_async(), and the command line
+ * renderer submit their images to the global instance returned by
+ * \ref instance().
+ */
+class MI_EXPORT_LIB BitmapWriter : public Object {
+public:
+    /**
+     * \brief Create a new writer service
+     *
+     * \param worker_count
+     *     Number of worker threads that encode and write images
+     *
+     * \param queue_capacity
+     *     Maximum number of requests waiting in the queue (in addition to
+     *     the ones processed by the workers)
+     *
+     * \param quality
+     *     Quality or compression level that is used when a request specifies
+     *     the value -1 (see \ref Bitmap::write() for the meaning of this
+     *     parameter for each file format)
+     */
+    BitmapWriter(size_t worker_count = 2, size_t queue_capacity = 8,
+                 int quality = -1);
+
+    /**
+     * \brief Submit a bitmap for writing
+     *
+     * Blocks while the queue is full. The writer keeps a reference to the
+     * bitmap, whose contents must not be modified until the write has
+     * completed.
+     *
+     * \return A future that completes once the file was written, and which
+     *     rethrows any error that occurred in the process
+     */
+    std::shared_future<void> write(const Bitmap *bitmap, const fs::path &path,
+                                   Bitmap::FileFormat format = Bitmap::FileFormat::Auto,
+                                   int quality = -1);
+
+    /**
+     * \brief Wait until all submitted writes have completed
+     *
+     * Rethrows the first error that occurred since the previous call.
+     */
+    void flush();
+
+    /// Return the number of requests that were submitted but have not completed yet
+    size_t pending() const;
+
+    /// Return the number of worker threads
+    size_t worker_count() const { return m_workers.size(); }
+
+    /// Return the capacity of the queue
+    size_t queue_capacity() const { return m_queue_capacity; }
+
+    /// Return the default quality or compression level
+    int quality() const { return m_quality; }
+
+    /// Return the global instance (created with default settings upon first use)
+    static BitmapWriter *instance();
+
+    /**
+     * \brief Replace the global instance (e.g. to change the number of workers)
+     *
+     * The pending requests of the previous instance are completed first.
+     */
+    static void set_instance(BitmapWriter *writer);
+
+    /// Complete the pending requests of the global instance and release it
+    static void static_shutdown();
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    friend class BitmapWriterThread;
+
+    /// Stops the worker threads once all pending requests have completed
+    virtual ~BitmapWriter();
+
+    /// Main loop of the worker threads
+    void run_worker();
+
+private:
+    struct Request {
+        ref<const Bitmap> bitmap;
+        fs::path path;
+        Bitmap::FileFormat format;
+        int quality;
+        std::promise<void> promise;
+    };
+
+    std::vector<ref<Thread>> m_workers;
+    std::deque<Request> m_queue;
+    size_t m_queue_capacity;
+    int m_quality;
+    /// Number of queued requests and requests being processed
+    size_t m_pending = 0;
+    bool m_shutdown = false;
+    /// First error since the last call to \ref flush()
+    std::exception_ptr m_error;
+    mutable std::mutex m_mutex;
+    /// Signaled when requests are queued, or when shutting down
+    std::condition_variable m_cv_request;
+    /// Signaled when space in the queue becomes available
+    std::condition_variable m_cv_space;
+    /// Signaled when a request has completed
+    std::condition_variable m_cv_done;
+};
+
+NAMESPACE_END(mitsuba)
@@ -248,6 +248,252 @@ private:
     ScalarVector2u m_valid;
 };
 
+/**
+ * \brief Discrete 1D probability distribution based on the alias method
+ *
+ * This data structure provides the same interface as \ref
+ * DiscreteDistribution, but it generates samples using an alias table
+ * constructed with Vose's algorithm. Sampling requires a constant number of
+ * memory lookups regardless of the number of entries (as opposed to the
+ * binary search over a CDF in \ref DiscreteDistribution), which is
+ * beneficial for very large distributions, particularly on the GPU.
+ *
+ * Note that the mapping from uniform variates to indices is not monotonic,
+ * hence stratification of the input samples is not preserved.
+ */
+template <typename Value> struct AliasDistribution {
+    using Float = std::conditional_t<dr::is_static_array_v<Value>,
+                                     dr::value_t<Value>, Value>;
+    using FloatStorage   = DynamicBuffer<Float>;
+    using Index          = dr::uint32_array_t<Value>;
+    using IndexStorage   = DynamicBuffer<dr::uint32_array_t<Float>>;
+    using Mask           = dr::mask_t<Value>;
+
+    using ScalarFloat    = dr::scalar_t<Float>;
+
+public:
+    /// Create an uninitialized AliasDistribution instance
+    AliasDistribution() { }
+
+    /// Initialize from a given probability mass function
+    AliasDistribution(const FloatStorage &pmf)
+        : m_pmf(pmf) {
+        update();
+    }
+
+    /// Initialize from a given probability mass function (rvalue version)
+    AliasDistribution(FloatStorage &&pmf)
+        : m_pmf(std::move(pmf)) {
+        update();
+    }
+
+    /// Initialize from a given floating point array
+    AliasDistribution(const ScalarFloat *values, size_t size)
+        : m_pmf(dr::load<FloatStorage>(values, size)) {
+        compute_alias_table(values, size);
+    }
+
+    /// Update the internal state. Must be invoked when changing the pmf.
+    void update() {
+        if constexpr (dr::is_jit_v<Float>) {
+            FloatStorage temp = dr::migrate(m_pmf, AllocType::Host);
+            dr::sync_thread();
+            compute_alias_table(temp.data(), temp.size());
+        } else {
+            compute_alias_table(m_pmf.data(), m_pmf.size());
+        }
+    }
+
+    /// Return the unnormalized probability mass function
+    FloatStorage &pmf() { return m_pmf; }
+
+    /// Return the unnormalized probability mass function (const version)
+    const FloatStorage &pmf() const { return m_pmf; }
+
+    /// \brief Return the original sum of PMF entries before normalization
+    Float sum() const { return m_sum; }
+
+    /// \brief Return the normalization factor (i.e. the inverse of \ref sum())
+    Float normalization() const { return m_normalization; }
+
+    /// Return the number of entries
+    size_t size() const { return m_pmf.size(); }
+
+    /// Is the distribution object empty/uninitialized?
+    bool empty() const { return m_pmf.empty(); }
+
+    /// Evaluate the unnormalized probability mass function (PMF) at index \c index
+    Value eval_pmf(Index index, Mask active = true) const {
+        return dr::gather<Value>(m_pmf, index, active);
+    }
+
+    /// Evaluate the normalized probability mass function (PMF) at index \c index
+    Value eval_pmf_normalized(Index index, Mask active = true) const {
+        return dr::gather<Value>(m_pmf, index, active) * m_normalization;
+    }
+
+    /**
+     * \brief %Transform a uniformly distributed sample to the stored
+     * distribution
+     *
+     * \param value
+     *     A uniformly distributed sample on the interval [0, 1].
+     *
+     * \return
+     *     The discrete index associated with the sample
+     */
+    Index sample(Value value, Mask active = true) const {
+        return sample_reuse(value, active).first;
+    }
+
+    /**
+     * \brief %Transform a uniformly distributed sample to the stored
+     * distribution
+     *
+     * \param value
+     *     A uniformly distributed sample on the interval [0, 1].
+     *
+     * \return
+     *     A tuple consisting of
+     *
+     *     1. the discrete index associated with the sample, and
+     *     2. the normalized probability value of the sample.
+     */
+    std::pair<Index, Value> sample_pmf(Value value, Mask active = true) const {
+        MI_MASK_ARGUMENT(active);
+
+        Index index = sample(value, active);
+        return { index, eval_pmf_normalized(index, active) };
+    }
+
+    /**
+     * \brief %Transform a uniformly distributed sample to the stored
+     * distribution
+     *
+     * The original sample is value adjusted so that it can be reused as a
+     * uniform variate.
+     *
+     * \param value
+     *     A uniformly distributed sample on the interval [0, 1].
+     *
+     * \return
+     *     A tuple consisting of
+     *
+     *     1. the discrete index associated with the sample, and
+     *     2. the re-scaled sample value.
+     */
+    std::pair<Index, Value>
+    sample_reuse(Value value, Mask active = true) const {
+        MI_MASK_ARGUMENT(active);
+
+        // Select a bucket and use the fractional part for the alias decision
+        value *= ScalarFloat(m_pmf.size());
+        Index bucket = dr::minimum(Index(value), uint32_t(m_pmf.size() - 1));
+        value -= Value(bucket);
+
+        Value threshold = dr::gather<Value>(m_threshold, bucket, active);
+        Index alias = dr::gather<Index>(m_alias, bucket, active);
+
+        Mask keep = value < threshold;
+        Value reused = dr::select(keep, value / threshold,
+                                  (value - threshold) / (1.f - threshold));
+
+        return { dr::select(keep, bucket, alias),
+                 dr::clamp(reused, 0.f, dr::OneMinusEpsilon<Value>) };
+    }
+
+    /**
+     * \brief %Transform a uniformly distributed sample to the stored
+     * distribution.
+     *
+     * The original sample is value adjusted so that it can be reused as a
+     * uniform variate.
+     *
+     * \param value
+     *     A uniformly distributed sample on the interval [0, 1].
+     *
+     * \return
+     *     A tuple consisting of
+     *
+     *     1. the discrete index associated with the sample
+     *     2. the re-scaled sample value
+     *     3. the normalized probability value of the sample
+     */
+    std::tuple<Index, Value, Value>
+    sample_reuse_pmf(Value value, Mask active = true) const {
+        MI_MASK_ARGUMENT(active);
+
+        auto [index, reused] = sample_reuse(value, active);
+        return { index, reused, eval_pmf_normalized(index, active) };
+    }
+
+private:
+    /// Construct the alias table using Vose's algorithm
+    void compute_alias_table(const ScalarFloat *pmf, size_t size) {
+        if (size == 0)
+            Throw("AliasDistribution: empty distribution!");
+
+        double sum = 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            if (pmf[i] < 0.f)
+                Throw("AliasDistribution: entries must be non-negative!");
+            sum += (double) pmf[i];
+        }
+
+        if (!(sum > 0.0))
+            Throw("AliasDistribution: no probability mass found!");
+
+        // Probabilities scaled so that the average bucket holds 1
+        std::vector<double> scaled(size);
+        std::vector<uint32_t> small, large;
+        double scale = (double) size / sum;
+        for (uint32_t i = 0; i < size; ++i) {
+            scaled[i] = (double) pmf[i] * scale;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        std::vector<ScalarFloat> threshold(size);
+        std::vector<uint32_t> alias(size);
+
+        // Fill underfull buckets with the excess mass of overfull ones
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+
+            threshold[s] = (ScalarFloat) scaled[s];
+            alias[s] = l;
+
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+
+        // Remaining buckets are full up to round-off errors
+        for (uint32_t i : large) {
+            threshold[i] = 1.f;
+            alias[i] = i;
+        }
+        for (uint32_t i : small) {
+            threshold[i] = 1.f;
+            alias[i] = i;
+        }
+
+        m_sum = dr::opaque<Float>(sum);
+        m_normalization = dr::opaque<Float>(1.0 / sum);
+        m_threshold = dr::load<FloatStorage>(threshold.data(), size);
+        m_alias = dr::load<IndexStorage>(alias.data(), size);
+    }
+
+private:
+    FloatStorage m_pmf;
+    FloatStorage m_threshold;
+    IndexStorage m_alias;
+    Float m_sum = 0.f;
+    Float m_normalization = 0.f;
+};
+
 /**
  * \brief Continuous 1D probability distribution defined in terms of a regularly
  * sampled linear interpolant
@@ -264,6 +510,7 @@ template <typename Value> struct ContinuousDistribution {
     using Float = std::conditional_t<dr::is_static_array_v<Value>,
                                      dr::value_t<Value>, Value>;
     using FloatStorage = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<dr::uint32_array_t<Float>>;
     using Index = dr::uint32_array_t<Value>;
     using Mask = dr::mask_t<Value>;
 
@@ -401,15 +648,9 @@ public:
     Value sample(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        Index index = sample_interval(value, active);
         value *= m_integral;
 
-        Index index = dr::binary_search<Index>(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_cdf, index, active) < value;
-            }
-        );
-
         Value y0 = dr::gather<Value>(m_pdf, index,      active),
               y1 = dr::gather<Value>(m_pdf, index + 1u, active),
               c0 = dr::gather<Value>(m_cdf, index - 1u, active && index > 0);
@@ -439,15 +680,9 @@ public:
     std::pair<Value, Value> sample_pdf(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        Index index = sample_interval(value, active);
         value *= m_integral;
 
-        Index index = dr::binary_search<Index>(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_cdf, index, active) < value;
-            }
-        );
-
         Value y0 = dr::gather<Value>(m_pdf, index,      active),
               y1 = dr::gather<Value>(m_pdf, index + 1u, active),
               c0 = dr::gather<Value>(m_cdf, index - 1u, active && index > 0);
@@ -471,7 +706,43 @@ public:
         return m_max;
     }
 
+    /// Return the guide table that bounds the search of \ref sample() (two entries per cell)
+    const UInt32Storage &guide() const { return m_guide; }
+
 private:
+    /**
+     * \brief Find the interval of the CDF that contains the uniformly
+     * distributed sample \c value
+     *
+     * The sample space is split into \ref size() - 1 uniform cells. For each
+     * cell, the guide table stores the range of intervals whose CDF covers
+     * it, which bounds the subsequent binary search. Distributions with sharp
+     * peaks hence need a handful of steps instead of a search over all
+     * intervals.
+     */
+    Index sample_interval(Value value, Mask active) const {
+        uint32_t guide_size = (uint32_t) m_guide.size() / 2;
+        Index cell = dr::minimum(Index(value * (ScalarFloat) guide_size),
+                                 guide_size - 1u);
+
+        Index start = dr::gather<Index>(m_guide, 2u * cell,      active),
+              end   = dr::gather<Index>(m_guide, 2u * cell + 1u, active);
+
+        value *= m_integral;
+        for (uint32_t i = 0; i < m_guide_iterations; ++i) {
+            if constexpr (!dr::is_array_v<Index>) {
+                if (start == end)
+                    break;
+            }
+            Index middle = dr::sr<1>(start + end);
+            Mask cond = dr::gather<Value>(m_cdf, middle, active) < value;
+            start = dr::select(cond, dr::minimum(middle + 1u, end), start);
+            end   = dr::select(cond, end, middle);
+        }
+
+        return start;
+    }
+
     void compute_cdf(const ScalarFloat *pdf, size_t size) {
         if (size < 2)
             Throw("ContinuousDistribution: needs at least two entries!");
@@ -518,6 +789,30 @@ private:
         m_interval_size_scalar = (ScalarFloat) interval_size;
         m_inv_interval_size = dr::opaque<Float>(1. / interval_size);
         m_cdf = dr::load<FloatStorage>(cdf.data(), size - 1);
+
+        /* Guide table: for each uniform cell of the sample space, the first
+           and last interval that the search can return. A small margin
+           accounts for rounding when the sample is scaled by the integral. */
+        size_t guide_size = size - 1;
+        std::vector<uint32_t> guide(2 * guide_size);
+        double margin = integral * 1e-6;
+        uint32_t lo = m_valid.x(), hi = m_valid.x();
+        m_guide_iterations = 0;
+        for (size_t j = 0; j < guide_size; ++j) {
+            double start = integral * j / guide_size - margin,
+                   end   = integral * (j + 1) / guide_size + margin;
+            while (lo < m_valid.y() && (double) cdf[lo] < start)
+                ++lo;
+            hi = std::max(hi, lo);
+            while (hi < m_valid.y() && (double) cdf[hi] < end)
+                ++hi;
+            guide[2 * j]     = lo;
+            guide[2 * j + 1] = hi;
+            if (hi > lo)
+                m_guide_iterations = std::max(
+                    m_guide_iterations, (uint32_t) dr::log2i(hi - lo) + 1u);
+        }
+        m_guide = dr::load<UInt32Storage>(guide.data(), guide.size());
     }
 
 private:
@@ -531,6 +826,8 @@ private:
     ScalarVector2f m_range { 0.f, 0.f };
     ScalarVector2u m_valid;
     ScalarFloat m_max = 0.f;
+    UInt32Storage m_guide;
+    uint32_t m_guide_iterations = 0;
 };
 
 /**
@@ -550,6 +847,7 @@ template <typename Value> struct IrregularContinuousDistribution {
                                      dr::value_t<Value>, Value>;
     using FloatStorage = DynamicBuffer<Float>;
     using Index = dr::uint32_array_t<Value>;
+    using UInt32Storage = DynamicBuffer<dr::uint32_array_t<Float>>;
     using Mask = dr::mask_t<Value>;
 
     using ScalarFloat = dr::scalar_t<Float>;
@@ -639,14 +937,7 @@ public:
 
         active &= x >= m_range.x() && x <= m_range.y();
 
-        Index index = dr::binary_search<Index>(
-            0, (uint32_t) m_nodes.size(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_nodes, index, active) < x;
-            }
-        );
-
-        index = dr::maximum(dr::minimum(index, (uint32_t) m_nodes.size() - 1u), 1u) - 1u;
+        Index index = find_interval(x, active);
 
         Value x0 = dr::gather<Value>(m_nodes, index,      active),
               x1 = dr::gather<Value>(m_nodes, index + 1u, active),
@@ -669,14 +960,7 @@ public:
     Value eval_cdf(Value x, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
-        Index index = dr::binary_search<Index>(
-            0, (uint32_t) m_nodes.size(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_nodes, index, active) < x;
-            }
-        );
-
-        index = dr::maximum(dr::minimum(index, (uint32_t) m_nodes.size() - 1u), 1u) - 1u;
+        Index index = find_interval(x, active);
 
         Value x0 = dr::gather<Value>(m_nodes, index,      active),
               x1 = dr::gather<Value>(m_nodes, index + 1u, active),
@@ -711,15 +995,9 @@ public:
     Value sample(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        Index index = sample_interval(value, active);
         value *= m_integral;
 
-        Index index = dr::binary_search<Index>(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_cdf, index, active) < value;
-            }
-        );
-
         Value x0 = dr::gather<Value>(m_nodes, index,      active),
               x1 = dr::gather<Value>(m_nodes, index + 1u, active),
               y0 = dr::gather<Value>(m_pdf,   index,      active),
@@ -752,15 +1030,9 @@ public:
     std::pair<Value, Value> sample_pdf(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        Index index = sample_interval(value, active);
         value *= m_integral;
 
-        Index index = dr::binary_search<Index>(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_cdf, index, active) < value;
-            }
-        );
-
         Value x0 = dr::gather<Value>(m_nodes, index,      active),
               x1 = dr::gather<Value>(m_nodes, index + 1u, active),
               y0 = dr::gather<Value>(m_pdf,   index,      active),
@@ -789,7 +1061,105 @@ public:
         return m_max;
     }
 
+    /// Return the guide table that bounds the search of \ref sample() (two entries per cell)
+    const UInt32Storage &sample_guide() const { return m_sample_guide; }
+
+    /// Return the guide table that bounds the search of \ref eval_pdf() (two entries per cell)
+    const UInt32Storage &eval_guide() const { return m_eval_guide; }
+
 private:
+    /**
+     * \brief Bounded binary search for the first index in the guide table
+     * range of \c cell for which \c pred is \c false
+     *
+     * Both guide tables split their domain (the sample space, or the range
+     * of the nodes) into \ref size() - 1 uniform cells and store the range of
+     * candidate intervals of each cell, so that few search steps are needed
+     * even with many irregularly spaced nodes.
+     */
+    template <typename Predicate>
+    Index guided_search(const UInt32Storage &guide, uint32_t iterations,
+                        const Index &cell, const Predicate &pred,
+                        Mask active) const {
+        Index start = dr::gather<Index>(guide, 2u * cell,      active),
+              end   = dr::gather<Index>(guide, 2u * cell + 1u, active);
+
+        for (uint32_t i = 0; i < iterations; ++i) {
+            if constexpr (!dr::is_array_v<Index>) {
+                if (start == end)
+                    break;
+            }
+            Index middle = dr::sr<1>(start + end);
+            Mask cond = pred(middle);
+            start = dr::select(cond, dr::minimum(middle + 1u, end), start);
+            end   = dr::select(cond, end, middle);
+        }
+
+        return start;
+    }
+
+    /// Find the interval between two nodes that contains the position \c x
+    Index find_interval(const Value &x, Mask active) const {
+        uint32_t guide_size = (uint32_t) m_eval_guide.size() / 2;
+        Value c = dr::clamp((x - m_range.x()) * m_eval_guide_scale, 0.f,
+                            (ScalarFloat) (guide_size - 1));
+        return guided_search(
+            m_eval_guide, m_eval_guide_iterations, Index(c),
+            [&](const Index &i) DRJIT_INLINE_LAMBDA {
+                return dr::gather<Value>(m_nodes, i + 1u, active) < x;
+            }, active);
+    }
+
+    /// Find the interval of the CDF that contains the uniformly distributed sample \c value
+    Index sample_interval(const Value &value, Mask active) const {
+        uint32_t guide_size = (uint32_t) m_sample_guide.size() / 2;
+        Index cell = dr::minimum(Index(value * (ScalarFloat) guide_size),
+                                 guide_size - 1u);
+        Value scaled = value * m_integral;
+        return guided_search(
+            m_sample_guide, m_sample_guide_iterations, cell,
+            [&](const Index &i) DRJIT_INLINE_LAMBDA {
+                return dr::gather<Value>(m_cdf, i, active) < scaled;
+            }, active);
+    }
+
+    /**
+     * \brief Build a guide table over \c guide_size uniform cells of the
+     * interval [\c lo_value, \c hi_value]
+     *
+     * \c key(i) must be increasing in the interval index \c i. The candidate
+     * range of a cell spans from the first interval whose key reaches the
+     * start of the cell to the first interval whose key reaches its end,
+     * which is where the search predicate switches within that cell. A
+     * small margin accounts for rounding errors.
+     */
+    template <typename Key>
+    static UInt32Storage build_guide(size_t guide_size, double lo_value,
+                                     double hi_value, uint32_t first,
+                                     uint32_t last, const Key &key,
+                                     uint32_t &iterations) {
+        std::vector<uint32_t> guide(2 * guide_size);
+        double width = hi_value - lo_value,
+               margin = width * 1e-6;
+        uint32_t lo = first, hi = first;
+        iterations = 0;
+        for (size_t j = 0; j < guide_size; ++j) {
+            double start = lo_value + width * j / guide_size - margin,
+                   end   = lo_value + width * (j + 1) / guide_size + margin;
+            while (lo < last && key(lo) < start)
+                ++lo;
+            hi = std::max(hi, lo);
+            while (hi < last && key(hi) < end)
+                ++hi;
+            guide[2 * j]     = lo;
+            guide[2 * j + 1] = hi;
+            if (hi > lo)
+                iterations = std::max(iterations,
+                                      (uint32_t) dr::log2i(hi - lo) + 1u);
+        }
+        return dr::load<UInt32Storage>(guide.data(), guide.size());
+    }
+
     void compute_cdf(const ScalarFloat *nodes, const ScalarFloat *pdf, size_t size) {
         if (size < 2)
             Throw("IrregularContinuousDistribution: needs at least two entries!");
@@ -842,6 +1212,23 @@ private:
         m_integral = dr::opaque<Float>(integral);
         m_normalization = dr::opaque<Float>(1. / integral);
         m_cdf = dr::load<FloatStorage>(cdf.data(), size - 1);
+
+        // 'nodes' was advanced to the last node by the loop above
+        const ScalarFloat *nodes_begin = nodes - (size - 1);
+        size_t guide_size = size - 1;
+
+        m_sample_guide = build_guide(
+            guide_size, 0.0, integral, m_valid.x(), m_valid.y(),
+            [&](uint32_t i) { return (double) cdf[i]; },
+            m_sample_guide_iterations);
+
+        m_eval_guide = build_guide(
+            guide_size, (double) m_range.x(), (double) m_range.y(), 0u,
+            (uint32_t) size - 2u,
+            [&](uint32_t i) { return (double) nodes_begin[i + 1]; },
+            m_eval_guide_iterations);
+        m_eval_guide_scale =
+            (ScalarFloat) (guide_size / ((double) m_range.y() - (double) m_range.x()));
     }
 
 private:
@@ -854,6 +1241,9 @@ private:
     ScalarVector2u m_valid;
     ScalarFloat m_interval_size = 0.f;
     ScalarFloat m_max = 0.f;
+    UInt32Storage m_sample_guide, m_eval_guide;
+    uint32_t m_sample_guide_iterations = 0, m_eval_guide_iterations = 0;
+    ScalarFloat m_eval_guide_scale = 0.f;
 };
 
 template <typename Value>
@@ -866,6 +1256,16 @@ std::ostream &operator<<(std::ostream &os, const DiscreteDistribution<Value> &di
     return os;
 }
 
+template <typename Value>
+std::ostream &operator<<(std::ostream &os, const AliasDistribution<Value> &distr) {
+    os << "AliasDistribution[" << std::endl
+        << "  size = " << distr.size() << "," << std::endl
+        << "  sum = " << distr.sum() << "," << std::endl
+        << "  pmf = " << distr.pmf() << std::endl
+        << "]";
+    return os;
+}
+
 template <typename Value>
 std::ostream &operator<<(std::ostream &os, const ContinuousDistribution<Value> &distr) {
     os << "ContinuousDistribution[" << std::endl
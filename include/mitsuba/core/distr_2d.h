@@ -12,6 +12,8 @@
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/util.h>
 #include <drjit/dynamic.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
 #include <array>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -203,6 +205,31 @@ protected:
     ScalarFloat m_normalization;
 };
 
+NAMESPACE_BEGIN(detail)
+/**
+ * \brief Invoke <tt>func(begin, end)</tt> on ranges of the rows
+ * <tt>[0, count)</tt> of a table with \c width columns in parallel
+ *
+ * Used to construct the tables of large distributions. Small tables are
+ * processed on the calling thread.
+ */
+template <typename Func>
+void parallel_rows(uint32_t count, uint32_t width, Func &&func) {
+    uint32_t grain = std::max(1u, 16384u / std::max(width, 1u));
+    if (count <= grain) {
+        func(0u, count);
+        return;
+    }
+
+    dr::parallel_for(
+        dr::blocked_range<uint32_t>(0, count, grain),
+        [&](const dr::blocked_range<uint32_t> &range) {
+            func(range.begin(), range.end());
+        }
+    );
+}
+NAMESPACE_END(detail)
+
 /// Base class of Hierarchical2D and Marginal2D with common functionality
 template <typename Float_, size_t Dimension_ = 0> class Distribution2D {
 public:
@@ -393,24 +420,27 @@ public:
             m_levels.reserve(1);
             m_levels.emplace_back(size, m_slices);
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat *p = m_levels[0].data.data();
-                uint32_t offset = m_levels[0].size * slice;
+            Level &level0 = m_levels[0];
+            ScalarFloat *p = level0.data.data();
 
-                ScalarFloat scale = 1.f;
-                if (normalize) {
-                    double sum = 0.0;
-                    for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                        sum += (double) data[offset + i];
-                    scale = dr::prod(n_patches) / (ScalarFloat) sum;
-                }
+            detail::parallel_rows(m_slices, level0.size, [&](uint32_t s0, uint32_t s1) {
+                for (uint32_t slice = s0; slice < s1; ++slice) {
+                    uint32_t offset = level0.size * slice;
 
-                for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                    p[offset + i] = data[offset + i] * scale;
+                    ScalarFloat scale = 1.f;
+                    if (normalize) {
+                        double sum = 0.0;
+                        for (uint32_t i = 0; i < level0.size; ++i)
+                            sum += (double) data[offset + i];
+                        scale = dr::prod(n_patches) / (ScalarFloat) sum;
+                    }
 
-                m_levels[0].ready();
-            }
+                    for (uint32_t i = 0; i < level0.size; ++i)
+                        p[offset + i] = data[offset + i] * scale;
+                }
+            });
 
+            level0.ready();
             return;
         }
 
@@ -428,54 +458,73 @@ public:
         ScalarFloat *l0p = m_levels[0].data.data(),
                     *l1p = m_levels[1].data.data();
 
-        for (uint32_t slice = 0; slice < m_slices; ++slice) {
-            uint32_t offset0 = m_levels[0].size * slice,
-                     offset1 = m_levels[1].size * slice;
-
-            // Integrate linear interpolant
-            const ScalarFloat *in = data + offset0;
-
-            double sum = 0.0;
-            for (uint32_t y = 0; y < n_patches.y(); ++y) {
-                for (uint32_t x = 0; x < n_patches.x(); ++x) {
-                    ScalarFloat avg = .25f * (in[0] + in[1] + in[size.x()] +
-                                              in[size.x() + 1]);
-                    sum += (double) avg;
-                    *(l1p + m_levels[1].index(ScalarVector2u(x, y)) + offset1) = avg;
-                    ++in;
-                }
-                ++in;
-            }
-
-            // Copy and normalize fine resolution interpolant
-            ScalarFloat scale = normalize ? (ScalarFloat) (dr::prod(n_patches) / sum) : 1.f;
-            for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                l0p[offset0 + i] = data[offset0 + i] * scale;
-            for (uint32_t i = 0; i < m_levels[1].size; ++i)
-                l1p[offset1 + i] *= scale;
-
-            // Build a MIP hierarchy
-            level_size = n_patches;
-            for (uint32_t level = 2; level <= max_level + 1; ++level) {
-                const Level &l0 = m_levels[level - 1];
-                Level &l1 = m_levels[level];
-                offset0 = l0.size * slice;
-                offset1 = l1.size * slice;
-                level_size = dr::sr<1>(level_size + 1u);
-
-                const ScalarFloat *l0p_ = l0.data.data();
-                ScalarFloat *l1p_ = l1.data.data();
-
-                // Downsample
-                for (uint32_t y = 0; y < level_size.y(); ++y) {
-                    for (uint32_t x = 0; x < level_size.x(); ++x) {
-                        ScalarFloat *d1 = l1p_ + l1.index(ScalarVector2u(x, y)) + offset1;
-                        const ScalarFloat *d0 = l0p_ + l0.index(ScalarVector2u(x*2, y*2)) + offset0;
-                        *d1 = d0[0] + d0[1] + d0[2] + d0[3];
+        // Slices are processed in parallel, and so are the rows of each level
+        detail::parallel_rows(m_slices, m_levels[0].size, [&](uint32_t s0, uint32_t s1) {
+            std::unique_ptr<double[]> row_sum(new double[n_patches.y()]);
+
+            for (uint32_t slice = s0; slice < s1; ++slice) {
+                uint32_t offset0 = m_levels[0].size * slice,
+                         offset1 = m_levels[1].size * slice;
+
+                // Integrate linear interpolant
+                detail::parallel_rows(n_patches.y(), n_patches.x(), [&](uint32_t y0, uint32_t y1) {
+                    for (uint32_t y = y0; y < y1; ++y) {
+                        const ScalarFloat *in = data + offset0 + y * size.x();
+                        double sum = 0.0;
+                        for (uint32_t x = 0; x < n_patches.x(); ++x) {
+                            ScalarFloat avg = .25f * (in[0] + in[1] + in[size.x()] +
+                                                      in[size.x() + 1]);
+                            sum += (double) avg;
+                            *(l1p + m_levels[1].index(ScalarVector2u(x, y)) + offset1) = avg;
+                            ++in;
+                        }
+                        row_sum[y] = sum;
                     }
+                });
+
+                double sum = 0.0;
+                for (uint32_t y = 0; y < n_patches.y(); ++y)
+                    sum += row_sum[y];
+
+                // Copy and normalize fine resolution interpolant
+                ScalarFloat scale = normalize ? (ScalarFloat) (dr::prod(n_patches) / sum) : 1.f;
+                detail::parallel_rows(size.y(), size.x(), [&](uint32_t y0, uint32_t y1) {
+                    for (uint32_t i = y0 * size.x(); i < y1 * size.x(); ++i)
+                        l0p[offset0 + i] = data[offset0 + i] * scale;
+                });
+
+                uint32_t width1 = m_levels[1].width,
+                         height1 = m_levels[1].size / width1;
+                detail::parallel_rows(height1, width1, [&](uint32_t y0, uint32_t y1) {
+                    for (uint32_t i = y0 * width1; i < y1 * width1; ++i)
+                        l1p[offset1 + i] *= scale;
+                });
+
+                // Build a MIP hierarchy
+                ScalarVector2u level_size_2 = n_patches;
+                for (uint32_t level = 2; level <= max_level + 1; ++level) {
+                    const Level &l0 = m_levels[level - 1];
+                    Level &l1 = m_levels[level];
+                    uint32_t offset0_ = l0.size * slice,
+                             offset1_ = l1.size * slice;
+                    level_size_2 = dr::sr<1>(level_size_2 + 1u);
+
+                    const ScalarFloat *l0p_ = l0.data.data();
+                    ScalarFloat *l1p_ = l1.data.data();
+
+                    // Downsample
+                    detail::parallel_rows(level_size_2.y(), level_size_2.x(), [&](uint32_t y0, uint32_t y1) {
+                        for (uint32_t y = y0; y < y1; ++y) {
+                            for (uint32_t x = 0; x < level_size_2.x(); ++x) {
+                                ScalarFloat *d1 = l1p_ + l1.index(ScalarVector2u(x, y)) + offset1_;
+                                const ScalarFloat *d0 = l0p_ + l0.index(ScalarVector2u(x*2, y*2)) + offset0_;
+                                *d1 = d0[0] + d0[1] + d0[2] + d0[3];
+                            }
+                        }
+                    });
                 }
             }
-        }
+        });
 
         for (auto& level : m_levels)
             level.ready();
@@ -661,6 +710,199 @@ public:
         return { sample, pdf };
     }
 
+    /**
+     * \brief Draw a sample from the product of the distribution and a
+     * positive weighting function
+     *
+     * The function \c weight is invoked with the bounds <tt>(min, max)</tt>
+     * of the cells visited during the hierarchical traversal (in the unit
+     * square) and must return a weight that is representative of (e.g. an
+     * upper bound of) the product factor within each cell. Its value should
+     * only depend on the cell, which makes the density of the resulting
+     * samples tractable (see \ref eval_weighted()).
+     *
+     * Returns the warped sample and associated probability density, which
+     * is always normalized (even when the distribution was constructed with
+     * <tt>normalize=false</tt>).
+     */
+    template <typename WeightFunction>
+    std::pair<Point2f, Float> sample_weighted(Point2f sample,
+                                              const WeightFunction &weight,
+                                              const Float *param = nullptr,
+                                              Mask active = true) const {
+        MI_MASK_ARGUMENT(active);
+
+        /// Find offset and interpolation weights wrt. conditional parameters
+        Float param_weight[2 * DimensionInt];
+        UInt32 slice_offset = interpolate_weights(param, param_weight, active);
+
+        // Avoid issues with roundoff error
+        sample = dr::clamp(sample, 0.f, 1.f);
+
+        // Hierarchical sample warping with reweighted cells
+        Point2u offset = dr::zeros<Point2u>();
+        Float prob = 1.f, value = patch_value(offset, slice_offset,
+                                              param_weight, active);
+        for (int l = (int) m_levels.size() - 2; l > 0; --l) {
+            const Level &level = m_levels[l];
+            ScalarVector2f cell_size = m_patch_size * ScalarFloat(1u << (l - 1));
+
+            offset = dr::sl<1>(offset);
+
+            // Fetch values from next MIP level
+            UInt32 offset_i = level.index(offset) + slice_offset * level.size;
+
+            Float v00 = level.lookup(offset_i, m_param_strides,
+                                     param_weight, active),
+                  v10 = level.lookup(offset_i + 1u, m_param_strides,
+                                     param_weight, active),
+                  v01 = level.lookup(offset_i + 2u, m_param_strides,
+                                     param_weight, active),
+                  v11 = level.lookup(offset_i + 3u, m_param_strides,
+                                     param_weight, active);
+
+            Point2f p00 = Point2f(offset) * cell_size,
+                    p10 = p00 + Point2f(cell_size.x(), 0.f),
+                    p01 = p00 + Point2f(0.f, cell_size.y()),
+                    p11 = p00 + cell_size;
+
+            Float w00 = v00 * weight(p00, p00 + cell_size),
+                  w10 = v10 * weight(p10, p10 + cell_size),
+                  w01 = v01 * weight(p01, p01 + cell_size),
+                  w11 = v11 * weight(p11, p11 + cell_size);
+
+            // Avoid issues with roundoff error
+            sample = dr::clamp(sample, 0.f, 1.f);
+
+            // Select the row
+            Float r0 = w00 + w10,
+                  r1 = w01 + w11,
+                  total = r0 + r1;
+            sample.y() *= total;
+            Mask mask_y = sample.y() > r0;
+            dr::masked(offset.y(), mask_y) += 1u;
+            dr::masked(sample.y(), mask_y) -= r0;
+            sample.y() /= dr::select(mask_y, r1, r0);
+
+            // Select the column
+            Float c0 = dr::select(mask_y, w01, w00),
+                  c1 = dr::select(mask_y, w11, w10);
+            sample.x() *= c0 + c1;
+            Mask mask_x = sample.x() > c0;
+            dr::masked(sample.x(), mask_x) -= c0;
+            sample.x() /= dr::select(mask_x, c1, c0);
+            dr::masked(offset.x(), mask_x) += 1u;
+
+            prob *= dr::select(mask_x, c1, c0) / total;
+            value = dr::select(mask_x, dr::select(mask_y, v11, v10),
+                                       dr::select(mask_y, v01, v00));
+        }
+
+        const Level &level0 = m_levels[0];
+
+        UInt32 offset_i =
+            offset.x() + offset.y() * level0.width + slice_offset * level0.size;
+
+        // Fetch corners of bilinear patch
+        Float v00 = level0.lookup(offset_i, m_param_strides,
+                                  param_weight, active),
+              v10 = level0.lookup(offset_i + 1, m_param_strides,
+                                  param_weight, active),
+              v01 = level0.lookup(offset_i + level0.width, m_param_strides,
+                                  param_weight, active),
+              v11 = level0.lookup(offset_i + level0.width + 1, m_param_strides,
+                                  param_weight, active);
+
+        Float pdf;
+        std::tie(sample, pdf) =
+            warp::square_to_bilinear(v00, v10, v01, v11, sample);
+
+        /* Probability of the patch times the density within the patch, whose
+           average value is stored in the first MIP level */
+        pdf *= prob * dr::prod(m_inv_patch_size) / value;
+
+        return {
+            (Point2f(Point2i(offset)) + sample) * m_patch_size,
+            dr::select(value > 0.f, pdf, 0.f)
+        };
+    }
+
+    /// Evaluate the density of samples generated by \ref sample_weighted()
+    template <typename WeightFunction>
+    Float eval_weighted(Point2f pos, const WeightFunction &weight,
+                        const Float *param = nullptr,
+                        Mask active = true) const {
+        /// Find offset and interpolation weights wrt. conditional parameters
+        Float param_weight[2 * DimensionInt];
+        UInt32 slice_offset = interpolate_weights(param, param_weight, active);
+
+        // Avoid issues with roundoff error
+        pos = dr::clamp(pos, 0.f, 1.f);
+
+        pos *= m_inv_patch_size;
+        Point2u offset = dr::minimum(Point2u(Point2i(pos)), m_max_patch_index);
+        pos -= Point2f(Point2i(offset));
+
+        // Accumulate the probabilities of the cells containing the patch
+        Float prob = 1.f, value = patch_value(offset, slice_offset,
+                                              param_weight, active);
+        for (int l = (int) m_levels.size() - 2; l > 0; --l) {
+            const Level &level = m_levels[l];
+            ScalarVector2f cell_size = m_patch_size * ScalarFloat(1u << (l - 1));
+
+            Point2u cell = offset >> (uint32_t) (l - 1),
+                    base = cell & ~1u;
+
+            UInt32 offset_i = level.index(base) + slice_offset * level.size;
+
+            Float v00 = level.lookup(offset_i, m_param_strides,
+                                     param_weight, active),
+                  v10 = level.lookup(offset_i + 1u, m_param_strides,
+                                     param_weight, active),
+                  v01 = level.lookup(offset_i + 2u, m_param_strides,
+                                     param_weight, active),
+                  v11 = level.lookup(offset_i + 3u, m_param_strides,
+                                     param_weight, active);
+
+            Point2f p00 = Point2f(base) * cell_size,
+                    p10 = p00 + Point2f(cell_size.x(), 0.f),
+                    p01 = p00 + Point2f(0.f, cell_size.y()),
+                    p11 = p00 + cell_size;
+
+            Float w00 = v00 * weight(p00, p00 + cell_size),
+                  w10 = v10 * weight(p10, p10 + cell_size),
+                  w01 = v01 * weight(p01, p01 + cell_size),
+                  w11 = v11 * weight(p11, p11 + cell_size);
+
+            Mask mask_x = dr::neq(cell.x() & 1u, 0u),
+                 mask_y = dr::neq(cell.y() & 1u, 0u);
+
+            prob *= dr::select(mask_x, dr::select(mask_y, w11, w10),
+                                       dr::select(mask_y, w01, w00)) /
+                    (w00 + w10 + w01 + w11);
+            value = dr::select(mask_x, dr::select(mask_y, v11, v10),
+                                       dr::select(mask_y, v01, v00));
+        }
+
+        const Level &level0 = m_levels[0];
+        UInt32 offset_i =
+            offset.x() + offset.y() * level0.width + slice_offset * level0.size;
+
+        Float v00 = level0.lookup(offset_i, m_param_strides,
+                                  param_weight, active),
+              v10 = level0.lookup(offset_i + 1, m_param_strides,
+                                  param_weight, active),
+              v01 = level0.lookup(offset_i + level0.width, m_param_strides,
+                                  param_weight, active),
+              v11 = level0.lookup(offset_i + level0.width + 1, m_param_strides,
+                                  param_weight, active);
+
+        Float pdf = warp::square_to_bilinear_pdf(v00, v10, v01, v11, pos) *
+                    prob * dr::prod(m_inv_patch_size) / value;
+
+        return dr::select(value > 0.f, pdf, 0.f);
+    }
+
     /**
      * \brief Evaluate the density at position \c pos. The distribution is
      * parameterized by \c param if applicable.
@@ -790,6 +1032,20 @@ protected:
         }
     };
 
+    /**
+     * \brief Average value of the patch \c offset when the hierarchical
+     * traversal in \ref sample_weighted() doesn't visit the first MIP level
+     * (i.e. there is only a single patch). Returns zero otherwise.
+     */
+    Float patch_value(const Point2u &offset, const UInt32 &slice_offset,
+                      const Float *param_weight, const Mask &active) const {
+        if (m_levels.size() != 2)
+            return 0.f;
+        const Level &level = m_levels[1];
+        return level.lookup(level.index(offset) + slice_offset * level.size,
+                            m_param_strides, param_weight, active);
+    }
+
     /// MIP hierarchy over linearly interpolated patches
     std::vector<Level> m_levels;
 
@@ -886,104 +1142,109 @@ public:
 
         std::unique_ptr<ScalarFloat[]> data_out(new ScalarFloat[m_slices * n_data]);
 
+        // Number of rows of the conditional CDF
+        uint32_t n_rows = Continuous ? h : (h - 1);
+
         if (enable_sampling) {
             std::unique_ptr<ScalarFloat[]> marg_cdf(new ScalarFloat[m_slices * n_marg]);
             std::unique_ptr<ScalarFloat[]> cond_cdf(new ScalarFloat[m_slices * n_cond]);
 
-            ScalarFloat *marg_cdf_ptr = marg_cdf.get(),
-                        *cond_cdf_ptr = cond_cdf.get(),
-                        *data_out_ptr = data_out.get();
+            // Slices are processed in parallel, and so are the rows of each slice
+            detail::parallel_rows(m_slices, n_data, [&](uint32_t s0, uint32_t s1) {
+                std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
 
-            std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
+                for (uint32_t slice = s0; slice < s1; ++slice) {
+                    const ScalarFloat *data_ptr = data + slice * n_data;
+                    ScalarFloat *marg_cdf_ptr = marg_cdf.get() + slice * n_marg,
+                                *cond_cdf_ptr = cond_cdf.get() + slice * n_cond,
+                                *data_out_ptr = data_out.get() + slice * n_data;
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat norm = 1.f;
+                    /* The marginal/probability distribution computation
+                       differs for the Continuous=false/true cases */
 
-                /* The marginal/probability distribution computation
-                   differs for the Continuous=false/true cases */
-                if constexpr (Continuous) {
                     // Construct conditional CDF
-                    for (uint32_t y = 0; y < h; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale_x * ((double) data[i] +
-                                                (double) data[i + 1]);
-                            cond_cdf_ptr[j] = (ScalarFloat) accum;
+                    detail::parallel_rows(n_rows, w, [&](uint32_t y0, uint32_t y1) {
+                        for (uint32_t y = y0; y < y1; ++y) {
+                            double accum = 0.0;
+                            uint32_t i = y * w, j = y * (w - 1);
+                            for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                                if constexpr (Continuous)
+                                    accum += scale_x * ((double) data_ptr[i] +
+                                                        (double) data_ptr[i + 1]);
+                                else
+                                    accum += scale_x * scale_y *
+                                             ((double) data_ptr[i] +
+                                              (double) data_ptr[i + 1] +
+                                              (double) data_ptr[i + w] +
+                                              (double) data_ptr[i + w + 1]);
+                                cond_cdf_ptr[j] = (ScalarFloat) accum;
+                            }
+                            cond_cdf_sum[y] = accum;
                         }
-                        cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
                     for (uint32_t y = 0; y < h - 1; ++y) {
-                        accum += scale_y * (cond_cdf_sum[y] + cond_cdf_sum[y + 1]);
+                        if constexpr (Continuous)
+                            accum += scale_y * (cond_cdf_sum[y] + cond_cdf_sum[y + 1]);
+                        else
+                            accum += cond_cdf_sum[y];
                         marg_cdf_ptr[y] = (ScalarFloat) accum;
                     }
 
-                    if (normalize)
-                        norm = ScalarFloat(1.0 / accum);
-                } else {
-                    double scale = scale_x * scale_y;
-
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale * ((double) data[i] +
-                                              (double) data[i + 1] +
-                                              (double) data[i + w] +
-                                              (double) data[i + w + 1]);
-                            cond_cdf_ptr[j] = (ScalarFloat) accum;
-                        }
-                        cond_cdf_sum[y] = accum;
-                    }
+                    ScalarFloat norm = normalize ? ScalarFloat(1.0 / accum) : 1.f;
 
-                    // Construct marginal CDF
-                    double accum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        accum += cond_cdf_sum[y];
-                        marg_cdf_ptr[y] = (ScalarFloat) accum;
-                    }
+                    for (size_t i = 0; i < n_marg; ++i)
+                        marg_cdf_ptr[i] *= norm;
 
-                    if (normalize)
-                        norm = ScalarFloat(1.0 / accum);
+                    detail::parallel_rows(h, w, [&](uint32_t y0, uint32_t y1) {
+                        for (uint32_t i = y0 * (w - 1); i < std::min(y1, n_rows) * (w - 1); ++i)
+                            cond_cdf_ptr[i] *= norm;
+                        for (uint32_t i = y0 * w; i < y1 * w; ++i)
+                            data_out_ptr[i] = data_ptr[i] * norm;
+                    });
                 }
-
-                for (size_t i = 0; i < n_cond; ++i)
-                    *cond_cdf_ptr++ *= norm;
-                for (size_t i = 0; i < n_marg; ++i)
-                    *marg_cdf_ptr++ *= norm;
-                for (size_t i = 0; i < n_data; ++i)
-                    *data_out_ptr++ = *data++ * norm;
-            }
+            });
 
             m_marg_cdf = dr::load<FloatStorage>(marg_cdf.get(), m_slices * n_marg);
             m_cond_cdf = dr::load<FloatStorage>(cond_cdf.get(), m_slices * n_cond);
         } else {
-            ScalarFloat *data_out_ptr = data_out.get();
-
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat norm = 1.f;
-
-                if (normalize) {
-                    double sum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        size_t i = y * w;
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i) {
-                            sum += (double) data[i] +
-                                   (double) data[i + 1] +
-                                   (double) data[i + w] +
-                                   (double) data[i + w + 1];
-                        }
+            detail::parallel_rows(m_slices, n_data, [&](uint32_t s0, uint32_t s1) {
+                std::unique_ptr<double[]> row_sum(new double[h]);
+
+                for (uint32_t slice = s0; slice < s1; ++slice) {
+                    const ScalarFloat *data_ptr = data + slice * n_data;
+                    ScalarFloat *data_out_ptr = data_out.get() + slice * n_data;
+                    ScalarFloat norm = 1.f;
+
+                    if (normalize) {
+                        detail::parallel_rows(h - 1, w, [&](uint32_t y0, uint32_t y1) {
+                            for (uint32_t y = y0; y < y1; ++y) {
+                                double sum = 0.0;
+                                size_t i = y * w;
+                                for (uint32_t x = 0; x < w - 1; ++x, ++i) {
+                                    sum += (double) data_ptr[i] +
+                                           (double) data_ptr[i + 1] +
+                                           (double) data_ptr[i + w] +
+                                           (double) data_ptr[i + w + 1];
+                                }
+                                row_sum[y] = sum;
+                            }
+                        });
+
+                        double sum = 0.0;
+                        for (uint32_t y = 0; y < h - 1; ++y)
+                            sum += row_sum[y];
+                        norm = ScalarFloat(1.0 / (scale_x * scale_y * sum));
                     }
-                    norm = ScalarFloat(1.0 / (scale_x * scale_y * sum));
-                }
 
-                for (uint32_t k = 0; k < n_data; ++k)
-                    *data_out_ptr++ = *data++ * norm;
-            }
+                    detail::parallel_rows(h, w, [&](uint32_t y0, uint32_t y1) {
+                        for (uint32_t i = y0 * w; i < y1 * w; ++i)
+                            data_out_ptr[i] = data_ptr[i] * norm;
+                    });
+                }
+            });
         }
 
         m_data = dr::load<FloatStorage>(data_out.get(), m_slices * n_data);
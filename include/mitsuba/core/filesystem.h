@@ -207,6 +207,11 @@ extern MI_EXPORT_LIB bool exists(const path& p) noexcept;
  * that is not a regular file or a symlink) is treated as an error.
  */
 extern MI_EXPORT_LIB size_t file_size(const path& p);
+/** \brief Returns the time of the last modification of the file or directory
+ * at <tt>p</tt> (in seconds since the Unix epoch). Attempting to query a path
+ * that does not exist is treated as an error.
+ */
+extern MI_EXPORT_LIB int64_t last_write_time(const path& p);
 
 /** \brief Checks whether two paths refer to the same file system object.
  * Both must refer to an existing file or directory.
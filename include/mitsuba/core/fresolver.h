@@ -3,6 +3,8 @@
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/object.h>
 #include <iosfwd>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -12,6 +14,12 @@ NAMESPACE_BEGIN(mitsuba)
  * This convenience class looks for a file or directory given its name
  * and a set of search paths. The implementation walks through the
  * search paths in order and stops once the file is found.
+ *
+ * Successful lookups are cached, since querying the file system can be slow,
+ * e.g. on network file systems. Failed lookups are not cached, so that files
+ * created later are found. The cache holds a bounded number of entries and is
+ * invalidated when the list of search paths changes in a way that could shadow
+ * previous results.
  */
 class MI_EXPORT_LIB FileResolver : public Object {
 public:
@@ -27,14 +35,25 @@ public:
     /// Walk through the list of search paths and try to resolve the input path
     fs::path resolve(const fs::path &path) const;
 
+    /**
+     * \brief Resolve several paths in parallel and cache the successful results
+     *
+     * This overlaps the latency of the underlying file system queries, after
+     * which \ref resolve() can answer lookups of these paths from its cache.
+     */
+    void prefetch(const std::vector<fs::path> &paths) const;
+
+    /// Forget the outcome of all previous lookups
+    void clear_cache();
+
     /// Return the number of search paths
     size_t size() const { return m_paths.size(); }
 
     /// Return an iterator at the beginning of the list of search paths
-    iterator begin() { return m_paths.begin(); }
+    iterator begin() { clear_cache(); return m_paths.begin(); }
 
     /// Return an iterator at the end of the list of search paths
-    iterator end()   { return m_paths.end(); }
+    iterator end()   { clear_cache(); return m_paths.end(); }
 
     /// Return an iterator at the beginning of the list of search paths (const)
     const_iterator begin() const { return m_paths.begin(); }
@@ -46,22 +65,22 @@ public:
     bool contains(const fs::path &p) const;
 
     /// Erase the entry at the given iterator position
-    void erase(iterator it) { m_paths.erase(it); }
+    void erase(iterator it) { clear_cache(); m_paths.erase(it); }
 
     /// Erase the search path from the list
     void erase(const fs::path &p);
 
     /// Clear the list of search paths
-    void clear() { m_paths.clear(); }
+    void clear() { clear_cache(); m_paths.clear(); }
 
     /// Prepend an entry at the beginning of the list of search paths
-    void prepend(const fs::path &path) { m_paths.insert(m_paths.begin(), path); }
+    void prepend(const fs::path &path);
 
     /// Append an entry to the end of the list of search paths
-    void append(const fs::path &path) { m_paths.push_back(path); }
+    void append(const fs::path &path);
 
     /// Return an entry from the list of search paths
-    fs::path &operator[](size_t index) { return m_paths[index]; }
+    fs::path &operator[](size_t index) { clear_cache(); return m_paths[index]; }
 
     /// Return an entry from the list of search paths (const)
     const fs::path &operator[](size_t index) const { return m_paths[index]; }
@@ -70,8 +89,16 @@ public:
     std::string to_string() const override;
 
     MI_DECLARE_CLASS()
+private:
+    /// Walk through the search paths, returns an empty path on failure
+    fs::path resolve_uncached(const fs::path &path) const;
+
 private:
     std::vector<fs::path> m_paths;
+
+    /// Successful lookup results (name -> resolved path)
+    mutable std::unordered_map<std::string, fs::path> m_cache;
+    mutable std::mutex m_cache_mutex;
 };
 
 NAMESPACE_END(mitsuba)
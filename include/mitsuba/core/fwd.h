@@ -33,7 +33,9 @@ class MemoryStream;
 class Mutex;
 class PluginManager;
 class Properties;
+class ServerSocket;
 class ScopedThreadEnvironment;
+class SocketStream;
 class Stream;
 class StreamAppender;
 class Struct;
@@ -64,6 +66,7 @@ template <typename Point>                       struct BoundingBox;
 template <typename Point>                       struct BoundingSphere;
 template <typename Vector>                      struct Frame;
 template <typename Float>                       struct DiscreteDistribution;
+template <typename Float>                       struct AliasDistribution;
 template <typename Float>                       struct ContinuousDistribution;
 
 template <typename Spectrum> using StokesVector  = dr::Array<Spectrum, 4>;
@@ -291,7 +294,7 @@ template <typename Float_> struct CoreAliases {
         mask = true;
 
 #define MI_MASKED_FUNCTION(profiler_phase, mask)                               \
-    ScopedPhase scope_phase(profiler_phase);                                   \
+    ScopedPhase scope_phase(profiler_phase, this);                             \
     (void) mask;                                                               \
     if constexpr (!dr::is_array_v<Float>)                                      \
         mask = true;
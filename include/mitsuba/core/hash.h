@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <cstring>
 #include <functional>
 #include <tuple>
 #include <iostream>
@@ -50,6 +51,23 @@ size_t hash(const std::vector<T, Allocator> &v) {
     return value;
 }
 
+/// Hash the contents of a memory region
+inline size_t hash(const void *ptr, size_t size) {
+    const uint8_t *data = (const uint8_t *) ptr;
+    size_t value = hash(size);
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), data += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(uint64_t));
+        value = hash_combine(value, hash(word));
+    }
+    if (size > 0) {
+        uint64_t word = 0;
+        memcpy(&word, data, size);
+        value = hash_combine(value, hash(word));
+    }
+    return value;
+}
+
 template <typename T> struct hasher {
     size_t operator()(const T &t) const {
         return hash(t);
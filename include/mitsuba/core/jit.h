@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/mitsuba.h>
+#include <mitsuba/core/filesystem.h>
 
 #if defined(DRJIT_X86_64)
 #  if defined(__GNUG__) && !defined(__clang__)
@@ -46,6 +47,55 @@ struct MI_EXPORT_LIB Jit {
 
     static Jit *get_instance();
 
+    /**
+     * \brief Initialize the given Dr.Jit backend(s), caching compiled kernels
+     * in the directory \c cache_dir
+     *
+     * Dr.Jit keeps compiled kernels in the ".drjit" subdirectory of the
+     * user's home directory, which it resolves once during initialization.
+     * When \c cache_dir is non-empty, the \c DRJIT_CACHE_DIR environment
+     * variable is set before initialization so that kernels are stored in
+     * <tt>cache_dir/.drjit</tt> instead. This allows render nodes to share a
+     * precompiled cache.
+     */
+    static void init_backend(uint32_t backends, const fs::path &cache_dir = {});
+
+    /**
+     * \brief Directory passed to \ref init_backend() to cache compiled
+     * kernels (empty when the default location is used)
+     *
+     * Other caches of compiled programs, such as the one of the OptiX
+     * modules, are also placed in this directory.
+     */
+    static const fs::path &cache_dir();
+
+    /// Summary of the kernels launched by Dr.Jit, see \ref kernel_stats()
+    struct KernelStats {
+        /// Number of launched kernels
+        size_t launches = 0;
+        /// Launches that reused a kernel compiled in the same process
+        size_t memory_hits = 0;
+        /// Launches that loaded a compiled kernel from the on-disk cache
+        size_t disk_hits = 0;
+        /// Total time (ms) spent generating IR, compiling it, and launching
+        float codegen_time = 0.f, backend_time = 0.f, execution_time = 0.f;
+
+        /// Fraction of launches that did not require compilation
+        float hit_rate() const {
+            return launches ? (float) (memory_hits + disk_hits) / launches : 0.f;
+        }
+
+        std::string to_string() const;
+    };
+
+    /**
+     * \brief Summarize and clear the history of kernel launches
+     *
+     * The history is only recorded while the \c JitFlag::KernelHistory flag
+     * of Dr.Jit is set.
+     */
+    static KernelStats kernel_stats();
+
 private:
     Jit();
     Jit(const Jit &) = delete;
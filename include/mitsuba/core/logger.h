@@ -22,6 +22,12 @@ enum LogLevel : int {
  * convert it into a human-readable form. Following that, it sends this
  * information to every registered Appender.
  *
+ * By default, the appenders are invoked synchronously by the thread that
+ * submits the message. In asynchronous mode (see \ref set_async()), messages
+ * are instead placed into a lock-free queue that is processed by a
+ * background thread, so that threads producing many messages (e.g. during
+ * parallel scene loading with debug output) don't serialize on the appenders.
+ *
  * \ingroup libcore
  */
 class MI_EXPORT_LIB Logger : public Object {
@@ -76,6 +82,27 @@ public:
     /// Return the current error level
     LogLevel error_level() const;
 
+    /**
+     * \brief Enable or disable the asynchronous processing of log messages
+     *
+     * Messages are still formatted by the submitting thread, but the
+     * appenders are invoked by a background thread in the order in which the
+     * messages were submitted. Submitting threads never wait for the
+     * background thread: messages that don't fit into the queue are kept in
+     * an unbounded overflow list instead. Disabling asynchronous mode
+     * processes all pending messages first. Progress messages are never
+     * deferred.
+     *
+     * This function must not be called while other threads submit messages.
+     */
+    void set_async(bool value);
+
+    /// Are log messages processed asynchronously?
+    bool is_async() const;
+
+    /// Wait until all pending asynchronous log messages have been processed
+    void flush();
+
     /// Add an appender to this logger
     void add_appender(Appender *appender);
 
@@ -400,6 +400,63 @@ solve_quadratic(const Value &a, const Value &b, const Value &c) {
     return { valid_linear || valid_quadratic, x0, x1 };
 }
 
+/**
+ * \brief Polynomial approximation of the sine and cosine of an angle in
+ * <tt>[-pi/4, pi/4]</tt>
+ *
+ * The truncated Taylor series have an absolute error below <tt>4e-7</tt> on
+ * this interval. Since no range reduction is performed, this is considerably
+ * cheaper than \c dr::sincos(), especially in packets.
+ */
+template <typename Value>
+MI_INLINE std::pair<Value, Value> sincos_quarter_pi(const Value &x) {
+    using Scalar = dr::scalar_t<Value>;
+    Value x2 = dr::sqr(x);
+
+    Value s = dr::fmadd(x2, Scalar(-1.0 / 5040.0), Scalar(1.0 / 120.0));
+    s = dr::fmadd(x2, s, Scalar(-1.0 / 6.0));
+    s = dr::fmadd(x2 * x, s, x);
+
+    Value c = dr::fmadd(x2, Scalar(1.0 / 40320.0), Scalar(-1.0 / 720.0));
+    c = dr::fmadd(x2, c, Scalar(1.0 / 24.0));
+    c = dr::fmadd(x2, c, Scalar(-0.5));
+    c = dr::fmadd(x2, c, Scalar(1.0));
+
+    return { s, c };
+}
+
+/**
+ * \brief Fast approximation of the sine and cosine of <tt>2*pi*u</tt>
+ *
+ * The argument is reduced exactly to a quarter turn around the nearest
+ * multiple of <tt>pi/2</tt>, which is evaluated by \ref sincos_quarter_pi().
+ * The absolute error is below <tt>1e-6</tt> for arguments in <tt>[-1, 1]</tt>
+ * (e.g. uniformly distributed samples) and grows with the rounding error of
+ * the reduction for larger ones.
+ */
+template <typename Value>
+MI_INLINE std::pair<Value, Value> sincos_2pi_fast(const Value &u) {
+    using Int32 = dr::int32_array_t<Value>;
+    using Mask = dr::mask_t<Value>;
+
+    Value x = u - dr::round(u),
+          q = dr::round(4.f * x),
+          r = dr::fnmadd(q, .25f, x);
+
+    auto [s0, c0] = sincos_quarter_pi(dr::TwoPi<Value> * r);
+
+    // Rotate by q quarter turns
+    Int32 qi = Int32(q) & 3;
+    Mask swap  = Mask(dr::neq(qi & 1, 0)),
+         neg_s = Mask(dr::neq(qi & 2, 0)),
+         neg_c = Mask(dr::neq((qi + 1) & 2, 0));
+
+    Value s = dr::select(swap, c0, s0),
+          c = dr::select(swap, s0, c0);
+
+    return { dr::select(neg_s, -s, s), dr::select(neg_c, -c, c) };
+}
+
 //! @}
 // -----------------------------------------------------------------------
 
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <atomic>
+#include <string>
+#include <utility>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Categories of the memory usage reported by the \ref MemoryTracker
+enum class MemoryCategory : uint32_t {
+    Mesh = 0,          /* Vertex and face buffers of meshes */
+    Bitmap,            /* Pixels of Bitmap instances */
+    Texture,           /* Texels of textures */
+    Volume,            /* Voxels of volume grids and grid volumes */
+    Film,              /* Image blocks (films and render tiles) */
+    Accel,             /* Ray tracing acceleration data structures */
+
+    MemoryCategoryCount
+};
+
+constexpr const char
+    *memory_category_id[uint32_t(MemoryCategory::MemoryCategoryCount)] = {
+        "Meshes",
+        "Bitmaps",
+        "Textures",
+        "Volumes",
+        "Films",
+        "Acceleration data structures"
+    };
+
+/**
+ * \brief Accounting of the memory used by the large buffers of the renderer
+ *
+ * Objects owning large buffers (meshes, bitmaps, textures, volumes, image
+ * blocks and acceleration data structures) register their host and device
+ * memory usage under a \ref MemoryCategory via a \ref MemoryRecord member.
+ * The totals are updated using atomic operations and can be queried at any
+ * time, e.g. to find out which part of a scene exhausts the available memory.
+ *
+ * An optional budget produces a warning as soon as the total usage exceeds
+ * it. Objects register their buffers before allocating them where possible,
+ * so that the warning precedes a failing allocation.
+ *
+ * Temporary allocations, buffers of the JIT compiler that are not owned by
+ * one of the above objects, and the memory of external ray tracing libraries
+ * that do not report it are not accounted for.
+ */
+class MI_EXPORT_LIB MemoryTracker {
+public:
+    /// Return the (host, device) memory usage of a category in bytes
+    static std::pair<size_t, size_t> usage(MemoryCategory category);
+
+    /// Return the total (host, device) memory usage in bytes
+    static std::pair<size_t, size_t> total();
+
+    /// Return the largest total usage (host + device) since the last \ref reset_peak()
+    static size_t peak();
+
+    /// Reset the peak usage to the current total
+    static void reset_peak();
+
+    /**
+     * \brief Set the budget (in bytes) of the total (host + device) usage
+     *
+     * A warning is logged whenever the usage exceeds the budget. A budget of
+     * zero (the default) disables the warning.
+     */
+    static void set_budget(size_t budget);
+
+    /// Return the current budget (zero: no budget)
+    static size_t budget();
+
+    /// Adjust the usage of a category (used by \ref MemoryRecord)
+    static void add(MemoryCategory category, int64_t host, int64_t device);
+
+    /// Return a human-readable table of the usage of all categories
+    static std::string to_string();
+};
+
+/**
+ * \brief Memory usage of an object in a \ref MemoryCategory
+ *
+ * The usage is unregistered when the record is destroyed. Copies start with
+ * zero usage, since the copied object registers the buffers it allocates
+ * itself.
+ */
+class MI_EXPORT_LIB MemoryRecord {
+public:
+    MemoryRecord(MemoryCategory category) : m_category(category) { }
+
+    MemoryRecord(const MemoryRecord &record) : m_category(record.m_category) { }
+
+    MemoryRecord(MemoryRecord &&record)
+        : m_category(record.m_category), m_host(record.m_host),
+          m_device(record.m_device) {
+        record.m_host = record.m_device = 0;
+    }
+
+    MemoryRecord &operator=(const MemoryRecord &) = delete;
+
+    ~MemoryRecord() { set(0, 0); }
+
+    /// Replace the registered usage (in bytes)
+    void set(size_t host, size_t device = 0) {
+        if (host == m_host && device == m_device)
+            return;
+        MemoryTracker::add(m_category, (int64_t) host - (int64_t) m_host,
+                           (int64_t) device - (int64_t) m_device);
+        m_host = host;
+        m_device = device;
+    }
+
+    /// Register \c bytes in device memory if \c device is set, and in host memory otherwise
+    void set_bytes(size_t bytes, bool device) {
+        set(device ? 0 : bytes, device ? bytes : 0);
+    }
+
+    /// Return the registered host memory usage (in bytes)
+    size_t host() const { return m_host; }
+
+    /// Return the registered device memory usage (in bytes)
+    size_t device() const { return m_device; }
+
+private:
+    MemoryCategory m_category;
+    size_t m_host = 0, m_device = 0;
+};
+
+NAMESPACE_END(mitsuba)
@@ -32,6 +32,14 @@ public:
     /// Return the list of loaded plugins
     std::vector<std::string> loaded_plugins() const;
 
+    /**
+     * \brief Return the list of plugins that are listed in the plugin
+     * manifest generated by the build system, without loading them
+     *
+     * The list is empty if no manifest was found.
+     */
+    std::vector<std::string> available_plugins() const;
+
     /// Register a Python plugin
     void register_python_plugin(const std::string &plugin_name,
                                 const std::string &variant);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/trace.h>
 
 #if defined(MI_ENABLE_ITTNOTIFY)
 #  include <ittnotify.h>
@@ -10,6 +11,10 @@
 #  include <nvtx3/nvToolsExt.h>
 #endif
 
+#if defined(MI_ENABLE_PROFILER)
+#  include <atomic>
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**
@@ -84,8 +89,57 @@ extern MI_EXPORT_LIB __itt_string_handle *
     mitsuba_itt_phase[int(ProfilerPhase::ProfilerPhaseCount)];
 #endif
 
+#if defined(MI_ENABLE_PROFILER)
+/// Maximum nesting depth of phases that are attributed to plugin instances
+#define MI_PROFILER_MAX_DEPTH 32
+
+/**
+ * \brief Per-thread state of the built-in sampling profiler
+ *
+ * This record is written by \ref ScopedPhase and read by a signal handler that
+ * periodically interrupts the running thread.
+ */
+struct ProfilerThreadState {
+    /// Bit mask of the phases that are currently active
+    uint64_t flags = 0;
+    /// Nesting depth of the active phases
+    uint32_t depth = 0;
+    /// Phase stack, from the outermost to the innermost phase
+    ProfilerPhase phases[MI_PROFILER_MAX_DEPTH];
+    /// Plugin instance associated with each entry of the phase stack
+    const Object *objects[MI_PROFILER_MAX_DEPTH];
+};
+
+extern MI_EXPORT_LIB thread_local ProfilerThreadState profiler_state;
+#endif
+
 struct ScopedPhase {
-    ScopedPhase(ProfilerPhase phase) {
+    /**
+     * \brief Mark the beginning of a profiler phase that lasts until the
+     * destruction of this object
+     *
+     * The optional \c object (e.g. the BSDF that is being evaluated) is used
+     * to attribute the time spent in the phase to a specific plugin instance.
+     * While a \ref Trace is recorded, the phase is also added to its timeline.
+     */
+    ScopedPhase(ProfilerPhase phase, const Object *object = nullptr)
+        : m_phase(phase),
+          m_trace_start(detail::trace_enabled.load(std::memory_order_relaxed)
+                            ? detail::trace_time() : 0) {
+#if defined(MI_ENABLE_PROFILER)
+        ProfilerThreadState &state = profiler_state;
+        m_flag = (state.flags & (1ull << (int) phase)) ? 0 : (1ull << (int) phase);
+        uint32_t depth = state.depth;
+        if (depth < MI_PROFILER_MAX_DEPTH) {
+            state.phases[depth] = phase;
+            state.objects[depth] = object;
+        }
+        state.flags |= m_flag;
+        // Publish the stack entry before the signal handler can observe it
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        state.depth = depth + 1;
+#endif
+
         /// Interface with various external visual profilers
 #if defined(MI_ENABLE_ITTNOTIFY)
         __itt_task_begin(mitsuba_itt_domain, __itt_null, __itt_null,
@@ -95,10 +149,21 @@ struct ScopedPhase {
 #if defined(MI_ENABLE_NVTX)
         nvtxRangePush(profiler_phase_id[(int) phase]);
 #endif
-        (void) phase;
+        (void) phase; (void) object;
     }
 
     ~ScopedPhase() {
+        if (unlikely(m_trace_start))
+            detail::trace_record(profiler_phase_id[(int) m_phase], "phase",
+                                 m_trace_start);
+
+#if defined(MI_ENABLE_PROFILER)
+        ProfilerThreadState &state = profiler_state;
+        state.depth--;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        state.flags &= ~m_flag;
+#endif
+
 #if defined(MI_ENABLE_ITTNOTIFY)
         __itt_task_end(mitsuba_itt_domain);
 #endif
@@ -110,12 +175,42 @@ struct ScopedPhase {
 
     ScopedPhase(const ScopedPhase &) = delete;
     ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+private:
+    ProfilerPhase m_phase;
+    /// Start of the phase for \ref Trace, or zero if no trace is recorded
+    uint64_t m_trace_start;
+#if defined(MI_ENABLE_PROFILER)
+    /// Bit of the phase, or zero if the phase was already active (recursion)
+    uint64_t m_flag;
+#endif
 };
 
+/**
+ * \brief Built-in sampling profiler
+ *
+ * When Mitsuba is compiled with <tt>MI_ENABLE_PROFILER</tt>, a timer
+ * periodically interrupts the running threads and records which \ref
+ * ProfilerPhase (and which plugin instance) they are currently executing. The
+ * overhead of this approach is limited to a few instructions per \ref
+ * ScopedPhase, which makes it suitable for production runs.
+ *
+ * Note that in JIT variants, the phases only cover the tracing of kernels and
+ * not their execution.
+ */
 class MI_EXPORT_LIB Profiler {
 public:
     static void static_initialization();
     static void static_shutdown();
+
+    /**
+     * \brief Print a summary of the time spent in each phase and plugin
+     * instance since the last call, and reset the statistics.
+     *
+     * Must be called while the referenced plugin instances are still alive.
+     * Does nothing when the profiler is disabled.
+     */
+    static void print_report();
 };
 
 NAMESPACE_END(mitsuba)
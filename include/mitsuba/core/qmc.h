@@ -236,4 +236,150 @@ Float sobol_2(UInt index, UInt scramble = 0) {
     }
 }
 
+
+/**
+ * \brief 256x256 threshold matrix for ordered dithering (defined in
+ * dither-matrix256.cpp)
+ *
+ * The entries are a permutation of the integers <tt>0..65535</tt>, mapped to
+ * the interval <tt>[-0.5, 0.5]</tt>, and have a blue-noise spectrum.
+ */
+extern MI_EXPORT_LIB const float dither_matrix256[65536];
+
+/// Number of dimensions provided by \ref sobol_sample()
+static constexpr uint32_t SobolMaxDimension = 4;
+
+NAMESPACE_BEGIN(detail)
+/**
+ * Generator matrices of the first four dimensions of the Sobol' sequence
+ * (Joe-Kuo direction numbers). Column \c i is XORed into the result when bit
+ * \c i of the sample index is set.
+ */
+static constexpr uint32_t sobol_matrices[SobolMaxDimension][32] = {
+        {
+          0x80000000u, 0x40000000u, 0x20000000u, 0x10000000u,
+          0x08000000u, 0x04000000u, 0x02000000u, 0x01000000u,
+          0x00800000u, 0x00400000u, 0x00200000u, 0x00100000u,
+          0x00080000u, 0x00040000u, 0x00020000u, 0x00010000u,
+          0x00008000u, 0x00004000u, 0x00002000u, 0x00001000u,
+          0x00000800u, 0x00000400u, 0x00000200u, 0x00000100u,
+          0x00000080u, 0x00000040u, 0x00000020u, 0x00000010u,
+          0x00000008u, 0x00000004u, 0x00000002u, 0x00000001u },
+        {
+          0x80000000u, 0xc0000000u, 0xa0000000u, 0xf0000000u,
+          0x88000000u, 0xcc000000u, 0xaa000000u, 0xff000000u,
+          0x80800000u, 0xc0c00000u, 0xa0a00000u, 0xf0f00000u,
+          0x88880000u, 0xcccc0000u, 0xaaaa0000u, 0xffff0000u,
+          0x80008000u, 0xc000c000u, 0xa000a000u, 0xf000f000u,
+          0x88008800u, 0xcc00cc00u, 0xaa00aa00u, 0xff00ff00u,
+          0x80808080u, 0xc0c0c0c0u, 0xa0a0a0a0u, 0xf0f0f0f0u,
+          0x88888888u, 0xccccccccu, 0xaaaaaaaau, 0xffffffffu },
+        {
+          0x80000000u, 0xc0000000u, 0x60000000u, 0x90000000u,
+          0xe8000000u, 0x5c000000u, 0x8e000000u, 0xc5000000u,
+          0x68800000u, 0x9cc00000u, 0xee600000u, 0x55900000u,
+          0x80680000u, 0xc09c0000u, 0x60ee0000u, 0x90550000u,
+          0xe8808000u, 0x5cc0c000u, 0x8e606000u, 0xc5909000u,
+          0x6868e800u, 0x9c9c5c00u, 0xeeee8e00u, 0x5555c500u,
+          0x8000e880u, 0xc0005cc0u, 0x60008e60u, 0x9000c590u,
+          0xe8006868u, 0x5c009c9cu, 0x8e00eeeeu, 0xc5005555u },
+        {
+          0x80000000u, 0xc0000000u, 0x20000000u, 0x50000000u,
+          0xf8000000u, 0x74000000u, 0xa2000000u, 0x93000000u,
+          0xd8800000u, 0x25400000u, 0x59e00000u, 0xe6d00000u,
+          0x78080000u, 0xb40c0000u, 0x82020000u, 0xc3050000u,
+          0x208f8000u, 0x51474000u, 0xfbea2000u, 0x75d93000u,
+          0xa0858800u, 0x914e5400u, 0xdbe79e00u, 0x25db6d00u,
+          0x58800080u, 0xe54000c0u, 0x79e00020u, 0xb6d00050u,
+          0x800800f8u, 0xc00c0074u, 0x200200a2u, 0x50050093u }
+};
+NAMESPACE_END(detail)
+
+/// Reverse the order of the bits of a 32 bit unsigned integer
+template <typename UInt32> UInt32 reverse_bits(UInt32 x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ff) << 8) | ((x & 0xff00ff00) >> 8);
+    x = ((x & 0x0f0f0f0f) << 4) | ((x & 0xf0f0f0f0) >> 4);
+    x = ((x & 0x33333333) << 2) | ((x & 0xcccccccc) >> 2);
+    x = ((x & 0x55555555) << 1) | ((x & 0xaaaaaaaa) >> 1);
+    return x;
+}
+
+/**
+ * \brief Evaluate the 32 bit integer representation of the Sobol' sequence
+ *
+ * The generator matrix of dimension \c dim is applied to the sample index
+ * using branch-free XOR operations, which vectorizes well.
+ *
+ * \param index
+ *     Sample index
+ * \param dim
+ *     Sobol' dimension (must be smaller than \ref SobolMaxDimension)
+ */
+template <typename UInt32> UInt32 sobol_sample(UInt32 index, uint32_t dim) {
+    Assert(dim < SobolMaxDimension, "sobol_sample(): dimension out of range!");
+
+    // The first dimension is the Van der Corput sequence
+    if (dim == 0)
+        return reverse_bits(index);
+
+    const uint32_t *m = detail::sobol_matrices[dim];
+    UInt32 result = 0;
+    for (uint32_t bit = 0; bit < 32; ++bit)
+        dr::masked(result, dr::neq(index & (1u << bit), 0u)) ^= m[bit];
+    return result;
+}
+
+/**
+ * \brief Hash-based approximation of the Laine-Karras permutation
+ *
+ * Every output bit only depends on the input bits of lower or equal
+ * significance. Refer to "Practical Hash-based Owen Scrambling" by Brent
+ * Burley (JCGT 2020) for details.
+ */
+template <typename UInt32>
+UInt32 laine_karras_permutation(UInt32 x, UInt32 seed) {
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+/**
+ * \brief Nested uniform (Owen) scrambling of the bits of a 32 bit integer
+ *
+ * Applied to a sample value, this randomizes a (t, m, s)-net while preserving
+ * its stratification. Applied to a sample index, it shuffles the order of the
+ * points such that every aligned block of \f$2^k\f$ indices is mapped onto
+ * another aligned block of the same size.
+ */
+template <typename UInt32>
+UInt32 nested_uniform_scramble(UInt32 x, UInt32 seed) {
+    return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+/**
+ * \brief Owen-scrambled and shuffled Sobol' sequence
+ *
+ * \param index
+ *     Sample index
+ * \param dim
+ *     Sobol' dimension (must be smaller than \ref SobolMaxDimension)
+ * \param shuffle_seed
+ *     Seed of the nested uniform scramble of the sample index
+ * \param scramble_seed
+ *     Seed of the nested uniform scramble of the sample value
+ * \return
+ *     A sample in the interval <tt>[0, 1)</tt>
+ */
+template <typename UInt32, typename Float = dr::float_array_t<UInt32>>
+Float owen_scrambled_sobol(UInt32 index, uint32_t dim, UInt32 shuffle_seed,
+                           UInt32 scramble_seed) {
+    index = nested_uniform_scramble(index, shuffle_seed);
+    UInt32 value = nested_uniform_scramble(sobol_sample(index, dim), scramble_seed);
+    return dr::minimum(Float(value) * Float(0x1p-32), dr::OneMinusEpsilon<Float>);
+}
+
 NAMESPACE_END(mitsuba)
@@ -4,6 +4,7 @@
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/distr_1d.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -62,6 +63,24 @@ public:
     /// Check whether this is a box filter?
     bool is_box_filter() const;
 
+    /**
+     * \brief Importance sample the (separable) filter function
+     *
+     * Generates an offset from the pixel center that is distributed
+     * proportionally to the absolute value of the filter, using a tabulated
+     * version of it. This allows adding every sample to a single pixel with a
+     * box weight instead of splatting it over the filter footprint.
+     *
+     * \param sample
+     *     A uniformly distributed sample on <tt>[0, 1]^2</tt>
+     *
+     * \return
+     *     The offset, and the ratio between the filter value and the sample
+     *     density (which is negative within negative lobes of the filter).
+     */
+    std::pair<Vector2f, Float> sample(const Point2f &sample,
+                                      Mask active = true) const;
+
     /// Evaluate a discretized version of the filter (generally faster than 'eval')
     MI_INLINE Float eval_discretized(Float x, Mask active = true) const {
         if constexpr (!dr::is_jit_v<Float>) {
@@ -89,6 +108,9 @@ protected:
     ScalarFloat m_radius, m_scale_factor;
     std::vector<ScalarFloat> m_values;
     uint32_t m_border_size;
+
+    /// Tabulated absolute value of the filter used by \ref sample()
+    ContinuousDistribution<Float> m_distr;
 };
 
 /**
@@ -291,6 +313,71 @@ template <typename Scalar_> struct Resampler {
         (this->*f)(source, source_stride, target, target_stride, channels);
     }
 
+    /**
+     * \brief Resample a 2D array of samples along its rows (i.e. vertically)
+     *
+     * This is equivalent to calling \ref resample() for every column of the
+     * array, but accumulates entire source rows into each target row. The
+     * memory accesses are thus sequential and the inner loop vectorizes,
+     * whereas resampling the columns of a large image individually is
+     * limited by cache misses.
+     *
+     * \param source
+     *     Source array with \ref source_resolution() rows
+     * \param target
+     *     Target array with \ref target_resolution() rows
+     * \param row_size
+     *     Number of samples per row (i.e. the width times the channel count)
+     * \param first
+     *     Index of the first target row that should be computed
+     * \param last
+     *     One past the index of the last target row that should be computed
+     */
+    void resample_rows(const Scalar *source, Scalar *target, size_t row_size,
+                       uint32_t first, uint32_t last) const {
+        const uint32_t taps = m_taps, half_taps = m_taps / 2;
+        const Scalar min = std::get<0>(m_clamp);
+        const Scalar max = std::get<1>(m_clamp);
+        bool clamp = m_clamp != std::make_pair(-std::numeric_limits<Scalar>::infinity(),
+                                                std::numeric_limits<Scalar>::infinity());
+
+        for (uint32_t i = first; i < last; ++i) {
+            const int32_t offset =
+                m_start ? m_start[i] : ((int32_t) i - (int32_t) half_taps);
+            const Scalar *weights =
+                m_weights.get() + (m_start ? (size_t) i * taps : (size_t) 0);
+            Scalar *t = target + (size_t) i * row_size;
+
+            for (size_t k = 0; k < row_size; ++k)
+                t[k] = Scalar(0);
+
+            for (uint32_t j = 0; j < taps; ++j) {
+                int32_t pos = offset + (int32_t) j;
+                const Scalar weight = weights[j];
+
+                if (unlikely(pos < 0 || pos >= (int32_t) m_source_res)) {
+                    if (m_bc == FilterBoundaryCondition::One ||
+                        m_bc == FilterBoundaryCondition::Zero) {
+                        const Scalar value = Scalar(m_bc == FilterBoundaryCondition::One ? 1 : 0);
+                        for (size_t k = 0; k < row_size; ++k)
+                            t[k] += value * weight;
+                        continue;
+                    }
+                    pos = boundary_position(pos);
+                }
+
+                const Scalar *s = source + (size_t) pos * row_size;
+                for (size_t k = 0; k < row_size; ++k)
+                    t[k] += s[k] * weight;
+            }
+
+            if (clamp) {
+                for (size_t k = 0; k < row_size; ++k)
+                    t[k] = dr::template clamp<Scalar>(t[k], min, max);
+            }
+        }
+    }
+
 
     /// Return a human-readable summary
     std::string to_string() const {
@@ -377,31 +464,44 @@ private:
     Scalar lookup(const Scalar *source, int32_t pos, uint32_t stride, uint32_t ch) const {
         if (unlikely(pos < 0 || pos >= (int32_t) m_source_res)) {
             switch (m_bc) {
-                case FilterBoundaryCondition::Clamp:
-                    pos = dr::clamp(pos, 0, (int32_t) m_source_res - 1);
-                    break;
-
-                case FilterBoundaryCondition::Repeat:
-                    pos = math::modulo(pos, (int32_t) m_source_res);
-                    break;
-
-                case FilterBoundaryCondition::Mirror:
-                    pos = math::modulo(pos, 2 * (int32_t) m_source_res - 2);
-                    if (pos >= (int32_t) m_source_res - 1)
-                        pos = 2 * m_source_res - 2 - pos;
-                    break;
-
                 case FilterBoundaryCondition::One:
                     return Scalar(1);
 
                 case FilterBoundaryCondition::Zero:
                     return Scalar(0);
+
+                default:
+                    pos = boundary_position(pos);
+                    break;
             }
         }
 
         return source[pos * stride + ch];
     }
 
+    /// Map an out-of-range sample position according to the (clamp/repeat/mirror) boundary condition
+    int32_t boundary_position(int32_t pos) const {
+        switch (m_bc) {
+            case FilterBoundaryCondition::Clamp:
+                pos = dr::clamp(pos, 0, (int32_t) m_source_res - 1);
+                break;
+
+            case FilterBoundaryCondition::Repeat:
+                pos = math::modulo(pos, (int32_t) m_source_res);
+                break;
+
+            case FilterBoundaryCondition::Mirror:
+                pos = math::modulo(pos, 2 * (int32_t) m_source_res - 2);
+                if (pos >= (int32_t) m_source_res - 1)
+                    pos = 2 * m_source_res - 2 - pos;
+                break;
+
+            default:
+                break;
+        }
+        return pos;
+    }
+
 private:
     std::unique_ptr<int32_t[]> m_start;
     std::unique_ptr<Scalar[]> m_weights;
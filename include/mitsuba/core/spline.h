@@ -299,6 +299,213 @@ Value eval_1d(const Float *nodes, const Float *values,
         return eval_spline(f0, f1, d0, d1, t);
 }
 
+/**
+ * \brief Precompute the polynomial coefficients of the segments of a cubic
+ * spline interpolant of a \a uniformly sampled 1D function
+ *
+ * The Catmull-Rom spline evaluated by \ref eval_1d() is converted into the
+ * power basis <tt>((a*t + b)*t + c)*t + d</tt> of every segment, whose four
+ * coefficients are stored consecutively. \ref eval_1d_precomputed() then
+ * only requires a single (packed) gather per evaluation instead of four
+ * gathers and the finite differences of every call.
+ *
+ * \param values
+ *      Array containing \c size regularly spaced evaluations of the
+ *      approximated function.
+ * \param size
+ *      Denotes the size of the \c values array
+ * \param[out] out
+ *      An array with <tt>4*(size-1)</tt> entries, which will be used to
+ *      store the coefficients
+ * \remark
+ *      The Python API lacks the \c size and \c out parameters. The former
+ *      is inferred automatically from the size of the input array, and \c out
+ *      is returned as a list.
+ */
+template <typename Float>
+void precompute_1d(const Float *values, uint32_t size, Float *out) {
+    for (uint32_t idx = 0; idx < size - 1; ++idx) {
+        Float f0 = values[idx],
+              f1 = values[idx + 1],
+              d0 = idx > 0 ? (Float) .5f * (f1 - values[idx - 1]) : f1 - f0,
+              d1 = idx + 2 < size ? (Float) .5f * (values[idx + 2] - f0) : f1 - f0;
+
+        out[4 * idx + 0] = 2 * f0 - 2 * f1 + d0 + d1;
+        out[4 * idx + 1] = -3 * f0 + 3 * f1 - 2 * d0 - d1;
+        out[4 * idx + 2] = d0;
+        out[4 * idx + 3] = f0;
+    }
+}
+
+/**
+ * \brief Precompute the polynomial coefficients of the segments of a cubic
+ * spline interpolant of a \a non-uniformly sampled 1D function
+ *
+ * Counterpart of the uniform version of \ref precompute_1d() for the
+ * spline evaluated by the non-uniform version of \ref eval_1d(). The
+ * polynomials are parameterized by the relative position within the
+ * segment.
+ *
+ * \param nodes
+ *      Array containing \c size non-uniformly spaced values denoting positions
+ *      the where the function to be interpolated was evaluated. They must be
+ *      provided in \a increasing order.
+ * \param values
+ *      Array containing function evaluations matched to the entries of \c
+ *      nodes.
+ * \param size
+ *      Denotes the size of the \c nodes and \c values array
+ * \param[out] out
+ *      An array with <tt>4*(size-1)</tt> entries, which will be used to
+ *      store the coefficients
+ * \remark
+ *      The Python API lacks the \c size and \c out parameters. The former
+ *      is inferred automatically from the size of the input array, and \c out
+ *      is returned as a list.
+ */
+template <typename Float>
+void precompute_1d(const Float *nodes, const Float *values, uint32_t size,
+                   Float *out) {
+    for (uint32_t idx = 0; idx < size - 1; ++idx) {
+        Float f0 = values[idx],
+              f1 = values[idx + 1],
+              x0 = nodes[idx],
+              x1 = nodes[idx + 1],
+              width = x1 - x0,
+              d0 = idx > 0 ? width * (f1 - values[idx - 1]) / (x1 - nodes[idx - 1])
+                           : f1 - f0,
+              d1 = idx + 2 < size ? width * (values[idx + 2] - f0) / (nodes[idx + 2] - x0)
+                                  : f1 - f0;
+
+        out[4 * idx + 0] = 2 * f0 - 2 * f1 + d0 + d1;
+        out[4 * idx + 1] = -3 * f0 + 3 * f1 - 2 * d0 - d1;
+        out[4 * idx + 2] = d0;
+        out[4 * idx + 3] = f0;
+    }
+}
+
+/**
+ * \brief Evaluate a cubic spline interpolant of a \a uniformly sampled 1D
+ * function using coefficients computed by \ref precompute_1d()
+ *
+ * The result matches \ref eval_1d(). The segment is found in constant time
+ * from the position of \c x, and its four coefficients are fetched using a
+ * single gather of a packed 4D vector.
+ *
+ * \tparam Extrapolate
+ *      Extrapolate values when \c x is out of range? (default: \c false)
+ * \param min
+ *      Position of the first node
+ * \param max
+ *      Position of the last node
+ * \param coeffs
+ *      Array containing the <tt>4*(size-1)</tt> coefficients computed by
+ *      \ref precompute_1d()
+ * \param size
+ *      Denotes the number of nodes of the spline (i.e. the size of the
+ *      \c values array passed to \ref precompute_1d())
+ * \param x
+ *      Evaluation point
+ * \remark
+ *      The Python API lacks the \c size parameter, which is inferred
+ *      automatically from the size of the coefficient array.
+ * \return
+ *      The interpolated value or zero when <tt>Extrapolate=false</tt>
+ *      and \c x lies outside of [\c min, \c max]
+ */
+template <bool Extrapolate = false, typename Value, typename Float>
+Value eval_1d_precomputed(Float min, Float max, const Float *coeffs,
+                          uint32_t size, Value x) {
+    using Mask = dr::mask_t<Value>;
+    using Index = dr::uint32_array_t<Value>;
+    using Coeffs = dr::Array<Value, 4>;
+
+    /* Give up when given an out-of-range or NaN argument */
+    Mask mask_valid = (x >= min) && (x <= max);
+
+    if (unlikely(!Extrapolate && dr::none(mask_valid)))
+        return dr::zeros<Value>();
+
+    /* Transform 'x' so that nodes lie at integer positions */
+    Value t = (x - min) * (Float(size - 1) / (max - min));
+
+    /* Find the index of the left node in the queried subinterval */
+    Index idx = dr::maximum(Index(0), dr::minimum(Index(t), Index(size - 2)));
+
+    Coeffs c = dr::gather<Coeffs>(coeffs, idx);
+
+    /* Compute the relative position within the interval */
+    t -= idx;
+
+    Value result = dr::fmadd(dr::fmadd(dr::fmadd(c.x(), t, c.y()), t, c.z()), t, c.w());
+
+    if (!Extrapolate)
+        return dr::select(mask_valid, result, dr::zeros<Value>());
+    else
+        return result;
+}
+
+/**
+ * \brief Evaluate a cubic spline interpolant of a \a non-uniformly sampled 1D
+ * function using coefficients computed by \ref precompute_1d()
+ *
+ * The result matches the non-uniform version of \ref eval_1d().
+ *
+ * \tparam Extrapolate
+ *      Extrapolate values when \c x is out of range? (default: \c false)
+ * \param nodes
+ *      Array containing \c size non-uniformly spaced values denoting positions
+ *      the where the function to be interpolated was evaluated. They must be
+ *      provided in \a increasing order.
+ * \param coeffs
+ *      Array containing the <tt>4*(size-1)</tt> coefficients computed by
+ *      \ref precompute_1d()
+ * \param size
+ *      Denotes the size of the \c nodes array
+ * \param x
+ *      Evaluation point
+ * \remark
+ *      The Python API lacks the \c size parameter, which is inferred
+ *      automatically from the size of the input array
+ * \return
+ *      The interpolated value or zero when <tt>Extrapolate=false</tt>
+ *      and \c x lies outside of \a [\c min, \c max]
+ */
+template <bool Extrapolate = false, typename Value, typename Float>
+Value eval_1d_precomputed(const Float *nodes, const Float *coeffs,
+                          uint32_t size, Value x) {
+    using Mask = dr::mask_t<Value>;
+    using Index = dr::uint32_array_t<Value>;
+    using Coeffs = dr::Array<Value, 4>;
+
+    /* Give up when given an out-of-range or NaN argument */
+    Mask mask_valid = (x >= nodes[0]) && (x <= nodes[size-1]);
+
+    if (unlikely(!Extrapolate && dr::none(mask_valid)))
+        return dr::zeros<Value>();
+
+    /* Find the index of the left node in the queried subinterval */
+    Index idx = math::find_interval<Index>(size,
+        [&](Index idx) {
+            return dr::gather<Value>(nodes, idx, mask_valid) <= x;
+        }
+    );
+
+    Value x0 = dr::gather<Value>(nodes, idx),
+          x1 = dr::gather<Value>(nodes, idx + 1);
+    Coeffs c = dr::gather<Coeffs>(coeffs, idx);
+
+    /* Compute the relative position within the interval */
+    Value t = (x - x0) / (x1 - x0);
+
+    Value result = dr::fmadd(dr::fmadd(dr::fmadd(c.x(), t, c.y()), t, c.z()), t, c.w());
+
+    if (!Extrapolate)
+        return dr::select(mask_valid, result, dr::zeros<Value>());
+    else
+        return result;
+}
+
 /**
  * \brief Computes a prefix sum of integrals over segments of a \a uniformly
  * sampled 1D Catmull-Rom spline interpolant
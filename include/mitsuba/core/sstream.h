@@ -0,0 +1,102 @@
+#pragma once
+
+#include <mitsuba/core/stream.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/** \brief \ref Stream implementation backed by a TCP socket
+ *
+ * Socket streams are not seekable: \ref seek() and \ref truncate() throw, and
+ * \ref tell() and \ref size() report the number of bytes transferred so far.
+ * Reads block until the requested amount of data has arrived and throw when
+ * the connection is closed by the peer.
+ */
+class MI_EXPORT_LIB SocketStream : public Stream {
+public:
+#if defined(_WIN32)
+    using Socket = uintptr_t;
+#else
+    using Socket = int;
+#endif
+
+    /// Wrap an already connected socket (ownership is transferred)
+    SocketStream(Socket socket);
+
+    /// Connect to the given host and port
+    SocketStream(const std::string &host, uint16_t port);
+
+    /// Return the address of the peer (e.g. for log messages)
+    const std::string &peer() const { return m_peer; }
+
+    /// Return the number of bytes received so far
+    size_t received_bytes() const { return m_received; }
+
+    /// Return the number of bytes sent so far
+    size_t sent_bytes() const { return m_sent; }
+
+    std::string to_string() const override;
+
+    // =========================================================================
+    //! @{ \name Implementation of the Stream interface
+    // =========================================================================
+
+    virtual void close() override;
+    virtual bool is_closed() const override { return m_closed; }
+    virtual void read(void *p, size_t size) override;
+    virtual void write(const void *p, size_t size) override;
+    virtual void seek(size_t pos) override;
+    virtual void truncate(size_t size) override;
+    virtual size_t tell() const override { return m_received + m_sent; }
+    virtual size_t size() const override { return m_received + m_sent; }
+    virtual void flush() override { /* Data is sent right away */ }
+    virtual bool can_write() const override { return !m_closed; }
+    virtual bool can_read() const override { return !m_closed; }
+
+    //! @}
+    // =========================================================================
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~SocketStream();
+
+protected:
+    Socket m_socket;
+    std::string m_peer;
+    size_t m_received = 0, m_sent = 0;
+    bool m_closed = false;
+};
+
+/// Listens on a TCP port and accepts incoming connections as \ref SocketStream instances
+class MI_EXPORT_LIB ServerSocket : public Object {
+public:
+    /**
+     * \brief Listen on the given port (0: pick any free port)
+     *
+     * By default, only connections from the local machine are accepted. Pass
+     * the address of a network interface (or \c "0.0.0.0" for all of them)
+     * to accept connections from other machines.
+     */
+    ServerSocket(uint16_t port, const std::string &address = "127.0.0.1");
+
+    /// Return the port the server listens on
+    uint16_t port() const { return m_port; }
+
+    /// Return the address the server listens on
+    const std::string &address() const { return m_address; }
+
+    /// Block until a client connects
+    ref<SocketStream> accept();
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~ServerSocket();
+
+protected:
+    SocketStream::Socket m_socket;
+    std::string m_address;
+    uint16_t m_port;
+};
+
+NAMESPACE_END(mitsuba)
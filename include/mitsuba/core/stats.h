@@ -0,0 +1,139 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <drjit/array_router.h>
+#include <atomic>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Event counters that are collected by the \ref Statistics subsystem
+enum class StatsCounter : uint32_t {
+    RayIntersect = 0,   /* Scene::ray_intersect[_preliminary]() */
+    RayTest,            /* Scene::ray_test() */
+    BSDFSample,         /* BSDF::sample() invocations by integrators */
+    EmitterSample,      /* Scene::sample_emitter_direction() */
+    NullCollision,      /* Null collisions sampled in participating media */
+
+    StatsCounterCount
+};
+
+constexpr const char
+    *stats_counter_id[uint32_t(StatsCounter::StatsCounterCount)] = {
+        "Rays (closest hit)",
+        "Rays (shadow)",
+        "BSDF samples",
+        "Emitter samples",
+        "Null collisions"
+    };
+
+/// Number of bins of the path length histogram (the last bin includes longer paths)
+constexpr uint32_t stats_path_length_bins = 32;
+
+/// Total number of counter slots (counters, followed by the histogram)
+constexpr uint32_t stats_slot_count =
+    uint32_t(StatsCounter::StatsCounterCount) + stats_path_length_bins;
+
+NAMESPACE_BEGIN(detail)
+/// Thread-local counters of scalar variants, padded to a cache line
+struct alignas(64) StatsBlock {
+    uint64_t values[stats_slot_count] { };
+};
+
+extern MI_EXPORT_LIB std::atomic<bool> stats_enabled;
+extern MI_EXPORT_LIB thread_local StatsBlock *stats_block;
+/// JIT variable indices of the device counters (LLVM, CUDA)
+extern MI_EXPORT_LIB uint32_t stats_jit_index[2];
+
+/// Allocate and register the counters of the calling thread
+extern MI_EXPORT_LIB StatsBlock *stats_register_thread();
+
+template <typename UInt32, typename Mask>
+void stats_add(const UInt32 &slot, const Mask &active) {
+    if constexpr (dr::is_jit_v<Mask>) {
+        using UInt64 = dr::uint64_array_t<dr::detached_t<UInt32>>;
+        uint32_t &index = stats_jit_index[dr::backend_v<Mask> == JitBackend::CUDA];
+        if (index == 0)
+            index = dr::zeros<UInt64>(stats_slot_count).release();
+
+        // The counters are updated by atomic operations within the kernel
+        UInt64 counters = UInt64::steal(index);
+        dr::scatter_reduce(ReduceOp::Add, counters, UInt64(1),
+                           dr::detach(slot), dr::detach(active));
+        index = counters.release();
+    } else {
+        StatsBlock *block = stats_block;
+        if (unlikely(!block))
+            block = stats_register_thread();
+        if constexpr (dr::is_array_v<Mask>) {
+            for (size_t i = 0; i < dr::width(active); ++i)
+                block->values[slot.entry(i)] += active.entry(i) ? 1 : 0;
+        } else {
+            block->values[slot] += active ? 1 : 0;
+        }
+    }
+}
+NAMESPACE_END(detail)
+
+/**
+ * \brief Count the lanes of \c active in the given statistics counter
+ *
+ * This function does nothing unless statistics were enabled via \ref
+ * Statistics::set_enabled(). In JIT variants, the test happens while tracing,
+ * and the counting adds an atomic operation to the generated kernel.
+ */
+template <typename Mask>
+MI_INLINE void stats_count(StatsCounter counter, const Mask &active) {
+    if (likely(!detail::stats_enabled.load(std::memory_order_relaxed)))
+        return;
+    using UInt32 = dr::uint32_array_t<Mask>;
+    detail::stats_add(UInt32((uint32_t) counter), active);
+}
+
+/// Record the final length of the paths in \c active in the path length histogram
+template <typename UInt32, typename Mask>
+MI_INLINE void stats_path_length(const UInt32 &depth, const Mask &active) {
+    if (likely(!detail::stats_enabled.load(std::memory_order_relaxed)))
+        return;
+    detail::stats_add(dr::minimum(depth, stats_path_length_bins - 1) +
+                          (uint32_t) StatsCounter::StatsCounterCount,
+                      active);
+}
+
+/**
+ * \brief Opt-in render statistics
+ *
+ * Collects the number of traced rays, BSDF and emitter samples, null
+ * collisions, and a histogram of path lengths. Scalar variants increment
+ * thread-local counters (padded to avoid false sharing) and JIT variants
+ * accumulate the counts on the device via atomic scatter-reductions, which
+ * are only read back when the statistics are queried.
+ */
+class MI_EXPORT_LIB Statistics {
+public:
+    /// Enable or disable the collection of statistics (disabled by default)
+    static void set_enabled(bool enabled);
+
+    /// Is the collection of statistics currently enabled?
+    static bool enabled() { return detail::stats_enabled; }
+
+    /// Return the current value of a counter (summed over threads and backends)
+    static uint64_t value(StatsCounter counter);
+
+    /// Return the path length histogram (one entry per path length)
+    static std::vector<uint64_t> path_length_histogram();
+
+    /// Return the time in milliseconds since the last call to \ref reset()
+    static float elapsed();
+
+    /// Reset all counters to zero
+    static void reset();
+
+    /// Return a human-readable summary of the collected statistics
+    static std::string to_string();
+
+    /// Free the device counters (called on shutdown)
+    static void static_shutdown();
+};
+
+NAMESPACE_END(mitsuba)
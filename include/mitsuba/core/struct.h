@@ -428,6 +428,37 @@ protected:
     bool load(const uint8_t *src, const Struct::Field &f, Value &value) const;
     void linearize(Value &value) const;
     void save(uint8_t *dst, const Struct::Field &f, Value value, size_t x, size_t y) const;
+
+    /**
+     * \brief Precompiled operation of the fast conversion path
+     *
+     * Conversions that only permute fields (possibly with a change of byte
+     * order), or that expand 8-bit channels into floating point values, are
+     * compiled into a list of such operations when the converter is created.
+     * These are then applied to blocks of records using specialized loops
+     * instead of interpreting the field descriptors per record.
+     */
+    struct FastOp {
+        enum class Kind : uint32_t {
+            /// Copy \c size bytes
+            Copy,
+            /// Copy \c size bytes while swapping the byte order of each word
+            Swap16, Swap32, Swap64,
+            /// Look up an 8-bit value in \ref m_fast_lut and store it as a float/double
+            UInt8ToFloat32, UInt8ToFloat64
+        };
+
+        Kind kind;
+        uint32_t src_offset, dst_offset, size;
+        /// Offset of the 256-entry table within \ref m_fast_lut
+        uint32_t lut_offset;
+    };
+
+    /// Compile \ref m_fast_ops when the conversion admits the fast path
+    void build_fast_path();
+
+    /// Convert \c count records using the operations in \ref m_fast_ops
+    void convert_fast(size_t count, const uint8_t *src, uint8_t *dest) const;
 #endif
 
 protected:
@@ -437,6 +468,10 @@ protected:
     FuncType m_func;
 #else
     bool m_dither;
+    /// Can the conversion use the precompiled fast path?
+    bool m_fast = false;
+    std::vector<FastOp> m_fast_ops;
+    std::vector<float> m_fast_lut;
 #endif
 };
 
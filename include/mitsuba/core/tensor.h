@@ -2,6 +2,8 @@
 
 #include <mitsuba/core/mmap.h>
 #include <mitsuba/core/struct.h>
+#include <drjit/dynamic.h>
+#include <drjit/jit.h>
 #include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -10,10 +12,22 @@ NAMESPACE_BEGIN(mitsuba)
  * \brief Simple exchange format for tensor data of arbitrary rank and size
  *
  * This class provides convenient memory-mapped read-only access to tensor
- * data, usually exported from NumPy.
+ * data, usually exported from NumPy. Files are created using \ref write(),
+ * which places every field at an offset that is a multiple of \ref Alignment
+ * and can optionally compress individual fields.
+ *
+ * Uncompressed fields directly reference the mapped file, hence tables with
+ * precomputed data (e.g. lookup tables or cached distributions) load without
+ * parsing or copying, and \ref array() can even expose them as Dr.Jit arrays
+ * without a copy in scalar and LLVM variants. Compressed fields are inflated
+ * into memory owned by the \c TensorFile when the file is opened.
+ *
+ * Version 1.0 files (without compression) remain readable.
  */
 class MI_EXPORT_LIB TensorFile : public MemoryMappedFile {
 public:
+    /// Alignment of the fields written by \ref write() (in bytes)
+    static constexpr size_t Alignment = 64;
 
     /// Information about the specified field
     struct Field {
@@ -28,6 +42,17 @@ public:
 
         /// Const pointer to the start of the tensor
         const void *data;
+
+        /// Is the field stored in compressed form within the file?
+        bool compressed = false;
+
+        /// Return the number of entries of the tensor
+        size_t size() const {
+            size_t result = 1;
+            for (size_t s : shape)
+                result *= s;
+            return result;
+        }
     };
 
     /// Map the specified file into memory
@@ -39,6 +64,60 @@ public:
     /// Return a data structure with information about the specified field
     const Field &field(const std::string &name) const;
 
+    /// Return the names of all fields (in sorted order)
+    std::vector<std::string> field_names() const;
+
+    /**
+     * \brief Return the contents of a field as a flat Dr.Jit array
+     *
+     * The scalar type of \c Array must match the type of the field. In
+     * scalar and LLVM variants, the returned array references the data of the
+     * field without copying it (in LLVM variants, it also keeps the
+     * \c TensorFile alive, while scalar arrays must not outlive it). CUDA
+     * variants copy the data to the device.
+     */
+    template <typename Array> Array array(const std::string &name) const {
+        using Scalar = dr::scalar_t<Array>;
+        const Field &f = field(name);
+        if (f.dtype != struct_type_v<Scalar>)
+            Throw("TensorFile: field \"%s\" has type %s, expected %s!", name,
+                  f.dtype, struct_type_v<Scalar>);
+
+        if constexpr (!dr::is_cuda_v<Array>) {
+            if ((uintptr_t) f.data % Alignment == 0) {
+                Array result = dr::map<Array>((void *) f.data, f.size(), false);
+
+                if constexpr (dr::is_jit_v<Array>) {
+                    // Release the file once the mapped variable is freed
+                    inc_ref();
+                    jit_var_set_callback(
+                        result.index(),
+                        [](uint32_t /* index */, int free, void *payload) {
+                            if (free)
+                                ((const TensorFile *) payload)->dec_ref();
+                        },
+                        (void *) this);
+                }
+
+                return result;
+            }
+        }
+
+        return dr::load<Array>(f.data, f.size());
+    }
+
+    /**
+     * \brief Write a tensor file with the given fields
+     *
+     * Only the name, type, shape, data pointer and the \c compressed flag of
+     * the fields are used. Compressed fields are stored as raw deflate
+     * streams with the given zlib compression level, which reduces the size
+     * of the file but requires an inflated copy when it is opened.
+     */
+    static void write(const fs::path &filename,
+                      const std::vector<std::pair<std::string, Field>> &fields,
+                      int compression_level = -1);
+
     /// Return a human-readable summary
     std::string to_string() const override;
 
@@ -49,6 +128,9 @@ protected:
 
 private:
     std::unordered_map<std::string, Field> m_fields;
+
+    /// Storage of the inflated compressed fields
+    std::vector<std::unique_ptr<uint8_t[]>> m_buffers;
 };
 
 NAMESPACE_END(mitsuba)
@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/object.h>
 #include <memory>
+#include <vector>
 
 extern "C" { struct Task; };
 
@@ -18,7 +19,8 @@ NAMESPACE_BEGIN(mitsuba)
 class MI_EXPORT_LIB Thread : public Object {
 public:
 
-    friend class ScopedThreadEnvironment;
+    friend class ThreadEnvironment;
+    friend class ScopedSetThreadEnvironment;
 
     /// Possible priority values for \ref Thread::set_priority()
     enum EPriority {
@@ -159,6 +161,15 @@ public:
     /// Wait for previously registered nanothread tasks to complete
     static void wait_for_tasks();
 
+    /**
+     * \brief Return the logical processor cores of each NUMA node
+     *
+     * On Linux, the topology is read from <tt>/sys/devices/system/node</tt>.
+     * On other platforms (or when this information is unavailable), a single
+     * node containing all cores is reported.
+     */
+    static const std::vector<std::vector<uint32_t>> &numa_nodes();
+
     MI_DECLARE_CLASS()
 protected:
     /// Protected destructor
@@ -184,6 +195,11 @@ private:
 /**
  * \brief Captures a thread environment (logger and file resolver).
  * Used with \ref ScopedSetThreadEnvironment
+ *
+ * Every captured environment carries a generation number that identifies the
+ * logger/file resolver pair, which is shared with the thread it was captured
+ * from and with the threads it is installed on. Changing the logger or file
+ * resolver of a thread invalidates its generation.
  */
 class MI_EXPORT_LIB ThreadEnvironment {
     friend class ScopedSetThreadEnvironment;
@@ -195,9 +211,17 @@ public:
 private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
+    uint64_t m_generation;
 };
 
-/// RAII-style class to temporarily switch to another thread's logger/file resolver
+/**
+ * \brief RAII-style class to temporarily switch to another thread's logger/file
+ * resolver
+ *
+ * Nothing is swapped (and no reference counts change) when the calling thread
+ * already uses the given environment. Otherwise, the previous logger and file
+ * resolver are restored by the destructor.
+ */
 class MI_EXPORT_LIB ScopedSetThreadEnvironment {
 public:
     ScopedSetThreadEnvironment(ThreadEnvironment &env);
@@ -207,8 +231,30 @@ public:
     ScopedSetThreadEnvironment& operator=(const ScopedSetThreadEnvironment &) = delete;
 
 private:
+    Thread *m_thread = nullptr;
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
+    uint64_t m_generation = 0;
+};
+
+/**
+ * \brief RAII-style class to temporarily restrict the calling thread to the
+ * cores of a NUMA node (see \ref Thread::numa_nodes())
+ *
+ * The previous affinity mask is restored by the destructor. This class has no
+ * effect on platforms other than Linux.
+ */
+class MI_EXPORT_LIB ScopedNumaAffinity {
+public:
+    ScopedNumaAffinity(uint32_t node);
+    ~ScopedNumaAffinity();
+
+    ScopedNumaAffinity(const ScopedNumaAffinity &) = delete;
+    ScopedNumaAffinity& operator=(const ScopedNumaAffinity &) = delete;
+
+private:
+    /// Affinity mask of the thread before the constructor was called
+    void *m_previous = nullptr;
 };
 
 NAMESPACE_END(mitsuba)
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/bitmap.h>
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Mip-mapped image that is split into square tiles, which are loaded
+ * lazily through the global \ref TileCache
+ *
+ * Tiled OpenEXR files are read tile by tile on demand, using the mip levels
+ * stored in the file when available. Other images (and scanline OpenEXR
+ * files) are loaded once in full resolution and only their coarser mip
+ * levels are cached. Missing mip levels are generated on demand by box
+ * filtering the next finer level.
+ *
+ * Pixel data is stored in single precision with 1 (luminance) or 3 (RGB)
+ * channels. Bitmaps are converted into linear space unless \c raw is set.
+ */
+class MI_EXPORT_LIB TiledImage : public Object {
+public:
+    using Float = float;
+    MI_IMPORT_CORE_TYPES()
+
+    /// Wrap modes supported by \ref eval()
+    enum class WrapMode : uint32_t { Repeat, Mirror, Clamp };
+
+    /// A square block of pixels, possibly smaller near the image boundary
+    struct Tile {
+        ScalarVector2u size;
+        std::unique_ptr<float[]> data;
+    };
+
+    /**
+     * \brief Open an image file
+     *
+     * \param tile_size
+     *     Tile resolution used when the file does not specify one
+     */
+    TiledImage(const fs::path &filename, bool raw = false,
+               uint32_t tile_size = 64);
+
+    /// Return the resolution of the given mip level
+    ScalarVector2u size(uint32_t level = 0) const { return m_levels[level].size; }
+
+    /// Return the number of mip levels
+    uint32_t level_count() const { return (uint32_t) m_levels.size(); }
+
+    /// Return the number of channels (1 or 3)
+    uint32_t channel_count() const { return m_channel_count; }
+
+    /// Return the tile resolution
+    uint32_t tile_size() const { return m_tile_size; }
+
+    /// Is the file read tile by tile (i.e. is it a tiled OpenEXR file)?
+    bool is_tiled() const { return m_exr_tiled; }
+
+    /// Return the filename of the underlying image
+    const fs::path &filename() const { return m_filename; }
+
+    /**
+     * \brief Return a tile, loading it through the cache if needed
+     *
+     * The returned reference keeps the tile alive even if it is evicted from
+     * the cache in the meantime.
+     */
+    std::shared_ptr<const Tile> tile(uint32_t level, uint32_t tx,
+                                     uint32_t ty) const;
+
+    /// Look up a single pixel (after wrapping the coordinates) of a mip level
+    void fetch(uint32_t level, int32_t x, int32_t y, WrapMode wrap,
+               float *out) const;
+
+    /**
+     * \brief Evaluate the image at the given UV position
+     *
+     * \param lod
+     *     Fractional mip level; two levels are blended when it is not integer
+     *
+     * \param bilinear
+     *     Interpolate bilinearly within a level (nearest neighbor otherwise)
+     *
+     * \param out
+     *     Receives \ref channel_count() values
+     */
+    void eval(const ScalarPoint2f &uv, float lod, WrapMode wrap,
+              bool bilinear, float *out) const;
+
+    /// Return the average value of the image (computed from the coarsest level)
+    void mean(float *out) const;
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~TiledImage();
+
+    /// Load the pixels of a tile (called by the cache on a miss)
+    std::shared_ptr<Tile> load_tile(uint32_t level, uint32_t tx, uint32_t ty) const;
+
+    /// Generate a tile of a mip level that is not stored in the file
+    void downsample_tile(uint32_t level, uint32_t tx, uint32_t ty, Tile &tile) const;
+
+    /// Wrap a pixel coordinate into [0, size)
+    static int32_t wrap_coord(int32_t x, int32_t size, WrapMode wrap);
+
+protected:
+    struct Level {
+        ScalarVector2u size;
+        ScalarVector2u tile_count;
+        /// Is the level stored in the file?
+        bool stored;
+    };
+
+    fs::path m_filename;
+    std::vector<Level> m_levels;
+    uint32_t m_channel_count;
+    uint32_t m_tile_size;
+    uint32_t m_id;
+
+    /// Tiled OpenEXR input (opaque, guarded by \c m_file_mutex)
+    bool m_exr_tiled = false;
+    std::vector<std::string> m_exr_channels;
+    void *m_exr_file = nullptr;
+    mutable std::mutex m_file_mutex;
+
+    /// Full-resolution pixels for non-tiled images
+    ref<Bitmap> m_bitmap;
+};
+
+/**
+ * \brief Global least-recently-used cache of image tiles, shared by all
+ * \ref TiledImage instances
+ *
+ * The cache evicts tiles once their total size exceeds a memory budget.
+ * Every thread additionally keeps a small direct-mapped table of recently
+ * used tiles, so that repeated lookups of the same tiles do not need to take
+ * the global lock. These per-thread references keep evicted tiles alive
+ * until they are replaced, so the resident size can temporarily exceed the
+ * budget by a few tiles per thread.
+ */
+class MI_EXPORT_LIB TileCache : public Object {
+public:
+    using Tile = TiledImage::Tile;
+
+    /// Return the global tile cache
+    static TileCache *instance();
+
+    /// Set the memory budget in bytes (default: 1 GiB)
+    void set_memory_budget(size_t bytes);
+
+    /// Return the memory budget in bytes
+    size_t memory_budget() const { return m_budget; }
+
+    /// Return the size of the tiles currently held by the cache
+    size_t memory_usage() const { return m_usage; }
+
+    /// Return the number of lookups that found their tile in the cache
+    size_t hits() const { return m_hits; }
+
+    /// Return the number of lookups that needed to load a tile
+    size_t misses() const { return m_misses; }
+
+    /// Return the number of tiles evicted so far
+    size_t evictions() const { return m_evictions; }
+
+    /// Release all tiles
+    void clear();
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    friend class TiledImage;
+
+    TileCache();
+    virtual ~TileCache();
+
+    /// Look up a tile, invoking \c image->load_tile() on a miss
+    std::shared_ptr<const Tile> lookup(const TiledImage *image, uint32_t level,
+                                       uint32_t tx, uint32_t ty);
+
+    /// Drop all tiles belonging to an image
+    void release(uint32_t image_id);
+
+    /// Evict tiles until the budget is met (caller holds \c m_mutex)
+    void evict();
+
+    /// Allocate a unique image identifier
+    uint32_t next_id() { return m_next_id++; }
+
+protected:
+    struct Entry;
+    struct State;
+    std::unique_ptr<State> m_state;
+    std::mutex m_mutex;
+    size_t m_budget;
+    std::atomic<size_t> m_usage { 0 }, m_hits { 0 }, m_misses { 0 },
+        m_evictions { 0 };
+    std::atomic<uint32_t> m_next_id { 1 };
+    /// Incremented by \ref clear() and \ref release() to invalidate per-thread tables
+    std::atomic<uint32_t> m_generation { 0 };
+};
+
+NAMESPACE_END(mitsuba)
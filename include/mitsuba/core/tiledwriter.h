@@ -0,0 +1,93 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/struct.h>
+#include <mitsuba/core/vector.h>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Incrementally writes a tiled OpenEXR file
+ *
+ * Tiles can be written in any order and from multiple threads, which allows
+ * producing very large images without keeping them in memory. The file is
+ * only valid once every tile has been written and \ref close() was called
+ * (missing tiles are filled with zeros at this point).
+ */
+class MI_EXPORT_LIB TiledEXRWriter : public Object {
+public:
+    using ScalarVector2u = Vector<uint32_t, 2>;
+
+    /**
+     * \brief Create a new tiled OpenEXR file
+     *
+     * \param size
+     *     Resolution of the image
+     *
+     * \param tile_size
+     *     Width and height of the (square) tiles
+     *
+     * \param channel_names
+     *     Names of the channels stored in the file
+     *
+     * \param component_format
+     *     Component format used in the file (\c Float16, \c Float32 or
+     *     \c UInt32)
+     */
+    TiledEXRWriter(const fs::path &filename, const ScalarVector2u &size,
+                   uint32_t tile_size,
+                   const std::vector<std::string> &channel_names,
+                   Struct::Type component_format);
+
+    /// Return the resolution of the image
+    const ScalarVector2u &size() const { return m_size; }
+
+    /// Return the tile resolution
+    uint32_t tile_size() const { return m_tile_size; }
+
+    /// Return the number of tiles along each axis
+    ScalarVector2u tile_count() const {
+        return (m_size + (m_tile_size - 1)) / m_tile_size;
+    }
+
+    /// Return the resolution of the given tile (smaller at the image boundary)
+    ScalarVector2u tile_extent(uint32_t tx, uint32_t ty) const;
+
+    /**
+     * \brief Write a tile
+     *
+     * \param data
+     *     Interleaved single precision pixel data of the tile, with
+     *     <tt>tile_extent(tx, ty)</tt> pixels and one component per channel
+     */
+    void write_tile(uint32_t tx, uint32_t ty, const float *data);
+
+    /// Fill the remaining tiles with zeros and close the file
+    void close();
+
+    /// Has \ref close() been called?
+    bool closed() const { return m_file == nullptr; }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~TiledEXRWriter();
+
+    /// Write a tile without acquiring the lock
+    void write_tile_locked(uint32_t tx, uint32_t ty, const float *data);
+
+protected:
+    fs::path m_filename;
+    ScalarVector2u m_size;
+    uint32_t m_tile_size;
+    std::vector<std::string> m_channel_names;
+    std::vector<bool> m_written;
+    /// Opaque Imf::TiledOutputFile (guarded by \c m_mutex)
+    void *m_file = nullptr;
+    std::mutex m_mutex;
+};
+
+NAMESPACE_END(mitsuba)
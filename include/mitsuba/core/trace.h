@@ -0,0 +1,100 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <atomic>
+#include <chrono>
+
+NAMESPACE_BEGIN(mitsuba)
+
+NAMESPACE_BEGIN(detail)
+/// A completed range of the timeline (names must be string literals)
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    uint64_t start, end;
+};
+
+extern MI_EXPORT_LIB std::atomic<bool> trace_enabled;
+
+/// Current time in nanoseconds (steady clock)
+MI_INLINE uint64_t trace_time() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Append a range that ends now to the buffer of the calling thread
+extern MI_EXPORT_LIB void trace_record(const char *name, const char *category,
+                                       uint64_t start);
+NAMESPACE_END(detail)
+
+/**
+ * \brief Opt-in recording of a timeline of the render
+ *
+ * While enabled, every \ref ScopedPhase and \ref ScopedTraceEvent appends the
+ * time range it covers to a buffer of the calling thread. The buffers are
+ * grown in fixed-size chunks that are only written by their owner, hence
+ * recording an event requires no locks or atomic read-modify-write operations.
+ * When recording is disabled, the cost is a single relaxed load per range.
+ *
+ * \ref write() exports the events in the Chrome trace event format, which can
+ * be viewed using <tt>chrome://tracing</tt> or Perfetto (one track per
+ * thread). Note that in JIT variants, the phases only cover the tracing of
+ * kernels and not their execution.
+ */
+class MI_EXPORT_LIB Trace {
+public:
+    /**
+     * \brief Start recording and discard previously recorded events
+     *
+     * Ranges shorter than \c min_duration (in microseconds) are dropped,
+     * which bounds the size of traces of scalar variants, where many phases
+     * cover a single ray. At most \c max_events events are kept.
+     *
+     * Must not be called while other threads are recording events.
+     */
+    static void start(float min_duration = 0.f, size_t max_events = 1u << 26);
+
+    /// Stop recording (the recorded events are kept until the next \ref start())
+    static void stop();
+
+    /// Is the recording of events currently enabled?
+    static bool enabled() { return detail::trace_enabled; }
+
+    /// Return the number of recorded and dropped events
+    static std::pair<size_t, size_t> event_count();
+
+    /// Write the recorded events to a JSON file in the Chrome trace event format
+    static void write(const fs::path &filename);
+
+    /// Free the recorded events (called on shutdown)
+    static void static_shutdown();
+};
+
+/**
+ * \brief Record the time range from the construction until the destruction of
+ * this object in the timeline of \ref Trace
+ *
+ * The name and category must be string literals (or otherwise outlive the
+ * trace), as only the pointers are stored.
+ */
+struct ScopedTraceEvent {
+    ScopedTraceEvent(const char *name, const char *category = "mitsuba")
+        : m_name(name), m_category(category),
+          m_start(detail::trace_enabled.load(std::memory_order_relaxed)
+                      ? detail::trace_time() : 0) { }
+
+    ~ScopedTraceEvent() {
+        if (unlikely(m_start))
+            detail::trace_record(m_name, m_category, m_start);
+    }
+
+    ScopedTraceEvent(const ScopedTraceEvent &) = delete;
+    ScopedTraceEvent &operator=(const ScopedTraceEvent &) = delete;
+
+private:
+    const char *m_name, *m_category;
+    uint64_t m_start;
+};
+
+NAMESPACE_END(mitsuba)
@@ -12,9 +12,26 @@ NAMESPACE_BEGIN(mitsuba)
  *
  * The main application of this class is to generate uniformly
  * distributed or weighted point sets in certain common target domains.
+ *
+ * The mappings that evaluate trigonometric functions take an optional \c Fast
+ * template parameter, which replaces \c dr::sincos() by the polynomial
+ * approximations of \ref math::sincos_2pi_fast() and \ref
+ * math::sincos_quarter_pi() (absolute error below <tt>1e-6</tt>).
+ * \ref batch() applies a mapping to an array of samples using packets.
  */
 NAMESPACE_BEGIN(warp)
 
+NAMESPACE_BEGIN(detail)
+/// Sine and cosine of <tt>2*pi*u</tt>, using the fast approximation if requested
+template <typename Value, bool Fast>
+MI_INLINE std::pair<Value, Value> sincos_2pi(const Value &u) {
+    if constexpr (Fast)
+        return math::sincos_2pi_fast(u);
+    else
+        return dr::sincos(dr::TwoPi<Value> * u);
+}
+NAMESPACE_END(detail)
+
 // =======================================================================
 //! @{ \name Warping techniques that operate in the plane
 // =======================================================================
@@ -23,10 +40,10 @@ template <typename Value>
 Value circ(Value x) { return dr::safe_sqrt(dr::fnmadd(x, x, 1.f)); }
 
 /// Uniformly sample a vector on a 2D disk
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Point<Value, 2> square_to_uniform_disk(const Point<Value, 2> &sample) {
     Value r = dr::sqrt(sample.y());
-    auto [s, c] = dr::sincos(dr::TwoPi<Value> * sample.x());
+    auto [s, c] = detail::sincos_2pi<Value, Fast>(sample.x());
     return { c * r, s * r };
 }
 
@@ -50,7 +67,7 @@ MI_INLINE Value square_to_uniform_disk_pdf(const Point<Value, 2> &p) {
 // =======================================================================
 
 /// Low-distortion concentric square to disk mapping by Peter Shirley
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Point<Value, 2> square_to_uniform_disk_concentric(const Point<Value, 2> &sample) {
     using Mask   = dr::mask_t<Value>;
 
@@ -82,11 +99,21 @@ MI_INLINE Point<Value, 2> square_to_uniform_disk_concentric(const Point<Value, 2
           rp = dr::select(quadrant_1_or_3, x, y);
 
     Value phi = 0.25f * dr::Pi<Value> * rp / r;
-    dr::masked(phi, quadrant_1_or_3) = 0.5f * dr::Pi<Value> - phi;
-    dr::masked(phi, is_zero) = 0.f;
 
-    auto [s, c] = dr::sincos(phi);
-    return { r * c, r * s };
+    if constexpr (Fast) {
+        /* The angle lies in [-pi/4, pi/4] before the adjustment of quadrants
+           1 and 3, which swaps sine and cosine */
+        dr::masked(phi, is_zero) = 0.f;
+        auto [s, c] = math::sincos_quarter_pi(phi);
+        return { r * dr::select(quadrant_1_or_3, s, c),
+                 r * dr::select(quadrant_1_or_3, c, s) };
+    } else {
+        dr::masked(phi, quadrant_1_or_3) = 0.5f * dr::Pi<Value> - phi;
+        dr::masked(phi, is_zero) = 0.f;
+
+        auto [s, c] = dr::sincos(phi);
+        return { r * c, r * s };
+    }
 }
 
 /// Inverse of the mapping \ref square_to_uniform_disk_concentric
@@ -176,12 +203,11 @@ MI_INLINE Value square_to_uniform_triangle_pdf(const Point<Value, 2> &p) {
 // =======================================================================
 
 /// Sample a point on a 2D standard normal distribution. Internally uses the Box-Muller transformation
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Point<Value, 2> square_to_std_normal(const Point<Value, 2> &sample) {
-    Value r   = dr::sqrt(-2.f * dr::log(1.f - sample.x())),
-          phi = 2.f * dr::Pi<Value> * sample.y();
+    Value r = dr::sqrt(-2.f * dr::log(1.f - sample.x()));
 
-    auto [s, c] = dr::sincos(phi);
+    auto [s, c] = detail::sincos_2pi<Value, Fast>(sample.y());
     return { c * r, s * r };
 }
 
@@ -246,11 +272,11 @@ Value square_to_tent_pdf(const Point<Value, 2> &p_) {
 // =======================================================================
 
 /// Uniformly sample a vector on the unit sphere with respect to solid angles
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Vector<Value, 3> square_to_uniform_sphere(const Point<Value, 2> &sample) {
     Value z = dr::fnmadd(2.f, sample.y(), 1.f),
           r = circ(z);
-    auto [s, c] = dr::sincos(2.f * dr::Pi<Value> * sample.x());
+    auto [s, c] = detail::sincos_2pi<Value, Fast>(sample.x());
     return { r * c, r * s, z };
 }
 
@@ -278,7 +304,7 @@ MI_INLINE Value square_to_uniform_sphere_pdf(const Vector<Value, 3> &v) {
 // =======================================================================
 
 /// Uniformly sample a vector on the unit hemisphere with respect to solid angles
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Vector<Value, 3> square_to_uniform_hemisphere(const Point<Value, 2> &sample) {
 #if 0
     // Approach 1: warping method based on standard disk mapping
@@ -288,7 +314,7 @@ MI_INLINE Vector<Value, 3> square_to_uniform_hemisphere(const Point<Value, 2> &s
     return { c * tmp, s * tmp, z };
 #else
     // Approach 2: low-distortion warping technique based on concentric disk mapping
-    Point<Value, 2> p = square_to_uniform_disk_concentric(sample);
+    Point<Value, 2> p = square_to_uniform_disk_concentric<Value, Fast>(sample);
     Value z = 1.f - dr::squared_norm(p);
     p *= dr::sqrt(z + 1.f);
     return { p.x(), p.y(), z };
@@ -316,10 +342,10 @@ MI_INLINE Value square_to_uniform_hemisphere_pdf(const Vector<Value, 3> &v) {
 // =======================================================================
 
 /// Sample a cosine-weighted vector on the unit hemisphere with respect to solid angles
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Vector<Value, 3> square_to_cosine_hemisphere(const Point<Value, 2> &sample) {
     // Low-distortion warping technique based on concentric disk mapping
-    Point<Value, 2> p = square_to_uniform_disk_concentric(sample);
+    Point<Value, 2> p = square_to_uniform_disk_concentric<Value, Fast>(sample);
 
     // Guard against numerical imprecisions
     Value z = dr::safe_sqrt(1.f - dr::squared_norm(p));
@@ -430,6 +456,122 @@ square_to_bilinear_pdf(Value v00, Value v10, Value v01, Value v11,
 
 // =======================================================================
 
+namespace detail {
+    /// Internal angles of a spherical triangle with unit vertex directions
+    template <typename Vector3>
+    MI_INLINE auto spherical_triangle_angles(const Vector3 &a, const Vector3 &b,
+                                             const Vector3 &c) {
+        Vector3 n_ab = dr::normalize(dr::cross(a, b)),
+                n_bc = dr::normalize(dr::cross(b, c)),
+                n_ca = dr::normalize(dr::cross(c, a));
+
+        return std::make_tuple(dr::unit_angle(n_ab, -n_ca),
+                               dr::unit_angle(n_bc, -n_ab),
+                               dr::unit_angle(n_ca, -n_bc));
+    }
+}
+
+/**
+ * \brief Uniformly sample a direction within a spherical triangle
+ *
+ * The spherical triangle is specified by the unit vectors \c a, \c b, and
+ * \c c pointing towards its vertices. The implementation is based on Arvo's
+ * area-preserving parameterization: the first sample dimension selects a
+ * sub-triangle with a proportional solid angle, and the second one positions
+ * the sample along an arc through the vertex \c b.
+ *
+ * Returns the sampled direction and its density per unit solid angle, which
+ * is zero for degenerate triangles.
+ */
+template <typename Value>
+MI_INLINE std::pair<Vector<Value, 3>, Value>
+square_to_spherical_triangle(const Vector<Value, 3> &a, const Vector<Value, 3> &b,
+                             const Vector<Value, 3> &c, const Point<Value, 2> &sample) {
+    using Vector3 = Vector<Value, 3>;
+
+    auto [alpha, beta, gamma] = detail::spherical_triangle_angles(a, b, c);
+    Value solid_angle = alpha + beta + gamma - dr::Pi<Value>;
+
+    // Find the vertex c' on the arc 'ac' bounding a sub-triangle of the sampled area
+    auto [sin_alpha, cos_alpha] = dr::sincos(alpha);
+    auto [sin_area, cos_area] =
+        dr::sincos(dr::fmadd(sample.x(), solid_angle, dr::Pi<Value>));
+
+    Value sin_phi = sin_area * cos_alpha - cos_area * sin_alpha,
+          cos_phi = cos_area * cos_alpha + sin_area * sin_alpha,
+          k1 = cos_phi + cos_alpha,
+          k2 = sin_phi - sin_alpha * dr::dot(a, b);
+
+    Value cos_bp = (k2 + (k2 * cos_phi - k1 * sin_phi) * cos_alpha) /
+                   ((k2 * sin_phi + k1 * cos_phi) * sin_alpha);
+    cos_bp = dr::clamp(cos_bp, -1.f, 1.f);
+
+    Value sin_bp = dr::safe_sqrt(dr::fnmadd(cos_bp, cos_bp, 1.f));
+    Vector3 cp = cos_bp * a + sin_bp * dr::normalize(dr::fnmadd(a, dr::dot(c, a), c));
+
+    // Sample along the arc between 'b' and c'
+    Value cos_theta = dr::fnmadd(sample.y(), 1.f - dr::dot(cp, b), 1.f),
+          sin_theta = dr::safe_sqrt(dr::fnmadd(cos_theta, cos_theta, 1.f));
+
+    Vector3 d = cos_theta * b + sin_theta * dr::normalize(dr::fnmadd(b, dr::dot(cp, b), cp));
+
+    return { d, dr::select(solid_angle > 0.f, dr::rcp(solid_angle), 0.f) };
+}
+
+/// Inverse of \ref square_to_spherical_triangle
+template <typename Value>
+MI_INLINE std::pair<Point<Value, 2>, Value>
+spherical_triangle_to_square(const Vector<Value, 3> &a, const Vector<Value, 3> &b,
+                             const Vector<Value, 3> &c, const Vector<Value, 3> &d) {
+    using Vector3 = Vector<Value, 3>;
+
+    auto [alpha, beta, gamma] = detail::spherical_triangle_angles(a, b, c);
+    Value solid_angle = alpha + beta + gamma - dr::Pi<Value>;
+
+    // Vertex c' where the arc through 'b' and 'd' meets the arc 'ac'
+    Vector3 cp = dr::normalize(dr::cross(dr::cross(b, d), dr::cross(c, a)));
+    cp = dr::select(dr::dot(cp, a + c) < 0.f, -cp, cp);
+
+    // Solid angle of the sub-triangle (a, b, c')
+    Vector3 n_ab  = dr::normalize(dr::cross(a, b)),
+            n_cpb = dr::normalize(dr::cross(cp, b)),
+            n_acp = dr::normalize(dr::cross(a, cp));
+
+    Value sub_area = alpha + dr::unit_angle(n_ab, n_cpb) +
+                     dr::unit_angle(n_acp, -n_cpb) - dr::Pi<Value>;
+
+    Value u0 = dr::select(dr::dot(a, cp) > 0.99999847691f /* 0.1 deg */,
+                          0.f, sub_area / solid_angle),
+          u1 = (1.f - dr::dot(d, b)) / (1.f - dr::dot(cp, b));
+
+    Point<Value, 2> sample(dr::select(dr::isfinite(u0), u0, .5f),
+                           dr::select(dr::isfinite(u1), u1, .5f));
+
+    return { dr::clamp(sample, 0.f, 1.f),
+             dr::select(solid_angle > 0.f, dr::rcp(solid_angle), 0.f) };
+}
+
+/// Density of \ref square_to_spherical_triangle() with respect to solid angles
+template <typename Value>
+MI_INLINE Value
+square_to_spherical_triangle_pdf(const Vector<Value, 3> &a, const Vector<Value, 3> &b,
+                                 const Vector<Value, 3> &c, const Vector<Value, 3> &d) {
+    auto [alpha, beta, gamma] = detail::spherical_triangle_angles(a, b, c);
+    Value solid_angle = alpha + beta + gamma - dr::Pi<Value>;
+
+    // Is 'd' on the inner side of all three great circles?
+    Value orientation = dr::dot(a, dr::cross(b, c));
+    dr::mask_t<Value> inside =
+        dr::dot(d, dr::cross(a, b)) * orientation >= 0.f &&
+        dr::dot(d, dr::cross(b, c)) * orientation >= 0.f &&
+        dr::dot(d, dr::cross(c, a)) * orientation >= 0.f &&
+        solid_angle > 0.f;
+
+    return dr::select(inside, dr::rcp(solid_angle), 0.f);
+}
+
+// =======================================================================
+
 /**
  * \brief Uniformly sample a vector that lies within a given
  * cone of angles around the Z axis
@@ -437,7 +579,7 @@ square_to_bilinear_pdf(Value v00, Value v10, Value v01, Value v11,
  * \param cos_cutoff Cosine of the cutoff angle
  * \param sample A uniformly distributed sample on \f$[0,1]^2\f$
  */
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Vector<Value, 3> square_to_uniform_cone(const Point<Value, 2> &sample,
                                                    const Value &cos_cutoff) {
 #if 0
@@ -450,7 +592,7 @@ MI_INLINE Vector<Value, 3> square_to_uniform_cone(const Point<Value, 2> &sample,
 #else
     // Approach 2: low-distortion warping technique based on concentric disk mapping
     Value one_minus_cos_cutoff(1.f - cos_cutoff);
-    Point<Value, 2> p = square_to_uniform_disk_concentric(sample);
+    Point<Value, 2> p = square_to_uniform_disk_concentric<Value, Fast>(sample);
     Value pn = dr::squared_norm(p);
     Value z = cos_cutoff + one_minus_cos_cutoff * (1.f - pn);
     p *= dr::safe_sqrt(one_minus_cos_cutoff * (2.f - one_minus_cos_cutoff * pn));
@@ -487,7 +629,7 @@ MI_INLINE Value square_to_uniform_cone_pdf(const Vector<Value, 3> &v,
 // =======================================================================
 
 /// Warp a uniformly distributed square sample to a Beckmann distribution
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Vector<Value, 3> square_to_beckmann(const Point<Value, 2> &sample,
                                                const Value &alpha) {
 #if 0
@@ -501,7 +643,7 @@ MI_INLINE Vector<Value, 3> square_to_beckmann(const Point<Value, 2> &sample,
     return { sin_theta_m * c, sin_theta_m * s, cos_theta_m };
 #else
     // Approach 2: low-distortion warping technique based on concentric disk mapping
-    Point<Value, 2> p = square_to_uniform_disk_concentric(sample);
+    Point<Value, 2> p = square_to_uniform_disk_concentric<Value, Fast>(sample);
     Value r2 = dr::squared_norm(p);
 
     Value tan_theta_m_sqr = -dr::sqr(alpha) * dr::log(1.f - r2);
@@ -542,7 +684,7 @@ MI_INLINE Value square_to_beckmann_pdf(const Vector<Value, 3> &m,
 // =======================================================================
 
 /// Warp a uniformly distributed square sample to a von Mises Fisher distribution
-template <typename Value>
+template <typename Value, bool Fast = false>
 MI_INLINE Vector<Value, 3> square_to_von_mises_fisher(const Point<Value, 2> &sample,
                                                        const Value &kappa) {
 #if 1
@@ -561,12 +703,12 @@ MI_INLINE Vector<Value, 3> square_to_von_mises_fisher(const Point<Value, 2> &sam
             dr::log(dr::fmadd(1.f - sy, dr::exp(-2.f * kappa), sy)) / kappa;
 #endif
 
-    auto [s, c] = dr::sincos(dr::TwoPi<Value> * sample.x());
+    auto [s, c] = detail::sincos_2pi<Value, Fast>(sample.x());
     Value sin_theta = dr::safe_sqrt(1.f - dr::sqr(cos_theta));
     Vector<Value, 3> result = { c * sin_theta, s * sin_theta, cos_theta };
 #else
     // Approach 2: low-distortion warping technique based on concentric disk mapping
-    Point<Value, 2> p = square_to_uniform_disk_concentric(sample);
+    Point<Value, 2> p = square_to_uniform_disk_concentric<Value, Fast>(sample);
 
     Value r2 = dr::squared_norm(p),
           sy = dr::maximum(1.f - r2, 1e-6f),
@@ -577,7 +719,7 @@ MI_INLINE Vector<Value, 3> square_to_von_mises_fisher(const Point<Value, 2> &sam
     Vector<Value, 3> result = { p.x(), p.y(), cos_theta };
 #endif
 
-    dr::masked(result, dr::eq(kappa, 0.f)) = square_to_uniform_sphere(sample);
+    dr::masked(result, dr::eq(kappa, 0.f)) = square_to_uniform_sphere<Value, Fast>(sample);
 
     return result;
 }
@@ -703,5 +845,81 @@ Value square_to_rough_fiber_pdf(const Vector3 &v, const Vector3 &wi, const Vecto
 //! @}
 // =======================================================================
 
+// =======================================================================
+//! @{ \name Batched evaluation
+// =======================================================================
+
+NAMESPACE_BEGIN(detail)
+/// Write a scalar sample (or static array thereof) into lane \c k of a packet
+template <typename Packet, typename Value>
+MI_INLINE void batch_store_lane(Packet &p, size_t k, const Value &value) {
+    if constexpr (dr::is_array_v<Value>) {
+        for (size_t j = 0; j < dr::size_v<Value>; ++j)
+            p[j][k] = value[j];
+    } else {
+        p[k] = value;
+    }
+}
+
+/// Extract lane \c k of a packet as a scalar (or static array thereof)
+template <typename Value, typename Packet>
+MI_INLINE Value batch_load_lane(const Packet &p, size_t k) {
+    if constexpr (dr::is_array_v<Value>) {
+        Value value;
+        for (size_t j = 0; j < dr::size_v<Value>; ++j)
+            value[j] = p[j][k];
+        return value;
+    } else {
+        return p[k];
+    }
+}
+NAMESPACE_END(detail)
+
+/**
+ * \brief Apply a warping function to an array of samples using packets
+ *
+ * Scalar variants evaluate the mappings of this namespace one sample at a
+ * time. When many samples are warped at once, this function instead gathers
+ * groups of \c Width samples into packets, so that the mapping (including its
+ * transcendental functions) is evaluated using SIMD instructions. The final
+ * partial group is padded with zero-valued samples.
+ *
+ * \param func
+ *     Function mapping a packet of samples to a packet of results,
+ *     e.g. <tt>[](const Point2fP &s) { return warp::square_to_cosine_hemisphere<FloatP, true>(s); }</tt>
+ * \param in
+ *     Array of \c count input samples (scalars or static arrays of scalars)
+ * \param out
+ *     Array of \c count results (scalars or static arrays of scalars)
+ * \param count
+ *     Number of samples
+ */
+template <size_t Width = 16, typename Func, typename Input, typename Output>
+void batch(const Func &func, const Input *in, Output *out, size_t count) {
+    using Scalar  = dr::scalar_t<Input>;
+    using FloatP  = dr::Packet<Scalar, Width>;
+    using InputP  = dr::replace_scalar_t<Input, FloatP>;
+    using OutputP = std::decay_t<decltype(func(std::declval<const InputP &>()))>;
+    static_assert(std::is_same_v<dr::scalar_t<OutputP>, dr::scalar_t<Output>> &&
+                  dr::size_v<OutputP> == (dr::is_array_v<Output> ? dr::size_v<Output> : Width),
+                  "warp::batch(): the function result does not match the output type!");
+
+    for (size_t i = 0; i < count; i += Width) {
+        size_t n = std::min(Width, count - i);
+
+        InputP p = dr::zeros<InputP>();
+        for (size_t k = 0; k < n; ++k)
+            detail::batch_store_lane(p, k, in[i + k]);
+
+        OutputP result = func(p);
+
+        for (size_t k = 0; k < n; ++k)
+            out[i + k] = detail::batch_load_lane<Output>(result, k);
+    }
+}
+
+//! @}
+// =======================================================================
+
 NAMESPACE_END(warp)
 NAMESPACE_END(mitsuba)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/stream.h>
+#include <vector>
 
 extern "C" {
     struct z_stream_s;
@@ -134,4 +135,149 @@ private:
     bool m_did_write;
 };
 
+/**
+ * \brief Block-parallel compression/decompression stream based on \c zlib.
+ *
+ * In contrast to \ref ZStream, which compresses the data as a single
+ * sequential \c DEFLATE stream, this class splits the data into blocks
+ * (1 MiB by default) that are compressed independently. Reading and writing
+ * thus processes batches of blocks in parallel using the thread pool, which
+ * lifts the single-core throughput limit of \c zlib.
+ *
+ * The encoding is a sequence of frames, each consisting of the uncompressed
+ * and compressed block size (\c uint32, in the byte order of the child
+ * stream) followed by the block in \c zlib format. A frame whose sizes are
+ * both zero marks the end of the stream.
+ */
+class MI_EXPORT_LIB BlockZStream : public Stream {
+public:
+    using Stream::read;
+    using Stream::write;
+
+    /** \brief Creates a new block compression stream with the given
+     * underlying stream. This new instance takes ownership of the child
+     * stream.
+     *
+     * \param level
+     *    Compression level of \c zlib (-1: default)
+     *
+     * \param block_size
+     *    Size of the (uncompressed) blocks that are compressed independently
+     */
+    BlockZStream(Stream *child_stream, int level = -1,
+                 size_t block_size = 1024 * 1024);
+
+    /// Returns a string representation
+    std::string to_string() const override;
+
+    /** \brief Closes the stream, but not the underlying child stream.
+     * No further read or write operations are permitted.
+     *
+     * When data was written, this compresses the buffered blocks and adds the
+     * end-of-stream marker. This function is idempotent. It is called
+     * automatically by the destructor.
+     */
+    virtual void close() override;
+
+    /// Whether the stream is closed (no read or write are then permitted).
+    virtual bool is_closed() const override { return !m_child_stream || m_child_stream->is_closed(); };
+
+    /// Returns the child stream of this compression stream
+    const Stream *child_stream() const { return m_child_stream.get(); }
+
+    /// Returns the child stream of this compression stream
+    Stream *child_stream() { return m_child_stream; }
+
+    /**
+     * \brief Compress a single block of memory in \c zlib format
+     *
+     * This function is thread-safe and can be used to build other
+     * block-compressed formats.
+     *
+     * \param level
+     *    Compression level of \c zlib (-1: default)
+     */
+    static std::vector<uint8_t> compress_block(const void *data, size_t size,
+                                               int level = -1);
+
+    /**
+     * \brief Decompress a block created by \ref compress_block() into a
+     * buffer, whose size must match the size of the uncompressed block
+     */
+    static void decompress_block(const void *data, size_t size, void *out,
+                                 size_t out_size);
+
+    /**
+     * \brief Reads a specified amount of data from the stream, decompressing
+     * batches of blocks in parallel.
+     * Throws an exception when the stream ended prematurely.
+     */
+    virtual void read(void *p, size_t size) override;
+
+    /**
+     * \brief Writes a specified amount of data into the stream. Full batches
+     * of blocks are compressed in parallel.
+     */
+    virtual void write(const void *p, size_t size) override;
+
+    /// Compresses and writes all buffered data (ends the current block)
+    virtual void flush() override;
+
+    /// Unsupported. Always throws.
+    virtual void seek(size_t) override {
+        Throw("seek(): unsupported in a block-compressed stream!");
+    }
+
+    //// Unsupported. Always throws.
+    virtual void truncate(size_t) override {
+        Throw("truncate(): unsupported in a block-compressed stream!");
+    }
+
+    /// Unsupported. Always throws.
+    virtual size_t tell() const override {
+        Throw("tell(): unsupported in a block-compressed stream!");
+        return 0;
+    }
+
+    /// Unsupported. Always throws.
+    virtual size_t size() const override {
+        Throw("size(): unsupported in a block-compressed stream!");
+        return 0;
+    }
+
+    /// Can we write to the stream?
+    virtual bool can_write() const override {
+        return m_child_stream->can_write();
+    }
+
+    /// Can we read from the stream?
+    virtual bool can_read() const override {
+        return m_child_stream->can_read();
+    }
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Protected destructor
+    virtual ~BlockZStream();
+
+    /// Compress the buffered data and write it to the child stream
+    void write_blocks();
+
+    /// Read and decompress the next batch of blocks
+    void read_blocks();
+
+private:
+    ref<Stream> m_child_stream;
+    int m_level;
+    size_t m_block_size;
+    /// Number of blocks that are processed in parallel
+    size_t m_batch_size;
+    /// Uncompressed data (pending writes, or decompressed blocks)
+    std::vector<uint8_t> m_buffer;
+    /// Read position within \ref m_buffer
+    size_t m_buffer_pos = 0;
+    bool m_did_write = false;
+    bool m_end_of_stream = false;
+};
+
 NAMESPACE_END(mitsuba)
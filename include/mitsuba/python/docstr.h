@@ -237,6 +237,16 @@ static const char *__doc_OptixInstance_traversableHandle = R"doc()doc";
 
 static const char *__doc_OptixInstance_visibilityMask = R"doc()doc";
 
+static const char *__doc_OptixMatrixMotionTransform = R"doc()doc";
+
+static const char *__doc_OptixMatrixMotionTransform_child = R"doc()doc";
+
+static const char *__doc_OptixMatrixMotionTransform_motionOptions = R"doc()doc";
+
+static const char *__doc_OptixMatrixMotionTransform_pad = R"doc()doc";
+
+static const char *__doc_OptixMatrixMotionTransform_transform = R"doc()doc";
+
 static const char *__doc_OptixModuleCompileOptions = R"doc()doc";
 
 static const char *__doc_OptixModuleCompileOptions_boundValues = R"doc()doc";
@@ -365,6 +375,14 @@ static const char *__doc_SbtRecord_header = R"doc()doc";
 
 static const char *__doc_drjit_operator_lshift = R"doc(Prints the canonical representation of a PCG32 object.)doc";
 
+static const char *__doc_mitsuba_AccelStats =
+R"doc(Summary of the ray tracing acceleration data structure of a scene
+(see Scene::accel_stats())
+
+Statistics that a backend does not expose are zero (counts) or NaN
+(SAH cost). Embree and OptiX do not report their node counts and SAH
+costs.)doc";
+
 static const char *__doc_mitsuba_AdjointIntegrator =
 R"doc(Abstract adjoint integrator that performs Monte Carlo sampling
 starting from the emitters.
@@ -426,6 +444,151 @@ Parameter ``sample_scale``:
     A scale factor that must be applied to each sample to account for
     the film resolution and number of samples.)doc";
 
+static const char *__doc_mitsuba_AliasDistribution =
+R"doc(Discrete 1D probability distribution based on the alias method
+
+This data structure provides the same interface as
+DiscreteDistribution, but it generates samples using an alias table
+constructed with Vose's algorithm. Sampling requires a constant number
+of memory lookups regardless of the number of entries (as opposed to
+the binary search over a CDF in DiscreteDistribution), which is
+beneficial for very large distributions, particularly on the GPU.
+
+Note that the mapping from uniform variates to indices is not
+monotonic, hence stratification of the input samples is not
+preserved.)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_AliasDistribution = R"doc(Create an uninitialized AliasDistribution instance)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_AliasDistribution_2 = R"doc(Initialize from a given probability mass function)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_AliasDistribution_3 = R"doc(Initialize from a given probability mass function (rvalue version))doc";
+
+static const char *__doc_mitsuba_AliasDistribution_AliasDistribution_4 = R"doc(Initialize from a given floating point array)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_compute_alias_table = R"doc(Construct the alias table using Vose's algorithm)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_empty = R"doc(Is the distribution object empty/uninitialized?)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_eval_pmf =
+R"doc(Evaluate the unnormalized probability mass function (PMF) at index
+``index``)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_eval_pmf_normalized =
+R"doc(Evaluate the normalized probability mass function (PMF) at index
+``index``)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_m_alias = R"doc()doc";
+
+static const char *__doc_mitsuba_AliasDistribution_m_normalization = R"doc()doc";
+
+static const char *__doc_mitsuba_AliasDistribution_m_pmf = R"doc()doc";
+
+static const char *__doc_mitsuba_AliasDistribution_m_sum = R"doc()doc";
+
+static const char *__doc_mitsuba_AliasDistribution_m_threshold = R"doc()doc";
+
+static const char *__doc_mitsuba_AliasDistribution_normalization = R"doc(Return the normalization factor (i.e. the inverse of sum()))doc";
+
+static const char *__doc_mitsuba_AliasDistribution_pmf = R"doc(Return the unnormalized probability mass function)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_pmf_2 = R"doc(Return the unnormalized probability mass function (const version))doc";
+
+static const char *__doc_mitsuba_AliasDistribution_sample =
+R"doc(%Transform a uniformly distributed sample to the stored distribution
+
+Parameter ``value``:
+    A uniformly distributed sample on the interval [0, 1].
+
+Returns:
+    The discrete index associated with the sample)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_sample_pmf =
+R"doc(%Transform a uniformly distributed sample to the stored distribution
+
+Parameter ``value``:
+    A uniformly distributed sample on the interval [0, 1].
+
+Returns:
+    A tuple consisting of
+
+1. the discrete index associated with the sample, and 2. the
+normalized probability value of the sample.)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_sample_reuse =
+R"doc(%Transform a uniformly distributed sample to the stored distribution
+
+The original sample is value adjusted so that it can be reused as a
+uniform variate.
+
+Parameter ``value``:
+    A uniformly distributed sample on the interval [0, 1].
+
+Returns:
+    A tuple consisting of
+
+1. the discrete index associated with the sample, and 2. the re-scaled
+sample value.)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_sample_reuse_pmf =
+R"doc(%Transform a uniformly distributed sample to the stored distribution.
+
+The original sample is value adjusted so that it can be reused as a
+uniform variate.
+
+Parameter ``value``:
+    A uniformly distributed sample on the interval [0, 1].
+
+Returns:
+    A tuple consisting of
+
+1. the discrete index associated with the sample 2. the re-scaled
+sample value 3. the normalized probability value of the sample)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_size = R"doc(Return the number of entries)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_sum = R"doc(Return the original sum of PMF entries before normalization)doc";
+
+static const char *__doc_mitsuba_AliasDistribution_update = R"doc(Update the internal state. Must be invoked when changing the pmf.)doc";
+
+static const char *__doc_mitsuba_Animation =
+R"doc(Keyframed animation of the parameters of a scene
+
+The keyframes are loaded from a text file with one keyframe per line,
+which specifies the frame number, the name of a parameter (following
+the naming convention of ``mitsuba.traverse()``, e.g.
+``sensor.to_world``), and its value at that frame. Scalar parameters
+take one value, 3D points, vectors and colors three values, and
+transformations either the 16 entries of a matrix (in row-major order)
+or the keyword ``look_at`` followed by the origin, target and up
+vector of Transform::look_at(). Lines starting with ``#`` are ignored.
+
+Between two keyframes, the values are interpolated linearly, and
+outside of the range of keyframes of a parameter, they remain
+constant. set_frame() writes the values of a frame into the scene and
+notifies the modified objects bottom-up like
+``SceneParameters.update()``.)doc";
+
+static const char *__doc_mitsuba_Animation_Animation =
+R"doc(Load the keyframes of ``filename`` and look up the animated parameters
+among those exposed by ``root`` (usually a scene))doc";
+
+static const char *__doc_mitsuba_Animation_Track = R"doc(Keyframes of a single parameter)doc";
+
+static const char *__doc_mitsuba_Animation_frame_range = R"doc(Return the first and last frame that has a keyframe)doc";
+
+static const char *__doc_mitsuba_Animation_parameters = R"doc(Return the names of the animated parameters)doc";
+
+static const char *__doc_mitsuba_Animation_set_frame =
+R"doc(Set all animated parameters to their (interpolated) value at the given
+frame and notify the objects that were modified)doc";
+
+static const char *__doc_mitsuba_Animation_to_string = R"doc(Return a human-readable representation of the animation)doc";
+
+static const char *__doc_mitsuba_Animation_write =
+R"doc(Write the value of a track at the given frame (returns ``False`` if
+the parameter already has this value))doc";
+
 static const char *__doc_mitsuba_Appender =
 R"doc(This class defines an abstract destination for logging-relevant
 information)doc";
@@ -882,6 +1045,16 @@ static const char *__doc_mitsuba_BSDF_flags = R"doc(Flags for all components com
 
 static const char *__doc_mitsuba_BSDF_flags_2 = R"doc(Flags for a specific component of this BSDF.)doc";
 
+static const char *__doc_mitsuba_BSDF_flatten =
+R"doc(Simplify the network of nested BSDFs rooted at this BSDF
+
+Adapter BSDFs (e.g. ``blendbsdf``, ``mask`` or ``twosided``) first
+flatten their nested BSDFs and then return the nested BSDF in place of
+themselves when they don't alter its response, e.g. a blend with a
+constant weight of zero or a fully opaque mask. Each removed layer
+saves one virtual function call per query. The default implementation
+returns the BSDF itself.)doc";
+
 static const char *__doc_mitsuba_BSDF_id = R"doc(Return a string identifier)doc";
 
 static const char *__doc_mitsuba_BSDF_m_components = R"doc(Flags for each component of this BSDF.)doc";
@@ -890,8 +1063,39 @@ static const char *__doc_mitsuba_BSDF_m_flags = R"doc(Combined flags for all com
 
 static const char *__doc_mitsuba_BSDF_m_id = R"doc(Identifier (if available))doc";
 
+static const char *__doc_mitsuba_BSDF_merge =
+R"doc(Merge several instances of this BSDF into a single one
+
+The returned BSDF behaves like ``instances[i]`` on the surface of
+every shape whose Shape::bsdf_index() is equal to ``i``, gathering the
+parameters of the instance from per-instance buffers. In the
+vectorized variants, this replaces many entries of the virtual
+function call table by one, so that lanes with different materials of
+the same type no longer evaluate separately.
+
+All instances must share the merge_key() of this BSDF. The function
+returns ``nullptr`` when merging isn't possible. The default
+implementation always does so.)doc";
+
+static const char *__doc_mitsuba_BSDF_merge_key =
+R"doc(Return a key that identifies the configuration of this BSDF which
+cannot vary between merged instances
+
+BSDFs of the same plugin with an identical (non-empty) key can be
+merged using merge(). The default implementation returns an empty
+string, i.e. the BSDF cannot be merged.)doc";
+
 static const char *__doc_mitsuba_BSDF_needs_differentials = R"doc(Does the implementation require access to texture-space differentials?)doc";
 
+static const char *__doc_mitsuba_BSDF_opacity_texture =
+R"doc(Return the texture that controls the opacity of the surface
+
+BSDFs that let light pass straight through the surface wherever this
+texture is zero (e.g. ``mask``) return it, so that ray tracing can
+skip the fully transparent regions during traversal instead of
+re-tracing rays from every null interaction (see
+Texture::zero_mask()). The default implementation returns ``nullptr``.)doc";
+
 static const char *__doc_mitsuba_BSDF_operator_delete = R"doc()doc";
 
 static const char *__doc_mitsuba_BSDF_operator_delete_2 = R"doc()doc";
@@ -926,6 +1130,17 @@ Parameter ``si``:
 Parameter ``wo``:
     The outgoing direction)doc";
 
+static const char *__doc_mitsuba_BSDF_ray_flags =
+R"doc(Return the fields of the surface interaction accessed by the BSDF as a
+combination of RayFlags (not counting nested textures)
+
+Scenes combine the flags of their BSDFs with the requirements of their
+textures to skip the computation of unused fields during ray
+intersections (see Scene::ray_flags()). The default implementation
+requests the shading frame, and additionally the UV coordinates and
+their position partials for anisotropic BSDFs (whose tangent follows
+dp_du) and BSDFs that need differentials.)doc";
+
 static const char *__doc_mitsuba_BSDF_sample =
 R"doc(Importance sample the BSDF model
 
@@ -986,6 +1201,77 @@ PNG and OpenEXR files are optionally annotated with string-valued
 metadata, and the gamma setting can be stored as well. Please see the
 class methods and enumerations for further detail.)doc";
 
+static const char *__doc_mitsuba_BitmapWriter =
+R"doc(Service that encodes and writes bitmaps on background threads
+
+Write requests are placed into a bounded queue that is processed by a
+fixed number of worker threads. When the queue is full, write() blocks
+until a worker takes on the next request. This provides back-pressure
+and bounds the memory held by images waiting to be written, e.g. when
+an animation with many AOVs per frame is rendered from Python.
+
+Bitmap::write_async(), Film::write_async(), and the command line
+renderer submit their images to the global instance returned by
+instance().)doc";
+
+static const char *__doc_mitsuba_BitmapWriterThread = R"doc(Worker thread of a BitmapWriter)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_BitmapWriter =
+R"doc(Create a new writer service
+
+Parameter ``worker_count``:
+    Number of worker threads that encode and write images
+
+Parameter ``queue_capacity``:
+    Maximum number of requests waiting in the queue (in addition to
+    the ones processed by the workers)
+
+Parameter ``quality``:
+    Quality or compression level that is used when a request
+    specifies the value -1 (see Bitmap::write() for the meaning of
+    this parameter for each file format))doc";
+
+static const char *__doc_mitsuba_BitmapWriter_Request = R"doc()doc";
+
+static const char *__doc_mitsuba_BitmapWriter_class = R"doc()doc";
+
+static const char *__doc_mitsuba_BitmapWriter_flush =
+R"doc(Wait until all submitted writes have completed
+
+Rethrows the first error that occurred since the previous call.)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_instance = R"doc(Return the global instance (created with default settings upon first use))doc";
+
+static const char *__doc_mitsuba_BitmapWriter_pending = R"doc(Return the number of requests that were submitted but have not completed yet)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_quality = R"doc(Return the default quality or compression level)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_queue_capacity = R"doc(Return the capacity of the queue)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_run_worker = R"doc(Main loop of the worker threads)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_set_instance =
+R"doc(Replace the global instance (e.g. to change the number of workers)
+
+The pending requests of the previous instance are completed first.)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_static_shutdown = R"doc(Complete the pending requests of the global instance and release it)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_to_string = R"doc()doc";
+
+static const char *__doc_mitsuba_BitmapWriter_worker_count = R"doc(Return the number of worker threads)doc";
+
+static const char *__doc_mitsuba_BitmapWriter_write =
+R"doc(Submit a bitmap for writing
+
+Blocks while the queue is full. The writer keeps a reference to the
+bitmap, whose contents must not be modified until the write has
+completed.
+
+Returns:
+    A future that completes once the file was written, and which
+    rethrows any error that occurred in the process)doc";
+
 static const char *__doc_mitsuba_Bitmap_AlphaTransform = R"doc(Type of alpha transformation)doc";
 
 static const char *__doc_mitsuba_Bitmap_AlphaTransform_Empty = R"doc(No transformation (default))doc";
@@ -1034,6 +1320,9 @@ Parameter ``format``:
 static const char *__doc_mitsuba_Bitmap_Bitmap_3 =
 R"doc(Load a bitmap from a given filename
 
+PFM and OpenEXR files are read from a read-only memory mapping of the
+file, which avoids intermediate copies of their pixel data.
+
 Parameter ``path``:
     Name of the file to be loaded
 
@@ -1044,6 +1333,32 @@ static const char *__doc_mitsuba_Bitmap_Bitmap_4 = R"doc(Copy constructor (copie
 
 static const char *__doc_mitsuba_Bitmap_Bitmap_5 = R"doc(Move constructor)doc";
 
+static const char *__doc_mitsuba_Bitmap_EXRCompression = R"doc(Compression method used when writing OpenEXR files)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_B44 = R"doc(Lossy 4x4 block compression of half channels)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_B44A = R"doc(Like B44, but compresses flat regions further)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_DWAA = R"doc(Lossy DCT compression of half channels in blocks of 32 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_DWAB = R"doc(Lossy DCT compression of half channels in blocks of 256 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_Default =
+R"doc(Lossless PIZ compression, or DWAB compression when a positive
+quality level is passed to write() (default))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_None = R"doc(No compression)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_PIZ = R"doc(Lossless wavelet compression)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_PXR24 = R"doc(Lossy 24-bit float compression (lossless for half channels))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_RLE = R"doc(Lossless run-length encoding)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_ZIP = R"doc(Lossless zlib compression of blocks of 16 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_ZIPS = R"doc(Lossless zlib compression of individual scanlines)doc";
+
 static const char *__doc_mitsuba_Bitmap_FileFormat = R"doc(Supported image file formats)doc";
 
 static const char *__doc_mitsuba_Bitmap_FileFormat_Auto =
@@ -1254,6 +1569,10 @@ static const char *__doc_mitsuba_Bitmap_data_2 = R"doc(Return a pointer to the u
 
 static const char *__doc_mitsuba_Bitmap_detect_file_format = R"doc(Attempt to detect the bitmap file format in a given stream)doc";
 
+static const char *__doc_mitsuba_Bitmap_exr_channel_format = R"doc(Return the format of a channel in OpenEXR files (see set_exr_channel_format()))doc";
+
+static const char *__doc_mitsuba_Bitmap_exr_compression = R"doc(Return the compression method used when writing OpenEXR files)doc";
+
 static const char *__doc_mitsuba_Bitmap_has_alpha = R"doc(Return whether this image has an alpha channel)doc";
 
 static const char *__doc_mitsuba_Bitmap_height = R"doc(Return the bitmap's height in pixels)doc";
@@ -1262,6 +1581,10 @@ static const char *__doc_mitsuba_Bitmap_m_component_format = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_data = R"doc()doc";
 
+static const char *__doc_mitsuba_Bitmap_m_exr_channel_formats = R"doc()doc";
+
+static const char *__doc_mitsuba_Bitmap_m_exr_compression = R"doc()doc";
+
 static const char *__doc_mitsuba_Bitmap_m_metadata = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_owns_data = R"doc()doc";
@@ -1373,6 +1696,18 @@ Parameter ``clamp``:
     Filtered image pixels will be clamped to the following range.
     Default: -infinity..infinity (i.e. no clamping is used))doc";
 
+static const char *__doc_mitsuba_Bitmap_set_exr_channel_format =
+R"doc(Specify the precision of a channel in OpenEXR files
+
+By default, every channel is stored with the bitmap's component
+format. This function overrides the format of the channel with the
+given name (``Float16``, ``Float32`` or ``UInt32``), and the OpenEXR
+library converts the samples while writing. This can e.g. be used to
+store albedo and normal AOVs in half precision alongside single
+precision depth and positions.)doc";
+
+static const char *__doc_mitsuba_Bitmap_set_exr_compression = R"doc(Set the compression method used when writing OpenEXR files)doc";
+
 static const char *__doc_mitsuba_Bitmap_set_metadata = R"doc(Set the a Properties object containing the image metadata)doc";
 
 static const char *__doc_mitsuba_Bitmap_set_premultiplied_alpha = R"doc(Specify whether the bitmap uses premultiplied alpha)doc";
@@ -1435,7 +1770,9 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor. When a compression method was chosen via
+set_exr_compression(), this parameter only specifies the level of the
+DWAA and DWAB compressors.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_2 =
 R"doc(Write an encoded form of the bitmap to a file using the specified file
@@ -1463,11 +1800,17 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor. When a compression method was chosen via
+set_exr_compression(), this parameter only specifies the level of the
+DWAA and DWAB compressors.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_async =
 R"doc(Equivalent to write(), but executes asynchronously on a different
-thread)doc";
+thread
+
+The image is submitted to the global BitmapWriter, which blocks when
+too many writes are pending. The bitmap must not be modified until the
+write has completed (see BitmapWriter::flush()).)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_exr = R"doc(Write a file using the OpenEXR file format)doc";
 
@@ -1481,6 +1824,105 @@ static const char *__doc_mitsuba_Bitmap_write_ppm = R"doc(Save a file using the
 
 static const char *__doc_mitsuba_Bitmap_write_rgbe = R"doc(Save a file using the RGBE file format)doc";
 
+static const char *__doc_mitsuba_BlockZStream =
+R"doc(Block-parallel compression/decompression stream based on ``zlib``.
+
+In contrast to ZStream, which compresses the data as a single
+sequential ``DEFLATE`` stream, this class splits the data into blocks
+(1 MiB by default) that are compressed independently. Reading and
+writing thus processes batches of blocks in parallel using the thread
+pool, which lifts the single-core throughput limit of ``zlib``.
+
+The encoding is a sequence of frames, each consisting of the
+uncompressed and compressed block size (``uint32``, in the byte order
+of the child stream) followed by the block in ``zlib`` format. A frame
+whose sizes are both zero marks the end of the stream.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_BlockZStream =
+R"doc(Creates a new block compression stream with the given underlying
+stream. This new instance takes ownership of the child stream.
+
+Parameter ``level``:
+    Compression level of ``zlib`` (-1: default)
+
+Parameter ``block_size``:
+    Size of the (uncompressed) blocks that are compressed
+    independently)doc";
+
+static const char *__doc_mitsuba_BlockZStream_can_read = R"doc(Can we read from the stream?)doc";
+
+static const char *__doc_mitsuba_BlockZStream_can_write = R"doc(Can we write to the stream?)doc";
+
+static const char *__doc_mitsuba_BlockZStream_child_stream = R"doc(Returns the child stream of this compression stream)doc";
+
+static const char *__doc_mitsuba_BlockZStream_child_stream_2 = R"doc(Returns the child stream of this compression stream)doc";
+
+static const char *__doc_mitsuba_BlockZStream_class = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockZStream_close =
+R"doc(Closes the stream, but not the underlying child stream. No further
+read or write operations are permitted.
+
+When data was written, this compresses the buffered blocks and adds
+the end-of-stream marker. This function is idempotent. It is called
+automatically by the destructor.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_compress_block =
+R"doc(Compress a single block of memory in ``zlib`` format
+
+This function is thread-safe and can be used to build other
+block-compressed formats.
+
+Parameter ``level``:
+    Compression level of ``zlib`` (-1: default))doc";
+
+static const char *__doc_mitsuba_BlockZStream_decompress_block =
+R"doc(Decompress a block created by compress_block() into a buffer, whose
+size must match the size of the uncompressed block)doc";
+
+static const char *__doc_mitsuba_BlockZStream_flush = R"doc(Compresses and writes all buffered data (ends the current block))doc";
+
+static const char *__doc_mitsuba_BlockZStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_batch_size = R"doc(Number of blocks that are processed in parallel)doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_block_size = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_buffer = R"doc(Uncompressed data (pending writes, or decompressed blocks))doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_buffer_pos = R"doc(Read position within m_buffer)doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_child_stream = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_did_write = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_end_of_stream = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockZStream_m_level = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockZStream_read =
+R"doc(Reads a specified amount of data from the stream, decompressing
+batches of blocks in parallel. Throws an exception when the stream
+ended prematurely.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_read_blocks = R"doc(Read and decompress the next batch of blocks)doc";
+
+static const char *__doc_mitsuba_BlockZStream_seek = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_size = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_tell = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_to_string = R"doc(Returns a string representation)doc";
+
+static const char *__doc_mitsuba_BlockZStream_truncate = R"doc(/ Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_write =
+R"doc(Writes a specified amount of data into the stream. Full batches of
+blocks are compressed in parallel.)doc";
+
+static const char *__doc_mitsuba_BlockZStream_write_blocks = R"doc(Compress the buffered data and write it to the child stream)doc";
+
 static const char *__doc_mitsuba_BoundingBox =
 R"doc(Generic n-dimensional bounding box data structure
 
@@ -1847,12 +2289,18 @@ static const char *__doc_mitsuba_ContinuousDistribution_eval_pdf_normalized =
 R"doc(Evaluate the normalized probability mass function (PDF) at position
 ``x``)doc";
 
+static const char *__doc_mitsuba_ContinuousDistribution_guide = R"doc(Return the guide table that bounds the search of sample() (two entries per cell))doc";
+
 static const char *__doc_mitsuba_ContinuousDistribution_integral = R"doc(Return the original integral of PDF entries before normalization)doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_interval_resolution = R"doc(Return the minimum resolution of the discretization)doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_m_cdf = R"doc()doc";
 
+static const char *__doc_mitsuba_ContinuousDistribution_m_guide = R"doc()doc";
+
+static const char *__doc_mitsuba_ContinuousDistribution_m_guide_iterations = R"doc()doc";
+
 static const char *__doc_mitsuba_ContinuousDistribution_m_integral = R"doc()doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_m_interval_size = R"doc()doc";
@@ -1906,10 +2354,60 @@ Returns:
 1. the sampled position. 2. the normalized probability density of the
 sample.)doc";
 
+static const char *__doc_mitsuba_ContinuousDistribution_sample_interval =
+R"doc(Find the interval of the CDF that contains the uniformly distributed
+sample ``value``
+
+The sample space is split into size() - 1 uniform cells. For each
+cell, the guide table stores the range of intervals whose CDF covers
+it, which bounds the subsequent binary search. Distributions with
+sharp peaks hence need a handful of steps instead of a search over all
+intervals.)doc";
+
 static const char *__doc_mitsuba_ContinuousDistribution_size = R"doc(Return the number of discretizations)doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_update = R"doc(Update the internal state. Must be invoked when changing the pdf.)doc";
 
+static const char *__doc_mitsuba_CppADIntegrator =
+R"doc(Abstract base class of the differentiable integrators
+
+The Python class ``ADIntegrator`` (see ``mitsuba.ad.integrators``)
+derives from this class and orchestrates the primal and differential
+phases of radiative backpropagation-style methods. Integrators
+implemented in C++ instead provide their sampling loop by overriding
+sample_adjoint(), which can be invoked by the Python orchestration
+code or directly from C++. Primal renderings via render() then simply
+forward to sample_adjoint() in primal mode.)doc";
+
+static const char *__doc_mitsuba_CppADIntegrator_CppADIntegrator = R"doc(Create an integrator)doc";
+
+static const char *__doc_mitsuba_CppADIntegrator_sample = R"doc(Compute a primal estimate via sample_adjoint())doc";
+
+static const char *__doc_mitsuba_CppADIntegrator_sample_adjoint =
+R"doc(Sample the incident radiance along a ray and optionally propagate
+derivatives
+
+Parameter ``mode``:
+    Specifies whether the loop should compute an ordinary primal
+    estimate (``dr::ADMode::Primal``) or propagate derivatives in
+    forward (``dr::ADMode::Forward``) or reverse mode
+    (``dr::ADMode::Backward``).
+
+Parameter ``delta_L``:
+    In reverse mode, the adjoint radiance (i.e. the gradient of the
+    objective with respect to the estimate). Ignored in primal and
+    forward mode.
+
+Parameter ``state_in``:
+    Primal estimate computed by a previous invocation in primal mode
+    with the same random numbers. Ignored in primal mode.
+
+Returns:
+    A tuple containing the primal radiance (in primal mode) or the
+    differential radiance (in forward and reverse mode), the ray
+    validity flag used for alpha blending, and the primal radiance
+    that should be provided as ``state_in`` to the differential phase.)doc";
+
 static const char *__doc_mitsuba_DefaultFormatter =
 R"doc(The default formatter used to turn log messages into a human-readable
 form)doc";
@@ -2031,6 +2529,13 @@ static const char *__doc_mitsuba_DirectionSample_operator_assign_3 = R"doc()doc"
 
 static const char *__doc_mitsuba_DirectionSample_operator_assign_4 = R"doc()doc";
 
+static const char *__doc_mitsuba_DirectionSample_prim_index =
+R"doc(Optional: index of the sampled primitive within its shape
+
+Shapes consisting of several primitives (e.g. the triangles of a mesh)
+can use this attribute to identify the primitive that contains the
+sampled position when evaluating the associated density.)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution =
 R"doc(Discrete 1D probability distribution
 
@@ -2311,8 +2816,121 @@ static const char *__doc_mitsuba_EOFException_gcount = R"doc()doc";
 
 static const char *__doc_mitsuba_EOFException_m_gcount = R"doc()doc";
 
+static const char *__doc_mitsuba_EmbreeBuildMode = R"doc(Specifies how the Embree BVH of a shape is built and updated)doc";
+
+static const char *__doc_mitsuba_EmbreeBuildMode_Dynamic = R"doc(Build with low quality, for shapes that are rebuilt frequently)doc";
+
+static const char *__doc_mitsuba_EmbreeBuildMode_Refit = R"doc(Build with the default quality, refit the BVH when the shape deforms)doc";
+
+static const char *__doc_mitsuba_EmbreeBuildMode_Static = R"doc(Build with high quality (spatial splits), rebuild when the shape deforms)doc";
+
 static const char *__doc_mitsuba_Emitter = R"doc()doc";
 
+static const char *__doc_mitsuba_EmitterCache =
+R"doc(Spatial cache of the contribution of every emitter, used to guide the
+choice of an emitter in next event estimation
+
+The cache hashes the cells of a regular grid over the scene's bounding
+box into a table of fixed size. For every table entry and emitter, it
+accumulates the unoccluded contribution of the emitter samples drawn
+from that cell (i.e. emitter samples whose shadow rays are blocked
+contribute zero), and the number of these samples. update() turns the
+averages into a discrete distribution over the emitters of every
+entry.
+
+Scene::sample_emitter_direction() draws from this distribution with
+probability learned_prob() and otherwise falls back to its default
+strategy, which guarantees that every emitter keeps a nonzero
+probability and that the estimate remains unbiased. Entries that did
+not receive any visible samples only use the default strategy.
+
+Recording is thread-safe, while update() must not run concurrently
+with sampling or recording (integrators call it between rendering
+passes).)doc";
+
+static const char *__doc_mitsuba_EmitterCache_EmitterCache =
+R"doc(Create an empty emitter cache
+
+Parameter ``bbox``:
+    Region covered by the spatial grid (usually the scene bounds)
+
+Parameter ``emitters``:
+    Emitters of the scene (in the order of Scene::emitters())
+
+Parameter ``resolution``:
+    Number of grid cells along the longest axis of ``bbox``
+
+Parameter ``entry_count``:
+    Size of the hash table (rounded up to a power of two)
+
+Parameter ``training_passes``:
+    Number of calls to update() after which recording stops)doc";
+
+static const char *__doc_mitsuba_EmitterCache_class = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_emitter_index = R"doc(Return the index of an emitter in the constructor's list)doc";
+
+static const char *__doc_mitsuba_EmitterCache_entry = R"doc(Return the hash table entry of the grid cell containing ``p``)doc";
+
+static const char *__doc_mitsuba_EmitterCache_learned_prob =
+R"doc(Probability of sampling from the cache in entries that hold a
+distribution)doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_bbox = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_cdf = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_emitter_count = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_entry_count = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_index_map =
+R"doc(Maps emitters (scalar variants) or their JIT registry identifiers to
+emitter indices)doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_inv_cell_size = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_prob = R"doc(Per entry and emitter: probabilities and cumulative distributions)doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_registry_map = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_train = R"doc(Per entry and emitter: sum of the recorded values and sample count)doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_train_scalar = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_training_passes = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_m_update_count = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_pdf_emitter =
+R"doc(Evaluate the discrete probability of sample_emitter() choosing an
+emitter)doc";
+
+static const char *__doc_mitsuba_EmitterCache_ready = R"doc(Has update() been called, i.e. can the cache be sampled?)doc";
+
+static const char *__doc_mitsuba_EmitterCache_record =
+R"doc(Record the outcome of an emitter sample
+
+Parameter ``value``:
+    Contribution of the emitter sample (divided by the solid angle
+    density, but not by the probability of choosing the emitter), or
+    zero if the shadow ray is occluded)doc";
+
+static const char *__doc_mitsuba_EmitterCache_sample_emitter =
+R"doc(Sample an emitter from the distribution of a table entry
+
+Returns:
+    The index of the chosen emitter, its discrete probability, and the
+    transformed random sample for reuse)doc";
+
+static const char *__doc_mitsuba_EmitterCache_to_string = R"doc()doc";
+
+static const char *__doc_mitsuba_EmitterCache_training = R"doc(Should record() still be called, i.e. is the cache being trained?)doc";
+
+static const char *__doc_mitsuba_EmitterCache_update = R"doc(Rebuild the distributions from all data recorded so far)doc";
+
+static const char *__doc_mitsuba_EmitterCache_valid = R"doc(Does the given table entry hold a distribution?)doc";
+
 static const char *__doc_mitsuba_Emitter_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Emitter_3 = R"doc()doc";
@@ -2335,6 +2953,8 @@ static const char *__doc_mitsuba_EmitterFlags_Empty = R"doc(No flags set (defaul
 
 static const char *__doc_mitsuba_EmitterFlags_Infinite = R"doc(The emitter is placed at infinity (e.g. environment maps))doc";
 
+static const char *__doc_mitsuba_EmitterFlags_Medium = R"doc(The emitter fills a participating medium (e.g. volume emitters))doc";
+
 static const char *__doc_mitsuba_EmitterFlags_SpatiallyVarying = R"doc(The emission depends on the UV coordinates)doc";
 
 static const char *__doc_mitsuba_EmitterFlags_Surface = R"doc(The emitter is attached to a surface (e.g. area emitters))doc";
@@ -2686,7 +3306,13 @@ R"doc(Simple class for resolving paths on Linux/Windows/Mac OS
 
 This convenience class looks for a file or directory given its name
 and a set of search paths. The implementation walks through the search
-paths in order and stops once the file is found.)doc";
+paths in order and stops once the file is found.
+
+Successful lookups are cached, since querying the file system can be
+slow, e.g. on network file systems. Failed lookups are not cached, so
+that files created later are found. The cache holds a bounded number
+of entries and is invalidated when the list of search paths changes in
+a way that could shadow previous results.)doc";
 
 static const char *__doc_mitsuba_FileResolver_FileResolver = R"doc(Initialize a new file resolver with the current working directory)doc";
 
@@ -2704,6 +3330,8 @@ static const char *__doc_mitsuba_FileResolver_class = R"doc()doc";
 
 static const char *__doc_mitsuba_FileResolver_clear = R"doc(Clear the list of search paths)doc";
 
+static const char *__doc_mitsuba_FileResolver_clear_cache = R"doc(Forget the outcome of all previous lookups)doc";
+
 static const char *__doc_mitsuba_FileResolver_contains = R"doc(Check if a given path is included in the search path list)doc";
 
 static const char *__doc_mitsuba_FileResolver_end = R"doc(Return an iterator at the end of the list of search paths)doc";
@@ -2714,18 +3342,30 @@ static const char *__doc_mitsuba_FileResolver_erase = R"doc(Erase the entry at t
 
 static const char *__doc_mitsuba_FileResolver_erase_2 = R"doc(Erase the search path from the list)doc";
 
+static const char *__doc_mitsuba_FileResolver_m_cache = R"doc(Successful lookup results (name -> resolved path))doc";
+
+static const char *__doc_mitsuba_FileResolver_m_cache_mutex = R"doc()doc";
+
 static const char *__doc_mitsuba_FileResolver_m_paths = R"doc()doc";
 
 static const char *__doc_mitsuba_FileResolver_operator_array = R"doc(Return an entry from the list of search paths)doc";
 
 static const char *__doc_mitsuba_FileResolver_operator_array_2 = R"doc(Return an entry from the list of search paths (const))doc";
 
+static const char *__doc_mitsuba_FileResolver_prefetch =
+R"doc(Resolve several paths in parallel and cache the successful results
+
+This overlaps the latency of the underlying file system queries, after
+which resolve() can answer lookups of these paths from its cache.)doc";
+
 static const char *__doc_mitsuba_FileResolver_prepend = R"doc(Prepend an entry at the beginning of the list of search paths)doc";
 
 static const char *__doc_mitsuba_FileResolver_resolve =
 R"doc(Walk through the list of search paths and try to resolve the input
 path)doc";
 
+static const char *__doc_mitsuba_FileResolver_resolve_uncached = R"doc(Walk through the search paths, returns an empty path on failure)doc";
+
 static const char *__doc_mitsuba_FileResolver_size = R"doc(Return the number of search paths)doc";
 
 static const char *__doc_mitsuba_FileResolver_to_string = R"doc(Return a human-readable representation of this instance)doc";
@@ -2977,6 +3617,24 @@ static const char *__doc_mitsuba_Film_traverse = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_write = R"doc(Write the developed contents of the film to a file on disk)doc";
 
+static const char *__doc_mitsuba_Film_write_async =
+R"doc(Write the developed contents of the film to a file on disk
+asynchronously
+
+The image is developed right away, but encoded and written by the
+global BitmapWriter, so that the film can be cleared and reused before
+the file is complete. Use BitmapWriter::flush() to wait for pending
+writes. The default implementation simply calls write().)doc";
+
+static const char *__doc_mitsuba_Film_write_snapshot =
+R"doc(Write the developed contents of the film to a file on disk while
+rendering is still in progress
+
+Films that support this copy their storage into a separate snapshot
+buffer and develop it without holding the lock taken by put_block(),
+so that render workers are not stalled by the write. The default
+implementation simply calls write().)doc";
+
 static const char *__doc_mitsuba_FilterBoundaryCondition =
 R"doc(When resampling data to a different resolution using
 Resampler::resample(), this enumeration specifies how lookups
@@ -3226,18 +3884,40 @@ static const char *__doc_mitsuba_Hierarchical2D_eval =
 R"doc(Evaluate the density at position ``pos``. The distribution is
 parameterized by ``param`` if applicable.)doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_eval_weighted = R"doc(Evaluate the density of samples generated by sample_weighted())doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_invert = R"doc(Inverse of the mapping implemented in ``sample()``)doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_m_levels = R"doc(MIP hierarchy over linearly interpolated patches)doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_m_max_patch_index = R"doc(Number of bilinear patches in the X/Y dimension - 1)doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_patch_value =
+R"doc(Average value of the patch ``offset`` when the hierarchical traversal
+in sample_weighted() doesn't visit the first MIP level (i.e. there is
+only a single patch). Returns zero otherwise.)doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_sample =
 R"doc(Given a uniformly distributed 2D sample, draw a sample from the
 distribution (parameterized by ``param`` if applicable)
 
 Returns the warped sample and associated probability density.)doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_sample_weighted =
+R"doc(Draw a sample from the product of the distribution and a positive
+weighting function
+
+The function ``weight`` is invoked with the bounds ``(min, max)`` of
+the cells visited during the hierarchical traversal (in the unit
+square) and must return a weight that is representative of (e.g. an
+upper bound of) the product factor within each cell. Its value should
+only depend on the cell, which makes the density of the resulting
+samples tractable (see eval_weighted()).
+
+Returns the warped sample and associated probability density, which is
+always normalized (even when the distribution was constructed with
+``normalize=false``).)doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_to_string = R"doc()doc";
 
 static const char *__doc_mitsuba_IOREntry = R"doc()doc";
@@ -3386,10 +4066,14 @@ static const char *__doc_mitsuba_ImageBlock_class = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_clear = R"doc(Clear the image block contents to zero.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_clear_variance = R"doc(Allocate zero-initialized per-pixel variance statistics)doc";
+
 static const char *__doc_mitsuba_ImageBlock_coalesce = R"doc(Try to coalesce reads/writes in JIT modes?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_compensate = R"doc(Use Kahan-style error-compensated floating point accumulation?)doc";
 
+static const char *__doc_mitsuba_ImageBlock_develop_variance = R"doc(Write the per-pixel variance into the target channels of the tensor)doc";
+
 static const char *__doc_mitsuba_ImageBlock_has_border = R"doc(Does the image block have a border region?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_height = R"doc(Return the bitmap's height in pixels)doc";
@@ -3408,12 +4092,26 @@ static const char *__doc_mitsuba_ImageBlock_m_offset = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_rfilter = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_m_sample_group = R"doc()doc";
+
 static const char *__doc_mitsuba_ImageBlock_m_size = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_m_sorted = R"doc()doc";
+
 static const char *__doc_mitsuba_ImageBlock_m_tensor = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_tensor_compensation = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_m_variance = R"doc(Sample count, means and sums of squared deviations of every pixel)doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_variance_count = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_variance_source = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_variance_target = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_variance_weight = R"doc()doc";
+
 static const char *__doc_mitsuba_ImageBlock_m_warn_invalid = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_warn_negative = R"doc()doc";
@@ -3457,6 +4155,10 @@ Parameter ``values``:
 
 static const char *__doc_mitsuba_ImageBlock_put_block = R"doc(Accumulate another image block into this one)doc";
 
+static const char *__doc_mitsuba_ImageBlock_put_sorted = R"doc(Implementation detail of put() in sorted mode (returns ``False`` if unsupported))doc";
+
+static const char *__doc_mitsuba_ImageBlock_put_variance = R"doc(Implementation detail of put() updating the per-pixel variance)doc";
+
 static const char *__doc_mitsuba_ImageBlock_read =
 R"doc(Fetch a single sample or a wavefront of samples from the image block.
 
@@ -3474,6 +4176,8 @@ Parameter ``values``:
 
 static const char *__doc_mitsuba_ImageBlock_rfilter = R"doc(Return the image reconstruction filter underlying the ImageBlock)doc";
 
+static const char *__doc_mitsuba_ImageBlock_sample_group = R"doc(Return the number of consecutive wavefront lanes that share a pixel)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_coalesce = R"doc(Try to coalesce reads/writes in JIT modes?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_compensate = R"doc(Use Kahan-style error-compensated floating point accumulation?)doc";
@@ -3487,20 +4191,75 @@ This corresponds to the offset from the top-left corner of a larger
 image (e.g. a Film) to the top-left corner of this ImageBlock
 instance.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_rfilter =
+R"doc(Change the reconstruction filter used by put() and read()
+
+A value of ``nullptr`` selects the box filter, which requires that the
+block has no border region.)doc";
+
+static const char *__doc_mitsuba_ImageBlock_set_sample_group =
+R"doc(Specify how samples are laid out in the wavefronts passed to put()
+
+A value of ``n`` states that the lanes ``[i*n, (i+1)*n)`` all sample
+the same pixel, and that different groups of lanes sample different
+pixels. This is the layout generated by the JIT rendering loop of
+SamplingIntegrator with ``n`` samples per pass. In sorted mode, put()
+then sums each group before touching the image, so that every pixel
+receives a single (uncontended) update instead of ``n`` atomic
+additions.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_size = R"doc(Set the block size. This potentially destroys the block's content.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_sorted =
+R"doc(Accumulate groups of samples that share a pixel with a segmented
+reduction instead of per-sample atomics? (JIT modes only)
+
+This only takes effect when a sample group size greater than one has
+been specified via set_sample_group().)doc";
+
+static const char *__doc_mitsuba_ImageBlock_set_variance =
+R"doc(Record a streaming estimate of the per-pixel sample variance
+
+The channels ``[target, target + count)`` then report the unbiased
+variance of the values that put() receives for the channels ``[source,
+source + count)``, where every sample counts towards the pixel that
+contains it (irrespective of the reconstruction filter). The variance
+is stored premultiplied by the ``weight`` channel so that the usual
+normalization recovers it when the image is developed, and any values
+passed to the target channels are ignored.
+
+The sample count, mean and sum of squared deviations of every pixel
+are updated with Welford's algorithm and merged across wavefronts and
+image blocks using its parallel formulation by Chan et al. Unlike the
+raw second moment, this does not suffer from catastrophic cancellation
+when many samples are accumulated in single precision. In JIT
+variants, the groups of a wavefront (see set_sample_group()) must
+sample distinct pixels, which is the layout generated by
+SamplingIntegrator.
+
+The statistics are kept separately from the image tensor, with ``2 *
+count + 1`` values per pixel. When another block recording the
+variance is merged via put_block(), this block starts recording it as
+well. A ``count`` of zero disables the feature.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_warn_negative = R"doc(Warn when writing negative sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_size = R"doc(Return the current block size)doc";
 
+static const char *__doc_mitsuba_ImageBlock_sorted = R"doc(Accumulate groups of samples that share a pixel with a segmented reduction?)doc";
+
 static const char *__doc_mitsuba_ImageBlock_tensor = R"doc(Return the underlying image tensor)doc";
 
 static const char *__doc_mitsuba_ImageBlock_tensor_2 = R"doc(Return the underlying image tensor (const version))doc";
 
 static const char *__doc_mitsuba_ImageBlock_to_string = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_ImageBlock_update_memory = R"doc(Register the size of the tensors with the MemoryTracker)doc";
+
+static const char *__doc_mitsuba_ImageBlock_variance_count = R"doc(Return the number of channels whose per-pixel variance is recorded)doc";
+
 static const char *__doc_mitsuba_ImageBlock_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_warn_negative = R"doc(Warn when writing negative sample values?)doc";
@@ -3801,6 +4560,71 @@ time. If not, the application is terminated via ``abort()``.)doc";
 
 static const char *__doc_mitsuba_Jit_static_shutdown = R"doc(Release all memory used by JIT-compiled routines)doc";
 
+static const char *__doc_mitsuba_LightPathExpressions =
+R"doc(Set of compiled light path expressions (LPEs) that classify the paths
+of a path tracer into separate image components
+
+An expression is a regular expression over the scattering events of a
+path, starting at the sensor (``C``, optional) and ending at an
+emitter (``L``). The events are named after the BSDF lobe that was
+sampled (or evaluated for emitter samples) at the vertex:
+
+- ``D``: diffuse reflection
+
+- ``G``: glossy reflection
+
+- ``S``: specular (i.e. Dirac delta) reflection
+
+- ``T``: transmission (of any kind)
+
+Null events (e.g. at an index-matched boundary) are ignored. Events
+can be combined with ``.`` (any event), sets such as ``[DG]`` or
+``[^D]``, grouping with parentheses, alternatives (``|``) and the
+repetition operators ``*``, ``+`` and ``?``. A light group
+``L'prefix'`` restricts an expression to the emitters whose identifier
+starts with ``prefix``. For instance, ``C D L`` selects direct diffuse
+illumination, and ``C .* S .* L'sun'`` selects all light from emitters
+named ``sun*`` that underwent at least one specular reflection.
+
+Every expression is compiled into a deterministic finite automaton,
+and the states of all automata are packed into a single 32 bit integer
+that paths update with one table lookup per expression and vertex.)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_Event = R"doc(Scattering events distinguished by the expressions)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_LightPathExpressions =
+R"doc(Compile a comma-separated list of expressions
+
+Parameter ``spec``:
+    List of ``name:expression`` pairs, e.g. ``"direct:C.L,
+    indirect:C..+L"``)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_accept =
+R"doc(Return a bit mask of the expressions that accept a path with the
+given state once it reaches ``emitter``)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_advance = R"doc(Advance the packed state by the event of a sampled BSDF lobe)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_advance_2 = R"doc(Advance the packed state by the given event)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_class = R"doc()doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_event_flags = R"doc(Return the BSDF lobes that produce the given event)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_initial_state = R"doc(Return the packed state of paths that only consist of the sensor vertex)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_names = R"doc(Return the names of the expressions)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_set_emitters =
+R"doc(Resolve the light groups of the expressions
+
+Parameter ``emitters``:
+    Emitters of the scene (in the order of Scene::emitters()))doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_size = R"doc(Return the number of expressions)doc";
+
+static const char *__doc_mitsuba_LightPathExpressions_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_LogLevel = R"doc(Available Log message types)doc";
 
 static const char *__doc_mitsuba_LogLevel_Debug = R"doc(Trace message, for extremely verbose debugging)doc";
@@ -3818,7 +4642,14 @@ R"doc(Responsible for processing log messages
 
 Upon receiving a log message, the Logger class invokes a Formatter to
 convert it into a human-readable form. Following that, it sends this
-information to every registered Appender.)doc";
+information to every registered Appender.
+
+By default, the appenders are invoked synchronously by the thread that
+submits the message. In asynchronous mode (see set_async()), messages
+are instead placed into a lock-free queue that is processed by a
+background thread, so that threads producing many messages (e.g.
+during parallel scene loading with debug output) don't serialize on
+the appenders.)doc";
 
 static const char *__doc_mitsuba_Logger_Logger = R"doc(Construct a new logger with the given minimum log level)doc";
 
@@ -3840,10 +4671,14 @@ static const char *__doc_mitsuba_Logger_d = R"doc()doc";
 
 static const char *__doc_mitsuba_Logger_error_level = R"doc(Return the current error level)doc";
 
+static const char *__doc_mitsuba_Logger_flush = R"doc(Wait until all pending asynchronous log messages have been processed)doc";
+
 static const char *__doc_mitsuba_Logger_formatter = R"doc(Return the logger's formatter implementation)doc";
 
 static const char *__doc_mitsuba_Logger_formatter_2 = R"doc(Return the logger's formatter implementation (const))doc";
 
+static const char *__doc_mitsuba_Logger_is_async = R"doc(Are log messages processed asynchronously?)doc";
+
 static const char *__doc_mitsuba_Logger_log =
 R"doc(Process a log message
 
@@ -3896,6 +4731,19 @@ Throws a runtime exception upon failure)doc";
 
 static const char *__doc_mitsuba_Logger_remove_appender = R"doc(Remove an appender from this logger)doc";
 
+static const char *__doc_mitsuba_Logger_set_async =
+R"doc(Enable or disable the asynchronous processing of log messages
+
+Messages are still formatted by the submitting thread, but the
+appenders are invoked by a background thread in the order in which the
+messages were submitted. Submitting threads never wait for the
+background thread: messages that don't fit into the queue are kept in
+an unbounded overflow list instead. Disabling asynchronous mode
+processes all pending messages first. Progress messages are never
+deferred.
+
+This function must not be called while other threads submit messages.)doc";
+
 static const char *__doc_mitsuba_Logger_set_error_level =
 R"doc(Set the error log level (this level and anything above will throw
 exceptions).
@@ -4076,6 +4924,10 @@ static const char *__doc_mitsuba_Medium_Medium_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_class = R"doc()doc";
 
+static const char *__doc_mitsuba_Medium_emitter = R"doc(Return the emitter filling this medium (if any))doc";
+
+static const char *__doc_mitsuba_Medium_emitter_2 = R"doc(Return the emitter filling this medium (if any))doc";
+
 static const char *__doc_mitsuba_Medium_eval_tr_and_pdf =
 R"doc(Compute the transmittance and PDF
 
@@ -4091,6 +4943,15 @@ depend on the wavelength.
 Returns:
     This method returns a pair of (Transmittance, PDF).)doc";
 
+static const char *__doc_mitsuba_Medium_get_albedo =
+R"doc(Returns the single-scattering albedo evaluated at a given
+MediumInteraction mi
+
+The default implementation divides the scattering coefficient by the
+extinction. Media that store the albedo should evaluate it directly,
+since it is all that collisions with the control component of
+sample_interaction_decomposition() need to look up.)doc";
+
 static const char *__doc_mitsuba_Medium_get_majorant = R"doc(Returns the medium's majorant used for delta tracking)doc";
 
 static const char *__doc_mitsuba_Medium_get_scattering_coefficients =
@@ -4103,8 +4964,12 @@ static const char *__doc_mitsuba_Medium_id = R"doc(Return a string identifier)do
 
 static const char *__doc_mitsuba_Medium_intersect_aabb = R"doc(Intersects a ray with the medium's bounding box)doc";
 
+static const char *__doc_mitsuba_Medium_is_emitter = R"doc(Is this medium emissive?)doc";
+
 static const char *__doc_mitsuba_Medium_is_homogeneous = R"doc(Returns whether this medium is homogeneous)doc";
 
+static const char *__doc_mitsuba_Medium_m_emitter = R"doc(Nested emitter with the EmitterFlags::Medium flag (optional))doc";
+
 static const char *__doc_mitsuba_Medium_m_has_spectral_extinction = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_m_id = R"doc(Identifier (if available))doc";
@@ -4125,6 +4990,61 @@ static const char *__doc_mitsuba_Medium_operator_new_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_phase_function = R"doc(Return the phase function of this medium)doc";
 
+static const char *__doc_mitsuba_Medium_sample_interaction_decomposition =
+R"doc(Sample a collision for decomposition tracking
+
+Decomposition tracking splits the extinction into a piecewise constant
+control component and a residual component. The free-flight distance
+is sampled according to the (per-channel, if available) majorant of
+the given channel, and ``sample.y()`` then selects which of the two
+components the collision belongs to. Collisions with the control
+component are always real and only evaluate the albedo (see
+get_albedo()), while the others are real or null collisions of the
+residual component. Media with a grid of local majorants use the per-
+cell lower bounds as control, homogeneous media use their extinction,
+and all other media have no control component.
+
+The returned interaction holds the coefficients of the component that
+produced the collision: ``sigma_t`` and ``sigma_s`` are those of the
+control or residual component, ``sigma_n`` is the null extinction, and
+``combined_extinction`` is the majorant. The probability of a real or
+null collision in any channel is thus given by the ratio of
+``sigma_t`` or ``sigma_n`` to ``combined_extinction``, as in
+sample_interaction().
+
+Unlike sample_interaction(), the majorant may vary along the ray and
+between channels. The interval ``[0, ray.maxt]`` should thus end at
+the next surface, so that the returned optical depth yields the free-
+flight transmittance.
+
+Returns:
+    A tuple of (MediumInteraction, optical depth of the majorant of
+    every channel up to the collision or to the end of the ray, mask
+    of collisions with the control component). The corresponding free-
+    flight transmittance is ``exp(-optical depth)``.)doc";
+
+static const char *__doc_mitsuba_Medium_sample_interaction_residual =
+R"doc(Sample a tentative collision for residual ratio tracking
+
+Residual ratio tracking splits the extinction into a piecewise constant
+control component, whose transmittance is evaluated analytically, and a
+residual component, which is estimated by ratio tracking against a
+residual majorant. Media with a grid of local majorants use the per-
+cell lower bounds (see m_control_grid) as control, homogeneous media
+use their extinction (which requires no collisions at all), and all
+other media fall back to plain ratio tracking.
+
+The returned interaction stores the residual majorant in
+``combined_extinction``, and its ``sigma_n`` field holds the residual
+null extinction, so that the transmittance weight of a collision is
+given by ``sigma_n / combined_extinction``.
+
+Returns:
+    A tuple of (MediumInteraction, control extinction at the
+    collision, control optical depth up to the collision or to the end
+    of the ray). The caller must multiply the transmittance by
+    ``exp(-control optical depth)``.)doc";
+
 static const char *__doc_mitsuba_Medium_sample_interaction =
 R"doc(Sample a free-flight distance in the medium.
 
@@ -4156,6 +5076,22 @@ static const char *__doc_mitsuba_Medium_traverse = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_use_emitter_sampling = R"doc(Returns whether this specific medium instance uses emitter sampling)doc";
 
+static const char *__doc_mitsuba_MemoryCategory = R"doc(Categories of the memory usage reported by the MemoryTracker)doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Accel = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Bitmap = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Film = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryCategory_MemoryCategoryCount = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Mesh = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Texture = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryCategory_Volume = R"doc()doc";
+
 static const char *__doc_mitsuba_MemoryMappedFile =
 R"doc(Basic cross-platform abstraction for memory mapped files
 
@@ -4203,6 +5139,29 @@ static const char *__doc_mitsuba_MemoryMappedFile_size = R"doc(Return the size o
 
 static const char *__doc_mitsuba_MemoryMappedFile_to_string = R"doc(Return a string representation)doc";
 
+static const char *__doc_mitsuba_MemoryRecord =
+R"doc(Memory usage of an object in a MemoryCategory
+
+The usage is unregistered when the record is destroyed. Copies start
+with zero usage, since the copied object registers the buffers it
+allocates itself.)doc";
+
+static const char *__doc_mitsuba_MemoryRecord_MemoryRecord = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryRecord_MemoryRecord_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryRecord_MemoryRecord_3 = R"doc()doc";
+
+static const char *__doc_mitsuba_MemoryRecord_device = R"doc(Return the registered device memory usage (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryRecord_host = R"doc(Return the registered host memory usage (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryRecord_set = R"doc(Replace the registered usage (in bytes))doc";
+
+static const char *__doc_mitsuba_MemoryRecord_set_bytes =
+R"doc(Register ``bytes`` in device memory if ``device`` is set, and in host
+memory otherwise)doc";
+
 static const char *__doc_mitsuba_MemoryStream =
 R"doc(Simple memory buffer-based stream with automatic memory management. It
 always has read & write capabilities.
@@ -4295,6 +5254,46 @@ static const char *__doc_mitsuba_MemoryStream_write =
 R"doc(Writes a specified amount of data into the memory buffer. The capacity
 of the memory buffer is extended if necessary.)doc";
 
+static const char *__doc_mitsuba_MemoryTracker =
+R"doc(Accounting of the memory used by the large buffers of the renderer
+
+Objects owning large buffers (meshes, bitmaps, textures, volumes, image
+blocks and acceleration data structures) register their host and
+device memory usage under a MemoryCategory via a MemoryRecord member.
+The totals are updated using atomic operations and can be queried at
+any time, e.g. to find out which part of a scene exhausts the
+available memory.
+
+An optional budget produces a warning as soon as the total usage
+exceeds it. Objects register their buffers before allocating them
+where possible, so that the warning precedes a failing allocation.
+
+Temporary allocations, buffers of the JIT compiler that are not owned
+by one of the above objects, and the memory of external ray tracing
+libraries that do not report it are not accounted for.)doc";
+
+static const char *__doc_mitsuba_MemoryTracker_add = R"doc(Adjust the usage of a category (used by MemoryRecord))doc";
+
+static const char *__doc_mitsuba_MemoryTracker_budget = R"doc(Return the current budget (zero: no budget))doc";
+
+static const char *__doc_mitsuba_MemoryTracker_peak =
+R"doc(Return the largest total usage (host + device) since the last
+reset_peak())doc";
+
+static const char *__doc_mitsuba_MemoryTracker_reset_peak = R"doc(Reset the peak usage to the current total)doc";
+
+static const char *__doc_mitsuba_MemoryTracker_set_budget =
+R"doc(Set the budget (in bytes) of the total (host + device) usage
+
+A warning is logged whenever the usage exceeds the budget. A budget of
+zero (the default) disables the warning.)doc";
+
+static const char *__doc_mitsuba_MemoryTracker_to_string = R"doc(Return a human-readable table of the usage of all categories)doc";
+
+static const char *__doc_mitsuba_MemoryTracker_total = R"doc(Return the total (host, device) memory usage in bytes)doc";
+
+static const char *__doc_mitsuba_MemoryTracker_usage = R"doc(Return the (host, device) memory usage of a category in bytes)doc";
+
 static const char *__doc_mitsuba_Mesh = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_2 = R"doc()doc";
@@ -4307,7 +5306,19 @@ static const char *__doc_mitsuba_Mesh_5 = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_Mesh = R"doc(Create a new mesh with the given vertex and face data structures)doc";
 
-static const char *__doc_mitsuba_Mesh_Mesh_2 = R"doc()doc";
+static const char *__doc_mitsuba_Mesh_Mesh_2 =
+R"doc(Create a new mesh that references existing vertex and face buffers
+
+The buffers are adopted by reference instead of being copied, which
+makes it possible to wrap memory that is owned by another framework
+(e.g. via ``dr::map()``) without any copies. The vertex normal and
+texture coordinate buffers may be empty.
+
+From Python, the buffers can be Dr.Jit arrays or any object that
+implements the NumPy/CUDA array interface or DLPack (e.g. NumPy, CuPy,
+or PyTorch arrays). Contiguous arrays of matching type and device are
+mapped without a copy and kept alive as long as Mitsuba references
+them.)doc";
 
 static const char *__doc_mitsuba_Mesh_Mesh_3 = R"doc()doc";
 
@@ -4352,10 +5363,21 @@ R"doc(Build internal tables for sampling uniformly wrt. area.
 Computes the surface area and sets up ``m_area_pmf`` Thread-safe,
 since it uses a mutex.)doc";
 
+static const char *__doc_mitsuba_Mesh_build_vertex_adjacency =
+R"doc(Build the vertex-to-face adjacency used by recompute_vertex_normals()
+
+The table is stored in compressed sparse row format: entries
+<tt>[offsets[i], offsets[i+1])</tt> of m_vertex_corners list the face
+corners (<tt>3 * face + corner</tt>) that reference vertex i, in
+increasing order. It only depends on the topology and is therefore
+reused until the faces change.)doc";
+
 static const char *__doc_mitsuba_Mesh_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_compute_surface_interaction = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_embree_cutout_filter = R"doc(Embree filter function that discards hits in the transparent regions)doc";
+
 static const char *__doc_mitsuba_Mesh_embree_geometry = R"doc(Return the Embree version of this shape)doc";
 
 static const char *__doc_mitsuba_Mesh_ensure_pmf_built = R"doc()doc";
@@ -4388,14 +5410,36 @@ static const char *__doc_mitsuba_Mesh_has_vertex_normals = R"doc(Does this mesh
 
 static const char *__doc_mitsuba_Mesh_has_vertex_texcoords = R"doc(Does this mesh have per-vertex texture coordinates?)doc";
 
+static const char *__doc_mitsuba_Mesh_has_vertex_tangents = R"doc(Does this mesh have precomputed per-vertex tangents?)doc";
+
 static const char *__doc_mitsuba_Mesh_initialize = R"doc(Must be called at the end of the constructor of Mesh plugins)doc";
 
+static const char *__doc_mitsuba_Mesh_instance_transform =
+R"doc(Check whether ``other`` is a transformed copy of this mesh
+
+Returns the transformation mapping this mesh onto ``other``, which is
+derived from the ``to_world`` transformations of both meshes, if the
+two meshes agree after transformation (up to rounding errors).
+Mirroring transformations are rejected.)doc";
+
 static const char *__doc_mitsuba_Mesh_interpolate_attribute = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_alias_sampling = R"doc()doc";
+
+static const char *__doc_mitsuba_Mesh_m_area_alias = R"doc(Alias table built alongside m_area_pmf when m_alias_sampling is set)doc";
+
 static const char *__doc_mitsuba_Mesh_m_area_pmf = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_bbox = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_cutout = R"doc(Cells of the UV square where the BSDF is fully transparent)doc";
+
+static const char *__doc_mitsuba_Mesh_m_cutout_faces = R"doc(Host pointers to the buffers read by embree_cutout_filter())doc";
+
+static const char *__doc_mitsuba_Mesh_m_cutout_resolution = R"doc()doc";
+
+static const char *__doc_mitsuba_Mesh_m_cutout_texcoords = R"doc()doc";
+
 static const char *__doc_mitsuba_Mesh_m_face_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_face_normals =
@@ -4412,10 +5456,14 @@ static const char *__doc_mitsuba_Mesh_m_mutex = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_name = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_optix_faces = R"doc(Faces passed to OptiX, without the fully transparent triangles)doc";
+
 static const char *__doc_mitsuba_Mesh_m_parameterization = R"doc(Optional: used in eval_parameterization())doc";
 
 static const char *__doc_mitsuba_Mesh_m_scene = R"doc(Pointer to the scene that owns this mesh)doc";
 
+static const char *__doc_mitsuba_Mesh_m_tangents = R"doc(Precompute per-vertex tangents in initialize()?)doc";
+
 static const char *__doc_mitsuba_Mesh_m_vertex_buffer_ptr = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_vertex_count = R"doc()doc";
@@ -4424,10 +5472,20 @@ static const char *__doc_mitsuba_Mesh_m_vertex_normals = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_vertex_positions = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_vertex_tangents = R"doc(Precomputed tangent frames (see recompute_vertex_tangents()))doc";
+
 static const char *__doc_mitsuba_Mesh_m_vertex_texcoords = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_merge = R"doc(Merge two meshes into one)doc";
 
+static const char *__doc_mitsuba_Mesh_merge_2 =
+R"doc(Merge a list of compatible meshes into one
+
+All inputs must reference the same BSDF, media, emitter, and sensor and
+store the same set of vertex attributes. The merged buffers are
+allocated once and filled in parallel, which is much faster than a
+sequence of pairwise merge() calls for many small meshes.)doc";
+
 static const char *__doc_mitsuba_Mesh_moeller_trumbore =
 R"doc(Moeller and Trumbore algorithm for computing ray-triangle intersection
 
@@ -4455,6 +5513,8 @@ Returns:
 
 static const char *__doc_mitsuba_Mesh_optix_build_input = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_optix_faces = R"doc(Return the faces passed to OptiX (see update_cutout()))doc";
+
 static const char *__doc_mitsuba_Mesh_optix_prepare_geometry = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_parameters_changed = R"doc()doc";
@@ -4465,6 +5525,21 @@ static const char *__doc_mitsuba_Mesh_pdf_position = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_primitive_count = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_quantize_attributes =
+R"doc(Convert the vertex normals and texture coordinates to the quantized
+representation (see quantized())
+
+This is done automatically at the end of initialize() when the mesh
+was created with the ``quantize`` property set to ``True``.)doc";
+
+static const char *__doc_mitsuba_Mesh_quantized =
+R"doc(Are vertex normals and texture coordinates stored in quantized form?
+
+Quantized meshes store normals as 2x16 bit octahedral coordinates and
+texture coordinates as two half-precision values. The float buffers
+returned by vertex_normals_buffer() and vertex_texcoords_buffer() are
+empty in this case.)doc";
+
 static const char *__doc_mitsuba_Mesh_ray_intersect_triangle = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_ray_intersect_triangle_impl =
@@ -4498,15 +5573,49 @@ static const char *__doc_mitsuba_Mesh_recompute_bbox = R"doc(Recompute the bound
 
 static const char *__doc_mitsuba_Mesh_recompute_vertex_normals = R"doc(Compute smooth vertex normals and replace the current normal values)doc";
 
+static const char *__doc_mitsuba_Mesh_recompute_vertex_tangents =
+R"doc(Precompute per-vertex tangent frames from the texture coordinates
+
+The per-face UV parameterization derivatives are accumulated at the
+vertices (weighted by face area) and orthogonalized against the vertex
+normals, similar to MikkTSpace. Interpolating them yields tangent
+frames that vary continuously across faces, which are then used for
+``dp_du`` and ``dp_dv`` in compute_surface_interaction().
+
+This is done automatically in initialize() when the mesh was created
+with the ``tangents`` property set to ``True``.)doc";
+
 static const char *__doc_mitsuba_Mesh_sample_position = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_set_scene = R"doc()doc";
 
-static const char *__doc_mitsuba_Mesh_surface_area = R"doc()doc";
+static const char *__doc_mitsuba_Mesh_surface_area = R"doc()doc";
+
+static const char *__doc_mitsuba_Mesh_to_string = R"doc(Return a human-readable string representation of the shape contents.)doc";
+
+static const char *__doc_mitsuba_Mesh_topology_hash =
+R"doc(Hash the transformation-invariant contents of the mesh
+
+The hash covers the face indices, texture coordinates, and attribute
+flags, but not the vertex positions and normals. Meshes that only
+differ by their ``to_world`` transformation produce the same hash (see
+instance_transform()).)doc";
+
+static const char *__doc_mitsuba_Mesh_traverse = R"doc(@})doc";
+
+static const char *__doc_mitsuba_Mesh_update_cutout =
+R"doc(Update the map of the fully transparent regions of the surface that
+ray tracing skips (see BSDF::opacity_texture())
 
-static const char *__doc_mitsuba_Mesh_to_string = R"doc(Return a human-readable string representation of the shape contents.)doc";
+Embree discards the hits in these regions with a filter function, and
+the OptiX geometry replaces the triangles that lie entirely inside of
+them by degenerate ones. Called when the geometry is created or
+updated, and when the scene parameters change, since the opacity
+texture may have changed. Returns ``True`` when the map changed.)doc";
 
-static const char *__doc_mitsuba_Mesh_traverse = R"doc(@})doc";
+static const char *__doc_mitsuba_Mesh_update_memory =
+R"doc(Register the size of the vertex, face and attribute buffers with the
+MemoryTracker)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_count = R"doc(Return the total number of vertices)doc";
 
@@ -4530,6 +5639,32 @@ static const char *__doc_mitsuba_Mesh_vertex_texcoords_buffer = R"doc(Return ver
 
 static const char *__doc_mitsuba_Mesh_vertex_texcoords_buffer_2 = R"doc(Const variant of vertex_texcoords_buffer.)doc";
 
+static const char *__doc_mitsuba_Mesh_vertex_tangent =
+R"doc(Returns the tangent of the vertex with index ``index``
+
+The first three components store the tangent direction ``dp_du``
+(orthogonal to the vertex normal), and the last component stores the
+signed length of ``dp_dv``, whose sign encodes the handedness of the
+tangent frame.)doc";
+
+static const char *__doc_mitsuba_Mesh_vertex_tangents_buffer = R"doc(Return vertex tangents buffer (see recompute_vertex_tangents()))doc";
+
+static const char *__doc_mitsuba_Mesh_vertex_tangents_buffer_2 = R"doc(Const variant of vertex_tangents_buffer.)doc";
+
+static const char *__doc_mitsuba_Mesh_write_bundle =
+R"doc(Write several meshes to a single bundle file, which can be loaded by
+the ``bundle`` shape plugin
+
+The world-space vertex and face buffers are stored uncompressed, in
+native byte order, and aligned to page boundaries, so that the plugin
+can read them from a memory mapping without any parsing.
+
+Parameter ``filename``:
+    Target file path on disk
+
+Parameter ``meshes``:
+    Meshes to be stored (mesh attributes are not supported))doc";
+
 static const char *__doc_mitsuba_Mesh_write_ply =
 R"doc(Write the mesh to a binary PLY file
 
@@ -4757,6 +5892,99 @@ static const char *__doc_mitsuba_Normal_operator_assign = R"doc()doc";
 
 static const char *__doc_mitsuba_Normal_operator_assign_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_OIDNDenoiser =
+R"doc(Wrapper for the Intel Open Image Denoise (OIDN) CPU denoiser
+
+This class provides the same interface as OptixDenoiser for machines
+without an NVIDIA GPU. It can be used with scalar and LLVM variants.
+The denoiser runs on all threads of Mitsuba's thread pool (see
+Thread::thread_count()).
+
+Inputs are passed to OIDN without copies whenever possible: the pixel
+data of TensorXf and single-precision Bitmap inputs (including
+individual layers of MultiChannel bitmaps) is referenced in place. A
+temporary copy is only made of normals that must be transformed, and
+of layers that are not stored in single precision.
+
+Like OptiX, OIDN works best on noisy renderings that were produced
+with the `box` ReconstructionFilter. Unlike OptiX, OIDN does not
+denoise the alpha channel, which is copied from the noisy input, and
+does not provide a temporal mode.)doc";
+
+static const char *__doc_mitsuba_OIDNDenoiser_OIDNDenoiser =
+R"doc(Constructs an OIDN denoiser
+
+Parameter ``input_size``:
+    Resolution of noisy images that will be fed to the denoiser.
+
+Parameter ``albedo``:
+    Whether or not albedo information will also be given to the
+    denoiser.
+
+Parameter ``normals``:
+    Whether or not shading normals information will also be given to
+    the Denoiser.)doc";
+
+static const char *__doc_mitsuba_OIDNDenoiser_class = R"doc()doc";
+
+static const char *__doc_mitsuba_OIDNDenoiser_operator_call =
+R"doc(Apply denoiser on inputs which are TensorXf objects.
+
+Parameter ``noisy``:
+    The noisy input. (tensor shape: (width, height, 3 | 4))
+
+Parameter ``albedo``:
+    Albedo information of the noisy rendering. This parameter is
+    optional unless the OIDNDenoiser was built with albedo support.
+    (tensor shape: (width, height, 3))
+
+Parameter ``normals``:
+    Shading normal information of the noisy rendering. This parameter
+    is optional unless the OIDNDenoiser was built with normals
+    support. (tensor shape: (width, height, 3))
+
+Parameter ``to_sensor``:
+    A Transform4f which is applied to the ``normals`` parameter before
+    denoising. OIDN accepts normals in any coordinate frame, so this
+    is only needed for consistency between frames. This parameter is
+    optional, by default no transformation is applied.
+
+Returns:
+    The denoised input.)doc";
+
+static const char *__doc_mitsuba_OIDNDenoiser_operator_call_2 =
+R"doc(Apply denoiser on inputs which are Bitmap objects.
+
+Parameter ``noisy``:
+    The noisy input. When passing additional information like albedo
+    or normals to the denoiser, this Bitmap object must be a
+    MultiChannel bitmap.
+
+Parameter ``albedo_ch``:
+    The name of the channel in the ``noisy`` parameter which contains
+    the albedo information of the noisy rendering. This parameter is
+    optional unless the OIDNDenoiser was built with albedo support.
+
+Parameter ``normals_ch``:
+    The name of the channel in the ``noisy`` parameter which contains
+    the shading normal information of the noisy rendering. This
+    parameter is optional unless the OIDNDenoiser was built with
+    normals support.
+
+Parameter ``to_sensor``:
+    A Transform4f which is applied to the ``normals`` parameter before
+    denoising. This parameter is optional, by default no
+    transformation is applied.
+
+Parameter ``noisy_ch``:
+    The name of the channel in the ``noisy`` parameter which contains
+    the noisy rendering.
+
+Returns:
+    The denoised input.)doc";
+
+static const char *__doc_mitsuba_OIDNDenoiser_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_Object =
 R"doc(Object base class with builtin reference counting
 
@@ -5041,6 +6269,30 @@ Parameter ``noisy_ch``:
 Returns:
     The denoised input.)doc";
 
+static const char *__doc_mitsuba_OptixDenoiser_pending = R"doc(Return the number of frames that were submitted but not yet retrieved)doc";
+
+static const char *__doc_mitsuba_OptixDenoiser_reset = R"doc(Start a new temporal sequence (drops the previous denoised frame))doc";
+
+static const char *__doc_mitsuba_OptixDenoiser_result =
+R"doc(Return the denoised result of the oldest submitted frame
+
+This does not block the host: Dr.Jit kernels that use the returned
+tensor are ordered after the denoiser's work on the GPU.)doc";
+
+static const char *__doc_mitsuba_OptixDenoiser_submit =
+R"doc(Queue a frame for denoising and return without waiting for it
+
+The arguments are the same as those of the TensorXf variant of
+operator()(). The inputs are evaluated on the Dr.Jit stream, after
+which the denoiser's own stream denoises them concurrently with any
+work that is subsequently launched by Dr.Jit. Frames are retrieved in
+submission order with result().
+
+In temporal mode, ``flow`` and ``previous_denoised`` are optional: the
+flow then defaults to zero, and the previous denoised frame to the
+result of the last submitted frame (or the noisy input for the first
+frame after construction or reset()).)doc";
+
 static const char *__doc_mitsuba_OptixDenoiser_to_string = R"doc()doc";
 
 static const char *__doc_mitsuba_OptixDenoiser_validate_input = R"doc(Helper function to validate tensor sizes)doc";
@@ -5290,6 +6542,12 @@ static const char *__doc_mitsuba_PluginManager_create_object_2 = R"doc(Convenien
 
 static const char *__doc_mitsuba_PluginManager_d = R"doc()doc";
 
+static const char *__doc_mitsuba_PluginManager_available_plugins =
+R"doc(Return the list of plugins that are listed in the plugin manifest
+generated by the build system, without loading them
+
+The list is empty if no manifest was found.)doc";
+
 static const char *__doc_mitsuba_PluginManager_ensure_plugin_loaded = R"doc(Ensure that a plugin is loaded and ready)doc";
 
 static const char *__doc_mitsuba_PluginManager_get_plugin_class = R"doc(Return the class corresponding to a plugin for a specific variant)doc";
@@ -6077,6 +7335,8 @@ static const char *__doc_mitsuba_ReconstructionFilter_is_box_filter = R"doc(Chec
 
 static const char *__doc_mitsuba_ReconstructionFilter_m_border_size = R"doc()doc";
 
+static const char *__doc_mitsuba_ReconstructionFilter_m_distr = R"doc(Tabulated absolute value of the filter used by sample())doc";
+
 static const char *__doc_mitsuba_ReconstructionFilter_m_radius = R"doc()doc";
 
 static const char *__doc_mitsuba_ReconstructionFilter_m_scale_factor = R"doc()doc";
@@ -6085,6 +7345,21 @@ static const char *__doc_mitsuba_ReconstructionFilter_m_values = R"doc()doc";
 
 static const char *__doc_mitsuba_ReconstructionFilter_radius = R"doc(Return the filter's width)doc";
 
+static const char *__doc_mitsuba_ReconstructionFilter_sample =
+R"doc(Importance sample the (separable) filter function
+
+Generates an offset from the pixel center that is distributed
+proportionally to the absolute value of the filter, using a tabulated
+version of it. This allows adding every sample to a single pixel with a
+box weight instead of splatting it over the filter footprint.
+
+Parameter ``sample``:
+    A uniformly distributed sample on ``[0, 1]^2``
+
+Returns:
+    The offset, and the ratio between the filter value and the sample
+    density (which is negative within negative lobes of the filter).)doc";
+
 static const char *__doc_mitsuba_Resampler =
 R"doc(Utility class for efficiently resampling discrete datasets to
 different resolutions
@@ -6112,6 +7387,10 @@ static const char *__doc_mitsuba_Resampler_boundary_condition =
 R"doc(Return the boundary condition that should be used when looking up
 samples outside of the defined input domain)doc";
 
+static const char *__doc_mitsuba_Resampler_boundary_position =
+R"doc(Map an out-of-range sample position according to the
+(clamp/repeat/mirror) boundary condition)doc";
+
 static const char *__doc_mitsuba_Resampler_clamp =
 R"doc(Returns the range to which resampled values will be clamped
 
@@ -6158,6 +7437,30 @@ Parameter ``target_stride``:
 Parameter ``channels``:
     Number of channels to be resampled)doc";
 
+static const char *__doc_mitsuba_Resampler_resample_rows =
+R"doc(Resample a 2D array of samples along its rows (i.e. vertically)
+
+This is equivalent to calling resample() for every column of the
+array, but accumulates entire source rows into each target row. The
+memory accesses are thus sequential and the inner loop vectorizes,
+whereas resampling the columns of a large image individually is
+limited by cache misses.
+
+Parameter ``source``:
+    Source array with source_resolution() rows
+
+Parameter ``target``:
+    Target array with target_resolution() rows
+
+Parameter ``row_size``:
+    Number of samples per row (i.e. the width times the channel count)
+
+Parameter ``first``:
+    Index of the first target row that should be computed
+
+Parameter ``last``:
+    One past the index of the last target row that should be computed)doc";
+
 static const char *__doc_mitsuba_Resampler_resample_internal = R"doc()doc";
 
 static const char *__doc_mitsuba_Resampler_set_boundary_condition =
@@ -6260,7 +7563,7 @@ static const char *__doc_mitsuba_Sampler_compute_per_sequence_seed =
 R"doc(Generates a array of seeds where the seed values are unique per
 sequence)doc";
 
-static const char *__doc_mitsuba_Sampler_current_sample_index = R"doc(Return the index of the current sample)doc";
+static const char *__doc_mitsuba_Sampler_current_sample_index = R"doc(Return the index of the current sample of every pixel)doc";
 
 static const char *__doc_mitsuba_Sampler_fork =
 R"doc(Create a fork of this sampler.
@@ -6301,6 +7604,14 @@ the wavefront.)doc";
 
 static const char *__doc_mitsuba_Sampler_seeded = R"doc(Return whether the sampler was seeded)doc";
 
+static const char *__doc_mitsuba_Sampler_set_pixel_position =
+R"doc(Inform the sampler about the pixel associated with each sequence
+
+Invoked by the rendering algorithm after seed(). Samplers that
+distribute the error over the image plane (e.g. using a blue-noise
+dither mask) rely on this information, while the default
+implementation ignores it.)doc";
+
 static const char *__doc_mitsuba_Sampler_set_sample_count = R"doc(Set the number of samples per pixel)doc";
 
 static const char *__doc_mitsuba_Sampler_set_samples_per_wavefront =
@@ -6334,6 +7645,29 @@ static const char *__doc_mitsuba_SamplingIntegrator_class = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_m_block_size = R"doc(Size of (square) image blocks to render in parallel (in scalar mode))doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_load_state =
+R"doc(Restore the film storage saved by save_state()
+
+Throws if the state does not match the current render configuration.
+Returns the number of completed passes.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_filter_sampling =
+R"doc(Importance sample the reconstruction filter of the film
+
+Every camera sample is offset from its pixel center proportionally to
+the filter and added to that pixel alone (weighted by the ratio of the
+filter and the sample density), instead of being splatted over the
+footprint of the filter.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_priority_offset =
+R"doc(Region of interest (in film pixels, including the crop offset) whose
+image blocks are rendered first (in scalar mode)
+
+Without a pass barrier, all passes over the region are rendered before
+the rest of the image. A size of zero disables the region.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_priority_size = R"doc()doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_samples_per_pass =
 R"doc(Number of samples to compute for each pass over the image blocks.
 
@@ -6346,6 +7680,17 @@ static const char *__doc_mitsuba_SamplingIntegrator_render_block = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render_sample = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_render_tile =
+R"doc(Render a single tile of an image split across several processes
+
+This renders the same samples as a single-pass call to render() would
+for the tile with the given identifier and block size (see
+Spiral::next_tile()). It is only supported in scalar variants.
+
+Parameter ``seed``:
+    Seed of the render, already multiplied by the pixel count of the
+    (possibly border-extended) film as done by render())doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_sample =
 R"doc(Sample the incident radiance along a ray.
 
@@ -6389,6 +7734,32 @@ Remark:
 (spec, mask, aov) = integrator.sample(scene, sampler, ray, medium, active)
 ```)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_save_state = R"doc(Write the film storage and progress of a render to m_state_file)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_set_state_file =
+R"doc(Save the render state to a file after every completed pass
+
+The state consists of the accumulated film storage, the number of
+completed passes and the seed and sample counts used by the render. It
+is only saved in scalar variants and when adaptive sampling is
+disabled. Use ``samples_per_pass`` to save it more often.
+
+Parameter ``path``:
+    Filename of the state. An empty path disables saving the state.
+
+Parameter ``resume``:
+    If the file already exists, load it and continue rendering with
+    the first incomplete pass. The result matches that of an
+    uninterrupted render with the same seed and sample count.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_variance_aovs =
+R"doc(Return the AOVs whose per-pixel sample variance is recorded by
+render() (see ImageBlock::set_variance())
+
+The result contains the index of the first source and target AOV
+(into aov_names()) and the number of AOVs. The default implementation
+returns a count of zero, which disables the feature.)doc";
+
 static const char *__doc_mitsuba_Scene =
 R"doc(Central scene data structure
 
@@ -6419,7 +7790,63 @@ static const char *__doc_mitsuba_Scene_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_5 = R"doc()doc";
 
-static const char *__doc_mitsuba_Scene_Scene = R"doc(Instantiate a scene from a Properties object)doc";
+static const char *__doc_mitsuba_Scene_Scene =
+R"doc(Instantiate a scene from a Properties object
+
+When the ``merge_bsdfs`` property is set to ``True``, the BSDFs of all
+shapes that are instances of the same plugin with identical
+configuration and constant parameters are merged into a single BSDF
+per group (see BSDF::merge()). This reduces the number of virtual
+function calls in vectorized variants, but the parameters of the
+merged BSDFs can no longer be changed (e.g. through ``traverse()``).
+
+Similarly, the ``flatten_bsdfs`` property removes adapter BSDFs that
+don't alter the response of the BSDF they wrap (see BSDF::flatten()).
+Flattening happens before merging.
+
+When the ``instance_meshes`` property is set to ``True``, meshes that
+only differ by their ``to_world`` transformation (e.g. several ``ply``,
+``obj``, or ``serialized`` shapes loading the same geometry) are
+detected by hashing their face and texture coordinate buffers and
+comparing the transformed vertices of the candidates. Every set of
+duplicates is replaced by a shape group containing a single copy of
+the geometry and one instance per mesh, which saves memory and
+acceleration data structure construction time. Meshes with attached
+emitters, sensors, or mesh attributes are never instanced, and the
+vertex buffers of the replaced meshes are no longer exposed through
+``traverse()``.
+
+In CPU variants without Embree, the ``accel_type`` property selects
+the acceleration data structure: a SAH kd-tree (``kdtree``, the
+default) or a four-wide BVH (``bvh``). The BVH traverses instances as
+the top level of a two-level hierarchy and is usually faster for
+scenes with many overlapping instances.
+
+In CPU variants using Embree, the ``embree_build_quality`` property
+(``low``, ``medium``, or ``high``, the default) selects the quality of
+the BVH built over the scene, trading construction time for tracing
+performance. The boolean properties ``embree_compact``,
+``embree_robust``, and ``embree_dynamic`` respectively request a more
+compact BVH, more robust (but slower) intersection tests, and a
+two-level BVH that is faster to update. The latter is enabled by
+default when a shape sets its ``embree_build`` property to
+``dynamic``.
+
+In CUDA variants, the ``optix_allow_update`` property builds the OptiX
+acceleration data structures such that they can be refit in place,
+which is much faster than a rebuild when only vertex positions or
+instance transformations change (e.g. in an optimization loop). The
+refit structures trace slightly slower, and a full rebuild still
+happens when the number of primitives of a shape changes.
+
+When the ``emitter_cache`` property is set to ``True``, an
+EmitterCache learns the visible contribution of every emitter over a
+hashed grid of ``emitter_cache_resolution`` cells along the longest
+axis of the scene (default: 32) with ``emitter_cache_entries`` table
+entries (default: 16384). Sampling integrators update it after each of
+the first ``emitter_cache_passes`` rendering passes (default: 4), and
+sample_emitter_direction() then mostly chooses emitters from it. This
+requires multiple passes.)doc";
 
 static const char *__doc_mitsuba_Scene_accel_init_cpu = R"doc(Create the ray-intersection acceleration data structure)doc";
 
@@ -6433,12 +7860,40 @@ static const char *__doc_mitsuba_Scene_accel_release_cpu = R"doc(Release the ray
 
 static const char *__doc_mitsuba_Scene_accel_release_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_accel_stats =
+R"doc(Return build statistics of the ray tracing acceleration data
+structure (updated on every build or refit))doc";
+
+static const char *__doc_mitsuba_Scene_accel_traversal_stats =
+R"doc(Measure the traversal cost of the native acceleration data
+structures (kd-tree or BVH) using random rays
+
+The rays connect pairs of uniformly distributed points on the bounding
+sphere of the scene, which yields the distribution of lines assumed by
+the surface area heuristic. Unusually high counts compared to the SAH
+cost reported by accel_stats() point at geometry that the builder
+handles poorly, e.g. long and thin triangles or heavily overlapping
+instances. The rays are traced on the calling thread.
+
+This function is not available for the Embree and OptiX backends,
+whose traversal is not instrumented.
+
+Parameter ``ray_count``:
+    Number of random rays
+
+Parameter ``seed``:
+    Seed of the random number generator)doc";
+
+static const char *__doc_mitsuba_Scene_accel_traversal_stats_cpu = R"doc(Trace random rays through the native acceleration data structure)doc";
+
 static const char *__doc_mitsuba_Scene_bbox = R"doc(Return a bounding box surrounding the scene)doc";
 
 static const char *__doc_mitsuba_Scene_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_clear_shapes_dirty = R"doc(Unmarks all shapes as dirty)doc";
 
+static const char *__doc_mitsuba_Scene_emitter_cache = R"doc(Return the emitter cache (if enabled))doc";
+
 static const char *__doc_mitsuba_Scene_emitters = R"doc(Return the list of emitters)doc";
 
 static const char *__doc_mitsuba_Scene_emitters_2 = R"doc(Return the list of emitters (const version))doc";
@@ -6482,6 +7937,10 @@ Returns:
     The incident radiance and discrete or solid angle density of the
     sample.)doc";
 
+static const char *__doc_mitsuba_Scene_flatten_bsdfs = R"doc(Flatten the networks of nested BSDFs of the shapes in the scene)doc";
+
+static const char *__doc_mitsuba_Scene_instance_meshes = R"doc(Replace meshes that are transformed copies of each other by instances)doc";
+
 static const char *__doc_mitsuba_Scene_integrator = R"doc(Return the scene's integrator)doc";
 
 static const char *__doc_mitsuba_Scene_integrator_2 = R"doc(Return the scene's integrator)doc";
@@ -6494,6 +7953,18 @@ static const char *__doc_mitsuba_Scene_m_bbox = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_children = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_emitter_alias = R"doc(Alias table replacing m_emitter_distr when ``alias_sampling`` is set)doc";
+
+static const char *__doc_mitsuba_Scene_m_emitter_cache =
+R"doc(Learned emitter selection used by sample_emitter_direction()
+(optional))doc";
+
+static const char *__doc_mitsuba_Scene_m_emitter_cache_entries = R"doc()doc";
+
+static const char *__doc_mitsuba_Scene_m_emitter_cache_passes = R"doc()doc";
+
+static const char *__doc_mitsuba_Scene_m_emitter_cache_resolution = R"doc()doc";
+
 static const char *__doc_mitsuba_Scene_m_emitter_pmf = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_emitters = R"doc()doc";
@@ -6504,6 +7975,8 @@ static const char *__doc_mitsuba_Scene_m_environment = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_integrator = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_ray_flags = R"doc(Surface interaction fields needed by the scene (see ray_flags()))doc";
+
 static const char *__doc_mitsuba_Scene_m_sensors = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_shapegroups = R"doc()doc";
@@ -6514,6 +7987,10 @@ static const char *__doc_mitsuba_Scene_m_shapes_dr = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_shapes_grad_enabled = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_use_emitter_cache = R"doc()doc";
+
+static const char *__doc_mitsuba_Scene_merge_bsdfs = R"doc(Merge compatible BSDF instances of the shapes in the scene)doc";
+
 static const char *__doc_mitsuba_Scene_parameters_changed = R"doc(Update internal state following a parameter update)doc";
 
 static const char *__doc_mitsuba_Scene_pdf_emitter =
@@ -6539,6 +8016,19 @@ Parameter ``ds``:
 Returns:
     The solid angle density of the sample)doc";
 
+static const char *__doc_mitsuba_Scene_ray_flags =
+R"doc(Return the smallest combination of RayFlags that provides the
+fields of the surface interaction accessed by the scene's BSDFs,
+textures and emitters
+
+The flags are derived from the BSDFs (see BSDF::ray_flags()) and
+textures reachable from the shapes when the scene is loaded or its
+parameters change. For example, UV coordinates are only computed when
+a texture is spatially varying, and their position partials when a
+BSDF is anisotropic or perturbs the shading frame. Integrators pass
+these flags to ray_intersect() to skip the computation of unused
+fields on every hit.)doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect =
 R"doc(Intersect a ray with the shapes comprising the scene and return a
 detailed data structure describing the intersection, if one is found.
@@ -6692,6 +8182,29 @@ Returns:
     method should be queried to check if an intersection was actually
     found.)doc";
 
+static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_batch =
+R"doc(Find the preliminary intersections of a batch of rays
+
+This function is equivalent to calling ray_intersect_preliminary() for
+each entry of ``rays`` and storing the results in ``result``. It is
+meant for applications that trace many independent rays with the
+scalar variants. In scalar variants using Embree, the rays are traced
+in packets of 16 using Embree's packet traversal
+(<tt>rtcIntersect16</tt>). The other variants trace the rays
+individually. Large batches are split into chunks that are traced in
+parallel on Mitsuba's thread pool.
+
+Parameter ``rays``:
+    Array of ``count`` rays
+
+Parameter ``active``:
+    Array of ``count`` masks. Inactive rays are reported as misses.
+
+Parameter ``result``:
+    Output array of ``count`` preliminary intersection records)doc";
+
+static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_batch_cpu = R"doc()doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_cpu = R"doc(Trace a ray and only return a preliminary intersection data structure)doc";
 
 static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_gpu = R"doc()doc";
@@ -6754,6 +8267,31 @@ Parameter ``coherent``:
 Returns:
     ``True`` if an intersection was found)doc";
 
+static const char *__doc_mitsuba_Scene_ray_test_batch =
+R"doc(Test a batch of rays for occlusion
+
+This function is equivalent to calling ray_test() for each entry of
+``rays`` and storing the results in ``occluded``. In scalar variants
+using Embree, the rays are traced in packets of 16 using Embree's
+packet traversal (<tt>rtcOccluded16</tt>), which uses SIMD
+instructions across rays and is more efficient than tracing them one
+after the other (e.g. for the shadow rays of several emitter samples
+at the same shading point). The other variants trace the rays
+individually. Large batches are split into chunks that are
+traced in parallel on Mitsuba's thread pool.
+
+Parameter ``rays``:
+    Array of ``count`` rays to be tested
+
+Parameter ``active``:
+    Array of ``count`` masks. Inactive rays are reported as unoccluded.
+
+Parameter ``occluded``:
+    Output array of ``count`` masks set to ``true`` where an
+    intersection was found)doc";
+
+static const char *__doc_mitsuba_Scene_ray_test_batch_cpu = R"doc()doc";
+
 static const char *__doc_mitsuba_Scene_ray_test_cpu = R"doc(Trace a shadow ray)doc";
 
 static const char *__doc_mitsuba_Scene_ray_test_gpu = R"doc()doc";
@@ -6762,8 +8300,12 @@ static const char *__doc_mitsuba_Scene_sample_emitter =
 R"doc(Sample one emitter in the scene and rescale the input sample for
 reuse.
 
-Currently, the sampling scheme implemented by the Scene class is very
-simplistic (uniform).
+Emitters are chosen uniformly unless some of them specify a custom
+``sampling_weight``, in which case they are chosen proportionally to
+it. This discrete distribution is searched in O(log n) by default;
+setting the scene's ``alias_sampling`` property to ``True`` instead
+builds an alias table with O(1) lookups. The latter does not preserve
+the stratification of ``index_sample``.
 
 Parameter ``sample``:
     A uniformly distributed number in [0, 1).
@@ -6888,17 +8430,31 @@ static const char *__doc_mitsuba_Scene_to_string = R"doc(Return a human-readable
 
 static const char *__doc_mitsuba_Scene_traverse = R"doc(Traverse the scene graph and invoke the given callback for each object)doc";
 
+static const char *__doc_mitsuba_Scene_update_emitter_cache =
+R"doc(Discard the learned data by creating a new m_emitter_cache (if
+enabled))doc";
+
+static const char *__doc_mitsuba_Scene_update_ray_flags = R"doc(Derive m_ray_flags from the BSDFs and textures of the shapes)doc";
+
 static const char *__doc_mitsuba_ScopedPhase = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_ScopedPhase = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_ScopedPhase_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedPhase_m_phase = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedPhase_m_trace_start = R"doc(Start of the phase for Trace, or zero if no trace is recorded)doc";
+
 static const char *__doc_mitsuba_ScopedPhase_operator_assign = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment =
 R"doc(RAII-style class to temporarily switch to another thread's logger/file
-resolver)doc";
+resolver
+
+Nothing is swapped (and no reference counts change) when the calling
+thread already uses the given environment. Otherwise, the previous
+logger and file resolver are restored by the destructor.)doc";
 
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_ScopedSetThreadEnvironment = R"doc()doc";
 
@@ -6906,10 +8462,33 @@ static const char *__doc_mitsuba_ScopedSetThreadEnvironment_ScopedSetThreadEnvir
 
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_file_resolver = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_generation = R"doc()doc";
+
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_logger = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_thread = R"doc()doc";
+
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_operator_assign = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedTraceEvent =
+R"doc(Record the time range from the construction until the destruction of
+this object in the timeline of Trace
+
+The name and category must be string literals (or otherwise outlive
+the trace), as only the pointers are stored.)doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_ScopedTraceEvent = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_ScopedTraceEvent_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_category = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_name = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_start = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_operator_assign = R"doc()doc";
+
 static const char *__doc_mitsuba_Sensor = R"doc()doc";
 
 static const char *__doc_mitsuba_Sensor_2 = R"doc()doc";
@@ -7042,6 +8621,15 @@ This class provides core functionality for sampling positions on
 surfaces, computing ray intersections, and bounding shapes within ray
 intersection acceleration data structures.)doc";
 
+static const char *__doc_mitsuba_ShapeBVH_memory = R"doc(Return the memory used by the nodes and the index list (bytes))doc";
+
+static const char *__doc_mitsuba_ShapeBVH_sah_cost =
+R"doc(Return the SAH cost of the hierarchy, i.e. the expected cost of
+tracing a random ray that intersects the bounding box of the BVH
+(relative to ``bvh_intersection_cost`` and ``bvh_traversal_cost``))doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_memory = R"doc(Return the memory used by the nodes, indices and packed leaves (bytes))doc";
+
 static const char *__doc_mitsuba_Shape_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_3 = R"doc()doc";
@@ -7171,7 +8759,11 @@ static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_naive = R"doc(Brute f
 
 static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_preliminary = R"doc()doc";
 
-static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_scalar = R"doc()doc";
+static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_scalar =
+R"doc(Trace a single ray through the kd-tree
+
+When ``Count`` is set, the visited nodes and primitive intersection
+tests are accumulated into ``counters``.)doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_shape = R"doc(Return the i-th shape (const version))doc";
 
@@ -7208,6 +8800,10 @@ static const char *__doc_mitsuba_Shape_bsdf = R"doc(Return the shape's BSDF)doc"
 
 static const char *__doc_mitsuba_Shape_bsdf_2 = R"doc(Return the shape's BSDF)doc";
 
+static const char *__doc_mitsuba_Shape_bsdf_index =
+R"doc(Return the index of the shape's original BSDF within its merged BSDF
+(see BSDF::merge()), and zero otherwise)doc";
+
 static const char *__doc_mitsuba_Shape_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_compute_surface_interaction =
@@ -7250,6 +8846,15 @@ the scene by this shape
 Includes instanced geometry. The default implementation simply returns
 the same value as primitive_count().)doc";
 
+static const char *__doc_mitsuba_Shape_embree_build_mode = R"doc(Return how the Embree BVH of this shape is built and updated)doc";
+
+static const char *__doc_mitsuba_Shape_embree_build_quality =
+R"doc(Return the Embree build quality of this shape's geometry
+
+Depends on the ``embree_build`` property of the shape. When ``update``
+is ``True``, the quality of an update of the geometry after a
+deformation is returned instead (e.g. ``RTC_BUILD_QUALITY_REFIT``).)doc";
+
 static const char *__doc_mitsuba_Shape_embree_geometry = R"doc(Return the Embree version of this shape)doc";
 
 static const char *__doc_mitsuba_Shape_emitter = R"doc(Return the area emitter associated with this shape (if any))doc";
@@ -7325,6 +8930,13 @@ static const char *__doc_mitsuba_Shape_exterior_medium = R"doc(Return the medium
 
 static const char *__doc_mitsuba_Shape_get_children_string = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_has_motion =
+R"doc(Does this shape move during the exposure?
+
+This is the case for instances with keyframed ``to_world``
+transformations, which require motion blur support by the ray tracing
+backend.)doc";
+
 static const char *__doc_mitsuba_Shape_id = R"doc(Return a string identifier)doc";
 
 static const char *__doc_mitsuba_Shape_initialize = R"doc()doc";
@@ -7349,8 +8961,12 @@ static const char *__doc_mitsuba_Shape_is_shapegroup = R"doc(Is this shape a sha
 
 static const char *__doc_mitsuba_Shape_m_bsdf = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_m_bsdf_index = R"doc()doc";
+
 static const char *__doc_mitsuba_Shape_m_dirty = R"doc(True if the shape's geometry has changed)doc";
 
+static const char *__doc_mitsuba_Shape_m_embree_build_mode = R"doc(How the Embree BVH of this shape is built and updated)doc";
+
 static const char *__doc_mitsuba_Shape_m_emitter = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_m_exterior_medium = R"doc()doc";
@@ -7534,6 +9150,14 @@ Returns:
     only used by the ShapeGroup class and be set to \c (uint32_t)-1
     otherwise.)doc";
 
+static const char *__doc_mitsuba_Shape_ray_intersect_primitive_scalar =
+R"doc(Scalar intersection test with a single primitive of the shape
+
+This operation is used by the native BVH for shapes that consist of
+several primitives (see primitive_count()) but aren't meshes. The
+default implementation ignores ``prim_index`` and forwards to
+ray_intersect_preliminary_scalar().)doc";
+
 static const char *__doc_mitsuba_Shape_ray_test =
 R"doc(Fast ray shadow test
 
@@ -7554,6 +9178,8 @@ static const char *__doc_mitsuba_Shape_ray_test_packet_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_ray_test_packet_3 = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_ray_test_primitive_scalar = R"doc(Shadow ray variant of ray_intersect_primitive_scalar())doc";
+
 static const char *__doc_mitsuba_Shape_ray_test_scalar = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_sample_direction =
@@ -7604,6 +9230,13 @@ static const char *__doc_mitsuba_Shape_sensor = R"doc(Return the area sensor ass
 
 static const char *__doc_mitsuba_Shape_sensor_2 = R"doc(Return the area sensor associated with this shape (if any))doc";
 
+static const char *__doc_mitsuba_Shape_set_bsdf =
+R"doc(Replace the shape's BSDF
+
+Parameter ``index``:
+    When ``bsdf`` merges several BSDF instances, the index of the
+    instance that describes the surface of this shape.)doc";
+
 static const char *__doc_mitsuba_Shape_set_id = R"doc(Set a string identifier)doc";
 
 static const char *__doc_mitsuba_Shape_surface_area =
@@ -7616,6 +9249,18 @@ The default implementation throws an exception.)doc";
 
 static const char *__doc_mitsuba_Shape_traverse = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_update_tessellation =
+R"doc(Adapt the tessellation of this shape to the sensors of a scene
+
+Called by the scene once all of its sensors are known and before the
+acceleration data structure is built. The default implementation does
+nothing.
+
+Returns:
+    ``True`` if the geometry (and hence the bounding box) changed)doc";
+
+static const char *__doc_mitsuba_SobolMaxDimension = R"doc(Number of dimensions provided by sobol_sample())doc";
+
 static const char *__doc_mitsuba_Spectrum =
 R"doc(//! @{ \name Data types for spectral quantities with sampled
 wavelengths)doc";
@@ -7655,12 +9300,16 @@ static const char *__doc_mitsuba_Spiral_block_count = R"doc(Return the total num
 
 static const char *__doc_mitsuba_Spiral_class = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_direction = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_is_priority_block =
+R"doc(Does the tile with the given identifier and block size (as returned by
+next_tile()) overlap the priority region?)doc";
 
 static const char *__doc_mitsuba_Spiral_m_block_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_block_counter = R"doc()doc";
 
+static const char *__doc_mitsuba_Spiral_m_block_end = R"doc()doc";
+
 static const char *__doc_mitsuba_Spiral_m_block_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_blocks = R"doc()doc";
@@ -7669,15 +9318,25 @@ static const char *__doc_mitsuba_Spiral_m_mutex = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_offset = R"doc()doc";
 
+static const char *__doc_mitsuba_Spiral_m_order = R"doc()doc";
+
+static const char *__doc_mitsuba_Spiral_m_pass_barrier = R"doc()doc";
+
+static const char *__doc_mitsuba_Spiral_m_pass_count = R"doc()doc";
+
 static const char *__doc_mitsuba_Spiral_m_passes_left = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_position = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_positions = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_size = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_priority = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_spiral_size = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_priority_count = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_steps_left = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_region_done = R"doc()doc";
+
+static const char *__doc_mitsuba_Spiral_m_region_first = R"doc()doc";
+
+static const char *__doc_mitsuba_Spiral_m_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_max_block_size = R"doc(Return the maximum block size)doc";
 
@@ -7686,10 +9345,123 @@ R"doc(Return the offset, size, and unique identifier of the next block.
 
 A size of zero indicates that the spiral traversal is done.)doc";
 
+static const char *__doc_mitsuba_Spiral_next_pass =
+R"doc(Continue with the next pass after stopping at a pass barrier
+
+Returns ``False`` if the current pass was the last one.)doc";
+
+static const char *__doc_mitsuba_Spiral_next_tile =
+R"doc(Return the offset, size, unique identifier, and block size of the next
+tile.
+
+This function behaves like next_block(), except that the returned tile
+may be a quadrant of a spiral block when adaptive splitting is
+enabled. The identifier and block size are chosen so that
+<tt>block_id * block_size^2</tt> plus the Morton index of a pixel
+within the tile matches the Morton index of that pixel within the
+unsplit parent block. Sample seeds are therefore independent of the
+splitting decisions.
+
+A size of zero indicates that the spiral traversal is done.)doc";
+
+static const char *__doc_mitsuba_Spiral_passes_left = R"doc(Return the number of passes that remain, including the current one)doc";
+
+static const char *__doc_mitsuba_Spiral_priority_block_count = R"doc(Return the number of blocks that overlap the priority region)doc";
+
+static const char *__doc_mitsuba_Spiral_record_time =
+R"doc(Record the time (in milliseconds) spent rendering the tile with the
+given identifier and block size, as returned by next_tile(). The
+measurements inform future splitting decisions.)doc";
+
 static const char *__doc_mitsuba_Spiral_reset =
 R"doc(Reset the spiral to its initial state. Does not affect the number of
 passes.)doc";
 
+static const char *__doc_mitsuba_Spiral_set_adaptive =
+R"doc(Enable adaptive splitting of expensive blocks
+
+When enabled, next_tile() subdivides blocks into quadrants ("tiles")
+that are placed onto a shared queue, from which idle workers take work
+before advancing the spiral. A block is split when its running cost
+(see record_time()) exceeds ``split_threshold`` times the average
+block cost, or when fewer than ``worker_count`` blocks remain in the
+final pass.
+
+Parameter ``worker_count``:
+    Number of workers consuming the tiles. A value of zero disables
+    adaptive splitting.
+
+Parameter ``min_block_size``:
+    Tiles are never split below this size (in pixels).
+
+Parameter ``split_threshold``:
+    Relative cost above which a block is subdivided.)doc";
+
+static const char *__doc_mitsuba_Spiral_set_pass_barrier =
+R"doc(Stop the traversal at the end of every pass
+
+When enabled, next_block() and next_tile() report that the traversal
+is done once all blocks of the current pass were generated, until
+next_pass() is called. This allows the caller to wait for all workers
+to finish a pass (e.g. to save the render state).)doc";
+
+static const char *__doc_mitsuba_Spiral_set_priority_region =
+R"doc(Generate the blocks that overlap a region of interest first
+
+The region is specified in the coordinates of the block offsets
+returned by next_block() (i.e. including the offset of the crop
+window). Without a pass barrier (see set_pass_barrier()), all passes
+over the blocks of the region are generated before the remaining
+blocks, so that the region converges first. With a pass barrier, the
+region comes first within every pass. Block identifiers, and thus the
+sample seeds, don't depend on the order. A region of size zero
+restores the default order.
+
+This function must be called before the traversal starts.)doc";
+
+static const char *__doc_mitsuba_Spiral_spiral_index = R"doc(Spiral index of a block (i.e. its ID in the first pass) given a tile ID)doc";
+
+static const char *__doc_mitsuba_Spiral_split_tile = R"doc(Split a tile into quadrants and append them to m_tiles)doc";
+
+static const char *__doc_mitsuba_Statistics =
+R"doc(Opt-in render statistics
+
+Collects the number of traced rays, BSDF and emitter samples, null
+collisions, and a histogram of path lengths. Scalar variants increment
+thread-local counters (padded to avoid false sharing) and JIT variants
+accumulate the counts on the device via atomic scatter-reductions,
+which are only read back when the statistics are queried.)doc";
+
+static const char *__doc_mitsuba_Statistics_elapsed = R"doc(Return the time in milliseconds since the last call to reset())doc";
+
+static const char *__doc_mitsuba_Statistics_enabled = R"doc(Is the collection of statistics currently enabled?)doc";
+
+static const char *__doc_mitsuba_Statistics_path_length_histogram = R"doc(Return the path length histogram (one entry per path length))doc";
+
+static const char *__doc_mitsuba_Statistics_reset = R"doc(Reset all counters to zero)doc";
+
+static const char *__doc_mitsuba_Statistics_set_enabled = R"doc(Enable or disable the collection of statistics (disabled by default))doc";
+
+static const char *__doc_mitsuba_Statistics_static_shutdown = R"doc(Free the device counters (called on shutdown))doc";
+
+static const char *__doc_mitsuba_Statistics_to_string = R"doc(Return a human-readable summary of the collected statistics)doc";
+
+static const char *__doc_mitsuba_Statistics_value = R"doc(Return the current value of a counter (summed over threads and backends))doc";
+
+static const char *__doc_mitsuba_StatsCounter = R"doc(Event counters that are collected by the Statistics subsystem)doc";
+
+static const char *__doc_mitsuba_StatsCounter_BSDFSample = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_EmitterSample = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_NullCollision = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_RayIntersect = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_RayTest = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_StatsCounterCount = R"doc()doc";
+
 static const char *__doc_mitsuba_Stream =
 R"doc(Abstract seekable stream class
 
@@ -7925,6 +9697,39 @@ case the same conversion is needed later on. Note that JIT compilation
 only works on x86_64 processors; other platforms use a slow generic
 fallback implementation.)doc";
 
+static const char *__doc_mitsuba_StructConverter_FastOp =
+R"doc(Precompiled operation of the fast conversion path
+
+Conversions that only permute fields (possibly with a change of byte
+order), or that expand 8-bit channels into floating point values, are
+compiled into a list of such operations when the converter is created.
+These are then applied to blocks of records using specialized loops
+instead of interpreting the field descriptors per record.)doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind_Copy = R"doc(Copy ``size`` bytes)doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind_Swap16 = R"doc(Copy ``size`` bytes while swapping the byte order of each word)doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind_Swap32 = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind_Swap64 = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind_UInt8ToFloat32 = R"doc(Look up an 8-bit value in m_fast_lut and store it as a float/double)doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_Kind_UInt8ToFloat64 = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_dst_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_kind = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_lut_offset = R"doc(Offset of the 256-entry table within m_fast_lut)doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_size = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FastOp_src_offset = R"doc()doc";
+
 static const char *__doc_mitsuba_StructConverter_StructConverter =
 R"doc(Construct an optimized conversion routine going from ``source`` to
 ``target``)doc";
@@ -7935,18 +9740,28 @@ static const char *__doc_mitsuba_StructConverter_Value_flags = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_Value_type = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_build_fast_path = R"doc(Compile m_fast_ops when the conversion admits the fast path)doc";
+
 static const char *__doc_mitsuba_StructConverter_class = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_convert = R"doc(Convert ``count`` elements. Returns ``True`` upon success)doc";
 
 static const char *__doc_mitsuba_StructConverter_convert_2d = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_convert_fast = R"doc(Convert ``count`` records using the operations in m_fast_ops)doc";
+
 static const char *__doc_mitsuba_StructConverter_linearize = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_load = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_m_dither = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_m_fast = R"doc(Can the conversion use the precompiled fast path?)doc";
+
+static const char *__doc_mitsuba_StructConverter_m_fast_lut = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_fast_ops = R"doc()doc";
+
 static const char *__doc_mitsuba_StructConverter_m_source = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_m_target = R"doc()doc";
@@ -8699,6 +10514,8 @@ R"doc(Return the number of primitives, at which the builder will switch from
 (approximate) Min-Max binning to the accurate O(n log n) optimization
 method.)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_index_count = R"doc(Return the number of primitive references stored in the leaves)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_log_level = R"doc(Return the log level of kd-tree status messages)doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_m_bbox = R"doc()doc";
@@ -8737,10 +10554,16 @@ static const char *__doc_mitsuba_TShapeKDTree_max_depth = R"doc(Return the maxim
 
 static const char *__doc_mitsuba_TShapeKDTree_min_max_bins = R"doc(Return the number of bins used for Min-Max binning)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_node_count = R"doc(Return the number of nodes)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_ready = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_retract_bad_splits = R"doc(Return whether or not bad splits can be "retracted".)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_sah_cost =
+R"doc(Return the SAH cost of the tree computed during the last build (NaN
+when the tree was loaded from a cache file))doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_set_clip_primitives = R"doc(Set whether primitive clipping is used during tree construction)doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_set_exact_primitive_threshold =
@@ -8772,10 +10595,25 @@ static const char *__doc_mitsuba_TensorFile =
 R"doc(Simple exchange format for tensor data of arbitrary rank and size
 
 This class provides convenient memory-mapped read-only access to
-tensor data, usually exported from NumPy.)doc";
+tensor data, usually exported from NumPy. Files are created using
+write(), which places every field at an offset that is a multiple
+of Alignment and can optionally compress individual fields.
+
+Uncompressed fields directly reference the mapped file, hence tables
+with precomputed data (e.g. lookup tables or cached distributions) load
+without parsing or copying, and array() can even expose them as
+Dr.Jit arrays without a copy in scalar and LLVM variants. Compressed
+fields are inflated into memory owned by the ``TensorFile`` when the
+file is opened.
+
+Version 1.0 files (without compression) remain readable.)doc";
+
+static const char *__doc_mitsuba_TensorFile_Alignment = R"doc(Alignment of the fields written by write() (in bytes))doc";
 
 static const char *__doc_mitsuba_TensorFile_Field = R"doc(Information about the specified field)doc";
 
+static const char *__doc_mitsuba_TensorFile_Field_compressed = R"doc(Is the field stored in compressed form within the file?)doc";
+
 static const char *__doc_mitsuba_TensorFile_Field_data = R"doc(Const pointer to the start of the tensor)doc";
 
 static const char *__doc_mitsuba_TensorFile_Field_dtype = R"doc(Data type (uint32, float, ...) of the tensor)doc";
@@ -8784,18 +10622,41 @@ static const char *__doc_mitsuba_TensorFile_Field_offset = R"doc(Offset within t
 
 static const char *__doc_mitsuba_TensorFile_Field_shape = R"doc(Specifies both rank and size along each dimension)doc";
 
+static const char *__doc_mitsuba_TensorFile_Field_size = R"doc(Return the number of entries of the tensor)doc";
+
 static const char *__doc_mitsuba_TensorFile_TensorFile = R"doc(Map the specified file into memory)doc";
 
+static const char *__doc_mitsuba_TensorFile_array =
+R"doc(Return the contents of a field as a flat Dr.Jit array
+
+The scalar type of ``Array`` must match the type of the field. In
+scalar and LLVM variants, the returned array references the data of
+the field without copying it (in LLVM variants, it also keeps the
+``TensorFile`` alive, while scalar arrays must not outlive it). CUDA
+variants copy the data to the device.)doc";
+
 static const char *__doc_mitsuba_TensorFile_class = R"doc()doc";
 
 static const char *__doc_mitsuba_TensorFile_field = R"doc(Return a data structure with information about the specified field)doc";
 
+static const char *__doc_mitsuba_TensorFile_field_names = R"doc(Return the names of all fields (in sorted order))doc";
+
 static const char *__doc_mitsuba_TensorFile_has_field = R"doc(Does the file contain a field of the specified name?)doc";
 
+static const char *__doc_mitsuba_TensorFile_m_buffers = R"doc()doc";
+
 static const char *__doc_mitsuba_TensorFile_m_fields = R"doc()doc";
 
 static const char *__doc_mitsuba_TensorFile_to_string = R"doc(Return a human-readable summary)doc";
 
+static const char *__doc_mitsuba_TensorFile_write =
+R"doc(Write a tensor file with the given fields
+
+Only the name, type, shape, data pointer and the ``compressed`` flag
+of the fields are used. Compressed fields are stored as raw deflate
+streams with the given zlib compression level, which reduces the size
+of the file but requires an inflated copy when it is opened.)doc";
+
 static const char *__doc_mitsuba_Texture =
 R"doc(Base class of all surface texture implementations
 
@@ -8902,6 +10763,31 @@ default implementation throws an exception.
 Even if the operation is provided, it may only return an
 approximation.)doc";
 
+static const char *__doc_mitsuba_Texture_merge =
+R"doc(Convenience function to merge the textures of several BSDF instances
+(see BSDF::merge())
+
+The resulting texture evaluates ``textures[i]`` on shapes whose
+Shape::bsdf_index() is equal to ``i``. Returns ``nullptr`` unless all
+textures share a non-empty merge_key(), or in spectral variants.)doc";
+
+static const char *__doc_mitsuba_Texture_merge_instances =
+R"doc(Merge several instances of this texture into a single one
+
+All instances must share the merge_key() of this texture. The default
+implementation stores the values of constant textures in a per-
+instance buffer (see the ``merged`` plugin). Returns ``nullptr`` when
+merging isn't possible.)doc";
+
+static const char *__doc_mitsuba_Texture_merge_key =
+R"doc(Return a key that identifies the configuration of this texture which
+cannot vary between merged instances
+
+Textures with an identical (non-empty) key can be merged using
+merge_instances(). The default implementation returns ``"constant"``
+for textures that aren't spatially varying and an empty string
+otherwise.)doc";
+
 static const char *__doc_mitsuba_Texture_pdf_position = R"doc(Returns the probability per unit area of sample_position())doc";
 
 static const char *__doc_mitsuba_Texture_pdf_spectrum =
@@ -8976,6 +10862,16 @@ R"doc(Returns the range of wavelengths covered by the spectrum
 
 The default implementation returns ``(MI_CIE_MIN, MI_CIE_MAX)``)doc";
 
+static const char *__doc_mitsuba_Texture_zero_mask =
+R"doc(Return a conservative map of the regions where the texture is zero
+
+The UV square is divided into the cells of a grid with the
+resolution() of the texture, stored in row-major order (the row index
+follows the ``v`` coordinate). An entry is ``True`` when the texture
+evaluates to zero everywhere inside the corresponding cell, regardless
+of the wavelength. Textures that cannot guarantee this return an empty
+vector, which is what the default implementation does.)doc";
+
 static const char *__doc_mitsuba_Thread =
 R"doc(Cross-platform thread implementation
 
@@ -8986,7 +10882,12 @@ when a thread launches another thread.)doc";
 
 static const char *__doc_mitsuba_ThreadEnvironment =
 R"doc(Captures a thread environment (logger and file resolver). Used with
-ScopedSetThreadEnvironment)doc";
+ScopedSetThreadEnvironment
+
+Every captured environment carries a generation number that identifies
+the logger/file resolver pair, which is shared with the thread it was
+captured from and with the threads it is installed on. Changing the
+logger or file resolver of a thread invalidates its generation.)doc";
 
 static const char *__doc_mitsuba_ThreadEnvironment_ThreadEnvironment = R"doc()doc";
 
@@ -8994,6 +10895,8 @@ static const char *__doc_mitsuba_ThreadEnvironment_ThreadEnvironment_2 = R"doc()
 
 static const char *__doc_mitsuba_ThreadEnvironment_m_file_resolver = R"doc()doc";
 
+static const char *__doc_mitsuba_ThreadEnvironment_m_generation = R"doc()doc";
+
 static const char *__doc_mitsuba_ThreadEnvironment_m_logger = R"doc()doc";
 
 static const char *__doc_mitsuba_ThreadEnvironment_operator_assign = R"doc()doc";
@@ -9125,6 +11028,37 @@ static const char *__doc_mitsuba_Thread_wait_for_tasks = R"doc(Wait for previous
 
 static const char *__doc_mitsuba_Thread_yield = R"doc(Yield to another processor)doc";
 
+static const char *__doc_mitsuba_TileCache =
+R"doc(Global least-recently-used cache of image tiles, shared by all
+TiledImage instances
+
+The cache evicts tiles once their total size exceeds a memory budget.
+Every thread additionally keeps a small direct-mapped table of
+recently used tiles, so that repeated lookups of the same tiles do not
+need to take the global lock. These per-thread references keep evicted
+tiles alive until they are replaced, so the resident size can
+temporarily exceed the budget by a few tiles per thread.)doc";
+
+static const char *__doc_mitsuba_TileCache_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TileCache_clear = R"doc(Release all tiles)doc";
+
+static const char *__doc_mitsuba_TileCache_evictions = R"doc(Return the number of tiles evicted so far)doc";
+
+static const char *__doc_mitsuba_TileCache_hits = R"doc(Return the number of lookups that found their tile in the cache)doc";
+
+static const char *__doc_mitsuba_TileCache_instance = R"doc(Return the global tile cache)doc";
+
+static const char *__doc_mitsuba_TileCache_memory_budget = R"doc(Return the memory budget in bytes)doc";
+
+static const char *__doc_mitsuba_TileCache_memory_usage = R"doc(Return the size of the tiles currently held by the cache)doc";
+
+static const char *__doc_mitsuba_TileCache_misses = R"doc(Return the number of lookups that needed to load a tile)doc";
+
+static const char *__doc_mitsuba_TileCache_set_memory_budget = R"doc(Set the memory budget in bytes (default: 1 GiB))doc";
+
+static const char *__doc_mitsuba_TileCache_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_Timer = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_Timer = R"doc()doc";
@@ -9139,6 +11073,40 @@ static const char *__doc_mitsuba_Timer_start = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_value = R"doc()doc";
 
+static const char *__doc_mitsuba_Trace =
+R"doc(Opt-in recording of a timeline of the render
+
+While enabled, every ScopedPhase and ScopedTraceEvent appends the
+time range it covers to a buffer of the calling thread. The buffers
+are grown in fixed-size chunks that are only written by their owner,
+hence recording an event requires no locks or atomic read-modify-write
+operations. When recording is disabled, the cost is a single relaxed
+load per range.
+
+write() exports the events in the Chrome trace event format, which can
+be viewed using ``chrome://tracing`` or Perfetto (one track per
+thread). Note that in JIT variants, the phases only cover the tracing
+of kernels and not their execution.)doc";
+
+static const char *__doc_mitsuba_Trace_enabled = R"doc(Is the recording of events currently enabled?)doc";
+
+static const char *__doc_mitsuba_Trace_event_count = R"doc(Return the number of recorded and dropped events)doc";
+
+static const char *__doc_mitsuba_Trace_start =
+R"doc(Start recording and discard previously recorded events
+
+Ranges shorter than ``min_duration`` (in microseconds) are dropped,
+which bounds the size of traces of scalar variants, where many phases
+cover a single ray. At most ``max_events`` events are kept.
+
+Must not be called while other threads are recording events.)doc";
+
+static const char *__doc_mitsuba_Trace_static_shutdown = R"doc(Free the recorded events (called on shutdown))doc";
+
+static const char *__doc_mitsuba_Trace_stop = R"doc(Stop recording (the recorded events are kept until the next start()))doc";
+
+static const char *__doc_mitsuba_Trace_write = R"doc(Write the recorded events to a JSON file in the Chrome trace event format)doc";
+
 static const char *__doc_mitsuba_Transform =
 R"doc(Encapsulates a 4x4 homogeneous coordinate transformation along with
 its inverse transpose
@@ -9322,6 +11290,12 @@ static const char *__doc_mitsuba_TraversalCallback_put_parameter = R"doc(Inform
 
 static const char *__doc_mitsuba_TraversalCallback_put_parameter_impl = R"doc(Actual implementation of put_parameter(). [To be provided by subclass])doc";
 
+static const char *__doc_mitsuba_TraversalCounters =
+R"doc(Work performed while tracing rays through a native acceleration data
+structure (see Scene::accel_traversal_stats()))doc";
+
+static const char *__doc_mitsuba_TraversalStats = R"doc(Average work per ray measured by Scene::accel_traversal_stats())doc";
+
 static const char *__doc_mitsuba_Vector = R"doc(//! @{ \name Elementary vector, point, and normal data types)doc";
 
 static const char *__doc_mitsuba_Vector_Vector = R"doc()doc";
@@ -9372,6 +11346,19 @@ static const char *__doc_mitsuba_VolumeGrid_bbox_transform =
 R"doc(Estimates the transformation from a unit axis-aligned bounding box to
 the given one.)doc";
 
+static const char *__doc_mitsuba_VolumeGrid_brick_count = R"doc(Return the number of bricks along each axis)doc";
+
+static const char *__doc_mitsuba_VolumeGrid_brick_max = R"doc(Return the maximum (over all channels) of every brick, in z-major order)doc";
+
+static const char *__doc_mitsuba_VolumeGrid_brick_min = R"doc(Return the minimum (over all channels) of every brick, in z-major order)doc";
+
+static const char *__doc_mitsuba_VolumeGrid_brick_size =
+R"doc(Return the resolution of the bricks whose value bounds are known, or
+zero if no bounds are available
+
+Files in the chunked format store these bounds in their header. For
+other grids, they can be computed using compute_brick_bounds().)doc";
+
 static const char *__doc_mitsuba_VolumeGrid_buffer_size = R"doc(Return the volume grid size in bytes (excluding metadata))doc";
 
 static const char *__doc_mitsuba_VolumeGrid_bytes_per_voxel = R"doc(Return the number bytes of storage used per voxel)doc";
@@ -9380,12 +11367,20 @@ static const char *__doc_mitsuba_VolumeGrid_channel_count = R"doc(Return the num
 
 static const char *__doc_mitsuba_VolumeGrid_class = R"doc()doc";
 
+static const char *__doc_mitsuba_VolumeGrid_compute_brick_bounds = R"doc(Compute the value bounds of all bricks of the given resolution)doc";
+
 static const char *__doc_mitsuba_VolumeGrid_data = R"doc(Return a pointer to the underlying volume storage)doc";
 
 static const char *__doc_mitsuba_VolumeGrid_data_2 = R"doc(Return a pointer to the underlying volume storage)doc";
 
 static const char *__doc_mitsuba_VolumeGrid_m_bbox = R"doc()doc";
 
+static const char *__doc_mitsuba_VolumeGrid_m_brick_max = R"doc()doc";
+
+static const char *__doc_mitsuba_VolumeGrid_m_brick_min = R"doc()doc";
+
+static const char *__doc_mitsuba_VolumeGrid_m_brick_size = R"doc()doc";
+
 static const char *__doc_mitsuba_VolumeGrid_m_channel_count = R"doc()doc";
 
 static const char *__doc_mitsuba_VolumeGrid_m_data = R"doc()doc";
@@ -9416,17 +11411,31 @@ static const char *__doc_mitsuba_VolumeGrid_size = R"doc(Return the resolution o
 
 static const char *__doc_mitsuba_VolumeGrid_to_string = R"doc(Return a human-readable summary of this volume grid)doc";
 
+static const char *__doc_mitsuba_VolumeGrid_update_max = R"doc(Compute the (per-channel) maximum of the voxels)doc";
+
 static const char *__doc_mitsuba_VolumeGrid_write =
 R"doc(Write an encoded form of the bitmap to a binary volume file
 
 Parameter ``path``:
-    Target file name (expected to end in ".vol"))doc";
+    Target file name (expected to end in ".vol")
+
+Parameter ``brick_size``:
+    When nonzero, the voxels are written in the chunked format (version
+    4), which compresses bricks of the given resolution independently
+    and stores their value bounds. Otherwise, the dense format (version
+    3) is used.)doc";
 
 static const char *__doc_mitsuba_VolumeGrid_write_2 =
 R"doc(Write an encoded form of the volume grid to a stream
 
 Parameter ``stream``:
-    Target stream that will receive the encoded output)doc";
+    Target stream that will receive the encoded output
+
+Parameter ``brick_size``:
+    When nonzero, the voxels are written in the chunked format (version
+    4), which compresses bricks of the given resolution independently
+    and stores their value bounds. Otherwise, the dense format (version
+    3) is used.)doc";
 
 static const char *__doc_mitsuba_Volume_Volume = R"doc()doc";
 
@@ -9480,6 +11489,32 @@ maximum value for each channel.
 
 Pointer allocation/deallocation must be performed by the caller.)doc";
 
+static const char *__doc_mitsuba_Volume_max_per_cell =
+R"doc(Computes the maximum value of the volume (over all channels) within
+every cell of a coarse grid of the given resolution, which subdivides
+the ``[0, 1]^3`` domain of the volume.
+
+The values are stored in z-major order and are conservative, i.e. they
+bound any value obtained by interpolating within a cell. The default
+implementation fills every cell with max().
+
+Pointer allocation/deallocation must be performed by the caller.)doc";
+
+static const char *__doc_mitsuba_Volume_max_per_cell_per_channel =
+R"doc(Per-channel variant of max_per_cell(), which stores
+``max(channel_count(), 1)`` consecutive values for every cell.
+
+The default implementation replicates the values of max_per_cell()
+across the channels.
+
+Pointer allocation/deallocation must be performed by the caller.)doc";
+
+static const char *__doc_mitsuba_Volume_min_per_cell =
+R"doc(Counterpart of max_per_cell() that computes conservative lower bounds.
+The default implementation fills every cell with zero.)doc";
+
+static const char *__doc_mitsuba_Volume_min_per_cell_per_channel = R"doc(Per-channel variant of min_per_cell(), see max_per_cell_per_channel())doc";
+
 static const char *__doc_mitsuba_Volume_resolution =
 R"doc(Returns the resolution of the volume, assuming that it is based on a
 discrete representation.
@@ -9731,6 +11766,16 @@ static const char *__doc_mitsuba_detail_OrderedChunkAllocator_used = R"doc(Retur
 
 static const char *__doc_mitsuba_detail_Throw = R"doc()doc";
 
+static const char *__doc_mitsuba_detail_TraceEvent = R"doc(A completed range of the timeline (names must be string literals))doc";
+
+static const char *__doc_mitsuba_detail_TraceEvent_category = R"doc()doc";
+
+static const char *__doc_mitsuba_detail_TraceEvent_end = R"doc()doc";
+
+static const char *__doc_mitsuba_detail_TraceEvent_name = R"doc()doc";
+
+static const char *__doc_mitsuba_detail_TraceEvent_start = R"doc()doc";
+
 static const char *__doc_mitsuba_detail_get_color_space_tables = R"doc()doc";
 
 static const char *__doc_mitsuba_detail_get_construct_functor = R"doc()doc";
@@ -9823,6 +11868,10 @@ static const char *__doc_mitsuba_detail_swap_3 = R"doc()doc";
 
 static const char *__doc_mitsuba_detail_swap_4 = R"doc()doc";
 
+static const char *__doc_mitsuba_detail_trace_record = R"doc(Append a range that ends now to the buffer of the calling thread)doc";
+
+static const char *__doc_mitsuba_detail_trace_time = R"doc(Current time in nanoseconds (steady clock))doc";
+
 static const char *__doc_mitsuba_detail_underlying = R"doc(Type trait to strip away dynamic/masking-related type wrappers)doc";
 
 static const char *__doc_mitsuba_detail_underlying_2 = R"doc()doc";
@@ -9841,6 +11890,14 @@ static const char *__doc_mitsuba_detail_variant_helper_move = R"doc()doc";
 
 static const char *__doc_mitsuba_detail_variant_helper_visit = R"doc()doc";
 
+static const char *__doc_mitsuba_dither_matrix256 =
+R"doc(256x256 threshold matrix for ordered dithering (defined in
+dither-matrix256.cpp)
+
+The entries are a permutation of the integers <tt>0..65535</tt>,
+mapped to the interval <tt>[-0.5, 0.5]</tt>, and have a blue-noise
+spectrum.)doc";
+
 static const char *__doc_mitsuba_emitter =
 R"doc(Return the emitter associated with the intersection (if any) \note
 Defined in scene.h)doc";
@@ -9905,6 +11962,11 @@ static const char *__doc_mitsuba_filesystem_is_regular_file =
 R"doc(Checks if ``p`` points to a regular file, as opposed to a directory or
 symlink.)doc";
 
+static const char *__doc_mitsuba_filesystem_last_write_time =
+R"doc(Returns the time of the last modification of the file or directory at
+``p`` (in seconds since the Unix epoch). Attempting to query a path
+that does not exist is treated as an error.)doc";
+
 static const char *__doc_mitsuba_filesystem_path =
 R"doc(Represents a path to a filesystem resource. On construction, the path
 is parsed and stored in a system-agnostic representation. The path can
@@ -10175,6 +12237,13 @@ static const char *__doc_mitsuba_hasher_operator_call = R"doc()doc";
 
 static const char *__doc_mitsuba_ior_from_file = R"doc()doc";
 
+static const char *__doc_mitsuba_laine_karras_permutation =
+R"doc(Hash-based approximation of the Laine-Karras permutation
+
+Every output bit only depends on the input bits of lower or equal
+significance. Refer to "Practical Hash-based Owen Scrambling" by Brent
+Burley (JCGT 2020) for details.)doc";
+
 static const char *__doc_mitsuba_librender_nop =
 R"doc(Dummy function which can be called to ensure that the librender shared
 library is loaded)doc";
@@ -10306,6 +12375,23 @@ interval.
 This operation is useful to implement a type of correlated
 stratification in the context of Monte Carlo integration.)doc";
 
+static const char *__doc_mitsuba_math_sincos_2pi_fast =
+R"doc(Fast approximation of the sine and cosine of ``2*pi*u``
+
+The argument is reduced exactly to a quarter turn around the nearest
+multiple of ``pi/2``, which is evaluated by sincos_quarter_pi(). The
+absolute error is below ``1e-6`` for arguments in ``[-1, 1]`` (e.g.
+uniformly distributed samples) and grows with the rounding error of
+the reduction for larger ones.)doc";
+
+static const char *__doc_mitsuba_math_sincos_quarter_pi =
+R"doc(Polynomial approximation of the sine and cosine of an angle in
+``[-pi/4, pi/4]``
+
+The truncated Taylor series have an absolute error below ``4e-7`` on
+this interval. Since no range reduction is performed, this is
+considerably cheaper than ``dr::sincos()``, especially in packets.)doc";
+
 static const char *__doc_mitsuba_math_solve_quadratic =
 R"doc(Solve a quadratic equation of the form a*x^2 + b*x + c = 0.
 
@@ -10333,6 +12419,13 @@ R"doc(Constructs the Mueller matrix of a linear diattenuator, which
 attenuates the electric field components at 0 and 90 degrees by 'x'
 and 'y', * respectively.)doc";
 
+static const char *__doc_mitsuba_mueller_is_depolarizer =
+R"doc(Checks whether a Mueller matrix is an ideal depolarizer, i.e. whether
+only its (0, 0) element is nonzero
+
+The elements must be (unpolarized) spectra, and the test is performed
+for all of their wavelengths at once.)doc";
+
 static const char *__doc_mitsuba_mueller_left_circular_polarizer =
 R"doc(Constructs the Mueller matrix of a (left) circular polarizer.
 
@@ -10519,6 +12612,14 @@ Returns:
     The (implicitly defined) reference coordinate system basis for the
     Stokes vector traveling along forward.)doc";
 
+static const char *__doc_mitsuba_nested_uniform_scramble =
+R"doc(Nested uniform (Owen) scrambling of the bits of a 32 bit integer
+
+Applied to a sample value, this randomizes a (t, m, s)-net while
+preserving its stratification. Applied to a sample index, it shuffles
+the order of the points such that every aligned block of :math:`2^k`
+indices is mapped onto another aligned block of the same size.)doc";
+
 static const char *__doc_mitsuba_operator_add = R"doc()doc";
 
 static const char *__doc_mitsuba_operator_add_2 = R"doc()doc";
@@ -10673,6 +12774,24 @@ static const char *__doc_mitsuba_orthographic_projection =
 R"doc(Helper function to create a orthographic projection transformation
 matrix)doc";
 
+static const char *__doc_mitsuba_owen_scrambled_sobol =
+R"doc(Owen-scrambled and shuffled Sobol' sequence
+
+Parameter ``index``:
+    Sample index
+
+Parameter ``dim``:
+    Sobol' dimension (must be smaller than SobolMaxDimension)
+
+Parameter ``shuffle_seed``:
+    Seed of the nested uniform scramble of the sample index
+
+Parameter ``scramble_seed``:
+    Seed of the nested uniform scramble of the sample value
+
+Returns:
+    A sample in the interval <tt>[0, 1)</tt>)doc";
+
 static const char *__doc_mitsuba_parse_fov = R"doc(Helper function to parse the field of view field of a camera)doc";
 
 static const char *__doc_mitsuba_pdf_rgb_spectrum =
@@ -10908,6 +13027,34 @@ Parameter ``cos_theta_t``:
 Parameter ``eta_ti``:
     Relative index of refraction (transmitted / incident))doc";
 
+static const char *__doc_mitsuba_reverse_bits = R"doc(Reverse the order of the bits of a 32 bit unsigned integer)doc";
+
+static const char *__doc_mitsuba_sample_philox4x32 =
+R"doc(Counter-based Philox4x32 pseudorandom number generator
+
+Philox maps a 128 bit counter and a 64 bit key to 128 pseudorandom
+bits using a bijection built from 32 bit multiplications. Unlike
+PCG32, it does not require any state: every output is a pure function
+of its inputs, which makes it possible to regenerate arbitrary subsets
+of a random stream.
+
+For details, refer to "Parallel random numbers: as easy as 1, 2, 3" by
+John K. Salmon, Mark A. Moraes, Ron O. Dror, and David E. Shaw.
+
+Parameter ``c0``:
+    c1, c2, c3 Counter words (e.g. sample index, dimension, sequence
+    index)
+
+Parameter ``k0``:
+    k1 Key words (e.g. a seed value)
+
+Parameter ``rounds``:
+    How many rounds should be executed? The default of 10 passes the
+    BigCrush test suite with a safety margin.
+
+Returns:
+    Four uniformly distributed 32-bit integers)doc";
+
 static const char *__doc_mitsuba_sample_rgb_spectrum =
 R"doc(Importance sample a "importance spectrum" that concentrates the
 computation on wavelengths that are relevant for rendering of RGB data
@@ -11017,6 +13164,28 @@ context for the current scope.)doc";
 
 static const char *__doc_mitsuba_scoped_optix_context_scoped_optix_context = R"doc()doc";
 
+static const char *__doc_mitsuba_sggx_factorize =
+R"doc(Precompute the sampling frame of an SGGX microflake distribution
+
+The matrix :math:`S` is factorized as :math:`S = L L^T` using a
+Cholesky decomposition, whose inverse transpose maps the unit sphere
+onto the SGGX ellipsoid. The functions sggx_ndf_pdf_factorized(),
+sggx_projected_area_factorized() and sggx_sample_vndf_factorized()
+then only require a few matrix-vector products instead of rebuilding
+and projecting :math:`S`.
+
+To handle degenerate (e.g. zero or planar) distributions, a small
+multiple of the identity is added to :math:`S` first.
+
+Parameter ``s``:
+    The parameters of the SGGX phase function stored as a 6D vector
+    [S_xx, S_yy, S_zz, S_xy, S_xz, S_yz].
+
+Returns:
+    The lower triangular factor :math:`L` and its inverse, stored as a
+    12D vector [L_xx, L_yy, L_zz, L_yx, L_zx, L_zy] followed by the
+    same entries of :math:`L^{-1}`.)doc";
+
 static const char *__doc_mitsuba_sggx_ndf_pdf =
 R"doc(Evaluates the probability of sampling a given normal using the SGGX
 microflake distribution
@@ -11034,6 +13203,19 @@ Parameter ``s``:
 Returns:
     The probability of sampling a certain normal)doc";
 
+static const char *__doc_mitsuba_sggx_ndf_pdf_factorized =
+R"doc(Evaluates the probability of sampling a given normal using the SGGX
+microflake distribution with a precomputed frame
+
+Parameter ``wm``:
+    The microflake normal
+
+Parameter ``f``:
+    The sampling frame computed by sggx_factorize()
+
+Returns:
+    The probability of sampling a certain normal)doc";
+
 static const char *__doc_mitsuba_sggx_projected_area =
 R"doc(Evaluates the projected area of the SGGX microflake distribution
 
@@ -11050,6 +13232,19 @@ Parameter ``s``:
 Returns:
     The projected area of the SGGX microflake distribution)doc";
 
+static const char *__doc_mitsuba_sggx_projected_area_factorized =
+R"doc(Evaluates the projected area of the SGGX microflake distribution with
+a precomputed frame
+
+Parameter ``wi``:
+    A 3D direction
+
+Parameter ``f``:
+    The sampling frame computed by sggx_factorize()
+
+Returns:
+    The projected area of the SGGX microflake distribution)doc";
+
 static const char *__doc_mitsuba_sggx_sample_vndf =
 R"doc(Samples the visible normal distribution of the SGGX microflake
 distribution
@@ -11079,8 +13274,42 @@ Returns:
 
 static const char *__doc_mitsuba_sggx_sample_vndf_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_sggx_sample_vndf_factorized =
+R"doc(Samples the visible normal distribution of the SGGX microflake
+distribution with a precomputed frame
+
+The ellipsoid is the image of the unit sphere under :math:`L^{-T}`. Its
+visible normals are sampled by drawing a cosine-distributed normal of
+the sphere around :math:`L^T \omega_i` and transforming it by
+:math:`L`.
+
+Parameter ``wi``:
+    The incident direction
+
+Parameter ``sample``:
+    A uniformly distributed 2D sample
+
+Parameter ``f``:
+    The sampling frame computed by sggx_factorize()
+
+Returns:
+    A normal (in world space) sampled from the distribution of visible
+    normals)doc";
+
 static const char *__doc_mitsuba_sobol_2 = R"doc(Sobol' radical inverse in base 2)doc";
 
+static const char *__doc_mitsuba_sobol_sample =
+R"doc(Evaluate the 32 bit integer representation of the Sobol' sequence
+
+The generator matrix of dimension ``dim`` is applied to the sample
+index using branch-free XOR operations, which vectorizes well.
+
+Parameter ``index``:
+    Sample index
+
+Parameter ``dim``:
+    Sobol' dimension (must be smaller than SobolMaxDimension))doc";
+
 static const char *__doc_mitsuba_spectrum_from_file =
 R"doc(Read a spectral power distribution from an ASCII file.
 
@@ -11219,6 +13448,76 @@ Returns:
     The interpolated value or zero when ``Extrapolate=false`` and
     ``x`` lies outside of \a [``min``, ``max``])doc";
 
+static const char *__doc_mitsuba_spline_eval_1d_precomputed =
+R"doc(Evaluate a cubic spline interpolant of a *uniformly* sampled 1D
+function using coefficients computed by precompute_1d()
+
+The result matches eval_1d(). The segment is found in constant time
+from the position of ``x``, and its four coefficients are fetched
+using a single gather of a packed 4D vector.
+
+Template parameter ``Extrapolate``:
+    Extrapolate values when ``x`` is out of range? (default:
+    ``False``)
+
+Parameter ``min``:
+    Position of the first node
+
+Parameter ``max``:
+    Position of the last node
+
+Parameter ``coeffs``:
+    Array containing the ``4*(size-1)`` coefficients computed by
+    precompute_1d()
+
+Parameter ``size``:
+    Denotes the number of nodes of the spline (i.e. the size of the
+    ``values`` array passed to precompute_1d())
+
+Parameter ``x``:
+    Evaluation point
+
+Remark:
+    The Python API lacks the ``size`` parameter, which is inferred
+    automatically from the size of the coefficient array.
+
+Returns:
+    The interpolated value or zero when ``Extrapolate=false`` and
+    ``x`` lies outside of [``min``, ``max``])doc";
+
+static const char *__doc_mitsuba_spline_eval_1d_precomputed_2 =
+R"doc(Evaluate a cubic spline interpolant of a *non-uniformly* sampled 1D
+function using coefficients computed by precompute_1d()
+
+The result matches the non-uniform version of eval_1d().
+
+Template parameter ``Extrapolate``:
+    Extrapolate values when ``x`` is out of range? (default:
+    ``False``)
+
+Parameter ``nodes``:
+    Array containing ``size`` non-uniformly spaced values denoting
+    positions the where the function to be interpolated was evaluated.
+    They must be provided in *increasing* order.
+
+Parameter ``coeffs``:
+    Array containing the ``4*(size-1)`` coefficients computed by
+    precompute_1d()
+
+Parameter ``size``:
+    Denotes the size of the ``nodes`` array
+
+Parameter ``x``:
+    Evaluation point
+
+Remark:
+    The Python API lacks the ``size`` parameter, which is inferred
+    automatically from the size of the input array
+
+Returns:
+    The interpolated value or zero when ``Extrapolate=false`` and
+    ``x`` lies outside of *[``min``, ``max``]*)doc";
+
 static const char *__doc_mitsuba_spline_eval_2d =
 R"doc(Evaluate a cubic spline interpolant of a uniformly sampled 2D function
 
@@ -11515,6 +13814,61 @@ Parameter ``eps``:
 Returns:
     The spline parameter ``t`` such that ``eval_1d(..., t)=y``)doc";
 
+static const char *__doc_mitsuba_spline_precompute_1d =
+R"doc(Precompute the polynomial coefficients of the segments of a cubic
+spline interpolant of a *uniformly* sampled 1D function
+
+The Catmull-Rom spline evaluated by eval_1d() is converted into the
+power basis ``((a*t + b)*t + c)*t + d`` of every segment, whose four
+coefficients are stored consecutively. eval_1d_precomputed() then only
+requires a single (packed) gather per evaluation instead of four
+gathers and the finite differences of every call.
+
+Parameter ``values``:
+    Array containing ``size`` regularly spaced evaluations of the
+    approximated function.
+
+Parameter ``size``:
+    Denotes the size of the ``values`` array
+
+Parameter ``out``:
+    An array with ``4*(size-1)`` entries, which will be used to store
+    the coefficients
+
+Remark:
+    The Python API lacks the ``size`` and ``out`` parameters. The
+    former is inferred automatically from the size of the input array,
+    and ``out`` is returned as a list.)doc";
+
+static const char *__doc_mitsuba_spline_precompute_1d_2 =
+R"doc(Precompute the polynomial coefficients of the segments of a cubic
+spline interpolant of a *non-uniformly* sampled 1D function
+
+Counterpart of the uniform version of precompute_1d() for the spline
+evaluated by the non-uniform version of eval_1d(). The polynomials are
+parameterized by the relative position within the segment.
+
+Parameter ``nodes``:
+    Array containing ``size`` non-uniformly spaced values denoting
+    positions the where the function to be interpolated was evaluated.
+    They must be provided in *increasing* order.
+
+Parameter ``values``:
+    Array containing function evaluations matched to the entries of
+    ``nodes``.
+
+Parameter ``size``:
+    Denotes the size of the ``nodes`` and ``values`` array
+
+Parameter ``out``:
+    An array with ``4*(size-1)`` entries, which will be used to store
+    the coefficients
+
+Remark:
+    The Python API lacks the ``size`` and ``out`` parameters. The
+    former is inferred automatically from the size of the input array,
+    and ``out`` is returned as a list.)doc";
+
 static const char *__doc_mitsuba_spline_sample_1d =
 R"doc(Importance sample a segment of a *uniformly* sampled 1D Catmull-Rom
 spline interpolant
@@ -11734,6 +14088,31 @@ static const char *__doc_mitsuba_variant_variant_3 = R"doc()doc";
 
 static const char *__doc_mitsuba_variant_visit = R"doc()doc";
 
+static const char *__doc_mitsuba_warp_batch =
+R"doc(Apply a warping function to an array of samples using packets
+
+Scalar variants evaluate the mappings of this namespace one sample at
+a time. When many samples are warped at once, this function instead
+gathers groups of ``Width`` samples into packets, so that the mapping
+(including its transcendental functions) is evaluated using SIMD
+instructions. The final partial group is padded with zero-valued
+samples.
+
+Parameter ``func``:
+    Function mapping a packet of samples to a packet of results,
+    e.g. ``[](const Point2fP &s) { return
+    warp::square_to_cosine_hemisphere<FloatP, true>(s); }``
+
+Parameter ``in``:
+    Array of ``count`` input samples (scalars or static arrays of
+    scalars)
+
+Parameter ``out``:
+    Array of ``count`` results (scalars or static arrays of scalars)
+
+Parameter ``count``:
+    Number of samples)doc";
+
 static const char *__doc_mitsuba_warp_beckmann_to_square = R"doc(Inverse of the mapping square_to_uniform_cone)doc";
 
 static const char *__doc_mitsuba_warp_bilinear_to_square = R"doc(Inverse of square_to_bilinear)doc";
@@ -11742,10 +14121,22 @@ static const char *__doc_mitsuba_warp_circ = R"doc(//! @{ \name Warping techniqu
 
 static const char *__doc_mitsuba_warp_cosine_hemisphere_to_square = R"doc(Inverse of the mapping square_to_cosine_hemisphere)doc";
 
+static const char *__doc_mitsuba_warp_detail_batch_load_lane = R"doc(Extract lane ``k`` of a packet as a scalar (or static array thereof))doc";
+
+static const char *__doc_mitsuba_warp_detail_batch_store_lane =
+R"doc(Write a scalar sample (or static array thereof) into lane ``k`` of a
+packet)doc";
+
 static const char *__doc_mitsuba_warp_detail_i0 = R"doc()doc";
 
 static const char *__doc_mitsuba_warp_detail_log_i0 = R"doc()doc";
 
+static const char *__doc_mitsuba_warp_detail_sincos_2pi =
+R"doc(Sine and cosine of ``2*pi*u``, using the fast approximation if
+requested)doc";
+
+static const char *__doc_mitsuba_warp_detail_spherical_triangle_angles = R"doc(Internal angles of a spherical triangle with unit vertex directions)doc";
+
 static const char *__doc_mitsuba_warp_interval_to_linear =
 R"doc(Importance sample a linear interpolant
 
@@ -11762,6 +14153,8 @@ static const char *__doc_mitsuba_warp_interval_to_tent = R"doc(Warp a uniformly
 
 static const char *__doc_mitsuba_warp_linear_to_interval = R"doc(Inverse of interval_to_linear)doc";
 
+static const char *__doc_mitsuba_warp_spherical_triangle_to_square = R"doc(Inverse of square_to_spherical_triangle)doc";
+
 static const char *__doc_mitsuba_warp_square_to_beckmann = R"doc(Warp a uniformly distributed square sample to a Beckmann distribution)doc";
 
 static const char *__doc_mitsuba_warp_square_to_beckmann_pdf = R"doc(Probability density of square_to_beckmann())doc";
@@ -11795,6 +14188,20 @@ distribution)doc";
 
 static const char *__doc_mitsuba_warp_square_to_rough_fiber_pdf = R"doc(Probability density of square_to_rough_fiber())doc";
 
+static const char *__doc_mitsuba_warp_square_to_spherical_triangle =
+R"doc(Uniformly sample a direction within a spherical triangle
+
+The spherical triangle is specified by the unit vectors ``a``, ``b``,
+and ``c`` pointing towards its vertices. The implementation is based
+on Arvo's area-preserving parameterization: the first sample dimension
+selects a sub-triangle with a proportional solid angle, and the second
+one positions the sample along an arc through the vertex ``b``.
+
+Returns the sampled direction and its density per unit solid angle,
+which is zero for degenerate triangles.)doc";
+
+static const char *__doc_mitsuba_warp_square_to_spherical_triangle_pdf = R"doc(Density of square_to_spherical_triangle() with respect to solid angles)doc";
+
 static const char *__doc_mitsuba_warp_square_to_std_normal =
 R"doc(Sample a point on a 2D standard normal distribution. Internally uses
 the Box-Muller transformation)doc";
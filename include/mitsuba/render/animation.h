@@ -0,0 +1,112 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/render/fwd.h>
+#include <tuple>
+#include <typeinfo>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Keyframed animation of the parameters of a scene
+ *
+ * The keyframes are loaded from a text file with one keyframe per line,
+ * which specifies the frame number, the name of a parameter (following the
+ * naming convention of \c mitsuba.traverse(), e.g. \c sensor.to_world), and
+ * its value at that frame:
+ *
+ * <tt>
+ * # frame  parameter              value
+ * 0        sensor.to_world        look_at 0 -4 1   0 0 0   0 0 1
+ * 48       sensor.to_world        look_at 4  0 1   0 0 0   0 0 1
+ * 0        light.intensity.value  10 10 10
+ * 48       light.intensity.value  2 2 2
+ * </tt>
+ *
+ * Scalar parameters take one value, 3D points, vectors and colors three
+ * values, and transformations either the 16 entries of a matrix (in
+ * row-major order) or the keyword \c look_at followed by the origin, target
+ * and up vector of \ref Transform::look_at(). Lines starting with \c # are
+ * ignored.
+ *
+ * Between two keyframes, the values are interpolated linearly (the
+ * parameters of \c look_at transformations are interpolated before the
+ * matrix is assembled, which keeps it a rigid transformation), and outside
+ * of the range of keyframes of a parameter, they remain constant.
+ *
+ * \ref set_frame() writes the values of a frame into the scene and notifies
+ * the modified objects bottom-up like \c SceneParameters.update(), hence the
+ * scene only updates the acceleration data structures and emitter sampling
+ * structures that depend on the animated parameters, and in JIT variants,
+ * the kernels of the previous frame can be reused.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB Animation : public Object {
+public:
+    MI_IMPORT_TYPES()
+
+    /**
+     * \brief Load the keyframes of \c filename and look up the animated
+     * parameters among those exposed by \c root (usually a scene)
+     */
+    Animation(Object *root, const fs::path &filename);
+
+    /// Return the first and last frame that has a keyframe
+    std::pair<int, int> frame_range() const;
+
+    /**
+     * \brief Set all animated parameters to their (interpolated) value at the
+     * given frame and notify the objects that were modified
+     */
+    void set_frame(ScalarFloat frame);
+
+    /// Return the names of the animated parameters
+    std::vector<std::string> parameters() const;
+
+    /// Return a human-readable representation of the animation
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~Animation();
+
+    /// Keyframes of a single parameter
+    struct Track {
+        /// Name of the parameter
+        std::string name;
+
+        /// Storage and type of the parameter
+        void *ptr;
+        const std::type_info *type;
+
+        /// Number of values per keyframe
+        size_t size;
+
+        /// Is the transformation specified in the \c look_at form?
+        bool look_at;
+
+        /// Objects to notify (starting with the owner) and their keys
+        std::vector<std::tuple<Object *, uint32_t, std::string>> nodes;
+
+        /// Sorted frame numbers and the associated values
+        std::vector<ScalarFloat> frames;
+        std::vector<ScalarFloat> values;
+
+        /// Values that were last written to the parameter
+        std::vector<ScalarFloat> current;
+    };
+
+    /**
+     * \brief Write the value of a track at the given frame (returns \c false
+     * if the parameter already has this value)
+     */
+    bool write(Track &track, ScalarFloat frame);
+
+protected:
+    ref<Object> m_root;
+    std::vector<Track> m_tracks;
+};
+
+MI_EXTERN_CLASS(Animation)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/render/fwd.h>
+#include <string>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Settings that affect the throughput of a render but not its result
+ *
+ * A value of zero leaves the corresponding setting unchanged.
+ */
+struct MI_EXPORT_LIB AutotuneConfig {
+    /// Vector width of the LLVM backend
+    uint32_t vector_width = 0;
+
+    /**
+     * \brief Samples per pixel of every pass of the integrator, which
+     * determines the wavefront size in JIT variants
+     */
+    uint32_t samples_per_pass = 0;
+
+    /// Size of the image blocks rendered in parallel (scalar variants)
+    uint32_t block_size = 0;
+
+    /// Number of threads
+    uint32_t thread_count = 0;
+
+    /// Measured throughput in samples per second
+    double samples_per_second = 0.0;
+
+    /// Return a human-readable representation of the settings
+    std::string to_string() const;
+};
+
+/**
+ * \brief Finds the settings of the renderer that maximize the throughput of
+ * a scene on the current machine
+ *
+ * The tuner renders the scene with a small number of samples per pixel
+ * while exploring a grid of settings, one setting at a time (the vector
+ * width of the LLVM backend, the samples per pass that determine the
+ * wavefront size in JIT variants, the image block size in scalar variants,
+ * and the thread count). Each configuration is first rendered once to
+ * compile its kernels, and its throughput is then measured in samples per
+ * second.
+ *
+ * The fastest configuration is stored in a cache file under a key that
+ * consists of the host (name, core count and LLVM target) and the scene
+ * (see \ref scene_key()), so that later runs skip the calibration. The
+ * cache is a text file with one line per entry:
+ *
+ * <tt>
+ * # host  scene  vector_width  samples_per_pass  block_size  threads  samples/s
+ * </tt>
+ *
+ * Only \ref SamplingIntegrator instances can be tuned.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB Autotuner : public Object {
+public:
+    MI_IMPORT_TYPES(Scene, Sensor, SamplingIntegrator)
+
+    /**
+     * \param cache_file
+     *     File storing the fastest configuration of every scene and host. An
+     *     empty path selects \ref default_cache_file().
+     *
+     * \param tune_thread_count
+     *     Explore the number of threads (otherwise, the current one is used)
+     *
+     * \param tune_vector_width
+     *     Explore the vector width of the LLVM backend (otherwise, the
+     *     current one is used)
+     */
+    Autotuner(const fs::path &cache_file, bool tune_thread_count = true,
+              bool tune_vector_width = true);
+
+    /**
+     * \brief Return the fastest configuration for rendering \c sensor of
+     * \c scene, and apply it
+     *
+     * The configuration is looked up in the cache using \c scene_key (e.g. a
+     * hash of the scene description, see \ref scene_key()). If there is no
+     * entry, the calibration renders are performed and the result is added
+     * to the cache. The sample count of the sensor's sampler is preserved.
+     */
+    AutotuneConfig tune(Scene *scene, Sensor *sensor,
+                        const std::string &scene_key);
+
+    /**
+     * \brief Apply a configuration to the renderer and the integrator of
+     * \c scene
+     *
+     * The samples per pass are reduced to a divisor of the sample count of
+     * \c sensor if needed.
+     */
+    static void apply(const AutotuneConfig &config, Scene *scene,
+                      Sensor *sensor);
+
+    /**
+     * \brief Return a key identifying a scene description, the variant and
+     * the parameters used to load it, and the rendered sensor
+     *
+     * Changes to files referenced by the scene (meshes, textures, ..) do not
+     * change the key.
+     */
+    static std::string scene_key(const std::string &scene_source,
+                                 const std::string &variant,
+                                 const std::string &parameters,
+                                 uint32_t sensor_index);
+
+    /// Return a key identifying the current machine
+    static std::string host_key();
+
+    /// Return the default location of the cache file (in the user's home directory)
+    static fs::path default_cache_file();
+
+    /// Return the cache file
+    const fs::path &cache_file() const { return m_cache_file; }
+
+    /// Return a human-readable representation of the tuner
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~Autotuner();
+
+    /// Render with the given configuration and return its throughput
+    double measure(const AutotuneConfig &config, Scene *scene, Sensor *sensor,
+                   uint32_t spp);
+
+    /// Look up the entry of \c key in the cache file
+    bool load(const std::string &key, AutotuneConfig &config) const;
+
+    /// Add or replace the entry of \c key in the cache file
+    void store(const std::string &key, const AutotuneConfig &config) const;
+
+protected:
+    fs::path m_cache_file;
+    bool m_tune_thread_count;
+    bool m_tune_vector_width;
+};
+
+MI_EXTERN_CLASS(Autotuner)
+NAMESPACE_END(mitsuba)
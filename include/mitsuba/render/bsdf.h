@@ -265,7 +265,7 @@ template <typename Float, typename Spectrum> struct BSDFSample3 {
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB BSDF : public Object {
 public:
-    MI_IMPORT_TYPES()
+    MI_IMPORT_TYPES(Texture)
 
     /**
      * \brief Importance sample the BSDF model
@@ -519,6 +519,75 @@ public:
     virtual Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
                                               Mask active = true) const;
 
+    //! @}
+    // -----------------------------------------------------------------------
+
+    // -----------------------------------------------------------------------
+    //! @{ \name Merging of BSDF instances
+    // -----------------------------------------------------------------------
+
+    /**
+     * \brief Return a key that identifies the configuration of this BSDF
+     * which cannot vary between merged instances
+     *
+     * BSDFs of the same plugin with an identical (non-empty) key can be
+     * merged using \ref merge(). The default implementation returns an
+     * empty string, i.e. the BSDF cannot be merged.
+     */
+    virtual std::string merge_key() const;
+
+    /**
+     * \brief Merge several instances of this BSDF into a single one
+     *
+     * The returned BSDF behaves like <tt>instances[i]</tt> on the surface of
+     * every shape whose \ref Shape::bsdf_index() is equal to \c i, gathering
+     * the parameters of the instance from per-instance buffers. In the
+     * vectorized variants, this replaces many entries of the virtual function
+     * call table by one, so that lanes with different materials of the same
+     * type no longer evaluate separately.
+     *
+     * All instances must share the \ref merge_key() of this BSDF. The
+     * function returns \c nullptr when merging isn't possible. The default
+     * implementation always does so.
+     */
+    virtual ref<BSDF> merge(const std::vector<ref<BSDF>> &instances) const;
+
+    /**
+     * \brief Simplify the network of nested BSDFs rooted at this BSDF
+     *
+     * Adapter BSDFs (e.g. \c blendbsdf, \c mask or \c twosided) first
+     * flatten their nested BSDFs and then return the nested BSDF in place of
+     * themselves when they don't alter its response, e.g. a blend with a
+     * constant weight of zero or a fully opaque mask. Each removed layer
+     * saves one virtual function call per query. The default implementation
+     * returns the BSDF itself.
+     */
+    virtual ref<BSDF> flatten();
+
+    /**
+     * \brief Return the texture that controls the opacity of the surface
+     *
+     * BSDFs that let light pass straight through the surface wherever this
+     * texture is zero (e.g. \c mask) return it, so that ray tracing can
+     * skip the fully transparent regions during traversal instead of
+     * re-tracing rays from every null interaction (see \ref
+     * Texture::zero_mask()). The default implementation returns \c nullptr.
+     */
+    virtual const Texture *opacity_texture() const;
+
+    /**
+     * \brief Return the fields of the surface interaction accessed by the
+     * BSDF as a combination of \ref RayFlags (not counting nested textures)
+     *
+     * Scenes combine the flags of their BSDFs with the requirements of their
+     * textures to skip the computation of unused fields during ray
+     * intersections (see \ref Scene::ray_flags()). The default
+     * implementation requests the shading frame, and additionally the UV
+     * coordinates and their position partials for anisotropic BSDFs (whose
+     * tangent follows \c dp_du) and BSDFs that need differentials.
+     */
+    virtual uint32_t ray_flags() const;
+
     /// Return a human-readable representation of the BSDF
     std::string to_string() const override = 0;
 
@@ -570,14 +639,11 @@ typename SurfaceInteraction<Float, Spectrum>::BSDFPtr SurfaceInteraction<Float,
     const typename SurfaceInteraction<Float, Spectrum>::RayDifferential3f &ray) {
     const BSDFPtr bsdf = shape->bsdf();
 
-    /// TODO: revisit the 'false' default for autodiff mode once there are actually BRDFs using
-    /// differentials
-    if constexpr (!dr::is_diff_v<Float>) {
-        if (!has_uv_partials() && dr::any(bsdf->needs_differentials()))
-            compute_uv_partials(ray);
-    } else {
-        DRJIT_MARK_USED(ray);
-    }
+    /* Rays only carry differentials when generated by a sensor. Compute the
+       UV partials in that case, so that textures can filter their lookups
+       (e.g. MIP-mapped bitmaps). */
+    if (ray.has_differentials && !has_uv_partials())
+        compute_uv_partials(ray);
 
     return bsdf;
 }
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/shapegroup.h>
+#include <drjit/packet.h>
+
+/// Maximum depth of the BVH (used to size the traversal stack)
+#if !defined(MI_BVH_MAXDEPTH)
+#  define MI_BVH_MAXDEPTH 64
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Bounding volume hierarchy with four-wide nodes for the native CPU
+ * ray tracing backend.
+ *
+ * This class is an alternative to \ref ShapeKDTree that is considerably faster
+ * to construct: primitives are organized using a binned surface area
+ * heuristic (SAH) over the primitive centroids, which avoids the clipping and
+ * the large temporary allocations of the kd-tree builder. The resulting
+ * binary hierarchy is subsequently collapsed into nodes with four children,
+ * whose bounding boxes are stored in SoA layout so that all of them can be
+ * tested against a ray using a single SIMD packet.
+ *
+ * Because the hierarchy never splits primitives, it can be refit in
+ * O(N) time via \ref refit() when the geometry deforms while its topology
+ * remains unchanged.
+ *
+ * The BVH also serves as the top level of a two-level hierarchy when the
+ * scene contains instances: each instance is a single primitive, whose
+ * world-to-object transformation is kept next to a pointer to the kd-tree of
+ * its shape group (which is shared by all instances of the group). Rays are
+ * transformed using SIMD packets and traced through that kd-tree directly,
+ * bypassing the virtual function calls of the \c Instance and \ref
+ * ShapeGroup classes.
+ *
+ * The following scene properties control the construction:
+ *
+ * - \c bvh_bins: number of bins used by the SAH evaluation (default: 16)
+ * - \c bvh_max_leaf_size: maximum number of primitives per leaf (default: 8)
+ * - \c bvh_intersection_cost: relative cost of a primitive intersection
+ *   (default: 1)
+ * - \c bvh_traversal_cost: relative cost of a node traversal step
+ *   (default: 1)
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB ShapeBVH : public Object {
+public:
+    MI_IMPORT_TYPES(Shape, Mesh)
+
+    using ScalarRay3f = Ray<ScalarPoint3f, Spectrum>;
+    using Size        = uint32_t;
+    using Index       = uint32_t;
+    using FloatP      = dr::Packet<ScalarFloat, 4>;
+    using MaskP       = dr::mask_t<FloatP>;
+
+    /// BVH node storing the bounding boxes of up to four children
+    struct Node {
+        /// Child bounding boxes (one SIMD lane per child)
+        FloatP bbox_min[3];
+        FloatP bbox_max[3];
+
+        /// Index of an inner child node, or offset into the index list
+        Index child[4];
+
+        /// Primitive count of leaf children (zero for inner nodes)
+        Size count[4];
+    };
+
+    /// Instance prepared for traversal without virtual function calls
+    struct InstanceRecord {
+        /// Columns of the affine world-to-object transformation (w: unused)
+        FloatP to_object[4];
+        /// The referenced shape group
+        const ShapeGroup<Float, Spectrum> *shapegroup;
+    };
+
+    /// Create an empty BVH and take build-related parameters from \c props.
+    ShapeBVH(const Properties &props);
+
+    /// Clear the BVH (build-related parameters remain)
+    void clear();
+
+    /// Register a new shape with the BVH (to be called before \ref build())
+    void add_shape(Shape *shape);
+
+    /// Build the BVH
+    void build();
+
+    /**
+     * \brief Recompute the node bounding boxes while keeping the topology
+     *
+     * This is useful when the registered shapes deform without changing
+     * their number of primitives (e.g. when the vertex positions of a mesh
+     * are updated). Tree quality may degrade under large deformations.
+     */
+    void refit();
+
+    /// Has the BVH been built?
+    bool ready() const { return !m_nodes.empty(); }
+
+    /// Return the number of registered shapes
+    Size shape_count() const { return Size(m_shapes.size()); }
+
+    /// Return the number of registered primitives
+    Size primitive_count() const { return m_primitive_map.back(); }
+
+    /// Return the number of nodes
+    Size node_count() const { return Size(m_nodes.size()); }
+
+    /// Return the memory used by the nodes and the index list (bytes)
+    size_t memory() const {
+        return m_indices.size() * sizeof(Index) + m_nodes.size() * sizeof(Node);
+    }
+
+    /**
+     * \brief Return the SAH cost of the hierarchy, i.e. the expected cost of
+     * tracing a random ray that intersects the bounding box of the BVH
+     * (relative to \c bvh_intersection_cost and \c bvh_traversal_cost)
+     */
+    ScalarFloat sah_cost() const;
+
+    /// Return the i-th shape (const version)
+    const Shape *shape(size_t i) const { Assert(i < m_shapes.size()); return m_shapes[i]; }
+
+    /// Return the i-th shape
+    Shape *shape(size_t i) { Assert(i < m_shapes.size()); return m_shapes[i]; }
+
+    /// Return the bounding box of the entire BVH
+    const ScalarBoundingBox3f &bbox() const { return m_bbox; }
+
+    /// Return the bounding box of the i-th primitive
+    MI_INLINE ScalarBoundingBox3f bbox(Index i) const {
+        Index shape_index = find_shape(i);
+        return m_shapes[shape_index]->bbox(i);
+    }
+
+    template <bool ShadowRay>
+    MI_INLINE PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                                   Mask active) const {
+        DRJIT_MARK_USED(active);
+        if constexpr (!dr::is_array_v<Float>)
+            return ray_intersect_scalar<ShadowRay>(ray);
+        else
+            Throw("BVH should only be used in scalar mode");
+    }
+
+    /**
+     * \brief Trace a single ray through the BVH
+     *
+     * When \c Count is set, the visited nodes and primitive intersection
+     * tests are accumulated into \c counters. An instance counts as one
+     * primitive, in addition to the work spent in the kd-tree of its shape
+     * group.
+     */
+    template <bool ShadowRay, bool Count = false>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    ray_intersect_scalar(ScalarRay3f ray,
+                         TraversalCounters *counters = nullptr) const {
+        DRJIT_MARK_USED(counters);
+
+        /// Ray traversal stack entry
+        struct BVHStackEntry {
+            // Distance to the entry point of the child bounding box
+            ScalarFloat t;
+            // Node index or primitive offset
+            Index child;
+            // Primitive count (zero for inner nodes)
+            Size count;
+        };
+
+        // Every visited node replaces its stack entry by at most four others
+        BVHStackEntry stack[3 * MI_BVH_MAXDEPTH + 1];
+        uint32_t stack_index = 0;
+
+        // Resulting intersection struct
+        PreliminaryIntersection<ScalarFloat, Shape> pi;
+
+        if (unlikely(m_nodes.empty()))
+            return pi;
+
+        ScalarVector3f d_rcp = dr::rcp(ray.d);
+        FloatP o[3]     = { FloatP(ray.o.x()), FloatP(ray.o.y()), FloatP(ray.o.z()) },
+               d_inv[3] = { FloatP(d_rcp.x()), FloatP(d_rcp.y()), FloatP(d_rcp.z()) };
+
+        stack[stack_index++] = { 0.f, 0, 0 };
+
+        while (stack_index > 0) {
+            const BVHStackEntry entry = stack[--stack_index];
+
+            // Skip subtrees beyond the closest intersection found so far
+            if (entry.t > ray.maxt)
+                continue;
+
+            if constexpr (Count)
+                counters->nodes++;
+
+            if (entry.count > 0) { // Arrived at a leaf node
+                Index prim_end = entry.child + entry.count;
+                for (Index i = entry.child; i < prim_end; i++) {
+                    PreliminaryIntersection<ScalarFloat, Shape> prim_pi =
+                        intersect_prim<ShadowRay, Count>(m_indices[i], ray, counters);
+
+                    if (unlikely(prim_pi.is_valid())) {
+                        if constexpr (ShadowRay)
+                            return prim_pi;
+
+                        Assert(prim_pi.t >= 0.f && prim_pi.t <= ray.maxt);
+                        pi = prim_pi;
+                        ray.maxt = pi.t;
+                    }
+                }
+                continue;
+            }
+
+            // Inner node: test all four child bounding boxes at once
+            const Node &node = m_nodes[entry.child];
+            FloatP t_min(0.f), t_max(ray.maxt);
+            for (size_t k = 0; k < 3; ++k) {
+                FloatP t0 = (node.bbox_min[k] - o[k]) * d_inv[k],
+                       t1 = (node.bbox_max[k] - o[k]) * d_inv[k];
+                t_min = dr::maximum(t_min, dr::minimum(t0, t1));
+                t_max = dr::minimum(t_max, dr::maximum(t0, t1));
+            }
+
+            /* Unused lanes have inverted bounds, which the slab test above
+               would report as a hit spanning the whole ray */
+            MaskP hit = t_min <= t_max && node.bbox_min[0] <= node.bbox_max[0];
+            if (dr::none(hit))
+                continue;
+
+            alignas(alignof(FloatP)) ScalarFloat t_hit[4];
+            dr::store_aligned(t_hit, dr::select(hit, t_min, FloatP(dr::Infinity<ScalarFloat>)));
+
+            // Sort the intersected children by decreasing distance
+            uint32_t order[4], n_hit = 0;
+            for (uint32_t i = 0; i < 4; ++i) {
+                if (t_hit[i] == dr::Infinity<ScalarFloat>)
+                    continue;
+                uint32_t j = n_hit++;
+                for (; j > 0 && t_hit[order[j - 1]] < t_hit[i]; --j)
+                    order[j] = order[j - 1];
+                order[j] = i;
+            }
+
+            // .. and push them so that the closest one is visited first
+            for (uint32_t j = 0; j < n_hit; ++j) {
+                uint32_t i = order[j];
+                stack[stack_index++] = { t_hit[i], node.child[i], node.count[i] };
+            }
+        }
+
+        return pi;
+    }
+
+    /// Brute force intersection routine for debugging purposes
+    template <bool ShadowRay>
+    MI_INLINE PreliminaryIntersection3f
+    ray_intersect_naive(Ray3f ray, Mask active) const {
+        if constexpr (!dr::is_array_v<Float>) {
+            PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+
+            for (Size i = 0; i < primitive_count(); ++i) {
+                PreliminaryIntersection3f prim_pi = intersect_prim<ShadowRay>(i, ray);
+
+                if (prim_pi.is_valid()) {
+                    pi = prim_pi;
+                    ray.maxt = prim_pi.t;
+                }
+
+                if (ShadowRay && dr::all(pi.is_valid() || !active))
+                    break;
+            }
+
+            return pi;
+        } else {
+            Throw("BVH should only be used in scalar mode");
+        }
+    }
+
+    /// Return a human-readable string representation of the scene contents.
+    virtual std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Node of the intermediate binary hierarchy produced by the SAH builder
+    struct BuildNode {
+        ScalarBoundingBox3f bbox;
+        Index left, right;
+        Index offset;
+        Size count; // zero for inner nodes
+    };
+
+    /// Recursively partition <tt>m_indices[begin, end)</tt> using the binned SAH
+    Index build_recursive(std::vector<BuildNode> &nodes,
+                          const std::vector<ScalarBoundingBox3f> &prim_bbox,
+                          const std::vector<ScalarPoint3f> &centroids,
+                          Index begin, Index end, uint32_t depth);
+
+    /// Collapse the binary hierarchy rooted at \c index into four-wide nodes
+    Index collapse(const std::vector<BuildNode> &nodes, Index index);
+
+    /// Compute the bounding boxes of all primitives (in parallel)
+    std::vector<ScalarBoundingBox3f> primitive_bboxes() const;
+
+    /**
+     * \brief Map an abstract primitive index to a specific shape managed by
+     * the \ref ShapeBVH.
+     *
+     * The function returns the shape index and updates the \a idx parameter to
+     * point to the primitive index (e.g. triangle ID) within the shape.
+     */
+    MI_INLINE Index find_shape(Index &i) const {
+        Assert(i < primitive_count());
+
+        Index shape_index = math::find_interval<Index>(
+            Size(m_primitive_map.size()),
+            [&](Index k) DRJIT_INLINE_LAMBDA {
+                return m_primitive_map[k] <= i;
+            }
+        );
+
+        Assert(shape_index < shape_count() &&
+               m_primitive_map.size() == shape_count() + 1);
+
+        Assert(i >= m_primitive_map[shape_index]);
+        Assert(i <  m_primitive_map[shape_index + 1]);
+        i -= m_primitive_map[shape_index];
+
+        return shape_index;
+    }
+
+    /// Collect the \ref InstanceRecord of all registered instances
+    void prepare_instances();
+
+#if !defined(MI_ENABLE_EMBREE)
+    /// Intersect a ray against the shape group of an instance
+    template <bool ShadowRay = false, bool Count = false>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    intersect_instance(const InstanceRecord &inst, Index shape_index,
+                       const ScalarRay3f &ray,
+                       TraversalCounters *counters = nullptr) const {
+        // Transform the ray into the local frame of the shape group
+        FloatP o = dr::fmadd(inst.to_object[0], ray.o.x(),
+                   dr::fmadd(inst.to_object[1], ray.o.y(),
+                   dr::fmadd(inst.to_object[2], ray.o.z(), inst.to_object[3]))),
+               d = dr::fmadd(inst.to_object[0], ray.d.x(),
+                   dr::fmadd(inst.to_object[1], ray.d.y(),
+                             inst.to_object[2] * ray.d.z()));
+
+        ScalarRay3f ray_local(ScalarPoint3f(o[0], o[1], o[2]),
+                              ScalarVector3f(d[0], d[1], d[2]), ray.maxt,
+                              ray.time, ray.wavelengths);
+
+        PreliminaryIntersection<ScalarFloat, Shape> pi_local =
+            inst.shapegroup->kdtree()->template ray_intersect_scalar<ShadowRay, Count>(
+                ray_local, counters);
+
+        PreliminaryIntersection<ScalarFloat, Shape> pi;
+        if constexpr (ShadowRay) {
+            pi.t = dr::select(pi_local.is_valid(), 0.f, pi.t);
+        } else if (pi_local.is_valid()) {
+            pi.t           = pi_local.t;
+            pi.prim_uv     = pi_local.prim_uv;
+            pi.prim_index  = pi_local.prim_index;
+            pi.shape       = (const Shape *) (size_t) shape_index; // shape_index for LLVM + BVH
+            pi.instance    = m_shapes[shape_index];
+            pi.shape_index = pi_local.shape_index;
+        }
+        return pi;
+    }
+#endif
+
+    /// Check whether a primitive is intersected by the given ray.
+    template <bool ShadowRay = false, bool Count = false>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    intersect_prim(Index prim_index, const ScalarRay3f &ray,
+                   TraversalCounters *counters = nullptr) const {
+        DRJIT_MARK_USED(counters);
+        if constexpr (Count)
+            counters->primitives++;
+
+        Index shape_index  = find_shape(prim_index);
+
+#if !defined(MI_ENABLE_EMBREE)
+        if (!m_instance_index.empty() &&
+            m_instance_index[shape_index] != (Index) -1)
+            return intersect_instance<ShadowRay, Count>(
+                m_instances[m_instance_index[shape_index]], shape_index, ray,
+                counters);
+#endif
+
+        const Shape *shape = this->shape(shape_index);
+        const Mesh *mesh = (const Mesh *) shape;
+
+        PreliminaryIntersection<ScalarFloat, Shape> pi;
+
+        if constexpr (ShadowRay) {
+            bool hit;
+            if (shape->is_mesh())
+                hit = mesh->ray_intersect_triangle_scalar(prim_index, ray).first != dr::Infinity<ScalarFloat>;
+            else
+                hit = shape->ray_test_primitive_scalar(prim_index, ray);
+            pi.t = dr::select(hit, 0.f , pi.t);
+        } else {
+            uint32_t inst_index = (uint32_t) -1;
+            if (shape->is_mesh())
+                std::tie(pi.t, pi.prim_uv) = mesh->ray_intersect_triangle_scalar(prim_index, ray);
+            else
+                std::tie(pi.t, pi.prim_uv, inst_index, prim_index) =
+                    shape->ray_intersect_primitive_scalar(prim_index, ray);
+            pi.prim_index = prim_index;
+
+            bool hit_inst  = (inst_index != (uint32_t) -1);
+            pi.shape       = hit_inst ? (const Shape *) (size_t) shape_index : shape; // shape_index for LLVM + BVH
+            pi.instance    = hit_inst ? shape : nullptr;
+            pi.shape_index = hit_inst ? inst_index : shape_index;
+        }
+
+        return pi;
+    }
+
+protected:
+    std::vector<ref<Shape>> m_shapes;
+    std::vector<Size> m_primitive_map;
+    std::vector<Node> m_nodes;
+    std::vector<Index> m_indices;
+    /// Registered instances (see \ref InstanceRecord)
+    std::vector<InstanceRecord> m_instances;
+    /// Index into \ref m_instances for every shape (-1: not an instance)
+    std::vector<Index> m_instance_index;
+    ScalarBoundingBox3f m_bbox;
+    uint32_t m_bin_count;
+    Size m_max_leaf_size;
+    ScalarFloat m_intersection_cost;
+    ScalarFloat m_traversal_cost;
+};
+
+MI_EXTERN_CLASS(ShapeBVH)
+NAMESPACE_END(mitsuba)
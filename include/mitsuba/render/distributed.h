@@ -0,0 +1,130 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/sstream.h>
+#include <mitsuba/core/xml.h>
+#include <mitsuba/render/fwd.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Description of a render job that a \ref RenderCoordinator sends to
+ * its workers
+ *
+ * The scene is shipped as XML source once per connection. Files referenced
+ * by the scene (meshes, textures, ..) are resolved relative to \c scene_dir
+ * on the worker, so they must be reachable under the same path there (e.g.
+ * through a shared file system).
+ */
+struct MI_EXPORT_LIB RenderJob {
+    /// Variant used to load the scene (e.g. "scalar_rgb")
+    std::string variant;
+
+    /// XML description of the scene
+    std::string scene;
+
+    /// Directory used to resolve relative paths within the scene
+    fs::path scene_dir;
+
+    /// Parameters referenced as <tt>$key</tt> within the scene
+    xml::ParameterList parameters;
+
+    /// Index of the sensor to render with
+    uint32_t sensor_index = 0;
+
+    /// Seed of the render
+    uint32_t seed = 0;
+
+    /// Samples per pixel (0: use the sample count of the sensor's sampler)
+    uint32_t spp = 0;
+
+    /// Create a job from an XML scene file
+    static RenderJob from_file(const fs::path &filename,
+                               const std::string &variant,
+                               const xml::ParameterList &parameters,
+                               uint32_t sensor_index);
+
+    /// Serialize the job into a stream
+    void write(Stream *stream) const;
+
+    /// Deserialize a job from a stream
+    static RenderJob read(Stream *stream);
+};
+
+/**
+ * \brief Serves tile requests of a distributed render on a worker machine
+ *
+ * The worker loads the scene of a \ref RenderJob, then renders the tiles
+ * requested by the coordinator on all local threads, sending the resulting
+ * image blocks back as they complete. Only scalar variants are supported.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB RenderWorker : public Object {
+public:
+    MI_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, SamplingIntegrator)
+
+    /// Load the scene of the job received on \c stream
+    RenderWorker(SocketStream *stream, const RenderJob &job);
+
+    /// Serve tile requests until the coordinator is done or disconnects
+    void run();
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~RenderWorker();
+
+protected:
+    ref<SocketStream> m_stream;
+    RenderJob m_job;
+    ref<Scene> m_scene;
+    ref<Sensor> m_sensor;
+    ref<SamplingIntegrator> m_integrator;
+    uint32_t m_seed;
+};
+
+/**
+ * \brief Distributes the tiles of a render over remote \ref RenderWorker
+ * instances
+ *
+ * Every worker receives the scene once and then a stream of tiles from a
+ * \ref Spiral, keeping as many tiles in flight as it has threads. Rendered
+ * blocks are merged into the film with \ref Film::put_block(). The tiles of
+ * a worker that is lost are handed to the remaining workers; tiles that are
+ * left over when all workers are gone are rendered locally.
+ *
+ * The result matches that of a single-pass render with the same seed and
+ * sample count. Only scalar variants of \ref SamplingIntegrator are
+ * supported.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB RenderCoordinator : public Object {
+public:
+    MI_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, SamplingIntegrator)
+
+    /**
+     * \param scene
+     *     Locally loaded copy of the scene of \c job
+     *
+     * \param workers
+     *     Addresses (<tt>host:port</tt>) of the workers
+     */
+    RenderCoordinator(Scene *scene, const RenderJob &job,
+                      const std::vector<std::string> &workers);
+
+    /// Render the image into the film of the job's sensor
+    void render();
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~RenderCoordinator();
+
+protected:
+    ref<Scene> m_scene;
+    RenderJob m_job;
+    std::vector<std::string> m_workers;
+};
+
+MI_EXTERN_CLASS(RenderWorker)
+MI_EXTERN_CLASS(RenderCoordinator)
+NAMESPACE_END(mitsuba)
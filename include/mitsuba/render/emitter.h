@@ -32,6 +32,9 @@ enum class EmitterFlags : uint32_t {
     /// The emitter is attached to a surface (e.g. area emitters)
     Surface              = 0x00008,
 
+    /// The emitter fills a participating medium (e.g. volume emitters)
+    Medium               = 0x00020,
+
     // =============================================================
     //!                   Other lobe attributes
     // =============================================================
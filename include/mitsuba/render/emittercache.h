@@ -0,0 +1,138 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/fwd.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Spatial cache of the contribution of every emitter, used to guide
+ * the choice of an emitter in next event estimation
+ *
+ * The cache hashes the cells of a regular grid over the scene's bounding box
+ * into a table of fixed size. For every table entry and emitter, it
+ * accumulates the unoccluded contribution of the emitter samples drawn from
+ * that cell (i.e. emitter samples whose shadow rays are blocked contribute
+ * zero), and the number of these samples. \ref update() turns the averages
+ * into a discrete distribution over the emitters of every entry.
+ *
+ * \ref Scene::sample_emitter_direction() draws from this distribution with
+ * probability \ref learned_prob() and otherwise falls back to its default
+ * strategy, which guarantees that every emitter keeps a nonzero probability
+ * and that the estimate remains unbiased. Entries that did not receive any
+ * visible samples only use the default strategy.
+ *
+ * Recording is thread-safe, while \ref update() must not run concurrently
+ * with sampling or recording (integrators call it between rendering passes).
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB EmitterCache : public Object {
+public:
+    MI_IMPORT_TYPES(Emitter, EmitterPtr)
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /**
+     * \brief Create an empty emitter cache
+     *
+     * \param bbox
+     *     Region covered by the spatial grid (usually the scene bounds)
+     *
+     * \param emitters
+     *     Emitters of the scene (in the order of \ref Scene::emitters())
+     *
+     * \param resolution
+     *     Number of grid cells along the longest axis of \c bbox
+     *
+     * \param entry_count
+     *     Size of the hash table (rounded up to a power of two)
+     *
+     * \param training_passes
+     *     Number of calls to \ref update() after which recording stops
+     */
+    EmitterCache(const ScalarBoundingBox3f &bbox,
+                 const std::vector<ref<Emitter>> &emitters,
+                 uint32_t resolution, uint32_t entry_count,
+                 uint32_t training_passes);
+
+    /// Return the hash table entry of the grid cell containing \c p
+    UInt32 entry(const Point3f &p, Mask active = true) const;
+
+    /**
+     * \brief Record the outcome of an emitter sample
+     *
+     * \param value
+     *     Contribution of the emitter sample (divided by the solid angle
+     *     density, but not by the probability of choosing the emitter), or
+     *     zero if the shadow ray is occluded
+     */
+    void record(const UInt32 &entry, const UInt32 &index, const Float &value,
+                Mask active = true) const;
+
+    /// Rebuild the distributions from all data recorded so far
+    void update();
+
+    /// Should \ref record() still be called, i.e. is the cache being trained?
+    bool training() const { return m_update_count < m_training_passes; }
+
+    /// Has \ref update() been called, i.e. can the cache be sampled?
+    bool ready() const { return m_update_count > 0; }
+
+    /// Probability of sampling from the cache in entries that hold a distribution
+    static constexpr ScalarFloat learned_prob() { return .75f; }
+
+    /// Does the given table entry hold a distribution?
+    Mask valid(const UInt32 &entry, Mask active = true) const;
+
+    /**
+     * \brief Sample an emitter from the distribution of a table entry
+     *
+     * \return
+     *    The index of the chosen emitter, its discrete probability, and the
+     *    transformed random sample for reuse
+     */
+    std::tuple<UInt32, Float, Float> sample_emitter(const UInt32 &entry,
+                                                    Float sample,
+                                                    Mask active = true) const;
+
+    /// Evaluate the discrete probability of \ref sample_emitter() choosing an emitter
+    Float pdf_emitter(const UInt32 &entry, const UInt32 &index,
+                      Mask active = true) const;
+
+    /// Return the index of an emitter in the constructor's list
+    UInt32 emitter_index(const EmitterPtr &emitter, Mask active = true) const;
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~EmitterCache();
+
+protected:
+    ScalarBoundingBox3f m_bbox;
+    ScalarFloat m_inv_cell_size;
+    uint32_t m_entry_count;
+    uint32_t m_emitter_count;
+    uint32_t m_training_passes;
+    uint32_t m_update_count = 0;
+
+    /// Per entry and emitter: sum of the recorded values and sample count
+    mutable FloatStorage m_train;
+    std::unique_ptr<std::atomic<ScalarFloat>[]> m_train_scalar;
+
+    /// Per entry and emitter: probabilities and cumulative distributions
+    FloatStorage m_prob;
+    FloatStorage m_cdf;
+
+    /// Maps emitters (scalar variants) or their JIT registry identifiers to emitter indices
+    std::unordered_map<const Emitter *, uint32_t> m_index_map;
+    UInt32Storage m_registry_map;
+};
+
+MI_EXTERN_CLASS(EmitterCache)
+NAMESPACE_END(mitsuba)
@@ -72,6 +72,28 @@ public:
     /// Write the developed contents of the film to a file on disk
     virtual void write(const fs::path &path) const = 0;
 
+    /**
+     * \brief Write the developed contents of the film to a file on disk
+     * while rendering is still in progress
+     *
+     * Films that support this copy their storage into a separate snapshot
+     * buffer and develop it without holding the lock taken by \ref
+     * put_block(), so that render workers are not stalled by the write. The
+     * default implementation simply calls \ref write().
+     */
+    virtual void write_snapshot(const fs::path &path) const;
+
+    /**
+     * \brief Write the developed contents of the film to a file on disk
+     * asynchronously
+     *
+     * The image is developed right away, but encoded and written by the global
+     * \ref BitmapWriter, so that the film can be cleared and reused before the
+     * file is complete. Use \ref BitmapWriter::flush() to wait for pending
+     * writes. The default implementation simply calls \ref write().
+     */
+    virtual void write_async(const fs::path &path) const;
+
     /// dr::schedule() variables that represent the internal film storage
     virtual void schedule_storage() = 0;
 
@@ -12,10 +12,16 @@ template <typename Float, typename Spectrum> class OptixDenoiser;
 template <typename Float, typename Spectrum> class Emitter;
 template <typename Float, typename Spectrum> class Endpoint;
 template <typename Float, typename Spectrum> class Film;
+template <typename Float, typename Spectrum> class GuidingField;
+template <typename Float, typename Spectrum> class LightPathExpressions;
 template <typename Float, typename Spectrum> class ImageBlock;
 template <typename Float, typename Spectrum> class Integrator;
+template <typename Float, typename Spectrum> class LightTree;
+template <typename Float, typename Spectrum> class EmitterCache;
+template <typename Float, typename Spectrum> class Animation;
 template <typename Float, typename Spectrum> class SamplingIntegrator;
 template <typename Float, typename Spectrum> class MonteCarloIntegrator;
+template <typename Float, typename Spectrum> class CppADIntegrator;
 template <typename Float, typename Spectrum> class AdjointIntegrator;
 template <typename Float, typename Spectrum> class Medium;
 template <typename Float, typename Spectrum> class Mesh;
@@ -80,7 +86,13 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using Integrator             = mitsuba::Integrator<FloatU, SpectrumU>;
     using SamplingIntegrator     = mitsuba::SamplingIntegrator<FloatU, SpectrumU>;
     using MonteCarloIntegrator   = mitsuba::MonteCarloIntegrator<FloatU, SpectrumU>;
+    using CppADIntegrator        = mitsuba::CppADIntegrator<FloatU, SpectrumU>;
     using AdjointIntegrator      = mitsuba::AdjointIntegrator<FloatU, SpectrumU>;
+    using LightTree              = mitsuba::LightTree<FloatU, SpectrumU>;
+    using EmitterCache           = mitsuba::EmitterCache<FloatU, SpectrumU>;
+    using Animation              = mitsuba::Animation<FloatU, SpectrumU>;
+    using GuidingField           = mitsuba::GuidingField<FloatU, SpectrumU>;
+    using LightPathExpressions   = mitsuba::LightPathExpressions<FloatU, SpectrumU>;
     using BSDF                   = mitsuba::BSDF<FloatU, SpectrumU>;
     using OptixDenoiser          = mitsuba::OptixDenoiser<FloatU, SpectrumU>;
     using Sensor                 = mitsuba::Sensor<FloatU, SpectrumU>;
@@ -167,7 +179,13 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using Integrator             = typename RenderAliases::Integrator;                             \
     using SamplingIntegrator     = typename RenderAliases::SamplingIntegrator;                     \
     using MonteCarloIntegrator   = typename RenderAliases::MonteCarloIntegrator;                   \
+    using CppADIntegrator        = typename RenderAliases::CppADIntegrator;                        \
     using AdjointIntegrator      = typename RenderAliases::AdjointIntegrator;                      \
+    using LightTree              = typename RenderAliases::LightTree;                              \
+    using EmitterCache           = typename RenderAliases::EmitterCache;                           \
+    using Animation              = typename RenderAliases::Animation;                              \
+    using GuidingField           = typename RenderAliases::GuidingField;                           \
+    using LightPathExpressions   = typename RenderAliases::LightPathExpressions;                   \
     using BSDF                   = typename RenderAliases::BSDF;                                   \
     using OptixDenoiser          = typename RenderAliases::OptixDenoiser;                          \
     using Sensor                 = typename RenderAliases::Sensor;                                 \
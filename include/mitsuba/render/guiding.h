@@ -0,0 +1,190 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <atomic>
+#include <memory>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Learned distribution of incident radiance used for path guiding
+ *
+ * The field partitions the scene's bounding box into a regular grid of
+ * cells. Every cell stores a histogram over the sphere of directions, whose
+ * bins are squares in the cylindrical (equal-area) parameterization
+ * <tt>(cos(theta), phi)</tt>. Integrators deposit estimates of the incident
+ * radiance along sampled directions via \ref record() (usually through a
+ * \ref GuidingField::Vertices instance), and \ref update() turns the
+ * collected data into piecewise-constant sampling densities. These can then
+ * be combined with BSDF sampling using one-sample multiple importance
+ * sampling (see \ref sample_bsdf()).
+ *
+ * Every cell additionally tracks the average incident radiance of the
+ * recorded samples (see \ref radiance()), which serves as a coarse estimate
+ * of the contribution of a path continuation, e.g. for Russian roulette
+ * and splitting.
+ *
+ * Recording is thread-safe, while \ref update() must not run concurrently
+ * with sampling or recording (integrators call it between rendering passes).
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB GuidingField : public Object {
+public:
+    MI_IMPORT_TYPES(BSDFPtr)
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Number of vertices per path whose incident radiance is recorded
+    static constexpr uint32_t MaxTrainingVertices = 4;
+
+    /**
+     * \brief Create an empty guiding field
+     *
+     * \param bbox
+     *     Region covered by the spatial grid (usually the scene bounds)
+     *
+     * \param grid_resolution
+     *     Number of cells along each axis of the spatial grid
+     *
+     * \param bin_resolution
+     *     Number of bins along each axis of the directional histograms
+     */
+    GuidingField(const ScalarBoundingBox3f &bbox, uint32_t grid_resolution,
+                 uint32_t bin_resolution);
+
+    /// Return the index of the histogram bin for the given position and direction
+    UInt32 bin_index(const Point3f &p, const Vector3f &d, Mask active = true) const;
+
+    /// Accumulate a radiance estimate (divided by the sample density) into a bin
+    void record(const UInt32 &index, const Float &value, Mask active = true) const;
+
+    /// Accumulate an incident radiance sample into the cell of the given bin
+    void record_radiance(const UInt32 &index, const Float &radiance,
+                         Mask active = true) const;
+
+    /// Rebuild the sampling densities from all data recorded so far
+    void update();
+
+    /// Discard all recorded data (the sampling densities are kept)
+    void reset();
+
+    /// Has \ref update() been called, i.e. can the field be sampled?
+    bool ready() const { return m_ready; }
+
+    /// Sample a world-space direction, returning it along with its solid angle density
+    std::pair<Vector3f, Float> sample(const Point3f &p, const Point2f &sample,
+                                      Mask active = true) const;
+
+    /// Evaluate the solid angle density of \ref sample()
+    Float pdf(const Point3f &p, const Vector3f &d, Mask active = true) const;
+
+    /**
+     * \brief Return the average incident radiance recorded in the cell
+     * containing \c p, or zero if the cell did not receive any samples
+     *
+     * The radiance (a channel average) is only available after \ref update().
+     */
+    Float radiance(const Point3f &p, Mask active = true) const;
+
+    /**
+     * \brief Combine a BSDF sample with guided sampling using one-sample MIS
+     *
+     * On lanes where \c active is set, a direction is drawn from the field
+     * with probability \c prob (based on \c sample1) and otherwise taken
+     * from the given BSDF sample. The returned sample stores the density of
+     * the mixture (in its \c pdf field), and the returned weight (in the
+     * local frame, like \ref BSDF::sample()) is divided by it. Lanes whose
+     * BSDF has Dirac delta components should not be guided.
+     *
+     * \return
+     *     The updated BSDF sample and weight, and a mask of the lanes that
+     *     used guided sampling.
+     */
+    std::tuple<BSDFSample3f, Spectrum, Mask>
+    sample_bsdf(const BSDFContext &ctx, const BSDFPtr &bsdf,
+                const SurfaceInteraction3f &si, const BSDFSample3f &bs,
+                const Spectrum &weight, Float sample1, const Point2f &sample2,
+                ScalarFloat prob, Mask active) const;
+
+    /// Evaluate the density of \ref sample_bsdf() given the density of the BSDF
+    Float pdf_bsdf(const SurfaceInteraction3f &si, const Vector3f &d,
+                   const Float &bsdf_pdf, ScalarFloat prob, Mask active) const;
+
+    /**
+     * \brief Vertices of a wavefront of paths that are recorded during training
+     *
+     * The incident radiance at a vertex is only known once its path is
+     * complete. The integrator calls \ref put() at every scattering vertex
+     * after updating the path throughput, and \ref finish() once the path has
+     * terminated, which deposits the radiance that arrived at each vertex
+     * along the sampled direction.
+     */
+    struct Vertices {
+        /// Allocate storage for a wavefront of \c width paths
+        Vertices(size_t width);
+
+        /**
+         * \brief Store the state of a path at vertex \c depth
+         *
+         * \param radiance
+         *     The radiance collected by the path so far
+         *
+         * \param throughput
+         *     The path throughput, including the weight of the sampled direction
+         *
+         * \param pdf
+         *     The solid angle density of the sampled direction
+         */
+        void put(const UInt32 &depth, const UInt32 &index,
+                 const Spectrum &radiance, const Spectrum &throughput,
+                 const Float &pdf, Mask active);
+
+        /// Record the incident radiance of all stored vertices into the field
+        void finish(const GuidingField *field, const Spectrum &radiance,
+                    Mask active);
+
+        UInt32 lane;
+        UInt32Storage vertex_index;
+        FloatStorage vertex_radiance, vertex_scale, vertex_pdf;
+    };
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~GuidingField();
+
+    /// Return the index of the spatial cell containing \c p
+    UInt32 cell_index(const Point3f &p, Mask active) const;
+
+protected:
+    ScalarBoundingBox3f m_bbox;
+    ScalarVector3f m_inv_extents;
+    uint32_t m_grid_resolution;
+    uint32_t m_bin_resolution;
+    uint32_t m_cell_count;
+    uint32_t m_bin_count;
+    bool m_ready = false;
+
+    /// Recorded data (scatter-reduced in JIT variants, atomic in scalar variants)
+    mutable FloatStorage m_train;
+    std::unique_ptr<std::atomic<ScalarFloat>[]> m_train_scalar;
+
+    /// Per-cell sum of the recorded incident radiance and sample count
+    mutable FloatStorage m_train_cell;
+    std::unique_ptr<std::atomic<ScalarFloat>[]> m_train_cell_scalar;
+
+    /// Per-bin probabilities and per-cell cumulative distributions
+    FloatStorage m_prob;
+    FloatStorage m_cdf;
+
+    /// Per-cell average incident radiance
+    FloatStorage m_radiance;
+};
+
+MI_EXTERN_CLASS(GuidingField)
+NAMESPACE_END(mitsuba)
@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/render/fwd.h>
@@ -301,6 +302,66 @@ public:
     /// Use Kahan-style error-compensated floating point accumulation?
     bool compensate() const { return m_compensate; }
 
+    /**
+     * \brief Accumulate groups of samples that share a pixel with a
+     * segmented reduction instead of per-sample atomics? (JIT modes only)
+     *
+     * This only takes effect when a sample group size greater than one has
+     * been specified via \ref set_sample_group().
+     */
+    void set_sorted(bool value) { m_sorted = value; }
+
+    /// Accumulate groups of samples that share a pixel with a segmented reduction?
+    bool sorted() const { return m_sorted; }
+
+    /**
+     * \brief Specify how samples are laid out in the wavefronts passed to
+     * \ref put()
+     *
+     * A value of \c n states that the lanes <tt>[i*n, (i+1)*n)</tt> all
+     * sample the same pixel, and that different groups of lanes sample
+     * different pixels. This is the layout generated by the JIT rendering
+     * loop of \ref SamplingIntegrator with \c n samples per pass. In sorted
+     * mode, \ref put() then sums each group before touching the image, so
+     * that every pixel receives a single (uncontended) update instead of
+     * \c n atomic additions.
+     */
+    void set_sample_group(uint32_t value) { m_sample_group = value; }
+
+    /// Return the number of consecutive wavefront lanes that share a pixel
+    uint32_t sample_group() const { return m_sample_group; }
+
+    /**
+     * \brief Record a streaming estimate of the per-pixel sample variance
+     *
+     * The channels <tt>[target, target + count)</tt> then report the
+     * unbiased variance of the values that \ref put() receives for the
+     * channels <tt>[source, source + count)</tt>, where every sample counts
+     * towards the pixel that contains it (irrespective of the reconstruction
+     * filter). The variance is stored premultiplied by the \c weight channel
+     * so that the usual normalization recovers it when the image is
+     * developed, and any values passed to the target channels are ignored.
+     *
+     * The sample count, mean and sum of squared deviations of every pixel are
+     * updated with Welford's algorithm and merged across wavefronts and image
+     * blocks using its parallel formulation by Chan et al. Unlike the raw
+     * second moment, this does not suffer from catastrophic cancellation
+     * when many samples are accumulated in single precision. In JIT variants,
+     * the groups of a wavefront (see \ref set_sample_group()) must sample
+     * distinct pixels, which is the layout generated by \ref
+     * SamplingIntegrator.
+     *
+     * The statistics are kept separately from the image tensor, with \c 2 *
+     * count + 1 values per pixel. When another block recording the variance
+     * is merged via \ref put_block(), this block starts recording it as
+     * well. A \c count of zero disables the feature.
+     */
+    void set_variance(uint32_t source, uint32_t target, uint32_t count,
+                      uint32_t weight);
+
+    /// Return the number of channels whose per-pixel variance is recorded
+    uint32_t variance_count() const { return m_variance_count; }
+
     /// Return the number of channels stored by the image block
     uint32_t channel_count() const { return m_channel_count; }
 
@@ -313,6 +374,15 @@ public:
     /// Return the image reconstruction filter underlying the ImageBlock
     const ReconstructionFilter *rfilter() const { return m_rfilter; }
 
+    /**
+     * \brief Change the reconstruction filter used by \ref put() and
+     * \ref read()
+     *
+     * A value of \c nullptr selects the box filter, which requires
+     * that the block has no border region.
+     */
+    void set_rfilter(const ReconstructionFilter *rfilter);
+
     /// Return the underlying image tensor
     TensorXf &tensor();
 
@@ -331,6 +401,21 @@ protected:
 
     // Implementation detail to atomically accumulate a value into the image block
     void accum(Float value, UInt32 index, Bool active);
+
+    /// Implementation detail of \ref put() in sorted mode (returns \c false if unsupported)
+    bool put_sorted(const Point2f &pos, const Float *values, Mask active);
+
+    /// Implementation detail of \ref put() updating the per-pixel variance
+    void put_variance(const Point2f &pos, const Float *values, Mask active);
+
+    /// Write the per-pixel variance into the target channels of the tensor
+    void develop_variance();
+
+    /// Allocate zero-initialized per-pixel variance statistics
+    void clear_variance();
+
+    /// Register the size of the tensors with the \ref MemoryTracker
+    void update_memory();
 protected:
     ScalarPoint2i m_offset;
     ScalarVector2u m_size;
@@ -344,6 +429,15 @@ protected:
     bool m_compensate;
     bool m_warn_negative;
     bool m_warn_invalid;
+    bool m_sorted;
+    uint32_t m_sample_group;
+    uint32_t m_variance_source;
+    uint32_t m_variance_target;
+    uint32_t m_variance_count;
+    uint32_t m_variance_weight;
+    /// Sample count, means and sums of squared deviations of every pixel
+    TensorXf m_variance;
+    MemoryRecord m_memory { MemoryCategory::Film };
 };
 
 MI_EXTERN_CLASS(ImageBlock)
@@ -14,6 +14,7 @@
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/medium.h>
+#include <drjit/autodiff.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -218,6 +219,108 @@ public:
     //! @}
     // =========================================================================
 
+    /**
+     * \brief Save the render state to a file after every completed pass
+     *
+     * The state consists of the accumulated film storage, the number of
+     * completed passes and the seed and sample counts used by the render.
+     * It is only saved in scalar variants and when adaptive sampling is
+     * disabled. Use \c samples_per_pass to save it more often.
+     *
+     * \param path
+     *     Filename of the state. An empty path disables saving the state.
+     *
+     * \param resume
+     *     If the file already exists, load it and continue rendering with
+     *     the first incomplete pass. The result matches that of an
+     *     uninterrupted render with the same seed and sample count.
+     */
+    void set_state_file(const fs::path &path, bool resume = true);
+
+    /**
+     * \brief Only compile the kernels of subsequent renders (JIT variants)
+     *
+     * When enabled, \ref render() traces and launches the same kernels as a
+     * regular render but only evaluates a single pixel. Since launch sizes
+     * are not part of the generated code, this fills Dr.Jit's kernel cache
+     * for the scene at a negligible cost, so that later renders with the
+     * same configuration skip compilation. The film contents are undefined.
+     */
+    void set_warmup(bool warmup) { m_warmup = warmup; }
+
+    /**
+     * \brief Set the size of the image blocks rendered in parallel (scalar
+     * variants). It must be a power of two, and zero selects it automatically.
+     */
+    void set_block_size(uint32_t block_size) { m_block_size = block_size; }
+
+    /// Return the size of the image blocks (zero: chosen automatically)
+    uint32_t block_size() const { return m_block_size; }
+
+    /**
+     * \brief Set the number of samples per pixel of every pass over the
+     * image, which must divide the sample count. The value
+     * <tt>(uint32_t) -1</tt> renders all samples in a single pass.
+     */
+    void set_samples_per_pass(uint32_t spp) { m_samples_per_pass = spp; }
+
+    /// Return the number of samples per pixel of every pass
+    uint32_t samples_per_pass() const { return m_samples_per_pass; }
+
+    /**
+     * \brief Render a single tile of an image split across several processes
+     *
+     * This renders the same samples as a single-pass call to \ref render()
+     * would for the tile with the given identifier and block size (see
+     * \ref Spiral::next_tile()). It is only supported in scalar variants.
+     *
+     * \param seed
+     *     Seed of the render, already multiplied by the pixel count of the
+     *     (possibly border-extended) film as done by \ref render()
+     */
+    void render_tile(const Scene *scene,
+                     const Sensor *sensor,
+                     Sampler *sampler,
+                     ImageBlock *block,
+                     uint32_t seed,
+                     uint32_t sample_count,
+                     uint32_t block_id,
+                     uint32_t block_size) const;
+
+    /**
+     * \brief Callback invoked by \ref render() before the first pass
+     *
+     * Integrators that adapt their sampling strategy over the course of a
+     * render (e.g. by learning from previous passes) can override this
+     * function to reset their state. The default implementation does nothing.
+     */
+    virtual void render_begin(const Scene *scene, uint32_t n_passes);
+
+    /**
+     * \brief Callback invoked by \ref render() once all samples of a pass
+     * have been computed
+     *
+     * This is only done when \ref needs_pass_callback() returns \c true, in
+     * which case scalar variants wait for all workers to finish the pass. The
+     * default implementation does nothing.
+     */
+    virtual void render_pass_end(uint32_t pass);
+
+    /// Should \ref render_pass_end() be invoked after every pass?
+    virtual bool needs_pass_callback() const { return false; }
+
+    /**
+     * \brief Return the AOVs whose per-pixel sample variance is recorded by
+     * \ref render() (see \ref ImageBlock::set_variance())
+     *
+     * The result contains the index of the first source and target AOV (into
+     * \ref aov_names()) and the number of AOVs. The default implementation
+     * returns a count of zero, which disables the feature.
+     */
+    virtual std::tuple<uint32_t, uint32_t, uint32_t> variance_aovs() const {
+        return { 0u, 0u, 0u };
+    }
+
     MI_DECLARE_CLASS()
 protected:
     SamplingIntegrator(const Properties &props);
@@ -233,6 +336,37 @@ protected:
                               uint32_t block_id,
                               uint32_t block_size) const;
 
+    /// Running luminance statistics of a pixel used by adaptive sampling
+    struct PixelStatistics {
+        uint32_t count = 0;
+        ScalarFloat mean = 0.f;
+        ScalarFloat m2 = 0.f;
+        bool converged = false;
+    };
+
+    /**
+     * \brief Variant of \ref render_block() used by adaptive sampling
+     *
+     * Pixels flagged as converged in \c stats are skipped. The others receive
+     * \c sample_count samples, after which their running luminance mean and
+     * variance are updated and tested against \c threshold.
+     * The statistics of pixel \c p are stored at index
+     * <tt>(p.y - stats_origin.y) * stats_width + (p.x - stats_origin.x)</tt>.
+     */
+    void render_block_adaptive(const Scene *scene,
+                               const Sensor *sensor,
+                               Sampler *sampler,
+                               ImageBlock *block,
+                               Float *aovs,
+                               uint32_t sample_count,
+                               uint32_t seed,
+                               uint32_t block_id,
+                               uint32_t block_size,
+                               PixelStatistics *stats,
+                               const ScalarPoint2i &stats_origin,
+                               uint32_t stats_width,
+                               ScalarFloat threshold) const;
+
     void render_sample(const Scene *scene,
                        const Sensor *sensor,
                        Sampler *sampler,
@@ -242,11 +376,81 @@ protected:
                        ScalarFloat diff_scale_factor,
                        Mask active = true) const;
 
+    /// Write the film storage and progress of a render to \ref m_state_file
+    void save_state(const Film *film, uint32_t seed, uint32_t spp,
+                    uint32_t spp_per_pass, uint32_t passes_done) const;
+
+    /**
+     * \brief Restore the film storage saved by \ref save_state()
+     *
+     * Throws if the state does not match the current render configuration.
+     * Returns the number of completed passes.
+     */
+    uint32_t load_state(Film *film, uint32_t seed, uint32_t spp,
+                        uint32_t spp_per_pass, size_t channels) const;
+
 protected:
 
     /// Size of (square) image blocks to render in parallel (in scalar mode)
     uint32_t m_block_size;
 
+    /// Split expensive image blocks into smaller tiles (in scalar mode)
+    bool m_adaptive_blocks;
+
+    /**
+     * \brief Pin the worker threads to NUMA nodes (in scalar mode)
+     *
+     * The workers of each node accumulate their image blocks into a
+     * film-sized block allocated in node-local memory, which is merged
+     * into the film at the end of every pass.
+     */
+    bool m_numa;
+
+    /**
+     * \brief Importance sample the reconstruction filter of the film
+     *
+     * Every camera sample is offset from its pixel center proportionally to
+     * the filter and added to that pixel alone (weighted by the ratio of the
+     * filter and the sample density), instead of being splatted over the
+     * footprint of the filter.
+     */
+    bool m_filter_sampling;
+
+    /**
+     * \brief Region of interest (in film pixels, including the crop offset)
+     * whose image blocks are rendered first (in scalar mode)
+     *
+     * Without a pass barrier, all passes over the region are rendered
+     * before the rest of the image. A size of zero disables the region.
+     */
+    ScalarPoint2i m_priority_offset;
+    ScalarVector2u m_priority_size;
+
+    /**
+     * \brief Target relative standard error of adaptive sampling.
+     *
+     * Pixels whose luminance estimate falls below this error stop receiving
+     * samples, and the budget of <tt>spp * pixel count</tt> samples is spent
+     * on the remaining ones. A value of zero disables adaptive sampling.
+     */
+    ScalarFloat m_adaptive_threshold;
+
+    /// Samples taken per pixel before the convergence test is applied
+    uint32_t m_adaptive_min_spp;
+
+    /// Upper bound on the samples per pixel (0: four times the sample count)
+    uint32_t m_adaptive_max_spp;
+
+    /**
+     * \brief Wall-clock time to spend on a render (in seconds).
+     *
+     * The samples are then taken in rounds (scalar variants) or passes (JIT
+     * variants) whose size is chosen from the measured throughput so that
+     * the budget is used up, without exceeding the sample count (or the
+     * budget of adaptive sampling). A value of zero disables the budget.
+     */
+    ScalarFloat m_time_budget;
+
     /**
      * \brief Number of samples to compute for each pass over the image blocks.
      *
@@ -254,6 +458,15 @@ protected:
      * If set to (uint32_t) -1, all the work is done in a single pass (default).
      */
     uint32_t m_samples_per_pass;
+
+    /// Render state saved after every pass (see \ref set_state_file())
+    fs::path m_state_file;
+
+    /// Continue from an existing render state?
+    bool m_state_resume = false;
+
+    /// Only compile kernels (see \ref set_warmup())
+    bool m_warmup = false;
 };
 
 /** \brief Abstract integrator that performs *recursive* Monte Carlo sampling
@@ -283,6 +496,75 @@ protected:
     uint32_t m_rr_depth;
 };
 
+/** \brief Abstract base class of the differentiable integrators
+ *
+ * The Python class ``ADIntegrator`` (see ``mitsuba.ad.integrators``) derives
+ * from this class and orchestrates the primal and differential phases of
+ * radiative backpropagation-style methods. Integrators implemented in C++
+ * instead provide their sampling loop by overriding \ref sample_adjoint(),
+ * which can be invoked by the Python orchestration code or directly from C++.
+ * Primal renderings via \ref render() then simply forward to
+ * \ref sample_adjoint() in primal mode.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB CppADIntegrator
+    : public SamplingIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(SamplingIntegrator)
+    MI_IMPORT_TYPES(Scene, Sampler, Medium)
+
+    /**
+     * \brief Sample the incident radiance along a ray and optionally
+     * propagate derivatives
+     *
+     * \param mode
+     *     Specifies whether the loop should compute an ordinary primal
+     *     estimate (\c dr::ADMode::Primal) or propagate derivatives in
+     *     forward (\c dr::ADMode::Forward) or reverse mode
+     *     (\c dr::ADMode::Backward).
+     *
+     * \param delta_L
+     *     In reverse mode, the adjoint radiance (i.e. the gradient of the
+     *     objective with respect to the estimate). Ignored in primal and
+     *     forward mode.
+     *
+     * \param state_in
+     *     Primal estimate computed by a previous invocation in primal mode
+     *     with the same random numbers. Ignored in primal mode.
+     *
+     * \return
+     *     A tuple containing the primal radiance (in primal mode) or the
+     *     differential radiance (in forward and reverse mode), the ray
+     *     validity flag used for alpha blending, and the primal radiance that
+     *     should be provided as \c state_in to the differential phase.
+     */
+    virtual std::tuple<Spectrum, Mask, Spectrum>
+    sample_adjoint(dr::ADMode mode,
+                   const Scene *scene,
+                   Sampler *sampler,
+                   const Ray3f &ray,
+                   const Spectrum &delta_L,
+                   const Spectrum &state_in,
+                   Mask active) const;
+
+    /// Compute a primal estimate via \ref sample_adjoint()
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray,
+                                     const Medium *medium = nullptr,
+                                     Float *aovs = nullptr,
+                                     Mask active = true) const override;
+
+protected:
+    /// Create an integrator
+    CppADIntegrator(const Properties &props);
+
+    /// Virtual destructor
+    virtual ~CppADIntegrator();
+
+    MI_DECLARE_CLASS()
+};
+
 /** \brief Abstract adjoint integrator that performs Monte Carlo sampling
  * starting from the emitters.
  *
@@ -359,6 +641,12 @@ protected:
      */
     uint32_t m_samples_per_pass;
 
+    /**
+     * \brief Memory budget (in bytes, per thread) for the private image
+     * blocks that workers accumulate into in scalar variants
+     */
+    size_t m_block_budget;
+
     /**
      * Longest visualized path depth (\c -1 = infinite).
      * A value of \c 1 will visualize only directly visible light sources.
@@ -374,5 +662,6 @@ protected:
 MI_EXTERN_CLASS(Integrator)
 MI_EXTERN_CLASS(SamplingIntegrator)
 MI_EXTERN_CLASS(MonteCarloIntegrator)
+MI_EXTERN_CLASS(CppADIntegrator)
 MI_EXTERN_CLASS(AdjointIntegrator)
 NAMESPACE_END(mitsuba)
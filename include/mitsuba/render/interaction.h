@@ -387,6 +387,14 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
                               const Vector3f &in_forward_local,
                               const Vector3f &out_forward_local) const {
         if constexpr (is_polarized_v<Spectrum>) {
+            /* Depolarizers are invariant under rotations of the Stokes bases.
+               Skip them in scalar variants (vectorized ones would evaluate
+               both branches anyway). */
+            if constexpr (!dr::is_array_v<Float>) {
+                if (mueller::is_depolarizer(M_local))
+                    return M_local;
+            }
+
             Vector3f in_forward_world  = to_world(in_forward_local),
                      out_forward_world = to_world(out_forward_local);
 
@@ -5,6 +5,7 @@
 
 #include <nanothread/nanothread.h>
 #include <mitsuba/core/bbox.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
@@ -25,6 +26,9 @@
 /// Grain size for parallelization
 #define MI_KD_GRAIN_SIZE 10240u
 
+/// Sort and partition edge event lists of at least this size in parallel
+#define MI_KD_PARALLEL_EVENTS 65536u
+
 /**
  * Temporary scratch space that is used to cache intersection information
  * (# of floats)
@@ -33,6 +37,17 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Work performed while tracing rays through a native acceleration
+ * data structure (see \ref Scene::accel_traversal_stats())
+ */
+struct TraversalCounters {
+    /// Number of visited inner and leaf nodes
+    uint64_t nodes = 0;
+    /// Number of primitive intersection tests
+    uint64_t primitives = 0;
+};
+
 NAMESPACE_BEGIN(detail)
 /**
  * During kd-tree construction, large amounts of memory are required to
@@ -466,6 +481,18 @@ public:
 
     bool ready() const { return (bool) m_nodes; }
 
+    /// Return the number of nodes
+    Size node_count() const { return m_node_count; }
+
+    /// Return the number of primitive references stored in the leaves
+    Size index_count() const { return m_index_count; }
+
+    /**
+     * \brief Return the SAH cost of the tree computed during the last build
+     * (NaN when the tree was loaded from a cache file)
+     */
+    Scalar sah_cost() const { return m_sah_cost; }
+
     /// Return the bounding box of the entire kd-tree
     const BoundingBox bbox() const { return m_bbox; }
 
@@ -790,6 +817,189 @@ protected:
     static_assert(sizeof(Scalar) + sizeof(Index) + sizeof(uint32_t) ==
                   sizeof(EdgeEvent), "EdgeEvent has an unexpected size!");
 
+    /**
+     * \brief Return an 8-bit digit of the radix sort key of an edge event
+     *
+     * The digits are numbered from least to most significant and follow the
+     * ordering of \ref EdgeEvent::operator<() (axis, position, type, index).
+     * Positions are mapped to unsigned integers with the same ordering.
+     */
+    static uint32_t event_digit(const EdgeEvent &e, size_t digit) {
+        if (digit < sizeof(Index))
+            return uint32_t(e.index >> (8 * digit)) & 0xFFu;
+        digit -= sizeof(Index);
+        if (digit == 0)
+            return (uint32_t) e.type;
+        digit -= 1;
+        if (digit < sizeof(Scalar)) {
+            // Flip the sign bit of positive values and all bits of negative ones (-0 == +0)
+            SizedInt sign = SizedInt(1) << (sizeof(SizedInt) * 8 - 1),
+                     bits = dr::memcpy_cast<SizedInt>(e.pos == 0 ? Scalar(0) : e.pos);
+            bits = (bits & sign) ? ~bits : (bits | sign);
+            return uint32_t(bits >> (8 * digit)) & 0xFFu;
+        }
+        return e.axis;
+    }
+
+    /**
+     * \brief Sort an edge event list according to \ref EdgeEvent::operator<()
+     *
+     * Large lists are sorted using a parallel least-significant-digit radix
+     * sort over the 8-bit digits of \ref event_digit(). Digits that are
+     * identical for all events (e.g. the high bytes of the primitive indices
+     * of small scenes) are skipped.
+     */
+    static void sort_events(EdgeEvent *start, EdgeEvent *end) {
+        Size count = Size(end - start);
+        if (count < MI_KD_PARALLEL_EVENTS) {
+            std::sort(start, end);
+            return;
+        }
+
+        constexpr size_t Digits = sizeof(Index) + sizeof(Scalar) + 2;
+        const Size block_size = MI_KD_GRAIN_SIZE,
+                   block_count = (count + block_size - 1) / block_size;
+
+        std::unique_ptr<EdgeEvent[]> temp(new EdgeEvent[count]);
+        std::unique_ptr<Size[]> offsets(new Size[block_count * 256]);
+        EdgeEvent *src = start, *dst = temp.get();
+
+        for (size_t digit = 0; digit < Digits; ++digit) {
+            /* Histogram of the current digit for every block */
+            dr::parallel_for(
+                dr::blocked_range<Size>(0u, block_count, 1u),
+                [&](const dr::blocked_range<Size> &range) {
+                    for (Size b = range.begin(); b != range.end(); ++b) {
+                        Size *hist = offsets.get() + b * 256;
+                        std::fill(hist, hist + 256, Size(0));
+                        const EdgeEvent *it = src + b * block_size,
+                                        *it_end = src + std::min(count, (b + 1) * block_size);
+                        for (; it != it_end; ++it)
+                            hist[event_digit(*it, digit)]++;
+                    }
+                }
+            );
+
+            /* Exclusive prefix sum ordered by digit value, then by block */
+            Size sum = 0;
+            bool skip = false;
+            for (Size value = 0; value < 256 && !skip; ++value) {
+                for (Size b = 0; b < block_count; ++b) {
+                    Size &offset = offsets[b * 256 + value];
+                    Size block_hist = offset;
+                    offset = sum;
+                    sum += block_hist;
+                }
+                skip = sum == count && offsets[value] == 0;
+            }
+            if (skip)
+                continue;
+
+            /* Stable scatter of every block to its offsets */
+            dr::parallel_for(
+                dr::blocked_range<Size>(0u, block_count, 1u),
+                [&](const dr::blocked_range<Size> &range) {
+                    for (Size b = range.begin(); b != range.end(); ++b) {
+                        Size *offset = offsets.get() + b * 256;
+                        const EdgeEvent *it = src + b * block_size,
+                                        *it_end = src + std::min(count, (b + 1) * block_size);
+                        for (; it != it_end; ++it)
+                            dst[offset[event_digit(*it, digit)]++] = *it;
+                    }
+                }
+            );
+
+            std::swap(src, dst);
+        }
+
+        if (src != start)
+            std::copy(src, src + count, start);
+    }
+
+    /**
+     * \brief Partition a large edge event list into the (sorted) lists of the
+     * left and right child in parallel, preserving the order of the events
+     *
+     * Events of primitives straddling the split plane are copied to both
+     * lists if \c include_both is set, and skipped otherwise (they are then
+     * clipped by the caller). If one of the outputs coincides with the input
+     * (in-place partitioning), the events are first copied to a temporary
+     * buffer. Returns the ends of the two output lists.
+     */
+    static std::pair<EdgeEvent *, EdgeEvent *>
+    partition_events(const ClassificationStorage &classification,
+                     const EdgeEvent *start, const EdgeEvent *end,
+                     EdgeEvent *left, EdgeEvent *right, bool include_both) {
+        const Size count = Size(end - start), block_size = MI_KD_GRAIN_SIZE,
+                   block_count = (count + block_size - 1) / block_size;
+
+        bool in_place = left == start || right == start;
+        std::unique_ptr<EdgeEvent[]> temp(in_place ? new EdgeEvent[count] : nullptr);
+        std::unique_ptr<Size[]> offsets(new Size[2 * (block_count + 1)]);
+        const EdgeEvent *src = in_place ? temp.get() : start;
+
+        auto to_left = [include_both](PrimClassification c) {
+            return c == PrimClassification::Left ||
+                   (include_both && c == PrimClassification::Both);
+        };
+        auto to_right = [include_both](PrimClassification c) {
+            return c == PrimClassification::Right ||
+                   (include_both && c == PrimClassification::Both);
+        };
+
+        /* Count the left/right events of every block (and copy them) */
+        dr::parallel_for(
+            dr::blocked_range<Size>(0u, block_count, 1u),
+            [&](const dr::blocked_range<Size> &range) {
+                for (Size b = range.begin(); b != range.end(); ++b) {
+                    Size left_count = 0, right_count = 0;
+                    for (Size i = b * block_size,
+                              i_end = std::min(count, (b + 1) * block_size);
+                         i != i_end; ++i) {
+                        PrimClassification c = classification.get(start[i].index);
+                        Assert(c != PrimClassification::Ignore);
+                        left_count += to_left(c);
+                        right_count += to_right(c);
+                        if (in_place)
+                            temp[i] = start[i];
+                    }
+                    offsets[2 * (b + 1)] = left_count;
+                    offsets[2 * (b + 1) + 1] = right_count;
+                }
+            }
+        );
+
+        offsets[0] = offsets[1] = 0;
+        for (Size b = 1; b <= block_count; ++b) {
+            offsets[2 * b] += offsets[2 * (b - 1)];
+            offsets[2 * b + 1] += offsets[2 * (b - 1) + 1];
+        }
+
+        /* Stable scatter of every block to its offsets */
+        dr::parallel_for(
+            dr::blocked_range<Size>(0u, block_count, 1u),
+            [&](const dr::blocked_range<Size> &range) {
+                for (Size b = range.begin(); b != range.end(); ++b) {
+                    EdgeEvent *left_it = left + offsets[2 * b],
+                              *right_it = right + offsets[2 * b + 1];
+                    for (Size i = b * block_size,
+                              i_end = std::min(count, (b + 1) * block_size);
+                         i != i_end; ++i) {
+                        const EdgeEvent &event = src[i];
+                        PrimClassification c = classification.get(event.index);
+                        if (to_left(c))
+                            *left_it++ = event;
+                        if (to_right(c))
+                            *right_it++ = event;
+                    }
+                }
+            }
+        );
+
+        return { left + offsets[2 * block_count],
+                 right + offsets[2 * block_count + 1] };
+    }
+
     /**
      * \brief Min-max binning data structure with parallel binning & partitioning steps
      *
@@ -1467,7 +1677,13 @@ protected:
             left_events_end = left_events_start;
             right_events_end = right_events_start;
 
-            if (prims_both == 0 || !derived.clip_primitives()) {
+            if ((prims_both == 0 || !derived.clip_primitives()) &&
+                Size(events_end - events_start) >= MI_KD_PARALLEL_EVENTS) {
+                /* Fast path for large lists: partition in parallel */
+                std::tie(left_events_end, right_events_end) =
+                    partition_events(classification, events_start, events_end,
+                                     left_events_start, right_events_start, true);
+            } else if (prims_both == 0 || !derived.clip_primitives()) {
                 /* Fast path: no clipping needed. */
                 for (auto it = events_start; it != events_end; ++it) {
                     auto event = *it;
@@ -1514,17 +1730,28 @@ protected:
                 new_right_events_start = new_right_events_end =
                     right_alloc.template allocate<EdgeEvent>(prims_both * 2 * Dimension);
 
+                /* Partition the events of large lists that don't require
+                   clipping in parallel, and clip the remaining ones below */
+                bool parallel = Size(events_end - events_start) >= MI_KD_PARALLEL_EVENTS;
+                if (parallel)
+                    std::tie(temp_left_events_end, temp_right_events_end) =
+                        partition_events(classification, events_start, events_end,
+                                         temp_left_events_start,
+                                         temp_right_events_start, false);
+
                 for (auto it = events_start; it != events_end; ++it) {
                     auto event = *it;
 
                     /* Fetch the classification of the current event */
                     switch (classification.get(event.index)) {
                         case PrimClassification::Left:
-                            *temp_left_events_end++ = event;
+                            if (!parallel)
+                                *temp_left_events_end++ = event;
                             break;
 
                         case PrimClassification::Right:
-                            *temp_right_events_end++ = event;
+                            if (!parallel)
+                                *temp_right_events_end++ = event;
                             break;
 
                         case PrimClassification::Ignore:
@@ -1597,8 +1824,8 @@ protected:
                 m_ctx.pruned += pruned_left + pruned_right;
 
                 /* Sort the events due to primitives which overlap the split plane */
-                std::sort(new_left_events_start, new_left_events_end);
-                std::sort(new_right_events_start, new_right_events_end);
+                sort_events(new_left_events_start, new_left_events_end);
+                sort_events(new_right_events_start, new_right_events_end);
 
                 /* Merge the left list */
                 left_events_end = std::merge(temp_left_events_start,
@@ -1695,38 +1922,49 @@ protected:
                 m_local.left_alloc.template allocate<EdgeEvent>(initial_size),
                 *events_end = events_start + initial_size;
 
-            for (Size i = 0; i<prim_count; ++i) {
-                Index prim_index = m_indices[i];
-                BoundingBox prim_bbox = derived.bbox(prim_index, m_bbox);
-                bool valid = prim_bbox.valid() && prim_bbox.surface_area() > 0;
-
-                if (unlikely(!valid)) {
-                    --final_prim_count;
-                    m_ctx.pruned++;
-                }
+            std::atomic<Size> invalid_count { 0 };
+            dr::parallel_for(
+                dr::blocked_range<Size>(0u, prim_count, MI_KD_GRAIN_SIZE),
+                [&](const dr::blocked_range<Index> &range) {
+                    Size invalid_count_local = 0;
 
-                for (Index axis = 0; axis < Dimension; ++axis) {
-                    Scalar min = prim_bbox.min[axis], max = prim_bbox.max[axis];
-                    Index offset = (Index) (axis * prim_count + i) * 2;
-
-                    if (unlikely(!valid)) {
-                        events_start[offset  ].set_invalid();
-                        events_start[offset+1].set_invalid();
-                    } else if (min == max) {
-                        events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgePlanar, axis, min, prim_index);
-                        events_start[offset+1].set_invalid();
-                    } else {
-                        events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgeStart, axis, min, prim_index);
-                        events_start[offset+1] = EdgeEvent(EdgeEvent::Type::EdgeEnd,   axis, max, prim_index);
+                    for (Size i = range.begin(); i != range.end(); ++i) {
+                        Index prim_index = m_indices[i];
+                        BoundingBox prim_bbox = derived.bbox(prim_index, m_bbox);
+                        bool valid = prim_bbox.valid() && prim_bbox.surface_area() > 0;
+
+                        if (unlikely(!valid))
+                            invalid_count_local++;
+
+                        for (Index axis = 0; axis < Dimension; ++axis) {
+                            Scalar min = prim_bbox.min[axis], max = prim_bbox.max[axis];
+                            Index offset = (Index) (axis * prim_count + i) * 2;
+
+                            if (unlikely(!valid)) {
+                                events_start[offset  ].set_invalid();
+                                events_start[offset+1].set_invalid();
+                            } else if (min == max) {
+                                events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgePlanar, axis, min, prim_index);
+                                events_start[offset+1].set_invalid();
+                            } else {
+                                events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgeStart, axis, min, prim_index);
+                                events_start[offset+1] = EdgeEvent(EdgeEvent::Type::EdgeEnd,   axis, max, prim_index);
+                            }
+                        }
                     }
+
+                    invalid_count += invalid_count_local;
                 }
-            }
+            );
+
+            final_prim_count -= invalid_count;
+            m_ctx.pruned += invalid_count;
 
             /* Release index list */
             IndexVector().swap(m_indices);
 
             /* Sort the events list and remove invalid ones from the end */
-            std::sort(events_start, events_end);
+            sort_events(events_start, events_end);
             while (events_start != events_end && !(events_end-1)->valid())
                 --events_end;
 
@@ -1890,6 +2128,7 @@ protected:
                                        m_bbox, 0, 0, &final_cost);
             task.execute();
         }
+        m_sah_cost = final_cost;
 
         Log(m_log_level, "Structural kd-tree statistics:");
 
@@ -1999,6 +2238,7 @@ protected:
     std::unique_ptr<Index[]> m_indices;
     Size m_node_count = 0;
     Size m_index_count = 0;
+    Scalar m_sah_cost = dr::NaN<Scalar>;
 
     CostModel m_cost_model;
     bool m_clip_primitives = true;
@@ -2147,6 +2387,37 @@ public:
     using Base::m_indices;
     using Base::m_index_count;
     using Base::m_node_count;
+    using Base::m_sah_cost;
+
+    using FloatP    = dr::Packet<ScalarFloat, 4>;
+    using MaskP     = dr::mask_t<FloatP>;
+    using Point3fP  = Point<FloatP, 3>;
+    using Vector3fP = Vector<FloatP, 3>;
+
+    /**
+     * \brief Four triangles of a leaf, stored in SoA layout and prepared for
+     * a single SIMD Moeller-Trumbore intersection test
+     *
+     * Unused lanes have a NaN vertex position and never report a hit.
+     */
+    struct TriangleBatch {
+        Point3fP p0;
+        /// Edge vectors <tt>p1 - p0</tt> and <tt>p2 - p0</tt>
+        Vector3fP e1, e2;
+        /// Shape and (shape-local) triangle index of each lane
+        Index shape_index[4];
+        Index prim_index[4];
+    };
+
+    /// Range of the triangle batches of a leaf (see \ref m_leaf_batches)
+    struct LeafBatches {
+        /// Index of the first batch in \ref m_batches
+        Index offset;
+        /// Number of batches
+        Size count;
+        /// Number of triangles, which precede the other primitives of the leaf
+        Size triangles;
+    };
 
     /// Create an empty kd-tree and take build-related parameters from \c props.
     ShapeKDTree(const Properties &props);
@@ -2157,9 +2428,22 @@ public:
     /// Register a new shape with the kd-tree (to be called before \ref build())
     void add_shape(Shape *shape);
 
-    /// Build the kd-tree
+    /**
+     * \brief Build the kd-tree
+     *
+     * When a cache directory was specified (\c kd_cache_dir), the first
+     * build first looks for a tree that was previously built from identical
+     * geometry and build parameters, and stores the result otherwise.
+     */
     void build();
 
+    /// Return the memory used by the nodes, indices and packed leaves (bytes)
+    size_t memory() const {
+        return m_index_count * sizeof(Index) + m_node_count * sizeof(KDNode) +
+               m_batches.size() * sizeof(TriangleBatch) +
+               (m_leaf_batches ? m_index_count * sizeof(LeafBatches) : 0);
+    }
+
     /// Return the number of registered shapes
     Size shape_count() const { return Size(m_shapes.size()); }
 
@@ -2194,9 +2478,18 @@ public:
             Throw("kdtree should only be used in scalar mode");
     }
 
-    template <bool ShadowRay>
+    /**
+     * \brief Trace a single ray through the kd-tree
+     *
+     * When \c Count is set, the visited nodes and primitive intersection
+     * tests are accumulated into \c counters.
+     */
+    template <bool ShadowRay, bool Count = false>
     MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
-    ray_intersect_scalar(ScalarRay3f ray) const {
+    ray_intersect_scalar(ScalarRay3f ray,
+                         TraversalCounters *counters = nullptr) const {
+        DRJIT_MARK_USED(counters);
+
         /// Ray traversal stack entry
         struct KDStackEntry {
             // Ray distance associated with the node entry and exit point
@@ -2222,6 +2515,9 @@ public:
 
         const KDNode *node = m_nodes.get();
         while (mint <= maxt) {
+            if constexpr (Count)
+                counters->nodes++;
+
             if (likely(!node->leaf())) { // Inner node
                 const ScalarFloat split = node->split();
                 const uint32_t axis     = node->axis();
@@ -2261,6 +2557,26 @@ public:
             } else if (node->primitive_count() > 0) { // Arrived at a leaf node
                 Index prim_start = node->primitive_offset();
                 Index prim_end = prim_start + node->primitive_count();
+
+                if (m_leaf_batches) {
+                    // Test the packed triangles of the leaf four at a time
+                    const LeafBatches &lb = m_leaf_batches[prim_start];
+                    if constexpr (Count)
+                        counters->primitives += lb.triangles;
+                    for (Size j = 0; j < lb.count; ++j) {
+                        if (intersect_batch<ShadowRay>(m_batches[lb.offset + j],
+                                                       ray, pi)) {
+                            if constexpr (ShadowRay)
+                                return pi;
+                            ray.maxt = pi.t;
+                        }
+                    }
+                    prim_start += lb.triangles;
+                }
+
+                if constexpr (Count)
+                    counters->primitives += prim_end - prim_start;
+
                 for (Index i = prim_start; i < prim_end; i++) {
                     Index prim_index = m_indices[i];
 
@@ -2292,16 +2608,35 @@ public:
         return pi;
     }
 
-#if 0
-    template <bool ShadowRay>
-    MI_INLINE PreliminaryIntersection3f ray_intersect_packet(Ray3f ray,
-                                                              Mask active) const {
+    /**
+     * \brief Trace a packet of \c Width rays through the tree at once
+     *
+     * All lanes share a single traversal: every node is read once for the
+     * whole packet, and a subtree is skipped when none of the active lanes
+     * overlaps it. This pays off for coherent rays (e.g. primary rays of a
+     * tile of pixels or shadow rays towards the same emitter), which mostly
+     * visit the same nodes. Incoherent packets remain correct but visit the
+     * union of the nodes of their rays.
+     *
+     * \param rays
+     *     The rays to trace (their \c maxt fields are updated)
+     *
+     * \param valid
+     *     Lanes that should be traced
+     *
+     * \param pi
+     *     Receives the intersection of every traced lane
+     */
+    template <bool ShadowRay, size_t Width>
+    MI_INLINE void
+    ray_intersect_packet(ScalarRay3f *rays, const bool *valid,
+                         PreliminaryIntersection<ScalarFloat, Shape> *pi) const {
         /// Ray traversal stack entry
         struct KDStackEntry {
-            // Ray distance associated with the node entry and exit point
-            Float mint, maxt;
-            // Is the corresponding SIMD lane enabled?
-            Mask active;
+            // Ray distances associated with the node entry and exit points
+            ScalarFloat mint[Width], maxt[Width];
+            // Lanes that need to visit the node
+            bool active[Width];
             // Pointer to the far child
             const KDNode *node;
         };
@@ -2310,95 +2645,143 @@ public:
         KDStackEntry stack[MI_KD_MAXDEPTH];
         int32_t stack_index = 0;
 
-        // Resulting intersection struct
-        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
-
-        const KDNode *node = m_nodes.get();
+        ScalarFloat mint[Width], maxt[Width], t_plane[Width];
+        bool active[Width], left_first[Width], single_node[Width],
+             visit_left[Width];
+        ScalarVector3f d_rcp[Width];
 
-        /* Intersect against the scene bounding box */
-        auto bbox_result = m_bbox.ray_intersect(ray);
-        Float mint = dr::maximum(ray.mint, std::get<1>(bbox_result));
-        Float maxt = dr::minimum(ray.maxt, std::get<2>(bbox_result));
+        // Intersect against the scene bounding box
+        for (size_t i = 0; i < Width; ++i) {
+            pi[i] = PreliminaryIntersection<ScalarFloat, Shape>();
+            active[i] = valid[i];
+            if (!valid[i])
+                continue;
+            auto bbox_result = m_bbox.ray_intersect(rays[i]);
+            mint[i] = std::max(ScalarFloat(0), std::get<1>(bbox_result));
+            maxt[i] = std::min(rays[i].maxt, std::get<2>(bbox_result));
+            d_rcp[i] = dr::rcp(rays[i].d);
+        }
 
+        const KDNode *node = m_nodes.get();
         while (true) {
-            active = active && (maxt >= mint);
-            if (ShadowRay)
-                active = active && !pi.is_valid();
+            bool any_active = false;
+            for (size_t i = 0; i < Width; ++i) {
+                active[i] = active[i] && mint[i] <= maxt[i];
+                if constexpr (ShadowRay)
+                    active[i] = active[i] && !pi[i].is_valid();
+                any_active |= active[i];
+            }
 
-            if (likely(dr::any(active))) {
+            if (likely(any_active)) {
                 if (likely(!node->leaf())) { // Inner node
-                    const dr::scalar_t<Float> split = node->split();
-                    const uint32_t axis = node->axis();
-
-                    // Compute parametric distance along the rays to the split plane
-                    Float t_plane          = (split - ray.o[axis]) * ray.d_rcp[axis];
-                    Mask left_first        = (ray.o[axis] < split) ||
-                                              (dr::eq(ray.o[axis], split) && ray.d[axis] >= 0.f),
-                         start_after       = t_plane < mint,
-                         end_before        = t_plane > maxt || t_plane < 0.f || !dr::isfinite(t_plane),
-                         single_node       = start_after || end_before,
-                         visit_left        = dr::eq(end_before, left_first),
-                         visit_only_left   = single_node &&  visit_left,
-                         visit_only_right  = single_node && !visit_left;
-
-                    bool all_visit_only_left  = dr::all(visit_only_left || !active),
-                         all_visit_only_right = dr::all(visit_only_right || !active),
-                         all_visit_same_node  = all_visit_only_left || all_visit_only_right;
-
-                    /* If we only need to visit one node, just pick the correct one and continue */
-                    if (all_visit_same_node) {
+                    const ScalarFloat split = node->split();
+                    const uint32_t axis     = node->axis();
+
+                    bool all_visit_only_left = true, all_visit_only_right = true;
+                    size_t left_votes = 0, right_votes = 0;
+
+                    for (size_t i = 0; i < Width; ++i) {
+                        if (!active[i])
+                            continue;
+
+                        /* Compute parametric distance along the ray to the split plane */
+                        const ScalarRay3f &ray = rays[i];
+                        t_plane[i] = (split - ray.o[axis]) * d_rcp[i][axis];
+
+                        left_first[i] = (ray.o[axis] < split) ||
+                                        (ray.o[axis] == split && ray.d[axis] >= 0.f);
+                        bool start_after = t_plane[i] < mint[i],
+                             end_before  = t_plane[i] > maxt[i] || t_plane[i] < 0.f ||
+                                           !dr::isfinite(t_plane[i]);
+                        single_node[i] = start_after || end_before;
+                        visit_left[i]  = end_before == left_first[i];
+
+                        all_visit_only_left  &= single_node[i] &&  visit_left[i];
+                        all_visit_only_right &= single_node[i] && !visit_left[i];
+                        left_votes  += left_first[i] ? 1 : 0;
+                        right_votes += left_first[i] ? 0 : 1;
+                    }
+
+                    /* If all lanes only need to visit one node, just pick it and continue */
+                    if (all_visit_only_left || all_visit_only_right) {
                         node = node->left() + (all_visit_only_left ? 0 : 1);
                         continue;
                     }
 
-                    size_t left_votes  = count(left_first && active),
-                           right_votes = count(!left_first && active);
-
+                    /* Visit both child nodes in the order preferred by most lanes */
                     bool go_left = left_votes >= right_votes;
-
-                    Mask go_left_bcast = Mask(go_left),
-                         correct_order = dr::eq(left_first, go_left_bcast),
-                         visit_both    = !single_node,
-                         visit_cur     = visit_both || eq (visit_left, go_left_bcast),
-                         visit_next    = visit_both || dr::neq(visit_left, go_left_bcast);
-
-                    /* Visit both child nodes in the right order */
                     Index node_offset = go_left ? 0 : 1;
                     const KDNode *left   = node->left(),
                                  *n_cur  = left + node_offset,
                                  *n_next = left + (1 - node_offset);
 
                     /* Postpone visit to 'n_next' */
-                    Mask sel0 =  correct_order && visit_both,
-                         sel1 = !correct_order && visit_both;
                     KDStackEntry& entry = stack[stack_index++];
-                    entry.mint = dr::select(sel0, t_plane, mint);
-                    entry.maxt = dr::select(sel1, t_plane, maxt);
-                    entry.active = active && visit_next;
                     entry.node = n_next;
 
-                    /* Visit 'n_cur' now */
-                    mint = dr::select(sel1, t_plane, mint);
-                    maxt = dr::select(sel0, t_plane, maxt);
-                    active = active && visit_cur;
+                    for (size_t i = 0; i < Width; ++i) {
+                        if (!active[i]) {
+                            entry.active[i] = false;
+                            continue;
+                        }
+
+                        bool correct_order = left_first[i] == go_left,
+                             visit_both    = !single_node[i],
+                             visit_cur     = visit_both || visit_left[i] == go_left,
+                             visit_next    = visit_both || visit_left[i] != go_left,
+                             sel0          =  correct_order && visit_both,
+                             sel1          = !correct_order && visit_both;
+
+                        entry.mint[i]   = sel0 ? t_plane[i] : mint[i];
+                        entry.maxt[i]   = sel1 ? t_plane[i] : maxt[i];
+                        entry.active[i] = visit_next;
+
+                        /* Visit 'n_cur' now */
+                        if (sel1)
+                            mint[i] = t_plane[i];
+                        if (sel0)
+                            maxt[i] = t_plane[i];
+                        active[i] = visit_cur;
+                    }
+
                     node = n_cur;
                     continue;
                 } else if (node->primitive_count() > 0) { // Arrived at a leaf node
                     Index prim_start = node->primitive_offset();
                     Index prim_end = prim_start + node->primitive_count();
-                    for (Index i = prim_start; i < prim_end; i++) {
-                        Index prim_index = m_indices[i];
 
-                        PreliminaryIntersection3f prim_pi =
-                            intersect_prim<ShadowRay>(prim_index, ray, active);
+                    if (m_leaf_batches) {
+                        const LeafBatches &lb = m_leaf_batches[prim_start];
+                        for (Size j = 0; j < lb.count; ++j) {
+                            const TriangleBatch &batch = m_batches[lb.offset + j];
+                            for (size_t i = 0; i < Width; ++i) {
+                                if (!active[i] || (ShadowRay && pi[i].is_valid()))
+                                    continue;
+                                if (intersect_batch<ShadowRay>(batch, rays[i], pi[i])) {
+                                    if constexpr (!ShadowRay)
+                                        rays[i].maxt = pi[i].t;
+                                }
+                            }
+                        }
+                        prim_start += lb.triangles;
+                    }
+
+                    for (Index j = prim_start; j < prim_end; j++) {
+                        Index prim_index = m_indices[j];
 
-                        dr::masked(pi, prim_pi.is_valid()) = prim_pi;
+                        for (size_t i = 0; i < Width; ++i) {
+                            if (!active[i] || (ShadowRay && pi[i].is_valid()))
+                                continue;
 
-                        if constexpr (!ShadowRay) {
-                            Assert(dr::all(!prim_pi.is_valid() ||
-                                       (prim_pi.t >= ray.mint &&
-                                        prim_pi.t <= ray.maxt)));
-                            dr::masked(ray.maxt, prim_pi.is_valid()) = prim_pi.t;
+                            PreliminaryIntersection<ScalarFloat, Shape> prim_pi =
+                                intersect_prim<ShadowRay>(prim_index, rays[i]);
+
+                            if (unlikely(prim_pi.is_valid())) {
+                                Assert(prim_pi.t >= 0.f && prim_pi.t <= rays[i].maxt);
+                                pi[i] = prim_pi;
+                                if constexpr (!ShadowRay)
+                                    rays[i].maxt = prim_pi.t;
+                            }
                         }
                     }
                 }
@@ -2407,18 +2790,19 @@ public:
             if (likely(stack_index > 0)) {
                 --stack_index;
                 KDStackEntry& entry = stack[stack_index];
-                mint = entry.mint;
-                maxt = dr::minimum(entry.maxt, ray.maxt);
-                active = entry.active;
+                for (size_t i = 0; i < Width; ++i) {
+                    active[i] = entry.active[i];
+                    if (active[i]) {
+                        mint[i] = entry.mint[i];
+                        maxt[i] = std::min(entry.maxt[i], rays[i].maxt);
+                    }
+                }
                 node = entry.node;
             } else {
                 break;
             }
         }
-
-        return pi;
     }
-#endif
 
     /// Brute force intersection routine for debugging purposes
     template <bool ShadowRay>
@@ -2519,9 +2903,88 @@ protected:
         return pi;
     }
 
+    /**
+     * \brief Intersect a ray against the four triangles of a batch
+     *
+     * When a triangle is hit before <tt>ray.maxt</tt>, \c pi is overwritten
+     * with the closest one and the function returns \c true.
+     */
+    template <bool ShadowRay = false>
+    MI_INLINE bool intersect_batch(const TriangleBatch &batch,
+                                   const ScalarRay3f &ray,
+                                   PreliminaryIntersection<ScalarFloat, Shape> &pi) const {
+        Vector3fP d(ray.d.x(), ray.d.y(), ray.d.z());
+        Point3fP o(ray.o.x(), ray.o.y(), ray.o.z());
+
+        Vector3fP pvec = dr::cross(d, batch.e2);
+        FloatP inv_det = dr::rcp(dr::dot(batch.e1, pvec));
+
+        Vector3fP tvec = o - batch.p0;
+        FloatP u = dr::dot(tvec, pvec) * inv_det;
+        MaskP active = u >= 0.f && u <= 1.f;
+
+        Vector3fP qvec = dr::cross(tvec, batch.e1);
+        FloatP v = dr::dot(d, qvec) * inv_det;
+        active &= v >= 0.f && u + v <= 1.f;
+
+        FloatP t = dr::dot(batch.e2, qvec) * inv_det;
+        active &= t >= 0.f && t <= ray.maxt;
+
+        if (likely(dr::none(active)))
+            return false;
+
+        if constexpr (ShadowRay) {
+            pi.t = 0.f;
+        } else {
+            alignas(alignof(FloatP)) ScalarFloat t_hit[4], u_hit[4], v_hit[4];
+            dr::store_aligned(t_hit, dr::select(active, t, FloatP(dr::Infinity<ScalarFloat>)));
+            dr::store_aligned(u_hit, u);
+            dr::store_aligned(v_hit, v);
+
+            uint32_t k = 0;
+            for (uint32_t i = 1; i < 4; ++i)
+                k = t_hit[i] < t_hit[k] ? i : k;
+
+            const Shape *shape = m_shapes[batch.shape_index[k]];
+            pi.t           = t_hit[k];
+            pi.prim_uv     = ScalarPoint2f(u_hit[k], v_hit[k]);
+            pi.prim_index  = batch.prim_index[k];
+            pi.shape       = shape;
+            pi.instance    = nullptr;
+            pi.shape_index = batch.shape_index[k];
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Reorder the primitives of each leaf so that triangles come
+     * first, and pack the triangles into \ref m_batches
+     */
+    void pack_leaves();
+
+protected:
+    /// Hash of the registered geometry and build parameters (cache key)
+    uint64_t cache_key() const;
+
+    /// Try to load a previously built tree from \c m_cache_dir
+    bool cache_load(uint64_t key);
+
+    /// Store the current tree in \c m_cache_dir
+    void cache_store(uint64_t key) const;
+
 protected:
     std::vector<ref<Shape>> m_shapes;
     std::vector<Size> m_primitive_map;
+    fs::path m_cache_dir;
+    bool m_cache_enabled = false;
+
+    /// Pack the triangles of the leaves for SIMD intersection tests?
+    bool m_packed_leaves = true;
+    /// Packed triangles of all leaves
+    std::vector<TriangleBatch> m_batches;
+    /// Batch ranges, indexed by the primitive offset of a leaf
+    std::unique_ptr<LeafBatches[]> m_leaf_batches;
 };
 
 MI_EXTERN_CLASS(ShapeKDTree)
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Spatial hierarchy over the emitters of a scene, used to pick an
+ * emitter proportionally to its estimated contribution at a reference point
+ *
+ * Every node of the binary tree stores conservative bounds on the position
+ * (an axis-aligned bounding box), the emission directions (a cone of normals
+ * and an angle by which emission spreads around it) and the total power of
+ * the emitters below it. Sampling descends from the root and chooses each
+ * child with a probability proportional to an importance that bounds the
+ * contribution of its emitters to the reference point, accounting for their
+ * distance, orientation and power. Evaluating the probability of a given
+ * emitter retraces the path from the root to its leaf.
+ *
+ * The traversal only involves gathers from flat node arrays and therefore
+ * works in both scalar and JIT variants.
+ *
+ * Emitters without a position (environment maps, directional emitters) are
+ * not part of the hierarchy. They are chosen uniformly with a probability of
+ * <tt>n / (n + 1)</tt> when the scene contains \c n such emitters. Area
+ * emitters attached to a \ref Mesh are bounded by the cone of their face
+ * normals (treated as two-sided), while other emitters use a conservative
+ * bound covering the full sphere of directions. The power of each emitter
+ * is estimated once at construction time by averaging the weights of
+ * emitted rays, and multiplied by its sampling weight.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB LightTree : public Object {
+public:
+    MI_IMPORT_TYPES(Emitter, Mesh)
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Build a light tree over the given emitters
+    LightTree(const std::vector<ref<Emitter>> &emitters);
+
+    /**
+     * \brief Sample an emitter given a reference point
+     *
+     * \return
+     *    The index of the chosen emitter (within the list passed to the
+     *    constructor), its discrete probability, and the transformed random
+     *    sample for reuse. A probability of zero indicates that no emitter
+     *    can contribute to the reference point.
+     */
+    std::tuple<UInt32, Float, Float> sample_emitter(const Interaction3f &ref,
+                                                    Float sample,
+                                                    Mask active = true) const;
+
+    /// Evaluate the discrete probability of \ref sample_emitter() choosing the given emitter
+    Float pdf_emitter(const Interaction3f &ref, const EmitterPtr &emitter,
+                      Mask active = true) const;
+
+    /// Return the number of nodes of the hierarchy
+    uint32_t node_count() const { return m_node_count; }
+
+    /// Return the number of emitters located within the hierarchy
+    uint32_t emitter_count() const { return m_tree_count; }
+
+    /// Return the number of emitters that are sampled uniformly (infinite emitters)
+    uint32_t infinite_count() const { return (uint32_t) m_infinite.size(); }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~LightTree();
+
+    /// Bounds of a set of emitters (\c emitter is only meaningful for leaves)
+    struct LightBounds {
+        uint32_t emitter = 0;
+        ScalarBoundingBox3f bbox;
+        ScalarVector3f axis = ScalarVector3f(0.f, 0.f, 1.f);
+        ScalarFloat cos_theta_o = -1.f;
+        ScalarFloat cos_theta_e = 0.f;
+        ScalarFloat power = 0.f;
+    };
+
+    /// Compute conservative bounds for an emitter
+    LightBounds emitter_bounds(const Emitter *emitter) const;
+
+    /// Estimate the power of an emitter from a set of emitted rays
+    ScalarFloat estimate_power(const Emitter *emitter) const;
+
+    /// Compute the union of two bounds
+    static LightBounds merge(const LightBounds &a, const LightBounds &b);
+
+    /**
+     * \brief Recursively build the subtree over <tt>bounds[start, end)</tt>
+     * and record the path from the root to every leaf in \c trails and
+     * \c depths
+     */
+    void build(std::vector<LightBounds> &bounds, uint32_t start, uint32_t end,
+               uint32_t node, uint32_t trail, uint32_t depth,
+               uint32_t &next_node, std::vector<uint32_t> &trails,
+               std::vector<uint32_t> &depths);
+
+    /// Importance of a node for the given reference point
+    Float importance(const Interaction3f &ref, const UInt32 &node,
+                     Mask active) const;
+
+    /// Return the index of an emitter in the constructor's list
+    UInt32 emitter_index(const EmitterPtr &emitter, Mask active) const;
+
+protected:
+    /// Per node: bbox min (3), bbox max (3), axis (3), cos_theta_o, cos_theta_e, power
+    std::vector<ScalarFloat> m_nodes_host;
+    FloatStorage m_nodes;
+
+    /// Per node: index of the left child (the right child follows it), or
+    /// <tt>0x80000000 | emitter index</tt> for leaves
+    std::vector<uint32_t> m_children_host;
+    UInt32Storage m_children;
+
+    /// Per emitter: the branches taken from the root (bit \c i: right child at depth \c i)
+    UInt32Storage m_trail;
+
+    /// Per emitter: depth of its leaf, or \c 0xFFFFFFFF if it is not part of the tree
+    UInt32Storage m_depth;
+
+    /// Maps emitters (scalar variants) or their JIT registry identifiers to emitter indices
+    std::unordered_map<const Emitter *, uint32_t> m_index_map;
+    UInt32Storage m_registry_map;
+
+    /// Indices of the emitters that are sampled uniformly
+    std::vector<uint32_t> m_infinite;
+    UInt32Storage m_infinite_dr;
+
+    uint32_t m_node_count = 0;
+    uint32_t m_tree_count = 0;
+    uint32_t m_max_depth = 0;
+
+    /// Probability of choosing an infinite emitter
+    ScalarFloat m_infinite_prob = 0.f;
+};
+
+MI_EXTERN_CLASS(LightTree)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/fwd.h>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Set of compiled light path expressions (LPEs) that classify the
+ * paths of a path tracer into separate image components
+ *
+ * An expression is a regular expression over the scattering events of a path,
+ * starting at the sensor (\c C, optional) and ending at an emitter (\c L).
+ * The events are named after the BSDF lobe that was sampled (or evaluated for
+ * emitter samples) at the vertex:
+ *
+ * - \c D: diffuse reflection
+ * - \c G: glossy reflection
+ * - \c S: specular (i.e. Dirac delta) reflection
+ * - \c T: transmission (of any kind)
+ *
+ * Null events (e.g. at an index-matched boundary) are ignored. Events can be
+ * combined with \c . (any event), sets such as <tt>[DG]</tt> or
+ * <tt>[^D]</tt>, grouping with parentheses, alternatives (\c |) and the
+ * repetition operators <tt>*</tt>, <tt>+</tt> and <tt>?</tt>. A light group
+ * <tt>L'prefix'</tt> restricts an expression to the emitters whose identifier
+ * starts with \c prefix. For instance, <tt>C D L</tt> selects direct diffuse
+ * illumination, and <tt>C .* S .* L'sun'</tt> selects all light from emitters
+ * named \c sun* that underwent at least one specular reflection.
+ *
+ * Every expression is compiled into a deterministic finite automaton, and the
+ * states of all automata are packed into a single 32 bit integer that paths
+ * update with one table lookup per expression and vertex.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB LightPathExpressions : public Object {
+public:
+    MI_IMPORT_TYPES(Emitter, EmitterPtr)
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Maximum number of expressions
+    static constexpr size_t MaxCount = 16;
+
+    /// Scattering events distinguished by the expressions
+    enum class Event : uint32_t { Diffuse = 0, Glossy, Specular, Transmission, Count };
+
+    /**
+     * \brief Compile a comma-separated list of expressions
+     *
+     * \param spec
+     *     List of <tt>name:expression</tt> pairs, e.g.
+     *     <tt>"direct:C.L, indirect:C..+L"</tt>
+     */
+    LightPathExpressions(const std::string &spec);
+
+    /// Return the number of expressions
+    size_t size() const { return m_names.size(); }
+
+    /// Return the names of the expressions
+    const std::vector<std::string> &names() const { return m_names; }
+
+    /**
+     * \brief Resolve the light groups of the expressions
+     *
+     * \param emitters
+     *     Emitters of the scene (in the order of \ref Scene::emitters())
+     */
+    void set_emitters(const std::vector<ref<Emitter>> &emitters);
+
+    /// Return the packed state of paths that only consist of the sensor vertex
+    UInt32 initial_state() const { return 0u; }
+
+    /// Advance the packed state by the event of a sampled BSDF lobe
+    UInt32 advance(const UInt32 &state, const UInt32 &sampled_type,
+                   Mask active = true) const;
+
+    /// Advance the packed state by the given event
+    UInt32 advance(const UInt32 &state, Event event, Mask active = true) const;
+
+    /**
+     * \brief Return a bit mask of the expressions that accept a path with the
+     * given state once it reaches \c emitter
+     */
+    UInt32 accept(const UInt32 &state, const EmitterPtr &emitter,
+                  Mask active = true) const;
+
+    /// Return the BSDF lobes that produce the given event
+    static uint32_t event_flags(Event event);
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~LightPathExpressions();
+
+    UInt32 advance_symbol(const UInt32 &state, const UInt32 &symbol,
+                          Mask active) const;
+
+protected:
+    std::vector<std::string> m_names;
+    std::vector<std::string> m_expressions;
+
+    /// Light group of every expression (empty: all emitters)
+    std::vector<std::string> m_groups;
+
+    /// Per expression: number of DFA states, bit offset and mask, and table offset
+    std::vector<uint32_t> m_state_count;
+    std::vector<uint32_t> m_state_offset;
+    std::vector<uint32_t> m_state_mask;
+    std::vector<uint32_t> m_table_offset;
+    uint32_t m_state_bits = 0;
+
+    /// Transitions (state x event) and accepting states of all automata
+    UInt32Storage m_transitions;
+    UInt32Storage m_accepting;
+
+    /// Maps emitters (scalar variants) or their JIT registry identifiers to expression masks
+    std::unordered_map<const Emitter *, uint32_t> m_light_map;
+    UInt32Storage m_registry_map;
+};
+
+MI_EXTERN_CLASS(LightPathExpressions)
+NAMESPACE_END(mitsuba)
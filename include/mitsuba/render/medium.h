@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mitsuba/core/bbox.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/traits.h>
@@ -11,7 +12,9 @@ NAMESPACE_BEGIN(mitsuba)
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Medium : public Object {
 public:
-    MI_IMPORT_TYPES(PhaseFunction, Sampler, Scene, Texture);
+    MI_IMPORT_TYPES(Emitter, PhaseFunction, Sampler, Scene, Texture);
+    using FloatStorage = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
 
     /// Intersects a ray with the medium's bounding box
     virtual std::tuple<Mask, Float, Float>
@@ -29,6 +32,18 @@ public:
     get_scattering_coefficients(const MediumInteraction3f &mi,
                                 Mask active = true) const = 0;
 
+    /**
+     * \brief Returns the single-scattering albedo evaluated at a given
+     * MediumInteraction mi
+     *
+     * The default implementation divides the scattering coefficient by the
+     * extinction. Media that store the albedo should evaluate it directly,
+     * since it is all that collisions with the control component of
+     * \ref sample_interaction_decomposition() need to look up.
+     */
+    virtual UnpolarizedSpectrum get_albedo(const MediumInteraction3f &mi,
+                                           Mask active = true) const;
+
     /**
      * \brief Sample a free-flight distance in the medium.
      *
@@ -43,6 +58,11 @@ public:
      * free-flight distance. This argument is only used when rendering in RGB
      * modes.
      *
+     * If the medium provides a grid of local majorants (see
+     * \ref m_majorant_grid), the distance is sampled by traversing the grid,
+     * and the returned interaction stores the local majorant of the cell
+     * containing it.
+     *
      * \return         This method returns a MediumInteraction.
      *                 The MediumInteraction will always be valid,
      *                 except if the ray missed the Medium's bounding box.
@@ -50,6 +70,68 @@ public:
     MediumInteraction3f sample_interaction(const Ray3f &ray, Float sample,
                                            UInt32 channel, Mask active) const;
 
+    /**
+     * \brief Sample a tentative collision for residual ratio tracking
+     *
+     * Residual ratio tracking splits the extinction into a piecewise
+     * constant control component, whose transmittance is evaluated
+     * analytically, and a residual component, which is estimated by ratio
+     * tracking against a residual majorant. Media with a grid of local
+     * majorants use the per-cell lower bounds (see \ref m_control_grid) as
+     * control, homogeneous media use their extinction (which requires no
+     * collisions at all), and all other media fall back to plain ratio
+     * tracking.
+     *
+     * The returned interaction stores the residual majorant in
+     * \c combined_extinction, and its \c sigma_n field holds the residual
+     * null extinction, so that the transmittance weight of a collision is
+     * given by <tt>sigma_n / combined_extinction</tt>.
+     *
+     * \return A tuple of (MediumInteraction, control extinction at the
+     * collision, control optical depth up to the collision or to the end of
+     * the ray). The caller must multiply the transmittance by
+     * <tt>exp(-control optical depth)</tt>.
+     */
+    std::tuple<MediumInteraction3f, UnpolarizedSpectrum, UnpolarizedSpectrum>
+    sample_interaction_residual(const Ray3f &ray, Float sample,
+                                Mask active) const;
+
+    /**
+     * \brief Sample a collision for decomposition tracking
+     *
+     * Decomposition tracking splits the extinction into a piecewise constant
+     * control component and a residual component. The free-flight distance
+     * is sampled according to the (per-channel, if available) majorant of
+     * the given channel, and <tt>sample.y()</tt> then selects which of the
+     * two components the collision belongs to. Collisions with the control
+     * component are always real and only evaluate the albedo (see
+     * \ref get_albedo()), while the others are real or null collisions of
+     * the residual component. Media with a grid of local majorants use the
+     * per-cell lower bounds as control, homogeneous media use their
+     * extinction, and all other media have no control component.
+     *
+     * The returned interaction holds the coefficients of the component that
+     * produced the collision: \c sigma_t and \c sigma_s are those of the
+     * control or residual component, \c sigma_n is the null extinction, and
+     * \c combined_extinction is the majorant. The probability of a real or
+     * null collision in any channel is thus given by the ratio of
+     * \c sigma_t or \c sigma_n to \c combined_extinction, as in
+     * \ref sample_interaction().
+     *
+     * Unlike \ref sample_interaction(), the majorant may vary along the ray
+     * and between channels. The interval <tt>[0, ray.maxt]</tt> should thus
+     * end at the next surface, so that the returned optical depth yields the
+     * free-flight transmittance.
+     *
+     * \return A tuple of (MediumInteraction, optical depth of the majorant
+     * of every channel up to the collision or to the end of the ray, mask of
+     * collisions with the control component). The corresponding free-flight
+     * transmittance is <tt>exp(-optical depth)</tt>.
+     */
+    std::tuple<MediumInteraction3f, UnpolarizedSpectrum, Mask>
+    sample_interaction_decomposition(const Ray3f &ray, const Point2f &sample,
+                                     UInt32 channel, Mask active) const;
+
     /**
      * \brief Compute the transmittance and PDF
      *
@@ -74,12 +156,24 @@ public:
         return m_phase_function.get();
     }
 
+    /// Return the emitter filling this medium (if any)
+    MI_INLINE const Emitter *emitter() const { return m_emitter.get(); }
+
+    /// Return the emitter filling this medium (if any)
+    MI_INLINE Emitter *emitter() { return m_emitter.get(); }
+
+    /// Is this medium emissive?
+    MI_INLINE bool is_emitter() const { return (bool) m_emitter; }
+
     /// Returns whether this specific medium instance uses emitter sampling
     MI_INLINE bool use_emitter_sampling() const { return m_sample_emitters; }
 
     /// Returns whether this medium is homogeneous
     MI_INLINE bool is_homogeneous() const { return m_is_homogeneous; }
 
+    /// Returns whether this medium provides a grid of local majorants
+    MI_INLINE bool has_majorant_grid() const { return m_majorant_resolution.x() > 0; }
+
     /// Returns whether this medium has a spectrally varying extinction
     MI_INLINE bool has_spectral_extinction() const {
         return m_has_spectral_extinction;
@@ -104,10 +198,94 @@ protected:
     Medium(const Properties &props);
     virtual ~Medium();
 
+    /// Look up the local majorant at \c p (\ref m_majorant_bound outside of the grid)
+    Float eval_majorant_grid(const Point3f &p, Mask active) const;
+
+    /**
+     * \brief Prepare the empty-space skipping of \ref sample_majorant_grid()
+     *
+     * Media should call this function whenever they fill in
+     * \ref m_majorant_grid. It computes \ref m_majorant_occupied and
+     * \ref m_majorant_skip from the (channel-uniform) majorants of the given
+     * grid resolution.
+     */
+    void update_empty_space(const ScalarVector3i &cells,
+                            const ScalarFloat *majorants);
+
+    /// Tracking techniques supported by \ref sample_majorant_grid()
+    enum class MajorantGridMode {
+        /// Sample according to the majorants
+        Delta,
+
+        /**
+         * Subtract the lower bounds of \ref m_control_grid from the majorants
+         * and accumulate their optical depth
+         */
+        Residual,
+
+        /**
+         * Sample according to the per-channel majorants of the given channel
+         * (if available) and accumulate the optical depth of all channels
+         */
+        Decomposition
+    };
+
+    /**
+     * \brief Sample a free-flight distance within <tt>[mint, maxt]</tt> by
+     * traversing the majorant grid using a 3D DDA
+     *
+     * \return The sampled distance (infinite if the sample lies beyond
+     * \c maxt), the majorant and the control extinction at that distance,
+     * and the optical depth up to it. The latter is the control optical
+     * depth for \ref MajorantGridMode::Residual, the majorant optical depth
+     * for \ref MajorantGridMode::Decomposition, and zero otherwise.
+     */
+    std::tuple<Float, UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
+    sample_majorant_grid(const Ray3f &ray, Float mint, Float maxt,
+                         Float sample, UInt32 channel, MajorantGridMode mode,
+                         Mask active) const;
+
 protected:
     ref<PhaseFunction> m_phase_function;
+    /// Nested emitter with the \ref EmitterFlags::Medium flag (optional)
+    ref<Emitter> m_emitter;
     bool m_sample_emitters, m_is_homogeneous, m_has_spectral_extinction;
 
+    /**
+     * \brief Coarse grid of local majorants (optional)
+     *
+     * Media with spatially varying extinction may fill in a grid of cells
+     * that bound the extinction (in all channels) over their extent, which
+     * avoids most null collisions in sparse regions. The grid is stored in
+     * z-major order. Outside of the grid, \ref m_majorant_bound is used.
+     */
+    FloatStorage m_majorant_grid;
+    /// Per-cell lower bounds of the extinction (optional, for residual tracking)
+    FloatStorage m_control_grid;
+    /**
+     * \brief Per-channel variants of \ref m_majorant_grid and
+     * \ref m_control_grid (optional, RGB modes only)
+     *
+     * Each cell stores one value per channel, which lets decomposition
+     * tracking sample distances according to a tight majorant of a single
+     * channel of a chromatic medium.
+     */
+    FloatStorage m_majorant_grid_rgb, m_control_grid_rgb;
+    ScalarVector3i m_majorant_resolution = 0;
+    /// Transformation from world space to grid coordinates in <tt>[0, res]^3</tt>
+    ScalarTransform4f m_majorant_to_grid;
+    ScalarFloat m_majorant_bound = 0.f;
+    /// Bounds (in grid coordinates) of the cells with a nonzero majorant
+    ScalarBoundingBox3f m_majorant_occupied;
+    /**
+     * \brief Chebyshev distance (in cells, capped) from every cell to the
+     * nearest cell with a nonzero majorant
+     *
+     * The grid traversal jumps across all cells within a distance of
+     * <tt>skip - 1</tt> at once, as they are known to be empty.
+     */
+    UInt32Storage m_majorant_skip;
+
     /// Identifier (if available)
     std::string m_id;
 };
@@ -121,14 +299,18 @@ NAMESPACE_END(mitsuba)
 
 DRJIT_VCALL_TEMPLATE_BEGIN(mitsuba::Medium)
     DRJIT_VCALL_GETTER(phase_function, const typename Class::PhaseFunction*)
+    DRJIT_VCALL_GETTER(emitter, const typename Class::Emitter*)
     DRJIT_VCALL_GETTER(use_emitter_sampling, bool)
     DRJIT_VCALL_GETTER(is_homogeneous, bool)
     DRJIT_VCALL_GETTER(has_spectral_extinction, bool)
     DRJIT_VCALL_METHOD(get_majorant)
     DRJIT_VCALL_METHOD(intersect_aabb)
     DRJIT_VCALL_METHOD(sample_interaction)
+    DRJIT_VCALL_METHOD(sample_interaction_residual)
+    DRJIT_VCALL_METHOD(sample_interaction_decomposition)
     DRJIT_VCALL_METHOD(eval_tr_and_pdf)
     DRJIT_VCALL_METHOD(get_scattering_coefficients)
+    DRJIT_VCALL_METHOD(get_albedo)
 DRJIT_VCALL_TEMPLATE_END(mitsuba::Medium)
 
 //! @}
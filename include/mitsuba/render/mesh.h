@@ -3,16 +3,43 @@
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/srgb.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/properties.h>
 #include <unordered_map>
 #include <mutex>
+#include <optional>
 #include <drjit/dynamic.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+/// File header of the mesh bundles written by \ref Mesh::write_bundle()
+struct MeshBundleHeader {
+    char magic[8];       ///< "MIBUNDLE"
+    uint32_t version;    ///< \ref mesh_bundle_version
+    uint32_t mesh_count; ///< Number of \ref MeshBundleEntry records that follow
+};
+
+/// Table of contents entry of a mesh bundle (buffer offsets are in bytes)
+struct MeshBundleEntry {
+    char name[64];
+    uint64_t vertex_count;
+    uint64_t face_count;
+    uint32_t flags; ///< 1: vertex normals, 2: texture coordinates, 4: face normals
+    uint32_t padding;
+    float bbox_min[3];
+    float bbox_max[3];
+    uint64_t positions, normals, texcoords, faces; ///< 0: buffer is absent
+};
+
+constexpr uint32_t mesh_bundle_version = 1;
+/// Alignment of all buffers within a mesh bundle
+constexpr uint64_t mesh_bundle_alignment = 4096;
+NAMESPACE_END(detail)
+
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Mesh : public Shape<Float, Spectrum> {
 public:
@@ -37,6 +64,20 @@ public:
          ScalarSize face_count, const Properties &props = Properties(),
          bool has_vertex_normals = false, bool has_vertex_texcoords = false);
 
+    /**
+     * \brief Create a new mesh that references existing vertex and face buffers
+     *
+     * The buffers are adopted by reference instead of being copied, which
+     * makes it possible to wrap memory that is owned by another framework
+     * (e.g. via \c dr::map()) without any copies. The vertex normal and
+     * texture coordinate buffers may be empty.
+     */
+    Mesh(const std::string &name, const FloatStorage &vertex_positions,
+         const DynamicBuffer<UInt32> &faces,
+         const FloatStorage &vertex_normals = FloatStorage(),
+         const FloatStorage &vertex_texcoords = FloatStorage(),
+         const Properties &props = Properties());
+
     /// Must be called at the end of the constructor of Mesh plugins
     void initialize() override;
 
@@ -64,6 +105,11 @@ public:
     /// Const variant of \ref vertex_texcoords_buffer.
     const FloatStorage& vertex_texcoords_buffer() const { return m_vertex_texcoords; }
 
+    /// Return vertex tangents buffer (see \ref recompute_vertex_tangents())
+    FloatStorage& vertex_tangents_buffer() { return m_vertex_tangents; }
+    /// Const variant of \ref vertex_tangents_buffer.
+    const FloatStorage& vertex_tangents_buffer() const { return m_vertex_tangents; }
+
     /// Return face indices buffer
     DynamicBuffer<UInt32>& faces_buffer() { return m_faces; }
     /// Const variant of \ref faces_buffer.
@@ -102,6 +148,9 @@ public:
     MI_INLINE auto vertex_normal(Index index,
                                  dr::mask_t<Index> active = true) const {
         using Result = Normal<dr::replace_scalar_t<Index, InputFloat>, 3>;
+        if (m_quantized)
+            return decode_octahedral<Result>(dr::gather<dr::uint32_array_t<Index>>(
+                m_vertex_normals_quantized, index, active));
         return dr::gather<Result>(m_vertex_normals, index, active);
     }
 
@@ -110,14 +159,56 @@ public:
     MI_INLINE auto vertex_texcoord(Index index,
                                    dr::mask_t<Index> active = true) const {
         using Result = Point<dr::replace_scalar_t<Index, InputFloat>, 2>;
+        if (m_quantized) {
+            auto value = dr::gather<dr::uint32_array_t<Index>>(
+                m_vertex_texcoords_quantized, index, active);
+            return Result(decode_half(value & 0xffffu), decode_half(value >> 16));
+        }
         return dr::gather<Result>(m_vertex_texcoords, index, active);
     }
 
+    /**
+     * \brief Returns the tangent of the vertex with index \c index
+     *
+     * The first three components store the tangent direction \c dp_du
+     * (orthogonal to the vertex normal), and the last component stores
+     * the signed length of \c dp_dv, whose sign encodes the handedness of
+     * the tangent frame.
+     */
+    template <typename Index>
+    MI_INLINE auto vertex_tangent(Index index,
+                                  dr::mask_t<Index> active = true) const {
+        using Result = dr::Array<dr::replace_scalar_t<Index, InputFloat>, 4>;
+        return dr::gather<Result>(m_vertex_tangents, index, active);
+    }
+
     /// Does this mesh have per-vertex normals?
-    bool has_vertex_normals() const { return dr::width(m_vertex_normals) != 0; }
+    bool has_vertex_normals() const {
+        return dr::width(m_vertex_normals) != 0 ||
+               dr::width(m_vertex_normals_quantized) != 0;
+    }
 
     /// Does this mesh have per-vertex texture coordinates?
-    bool has_vertex_texcoords() const { return dr::width(m_vertex_texcoords) != 0; }
+    bool has_vertex_texcoords() const {
+        return dr::width(m_vertex_texcoords) != 0 ||
+               dr::width(m_vertex_texcoords_quantized) != 0;
+    }
+
+    /// Does this mesh have precomputed per-vertex tangents?
+    bool has_vertex_tangents() const {
+        return dr::width(m_vertex_tangents) != 0;
+    }
+
+    /**
+     * \brief Are vertex normals and texture coordinates stored in quantized
+     * form?
+     *
+     * Quantized meshes store normals as 2x16 bit octahedral coordinates and
+     * texture coordinates as two half-precision values. The float buffers
+     * returned by \ref vertex_normals_buffer() and \ref
+     * vertex_texcoords_buffer() are empty in this case.
+     */
+    bool quantized() const { return m_quantized; }
 
     /// Does this mesh have additional mesh attributes?
     bool has_mesh_attributes() const { return m_mesh_attributes.size() > 0; }
@@ -144,15 +235,98 @@ public:
      */
     void write_ply(Stream *stream) const;
 
+    /**
+     * \brief Write several meshes to a single bundle file, which can be
+     * loaded by the \c bundle shape plugin
+     *
+     * The world-space vertex and face buffers are stored uncompressed, in
+     * native byte order, and aligned to page boundaries, so that the plugin
+     * can read them from a memory mapping without any parsing.
+     *
+     * \param filename
+     *    Target file path on disk
+     *
+     * \param meshes
+     *    Meshes to be stored (mesh attributes are not supported)
+     */
+    static void write_bundle(const std::string &filename,
+                             const std::vector<ref<Mesh>> &meshes);
+
     /// Merge two meshes into one
     ref<Mesh> merge(const Mesh *other) const;
 
+    /**
+     * \brief Merge a list of compatible meshes into one
+     *
+     * All inputs must reference the same BSDF, media, emitter, and sensor and
+     * store the same set of vertex attributes. The merged buffers are
+     * allocated once and filled in parallel, which is much faster than a
+     * sequence of pairwise \ref merge() calls for many small meshes.
+     */
+    static ref<Mesh> merge(const std::vector<ref<Mesh>> &meshes);
+
+    /**
+     * \brief Hash the transformation-invariant contents of the mesh
+     *
+     * The hash covers the face indices, texture coordinates, and attribute
+     * flags, but not the vertex positions and normals. Meshes that only
+     * differ by their \c to_world transformation produce the same hash
+     * (see \ref instance_transform()).
+     */
+    size_t topology_hash() const;
+
+    /**
+     * \brief Check whether \c other is a transformed copy of this mesh
+     *
+     * Returns the transformation mapping this mesh onto \c other, which is
+     * derived from the \c to_world transformations of both meshes, if the
+     * two meshes agree after transformation (up to rounding errors).
+     * Mirroring transformations are rejected.
+     */
+    std::optional<ScalarTransform4f> instance_transform(const Mesh *other) const;
+
     /// Compute smooth vertex normals and replace the current normal values
     void recompute_vertex_normals();
 
+    /**
+     * \brief Build the vertex-to-face adjacency used by \ref
+     * recompute_vertex_normals()
+     *
+     * The table is stored in compressed sparse row format: entries
+     * <tt>[offsets[i], offsets[i+1])</tt> of \c m_vertex_corners list the
+     * face corners (<tt>3 * face + corner</tt>) that reference vertex \c i,
+     * in increasing order. It only depends on the topology and is therefore
+     * reused until the faces change.
+     */
+    void build_vertex_adjacency();
+
+    /**
+     * \brief Precompute per-vertex tangent frames from the texture
+     * coordinates
+     *
+     * The per-face UV parameterization derivatives are accumulated at the
+     * vertices (weighted by face area) and orthogonalized against the vertex
+     * normals, similar to MikkTSpace. Interpolating them yields tangent
+     * frames that vary continuously across faces, which are then used for
+     * \c dp_du and \c dp_dv in \ref compute_surface_interaction().
+     *
+     * This is done automatically in \ref initialize() when the mesh was
+     * created with the \c tangents property set to \c true.
+     */
+    void recompute_vertex_tangents();
+
     /// Recompute the bounding box (e.g. after modifying the vertex positions)
     void recompute_bbox();
 
+    /**
+     * \brief Convert the vertex normals and texture coordinates to the
+     * quantized representation (see \ref quantized())
+     *
+     * This is done automatically at the end of \ref initialize() when the
+     * mesh was created with the \c quantize property set to \c true.
+     */
+    void quantize_attributes();
+
     // =============================================================
     //! @{ \name Shape interface implementation
     // =============================================================
@@ -173,6 +347,14 @@ public:
 
     virtual Float pdf_position(const PositionSample3f &ps, Mask active = true) const override;
 
+    virtual DirectionSample3f sample_direction(const Interaction3f &it,
+                                               const Point2f &sample,
+                                               Mask active = true) const override;
+
+    virtual Float pdf_direction(const Interaction3f &it,
+                                const DirectionSample3f &ds,
+                                Mask active = true) const override;
+
     virtual Point3f
     barycentric_coordinates(const SurfaceInteraction3f &si,
                             Mask active = true) const;
@@ -284,14 +466,39 @@ public:
 #if defined(MI_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device) override;
+
+    /**
+     * \brief Re-share the vertex and index buffers and request an Embree
+     * refit. Returns \c false when the faces changed since the geometry was
+     * created, so that it is rebuilt.
+     */
+    virtual bool embree_update_geometry(RTCGeometry geom) override;
+
+    /// Embree filter function that discards hits in the transparent regions
+    static void embree_cutout_filter(const RTCFilterFunctionNArguments *args);
 #endif
 
 #if defined(MI_ENABLE_CUDA)
     using Base::m_optix_data_ptr;
     virtual void optix_prepare_geometry() override;
     virtual void optix_build_input(OptixBuildInput&) const override;
+
+    /// Return the faces passed to OptiX (see \ref update_cutout())
+    const DynamicBuffer<UInt32> &optix_faces() const;
 #endif
 
+    /**
+     * \brief Update the map of the fully transparent regions of the surface
+     * that ray tracing skips (see \ref BSDF::opacity_texture())
+     *
+     * Embree discards the hits in these regions with a filter function, and
+     * the OptiX geometry replaces the triangles that lie entirely inside of
+     * them by degenerate ones. Called when the geometry is created or
+     * updated, and when the scene parameters change, since the opacity
+     * texture may have changed. Returns \c true when the map changed.
+     */
+    bool update_cutout();
+
     /// @}
     // =========================================================================
 
@@ -333,6 +540,15 @@ protected:
             const_cast<Mesh *>(this)->build_pmf();
     }
 
+    /// Choose a face proportionally to its area and return the reused sample
+    std::pair<UInt32, Float> sample_face(Float sample, Mask active) const;
+
+    /// Fill a position sample for the barycentric coordinates \c b on face \c fi
+    PositionSample3f face_position_sample(const Vector3u &fi, const Point3f &p0,
+                                          const Point3f &p1, const Point3f &p2,
+                                          const Point2f &b, Float time,
+                                          Mask active) const;
+
     /** \brief Moeller and Trumbore algorithm for computing ray-triangle
      * intersection
      *
@@ -440,6 +656,40 @@ protected:
         }
     }
 
+protected:
+    /// Decode a unit vector stored as two 16 bit octahedral coordinates
+    template <typename Result, typename UInt32_>
+    static MI_INLINE Result decode_octahedral(const UInt32_ &value) {
+        using Value = dr::value_t<Result>;
+        Value x = Value(value & 0xffffu) * (2.f / 65535.f) - 1.f,
+              y = Value(value >> 16) * (2.f / 65535.f) - 1.f,
+              z = 1.f - dr::abs(x) - dr::abs(y),
+              t = dr::maximum(-z, 0.f);
+        x -= dr::copysign(t, x);
+        y -= dr::copysign(t, y);
+        return dr::normalize(Result(x, y, z));
+    }
+
+    /// Decode an IEEE half-precision value stored in the low 16 bits
+    template <typename UInt32_>
+    static MI_INLINE auto decode_half(const UInt32_ &value) {
+        using Value = dr::float32_array_t<UInt32_>;
+        // Shift exponent and mantissa, then rebias via a multiplication
+        Value result = dr::reinterpret_array<Value>((value & 0x7fffu) << 13) *
+                       Value(5.192296858534828e33f /* 2^112 */);
+        return dr::reinterpret_array<Value>(
+            dr::reinterpret_array<UInt32_>(result) | ((value & 0x8000u) << 16));
+    }
+
+    /// Return the vertex normals as a float buffer, decoding them if necessary
+    FloatStorage decoded_vertex_normals() const;
+
+    /// Return the texture coordinates as a float buffer, decoding them if necessary
+    FloatStorage decoded_vertex_texcoords() const;
+
+    /// Register the size of the vertex, face and attribute buffers with the \ref MemoryTracker
+    void update_memory();
+
 protected:
     std::string m_name;
     ScalarBoundingBox3f m_bbox;
@@ -451,8 +701,15 @@ protected:
     mutable FloatStorage m_vertex_normals;
     mutable FloatStorage m_vertex_texcoords;
 
+    /// Precomputed tangent frames (see \ref recompute_vertex_tangents())
+    mutable FloatStorage m_vertex_tangents;
+
     mutable DynamicBuffer<UInt32> m_faces;
 
+    /// Quantized vertex normals and texture coordinates (see \ref quantized())
+    mutable DynamicBuffer<UInt32> m_vertex_normals_quantized;
+    mutable DynamicBuffer<UInt32> m_vertex_texcoords_quantized;
+
 #if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
     /* Data pointer to ensure triangle intersection routine doesn't rely on
        drjit-core when called from an LLVM kernel */
@@ -464,22 +721,59 @@ protected:
 
 #if defined(MI_ENABLE_CUDA)
     mutable void* m_vertex_buffer_ptr = nullptr;
+    /// Faces passed to OptiX, without the fully transparent triangles
+    mutable DynamicBuffer<UInt32> m_optix_faces;
 #endif
 
     /// Flag that can be set by the user to disable loading/computation of vertex normals
     bool m_face_normals = false;
     bool m_flip_normals = false;
 
+    /// Quantize normals and texture coordinates in \ref initialize()?
+    bool m_quantize = false;
+    bool m_quantized = false;
+    /// Were the faces updated since the Embree geometry was created?
+    bool m_faces_changed = false;
+
+    /// Precompute per-vertex tangents in \ref initialize()?
+    bool m_tangents = false;
+
+    /// Cells of the UV square where the BSDF is fully transparent
+    std::vector<bool> m_cutout;
+    ScalarVector2i m_cutout_resolution;
+
+#if defined(MI_ENABLE_EMBREE)
+    /// Host pointers to the buffers read by \ref embree_cutout_filter()
+    const ScalarIndex *m_cutout_faces = nullptr;
+    const void *m_cutout_texcoords = nullptr;
+#endif
+
     /* Surface area distribution -- generated on demand when \ref
        prepare_area_pmf() is first called. */
     DiscreteDistribution<Float> m_area_pmf;
+
+    /// Strategy used by \ref sample_direction()
+    enum class DirectionSampling : uint32_t {
+        Area, SolidAngle, ProjectedSolidAngle
+    };
+    DirectionSampling m_direction_sampling = DirectionSampling::Area;
+
+    /// Alias table built alongside \ref m_area_pmf when \c m_alias_sampling is set
+    AliasDistribution<Float> m_area_alias;
+    bool m_alias_sampling = false;
     std::mutex m_mutex;
 
     /// Optional: used in eval_parameterization()
     ref<Scene<Float, Spectrum>> m_parameterization;
 
+    /// Vertex-to-face adjacency (see \ref build_vertex_adjacency())
+    DynamicBuffer<UInt32> m_vertex_corner_offsets;
+    DynamicBuffer<UInt32> m_vertex_corners;
+
     /// Pointer to the scene that owns this mesh
     Scene<Float, Spectrum>* m_scene = nullptr;
+
+    MemoryRecord m_memory { MemoryCategory::Mesh };
 };
 
 MI_EXTERN_CLASS(Mesh)
@@ -567,4 +567,62 @@ Float eval_transmittance(const MicrofaceDistributionP &distr,
     return result;
 }
 
+/**
+ * \brief Compute the directional albedo of a microfacet reflection model with
+ * a perfectly reflecting Fresnel term (F = 1)
+ *
+ * The values are integrated using Gauss-Legendre quadrature over visible
+ * normals. They are used to compensate for the energy that single-scattering
+ * microfacet models lose at high roughness, following "Revisiting Physically
+ * Based Shading at Imageworks" by Christopher Kulla and Alejandro Conty.
+ */
+template <typename Float, typename MicrofaceDistributionP>
+Float eval_albedo(const MicrofaceDistributionP &distr,
+                  const Vector<Float, 3> &wi) {
+    MI_IMPORT_CORE_TYPES()
+
+    if (!distr.sample_visible())
+        Throw("eval_albedo(): requires visible normal sampling!");
+
+    using FloatX = dr::DynamicArray<dr::scalar_t<Float>>;
+    auto [nodes, weights] = quad::gauss_legendre<FloatX>(32);
+    Float result = dr::zeros<Float>(dr::width(wi));
+
+    auto [nodes_x, nodes_y]     = dr::meshgrid(nodes, nodes);
+    auto [weights_x, weights_y] = dr::meshgrid(weights, weights);
+
+    using FloatP = dr::Packet<dr::scalar_t<Float>>;
+    using Normal3fP = Normal<FloatP, 3>;
+    using Vector3fP = Vector<FloatP, 3>;
+
+    size_t packet_count = dr::width(wi) / FloatP::Size;
+
+    Assert(dr::width(wi) % FloatP::Size == 0);
+
+    for (size_t i = 0; i < packet_count; ++i) {
+        Vector3fP wi_p;
+        wi_p.x() = dr::load<FloatP>(wi.x().data() + i * FloatP::Size);
+        wi_p.y() = dr::load<FloatP>(wi.y().data() + i * FloatP::Size);
+        wi_p.z() = dr::load<FloatP>(wi.z().data() + i * FloatP::Size);
+
+        FloatP result_p = 0.f;
+
+        for (size_t j = 0; j < dr::width(nodes_x); ++j) {
+            ScalarVector2f node = { nodes_x[j], nodes_y[j] };
+            ScalarVector2f weight = { weights_x[j], weights_y[j] };
+            node = dr::fmadd(node, 0.5f, 0.5f);
+
+            Normal3fP m = std::get<0>(distr.sample(wi_p, node));
+            Vector3fP wo = reflect(wi_p, m);
+            FloatP smith = distr.smith_g1(wo, m);
+            dr::masked(smith, wo.z() <= 0.f || wi_p.z() <= 0.f) = 0.f;
+            result_p += smith * dr::prod(weight) * 0.25f;
+        }
+
+        dr::store(result.data() + i * FloatP::Size, result_p);
+    }
+
+    return result;
+}
+
 NAMESPACE_END(mitsuba)
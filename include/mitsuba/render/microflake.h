@@ -127,4 +127,130 @@ MI_INLINE Float sggx_projected_area(const Vector<Float, 3> &wi,
     return dr::safe_sqrt(sigma2);
 }
 
+/**
+ * \brief Precompute the sampling frame of an SGGX microflake distribution
+ *
+ * The matrix \f$S\f$ is factorized as \f$S = L L^T\f$ using a Cholesky
+ * decomposition, whose inverse transpose maps the unit sphere onto the SGGX
+ * ellipsoid. The
+ * functions \ref sggx_ndf_pdf_factorized(), \ref sggx_projected_area_factorized()
+ * and \ref sggx_sample_vndf_factorized() then only require a few
+ * matrix-vector products instead of rebuilding and projecting \f$S\f$.
+ *
+ * To handle degenerate (e.g. zero or planar) distributions, a small multiple
+ * of the identity is added to \f$S\f$ first.
+ *
+ * \param s
+ *      The parameters of the SGGX phase function stored as a 6D vector
+ *      [S_xx, S_yy, S_zz, S_xy, S_xz, S_yz].
+ *
+ * \return The lower triangular factor \f$L\f$ and its inverse, stored as a
+ *      12D vector [L_xx, L_yy, L_zz, L_yx, L_zx, L_zy] followed by the same
+ *      entries of \f$L^{-1}\f$.
+ */
+template <typename Float>
+dr::Array<Float, 12> sggx_factorize(const dr::Array<Float, 6> &s) {
+    const size_t XX = 0, YY = 1, ZZ = 2, XY = 3, XZ = 4, YZ = 5;
+
+    Float eps = dr::maximum((s[XX] + s[YY] + s[ZZ]) * 1e-4f, 1e-7f);
+
+    Float l_xx = dr::safe_sqrt(s[XX] + eps),
+          l_yx = s[XY] / l_xx,
+          l_zx = s[XZ] / l_xx,
+          l_yy = dr::safe_sqrt(s[YY] + eps - dr::sqr(l_yx)),
+          l_zy = (s[YZ] - l_zx * l_yx) / l_yy,
+          l_zz = dr::safe_sqrt(s[ZZ] + eps - dr::sqr(l_zx) - dr::sqr(l_zy));
+
+    Float m_xx = dr::rcp(l_xx), m_yy = dr::rcp(l_yy), m_zz = dr::rcp(l_zz),
+          m_yx = -l_yx * m_xx * m_yy,
+          m_zy = -l_zy * m_yy * m_zz,
+          m_zx = (l_yx * l_zy - l_yy * l_zx) * m_xx * m_yy * m_zz;
+
+    return { l_xx, l_yy, l_zz, l_yx, l_zx, l_zy,
+             m_xx, m_yy, m_zz, m_yx, m_zx, m_zy };
+}
+
+/**
+ * \brief Evaluates the probability of sampling a given normal using the
+ * SGGX microflake distribution with a precomputed frame
+ *
+ * \param wm
+ *      The microflake normal
+ *
+ * \param f
+ *      The sampling frame computed by \ref sggx_factorize()
+ *
+ * \return The probability of sampling a certain normal
+ */
+template <typename Float>
+Float sggx_ndf_pdf_factorized(const Vector<Float, 3> &wm,
+                              const dr::Array<Float, 12> &f) {
+    // wm^T S^-1 wm = |L^-1 wm|^2, and det(S)^-1/2 = det(L^-1)
+    Vector<Float, 3> v(f[6] * wm.x(),
+                       f[9] * wm.x() + f[7] * wm.y(),
+                       f[10] * wm.x() + f[11] * wm.y() + f[8] * wm.z());
+    return f[6] * f[7] * f[8] / (dr::Pi<Float> * dr::sqr(dr::squared_norm(v)));
+}
+
+/**
+ * \brief Evaluates the projected area of the SGGX microflake distribution
+ * with a precomputed frame
+ *
+ * \param wi
+ *      A 3D direction
+ *
+ * \param f
+ *      The sampling frame computed by \ref sggx_factorize()
+ *
+ * \return The projected area of the SGGX microflake distribution
+ */
+template <typename Float>
+MI_INLINE Float sggx_projected_area_factorized(const Vector<Float, 3> &wi,
+                                               const dr::Array<Float, 12> &f) {
+    // sqrt(wi^T * S * wi) = |L^T wi|
+    Vector<Float, 3> v(f[0] * wi.x() + f[3] * wi.y() + f[4] * wi.z(),
+                       f[1] * wi.y() + f[5] * wi.z(),
+                       f[2] * wi.z());
+    return dr::norm(v);
+}
+
+/**
+ * \brief Samples the visible normal distribution of the SGGX microflake
+ * distribution with a precomputed frame
+ *
+ * The ellipsoid is the image of the unit sphere under \f$L^{-T}\f$. Its
+ * visible normals are sampled by drawing a cosine-distributed normal of the
+ * sphere around \f$L^T \omega_i\f$ and transforming it by \f$L\f$.
+ *
+ * \param wi
+ *      The incident direction
+ *
+ * \param sample
+ *      A uniformly distributed 2D sample
+ *
+ * \param f
+ *      The sampling frame computed by \ref sggx_factorize()
+ *
+ * \return A normal (in world space) sampled from the distribution
+ *         of visible normals
+ */
+template <typename Float>
+Normal<Float, 3> sggx_sample_vndf_factorized(const Vector<Float, 3> &wi,
+                                             const Point<Float, 2> &sample,
+                                             const dr::Array<Float, 12> &f) {
+    using Vector3f = Vector<Float, 3>;
+
+    Vector3f wi_sphere = dr::normalize(
+        Vector3f(f[0] * wi.x() + f[3] * wi.y() + f[4] * wi.z(),
+                 f[1] * wi.y() + f[5] * wi.z(),
+                 f[2] * wi.z()));
+    Vector3f p = Frame<Float>(wi_sphere).to_world(
+        warp::square_to_cosine_hemisphere(sample));
+
+    return dr::normalize(
+        Vector3f(f[0] * p.x(),
+                 f[3] * p.x() + f[1] * p.y(),
+                 f[4] * p.x() + f[5] * p.y() + f[2] * p.z()));
+}
+
 NAMESPACE_END(mitsuba)
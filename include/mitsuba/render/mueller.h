@@ -40,6 +40,25 @@ MuellerMatrix<Float> depolarizer(Float value = 1.f) {
     return result;
 }
 
+/**
+* \brief Checks whether a Mueller matrix is an ideal depolarizer, i.e. whether
+* only its (0, 0) element is nonzero
+*
+* The elements must be (unpolarized) spectra, and the test is performed for
+* all of their wavelengths at once.
+*/
+template <typename Spectrum>
+dr::mask_t<dr::value_t<Spectrum>> is_depolarizer(const MuellerMatrix<Spectrum> &M) {
+    dr::mask_t<dr::value_t<Spectrum>> result = true;
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            if (i != 0 || j != 0)
+                result &= dr::all(dr::eq(M(i, j), 0.f));
+        }
+    }
+    return result;
+}
+
 /**
 * \brief Constructs the Mueller matrix of an ideal absorber
 *
@@ -0,0 +1,159 @@
+#pragma once
+
+#if defined(MI_ENABLE_OIDN)
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/render/fwd.h>
+#include <drjit/tensor.h>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Wrapper for the Intel Open Image Denoise (OIDN) CPU denoiser
+ *
+ * This class provides the same interface as \ref OptixDenoiser for machines
+ * without an NVIDIA GPU. It can be used with scalar and LLVM variants. The
+ * denoiser runs on all threads of Mitsuba's thread pool (see
+ * \ref Thread::thread_count()).
+ *
+ * Inputs are passed to OIDN without copies whenever possible: the pixel
+ * data of \ref TensorXf and single-precision \ref Bitmap inputs (including
+ * individual layers of \ref MultiChannel bitmaps) is referenced in place. A
+ * temporary copy is only made of normals that must be transformed, and of
+ * layers that are not stored in single precision.
+ *
+ * Like OptiX, OIDN works best on noisy renderings that were produced with the
+ * `box` \ref ReconstructionFilter. Unlike OptiX, OIDN does not denoise the
+ * alpha channel, which is copied from the noisy input, and does not provide
+ * a temporal mode.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB OIDNDenoiser : public Object {
+public:
+    MI_IMPORT_TYPES()
+
+    /**
+     * \brief Constructs an OIDN denoiser
+     *
+     * \param input_size
+     *      Resolution of noisy images that will be fed to the denoiser.
+     *
+     * \param albedo
+     *      Whether or not albedo information will also be given to the
+     *      denoiser.
+     *
+     * \param normals
+     *      Whether or not shading normals information will also be given to the
+     *      Denoiser.
+     */
+    OIDNDenoiser(const ScalarVector2u &input_size, bool albedo, bool normals);
+
+    OIDNDenoiser(const OIDNDenoiser &other) = delete;
+
+    OIDNDenoiser& operator=(const OIDNDenoiser &other) = delete;
+
+    ~OIDNDenoiser();
+
+    /**
+     * \brief Apply denoiser on inputs which are \ref TensorXf objects.
+     *
+     * \param noisy
+     *      The noisy input. (tensor shape: (width, height, 3 | 4))
+     *
+     * \param albedo
+     *      Albedo information of the noisy rendering.
+     *      This parameter is optional unless the OIDNDenoiser was built with
+     *      albedo support. (tensor shape: (width, height, 3))
+     *
+     * \param normals
+     *      Shading normal information of the noisy rendering.
+     *      This parameter is optional unless the OIDNDenoiser was built with
+     *      normals support. (tensor shape: (width, height, 3))
+     *
+     * \param to_sensor
+     *      A \ref Transform4f which is applied to the \c normals parameter
+     *      before denoising. OIDN accepts normals in any coordinate frame, so
+     *      this is only needed for consistency between frames.
+     *      This parameter is optional, by default no transformation is
+     *      applied.
+     *
+     * \return The denoised input.
+     */
+    TensorXf operator()(const TensorXf &noisy,
+                        const TensorXf &albedo = TensorXf(),
+                        const TensorXf &normals = TensorXf(),
+                        const Transform4f &to_sensor = Transform4f()) const;
+
+    /**
+     * \brief Apply denoiser on inputs which are \ref Bitmap objects.
+     *
+     * \param noisy
+     *      The noisy input. When passing additional information like albedo or
+     *      normals to the denoiser, this \ref Bitmap object must be a \ref
+     *      MultiChannel bitmap.
+     *
+     * \param albedo_ch
+     *      The name of the channel in the \c noisy parameter which contains
+     *      the albedo information of the noisy rendering.
+     *      This parameter is optional unless the OIDNDenoiser was built with
+     *      albedo support.
+     *
+     * \param normals_ch
+     *      The name of the channel in the \c noisy parameter which contains
+     *      the shading normal information of the noisy rendering.
+     *      This parameter is optional unless the OIDNDenoiser was built with
+     *      normals support.
+     *
+     * \param to_sensor
+     *      A \ref Transform4f which is applied to the \c normals parameter
+     *      before denoising.
+     *      This parameter is optional, by default no transformation is
+     *      applied.
+     *
+     * \param noisy_ch
+     *      The name of the channel in the \c noisy parameter which contains
+     *      the noisy rendering.
+     *
+     * \return The denoised input.
+     */
+    ref<Bitmap> operator()(const ref<Bitmap> &noisy,
+                           const std::string &albedo_ch = "",
+                           const std::string &normals_ch = "",
+                           const Transform4f &to_sensor = Transform4f(),
+                           const std::string &noisy_ch = "<root>") const;
+
+    virtual std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+private:
+    /// View of an image layer in host memory
+    struct Image {
+        const float *data = nullptr;
+        size_t pixel_stride = 0; // in floats
+        uint32_t channels = 0;
+    };
+
+    /// Denoise \c noisy into \c output (which has the same layout)
+    void denoise(const Image &noisy, const Image &albedo, const Image &normals,
+                 const Transform4f &to_sensor, float *output) const;
+
+    /// Helper function to validate tensor sizes
+    void validate_input(const TensorXf &noisy,
+                        const TensorXf &albedo,
+                        const TensorXf &normals) const;
+
+    ScalarVector2u m_input_size;
+    bool m_albedo;
+    bool m_normals;
+    /// Opaque OIDN device and filter handles (guarded by \c m_mutex)
+    void *m_device;
+    void *m_filter;
+    mutable std::mutex m_mutex;
+};
+
+MI_EXTERN_CLASS(OIDNDenoiser)
+NAMESPACE_END(mitsuba)
+
+#endif // defined(MI_ENABLE_OIDN)
@@ -79,7 +79,14 @@ struct OptixAccelData {
     struct HandleData {
         OptixTraversableHandle handle = 0ull;
         void* buffer = nullptr;
+        size_t size = 0;
         uint32_t count = 0u;
+        /// Was the structure built so that it can be updated in place?
+        bool allow_update = false;
+        /// Temporary memory needed by an update
+        size_t update_size = 0;
+        /// Primitive count of every build input at the time of the last build
+        std::vector<uint32_t> primitive_counts;
     };
     HandleData meshes;
     HandleData bspline_curves;
@@ -94,6 +101,130 @@ struct OptixAccelData {
     }
 };
 
+/**
+ * \brief Build an OptiX acceleration structure and compact it
+ *
+ * When \c allow_update is \c true, the structure is built such that it can
+ * later be refit in place: if the structure previously stored in \c handle
+ * was built this way from inputs with the same primitive counts (i.e. only
+ * the vertex positions, bounds or instance transformations changed), it is
+ * updated with \c OPTIX_BUILD_OPERATION_UPDATE instead of being rebuilt.
+ * The caller is responsible for setting \c handle.count.
+ */
+inline void build_accel(const OptixDeviceContext &context,
+                        const std::vector<OptixBuildInput> &build_inputs,
+                        const std::vector<uint32_t> &primitive_counts,
+                        bool allow_update,
+                        OptixAccelData::HandleData &handle) {
+    OptixAccelBuildOptions accel_options = {};
+    accel_options.buildFlags = OPTIX_BUILD_FLAG_ALLOW_COMPACTION |
+                               OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+    if (allow_update)
+        accel_options.buildFlags |= OPTIX_BUILD_FLAG_ALLOW_UPDATE;
+    accel_options.motionOptions.numKeys = 0;
+
+    if (allow_update && handle.allow_update && handle.buffer &&
+        handle.primitive_counts == primitive_counts) {
+        accel_options.operation = OPTIX_BUILD_OPERATION_UPDATE;
+
+        void* d_temp_buffer = jit_malloc(AllocType::Device, handle.update_size);
+        jit_optix_check(optixAccelBuild(
+            context,
+            (CUstream) jit_cuda_stream(),
+            &accel_options,
+            build_inputs.data(),
+            (unsigned int) build_inputs.size(),
+            (CUdeviceptr) d_temp_buffer,
+            handle.update_size,
+            (CUdeviceptr) handle.buffer,
+            handle.size,
+            &handle.handle,
+            0, // emitted property list
+            0  // num emitted properties
+        ));
+        jit_free(d_temp_buffer);
+        return;
+    }
+
+    accel_options.operation = OPTIX_BUILD_OPERATION_BUILD;
+    if (handle.buffer)
+        jit_free(handle.buffer);
+    handle.handle = 0ull;
+    handle.buffer = nullptr;
+    handle.size = 0;
+    handle.allow_update = false;
+    handle.primitive_counts.clear();
+
+    if (build_inputs.empty())
+        return;
+
+    OptixAccelBufferSizes buffer_sizes;
+    jit_optix_check(optixAccelComputeMemoryUsage(
+        context,
+        &accel_options,
+        build_inputs.data(),
+        (unsigned int) build_inputs.size(),
+        &buffer_sizes
+    ));
+
+    void* d_temp_buffer = jit_malloc(AllocType::Device, buffer_sizes.tempSizeInBytes);
+    void* output_buffer = jit_malloc(AllocType::Device, buffer_sizes.outputSizeInBytes);
+    void* compact_size_buffer = jit_malloc(AllocType::Device, 8);
+
+    OptixAccelEmitDesc emit_property = {};
+    emit_property.type   = OPTIX_PROPERTY_TYPE_COMPACTED_SIZE;
+    emit_property.result = (CUdeviceptr) compact_size_buffer; // needs to be aligned
+
+    OptixTraversableHandle accel;
+    jit_optix_check(optixAccelBuild(
+        context,
+        (CUstream) jit_cuda_stream(),
+        &accel_options,
+        build_inputs.data(),
+        (unsigned int) build_inputs.size(),
+        (CUdeviceptr) d_temp_buffer,
+        buffer_sizes.tempSizeInBytes,
+        (CUdeviceptr) output_buffer,
+        buffer_sizes.outputSizeInBytes,
+        &accel,
+        &emit_property,  // emitted property list
+        1                // num emitted properties
+    ));
+
+    jit_free(d_temp_buffer);
+
+    size_t compact_size;
+    jit_memcpy(JitBackend::CUDA,
+               &compact_size,
+               (void*)emit_property.result,
+               sizeof(size_t));
+    jit_free(compact_size_buffer);
+
+    size_t output_size = buffer_sizes.outputSizeInBytes;
+    if (compact_size < output_size) {
+        void* compact_buffer = jit_malloc(AllocType::Device, compact_size);
+        // Use handle as input and output
+        jit_optix_check(optixAccelCompact(
+            context,
+            (CUstream) jit_cuda_stream(),
+            accel,
+            (CUdeviceptr) compact_buffer,
+            compact_size,
+            &accel
+        ));
+        jit_free(output_buffer);
+        output_buffer = compact_buffer;
+        output_size = compact_size;
+    }
+
+    handle.handle = accel;
+    handle.buffer = output_buffer;
+    handle.size = output_size;
+    handle.allow_update = allow_update;
+    handle.update_size = buffer_sizes.tempUpdateSizeInBytes;
+    handle.primitive_counts = primitive_counts;
+}
+
 /// Creates and appends the HitGroupSbtRecord for a given list of shapes
 template <typename Shape>
 void fill_hitgroup_records(std::vector<ref<Shape>> &shapes,
@@ -129,12 +260,15 @@ void fill_hitgroup_records(std::vector<ref<Shape>> &shapes,
  * \brief Build OptiX geometry acceleration structures (GAS) for a given list of shapes.
  *
  * Two different GAS will be created for the meshes and the custom shapes. Optix
- * handles to those GAS will be stored in an \ref OptixAccelData.
+ * handles to those GAS will be stored in an \ref OptixAccelData. When \c
+ * allow_update is \c true, GAS whose shapes kept their primitive counts since
+ * the last build are refit in place (see \ref build_accel()).
  */
 template <typename Shape>
 void build_gas(const OptixDeviceContext &context,
                const std::vector<ref<Shape>> &shapes,
-               OptixAccelData& out_accel) {
+               OptixAccelData& out_accel,
+               bool allow_update = false) {
 
     // Separate geometry types
     std::vector<ref<Shape>> meshes, bspline_curves,
@@ -151,90 +285,21 @@ void build_gas(const OptixDeviceContext &context,
     }
 
     // Build a GAS given a subset of shape pointers
-    auto build_single_gas = [&context](const std::vector<ref<Shape>> &shape_subset,
-                                       OptixAccelData::HandleData &handle) {
-
-        OptixAccelBuildOptions accel_options = {};
-        accel_options.buildFlags = OPTIX_BUILD_FLAG_ALLOW_COMPACTION |
-                                   OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
-
-        accel_options.operation  = OPTIX_BUILD_OPERATION_BUILD;
-        accel_options.motionOptions.numKeys = 0;
-        if (handle.buffer) {
-            jit_free(handle.buffer);
-            handle.handle = 0ull;
-            handle.buffer = nullptr;
-            handle.count = 0;
-        }
-
+    auto build_single_gas = [&context, allow_update](
+                                const std::vector<ref<Shape>> &shape_subset,
+                                OptixAccelData::HandleData &handle) {
         size_t shapes_count = shape_subset.size();
-        if (shapes_count == 0)
-            return;
-
         std::vector<OptixBuildInput> build_inputs(shapes_count);
-        for (size_t i = 0; i < shapes_count; i++)
+        std::vector<uint32_t> primitive_counts(shapes_count);
+        for (size_t i = 0; i < shapes_count; i++) {
             shape_subset[i]->optix_build_input(build_inputs[i]);
+            primitive_counts[i] = (uint32_t) shape_subset[i]->primitive_count();
+        }
 
         // Ensure shape data pointers are fully evaluated before building the BVH
         dr::sync_thread();
 
-        OptixAccelBufferSizes buffer_sizes;
-        jit_optix_check(optixAccelComputeMemoryUsage(
-            context,
-            &accel_options,
-            build_inputs.data(),
-            (unsigned int) shapes_count,
-            &buffer_sizes
-        ));
-
-        void* d_temp_buffer = jit_malloc(AllocType::Device, buffer_sizes.tempSizeInBytes);
-        void* output_buffer = jit_malloc(AllocType::Device, buffer_sizes.outputSizeInBytes);
-        void* compact_size_buffer = jit_malloc(AllocType::Device, 8);
-
-        OptixAccelEmitDesc emit_property = {};
-        emit_property.type   = OPTIX_PROPERTY_TYPE_COMPACTED_SIZE;
-        emit_property.result = (CUdeviceptr) compact_size_buffer; // needs to be aligned
-
-        OptixTraversableHandle accel;
-        jit_optix_check(optixAccelBuild(
-            context,
-            (CUstream) jit_cuda_stream(),
-            &accel_options,
-            build_inputs.data(),
-            (unsigned int) shapes_count,
-            (CUdeviceptr) d_temp_buffer,
-            buffer_sizes.tempSizeInBytes,
-            (CUdeviceptr) output_buffer,
-            buffer_sizes.outputSizeInBytes,
-            &accel,
-            &emit_property,  // emitted property list
-            1                // num emitted properties
-        ));
-
-        jit_free(d_temp_buffer);
-
-        size_t compact_size;
-        jit_memcpy(JitBackend::CUDA,
-                   &compact_size,
-                   (void*)emit_property.result,
-                   sizeof(size_t));
-        if (compact_size < buffer_sizes.outputSizeInBytes) {
-            void* compact_buffer = jit_malloc(AllocType::Device, compact_size);
-            // Use handle as input and output
-            jit_optix_check(optixAccelCompact(
-                context,
-                (CUstream) jit_cuda_stream(),
-                accel,
-                (CUdeviceptr) compact_buffer,
-                compact_size,
-                &accel
-            ));
-            jit_free(output_buffer);
-            output_buffer = compact_buffer;
-        }
-
-        handle.handle = accel;
-        handle.buffer = output_buffer;
+        build_accel(context, build_inputs, primitive_counts, allow_update, handle);
         handle.count = (uint32_t) shapes_count;
     };
 
@@ -11,6 +11,8 @@
 
 using CUdeviceptr            = void*;
 using CUstream               = void*;
+using CUevent                = void*;
+using CUresult               = int;
 using OptixPipeline          = void *;
 using OptixModule            = void *;
 using OptixProgramGroup      = void *;
@@ -24,6 +26,7 @@ using OptixTransformFormat   = int;
 using OptixAccelPropertyType = int;
 using OptixProgramGroupKind  = int;
 using OptixPrimitiveType     = int;
+using OptixTraversableType   = int;
 using OptixDeviceContext     = void*;
 using OptixTask              = void*;
 using OptixDenoiserStructPtr = void*;
@@ -37,6 +40,7 @@ using OptixDenoiserStructPtr = void*;
 #define OPTIX_BUILD_INPUT_TYPE_INSTANCES         0x2143
 #define OPTIX_BUILD_INPUT_TYPE_CURVES            0x2145
 #define OPTIX_BUILD_OPERATION_BUILD              0x2161
+#define OPTIX_BUILD_OPERATION_UPDATE             0x2162
 
 #define OPTIX_GEOMETRY_FLAG_NONE           0
 #define OPTIX_GEOMETRY_FLAG_DISABLE_ANYHIT 1
@@ -54,6 +58,7 @@ using OptixDenoiserStructPtr = void*;
 #define OPTIX_COMPILE_DEBUG_LEVEL_MODERATE       0x2353
 #define OPTIX_COMPILE_DEBUG_LEVEL_FULL           0x2352
 
+#define OPTIX_BUILD_FLAG_ALLOW_UPDATE               1
 #define OPTIX_BUILD_FLAG_ALLOW_COMPACTION           2
 #define OPTIX_BUILD_FLAG_PREFER_FAST_TRACE          4
 #define OPTIX_BUILD_FLAG_ALLOW_RANDOM_VERTEX_ACCESS 16
@@ -92,6 +97,13 @@ using OptixDenoiserStructPtr = void*;
 
 #define OPTIX_MODULE_COMPILE_STATE_COMPLETED 0x2364
 
+#define OPTIX_TRAVERSABLE_TYPE_MATRIX_MOTION_TRANSFORM 0x21C2
+#define OPTIX_MOTION_FLAG_NONE                         0
+#define OPTIX_TRANSFORM_BYTE_ALIGNMENT                 64ull
+
+#define CU_STREAM_NON_BLOCKING     1
+#define CU_EVENT_DISABLE_TIMING    2
+
 
 // =====================================================
 //          Commonly used OptiX data structures
@@ -104,6 +116,13 @@ struct OptixMotionOptions {
     float timeEnd;
 };
 
+struct OptixMatrixMotionTransform {
+    OptixTraversableHandle child;
+    OptixMotionOptions motionOptions;
+    unsigned int pad[3];
+    float transform[2][12];
+};
+
 struct OptixAccelBuildOptions {
     unsigned int buildFlags;
     OptixBuildOperation operation;
@@ -354,8 +373,12 @@ D(optixProgramGroupCreate, OptixDeviceContext, const OptixProgramGroupDesc *,
   unsigned int, const OptixProgramGroupOptions *, char *, size_t *,
   OptixProgramGroup *);
 D(optixSbtRecordPackHeader, OptixProgramGroup, void *);
+D(optixDeviceContextSetCacheEnabled, OptixDeviceContext, int);
+D(optixDeviceContextSetCacheLocation, OptixDeviceContext, const char *);
 D(optixAccelCompact, OptixDeviceContext, CUstream, OptixTraversableHandle,
   CUdeviceptr, size_t, OptixTraversableHandle *);
+D(optixConvertPointerToTraversableHandle, OptixDeviceContext, CUdeviceptr,
+  OptixTraversableType, OptixTraversableHandle *);
 D(optixDenoiserCreate, OptixDeviceContext, OptixDenoiserModelKind,
   const OptixDenoiserOptions *, OptixDenoiserStructPtr *);
 D(optixDenoiserDestroy, OptixDenoiserStructPtr);
@@ -372,6 +395,27 @@ D(optixDenoiserComputeIntensity, OptixDenoiserStructPtr, CUstream,
 
 #undef D
 
+// =====================================================
+//     CUDA driver functions used alongside OptiX
+// =====================================================
+
+#if defined(OPTIX_API_IMPL)
+#  define D(name, ...) CUresult (*name)(__VA_ARGS__) = nullptr;
+#else
+#  define D(name, ...) extern MI_EXPORT_LIB CUresult (*name)(__VA_ARGS__)
+#endif
+
+D(cuStreamCreate, CUstream *, unsigned int);
+D(cuStreamDestroy_v2, CUstream);
+D(cuStreamSynchronize, CUstream);
+D(cuStreamWaitEvent, CUstream, CUevent, unsigned int);
+D(cuEventCreate, CUevent *, unsigned int);
+D(cuEventDestroy_v2, CUevent);
+D(cuEventRecord, CUevent, CUstream);
+D(cuEventQuery, CUevent);
+
+#undef D
+
 NAMESPACE_BEGIN(mitsuba)
 extern MI_EXPORT_LIB void optix_initialize();
 
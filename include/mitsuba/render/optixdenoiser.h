@@ -7,6 +7,7 @@
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/optix_api.h>
 #include <drjit/tensor.h>
+#include <deque>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -20,6 +21,14 @@ NAMESPACE_BEGIN(mitsuba)
  * with a \ref Film which used the `box` \ref ReconstructionFilter. With a
  * filter that spans multiple pixels, the denoiser might identify some local
  * variance as a feature of the scene and will not denoise it.
+ *
+ * Denoising runs on a CUDA stream owned by the denoiser, whose state and
+ * scratch memory are allocated once and reused for every frame. To denoise
+ * an animation without stalling the renderer, queue frames with \ref submit()
+ * and retrieve them later with \ref result(): the render of the next frame
+ * can then be launched while the previous one is still being denoised. In
+ * temporal mode, \ref submit() also keeps track of the previous denoised
+ * frame.
  */
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB OptixDenoiser : public Object {
@@ -177,10 +186,63 @@ public:
                            const std::string &previous_denoised_ch = "",
                            const std::string &noisy_ch = "<root>") const;
 
+    /**
+     * \brief Queue a frame for denoising and return without waiting for it
+     *
+     * The arguments are the same as those of the \ref TensorXf variant of
+     * \ref operator()(). The inputs are evaluated on the Dr.Jit stream, after
+     * which the denoiser's own stream denoises them concurrently with any
+     * work that is subsequently launched by Dr.Jit. Frames are retrieved in
+     * submission order with \ref result().
+     *
+     * In temporal mode, \c flow and \c previous_denoised are optional: the
+     * flow then defaults to zero, and the previous denoised frame to the
+     * result of the last submitted frame (or the noisy input for the first
+     * frame after construction or \ref reset()).
+     */
+    void submit(const TensorXf &noisy,
+                bool denoise_alpha = true,
+                const TensorXf &albedo = TensorXf(),
+                const TensorXf &normals = TensorXf(),
+                const Transform4f &to_sensor = Transform4f(),
+                const TensorXf &flow = TensorXf(),
+                const TensorXf &previous_denoised = TensorXf());
+
+    /**
+     * \brief Return the denoised result of the oldest submitted frame
+     *
+     * This does not block the host: Dr.Jit kernels that use the returned
+     * tensor are ordered after the denoiser's work on the GPU.
+     */
+    TensorXf result();
+
+    /// Return the number of frames that were submitted but not yet retrieved
+    size_t pending() const { return m_pending.size(); }
+
+    /// Start a new temporal sequence (drops the previous denoised frame)
+    void reset() { m_previous = TensorXf(); }
+
     virtual std::string to_string() const override;
 
     MI_DECLARE_CLASS()
 private:
+    /// A denoised frame that is in flight on the denoiser stream
+    struct Frame {
+        TensorXf output;
+        /// Inputs that must stay alive until the denoiser has read them
+        std::vector<TensorXf> inputs;
+        CUevent done = nullptr;
+    };
+
+    /// Launch the denoiser on its stream without waiting for completion
+    Frame launch(const TensorXf &noisy, bool denoise_alpha,
+                 const TensorXf &albedo, const TensorXf &normals,
+                 const Transform4f &to_sensor, const TensorXf &flow,
+                 const TensorXf &previous_denoised) const;
+
+    /// Order subsequent Dr.Jit work after a frame and release its resources
+    TensorXf finish(Frame &frame) const;
+
     /// Helper function to validate tensor sizes
     void validate_input(const TensorXf &noisy,
                         const TensorXf &albedo,
@@ -197,6 +259,10 @@ private:
     bool m_temporal;
     OptixDenoiserStructPtr m_denoiser;
     CUdeviceptr m_hdr_intensity;
+    CUstream m_stream;
+    CUevent m_inputs_ready;
+    std::deque<Frame> m_pending;
+    TensorXf m_previous;
 };
 
 MI_EXTERN_CLASS(OptixDenoiser)
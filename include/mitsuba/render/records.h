@@ -144,6 +144,15 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
       */
     EmitterPtr emitter = nullptr;
 
+    /**
+     * \brief Optional: index of the sampled primitive within its shape
+     *
+     * Shapes consisting of several primitives (e.g. the triangles of a mesh)
+     * can use this attribute to identify the primitive that contains the
+     * sampled position when evaluating the associated density.
+     */
+    UInt32 prim_index = 0;
+
     //! @}
     // =============================================================
 
@@ -177,6 +186,7 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
         dist = dr::norm(rel);
         d = select(si.is_valid(), rel / dist, -si.wi);
         emitter = si.emitter(scene);
+        prim_index = si.prim_index;
     }
 
     /// Element-by-element constructor
@@ -191,7 +201,8 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     //! @}
     // =============================================================
 
-    DRJIT_STRUCT(DirectionSample, p, n, uv, time, pdf, delta, d, dist, emitter)
+    DRJIT_STRUCT(DirectionSample, p, n, uv, time, pdf, delta, d, dist, emitter,
+                 prim_index)
 };
 
 // -----------------------------------------------------------------------------
@@ -222,7 +233,8 @@ std::ostream &operator<<(std::ostream &os,
        << "  delta = " << ds.delta << "," << std::endl
        << "  emitter = " << string::indent(ds.emitter) << "," << std::endl
        << "  d = " << string::indent(ds.d, 6) << "," << std::endl
-       << "  dist = " << ds.dist << std::endl
+       << "  dist = " << ds.dist << "," << std::endl
+       << "  prim_index = " << ds.prim_index << std::endl
        << "]";
     return os;
 }
@@ -59,6 +59,10 @@ NAMESPACE_BEGIN(mitsuba)
  *      of (pseudo-) random numbers using the \ref next_1d() and \ref next_2d()
  *      functions.
  *
+ * In both cases, the rendering algorithm may additionally invoke
+ * \ref set_pixel_position() after \ref seed() to specify which pixel the
+ * sequence(s) will be used for.
+ *
  */
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Sampler : public Object {
@@ -125,12 +129,25 @@ public:
     /// Set the number of samples per pixel per pass in wavefront modes (default is 1)
     void set_samples_per_wavefront(uint32_t samples_per_wavefront);
 
+    /**
+     * \brief Inform the sampler about the pixel associated with each sequence
+     *
+     * Invoked by the rendering algorithm after \ref seed(). Samplers that
+     * distribute the error over the image plane (e.g. using a blue-noise
+     * dither mask) rely on this information, while the default implementation
+     * ignores it.
+     */
+    virtual void set_pixel_position(const Point2u & /* pos */) { }
+
     /// dr::schedule() variables that represent the internal sampler state
     virtual void schedule_state();
 
     /// Register internal state of this sampler with a symbolic loop
     virtual void loop_put(dr::Loop<Mask> &loop);
 
+    /// Return the index of the current sample of every pixel
+    UInt32 current_sample_index() const;
+
     MI_DECLARE_CLASS()
 protected:
     Sampler(const Properties &props);
@@ -140,8 +157,6 @@ protected:
 
     /// Generates a array of seeds where the seed values are unique per sequence
     UInt32 compute_per_sequence_seed(uint32_t seed) const;
-    /// Return the index of the current sample
-    UInt32 current_sample_index() const;
 
 protected:
     /// Base seed value
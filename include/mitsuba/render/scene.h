@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/shapegroup.h>
@@ -9,6 +10,48 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Summary of the ray tracing acceleration data structure of a scene
+ * (see \ref Scene::accel_stats())
+ *
+ * Statistics that a backend does not expose are zero (counts) or NaN (SAH
+ * cost). Embree and OptiX do not report their node counts and SAH costs.
+ */
+struct MI_EXPORT_LIB AccelStats {
+    /// Backend: \c "kdtree", \c "bvh", \c "embree" or \c "optix"
+    std::string backend;
+    /// Duration of the last build or update (in milliseconds)
+    float build_time = 0.f;
+    /// Memory used by the data structure (in bytes)
+    size_t memory = 0;
+    /// Number of nodes
+    size_t node_count = 0;
+    /// Number of primitives in the scene
+    size_t primitive_count = 0;
+    /// Expected cost of a ray that intersects the scene bounding box
+    float sah_cost = dr::NaN<float>;
+
+    /// Return a human-readable summary
+    std::string to_string() const;
+};
+
+/**
+ * \brief Average work per ray measured by \ref Scene::accel_traversal_stats()
+ */
+struct MI_EXPORT_LIB TraversalStats {
+    /// Number of traced rays
+    size_t ray_count = 0;
+    /// Average number of visited nodes per ray
+    float nodes_per_ray = 0.f;
+    /// Average number of primitive intersection tests per ray
+    float primitives_per_ray = 0.f;
+    /// Fraction of the rays that intersected the scene
+    float hit_fraction = 0.f;
+
+    /// Return a human-readable summary
+    std::string to_string() const;
+};
+
 /**
  * \brief Central scene data structure
  *
@@ -37,9 +80,66 @@ template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Scene : public Object {
 public:
     MI_IMPORT_TYPES(BSDF, Emitter, EmitterPtr, Film, Sampler, Shape, ShapePtr,
-                    ShapeGroup, Sensor, Integrator, Medium, MediumPtr, Mesh)
+                    ShapeGroup, Sensor, Integrator, Medium, MediumPtr, Mesh,
+                    LightTree, EmitterCache, Texture)
 
-    /// Instantiate a scene from a \ref Properties object
+    /**
+     * \brief Instantiate a scene from a \ref Properties object
+     *
+     * When the \c merge_bsdfs property is set to \c true, the BSDFs of all
+     * shapes that are instances of the same plugin with identical
+     * configuration and constant parameters are merged into a single BSDF
+     * per group (see \ref BSDF::merge()). This reduces the number of
+     * virtual function calls in vectorized variants, but the parameters of
+     * the merged BSDFs can no longer be changed (e.g. through \c traverse()).
+     *
+     * Similarly, the \c flatten_bsdfs property removes adapter BSDFs that
+     * don't alter the response of the BSDF they wrap (see \ref
+     * BSDF::flatten()). Flattening happens before merging.
+     *
+     * When the \c instance_meshes property is set to \c true, meshes that
+     * only differ by their \c to_world transformation (e.g. several
+     * \c ply, \c obj, or \c serialized shapes loading the same geometry)
+     * are detected by hashing their face and texture coordinate buffers and
+     * comparing the transformed vertices of the candidates. Every set of
+     * duplicates is replaced by a shape group containing a single copy of
+     * the geometry and one instance per mesh, which saves memory and
+     * acceleration data structure construction time. Meshes with attached
+     * emitters, sensors, or mesh attributes are never instanced, and the
+     * vertex buffers of the replaced meshes are no longer exposed through
+     * \c traverse().
+     *
+     * In CPU variants without Embree, the \c accel_type property selects
+     * the acceleration data structure: a SAH kd-tree (\c kdtree, the
+     * default) or a four-wide BVH (\c bvh). The BVH traverses instances as
+     * the top level of a two-level hierarchy and is usually faster for
+     * scenes with many overlapping instances.
+     *
+     * In CPU variants using Embree, the \c embree_build_quality property
+     * (\c low, \c medium, or \c high, the default) selects the quality of
+     * the BVH built over the scene, trading construction time for tracing
+     * performance. The boolean properties \c embree_compact, \c
+     * embree_robust, and \c embree_dynamic respectively request a more
+     * compact BVH, more robust (but slower) intersection tests, and a
+     * two-level BVH that is faster to update. The latter is enabled by
+     * default when a shape sets its \c embree_build property to \c dynamic.
+     *
+     * In CUDA variants, the \c optix_allow_update property builds the OptiX
+     * acceleration data structures such that they can be refit in place,
+     * which is much faster than a rebuild when only vertex positions or
+     * instance transformations change (e.g. in an optimization loop). The
+     * refit structures trace slightly slower, and a full rebuild still
+     * happens when the number of primitives of a shape changes.
+     *
+     * When the \c emitter_cache property is set to \c true, an \ref
+     * EmitterCache learns the visible contribution of every emitter over a
+     * hashed grid of \c emitter_cache_resolution cells along the longest
+     * axis of the scene (default: 32) with \c emitter_cache_entries table
+     * entries (default: 16384). Sampling integrators update it after each
+     * of the first \c emitter_cache_passes rendering passes (default: 4),
+     * and \ref sample_emitter_direction() then mostly chooses emitters from
+     * it. This requires multiple passes.
+     */
     Scene(const Properties &props);
 
     // =============================================================
@@ -206,6 +306,58 @@ public:
      */
     Mask ray_test(const Ray3f &ray, Mask coherent, Mask active) const;
 
+    /**
+     * \brief Test a batch of rays for occlusion
+     *
+     * This function is equivalent to calling \ref ray_test() for each entry
+     * of \c rays and storing the results in \c occluded. In scalar variants
+     * using Embree, the rays are traced in packets of 16 using Embree's
+     * packet traversal (<tt>rtcOccluded16</tt>), which uses SIMD instructions
+     * across rays and is more efficient than tracing them one after the
+     * other (e.g. for the shadow rays of several emitter samples at the same
+     * shading point). The other variants trace the rays individually.
+     *
+     * \param rays
+     *    Array of \c count rays to be tested
+     *
+     * Large batches are split into chunks that are traced in parallel on
+     * Mitsuba's thread pool.
+     *
+     * \param active
+     *    Array of \c count masks. Inactive rays are reported as unoccluded.
+     *
+     * \param occluded
+     *    Output array of \c count masks set to \c true where an intersection
+     *    was found
+     */
+    void ray_test_batch(const Ray3f *rays, const Mask *active, Mask *occluded,
+                        size_t count) const;
+
+    /**
+     * \brief Find the preliminary intersections of a batch of rays
+     *
+     * This function is equivalent to calling \ref ray_intersect_preliminary()
+     * for each entry of \c rays and storing the results in \c result. It is
+     * meant for applications that trace many independent rays with the
+     * scalar variants. In scalar variants using Embree, the rays are traced
+     * in packets of 16 using Embree's packet traversal
+     * (<tt>rtcIntersect16</tt>). The other variants trace the rays
+     * individually. Large batches are split into chunks that are traced in
+     * parallel on Mitsuba's thread pool.
+     *
+     * \param rays
+     *    Array of \c count rays
+     *
+     * \param active
+     *    Array of \c count masks. Inactive rays are reported as misses.
+     *
+     * \param result
+     *    Output array of \c count preliminary intersection records
+     */
+    void ray_intersect_preliminary_batch(const Ray3f *rays, const Mask *active,
+                                         PreliminaryIntersection3f *result,
+                                         size_t count) const;
+
     /**
      * \brief Intersect a ray with the shapes comprising the scene and return
      * preliminary information, if one is found
@@ -279,8 +431,12 @@ public:
      * \brief Sample one emitter in the scene and rescale the input sample
      * for reuse.
      *
-     * Currently, the sampling scheme implemented by the \ref Scene class is
-     * very simplistic (uniform).
+     * Emitters are chosen uniformly unless some of them specify a custom
+     * \c sampling_weight, in which case they are chosen proportionally to
+     * it. This discrete distribution is searched in O(log n) by default;
+     * setting the scene's \c alias_sampling property to \c true instead
+     * builds an alias table with O(1) lookups. The latter does not preserve
+     * the stratification of \c index_sample.
      *
      * \param sample
      *    A uniformly distributed number in [0, 1).
@@ -351,6 +507,14 @@ public:
      * the sampled emitter position. However, approximations are acceptable as
      * long as these are reflected in the returned Monte Carlo sampling weight.
      *
+     * By default, the emitter is chosen independently of \c ref. When the
+     * scene was created with the \c light_tree property set to \c true, a
+     * \ref LightTree instead picks emitters according to their distance,
+     * orientation and power relative to \c ref. Once the optional \ref
+     * EmitterCache has been trained, emitters are drawn from a mixture of the
+     * cached distribution of the cell containing \c ref and the above
+     * strategy. Shadow rays cast with \c test_visibility set train the cache.
+     *
      * \param ref
      *    A 3D reference location within the scene, which may influence the
      *    sampling process.
@@ -476,6 +640,9 @@ public:
     /// Return the scene's integrator
     const Integrator* integrator() const { return m_integrator; }
 
+    /// Return the emitter cache (if enabled)
+    EmitterCache *emitter_cache() const { return m_emitter_cache.get(); }
+
     /// Return the list of emitters as an Dr.Jit array
     const DynamicBuffer<EmitterPtr> &emitters_dr() const { return m_emitters_dr; }
 
@@ -504,6 +671,50 @@ public:
      */
     bool shapes_grad_enabled() const { return m_shapes_grad_enabled; };
 
+    /**
+     * \brief Return the smallest combination of \ref RayFlags that provides
+     * the fields of the surface interaction accessed by the scene's BSDFs,
+     * textures and emitters
+     *
+     * The flags are derived from the BSDFs (see \ref BSDF::ray_flags()) and
+     * textures reachable from the shapes when the scene is loaded or its
+     * parameters change. For example, UV coordinates are only computed when
+     * a texture is spatially varying, and their position partials when a
+     * BSDF is anisotropic or perturbs the shading frame. Integrators pass
+     * these flags to \ref ray_intersect() to skip the computation of unused
+     * fields on every hit.
+     */
+    uint32_t ray_flags() const { return m_ray_flags; }
+
+    /**
+     * \brief Return build statistics of the ray tracing acceleration data
+     * structure (updated on every build or refit)
+     */
+    const AccelStats &accel_stats() const { return m_accel_stats; }
+
+    /**
+     * \brief Measure the traversal cost of the native acceleration data
+     * structures (kd-tree or BVH) using random rays
+     *
+     * The rays connect pairs of uniformly distributed points on the bounding
+     * sphere of the scene, which yields the distribution of lines assumed by
+     * the surface area heuristic. Unusually high counts compared to the SAH
+     * cost reported by \ref accel_stats() point at geometry that the
+     * builder handles poorly, e.g. long and thin triangles or heavily
+     * overlapping instances. The rays are traced on the calling thread.
+     *
+     * This function is not available for the Embree and OptiX backends,
+     * whose traversal is not instrumented.
+     *
+     * \param ray_count
+     *     Number of random rays
+     *
+     * \param seed
+     *     Seed of the random number generator
+     */
+    TraversalStats accel_traversal_stats(uint32_t ray_count = 65536,
+                                         uint32_t seed = 0) const;
+
     /// Return a human-readable string representation of the scene contents.
     virtual std::string to_string() const override;
 
@@ -538,6 +749,10 @@ protected:
     static void static_accel_shutdown_cpu();
     static void static_accel_shutdown_gpu();
 
+    /// Trace random rays through the native acceleration data structure
+    TraversalStats accel_traversal_stats_cpu(uint32_t ray_count,
+                                             uint32_t seed) const;
+
     /// Trace a ray and only return a preliminary intersection data structure
     MI_INLINE PreliminaryIntersection3f ray_intersect_preliminary_cpu(
         const Ray3f &ray, Mask coherent, Mask active) const;
@@ -552,12 +767,35 @@ protected:
     /// Trace a shadow ray
     MI_INLINE Mask ray_test_cpu(const Ray3f &ray, Mask coherent, Mask active) const;
     MI_INLINE Mask ray_test_gpu(const Ray3f &ray, Mask active) const;
+    MI_INLINE void ray_test_batch_cpu(const Ray3f *rays, const Mask *active,
+                                      Mask *occluded, size_t count) const;
+    MI_INLINE void ray_intersect_preliminary_batch_cpu(
+        const Ray3f *rays, const Mask *active,
+        PreliminaryIntersection3f *result, size_t count) const;
 
     using ShapeKDTree = mitsuba::ShapeKDTree<Float, Spectrum>;
 
     /// Updates the discrete distribution used to select an emitter
     void update_emitter_sampling_distribution();
 
+    /// Discard the learned data by creating a new \ref m_emitter_cache (if enabled)
+    void update_emitter_cache();
+
+    /// (Re-)build \ref m_emitter_distr or \ref m_emitter_alias from \ref m_emitter_weights
+    void build_emitter_distribution();
+
+    /// Merge compatible BSDF instances of the shapes in the scene
+    void merge_bsdfs();
+
+    /// Flatten the networks of nested BSDFs of the shapes in the scene
+    void flatten_bsdfs();
+
+    /// Replace meshes that are transformed copies of each other by instances
+    void instance_meshes();
+
+    /// Derive \ref m_ray_flags from the BSDFs and textures of the shapes
+    void update_ray_flags();
+
 protected:
     /// Acceleration data structure (IAS) (type depends on implementation)
     void *m_accel = nullptr;
@@ -576,9 +814,28 @@ protected:
     ref<Integrator> m_integrator;
     ref<Emitter> m_environment;
     ScalarFloat m_emitter_pmf;
+    /// Emitter sampling weights used to build the current emitter distribution
+    std::vector<ScalarFloat> m_emitter_weights;
     std::unique_ptr<DiscreteDistribution<Float>> m_emitter_distr = nullptr;
+    /// Alias table replacing \ref m_emitter_distr when ``alias_sampling`` is set
+    std::unique_ptr<AliasDistribution<Float>> m_emitter_alias = nullptr;
+    bool m_use_alias_sampling = false;
+    /// Spatial emitter hierarchy used by \ref sample_emitter_direction() (optional)
+    ref<LightTree> m_light_tree;
+    bool m_use_light_tree = false;
+    /// Learned emitter selection used by \ref sample_emitter_direction() (optional)
+    ref<EmitterCache> m_emitter_cache;
+    bool m_use_emitter_cache = false;
+    uint32_t m_emitter_cache_resolution;
+    uint32_t m_emitter_cache_entries;
+    uint32_t m_emitter_cache_passes;
 
     bool m_shapes_grad_enabled;
+    /// Surface interaction fields needed by the scene (see \ref ray_flags())
+    uint32_t m_ray_flags = +RayFlags::All;
+    /// Statistics of the last acceleration data structure build
+    AccelStats m_accel_stats;
+    MemoryRecord m_accel_memory { MemoryCategory::Accel };
 };
 
 /// Dummy function which can be called to ensure that the librender shared library is loaded
@@ -588,11 +845,21 @@ extern MI_EXPORT_LIB void librender_nop();
 template <typename Float, typename Spectrum>
 typename SurfaceInteraction<Float, Spectrum>::EmitterPtr
 SurfaceInteraction<Float, Spectrum>::emitter(const Scene *scene, Mask active) const {
+    /* Emissive shapes of a shape group are sampled by the emitter of the
+       instance that was hit (see the 'instance' plugin) */
     if constexpr (!dr::is_jit_v<Float>) {
         DRJIT_MARK_USED(active);
-        return is_valid() ? shape->emitter() : scene->environment();
+        if (!is_valid())
+            return scene->environment();
+        EmitterPtr emitter = shape->emitter();
+        if (emitter && instance)
+            emitter = instance->emitter();
+        return emitter;
     } else {
         EmitterPtr emitter = shape->emitter(active);
+        Mask instanced = active && dr::neq(emitter, nullptr) &&
+                         dr::neq(instance, nullptr);
+        emitter = dr::select(instanced, instance->emitter(instanced), emitter);
         if (scene->environment())
             emitter = dr::select(is_valid(), emitter, scene->environment() & active);
         return emitter;
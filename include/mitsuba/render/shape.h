@@ -15,6 +15,16 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Specifies how the Embree BVH of a shape is built and updated
+enum class EmbreeBuildMode : uint32_t {
+    /// Build with the default quality, refit the BVH when the shape deforms
+    Refit,
+    /// Build with high quality (spatial splits), rebuild when the shape deforms
+    Static,
+    /// Build with low quality, for shapes that are rebuilt frequently
+    Dynamic
+};
+
 /**
  * \brief Base class of all geometric shapes in Mitsuba
  *
@@ -221,6 +231,22 @@ public:
     ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const;
     virtual bool ray_test_scalar(const ScalarRay3f &ray) const;
 
+    /**
+     * \brief Scalar intersection test with a single primitive of the shape
+     *
+     * This operation is used by the native BVH for shapes that consist of
+     * several primitives (see \ref primitive_count()) but aren't meshes.
+     * The default implementation ignores \c prim_index and forwards to
+     * \ref ray_intersect_preliminary_scalar().
+     */
+    virtual std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_primitive_scalar(ScalarIndex prim_index,
+                                   const ScalarRay3f &ray) const;
+
+    /// Shadow ray variant of \ref ray_intersect_primitive_scalar()
+    virtual bool ray_test_primitive_scalar(ScalarIndex prim_index,
+                                           const ScalarRay3f &ray) const;
+
     /// Macro to declare packet versions of the scalar routine above
     #define MI_DECLARE_RAY_INTERSECT_PACKET(N)                            \
         using FloatP##N   = dr::Packet<dr::scalar_t<Float>, N>;            \
@@ -390,6 +416,41 @@ public:
     /// Is this shape an instance?
     bool is_instance() const { return class_()->name() == "Instance"; };
 
+    /**
+     * \brief Does this shape move during the exposure?
+     *
+     * This is the case for instances with keyframed \c to_world
+     * transformations, which require motion blur support by the ray tracing
+     * backend.
+     */
+    virtual bool has_motion() const { return false; }
+
+    /**
+     * \brief Adapt the tessellation of this shape to the sensors of a scene
+     *
+     * Called by the scene once all of its sensors are known and before the
+     * acceleration data structure is built. The default implementation does
+     * nothing.
+     *
+     * \return
+     *    \c true if the geometry (and hence the bounding box) changed
+     */
+    virtual bool update_tessellation(const std::vector<ref<Sensor>> &sensors) {
+        DRJIT_MARK_USED(sensors);
+        return false;
+    }
+
+    /**
+     * \brief Return the shape group referenced by this shape if it is an
+     * instance, and \c nullptr otherwise
+     */
+    virtual const ShapeGroup<Float, Spectrum> *instanced_shapegroup() const {
+        return nullptr;
+    }
+
+    /// Return the world-to-object transformation of the shape (scalar version)
+    const ScalarTransform4f &to_object_scalar() const { return m_to_object.scalar(); }
+
     /// Does the surface of this shape mark a medium transition?
     bool is_medium_transition() const { return m_interior_medium.get() != nullptr ||
                                                m_exterior_medium.get() != nullptr; }
@@ -406,6 +467,21 @@ public:
     /// Return the shape's BSDF
     BSDF *bsdf(Mask /*unused*/ = true) { return m_bsdf.get(); }
 
+    /**
+     * \brief Return the index of the shape's original BSDF within its merged
+     * BSDF (see \ref BSDF::merge()), and zero otherwise
+     */
+    uint32_t bsdf_index(Mask /*unused*/ = true) const { return m_bsdf_index; }
+
+    /**
+     * \brief Replace the shape's BSDF
+     *
+     * \param index
+     *     When \c bsdf merges several BSDF instances, the index of the
+     *     instance that describes the surface of this shape.
+     */
+    void set_bsdf(BSDF *bsdf, uint32_t index = 0);
+
     /// Is this shape also an area emitter?
     bool is_emitter() const { return (bool) m_emitter; }
 
@@ -444,8 +520,30 @@ public:
 #if defined(MI_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device);
+
+    /**
+     * \brief Refresh an Embree geometry previously created by \ref
+     * embree_geometry() after the shape deformed without changing its
+     * topology, and mark it for a refit rather than a full rebuild.
+     *
+     * Returns \c false when the shape does not support this operation, in
+     * which case the caller must create a new geometry instead.
+     */
+    virtual bool embree_update_geometry(RTCGeometry geom);
+
+    /**
+     * \brief Return the Embree build quality of this shape's geometry
+     *
+     * Depends on the \c embree_build property of the shape. When \c update
+     * is \c true, the quality of an update of the geometry after a
+     * deformation is returned instead (e.g. \c RTC_BUILD_QUALITY_REFIT).
+     */
+    RTCBuildQuality embree_build_quality(bool update = false) const;
 #endif
 
+    /// Return how the Embree BVH of this shape is built and updated
+    EmbreeBuildMode embree_build_mode() const { return m_embree_build_mode; }
+
 #if defined(MI_ENABLE_CUDA)
     /**
      * \brief Populates the GPU data buffer, used in the OptiX Hitgroup sbt records.
@@ -564,6 +662,7 @@ protected:
     std::string get_children_string() const;
 protected:
     ref<BSDF> m_bsdf;
+    uint32_t m_bsdf_index = 0;
     ref<Emitter> m_emitter;
     ref<Sensor> m_sensor;
     ref<Medium> m_interior_medium;
@@ -578,6 +677,9 @@ protected:
     /// True if the shape is used in a \c ShapeGroup
     bool m_is_instance = false;
 
+    /// How the Embree BVH of this shape is built and updated
+    EmbreeBuildMode m_embree_build_mode = EmbreeBuildMode::Refit;
+
 #if defined(MI_ENABLE_CUDA)
     /// OptiX hitgroup data buffer
     void* m_optix_data_ptr = nullptr;
@@ -665,6 +767,7 @@ DRJIT_VCALL_TEMPLATE_BEGIN(mitsuba::Shape)
     DRJIT_VCALL_GETTER(emitter, const typename Class::Emitter *)
     DRJIT_VCALL_GETTER(sensor, const typename Class::Sensor *)
     DRJIT_VCALL_GETTER(bsdf, const typename Class::BSDF *)
+    DRJIT_VCALL_GETTER(bsdf_index, uint32_t)
     DRJIT_VCALL_GETTER(interior_medium, const typename Class::Medium *)
     DRJIT_VCALL_GETTER(exterior_medium, const typename Class::Medium *)
     auto is_emitter() const { return neq(emitter(), nullptr); }
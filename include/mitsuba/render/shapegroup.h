@@ -60,6 +60,14 @@ public:
     /// Return whether this shapegroup contains other type of shapes
     bool has_others() const { return m_has_others; }
 
+    /// Return the shapes of the group
+    const std::vector<ref<Base>> &shapes() const { return m_shapes; }
+
+#if !defined(MI_ENABLE_EMBREE)
+    /// Return the kd-tree over the shapes of the group (shared by all instances)
+    const ShapeKDTree *kdtree() const { return m_kdtree.get(); }
+#endif
+
     void traverse(TraversalCallback *callback) override;
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override;
     bool parameters_grad_enabled() const override;
@@ -4,6 +4,7 @@
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/imageblock.h>
+#include <deque>
 #include <mutex>
 
 #if !defined(MI_BLOCK_SIZE)
@@ -40,9 +41,54 @@ public:
     /// Return the total number of blocks
     uint32_t block_count() { return m_block_count; }
 
+    /// Return the number of passes that remain, including the current one
+    uint32_t passes_left() const { return m_passes_left; }
+
     /// Reset the spiral to its initial state. Does not affect the number of passes.
     void reset();
 
+    /**
+     * \brief Generate the blocks that overlap a region of interest first
+     *
+     * The region is specified in the coordinates of the block offsets
+     * returned by \ref next_block() (i.e. including the offset of the crop
+     * window). Without a pass barrier (see \ref set_pass_barrier()), all
+     * passes over the blocks of the region are generated before the
+     * remaining blocks, so that the region converges first. With a pass
+     * barrier, the region comes first within every pass. Block identifiers,
+     * and thus the sample seeds, don't depend on the order. A region of size
+     * zero restores the default order.
+     *
+     * This function must be called before the traversal starts.
+     */
+    void set_priority_region(const Vector2i &offset, const Vector2u &size);
+
+    /// Return the number of blocks that overlap the priority region
+    uint32_t priority_block_count() const { return m_priority_count; }
+
+    /**
+     * \brief Does the tile with the given identifier and block size (as
+     * returned by \ref next_tile()) overlap the priority region?
+     */
+    bool is_priority_block(uint32_t block_id, uint32_t block_size) const;
+
+    /**
+     * \brief Stop the traversal at the end of every pass
+     *
+     * When enabled, \ref next_block() and \ref next_tile() report that the
+     * traversal is done once all blocks of the current pass were generated,
+     * until \ref next_pass() is called. This allows the caller to wait for
+     * all workers to finish a pass (e.g. to save the render state).
+     */
+    void set_pass_barrier(bool value);
+
+    /**
+     * \brief Continue with the next pass after stopping at a pass barrier
+     *
+     * Returns \c false if the current pass was the last one.
+     */
+    bool next_pass();
+
     /**
      * \brief Return the offset, size, and unique identifier of the next block.
      *
@@ -50,22 +96,91 @@ public:
      */
     std::tuple<Vector2i, Vector2u, uint32_t> next_block();
 
+    /**
+     * \brief Enable adaptive splitting of expensive blocks
+     *
+     * When enabled, \ref next_tile() subdivides blocks into quadrants
+     * ("tiles") that are placed onto a shared queue, from which idle workers
+     * take work before advancing the spiral. A block is split when its
+     * running cost (see \ref record_time()) exceeds \c split_threshold
+     * times the average block cost, or when fewer than \c worker_count
+     * blocks remain in the final pass.
+     *
+     * \param worker_count
+     *     Number of workers consuming the tiles. A value of zero disables
+     *     adaptive splitting.
+     *
+     * \param min_block_size
+     *     Tiles are never split below this size (in pixels).
+     *
+     * \param split_threshold
+     *     Relative cost above which a block is subdivided.
+     */
+    void set_adaptive(uint32_t worker_count,
+                      uint32_t min_block_size = 4,
+                      float split_threshold = 2.f);
+
+    /**
+     * \brief Return the offset, size, unique identifier, and block size
+     * of the next tile.
+     *
+     * This function behaves like \ref next_block(), except that the returned
+     * tile may be a quadrant of a spiral block when adaptive splitting is
+     * enabled. The identifier and block size are chosen so that
+     * <tt>block_id * block_size^2</tt> plus the Morton index of a pixel
+     * within the tile matches the Morton index of that pixel within the
+     * unsplit parent block. Sample seeds are therefore independent of the
+     * splitting decisions.
+     *
+     * A size of zero indicates that the spiral traversal is done.
+     */
+    std::tuple<Vector2i, Vector2u, uint32_t, uint32_t> next_tile();
+
+    /**
+     * \brief Record the time (in milliseconds) spent rendering the tile
+     * with the given identifier and block size, as returned by
+     * \ref next_tile(). The measurements inform future splitting decisions.
+     */
+    void record_time(uint32_t block_id, uint32_t block_size, float time);
+
     MI_DECLARE_CLASS()
 protected:
     enum class Direction { Right, Down, Left, Up };
 
+    /// Spiral index of a block (i.e. its ID in the first pass) given a tile ID
+    uint32_t spiral_index(uint32_t block_id, uint32_t block_size) const;
+
+    using Tile = std::tuple<Vector2i, Vector2u, uint32_t, uint32_t>;
+
+    /// Advance the spiral (the caller must hold \ref m_mutex)
+    std::tuple<Vector2i, Vector2u, uint32_t> next_block_unlocked();
+
+    /// Split a tile into quadrants and append them to \ref m_tiles
+    void split_tile(const Tile &tile, uint32_t levels);
+
     std::mutex m_mutex;       //< Protects the state for thread safety
     Vector2u m_size;          //< Size of the 2D image (in pixels)
     Vector2u m_offset;        //< Offset to the crop region on the sensor (pixels)
     Vector2u m_blocks;        //< Number of blocks in each direction
-    Point2i  m_position;      //< Relative position of the current block
-    Direction direction;      //< Current spiral direction
     uint32_t m_block_counter; //< Number of blocks generated so far
+    uint32_t m_block_end;     //< Value of \ref m_block_counter ending the pass
     uint32_t m_block_count;   //< Number of blocks to be generated in pass
+    uint32_t m_pass_count;    //< Total number of spiral passes
     uint32_t m_passes_left;   //< Remaining spiral passes to be generated
+    bool m_pass_barrier;      //< Stop at the end of every pass?
     uint32_t m_block_size;    //< Size of the (square) blocks (in pixels)
-    uint32_t m_steps_left;    //< Steps before next change of direction
-    uint32_t m_spiral_size;   //< Current spiral size in blocks
+    std::vector<Point2i> m_positions; //< Position of every block along the spiral
+    std::vector<uint32_t> m_order;    //< Spiral indices in traversal order
+    std::vector<bool> m_priority;     //< Does a block overlap the priority region?
+    uint32_t m_priority_count;//< Number of blocks in the priority region
+    bool m_region_first;      //< Generate all passes of the region first?
+    bool m_region_done;       //< Are all passes of the region generated?
+    uint32_t m_worker_count;  //< Workers consuming tiles (0: no splitting)
+    uint32_t m_min_block_size;//< Smallest tile size produced by splitting
+    float m_split_threshold;  //< Relative cost that triggers a split
+    std::deque<Tile> m_tiles; //< Queue of pending sub-tiles
+    std::vector<float> m_block_cost; //< Accumulated time per spiral block
+    float m_total_cost;       //< Sum of \ref m_block_cost
 };
 
 NAMESPACE_END(mitsuba)
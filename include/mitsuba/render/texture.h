@@ -182,6 +182,19 @@ public:
      */
     virtual ScalarVector2i resolution() const;
 
+    /**
+     * \brief Return a conservative map of the regions where the texture is
+     * zero
+     *
+     * The UV square is divided into the cells of a grid with the \ref
+     * resolution() of the texture, stored in row-major order (the row index
+     * follows the \c v coordinate). An entry is \c true when the texture
+     * evaluates to zero everywhere inside the corresponding cell, regardless
+     * of the wavelength. Textures that cannot guarantee this return an empty
+     * vector, which is what the default implementation does.
+     */
+    virtual std::vector<bool> zero_mask() const;
+
     /**
      * \brief Returns the resolution of the spectrum in nanometers (if discretized)
      *
@@ -220,6 +233,39 @@ public:
     /// standard D65 illuminant
     static ref<Texture> D65(ref<Texture> texture);
 
+    /**
+     * \brief Convenience function to merge the textures of several BSDF
+     * instances (see \ref BSDF::merge())
+     *
+     * The resulting texture evaluates <tt>textures[i]</tt> on shapes whose
+     * \ref Shape::bsdf_index() is equal to \c i. Returns \c nullptr unless
+     * all textures share a non-empty \ref merge_key(), or in spectral
+     * variants.
+     */
+    static ref<Texture> merge(const std::vector<ref<Texture>> &textures);
+
+    /**
+     * \brief Return a key that identifies the configuration of this texture
+     * which cannot vary between merged instances
+     *
+     * Textures with an identical (non-empty) key can be merged using \ref
+     * merge_instances(). The default implementation returns \c "constant"
+     * for textures that aren't spatially varying and an empty string
+     * otherwise.
+     */
+    virtual std::string merge_key() const;
+
+    /**
+     * \brief Merge several instances of this texture into a single one
+     *
+     * All instances must share the \ref merge_key() of this texture. The
+     * default implementation stores the values of constant textures in a
+     * per-instance buffer (see the \c merged plugin). Returns \c nullptr
+     * when merging isn't possible.
+     */
+    virtual ref<Texture>
+    merge_instances(const std::vector<ref<Texture>> &textures) const;
+
     /// Return a string identifier
     std::string id() const override { return m_id; }
 
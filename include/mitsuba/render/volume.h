@@ -60,9 +60,47 @@ public:
      */
     virtual void max_per_channel(ScalarFloat *out) const;
 
+    /**
+     * \brief Computes the maximum value of the volume (over all channels)
+     * within every cell of a coarse grid of the given resolution, which
+     * subdivides the <tt>[0, 1]^3</tt> domain of the volume.
+     *
+     * The values are stored in z-major order and are conservative, i.e. they
+     * bound any value obtained by interpolating within a cell. The default
+     * implementation fills every cell with \ref max().
+     *
+     * Pointer allocation/deallocation must be performed by the caller.
+     */
+    virtual void max_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const;
+
+    /**
+     * \brief Counterpart of \ref max_per_cell() that computes conservative
+     * lower bounds. The default implementation fills every cell with zero.
+     */
+    virtual void min_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const;
+
+    /**
+     * \brief Per-channel variant of \ref max_per_cell(), which stores
+     * <tt>max(channel_count(), 1)</tt> consecutive values for every cell.
+     *
+     * The default implementation replicates the values of \ref max_per_cell()
+     * across the channels.
+     *
+     * Pointer allocation/deallocation must be performed by the caller.
+     */
+    virtual void max_per_cell_per_channel(const ScalarVector3i &cells,
+                                          ScalarFloat *out) const;
+
+    /// Per-channel variant of \ref min_per_cell(), see \ref max_per_cell_per_channel()
+    virtual void min_per_cell_per_channel(const ScalarVector3i &cells,
+                                          ScalarFloat *out) const;
+
     /// Returns the bounding box of the volume
     ScalarBoundingBox3f bbox() const { return m_bbox; }
 
+    /// Returns the transformation from world coordinates to local coordinates
+    const ScalarTransform4f &to_local() const { return m_to_local; }
+
     /**
      * \brief Returns the resolution of the volume, assuming that it is based
      * on a discrete representation.
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/bbox.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/transform.h>
@@ -86,21 +87,54 @@ public:
     /// Return the volume grid size in bytes (excluding metadata)
     size_t buffer_size() const { return dr::prod(m_size) * bytes_per_voxel(); }
 
+    /**
+     * \brief Return the resolution of the bricks whose value bounds are
+     * known, or zero if no bounds are available
+     *
+     * Files in the chunked format store these bounds in their header. For
+     * other grids, they can be computed using \ref compute_brick_bounds().
+     */
+    uint32_t brick_size() const { return m_brick_size; }
+
+    /// Return the number of bricks along each axis
+    ScalarVector3u brick_count() const;
+
+    /// Return the minimum (over all channels) of every brick, in z-major order
+    const std::vector<ScalarFloat> &brick_min() const { return m_brick_min; }
+
+    /// Return the maximum (over all channels) of every brick, in z-major order
+    const std::vector<ScalarFloat> &brick_max() const { return m_brick_max; }
+
+    /// Compute the value bounds of all bricks of the given resolution
+    void compute_brick_bounds(uint32_t brick_size);
+
     /**
      * Write an encoded form of the bitmap to a binary volume file
      *
      * \param path
      *    Target file name (expected to end in ".vol")
+     *
+     * \param brick_size
+     *    When nonzero, the voxels are written in the chunked format (version
+     *    4), which compresses bricks of the given resolution independently
+     *    and stores their value bounds. Otherwise, the dense format (version
+     *    3) is used.
      */
-    void write(const fs::path &path) const;
+    void write(const fs::path &path, uint32_t brick_size = 0) const;
 
     /**
      * Write an encoded form of the volume grid to a stream
      *
      * \param stream
      *    Target stream that will receive the encoded output
+     *
+     * \param brick_size
+     *    When nonzero, the voxels are written in the chunked format (version
+     *    4), which compresses bricks of the given resolution independently
+     *    and stores their value bounds. Otherwise, the dense format (version
+     *    3) is used.
      */
-    void write(Stream *stream) const;
+    void write(Stream *stream, uint32_t brick_size = 0) const;
 
     /// Return a human-readable summary of this volume grid
     virtual std::string to_string() const override;
@@ -110,6 +144,9 @@ public:
 protected:
     void read(Stream *stream);
 
+    /// Compute the (per-channel) maximum of the voxels
+    void update_max();
+
 protected:
     std::unique_ptr<ScalarFloat[]> m_data;
 
@@ -118,6 +155,9 @@ protected:
     ScalarBoundingBox3f m_bbox;
     ScalarFloat m_max;
     std::vector<ScalarFloat> m_max_per_channel;
+    uint32_t m_brick_size = 0;
+    std::vector<ScalarFloat> m_brick_min, m_brick_max;
+    MemoryRecord m_memory { MemoryCategory::Volume };
 };
 
 MI_EXTERN_CLASS(VolumeGrid)
@@ -147,6 +147,16 @@ if __name__ == '__main__':
         if platform.system() == 'Darwin' and 'cuda' in name:
             continue
         item = configurations[name]
+        if 'Packet' in item['float']:
+            # The renderer assumes that 'Float' is either a scalar or a JIT
+            # array (virtual function calls, loops, texture lookups, ..)
+            raise ValueError('mitsuba.conf: configuration "%s" uses the '
+                             'unsupported packet type "%s". Use a scalar '
+                             'variant along with the batched ray tracing '
+                             'functions Scene::ray_test_batch() and '
+                             'Scene::ray_intersect_preliminary_batch() '
+                             '(which use Embree\'s packet traversal), or an '
+                             'LLVM variant instead.' % (name, item['float']))
         spectrum = item['spectrum'].replace('Float', item['float'])
         float_types.add(item['float'])
         enabled.append((name, item['float'], spectrum))
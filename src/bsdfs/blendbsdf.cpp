@@ -93,13 +93,7 @@ public:
         if (bsdf_index != 2)
             Throw("BlendBSDF: Two child BSDFs must be specified!");
 
-        m_components.clear();
-        for (size_t i = 0; i < 2; ++i)
-            for (size_t j = 0; j < m_nested_bsdf[i]->component_count(); ++j)
-                m_components.push_back(m_nested_bsdf[i]->flags(j));
-
-        m_flags = m_nested_bsdf[0]->flags() | m_nested_bsdf[1]->flags();
-        dr::set_attr(this, "flags", m_flags);
+        update_components();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -213,6 +207,59 @@ public:
                  pdf_0 * (1 - weight) + pdf_1 * weight };
     }
 
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                    const Vector3f &wo, Float sample1, const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        if (unlikely(ctx.component != (uint32_t) -1))
+            return Base::eval_pdf_sample(ctx, si, wo, sample1, sample2, active);
+
+        /* Both nested BSDFs must be evaluated anyways, hence each of them
+           also produces a sample for the lanes that select it. This halves
+           the number of nested calls compared to separate queries. */
+        Float weight = eval_weight(si, active);
+
+        Mask m0 = active && sample1 >  weight,
+             m1 = active && sample1 <= weight;
+
+        auto [val_0, pdf_0, bs_0, bsdf_weight_0] = m_nested_bsdf[0]->eval_pdf_sample(
+            ctx, si, wo, dr::select(m0, (sample1 - weight) / (1 - weight), 0.f),
+            sample2, active);
+        auto [val_1, pdf_1, bs_1, bsdf_weight_1] = m_nested_bsdf[1]->eval_pdf_sample(
+            ctx, si, wo, dr::select(m1, sample1 / weight, 0.f), sample2, active);
+
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+        Spectrum bsdf_weight(0.f);
+        dr::masked(bs, m0) = bs_0;
+        dr::masked(bsdf_weight, m0) = bsdf_weight_0;
+        dr::masked(bs, m1) = bs_1;
+        dr::masked(bsdf_weight, m1) = bsdf_weight_1;
+
+        return { val_0 * (1 - weight) + val_1 * weight,
+                 pdf_0 * (1 - weight) + pdf_1 * weight, bs, bsdf_weight };
+    }
+
+    ref<Base> flatten() override {
+        for (size_t i = 0; i < 2; ++i)
+            m_nested_bsdf[i] = m_nested_bsdf[i]->flatten();
+        update_components();
+
+        if (m_nested_bsdf[0] == m_nested_bsdf[1])
+            return m_nested_bsdf[0];
+
+        // Blends with a constant weight of zero or one select a single BSDF
+        if (!m_weight->is_spatially_varying()) {
+            if (m_weight->max() <= 0.f)
+                return m_nested_bsdf[0];
+            if (dr::all(m_weight->mean() >= 1.f))
+                return m_nested_bsdf[1];
+        }
+
+        return this;
+    }
+
     MI_INLINE Float eval_weight(const SurfaceInteraction3f &si, const Mask &active) const {
         return dr::clamp(m_weight->eval_1(si, active), 0.f, 1.f);
     }
@@ -236,6 +283,16 @@ public:
 
     MI_DECLARE_CLASS()
 protected:
+    void update_components() {
+        m_components.clear();
+        for (size_t i = 0; i < 2; ++i)
+            for (size_t j = 0; j < m_nested_bsdf[i]->component_count(); ++j)
+                m_components.push_back(m_nested_bsdf[i]->flags(j));
+
+        m_flags = m_nested_bsdf[0]->flags() | m_nested_bsdf[1]->flags();
+        dr::set_attr(this, "flags", m_flags);
+    }
+
     ref<Texture> m_weight;
     ref<Base> m_nested_bsdf[2];
 };
@@ -40,6 +40,12 @@ cause changes to the shading frame.
 
 Note that the magnitude of the height field variations influences the scale of the displacement.
 
+The gradient of the height field is obtained from a single analytic evaluation of the texture
+(see ``Texture::eval_1_grad()``). On triangle meshes, the perturbation is applied along the
+tangents :math:`\partial p/\partial u` and :math:`\partial p/\partial v`, which are discontinuous
+across faces by default. Setting the ``tangents`` parameter of the mesh to |true| precomputes
+smooth per-vertex tangent frames that avoid faceting artifacts.
+
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/bsdf_bumpmap_without.jpg
    :caption: Roughplastic BSDF
@@ -107,12 +113,7 @@ public:
 
         m_scale = props.get<ScalarFloat>("scale", 1.f);
 
-        // Add all nested components
-        m_components.clear();
-        for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
-            m_components.push_back(m_nested_bsdf->flags(i));
-        m_flags = m_nested_bsdf->flags();
-        dr::set_attr(this, "flags", m_flags);
+        update_components();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -196,6 +197,40 @@ public:
         return { value & active, dr::select(active, pdf, 0.f) };
     }
 
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                    const Vector3f &wo, Float sample1, const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        // The perturbed shading frame is shared by both queries
+        SurfaceInteraction3f perturbed_si(si);
+        perturbed_si.sh_frame = frame(si, active);
+        perturbed_si.wi       = perturbed_si.to_local(si.wi);
+        Vector3f perturbed_wo = perturbed_si.to_local(wo);
+
+        auto [value, pdf, bs, weight] = m_nested_bsdf->eval_pdf_sample(
+            ctx, perturbed_si, perturbed_wo, sample1, sample2, active);
+
+        Mask active_e = active && Frame3f::cos_theta(wo) *
+                                  Frame3f::cos_theta(perturbed_wo) > 0.f;
+
+        // Transform sampled 'wo' back to original frame and check orientation
+        Vector3f sampled_wo = perturbed_si.to_world(bs.wo);
+        Mask active_s = active && dr::any(dr::neq(unpolarized_spectrum(weight), 0.f)) &&
+                        Frame3f::cos_theta(bs.wo) * Frame3f::cos_theta(sampled_wo) > 0.f;
+        bs.wo = sampled_wo;
+
+        return { value & active_e, dr::select(active_e, pdf, 0.f), bs,
+                 weight & active_s };
+    }
+
+    ref<Base> flatten() override {
+        m_nested_bsdf = m_nested_bsdf->flatten();
+        update_components();
+        return this;
+    }
+
     Frame3f frame(const SurfaceInteraction3f &si, Mask active) const {
         // Evaluate texture gradient
         Vector2f grad_uv = m_scale * m_nested_texture->eval_1_grad(si, active);
@@ -214,8 +249,9 @@ public:
         // Convert to small rotation from original shading frame
         result.n = si.to_local(result.n);
 
-        // Gram-schmidt orthogonalization to compute local shading frame
-        result.s = dr::normalize(dr::fnmadd(result.n, dr::dot(result.n, si.dp_du), si.dp_du));
+        /* Gram-schmidt orthogonalization to compute local shading frame. The
+           tangent corresponds to the first axis of the original frame. */
+        result.s = dr::normalize(dr::fnmadd(result.n, result.n.x(), Vector3f(1.f, 0.f, 0.f)));
         result.t = dr::cross(result.n, result.s);
 
         return result;
@@ -226,6 +262,11 @@ public:
         return m_nested_bsdf->eval_diffuse_reflectance(si, active);
     }
 
+    uint32_t ray_flags() const override {
+        // The height field is differentiated along the position partials
+        return Base::ray_flags() | RayFlags::UV | RayFlags::dPdUV;
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "BumpMap[" << std::endl
@@ -238,6 +279,15 @@ public:
 
     MI_DECLARE_CLASS()
 protected:
+    void update_components() {
+        // Add all nested components
+        m_components.clear();
+        for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
+            m_components.push_back(m_nested_bsdf->flags(i));
+        m_flags = m_nested_bsdf->flags();
+        dr::set_attr(this, "flags", m_flags);
+    }
+
     ScalarFloat m_scale;
     ref<Texture> m_nested_texture;
     ref<Base> m_nested_bsdf;
@@ -23,6 +23,11 @@ Smooth dielectric material (:monosp:`dielectric`)
    - |float| or |string|
    - Exterior index of refraction specified numerically or using a known material name.  (Default: air / 1.000277)
 
+ * - abbe_number
+   - |float|
+   - Abbe number of the interior material, which enables dispersion in spectral variants
+     when positive. (Default: 0, i.e. no dispersion)
+
  * - specular_reflectance
    - |spectrum| or |texture|
    - Optional factor that can be used to modulate the specular reflection component. Note that for physical realism, this parameter should never be touched. (Default: 1.0)
@@ -130,9 +135,17 @@ In *polarized* rendering modes, the material automatically switches to a polariz
 implementation of the underlying Fresnel equations that quantify the reflectance and
 transmission.
 
-.. note::
-
-    Dispersion is currently unsupported but will be enabled in a future release.
+In *spectral* rendering modes, a positive ``abbe_number`` :math:`V_d` makes the
+interior index of refraction depend on the wavelength following Cauchy's
+equation :math:`n(\lambda) = A + B/\lambda^2`, where the coefficients are chosen
+so that ``int_ior`` is attained at the Fraunhofer d line (587.6 nm) and
+:math:`V_d = (n_d - 1) / (n_F - n_C)`. Typical crown glasses (e.g. BK7) have an
+Abbe number of about 64, and flint glasses go down to about 30. Since
+every wavelength would refract into a different direction, a path that
+interacts with a dispersive interface only keeps following its first (*hero*)
+wavelength and terminates the others, whose contribution is transferred to
+the hero wavelength so that the estimate remains unbiased
+:cite:`Wilkie2014Hero`. Dispersion is ignored in RGB and monochromatic modes.
 
 Instead of specifying numerical values for the indices of refraction, Mitsuba 3
 comes with a list of presets that can be specified with the :paramtype:`material`
@@ -225,6 +238,22 @@ public:
 
         m_eta = int_ior / ext_ior;
 
+        /* Cauchy coefficient B (in nm^2) of the relative index of refraction
+           such that 'abbe_number' = (n_d - 1) / (n_F - n_C) */
+        ScalarFloat abbe_number = props.get<ScalarFloat>("abbe_number", 0.f);
+        if (abbe_number < 0)
+            Throw("The Abbe number must be positive!");
+        m_cauchy_b = 0.f;
+        if (abbe_number > 0) {
+            if constexpr (is_spectral_v<Spectrum>)
+                m_cauchy_b = (int_ior - 1.f) /
+                             (abbe_number * ext_ior *
+                              (1.f / dr::sqr(486.1f) - 1.f / dr::sqr(656.3f)));
+            else
+                Log(Warn, "Dispersion (\"abbe_number\") is only supported "
+                          "in spectral variants and will be ignored.");
+        }
+
         if (props.has_property("specular_reflectance"))
             m_specular_reflectance   = props.texture<Texture>("specular_reflectance", 1.f);
         if (props.has_property("specular_transmittance"))
@@ -260,7 +289,8 @@ public:
         // Evaluate the Fresnel equations for unpolarized illumination
         Float cos_theta_i = Frame3f::cos_theta(si.wi);
 
-        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, Float(m_eta));
+        Float eta = eval_eta(si);
+        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, eta);
         Float t_i = 1.f - r_i;
 
         // Lobe selection
@@ -306,8 +336,8 @@ public:
 
             /* BSDF weights are Mueller matrices now. */
             Float cos_theta_o_hat = Frame3f::cos_theta(wo_hat);
-            Spectrum R = mueller::specular_reflection(UnpolarizedSpectrum(cos_theta_o_hat), UnpolarizedSpectrum(m_eta)),
-                     T = mueller::specular_transmission(UnpolarizedSpectrum(cos_theta_o_hat), UnpolarizedSpectrum(m_eta));
+            Spectrum R = mueller::specular_reflection(UnpolarizedSpectrum(cos_theta_o_hat), UnpolarizedSpectrum(eta)),
+                     T = mueller::specular_transmission(UnpolarizedSpectrum(cos_theta_o_hat), UnpolarizedSpectrum(eta));
 
             if (likely(has_reflection && has_transmission)) {
                 weight = dr::select(selected_r, R, T) / bs.pdf;
@@ -362,6 +392,20 @@ public:
             weight[selected_t] *= dr::sqr(factor);
         }
 
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (m_cauchy_b != 0.f) {
+                /* The directions above are only valid for the hero wavelength:
+                   terminate the other wavelengths and transfer their share of
+                   the (averaged) estimate to the hero wavelength */
+                UnpolarizedSpectrum hero(0.f);
+                hero[0] = (ScalarFloat) dr::array_size_v<UnpolarizedSpectrum>;
+                if constexpr (is_polarized_v<Spectrum>)
+                    weight *= mueller::absorber(hero);
+                else
+                    weight *= hero;
+            }
+        }
+
         return { bs, weight & active };
     }
 
@@ -370,6 +414,17 @@ public:
         return 0.f;
     }
 
+    /// Relative index of refraction at the hero wavelength of \c si
+    Float eval_eta(const SurfaceInteraction3f &si) const {
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (m_cauchy_b != 0.f)
+                return m_eta + m_cauchy_b * (dr::rcp(dr::sqr(si.wavelengths[0])) -
+                                             1.f / dr::sqr(587.6f));
+        }
+        DRJIT_MARK_USED(si);
+        return m_eta;
+    }
+
     Float pdf(const BSDFContext & /* ctx */, const SurfaceInteraction3f & /* si */,
               const Vector3f & /* wo */, Mask /* active */) const override {
         return 0.f;
@@ -382,14 +437,17 @@ public:
             oss << "  specular_reflectance = " << string::indent(m_specular_reflectance) << "," << std::endl;
         if (m_specular_transmittance)
             oss << "  specular_transmittance = " << string::indent(m_specular_transmittance) << ", " << std::endl;
-        oss << "  eta = " << m_eta << "," << std::endl
-            << "]";
+        oss << "  eta = " << m_eta << "," << std::endl;
+        if (m_cauchy_b != 0.f)
+            oss << "  cauchy_b = " << m_cauchy_b << "," << std::endl;
+        oss << "]";
         return oss.str();
     }
 
     MI_DECLARE_CLASS()
 private:
     ScalarFloat m_eta;
+    ScalarFloat m_cauchy_b;
     ref<Texture> m_specular_reflectance;
     ref<Texture> m_specular_transmittance;
 };
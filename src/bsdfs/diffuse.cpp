@@ -184,6 +184,26 @@ public:
         return m_reflectance->eval(si, active);
     }
 
+    std::string merge_key() const override {
+        std::string key = m_reflectance->merge_key();
+        return key.empty() ? "" : "diffuse:" + key;
+    }
+
+    ref<Base> merge(const std::vector<ref<Base>> &instances) const override {
+        std::vector<ref<Texture>> reflectance;
+        for (const auto &bsdf : instances)
+            reflectance.push_back(static_cast<const SmoothDiffuse *>(bsdf.get())->m_reflectance);
+
+        ref<Texture> texture = Texture::merge(reflectance);
+        if (!texture)
+            return nullptr;
+
+        ref<SmoothDiffuse> merged = new SmoothDiffuse(*this);
+        merged->m_reflectance = texture;
+        dr::set_attr(merged.get(), "flags", m_flags);
+        return merged.get();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "SmoothDiffuse[" << std::endl
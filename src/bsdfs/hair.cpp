@@ -0,0 +1,592 @@
+#include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/fresnel.h>
+#include <mitsuba/render/texture.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _bsdf-hair:
+
+Hair material (:monosp:`hair`)
+------------------------------
+
+.. pluginparameters::
+ :extra-rows: 2
+
+ * - eumelanin, pheomelanin
+   - |float|
+   - Concentrations of the two pigments that determine the absorption
+     coefficient of the fiber. (Default: 1.3 and 0.2, i.e. brown hair)
+
+ * - sigma_a
+   - |spectrum| or |texture|
+   - Absorption coefficient of the fiber interior in inverse units of the
+     fiber radius. Can't be combined with the pigment concentrations.
+   - |exposed|, |differentiable|
+
+ * - eta
+   - |float|
+   - Index of refraction of the fiber. (Default: 1.55)
+
+ * - beta_m
+   - |float|
+   - Longitudinal roughness in the range (0, 1]. (Default: 0.3)
+
+ * - beta_n
+   - |float|
+   - Azimuthal roughness in the range (0, 1]. (Default: 0.3)
+
+ * - alpha
+   - |float|
+   - Tilt angle of the cuticle scales in degrees. (Default: 2)
+
+This plugin implements the hair and fur scattering model by Chiang et al.
+:cite:`Chiang2016Practical`, which builds on the energy-conserving
+parameterization of d'Eon et al. :cite:`dEon2011Energy`. Light scattered by
+the fiber is separated into lobes that are reflected at the cuticle (R),
+transmitted through the fiber (TT), and reflected once (TRT) or more often
+(TRRT+) inside of it. Each lobe is the product of a longitudinal term, which
+depends on the elevation angles relative to the fiber axis, an azimuthal
+term, which depends on the azimuthal angle around the axis and the offset of
+the intersection from the center of the fiber, and an attenuation term that
+accounts for Fresnel reflection and absorption.
+
+The material must be applied to a curve shape (:ref:`bsplinecurve
+<shape-bsplinecurve>` or :ref:`linearcurve <shape-linearcurve>`), which
+provides the fiber axis as the bitangent of the shading frame. Compared to
+an approximation of the fiber using a rough dielectric, the model accounts for
+the light that travels through the fiber with a single scattering event,
+hence it converges with far shorter paths.
+
+The longitudinal and azimuthal terms of each lobe are tabulated at loading
+time and importance sampled using ``Marginal2D`` interpolants conditioned on
+the elevation of the incident direction, while the lobe is chosen based on its
+attenuation. The tables only depend on the roughness
+parameters and are shared by all instances of the material that use the same
+values. The BSDF itself is evaluated analytically, hence the tabulation only
+affects the variance and not the expected value of a rendering.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: hair
+
+        <bsdf type="hair">
+            <float name="eumelanin" value="0.3"/>
+            <float name="pheomelanin" value="0.8"/>
+            <float name="beta_m" value="0.25"/>
+        </bsdf>
+
+    .. code-tab:: python
+
+        'type': 'hair',
+        'eumelanin': 0.3,
+        'pheomelanin': 0.8,
+        'beta_m': 0.25
+*/
+
+template <typename Float, typename Spectrum>
+class Hair final : public BSDF<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(BSDF, m_flags, m_components)
+    MI_IMPORT_TYPES(Texture)
+
+    using Warp2D1 = Marginal2D<Float, 1, true>;
+
+    /// Number of lobes (R, TT, TRT and TRRT+)
+    static constexpr uint32_t LobeCount = 4;
+
+    /// Resolution of the tables in the longitudinal and azimuthal dimension
+    static constexpr uint32_t TableResTheta = 65, TableResPhi = 65;
+
+    /// Number of tabulated elevations of the incident direction
+    static constexpr uint32_t TableResParam = 33;
+
+    /// Sampling tables of the longitudinal and azimuthal term of each lobe
+    struct Tables {
+        Warp2D1 lobes[LobeCount];
+    };
+
+    Hair(const Properties &props) : Base(props) {
+        if (props.has_property("sigma_a")) {
+            if (props.has_property("eumelanin") || props.has_property("pheomelanin"))
+                Throw("Only one of \"sigma_a\" and \"eumelanin\"/\"pheomelanin\" "
+                      "can be specified!");
+            m_sigma_a = props.texture<Texture>("sigma_a");
+        } else {
+            ScalarFloat eumelanin   = props.get<ScalarFloat>("eumelanin", 1.3f),
+                        pheomelanin = props.get<ScalarFloat>("pheomelanin", 0.2f);
+            if (eumelanin < 0.f || pheomelanin < 0.f)
+                Throw("The pigment concentrations must be non-negative!");
+            set_melanin_absorption(eumelanin, pheomelanin);
+        }
+
+        m_eta = props.get<ScalarFloat>("eta", 1.55f);
+        if (m_eta <= 1.f)
+            Throw("The index of refraction must be greater than one!");
+
+        m_beta_m = props.get<ScalarFloat>("beta_m", 0.3f);
+        m_beta_n = props.get<ScalarFloat>("beta_n", 0.3f);
+        m_alpha  = props.get<ScalarFloat>("alpha", 2.f);
+        if (!(m_beta_m > 0.f && m_beta_m <= 1.f && m_beta_n > 0.f && m_beta_n <= 1.f))
+            Throw("The roughness parameters must be in the range (0, 1]!");
+
+        // Longitudinal variance of the lobes
+        m_v[0] = dr::sqr(0.726f * m_beta_m + 0.812f * dr::sqr(m_beta_m) +
+                         3.7f * dr::pow(m_beta_m, 20.f));
+        m_v[1] = .25f * m_v[0];
+        m_v[2] = m_v[3] = 4.f * m_v[0];
+
+        // Logistic scale factor of the azimuthal term
+        m_s = dr::sqrt(dr::Pi<ScalarFloat> / 8.f) *
+              (0.265f * m_beta_n + 1.194f * dr::sqr(m_beta_n) +
+               5.372f * dr::pow(m_beta_n, 22.f));
+        m_logistic_norm = 1.f / (logistic_cdf(dr::Pi<ScalarFloat>, m_s) -
+                                 logistic_cdf(-dr::Pi<ScalarFloat>, m_s));
+
+        // Tilt of the lobes by 2^k times the cuticle angle
+        m_sin_2k_alpha[0] = dr::sin(dr::deg_to_rad(m_alpha));
+        m_cos_2k_alpha[0] = dr::safe_sqrt(1.f - dr::sqr(m_sin_2k_alpha[0]));
+        for (size_t k = 1; k < 3; ++k) {
+            m_sin_2k_alpha[k] = 2.f * m_cos_2k_alpha[k - 1] * m_sin_2k_alpha[k - 1];
+            m_cos_2k_alpha[k] = dr::sqr(m_cos_2k_alpha[k - 1]) -
+                                dr::sqr(m_sin_2k_alpha[k - 1]);
+        }
+
+        m_tables = load_tables();
+
+        m_components.push_back(BSDFFlags::GlossyReflection | BSDFFlags::FrontSide |
+                               BSDFFlags::BackSide | BSDFFlags::Anisotropic);
+        m_components.push_back(BSDFFlags::GlossyTransmission | BSDFFlags::FrontSide |
+                               BSDFFlags::BackSide | BSDFFlags::Anisotropic);
+        m_flags = m_components[0] | m_components[1];
+        dr::set_attr(this, "flags", m_flags);
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        callback->put_object("sigma_a", m_sigma_a.get(), +ParamFlags::Differentiable);
+    }
+
+    std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
+                                             const SurfaceInteraction3f &si,
+                                             Float sample1,
+                                             const Point2f &sample2,
+                                             Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+
+        bool has_reflection   = ctx.is_enabled(BSDFFlags::GlossyReflection, 0),
+             has_transmission = ctx.is_enabled(BSDFFlags::GlossyTransmission, 1);
+
+        if (unlikely((!has_reflection && !has_transmission) ||
+                     dr::none_or<false>(active)))
+            return { bs, 0.f };
+
+        FiberGeometry g = geometry(si.wi);
+        auto [weights, attenuation] = lobe_weights(si, g, active);
+
+        // Choose a lobe proportionally to its attenuation
+        UInt32 lobe = LobeCount - 1;
+        Float cdf = weights[0] + weights[1] + weights[2];
+        for (int p = (int) LobeCount - 2; p >= 0; --p) {
+            lobe = dr::select(sample1 < cdf, (uint32_t) p, lobe);
+            cdf -= weights[p];
+        }
+
+        // Sample the longitudinal and azimuthal term of the chosen lobe
+        Point2f u = dr::zeros<Point2f>();
+        for (uint32_t p = 0; p < LobeCount; ++p) {
+            Mask active_p = active && dr::eq(lobe, p);
+            if (dr::none_or<false>(active_p))
+                continue;
+            Point2f u_p =
+                m_tables->lobes[p].sample(sample2, &g.sin_theta_o, active_p).first;
+            u = dr::select(active_p, u_p, u);
+        }
+
+        Float sin_theta_i = dr::fmsub(2.f, u.x(), 1.f),
+              cos_theta_i = dr::safe_sqrt(1.f - dr::sqr(sin_theta_i)),
+              phi_i = g.phi_o + dr::fmsub(2.f, u.y(), 1.f) * dr::Pi<Float>;
+
+        /* The tables of the R, TT and TRT lobes store the azimuthal term
+           relative to the direction of perfect specular scattering */
+        Float lobe_f = Float(lobe);
+        phi_i += dr::select(dr::neq(lobe, LobeCount - 1),
+                            lobe_phi(lobe_f, g.gamma_o, g.gamma_t), 0.f);
+
+        auto [sin_phi_i, cos_phi_i] = dr::sincos(phi_i);
+        bs.wo = Vector3f(sin_phi_i * cos_theta_i, sin_theta_i,
+                         cos_phi_i * cos_theta_i);
+
+        Mask reflect = Frame3f::cos_theta(si.wi) * Frame3f::cos_theta(bs.wo) > 0.f;
+        active &= (reflect && has_reflection) || (!reflect && has_transmission);
+
+        auto [value, pdf] = eval_pdf_impl(g, attenuation, weights, bs.wo);
+
+        bs.pdf = pdf;
+        bs.eta = 1.f;
+        bs.sampled_type = dr::select(reflect, UInt32(+BSDFFlags::GlossyReflection),
+                                     UInt32(+BSDFFlags::GlossyTransmission));
+        bs.sampled_component = dr::select(reflect, UInt32(0), UInt32(1));
+
+        active &= pdf > 0.f;
+        return { bs, (depolarizer<Spectrum>(value) / pdf) & active };
+    }
+
+    Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                  const Vector3f &wo, Mask active) const override {
+        return eval_pdf(ctx, si, wo, active).first;
+    }
+
+    Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+              const Vector3f &wo, Mask active) const override {
+        return eval_pdf(ctx, si, wo, active).second;
+    }
+
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        bool has_reflection   = ctx.is_enabled(BSDFFlags::GlossyReflection, 0),
+             has_transmission = ctx.is_enabled(BSDFFlags::GlossyTransmission, 1);
+
+        if (unlikely((!has_reflection && !has_transmission) ||
+                     dr::none_or<false>(active)))
+            return { 0.f, 0.f };
+
+        Mask reflect = Frame3f::cos_theta(si.wi) * Frame3f::cos_theta(wo) > 0.f;
+        active &= (reflect && has_reflection) || (!reflect && has_transmission);
+
+        FiberGeometry g = geometry(si.wi);
+        auto [weights, attenuation] = lobe_weights(si, g, active);
+        auto [value, pdf] = eval_pdf_impl(g, attenuation, weights, wo);
+
+        return { depolarizer<Spectrum>(value) & active,
+                 dr::select(active, pdf, 0.f) };
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Hair[" << std::endl
+            << "  sigma_a = " << string::indent(m_sigma_a) << "," << std::endl
+            << "  eta = " << m_eta << "," << std::endl
+            << "  beta_m = " << m_beta_m << "," << std::endl
+            << "  beta_n = " << m_beta_n << "," << std::endl
+            << "  alpha = " << m_alpha << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Quantities that only depend on the incident direction
+    struct FiberGeometry {
+        Float sin_theta_o, cos_theta_o, phi_o;
+        /// Offset of the intersection from the fiber axis in [-1, 1]
+        Float h;
+        /// Azimuthal angle of the incident and refracted direction
+        Float gamma_o, gamma_t;
+        /// Length of the refracted path in units of the fiber radius
+        Float path_length;
+    };
+
+    /**
+     * \brief Compute the geometry of the fiber as seen from the incident
+     * direction. The fiber axis is the 'y' axis of the local frame, and the
+     * azimuthal angles are measured relative to the normal.
+     */
+    FiberGeometry geometry(const Vector3f &wi) const {
+        FiberGeometry g;
+        g.sin_theta_o = wi.y();
+        g.cos_theta_o = dr::safe_sqrt(1.f - dr::sqr(g.sin_theta_o));
+        g.phi_o = dr::atan2(wi.x(), wi.z());
+        g.h = dr::clamp(wi.x() * dr::rsqrt(dr::maximum(
+                  dr::sqr(wi.x()) + dr::sqr(wi.z()), 1e-12f)), -1.f, 1.f);
+        g.gamma_o = dr::safe_asin(g.h);
+
+        // Refraction into the fiber, using the modified index of refraction
+        Float sin_theta_t = g.sin_theta_o / m_eta,
+              cos_theta_t = dr::safe_sqrt(1.f - dr::sqr(sin_theta_t)),
+              eta_p = dr::safe_sqrt(dr::sqr(m_eta) - dr::sqr(g.sin_theta_o)) /
+                      dr::maximum(g.cos_theta_o, 1e-6f),
+              sin_gamma_t = g.h / eta_p,
+              cos_gamma_t = dr::safe_sqrt(1.f - dr::sqr(sin_gamma_t));
+
+        g.gamma_t = dr::safe_asin(sin_gamma_t);
+        g.path_length = 2.f * cos_gamma_t / cos_theta_t;
+        return g;
+    }
+
+    /// Return the lobe selection probabilities along with the attenuation of each lobe
+    std::pair<std::array<Float, LobeCount>, std::array<UnpolarizedSpectrum, LobeCount>>
+    lobe_weights(const SurfaceInteraction3f &si, const FiberGeometry &g,
+                 Mask active) const {
+        UnpolarizedSpectrum transmittance =
+            dr::exp(-m_sigma_a->eval(si, active) * (m_sigma_a_scale * g.path_length));
+
+        Float cos_theta = g.cos_theta_o * dr::safe_sqrt(1.f - dr::sqr(g.h)),
+              f = std::get<0>(fresnel(cos_theta, Float(m_eta)));
+
+        std::array<UnpolarizedSpectrum, LobeCount> attenuation;
+        attenuation[0] = f;
+        attenuation[1] = dr::sqr(1.f - f) * transmittance;
+        attenuation[2] = attenuation[1] * transmittance * f;
+        attenuation[3] = attenuation[2] * transmittance * f /
+                         dr::maximum(1.f - transmittance * f, 1e-6f);
+
+        std::array<Float, LobeCount> weights;
+        Float sum = 0.f;
+        for (uint32_t p = 0; p < LobeCount; ++p) {
+            weights[p] = dr::mean(attenuation[p]);
+            sum += weights[p];
+        }
+
+        Float inv_sum = dr::select(sum > 0.f, dr::rcp(sum), 0.f);
+        for (uint32_t p = 0; p < LobeCount; ++p)
+            weights[p] *= inv_sum;
+
+        return { weights, attenuation };
+    }
+
+    /// Evaluate the BSDF analytically and the sampling density using the tables
+    std::pair<UnpolarizedSpectrum, Float>
+    eval_pdf_impl(const FiberGeometry &g,
+                  const std::array<UnpolarizedSpectrum, LobeCount> &attenuation,
+                  const std::array<Float, LobeCount> &weights,
+                  const Vector3f &wo) const {
+        Float sin_theta_i = wo.y(),
+              cos_theta_i = dr::safe_sqrt(1.f - dr::sqr(sin_theta_i)),
+              phi = dr::atan2(wo.x(), wo.z()) - g.phi_o;
+
+        UnpolarizedSpectrum value(0.f);
+        Float pdf(0.f);
+        Point2f u(.5f * (sin_theta_i + 1.f), .5f);
+
+        for (uint32_t p = 0; p < LobeCount; ++p) {
+            auto [sin_theta_op, cos_theta_op] =
+                tilt(p, g.sin_theta_o, g.cos_theta_o);
+
+            Float mp = longitudinal(sin_theta_i, cos_theta_i, sin_theta_op,
+                                    cos_theta_op, m_v[p]);
+
+            Float np;
+            if (p < LobeCount - 1) {
+                Float dphi = wrap_angle(
+                    phi - lobe_phi(Float((float) p), g.gamma_o, g.gamma_t));
+                np = trimmed_logistic(dphi);
+                u.y() = .5f * (dphi * dr::InvPi<Float> + 1.f);
+            } else {
+                np = dr::InvTwoPi<Float>;
+                u.y() = .5f;
+            }
+
+            value += attenuation[p] * (mp * np);
+            pdf += weights[p] * m_tables->lobes[p].eval(u, &g.sin_theta_o);
+        }
+
+        // Density w.r.t. (sin(theta), phi) in [-1, 1] x [-pi, pi]
+        pdf *= dr::InvFourPi<Float>;
+
+        return { value, pdf };
+    }
+
+    /// Direction of the elevation angle of a lobe that is tilted by the cuticle scales
+    template <typename Value>
+    std::pair<Value, Value> tilt(uint32_t p, const Value &sin_theta_o,
+                                 const Value &cos_theta_o) const {
+        if (p == LobeCount - 1)
+            return { sin_theta_o, cos_theta_o };
+
+        // R: -2 alpha, TT: alpha, TRT: 4 alpha
+        ScalarFloat sin_a = m_sin_2k_alpha[p == 0 ? 1 : (p == 1 ? 0 : 2)],
+                    cos_a = m_cos_2k_alpha[p == 0 ? 1 : (p == 1 ? 0 : 2)];
+        if (p == 0)
+            sin_a = -sin_a;
+
+        return { sin_theta_o * cos_a + cos_theta_o * sin_a,
+                 dr::abs(cos_theta_o * cos_a - sin_theta_o * sin_a) };
+    }
+
+    /// Longitudinal scattering function with variance \c v
+    template <typename Value>
+    static Value longitudinal(const Value &sin_theta_i, const Value &cos_theta_i,
+                              const Value &sin_theta_o, const Value &cos_theta_o,
+                              ScalarFloat v) {
+        Value a = cos_theta_i * cos_theta_o / v,
+              b = sin_theta_i * sin_theta_o / v;
+
+        // The direct evaluation overflows for low roughness values
+        if (v <= .1f)
+            return dr::exp(log_bessel_i0(a) - b - 1.f / v + 0.6931f +
+                           dr::log(1.f / (2.f * v)));
+        else
+            return dr::exp(-b) * bessel_i0(a) / (dr::sinh(1.f / v) * 2.f * v);
+    }
+
+    /// Modified Bessel function of the first kind and order zero
+    template <typename Value> static Value bessel_i0(const Value &x) {
+        Value result = 0.f, x2i = 1.f, x2 = dr::sqr(x);
+        double fact = 1.0, pow4 = 1.0;
+        for (int i = 0; i < 10; ++i) {
+            if (i > 1)
+                fact *= i;
+            result += x2i * (ScalarFloat) (1.0 / (pow4 * fact * fact));
+            x2i *= x2;
+            pow4 *= 4.0;
+        }
+        return result;
+    }
+
+    /// Logarithm of \ref bessel_i0(), with an asymptotic expansion for large arguments
+    template <typename Value> static Value log_bessel_i0(const Value &x) {
+        return dr::select(x > 12.f,
+                          x + .5f * (-dr::log(dr::TwoPi<ScalarFloat>) -
+                                     dr::log(x) + dr::rcp(8.f * x)),
+                          dr::log(bessel_i0(x)));
+    }
+
+    /// Azimuthal direction of perfect specular scattering of lobe \c p
+    static Float lobe_phi(const Float &p, const Float &gamma_o, const Float &gamma_t) {
+        return 2.f * p * gamma_t - 2.f * gamma_o + p * dr::Pi<Float>;
+    }
+
+    /// Map an angle to the interval [-pi, pi]
+    template <typename Value> static Value wrap_angle(const Value &phi) {
+        return phi - dr::TwoPi<ScalarFloat> * dr::round(phi * dr::InvTwoPi<ScalarFloat>);
+    }
+
+    static ScalarFloat logistic_cdf(ScalarFloat x, ScalarFloat s) {
+        return 1.f / (1.f + dr::exp(-x / s));
+    }
+
+    /// Logistic distribution that is normalized over [-pi, pi]
+    template <typename Value> Value trimmed_logistic(const Value &x) const {
+        Value e = dr::exp(-dr::abs(x) / m_s);
+        return e * m_logistic_norm / (m_s * dr::sqr(1.f + e));
+    }
+
+    /// Set the absorption coefficient of a fiber with the given pigment concentrations
+    void set_melanin_absorption(ScalarFloat eumelanin, ScalarFloat pheomelanin) {
+        ScalarColor3f sigma_a =
+            eumelanin * ScalarColor3f(0.419f, 0.697f, 1.37f) +
+            pheomelanin * ScalarColor3f(0.187f, 0.4f, 1.05f);
+
+        Properties props;
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            props = Properties("uniform");
+            props.set_float("value", luminance(sigma_a));
+        } else {
+            // The spectral upsampling model is limited to values in [0, 1]
+            if constexpr (is_spectral_v<Spectrum>) {
+                m_sigma_a_scale = dr::maximum(dr::max(sigma_a), 1.f);
+                sigma_a /= m_sigma_a_scale;
+            }
+            props = Properties("srgb");
+            props.set_color("color", sigma_a);
+            props.set_bool("unbounded", true);
+        }
+
+        m_sigma_a = PluginManager::instance()->create_object<Texture>(props);
+    }
+
+    /**
+     * \brief Return the sampling tables for the roughness parameters of
+     * this material
+     *
+     * The tables are shared by all instances of the material that use the
+     * same parameters and are kept alive as long as one of them exists.
+     */
+    std::shared_ptr<Tables> load_tables() const {
+        static std::mutex cache_mutex;
+        static std::unordered_map<std::string, std::weak_ptr<Tables>> cache;
+
+        std::string key = tfm::format("%.9g %.9g %.9g", m_beta_m, m_beta_n, m_alpha);
+        std::lock_guard<std::mutex> guard(cache_mutex);
+
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            std::shared_ptr<Tables> tables = it->second.lock();
+            if (tables)
+                return tables;
+        }
+
+        std::shared_ptr<Tables> tables = build_tables();
+        cache[key] = tables;
+        return tables;
+    }
+
+    /**
+     * \brief Tabulate the longitudinal and azimuthal term of each lobe
+     *
+     * The tables are parameterized by (sin(theta_i), phi), which makes the
+     * density proportional to solid angle, and they are conditioned on
+     * sin(theta_o). The azimuthal term is stored relative to \ref lobe_phi(),
+     * which removes the dependence on the offset and index of refraction.
+     */
+    std::shared_ptr<Tables> build_tables() const {
+        auto tables = std::make_shared<Tables>();
+
+        std::unique_ptr<ScalarFloat[]> params(new ScalarFloat[TableResParam]);
+        for (uint32_t i = 0; i < TableResParam; ++i)
+            params[i] = 2.f * i / (TableResParam - 1) - 1.f;
+
+        for (uint32_t p = 0; p < LobeCount; ++p) {
+            // The azimuthal term of the TRRT+ lobe is uniform
+            uint32_t res_phi = p < LobeCount - 1 ? TableResPhi : 2;
+            std::unique_ptr<ScalarFloat[]> data(
+                new ScalarFloat[TableResParam * res_phi * TableResTheta]);
+            ScalarFloat *ptr = data.get();
+
+            for (uint32_t i = 0; i < TableResParam; ++i) {
+                ScalarFloat sin_theta_o = params[i],
+                            cos_theta_o = dr::safe_sqrt(1.f - dr::sqr(sin_theta_o));
+                auto [sin_theta_op, cos_theta_op] = tilt(p, sin_theta_o, cos_theta_o);
+
+                for (uint32_t y = 0; y < res_phi; ++y) {
+                    ScalarFloat phi = (2.f * y / (res_phi - 1) - 1.f) * dr::Pi<ScalarFloat>,
+                                np = p < LobeCount - 1 ? trimmed_logistic(phi)
+                                                       : dr::InvTwoPi<ScalarFloat>;
+
+                    for (uint32_t x = 0; x < TableResTheta; ++x) {
+                        ScalarFloat sin_theta_i = 2.f * x / (TableResTheta - 1) - 1.f,
+                                    cos_theta_i = dr::safe_sqrt(1.f - dr::sqr(sin_theta_i));
+                        *ptr++ = longitudinal(sin_theta_i, cos_theta_i, sin_theta_op,
+                                              cos_theta_op, m_v[p]) * np;
+                    }
+                }
+            }
+
+            tables->lobes[p] = Warp2D1(
+                data.get(), ScalarVector2u(TableResTheta, res_phi),
+                {{ TableResParam }}, {{ params.get() }}
+            );
+        }
+
+        return tables;
+    }
+
+    ref<Texture> m_sigma_a;
+    /// Scale factor of \ref m_sigma_a
+    ScalarFloat m_sigma_a_scale = 1.f;
+    ScalarFloat m_eta, m_beta_m, m_beta_n, m_alpha;
+    ScalarFloat m_v[LobeCount];
+    ScalarFloat m_s, m_logistic_norm;
+    ScalarFloat m_sin_2k_alpha[3], m_cos_2k_alpha[3];
+    std::shared_ptr<Tables> m_tables;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(Hair, BSDF)
+MI_EXPORT_PLUGIN(Hair, "Hair material")
+NAMESPACE_END(mitsuba)
@@ -40,6 +40,14 @@ Note that the standard :ref:`path tracer <integrator-path>` does not have a good
 but the (:ref:`volumetric path tracer <integrator-volpath>`) does. It may thus be preferable when rendering
 scenes that contain the :ref:`mask <bsdf-mask>` plugin, even if there is nothing *volumetric* in the scene.
 
+Mesh regions where a :ref:`bitmap <texture-bitmap>` opacity texture is exactly zero are skipped
+during ray traversal, so that rays don't need to be re-traced from every null interaction in these
+cutouts. In CPU variants using Embree, this happens for every hit, while the CUDA variants remove
+the triangles that lie entirely inside of such regions from the OptiX acceleration data structure.
+This requires the mesh to have texture coordinates and the bitmap to have no :monosp:`to_uv`
+transformation, mipmaps, tiles or compression. Partially transparent regions are still handled
+through null interactions.
+
 The following XML snippet describes a material configuration for a transparent leaf:
 
 .. tabs::
@@ -106,14 +114,7 @@ public:
         if (!m_nested_bsdf)
            Throw("Child BSDF not specified");
 
-        m_components.clear();
-        for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
-            m_components.push_back(m_nested_bsdf->flags(i));
-
-        // The "transmission" BSDF component is at the last index.
-        m_components.push_back(BSDFFlags::Null | BSDFFlags::FrontSide | BSDFFlags::BackSide);
-        m_flags = m_nested_bsdf->flags() | m_components.back();
-        dr::set_attr(this, "flags", m_flags);
+        update_components();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -210,6 +211,66 @@ public:
         return { value, pdf };
     }
 
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                    const Vector3f &wo, Float sample1, const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        uint32_t null_index      = (uint32_t) component_count() - 1;
+        bool sample_transmission = ctx.is_enabled(BSDFFlags::Null, null_index);
+        bool sample_nested       = ctx.component == (uint32_t) -1 || ctx.component < null_index;
+
+        Float opacity = eval_opacity(si, active),
+              sample_opacity = opacity;
+        if (sample_transmission != sample_nested)
+            sample_opacity = sample_transmission ? 1.f : 0.f;
+
+        // The nested BSDF is evaluated and sampled by a single call
+        Mask nested_mask = active && sample1 < sample_opacity;
+        auto [value, pdf, bs_nested, weight_nested] = m_nested_bsdf->eval_pdf_sample(
+            ctx, si, wo, dr::select(nested_mask, sample1 / sample_opacity, 0.f),
+            sample2, active);
+
+        value *= opacity;
+        if (!sample_nested)
+            pdf = 0.f;
+        if (sample_transmission)
+            pdf *= opacity;
+
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+        Spectrum weight(0.f);
+        if (likely(sample_transmission || sample_nested)) {
+            bs.wo                = -si.wi;
+            bs.eta               = 1.f;
+            bs.sampled_component = null_index;
+            bs.sampled_type      = +BSDFFlags::Null;
+            bs.pdf               = 1.f - sample_opacity;
+            weight               = 1.f;
+
+            dr::masked(bs, nested_mask) = bs_nested;
+            dr::masked(weight, nested_mask) = weight_nested;
+        }
+
+        return { value, pdf, bs, weight };
+    }
+
+    ref<Base> flatten() override {
+        m_nested_bsdf = m_nested_bsdf->flatten();
+        update_components();
+
+        // A fully opaque mask doesn't alter the nested BSDF
+        if (!m_opacity->is_spatially_varying() &&
+            dr::all(m_opacity->mean() >= 1.f))
+            return m_nested_bsdf;
+
+        return this;
+    }
+
+    const Texture *opacity_texture() const override {
+        return m_opacity.get();
+    }
+
     Spectrum eval_null_transmission(const SurfaceInteraction3f &si,
                                     Mask active) const override {
         Float opacity = eval_opacity(si, active);
@@ -236,6 +297,17 @@ public:
 
     MI_DECLARE_CLASS()
 private:
+    void update_components() {
+        m_components.clear();
+        for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
+            m_components.push_back(m_nested_bsdf->flags(i));
+
+        // The "transmission" BSDF component is at the last index.
+        m_components.push_back(BSDFFlags::Null | BSDFFlags::FrontSide | BSDFFlags::BackSide);
+        m_flags = m_nested_bsdf->flags() | m_components.back();
+        dr::set_attr(this, "flags", m_flags);
+    }
+
     ref<Texture> m_opacity;
     ref<Base> m_nested_bsdf;
 };
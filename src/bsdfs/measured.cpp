@@ -6,6 +6,9 @@
 #include <mitsuba/render/bsdf.h>
 #include <array>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 /// Set to 1 to fall back to cosine-weighted sampling (for debugging)
 #define MI_SAMPLE_DIFFUSE     0
@@ -49,6 +52,10 @@ cannot be reliably represented in RGB, as they are outside of the color gamut)
 .. subfigend::
    :label: fig-measured
 
+Instances of this plugin that load the same file share their interpolation
+tables, hence a measured material can be assigned to many objects without
+duplicating its data in memory.
+
 Note that this material is one-sided---that is, observed from the back side, it
 will be completely black. If this is undesirable, consider using the
 :ref:`twosided <bsdf-twosided>` BRDF adapter plugin. The following XML snippet
@@ -78,6 +85,18 @@ public:
     using Warp2D2 = Marginal2D<Float, 2, true>;
     using Warp2D3 = Marginal2D<Float, 3, true>;
 
+    /// Interpolants of a measured material
+    struct Tables {
+        Warp2D0 ndf;
+        Warp2D0 sigma;
+        Warp2D2 vndf;
+        Warp2D2 luminance;
+        Warp2D3 spectra;
+        bool isotropic;
+        bool jacobian;
+        int reduction = 0;
+    };
+
     Measured(const Properties &props) : Base(props) {
         m_components.push_back(BSDFFlags::GlossyReflection | BSDFFlags::FrontSide);
         m_flags = m_components[0];
@@ -87,7 +106,41 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name             = file_path.filename().string();
 
+        m_tables    = load_tables(file_path);
+        m_isotropic = m_tables->isotropic;
+        m_jacobian  = m_tables->jacobian;
+        m_reduction = m_tables->reduction;
+    }
+
+    /**
+     * \brief Return the interpolants of the given file
+     *
+     * The tables are shared by all instances of the material that load the
+     * same file and are kept alive as long as one of them exists.
+     */
+    static std::shared_ptr<Tables> load_tables(const fs::path &file_path) {
+        static std::mutex cache_mutex;
+        static std::unordered_map<std::string, std::weak_ptr<Tables>> cache;
+
+        std::string key = fs::absolute(file_path).string();
+        std::lock_guard<std::mutex> guard(cache_mutex);
+
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            std::shared_ptr<Tables> tables = it->second.lock();
+            if (tables)
+                return tables;
+        }
+
+        std::shared_ptr<Tables> tables = read_tables(file_path);
+        cache[key] = tables;
+        return tables;
+    }
+
+    /// Read the interpolants of a measured material from the given file
+    static std::shared_ptr<Tables> read_tables(const fs::path &file_path) {
         ref<TensorFile> tf = new TensorFile(file_path);
+        auto tables = std::make_shared<Tables>();
         using Field = TensorFile::Field;
 
         const Field &theta_i       = tf->field("theta_i");
@@ -163,31 +216,31 @@ public:
               jacobian.dtype == Struct::Type::UInt8))
               Throw("Invalid file structure: %s", tf);
 
-        m_isotropic = phi_i.shape[0] <= 2;
-        m_jacobian  = ((uint8_t *) jacobian.data)[0];
+        tables->isotropic = phi_i.shape[0] <= 2;
+        tables->jacobian  = ((uint8_t *) jacobian.data)[0];
 
-        if (!m_isotropic) {
+        if (!tables->isotropic) {
             ScalarFloat *phi_i_data = (ScalarFloat *) phi_i.data;
-            m_reduction = (int) std::rint((2 * dr::Pi<ScalarFloat>) /
+            tables->reduction = (int) std::rint((2 * dr::Pi<ScalarFloat>) /
                 (phi_i_data[phi_i.shape[0] - 1] - phi_i_data[0]));
         }
 
         // Construct NDF interpolant data structure
-        m_ndf = Warp2D0(
+        tables->ndf = Warp2D0(
             (ScalarFloat *) ndf.data,
             ScalarVector2u(ndf.shape[1], ndf.shape[0]),
             { }, { }, false, false
         );
 
         // Construct projected surface area interpolant data structure
-        m_sigma = Warp2D0(
+        tables->sigma = Warp2D0(
             (ScalarFloat *) sigma.data,
             ScalarVector2u(sigma.shape[1], sigma.shape[0]),
             { }, { }, false, false
         );
 
         // Construct VNDF warp data structure
-        m_vndf = Warp2D2(
+        tables->vndf = Warp2D2(
             (ScalarFloat *) vndf.data,
             ScalarVector2u(vndf.shape[3], vndf.shape[2]),
             {{ (uint32_t) phi_i.shape[0],
@@ -197,7 +250,7 @@ public:
         );
 
         // Construct Luminance warp data structure
-        m_luminance = Warp2D2(
+        tables->luminance = Warp2D2(
             (ScalarFloat *) luminance.data,
             ScalarVector2u(luminance.shape[3], luminance.shape[2]),
             {{ (uint32_t) phi_i.shape[0],
@@ -207,7 +260,7 @@ public:
         );
 
         // Construct spectral interpolant
-        m_spectra = Warp2D3(
+        tables->spectra = Warp2D3(
             (ScalarFloat *) spectra.data,
             ScalarVector2u(spectra.shape[4], spectra.shape[3]),
             {{ (uint32_t) phi_i.shape[0],
@@ -227,6 +280,8 @@ public:
         Log(Info, "Loaded material \"%s\" (resolution %i x %i x %i x %i x %i)",
             description_str, spectra.shape[0], spectra.shape[1],
             spectra.shape[3], spectra.shape[4], spectra.shape[2]);
+
+        return tables;
     }
 
     /**
@@ -276,10 +331,10 @@ public:
         Float pdf = 1.f;
 
         #if MI_SAMPLE_LUMINANCE == 1
-        std::tie(sample, pdf) = m_luminance.sample(sample, params, active);
+        std::tie(sample, pdf) = m_tables->luminance.sample(sample, params, active);
         #endif
 
-        auto [u_m, ndf_pdf] = m_vndf.sample(sample, params, active);
+        auto [u_m, ndf_pdf] = m_tables->vndf.sample(sample, params, active);
 
         Float phi_m   = u2phi(u_m.y()),
               theta_m = u2theta(u_m.x());
@@ -317,7 +372,7 @@ public:
 
         u_m[1] = u_m[1] - dr::floor(u_m[1]);
 
-    std::tie(sample, std::ignore) = m_vndf.invert(u_m, params, active);
+    std::tie(sample, std::ignore) = m_tables->vndf.invert(u_m, params, active);
 #endif // MI_SAMPLE_DIFFUSE
 
         bs.eta               = 1.f;
@@ -328,12 +383,12 @@ public:
         for (size_t i = 0; i < dr::array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i,
                 is_spectral_v<Spectrum> ? si.wavelengths[i] : Float((float) i) };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_tables->spectra.eval(sample, params_spec, active);
         }
 
         if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+            spec *= m_tables->ndf.eval(u_m, params, active) /
+                    (4 * m_tables->sigma.eval(u_wi, params, active));
 
         bs.wo.x() = dr::mulsign_neg(bs.wo.x(), sx);
         bs.wo.y() = dr::mulsign_neg(bs.wo.y(), sy);
@@ -381,18 +436,18 @@ public:
         u_m[1] = u_m[1] - dr::floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, unused] = m_vndf.invert(u_m, params, active);
+        auto [sample, unused] = m_tables->vndf.invert(u_m, params, active);
 
         UnpolarizedSpectrum spec;
         for (size_t i = 0; i < dr::array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i,
                 is_spectral_v<Spectrum> ? si.wavelengths[i] : Float((float) i) };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_tables->spectra.eval(sample, params_spec, active);
         }
 
         if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+            spec *= m_tables->ndf.eval(u_m, params, active) /
+                    (4 * m_tables->sigma.eval(u_wi, params, active));
 
         return depolarizer<Spectrum>(spec) & active;
     }
@@ -438,11 +493,11 @@ public:
         u_m[1] = u_m[1] - dr::floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, vndf_pdf] = m_vndf.invert(u_m, params, active);
+        auto [sample, vndf_pdf] = m_tables->vndf.invert(u_m, params, active);
 
         Float pdf = 1.f;
         #if MI_SAMPLE_LUMINANCE == 1
-        pdf = m_luminance.eval(sample, params, active);
+        pdf = m_tables->luminance.eval(sample, params, active);
         #endif
 
         Float jacobian =
@@ -459,11 +514,11 @@ public:
         std::ostringstream oss;
         oss << "Measured[" << std::endl
             << "  filename = \"" << m_name << "\"," << std::endl
-            << "  ndf = " << string::indent(m_ndf.to_string()) << "," << std::endl
-            << "  sigma = " << string::indent(m_sigma.to_string()) << "," << std::endl
-            << "  vndf = " << string::indent(m_vndf.to_string()) << "," << std::endl
-            << "  luminance = " << string::indent(m_luminance.to_string()) << "," << std::endl
-            << "  spectra = " << string::indent(m_spectra.to_string()) << std::endl
+            << "  ndf = " << string::indent(m_tables->ndf.to_string()) << "," << std::endl
+            << "  sigma = " << string::indent(m_tables->sigma.to_string()) << "," << std::endl
+            << "  vndf = " << string::indent(m_tables->vndf.to_string()) << "," << std::endl
+            << "  luminance = " << string::indent(m_tables->luminance.to_string()) << "," << std::endl
+            << "  spectra = " << string::indent(m_tables->spectra.to_string()) << std::endl
             << "]";
         return oss.str();
     }
@@ -488,11 +543,7 @@ private:
 
 private:
     std::string m_name;
-    Warp2D0 m_ndf;
-    Warp2D0 m_sigma;
-    Warp2D2 m_vndf;
-    Warp2D2 m_luminance;
-    Warp2D3 m_spectra;
+    std::shared_ptr<Tables> m_tables;
     bool m_isotropic;
     bool m_jacobian;
     int m_reduction;
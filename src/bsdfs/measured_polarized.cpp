@@ -7,6 +7,9 @@
 #include <mitsuba/render/fresnel.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/microfacet.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 /* Set the weight for cosine hemisphere sampling in relation to GGX sampling.
    Set to 1.0 in order to fully fall back to cosine sampling. */
@@ -99,6 +102,9 @@ here as a user parameter `alpha_sample` and should be set according to the
 approximate roughness of the material to be rendered. Note that any value here
 will result in a correct rendering but the level of noise can vary significantly.
 
+Instances of this plugin that load the same file share their interpolation
+table, which is kept in memory as long as one of them exists.
+
 */
 template <typename Float, typename Spectrum>
 class MeasuredPolarized final : public BSDF<Float, Spectrum> {
@@ -122,6 +128,36 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name = file_path.filename().string();
 
+        m_interpolator = load_interpolator(file_path);
+    }
+
+    /**
+     * \brief Return the interpolant of the given file
+     *
+     * The interpolant is shared by all instances of the material that load
+     * the same file and is kept alive as long as one of them exists.
+     */
+    static std::shared_ptr<Interpolator> load_interpolator(const fs::path &file_path) {
+        static std::mutex cache_mutex;
+        static std::unordered_map<std::string, std::weak_ptr<Interpolator>> cache;
+
+        std::string key = fs::absolute(file_path).string();
+        std::lock_guard<std::mutex> guard(cache_mutex);
+
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            std::shared_ptr<Interpolator> interpolator = it->second.lock();
+            if (interpolator)
+                return interpolator;
+        }
+
+        std::shared_ptr<Interpolator> interpolator = read_interpolator(file_path);
+        cache[key] = interpolator;
+        return interpolator;
+    }
+
+    /// Read the interpolant of a measured polarized material from the given file
+    static std::shared_ptr<Interpolator> read_interpolator(const fs::path &file_path) {
         ref<TensorFile> tf = new TensorFile(file_path);
 
         auto theta_h = tf->field("theta_h");
@@ -158,7 +194,7 @@ public:
             wavelengths[i] = ScalarFloat(((uint16_t *) wvls.data)[i]);
         }
 
-        m_interpolator = Interpolator(
+        std::shared_ptr<Interpolator> interpolator(new Interpolator(
             (ScalarFloat *) pbrdf.data,
             ScalarVector2u(4, 4),
             {{ (uint32_t) phi_d.shape[1],
@@ -170,7 +206,9 @@ public:
                (const ScalarFloat *) theta_h.data,
                (const ScalarFloat *) wavelengths }},
             false, false
-        );
+        ));
+
+        return interpolator;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -261,7 +299,7 @@ public:
                                 phi_d, theta_d, theta_h,
                                 si.wavelengths[k]
                             };
-                            tmp[k] = m_interpolator.eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
+                            tmp[k] = m_interpolator->eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
                         }
                         value(i, j) = tmp;
                     }
@@ -273,7 +311,7 @@ public:
                             phi_d, theta_d, theta_h,
                             Float(m_wavelength)
                         };
-                        value(i, j) = m_interpolator.eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
+                        value(i, j) = m_interpolator->eval(Point2f(Float(j)/3.f, Float(i)/3.f), params, active);
                     }
                 }
             }
@@ -301,14 +339,14 @@ public:
                         phi_d, theta_d, theta_h,
                         si.wavelengths[k]
                     };
-                    value[k] = m_interpolator.eval(Point2f(0.f, 0.f), params, active);
+                    value[k] = m_interpolator->eval(Point2f(0.f, 0.f), params, active);
                 }
             } else {
                 Float params[4] = {
                     phi_d, theta_d, theta_h,
                     Float(m_wavelength)
                 };
-                Float value_ = m_interpolator.eval(Point2f(0.f, 0.f), params, active);
+                Float value_ = m_interpolator->eval(Point2f(0.f, 0.f), params, active);
                 value = Spectrum(value_);
             }
 
@@ -395,7 +433,7 @@ private:
     std::string m_name;
     ScalarFloat m_wavelength;
     ScalarFloat m_alpha_sample;
-    Interpolator  m_interpolator;
+    std::shared_ptr<Interpolator> m_interpolator;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(MeasuredPolarized, BSDF)
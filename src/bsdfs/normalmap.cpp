@@ -46,6 +46,11 @@ normal map with a value of :math:`(0,0,1)` everywhere causes no changes to the s
 3D normal directions into (nonnegative) color values suitable for this plugin, the mapping
 :math:`x \mapsto (x+1)/2` must be applied to each component.
 
+The tangent direction of the local shading frame follows the texture parameterization. On
+triangle meshes, it is discontinuous across faces unless the ``tangents`` parameter of the
+mesh is set to |true|, which precomputes smooth per-vertex tangent frames as expected by
+normal maps baked with MikkTSpace-based tools.
+
 The following XML snippet describes a smooth mirror material affected by a normal map. Note the we set the
 ``raw`` properties of the normal map ``bitmap`` object to ``true`` in order to disable the
 transformation from sRGB to linear encoding:
@@ -98,13 +103,7 @@ public:
         // TODO: How to assert this is actually a RGBDataTexture?
         m_normalmap = props.texture<Texture>("normalmap");
 
-        // Add all nested components
-        m_flags = (uint32_t) 0;
-        for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i) {
-            m_components.push_back((m_nested_bsdf->flags(i)));
-            m_flags |= m_components.back();
-        }
-        dr::set_attr(this, "flags", m_flags);
+        update_components();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -185,16 +184,58 @@ public:
         return { value & active, dr::select(active, pdf, 0.f) };
     }
 
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                    const Vector3f &wo, Float sample1, const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        // The perturbed shading frame is shared by both queries
+        SurfaceInteraction3f perturbed_si(si);
+        perturbed_si.sh_frame = frame(si, active);
+        perturbed_si.wi       = perturbed_si.to_local(si.wi);
+        Vector3f perturbed_wo = perturbed_si.to_local(wo);
+
+        auto [value, pdf, bs, weight] = m_nested_bsdf->eval_pdf_sample(
+            ctx, perturbed_si, perturbed_wo, sample1, sample2, active);
+
+        Mask active_e = active && Frame3f::cos_theta(wo) *
+                                  Frame3f::cos_theta(perturbed_wo) > 0.f;
+
+        // Transform sampled 'wo' back to original frame and check orientation
+        Vector3f sampled_wo = perturbed_si.to_world(bs.wo);
+        Mask active_s = active && dr::any(dr::neq(unpolarized_spectrum(weight), 0.f)) &&
+                        Frame3f::cos_theta(bs.wo) * Frame3f::cos_theta(sampled_wo) > 0.f;
+        bs.wo = sampled_wo;
+
+        return { value & active_e, dr::select(active_e, pdf, 0.f), bs,
+                 weight & active_s };
+    }
+
+    ref<Base> flatten() override {
+        m_nested_bsdf = m_nested_bsdf->flatten();
+        update_components();
+        return this;
+    }
+
     Frame3f frame(const SurfaceInteraction3f &si, Mask active) const {
         Normal3f n = dr::fmadd(m_normalmap->eval_3(si, active), 2, -1.f);
 
+        /* The perturbed frame is expressed relative to the local shading
+           frame, whose first axis already follows the (possibly
+           precomputed, see the mesh 'tangents' parameter) surface tangent */
         Frame3f result;
         result.n = dr::normalize(n);
-        result.s = dr::normalize(dr::fnmadd(result.n, dr::dot(result.n, si.dp_du), si.dp_du));
+        result.s = dr::normalize(dr::fnmadd(result.n, result.n.x(), Vector3f(1.f, 0.f, 0.f)));
         result.t = dr::cross(result.n, result.s);
         return result;
     }
 
+    uint32_t ray_flags() const override {
+        // The tangent space of the normal map follows the UV parameterization
+        return Base::ray_flags() | RayFlags::UV | RayFlags::dPdUV;
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "NormalMap[" << std::endl
@@ -208,6 +249,17 @@ public:
 
     MI_DECLARE_CLASS()
 protected:
+    void update_components() {
+        // Add all nested components
+        m_components.clear();
+        m_flags = (uint32_t) 0;
+        for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i) {
+            m_components.push_back((m_nested_bsdf->flags(i)));
+            m_flags |= m_components.back();
+        }
+        dr::set_attr(this, "flags", m_flags);
+    }
+
     ref<Base> m_nested_bsdf;
     ref<Texture> m_normalmap;
 };
@@ -190,22 +190,22 @@ public:
         // Parameter definitions
         m_base_color = props.texture<Texture>("base_color", 0.5f);
         m_roughness = props.texture<Texture>("roughness", 0.5f);
-        m_has_anisotropic = get_flag("anisotropic", props);
         m_anisotropic = props.texture<Texture>("anisotropic", 0.0f);
-        m_has_spec_trans = get_flag("spec_trans", props);
+        m_has_anisotropic = get_flag("anisotropic", props, m_anisotropic.get());
         m_spec_trans = props.texture<Texture>("spec_trans", 0.0f);
-        m_has_sheen = get_flag("sheen", props);
+        m_has_spec_trans = get_flag("spec_trans", props, m_spec_trans.get());
         m_sheen = props.texture<Texture>("sheen", 0.0f);
-        m_has_sheen_tint = get_flag("sheen_tint", props);
+        m_has_sheen = get_flag("sheen", props, m_sheen.get());
         m_sheen_tint = props.texture<Texture>("sheen_tint", 0.0f);
-        m_has_flatness = get_flag("flatness", props);
+        m_has_sheen_tint = get_flag("sheen_tint", props, m_sheen_tint.get());
         m_flatness = props.texture<Texture>("flatness", 0.0f);
-        m_has_spec_tint = get_flag("spec_tint", props);
+        m_has_flatness = get_flag("flatness", props, m_flatness.get());
         m_spec_tint = props.texture<Texture>("spec_tint", 0.0f);
-        m_has_metallic = get_flag("metallic", props);
+        m_has_spec_tint = get_flag("spec_tint", props, m_spec_tint.get());
         m_metallic = props.texture<Texture>("metallic", 0.0f);
-        m_has_clearcoat = get_flag("clearcoat", props);
+        m_has_metallic = get_flag("metallic", props, m_metallic.get());
         m_clearcoat = props.texture<Texture>("clearcoat", 0.0f);
+        m_has_clearcoat = get_flag("clearcoat", props, m_clearcoat.get());
         m_clearcoat_gloss = props.texture<Texture>("clearcoat_gloss", 0.0f);
         m_spec_srate = props.get("main_specular_sampling_rate", 1.0f);
         m_clearcoat_srate = props.get("clearcoat_sampling_rate", 1.0f);
@@ -842,6 +842,41 @@ public:
         return m_base_color->eval(si, active);
     }
 
+    std::string merge_key() const override {
+        std::ostringstream oss;
+        for (auto member : texture_members()) {
+            std::string key = (this->*member)->merge_key();
+            if (key.empty())
+                return "";
+            oss << key << ";";
+        }
+
+        // Lobe configuration, sampling rates and the index of refraction
+        oss << m_has_clearcoat << m_has_sheen << m_has_spec_trans
+            << m_has_metallic << m_has_spec_tint << m_has_sheen_tint
+            << m_has_anisotropic << m_has_flatness << m_eta_specular << ","
+            << m_diff_refl_srate << "," << m_spec_srate << ","
+            << m_clearcoat_srate << "," << dr::slice(m_eta);
+        if (!m_eta_specular)
+            oss << "," << dr::slice(m_specular);
+        return oss.str();
+    }
+
+    ref<Base> merge(const std::vector<ref<Base>> &instances) const override {
+        ref<Principled> merged = new Principled(*this);
+        for (auto member : texture_members()) {
+            std::vector<ref<Texture>> textures;
+            for (const auto &bsdf : instances)
+                textures.push_back(static_cast<const Principled *>(bsdf.get())->*member);
+            ref<Texture> texture = Texture::merge(textures);
+            if (!texture)
+                return nullptr;
+            merged.get()->*member = texture;
+        }
+        dr::set_attr(merged.get(), "flags", m_flags);
+        return merged.get();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "Principled BSDF :" << std::endl
@@ -864,6 +899,17 @@ public:
         return oss.str();
     }
     MI_DECLARE_CLASS()
+private:
+    /// All texture parameters (e.g. to merge instances)
+    static std::array<ref<Texture> Principled::*, 11> texture_members() {
+        return { &Principled::m_base_color, &Principled::m_roughness,
+                 &Principled::m_anisotropic, &Principled::m_sheen,
+                 &Principled::m_sheen_tint, &Principled::m_spec_trans,
+                 &Principled::m_flatness, &Principled::m_spec_tint,
+                 &Principled::m_clearcoat, &Principled::m_clearcoat_gloss,
+                 &Principled::m_metallic };
+    }
+
 private:
     /// Parameters
     ref<Texture> m_base_color;
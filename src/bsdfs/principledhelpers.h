@@ -131,6 +131,27 @@ bool get_flag(const std::string &name, const Properties &props) {
     }
 }
 
+/**
+ * \brief Refine the flag of a feature using the texture of its parameter.
+ *
+ * A texture that is zero everywhere (e.g. an \c rgb or \c uniform object
+ * with a value of zero) disables the feature as well, so that the
+ * corresponding lobe is skipped entirely while tracing the BSDF.
+ * \param name
+ *     Name of the feature.
+ * \param props
+ *     Given properties.
+ * \param texture
+ *     Texture that was loaded for the parameter of the feature.
+ * \return the flag of the feature.
+ */
+template <typename Texture>
+bool get_flag(const std::string &name, const Properties &props,
+              const Texture *texture) {
+    return get_flag(name, props) &&
+           (texture->is_spatially_varying() || texture->max() > 0.f);
+}
+
 /**
  * \brief Computes the schlick weight for Fresnel Schlick approximation.
  * \param cos_i
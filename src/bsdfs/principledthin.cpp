@@ -163,21 +163,21 @@ public:
 
         m_base_color = props.texture<Texture>("base_color", 0.5f);
         m_roughness = props.texture<Texture>("roughness", 0.5f);
-        m_has_anisotropic = get_flag("anisotropic", props);
         m_anisotropic = props.texture<Texture>("anisotropic", 0.0f);
-        m_has_spec_trans = get_flag("spec_trans", props);
+        m_has_anisotropic = get_flag("anisotropic", props, m_anisotropic.get());
         m_spec_trans = props.texture<Texture>("spec_trans", 0.0f);
-        m_has_sheen = get_flag("sheen", props);
+        m_has_spec_trans = get_flag("spec_trans", props, m_spec_trans.get());
         m_sheen = props.texture<Texture>("sheen", 0.0f);
-        m_has_sheen_tint = get_flag("sheen_tint", props);
+        m_has_sheen = get_flag("sheen", props, m_sheen.get());
         m_sheen_tint = props.texture<Texture>("sheen_tint", 0.0f);
-        m_has_flatness = get_flag("flatness", props);
+        m_has_sheen_tint = get_flag("sheen_tint", props, m_sheen_tint.get());
         m_flatness = props.texture<Texture>("flatness", 0.0f);
-        m_has_spec_tint = get_flag("spec_tint", props);
+        m_has_flatness = get_flag("flatness", props, m_flatness.get());
         m_spec_tint = props.texture<Texture>("spec_tint", 0.0f);
+        m_has_spec_tint = get_flag("spec_tint", props, m_spec_tint.get());
         m_eta_thin = props.texture<Texture>("eta", 1.5f);
-        m_has_diff_trans = get_flag("diff_trans", props);
         m_diff_trans = props.texture<Texture>("diff_trans", 0.0f);
+        m_has_diff_trans = get_flag("diff_trans", props, m_diff_trans.get());
         m_spec_refl_srate =
                 props.get("specular_reflectance_sampling_rate", 1.0f);
         m_spec_trans_srate =
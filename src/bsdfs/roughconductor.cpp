@@ -5,6 +5,8 @@
 #include <mitsuba/render/ior.h>
 #include <mitsuba/render/microfacet.h>
 #include <mitsuba/render/texture.h>
+#include <memory>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -56,6 +58,11 @@ Rough conductor material (:monosp:`roughconductor`)
      focuses computation on the visible parts of the microfacet normal distribution, considerably
      reducing variance in some cases. (Default: |true|, i.e. use visible normal sampling)
 
+ * - energy_compensation
+   - |bool|
+   - Add the energy that is lost by the single-scattering microfacet model at high roughness
+     following Kulla and Conty :cite:`Kulla2017Revisiting`. (Default: |false|)
+
 This plugin implements a realistic microfacet scattering model for rendering
 rough conducting materials, such as metals.
 
@@ -142,6 +149,14 @@ approach of sampling all normals is still available and can be enabled
 by setting :monosp:`sample_visible` to :monosp:`false`. However this will lead
 to significantly slower convergence.
 
+Microfacet models only account for a single reflection on the microsurface,
+hence very rough conductors appear too dark. When :monosp:`energy_compensation`
+is enabled, the plugin adds a multiple scattering term that restores the missing
+energy :cite:`Kulla2017Revisiting`. It is obtained from the directional albedo
+of the microfacet model, which is tabulated once per distribution when the
+first such material is loaded. The Fresnel term of the compensation is
+approximated from the reflectance at normal incidence.
+
 When using this plugin, you should ideally compile Mitsuba with support for
 spectral rendering to get the most accurate results. While it also works
 in RGB mode, the computations will be more approximate in nature.
@@ -208,6 +223,15 @@ public:
 
         m_components.clear();
         m_components.push_back(m_flags);
+
+        m_energy_compensation = props.get<bool>("energy_compensation", false);
+        if (m_energy_compensation) {
+            const AlbedoTable &table = albedo_table(m_type);
+            m_albedo = dr::load<DynamicBuffer<Float>>(
+                table.albedo.data(), table.albedo.size());
+            m_albedo_avg = dr::load<DynamicBuffer<Float>>(
+                table.albedo_avg.data(), table.albedo_avg.size());
+        }
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -297,11 +321,17 @@ public:
             F = fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, m)), eta_c);
         }
 
+        Spectrum result = F * weight;
+        if (m_energy_compensation)
+            result += depolarizer<Spectrum>(
+                eval_multiple_scattering(distr, eta_c, cos_theta_i,
+                                         Frame3f::cos_theta(bs.wo), active) / bs.pdf);
+
         /* If requested, include the specular reflectance component */
         if (m_specular_reflectance)
-            weight *= m_specular_reflectance->eval(si, active);
+            result *= m_specular_reflectance->eval(si, active);
 
-        return { bs, (F * weight) & active };
+        return { bs, result & active };
     }
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -367,11 +397,16 @@ public:
             F = fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, H)), eta_c);
         }
 
+        Spectrum value = F * result;
+        if (m_energy_compensation)
+            value += depolarizer<Spectrum>(eval_multiple_scattering(
+                distr, eta_c, cos_theta_i, cos_theta_o, active));
+
         /* If requested, include the specular reflectance component */
         if (m_specular_reflectance)
-            result *= m_specular_reflectance->eval(si, active);
+            value *= m_specular_reflectance->eval(si, active);
 
-        return (F * result) & active;
+        return value & active;
     }
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -482,9 +517,14 @@ public:
             F = fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, H)), eta_c);
         }
 
+        Spectrum result = F * value;
+        if (m_energy_compensation)
+            result += depolarizer<Spectrum>(eval_multiple_scattering(
+                distr, eta_c, cos_theta_i, cos_theta_o, active));
+
         // If requested, include the specular reflectance component
         if (m_specular_reflectance)
-            value *= m_specular_reflectance->eval(si, active);
+            result *= m_specular_reflectance->eval(si, active);
 
         Float pdf;
         if (likely(m_sample_visible))
@@ -492,7 +532,71 @@ public:
         else
             pdf = distr.pdf(si.wi, H) / (4.f * dr::dot(wo, H));
 
-        return { F * value & active, dr::select(active, pdf, 0.f) };
+        return { result & active, dr::select(active, pdf, 0.f) };
+    }
+
+    /**
+     * \brief Evaluate the multiple scattering term of the energy compensation
+     * (including the cosine foreshortening factor of \c wo)
+     */
+    UnpolarizedSpectrum
+    eval_multiple_scattering(const MicrofacetDistribution &distr,
+                             const dr::Complex<UnpolarizedSpectrum> &eta_c,
+                             Float cos_theta_i, Float cos_theta_o,
+                             Mask active) const {
+        Float alpha = dr::sqrt(distr.alpha_u() * distr.alpha_v());
+
+        Float albedo_i   = lookup_albedo(alpha, cos_theta_i, active),
+              albedo_o   = lookup_albedo(alpha, cos_theta_o, active),
+              albedo_avg = lookup_albedo_avg(alpha, active);
+
+        /* Average Fresnel reflectance of the conductor, approximated from its
+           reflectance at normal incidence */
+        UnpolarizedSpectrum f_0   = fresnel_conductor(UnpolarizedSpectrum(1.f), eta_c),
+                            f_avg = dr::fmadd(f_0, 20.f / 21.f, 1.f / 21.f);
+
+        // Energy that is lost by single scattering, tinted by interreflections
+        UnpolarizedSpectrum f_ms =
+            dr::sqr(f_avg) * albedo_avg / (1.f - f_avg * (1.f - albedo_avg));
+
+        Float lobe = (1.f - albedo_i) * (1.f - albedo_o) * cos_theta_o /
+                     (dr::Pi<Float> * dr::maximum(1.f - albedo_avg, 1e-4f));
+
+        return f_ms * lobe;
+    }
+
+    /// Bilinearly interpolate the tabulated directional albedo
+    Float lookup_albedo(Float alpha, Float cos_theta, Mask active) const {
+        using UInt32 = dr::uint32_array_t<Float>;
+        const uint32_t res = AlbedoTable::Resolution;
+
+        Float x = dr::clamp(cos_theta, 0.f, 1.f) * (res - 1),
+              y = dr::clamp(alpha, 0.f, 1.f) * (res - 1);
+        UInt32 ix = dr::minimum(UInt32(x), res - 2),
+               iy = dr::minimum(UInt32(y), res - 2),
+               index = iy * res + ix;
+
+        Float v00 = dr::gather<Float>(m_albedo, index, active),
+              v10 = dr::gather<Float>(m_albedo, index + 1, active),
+              v01 = dr::gather<Float>(m_albedo, index + res, active),
+              v11 = dr::gather<Float>(m_albedo, index + res + 1, active);
+
+        Float fx = x - Float(ix), fy = y - Float(iy);
+        return dr::lerp(dr::lerp(v00, v10, fx), dr::lerp(v01, v11, fx), fy);
+    }
+
+    /// Linearly interpolate the tabulated average albedo
+    Float lookup_albedo_avg(Float alpha, Mask active) const {
+        using UInt32 = dr::uint32_array_t<Float>;
+        const uint32_t res = AlbedoTable::Resolution;
+
+        Float x = dr::clamp(alpha, 0.f, 1.f) * (res - 1);
+        UInt32 index = dr::minimum(UInt32(x), res - 2);
+
+        Float v0 = dr::gather<Float>(m_albedo_avg, index, active),
+              v1 = dr::gather<Float>(m_albedo_avg, index + 1, active);
+
+        return dr::lerp(v0, v1, x - Float(index));
     }
 
     std::string to_string() const override {
@@ -500,6 +604,7 @@ public:
         oss << "RoughConductor[" << std::endl
             << "  distribution = " << m_type << "," << std::endl
             << "  sample_visible = " << m_sample_visible << "," << std::endl
+            << "  energy_compensation = " << m_energy_compensation << "," << std::endl
             << "  alpha_u = " << string::indent(m_alpha_u) << "," << std::endl
             << "  alpha_v = " << string::indent(m_alpha_v) << "," << std::endl;
         if (m_specular_reflectance)
@@ -512,6 +617,60 @@ public:
 
     MI_DECLARE_CLASS()
 private:
+    /// Directional albedo of a microfacet model without Fresnel term
+    struct AlbedoTable {
+        static constexpr uint32_t Resolution = 32;
+
+        /// Albedo indexed by roughness (rows) and incident cosine (columns)
+        std::vector<ScalarFloat> albedo;
+        /// Cosine-weighted hemispherical average for each roughness
+        std::vector<ScalarFloat> albedo_avg;
+    };
+
+    /**
+     * \brief Return the albedo table of the given microfacet distribution
+     *
+     * The table only depends on the distribution, hence it is computed
+     * when the first material using it is created and shared afterwards.
+     */
+    static const AlbedoTable &albedo_table(MicrofacetType type) {
+        static std::mutex mutex;
+        static std::unique_ptr<AlbedoTable> tables[2];
+
+        std::lock_guard<std::mutex> guard(mutex);
+        std::unique_ptr<AlbedoTable> &table = tables[(uint32_t) type];
+        if (table)
+            return *table;
+
+        const uint32_t res = AlbedoTable::Resolution;
+        table = std::make_unique<AlbedoTable>();
+        table->albedo.resize(res * res);
+        table->albedo_avg.resize(res);
+
+        using FloatX = DynamicBuffer<ScalarFloat>;
+        using Vector3fX = Vector<FloatX, 3>;
+        using FloatP = dr::Packet<dr::scalar_t<Float>>;
+
+        FloatX mu = dr::maximum(1e-6f, dr::linspace<FloatX>(0, 1, res));
+        Vector3fX wi = Vector3fX(dr::sqrt(1 - mu * mu), dr::zeros<FloatX>(res), mu);
+
+        for (uint32_t i = 0; i < res; ++i) {
+            ScalarFloat alpha = dr::maximum(1e-3f, ScalarFloat(i) / (res - 1));
+            mitsuba::MicrofacetDistribution<FloatP, Spectrum> distr(type, alpha);
+            FloatX albedo = mitsuba::eval_albedo(distr, wi);
+
+            ScalarFloat avg = 0.f;
+            for (uint32_t j = 0; j < res; ++j) {
+                ScalarFloat value = dr::clamp(albedo[j], 0.f, 1.f);
+                table->albedo[i * res + j] = value;
+                avg += value * mu[j];
+            }
+            table->albedo_avg[i] = avg * 2.f / res;
+        }
+
+        return *table;
+    }
+
     /// Specifies the type of microfacet distribution
     MicrofacetType m_type;
     /// Anisotropic roughness values
@@ -524,6 +683,11 @@ private:
     ref<Texture> m_k;
     /// Specular reflectance component
     ref<Texture> m_specular_reflectance;
+    /// Add the energy that is lost by single scattering?
+    bool m_energy_compensation;
+    /// Tabulated directional and average albedo (for energy compensation)
+    DynamicBuffer<Float> m_albedo;
+    DynamicBuffer<Float> m_albedo_avg;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(RoughConductor, BSDF)
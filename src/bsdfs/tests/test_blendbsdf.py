@@ -184,3 +184,105 @@ def test05_sample_components(variant_scalar_rgb):
     expected_b = weight*1.0    # InvPi will cancel out with sampling pdf, but still need to apply weight
     bs_b, weight_b = bsdf.sample(ctx, si, 0.3, [0.5, 0.5])
     assert dr.allclose(weight_b, expected_b)
+
+
+def create_stack(weight=0.3):
+    import numpy as np
+    normals = np.full((4, 4, 3), 0.5, dtype=np.float32)
+    normals[..., 0] = np.linspace(0.3, 0.7, 4)[None, :]
+    normals[..., 2] = 0.9
+
+    return mi.load_dict({
+        'type': 'blendbsdf',
+        'weight': weight,
+        'bsdf_0': {
+            'type': 'mask',
+            'opacity': 0.6,
+            'nested': {
+                'type': 'normalmap',
+                'normalmap': {
+                    'type': 'bitmap',
+                    'raw': True,
+                    'bitmap': mi.Bitmap(normals)
+                },
+                'nested': {'type': 'roughconductor', 'alpha': 0.3}
+            }
+        },
+        'bsdf_1': {
+            'type': 'twosided',
+            'nested': {'type': 'roughplastic'}
+        }
+    })
+
+
+def test06_eval_pdf_sample(variants_vec_rgb):
+    # The fused query of a stack of adapters matches the separate queries
+    bsdf = create_stack()
+
+    n = 1000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+
+    si = dr.zeros(mi.SurfaceInteraction3f, n)
+    si.n = mi.Normal3f(0, 0, 1)
+    si.sh_frame = mi.Frame3f(si.n)
+    si.dp_du = mi.Vector3f(1, 0, 0)
+    si.uv = sampler.next_2d()
+    si.wi = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+    wo = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+    sample1, sample2 = sampler.next_1d(), sampler.next_2d()
+
+    ctx = mi.BSDFContext()
+    value, pdf, bs, weight = bsdf.eval_pdf_sample(ctx, si, wo, sample1, sample2)
+    value_ref, pdf_ref = bsdf.eval_pdf(ctx, si, wo)
+    bs_ref, weight_ref = bsdf.sample(ctx, si, sample1, sample2)
+
+    assert dr.allclose(value, value_ref, atol=1e-5)
+    assert dr.allclose(pdf, pdf_ref, atol=1e-5)
+    assert dr.allclose(bs.wo, bs_ref.wo, atol=1e-5)
+    assert dr.allclose(bs.pdf, bs_ref.pdf, atol=1e-5)
+    assert dr.all(bs.sampled_component == bs_ref.sampled_component)
+    assert dr.allclose(weight, weight_ref, atol=1e-5)
+
+
+def test07_flatten(variants_all_rgb):
+    def create_scene(flatten):
+        return mi.load_dict({
+            'type': 'scene',
+            'flatten_bsdfs': flatten,
+            'rect': {
+                'type': 'rectangle',
+                'bsdf': {
+                    'type': 'blendbsdf',
+                    'weight': 0.0,
+                    'bsdf_0': {
+                        'type': 'mask',
+                        'opacity': 1.0,
+                        'nested': {
+                            'type': 'twosided',
+                            'nested': {
+                                'type': 'twosided',
+                                'nested': {'type': 'diffuse'}
+                            }
+                        }
+                    },
+                    'bsdf_1': {'type': 'conductor'}
+                }
+            }
+        })
+
+    # The whole stack of adapters collapses to its innermost two-sided BSDF
+    bsdf = create_scene(True).shapes()[0].bsdf()
+    assert bsdf.component_count() == 2
+    assert 'TwoSided' in str(bsdf)
+    assert str(bsdf).count('TwoSided') == 1
+
+    bsdf_ref = create_scene(False).shapes()[0].bsdf()
+    assert bsdf_ref.component_count() == 6
+
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    si.sh_frame = mi.Frame3f(mi.Normal3f(0, 0, 1))
+    si.wi = mi.Vector3f(0.3, 0.2, -0.9)
+    wo = mi.Vector3f(-0.1, 0.4, -0.8)
+    ctx = mi.BSDFContext()
+    assert dr.allclose(bsdf.eval(ctx, si, wo), bsdf_ref.eval(ctx, si, wo))
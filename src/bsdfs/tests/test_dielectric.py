@@ -175,4 +175,40 @@ def test06_attached_sampling(variants_all_ad_rgb):
     
     dr.forward(angle)
     assert dr.allclose(dr.grad(weight), 0.008912204764783382)
-    
\ No newline at end of file
+    
+
+def test07_dispersion(variant_scalar_spectral):
+    bsdf = mi.load_dict({
+        'type': 'dielectric',
+        'int_ior': 1.5,
+        'ext_ior': 1.0,
+        'abbe_number': 40
+    })
+
+    with pytest.raises(RuntimeError, match='Abbe number'):
+        mi.load_dict({'type': 'dielectric', 'abbe_number': -1})
+
+    wi = dr.normalize(mi.Vector3f(0.5, 0, 1))
+    si = mi.SurfaceInteraction3f()
+    si.wi = wi
+    ctx = mi.BSDFContext(mi.TransportMode.Importance)
+
+    def refract(wavelength):
+        si.wavelengths = [wavelength, 450, 550, 650]
+        return bsdf.sample(ctx, si, 0.99, [0, 0])
+
+    # The interior IOR is attained at the Fraunhofer d line
+    bs, spec = refract(587.6)
+    assert dr.allclose(bs.eta, 1.5)
+    assert bs.sampled_type == +mi.BSDFFlags.DeltaTransmission
+
+    # Only the hero wavelength carries on, with the weight of all wavelengths
+    assert dr.allclose(spec, [4, 0, 0, 0])
+
+    # Definition of the Abbe number
+    eta_f = refract(486.1)[0].eta
+    eta_c = refract(656.3)[0].eta
+    assert dr.allclose((1.5 - 1) / (eta_f - eta_c), 40, rtol=1e-3)
+
+    # Shorter wavelengths are bent more strongly towards the normal
+    assert refract(450)[0].wo.x > refract(650)[0].wo.x
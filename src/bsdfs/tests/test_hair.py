@@ -0,0 +1,51 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def test01_create(variant_scalar_rgb):
+    b = mi.load_dict({ 'type': 'hair' })
+    assert b is not None
+    assert b.component_count() == 2
+    assert mi.has_flag(b.flags(), mi.BSDFFlags.GlossyReflection)
+    assert mi.has_flag(b.flags(), mi.BSDFFlags.GlossyTransmission)
+
+    with pytest.raises(RuntimeError):
+        mi.load_dict({ 'type': 'hair', 'sigma_a': 0.5, 'eumelanin': 1.0 })
+
+
+def test02_chi2(variants_vec_backends_once_rgb):
+    xml = """<float name="beta_m" value="0.4"/>
+             <float name="beta_n" value="0.5"/>
+          """
+    wi = dr.normalize(mi.ScalarVector3f(0.4, 0.3, 0.6))
+    sample_func, pdf_func = mi.chi2.BSDFAdapter("hair", xml, wi=wi)
+
+    chi2 = mi.chi2.ChiSquareTest(
+        domain=mi.chi2.SphericalDomain(),
+        sample_func=sample_func,
+        pdf_func=pdf_func,
+        sample_dim=3
+    )
+
+    assert chi2.run()
+
+
+@pytest.mark.parametrize('wi', [[0.4, 0.3, 0.6], [-0.1, -0.7, 0.2], [0.0, 0.1, 1.0]])
+def test03_white_furnace(variants_vec_backends_once_rgb, wi):
+    # Without absorption, the lobes of the fiber conserve energy
+    bsdf = mi.load_dict({ 'type': 'hair', 'sigma_a': 0.0, 'beta_m': 0.25 })
+
+    n = 1000000
+    rng = mi.PCG32(size=n)
+    si = dr.zeros(mi.SurfaceInteraction3f, n)
+    si.wi = dr.normalize(mi.Vector3f(wi))
+
+    bs, weight = bsdf.sample(mi.BSDFContext(), si, rng.next_float32(),
+                             mi.Point2f(rng.next_float32(), rng.next_float32()))
+    assert dr.allclose(dr.mean(weight), 1.0, rtol=1e-2)
+
+    # The sampling density is consistent with the returned weight
+    value, pdf = bsdf.eval_pdf(mi.BSDFContext(), si, bs.wo)
+    assert dr.allclose(bs.pdf, pdf, rtol=1e-4)
+    assert dr.allclose(value / pdf, weight, rtol=1e-3)
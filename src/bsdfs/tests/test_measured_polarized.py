@@ -48,3 +48,30 @@ def test01_evaluation(variant_scalar_spectral_polarized):
            [-0.00424358,  0.00312945, -0.01219576,  0.00086167],
            [ 0.00099006, -0.00345963, -0.00285343, -0.00205485]]
     assert dr.allclose(ref, value, rtol=1e-4)
+
+
+@fresolver_append_path
+def test02_shared_tables(variant_scalar_spectral_polarized):
+    # Instances loading the same file share their tables, which must not
+    # interfere with parameters that are specific to each instance
+    def create(alpha_sample):
+        return mi.load_dict({
+            'type': 'measured_polarized',
+            'filename': 'resources/data/tests/pbsdf/spectralon_lowres.pbsdf',
+            'alpha_sample': alpha_sample
+        })
+
+    bsdfs = [create(0.1), create(0.3)]
+    del bsdfs[0]
+    bsdfs.append(create(0.2))
+
+    ctx = mi.BSDFContext()
+    si = mi.SurfaceInteraction3f()
+    si.wi = dr.normalize(mi.Vector3f(0.2, 0.1, 1))
+    si.sh_frame = mi.Frame3f([0, 0, 1])
+    si.wavelengths = [500, 500, 500, 500]
+    wo = dr.normalize(mi.Vector3f(-0.1, 0.05, 1))
+
+    values = [np.array(b.eval(ctx, si, wo)) for b in bsdfs]
+    assert np.allclose(values[0], values[1])
+    assert not np.allclose(bsdfs[0].pdf(ctx, si, wo), bsdfs[1].pdf(ctx, si, wo))
@@ -194,3 +194,40 @@ def test05_eval_pdf(variant_scalar_rgb):
         wo = [dr.sin(theta), 0, dr.cos(theta)]
         assert dr.allclose(bsdf.pdf(ctx, si, wo=wo), pdf_true[i])
         assert dr.allclose(bsdf.eval(ctx, si, wo=wo)[0], evaluate_true[i])
+
+
+def test06_constant_zero_lobes(variant_scalar_rgb):
+    # Lobes whose weight is a texture that is zero everywhere are skipped
+    zero = {'type': 'rgb', 'value': 0.0}
+    b = mi.load_dict({
+        'type': 'principled',
+        'base_color': {'type': 'rgb', 'value': [0.8, 0.3, 0.2]},
+        'spec_trans': zero,
+        'clearcoat': zero,
+        'anisotropic': {'type': 'uniform', 'value': 0.0},
+        'sheen': zero
+    })
+    assert b.component_count() == 2
+    assert not mi.has_flag(b.flags(), mi.BSDFFlags.GlossyTransmission)
+    assert not mi.has_flag(b.flags(), mi.BSDFFlags.Anisotropic)
+
+    b_ref = mi.load_dict({
+        'type': 'principled',
+        'base_color': {'type': 'rgb', 'value': [0.8, 0.3, 0.2]}
+    })
+
+    si = mi.SurfaceInteraction3f()
+    si.n = [0, 0, 1]
+    si.wi = dr.normalize(mi.Vector3f(0.4, 0.1, 1))
+    si.sh_frame = mi.Frame3f(si.n)
+    wo = dr.normalize(mi.Vector3f(-0.3, 0.2, 1))
+    ctx = mi.BSDFContext()
+    assert dr.allclose(b.eval(ctx, si, wo), b_ref.eval(ctx, si, wo))
+    assert dr.allclose(b.pdf(ctx, si, wo), b_ref.pdf(ctx, si, wo))
+
+    # Textures that vary over the surface keep their lobe
+    b = mi.load_dict({
+        'type': 'principled',
+        'spec_trans': {'type': 'checkerboard', 'color0': 0.0, 'color1': 0.0}
+    })
+    assert b.component_count() == 3
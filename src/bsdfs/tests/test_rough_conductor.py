@@ -115,3 +115,39 @@ def test06_eval_pdf(variant_scalar_rgb):
         v_eval_pdf = bsdf.eval_pdf(ctx, si, wo=wo)
         assert dr.allclose(v_eval, v_eval_pdf[0])
         assert dr.allclose(v_pdf, v_eval_pdf[1])
+
+
+def test07_energy_compensation(variants_vec_rgb):
+    # The default conductor (eta=0, k=1) reflects all light, hence the energy
+    # compensated model must conserve energy even at high roughness
+    def albedo(distribution, energy_compensation, cos_theta_i):
+        bsdf = mi.load_dict({
+            'type': 'roughconductor',
+            'distribution': distribution,
+            'alpha': 1.0,
+            'energy_compensation': energy_compensation
+        })
+
+        n = 100000
+        sampler = mi.load_dict({'type': 'independent'})
+        sampler.seed(0, n)
+
+        si = dr.zeros(mi.SurfaceInteraction3f, n)
+        si.sh_frame = mi.Frame3f(mi.Normal3f(0, 0, 1))
+        si.wi = mi.Vector3f(dr.sqrt(1 - cos_theta_i**2), 0, cos_theta_i)
+
+        ctx = mi.BSDFContext()
+        bs, weight = bsdf.sample(ctx, si, sampler.next_1d(), sampler.next_2d())
+
+        # The sampling weight matches eval() / pdf()
+        value, pdf = bsdf.eval_pdf(ctx, si, bs.wo)
+        valid = pdf > 0
+        assert dr.allclose(dr.select(valid, value / pdf, 0), dr.select(valid, weight, 0),
+                           rtol=1e-3, atol=1e-4)
+
+        return dr.mean(weight[0])[0]
+
+    for distribution in ['ggx', 'beckmann']:
+        for cos_theta_i in [0.2, 0.6, 1.0]:
+            assert albedo(distribution, False, cos_theta_i) < 0.9
+            assert abs(albedo(distribution, True, cos_theta_i) - 1) < 0.03
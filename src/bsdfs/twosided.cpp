@@ -85,19 +85,7 @@ public:
         if (!m_brdf[1])
             m_brdf[1] = m_brdf[0];
 
-        // Add all nested components, overwriting any front / back side flag.
-        for (size_t i = 0; i < m_brdf[0]->component_count(); ++i) {
-            auto c = (m_brdf[0]->flags(i) & ~BSDFFlags::BackSide);
-            m_components.push_back(c | BSDFFlags::FrontSide);
-            m_flags = m_flags | m_components.back();
-        }
-
-        for (size_t i = 0; i < m_brdf[1]->component_count(); ++i) {
-            auto c = (m_brdf[1]->flags(i) & ~BSDFFlags::FrontSide);
-            m_components.push_back(c | BSDFFlags::BackSide);
-            m_flags = m_flags | m_components.back();
-        }
-        dr::set_attr(this, "flags", m_flags);
+        update_components();
 
         if (has_flag(m_flags, BSDFFlags::Transmission))
             Throw("Only materials without a transmission component can be nested!");
@@ -257,6 +245,63 @@ public:
         return { value, pdf };
     }
 
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx_, const SurfaceInteraction3f &si_,
+                    const Vector3f &wo_, Float sample1, const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        using Result = std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>;
+
+        SurfaceInteraction3f si(si_);
+        BSDFContext ctx(ctx_);
+        Vector3f wo(wo_);
+        Result result = dr::zeros<Result>();
+
+        if (m_brdf[0] == m_brdf[1]) {
+            wo.z() = dr::mulsign(wo.z(), si.wi.z());
+            si.wi.z() = dr::abs(si.wi.z());
+            result = m_brdf[0]->eval_pdf_sample(ctx, si, wo, sample1, sample2, active);
+            BSDFSample3f &bs = std::get<2>(result);
+            bs.wo.z() = dr::mulsign(bs.wo.z(), si_.wi.z());
+        } else {
+            Mask front_side = Frame3f::cos_theta(si.wi) > 0.f && active,
+                 back_side  = Frame3f::cos_theta(si.wi) < 0.f && active;
+
+            if (dr::any_or<true>(front_side))
+                dr::masked(result, front_side) = m_brdf[0]->eval_pdf_sample(
+                    ctx, si, wo, sample1, sample2, front_side);
+
+            if (dr::any_or<true>(back_side)) {
+                if (ctx.component != (uint32_t) -1)
+                    ctx.component -= (uint32_t) m_brdf[0]->component_count();
+
+                si.wi.z() *= -1.f;
+                wo.z() *= -1.f;
+
+                Result back = m_brdf[1]->eval_pdf_sample(ctx, si, wo, sample1,
+                                                         sample2, back_side);
+                std::get<2>(back).wo.z() *= -1.f;
+                dr::masked(result, back_side) = back;
+            }
+        }
+
+        return result;
+    }
+
+    ref<Base> flatten() override {
+        bool same = m_brdf[0] == m_brdf[1];
+        m_brdf[0] = m_brdf[0]->flatten();
+        m_brdf[1] = same ? m_brdf[0] : m_brdf[1]->flatten();
+        update_components();
+
+        // Nesting a two-sided adapter into another one has no effect
+        if (m_brdf[0] == m_brdf[1] && dynamic_cast<TwoSidedBRDF *>(m_brdf[0].get()))
+            return m_brdf[0];
+
+        return this;
+    }
+
     Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si_,
                                       Mask active) const override {
         SurfaceInteraction3f si(si_);
@@ -293,6 +338,24 @@ public:
 
     MI_DECLARE_CLASS()
 protected:
+    void update_components() {
+        // Add all nested components, overwriting any front / back side flag.
+        m_components.clear();
+        m_flags = (uint32_t) 0;
+        for (size_t i = 0; i < m_brdf[0]->component_count(); ++i) {
+            auto c = (m_brdf[0]->flags(i) & ~BSDFFlags::BackSide);
+            m_components.push_back(c | BSDFFlags::FrontSide);
+            m_flags = m_flags | m_components.back();
+        }
+
+        for (size_t i = 0; i < m_brdf[1]->component_count(); ++i) {
+            auto c = (m_brdf[1]->flags(i) & ~BSDFFlags::FrontSide);
+            m_components.push_back(c | BSDFFlags::BackSide);
+            m_flags = m_flags | m_components.back();
+        }
+        dr::set_attr(this, "flags", m_flags);
+    }
+
     ref<Base> m_brdf[2];
 };
 
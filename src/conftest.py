@@ -139,3 +139,6 @@ def pytest_configure(config):
     config.addinivalue_line(
         "markers", "slow: marks tests as slow (deselect with -m 'not slow')"
     )
+    config.addinivalue_line(
+        "markers", "perf: marks performance regression tests (enabled with MI_PERF_TESTS=1)"
+    )
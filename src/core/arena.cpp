@@ -0,0 +1,52 @@
+#include <mitsuba/core/arena.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+void *MemoryArena::alloc_slow(size_t size, size_t align) {
+    size_t required = size + align;
+
+    // Continue with the next chunk that is large enough (if any)
+    while (m_chunk + 1 < m_chunks.size()) {
+        m_chunk++;
+        m_offset = 0;
+        if (m_chunks[m_chunk].size >= required)
+            return alloc(size, align);
+    }
+
+    /* Insert a new chunk after the current one. Marks only refer to this
+       chunk and to previous ones, so they remain valid. */
+    Chunk chunk;
+    chunk.size = std::max(m_chunk_size, required);
+    chunk.data.reset(new uint8_t[chunk.size]);
+
+    size_t index = m_chunks.empty() ? 0 : m_chunk + 1;
+    m_chunks.insert(m_chunks.begin() + index, std::move(chunk));
+    m_chunk = index;
+    m_offset = 0;
+    return alloc(size, align);
+}
+
+void MemoryArena::consolidate() {
+    size_t total = capacity();
+    m_chunks.clear();
+
+    Chunk chunk;
+    chunk.size = total;
+    chunk.data.reset(new uint8_t[total]);
+    m_chunks.push_back(std::move(chunk));
+}
+
+size_t MemoryArena::capacity() const {
+    size_t total = 0;
+    for (const Chunk &chunk : m_chunks)
+        total += chunk.size;
+    return total;
+}
+
+MemoryArena &MemoryArena::thread_arena() {
+    static thread_local MemoryArena arena;
+    return arena;
+}
+
+NAMESPACE_END(mitsuba)
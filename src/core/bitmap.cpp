@@ -1,4 +1,5 @@
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/bitmapwriter.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
@@ -6,8 +7,11 @@
 #include <mitsuba/core/rfilter.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/profiler.h>
 #include <unordered_map>
+#include <atomic>
 
 #include <nanothread/nanothread.h>
 #include <drjit/half.h>
@@ -77,6 +81,7 @@ Bitmap::Bitmap(PixelFormat pixel_format, Struct::Type component_format,
     rebuild_struct(channel_count, channel_names);
 
     if (!m_data) {
+        m_memory.set(buffer_size());
         m_data = std::unique_ptr<uint8_t[]>(new uint8_t[buffer_size()]);
 
         m_owns_data = true;
@@ -89,8 +94,11 @@ Bitmap::Bitmap(const Bitmap &bitmap)
       m_size(bitmap.m_size),
       m_struct(new Struct(*bitmap.m_struct)),
       m_srgb_gamma(bitmap.m_srgb_gamma),
-      m_owns_data(true) {
+      m_owns_data(true),
+      m_exr_compression(bitmap.m_exr_compression),
+      m_exr_channel_formats(bitmap.m_exr_channel_formats) {
     size_t size = buffer_size();
+    m_memory.set(size);
     m_data = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
     memcpy(m_data.get(), bitmap.m_data.get(), size);
 }
@@ -103,7 +111,8 @@ Bitmap::Bitmap(Bitmap &&bitmap)
       m_size(bitmap.m_size),
       m_struct(std::move(bitmap.m_struct)),
       m_srgb_gamma(bitmap.m_srgb_gamma),
-      m_owns_data(bitmap.m_owns_data) {
+      m_owns_data(bitmap.m_owns_data),
+      m_memory(std::move(bitmap.m_memory)) {
 }
 
 Bitmap::Bitmap(Stream *stream, FileFormat format) {
@@ -112,7 +121,22 @@ Bitmap::Bitmap(Stream *stream, FileFormat format) {
 
 Bitmap::Bitmap(const fs::path &filename, FileFormat format) {
     ref<FileStream> fs = new FileStream(filename);
-    read(fs, format);
+    if (format == FileFormat::Auto)
+        format = detect_file_format(fs);
+
+    if (format == FileFormat::PFM || format == FileFormat::OpenEXR) {
+        /* Large floating point images are read from a read-only mapping of
+           the file: pages are fetched lazily from the (shared) page cache,
+           and the readers copy the pixels straight into the bitmap without
+           intermediate buffers. The stream is never written to. */
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(filename);
+        fs->close();
+        ref<MemoryStream> ms = new MemoryStream(mmap->data(), mmap->size());
+        Log(Debug, "Reading \"%s\" from a memory mapping ..", filename.string());
+        read(ms, format);
+    } else {
+        read(fs, format);
+    }
 }
 
 Bitmap::~Bitmap() {
@@ -136,6 +160,30 @@ void Bitmap::set_srgb_gamma(bool value) {
     }
 }
 
+void Bitmap::set_exr_channel_format(const std::string &name, Struct::Type type) {
+    if (type != Struct::Type::Float16 && type != Struct::Type::Float32 &&
+        type != Struct::Type::UInt32)
+        Throw("Bitmap::set_exr_channel_format(): unsupported format %s for "
+              "channel \"%s\" (must be float16, float32 or uint32)!", type, name);
+    if (!m_struct->has_field(name))
+        Throw("Bitmap::set_exr_channel_format(): the bitmap has no channel "
+              "named \"%s\"!", name);
+
+    for (auto &[key, value] : m_exr_channel_formats) {
+        if (key == name) {
+            value = type;
+            return;
+        }
+    }
+    m_exr_channel_formats.emplace_back(name, type);
+}
+
+Struct::Type Bitmap::exr_channel_format(const std::string &name) const {
+    for (const auto &[key, value] : m_exr_channel_formats)
+        if (key == name)
+            return value;
+    return m_struct->field(name).type;
+}
 
 void Bitmap::set_premultiplied_alpha(bool value) {
     m_premultiplied_alpha = value;
@@ -313,16 +361,17 @@ resample(Bitmap *target, const Bitmap *source,
         r.set_boundary_condition(bc.second);
         r.set_clamp(clamp);
 
+        /* Process blocks of target rows, which accumulate entire source rows
+           (sequential memory accesses rather than one column at a time) */
+        size_t row_size = (size_t) source->width() * channels,
+               grain_size = std::max((size_t) 1, (size_t) 65536 / row_size);
+
         dr::parallel_for(
-            dr::blocked_range<size_t>(0, source->width(), 100),
-            [&](const dr::blocked_range<size_t> &range) {
-                for (auto x = range.begin(); x != range.end(); ++x) {
-                    const Scalar *s = (const Scalar *) source->uint8_data() +
-                                      x * channels;
-                    Scalar *t       = (Scalar *) target->uint8_data() +
-                                      x * channels;
-                    r.resample(s, source->width(), t, target->width(), (uint32_t) channels);
-                }
+            dr::blocked_range<uint32_t>(0, target->height(), (uint32_t) grain_size),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                r.resample_rows((const Scalar *) source->uint8_data(),
+                                (Scalar *) target->uint8_data(), row_size,
+                                range.begin(), range.end());
             }
         );
     }
@@ -372,6 +421,8 @@ ref<Bitmap> Bitmap::resample(
         new Bitmap(m_pixel_format, m_component_format, res, channel_count());
     result->m_struct = m_struct;
     result->m_metadata = m_metadata;
+    result->m_exr_compression = m_exr_compression;
+    result->m_exr_channel_formats = m_exr_channel_formats;
     result->set_srgb_gamma(m_srgb_gamma);
     result->set_premultiplied_alpha(m_premultiplied_alpha);
     resample(result, rfilter, bc, bound, nullptr);
@@ -398,6 +449,7 @@ ref<Bitmap> Bitmap::convert(PixelFormat pixel_format,
     }
 
     result->m_metadata = m_metadata;
+    result->m_exr_compression = m_exr_compression;
     result->set_srgb_gamma(srgb_gamma);
     convert(result);
     return result;
@@ -519,8 +571,24 @@ void Bitmap::convert(Bitmap *target) const {
     }
 
     StructConverter conv(m_struct, target_struct, true);
-    bool rv = conv.convert_2d(m_size.x(), m_size.y(), uint8_data(), target->uint8_data());
-    if (!rv)
+
+    /* Convert blocks of rows in parallel. The block size matches the period
+       of the dither matrix so that the result is identical to a conversion
+       of the whole image at once. */
+    size_t source_row = m_size.x() * bytes_per_pixel(),
+           target_row = m_size.x() * target->bytes_per_pixel();
+    std::atomic<bool> success(true);
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, m_size.y(), 256),
+        [&](const dr::blocked_range<size_t> &range) {
+            if (!conv.convert_2d(m_size.x(), range.end() - range.begin(),
+                                 uint8_data() + range.begin() * source_row,
+                                 target->uint8_data() + range.begin() * target_row))
+                success = false;
+        }
+    );
+
+    if (!success)
         Throw("Bitmap::convert(): conversion kernel indicated a failure!");
 }
 
@@ -697,6 +765,8 @@ void Bitmap::read(Stream *stream, FileFormat format) {
         default:
             Throw("Bitmap: Unknown file format!");
     }
+
+    m_memory.set(buffer_size());
 }
 
 Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
@@ -804,12 +874,7 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
 }
 
 void Bitmap::write_async(const fs::path &path, FileFormat format, int quality) const {
-    this->inc_ref();
-    Task *task = dr::do_async([path, format, quality, this](){
-        write(path, format, quality);
-        this->dec_ref();
-    });
-    Thread::register_task(task);
+    BitmapWriter::instance()->write(this, path, format, quality);
 }
 
 bool Bitmap::operator==(const Bitmap &bitmap) const {
@@ -867,6 +932,8 @@ public:
         m_stream(stream) {
         m_offset = stream->tell();
         m_size = stream->size();
+        if (auto ms = dynamic_cast<MemoryStream *>(stream); ms && !ms->owns_buffer())
+            m_buffer = ms->raw_buffer();
     }
 
     bool read(char *c, int n) override {
@@ -883,9 +950,22 @@ public:
     }
 
     void clear() override { }
+
+    /* Streams over a memory mapping let OpenEXR access the pixel data of
+       uncompressed files in place instead of copying it to a line buffer */
+    bool isMemoryMapped() const override { return m_buffer != nullptr; }
+
+    char *readMemoryMapped(int n) override {
+        size_t pos = m_stream->tell();
+        if (pos + (size_t) n > m_size)
+            Throw("EXRIStream: attempted to read past the end of the stream!");
+        m_stream->seek(pos + (size_t) n);
+        return (char *) m_buffer + pos;
+    }
 private:
     ref<Stream> m_stream;
     size_t m_offset, m_size;
+    const uint8_t *m_buffer = nullptr;
 };
 
 class EXROStream : public Imf::OStream {
@@ -900,6 +980,9 @@ private:
     ref<Stream> m_stream;
 };
 
+/// Number of pixels processed by each task of the post-processing passes of \ref read_exr()
+static constexpr size_t exr_pixel_block_size = 1 << 16;
+
 /// Dispatch parallel OpenEXR work via nanothread
 class EXRThreadPool : public IlmThread::ThreadPoolProvider {
 public:
@@ -978,6 +1061,15 @@ void Bitmap::read_exr(Stream *stream) {
     m_struct = new Struct();
     Imf::PixelType pixel_type = channels.begin().channel().type;
 
+    /* Files with channels of different precision (e.g. half precision albedo
+       and single precision depth AOVs) are loaded in single precision */
+    for (auto it = channels.begin(); it != channels.end(); ++it) {
+        if (it.channel().type != pixel_type) {
+            pixel_type = Imf::FLOAT;
+            break;
+        }
+    }
+
     switch (pixel_type) {
         case Imf::HALF:  m_component_format = Struct::Type::Float16; break;
         case Imf::FLOAT: m_component_format = Struct::Type::Float32; break;
@@ -1163,14 +1255,21 @@ void Bitmap::read_exr(Stream *stream) {
         const Struct::Field &field = m_struct->field(buf.first);
 
         size_t comp_size = field.size;
-        uint8_t *dst = uint8_data() + field.offset;
-        uint8_t *src = buf.second->uint8_data();
+        uint8_t *dst_base = uint8_data() + field.offset;
+        const uint8_t *src_base = buf.second->uint8_data();
 
-        for (size_t j=0; j<pixel_count; ++j) {
-            memcpy(dst, src, comp_size);
-            src += comp_size;
-            dst += pixel_stride;
-        }
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, pixel_count, exr_pixel_block_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                const uint8_t *src = src_base + range.begin() * comp_size;
+                uint8_t *dst = dst_base + range.begin() * pixel_stride;
+                for (size_t j = range.begin(); j != range.end(); ++j) {
+                    memcpy(dst, src, comp_size);
+                    src += comp_size;
+                    dst += pixel_stride;
+                }
+            }
+        );
 
         buf.second = nullptr;
     }
@@ -1179,33 +1278,39 @@ void Bitmap::read_exr(Stream *stream) {
         Log(Debug, "Converting from Luminance-Chroma to RGB format ..");
         Imath::V3f yw = Imf::RgbaYca::computeYw(file_chroma);
 
-        auto convert = [&](auto *data) {
-            using T = std::decay_t<decltype(*data)>;
-
-            for (size_t j = 0; j < pixel_count; ++j) {
-                Float Y  = (Float) data[0],
-                      RY = (Float) data[1],
-                      BY = (Float) data[2];
-
-                if (std::is_integral<T>::value) {
-                    Float scale = Float(1) / Float(std::numeric_limits<T>::max());
-                    Y *= scale; RY *= scale; BY *= scale;
+        auto convert = [&](auto *data_base) {
+            using T = std::decay_t<decltype(*data_base)>;
+
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, pixel_count, exr_pixel_block_size),
+                [&](const dr::blocked_range<size_t> &range) {
+                    T *data = data_base + range.begin() * channel_count();
+                    for (size_t j = range.begin(); j != range.end(); ++j) {
+                        Float Y  = (Float) data[0],
+                              RY = (Float) data[1],
+                              BY = (Float) data[2];
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = Float(1) / Float(std::numeric_limits<T>::max());
+                            Y *= scale; RY *= scale; BY *= scale;
+                        }
+
+                        Float R = (RY + 1.f) * Y,
+                              B = (BY + 1.f) * Y,
+                              G = ((Y - R * yw.x - B * yw.z) / yw.y);
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = Float(std::numeric_limits<T>::max());
+                            R *= R * scale + .5f;
+                            G *= G * scale + .5f;
+                            B *= B * scale + .5f;
+                        }
+
+                        data[0] = T(R); data[1] = T(G); data[2] = T(B);
+                        data += channel_count();
+                    }
                 }
-
-                Float R = (RY + 1.f) * Y,
-                      B = (BY + 1.f) * Y,
-                      G = ((Y - R * yw.x - B * yw.z) / yw.y);
-
-                if (std::is_integral<T>::value) {
-                    Float scale = Float(std::numeric_limits<T>::max());
-                    R *= R * scale + .5f;
-                    G *= G * scale + .5f;
-                    B *= B * scale + .5f;
-                }
-
-                data[0] = T(R); data[1] = T(G); data[2] = T(B);
-                data += channel_count();
-            }
+            );
         };
 
         switch (m_component_format) {
@@ -1251,32 +1356,38 @@ void Bitmap::read_exr(Stream *stream) {
 
         Log(Debug, "Converting to sRGB color space ..");
 
-        auto convert = [&](auto *data) {
-            using T = std::decay_t<decltype(*data)>;
-
-            for (size_t j = 0; j < pixel_count; ++j) {
-                Float R = (Float) data[0],
-                      G = (Float) data[1],
-                      B = (Float) data[2];
-
-                if (std::is_integral<T>::value) {
-                    Float scale = Float(1) / Float(std::numeric_limits<T>::max());
-                    R *= scale; G *= scale; B *= scale;
+        auto convert = [&](auto *data_base) {
+            using T = std::decay_t<decltype(*data_base)>;
+
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, pixel_count, exr_pixel_block_size),
+                [&](const dr::blocked_range<size_t> &range) {
+                    T *data = data_base + range.begin() * channel_count();
+                    for (size_t j = range.begin(); j != range.end(); ++j) {
+                        Float R = (Float) data[0],
+                              G = (Float) data[1],
+                              B = (Float) data[2];
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = Float(1) / Float(std::numeric_limits<T>::max());
+                            R *= scale; G *= scale; B *= scale;
+                        }
+
+                        Imath::V3f rgb = Imath::V3f(float(R), float(G), float(B)) * M;
+                        R = Float(rgb[0]); G = Float(rgb[1]); B = Float(rgb[2]);
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = Float(std::numeric_limits<T>::max());
+                            R *= R * scale + 0.5f;
+                            G *= G * scale + 0.5f;
+                            B *= B * scale + 0.5f;
+                        }
+
+                        data[0] = T(R); data[1] = T(G); data[2] = T(B);
+                        data += channel_count();
+                    }
                 }
-
-                Imath::V3f rgb = Imath::V3f(float(R), float(G), float(B)) * M;
-                R = Float(rgb[0]); G = Float(rgb[1]); B = Float(rgb[2]);
-
-                if (std::is_integral<T>::value) {
-                    Float scale = Float(std::numeric_limits<T>::max());
-                    R *= R * scale + 0.5f;
-                    G *= G * scale + 0.5f;
-                    B *= B * scale + 0.5f;
-                }
-
-                data[0] = T(R); data[1] = T(G); data[2] = T(B);
-                data += channel_count();
-            }
+            );
         };
 
         switch (m_component_format) {
@@ -1309,7 +1420,23 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
         quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
     );
 
-    if (quality > 0)
+    switch (m_exr_compression) {
+        case EXRCompression::Default: break;
+        case EXRCompression::None:  header.compression() = Imf::NO_COMPRESSION; break;
+        case EXRCompression::RLE:   header.compression() = Imf::RLE_COMPRESSION; break;
+        case EXRCompression::ZIPS:  header.compression() = Imf::ZIPS_COMPRESSION; break;
+        case EXRCompression::ZIP:   header.compression() = Imf::ZIP_COMPRESSION; break;
+        case EXRCompression::PIZ:   header.compression() = Imf::PIZ_COMPRESSION; break;
+        case EXRCompression::PXR24: header.compression() = Imf::PXR24_COMPRESSION; break;
+        case EXRCompression::B44:   header.compression() = Imf::B44_COMPRESSION; break;
+        case EXRCompression::B44A:  header.compression() = Imf::B44A_COMPRESSION; break;
+        case EXRCompression::DWAA:  header.compression() = Imf::DWAA_COMPRESSION; break;
+        case EXRCompression::DWAB:  header.compression() = Imf::DWAB_COMPRESSION; break;
+        default: Throw("write_exr(): unknown compression method!");
+    }
+
+    if (quality > 0 && (header.compression() == Imf::DWAA_COMPRESSION ||
+                        header.compression() == Imf::DWAB_COMPRESSION))
         Imf::addDwaCompressionLevel(header, float(quality));
 
     for (auto it = keys.begin(); it != keys.end(); ++it) {
@@ -1369,17 +1496,22 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
     Imf::ChannelList &channels = header.channels();
     Imf::FrameBuffer framebuffer;
     const uint8_t *ptr = uint8_data();
-    for (auto field : *m_struct) {
-        Imf::PixelType comp_type;
-        switch (field.type) {
-            case Struct::Type::Float32: comp_type = Imf::FLOAT; break;
-            case Struct::Type::Float16: comp_type = Imf::HALF; break;
-            case Struct::Type::UInt32: comp_type = Imf::UINT; break;
+    auto pixel_type = [](Struct::Type type) {
+        switch (type) {
+            case Struct::Type::Float32: return Imf::FLOAT;
+            case Struct::Type::Float16: return Imf::HALF;
+            case Struct::Type::UInt32: return Imf::UINT;
             default: Throw("Unexpected field type!");
         }
+    };
 
-        Imf::Slice slice(comp_type, (char *) (ptr + field.offset), pixel_stride, row_stride);
-        channels.insert(field.name, Imf::Channel(comp_type));
+    for (auto field : *m_struct) {
+        /* The channel may be stored with a different precision than the
+           one of the bitmap (OpenEXR converts the samples while writing) */
+        Imf::Slice slice(pixel_type(field.type), (char *) (ptr + field.offset),
+                         pixel_stride, row_stride);
+        channels.insert(field.name,
+                        Imf::Channel(pixel_type(exr_channel_format(field.name))));
         framebuffer.insert(field.name, slice);
     }
 
@@ -2197,6 +2329,40 @@ void Bitmap::read_pfm(Stream *stream) {
 
     size_t size = size_in_bytes / sizeof(float);
     float *data = (float *) uint8_data();
+    float scale = dr::abs(scale_and_order);
+
+    auto ms = dynamic_cast<MemoryStream *>(stream);
+    if (ms && !ms->owns_buffer()) {
+        /* The stream wraps a memory mapping: copy the scanlines (which are
+           stored from bottom to top) directly into place. This fuses the
+           read and the vertical flip, and avoids an intermediate buffer. */
+        size_t offset = ms->tell(),
+               row_size = size_in_bytes / m_size.y();
+        if (offset + size_in_bytes > ms->size())
+            Throw("read_pfm(): file is truncated!");
+        const uint8_t *src = ms->raw_buffer() + offset;
+        for (size_t y = 0; y < m_size.y(); ++y)
+            memcpy(m_data.get() + row_size * (m_size.y() - 1 - y),
+                   src + row_size * y, row_size);
+        ms->seek(offset + size_in_bytes);
+
+        Stream::EByteOrder file_order =
+            scale_and_order <= 0.f ? Stream::ELittleEndian : Stream::EBigEndian;
+        if (file_order != Stream::host_byte_order()) {
+            uint32_t *words = (uint32_t *) data;
+            for (size_t i = 0; i < size; ++i) {
+                uint32_t v = words[i];
+                words[i] = (v >> 24) | ((v >> 8) & 0xFF00u) |
+                           ((v << 8) & 0xFF0000u) | (v << 24);
+            }
+        }
+
+        if (scale != 1) {
+            for (size_t i = 0; i < size; ++i)
+                data[i] *= scale;
+        }
+        return;
+    }
 
     auto byte_order = stream->byte_order();
     stream->set_byte_order(scale_and_order <= 0.f ? Stream::ELittleEndian : Stream::EBigEndian);
@@ -2209,7 +2375,6 @@ void Bitmap::read_pfm(Stream *stream) {
     }
     stream->set_byte_order(byte_order);
 
-    float scale = dr::abs(scale_and_order);
     if (scale != 1) {
         for (size_t i = 0; i < size; ++i)
             data[i] *= scale;
@@ -2486,6 +2651,24 @@ std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value) {
     return os;
 }
 
+std::ostream &operator<<(std::ostream &os, Bitmap::EXRCompression value) {
+    switch (value) {
+        case Bitmap::EXRCompression::Default: os << "Default"; break;
+        case Bitmap::EXRCompression::None:    os << "None"; break;
+        case Bitmap::EXRCompression::RLE:     os << "RLE"; break;
+        case Bitmap::EXRCompression::ZIPS:    os << "ZIPS"; break;
+        case Bitmap::EXRCompression::ZIP:     os << "ZIP"; break;
+        case Bitmap::EXRCompression::PIZ:     os << "PIZ"; break;
+        case Bitmap::EXRCompression::PXR24:   os << "PXR24"; break;
+        case Bitmap::EXRCompression::B44:     os << "B44"; break;
+        case Bitmap::EXRCompression::B44A:    os << "B44A"; break;
+        case Bitmap::EXRCompression::DWAA:    os << "DWAA"; break;
+        case Bitmap::EXRCompression::DWAB:    os << "DWAB"; break;
+        default: Throw("Unknown EXR compression method!");
+    }
+    return os;
+}
+
 std::ostream &operator<<(std::ostream &os, Bitmap::AlphaTransform value) {
     switch (value) {
         case Bitmap::AlphaTransform::Empty:    os << "none";    break;
@@ -0,0 +1,181 @@
+#include <mitsuba/core/bitmapwriter.h>
+#include <mitsuba/core/logger.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Worker thread of a \ref BitmapWriter
+class BitmapWriterThread : public Thread {
+public:
+    BitmapWriterThread(BitmapWriter *writer, size_t index)
+        : Thread(tfm::format("bmw%zu", index)), m_writer(writer) { }
+
+    virtual void run() override { m_writer->run_worker(); }
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~BitmapWriterThread() { }
+
+private:
+    BitmapWriter *m_writer;
+};
+
+static ref<BitmapWriter> bitmap_writer_instance;
+static std::mutex bitmap_writer_instance_mutex;
+
+BitmapWriter::BitmapWriter(size_t worker_count, size_t queue_capacity, int quality)
+    : m_queue_capacity(queue_capacity), m_quality(quality) {
+    if (worker_count == 0)
+        Throw("BitmapWriter: at least one worker thread is required!");
+    if (queue_capacity == 0)
+        Throw("BitmapWriter: the queue capacity must be nonzero!");
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        ref<Thread> thread = new BitmapWriterThread(this, i);
+        thread->start();
+        m_workers.push_back(thread);
+    }
+}
+
+BitmapWriter::~BitmapWriter() {
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_shutdown = true;
+    }
+    m_cv_request.notify_all();
+
+    // The workers complete the queued requests before exiting
+    for (auto &thread : m_workers)
+        thread->join();
+
+    if (m_error) {
+        try {
+            std::rethrow_exception(m_error);
+        } catch (const std::exception &e) {
+            Log(Warn, "BitmapWriter: an image could not be written: %s", e.what());
+        } catch (...) { }
+    }
+}
+
+std::shared_future<void> BitmapWriter::write(const Bitmap *bitmap,
+                                             const fs::path &path,
+                                             Bitmap::FileFormat format,
+                                             int quality) {
+    Request request;
+    request.bitmap = bitmap;
+    request.path = path;
+    request.format = format;
+    request.quality = quality == -1 ? m_quality : quality;
+    std::shared_future<void> future = request.promise.get_future().share();
+
+    {
+        std::unique_lock<std::mutex> guard(m_mutex);
+        m_cv_space.wait(guard, [&] {
+            return m_queue.size() < m_queue_capacity || m_shutdown;
+        });
+        if (m_shutdown)
+            Throw("BitmapWriter::write(): the writer is shutting down!");
+        m_queue.push_back(std::move(request));
+        m_pending++;
+    }
+    m_cv_request.notify_one();
+
+    return future;
+}
+
+void BitmapWriter::run_worker() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            m_cv_request.wait(guard, [&] { return !m_queue.empty() || m_shutdown; });
+            if (m_queue.empty())
+                return; // Shutting down
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_cv_space.notify_one();
+
+        std::exception_ptr error;
+        try {
+            request.bitmap->write(request.path, request.format, request.quality);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // Release the image before signaling completion
+        request.bitmap = nullptr;
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (error && !m_error)
+                m_error = error;
+            m_pending--;
+        }
+        m_cv_done.notify_all();
+
+        if (error)
+            request.promise.set_exception(error);
+        else
+            request.promise.set_value();
+    }
+}
+
+void BitmapWriter::flush() {
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> guard(m_mutex);
+        m_cv_done.wait(guard, [&] { return m_pending == 0; });
+        std::swap(error, m_error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+size_t BitmapWriter::pending() const {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_pending;
+}
+
+BitmapWriter *BitmapWriter::instance() {
+    std::lock_guard<std::mutex> guard(bitmap_writer_instance_mutex);
+    if (!bitmap_writer_instance)
+        bitmap_writer_instance = new BitmapWriter();
+    return bitmap_writer_instance.get();
+}
+
+void BitmapWriter::set_instance(BitmapWriter *writer) {
+    ref<BitmapWriter> previous;
+    {
+        std::lock_guard<std::mutex> guard(bitmap_writer_instance_mutex);
+        previous = bitmap_writer_instance;
+        bitmap_writer_instance = writer;
+    }
+    if (previous)
+        previous->flush();
+}
+
+void BitmapWriter::static_shutdown() {
+    ref<BitmapWriter> previous;
+    {
+        std::lock_guard<std::mutex> guard(bitmap_writer_instance_mutex);
+        previous = bitmap_writer_instance;
+        bitmap_writer_instance = nullptr;
+    }
+    // The destructor completes the pending requests and reports errors
+}
+
+std::string BitmapWriter::to_string() const {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::ostringstream oss;
+    oss << "BitmapWriter[" << std::endl
+        << "  worker_count = " << m_workers.size() << "," << std::endl
+        << "  queue_capacity = " << m_queue_capacity << "," << std::endl
+        << "  quality = " << m_quality << "," << std::endl
+        << "  pending = " << m_pending << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(BitmapWriterThread, Thread)
+MI_IMPLEMENT_CLASS(BitmapWriter, Object)
+NAMESPACE_END(mitsuba)
@@ -107,8 +107,12 @@ ref<Object> Class::unserialize(Stream *stream) const {
 }
 
 void Class::static_initialization() {
-    for (auto &pair : *__classes)
-        initialize_once(pair.second);
+    /* This function runs again whenever a plugin is loaded. Only link up the
+       classes that were registered since then. */
+    for (auto &pair : *__classes) {
+        if (!pair.second->m_parent)
+            initialize_once(pair.second);
+    }
     m_is_initialized = true;
 }
 
@@ -1,33 +1,102 @@
 #include <mitsuba/core/fresolver.h>
 #include <sstream>
 #include <algorithm>
+#include <nanothread/nanothread.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Maximum number of cached lookups, the cache is flushed when it is full
+static constexpr size_t fresolver_cache_size = 4096;
+
 FileResolver::FileResolver() : Object() {
     m_paths.push_back(fs::current_path());
 }
 
 FileResolver::FileResolver(const FileResolver &fr)
-  : Object(), m_paths(fr.m_paths) { }
+  : Object(), m_paths(fr.m_paths) {
+    std::lock_guard<std::mutex> guard(fr.m_cache_mutex);
+    m_cache = fr.m_cache;
+}
 
 void FileResolver::erase(const fs::path &p) {
+    clear_cache();
     m_paths.erase(std::remove(m_paths.begin(), m_paths.end(), p), m_paths.end());
 }
 
+void FileResolver::prepend(const fs::path &path) {
+    // The new search path may shadow any previous lookup result
+    clear_cache();
+    m_paths.insert(m_paths.begin(), path);
+}
+
+void FileResolver::append(const fs::path &path) {
+    // Cached lookups succeeded on an earlier search path and remain valid
+    m_paths.push_back(path);
+}
+
+void FileResolver::clear_cache() {
+    std::lock_guard<std::mutex> guard(m_cache_mutex);
+    m_cache.clear();
+}
+
 bool FileResolver::contains(const fs::path &p) const {
     return std::find(m_paths.begin(), m_paths.end(), p) != m_paths.end();
 }
 
+fs::path FileResolver::resolve_uncached(const fs::path &path) const {
+    for (auto const &base : m_paths) {
+        fs::path combined = base / path;
+        if (fs::exists(combined))
+            return combined;
+    }
+    return fs::path();
+}
+
 fs::path FileResolver::resolve(const fs::path &path) const {
-    if (!path.is_absolute()) {
-        for (auto const &base : m_paths) {
-            fs::path combined = base / path;
-            if (fs::exists(combined))
-                return combined;
+    if (path.is_absolute() || path.empty())
+        return path;
+
+    std::string key = path.string();
+    {
+        std::lock_guard<std::mutex> guard(m_cache_mutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end())
+            return it->second;
+    }
+
+    fs::path result = resolve_uncached(path);
+    if (result.empty())
+        return path; // Failed lookups are not cached, the file may appear later
+
+    {
+        std::lock_guard<std::mutex> guard(m_cache_mutex);
+        if (m_cache.size() >= fresolver_cache_size)
+            m_cache.clear();
+        m_cache[key] = result;
+    }
+
+    return result;
+}
+
+void FileResolver::prefetch(const std::vector<fs::path> &paths) const {
+    std::vector<fs::path> pending;
+    {
+        std::lock_guard<std::mutex> guard(m_cache_mutex);
+        for (const fs::path &path : paths) {
+            if (!path.is_absolute() && !path.empty() &&
+                m_cache.find(path.string()) == m_cache.end())
+                pending.push_back(path);
         }
     }
-    return path;
+
+    // File system queries are latency-bound, hence the fine granularity
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, pending.size(), 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                (void) resolve(pending[i]);
+        }
+    );
 }
 
 std::string FileResolver::to_string() const {
@@ -1,9 +1,13 @@
 #include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
+#include <cstdlib>
 
 NAMESPACE_BEGIN(mitsuba)
 
 static Jit *jit = nullptr;
+static fs::path jit_cache_dir;
 
 Jit::Jit() { }
 Jit *Jit::get_instance() { return jit; }
@@ -21,4 +25,69 @@ void Jit::static_shutdown() {
 #endif
 }
 
+void Jit::init_backend(uint32_t backends, const fs::path &cache_dir) {
+#if defined(MI_ENABLE_LLVM) || defined(MI_ENABLE_CUDA)
+    if (cache_dir.empty()) {
+        jit_init(backends);
+        return;
+    }
+
+#if defined(_WIN32)
+    Log(Warn, "Custom kernel cache directories are not supported on Windows, "
+              "using the default location.");
+    jit_init(backends);
+#else
+    if (!fs::exists(cache_dir) && !fs::create_directory(cache_dir))
+        Throw("Could not create the kernel cache directory \"%s\"!",
+              cache_dir.string());
+
+    /* Dr.Jit resolves the location of its kernel cache once during
+       initialization, the variable is set before any kernel is compiled */
+    fs::path drjit_dir = fs::absolute(cache_dir) / ".drjit";
+    setenv("DRJIT_CACHE_DIR", drjit_dir.string().c_str(), 1);
+    jit_init(backends);
+
+    jit_cache_dir = fs::absolute(cache_dir);
+    Log(Info, "Caching compiled kernels in \"%s\".", drjit_dir.string());
+#endif
+#else
+    (void) backends; (void) cache_dir;
+#endif
+}
+
+const fs::path &Jit::cache_dir() { return jit_cache_dir; }
+
+Jit::KernelStats Jit::kernel_stats() {
+    KernelStats stats;
+#if defined(MI_ENABLE_LLVM) || defined(MI_ENABLE_CUDA)
+    KernelHistoryEntry *history = jit_kernel_history();
+    for (KernelHistoryEntry *e = history; e && (uint32_t) e->backend; ++e) {
+        if (e->type != KernelType::JIT)
+            continue;
+        stats.launches++;
+        if (e->cache_disk)
+            stats.disk_hits++;
+        else if (e->cache_hit)
+            stats.memory_hits++;
+        stats.codegen_time   += e->codegen_time;
+        stats.backend_time   += e->backend_time;
+        stats.execution_time += e->execution_time;
+    }
+    free(history);
+#endif
+    return stats;
+}
+
+std::string Jit::KernelStats::to_string() const {
+    std::ostringstream oss;
+    oss << launches << " kernel launches (" << memory_hits << " reused, "
+        << disk_hits << " loaded from the cache, "
+        << launches - memory_hits - disk_hits << " compiled; "
+        << tfm::format("%.1f%% hit rate", 100.f * hit_rate()) << "), "
+        << "codegen: " << util::time_string(codegen_time)
+        << ", compilation: " << util::time_string(backend_time)
+        << ", execution: " << util::time_string(execution_time);
+    return oss.str();
+}
+
 NAMESPACE_END(mitsuba)
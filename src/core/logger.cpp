@@ -7,21 +7,205 @@
 #include <thread>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Bounded lock-free queue with multiple producers and a single
+ * consumer (based on Dmitry Vyukov's bounded MPMC queue)
+ */
+struct LogQueue {
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        std::string text;
+    };
+
+    static constexpr size_t Size = 4096;
+
+    LogQueue() : slots(new Slot[Size]) {
+        for (size_t i = 0; i < Size; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /// Enqueue a message, returns \c false if the queue is full
+    bool push(LogLevel level, std::string &&text) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[pos % Size];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->level = level;
+        slot->text = std::move(text);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Dequeue a message (consumer thread only)
+    bool pop(LogLevel &level, std::string &text) {
+        Slot *slot = &slots[tail % Size];
+        if (slot->sequence.load(std::memory_order_acquire) != tail + 1)
+            return false;
+        level = slot->level;
+        text = std::move(slot->text);
+        slot->sequence.store(tail + Size, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<size_t> head { 0 };
+    size_t tail = 0;
+};
+
 struct Logger::LoggerPrivate {
     std::mutex mutex;
     LogLevel error_level = Error;
     std::vector<ref<Appender>> appenders;
     ref<Formatter> formatter;
+
+    /// State of the asynchronous mode
+    std::unique_ptr<LogQueue> queue;
+    std::thread worker;
+    std::atomic<bool> async { false }, stop { false };
+    std::atomic<size_t> submitted { 0 }, processed { 0 };
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+
+    /* Messages submitted while the queue is full. Producers never wait for
+       the background thread, which may itself wait for a lock held by the
+       producer (e.g. Python's GIL when an appender is implemented in Python).
+       While this list is non-empty, new messages are appended to it as well,
+       so that the messages of each thread stay in order. */
+    std::mutex overflow_mutex;
+    std::vector<std::pair<LogLevel, std::string>> overflow;
+    std::atomic<bool> overflowing { false };
+
+    void submit(LogLevel level, std::string &&text) {
+        submitted.fetch_add(1, std::memory_order_relaxed);
+        if (!overflowing.load(std::memory_order_acquire) &&
+            queue->push(level, std::move(text)))
+            return;
+
+        std::lock_guard<std::mutex> guard(overflow_mutex);
+        overflow.emplace_back(level, std::move(text));
+        overflowing.store(true, std::memory_order_release);
+        wake.notify_one();
+    }
+
+    void append(LogLevel level, const std::string &text) {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto entry : appenders)
+            entry->append(level, text);
+    }
+
+    void run() {
+        LogLevel level;
+        std::string text;
+        while (true) {
+            bool stopping = stop.load(std::memory_order_acquire);
+            bool empty = true;
+            while (queue->pop(level, text)) {
+                empty = false;
+                append(level, text);
+                processed.fetch_add(1, std::memory_order_release);
+            }
+
+            std::vector<std::pair<LogLevel, std::string>> pending;
+            if (overflowing.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> guard(overflow_mutex);
+                /* Messages of the queue are older than the ones that
+                   overflowed, wait until all claimed slots are published.
+                   The appenders are only invoked after releasing the lock. */
+                size_t end = queue->head.load(std::memory_order_acquire);
+                while (queue->tail != end) {
+                    if (queue->pop(level, text))
+                        pending.emplace_back(level, std::move(text));
+                    else
+                        std::this_thread::yield();
+                }
+                for (auto &entry : overflow)
+                    pending.push_back(std::move(entry));
+                overflow.clear();
+                overflowing.store(false, std::memory_order_release);
+            }
+            for (auto &entry : pending) {
+                empty = false;
+                append(entry.first, entry.second);
+                processed.fetch_add(1, std::memory_order_release);
+            }
+
+            if (empty) {
+                if (stopping)
+                    break;
+                /* Producers don't synchronize with this wait, hence the
+                   timeout bounds the latency of a missed notification */
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                wake.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+    }
+
+    void flush() {
+        if (!queue)
+            return;
+        size_t target = submitted.load(std::memory_order_acquire);
+        while (processed.load(std::memory_order_acquire) < target) {
+            wake.notify_one();
+            std::this_thread::yield();
+        }
+    }
 };
 
 Logger::Logger(LogLevel log_level)
     : m_log_level(log_level), d(new LoggerPrivate()) { }
 
-Logger::~Logger() { }
+Logger::~Logger() {
+    set_async(false);
+}
+
+void Logger::set_async(bool value) {
+    if (value == d->async.load())
+        return;
+
+    if (value) {
+        d->queue = std::make_unique<LogQueue>();
+        d->submitted.store(0);
+        d->processed.store(0);
+        d->stop.store(false);
+        d->worker = std::thread([p = d.get()]() { p->run(); });
+        d->async.store(true, std::memory_order_release);
+    } else {
+        d->async.store(false, std::memory_order_release);
+        d->stop.store(true, std::memory_order_release);
+        d->wake.notify_one();
+        d->worker.join();
+        d->queue.reset();
+    }
+}
+
+bool Logger::is_async() const {
+    return d->async.load(std::memory_order_acquire);
+}
+
+void Logger::flush() {
+    if (is_async())
+        d->flush();
+}
 
 void Logger::set_formatter(Formatter *formatter) {
     std::lock_guard<std::mutex> guard(d->mutex);
@@ -68,9 +252,12 @@ void Logger::log(LogLevel level, const Class *class_, const char *file,
     std::string text = d->formatter->format(level, class_,
         Thread::thread(), file, line, msg);
 
-    std::lock_guard<std::mutex> guard(d->mutex);
-    for (auto entry : d->appenders)
-        entry->append(level, text);
+    if (d->async.load(std::memory_order_acquire)) {
+        d->submit(level, std::move(text));
+        return;
+    }
+
+    d->append(level, text);
 }
 
 void Logger::log_progress(float progress, const std::string &name,
@@ -92,6 +279,7 @@ void Logger::remove_appender(Appender *appender) {
 }
 
 std::string Logger::read_log() {
+    flush();
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto appender: d->appenders) {
         if (appender->class_()->derives_from(MI_CLASS(StreamAppender))) {
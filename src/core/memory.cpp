@@ -0,0 +1,103 @@
+#include <mitsuba/core/memory.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/util.h>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+NAMESPACE_BEGIN(detail)
+static constexpr uint32_t memory_category_count =
+    uint32_t(MemoryCategory::MemoryCategoryCount);
+
+static std::atomic<int64_t> memory_host[memory_category_count] { },
+                            memory_device[memory_category_count] { };
+static std::atomic<int64_t> memory_total { 0 }, memory_peak { 0 };
+static std::atomic<size_t> memory_budget { 0 };
+/// Was the budget exceeded by the last update? (avoids repeated warnings)
+static std::atomic<bool> memory_over_budget { false };
+NAMESPACE_END(detail)
+
+std::pair<size_t, size_t> MemoryTracker::usage(MemoryCategory category) {
+    uint32_t i = (uint32_t) category;
+    return { (size_t) std::max(detail::memory_host[i].load(), (int64_t) 0),
+             (size_t) std::max(detail::memory_device[i].load(), (int64_t) 0) };
+}
+
+std::pair<size_t, size_t> MemoryTracker::total() {
+    size_t host = 0, device = 0;
+    for (uint32_t i = 0; i < detail::memory_category_count; ++i) {
+        auto [h, d] = usage((MemoryCategory) i);
+        host += h;
+        device += d;
+    }
+    return { host, device };
+}
+
+size_t MemoryTracker::peak() {
+    return (size_t) std::max(detail::memory_peak.load(), (int64_t) 0);
+}
+
+void MemoryTracker::reset_peak() {
+    detail::memory_peak = detail::memory_total.load();
+}
+
+void MemoryTracker::set_budget(size_t budget) {
+    detail::memory_budget = budget;
+    detail::memory_over_budget = false;
+}
+
+size_t MemoryTracker::budget() {
+    return detail::memory_budget;
+}
+
+void MemoryTracker::add(MemoryCategory category, int64_t host, int64_t device) {
+    using namespace detail;
+    uint32_t i = (uint32_t) category;
+    if (host)
+        memory_host[i].fetch_add(host, std::memory_order_relaxed);
+    if (device)
+        memory_device[i].fetch_add(device, std::memory_order_relaxed);
+
+    int64_t total = memory_total.fetch_add(host + device, std::memory_order_relaxed) +
+                    host + device;
+
+    int64_t peak = memory_peak.load(std::memory_order_relaxed);
+    while (total > peak &&
+           !memory_peak.compare_exchange_weak(peak, total, std::memory_order_relaxed))
+        ;
+
+    size_t budget = memory_budget.load(std::memory_order_relaxed);
+    if (budget == 0)
+        return;
+
+    bool over_budget = total > (int64_t) budget;
+    if (over_budget && !memory_over_budget.exchange(true))
+        Log(Warn, "Memory usage (%s) exceeds the budget of %s after "
+                  "registering %s of %s!\n%s",
+            util::mem_string((size_t) total), util::mem_string(budget),
+            util::mem_string((size_t) std::max(host + device, (int64_t) 0)),
+            memory_category_id[i], to_string());
+    else if (!over_budget && memory_over_budget.load(std::memory_order_relaxed))
+        memory_over_budget = false;
+}
+
+std::string MemoryTracker::to_string() {
+    std::ostringstream oss;
+    oss << "Memory usage:" << std::endl;
+    for (uint32_t i = 0; i < detail::memory_category_count; ++i) {
+        auto [host, device] = usage((MemoryCategory) i);
+        oss << tfm::format("  %-30s: %10s host, %10s device",
+                           memory_category_id[i], util::mem_string(host),
+                           util::mem_string(device)) << std::endl;
+    }
+    auto [host, device] = total();
+    oss << tfm::format("  %-30s: %10s host, %10s device", "Total",
+                       util::mem_string(host), util::mem_string(device)) << std::endl
+        << tfm::format("  %-30s: %10s", "Peak", util::mem_string(peak()));
+    if (size_t budget = detail::memory_budget; budget > 0)
+        oss << std::endl << tfm::format("  %-30s: %10s", "Budget",
+                                        util::mem_string(budget));
+    return oss.str();
+}
+
+NAMESPACE_END(mitsuba)
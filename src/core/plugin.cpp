@@ -4,6 +4,9 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/string.h>
+#include <algorithm>
+#include <fstream>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -90,6 +93,49 @@ struct PluginManager::PluginManagerPrivate {
     std::unordered_set<std::string> m_python_plugins;
     std::mutex m_mutex;
 
+    /// Plugin name -> library path, as listed in the plugin manifest
+    std::unordered_map<std::string, fs::path> m_manifest;
+    /// Variants that the plugins were compiled for
+    std::unordered_set<std::string> m_manifest_variants;
+    bool m_manifest_loaded = false;
+
+    /**
+     * Read the manifest "plugins/manifest.txt" that is generated by the build
+     * system. It lists the available plugins along with their library files,
+     * which avoids probing the file resolver search path for every plugin
+     * that is referenced by a scene. Plugins that are not listed are located
+     * through the file resolver. Must be called with the mutex held.
+     */
+    void load_manifest() {
+        if (m_manifest_loaded)
+            return;
+        m_manifest_loaded = true;
+
+        const FileResolver *resolver = Thread::thread()->file_resolver();
+        fs::path filename = resolver->resolve(fs::path("plugins") / "manifest.txt");
+        if (!fs::exists(filename))
+            return;
+
+        std::ifstream is(filename.native());
+        std::string line;
+        while (std::getline(is, line)) {
+            auto tokens = string::tokenize(line, " \t\r");
+            if (tokens.empty() || tokens[0][0] == '#')
+                continue;
+            if (tokens[0] == "variants") {
+                m_manifest_variants.insert(tokens.begin() + 1, tokens.end());
+            } else if (tokens[0] == "plugin" && tokens.size() == 4) {
+                m_manifest[tokens[1]] = filename.parent_path() / tokens[3];
+            } else {
+                Log(Warn, "Ignoring malformed line in the plugin manifest "
+                          "\"%s\": %s", filename.string(), line);
+            }
+        }
+
+        Log(Debug, "Read the plugin manifest \"%s\" (%zu plugins).",
+            filename.string(), m_manifest.size());
+    }
+
     Plugin *plugin(const std::string &name) {
         std::lock_guard<std::mutex> guard(m_mutex);
 
@@ -98,7 +144,12 @@ struct PluginManager::PluginManagerPrivate {
         if (it != m_plugins.end())
             return it->second;
 
-        // Build the full plugin file name
+        load_manifest();
+        auto it2 = m_manifest.find(name);
+        if (it2 != m_manifest.end() && fs::exists(it2->second))
+            return load(name, it2->second);
+
+        // Not listed (e.g. a third-party plugin), search for the library file
         fs::path filename = fs::path("plugins") / name;
 
         #if defined(_WIN32)
@@ -112,19 +163,22 @@ struct PluginManager::PluginManagerPrivate {
         const FileResolver *resolver = Thread::thread()->file_resolver();
         fs::path resolved = resolver->resolve(filename);
 
-        if (fs::exists(resolved)) {
-            Log(Debug, "Loading plugin \"%s\" ..", filename.string());
-            Plugin *plugin = new Plugin(resolved);
-            // New classes must be registered within the class hierarchy
-            Class::static_initialization();
-            // Statistics::instance()->log_plugin(shortName, description()); XXX
-            m_plugins[name] = plugin;
-            return plugin;
-        }
+        if (fs::exists(resolved))
+            return load(name, resolved);
 
         // Plugin not found!
         Throw("Plugin \"%s\" not found!", name.c_str());
     }
+
+    /// Load a plugin library. Must be called with the mutex held.
+    Plugin *load(const std::string &name, const fs::path &path) {
+        Log(Debug, "Loading plugin \"%s\" ..", path.string());
+        Plugin *plugin = new Plugin(path);
+        // New classes must be registered within the class hierarchy
+        Class::static_initialization();
+        m_plugins[name] = plugin;
+        return plugin;
+    }
 };
 
 ref<PluginManager> PluginManager::m_instance = new PluginManager();
@@ -152,11 +206,25 @@ const Class *PluginManager::get_plugin_class(const std::string &name,
     } else {
         const Plugin *plugin = d->plugin(name);
         plugin_class = Class::for_name(plugin->plugin_name, variant);
+        if (!plugin_class && !d->m_manifest_variants.empty() &&
+            d->m_manifest_variants.count(variant) == 0)
+            Throw("Plugin \"%s\" was not compiled for the variant \"%s\"!",
+                  name, variant);
     }
 
     return plugin_class;
 }
 
+std::vector<std::string> PluginManager::available_plugins() const {
+    std::lock_guard<std::mutex> guard(d->m_mutex);
+    d->load_manifest();
+    std::vector<std::string> list;
+    for (auto const &pair: d->m_manifest)
+        list.push_back(pair.first);
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
 std::vector<std::string> PluginManager::loaded_plugins() const {
     std::vector<std::string> list;
     std::lock_guard<std::mutex> guard(d->m_mutex);
@@ -2,6 +2,17 @@
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
 
+#if defined(MI_ENABLE_PROFILER)
+#  include <mitsuba/core/class.h>
+#  include <mitsuba/core/string.h>
+#  include <algorithm>
+#  include <cstring>
+#  include <sstream>
+#  include <vector>
+#  include <signal.h>
+#  include <sys/time.h>
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 #if defined(MI_ENABLE_ITTNOTIFY)
@@ -10,14 +21,223 @@ __itt_string_handle *
     mitsuba_itt_phase[int(ProfilerPhase::ProfilerPhaseCount)] { };
 #endif
 
+#if defined(MI_ENABLE_PROFILER)
+thread_local ProfilerThreadState profiler_state;
+
+/// Sampling interval of the profiler timer in microseconds
+static constexpr long profiler_interval_us = 1000;
+
+/// Capacity of the hash tables below (must be a power of two)
+static constexpr size_t profiler_table_size = 4096;
+
+/**
+ * Fixed-size hash table that maps a 64 bit key to a sample count. It does not
+ * allocate memory, which makes it safe to use from within a signal handler.
+ * Samples that do not fit into the table are counted as overflow.
+ */
+struct ProfilerTable {
+    std::atomic<uint64_t> keys[profiler_table_size];
+    std::atomic<uint32_t> counts[profiler_table_size];
+    std::atomic<uint32_t> overflow;
+
+    void record(uint64_t key) {
+        // Zero is reserved for unused entries
+        key += 1;
+        size_t index = (size_t) ((key * 0x9E3779B97F4A7C15ull) >> 52);
+        for (size_t i = 0; i < profiler_table_size; ++i) {
+            size_t slot = (index + i) & (profiler_table_size - 1);
+            uint64_t cur = keys[slot].load(std::memory_order_relaxed);
+            if (cur == 0 && keys[slot].compare_exchange_strong(cur, key))
+                cur = key;
+            if (cur == key) {
+                counts[slot].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename Func> void for_each(Func func) const {
+        for (size_t i = 0; i < profiler_table_size; ++i) {
+            uint64_t key = keys[i].load(std::memory_order_relaxed);
+            if (key != 0)
+                func(key - 1, counts[i].load(std::memory_order_relaxed));
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < profiler_table_size; ++i) {
+            keys[i].store(0, std::memory_order_relaxed);
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+        overflow.store(0, std::memory_order_relaxed);
+    }
+};
+
+/// Samples by the set of active phases
+static ProfilerTable profiler_phases;
+/// Samples by innermost (phase, plugin instance) pair
+static ProfilerTable profiler_objects;
+/// Plugin instances are looked up by address, this maps them back
+static const Object *profiler_object_ptr[profiler_table_size];
+static std::atomic<uint32_t> profiler_object_count { 0 };
+static std::atomic<uint32_t> profiler_samples { 0 };
+
+static void profiler_callback(int, siginfo_t *, void *) {
+    const ProfilerThreadState &state = profiler_state;
+    uint32_t depth = state.depth;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    profiler_samples.fetch_add(1, std::memory_order_relaxed);
+    profiler_phases.record(state.flags);
+
+    if (depth == 0 || depth > MI_PROFILER_MAX_DEPTH)
+        return;
+
+    // Attribute the sample to the innermost phase with an associated object
+    for (uint32_t i = depth; i-- > 0; ) {
+        const Object *object = state.objects[i];
+        if (!object)
+            continue;
+
+        uint32_t object_id = 0, count = profiler_object_count.load();
+        while (object_id < count && profiler_object_ptr[object_id] != object)
+            ++object_id;
+        if (object_id == count) {
+            if (count == profiler_table_size)
+                return;
+            object_id = profiler_object_count.fetch_add(1);
+            if (object_id >= profiler_table_size)
+                return;
+            profiler_object_ptr[object_id] = object;
+        }
+
+        profiler_objects.record(((uint64_t) object_id << 32) |
+                                (uint64_t) state.phases[i]);
+        return;
+    }
+}
+
+static std::string profiler_object_name(const Object *object) {
+    std::string name = object->class_()->name(), id = object->id();
+    if (!id.empty() && !string::starts_with(id, "_unnamed"))
+        name += " \"" + id + "\"";
+    return name;
+}
+#endif
+
 void Profiler::static_initialization() {
 #if defined(MI_ENABLE_ITTNOTIFY)
     mitsuba_itt_domain = __itt_domain_create("mitsuba");
     for (int i = 0; i < (int) ProfilerPhase::ProfilerPhaseCount; ++i)
         mitsuba_itt_phase[i] = __itt_string_handle_create(profiler_phase_id[i]);
 #endif
+
+#if defined(MI_ENABLE_PROFILER)
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sigaction));
+    sa.sa_sigaction = profiler_callback;
+    sa.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, nullptr))
+        Throw("Profiler::static_initialization(): could not install signal "
+              "handler!");
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = profiler_interval_us;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr))
+        Throw("Profiler::static_initialization(): timer could not be "
+              "initialized!");
+#endif
 }
 
-void Profiler::static_shutdown() { }
+void Profiler::static_shutdown() {
+#if defined(MI_ENABLE_PROFILER)
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(itimerval));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+#endif
+}
+
+void Profiler::print_report() {
+#if defined(MI_ENABLE_PROFILER)
+    // Suspend the timer while the tables are being read and cleared
+    struct itimerval timer, timer_old;
+    memset(&timer, 0, sizeof(itimerval));
+    setitimer(ITIMER_PROF, &timer, &timer_old);
+
+    uint32_t samples = profiler_samples.load();
+    if (samples == 0) {
+        setitimer(ITIMER_PROF, &timer_old, nullptr);
+        return;
+    }
+
+    constexpr int phase_count = (int) ProfilerPhase::ProfilerPhaseCount;
+    uint64_t inclusive[phase_count] { }, exclusive[phase_count] { };
+    profiler_phases.for_each([&](uint64_t flags, uint32_t count) {
+        if (flags == 0)
+            return;
+        for (int i = 0; i < phase_count; ++i) {
+            if (flags & (1ull << i))
+                inclusive[i] += count;
+        }
+        // Phases are partially ordered, the innermost one has the highest bit
+        exclusive[63 - __builtin_clzll(flags)] += count;
+    });
+
+    float scale = 100.f / samples;
+    auto time = [&](uint64_t count) {
+        return util::time_string(float(count * profiler_interval_us) / 1000.f);
+    };
+
+    std::ostringstream oss;
+    oss << "Profiler: recorded " << samples << " samples ("
+        << time(samples) << " of CPU time)." << std::endl << std::endl
+        << "  Phase                                        Inclusive  Exclusive"
+        << std::endl;
+    for (int i = 0; i < phase_count; ++i) {
+        if (inclusive[i] == 0)
+            continue;
+        oss << "  " << tfm::format("%-42s %9.2f%% %9.2f%%", profiler_phase_id[i],
+                                   inclusive[i] * scale, exclusive[i] * scale)
+            << std::endl;
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> objects;
+    profiler_objects.for_each([&](uint64_t key, uint32_t count) {
+        objects.emplace_back(key, count);
+    });
+    std::sort(objects.begin(), objects.end(),
+              [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    if (!objects.empty()) {
+        oss << std::endl << "  Plugin instances (exclusive time):" << std::endl;
+        for (size_t i = 0; i < std::min(objects.size(), (size_t) 20); ++i) {
+            auto [key, count] = objects[i];
+            const Object *object = profiler_object_ptr[key >> 32];
+            oss << "  " << tfm::format("%9.2f%%  %-10s  %s - %s",
+                                       count * scale, time(count),
+                                       profiler_phase_id[(uint32_t) key],
+                                       profiler_object_name(object))
+                << std::endl;
+        }
+    }
+
+    uint32_t overflow = profiler_phases.overflow + profiler_objects.overflow;
+    if (overflow > 0)
+        oss << std::endl << "  (" << overflow << " samples were dropped, "
+            << "the profiler tables are full)" << std::endl;
+
+    Log(Info, "%s", oss.str());
+
+    profiler_phases.clear();
+    profiler_objects.clear();
+    profiler_object_count.store(0);
+    profiler_samples.store(0);
+    setitimer(ITIMER_PROF, &timer_old, nullptr);
+#endif
+}
 
 NAMESPACE_END(mitsuba)
@@ -5,7 +5,8 @@
 
 #include <cstdlib>
 #include <iostream>
-#include <map>
+#include <algorithm>
+#include <functional>
 #include <sstream>
 #include <cstring>
 
@@ -64,12 +65,161 @@ struct SortKey {
     }
 };
 
+/**
+ * \brief Hash table of property entries
+ *
+ * Entries are stored contiguously in insertion order along with the hash of
+ * their name. Small tables (the common case during plugin construction) are
+ * searched linearly by comparing hashes, while larger ones (e.g. a scene with
+ * millions of children) additionally maintain an open addressing index.
+ * Iteration in the natural order of \ref SortKey is available via \ref
+ * sorted().
+ */
+struct EntryTable {
+    using Item = std::pair<std::string, Entry>;
+
+    /// Tables up to this size are searched linearly
+    static constexpr size_t LinearSearchSize = 8;
+
+    Item *find(const std::string &name) const {
+        return find(name, std::hash<std::string>()(name));
+    }
+
+    Entry &operator[](const std::string &name) {
+        size_t hash = std::hash<std::string>()(name);
+        if (Item *item = find(name, hash))
+            return item->second;
+
+        items.emplace_back(name, Entry());
+        hashes.push_back(hash);
+
+        if (items.size() > LinearSearchSize) {
+            if (2 * items.size() > index.size())
+                rebuild_index();
+            else
+                insert_index(items.size() - 1);
+        }
+
+        return items.back().second;
+    }
+
+    void erase(Item *item) {
+        size_t i = (size_t) (item - items.data()),
+               last = items.size() - 1;
+
+        // The last entry moves into the place of the removed one
+        if (!index.empty()) {
+            remove_index(i);
+            if (i != last)
+                index[index_slot(last)] = (uint32_t) (i + 1);
+        }
+
+        if (i != last) {
+            std::swap(items[i], items.back());
+            std::swap(hashes[i], hashes.back());
+        }
+        items.pop_back();
+        hashes.pop_back();
+
+        if (items.size() <= LinearSearchSize)
+            index.clear();
+    }
+
+    size_t size() const { return items.size(); }
+
+    /// Return the entries in the order defined by \ref SortKey
+    std::vector<Item *> sorted() const {
+        std::vector<Item *> result;
+        result.reserve(items.size());
+        for (const Item &item : items)
+            result.push_back(const_cast<Item *>(&item));
+        std::sort(result.begin(), result.end(),
+                  [](const Item *a, const Item *b) {
+                      return SortKey()(a->first, b->first);
+                  });
+        return result;
+    }
+
+    /// Entries in insertion order (iterate via \ref sorted() if order matters)
+    std::vector<Item> items;
+
+private:
+    Item *find(const std::string &name, size_t hash) const {
+        if (index.empty()) {
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (hashes[i] == hash && items[i].first == name)
+                    return const_cast<Item *>(&items[i]);
+            }
+            return nullptr;
+        }
+
+        size_t mask = index.size() - 1;
+        for (size_t slot = hash & mask; index[slot] != 0; slot = (slot + 1) & mask) {
+            size_t i = index[slot] - 1;
+            if (hashes[i] == hash && items[i].first == name)
+                return const_cast<Item *>(&items[i]);
+        }
+        return nullptr;
+    }
+
+    void insert_index(size_t i) {
+        size_t mask = index.size() - 1, slot = hashes[i] & mask;
+        while (index[slot] != 0)
+            slot = (slot + 1) & mask;
+        index[slot] = (uint32_t) (i + 1);
+    }
+
+    /// Return the slot of the index that refers to item \c i
+    size_t index_slot(size_t i) const {
+        size_t mask = index.size() - 1, slot = hashes[i] & mask;
+        while (index[slot] != i + 1)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    /**
+     * \brief Remove item \c i from the index using backward-shift deletion,
+     * which keeps the probe sequences of the other items intact without
+     * tombstones
+     */
+    void remove_index(size_t i) {
+        size_t mask = index.size() - 1, hole = index_slot(i);
+        for (size_t slot = (hole + 1) & mask; index[slot] != 0; slot = (slot + 1) & mask) {
+            size_t home = hashes[index[slot] - 1] & mask;
+            // Move the entry into the hole unless the hole precedes its home slot
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                index[hole] = index[slot];
+                hole = slot;
+            }
+        }
+        index[hole] = 0;
+    }
+
+    void rebuild_index() {
+        index.clear();
+        if (items.size() <= LinearSearchSize)
+            return;
+        size_t capacity = 4 * LinearSearchSize;
+        while (capacity < 4 * items.size())
+            capacity *= 2;
+        index.resize(capacity, 0u);
+        for (size_t i = 0; i < items.size(); ++i)
+            insert_index(i);
+    }
+
+    /// Hash values of the entry names
+    std::vector<size_t> hashes;
+
+    /// Open addressing index (item index + 1, or zero for empty slots)
+    std::vector<uint32_t> index;
+};
+
 struct Properties::PropertiesPrivate {
-    std::map<std::string, Entry, SortKey> entries;
+    EntryTable entries;
     std::string id, plugin_name;
 };
 
-using Iterator = typename std::map<std::string, Entry, SortKey>::iterator;
+using Iterator = EntryTable::Item *;
 
 template <typename T, typename T2 = T>
 T get_impl(const Iterator &it) {
@@ -126,7 +276,7 @@ T get_routing(const Iterator &it) {
 template <typename T>
 T Properties::get(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         Throw("Property \"%s\" has not been specified!", name);
     return get_routing<T>(it);
 }
@@ -134,7 +284,7 @@ T Properties::get(const std::string &name) const {
 template <typename T>
 T Properties::get(const std::string &name, const T &def_val) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         return def_val;
     return get_routing<T>(it);
 }
@@ -151,7 +301,7 @@ T Properties::get(const std::string &name, const T &def_val) const {
     \
     Type const & Properties::GetterName(const std::string &name) const { \
         const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        if (it == nullptr) \
             Throw("Property \"%s\" has not been specified!", name); \
         if (!it->second.data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
@@ -161,7 +311,7 @@ T Properties::get(const std::string &name, const T &def_val) const {
     \
     Type const & Properties::GetterName(const std::string &name, Type const &def_val) const { \
         const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        if (it == nullptr) \
             return def_val; \
         if (!it->second.data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
@@ -198,7 +348,7 @@ void Properties::operator=(const Properties &props) {
 }
 
 bool Properties::has_property(const std::string &name) const {
-    return d->entries.find(name) != d->entries.end();
+    return d->entries.find(name) != nullptr;
 }
 
 namespace {
@@ -236,7 +386,7 @@ namespace {
 
 Properties::Type Properties::type(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         Throw("type(): Could not find property named \"%s\"!", name);
 
     return it->second.data.visit(PropertyTypeVisitor());
@@ -244,7 +394,7 @@ Properties::Type Properties::type(const std::string &name) const {
 
 bool Properties::mark_queried(const std::string &name) const {
     auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         return false;
     it->second.queried = true;
     return true;
@@ -252,14 +402,14 @@ bool Properties::mark_queried(const std::string &name) const {
 
 bool Properties::was_queried(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         Throw("Could not find property named \"%s\"!", name);
     return it->second.queried;
 }
 
 bool Properties::remove_property(const std::string &name) {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         return false;
     d->entries.erase(it);
     return true;
@@ -285,28 +435,29 @@ void Properties::copy_attribute(const Properties &properties,
                                 const std::string &source_name,
                                 const std::string &target_name) {
     const auto it = properties.d->entries.find(source_name);
-    if (it == properties.d->entries.end())
+    if (it == nullptr)
         Throw("copy_attribute(): Could not find parameter \"%s\"!", source_name);
-    d->entries[target_name] = it->second;
+    Entry entry = it->second; // 'it' may be invalidated by the insertion
+    d->entries[target_name] = entry;
 }
 
 std::vector<std::string> Properties::property_names() const {
     std::vector<std::string> result;
-    for (const auto &e : d->entries)
-        result.push_back(e.first);
+    for (const auto *e : d->entries.sorted())
+        result.push_back(e->first);
     return result;
 }
 
 std::vector<std::pair<std::string, NamedReference>> Properties::named_references() const {
     std::vector<std::pair<std::string, NamedReference>> result;
     result.reserve(d->entries.size());
-    for (auto &e : d->entries) {
-        auto type = e.second.data.visit(PropertyTypeVisitor());
+    for (auto *e : d->entries.sorted()) {
+        auto type = e->second.data.visit(PropertyTypeVisitor());
         if (type != Type::NamedReference)
             continue;
-        auto const &value = (const NamedReference &) e.second.data;
-        result.push_back(std::make_pair(e.first, value));
-        e.second.queried = true;
+        auto const &value = (const NamedReference &) e->second.data;
+        result.push_back(std::make_pair(e->first, value));
+        e->second.queried = true;
     }
     return result;
 }
@@ -314,28 +465,28 @@ std::vector<std::pair<std::string, NamedReference>> Properties::named_references
 std::vector<std::pair<std::string, ref<Object>>> Properties::objects(bool mark_queried) const {
     std::vector<std::pair<std::string, ref<Object>>> result;
     result.reserve(d->entries.size());
-    for (auto &e : d->entries) {
-        auto type = e.second.data.visit(PropertyTypeVisitor());
+    for (auto *e : d->entries.sorted()) {
+        auto type = e->second.data.visit(PropertyTypeVisitor());
         if (type != Type::Object)
             continue;
-        result.push_back(std::make_pair(e.first, (const ref<Object> &) e.second));
+        result.push_back(std::make_pair(e->first, (const ref<Object> &) e->second));
         if (mark_queried)
-            e.second.queried = true;
+            e->second.queried = true;
     }
     return result;
 }
 
 std::vector<std::string> Properties::unqueried() const {
     std::vector<std::string> result;
-    for (const auto &e : d->entries) {
-        if (!e.second.queried)
-            result.push_back(e.first);
+    for (const auto *e : d->entries.sorted()) {
+        if (!e->second.queried)
+            result.push_back(e->first);
     }
     return result;
 }
 
 void Properties::merge(const Properties &p) {
-    for (const auto &e : p.d->entries)
+    for (const auto &e : p.d->entries.items)
         d->entries[e.first] = e.second;
 }
 
@@ -345,9 +496,9 @@ bool Properties::operator==(const Properties &p) const {
         d->entries.size() != p.d->entries.size())
         return false;
 
-    for (const auto &e : d->entries) {
+    for (const auto &e : d->entries.items) {
         auto it = p.d->entries.find(e.first);
-        if (it == p.d->entries.end())
+        if (it == nullptr)
             return false;
         if (e.second.data != it->second.data)
             return false;
@@ -358,45 +509,35 @@ bool Properties::operator==(const Properties &p) const {
 
 std::string Properties::as_string(const std::string &name) const {
     std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
-        Throw("Property \"%s\" has not been specified!", name); \
+    const auto it = d->entries.find(name);
+    if (it != nullptr)
+        it->second.data.visit(StreamVisitor(oss));
+    else
+        Throw("Property \"%s\" has not been specified!", name);
     return oss.str();
 }
 
 std::string Properties::as_string(const std::string &name, const std::string &def_val) const {
     std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
+    const auto it = d->entries.find(name);
+    if (it != nullptr)
+        it->second.data.visit(StreamVisitor(oss));
+    else
         return def_val;
     return oss.str();
 }
 
 std::ostream &operator<<(std::ostream &os, const Properties &p) {
-    auto it = p.d->entries.begin();
+    auto entries = p.d->entries.sorted();
 
     os << "Properties[" << std::endl
        << "  plugin_name = \"" << (p.d->plugin_name) << "\"," << std::endl
        << "  id = \"" << p.d->id << "\"," << std::endl
        << "  elements = {" << std::endl;
-    while (it != p.d->entries.end()) {
-        os << "    \"" << it->first << "\" -> ";
-        it->second.data.visit(StreamVisitor(os));
-        if (++it != p.d->entries.end()) os << ",";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        os << "    \"" << entries[i]->first << "\" -> ";
+        entries[i]->second.data.visit(StreamVisitor(os));
+        if (i + 1 != entries.size()) os << ",";
         os << std::endl;
     }
     os << "  }" << std::endl
@@ -447,7 +588,7 @@ void Properties::set_animated_transform(const std::string &name,
 /// AnimatedTransform getter (without default value).
 ref<AnimatedTransform> Properties::animated_transform(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         Throw("Property \"%s\" has not been specified!", name);
     if (it->second.data.is<Transform4f>()) {
         // Also accept simple transforms, from which we can build
@@ -472,7 +613,7 @@ ref<AnimatedTransform> Properties::animated_transform(const std::string &name) c
 ref<AnimatedTransform> Properties::animated_transform(
         const std::string &name, ref<AnimatedTransform> def_val) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         return def_val;
     if (it->second.data.is<Transform4f>()) {
         // Also accept simple transforms, from which we can build
@@ -502,7 +643,7 @@ ref<AnimatedTransform> Properties::animated_transform(
 
 ref<Object> Properties::find_object(const std::string &name) const {
     const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    if (it == nullptr)
         return ref<Object>();
 
     if (!it->second.data.is<ref<Object>>())
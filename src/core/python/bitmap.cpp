@@ -1,6 +1,7 @@
 // #include <ostream>
 
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/bitmapwriter.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/mstream.h>
@@ -44,6 +45,19 @@ MI_PY_EXPORT(Bitmap) {
         .value("Unpremultiply", Bitmap::AlphaTransform::Unpremultiply,
                 D(Bitmap, AlphaTransform, Unpremultiply));
 
+    py::enum_<Bitmap::EXRCompression>(bitmap, "EXRCompression", D(Bitmap, EXRCompression))
+        .value("Default", Bitmap::EXRCompression::Default, D(Bitmap, EXRCompression, Default))
+        .value("None",    Bitmap::EXRCompression::None,    D(Bitmap, EXRCompression, None))
+        .value("RLE",     Bitmap::EXRCompression::RLE,     D(Bitmap, EXRCompression, RLE))
+        .value("ZIPS",    Bitmap::EXRCompression::ZIPS,    D(Bitmap, EXRCompression, ZIPS))
+        .value("ZIP",     Bitmap::EXRCompression::ZIP,     D(Bitmap, EXRCompression, ZIP))
+        .value("PIZ",     Bitmap::EXRCompression::PIZ,     D(Bitmap, EXRCompression, PIZ))
+        .value("PXR24",   Bitmap::EXRCompression::PXR24,   D(Bitmap, EXRCompression, PXR24))
+        .value("B44",     Bitmap::EXRCompression::B44,     D(Bitmap, EXRCompression, B44))
+        .value("B44A",    Bitmap::EXRCompression::B44A,    D(Bitmap, EXRCompression, B44A))
+        .value("DWAA",    Bitmap::EXRCompression::DWAA,    D(Bitmap, EXRCompression, DWAA))
+        .value("DWAB",    Bitmap::EXRCompression::DWAB,    D(Bitmap, EXRCompression, DWAB));
+
     bitmap
         .def(py::init<Bitmap::PixelFormat, Struct::Type, const Vector2u &, size_t, std::vector<std::string>>(),
              "pixel_format"_a, "component_format"_a, "size"_a, "channel_count"_a = 0, "channel_names"_a = std::vector<std::string>(),
@@ -63,6 +77,10 @@ MI_PY_EXPORT(Bitmap) {
         .def_method(Bitmap, set_srgb_gamma)
         .def_method(Bitmap, premultiplied_alpha)
         .def_method(Bitmap, set_premultiplied_alpha)
+        .def_method(Bitmap, exr_compression)
+        .def_method(Bitmap, set_exr_compression, "value"_a)
+        .def_method(Bitmap, set_exr_channel_format, "name"_a, "type"_a)
+        .def_method(Bitmap, exr_channel_format, "name"_a)
         .def_method(Bitmap, clear)
         .def("metadata", py::overload_cast<>(&Bitmap::metadata), D(Bitmap, metadata),
             py::return_value_policy::reference_internal)
@@ -163,7 +181,7 @@ MI_PY_EXPORT(Bitmap) {
             py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
                 &Bitmap::write_async, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
-            D(Bitmap, write_async))
+            D(Bitmap, write_async), py::call_guard<py::gil_scoped_release>())
         .def("split", &Bitmap::split, D(Bitmap, split))
         .def_static("detect_file_format", &Bitmap::detect_file_format, D(Bitmap, detect_file_format))
         .def_property_readonly("__array_interface__", [](Bitmap &bitmap) -> py::object {
@@ -362,3 +380,32 @@ MI_PY_EXPORT(Bitmap) {
         return py::str(out.str());
     });
 }
+
+MI_PY_EXPORT(BitmapWriter) {
+    using Future = std::shared_future<void>;
+
+    auto writer = MI_PY_CLASS(BitmapWriter, Object)
+        .def(py::init<size_t, size_t, int>(), "worker_count"_a = 2,
+             "queue_capacity"_a = 8, "quality"_a = -1, D(BitmapWriter, BitmapWriter))
+        .def("write", &BitmapWriter::write, "bitmap"_a, "path"_a,
+             "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+             D(BitmapWriter, write), py::call_guard<py::gil_scoped_release>())
+        .def("flush", &BitmapWriter::flush, D(BitmapWriter, flush),
+             py::call_guard<py::gil_scoped_release>())
+        .def_method(BitmapWriter, pending)
+        .def_method(BitmapWriter, worker_count)
+        .def_method(BitmapWriter, queue_capacity)
+        .def_method(BitmapWriter, quality)
+        .def_static_method(BitmapWriter, instance)
+        .def_static("set_instance", &BitmapWriter::set_instance, "writer"_a,
+                    D(BitmapWriter, set_instance),
+                    py::call_guard<py::gil_scoped_release>());
+
+    py::class_<Future>(writer, "Future")
+        .def("wait", [](const Future &future) { future.get(); },
+             "Wait until the write has completed (rethrows errors)",
+             py::call_guard<py::gil_scoped_release>())
+        .def("done", [](const Future &future) {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }, "Has the write completed?");
+}
@@ -43,6 +43,10 @@ MI_PY_EXPORT(Logger) {
         .def_method(Logger, log_level)
         .def_method(Logger, set_error_level)
         .def_method(Logger, error_level)
+        .def_method(Logger, set_async, "value"_a,
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, is_async)
+        .def_method(Logger, flush, py::call_guard<py::gil_scoped_release>())
         .def_method(Logger, add_appender, py::keep_alive<1, 2>())
         .def_method(Logger, remove_appender)
         .def_method(Logger, clear_appenders)
@@ -50,7 +54,7 @@ MI_PY_EXPORT(Logger) {
         .def("appender", (Appender * (Logger::*)(size_t)) &Logger::appender, D(Logger, appender))
         .def("formatter", (Formatter * (Logger::*)()) &Logger::formatter, D(Logger, formatter))
         .def_method(Logger, set_formatter, py::keep_alive<1, 2>())
-        .def_method(Logger, read_log);
+        .def_method(Logger, read_log, py::call_guard<py::gil_scoped_release>());
 
     m.def("Log", &PyLog, "level"_a, "msg"_a);
 }
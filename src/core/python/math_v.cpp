@@ -53,6 +53,14 @@ MI_PY_EXPORT(math) {
           &math::solve_quadratic<Float>,
           "a"_a, "b"_a, "c"_a, D(math, solve_quadratic));
 
+    m.def("sincos_quarter_pi",
+          &math::sincos_quarter_pi<Float>,
+          "x"_a, D(math, sincos_quarter_pi));
+
+    m.def("sincos_2pi_fast",
+          &math::sincos_2pi_fast<Float>,
+          "u"_a, D(math, sincos_2pi_fast));
+
     m.def("morton_decode2", &dr::morton_decode<dr::Array<UInt32, 2>>, "m"_a);
     m.def("morton_decode3", &dr::morton_decode<dr::Array<UInt32, 3>>, "m"_a);
     m.def("morton_encode2", &dr::morton_encode<dr::Array<UInt32, 2>>, "v"_a);
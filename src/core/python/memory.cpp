@@ -0,0 +1,46 @@
+#include <mitsuba/core/memory.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(MemoryTracker) {
+    py::enum_<MemoryCategory>(m, "MemoryCategory", D(MemoryCategory))
+        .value("Mesh",    MemoryCategory::Mesh,    D(MemoryCategory, Mesh))
+        .value("Bitmap",  MemoryCategory::Bitmap,  D(MemoryCategory, Bitmap))
+        .value("Texture", MemoryCategory::Texture, D(MemoryCategory, Texture))
+        .value("Volume",  MemoryCategory::Volume,  D(MemoryCategory, Volume))
+        .value("Film",    MemoryCategory::Film,    D(MemoryCategory, Film))
+        .value("Accel",   MemoryCategory::Accel,   D(MemoryCategory, Accel));
+
+    py::class_<MemoryTracker>(m, "MemoryTracker", D(MemoryTracker))
+        .def_static("usage", &MemoryTracker::usage, "category"_a,
+                    D(MemoryTracker, usage))
+        .def_static("total", &MemoryTracker::total, D(MemoryTracker, total))
+        .def_static("peak", &MemoryTracker::peak, D(MemoryTracker, peak))
+        .def_static("reset_peak", &MemoryTracker::reset_peak,
+                    D(MemoryTracker, reset_peak))
+        .def_static("set_budget", &MemoryTracker::set_budget, "budget"_a,
+                    D(MemoryTracker, set_budget))
+        .def_static("budget", &MemoryTracker::budget, D(MemoryTracker, budget))
+        .def_static("to_string", &MemoryTracker::to_string,
+                    D(MemoryTracker, to_string));
+
+    m.def("memory_report", []() {
+        py::dict result;
+        for (uint32_t i = 0; i < (uint32_t) MemoryCategory::MemoryCategoryCount; ++i) {
+            auto [host, device] = MemoryTracker::usage((MemoryCategory) i);
+            py::dict entry;
+            entry["host"] = host;
+            entry["device"] = device;
+            entry["total"] = host + device;
+            result[memory_category_id[i]] = entry;
+        }
+        auto [host, device] = MemoryTracker::total();
+        py::dict entry;
+        entry["host"] = host;
+        entry["device"] = device;
+        entry["total"] = host + device;
+        result["Total"] = entry;
+        result["Peak"] = MemoryTracker::peak();
+        return result;
+    }, "Return the memory usage (in bytes) of all categories of the "
+       "MemoryTracker as a dictionary");
+}
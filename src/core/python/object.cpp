@@ -59,6 +59,8 @@ MI_PY_EXPORT(Object) {
              },
              "name"_a, "variant"_a, py::return_value_policy::reference,
              D(PluginManager, get_plugin_class))
+        .def_method(PluginManager, loaded_plugins)
+        .def_method(PluginManager, available_plugins)
         .def("create_object", [](PluginManager &pmgr, const Properties &props) {
             auto mi = py::module_::import("mitsuba");
             std::string variant = py::cast<std::string>(mi.attr("variant")());
@@ -29,4 +29,16 @@ MI_PY_EXPORT(qmc) {
 
     m.def("sobol_2", sobol_2<UInt32>,
           "index"_a, "scramble"_a, D(sobol_2));
+
+    m.def("sobol_sample", sobol_sample<UInt32>,
+          "index"_a, "dim"_a, D(sobol_sample));
+
+    m.def("nested_uniform_scramble", nested_uniform_scramble<UInt32>,
+          "x"_a, "seed"_a, D(nested_uniform_scramble));
+
+    m.def("owen_scrambled_sobol", owen_scrambled_sobol<UInt32>,
+          "index"_a, "dim"_a, "shuffle_seed"_a, "scramble_seed"_a,
+          D(owen_scrambled_sobol));
+
+    m.attr("SobolMaxDimension") = SobolMaxDimension;
 }
@@ -34,6 +34,10 @@ MI_PY_EXPORT(sample_tea) {
           sample_tea_float64<UInt32>,
           "v0"_a, "v1"_a, "rounds"_a = 4, D(sample_tea_float64));
 
+    m.def("sample_philox4x32", sample_philox4x32<UInt32>,
+          "c0"_a, "c1"_a, "c2"_a, "c3"_a, "k0"_a, "k1"_a, "rounds"_a = 10,
+          D(sample_philox4x32));
+
     m.attr("sample_tea_float") = m.attr(
         sizeof(Float) != sizeof(Float64) ? "sample_tea_float32" : "sample_tea_float64");
 
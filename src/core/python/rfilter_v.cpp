@@ -17,6 +17,9 @@ void bind_rfilter(py::module &m, const char *name) {
                  D(ReconstructionFilter, eval), "x"_a, "active"_a = true)
             .def("eval_discretized", &ReconstructionFilter::eval_discretized,
                  D(ReconstructionFilter, eval_discretized), "x"_a,
+                 "active"_a = true)
+            .def("sample", &ReconstructionFilter::sample,
+                 D(ReconstructionFilter, sample), "sample"_a,
                  "active"_a = true);
     }
 }
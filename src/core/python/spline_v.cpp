@@ -37,6 +37,73 @@ void bind_spline(py::module &m) {
                                             (uint32_t) values.shape(0), x);
                  },
                  "nodes"_a, "values"_a, "x"_a, D(spline, eval_1d, 2))
+            .def("precompute_1d",
+                 [](const py::array_t<ScalarFloat> &values) {
+                     if (values.ndim() != 1)
+                         throw std::runtime_error(
+                             "'values' must be a one-dimensional array!");
+                     if (values.size() < 2)
+                         throw std::runtime_error(
+                             "'values' must have at least two entries!");
+                     using Result  = DynamicBuffer<ScalarFloat>;
+                     Result result = dr::empty<Result>(4 * (values.size() - 1));
+                     spline::precompute_1d(values.data(),
+                                           (uint32_t) values.size(),
+                                           result.data());
+                     return result;
+                 },
+                 "values"_a, D(spline, precompute_1d))
+            .def("precompute_1d",
+                 [](const py::array_t<ScalarFloat> &nodes,
+                    const py::array_t<ScalarFloat> &values) {
+                     if (nodes.ndim() != 1 || values.ndim() != 1)
+                         throw std::runtime_error(
+                             "'nodes' and 'values' must be a one-dimensional "
+                             "array!");
+                     if (nodes.shape(0) != values.shape(0))
+                         throw std::runtime_error(
+                             "'nodes' and 'values' must have a matching size!");
+                     if (values.size() < 2)
+                         throw std::runtime_error(
+                             "'values' must have at least two entries!");
+                     using Result  = DynamicBuffer<ScalarFloat>;
+                     Result result = dr::empty<Result>(4 * (values.size() - 1));
+                     spline::precompute_1d(nodes.data(), values.data(),
+                                           (uint32_t) values.size(),
+                                           result.data());
+                     return result;
+                 },
+                 "nodes"_a, "values"_a, D(spline, precompute_1d, 2))
+            .def("eval_1d_precomputed",
+                 [](ScalarFloat min, ScalarFloat max,
+                    const py::array_t<ScalarFloat> &coeffs, Float x) {
+                     if (coeffs.ndim() != 1 || coeffs.shape(0) % 4 != 0)
+                         throw std::runtime_error(
+                             "'coeffs' must be a one-dimensional array whose "
+                             "size is a multiple of 4!");
+                     return spline::eval_1d_precomputed(
+                         min, max, coeffs.data(),
+                         (uint32_t) coeffs.shape(0) / 4 + 1, x);
+                 },
+                 "min"_a, "max"_a, "coeffs"_a, "x"_a,
+                 D(spline, eval_1d_precomputed))
+            .def("eval_1d_precomputed",
+                 [](const py::array_t<ScalarFloat> &nodes,
+                    const py::array_t<ScalarFloat> &coeffs, Float x) {
+                     if (nodes.ndim() != 1 || coeffs.ndim() != 1)
+                         throw std::runtime_error(
+                             "'nodes' and 'coeffs' must be a one-dimensional "
+                             "array!");
+                     if (coeffs.shape(0) != 4 * (nodes.shape(0) - 1))
+                         throw std::runtime_error(
+                             "'coeffs' must have 4 entries per segment of "
+                             "'nodes'!");
+                     return spline::eval_1d_precomputed(
+                         nodes.data(), coeffs.data(),
+                         (uint32_t) nodes.shape(0), x);
+                 },
+                 "nodes"_a, "coeffs"_a, "x"_a,
+                 D(spline, eval_1d_precomputed, 2))
             .def("integrate_1d",
                  [](ScalarFloat min, ScalarFloat max,
                     const py::array_t<ScalarFloat> &values) {
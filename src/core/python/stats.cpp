@@ -0,0 +1,22 @@
+#include <mitsuba/core/stats.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(Statistics) {
+    py::enum_<StatsCounter>(m, "StatsCounter", D(StatsCounter))
+        .value("RayIntersect",  StatsCounter::RayIntersect,  D(StatsCounter, RayIntersect))
+        .value("RayTest",       StatsCounter::RayTest,       D(StatsCounter, RayTest))
+        .value("BSDFSample",    StatsCounter::BSDFSample,    D(StatsCounter, BSDFSample))
+        .value("EmitterSample", StatsCounter::EmitterSample, D(StatsCounter, EmitterSample))
+        .value("NullCollision", StatsCounter::NullCollision, D(StatsCounter, NullCollision));
+
+    py::class_<Statistics>(m, "Statistics", D(Statistics))
+        .def_static("set_enabled", &Statistics::set_enabled, "enabled"_a,
+                    D(Statistics, set_enabled))
+        .def_static("enabled", &Statistics::enabled, D(Statistics, enabled))
+        .def_static("value", &Statistics::value, "counter"_a, D(Statistics, value))
+        .def_static("path_length_histogram", &Statistics::path_length_histogram,
+                    D(Statistics, path_length_histogram))
+        .def_static("elapsed", &Statistics::elapsed, D(Statistics, elapsed))
+        .def_static("reset", &Statistics::reset, D(Statistics, reset))
+        .def_static("to_string", &Statistics::to_string, D(Statistics, to_string));
+}
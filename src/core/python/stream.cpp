@@ -117,3 +117,14 @@ MI_PY_EXPORT(ZStream) {
             return py::cast(stream.child_stream());
         }, D(ZStream, child_stream));
 }
+
+MI_PY_EXPORT(BlockZStream) {
+    MI_PY_CLASS(BlockZStream, Stream)
+        .def(py::init<Stream*, int, size_t>(), D(BlockZStream, BlockZStream),
+            "child_stream"_a,
+            "level"_a = -1,
+            "block_size"_a = 1024 * 1024)
+        .def("child_stream", [](BlockZStream &stream) {
+            return py::cast(stream.child_stream());
+        }, D(BlockZStream, child_stream));
+}
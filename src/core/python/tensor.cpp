@@ -0,0 +1,73 @@
+#include <mitsuba/core/tensor.h>
+#include <mitsuba/core/filesystem.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <mitsuba/python/python.h>
+
+/// NumPy dtype of a tensor field
+static py::dtype dtype_for_type(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Int8:    return py::dtype("int8");
+        case Struct::Type::UInt8:   return py::dtype("uint8");
+        case Struct::Type::Int16:   return py::dtype("int16");
+        case Struct::Type::UInt16:  return py::dtype("uint16");
+        case Struct::Type::Int32:   return py::dtype("int32");
+        case Struct::Type::UInt32:  return py::dtype("uint32");
+        case Struct::Type::Int64:   return py::dtype("int64");
+        case Struct::Type::UInt64:  return py::dtype("uint64");
+        case Struct::Type::Float16: return py::dtype("float16");
+        case Struct::Type::Float32: return py::dtype("float32");
+        case Struct::Type::Float64: return py::dtype("float64");
+        default: Throw("Internal error.");
+    }
+}
+
+MI_PY_EXPORT(TensorFile) {
+    MI_PY_CLASS(TensorFile, MemoryMappedFile)
+        .def(py::init<const mitsuba::filesystem::path &>(),
+            D(TensorFile, TensorFile), "filename"_a)
+        .def("has_field", &TensorFile::has_field, D(TensorFile, has_field), "name"_a)
+        .def("field_names", &TensorFile::field_names, D(TensorFile, field_names))
+        .def("field", [](py::object self, const std::string &name) {
+                const TensorFile::Field &field =
+                    py::cast<const TensorFile *>(self)->field(name);
+                // Read-only view that keeps the file alive
+                py::array result(dtype_for_type(field.dtype), field.shape,
+                                 field.data, self);
+                py::detail::array_proxy(result.ptr())->flags &=
+                    ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+                return result;
+            }, "name"_a,
+            "Return the contents of the specified field as a read-only NumPy array")
+        .def("compressed", [](const TensorFile &t, const std::string &name) {
+                return t.field(name).compressed;
+            }, "name"_a, D(TensorFile, Field, compressed))
+        .def_static("write", [](const mitsuba::filesystem::path &filename,
+                                py::dict fields, bool compress,
+                                int compression_level) {
+                // Keep contiguous copies of the arrays alive while writing
+                std::vector<py::array> arrays;
+                std::vector<std::pair<std::string, TensorFile::Field>> fields_;
+                for (auto [key, value] : fields) {
+                    py::array array = py::array::ensure(
+                        value, py::array::c_style | py::array::forcecast);
+                    if (!array)
+                        throw py::type_error("TensorFile.write(): fields must be "
+                                             "convertible to NumPy arrays!");
+
+                    TensorFile::Field field;
+                    field.dtype = py::cast<Struct::Type>(array.dtype());
+                    field.offset = 0;
+                    field.shape = std::vector<size_t>(
+                        array.shape(), array.shape() + array.ndim());
+                    field.data = array.data();
+                    field.compressed = compress;
+                    fields_.emplace_back(py::cast<std::string>(key), field);
+                    arrays.push_back(array);
+                }
+
+                py::gil_scoped_release release;
+                TensorFile::write(filename, fields_, compression_level);
+            }, "filename"_a, "fields"_a, "compress"_a = false,
+            "compression_level"_a = -1, D(TensorFile, write));
+}
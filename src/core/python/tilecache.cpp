@@ -0,0 +1,15 @@
+#include <mitsuba/core/tilecache.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(TileCache) {
+    MI_PY_CLASS(TileCache, Object)
+        .def_static("instance", &TileCache::instance, D(TileCache, instance),
+                    py::return_value_policy::reference)
+        .def_method(TileCache, set_memory_budget, "bytes"_a)
+        .def_method(TileCache, memory_budget)
+        .def_method(TileCache, memory_usage)
+        .def_method(TileCache, hits)
+        .def_method(TileCache, misses)
+        .def_method(TileCache, evictions)
+        .def_method(TileCache, clear);
+}
@@ -0,0 +1,13 @@
+#include <mitsuba/core/trace.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(Trace) {
+    py::class_<Trace>(m, "Trace", D(Trace))
+        .def_static("start", &Trace::start, "min_duration"_a = 0.f,
+                    "max_events"_a = 1u << 26, D(Trace, start))
+        .def_static("stop", &Trace::stop, D(Trace, stop))
+        .def_static("enabled", &Trace::enabled, D(Trace, enabled))
+        .def_static("event_count", &Trace::event_count, D(Trace, event_count))
+        .def_static("write", &Trace::write, "filename"_a,
+                    py::call_guard<py::gil_scoped_release>(), D(Trace, write));
+}
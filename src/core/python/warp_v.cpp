@@ -174,4 +174,13 @@ MI_PY_EXPORT(warp) {
     m.def("bilinear_to_square", warp::bilinear_to_square<Float>,
           "v00"_a, "v10"_a, "v01"_a, "v11"_a, "sample"_a,
           D(warp, bilinear_to_square));
+
+    m.def("square_to_spherical_triangle", warp::square_to_spherical_triangle<Float>,
+          "a"_a, "b"_a, "c"_a, "sample"_a, D(warp, square_to_spherical_triangle));
+
+    m.def("spherical_triangle_to_square", warp::spherical_triangle_to_square<Float>,
+          "a"_a, "b"_a, "c"_a, "d"_a, D(warp, spherical_triangle_to_square));
+
+    m.def("square_to_spherical_triangle_pdf", warp::square_to_spherical_triangle_pdf<Float>,
+          "a"_a, "b"_a, "c"_a, "d"_a, D(warp, square_to_spherical_triangle_pdf));
 }
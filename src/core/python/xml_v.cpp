@@ -6,16 +6,40 @@
 #include <mitsuba/core/transform.h>
 #include <mitsuba/python/python.h>
 #include <nanothread/nanothread.h>
+#include <pybind11/numpy.h>
 #include <map>
 
 using Caster = py::object(*)(mitsuba::Object *);
 extern Caster cast_object;
 
+/// Structure-of-arrays payload of an "instances" entry (see \ref parse_instances)
+struct DictBulkInstances {
+    /// Number of referenced shape groups (stored as "shapegroup_<i>")
+    size_t shapegroup_count = 0;
+    /// Index of the shape group of every instance
+    std::vector<uint32_t> shapegroup_index;
+    /// Row-major 4x4 object-to-world matrix of every instance
+    std::vector<double> to_world;
+    /// Prefix of the instance ids
+    std::string id;
+};
+
 struct DictInstance {
     Properties props;
     ref<Object> object = nullptr;
     uint32_t scope;
     std::vector<std::pair<std::string, std::string>> dependencies;
+    std::shared_ptr<DictBulkInstances> bulk;
+};
+
+/// Object that expands into the shapes created from an "instances" entry
+class DictObjectList : public Object {
+public:
+    DictObjectList(std::vector<ref<Object>> &&objects)
+        : m_objects(std::move(objects)) { }
+    std::vector<ref<Object>> expand() const override { return m_objects; }
+private:
+    std::vector<ref<Object>> m_objects;
 };
 
 struct DictParseContext {
@@ -33,6 +57,12 @@ void parse_dictionary(
     const py::dict &dict
 );
 template <typename Float, typename Spectrum>
+void parse_instances(
+    DictParseContext &ctx,
+    const std::string path,
+    const py::dict &dict
+);
+template <typename Float, typename Spectrum>
 Task * instantiate_node(
     DictParseContext &ctx,
     const std::string path,
@@ -126,6 +156,12 @@ Parameter ``dict``:
 Parameter ``parallel``:
     Whether the loading should be executed on multiple threads in parallel
 
+A scene can describe many instances of shape groups with a single entry of
+type ``"instances"``, whose arrays are converted to instances in C++:
+``"shapes"`` (references to shape groups), ``"shape_index"`` (index into
+``"shapes"`` of every instance) and ``"to_world"`` (array of shape ``(N, 4,
+4)`` or ``(N, 3, 4)``).
+
 )doc");
 
     m.def(
@@ -168,6 +204,29 @@ void expand_and_set_object(Properties &props, const std::string &name, const ref
     }
 }
 
+/// Return the path of the object referenced by a dictionary with type "ref"
+std::string resolve_reference(DictParseContext &ctx, const py::dict &dict,
+                              const std::string &path) {
+    std::string path2;
+    for (auto& [k2, value2] : dict) {
+        std::string key2 = k2.template cast<std::string>();
+        if (key2 == "id") {
+            std::string id2 = value2.template cast<std::string>();
+            if (ctx.aliases.count(id2) == 1)
+                path2 = ctx.aliases[id2];
+            else
+                path2 = id2;
+            if (ctx.instances.count(path2) != 1)
+                Throw("Referenced id \"%s\" not found: %s", path2, path);
+        } else if (key2 != "type") {
+            Throw("Unexpected key in ref dictionary: %s", key2);
+        }
+    }
+    if (path2.empty())
+        Throw("Missing key 'id' in ref dictionary: %s", path);
+    return path2;
+}
+
 template <typename Float, typename Spectrum>
 ref<Object> create_texture_from(const py::dict &dict, bool within_emitter) {
     // Treat nested dictionary differently when their type is "rgb" or "spectrum"
@@ -298,23 +357,15 @@ void parse_dictionary(DictParseContext &ctx,
             if (type2 == "ref") {
                 if (is_scene)
                     Throw("Reference found at the scene level: %s", key);
-
-                for (auto& kv2 : value.template cast<py::dict>()) {
-                    std::string key2 = kv2.first.template cast<std::string>();
-                    if (key2 == "id") {
-                        std::string id2 = kv2.second.template cast<std::string>();
-                        std::string path2;
-                        if (ctx.aliases.count(id2) == 1)
-                            path2 = ctx.aliases[id2];
-                        else
-                            path2 = id2;
-                        if (ctx.instances.count(path2) != 1)
-                            Throw("Referenced id \"%s\" not found: %s", path2, path);
-                        inst.dependencies.push_back({key, path2});
-                    } else if (key2 != "type") {
-                        Throw("Unexpected key in ref dictionary: %s", key2);
-                    }
-                }
+                inst.dependencies.push_back(
+                    { key, resolve_reference(ctx, dict2, path) });
+            } else if (type2 == "instances") {
+                // Structure-of-arrays description of many instances
+                if (!is_scene)
+                    Throw("Instances must be specified at the scene level: %s", key);
+                std::string path2 = is_root ? key : path + "." + key;
+                inst.dependencies.push_back({key, path2});
+                parse_instances<Float, Spectrum>(ctx, path2, dict2);
             } else {
                 std::string path2 = is_root ? key : path + "." + key;
                 inst.dependencies.push_back({key, path2});
@@ -358,6 +409,166 @@ void parse_dictionary(DictParseContext &ctx,
     }
 }
 
+/**
+ * Parse a dictionary with type "instances", which describes many instances of
+ * shape groups using arrays instead of one dictionary per object:
+ *
+ * - "shapes": list of references to shape groups (or a single one)
+ * - "shape_index": index into "shapes" of every instance (optional when a
+ *   single shape group is given)
+ * - "to_world": array of N 4x4 (or 3x4) object-to-world matrices
+ * - "id": prefix of the instance ids (optional)
+ */
+template <typename Float, typename Spectrum>
+void parse_instances(DictParseContext &ctx,
+                     const std::string path,
+                     const py::dict &dict) {
+    using IndexArray = py::array_t<uint32_t, py::array::c_style | py::array::forcecast>;
+    using MatrixArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+    auto &inst = ctx.instances[path];
+    inst.props.set_plugin_name("instances");
+    inst.bulk = std::make_shared<DictBulkInstances>();
+    DictBulkInstances &bulk = *inst.bulk;
+    bulk.id = string::tokenize(path, ".").back();
+
+    bool has_index = false, has_to_world = false;
+    for (auto& [k, value] : dict) {
+        std::string key = k.template cast<std::string>();
+
+        if (key == "type") {
+            continue;
+        } else if (key == "id") {
+            bulk.id = value.template cast<std::string>();
+        } else if (key == "shapes") {
+            py::list shapes;
+            if (py::isinstance<py::list>(value) || py::isinstance<py::tuple>(value))
+                shapes = value.template cast<py::list>();
+            else
+                shapes.append(value);
+
+            for (auto shape : shapes) {
+                std::string key2 = "shapegroup_" + std::to_string(bulk.shapegroup_count++);
+                if (py::isinstance<py::dict>(shape)) {
+                    py::dict dict2 = shape.template cast<py::dict>();
+                    if (get_type(dict2) != "ref")
+                        Throw("\"%s\": shape groups of instances must be "
+                              "specified by reference: %s", path, dict2);
+                    inst.dependencies.push_back(
+                        { key2, resolve_reference(ctx, dict2, path) });
+                } else {
+                    try {
+                        inst.props.set_object(key2, shape.template cast<ref<Object>>());
+                    } catch (const pybind11::cast_error &) {
+                        Throw("\"%s\": unexpected entry of \"shapes\": %s", path, shape);
+                    }
+                }
+            }
+        } else if (key == "shape_index") {
+            IndexArray index = value.template cast<IndexArray>();
+            if (index.ndim() != 1)
+                Throw("\"%s\": \"shape_index\" must be a 1D array!", path);
+            bulk.shapegroup_index.assign(index.data(), index.data() + index.size());
+            has_index = true;
+        } else if (key == "to_world") {
+            MatrixArray m = value.template cast<MatrixArray>();
+            if (m.ndim() != 3 || m.shape(2) != 4 || (m.shape(1) != 3 && m.shape(1) != 4))
+                Throw("\"%s\": \"to_world\" must be an array of shape "
+                      "(N, 4, 4) or (N, 3, 4)!", path);
+            size_t count = (size_t) m.shape(0), rows = (size_t) m.shape(1);
+            bulk.to_world.resize(count * 16);
+            const double *src = m.data();
+            for (size_t i = 0; i < count; ++i) {
+                double *dst = bulk.to_world.data() + i * 16;
+                std::copy(src + i * rows * 4, src + (i + 1) * rows * 4, dst);
+                if (rows == 3) {
+                    dst[12] = dst[13] = dst[14] = 0.0;
+                    dst[15] = 1.0;
+                }
+            }
+            has_to_world = true;
+        } else {
+            Throw("Unexpected key in instances dictionary: %s", key);
+        }
+    }
+
+    size_t count = bulk.to_world.size() / 16;
+    if (!has_to_world || count == 0)
+        Throw("\"%s\": instances require a non-empty \"to_world\" array!", path);
+    if (bulk.shapegroup_count == 0)
+        Throw("\"%s\": instances require at least one entry in \"shapes\"!", path);
+
+    if (!has_index) {
+        if (bulk.shapegroup_count != 1)
+            Throw("\"%s\": \"shape_index\" must be specified when "
+                  "instancing several shape groups!", path);
+        bulk.shapegroup_index.assign(count, 0u);
+    } else if (bulk.shapegroup_index.size() != count) {
+        Throw("\"%s\": \"shape_index\" and \"to_world\" have different "
+              "sizes (%zu vs. %zu)!", path, bulk.shapegroup_index.size(), count);
+    }
+
+    for (uint32_t index : bulk.shapegroup_index) {
+        if (index >= bulk.shapegroup_count)
+            Throw("\"%s\": shape index %u is out of bounds (%zu shape groups)!",
+                  path, index, bulk.shapegroup_count);
+    }
+
+    if constexpr (dr::is_jit_v<Float>) {
+        if (ctx.parallel) {
+            jit_new_scope(dr::backend_v<Float>);
+            inst.scope = jit_scope(dr::backend_v<Float>);
+        }
+    }
+}
+
+/// Create the instances described by the payload of an "instances" entry
+template <typename Float, typename Spectrum>
+ref<Object> create_instances(DictParseContext &ctx, const Properties &props,
+                             const DictBulkInstances &bulk, uint32_t backend,
+                             uint32_t scope) {
+    std::vector<ref<Object>> shapegroups(bulk.shapegroup_count);
+    for (size_t i = 0; i < bulk.shapegroup_count; ++i)
+        shapegroups[i] = props.object("shapegroup_" + std::to_string(i));
+
+    const Class *class_ =
+        PluginManager::instance()->get_plugin_class("instance", GET_VARIANT())->parent();
+
+    size_t count = bulk.shapegroup_index.size();
+    std::vector<ref<Object>> objects(count);
+
+    auto create = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i != end; ++i) {
+            const double *m = bulk.to_world.data() + i * 16;
+            dr::Matrix<double, 4> matrix;
+            for (size_t r = 0; r < 4; ++r)
+                for (size_t c = 0; c < 4; ++c)
+                    matrix(r, c) = m[r * 4 + c];
+
+            Properties props2("instance");
+            props2.set_id(bulk.id + "_" + std::to_string(i));
+            props2.set_object("shapegroup", shapegroups[bulk.shapegroup_index[i]]);
+            props2.set_transform("to_world", Properties::Transform4f(matrix));
+            objects[i] = PluginManager::instance()->create_object(props2, class_);
+        }
+    };
+
+    if (ctx.parallel) {
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, count, 1024),
+            [&](const dr::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(ctx.env);
+                mitsuba::xml::ScopedSetJITScope set_scope(backend, scope);
+                create(range.begin(), range.end());
+            }
+        );
+    } else {
+        create(0, count);
+    }
+
+    return new DictObjectList(std::move(objects));
+}
+
 template <typename Float, typename Spectrum>
 Task *instantiate_node(DictParseContext &ctx,
                        std::string path,
@@ -391,6 +602,18 @@ Task *instantiate_node(DictParseContext &ctx,
         Properties props = inst.props;
         std::string type = props.plugin_name();
 
+        if (inst.bulk) {
+            for (auto &[key2, path2] : inst.dependencies) {
+                auto obj2 = ctx.instances[path2].object;
+                if (!obj2)
+                    Throw("Dependence hasn't been instantiated yet: %s, %s -> %s", path, path2, key2);
+                props.set_object(key2, obj2);
+            }
+            inst.object = create_instances<Float, Spectrum>(
+                ctx, props, *inst.bulk, ctx.parallel ? backend : 0u, scope);
+            return;
+        }
+
         const Class *class_;
         if (type == "scene")
             class_ = Class::for_name("Scene", GET_VARIANT());
@@ -21,6 +21,32 @@ MI_VARIANT void ReconstructionFilter<Float, Spectrum>::init_discretization() {
 
     m_scale_factor = MI_FILTER_RESOLUTION / m_radius;
     m_border_size = (int) dr::ceil(m_radius - .5f - 2.f * math::RayEpsilon<ScalarFloat>);
+
+    // Tabulate the absolute value of the filter for importance sampling
+    const size_t count = 4 * MI_FILTER_RESOLUTION + 1;
+    ScalarVector2f range(-m_radius, m_radius);
+    if constexpr (dr::is_jit_v<Float>) {
+        Float x = dr::linspace<Float>(-m_radius, m_radius, count);
+        m_distr = ContinuousDistribution<Float>(range, dr::abs(eval(x)));
+    } else {
+        std::vector<ScalarFloat> values(count);
+        for (size_t i = 0; i < count; ++i)
+            values[i] = dr::abs(eval(dr::lerp(-m_radius, m_radius,
+                                              i / ScalarFloat(count - 1))));
+        m_distr = ContinuousDistribution<Float>(range, values.data(), count);
+    }
+}
+
+MI_VARIANT std::pair<typename ReconstructionFilter<Float, Spectrum>::Vector2f, Float>
+ReconstructionFilter<Float, Spectrum>::sample(const Point2f &sample,
+                                              Mask active) const {
+    auto [x, pdf_x] = m_distr.sample_pdf(sample.x(), active);
+    auto [y, pdf_y] = m_distr.sample_pdf(sample.y(), active);
+
+    Float pdf    = pdf_x * pdf_y,
+          weight = dr::select(pdf > 0.f, eval(x, active) * eval(y, active) / pdf, 0.f);
+
+    return { Vector2f(x, y), weight };
 }
 
 MI_VARIANT bool ReconstructionFilter<Float, Spectrum>::is_box_filter() const {
@@ -0,0 +1,270 @@
+#include <mitsuba/core/sstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/util.h>
+#include <sstream>
+
+#if defined(_WIN32)
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  include <cstring>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+NAMESPACE_BEGIN(detail)
+
+#if defined(_WIN32)
+static constexpr SocketStream::Socket invalid_socket = INVALID_SOCKET;
+
+static void close_socket(SocketStream::Socket socket) { closesocket(socket); }
+
+static std::string socket_error() {
+    return "winsock error " + std::to_string(WSAGetLastError());
+}
+
+/// Initialize Winsock on first use
+static void socket_init() {
+    static bool initialized = [] {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            Throw("Could not initialize Winsock!");
+        return true;
+    }();
+    (void) initialized;
+}
+#else
+static constexpr SocketStream::Socket invalid_socket = -1;
+
+static void close_socket(SocketStream::Socket socket) { ::close(socket); }
+
+static std::string socket_error() { return strerror(errno); }
+
+static void socket_init() { }
+#endif
+
+/// Disable Nagle's algorithm, messages are small and latency-sensitive
+static void socket_configure(SocketStream::Socket socket) {
+    int flag = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char *) &flag,
+               sizeof(flag));
+}
+
+static std::string peer_name(SocketStream::Socket socket) {
+    sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    if (getpeername(socket, (sockaddr *) &addr, &len) != 0)
+        return "<unknown>";
+    char host[NI_MAXHOST], port[NI_MAXSERV];
+    if (getnameinfo((sockaddr *) &addr, len, host, sizeof(host), port,
+                    sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+        return "<unknown>";
+    return std::string(host) + ":" + port;
+}
+
+NAMESPACE_END(detail)
+
+SocketStream::SocketStream(Socket socket) : m_socket(socket) {
+    detail::socket_configure(m_socket);
+    m_peer = detail::peer_name(m_socket);
+}
+
+SocketStream::SocketStream(const std::string &host, uint16_t port)
+    : m_socket(detail::invalid_socket) {
+    detail::socket_init();
+
+    addrinfo hints, *result = nullptr;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    std::string port_str = std::to_string(port);
+    int rv = getaddrinfo(host.c_str(), port_str.c_str(), &hints, &result);
+    if (rv != 0)
+        Throw("SocketStream: could not resolve \"%s\": %s", host,
+              gai_strerror(rv));
+
+    for (addrinfo *p = result; p; p = p->ai_next) {
+        m_socket = ::socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (m_socket == detail::invalid_socket)
+            continue;
+        if (::connect(m_socket, p->ai_addr, (socklen_t) p->ai_addrlen) == 0)
+            break;
+        detail::close_socket(m_socket);
+        m_socket = detail::invalid_socket;
+    }
+    freeaddrinfo(result);
+
+    if (m_socket == detail::invalid_socket)
+        Throw("SocketStream: could not connect to %s:%u: %s", host, port,
+              detail::socket_error());
+
+    detail::socket_configure(m_socket);
+    m_peer = host + ":" + port_str;
+}
+
+SocketStream::~SocketStream() {
+    close();
+}
+
+void SocketStream::close() {
+    if (m_closed)
+        return;
+    detail::close_socket(m_socket);
+    m_closed = true;
+}
+
+void SocketStream::read(void *p, size_t size) {
+    if (m_closed)
+        Throw("SocketStream: attempted to read from a closed stream!");
+
+    char *ptr = (char *) p;
+    while (size > 0) {
+        int n = (int) ::recv(m_socket, ptr, (int) std::min(size, (size_t) (1 << 30)), 0);
+        if (n == 0)
+            Throw("SocketStream: connection to %s was closed by the peer!", m_peer);
+        if (n < 0) {
+#if !defined(_WIN32)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("SocketStream: could not read from %s: %s", m_peer,
+                  detail::socket_error());
+        }
+        ptr += n;
+        size -= (size_t) n;
+        m_received += (size_t) n;
+    }
+}
+
+void SocketStream::write(const void *p, size_t size) {
+    if (m_closed)
+        Throw("SocketStream: attempted to write to a closed stream!");
+
+    const char *ptr = (const char *) p;
+    while (size > 0) {
+#if defined(MSG_NOSIGNAL)
+        int flags = MSG_NOSIGNAL; // Report lost peers as errors, not as SIGPIPE
+#else
+        int flags = 0;
+#endif
+        int n = (int) ::send(m_socket, ptr, (int) std::min(size, (size_t) (1 << 30)), flags);
+        if (n < 0) {
+#if !defined(_WIN32)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("SocketStream: could not write to %s: %s", m_peer,
+                  detail::socket_error());
+        }
+        ptr += n;
+        size -= (size_t) n;
+        m_sent += (size_t) n;
+    }
+}
+
+void SocketStream::seek(size_t) {
+    Throw("SocketStream: seek() is not supported!");
+}
+
+void SocketStream::truncate(size_t) {
+    Throw("SocketStream: truncate() is not supported!");
+}
+
+std::string SocketStream::to_string() const {
+    std::ostringstream oss;
+    oss << "SocketStream[" << std::endl
+        << "  peer = \"" << m_peer << "\"," << std::endl
+        << "  received = " << util::mem_string(m_received) << "," << std::endl
+        << "  sent = " << util::mem_string(m_sent) << "," << std::endl
+        << "  closed = " << m_closed << std::endl
+        << "]";
+    return oss.str();
+}
+
+// -----------------------------------------------------------------------------
+
+ServerSocket::ServerSocket(uint16_t port, const std::string &address)
+    : m_socket(detail::invalid_socket), m_address(address) {
+    detail::socket_init();
+
+    addrinfo hints, *result = nullptr;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_PASSIVE;
+
+    std::string port_str = std::to_string(port);
+    int rv = getaddrinfo(address.c_str(), port_str.c_str(), &hints, &result);
+    if (rv != 0)
+        Throw("ServerSocket: could not resolve \"%s\": %s", address,
+              gai_strerror(rv));
+
+    std::string error;
+    for (addrinfo *p = result; p; p = p->ai_next) {
+        m_socket = ::socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (m_socket == detail::invalid_socket) {
+            error = detail::socket_error();
+            continue;
+        }
+
+        int flag = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, (const char *) &flag,
+                   sizeof(flag));
+
+        if (::bind(m_socket, p->ai_addr, (socklen_t) p->ai_addrlen) == 0 &&
+            ::listen(m_socket, 16) == 0)
+            break;
+
+        error = detail::socket_error();
+        detail::close_socket(m_socket);
+        m_socket = detail::invalid_socket;
+    }
+    freeaddrinfo(result);
+
+    if (m_socket == detail::invalid_socket)
+        Throw("ServerSocket: could not listen on %s:%u: %s", address, port,
+              error);
+
+    sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    getsockname(m_socket, (sockaddr *) &addr, &len);
+    if (addr.ss_family == AF_INET6)
+        m_port = ntohs(((sockaddr_in6 *) &addr)->sin6_port);
+    else
+        m_port = ntohs(((sockaddr_in *) &addr)->sin_port);
+}
+
+ServerSocket::~ServerSocket() {
+    detail::close_socket(m_socket);
+}
+
+ref<SocketStream> ServerSocket::accept() {
+    while (true) {
+        SocketStream::Socket socket = ::accept(m_socket, nullptr, nullptr);
+        if (socket != detail::invalid_socket)
+            return new SocketStream(socket);
+#if !defined(_WIN32)
+        if (errno == EINTR)
+            continue;
+#endif
+        Throw("ServerSocket: could not accept a connection: %s",
+              detail::socket_error());
+    }
+}
+
+std::string ServerSocket::to_string() const {
+    return tfm::format("ServerSocket[address=%s, port=%u]", m_address, m_port);
+}
+
+MI_IMPLEMENT_CLASS(SocketStream, Stream)
+MI_IMPLEMENT_CLASS(ServerSocket, Object)
+NAMESPACE_END(mitsuba)
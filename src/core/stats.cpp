@@ -0,0 +1,149 @@
+#include <mitsuba/core/stats.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <drjit/jit.h>
+#include <mutex>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+NAMESPACE_BEGIN(detail)
+std::atomic<bool> stats_enabled { false };
+thread_local StatsBlock *stats_block = nullptr;
+uint32_t stats_jit_index[2] { 0, 0 };
+
+/// Counters of all threads that ever recorded an event (never freed)
+static std::vector<StatsBlock *> stats_blocks;
+static std::mutex stats_mutex;
+static Timer stats_timer;
+
+StatsBlock *stats_register_thread() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    stats_block = new StatsBlock();
+    stats_blocks.push_back(stats_block);
+    return stats_block;
+}
+
+/// Sum the counters of all threads and backends
+static void stats_gather(uint64_t *out) {
+    for (uint32_t i = 0; i < stats_slot_count; ++i)
+        out[i] = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(stats_mutex);
+        for (const StatsBlock *block : stats_blocks)
+            for (uint32_t i = 0; i < stats_slot_count; ++i)
+                out[i] += block->values[i];
+    }
+
+    auto gather_jit = [&](auto array) {
+        using UInt64 = decltype(array);
+        uint32_t index = stats_jit_index[dr::backend_v<UInt64> == JitBackend::CUDA];
+        if (index == 0)
+            return;
+        auto &&host = dr::migrate(UInt64::borrow(index), AllocType::Host);
+        dr::sync_thread();
+        for (uint32_t i = 0; i < stats_slot_count; ++i)
+            out[i] += host.data()[i];
+    };
+    DRJIT_MARK_USED(gather_jit);
+
+#if defined(MI_ENABLE_LLVM)
+    gather_jit(dr::LLVMArray<uint64_t>());
+#endif
+#if defined(MI_ENABLE_CUDA)
+    gather_jit(dr::CUDAArray<uint64_t>());
+#endif
+}
+NAMESPACE_END(detail)
+
+void Statistics::set_enabled(bool enabled) {
+    if (enabled && !detail::stats_enabled)
+        detail::stats_timer.reset();
+    detail::stats_enabled = enabled;
+}
+
+uint64_t Statistics::value(StatsCounter counter) {
+    uint64_t values[stats_slot_count];
+    detail::stats_gather(values);
+    return values[(uint32_t) counter];
+}
+
+std::vector<uint64_t> Statistics::path_length_histogram() {
+    uint64_t values[stats_slot_count];
+    detail::stats_gather(values);
+    const uint64_t *hist = values + (uint32_t) StatsCounter::StatsCounterCount;
+    return std::vector<uint64_t>(hist, hist + stats_path_length_bins);
+}
+
+float Statistics::elapsed() {
+    return (float) detail::stats_timer.value();
+}
+
+void Statistics::reset() {
+    {
+        std::lock_guard<std::mutex> guard(detail::stats_mutex);
+        for (detail::StatsBlock *block : detail::stats_blocks)
+            for (uint32_t i = 0; i < stats_slot_count; ++i)
+                block->values[i] = 0;
+    }
+    static_shutdown();
+    detail::stats_timer.reset();
+}
+
+std::string Statistics::to_string() {
+    uint64_t values[stats_slot_count];
+    detail::stats_gather(values);
+
+    float seconds = elapsed() / 1000.f;
+    std::ostringstream oss;
+    oss << "Render statistics (" << util::time_string(elapsed()) << "):"
+        << std::endl;
+    for (uint32_t i = 0; i < (uint32_t) StatsCounter::StatsCounterCount; ++i) {
+        oss << tfm::format("  %-20s %14llu", stats_counter_id[i],
+                           (unsigned long long) values[i]);
+        if (i <= (uint32_t) StatsCounter::RayTest && seconds > 0.f)
+            oss << tfm::format("  (%.2f M/s)", values[i] / seconds * 1e-6f);
+        oss << std::endl;
+    }
+
+    const uint64_t *hist = values + (uint32_t) StatsCounter::StatsCounterCount;
+    uint64_t paths = 0, depth_sum = 0;
+    uint32_t max_bin = 0;
+    for (uint32_t i = 0; i < stats_path_length_bins; ++i) {
+        paths += hist[i];
+        depth_sum += hist[i] * i;
+        if (hist[i])
+            max_bin = i;
+    }
+
+    if (paths > 0) {
+        oss << tfm::format("  %-20s %14llu (average length: %.2f)",
+                           "Paths", (unsigned long long) paths,
+                           double(depth_sum) / double(paths))
+            << std::endl;
+        for (uint32_t i = 0; i <= max_bin; ++i)
+            oss << tfm::format("    length %2u%s %14llu (%5.2f%%)", i,
+                               i == stats_path_length_bins - 1 ? "+" : " ",
+                               (unsigned long long) hist[i],
+                               100.0 * double(hist[i]) / double(paths))
+                << std::endl;
+    }
+
+    return oss.str();
+}
+
+void Statistics::static_shutdown() {
+#if defined(MI_ENABLE_LLVM)
+    if (detail::stats_jit_index[0])
+        (void) dr::LLVMArray<uint64_t>::steal(detail::stats_jit_index[0]);
+#endif
+#if defined(MI_ENABLE_CUDA)
+    if (detail::stats_jit_index[1])
+        (void) dr::CUDAArray<uint64_t>::steal(detail::stats_jit_index[1]);
+#endif
+    detail::stats_jit_index[0] = detail::stats_jit_index[1] = 0;
+}
+
+NAMESPACE_END(mitsuba)
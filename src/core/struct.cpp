@@ -1,6 +1,7 @@
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
+#include <mitsuba/core/qmc.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/hash.h>
 #include <mitsuba/core/jit.h>
@@ -18,9 +19,6 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
-// Defined in dither-matrix256.cpp
-extern const float dither_matrix256[65536];
-
 NAMESPACE_BEGIN(detail)
 
 #if defined(DOUBLE_PRECISION)
@@ -1495,6 +1493,7 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
     __cache[key] = (void *) m_func;
 #else
     m_dither = dither;
+    build_fast_path();
 #endif
 }
 
@@ -1752,9 +1751,187 @@ void StructConverter::save(uint8_t *dst, const Struct::Field &f, Value value, si
     }
 }
 
+void StructConverter::build_fast_path() {
+    using Kind = FastOp::Kind;
+    bool swap = m_source->byte_order() != m_target->byte_order();
+
+    // Weights, alpha (un)premultiplication, and assertions require the general path
+    for (const Struct::Field &f : *m_source) {
+        if (has_flag(f.flags, Struct::Flags::Assert) ||
+            (has_flag(f.flags, Struct::Flags::Weight) && !m_target->has_field(f.name)))
+            return;
+        if (has_flag(f.flags, Struct::Flags::Alpha)) {
+            for (const Struct::Field &f2 : *m_target) {
+                if (!f2.blend.empty() || !m_source->has_field(f2.name) ||
+                    (f2.flags & (Struct::Flags::Weight | Struct::Flags::Alpha)))
+                    continue;
+                if (has_flag(f2.flags, Struct::Flags::PremultipliedAlpha) !=
+                    has_flag(m_source->field(f2.name).flags, Struct::Flags::PremultipliedAlpha))
+                    return;
+            }
+        }
+    }
+
+    uint32_t flag_mask = Struct::Flags::Normalized | Struct::Flags::Gamma;
+    std::vector<FastOp> ops;
+    for (const Struct::Field &f : *m_target) {
+        if (!f.blend.empty() || !m_source->has_field(f.name))
+            return;
+        const Struct::Field &sf = m_source->field(f.name);
+        FastOp op { Kind::Copy, (uint32_t) sf.offset, (uint32_t) f.offset,
+                    (uint32_t) f.size, 0 };
+
+        if (sf.type == f.type && (sf.flags & flag_mask) == (f.flags & flag_mask)) {
+            // Bit-exact copy of the field
+            if (swap && f.size > 1)
+                op.kind = f.size == 2 ? Kind::Swap16
+                                      : (f.size == 4 ? Kind::Swap32 : Kind::Swap64);
+        } else if (sf.type == Struct::Type::UInt8 && f.is_float() &&
+                   f.type != Struct::Type::Float16 &&
+                   !has_flag(f.flags, Struct::Flags::Gamma)) {
+            // Tabulate the linearization of all 256 values
+            op.kind = f.type == Struct::Type::Float32 ? Kind::UInt8ToFloat32
+                                                      : Kind::UInt8ToFloat64;
+            op.lut_offset = (uint32_t) m_fast_lut.size();
+            for (uint32_t i = 0; i < 256; ++i) {
+                Value value;
+                value.type = sf.type;
+                value.flags = sf.flags;
+                value.u = i;
+                linearize(value);
+                m_fast_lut.push_back((float) value.f);
+            }
+        } else {
+            return;
+        }
+
+        // Merge adjacent copies (e.g. the components of a position)
+        if (!ops.empty() && op.kind == Kind::Copy && ops.back().kind == Kind::Copy &&
+            ops.back().src_offset + ops.back().size == op.src_offset &&
+            ops.back().dst_offset + ops.back().size == op.dst_offset)
+            ops.back().size += op.size;
+        else
+            ops.push_back(op);
+    }
+
+    m_fast_ops = std::move(ops);
+    m_fast = true;
+}
+
+void StructConverter::convert_fast(size_t count, const uint8_t *src, uint8_t *dest) const {
+    using Kind = FastOp::Kind;
+    size_t source_size = m_source->size(),
+           target_size = m_target->size();
+
+    // Identical layouts: a single copy
+    if (m_fast_ops.size() == 1 && m_fast_ops[0].kind == Kind::Copy &&
+        m_fast_ops[0].src_offset == 0 && m_fast_ops[0].dst_offset == 0 &&
+        m_fast_ops[0].size == source_size && source_size == target_size) {
+        memcpy(dest, src, count * source_size);
+        return;
+    }
+
+    /* Process the records in blocks that fit into the L1 cache, applying one
+       operation at a time so that the inner loops are simple strided copies */
+    constexpr size_t block_size = 1024;
+    for (size_t start = 0; start < count; start += block_size) {
+        size_t n = std::min(block_size, count - start);
+        const uint8_t *src_block = src + start * source_size;
+        uint8_t *dest_block = dest + start * target_size;
+
+        for (const FastOp &op : m_fast_ops) {
+            const uint8_t *s = src_block + op.src_offset;
+            uint8_t *d = dest_block + op.dst_offset;
+
+            switch (op.kind) {
+                case Kind::Copy:
+                    switch (op.size) {
+                        case 1:
+                            for (size_t i = 0; i < n; ++i)
+                                d[i * target_size] = s[i * source_size];
+                            break;
+                        case 4:
+                            for (size_t i = 0; i < n; ++i)
+                                memcpy(d + i * target_size, s + i * source_size, 4);
+                            break;
+                        case 8:
+                            for (size_t i = 0; i < n; ++i)
+                                memcpy(d + i * target_size, s + i * source_size, 8);
+                            break;
+                        case 12:
+                            for (size_t i = 0; i < n; ++i)
+                                memcpy(d + i * target_size, s + i * source_size, 12);
+                            break;
+                        default:
+                            for (size_t i = 0; i < n; ++i)
+                                memcpy(d + i * target_size, s + i * source_size, op.size);
+                            break;
+                    }
+                    break;
+
+                case Kind::Swap16:
+                    for (size_t i = 0; i < n; ++i) {
+                        uint16_t value;
+                        memcpy(&value, s + i * source_size, sizeof(uint16_t));
+                        value = detail::swap(value);
+                        memcpy(d + i * target_size, &value, sizeof(uint16_t));
+                    }
+                    break;
+
+                case Kind::Swap32:
+                    for (size_t i = 0; i < n; ++i) {
+                        uint32_t value;
+                        memcpy(&value, s + i * source_size, sizeof(uint32_t));
+                        value = detail::swap(value);
+                        memcpy(d + i * target_size, &value, sizeof(uint32_t));
+                    }
+                    break;
+
+                case Kind::Swap64:
+                    for (size_t i = 0; i < n; ++i) {
+                        uint64_t value;
+                        memcpy(&value, s + i * source_size, sizeof(uint64_t));
+                        value = detail::swap(value);
+                        memcpy(d + i * target_size, &value, sizeof(uint64_t));
+                    }
+                    break;
+
+                case Kind::UInt8ToFloat32: {
+                        const float *lut = m_fast_lut.data() + op.lut_offset;
+                        for (size_t i = 0; i < n; ++i) {
+                            float value = lut[s[i * source_size]];
+                            if (m_target->byte_order() != Struct::host_byte_order())
+                                value = dr::memcpy_cast<float>(
+                                    detail::swap(dr::memcpy_cast<uint32_t>(value)));
+                            memcpy(d + i * target_size, &value, sizeof(float));
+                        }
+                    }
+                    break;
+
+                case Kind::UInt8ToFloat64: {
+                        const float *lut = m_fast_lut.data() + op.lut_offset;
+                        for (size_t i = 0; i < n; ++i) {
+                            double value = (double) lut[s[i * source_size]];
+                            if (m_target->byte_order() != Struct::host_byte_order())
+                                value = dr::memcpy_cast<double>(
+                                    detail::swap(dr::memcpy_cast<uint64_t>(value)));
+                            memcpy(d + i * target_size, &value, sizeof(double));
+                        }
+                    }
+                    break;
+            }
+        }
+    }
+}
+
 bool StructConverter::convert_2d(size_t width, size_t height, const void *src_, void *dest_) const {
     using namespace mitsuba::detail;
 
+    if (m_fast) {
+        convert_fast(width * height, (const uint8_t *) src_, (uint8_t *) dest_);
+        return true;
+    }
+
     size_t source_size = m_source->size();
     size_t target_size = m_target->size();
     Struct::Field weight_field, alpha_field;
@@ -1,9 +1,30 @@
 #include <mitsuba/core/tensor.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/zstream.h>
 #include <mitsuba/core/util.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Size of a single entry of the given type
+static size_t type_size(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Int8:
+        case Struct::Type::UInt8:   return 1;
+        case Struct::Type::Int16:
+        case Struct::Type::UInt16:
+        case Struct::Type::Float16: return 2;
+        case Struct::Type::Int32:
+        case Struct::Type::UInt32:
+        case Struct::Type::Float32: return 4;
+        case Struct::Type::Int64:
+        case Struct::Type::UInt64:
+        case Struct::Type::Float64: return 8;
+        default: Throw("TensorFile: invalid field type!");
+    }
+}
+
 TensorFile::TensorFile(const fs::path &filename)
     : MemoryMappedFile(filename, false) {
     if (size() < 12 + 2 + 4)
@@ -17,7 +38,7 @@ TensorFile::TensorFile(const fs::path &filename)
 
     if (memcmp(header, "tensor_file", 12) != 0)
         Throw("Invalid tensor file: invalid header.");
-    else if (version[1] != 0 && version[1] != 0)
+    else if (version[0] != 1 || version[1] > 1)
         Throw("Invalid tensor file: unknown file version.");
 
     Log(Info, "Loading tensor data from \"%s\" .. (%s, %i field%s)",
@@ -45,12 +66,113 @@ TensorFile::TensorFile(const fs::path &filename)
             shape[j] = (size_t) size_value;
         }
 
-        m_fields[name] =
-            Field{ (Struct::Type) dtype, static_cast<size_t>(offset), shape,
-                   (const uint8_t *) data() + offset };
+        Field field{ (Struct::Type) dtype, static_cast<size_t>(offset), shape,
+                     (const uint8_t *) data() + offset };
+        size_t field_size = field.size() * type_size(field.dtype),
+               stored_size = field_size;
+
+        // Version 1.1 adds the compression scheme and size of the stored data
+        uint8_t compression = 0;
+        if (version[1] >= 1) {
+            uint64_t size_value;
+            stream->read(compression);
+            stream->read(size_value);
+            stored_size = (size_t) size_value;
+            if (compression > 1)
+                Throw("Invalid tensor file: unknown compression scheme.");
+        }
+
+        if (offset + stored_size > size())
+            Throw("Invalid tensor file: field \"%s\" exceeds the file size, "
+                  "truncated?", name);
+
+        if (compression == 1) {
+            // Inflate into an aligned buffer owned by this instance
+            std::unique_ptr<uint8_t[]> buffer(new uint8_t[field_size + Alignment]);
+            uint8_t *ptr = buffer.get() +
+                (Alignment - (uintptr_t) buffer.get() % Alignment) % Alignment;
+
+            ref<MemoryStream> mstream =
+                new MemoryStream((void *) field.data, stored_size);
+            ref<ZStream> zstream = new ZStream(mstream, ZStream::EDeflateStream);
+            zstream->read(ptr, field_size);
+
+            field.data = ptr;
+            field.compressed = true;
+            m_buffers.push_back(std::move(buffer));
+        } else if (stored_size != field_size) {
+            Throw("Invalid tensor file: field \"%s\" has an invalid size.", name);
+        }
+
+        m_fields[name] = field;
     }
 }
 
+void TensorFile::write(const fs::path &filename,
+                       const std::vector<std::pair<std::string, Field>> &fields,
+                       int compression_level) {
+    // Compress fields beforehand, their size is needed to lay out the file
+    std::vector<ref<MemoryStream>> compressed(fields.size());
+    size_t header_size = 12 + 2 + 4;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const auto &[name, field] = fields[i];
+        if (name.size() > 0xFFFF || field.shape.size() > 0xFFFF)
+            Throw("TensorFile::write(): field \"%s\" has an overly long name "
+                  "or too many dimensions!", name);
+        header_size += 2 + name.size() + 2 + 1 + 8 + 8 * field.shape.size() + 1 + 8;
+
+        if (field.compressed) {
+            compressed[i] = new MemoryStream();
+            ref<ZStream> zstream = new ZStream(
+                compressed[i], ZStream::EDeflateStream, compression_level);
+            zstream->write(field.data, field.size() * type_size(field.dtype));
+            zstream->close();
+        }
+    }
+
+    // Assign aligned offsets to the fields
+    std::vector<size_t> offsets(fields.size()), sizes(fields.size());
+    size_t offset = header_size;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        offset = (offset + Alignment - 1) / Alignment * Alignment;
+        offsets[i] = offset;
+        sizes[i] = compressed[i] ? compressed[i]->size()
+                                 : fields[i].second.size() *
+                                       type_size(fields[i].second.dtype);
+        offset += sizes[i];
+    }
+
+    ref<FileStream> stream = new FileStream(filename, FileStream::ETruncReadWrite);
+    const uint8_t version[2] = { 1, 1 };
+    stream->write("tensor_file", 12);
+    stream->write(version, 2);
+    stream->write((uint32_t) fields.size());
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const auto &[name, field] = fields[i];
+        stream->write((uint16_t) name.size());
+        stream->write(name.data(), name.size());
+        stream->write((uint16_t) field.shape.size());
+        stream->write((uint8_t) field.dtype);
+        stream->write((uint64_t) offsets[i]);
+        for (size_t s : field.shape)
+            stream->write((uint64_t) s);
+        stream->write((uint8_t) (compressed[i] ? 1 : 0));
+        stream->write((uint64_t) sizes[i]);
+    }
+
+    const uint8_t padding[Alignment] = { };
+    for (size_t i = 0; i < fields.size(); ++i) {
+        stream->write(padding, offsets[i] - stream->tell());
+        if (compressed[i])
+            stream->write(compressed[i]->raw_buffer(), sizes[i]);
+        else
+            stream->write(fields[i].second.data, sizes[i]);
+    }
+
+    stream->close();
+}
+
 /// Does the file contain a field of the specified name?
 bool TensorFile::has_field(const std::string &name) const {
     return m_fields.find(name) != m_fields.end();
@@ -64,6 +186,14 @@ const TensorFile::Field &TensorFile::field(const std::string &name) const {
     return it->second;
 }
 
+std::vector<std::string> TensorFile::field_names() const {
+    std::vector<std::string> result;
+    for (const auto &it : m_fields)
+        result.push_back(it.first);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
 TensorFile::~TensorFile() { }
 
 std::string TensorFile::to_string() const {
@@ -78,6 +208,7 @@ std::string TensorFile::to_string() const {
         oss << "    \"" << it.first << "\"" << " => [" << std::endl
             << "      dtype = " << it.second.dtype << "," << std::endl
             << "      offset = " << it.second.offset << "," << std::endl
+            << "      compressed = " << it.second.compressed << "," << std::endl
             << "      shape = [";
         const auto& shape = it.second.shape;
         for (size_t j = 0; j < shape.size(); ++j) {
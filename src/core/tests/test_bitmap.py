@@ -198,6 +198,24 @@ def test_read_write_pfm(variant_scalar_rgb, tmpdir, np_rng):
     os.remove(tmp_file)
 
 
+def test_read_pfm_mapped(variant_scalar_rgb, tmpdir, np_rng):
+    # Big-endian PFM file with a scale factor, read from a memory mapping
+    ref = np.float32(np_rng.random((20, 10, 3)))
+    tmp_file = os.path.join(str(tmpdir), "out_be.pfm")
+    with open(tmp_file, 'wb') as f:
+        f.write(b'PF\n10 20\n2.0\n')
+        f.write((ref[::-1] * 0.5).astype('>f4').tobytes())
+
+    b = mi.Bitmap(tmp_file)
+    assert b.pixel_format() == mi.Bitmap.PixelFormat.RGB
+    assert np.allclose(np.array(b), ref)
+
+    # Must match the result of reading through a regular stream
+    b2 = mi.Bitmap(mi.FileStream(tmp_file))
+    assert np.all(np.array(b) == np.array(b2))
+    os.remove(tmp_file)
+
+
 def test_read_write_ppm(variant_scalar_rgb, tmpdir, np_rng):
     b = mi.Bitmap(mi.Bitmap.PixelFormat.RGB, mi.Struct.Type.UInt8, [10, 20])
     ref = np.uint8(np_rng.random((20, 10, 3))*255)
@@ -371,6 +389,29 @@ def test_resample(variants_all):
     assert b3.premultiplied_alpha()
 
 
+@pytest.mark.parametrize('bc', ['Clamp', 'Repeat', 'Mirror', 'Zero', 'One'])
+def test_resample_vertical_rows(variant_scalar_rgb, bc):
+    # Row-wise vertical resampling must match the per-column Resampler
+    np.random.seed(0)
+    data = np.random.rand(37, 23, 3).astype(np.float32)
+    b = mi.Bitmap(data)
+    bc = getattr(mi.FilterBoundaryCondition, bc)
+    rfilter = mi.load_dict({'type': 'lanczos', 'lobes': 2})
+
+    for height in [60, 11]:
+        result = np.array(b.resample([23, height], rfilter, (bc, bc)))
+
+        r = mi.Resampler(rfilter, 37, height)
+        r.set_boundary_condition(bc)
+        ref = np.zeros((height, 23, 3), dtype=np.float32)
+        for x in range(23):
+            column = np.zeros(height * 3, dtype=np.float32)
+            r.resample(np.ascontiguousarray(data[:, x, :]).ravel(), 1, column, 1, 3)
+            ref[:, x, :] = column.reshape(height, 3)
+
+        assert np.allclose(result, ref, atol=1e-6)
+
+
 def test_check_weight_division(variant_scalar_rgb):
     b = mi.Bitmap(
         pixel_format=mi.Bitmap.PixelFormat.RGBAW,
@@ -400,3 +441,47 @@ def test_check_weight_division(variant_scalar_rgb):
     assert np.all(x[0, 0, :] == (2, 0, 0, 0))
     assert np.all(x[1, 0, :] == (1, 0, 0, 0))
     assert np.all(x[2, 0, :] == (2, 0, 0, 0))
+
+
+def test_convert_parallel_dither(variant_scalar_rgb):
+    # Tall images are converted in blocks of rows: the dither pattern must
+    # still repeat with a period of 256 rows, as in a single conversion
+    b = mi.Bitmap(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.Float32, [16, 700])
+    np.array(b, copy=False)[:] = 0.3
+    b2 = np.array(b.convert(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.UInt8, False))
+    assert np.all(b2[0:256] == b2[256:512])
+    assert np.all(b2[0:188] == b2[512:700])
+
+
+def test_bitmap_writer(variant_scalar_rgb, tmpdir):
+    # A single worker with a queue of one request: 'write' must block
+    # instead of accumulating images, and all files must be complete
+    writer = mi.BitmapWriter(1, 1)
+    assert writer.worker_count() == 1
+    assert writer.queue_capacity() == 1
+
+    bitmaps, futures, paths = [], [], []
+    for i in range(6):
+        b = mi.Bitmap(mi.Bitmap.PixelFormat.RGB, mi.Struct.Type.Float32, [32, 16])
+        np.array(b, copy=False)[:] = i
+        path = os.path.join(str(tmpdir), "out_%i.exr" % i)
+        bitmaps.append(b)
+        paths.append(path)
+        futures.append(writer.write(b, path))
+
+    futures[-1].wait()
+    writer.flush()
+    assert writer.pending() == 0
+    assert all(f.done() for f in futures)
+
+    for i, path in enumerate(paths):
+        assert np.all(np.array(mi.Bitmap(path)) == i)
+
+    # Errors are reported by the future and by the next call to 'flush'
+    b = mi.Bitmap(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.Float32, [4, 4])
+    future = writer.write(b, os.path.join(str(tmpdir), "missing", "out.exr"))
+    with pytest.raises(RuntimeError):
+        future.wait()
+    with pytest.raises(RuntimeError):
+        writer.flush()
+    writer.flush()
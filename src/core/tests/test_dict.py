@@ -504,3 +504,94 @@ def test12_dict_spectrum(variant_scalar_spectral):
     """)
 
     assert str(s1) == str(s2)
+
+
+@pytest.mark.parametrize("parallel", [False, True])
+def test13_dict_instances(variants_all_rgb, parallel):
+    import numpy as np
+    np.random.seed(0)
+
+    n = 100
+    offsets = np.random.uniform(-10, 10, size=(n, 3))
+    to_world = np.tile(np.eye(4), (n, 1, 1))
+    to_world[:, :3, 3] = offsets
+    shape_index = np.arange(n) % 2
+
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'group_0' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'sphere', 'radius' : 0.1 }
+        },
+        'group_1' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'cube', 'to_world' : mi.ScalarTransform4f.scale(0.2) }
+        },
+        'objects' : {
+            'type' : 'instances',
+            'shapes' : [ { 'type' : 'ref', 'id' : 'group_0' },
+                         { 'type' : 'ref', 'id' : 'group_1' } ],
+            'shape_index' : shape_index,
+            'to_world' : to_world
+        }
+    }, parallel=parallel)
+
+    shapes = scene.shapes()
+    assert len(shapes) == n
+
+    ids = sorted(int(s.id().split('_')[-1]) for s in shapes)
+    assert ids == list(range(n))
+
+    for s in shapes:
+        i = int(s.id().split('_')[-1])
+        extent = 0.1 if shape_index[i] == 0 else 0.2
+        bbox = s.bbox()
+        assert dr.allclose(bbox.center(), offsets[i], atol=1e-5)
+        assert dr.allclose(bbox.extents(), 2 * extent, atol=1e-5)
+
+
+def test14_dict_instances_errors(variant_scalar_rgb):
+    import numpy as np
+
+    group = { 'type' : 'shapegroup', 'shape' : { 'type' : 'sphere' } }
+
+    # Several shape groups require a shape index
+    with pytest.raises(Exception) as e:
+        mi.load_dict({
+            'type' : 'scene',
+            'group_0' : group,
+            'group_1' : group,
+            'objects' : {
+                'type' : 'instances',
+                'shapes' : [ { 'type' : 'ref', 'id' : 'group_0' },
+                             { 'type' : 'ref', 'id' : 'group_1' } ],
+                'to_world' : np.tile(np.eye(4), (4, 1, 1))
+            }
+        })
+    e.match('shape_index')
+
+    # Out-of-bounds shape index
+    with pytest.raises(Exception) as e:
+        mi.load_dict({
+            'type' : 'scene',
+            'group_0' : group,
+            'objects' : {
+                'type' : 'instances',
+                'shapes' : { 'type' : 'ref', 'id' : 'group_0' },
+                'shape_index' : [0, 1],
+                'to_world' : np.tile(np.eye(4), (2, 1, 1))
+            }
+        })
+    e.match('out of bounds')
+
+    # 3x4 matrices are accepted
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'group_0' : group,
+        'objects' : {
+            'type' : 'instances',
+            'shapes' : { 'type' : 'ref', 'id' : 'group_0' },
+            'to_world' : np.tile(np.eye(4)[:3], (2, 1, 1))
+        }
+    })
+    assert len(scene.shapes()) == 2
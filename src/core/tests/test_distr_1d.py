@@ -268,3 +268,86 @@ def test18_irrcont_simple_function(variants_vec_backends_once):
                 0.48734, 0.654313, 0.786607, 0.899653, 1.])
          * d.normalization())
     )
+
+
+def test19_cont_sharp_peak(variants_vec_backends_once):
+    # The guide table must not change the result of sampling
+    x = dr.linspace(mi.Float, -1, 1, 1025)
+    y = dr.exp(-5000 * dr.sqr(x - 0.9)) + 1e-3
+
+    d = mi.ContinuousDistribution([-1, 1], y)
+    u = dr.linspace(mi.Float, 0, 1, 10001)
+    assert dr.allclose(d.eval_cdf_normalized(d.sample(u)), u, atol=1e-4)
+
+    sample, pdf = d.sample_pdf(u)
+    assert dr.allclose(sample, d.sample(u))
+    assert dr.allclose(pdf, d.eval_pdf_normalized(sample, True), rtol=1e-3)
+
+
+def test20_alias_invalid(variants_all_backends_once):
+    # The alias table rejects the same inputs as DiscreteDistribution
+    with pytest.raises(RuntimeError) as excinfo:
+        mi.AliasDistribution().update()
+    assert 'empty distribution' in str(excinfo.value)
+
+    with pytest.raises(RuntimeError) as excinfo:
+        mi.AliasDistribution([0, 0, 0])
+    assert "no probability mass found" in str(excinfo.value)
+
+    with pytest.raises(RuntimeError) as excinfo:
+        mi.AliasDistribution([1, -1, 1])
+    assert "entries must be non-negative" in str(excinfo.value)
+
+
+def test21_alias_histogram(variants_vec_backends_once):
+    # Sample counts and reused variates of the alias table match the PMF
+    import numpy as np
+
+    pmf = [0, 1, 3, 0, 2, 10, 0.5, 0]
+    x = mi.AliasDistribution(pmf)
+    assert len(x) == 8
+    assert x.sum() == sum(pmf)
+    assert dr.allclose(x.eval_pmf_normalized([1, 5]), [1 / 16.5, 10 / 16.5])
+
+    n = 100000
+    u = (dr.arange(mi.Float, n) + 0.5) / n
+    index, reused, prob = x.sample_reuse_pmf(u)
+    assert dr.allclose(prob, x.eval_pmf_normalized(index))
+
+    index = np.array(index)
+    hist = np.bincount(index, minlength=len(pmf)) / n
+    assert np.allclose(hist, np.array(pmf) / sum(pmf), atol=1e-3)
+
+    # The reused variate is uniformly distributed within each bucket
+    reused = np.array(reused)
+    assert np.all((reused >= 0) & (reused < 1))
+    for i in [2, 5]:
+        r = reused[index == i]
+        assert abs(np.mean(r) - 0.5) < 1e-2
+
+
+def test22_irrcont_guide_tables(variants_vec_backends_once):
+    # Guided lookups must match a reference search over irregular nodes
+    import numpy as np
+    rng = np.random.default_rng(0)
+    nodes = np.cumsum(rng.uniform(0.01, 1, 1000)) + 360
+    nodes[500:510] = nodes[499] + np.linspace(1e-3, 1e-2, 10)
+    nodes[510:] = nodes[510:] - nodes[510] + nodes[509] + 1e-3
+    pdf = rng.uniform(0, 1, 1000)
+    pdf[600:] += 50 * np.exp(-0.5 * ((np.arange(400) - 50) / 2) ** 2)
+
+    nodes, pdf = nodes.astype(np.float32), pdf.astype(np.float32)
+    d = mi.IrregularContinuousDistribution(mi.Float(nodes), mi.Float(pdf))
+
+    x = np.linspace(nodes[0] - 1, nodes[-1] + 1, 10007, dtype=np.float32)
+    x = np.concatenate([x, nodes])
+    ref = np.where((x >= nodes[0]) & (x <= nodes[-1]), np.interp(x, nodes, pdf), 0)
+    assert np.allclose(np.array(d.eval_pdf(mi.Float(x))), ref, rtol=1e-4, atol=1e-5)
+
+    u = dr.linspace(mi.Float, 0, 1, 10001)
+    sample = d.sample(u)
+    assert dr.allclose(d.eval_cdf_normalized(sample), u, atol=1e-4)
+
+    sample_2, pdf_2 = d.sample_pdf(u)
+    assert dr.allclose(sample_2, sample)
+    assert dr.allclose(pdf_2, d.eval_pdf_normalized(sample, True), rtol=1e-3)
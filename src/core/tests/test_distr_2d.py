@@ -177,3 +177,29 @@ def test05_discrete_distribution_2d(variants_all_backends_once):
     assert allclose(d.sample([1, 0]), ([2, 0], .3, [1, 0]))
     assert allclose(d.sample([0, 6 / 10 - 1e-7]), ([0, 0], .1, [0, 1]))
     assert allclose(d.sample([0, 6 / 10 + 1e-7]), ([1, 1], .1, [0, 0]))
+
+
+@pytest.mark.parametrize("warp", ['Hierarchical2D', 'MarginalDiscrete2D', 'MarginalContinuous2D'])
+def test06_large_distribution(variants_vec_backends_once, warp):
+    # Large tables are constructed in parallel across slices and rows
+    rng = np.random.default_rng(seed=0)
+    values = rng.random((3, 513, 1025)) * 10
+    values[1, 100:200, 300:400] = 1000
+    param_res = [[0, 0.5, 1]]
+
+    distr = getattr(mi, warp + '1')(values, param_res)
+
+    n = 100000
+    u = mi.Point2f(rng.random(n), rng.random(n))
+    for p in [0, 0.5, 1]:
+        param = [mi.Float(p)]
+
+        # The density is normalized
+        pdf = distr.eval(u, param=param)
+        assert np.allclose(np.mean(pdf), 1, rtol=1e-2)
+
+        # Forward and inverse mapping are consistent
+        p_o, pdf_o = distr.sample(u, param=param)
+        assert dr.allclose(distr.eval(p_o, param=param), pdf_o, rtol=1e-3)
+        p_i, _ = distr.invert(p_o, param=param)
+        assert dr.allclose(p_i, u, atol=1e-3)
@@ -153,3 +153,47 @@ def test12_truncate_and_file_size(variant_scalar_rgb):
     assert fs.file_size(p) == 42
     assert fs.remove(p)
     assert not fs.exists(p)
+
+
+def test13_file_resolver_cache(variant_scalar_rgb, tmp_path):
+    dir1, dir2 = tmp_path / 'dir1', tmp_path / 'dir2'
+    dir1.mkdir()
+    dir2.mkdir()
+    (dir2 / 'a.txt').write_text('a')
+
+    fr = mi.FileResolver()
+    fr.clear()
+    fr.append(str(dir1))
+    fr.prefetch(['a.txt', 'b.txt'])
+    assert fr.resolve('a.txt') == fs.path('a.txt')
+
+    # Appending a search path retries failed lookups
+    fr.append(str(dir2))
+    assert fr.resolve('a.txt') == fs.path(str(dir2 / 'a.txt'))
+
+    # Prepending a search path may shadow previous results
+    (dir1 / 'a.txt').write_text('a')
+    fr.prepend(str(dir1))
+    assert fr.resolve('a.txt') == fs.path(str(dir1 / 'a.txt'))
+
+
+def test14_last_write_time(variant_scalar_rgb, tmp_path):
+    import os
+    p = tmp_path / 'a.txt'
+    p.write_text('a')
+    os.utime(str(p), (1000000000, 1000000000))
+    assert fs.last_write_time(str(p)) == 1000000000
+
+    with pytest.raises(RuntimeError, match='cannot stat'):
+        fs.last_write_time(str(tmp_path / 'b.txt'))
+
+
+def test14_file_resolver_created_after_failed_lookup(variant_scalar_rgb, tmp_path):
+    fr = mi.FileResolver()
+    fr.clear()
+    fr.append(str(tmp_path))
+    assert fr.resolve('c.txt') == fs.path('c.txt')
+
+    # A file created after a failed lookup is found without clearing the cache
+    (tmp_path / 'c.txt').write_text('c')
+    assert fr.resolve('c.txt') == fs.path(str(tmp_path / 'c.txt'))
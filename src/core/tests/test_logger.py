@@ -39,3 +39,107 @@ def test01_custom(variant_scalar_rgb):
         for app in appenders:
             logger.add_appender(app)
         logger.set_formatter(formatter)
+
+
+def test02_async(variant_scalar_rgb):
+    # Messages of many threads are delivered in order by the background thread
+    import threading
+    messages = []
+
+    logger = mi.Thread.thread().logger()
+    appenders = []
+    while logger.appender_count() > 0:
+        app = logger.appender(0)
+        appenders.append(app)
+        logger.remove_appender(app)
+
+    class MyAppender(mi.Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+    try:
+        logger.add_appender(MyAppender())
+        logger.set_async(True)
+        assert logger.is_async()
+
+        def work(index):
+            for i in range(100):
+                mi.Log(mi.LogLevel.Warn, f'thread {index}, message {i}')
+
+        threads = [threading.Thread(target=work, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        logger.flush()
+        assert len(messages) == 400
+        for index in range(4):
+            ids = [int(m.split('message ')[1]) for m in messages
+                   if f'thread {index},' in m]
+            assert ids == list(range(100))
+    finally:
+        logger.set_async(False)
+        assert not logger.is_async()
+        logger.clear_appenders()
+        for app in appenders:
+            logger.add_appender(app)
+
+
+def test03_thread_environment(variant_scalar_rgb):
+    thread = mi.Thread.thread()
+    logger = thread.logger()
+    env = mi.ThreadEnvironment()
+
+    other = mi.Logger(mi.LogLevel.Error)
+    thread.set_logger(other)
+    try:
+        # Switching to a captured environment must not reuse a stale one
+        with mi.ScopedSetThreadEnvironment(env):
+            assert thread.logger().log_level() == logger.log_level()
+        assert thread.logger().log_level() == mi.LogLevel.Error
+
+        # Entering the environment that is already current is a no-op
+        env_other = mi.ThreadEnvironment()
+        with mi.ScopedSetThreadEnvironment(env_other):
+            assert thread.logger().log_level() == mi.LogLevel.Error
+            with mi.ScopedSetThreadEnvironment(env):
+                assert thread.logger().log_level() == logger.log_level()
+            assert thread.logger().log_level() == mi.LogLevel.Error
+        assert thread.logger().log_level() == mi.LogLevel.Error
+    finally:
+        thread.set_logger(logger)
+
+
+def test04_async_queue_full(variant_scalar_rgb):
+    # The GIL is held while logging, hence a full queue must not make the
+    # submitting thread wait for the background thread (which needs the GIL
+    # to invoke the Python appender)
+    messages = []
+
+    logger = mi.Thread.thread().logger()
+    appenders = []
+    while logger.appender_count() > 0:
+        app = logger.appender(0)
+        appenders.append(app)
+        logger.remove_appender(app)
+
+    class MyAppender(mi.Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+    try:
+        logger.add_appender(MyAppender())
+        logger.set_async(True)
+
+        count = 3 * 4096
+        for i in range(count):
+            mi.Log(mi.LogLevel.Warn, f'message {i}')
+
+        logger.flush()
+        assert [int(m.split('message ')[1]) for m in messages] == list(range(count))
+    finally:
+        logger.set_async(False)
+        logger.clear_appenders()
+        for app in appenders:
+            logger.add_appender(app)
@@ -95,3 +95,15 @@ def test09_morton3(variant_scalar_rgb):
     v1 = mi.math.morton_encode3(v0)
     v2 = mi.math.morton_decode3(v1)
     assert dr.all(v0 == v2)
+
+
+def test10_sincos_fast(variant_llvm_rgb):
+    x = dr.linspace(mi.Float, -dr.pi / 4, dr.pi / 4, 1001)
+    s, c = mi.math.sincos_quarter_pi(x)
+    assert dr.max(dr.abs(s - dr.sin(x)))[0] < 4e-7
+    assert dr.max(dr.abs(c - dr.cos(x)))[0] < 4e-7
+
+    u = dr.linspace(mi.Float, -1, 1, 10001)
+    s, c = mi.math.sincos_2pi_fast(u)
+    assert dr.max(dr.abs(s - dr.sin(2 * dr.pi * u)))[0] < 1e-6
+    assert dr.max(dr.abs(c - dr.cos(2 * dr.pi * u)))[0] < 1e-6
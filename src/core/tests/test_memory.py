@@ -0,0 +1,68 @@
+import gc
+import mitsuba as mi
+
+
+def test01_bitmap_usage(variant_scalar_rgb):
+    before = mi.MemoryTracker.usage(mi.MemoryCategory.Bitmap)[0]
+    b = mi.Bitmap(mi.Bitmap.PixelFormat.RGBA, mi.Struct.Type.Float32, [64, 32])
+    assert mi.MemoryTracker.usage(mi.MemoryCategory.Bitmap)[0] == \
+        before + 64 * 32 * 4 * 4
+
+    report = mi.memory_report()
+    assert report['Bitmaps']['host'] == before + 64 * 32 * 4 * 4
+    assert report['Total']['total'] >= report['Bitmaps']['total']
+    assert report['Peak'] >= report['Total']['total']
+
+    del b
+    gc.collect()
+    assert mi.MemoryTracker.usage(mi.MemoryCategory.Bitmap)[0] == before
+
+
+def test02_scene_usage(variant_scalar_rgb):
+    mesh_before = mi.MemoryTracker.usage(mi.MemoryCategory.Mesh)[0]
+    accel_before = mi.MemoryTracker.usage(mi.MemoryCategory.Accel)[0]
+    scene = mi.load_dict({
+        'type': 'scene',
+        'rect': {'type': 'rectangle'},
+    })
+    assert mi.MemoryTracker.usage(mi.MemoryCategory.Mesh)[0] > mesh_before
+    # Embree only approximates its memory usage, which may be zero
+    assert mi.MemoryTracker.usage(mi.MemoryCategory.Accel)[0] >= accel_before
+    assert 'Meshes' in mi.MemoryTracker.to_string()
+
+    del scene
+    gc.collect()
+    assert mi.MemoryTracker.usage(mi.MemoryCategory.Mesh)[0] == mesh_before
+    assert mi.MemoryTracker.usage(mi.MemoryCategory.Accel)[0] == accel_before
+
+
+def test03_budget(variant_scalar_rgb):
+    logger = mi.Thread.thread().logger()
+    appenders = [logger.appender(i) for i in range(logger.appender_count())]
+    messages = []
+
+    class MyAppender(mi.Appender):
+        def append(self, level, text):
+            if level == mi.LogLevel.Warn:
+                messages.append(text)
+
+    logger.add_appender(MyAppender())
+    total = sum(mi.MemoryTracker.total())
+    try:
+        mi.MemoryTracker.set_budget(total + 1024)
+        assert mi.MemoryTracker.budget() == total + 1024
+
+        b = mi.Bitmap(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.UInt8, [16, 16])
+        assert len(messages) == 0
+
+        # Exceeding the budget warns once, until the usage drops below it
+        b2 = mi.Bitmap(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.UInt8, [64, 64])
+        b3 = mi.Bitmap(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.UInt8, [64, 64])
+        assert len(messages) == 1
+        assert 'exceeds the budget' in messages[0]
+        del b, b2, b3
+    finally:
+        mi.MemoryTracker.set_budget(0)
+        logger.clear_appenders()
+        for app in appenders:
+            logger.add_appender(app)
@@ -0,0 +1,27 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def test01_manifest(variant_scalar_rgb):
+    pmgr = mi.PluginManager.instance()
+    plugins = pmgr.available_plugins()
+    if len(plugins) == 0:
+        pytest.skip('No plugin manifest was found')
+
+    assert plugins == sorted(plugins)
+    for name in ['diffuse', 'path', 'hdrfilm', 'independent', 'perspective']:
+        assert name in plugins
+
+
+def test02_lazy_loading(variant_scalar_rgb):
+    pmgr = mi.PluginManager.instance()
+
+    # Only referenced plugins are loaded
+    mi.load_dict({'type': 'roughplastic'})
+    loaded = pmgr.loaded_plugins()
+    assert 'roughplastic' in loaded
+    assert len(loaded) < max(len(pmgr.available_plugins()), len(loaded) + 1)
+
+    assert pmgr.get_plugin_class('roughplastic', 'scalar_rgb').name() == 'RoughPlastic'
+    assert pmgr.get_plugin_class('does_not_exist', 'scalar_rgb') is None
@@ -194,3 +194,32 @@ def test10_animated_transforms(variant_scalar_rgb):
     assert type(p["trafo"]) is mi.Transform4d
     assert type(p["atrafo"]) is mi.AnimatedTransform
 
+
+def test11_large_property_sets(variant_scalar_rgb):
+    # Enough entries to exercise the hash index of the property table
+    p = mi.Properties()
+    count = 1000
+    for i in reversed(range(count)):
+        p[f'arg_{i}'] = i
+
+    assert len(p.property_names()) == count
+    assert p.property_names()[:3] == ['arg_0', 'arg_1', 'arg_2']
+    assert p.property_names()[-1] == f'arg_{count - 1}'
+    assert all(p[f'arg_{i}'] == i for i in range(count))
+
+    # Removal keeps the remaining entries reachable
+    for i in range(0, count, 2):
+        assert p.remove_property(f'arg_{i}')
+    assert not p.has_property('arg_0')
+    assert all(p[f'arg_{i}'] == i for i in range(1, count, 2))
+    assert p.property_names()[:2] == ['arg_1', 'arg_3']
+
+    p['arg_0'] = 'again'
+    assert p['arg_0'] == 'again'
+    assert p.property_names()[0] == 'arg_0'
+
+    # Clearing the whole set
+    for name in p.property_names():
+        assert p.remove_property(name)
+    assert len(p.property_names()) == 0
+    assert not p.has_property('arg_1')
@@ -150,3 +150,33 @@ def test_eval_2d(variant_scalar_rgb):
     assert dr.allclose(spline.eval_2d(nodes_x, nodes_y, values, 0, 1),     0)
     assert dr.allclose(spline.eval_2d(nodes_x, nodes_y, values, 1, 1),     1)
     assert dr.allclose(spline.eval_2d(nodes_x, nodes_y, values, 0.5, 0.5), 0.5)
+
+
+def test_eval_1d_precomputed(variant_scalar_rgb):
+    from mitsuba import spline
+
+    nodes = Float([0.0, 0.1, 0.5, 0.6, 1.0])
+    for values in [values1, values2, values3]:
+        coeffs = spline.precompute_1d(values)
+        assert len(coeffs) == 4 * (len(values) - 1)
+        coeffs_n = spline.precompute_1d(nodes, values)
+
+        for i in range(21):
+            x = i / 20
+            assert dr.allclose(spline.eval_1d_precomputed(0, 1, coeffs, x),
+                               spline.eval_1d(0, 1, values, x))
+            assert dr.allclose(spline.eval_1d_precomputed(nodes, coeffs_n, x),
+                               spline.eval_1d(nodes, values, x))
+
+        # Out-of-range arguments evaluate to zero
+        assert spline.eval_1d_precomputed(0, 1, coeffs, 1.5) == 0
+        assert spline.eval_1d_precomputed(nodes, coeffs_n, -0.5) == 0
+
+
+def test_eval_1d_precomputed_vec(variant_llvm_rgb):
+    from mitsuba import spline
+
+    x = dr.linspace(mi.Float, -0.1, 1.1, 100)
+    coeffs = spline.precompute_1d(values3)
+    assert dr.allclose(spline.eval_1d_precomputed(0, 1, coeffs, x),
+                       spline.eval_1d(0, 1, values3, x))
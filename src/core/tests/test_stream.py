@@ -2,7 +2,8 @@ import os
 import pytest
 import drjit as dr
 
-from mitsuba.scalar_rgb import Stream, DummyStream, FileStream, MemoryStream, ZStream
+from mitsuba.scalar_rgb import Stream, DummyStream, FileStream, MemoryStream, ZStream, \
+    BlockZStream
 from mitsuba.scalar_rgb.test.util import tmpfile, make_tmpfile
 
 parameters = [
@@ -283,3 +284,30 @@ def test08_fstream(rw, tmpfile):
     else:
         with pytest.raises(RuntimeError):
             FileStream(new_name)
+
+
+def test09_block_zstream():
+    import numpy as np
+    data = np.arange(200000, dtype=np.uint32).tobytes()
+
+    # Use small blocks so that the data spans several batches of blocks
+    stream = MemoryStream()
+    zstream = BlockZStream(stream, block_size=4096)
+    assert zstream.can_write()
+    zstream.write(data[:1000])
+    zstream.flush()
+    zstream.write(data[1000:])
+    zstream.write_string('hello world')
+    zstream.close()
+    assert zstream.is_closed()
+    assert stream.size() < len(data)
+
+    with pytest.raises(RuntimeError):
+        BlockZStream(MemoryStream()).tell()
+
+    stream.seek(0)
+    zstream = BlockZStream(stream, block_size=4096)
+    assert zstream.read(len(data)) == data
+    assert zstream.read_string() == 'hello world'
+    with pytest.raises(RuntimeError):
+        zstream.read_uint32()
@@ -443,3 +443,46 @@ def test19_alpha_4():
     dst_data = (src_data_float[0], src_data_float[1], src_data[2])
     check_conversion(s, '@BBB', '@BBB',
                      src_data, dst_data)
+
+
+def test20_permute_many_records():
+    # Reordering, byte swapping, and padding (spans several blocks of records)
+    src_struct = Struct(byte_order=Struct.ByteOrder.BigEndian) \
+        .append('x', Struct.Type.Float32) \
+        .append('y', Struct.Type.Float32) \
+        .append('z', Struct.Type.Float32) \
+        .append('index', Struct.Type.UInt32)
+    dst_struct = Struct(pack=True, byte_order=Struct.ByteOrder.LittleEndian) \
+        .append('index', Struct.Type.UInt32) \
+        .append('x', Struct.Type.Float32) \
+        .append('y', Struct.Type.Float32) \
+        .append('z', Struct.Type.Float32)
+    s = StructConverter(src_struct, dst_struct)
+
+    n = 3000
+    src = np.zeros(n, dtype=[('x', '>f4'), ('y', '>f4'), ('z', '>f4'), ('index', '>u4')])
+    src['x'] = np.arange(n)
+    src['y'] = -np.arange(n)
+    src['z'] = 0.5
+    src['index'] = np.arange(n) * 3
+
+    dst = np.frombuffer(s.convert(src.tobytes()),
+                        dtype=[('index', '<u4'), ('x', '<f4'), ('y', '<f4'), ('z', '<f4')])
+    for name in ['x', 'y', 'z', 'index']:
+        assert np.all(dst[name] == src[name])
+
+
+def test21_rgb8_to_float_many_records():
+    flags = Struct.Flags.Normalized | Struct.Flags.Gamma
+    src_struct = Struct().append('r', Struct.Type.UInt8, flags) \
+                         .append('g', Struct.Type.UInt8, flags) \
+                         .append('b', Struct.Type.UInt8, flags)
+    dst_struct = Struct().append('r', Struct.Type.Float32) \
+                         .append('g', Struct.Type.Float32) \
+                         .append('b', Struct.Type.Float32)
+    s = StructConverter(src_struct, dst_struct)
+
+    src = (np.arange(3 * 2500) % 256).astype(np.uint8)
+    dst = np.frombuffer(s.convert(src.tobytes()), dtype=np.float32)
+    ref = np.array([from_srgb(x / 255.0) for x in range(256)])[src]
+    assert np.allclose(dst, ref, rtol=1e-5, atol=1e-7)
@@ -0,0 +1,64 @@
+import pytest
+import struct
+import numpy as np
+import mitsuba as mi
+
+
+def test01_write_read(variant_scalar_rgb, tmpdir):
+    fname = str(tmpdir.join('test.tensor'))
+    a = np.arange(12, dtype=np.float32).reshape(3, 4)
+    b = np.array([1, 2, 3], dtype=np.uint8)
+    mi.TensorFile.write(fname, {'a': a, 'b': b})
+
+    tf = mi.TensorFile(fname)
+    assert tf.field_names() == ['a', 'b']
+    assert tf.has_field('a') and not tf.has_field('c')
+    assert np.all(tf.field('a') == a) and tf.field('a').dtype == np.float32
+    assert np.all(tf.field('b') == b) and tf.field('b').shape == (3,)
+    assert not tf.compressed('a')
+
+    # Fields are aligned within the file
+    assert 'offset = 128' in str(tf) and 'offset = 192' in str(tf)
+    raw = np.array(tf, copy=False)
+    assert raw.size % 64 == 3
+
+    with pytest.raises(RuntimeError, match='not found'):
+        tf.field('c')
+
+
+def test02_compression(variant_scalar_rgb, tmpdir):
+    fname = str(tmpdir.join('test.tensor'))
+    a = np.zeros((256, 256), dtype=np.float64)
+    a[10, 20] = 1
+    mi.TensorFile.write(fname, {'a': a}, compress=True)
+
+    tf = mi.TensorFile(fname)
+    assert tf.compressed('a')
+    assert tf.size() < a.nbytes // 10
+    assert np.all(tf.field('a') == a)
+
+
+def test03_legacy_format(variant_scalar_rgb, tmpdir):
+    # Files of version 1.0 store neither the compression nor the data size
+    fname = str(tmpdir.join('test.tensor'))
+    a = np.array([1, 2, 3, 4], dtype=np.uint32)
+    header = b'tensor_file\0' + struct.pack('<BBI', 1, 0, 1)
+    header += struct.pack('<H', 1) + b'a' + struct.pack('<HBQQ', 1, 5, 0, 4)
+    header = header[:-16] + struct.pack('<QQ', len(header), 4)
+    with open(fname, 'wb') as f:
+        f.write(header + a.tobytes())
+
+    tf = mi.TensorFile(fname)
+    assert np.all(tf.field('a') == a)
+
+
+def test04_truncated(variant_scalar_rgb, tmpdir):
+    fname = str(tmpdir.join('test.tensor'))
+    mi.TensorFile.write(fname, {'a': np.ones(1000, dtype=np.float32)})
+    with open(fname, 'rb') as f:
+        data = f.read()
+    with open(fname, 'wb') as f:
+        f.write(data[:-4])
+
+    with pytest.raises(RuntimeError, match='exceeds the file size'):
+        mi.TensorFile(fname)
@@ -0,0 +1,61 @@
+import json
+import mitsuba as mi
+
+
+def test01_timeline(variant_scalar_rgb, tmpdir):
+    fname = str(tmpdir.join('trace.json'))
+    mi.Trace.start()
+    assert mi.Trace.enabled()
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': {'type': 'sphere'},
+        'light': {'type': 'constant'},
+        'sensor': {
+            'type': 'perspective',
+            'film': {'type': 'hdrfilm', 'width': 16, 'height': 16},
+        },
+    })
+    mi.render(scene, spp=4)
+    mi.Trace.stop()
+    assert not mi.Trace.enabled()
+
+    count, dropped = mi.Trace.event_count()
+    assert count > 0 and dropped == 0
+    mi.Trace.write(fname)
+
+    with open(fname) as f:
+        events = json.load(f)['traceEvents']
+
+    ranges = [e for e in events if e['ph'] == 'X']
+    assert len(ranges) == count
+    names = set(e['name'] for e in ranges)
+    assert 'render_block' in names
+    assert 'Integrator::render()' in names
+    assert 'Scene::ray_intersect()' in names
+
+    # Every thread with events is named, and ranges are properly formed
+    threads = set(e['tid'] for e in events if e['name'] == 'thread_name')
+    assert all(e['tid'] in threads and e['dur'] >= 0 and e['ts'] >= 0
+               for e in ranges)
+
+    # Events are discarded when the next trace starts
+    mi.Trace.start(min_duration=1e9)
+    mi.render(scene, spp=4)
+    mi.Trace.stop()
+    assert mi.Trace.event_count() == (0, 0)
+
+
+def test02_limit(variant_scalar_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': {'type': 'sphere'},
+        'sensor': {
+            'type': 'perspective',
+            'film': {'type': 'hdrfilm', 'width': 64, 'height': 64},
+        },
+    })
+    mi.Trace.start(max_events=0)
+    mi.render(scene, spp=16)
+    mi.Trace.stop()
+    count, dropped = mi.Trace.event_count()
+    assert dropped > 0
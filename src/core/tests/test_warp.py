@@ -182,3 +182,32 @@ def test_square_to_bilinear(variant_scalar_rgb):
     assert dr.allclose(pdf2, pdf)
     pdf3 = mi.warp.square_to_bilinear_pdf(*values, p),
     assert dr.allclose(pdf3, pdf)
+
+
+def test_square_to_spherical_triangle(variants_vec_backends_once):
+    # Vertex directions of a spherical triangle covering part of the octant
+    a = dr.normalize(mi.Vector3f(1, 0.1, 0.2))
+    b = dr.normalize(mi.Vector3f(0.2, 1, 0.1))
+    c = dr.normalize(mi.Vector3f(0.3, 0.2, 1))
+
+    n = 10000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    sample = sampler.next_2d()
+
+    d, pdf = mi.warp.square_to_spherical_triangle(a, b, c, sample)
+    assert dr.allclose(dr.norm(d), 1, atol=1e-5)
+    assert dr.allclose(pdf, mi.warp.square_to_spherical_triangle_pdf(a, b, c, d))
+
+    # The solid angle matches the closed form of Van Oosterom and Strackee
+    num = dr.abs(dr.dot(a, dr.cross(b, c)))
+    den = 1 + dr.dot(a, b) + dr.dot(b, c) + dr.dot(c, a)
+    assert dr.allclose(pdf, 1 / (2 * dr.atan2(num, den)), rtol=1e-4)
+
+    # The inverse mapping recovers the input sample
+    sample_2, pdf_2 = mi.warp.spherical_triangle_to_square(a, b, c, d)
+    assert dr.allclose(sample_2, sample, atol=1e-3)
+    assert dr.allclose(pdf_2, pdf)
+
+    # Directions outside of the triangle have zero density
+    assert dr.allclose(mi.warp.square_to_spherical_triangle_pdf(a, b, c, -d), 0)
@@ -425,3 +425,30 @@ def test31_python_plugins_parallel(variants_vec_backends_once_rgb):
         <bsdf type='dummy'/>
     </scene>
     """, parallel=True)
+
+
+def test32_repeated_transforms(variant_scalar_rgb):
+    # Repeated transform nodes are cached, which must not affect the result
+    transform = """<transform name="to_world">
+                       <scale value="2"/>
+                       <translate x="$x" y="1" z="0"/>
+                       <rotate z="1" angle="90"/>
+                   </transform>"""
+    scene = mi.load_string(f"""
+        <scene version="3.0.0">
+            <default name="x" value="3"/>
+            <shape type="sphere" id="s0">{transform}</shape>
+            <shape type="sphere" id="s1">{transform}</shape>
+            <shape type="sphere" id="s2">{transform.replace('$x', '3')}</shape>
+            <shape type="sphere" id="s3">{transform.replace('$x', '3')}</shape>
+            <shape type="sphere" id="s4">{transform.replace('$x', '-3')}</shape>
+        </scene>""")
+
+    T = mi.ScalarTransform4f
+    ref = T.rotate([0, 0, 1], 90) @ T.translate([3, 1, 0]) @ T.scale(2)
+    centers = [s.bbox().center() for s in scene.shapes()]
+    ids = [s.id() for s in scene.shapes()]
+    for i in range(4):
+        assert dr.allclose(centers[ids.index(f's{i}')], ref @ mi.ScalarPoint3f(0))
+    ref = T.rotate([0, 0, 1], 90) @ T.translate([-3, 1, 0]) @ T.scale(2)
+    assert dr.allclose(centers[ids.index('s4')], ref @ mi.ScalarPoint3f(0))
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <chrono>
 #include <cstring>
+#include <fstream>
 
 // Required for native thread functions
 #if defined(__linux__)
@@ -33,6 +34,9 @@ static __declspec(thread) int this_thread_id;
 static std::mutex task_mutex;
 static std::vector<Task *> registered_tasks;
 
+/// Source of the generation numbers of thread environments (0 = none)
+static std::atomic<uint64_t> env_generation_ctr { 0 };
+
 #if defined(_MSC_VER)
 namespace {
     // Helper function to set a native thread name. MSDN:
@@ -119,6 +123,8 @@ struct Thread::ThreadPrivate {
     ref<Logger> logger;
     ref<Thread> parent;
     ref<FileResolver> fresolver;
+    /// Generation of the logger/file resolver pair (see \ref ThreadEnvironment)
+    uint64_t env_generation = 0;
 
     ThreadPrivate(const std::string &name) : name(name) { }
 };
@@ -149,6 +155,7 @@ void Thread::set_name(const std::string &name) {
 
 void Thread::set_logger(Logger *logger) {
     d->logger = logger;
+    d->env_generation = 0;
 }
 
 Logger* Thread::logger() {
@@ -157,6 +164,7 @@ Logger* Thread::logger() {
 
 void Thread::set_file_resolver(FileResolver *fresolver) {
     d->fresolver = fresolver;
+    d->env_generation = 0;
 }
 
 FileResolver* Thread::file_resolver() {
@@ -375,6 +383,10 @@ void Thread::start() {
 
     d->parent = Thread::thread();
 
+    /* Inherit the parent thread's environment as a whole if none was set */
+    if (!d->logger && !d->fresolver)
+        d->env_generation = d->parent->d->env_generation;
+
     /* Inherit the parent thread's logger if none was set */
     if (!d->logger)
         d->logger = d->parent->logger();
@@ -546,26 +558,160 @@ void Thread::set_thread_count(size_t count) {
     pool_set_size(nullptr, (uint32_t) (count - 1));
 }
 
+static std::vector<std::vector<uint32_t>> numa_node_cores;
+static std::once_flag numa_once;
+
+#if defined(__linux__)
+/// Upper bound on the number of logical cores of the affinity masks below
+static constexpr int numa_max_cores = 8192;
+
+/// Parse a list of the form "0-3,8,10-11" (as found in sysfs)
+static std::vector<uint32_t> parse_cpu_list(const std::string &list) {
+    std::vector<uint32_t> result;
+    std::istringstream is(list);
+    std::string range;
+    while (std::getline(is, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            uint32_t first = (uint32_t) std::stoul(range.substr(0, dash)),
+                     last  = dash == std::string::npos
+                                 ? first
+                                 : (uint32_t) std::stoul(range.substr(dash + 1));
+            for (uint32_t i = first; i <= last; ++i)
+                result.push_back(i);
+        } catch (const std::exception &) {
+            continue;
+        }
+    }
+    return result;
+}
+#endif
+
+const std::vector<std::vector<uint32_t>> &Thread::numa_nodes() {
+    std::call_once(numa_once, []() {
+#if defined(__linux__)
+        // Node indices are not necessarily contiguous
+        for (uint32_t i = 0; i < 1024; ++i) {
+            std::ifstream is(tfm::format("/sys/devices/system/node/node%u/cpulist", i));
+            if (!is.good())
+                continue;
+            std::string line;
+            std::getline(is, line);
+            std::vector<uint32_t> cores = parse_cpu_list(line);
+            // Skip memory-only nodes
+            if (!cores.empty())
+                numa_node_cores.push_back(std::move(cores));
+        }
+#endif
+        if (numa_node_cores.empty()) {
+            std::vector<uint32_t> cores(util::core_count());
+            for (uint32_t i = 0; i < (uint32_t) cores.size(); ++i)
+                cores[i] = i;
+            numa_node_cores.push_back(std::move(cores));
+        }
+    });
+    return numa_node_cores;
+}
+
+ScopedNumaAffinity::ScopedNumaAffinity(uint32_t node) {
+#if defined(__linux__)
+    const std::vector<std::vector<uint32_t>> &nodes = Thread::numa_nodes();
+    if (node >= nodes.size())
+        Throw("ScopedNumaAffinity(): invalid NUMA node %u (%zu available)!",
+              node, nodes.size());
+
+    size_t size = CPU_ALLOC_SIZE(numa_max_cores);
+    cpu_set_t *previous = CPU_ALLOC(numa_max_cores),
+              *cpuset   = CPU_ALLOC(numa_max_cores);
+    if (!previous || !cpuset) {
+        Log(Warn, "ScopedNumaAffinity(): could not allocate cpu_set_t");
+        CPU_FREE(previous);
+        CPU_FREE(cpuset);
+        return;
+    }
+
+    int retval = pthread_getaffinity_np(pthread_self(), size, previous);
+    if (retval) {
+        Log(Warn, "ScopedNumaAffinity(): pthread_getaffinity_np(): %s",
+            strerror(retval));
+        CPU_FREE(previous);
+        CPU_FREE(cpuset);
+        return;
+    }
+
+    // Only keep the cores that were already available to the thread
+    CPU_ZERO_S(size, cpuset);
+    for (uint32_t core : nodes[node])
+        if ((int) core < numa_max_cores && CPU_ISSET_S(core, size, previous))
+            CPU_SET_S(core, size, cpuset);
+
+    if (CPU_COUNT_S(size, cpuset) > 0) {
+        retval = pthread_setaffinity_np(pthread_self(), size, cpuset);
+        if (retval)
+            Log(Warn, "ScopedNumaAffinity(): pthread_setaffinity_np(): %s",
+                strerror(retval));
+        else
+            m_previous = previous;
+    }
+
+    CPU_FREE(cpuset);
+    if (!m_previous)
+        CPU_FREE(previous);
+#else
+    (void) node;
+#endif
+}
+
+ScopedNumaAffinity::~ScopedNumaAffinity() {
+#if defined(__linux__)
+    if (!m_previous)
+        return;
+    cpu_set_t *previous = (cpu_set_t *) m_previous;
+    pthread_setaffinity_np(pthread_self(), CPU_ALLOC_SIZE(numa_max_cores),
+                           previous);
+    CPU_FREE(previous);
+#endif
+}
+
 ThreadEnvironment::ThreadEnvironment() {
     Thread *thread = Thread::thread();
     Assert(thread);
     m_logger = thread->logger();
     m_file_resolver = thread->file_resolver();
+
+    // The thread's pair has not been captured since it last changed
+    if (thread->d->env_generation == 0)
+        thread->d->env_generation = ++env_generation_ctr;
+    m_generation = thread->d->env_generation;
 }
 
 ScopedSetThreadEnvironment::ScopedSetThreadEnvironment(ThreadEnvironment &env) {
     Thread *thread = Thread::thread();
     Assert(thread);
-    m_logger = thread->logger();
-    m_file_resolver = thread->file_resolver();
-    thread->set_logger(env.m_logger);
-    thread->set_file_resolver(env.m_file_resolver);
+    Thread::ThreadPrivate *d = thread->d.get();
+
+    // Fast path: the environment is already installed
+    if (d->env_generation == env.m_generation)
+        return;
+
+    m_thread = thread;
+    m_logger = std::move(d->logger);
+    m_file_resolver = std::move(d->fresolver);
+    m_generation = d->env_generation;
+
+    d->logger = env.m_logger;
+    d->fresolver = env.m_file_resolver;
+    d->env_generation = env.m_generation;
 }
 
 ScopedSetThreadEnvironment::~ScopedSetThreadEnvironment() {
-    Thread *thread = Thread::thread();
-    thread->set_logger(m_logger);
-    thread->set_file_resolver(m_file_resolver);
+    if (!m_thread)
+        return;
+
+    Thread::ThreadPrivate *d = m_thread->d.get();
+    d->logger = std::move(m_logger);
+    d->fresolver = std::move(m_file_resolver);
+    d->env_generation = m_generation;
 }
 
 MI_IMPLEMENT_CLASS(Thread, Object)
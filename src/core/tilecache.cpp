@@ -0,0 +1,430 @@
+#include <mitsuba/core/tilecache.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/util.h>
+#include <unordered_map>
+#include <list>
+#include <cstring>
+
+#include <ImfTiledInputFile.h>
+#include <ImfTileDescription.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImathBox.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Pack an (image, level, tile) triple into a single cache key
+static uint64_t tile_key(uint32_t image_id, uint32_t level, uint32_t tx,
+                         uint32_t ty) {
+    return ((uint64_t) (image_id & 0xFFFFF) << 44) |
+           ((uint64_t) (level & 0x3F) << 38) |
+           ((uint64_t) (tx & 0x7FFFF) << 19) |
+            (uint64_t) (ty & 0x7FFFF);
+}
+
+// =======================================================================
+//! @{ \name TileCache implementation
+// =======================================================================
+
+struct TileCache::Entry {
+    uint64_t key;
+    std::shared_ptr<Tile> tile;
+    size_t bytes;
+};
+
+struct TileCache::State {
+    /// Most recently used tiles are at the front
+    std::list<Entry> lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> map;
+};
+
+/// Per-thread direct-mapped table of recently used tiles
+struct TileSlot {
+    uint64_t key = (uint64_t) -1;
+    uint32_t generation = 0;
+    std::shared_ptr<const TileCache::Tile> tile;
+};
+
+static constexpr uint32_t TileSlotCount = 32;
+static thread_local TileSlot tile_slots[TileSlotCount];
+
+TileCache::TileCache() : m_state(new State()), m_budget(size_t(1) << 30) { }
+
+TileCache::~TileCache() { }
+
+TileCache *TileCache::instance() {
+    static ref<TileCache> cache = new TileCache();
+    return cache.get();
+}
+
+void TileCache::set_memory_budget(size_t bytes) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_budget = bytes;
+    evict();
+}
+
+void TileCache::clear() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_state->map.clear();
+    m_state->lru.clear();
+    m_usage = 0;
+    m_generation++;
+}
+
+void TileCache::release(uint32_t image_id) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it = m_state->lru.begin(); it != m_state->lru.end(); ) {
+        if ((uint32_t) (it->key >> 44) == (image_id & 0xFFFFF)) {
+            m_usage -= it->bytes;
+            m_state->map.erase(it->key);
+            it = m_state->lru.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_generation++;
+}
+
+void TileCache::evict() {
+    while (m_usage > m_budget && !m_state->lru.empty()) {
+        Entry &entry = m_state->lru.back();
+        m_usage -= entry.bytes;
+        m_state->map.erase(entry.key);
+        m_state->lru.pop_back();
+        m_evictions++;
+    }
+}
+
+std::shared_ptr<const TileCache::Tile>
+TileCache::lookup(const TiledImage *image, uint32_t level, uint32_t tx,
+                  uint32_t ty) {
+    uint64_t key = tile_key(image->m_id, level, tx, ty);
+    uint32_t generation = m_generation;
+
+    // Fast path: check the per-thread table without taking the lock
+    TileSlot &slot = tile_slots[(key ^ (key >> 19) ^ (key >> 38)) % TileSlotCount];
+    if (slot.key == key && slot.generation == generation && slot.tile) {
+        m_hits++;
+        return slot.tile;
+    }
+
+    std::shared_ptr<const Tile> result;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto it = m_state->map.find(key);
+        if (it != m_state->map.end()) {
+            m_state->lru.splice(m_state->lru.begin(), m_state->lru, it->second);
+            result = it->second->tile;
+            m_hits++;
+        }
+    }
+
+    if (!result) {
+        // Load the tile without holding the lock. Another thread may
+        // concurrently load the same tile, in which case its copy is kept.
+        std::shared_ptr<Tile> tile = image->load_tile(level, tx, ty);
+        size_t bytes = sizeof(Tile) + (size_t) tile->size.x() * tile->size.y() *
+                                      image->channel_count() * sizeof(float);
+        m_misses++;
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto it = m_state->map.find(key);
+        if (it != m_state->map.end()) {
+            m_state->lru.splice(m_state->lru.begin(), m_state->lru, it->second);
+            result = it->second->tile;
+        } else {
+            m_state->lru.push_front(Entry{ key, tile, bytes });
+            m_state->map[key] = m_state->lru.begin();
+            m_usage += bytes;
+            result = tile;
+            evict();
+        }
+    }
+
+    slot.key = key;
+    slot.generation = generation;
+    slot.tile = result;
+    return result;
+}
+
+std::string TileCache::to_string() const {
+    std::ostringstream oss;
+    oss << "TileCache[" << std::endl
+        << "  memory_budget = " << util::mem_string(m_budget) << "," << std::endl
+        << "  memory_usage = " << util::mem_string(m_usage) << "," << std::endl
+        << "  hits = " << m_hits << "," << std::endl
+        << "  misses = " << m_misses << "," << std::endl
+        << "  evictions = " << m_evictions << std::endl
+        << "]";
+    return oss.str();
+}
+
+//! @}
+// =======================================================================
+
+// =======================================================================
+//! @{ \name TiledImage implementation
+// =======================================================================
+
+TiledImage::TiledImage(const fs::path &filename, bool raw, uint32_t tile_size)
+    : m_filename(filename), m_channel_count(0), m_tile_size(tile_size) {
+    if (!fs::exists(filename))
+        Throw("TiledImage: file \"%s\" does not exist!", filename.string());
+
+    m_id = TileCache::instance()->next_id();
+    ScalarVector2u size(0u);
+
+    // Try to open the file as a tiled OpenEXR image
+    Imf::TiledInputFile *file = nullptr;
+    try {
+        file = new Imf::TiledInputFile(filename.string().c_str());
+    } catch (...) {
+        file = nullptr;
+    }
+
+    if (file) {
+        const Imf::TileDescription &desc = file->header().tileDescription();
+        bool supported = desc.xSize == desc.ySize &&
+                         desc.mode != Imf::RIPMAP_LEVELS &&
+                         desc.roundingMode == Imf::ROUND_DOWN;
+
+        const Imf::ChannelList &channels = file->header().channels();
+        if (channels.findChannel("R") && channels.findChannel("G") &&
+            channels.findChannel("B")) {
+            m_exr_channels = { "R", "G", "B" };
+        } else if (channels.findChannel("Y")) {
+            m_exr_channels = { "Y" };
+        } else if (channels.begin() != channels.end()) {
+            m_exr_channels = { channels.begin().name() };
+        } else {
+            supported = false;
+        }
+
+        if (supported) {
+            m_exr_tiled = true;
+            m_exr_file = file;
+            m_tile_size = desc.xSize;
+            m_channel_count = (uint32_t) m_exr_channels.size();
+            size = ScalarVector2u(file->levelWidth(0), file->levelHeight(0));
+        } else {
+            Log(Warn, "TiledImage: \"%s\" uses an unsupported tile layout, "
+                "loading it in full resolution.", filename.string());
+            delete file;
+        }
+    }
+
+    if (!m_exr_tiled) {
+        ref<Bitmap> bitmap = new Bitmap(filename);
+        if (raw)
+            bitmap->set_srgb_gamma(false);
+
+        Bitmap::PixelFormat pixel_format;
+        switch (bitmap->pixel_format()) {
+            case Bitmap::PixelFormat::Y:
+            case Bitmap::PixelFormat::YA:
+                pixel_format = Bitmap::PixelFormat::Y;
+                break;
+            default:
+                pixel_format = Bitmap::PixelFormat::RGB;
+                break;
+        }
+
+        m_bitmap = bitmap->convert(pixel_format, Struct::Type::Float32, false);
+        m_channel_count = (uint32_t) m_bitmap->channel_count();
+        size = m_bitmap->size();
+    }
+
+    if (m_tile_size == 0)
+        Throw("TiledImage: the tile size must be positive!");
+
+    // Set up the mip pyramid down to a 1x1 level
+    uint32_t stored_levels =
+        m_exr_tiled ? (uint32_t) ((Imf::TiledInputFile *) m_exr_file)->numLevels() : 1;
+    for (uint32_t i = 0; ; ++i) {
+        Level level;
+        level.size = dr::maximum(size >> i, 1u);
+        level.tile_count = (level.size + (m_tile_size - 1)) / m_tile_size;
+        level.stored = i < stored_levels;
+        m_levels.push_back(level);
+        if (dr::all(level.size == 1u) || i == 63)
+            break;
+    }
+}
+
+TiledImage::~TiledImage() {
+    TileCache::instance()->release(m_id);
+    delete (Imf::TiledInputFile *) m_exr_file;
+}
+
+std::shared_ptr<const TiledImage::Tile>
+TiledImage::tile(uint32_t level, uint32_t tx, uint32_t ty) const {
+    return TileCache::instance()->lookup(this, level, tx, ty);
+}
+
+std::shared_ptr<TiledImage::Tile>
+TiledImage::load_tile(uint32_t level, uint32_t tx, uint32_t ty) const {
+    const Level &info = m_levels[level];
+    std::shared_ptr<Tile> tile = std::make_shared<Tile>();
+    tile->size = dr::minimum(ScalarVector2u(m_tile_size),
+                             info.size - ScalarVector2u(tx, ty) * m_tile_size);
+    tile->data = std::unique_ptr<float[]>(
+        new float[(size_t) tile->size.x() * tile->size.y() * m_channel_count]);
+
+    if (m_exr_tiled && info.stored) {
+        Imf::TiledInputFile *file = (Imf::TiledInputFile *) m_exr_file;
+        std::lock_guard<std::mutex> guard(m_file_mutex);
+
+        Imath::Box2i box = file->dataWindowForTile((int) tx, (int) ty, (int) level);
+        size_t x_stride = sizeof(float) * m_channel_count,
+               y_stride = x_stride * tile->size.x();
+        char *base = (char *) tile->data.get() -
+                     (ptrdiff_t) box.min.x * x_stride -
+                     (ptrdiff_t) box.min.y * y_stride;
+
+        Imf::FrameBuffer framebuffer;
+        for (uint32_t i = 0; i < m_channel_count; ++i)
+            framebuffer.insert(m_exr_channels[i].c_str(),
+                               Imf::Slice(Imf::FLOAT, base + i * sizeof(float),
+                                          x_stride, y_stride));
+        file->setFrameBuffer(framebuffer);
+        file->readTile((int) tx, (int) ty, (int) level);
+    } else {
+        downsample_tile(level, tx, ty, *tile);
+    }
+
+    return tile;
+}
+
+void TiledImage::downsample_tile(uint32_t level, uint32_t tx, uint32_t ty,
+                                 Tile &tile) const {
+    if (level == 0)
+        Throw("TiledImage: level 0 cannot be downsampled!");
+
+    int32_t x0 = (int32_t) (tx * m_tile_size), y0 = (int32_t) (ty * m_tile_size);
+    float value[3];
+    float *out = tile.data.get();
+
+    for (uint32_t y = 0; y < tile.size.y(); ++y) {
+        for (uint32_t x = 0; x < tile.size.x(); ++x) {
+            for (uint32_t c = 0; c < m_channel_count; ++c)
+                out[c] = 0.f;
+
+            for (int32_t dy = 0; dy < 2; ++dy) {
+                for (int32_t dx = 0; dx < 2; ++dx) {
+                    fetch(level - 1, 2 * (x0 + (int32_t) x) + dx,
+                          2 * (y0 + (int32_t) y) + dy, WrapMode::Clamp, value);
+                    for (uint32_t c = 0; c < m_channel_count; ++c)
+                        out[c] += .25f * value[c];
+                }
+            }
+
+            out += m_channel_count;
+        }
+    }
+}
+
+int32_t TiledImage::wrap_coord(int32_t x, int32_t size, WrapMode wrap) {
+    switch (wrap) {
+        case WrapMode::Repeat:
+            x %= size;
+            return x < 0 ? x + size : x;
+
+        case WrapMode::Mirror: {
+            int32_t period = 2 * size;
+            x %= period;
+            if (x < 0)
+                x += period;
+            return x < size ? x : period - 1 - x;
+        }
+
+        default:
+            return std::min(std::max(x, 0), size - 1);
+    }
+}
+
+void TiledImage::fetch(uint32_t level, int32_t x, int32_t y, WrapMode wrap,
+                       float *out) const {
+    const Level &info = m_levels[level];
+    uint32_t px = (uint32_t) wrap_coord(x, (int32_t) info.size.x(), wrap),
+             py = (uint32_t) wrap_coord(y, (int32_t) info.size.y(), wrap);
+
+    const float *src;
+    std::shared_ptr<const Tile> t;
+    if (!m_exr_tiled && level == 0) {
+        // The full-resolution level of non-tiled images stays in memory
+        src = (const float *) m_bitmap->data() +
+              ((size_t) py * info.size.x() + px) * m_channel_count;
+    } else {
+        t = tile(level, px / m_tile_size, py / m_tile_size);
+        src = t->data.get() + ((size_t) (py % m_tile_size) * t->size.x() +
+                               px % m_tile_size) * m_channel_count;
+    }
+
+    for (uint32_t c = 0; c < m_channel_count; ++c)
+        out[c] = src[c];
+}
+
+void TiledImage::eval(const ScalarPoint2f &uv, float lod, WrapMode wrap,
+                      bool bilinear, float *out) const {
+    lod = std::min(std::max(lod, 0.f), (float) (m_levels.size() - 1));
+    uint32_t level = (uint32_t) lod;
+    float level_weight = lod - (float) level;
+
+    auto eval_level = [&](uint32_t l, float weight) {
+        ScalarVector2f size(m_levels[l].size);
+        float value[3];
+
+        if (!bilinear) {
+            ScalarPoint2i p(dr::floor2int<ScalarPoint2i>(uv * size));
+            fetch(l, p.x(), p.y(), wrap, value);
+            for (uint32_t c = 0; c < m_channel_count; ++c)
+                out[c] += weight * value[c];
+            return;
+        }
+
+        ScalarPoint2f p = uv * size - .5f;
+        ScalarPoint2i p0 = dr::floor2int<ScalarPoint2i>(p);
+        ScalarVector2f w1 = p - ScalarPoint2f(p0), w0 = 1.f - w1;
+
+        const float weights[4] = { w0.x() * w0.y(), w1.x() * w0.y(),
+                                   w0.x() * w1.y(), w1.x() * w1.y() };
+        for (int32_t i = 0; i < 4; ++i) {
+            fetch(l, p0.x() + (i & 1), p0.y() + (i >> 1), wrap, value);
+            for (uint32_t c = 0; c < m_channel_count; ++c)
+                out[c] += weight * weights[i] * value[c];
+        }
+    };
+
+    for (uint32_t c = 0; c < m_channel_count; ++c)
+        out[c] = 0.f;
+
+    eval_level(level, 1.f - level_weight);
+    if (level_weight > 0.f && level + 1 < m_levels.size())
+        eval_level(level + 1, level_weight);
+}
+
+void TiledImage::mean(float *out) const {
+    fetch((uint32_t) m_levels.size() - 1, 0, 0, WrapMode::Clamp, out);
+}
+
+std::string TiledImage::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledImage[" << std::endl
+        << "  filename = \"" << m_filename.string() << "\"," << std::endl
+        << "  size = " << size() << "," << std::endl
+        << "  channel_count = " << m_channel_count << "," << std::endl
+        << "  tile_size = " << m_tile_size << "," << std::endl
+        << "  level_count = " << m_levels.size() << "," << std::endl
+        << "  tiled = " << (m_exr_tiled ? "true" : "false") << std::endl
+        << "]";
+    return oss.str();
+}
+
+//! @}
+// =======================================================================
+
+MI_IMPLEMENT_CLASS(TiledImage, Object)
+MI_IMPLEMENT_CLASS(TileCache, Object)
+NAMESPACE_END(mitsuba)
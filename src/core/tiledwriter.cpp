@@ -0,0 +1,143 @@
+#include <mitsuba/core/tiledwriter.h>
+#include <mitsuba/core/logger.h>
+
+#include <ImfTiledOutputFile.h>
+#include <ImfTileDescription.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+TiledEXRWriter::TiledEXRWriter(const fs::path &filename,
+                               const ScalarVector2u &size, uint32_t tile_size,
+                               const std::vector<std::string> &channel_names,
+                               Struct::Type component_format)
+    : m_filename(filename), m_size(size), m_tile_size(tile_size),
+      m_channel_names(channel_names) {
+    if (tile_size == 0 || dr::any(size == 0u))
+        Throw("TiledEXRWriter: invalid image or tile size!");
+
+    Imf::PixelType pixel_type;
+    switch (component_format) {
+        case Struct::Type::Float16: pixel_type = Imf::HALF; break;
+        case Struct::Type::Float32: pixel_type = Imf::FLOAT; break;
+        case Struct::Type::UInt32:  pixel_type = Imf::UINT; break;
+        default:
+            Throw("TiledEXRWriter: unsupported component format %s!",
+                  component_format);
+    }
+
+    Imf::Header header((int) size.x(), (int) size.y());
+    header.setTileDescription(
+        Imf::TileDescription(tile_size, tile_size, Imf::ONE_LEVEL));
+    // Allow writing tiles in any order without buffering them
+    header.lineOrder() = Imf::RANDOM_Y;
+    header.compression() = Imf::PIZ_COMPRESSION;
+
+    for (const std::string &name : channel_names)
+        header.channels().insert(name.c_str(), Imf::Channel(pixel_type));
+
+    m_file = new Imf::TiledOutputFile(filename.string().c_str(), header);
+
+    ScalarVector2u count = tile_count();
+    m_written.resize((size_t) count.x() * count.y(), false);
+}
+
+TiledEXRWriter::~TiledEXRWriter() {
+    if (m_file) {
+        try {
+            close();
+        } catch (const std::exception &e) {
+            Log(Warn, "TiledEXRWriter: could not close \"%s\": %s",
+                m_filename.string(), e.what());
+        }
+    }
+}
+
+TiledEXRWriter::ScalarVector2u
+TiledEXRWriter::tile_extent(uint32_t tx, uint32_t ty) const {
+    return dr::minimum(ScalarVector2u(m_tile_size),
+                       m_size - ScalarVector2u(tx, ty) * m_tile_size);
+}
+
+void TiledEXRWriter::write_tile(uint32_t tx, uint32_t ty, const float *data) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_file)
+        Throw("TiledEXRWriter: the file \"%s\" was already closed!",
+              m_filename.string());
+    write_tile_locked(tx, ty, data);
+}
+
+void TiledEXRWriter::write_tile_locked(uint32_t tx, uint32_t ty, const float *data) {
+    ScalarVector2u count = tile_count();
+    if (tx >= count.x() || ty >= count.y())
+        Throw("TiledEXRWriter: tile index (%u, %u) is out of bounds!", tx, ty);
+
+    size_t index = (size_t) ty * count.x() + tx;
+    if (m_written[index])
+        Throw("TiledEXRWriter: tile (%u, %u) was already written!", tx, ty);
+
+    Imf::TiledOutputFile *file = (Imf::TiledOutputFile *) m_file;
+    ScalarVector2u extent = tile_extent(tx, ty);
+    size_t x_stride = sizeof(float) * m_channel_names.size(),
+           y_stride = x_stride * extent.x();
+
+    // Slices are addressed in absolute pixel coordinates
+    char *base = (char *) data -
+                 (ptrdiff_t) (tx * m_tile_size) * x_stride -
+                 (ptrdiff_t) (ty * m_tile_size) * y_stride;
+
+    Imf::FrameBuffer framebuffer;
+    for (size_t i = 0; i < m_channel_names.size(); ++i)
+        framebuffer.insert(m_channel_names[i].c_str(),
+                           Imf::Slice(Imf::FLOAT, base + i * sizeof(float),
+                                      x_stride, y_stride));
+
+    file->setFrameBuffer(framebuffer);
+    file->writeTile((int) tx, (int) ty);
+    m_written[index] = true;
+}
+
+void TiledEXRWriter::close() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_file)
+        return;
+
+    ScalarVector2u count = tile_count();
+    size_t missing = 0;
+    std::vector<float> zeros;
+    for (uint32_t ty = 0; ty < count.y(); ++ty) {
+        for (uint32_t tx = 0; tx < count.x(); ++tx) {
+            if (m_written[(size_t) ty * count.x() + tx])
+                continue;
+            if (zeros.empty())
+                zeros.resize((size_t) m_tile_size * m_tile_size *
+                             m_channel_names.size(), 0.f);
+            write_tile_locked(tx, ty, zeros.data());
+            missing++;
+        }
+    }
+
+    if (missing > 0)
+        Log(Warn, "TiledEXRWriter: %zu tile%s of \"%s\" were never written "
+            "and have been filled with zeros.", missing,
+            missing == 1 ? "" : "s", m_filename.string());
+
+    delete (Imf::TiledOutputFile *) m_file;
+    m_file = nullptr;
+}
+
+std::string TiledEXRWriter::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledEXRWriter[" << std::endl
+        << "  filename = \"" << m_filename.string() << "\"," << std::endl
+        << "  size = " << m_size << "," << std::endl
+        << "  tile_size = " << m_tile_size << "," << std::endl
+        << "  channels = " << m_channel_names.size() << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(TiledEXRWriter, Object)
+NAMESPACE_END(mitsuba)
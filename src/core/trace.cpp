@@ -0,0 +1,215 @@
+#include <mitsuba/core/trace.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+NAMESPACE_BEGIN(detail)
+std::atomic<bool> trace_enabled { false };
+
+/// Number of events per chunk of a thread buffer
+static constexpr uint32_t trace_chunk_size = 4096;
+
+struct TraceChunk {
+    TraceEvent events[trace_chunk_size];
+    /// Number of valid events (written by the owner thread)
+    std::atomic<uint32_t> size { 0 };
+    /// Next chunk, or \c nullptr if this is the last one
+    std::atomic<TraceChunk *> next { nullptr };
+};
+
+/// Event buffer of a thread, which is never freed before shutdown
+struct TraceThread {
+    uint32_t id;
+    std::string name;
+    TraceChunk *head;
+    /// Chunk that is currently being written (only accessed by the owner)
+    TraceChunk *tail;
+};
+
+static std::vector<TraceThread *> trace_threads;
+static std::mutex trace_mutex;
+static thread_local TraceThread *trace_thread = nullptr;
+
+/// Time origin of the trace and minimum duration of recorded ranges (ns)
+static uint64_t trace_origin = 0, trace_min_duration = 0;
+/// Number of chunks that may still be allocated
+static std::atomic<int64_t> trace_chunks_left { 0 };
+static std::atomic<size_t> trace_dropped { 0 };
+
+static TraceThread *trace_register_thread() {
+    TraceThread *thread = new TraceThread();
+    thread->id = Thread::thread_id();
+    thread->name = Thread::thread()->name();
+    thread->head = thread->tail = new TraceChunk();
+
+    std::lock_guard<std::mutex> guard(trace_mutex);
+    trace_chunks_left--;
+    trace_threads.push_back(thread);
+    trace_thread = thread;
+    return thread;
+}
+
+void trace_record(const char *name, const char *category, uint64_t start) {
+    uint64_t end = trace_time();
+    if (end - start < trace_min_duration)
+        return;
+
+    TraceThread *thread = trace_thread;
+    if (unlikely(!thread))
+        thread = trace_register_thread();
+
+    TraceChunk *chunk = thread->tail;
+    uint32_t size = chunk->size.load(std::memory_order_relaxed);
+    if (unlikely(size == trace_chunk_size)) {
+        if (trace_chunks_left.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+            trace_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        TraceChunk *next = new TraceChunk();
+        chunk->next.store(next, std::memory_order_release);
+        thread->tail = chunk = next;
+        size = 0;
+    }
+
+    chunk->events[size] = TraceEvent{ name, category, start, end };
+    // Publish the event to Trace::write()
+    chunk->size.store(size + 1, std::memory_order_release);
+}
+
+/// Free all chunks of the buffer of a thread except for the first one
+static void trace_reset(TraceThread *thread) {
+    TraceChunk *chunk = thread->head->next.load();
+    while (chunk) {
+        TraceChunk *next = chunk->next.load();
+        delete chunk;
+        chunk = next;
+    }
+    thread->head->next = nullptr;
+    thread->head->size = 0;
+    thread->tail = thread->head;
+}
+
+/// Escape a string for use within JSON
+static std::string trace_escape(const std::string &str) {
+    std::string result;
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if ((unsigned char) c >= 0x20)
+            result += c;
+    }
+    return result;
+}
+NAMESPACE_END(detail)
+
+void Trace::start(float min_duration, size_t max_events) {
+    using namespace detail;
+    trace_enabled = false;
+
+    std::lock_guard<std::mutex> guard(trace_mutex);
+    for (TraceThread *thread : trace_threads)
+        trace_reset(thread);
+
+    trace_min_duration = (uint64_t) (std::max(min_duration, 0.f) * 1000.f);
+    trace_chunks_left = (int64_t) (max_events / trace_chunk_size) -
+                        (int64_t) trace_threads.size();
+    trace_dropped = 0;
+    trace_origin = trace_time();
+    trace_enabled = true;
+}
+
+void Trace::stop() {
+    detail::trace_enabled = false;
+}
+
+std::pair<size_t, size_t> Trace::event_count() {
+    using namespace detail;
+    size_t count = 0;
+
+    std::lock_guard<std::mutex> guard(trace_mutex);
+    for (const TraceThread *thread : trace_threads) {
+        const TraceChunk *chunk = thread->head;
+        while (chunk) {
+            count += chunk->size.load(std::memory_order_acquire);
+            chunk = chunk->next.load(std::memory_order_acquire);
+        }
+    }
+
+    return { count, trace_dropped.load() };
+}
+
+void Trace::write(const fs::path &filename) {
+    using namespace detail;
+    ref<FileStream> stream = new FileStream(filename, FileStream::ETruncReadWrite);
+    size_t count = 0;
+
+    std::ostringstream oss;
+    auto flush = [&](bool force) {
+        if (!force && oss.tellp() < (1 << 20))
+            return;
+        std::string str = oss.str();
+        stream->write(str.data(), str.size());
+        oss.str("");
+    };
+
+    oss << "{\"traceEvents\":[" << std::endl;
+    oss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+        << "\"args\":{\"name\":\"mitsuba\"}}";
+
+    {
+        std::lock_guard<std::mutex> guard(trace_mutex);
+        for (const TraceThread *thread : trace_threads) {
+            oss << "," << std::endl
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+                << thread->id << ",\"args\":{\"name\":\""
+                << trace_escape(thread->name) << "\"}}";
+
+            const TraceChunk *chunk = thread->head;
+            while (chunk) {
+                uint32_t size = chunk->size.load(std::memory_order_acquire);
+                for (uint32_t i = 0; i < size; ++i) {
+                    const TraceEvent &e = chunk->events[i];
+                    oss << "," << std::endl
+                        << tfm::format("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                                       "\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}",
+                                       trace_escape(e.name), e.category,
+                                       (e.start - trace_origin) / 1000.0,
+                                       (e.end - e.start) / 1000.0, thread->id);
+                    flush(false);
+                }
+                count += size;
+                chunk = chunk->next.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    oss << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    flush(true);
+    stream->close();
+
+    size_t dropped = trace_dropped.load();
+    Log(Info, "Wrote %i trace events to \"%s\" (%s).", count, filename,
+        util::mem_string(fs::file_size(filename)));
+    if (dropped > 0)
+        Log(Warn, "Trace: %i events were dropped, as the maximum number of "
+                  "events was reached.", dropped);
+}
+
+void Trace::static_shutdown() {
+    using namespace detail;
+    trace_enabled = false;
+
+    /* The thread buffers remain registered, since threads that are still
+       running reference them. Only the recorded events are freed. */
+    std::lock_guard<std::mutex> guard(trace_mutex);
+    for (TraceThread *thread : trace_threads)
+        trace_reset(thread);
+}
+
+NAMESPACE_END(mitsuba)
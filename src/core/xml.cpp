@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <set>
@@ -252,10 +253,36 @@ struct XMLParseContext {
 
     std::unordered_map<std::string, XMLObject> instances;
     Transform4f transform;
+    /// Does \c transform still hold the identity (no operation applied yet)?
+    bool transform_identity = true;
+    /// Products of earlier transform nodes, keyed by their operations
+    std::unordered_map<std::string, Transform4f> transform_cache;
     ColorMode color_mode;
     uint32_t id_counter = 0;
     uint32_t backend = 0;
 
+    /// Per-plugin load time statistics (see \ref log_load_times())
+    struct LoadTime {
+        size_t count = 0;
+        double total = 0.0;
+        double max = 0.0;
+        std::string slowest;
+    };
+    std::map<std::string, LoadTime> load_times;
+    std::mutex load_times_mutex;
+
+    void record_load_time(const std::string &plugin, const std::string &id,
+                          double time) {
+        std::lock_guard<std::mutex> guard(load_times_mutex);
+        LoadTime &entry = load_times[plugin];
+        entry.count++;
+        entry.total += time;
+        if (time >= entry.max) {
+            entry.max = time;
+            entry.slowest = id;
+        }
+    }
+
     XMLParseContext(const std::string &variant, bool parallel)
         : variant(variant), parallel(parallel) {
         color_mode = MI_INVOKE_VARIANT(variant, variant_to_color_mode);
@@ -269,6 +296,44 @@ struct XMLParseContext {
     }
 };
 
+/// Upper bound on the number of entries of \ref XMLParseContext::transform_cache
+static constexpr size_t transform_cache_size = 16384;
+
+/// Concatenate an operation with the transform node being parsed
+static void apply_transform(XMLParseContext &ctx, const Transform4f &op) {
+    ctx.transform = ctx.transform_identity ? op : op * ctx.transform;
+    ctx.transform_identity = false;
+}
+
+/**
+ * \brief Return the key of a transform node in \ref XMLParseContext::transform_cache
+ *
+ * The key lists the operations of the node along with their attributes. It is
+ * empty when the node cannot be cached, e.g. because its operations still
+ * refer to parameters that are substituted while parsing them.
+ */
+static std::string transform_cache_key(const pugi::xml_node &node) {
+    std::string key;
+    for (pugi::xml_node ch : node.children()) {
+        if (ch.type() == pugi::node_comment)
+            continue;
+        if (ch.type() != pugi::node_element)
+            return std::string();
+        key += ch.name();
+        for (pugi::xml_attribute attr : ch.attributes()) {
+            const char *value = attr.value();
+            if (strchr(value, '$'))
+                return std::string();
+            key += '\x1f';
+            key += attr.name();
+            key += '\x1f';
+            key += value;
+        }
+        key += '\x1e';
+    }
+    return key;
+}
+
 /// Helper function to check if attributes are fully specified
 static void check_attributes(XMLSource &src, const pugi::xml_node &node,
                              std::set<std::string> &&attrs, bool expect_all = true) {
@@ -428,6 +493,20 @@ void upgrade_tree(XMLSource &src, pugi::xml_node &node, const Version &version)
             Version(MI_VERSION));
 }
 
+/**
+ * \brief Sort the parameters by decreasing name length, so that the
+ * substitution of e.g. \c $index does not clobber \c $index2
+ *
+ * This happens once per parameter definition rather than once per node,
+ * which matters for scenes with millions of elements.
+ */
+static void sort_parameters(ParameterList &param) {
+    std::stable_sort(param.begin(), param.end(),
+        [](const auto &a, const auto &b) -> bool {
+            return std::get<0>(a).length() > std::get<0>(b).length();
+        });
+}
+
 static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseContext &ctx,
                                                      pugi::xml_node &node, Tag parent_tag,
                                                      Properties &props, ParameterList &param,
@@ -435,12 +514,8 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                                                      bool within_emitter = false,
                                                      bool within_spectrum = false) {
     try {
+        // The parameter list is kept sorted by \ref sort_parameters()
         if (!param.empty()) {
-            std::sort(param.begin(), param.end(),
-                [](const auto &a, const auto &b) -> bool {
-                    return std::get<0>(a).length() > std::get<0>(b).length();
-                });
-
             for (auto attr: node.attributes()) {
                 std::string value = attr.value();
                 if (value.find('$') == std::string::npos)
@@ -515,6 +590,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
             node.append_attribute("type") = "scene";
         } else if (tag == Tag::Transform) {
             ctx.transform = Transform4f();
+            ctx.transform_identity = true;
         }
 
         if (node.attribute("name")) {
@@ -539,6 +615,10 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
             node.append_attribute("id") = tfm::format("_unnamed_%u", ctx.id_counter++).c_str();
         }
 
+        // Repeated transform nodes reuse the product of their first occurrence
+        std::string transform_key;
+        bool transform_cached = false;
+
         switch (tag) {
             case Tag::Object: {
                     check_attributes(src, node, { "type", "id", "name" });
@@ -636,8 +716,10 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         if (std::get<0>(p) == name)
                             found = true;
                     }
-                    if (!found)
+                    if (!found) {
                         param.emplace_back(name, value, true);
+                        sort_parameters(param);
+                    }
                     return std::make_pair("", "");
                 }
                 break;
@@ -876,6 +958,16 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
             case Tag::Transform: {
                     check_attributes(src, node, { "name" });
                     ctx.transform = Transform4f();
+                    ctx.transform_identity = true;
+
+                    transform_key = transform_cache_key(node);
+                    if (!transform_key.empty()) {
+                        auto it = ctx.transform_cache.find(transform_key);
+                        if (it != ctx.transform_cache.end()) {
+                            ctx.transform = it->second;
+                            transform_cached = true;
+                        }
+                    }
                 }
                 break;
 
@@ -890,7 +982,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     } catch (...) {
                         src.throw_error(node, "could not parse floating point value \"%s\"", angle);
                     }
-                    ctx.transform = Transform4f::rotate(vec, angle_float) * ctx.transform;
+                    apply_transform(ctx, Transform4f::rotate(vec, angle_float));
                 }
                 break;
 
@@ -898,7 +990,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     detail::expand_value_to_xyz(src, node);
                     check_attributes(src, node, { "x", "y", "z" }, false);
                     Vector3f vec = detail::parse_vector(src, node);
-                    ctx.transform = Transform4f::translate(vec) * ctx.transform;
+                    apply_transform(ctx, Transform4f::translate(vec));
                 }
                 break;
 
@@ -906,7 +998,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     detail::expand_value_to_xyz(src, node);
                     check_attributes(src, node, { "x", "y", "z" }, false);
                     Vector3f vec = detail::parse_vector(src, node, 1);
-                    ctx.transform = Transform4f::scale(vec) * ctx.transform;
+                    apply_transform(ctx, Transform4f::scale(vec));
                 }
                 break;
 
@@ -927,7 +1019,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     auto result = Transform4f::look_at(origin, target, up);
                     if (dr::any_nested(dr::isnan(result.matrix)))
                         src.throw_error(node, "invalid lookat transformation");
-                    ctx.transform = result * ctx.transform;
+                    apply_transform(ctx, result);
                 }
                 break;
 
@@ -963,18 +1055,24 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         }
                         matrix = Matrix4f(mat3);
                     }
-                    ctx.transform = Transform4f(matrix) * ctx.transform;
+                    apply_transform(ctx, Transform4f(matrix));
                 }
                 break;
 
             default: Throw("Unhandled element \"%s\"", node.name());
         }
 
-        for (pugi::xml_node &ch: node.children())
-            parse_xml(src, ctx, ch, tag, props, param, arg_counter, depth + 1);
+        if (!transform_cached) {
+            for (pugi::xml_node &ch: node.children())
+                parse_xml(src, ctx, ch, tag, props, param, arg_counter, depth + 1);
+        }
 
-        if (tag == Tag::Transform)
+        if (tag == Tag::Transform) {
+            if (!transform_cached && !transform_key.empty() &&
+                ctx.transform_cache.size() < transform_cache_size)
+                ctx.transform_cache.emplace(std::move(transform_key), ctx.transform);
             props.set_transform(node.attribute("name").value(), ctx.transform);
+        }
     } catch (const std::exception &e) {
         if (strstr(e.what(), "Error while loading") == nullptr)
             src.throw_error(node, "%s", e.what());
@@ -989,12 +1087,14 @@ static std::string init_xml_parse_context_from_file(XMLParseContext &ctx,
                                                     const fs::path &filename_,
                                                     ParameterList param,
                                                     bool write_update) {
+    ScopedTraceEvent trace("Parse XML", "load");
     fs::path filename = filename_;
 
+    // Comments only need to be retained when the file is written back
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(filename.native().c_str(),
-        pugi::parse_default |
-        pugi::parse_comments);
+        write_update ? (pugi::parse_default | pugi::parse_comments)
+                     : pugi::parse_default);
 
     detail::XMLSource src{
         filename.string(), doc,
@@ -1008,6 +1108,7 @@ static std::string init_xml_parse_context_from_file(XMLParseContext &ctx,
     pugi::xml_node root = doc.document_element();
     Properties props;
     size_t arg_counter = 0; // Unused
+    sort_parameters(param);
     auto scene_id = parse_xml(src, ctx, root, Tag::Invalid, props,
                               param, arg_counter, 0).second;
 
@@ -1107,9 +1208,18 @@ static Task *instantiate_node(XMLParseContext &ctx,
                 for (auto c : children)
                     props.set_object(kv.first + "_" + std::to_string(ctr++), c, false);
             }
+
+            /* Anonymous objects have exactly one parent, hence the instance
+               table no longer needs to keep them alive. Only objects that
+               can be referenced by id remain until the end of loading. */
+            if (string::starts_with(child_id, "_unnamed_"))
+                it2->second.object = nullptr;
         }
 
+        Timer timer;
         try {
+            // Class names remain valid until shutdown
+            ScopedTraceEvent trace(inst.class_->name().c_str(), "load");
             inst.object = PluginManager::instance()->create_object(props, inst.class_);
         } catch (const std::exception &e) {
             Throw("Error while loading \"%s\" (near %s): could not instantiate "
@@ -1139,6 +1249,14 @@ static Task *instantiate_node(XMLParseContext &ctx,
                   unqueried.size() > 1 ? "properties" : "property", unqueried,
                   string::to_lower(inst.class_->name()), props.plugin_name());
         }
+
+        // Child objects were created by other tasks, this excludes their cost
+        ctx.record_load_time(string::to_lower(inst.class_->name()) + "/" +
+                                 props.plugin_name(),
+                             id, (double) timer.value());
+
+        // Release the parsed properties (and the references to child objects)
+        props = Properties();
     };
 
     if (top_node) {
@@ -1169,7 +1287,28 @@ static Task *instantiate_node(XMLParseContext &ctx,
     }
 }
 
+/// Print a per-plugin breakdown of the time spent instantiating objects
+static void log_load_times(XMLParseContext &ctx) {
+    if (ctx.load_times.empty() ||
+        Thread::thread()->logger()->log_level() > Debug)
+        return;
+
+    std::vector<std::pair<std::string, XMLParseContext::LoadTime>> entries(
+        ctx.load_times.begin(), ctx.load_times.end());
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+        return a.second.total > b.second.total;
+    });
+
+    Log(Debug, "Object instantiation times (per plugin, excluding children):");
+    for (const auto &[plugin, t] : entries)
+        Log(Debug, "   %-24s : %4i object%s, %s total (slowest: \"%s\", %s)",
+            plugin, t.count, t.count > 1 ? "s" : " ",
+            util::time_string((float) t.total, true), t.slowest,
+            util::time_string((float) t.max, true));
+}
+
 static ref<Object> instantiate_top_node(XMLParseContext &ctx, const std::string &id) {
+    ScopedTraceEvent trace("Instantiate objects", "load");
     ThreadEnvironment env;
     std::unordered_map<std::string, Task*> task_map;
     instantiate_node(ctx, id, env, task_map, true);
@@ -1177,6 +1316,7 @@ static ref<Object> instantiate_top_node(XMLParseContext &ctx, const std::string
     if (ctx.backend && ctx.parallel)
         jit_new_scope((JitBackend) ctx.backend);
 #endif
+    log_load_times(ctx);
     return ctx.instances.find(id)->second.object;
 }
 
@@ -1361,30 +1501,36 @@ std::vector<ref<Object>> load_string(const std::string &string,
                                      ParameterList param,
                                      bool parallel) {
     ScopedPhase sp(ProfilerPhase::InitScene);
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_buffer(string.c_str(), string.length(),
-                                                    pugi::parse_default |
-                                                    pugi::parse_comments);
-    detail::XMLSource src{
-        "<string>", doc,
-        [&](ptrdiff_t pos) { return detail::string_offset(string, pos); }
-    };
-
-    if (!result) // There was a parser error
-        Throw("Error while loading \"%s\" (at %s): %s", src.id,
-              src.offset(result.offset), result.description());
 
     // Make a backup copy of the FileResolver, which will be restored after parsing
     ref<FileResolver> fs_backup = Thread::thread()->file_resolver();
     Thread::thread()->set_file_resolver(new FileResolver(*fs_backup));
 
     try {
-        pugi::xml_node root = doc.document_element();
         detail::XMLParseContext ctx(variant, parallel);
-        Properties props;
-        size_t arg_counter = 0; // Unused
-        auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, props,
-                                          param, arg_counter, 0).second;
+        std::string scene_id;
+
+        {
+            // The DOM is released before the objects are instantiated
+            pugi::xml_document doc;
+            pugi::xml_parse_result result =
+                doc.load_buffer(string.c_str(), string.length());
+            detail::XMLSource src{
+                "<string>", doc,
+                [&](ptrdiff_t pos) { return detail::string_offset(string, pos); }
+            };
+
+            if (!result) // There was a parser error
+                Throw("Error while loading \"%s\" (at %s): %s", src.id,
+                      src.offset(result.offset), result.description());
+
+            pugi::xml_node root = doc.document_element();
+            Properties props;
+            size_t arg_counter = 0; // Unused
+            detail::sort_parameters(param);
+            scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, props,
+                                         param, arg_counter, 0).second;
+        }
 
         for (const auto& p : param) {
             if (!std::get<2>(p))
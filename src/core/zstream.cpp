@@ -1,5 +1,7 @@
 #include <mitsuba/core/zstream.h>
+#include <nanothread/nanothread.h>
 #include <zlib.h>
+#include <cstring>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -179,4 +181,188 @@ std::string ZStream::to_string() const {
 
 MI_IMPLEMENT_CLASS(ZStream, Stream)
 
+// -----------------------------------------------------------------------------
+
+BlockZStream::BlockZStream(Stream *child_stream, int level, size_t block_size)
+    : m_child_stream(child_stream), m_level(level), m_block_size(block_size) {
+    if (block_size == 0 || block_size > 0x7FFFFFFF)
+        Throw("BlockZStream: invalid block size %zu!", block_size);
+    m_batch_size = std::max((size_t) 1, (size_t) pool_size() * 2);
+}
+
+void BlockZStream::write(const void *ptr, size_t size) {
+    Assert(m_child_stream != nullptr);
+    const uint8_t *src = (const uint8_t *) ptr;
+    size_t batch_bytes = m_block_size * m_batch_size;
+
+    while (size > 0) {
+        size_t amount = std::min(size, batch_bytes - m_buffer.size());
+        m_buffer.insert(m_buffer.end(), src, src + amount);
+        src += amount;
+        size -= amount;
+        if (m_buffer.size() == batch_bytes)
+            write_blocks();
+    }
+
+    m_did_write = true;
+}
+
+std::vector<uint8_t> BlockZStream::compress_block(const void *data,
+                                                  size_t size, int level) {
+    uLongf out_size = compressBound((uLong) size);
+    std::vector<uint8_t> result(out_size);
+    int retval = compress2(result.data(), &out_size, (const Bytef *) data,
+                           (uLong) size, level);
+    if (retval != Z_OK)
+        Throw("compress2(): error code %i", retval);
+    result.resize(out_size);
+    return result;
+}
+
+void BlockZStream::decompress_block(const void *data, size_t size, void *out,
+                                    size_t out_size) {
+    uLongf actual_size = (uLongf) out_size;
+    int retval = uncompress((Bytef *) out, &actual_size, (const Bytef *) data,
+                            (uLong) size);
+    if (retval != Z_OK || actual_size != out_size)
+        Throw("uncompress(): data error (code %i)!", retval);
+}
+
+void BlockZStream::write_blocks() {
+    size_t block_count = (m_buffer.size() + m_block_size - 1) / m_block_size;
+    std::vector<std::vector<uint8_t>> compressed(block_count);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, block_count, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                size_t offset = i * m_block_size,
+                       size = std::min(m_block_size, m_buffer.size() - offset);
+                compressed[i] = compress_block(m_buffer.data() + offset, size,
+                                               m_level);
+            }
+        }
+    );
+
+    for (size_t i = 0; i < block_count; ++i) {
+        size_t size = std::min(m_block_size, m_buffer.size() - i * m_block_size);
+        m_child_stream->write((uint32_t) size);
+        m_child_stream->write((uint32_t) compressed[i].size());
+        m_child_stream->write(compressed[i].data(), compressed[i].size());
+    }
+
+    m_buffer.clear();
+}
+
+void BlockZStream::read_blocks() {
+    struct Frame {
+        uint32_t size;
+        std::vector<uint8_t> data;
+    };
+
+    // Read a batch of frames (sequential I/O)
+    std::vector<Frame> frames;
+    while (frames.size() < m_batch_size) {
+        uint32_t size = 0, compressed_size = 0;
+        m_child_stream->read(size);
+        m_child_stream->read(compressed_size);
+        if (size == 0 && compressed_size == 0) {
+            m_end_of_stream = true;
+            break;
+        }
+        Frame frame;
+        frame.size = size;
+        frame.data.resize(compressed_size);
+        m_child_stream->read(frame.data.data(), compressed_size);
+        frames.push_back(std::move(frame));
+    }
+
+    std::vector<size_t> offset(frames.size() + 1, 0);
+    for (size_t i = 0; i < frames.size(); ++i)
+        offset[i + 1] = offset[i] + frames[i].size;
+
+    m_buffer.resize(offset[frames.size()]);
+    m_buffer_pos = 0;
+
+    // Decompress the frames in parallel
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, frames.size(), 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                decompress_block(frames[i].data.data(), frames[i].data.size(),
+                                 m_buffer.data() + offset[i], frames[i].size);
+            }
+        }
+    );
+}
+
+void BlockZStream::read(void *ptr, size_t size) {
+    Assert(m_child_stream != nullptr);
+    uint8_t *target = (uint8_t *) ptr;
+
+    while (size > 0) {
+        if (m_buffer_pos == m_buffer.size()) {
+            if (m_end_of_stream)
+                Throw("BlockZStream: attempting to read past the end of the "
+                      "stream (%zu more bytes required)!", size);
+            read_blocks();
+            continue;
+        }
+
+        size_t amount = std::min(size, m_buffer.size() - m_buffer_pos);
+        memcpy(target, m_buffer.data() + m_buffer_pos, amount);
+        m_buffer_pos += amount;
+        target += amount;
+        size -= amount;
+    }
+}
+
+void BlockZStream::flush() {
+    Assert(m_child_stream != nullptr);
+    if (m_did_write && !m_buffer.empty()) {
+        write_blocks();
+        m_child_stream->flush();
+    }
+}
+
+void BlockZStream::close() {
+    if (!m_child_stream)
+        return;
+
+    if (m_did_write) {
+        if (!m_buffer.empty())
+            write_blocks();
+        m_child_stream->write((uint32_t) 0);
+        m_child_stream->write((uint32_t) 0);
+    }
+
+    m_buffer = std::vector<uint8_t>();
+    m_child_stream = nullptr;
+}
+
+BlockZStream::~BlockZStream() {
+    close();
+}
+
+std::string BlockZStream::to_string() const {
+    std::ostringstream oss;
+
+    oss << class_()->name() << "[" << std::endl;
+    if (is_closed()) {
+        oss << "  closed" << std::endl;
+    } else {
+        oss << "  child_stream = \"" << string::indent(m_child_stream) << "\"" << "," << std::endl
+            << "  block_size = " << m_block_size << "," << std::endl
+            << "  batch_size = " << m_batch_size << "," << std::endl
+            << "  can_read = " << can_read() << "," << std::endl
+            << "  can_write = " << can_write() << std::endl;
+    }
+
+    oss << "]";
+
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(BlockZStream, Stream)
+
 NAMESPACE_END(mitsuba)
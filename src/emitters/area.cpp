@@ -221,6 +221,22 @@ public:
         return { ps, weight };
     }
 
+    Float pdf_position(const PositionSample3f &ps, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        if (!m_radiance->is_spatially_varying())
+            return m_shape->pdf_position(ps, active);
+
+        // This surface intersection would be nice to avoid..
+        SurfaceInteraction3f si = m_shape->eval_parameterization(ps.uv, +RayFlags::dPdUV, active);
+        active &= si.is_valid();
+
+        Float value = m_radiance->pdf_position(ps.uv, active) /
+                      dr::norm(dr::cross(si.dp_du, si.dp_dv));
+
+        return dr::select(active, value, 0.f);
+    }
+
     std::pair<Wavelength, Spectrum>
     sample_wavelengths(const SurfaceInteraction3f &si, Float sample,
                        Mask active) const override {
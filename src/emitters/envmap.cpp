@@ -10,6 +10,9 @@
 #include <drjit/tensor.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/core/fstream.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -21,7 +24,7 @@ Environment emitter (:monosp:`envmap`)
 --------------------------------------
 
 .. pluginparameters::
- :extra-rows: 4
+ :extra-rows: 6
 
  * - filename
    - |string|
@@ -49,6 +52,13 @@ Environment emitter (:monosp:`envmap`)
      will be combined using multiple importance sampling (MIS)? This is
      extremely cheap to do and can slightly reduce variance. (Default: false)
 
+ * - product_sampling
+   - |bool|
+   - Importance sample the product of the environment map and the absolute cosine
+     of the angle to the surface normal at the reference point? This reduces
+     noise on surfaces that only see part of a high-frequency environment map,
+     at the cost of a more expensive traversal of the sampling hierarchy. (Default: false)
+
  * - data
    - |tensor|
    - Tensor array containing the radiance-valued data.
@@ -79,6 +89,18 @@ High quality free light probes are available on
 `Bernhard Vogl's <http://dativ.at/lightprobes/>`_ website or 
 `Polyhaven <https://polyhaven.com/hdris>`_.
 
+In JIT variants, environment maps that load the same file share the converted
+image and its sampling distribution, which are only computed once.
+
+By default, directions are sampled proportionally to the luminance of the
+environment map. With ``product_sampling`` enabled, the implementation instead
+reweights the cells of the hierarchical sampling structure by an upper bound of
+the cosine factor within each cell, which concentrates samples on the visible
+part of the environment. A small constant is added to the cell weights, which
+keeps the density positive everywhere so that the technique remains unbiased
+for arbitrary BSDFs. Reference points without a surface normal (e.g. in media)
+fall back to the default strategy.
+
 .. tabs::
     .. code-tab:: xml
         :name: envmap-light
@@ -113,6 +135,8 @@ public:
         m_bsphere = ScalarBoundingSphere3f(ScalarPoint3f(0.f), 1.f);
 
         ref<Bitmap> bitmap;
+        std::string cache_key;
+        bool mis_compensation = props.get<bool>("mis_compensation", false);
 
         if (props.has_property("bitmap")) {
             // Creates a Bitmap texture directly from an existing Bitmap object
@@ -128,109 +152,25 @@ public:
             FileResolver *fs = Thread::thread()->file_resolver();
             fs::path file_path = fs->resolve(props.string("filename"));
             m_filename = file_path.filename().string();
-            bitmap = new Bitmap(file_path);
-        }
-
-        if (bitmap->width() < 2 || bitmap->height() < 3)
-            Throw("\"%s\": the environment map resolution must be at least "
-                  "2x3 pixels", (m_filename.empty() ? "<Bitmap>" : m_filename));
-
-        /* Convert to linear RGBA float bitmap, will undergo further
-           conversion into coefficients of a spectral upsampling model below */
-        Bitmap::PixelFormat pixel_format = Bitmap::PixelFormat::RGB;
-        if constexpr (is_spectral_v<Spectrum>)
-            pixel_format = Bitmap::PixelFormat::RGBA;
-        bitmap = bitmap->convert(pixel_format, struct_type_v<Float>, false);
-
-        /* Allocate a larger image including an extra column to
-           account for the periodic boundary */
-        ScalarVector2u res(bitmap->width() + 1, bitmap->height());
-        ref<Bitmap> bitmap_2 = new Bitmap(bitmap->pixel_format(),
-                                          bitmap->component_format(), res);
-
-        // Luminance image used for importance sampling
-        std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[dr::prod(res)]);
-
-        ScalarFloat *in_ptr  = (ScalarFloat *) bitmap->data(),
-                    *out_ptr = (ScalarFloat *) bitmap_2->data(),
-                    *lum_ptr = (ScalarFloat *) luminance.get();
-
-        ScalarFloat theta_scale = 1.f / (bitmap->size().y() - 1) * dr::Pi<Float>;
-
-        /* "MIS Compensation: Optimizing Sampling Techniques in Multiple
-           Importance Sampling" Ondrej Karlik, Martin Sik, Petr Vivoda, Tomas
-           Skrivan, and Jaroslav Krivanek. SIGGRAPH Asia 2019 */
-        ScalarFloat luminance_offset = 0.f;
-        if (props.get<bool>("mis_compensation", false)) {
-            ScalarFloat min_lum = 0.f;
-            double lum_accum_d = 0.0;
 
-            for (size_t y = 0; y < bitmap->size().y(); ++y) {
-                for (size_t x = 0; x < bitmap->size().x(); ++x) {
-                    ScalarColor3f rgb = dr::load<ScalarVector3f>(in_ptr);
-                    ScalarFloat lum = mitsuba::luminance(rgb);
-                    min_lum = dr::minimum(min_lum, lum);
-                    lum_accum_d += (double) lum;
-                    in_ptr += 4;
-                }
-            }
-            in_ptr = (ScalarFloat *) bitmap->data();
-
-            luminance_offset = ScalarFloat(lum_accum_d / dr::prod(bitmap->size()));
+            /* Environment maps loading the same file share their data (in
+               JIT variants, where copies of arrays don't duplicate it) */
+            if constexpr (dr::is_jit_v<Float>)
+                cache_key = fs::absolute(file_path).string() + "|" +
+                            std::to_string(mis_compensation);
 
-            /* Be wary of constant environment maps: average and minimum
-               should be sufficiently different */
-            if (luminance_offset - min_lum <= 0.01f * luminance_offset)
-                luminance_offset = 0.f; // disable
+            if (cache_key.empty() || !cache_lookup(cache_key))
+                bitmap = new Bitmap(file_path);
         }
 
-        size_t pixel_width = is_spectral_v<Spectrum> ? 4 : 3;
-        for (size_t y = 0; y < bitmap->size().y(); ++y) {
-            ScalarFloat sin_theta = dr::sin(y * theta_scale);
-
-            for (size_t x = 0; x < bitmap->size().x(); ++x) {
-                ScalarColor3f rgb = dr::load<ScalarVector3f>(in_ptr);
-
-                ScalarFloat lum = mitsuba::luminance(rgb);
-
-                ScalarPixelData coeff;
-                if constexpr (is_monochromatic_v<Spectrum>) {
-                    coeff = ScalarPixelData(lum);
-                } else if constexpr (is_rgb_v<Spectrum>) {
-                    coeff = rgb;
-                } else {
-                    static_assert(is_spectral_v<Spectrum>);
-                    /* Evaluate the spectral upsampling model. This requires a
-                       reflectance value (colors in [0, 1]) which is accomplished here by
-                       scaling. We use a color where the highest component is 50%,
-                       which generally yields a fairly smooth spectrum. */
-                    ScalarFloat scale = dr::max(rgb) * 2.f;
-                    ScalarColor3f rgb_norm = rgb / dr::maximum(1e-8f, scale);
-                    coeff = dr::concat((ScalarColor3f) srgb_model_fetch(rgb_norm),
-                                       dr::Array<ScalarFloat, 1>(scale));
-                }
-
-                lum = dr::maximum(lum - luminance_offset, 0.f);
-
-                *lum_ptr++ = lum * sin_theta;
-                dr::store(out_ptr, coeff);
-                in_ptr += pixel_width;
-                out_ptr += pixel_width;
-            }
-
-            // Last column of pixels mirrors first
-            ScalarFloat temp = *(lum_ptr - bitmap->size().x());
-            *lum_ptr++ = temp;
-            dr::store(out_ptr, dr::load<ScalarPixelData>(
-                                   out_ptr - bitmap->size().x() * pixel_width));
-            out_ptr += pixel_width;
+        if (bitmap) {
+            init_data(bitmap, mis_compensation);
+            if (!cache_key.empty())
+                cache_insert(cache_key);
         }
 
-        size_t shape[3] = { (size_t) res.y(), (size_t) res.x(), pixel_width };
-        m_data = TensorXf(bitmap_2->data(), 3, shape);
-
         m_scale = props.get<ScalarFloat>("scale", 1.f);
-        m_warp = Warp(luminance.get(), res);
+        m_product_sampling = props.get<bool>("product_sampling", false);
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
         dr::set_attr(this, "flags", m_flags);
@@ -245,6 +185,8 @@ public:
 
     void parameters_changed(const std::vector<std::string> &keys = {}) override {
         if (keys.empty() || string::contains(keys, "data")) {
+            // The data no longer matches the cached version
+            m_cached = nullptr;
 
             ScalarVector2u res = { m_data.shape(1), m_data.shape(0) };
 
@@ -386,7 +328,13 @@ public:
                      Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
 
-        auto [uv, pdf] = m_warp.sample(sample, nullptr, active);
+        Point2f uv;
+        Float pdf;
+        if (m_product_sampling)
+            std::tie(uv, pdf) = m_warp.sample_weighted(
+                sample, cosine_weight(it), nullptr, active);
+        else
+            std::tie(uv, pdf) = m_warp.sample(sample, nullptr, active);
         uv.x() += .5f / (m_data.shape(1) - 1);
         active &= pdf > 0.f;
 
@@ -427,7 +375,7 @@ public:
         return { ds, weight & active };
     }
 
-    Float pdf_direction(const Interaction3f & /*it*/, const DirectionSample3f &ds,
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
                         Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
 
@@ -442,7 +390,11 @@ public:
         Float inv_sin_theta = dr::safe_rsqrt(dr::maximum(
             dr::sqr(d.x()) + dr::sqr(d.z()), dr::sqr(dr::Epsilon<Float>)));
 
-        return m_warp.eval(uv) * inv_sin_theta * (1.f / (2.f * dr::sqr(dr::Pi<Float>)));
+        Float pdf = m_product_sampling
+                        ? m_warp.eval_weighted(uv, cosine_weight(it), nullptr, active)
+                        : m_warp.eval(uv, nullptr, active);
+
+        return pdf * inv_sin_theta * (1.f / (2.f * dr::sqr(dr::Pi<Float>)));
     }
 
     Spectrum eval_direction(const Interaction3f &it,
@@ -489,6 +441,7 @@ public:
         if (!m_filename.empty())
             oss << "  filename = \"" << m_filename << "\"," << std::endl;
         oss << "  res = \"" << res << "\"," << std::endl
+            << "  product_sampling = " << m_product_sampling << "," << std::endl
             << "  bsphere = " << string::indent(m_bsphere) << std::endl
             << "]";
         return oss.str();
@@ -555,7 +508,204 @@ protected:
         }
     }
 
+    /**
+     * \brief Return a function that bounds the absolute cosine between the
+     * surface normal of \c it and the directions within a cell of the
+     * sampling hierarchy (for \ref Hierarchical2D::sample_weighted())
+     */
+    auto cosine_weight(const Interaction3f &it) const {
+        Vector3f n = m_to_world.value().inverse().transform_affine(Vector3f(it.n));
+
+        // Convert to the coordinate system of the latitude-longitude mapping
+        n = Vector3f(-n.z(), n.x(), n.y());
+        Float length_sqr = dr::squared_norm(n);
+        Mask valid = length_sqr > 0.f;
+        n *= dr::rsqrt(dr::select(valid, length_sqr, 1.f));
+
+        ScalarFloat u_offset = .5f / (m_data.shape(1) - 1);
+
+        return [n, valid, u_offset](const Point2f &p0, const Point2f &p1) {
+            // Weight of cells that don't face the reference point
+            constexpr ScalarFloat MinWeight = .05f;
+
+            Float theta_0 = dr::minimum(p0.y(), 1.f) * dr::Pi<Float>,
+                  theta_1 = dr::minimum(p1.y(), 1.f) * dr::Pi<Float>,
+                  theta_c = .5f * (theta_0 + theta_1),
+                  phi_c   = (.5f * (p0.x() + p1.x()) + u_offset) * dr::TwoPi<Float>;
+
+            /* Bound the angular distance between the cell center and its
+               other directions: along the meridian and along the parallel */
+            Float sin_max = dr::select(theta_0 < .5f * dr::Pi<Float> &&
+                                       theta_1 > .5f * dr::Pi<Float>, 1.f,
+                                       dr::maximum(dr::sin(theta_0), dr::sin(theta_1)));
+            Float radius = .5f * (theta_1 - theta_0) +
+                           (p1.x() - p0.x()) * dr::Pi<Float> * sin_max;
+
+            Float angle = dr::safe_acos(dr::dot(dr::sphdir(theta_c, phi_c), n));
+
+            // Largest absolute cosine within the cell
+            Float cos_max = dr::maximum(
+                dr::cos(dr::maximum(angle - radius, 0.f)),
+                -dr::cos(dr::minimum(angle + radius, dr::Pi<Float>)));
+
+            return dr::select(valid, dr::maximum(cos_max, 0.f) + MinWeight, 1.f);
+        };
+    }
+
     MI_DECLARE_CLASS()
+protected:
+    /// Convert the image into the stored representation and build the warp
+    void init_data(ref<Bitmap> bitmap, bool mis_compensation) {
+        if (bitmap->width() < 2 || bitmap->height() < 3)
+            Throw("\"%s\": the environment map resolution must be at least "
+                  "2x3 pixels", (m_filename.empty() ? "<Bitmap>" : m_filename));
+
+        /* Convert to linear RGBA float bitmap, will undergo further
+           conversion into coefficients of a spectral upsampling model below */
+        Bitmap::PixelFormat pixel_format = Bitmap::PixelFormat::RGB;
+        if constexpr (is_spectral_v<Spectrum>)
+            pixel_format = Bitmap::PixelFormat::RGBA;
+        bitmap = bitmap->convert(pixel_format, struct_type_v<Float>, false);
+
+        /* Allocate a larger image including an extra column to
+           account for the periodic boundary */
+        ScalarVector2u res(bitmap->width() + 1, bitmap->height());
+        ref<Bitmap> bitmap_2 = new Bitmap(bitmap->pixel_format(),
+                                          bitmap->component_format(), res);
+
+        // Luminance image used for importance sampling
+        std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[dr::prod(res)]);
+
+        ScalarFloat *in_ptr  = (ScalarFloat *) bitmap->data(),
+                    *out_ptr = (ScalarFloat *) bitmap_2->data(),
+                    *lum_ptr = (ScalarFloat *) luminance.get();
+
+        ScalarFloat theta_scale = 1.f / (bitmap->size().y() - 1) * dr::Pi<Float>;
+
+        /* "MIS Compensation: Optimizing Sampling Techniques in Multiple
+           Importance Sampling" Ondrej Karlik, Martin Sik, Petr Vivoda, Tomas
+           Skrivan, and Jaroslav Krivanek. SIGGRAPH Asia 2019 */
+        ScalarFloat luminance_offset = 0.f;
+        if (mis_compensation) {
+            ScalarFloat min_lum = 0.f;
+            double lum_accum_d = 0.0;
+
+            for (size_t y = 0; y < bitmap->size().y(); ++y) {
+                for (size_t x = 0; x < bitmap->size().x(); ++x) {
+                    ScalarColor3f rgb = dr::load<ScalarVector3f>(in_ptr);
+                    ScalarFloat lum = mitsuba::luminance(rgb);
+                    min_lum = dr::minimum(min_lum, lum);
+                    lum_accum_d += (double) lum;
+                    in_ptr += 4;
+                }
+            }
+            in_ptr = (ScalarFloat *) bitmap->data();
+
+            luminance_offset = ScalarFloat(lum_accum_d / dr::prod(bitmap->size()));
+
+            /* Be wary of constant environment maps: average and minimum
+               should be sufficiently different */
+            if (luminance_offset - min_lum <= 0.01f * luminance_offset)
+                luminance_offset = 0.f; // disable
+        }
+
+        size_t pixel_width = is_spectral_v<Spectrum> ? 4 : 3;
+        for (size_t y = 0; y < bitmap->size().y(); ++y) {
+            ScalarFloat sin_theta = dr::sin(y * theta_scale);
+
+            for (size_t x = 0; x < bitmap->size().x(); ++x) {
+                ScalarColor3f rgb = dr::load<ScalarVector3f>(in_ptr);
+
+                ScalarFloat lum = mitsuba::luminance(rgb);
+
+                ScalarPixelData coeff;
+                if constexpr (is_monochromatic_v<Spectrum>) {
+                    coeff = ScalarPixelData(lum);
+                } else if constexpr (is_rgb_v<Spectrum>) {
+                    coeff = rgb;
+                } else {
+                    static_assert(is_spectral_v<Spectrum>);
+                    /* Evaluate the spectral upsampling model. This requires a
+                       reflectance value (colors in [0, 1]) which is accomplished here by
+                       scaling. We use a color where the highest component is 50%,
+                       which generally yields a fairly smooth spectrum. */
+                    ScalarFloat scale = dr::max(rgb) * 2.f;
+                    ScalarColor3f rgb_norm = rgb / dr::maximum(1e-8f, scale);
+                    coeff = dr::concat((ScalarColor3f) srgb_model_fetch(rgb_norm),
+                                       dr::Array<ScalarFloat, 1>(scale));
+                }
+
+                lum = dr::maximum(lum - luminance_offset, 0.f);
+
+                *lum_ptr++ = lum * sin_theta;
+                dr::store(out_ptr, coeff);
+                in_ptr += pixel_width;
+                out_ptr += pixel_width;
+            }
+
+            // Last column of pixels mirrors first
+            ScalarFloat temp = *(lum_ptr - bitmap->size().x());
+            *lum_ptr++ = temp;
+            dr::store(out_ptr, dr::load<ScalarPixelData>(
+                                   out_ptr - bitmap->size().x() * pixel_width));
+            out_ptr += pixel_width;
+        }
+
+        size_t shape[3] = { (size_t) res.y(), (size_t) res.x(), pixel_width };
+        m_data = TensorXf(bitmap_2->data(), 3, shape);
+
+        m_warp = Warp(luminance.get(), res);
+    }
+
+    /// Data of an environment map loaded from a file
+    struct CachedData {
+        TensorXf data;
+        Warp warp;
+    };
+
+    struct Cache {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::weak_ptr<CachedData>> entries;
+    };
+
+    static Cache &cache() {
+        static Cache cache;
+        return cache;
+    }
+
+    /// Use the cached data of a file (if still referenced by another emitter)
+    bool cache_lookup(const std::string &key) {
+        Cache &c = cache();
+        std::lock_guard<std::mutex> guard(c.mutex);
+
+        for (auto it = c.entries.begin(); it != c.entries.end();) {
+            if (it->second.expired())
+                it = c.entries.erase(it);
+            else
+                ++it;
+        }
+
+        auto it = c.entries.find(key);
+        if (it == c.entries.end())
+            return false;
+        m_cached = it->second.lock();
+        if (!m_cached)
+            return false;
+
+        // Copies of JIT arrays share their storage
+        m_data = m_cached->data;
+        m_warp = m_cached->warp;
+        return true;
+    }
+
+    /// Make the data of this emitter available to other instances
+    void cache_insert(const std::string &key) {
+        Cache &c = cache();
+        std::lock_guard<std::mutex> guard(c.mutex);
+        m_cached = std::make_shared<CachedData>(CachedData{ m_data, m_warp });
+        c.entries[key] = m_cached;
+    }
+
 protected:
     std::string m_filename;
     ScalarBoundingSphere3f m_bsphere;
@@ -563,6 +713,8 @@ protected:
     Warp m_warp;
     ref<Texture> m_d65;
     Float m_scale;
+    bool m_product_sampling;
+    std::shared_ptr<CachedData> m_cached;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(EnvironmentMapEmitter, Emitter)
@@ -0,0 +1,527 @@
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/medium.h>
+#include <mitsuba/render/srgb.h>
+#include <mitsuba/render/texture.h>
+#include <fstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _emitter-pointarray:
+
+Point light array (:monosp:`pointarray`)
+----------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the text file that specifies the individual light sources
+     (see below).
+
+ * - scale
+   - |float|
+   - Scale factor that is applied to the intensity of all light sources
+     (Default: 1.0)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional transformation that is applied to the positions
+     and directions of all light sources. (Default: none, i.e. emitter space =
+     world space)
+
+ * - position
+   - |tensor|
+   - Positions of the light sources in structure-of-arrays layout, i.e.
+     all x coordinates followed by all y and z coordinates.
+   - |exposed|
+
+ * - intensity
+   - |tensor|
+   - Radiant intensities of the light sources in structure-of-arrays layout.
+     Depending on the variant, these are RGB values, spectral upsampling
+     coefficients, or monochromatic intensities.
+   - |exposed|, |differentiable|
+
+This plugin represents a large number of :ref:`point <emitter-point>` and
+:ref:`spot <emitter-spot>` light sources (e.g. the lights of a stadium or of
+an LED wall) within a single emitter. Compared to instantiating each light as
+a separate plugin, this greatly reduces the scene construction time, and
+occupies a single emitter slot in the scene's emitter sampling and virtual
+function call dispatch. The light sources are stored in structure-of-arrays
+layout and are importance sampled proportionally to their emitted power.
+
+The light sources are loaded from a text file, where every line specifies one
+light source and lines starting with :monosp:`#` are ignored. Point lights
+use six columns (position and RGB intensity)::
+
+    x y z r g b
+
+Spot lights additionally specify their central direction, as well as the
+cutoff angle and beam width in degrees (see the
+:ref:`spot <emitter-spot>` plugin for the definition of the falloff profile)::
+
+    x y z r g b dx dy dz cutoff_angle beam_width
+
+All lines of a file must use the same number of columns. In spectral variants,
+the RGB intensities are upsampled and multiplied by the D65 illuminant, like
+the :monosp:`intensity` parameter of the :monosp:`point` plugin.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: pointarray-light
+
+        <emitter type="pointarray">
+            <string name="filename" value="stadium_lights.txt"/>
+        </emitter>
+
+    .. code-tab:: python
+
+        'type': 'pointarray',
+        'filename': 'stadium_lights.txt'
+
+ */
+
+template <typename Float, typename Spectrum>
+class PointLightArray final : public Emitter<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Emitter, m_flags, m_medium, m_needs_sample_3)
+    MI_IMPORT_TYPES(Texture)
+
+    using FloatStorage = DynamicBuffer<Float>;
+    static constexpr size_t ChannelCount = is_monochromatic_v<Spectrum> ? 1 : 3;
+
+    PointLightArray(const Properties &props) : Base(props) {
+        ScalarFloat scale = props.get<ScalarFloat>("scale", 1.f);
+        ScalarTransform4f to_world = props.get<ScalarTransform4f>("to_world", ScalarTransform4f());
+
+        FileResolver *fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        if (!fs::exists(file_path))
+            Throw("\"%s\": file does not exist!", file_path);
+
+        std::vector<ScalarFloat> rows;
+        size_t columns = load_file(file_path, rows);
+        m_count = (uint32_t) (rows.size() / columns);
+        m_spot = columns == 11;
+
+        std::vector<ScalarFloat> position(3 * m_count),
+                                 intensity(ChannelCount * m_count),
+                                 intensity_scale(m_count, 1.f),
+                                 direction(m_spot ? 3 * m_count : 0),
+                                 cutoff(m_spot ? 4 * m_count : 0);
+
+        for (uint32_t i = 0; i < m_count; ++i) {
+            const ScalarFloat *row = rows.data() + i * columns;
+            ScalarPoint3f p = to_world * ScalarPoint3f(row[0], row[1], row[2]);
+            ScalarColor3f color = ScalarColor3f(row[3], row[4], row[5]) * scale;
+            m_bbox.expand(p);
+
+            if (dr::any(color < 0.f))
+                Throw("\"%s\": light %u has a negative intensity!", file_path, i);
+
+            for (size_t k = 0; k < 3; ++k)
+                position[k * m_count + i] = p[k];
+
+            if constexpr (is_spectral_v<Spectrum>) {
+                // Same upsampling strategy as the 'd65' spectrum plugin
+                ScalarFloat factor = dr::max(color) * 2.f;
+                if (factor != 0.f)
+                    color /= factor;
+                intensity_scale[i] = factor;
+                auto coeff = srgb_model_fetch(color);
+                for (size_t k = 0; k < 3; ++k)
+                    intensity[k * m_count + i] = coeff[k];
+            } else if constexpr (is_rgb_v<Spectrum>) {
+                for (size_t k = 0; k < 3; ++k)
+                    intensity[k * m_count + i] = color[k];
+            } else {
+                intensity[i] = luminance(color);
+            }
+
+            if (m_spot) {
+                ScalarVector3f d = dr::normalize(
+                    to_world * ScalarVector3f(row[6], row[7], row[8]));
+                ScalarFloat cutoff_angle = dr::deg_to_rad(row[9]),
+                            beam_width   = dr::deg_to_rad(row[10]);
+                if (!dr::all(dr::isfinite(d)))
+                    Throw("\"%s\": light %u has an invalid direction!", file_path, i);
+                if (beam_width > cutoff_angle)
+                    Throw("\"%s\": the beam width of light %u exceeds its "
+                          "cutoff angle!", file_path, i);
+                for (size_t k = 0; k < 3; ++k)
+                    direction[k * m_count + i] = d[k];
+                cutoff[i]               = cutoff_angle;
+                cutoff[m_count + i]     = dr::cos(cutoff_angle);
+                cutoff[2 * m_count + i] = dr::cos(beam_width);
+                cutoff[3 * m_count + i] = cutoff_angle > beam_width
+                                              ? 1.f / (cutoff_angle - beam_width)
+                                              : 0.f;
+            }
+        }
+
+        m_position = dr::load<FloatStorage>(position.data(), position.size());
+        m_intensity = dr::load<FloatStorage>(intensity.data(), intensity.size());
+        m_intensity_scale = dr::load<FloatStorage>(intensity_scale.data(), m_count);
+        if (m_spot) {
+            m_direction = dr::load<FloatStorage>(direction.data(), direction.size());
+            m_cutoff = dr::load<FloatStorage>(cutoff.data(), cutoff.size());
+        }
+
+        if constexpr (is_spectral_v<Spectrum>)
+            m_d65 = PluginManager::instance()->create_object<Texture>(Properties("d65"));
+
+        update_distribution();
+
+        m_needs_sample_3 = false;
+        m_flags = +EmitterFlags::DeltaPosition;
+        dr::set_attr(this, "flags", m_flags);
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("position",  m_position,  +ParamFlags::NonDifferentiable);
+        callback->put_parameter("intensity", m_intensity, +ParamFlags::Differentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        if (keys.empty() || string::contains(keys, "position")) {
+            if (dr::width(m_position) != 3 * m_count)
+                Throw("The number of light positions can't be changed!");
+
+            FloatStorage position = host_copy(m_position);
+            m_bbox.reset();
+            for (uint32_t i = 0; i < m_count; ++i)
+                m_bbox.expand(ScalarPoint3f(position[i], position[m_count + i],
+                                            position[2 * m_count + i]));
+        }
+
+        if (keys.empty() || string::contains(keys, "intensity")) {
+            if (dr::width(m_intensity) != ChannelCount * m_count)
+                Throw("The number of light intensities can't be changed!");
+            update_distribution();
+        }
+
+        Base::parameters_changed(keys);
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &pos_sample,
+                                          const Point2f &dir_sample,
+                                          Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        auto [index, pmf] = m_distr.sample_pmf(pos_sample.x(), active);
+
+        auto [wavelengths, weight] =
+            sample_intensity(index, wavelength_sample, active);
+
+        Vector3f d;
+        if (m_spot) {
+            Float cos_cutoff = gather_cutoff(index, 1, active);
+            Vector3f local_dir = warp::square_to_uniform_cone(dir_sample, cos_cutoff);
+            Float pdf_dir = warp::square_to_uniform_cone_pdf(local_dir, cos_cutoff);
+            weight *= falloff_curve(index, local_dir.z(), active) / pdf_dir;
+            d = Frame3f(Vector3f(gather_3(m_direction, index, active))).to_world(local_dir);
+        } else {
+            weight *= 4.f * dr::Pi<Float>;
+            d = warp::square_to_uniform_sphere(dir_sample);
+        }
+
+        Ray3f ray(gather_3(m_position, index, active), d, time, wavelengths);
+        return { ray, depolarizer<Spectrum>(weight / pmf) & active };
+    }
+
+    std::pair<DirectionSample3f, Spectrum> sample_direction(const Interaction3f &it,
+                                                            const Point2f &sample,
+                                                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        auto [index, pmf] = m_distr.sample_pmf(sample.x(), active);
+
+        DirectionSample3f ds;
+        ds.p          = gather_3(m_position, index, active);
+        ds.n          = 0.f;
+        ds.uv         = 0.f;
+        ds.time       = it.time;
+        ds.pdf        = pmf;
+        ds.delta      = true;
+        ds.emitter    = this;
+        ds.prim_index = index;
+        ds.d          = ds.p - it.p;
+
+        Float dist2    = dr::squared_norm(ds.d),
+              inv_dist = dr::rsqrt(dist2);
+
+        // Redundant sqrt (removed by the JIT when the 'dist' field is not used)
+        ds.dist = dr::sqrt(dist2);
+        ds.d *= inv_dist;
+
+        UnpolarizedSpectrum spec =
+            eval_intensity(index, it.wavelengths, -ds.d, active) *
+            (dr::sqr(inv_dist) / pmf);
+
+        return { ds, depolarizer<Spectrum>(spec) & active };
+    }
+
+    Float pdf_direction(const Interaction3f &, const DirectionSample3f &,
+                        Mask) const override {
+        return 0.f;
+    }
+
+    Spectrum eval_direction(const Interaction3f &it,
+                            const DirectionSample3f &ds,
+                            Mask active) const override {
+        Vector3f d = ds.p - it.p;
+        Float dist2 = dr::squared_norm(d);
+        UnpolarizedSpectrum spec =
+            eval_intensity(ds.prim_index, it.wavelengths, -d * dr::rsqrt(dist2),
+                           active) / dist2;
+        return depolarizer<Spectrum>(spec) & active;
+    }
+
+    std::pair<PositionSample3f, Float>
+    sample_position(Float time, const Point2f &sample,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSamplePosition, active);
+
+        auto [index, pmf] = m_distr.sample_pmf(sample.x(), active);
+
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+        ps.p     = gather_3(m_position, index, active);
+        ps.time  = time;
+        ps.pdf   = pmf;
+        ps.delta = true;
+        if (m_spot)
+            ps.n = Normal3f(gather_3(m_direction, index, active));
+
+        return { ps, dr::rcp(pmf) };
+    }
+
+    std::pair<Wavelength, Spectrum>
+    sample_wavelengths(const SurfaceInteraction3f &si, Float sample,
+                       Mask active) const override {
+        if constexpr (is_spectral_v<Spectrum>) {
+            return m_d65->sample_spectrum(
+                si, math::sample_shifted<Wavelength>(sample), active);
+        } else {
+            DRJIT_MARK_USED(si);
+            DRJIT_MARK_USED(sample);
+            DRJIT_MARK_USED(active);
+            return { dr::empty<Wavelength>(), Spectrum(1.f) };
+        }
+    }
+
+    Spectrum eval(const SurfaceInteraction3f &, Mask) const override {
+        return 0.f;
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "PointLightArray[" << std::endl
+            << "  count = " << m_count << "," << std::endl
+            << "  spot = " << m_spot << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  medium = " << (m_medium ? string::indent(m_medium) : "none")
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Parse a text file with one light source per line
+    static size_t load_file(const fs::path &path, std::vector<ScalarFloat> &values) {
+        std::ifstream is(path.native());
+        if (!is)
+            Throw("\"%s\": could not open file!", path);
+
+        size_t columns = 0, line_number = 0;
+        std::string line;
+        while (std::getline(is, line)) {
+            line_number++;
+            line = string::trim(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream iss(line);
+            size_t count = 0;
+            double value;
+            while (iss >> value) {
+                values.push_back((ScalarFloat) value);
+                count++;
+            }
+
+            if (!iss.eof())
+                Throw("\"%s\": could not parse line %zu!", path, line_number);
+            if (count != 6 && count != 11)
+                Throw("\"%s\": line %zu has %zu columns, expected 6 or 11!",
+                      path, line_number, count);
+            if (columns != 0 && columns != count)
+                Throw("\"%s\": line %zu has %zu columns, expected %zu like "
+                      "the preceding lines!", path, line_number, count, columns);
+            columns = count;
+        }
+
+        if (columns == 0)
+            Throw("\"%s\": the file does not specify any light sources!", path);
+
+        return columns;
+    }
+
+    /// Return a copy of a buffer that can be accessed on the host
+    static FloatStorage host_copy(const FloatStorage &buffer) {
+        if constexpr (dr::is_jit_v<Float>) {
+            FloatStorage temp = dr::migrate(buffer, AllocType::Host);
+            dr::sync_thread();
+            return temp;
+        } else {
+            return buffer;
+        }
+    }
+
+    /// Build the discrete distribution used to select a light source by its power
+    void update_distribution() {
+        FloatStorage intensity       = host_copy(m_intensity),
+                     intensity_scale = host_copy(m_intensity_scale),
+                     cutoff          = m_spot ? host_copy(m_cutoff) : FloatStorage();
+        const ScalarFloat *ip = intensity.data(),
+                          *sp = intensity_scale.data(),
+                          *cp = m_spot ? cutoff.data() : nullptr;
+        uint32_t n = m_count;
+
+        std::unique_ptr<ScalarFloat[]> power(new ScalarFloat[n]);
+        for (uint32_t i = 0; i < n; ++i) {
+            ScalarFloat value;
+            if constexpr (is_spectral_v<Spectrum>)
+                value = srgb_model_mean(ScalarVector3f(ip[i], ip[n + i], ip[2 * n + i])) * sp[i];
+            else if constexpr (is_rgb_v<Spectrum>)
+                value = luminance(ScalarColor3f(ip[i], ip[n + i], ip[2 * n + i]));
+            else
+                value = ip[i];
+
+            // Solid angle of the emission profile
+            if (m_spot)
+                value *= dr::TwoPi<ScalarFloat> *
+                         (1.f - .5f * (cp[n + i] + cp[2 * n + i]));
+            else
+                value *= 4.f * dr::Pi<ScalarFloat>;
+
+            power[i] = dr::maximum(value, 0.f);
+        }
+
+        DRJIT_MARK_USED(sp);
+        m_distr = DiscreteDistribution<Float>(power.get(), n);
+    }
+
+    Point3f gather_3(const FloatStorage &buffer, const UInt32 &index,
+                     Mask active) const {
+        return Point3f(dr::gather<Float>(buffer, index, active),
+                       dr::gather<Float>(buffer, index + m_count, active),
+                       dr::gather<Float>(buffer, index + 2 * m_count, active));
+    }
+
+    /// Gather entry \c k of the spot light parameters (cutoff, cos cutoff, cos beam, inv. transition)
+    Float gather_cutoff(const UInt32 &index, uint32_t k, Mask active) const {
+        return dr::gather<Float>(m_cutoff, index + k * m_count, active);
+    }
+
+    /// Linear falloff profile of the spot lights, see the 'spot' plugin
+    Float falloff_curve(const UInt32 &index, const Float &cos_theta,
+                        Mask active) const {
+        Float cutoff_angle     = gather_cutoff(index, 0, active),
+              cos_cutoff_angle = gather_cutoff(index, 1, active),
+              cos_beam_width   = gather_cutoff(index, 2, active),
+              inv_transition   = gather_cutoff(index, 3, active);
+
+        Float beam_res = dr::select(
+            cos_theta >= cos_beam_width, 1.f,
+            (cutoff_angle - dr::acos(cos_theta)) * inv_transition);
+
+        return dr::select(cos_theta > cos_cutoff_angle, beam_res, 0.f);
+    }
+
+    /// Radiant intensity emitted by light \c index into direction \c d
+    UnpolarizedSpectrum eval_intensity(const UInt32 &index,
+                                       const Wavelength &wavelengths,
+                                       const Vector3f &d, Mask active) const {
+        UnpolarizedSpectrum spec = color(index, wavelengths, active);
+
+        if (m_spot) {
+            Float falloff = falloff_curve(
+                index, dr::dot(Vector3f(gather_3(m_direction, index, active)), d), active);
+            spec *= falloff;
+        }
+
+        return spec;
+    }
+
+    /// Evaluate the (directionally uniform) intensity of light \c index
+    UnpolarizedSpectrum color(const UInt32 &index, const Wavelength &wavelengths,
+                              Mask active) const {
+        if constexpr (is_spectral_v<Spectrum>) {
+            Vector3f coeff(dr::gather<Float>(m_intensity, index, active),
+                           dr::gather<Float>(m_intensity, index + m_count, active),
+                           dr::gather<Float>(m_intensity, index + 2 * m_count, active));
+            SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+            si.wavelengths = wavelengths;
+            return srgb_model_eval<UnpolarizedSpectrum>(coeff, wavelengths) *
+                   m_d65->eval(si, active) *
+                   dr::gather<Float>(m_intensity_scale, index, active);
+        } else if constexpr (is_rgb_v<Spectrum>) {
+            DRJIT_MARK_USED(wavelengths);
+            return Color3f(dr::gather<Float>(m_intensity, index, active),
+                           dr::gather<Float>(m_intensity, index + m_count, active),
+                           dr::gather<Float>(m_intensity, index + 2 * m_count, active));
+        } else {
+            DRJIT_MARK_USED(wavelengths);
+            return dr::gather<Float>(m_intensity, index, active);
+        }
+    }
+
+    /// Sample the wavelengths emitted by light \c index and return the intensity weight
+    std::pair<Wavelength, UnpolarizedSpectrum>
+    sample_intensity(const UInt32 &index, Float sample, Mask active) const {
+        auto [wavelengths, weight] = sample_wavelengths(
+            dr::zeros<SurfaceInteraction3f>(), sample, active);
+
+        if constexpr (is_spectral_v<Spectrum>) {
+            // 'weight' accounts for the D65 illuminant, only multiply by the color
+            Vector3f coeff(dr::gather<Float>(m_intensity, index, active),
+                           dr::gather<Float>(m_intensity, index + m_count, active),
+                           dr::gather<Float>(m_intensity, index + 2 * m_count, active));
+            return { wavelengths,
+                     unpolarized_spectrum(weight) *
+                         srgb_model_eval<UnpolarizedSpectrum>(coeff, wavelengths) *
+                         dr::gather<Float>(m_intensity_scale, index, active) };
+        } else {
+            return { wavelengths, color(index, wavelengths, active) };
+        }
+    }
+
+private:
+    uint32_t m_count;
+    bool m_spot;
+    ScalarBoundingBox3f m_bbox;
+
+    FloatStorage m_position;
+    FloatStorage m_intensity;
+    FloatStorage m_intensity_scale;
+    FloatStorage m_direction;
+    FloatStorage m_cutoff;
+
+    ref<Texture> m_d65;
+    DiscreteDistribution<Float> m_distr;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(PointLightArray, Emitter)
+MI_EXPORT_PLUGIN(PointLightArray, "Point light array")
+NAMESPACE_END(mitsuba)
@@ -124,3 +124,16 @@ def test04_sample_direction(variants_vec_spectral, spectrum_key):
     assert dr.allclose(res, spec)
 
     assert dr.allclose(emitter.eval_direction(it, ds), spec)
+
+
+def test05_sample_position(variants_vec_rgb):
+    # Check the consistency of sample_position() and pdf_position()
+    shape, _ = create_emitter_and_spectrum()
+    emitter = shape.emitter()
+
+    samples = [[0.4, 0.5, 0.3], [0.1, 0.4, 0.9]]
+    ps, weight = emitter.sample_position(0.0, samples)
+
+    assert dr.allclose(ps.pdf, shape.pdf_position(ps))
+    assert dr.allclose(emitter.pdf_position(ps), ps.pdf)
+    assert dr.allclose(weight, dr.rcp(ps.pdf))
@@ -116,3 +116,88 @@ def test03_load_bitmap(variants_all_rgb):
     w2 = emitter_2.eval(si)
 
     assert dr.allclose(w1, w2, rtol=1e-3)
+
+
+def test04_shared_data(variants_vec_rgb):
+    tempdir = tempfile.TemporaryDirectory()
+    fname = os.path.join(tempdir.name, 'out.exr')
+    img = dr.zeros(mi.TensorXf, [20, 10, 3])
+    img[5, 3] = 1
+    img[12, 7] = 2
+    mi.Bitmap(img).write(fname)
+
+    # Both emitters share the data loaded from the file
+    emitter_1 = mi.load_dict({'type': 'envmap', 'filename': fname})
+    emitter_2 = mi.load_dict({'type': 'envmap', 'filename': fname})
+
+    si = dr.zeros(mi.SurfaceInteraction3f, 1000)
+    si.wi = -mi.warp.square_to_uniform_sphere(
+        mi.Point2f(dr.linspace(mi.Float, 0, 1, 1000),
+                   dr.linspace(mi.Float, 0.3, 0.6, 1000)))
+    ref = emitter_1.eval(si)
+    assert dr.allclose(emitter_2.eval(si), ref)
+
+    # Modifying one of them doesn't affect the other
+    params = mi.traverse(emitter_2)
+    params['data'] = dr.full(mi.TensorXf, 0.5, params['data'].shape)
+    params.update()
+    assert dr.allclose(emitter_2.eval(si), 0.5)
+    assert dr.allclose(emitter_1.eval(si), ref)
+
+
+def test05_product_sampling(variants_vec_rgb):
+    import numpy as np
+    tempdir = tempfile.TemporaryDirectory()
+    fname = os.path.join(tempdir.name, 'out.exr')
+
+    # Dim environment with a few bright regions, some of them below the horizon
+    rng = np.random.default_rng(0)
+    img = rng.uniform(0.02, 0.1, size=(32, 64, 3)).astype(np.float32)
+    img[4:6, 10:12] = 50
+    img[26:28, 40:42] = 100
+    mi.Bitmap(img).write(fname)
+
+    def load(product_sampling):
+        return mi.load_dict({
+            'type': 'envmap',
+            'filename': fname,
+            'product_sampling': product_sampling,
+            'to_world': mi.ScalarTransform4f.rotate([1, 0, 0], 30)
+        })
+
+    n = 1000000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    sample = sampler.next_2d()
+
+    si = dr.zeros(mi.SurfaceInteraction3f, n)
+    si.n = dr.normalize(mi.Vector3f(0.3, 1, 0.2))
+
+    def estimate(emitter):
+        ds, w = emitter.sample_direction(si, sample)
+
+        # The product density is discontinuous across cells, round-off
+        # errors may move a few of the directions to neighboring cells
+        pdf = np.array(emitter.pdf_direction(si, ds))
+        mismatch = np.abs(pdf - np.array(ds.pdf)) > 1e-3 * pdf
+        assert np.mean(mismatch) < 1e-3
+        assert dr.allclose(w * ds.pdf, emitter.eval_direction(si, ds), rtol=1e-3)
+
+        # Densities integrate to one over the sphere
+        assert np.allclose(np.mean(1.0 / np.array(ds.pdf)), 4 * np.pi, rtol=2e-2)
+
+        # Cosine-weighted irradiance (two-sided)
+        value = np.array(w[0] * dr.abs(dr.dot(ds.d, si.n)))
+        return np.mean(value), np.var(value)
+
+    mean, var = estimate(load(False))
+    mean_p, var_p = estimate(load(True))
+    assert np.allclose(mean_p, mean, rtol=2e-2)
+    assert var_p < var
+
+    # Reference points without normals use the default strategy
+    si.n = mi.Normal3f(0)
+    ds, _ = load(True).sample_direction(si, sample)
+    ds_ref, _ = load(False).sample_direction(si, sample)
+    assert dr.allclose(ds.d, ds_ref.d)
+    assert dr.allclose(ds.pdf, ds_ref.pdf)
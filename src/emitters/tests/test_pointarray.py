@@ -0,0 +1,124 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def write_lights(tmp_path, rows):
+    fname = str(tmp_path / 'lights.txt')
+    with open(fname, 'w') as f:
+        f.write('# x y z r g b [dx dy dz cutoff_angle beam_width]\n')
+        for row in rows:
+            f.write(' '.join(str(v) for v in row) + '\n')
+    return fname
+
+
+def test01_construct(variant_scalar_rgb, tmp_path):
+    fname = write_lights(tmp_path, [[0, 1, 0, 1, 1, 1], [2, 3, 4, 1, 0, 0]])
+    emitter = mi.load_dict({'type': 'pointarray', 'filename': fname})
+    assert emitter.is_delta_position()
+    assert dr.allclose(emitter.bbox().min, [0, 1, 0])
+    assert dr.allclose(emitter.bbox().max, [2, 3, 4])
+
+    params = mi.traverse(emitter)
+    assert dr.allclose(params['position'], [0, 2, 1, 3, 0, 4])
+
+    # Inconsistent number of columns
+    fname = write_lights(tmp_path, [[0, 1, 0, 1, 1, 1], [0, 1, 0, 1, 1, 1, 0, 0, 1, 20, 10]])
+    with pytest.raises(RuntimeError):
+        mi.load_dict({'type': 'pointarray', 'filename': fname})
+
+
+def test02_single_point_light(variants_vec_rgb, tmp_path):
+    # A single light behaves like the 'point' plugin
+    fname = write_lights(tmp_path, [[1, 2, 3, 0.5, 1.0, 2.0]])
+    emitter = mi.load_dict({'type': 'pointarray', 'filename': fname})
+    ref = mi.load_dict({
+        'type': 'point',
+        'position': [1, 2, 3],
+        'intensity': {'type': 'rgb', 'value': [0.5, 1.0, 2.0]}
+    })
+
+    it = dr.zeros(mi.SurfaceInteraction3f, 3)
+    it.p = [[0, -1, 5], [0, 0, 1], [0, 2, -3]]
+    sample = mi.Point2f(0.3, 0.6)
+
+    ds, spec = emitter.sample_direction(it, sample)
+    ds_ref, spec_ref = ref.sample_direction(it, sample)
+    assert dr.allclose(ds.p, ds_ref.p)
+    assert dr.allclose(ds.d, ds_ref.d)
+    assert dr.allclose(ds.dist, ds_ref.dist)
+    assert dr.allclose(ds.pdf, 1)
+    assert dr.allclose(spec, spec_ref)
+    assert dr.allclose(emitter.eval_direction(it, ds), spec_ref)
+
+
+def test03_spot_lights(variants_vec_rgb, tmp_path):
+    to_world = mi.ScalarTransform4f.look_at([0, 1, 0], [0, 0, 0], [1, 0, 0])
+    fname = write_lights(tmp_path, [[0, 1, 0, 2, 2, 2, 0, -1, 0, 40, 20]])
+    emitter = mi.load_dict({'type': 'pointarray', 'filename': fname})
+    ref = mi.load_dict({
+        'type': 'spot',
+        'cutoff_angle': 40,
+        'beam_width': 20,
+        'to_world': to_world,
+        'intensity': {'type': 'rgb', 'value': 2.0}
+    })
+
+    it = dr.zeros(mi.SurfaceInteraction3f, 4)
+    it.p = [[0, 0.1, 0.5, 2], [0, 0, 0, 0], [0, 0.2, 0.1, 0]]
+    ds, spec = emitter.sample_direction(it, mi.Point2f(0.5))
+    _, spec_ref = ref.sample_direction(it, mi.Point2f(0.5))
+    assert dr.allclose(spec, spec_ref)
+
+    # Rays are emitted within the cone and weighted consistently with 'spot'
+    sample = mi.Point2f(0.3, 0.8)
+    ray, weight = emitter.sample_ray(0, 0.5, sample, sample)
+    ray_ref, weight_ref = ref.sample_ray(0, 0.5, sample, sample)
+    assert dr.allclose(ray.o, ray_ref.o)
+    assert dr.allclose(dr.dot(ray.d, [0, -1, 0]), dr.dot(ray_ref.d, [0, -1, 0]))
+    assert dr.allclose(weight, weight_ref)
+
+
+def test04_importance_sampling(variants_vec_rgb, tmp_path):
+    rng = np.random.default_rng(0)
+    n = 100
+    pos = rng.uniform(-5, 5, size=(n, 3))
+    color = rng.uniform(0, 1, size=(n, 3)) * rng.uniform(0, 10, size=(n, 1))
+    fname = write_lights(tmp_path, np.hstack([pos, color]).tolist())
+    emitter = mi.load_dict({'type': 'pointarray', 'filename': fname})
+
+    # The expected value of the sampled contribution is the sum over all lights
+    p = np.array([0.3, 7.0, -0.2])
+    expected = np.sum(color / np.sum((pos - p)**2, axis=1)[:, None], axis=0)
+
+    m = 200000
+    it = dr.zeros(mi.SurfaceInteraction3f, m)
+    it.p = mi.Point3f(*p)
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, m)
+    _, spec = emitter.sample_direction(it, sampler.next_2d())
+    estimate = np.array([dr.mean(spec.x)[0], dr.mean(spec.y)[0], dr.mean(spec.z)[0]])
+    assert np.allclose(estimate, expected, rtol=2e-2)
+
+    # Lights are selected proportionally to their power
+    ds, _ = emitter.sample_direction(it, mi.Point2f(0.5, 0.5))
+    lum = 0.212671 * color[:, 0] + 0.715160 * color[:, 1] + 0.072169 * color[:, 2]
+    assert dr.allclose(ds.pdf, lum[np.array(ds.prim_index)[0]] / np.sum(lum), rtol=1e-4)
+
+
+def test05_spectral(variant_scalar_spectral, tmp_path):
+    fname = write_lights(tmp_path, [[1, 2, 3, 0.5, 1.0, 2.0]])
+    emitter = mi.load_dict({'type': 'pointarray', 'filename': fname})
+    ref = mi.load_dict({
+        'type': 'point',
+        'position': [1, 2, 3],
+        'intensity': {'type': 'rgb', 'value': [0.5, 1.0, 2.0]}
+    })
+
+    it = dr.zeros(mi.SurfaceInteraction3f)
+    it.p = [0, -1, 5]
+    it.wavelengths = [400, 500, 600, 700]
+    _, spec = emitter.sample_direction(it, mi.Point2f(0.5))
+    _, spec_ref = ref.sample_direction(it, mi.Point2f(0.5))
+    assert dr.allclose(spec, spec_ref, rtol=1e-4)
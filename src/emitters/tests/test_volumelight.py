@@ -0,0 +1,151 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def emission_grid(seed=0):
+    # Emission that is concentrated in a small region of the volume
+    rng = np.random.default_rng(seed)
+    data = np.zeros((6, 5, 4, 1), dtype=np.float32)
+    data[1:3, 2:4, 1:3] = rng.uniform(1.0, 4.0, size=(2, 2, 2, 1))
+    data[5, 0, 3] = 10.0
+    return data
+
+
+def create_emitter(data, cell_size=1):
+    return mi.load_dict({
+        'type': 'volumelight',
+        'cell_size': cell_size,
+        'emission': {
+            'type': 'gridvolume',
+            'grid': mi.VolumeGrid(mi.TensorXf(data)),
+            'filter_type': 'nearest',
+            'to_world': mi.ScalarTransform4f.translate([-1, 0, 2]).scale([2, 1, 3])
+        }
+    })
+
+
+def test01_create(variants_vec_rgb):
+    emitter = create_emitter(emission_grid())
+    assert emitter is not None
+    assert mi.has_flag(emitter.flags(), mi.EmitterFlags.Medium)
+
+    # The emitter is added to the scene through the medium of a shape
+    scene = mi.load_dict({
+        'type': 'scene',
+        'cube': {
+            'type': 'cube',
+            'bsdf': {'type': 'null'},
+            'interior': {
+                'type': 'homogeneous',
+                'albedo': 0.0,
+                'emitter': {'type': 'volumelight'}
+            }
+        }
+    })
+    emitters = scene.emitters()
+    assert len(emitters) == 1
+    assert mi.has_flag(emitters[0].flags(), mi.EmitterFlags.Medium)
+
+
+@pytest.mark.parametrize('cell_size', [1, 2])
+def test02_sample_direction(variants_vec_rgb, cell_size):
+    data = emission_grid()
+    emitter = create_emitter(data, cell_size)
+
+    n = 100000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+
+    it = dr.zeros(mi.Interaction3f, n)
+    it.p = mi.Point3f(0.5, -2.0, 1.0)
+    ds, weight = emitter.sample_direction(it, sampler.next_2d())
+
+    assert dr.all(ds.delta)
+    assert dr.allclose(emitter.pdf_direction(it, ds), ds.pdf, rtol=1e-3)
+    assert dr.allclose(weight * ds.pdf, emitter.eval_direction(it, ds), rtol=1e-3)
+
+    # Integrating the emission over the volume: weight * dist^2 estimates it
+    estimate = dr.mean(weight[0] * dr.sqr(ds.dist))
+    volume = 2 * 1 * 3
+    assert np.allclose(estimate, np.mean(data) * volume, rtol=2e-2)
+
+
+def test03_absorbing_slab(variants_vec_rgb):
+    # Camera rays through a purely absorbing, emissive cube gather the
+    # emission j / sigma_a * (1 - exp(-sigma_a * L)) at tentative collisions
+    sigma_t = 0.7
+    scene = mi.load_dict({
+        'type': 'scene',
+        'cube': {
+            'type': 'cube',
+            'bsdf': {'type': 'null'},
+            'interior': {
+                'type': 'homogeneous',
+                'albedo': 0.0,
+                'sigma_t': sigma_t,
+                'emitter': {
+                    'type': 'volumelight',
+                    'emission': {
+                        'type': 'constvolume',
+                        'value': 1.5,
+                        'to_world': mi.ScalarTransform4f.translate(-1).scale(2)
+                    }
+                }
+            }
+        }
+    })
+    integrator = mi.load_dict({'type': 'volpath', 'max_depth': 4})
+
+    n = 100000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    ray = mi.RayDifferential3f(mi.Point3f(0.2, 0.1, -5), mi.Vector3f(0, 0, 1))
+    result, _, _ = integrator.sample(scene, sampler, ray, None, True)
+
+    expected = 1.5 / sigma_t * (1 - np.exp(-sigma_t * 2))
+    assert np.allclose(dr.mean(result[0]), expected, rtol=2e-2)
+
+
+def test04_emitter_sampling(variants_vec_rgb):
+    # Scattering media render the same emission with and without emitter sampling
+    def render(sample_emitters):
+        scene = mi.load_dict({
+            'type': 'scene',
+            'sensor': {
+                'type': 'perspective',
+                'to_world': mi.ScalarTransform4f.look_at(
+                    origin=[0, 0, 4], target=[0, 0, 0], up=[0, 1, 0]),
+                'film': {'type': 'hdrfilm', 'width': 8, 'height': 8},
+                'sampler': {'type': 'independent', 'sample_count': 512}
+            },
+            'cube': {
+                'type': 'cube',
+                'bsdf': {'type': 'null'},
+                'interior': {
+                    'type': 'heterogeneous',
+                    'albedo': 0.8,
+                    'sigma_t': {
+                        'type': 'constvolume',
+                        'value': 2.0,
+                        'to_world': mi.ScalarTransform4f.translate(-1).scale(2)
+                    },
+                    'sample_emitters': sample_emitters,
+                    'emitter': {
+                        'type': 'volumelight',
+                        'emission': {
+                            'type': 'gridvolume',
+                            'grid': mi.VolumeGrid(mi.TensorXf(emission_grid())),
+                            'to_world': mi.ScalarTransform4f.translate(-1).scale(2)
+                        }
+                    }
+                }
+            }
+        })
+        integrator = mi.load_dict({'type': 'volpath', 'max_depth': 16})
+        return np.mean(np.array(mi.render(scene, integrator=integrator)))
+
+    reference = render(False)
+    assert reference > 0
+    assert np.allclose(render(True), reference, rtol=3e-2)
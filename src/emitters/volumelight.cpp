@@ -0,0 +1,333 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/texture.h>
+#include <mitsuba/render/volume.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _emitter-volumelight:
+
+Volume light (:monosp:`volumelight`)
+------------------------------------
+
+.. pluginparameters::
+
+ * - emission
+   - |float|, |spectrum| or |volume|
+   - Emission coefficient of the medium, i.e. the radiance that is emitted
+     per unit length along a ray, in units of radiance per scene unit. For
+     a medium with absorption coefficient :math:`\sigma_a` whose particles
+     emit the radiance :math:`L_e`, this is the product
+     :math:`\sigma_a L_e`. (Default: 1)
+   - |exposed|, |differentiable|
+
+ * - cell_size
+   - |int|
+   - Edge length (in voxels of the emission volume) of the cells of the
+     piecewise-constant distribution that is used to sample positions on the
+     emitter. (Default: 1)
+
+This plugin implements an isotropic emitter that fills a participating
+medium, e.g. to render fire or explosions. It must be nested into the
+medium, and is then added to the emitters of the scene along with the shapes
+whose interior or exterior medium it is. The emission volume should not
+extend beyond the region that is occupied by the medium.
+
+.. tabs::
+    .. code-tab:: xml
+
+        <medium type="heterogeneous" id="fire">
+            <volume name="sigma_t" type="gridvolume">
+                <string name="filename" value="density.vol"/>
+            </volume>
+            <emitter type="volumelight">
+                <volume name="emission" type="gridvolume">
+                    <string name="filename" value="emission.vol"/>
+                </volume>
+            </emitter>
+        </medium>
+
+    .. code-tab:: python
+
+        'fire': {
+            'type': 'heterogeneous',
+            'sigma_t': {
+                'type': 'gridvolume',
+                'filename': 'density.vol'
+            },
+            'emitter': {
+                'type': 'volumelight',
+                'emission': {
+                    'type': 'gridvolume',
+                    'filename': 'emission.vol'
+                }
+            }
+        }
+
+Direct illumination samples a cell of a coarse grid covering the emission
+volume proportionally to the largest emission within the cell, and then a
+position uniformly within the cell. The second dimension of the 2D sample
+provides two of the coordinates within the cell, which are hence quantized
+to 1/4096 of the cell size. The transmittance along the shadow ray towards
+that position is estimated by the integrator.
+
+The :ref:`volumetric path tracer <integrator-volpath>` furthermore gathers
+the emission at every tentative collision along the path (a collision
+estimator). The two techniques are not combined using multiple importance
+sampling, since volume emitters cannot be hit by rays. Instead, direction
+samples are marked as Dirac deltas, and the emission at collisions is only
+accounted for along paths whose previous vertex did not sample emitters
+(e.g. camera rays and paths through smooth dielectric boundaries).
+
+In spectral modes, the emission is multiplied by the D65 illuminant, so that
+RGB emission values reproduce their intended color.
+*/
+template <typename Float, typename Spectrum>
+class VolumeLight final : public Emitter<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Emitter, m_flags)
+    MI_IMPORT_TYPES(Texture, Volume)
+
+    /// The second sample dimension is split into this many positions along z
+    static constexpr uint32_t SubcellResolution = 4096;
+
+    VolumeLight(const Properties &props) : Base(props) {
+        m_emission = props.volume<Volume>("emission", 1.f);
+        m_cell_size = props.get<int>("cell_size", 1);
+        if (m_cell_size <= 0)
+            Throw("The cell size must be positive!");
+
+        m_d65 = Texture::D65(1.f);
+
+        m_flags = EmitterFlags::Medium | EmitterFlags::SpatiallyVarying;
+        dr::set_attr(this, "flags", m_flags);
+
+        update_distribution();
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_object("emission", m_emission.get(), +ParamFlags::Differentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        if (keys.empty() || string::contains(keys, "emission"))
+            update_distribution();
+        Base::parameters_changed(keys);
+    }
+
+    /// Rebuild the distribution of positions from the emission volume
+    void update_distribution() {
+        ScalarVector3i res = m_emission->resolution();
+        m_cells = dr::maximum((res + m_cell_size - 1) / m_cell_size, 1);
+        const size_t n_cells = (size_t) dr::prod(m_cells);
+
+        std::unique_ptr<ScalarFloat[]> weights(new ScalarFloat[n_cells]);
+        m_emission->max_per_cell(m_cells, weights.get());
+        m_distr = DiscreteDistribution<Float>(weights.get(), n_cells);
+
+        m_to_grid = ScalarTransform4f::scale(ScalarVector3f(m_cells)) *
+                    m_emission->to_local();
+        m_from_grid = m_to_grid.inverse();
+
+        ScalarFloat cell_volume =
+            dr::abs(dr::det(ScalarMatrix3f(m_from_grid.matrix)));
+        m_inv_cell_volume = dr::opaque<Float>(1.f / cell_volume);
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &pos_sample,
+                                          const Point2f &dir_sample,
+                                          Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Sample spatial component
+        auto [ps, pos_weight] = sample_position(time, pos_sample, active);
+
+        // 2. Sample spectral component
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        si.p = ps.p;
+        si.time = time;
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(si, wavelength_sample, active);
+
+        // 3. Sample directional component
+        Ray3f ray(ps.p, warp::square_to_uniform_sphere(dir_sample), time,
+                  wavelengths);
+
+        Spectrum weight = pos_weight * wav_weight * (4.f * dr::Pi<Float>);
+        return { ray, depolarizer<Spectrum>(weight) & active };
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f &sample,
+                     Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        auto [index, sample_x] = m_distr.sample_reuse(sample.x(), active);
+
+        DirectionSample3f ds;
+        ds.p       = sample_cell(index, sample_x, sample.y());
+        ds.n       = 0.f;
+        ds.uv      = 0.f;
+        ds.time    = it.time;
+        ds.delta   = true;
+        ds.emitter = this;
+        ds.d       = ds.p - it.p;
+
+        Float dist2 = dr::squared_norm(ds.d);
+        ds.dist = dr::sqrt(dist2);
+        ds.d /= ds.dist;
+
+        // Convert the density per unit volume to solid angle (times distance)
+        ds.pdf = m_distr.eval_pmf_normalized(index, active) *
+                 m_inv_cell_volume * dist2;
+        active &= ds.pdf > 0.f;
+        ds.pdf = dr::select(active, ds.pdf, 0.f);
+
+        UnpolarizedSpectrum spec =
+            eval_emission(ds.p, it.wavelengths, active) / ds.pdf;
+
+        return { ds, depolarizer<Spectrum>(spec) & active };
+    }
+
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
+                        Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return pdf_volume(ds.p, active) * dr::squared_norm(ds.p - it.p);
+    }
+
+    Spectrum eval_direction(const Interaction3f &it,
+                            const DirectionSample3f &ds,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return depolarizer<Spectrum>(
+            eval_emission(ds.p, it.wavelengths, active));
+    }
+
+    std::pair<PositionSample3f, Float>
+    sample_position(Float time, const Point2f &sample,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSamplePosition, active);
+
+        auto [index, sample_x] = m_distr.sample_reuse(sample.x(), active);
+
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+        ps.p     = sample_cell(index, sample_x, sample.y());
+        ps.time  = time;
+        ps.delta = false;
+        ps.pdf   = m_distr.eval_pmf_normalized(index, active) * m_inv_cell_volume;
+
+        return { ps, dr::select(ps.pdf > 0.f, dr::rcp(ps.pdf), 0.f) };
+    }
+
+    Float pdf_position(const PositionSample3f &ps,
+                       Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return pdf_volume(ps.p, active);
+    }
+
+    std::pair<Wavelength, Spectrum>
+    sample_wavelengths(const SurfaceInteraction3f &si, Float sample,
+                       Mask active) const override {
+        auto [wavelengths, weight] = m_d65->sample_spectrum(
+            si, math::sample_shifted<Wavelength>(sample), active);
+
+        return { wavelengths,
+                 weight * eval_emission(si.p, wavelengths, active, false) };
+    }
+
+    /// Returns the emission coefficient at the position \c si.p
+    Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return depolarizer<Spectrum>(
+            eval_emission(si.p, si.wavelengths, active));
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_emission->bbox(); }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "VolumeLight[" << std::endl
+            << "  emission = " << string::indent(m_emission) << "," << std::endl
+            << "  cells = " << m_cells << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Evaluate the emission coefficient at \c p
+    UnpolarizedSpectrum eval_emission(const Point3f &p,
+                                      const Wavelength &wavelengths,
+                                      Mask active,
+                                      bool include_whitepoint = true) const {
+        Interaction3f it = dr::zeros<Interaction3f>();
+        it.p = p;
+        it.wavelengths = wavelengths;
+        UnpolarizedSpectrum result = m_emission->eval(it, active);
+
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (include_whitepoint) {
+                SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+                si.wavelengths = wavelengths;
+                result *= m_d65->eval(si, active);
+            }
+        }
+
+        return result;
+    }
+
+    /// Map a cell index and two uniform samples to a position in that cell
+    Point3f sample_cell(UInt32 index, Float sample_x, Float sample_yz) const {
+        uint32_t n_x = (uint32_t) m_cells.x(),
+                 n_xy = (uint32_t) (m_cells.x() * m_cells.y());
+        UInt32 z = index / n_xy;
+        index -= z * n_xy;
+        UInt32 y = index / n_x,
+               x = index - y * n_x;
+
+        Float yz = sample_yz * (ScalarFloat) SubcellResolution,
+              z_offset = dr::floor(yz);
+
+        Point3f p(Float(x) + sample_x, Float(y) + (yz - z_offset),
+                  Float(z) + (z_offset + .5f) * (1.f / SubcellResolution));
+        return m_from_grid * p;
+    }
+
+    /// Return the density (per unit volume) of sampling the position \c p
+    Float pdf_volume(const Point3f &p, Mask active) const {
+        Point3f p_grid = m_to_grid * p;
+        active &= dr::all(p_grid >= 0.f && p_grid < ScalarPoint3f(m_cells));
+
+        Point3i cell = dr::clamp(dr::floor2int<Point3i>(p_grid), 0,
+                                 Point3i(m_cells - 1));
+        UInt32 index = UInt32(cell.x() + m_cells.x() *
+                              (cell.y() + m_cells.y() * cell.z()));
+
+        return dr::select(active,
+                          m_distr.eval_pmf_normalized(index, active) *
+                              m_inv_cell_volume,
+                          0.f);
+    }
+
+private:
+    ref<Volume> m_emission;
+    ref<Texture> m_d65;
+    int m_cell_size;
+
+    DiscreteDistribution<Float> m_distr;
+    ScalarVector3i m_cells;
+    /// Transformation from world space to cell coordinates in <tt>[0, cells]^3</tt>
+    ScalarTransform4f m_to_grid, m_from_grid;
+    Float m_inv_cell_volume;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(VolumeLight, Emitter)
+MI_EXPORT_PLUGIN(VolumeLight, "Volume emitter")
+NAMESPACE_END(mitsuba)
@@ -1,12 +1,15 @@
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/bitmapwriter.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/tiledwriter.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/imageblock.h>
 
+#include <memory>
 #include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -19,7 +22,7 @@ High dynamic range film (:monosp:`hdrfilm`)
 -------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 7
+ :extra-rows: 11
 
  * - width, height
    - |int|
@@ -43,6 +46,28 @@ High dynamic range film (:monosp:`hdrfilm`)
      The options are :monosp:`float16`, :monosp:`float32`, or :monosp:`uint32`.
      (Default: :monosp:`float16`)
 
+ * - channel_formats
+   - |string|
+   - Comma-separated list of :monosp:`<name>:<format>` pairs that override the
+     component format of individual channels of OpenEXR files, where
+     :monosp:`<name>` is either a channel name (e.g. :monosp:`dd.y`) or the
+     prefix of a group of channels (e.g. :monosp:`nn` for
+     :monosp:`nn.X`, :monosp:`nn.Y`, and :monosp:`nn.Z`), and :monosp:`<format>`
+     is :monosp:`float16`, :monosp:`float32`, or :monosp:`uint32`.
+     (Default: none)
+
+ * - compression
+   - |string|
+   - Compression method of OpenEXR files. The lossless options are
+     :monosp:`none`, :monosp:`rle`, :monosp:`zips`, :monosp:`zip`, and
+     :monosp:`piz`. The options :monosp:`pxr24`, :monosp:`b44`, :monosp:`b44a`,
+     :monosp:`dwaa`, and :monosp:`dwab` are lossy. (Default: :monosp:`piz`)
+
+ * - compression_level
+   - |int|
+   - Compression level of the :monosp:`dwaa` and :monosp:`dwab` methods, with
+     higher values corresponding to a lower quality. (Default: 45)
+
  * - crop_offset_x, crop_offset_y, crop_width, crop_height
    - |int|
    - These parameters can optionally be provided to select a sub-rectangle
@@ -64,6 +89,39 @@ High dynamic range film (:monosp:`hdrfilm`)
      in JIT variants and can make sample accumulation quite a bit more expensive.
      (Default: |false|, i.e. disabled)
 
+ * - sorted_splat
+   - |bool|
+   - If set to |true|, JIT variants accumulate the samples that a wavefront
+     renders into the same pixel with a segmented reduction and then update
+     every pixel once, instead of issuing one atomic addition per sample and
+     filter tap. This reduces atomic contention when rendering many samples per
+     pixel in each pass, at the cost of storing the wavefront's sample values
+     in memory. It only takes effect when the integrator generates pixel-major
+     wavefronts (e.g., :ref:`path <integrator-path>`). (Default: |false|, i.e. disabled)
+
+ * - stream_filename
+   - |string|
+   - When specified, the film does not keep the full image in memory. Instead,
+     every tile is developed and written to the given tiled OpenEXR file as
+     soon as all samples that can contribute to it have been splatted, and is
+     then released. This is only supported with :monosp:`file_format=openexr`
+     and single-pass, non-adaptive rendering, and the image cannot be accessed
+     via ``develop()`` or ``bitmap()``. (Default: unused)
+
+ * - stream_tile_size
+   - |int|
+   - Tile size of the file written when :monosp:`stream_filename` is
+     specified. (Default: 64)
+
+ * - tensor_layout
+   - |string|
+   - Memory layout of the image tensor returned by ``develop()`` (and thus
+     by ``mi.render()``): :monosp:`hwc` (height, width, channels) or
+     :monosp:`chw` (channels, height, width). The planar layout can be
+     passed as-is to machine learning frameworks expecting channel-first
+     images. This does not affect the files written to disk.
+     (Default: :monosp:`hwc`)
+
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -95,10 +153,27 @@ or XYZ(A) tristimulus bitmap having a :monosp:`float16`,
 The default configuration is RGB with a :monosp:`float16` component format, which is appropriate for
 most purposes.
 
+In JIT variants, the image tensor is developed on the device by a single
+kernel that also applies the :monosp:`tensor_layout`. In scalar variants, and
+when writing files, the weight normalization, the color conversion and the
+conversion to the component format are likewise fused into a single pass over
+the image. It can be shared with
+other frameworks without a copy (e.g. via DLPack using ``image.torch()``).
+
 For OpenEXR files, Mitsuba 3 also supports fully general multi-channel output; refer to
 the :ref:`aov <integrator-aov>` or :ref:`stokes <integrator-stokes>` plugins for
 details on how this works.
 
+The size of multi-channel files can be reduced considerably by storing each
+channel with the precision it requires, e.g. albedo and shading normals in
+half precision, and depth and positions in single precision (using the
+:monosp:`channel_formats` parameter), and by choosing a suitable compression
+method. The lossy :monosp:`dwaa` and :monosp:`dwab` methods only affect half
+precision channels: single precision channels are still stored losslessly. The
+:monosp:`compression` and :monosp:`channel_formats` parameters are ignored when
+the image is streamed to disk (see :monosp:`stream_filename`), in which case
+all channels use the PIZ compressor and the component format.
+
 The plugin can also write RLE-compressed files in the Radiance RGBE format pioneered by Greg Ward
 (set :monosp:`file_format=rgbe`), as well as the Portable Float Map format
 (set :monosp:`file_format=pfm`). In the former case, the :monosp:`component_format` and
@@ -224,7 +299,86 @@ public:
             }
         }
 
+        std::string compression = string::to_lower(
+            props.string("compression", "piz"));
+        if (compression == "none")
+            m_compression = Bitmap::EXRCompression::None;
+        else if (compression == "rle")
+            m_compression = Bitmap::EXRCompression::RLE;
+        else if (compression == "zips")
+            m_compression = Bitmap::EXRCompression::ZIPS;
+        else if (compression == "zip")
+            m_compression = Bitmap::EXRCompression::ZIP;
+        else if (compression == "piz")
+            m_compression = Bitmap::EXRCompression::PIZ;
+        else if (compression == "pxr24")
+            m_compression = Bitmap::EXRCompression::PXR24;
+        else if (compression == "b44")
+            m_compression = Bitmap::EXRCompression::B44;
+        else if (compression == "b44a")
+            m_compression = Bitmap::EXRCompression::B44A;
+        else if (compression == "dwaa")
+            m_compression = Bitmap::EXRCompression::DWAA;
+        else if (compression == "dwab")
+            m_compression = Bitmap::EXRCompression::DWAB;
+        else
+            Throw("The \"compression\" parameter must be equal to \"none\", "
+                  "\"rle\", \"zips\", \"zip\", \"piz\", \"pxr24\", \"b44\", "
+                  "\"b44a\", \"dwaa\", or \"dwab\". Found %s instead.",
+                  compression);
+
+        m_compression_level = props.get<int>("compression_level", 45);
+        if (m_compression_level <= 0)
+            Throw("The \"compression_level\" parameter must be positive!");
+
+        if (props.has_property("channel_formats")) {
+            for (const std::string &token :
+                 string::tokenize(props.string("channel_formats"), ", ")) {
+                std::vector<std::string> item = string::tokenize(token, ":");
+                if (item.size() != 2 || item[0].empty() || item[1].empty())
+                    Throw("Invalid channel format specification \"%s\": "
+                          "require <name>:<format> pair", token);
+
+                std::string format = string::to_lower(item[1]);
+                Struct::Type type;
+                if (format == "float16")
+                    type = Struct::Type::Float16;
+                else if (format == "float32")
+                    type = Struct::Type::Float32;
+                else if (format == "uint32")
+                    type = Struct::Type::UInt32;
+                else
+                    Throw("Invalid channel format \"%s\" for \"%s\": must "
+                          "be equal to \"float16\", \"float32\", or "
+                          "\"uint32\"!", item[1], item[0]);
+                m_channel_formats.emplace_back(item[0], type);
+            }
+        }
+
         m_compensate = props.get<bool>("compensate", false);
+        m_sorted_splat = props.get<bool>("sorted_splat", false);
+
+        if (props.has_property("stream_filename")) {
+            if (m_file_format != Bitmap::FileFormat::OpenEXR)
+                Throw("Streaming output (\"stream_filename\") requires "
+                      "file_format=\"openexr\"!");
+            m_stream_filename = props.string("stream_filename");
+            if (string::to_lower(m_stream_filename.extension().string()) != ".exr")
+                m_stream_filename.replace_extension(".exr");
+        }
+        m_stream_tile_size = props.get<uint32_t>("stream_tile_size", 64);
+        if (m_stream_tile_size == 0)
+            Throw("The \"stream_tile_size\" parameter must be positive!");
+
+        std::string tensor_layout = string::to_lower(
+            props.string("tensor_layout", "hwc"));
+        if (tensor_layout == "hwc")
+            m_planar = false;
+        else if (tensor_layout == "chw")
+            m_planar = true;
+        else
+            Throw("The \"tensor_layout\" parameter must either be equal to "
+                  "\"hwc\" or \"chw\". Found %s instead.", tensor_layout);
 
         props.mark_queried("banner"); // no banner in Mitsuba 3
     }
@@ -244,18 +398,31 @@ public:
         for (size_t i = 0; i < aovs.size(); ++i)
             channels[base_channels + i] = aovs[i];
 
+        std::vector<std::string> sorted = channels;
+        std::sort(sorted.begin(), sorted.end());
+        auto it = std::unique(sorted.begin(), sorted.end());
+        if (it != sorted.end())
+            Throw("Film::prepare(): duplicate channel name \"%s\"", *it);
+
         /* locked */ {
             std::lock_guard<std::mutex> lock(m_mutex);
-            m_storage = new ImageBlock(m_crop_size, m_crop_offset,
-                                       (uint32_t) channels.size());
             m_channels = channels;
+            if (streaming()) {
+                // Replacing the writer finalizes the output of a previous render
+                m_writer = nullptr;
+                m_writer = new TiledEXRWriter(
+                    m_stream_filename, m_crop_size, m_stream_tile_size,
+                    developed_channels(), m_component_format);
+                ScalarVector2u count = m_writer->tile_count();
+                m_tiles.clear();
+                m_tiles.resize((size_t) dr::prod(count));
+                m_stream_border = -1;
+            } else {
+                m_storage = new ImageBlock(m_crop_size, m_crop_offset,
+                                           (uint32_t) channels.size());
+            }
         }
 
-        std::sort(channels.begin(), channels.end());
-        auto it = std::unique(channels.begin(), channels.end());
-        if (it != channels.end())
-            Throw("Film::prepare(): duplicate channel name \"%s\"", *it);
-
         return m_channels.size();
     }
 
@@ -266,29 +433,48 @@ public:
 
         bool default_config = size == ScalarVector2u(0);
 
-        return new ImageBlock(default_config ? m_crop_size : size,
-                              default_config ? m_crop_offset : ScalarPoint2u(0),
-                              (uint32_t) m_channels.size(), m_filter.get(),
-                              border /* border */,
-                              normalize /* normalize */,
-                              dr::is_jit_v<Float> /* coalesce */,
-                              m_compensate /* compensate */,
-                              warn /* warn_negative */,
-                              warn /* warn_invalid */);
+        ref<ImageBlock> block = new ImageBlock(default_config ? m_crop_size : size,
+                                               default_config ? m_crop_offset : ScalarPoint2u(0),
+                                               (uint32_t) m_channels.size(), m_filter.get(),
+                                               border /* border */,
+                                               normalize /* normalize */,
+                                               dr::is_jit_v<Float> /* coalesce */,
+                                               m_compensate /* compensate */,
+                                               warn /* warn_negative */,
+                                               warn /* warn_invalid */);
+        block->set_sorted(m_sorted_splat);
+        return block;
     }
 
     void put_block(const ImageBlock *block) override {
+        if (streaming()) {
+            put_block_streaming(block);
+            return;
+        }
+
         Assert(m_storage != nullptr);
         std::lock_guard<std::mutex> lock(m_mutex);
         m_storage->put_block(block);
     }
 
     void clear() override {
+        if (streaming()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (StreamTile &tile : m_tiles) {
+                tile.data.reset();
+                tile.coverage = 0;
+            }
+        }
+
         if (m_storage)
             m_storage->clear();
     }
 
     TensorXf develop(bool raw = false) const override {
+        if (streaming())
+            Throw("HDRFilm::develop(): not supported when streaming the image "
+                  "to \"%s\"!", m_stream_filename.string());
+
         if (!m_storage)
             Throw("No storage allocated, was prepare() called first?");
 
@@ -332,13 +518,22 @@ public:
             // Number of channels of the target tensor
             uint32_t target_ch = color_ch + aovs + (uint32_t) alpha;
 
-            // Index vectors referencing pixels & channels of the output image
-            UInt32 idx         = dr::arange<UInt32>(pixel_count * target_ch),
-                   pixel_idx   = idx / target_ch,
-                   channel_idx = dr::fmadd(pixel_idx, uint32_t(-(int) target_ch), idx);
+            /* Index vectors referencing pixels & channels of the output image,
+               which is either interleaved (R1, G1, B1, R2, ..) or planar
+               (R1, R2, .., G1, G2, ..) */
+            UInt32 idx = dr::arange<UInt32>(pixel_count * target_ch),
+                   pixel_idx, channel_idx;
+            if (m_planar) {
+                channel_idx = idx / pixel_count;
+                pixel_idx   = dr::fmadd(channel_idx, uint32_t(-(int) pixel_count), idx);
+            } else {
+                pixel_idx   = idx / target_ch;
+                channel_idx = dr::fmadd(pixel_idx, uint32_t(-(int) target_ch), idx);
+            }
 
-            /* Index vectors referencing source pixels/weights as follows:
-                 values_idx = R1, G1, B1, R2, G2, B2 (for RGB output)
+            /* Index vectors referencing source pixels/weights as follows
+               (for RGB output and interleaved layout):
+                 values_idx = R1, G1, B1, R2, G2, B2
                  weight_idx = W1, W1, W1, W2, W2, W2 */
             UInt32 values_idx = dr::fmadd(pixel_idx, source_ch, channel_idx),
                    weight_idx = dr::fmadd(pixel_idx, source_ch, base_ch - 1);
@@ -364,23 +559,27 @@ public:
             Float weight = dr::gather<Float>(data, weight_idx),
                   values = dr::gather<Float>(data, values_idx, value_mask);
 
-            // Fill color channels with XYZ/Y data if requested
+            /* Compute the XYZ/Y color channels from the RGB values of their
+               pixel. Gathering them (rather than scattering the converted
+               colors) keeps the whole development in a single kernel. */
             if (to_xyz || to_y) {
-                UInt32 in_idx  = dr::arange<UInt32>(pixel_count) * source_ch,
-                       out_idx = dr::arange<UInt32>(pixel_count) * target_ch;
+                Mask color_mask = !value_mask;
+                UInt32 rgb_idx = pixel_idx * source_ch;
 
-                Color3f rgb = Color3f(dr::gather<Float>(data, in_idx),
-                                      dr::gather<Float>(data, in_idx + 1),
-                                      dr::gather<Float>(data, in_idx + 2));
+                Color3f rgb = Color3f(dr::gather<Float>(data, rgb_idx, color_mask),
+                                      dr::gather<Float>(data, rgb_idx + 1, color_mask),
+                                      dr::gather<Float>(data, rgb_idx + 2, color_mask));
 
+                Float color;
                 if (to_y) {
-                    dr::scatter(values, luminance(rgb), out_idx);
+                    color = luminance(rgb);
                 } else {
                     Color3f xyz = srgb_to_xyz(rgb);
-                    dr::scatter(values, xyz[0], out_idx);
-                    dr::scatter(values, xyz[1], out_idx + 1);
-                    dr::scatter(values, xyz[2], out_idx + 2);
+                    color = dr::select(dr::eq(channel_idx, 0u), xyz[0],
+                            dr::select(dr::eq(channel_idx, 1u), xyz[1], xyz[2]));
                 }
+
+                values = dr::select(color_mask, color, values);
             }
 
             // Perform the weight division unless the weight is zero
@@ -388,28 +587,145 @@ public:
 
             size_t shape[3] = { (size_t) size.y(), (size_t) size.x(),
                                 target_ch };
+            if (m_planar)
+                shape[0] = target_ch, shape[1] = (size_t) size.y(),
+                shape[2] = (size_t) size.x();
 
             return TensorXf(values, 3, shape);
         } else {
-            ref<Bitmap> source = bitmap();
-            ScalarVector2i size = source->size();
-            size_t width = source->channel_count() * dr::prod(size);
-            auto data = dr::load<DynamicBuffer<ScalarFloat>>(source->data(), width);
+            /* Normalize, convert and lay out the pixels in a single pass
+               that writes directly into the storage of the tensor */
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ScalarVector2u size = m_storage->size();
+            size_t channels = developed_channels().size(),
+                   pixels   = dr::prod(size);
+
+            DynamicBuffer<ScalarFloat> values =
+                dr::empty<DynamicBuffer<ScalarFloat>>(pixels * channels);
+            develop_pixels(m_storage->tensor().data(), pixels, values.data(),
+                           m_planar);
 
-            size_t shape[3] = { (size_t) source->height(),
-                                (size_t) source->width(),
-                                source->channel_count() };
+            size_t shape[3] = { (size_t) size.y(), (size_t) size.x(), channels };
+            if (m_planar)
+                shape[0] = channels, shape[1] = (size_t) size.y(),
+                shape[2] = (size_t) size.x();
 
-            return TensorXf(data, 3, shape);
+            return TensorXf(values, 3, shape);
         }
     }
 
     ref<Bitmap> bitmap(bool raw = false) const override {
+        if (streaming())
+            Throw("HDRFilm::bitmap(): not supported when streaming the image "
+                  "to \"%s\"!", m_stream_filename.string());
+
         if (!m_storage)
             Throw("No storage allocated, was prepare() called first?");
 
         std::lock_guard<std::mutex> lock(m_mutex);
-        auto &&storage = dr::migrate(m_storage->tensor().array(), AllocType::Host);
+        return bitmap_from(m_storage.get(), raw);
+    }
+
+    void write(const fs::path &path) const override {
+        if (streaming()) {
+            finish_streaming();
+            return;
+        }
+
+        write_bitmap(output_bitmap(), path);
+    }
+
+    void write_async(const fs::path &path) const override {
+        if (streaming()) {
+            finish_streaming();
+            return;
+        }
+
+        write_bitmap(output_bitmap(), path, true);
+    }
+
+    void write_snapshot(const fs::path &path) const override {
+        if (streaming())
+            Throw("HDRFilm::write_snapshot(): not supported when streaming "
+                  "the image to \"%s\"!", m_stream_filename.string());
+
+        // Only one snapshot can be developed at a time
+        std::lock_guard<std::mutex> snapshot_lock(m_snapshot_mutex);
+
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_storage)
+                Throw("No storage allocated, was prepare() called first?");
+
+            // Copy the storage into the back buffer, reusing it when possible
+            if (!m_snapshot || m_snapshot->size() != m_storage->size() ||
+                m_snapshot->channel_count() != m_storage->channel_count())
+                m_snapshot = new ImageBlock(m_storage->size(),
+                                            m_storage->offset(),
+                                            m_storage->channel_count());
+
+            if constexpr (dr::is_jit_v<Float>) {
+                m_snapshot->tensor() = m_storage->tensor();
+                dr::eval(m_snapshot->tensor());
+            } else {
+                std::memcpy(m_snapshot->tensor().data(),
+                            m_storage->tensor().data(),
+                            m_storage->tensor().size() * sizeof(ScalarFloat));
+            }
+        }
+
+        // Develop and write the snapshot while rendering continues
+        write_bitmap(bitmap_from(m_snapshot.get(), false, output_format()), path);
+    }
+
+    void schedule_storage() override {
+        if (m_storage)
+            dr::schedule(m_storage->tensor());
+    };
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "HDRFilm[" << std::endl
+            << "  size = " << m_size << "," << std::endl
+            << "  crop_size = " << m_crop_size << "," << std::endl
+            << "  crop_offset = " << m_crop_offset << "," << std::endl
+            << "  sample_border = " << m_sample_border << "," << std::endl
+            << "  compensate = " << m_compensate << "," << std::endl
+            << "  sorted_splat = " << m_sorted_splat << "," << std::endl
+            << "  filter = " << m_filter << "," << std::endl
+            << "  file_format = " << m_file_format << "," << std::endl
+            << "  pixel_format = " << m_pixel_format << "," << std::endl
+            << "  component_format = " << m_component_format << "," << std::endl
+            << "  tensor_layout = " << (m_planar ? "chw" : "hwc") << "," << std::endl;
+        if (m_file_format == Bitmap::FileFormat::OpenEXR) {
+            oss << "  compression = " << m_compression << "," << std::endl;
+            if (!m_channel_formats.empty()) {
+                oss << "  channel_formats = [";
+                for (size_t i = 0; i < m_channel_formats.size(); ++i)
+                    oss << (i > 0 ? ", " : "") << m_channel_formats[i].first
+                        << ":" << m_channel_formats[i].second;
+                oss << "]," << std::endl;
+            }
+        }
+        if (streaming())
+            oss << "  stream_filename = \"" << m_stream_filename.string() << "\"," << std::endl
+                << "  stream_tile_size = " << m_stream_tile_size << "," << std::endl;
+        oss << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+protected:
+    /**
+     * \brief Develop an image block with the film's layout into a bitmap
+     *
+     * Unless \c raw is set, the channels are normalized, converted to the
+     * pixel format and stored with the component type \c format in a single
+     * pass over the image (see \ref develop_pixels()).
+     */
+    ref<Bitmap> bitmap_from(const ImageBlock *block, bool raw,
+                            Struct::Type format = struct_type_v<ScalarFloat>) const {
+        auto &&storage = dr::migrate(block->tensor().array(), AllocType::Host);
 
         if constexpr (dr::is_jit_v<Float>)
             dr::sync_thread();
@@ -418,119 +734,141 @@ public:
         uint32_t base_ch = alpha ? 5 : 4;
         bool has_aovs  = m_channels.size() != base_ch;
 
-        Bitmap::PixelFormat source_fmt = !has_aovs
-                                     ? (alpha ? Bitmap::PixelFormat::RGBAW
-                                              : Bitmap::PixelFormat::RGBW)
-                                     : Bitmap::PixelFormat::MultiChannel;
+        if (raw) {
+            Bitmap::PixelFormat source_fmt = !has_aovs
+                                         ? (alpha ? Bitmap::PixelFormat::RGBAW
+                                                  : Bitmap::PixelFormat::RGBW)
+                                         : Bitmap::PixelFormat::MultiChannel;
+
+            return new Bitmap(source_fmt, struct_type_v<ScalarFloat>,
+                              block->size(), block->channel_count(),
+                              m_channels, (uint8_t *) storage.data());
+        }
 
-        ref<Bitmap> source = new Bitmap(
-            source_fmt, struct_type_v<ScalarFloat>, m_storage->size(),
-            m_storage->channel_count(), m_channels, (uint8_t *) storage.data());
+        // Integer outputs are converted by the Bitmap class
+        bool fused = format == Struct::Type::Float16 ||
+                     format == Struct::Type::Float32 ||
+                     format == Struct::Type::Float64;
+        Struct::Type develop_format = fused ? format : struct_type_v<ScalarFloat>;
 
-        if (raw)
-            return source;
+        std::vector<std::string> channels = developed_channels();
+        ref<Bitmap> target = new Bitmap(
+            has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
+            develop_format, block->size(), channels.size(),
+            has_aovs ? channels : std::vector<std::string>());
+
+        size_t pixels = dr::prod(block->size());
+        const ScalarFloat *data = storage.data();
+        switch (develop_format) {
+            case Struct::Type::Float16:
+                develop_pixels(data, pixels, (dr::half *) target->data(), false);
+                break;
+
+            case Struct::Type::Float32:
+                develop_pixels(data, pixels, (float *) target->data(), false);
+                break;
+
+            default:
+                develop_pixels(data, pixels, (double *) target->data(), false);
+                break;
+        }
 
-        bool to_rgb    = m_pixel_format == Bitmap::PixelFormat::RGB ||
-                         m_pixel_format == Bitmap::PixelFormat::RGBA;
-        bool to_xyz    = m_pixel_format == Bitmap::PixelFormat::XYZ ||
-                         m_pixel_format == Bitmap::PixelFormat::XYZA;
-        bool to_y      = m_pixel_format == Bitmap::PixelFormat::Y ||
-                         m_pixel_format == Bitmap::PixelFormat::YA;
+        if (develop_format != format) {
+            ref<Bitmap> converted = new Bitmap(
+                target->pixel_format(), format, target->size(),
+                target->channel_count(),
+                has_aovs ? channels : std::vector<std::string>());
+            target->convert(converted);
+            target = converted;
+        }
 
-        uint32_t img_ch = to_y ? 1 : 3;
-        uint32_t aovs_channel = has_aovs ? (img_ch + (uint32_t) alpha) : 0;
-        uint32_t target_ch =
-            (uint32_t) m_storage->channel_count() - base_ch + aovs_channel;
+        return target;
+    }
 
-        ref<Bitmap> target = new Bitmap(
-            has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
-            struct_type_v<ScalarFloat>, m_storage->size(),
-            has_aovs ? target_ch : 0);
-
-        if (has_aovs) {
-            source->struct_()->operator[](base_ch - 1).flags |=
-                +Struct::Flags::Weight;
-
-            for (size_t i = 0; i < target_ch; ++i) {
-                Struct::Field &dest_field = target->struct_()->operator[](i);
-
-                switch (i) {
-                    case 0:
-                        if (to_rgb) {
-                            dest_field.name = "R";
-                            break;
-                        } else if (to_xyz) {
-                            dest_field.name = "X";
-                            dest_field.blend = {
-                                { 0.412453f, "R" },
-                                { 0.357580f, "G" },
-                                { 0.180423f, "B" }
-                            };
-                            break;
-                        } else if (to_y) {
-                            dest_field.name = "Y";
-                            dest_field.blend = {
-                                { 0.212671f, "R" },
-                                { 0.715160f, "G" },
-                                { 0.072169f, "B" }
-                            };
-                            break;
-                        }
-                        [[fallthrough]];
-
-                    case 1:
-                        if (to_rgb) {
-                            dest_field.name = "G";
-                            break;
-                        } else if (to_xyz) {
-                            dest_field.name = "Y";
-                            dest_field.blend = {
-                                { 0.212671f, "R" },
-                                { 0.715160f, "G" },
-                                { 0.072169f, "B" }
-                            };
-                            break;
-                        } else if (to_y && alpha) {
-                            dest_field.name = "A";
-                            break;
-                        }
-                        [[fallthrough]];
-
-                    case 2:
-                        if (to_rgb) {
-                            dest_field.name = "B";
-                            break;
-                        } else if (to_xyz) {
-                            dest_field.name = "Z";
-                            dest_field.blend = {
-                                { 0.019334f, "R" },
-                                { 0.119193f, "G" },
-                                { 0.950227f, "B" }
-                            };
-                            break;
-                        }
-                        [[fallthrough]];
-
-                    case 3:
-                        if ((to_rgb || to_xyz) && alpha) {
-                            dest_field.name = "A";
-                            break;
-                        }
-                        [[fallthrough]];
-
-                    default:
-                        dest_field.name = m_channels[base_ch + i - aovs_channel];
-                        break;
+    /**
+     * \brief Normalize the accumulated channels of \c pixel_count pixels and
+     * convert them to the pixel format of the film
+     *
+     * The output is interleaved, or channel-first when \c planar is set.
+     */
+    template <typename T>
+    void develop_pixels(const ScalarFloat *data, size_t pixel_count, T *out,
+                        bool planar) const {
+        bool alpha  = has_flag(m_flags, FilmFlags::Alpha);
+        bool to_xyz = m_pixel_format == Bitmap::PixelFormat::XYZ ||
+                      m_pixel_format == Bitmap::PixelFormat::XYZA;
+        bool to_y   = m_pixel_format == Bitmap::PixelFormat::Y ||
+                      m_pixel_format == Bitmap::PixelFormat::YA;
+
+        uint32_t source_ch = (uint32_t) m_channels.size(),
+                 base_ch   = alpha ? 5 : 4,
+                 aovs      = source_ch - base_ch,
+                 color_ch  = to_y ? 1 : 3,
+                 target_ch = color_ch + (uint32_t) alpha + aovs;
+
+        size_t pixel_stride   = planar ? 1 : target_ch,
+               channel_stride = planar ? pixel_count : 1;
+
+        for (size_t i = 0; i < pixel_count; ++i) {
+            const ScalarFloat *in = data + i * source_ch;
+            T *o = out + i * pixel_stride;
+
+            ScalarFloat weight = in[base_ch - 1],
+                        inv_weight = weight == 0.f ? 1.f : 1.f / weight;
+
+            ScalarColor3f rgb(in[0], in[1], in[2]);
+            rgb *= inv_weight;
+
+            if (to_y) {
+                *o = (T) luminance(rgb);
+                o += channel_stride;
+            } else {
+                ScalarColor3f value = to_xyz ? srgb_to_xyz(rgb) : rgb;
+                for (uint32_t j = 0; j < 3; ++j) {
+                    *o = (T) value[j];
+                    o += channel_stride;
                 }
             }
+
+            if (alpha) {
+                *o = (T) (in[3] * inv_weight);
+                o += channel_stride;
+            }
+
+            for (uint32_t j = 0; j < aovs; ++j) {
+                *o = (T) (in[base_ch + j] * inv_weight);
+                o += channel_stride;
+            }
         }
+    }
 
-        source->convert(target);
+    /// Component type of the bitmaps developed for \ref write_bitmap()
+    Struct::Type output_format() const {
+        /* When some channels are stored with a higher precision than the
+           component format, keep the samples in single precision and let
+           OpenEXR convert the remaining channels while writing */
+        if (m_file_format == Bitmap::FileFormat::OpenEXR &&
+            !m_channel_formats.empty())
+            return Struct::Type::Float32;
+        return m_component_format;
+    }
 
-        return target;
+    /// Develop the image directly into the component format of the output file
+    ref<Bitmap> output_bitmap() const {
+        if (!m_storage)
+            Throw("No storage allocated, was prepare() called first?");
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return bitmap_from(m_storage.get(), false, output_format());
     }
 
-    void write(const fs::path &path) const override {
+    /**
+     * Write a developed bitmap (converting it to the component format if
+     * needed), or submit it to the global \ref BitmapWriter when \c async
+     * is set. The output settings of the file are stored in \c source.
+     */
+    void write_bitmap(Bitmap *source, const fs::path &path,
+                      bool async = false) const {
         fs::path filename = path;
         std::string proper_extension;
         if (m_file_format == Bitmap::FileFormat::OpenEXR)
@@ -550,56 +888,271 @@ public:
             Log(Info, "Developing \"%s\" ..", filename.string());
         #endif
 
-        ref<Bitmap> source = bitmap();
-        if (m_component_format != struct_type_v<ScalarFloat>) {
+        bool exr = m_file_format == Bitmap::FileFormat::OpenEXR;
+
+        ref<Bitmap> target = source;
+        Struct::Type component_format = output_format();
+        if (component_format != source->component_format()) {
             // Mismatch between the current format and the one expected by the film
             // Conversion is necessary before saving to disk
             std::vector<std::string> channel_names;
             for (size_t i = 0; i < source->channel_count(); i++)
                 channel_names.push_back(source->struct_()->operator[](i).name);
-            ref<Bitmap> target = new Bitmap(
+            target = new Bitmap(
                 source->pixel_format(),
-                m_component_format,
+                component_format,
                 source->size(),
                 source->channel_count(),
                 channel_names);
             source->convert(target);
+        }
 
-            target->write(filename, m_file_format);
-        } else {
-            source->write(filename, m_file_format);
+        if (exr) {
+            target->set_exr_compression(m_compression);
+            for (const Struct::Field &field : *target->struct_()) {
+                Struct::Type type = m_component_format;
+                for (const auto &[name, format] : m_channel_formats) {
+                    if (field.name == name ||
+                        string::starts_with(field.name, name + "."))
+                        type = format;
+                }
+                if (type != field.type)
+                    target->set_exr_channel_format(field.name, type);
+            }
         }
+
+        int quality = exr ? m_compression_level : -1;
+
+        if (async)
+            BitmapWriter::instance()->write(target, filename, m_file_format, quality);
+        else
+            target->write(filename, m_file_format, quality);
     }
 
-    void schedule_storage() override {
-        dr::schedule(m_storage->tensor());
-    };
+    /// Is the image streamed to a tiled OpenEXR file?
+    bool streaming() const { return !m_stream_filename.empty(); }
 
-    std::string to_string() const override {
-        std::ostringstream oss;
-        oss << "HDRFilm[" << std::endl
-            << "  size = " << m_size << "," << std::endl
-            << "  crop_size = " << m_crop_size << "," << std::endl
-            << "  crop_offset = " << m_crop_offset << "," << std::endl
-            << "  sample_border = " << m_sample_border << "," << std::endl
-            << "  compensate = " << m_compensate << "," << std::endl
-            << "  filter = " << m_filter << "," << std::endl
-            << "  file_format = " << m_file_format << "," << std::endl
-            << "  pixel_format = " << m_pixel_format << "," << std::endl
-            << "  component_format = " << m_component_format << "," << std::endl
-            << "]";
-        return oss.str();
+    /// Names of the channels of developed images
+    std::vector<std::string> developed_channels() const {
+        bool alpha = has_flag(m_flags, FilmFlags::Alpha);
+        uint32_t base_ch = alpha ? 5 : 4;
+        std::vector<std::string> result;
+
+        if (m_pixel_format == Bitmap::PixelFormat::Y ||
+            m_pixel_format == Bitmap::PixelFormat::YA)
+            result = { "Y" };
+        else if (m_pixel_format == Bitmap::PixelFormat::XYZ ||
+                 m_pixel_format == Bitmap::PixelFormat::XYZA)
+            result = { "X", "Y", "Z" };
+        else
+            result = { "R", "G", "B" };
+
+        if (alpha)
+            result.push_back("A");
+
+        for (size_t i = base_ch; i < m_channels.size(); ++i)
+            result.push_back(m_channels[i]);
+
+        return result;
+    }
+
+    /**
+     * \brief Sum of the number of pixels of the interval <tt>[r0, r1)</tt>
+     * within distance \c b of each pixel of the interval <tt>[t0, t1)</tt>
+     *
+     * A splat at a pixel of the block region can affect all pixels within
+     * the filter border of it. Summing this separable quantity over all
+     * blocks that reach a tile tells when it cannot receive further samples.
+     */
+    static uint64_t overlap_sum(int32_t t0, int32_t t1, int32_t r0,
+                                int32_t r1, int32_t b) {
+        uint64_t sum = 0;
+        for (int32_t q = t0; q < t1; ++q) {
+            int32_t lo = std::max(q - b, r0), hi = std::min(q + b + 1, r1);
+            if (hi > lo)
+                sum += (uint64_t) (hi - lo);
+        }
+        return sum;
+    }
+
+    /// Accumulate a block into the tiles of the streamed image
+    void put_block_streaming(const ImageBlock *block) {
+        if (unlikely(block->channel_count() != m_channels.size()))
+            Throw("HDRFilm::put_block(): mismatched channel counts! (%u, "
+                  "expected %u)", block->channel_count(), m_channels.size());
+
+        auto &&storage = dr::migrate(block->tensor().array(), AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const ScalarFloat *src = storage.data();
+
+        uint32_t channels = block->channel_count(),
+                 tile_size = m_stream_tile_size;
+        int32_t border = (int32_t) block->border_size();
+        ScalarVector2i crop_size(m_crop_size);
+
+        // Base region of the block and the region it splats into (relative to the crop)
+        ScalarPoint2i r0 = ScalarPoint2i(block->offset()) - ScalarPoint2i(m_crop_offset),
+                      r1 = r0 + ScalarVector2i(block->size()),
+                      s0 = r0 - border,
+                      s1 = r1 + border;
+        int32_t src_width = (int32_t) block->size().x() + 2 * border;
+
+        ScalarPoint2i lo = dr::maximum(s0, 0),
+                      hi = dr::minimum(s1, crop_size);
+        if (dr::any(lo >= hi))
+            return;
+
+        std::vector<std::pair<ScalarPoint2u, std::unique_ptr<ScalarFloat[]>>> finished;
+
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stream_border < 0)
+                m_stream_border = border;
+
+            ScalarVector2u count = m_writer->tile_count();
+            ScalarPoint2u tile_lo = ScalarPoint2u(lo) / tile_size,
+                          tile_hi = ScalarPoint2u(hi - 1) / tile_size;
+
+            for (uint32_t ty = tile_lo.y(); ty <= tile_hi.y(); ++ty) {
+                for (uint32_t tx = tile_lo.x(); tx <= tile_hi.x(); ++tx) {
+                    StreamTile &tile = m_tiles[(size_t) ty * count.x() + tx];
+                    if (tile.written)
+                        Throw("HDRFilm::put_block(): tile (%u, %u) of \"%s\" "
+                              "was already written. Streaming output only "
+                              "supports single-pass, non-adaptive rendering!",
+                              tx, ty, m_stream_filename.string());
+
+                    ScalarVector2u extent = m_writer->tile_extent(tx, ty);
+                    ScalarPoint2i t0 = ScalarPoint2i(ScalarPoint2u(tx, ty) * tile_size),
+                                  t1 = t0 + ScalarVector2i(extent);
+
+                    if (!tile.data) {
+                        size_t size = (size_t) dr::prod(extent) * channels;
+                        tile.data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size]);
+                        std::fill(tile.data.get(), tile.data.get() + size,
+                                  ScalarFloat(0));
+                    }
+
+                    ScalarPoint2i a = dr::maximum(lo, t0),
+                                  b = dr::minimum(hi, t1);
+                    for (int32_t y = a.y(); y < b.y(); ++y) {
+                        const ScalarFloat *src_row =
+                            src + ((size_t) (y - s0.y()) * src_width +
+                                   (a.x() - s0.x())) * channels;
+                        ScalarFloat *dst_row =
+                            tile.data.get() +
+                            ((size_t) (y - t0.y()) * extent.x() +
+                             (a.x() - t0.x())) * channels;
+                        for (size_t i = 0; i < (size_t) (b.x() - a.x()) * channels; ++i)
+                            dst_row[i] += src_row[i];
+                    }
+
+                    tile.coverage +=
+                        overlap_sum(t0.x(), t1.x(), r0.x(), r1.x(), border) *
+                        overlap_sum(t0.y(), t1.y(), r0.y(), r1.y(), border);
+
+                    if (tile.coverage >= expected_coverage(t0, t1)) {
+                        tile.written = true;
+                        finished.emplace_back(ScalarPoint2u(tx, ty),
+                                              std::move(tile.data));
+                    }
+                }
+            }
+        }
+
+        // Develop and write completed tiles without holding the lock
+        for (auto &[index, data] : finished)
+            write_stream_tile(index.x(), index.y(), data.get());
+    }
+
+    /// Coverage (see \ref overlap_sum()) of a tile once all blocks were splatted
+    uint64_t expected_coverage(const ScalarPoint2i &t0, const ScalarPoint2i &t1) const {
+        int32_t border = std::max(m_stream_border, 0),
+                margin = m_sample_border ? border : 0;
+        ScalarVector2i crop_size(m_crop_size);
+        return overlap_sum(t0.x(), t1.x(), -margin, crop_size.x() + margin, border) *
+               overlap_sum(t0.y(), t1.y(), -margin, crop_size.y() + margin, border);
+    }
+
+    /// Normalize the accumulated channels of a tile and write it to the file
+    void write_stream_tile(uint32_t tx, uint32_t ty, const ScalarFloat *data) const {
+        ScalarVector2u extent = m_writer->tile_extent(tx, ty);
+        size_t pixel_count = (size_t) dr::prod(extent);
+        std::unique_ptr<float[]> out(
+            new float[pixel_count * developed_channels().size()]);
+
+        develop_pixels(data, pixel_count, out.get(), false);
+
+        m_writer->write_tile(tx, ty, out.get());
+    }
+
+    /// Write the tiles that are still pending and close the streamed file
+    void finish_streaming() const {
+        if (!m_writer)
+            Throw("No output file opened, was prepare() called first?");
+
+        std::vector<std::pair<ScalarPoint2u, std::unique_ptr<ScalarFloat[]>>> pending;
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ScalarVector2u count = m_writer->tile_count();
+            for (uint32_t ty = 0; ty < count.y(); ++ty) {
+                for (uint32_t tx = 0; tx < count.x(); ++tx) {
+                    StreamTile &tile = m_tiles[(size_t) ty * count.x() + tx];
+                    if (tile.written || !tile.data)
+                        continue;
+                    tile.written = true;
+                    pending.emplace_back(ScalarPoint2u(tx, ty), std::move(tile.data));
+                }
+            }
+        }
+
+        for (auto &[index, data] : pending)
+            write_stream_tile(index.x(), index.y(), data.get());
+
+        // Tiles that never received any samples are filled with zeros here
+        m_writer->close();
+
+        #if !defined(_WIN32)
+            Log(Info, "\U00002714  Streamed \"%s\"", m_stream_filename.string());
+        #else
+            Log(Info, "Streamed \"%s\"", m_stream_filename.string());
+        #endif
     }
 
-    MI_DECLARE_CLASS()
 protected:
+    /// Accumulated pixels of a tile of the streamed image
+    struct StreamTile {
+        std::unique_ptr<ScalarFloat[]> data;
+        uint64_t coverage = 0;
+        bool written = false;
+    };
+
     Bitmap::FileFormat m_file_format;
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
+    Bitmap::EXRCompression m_compression;
+    int m_compression_level;
+    /// Per-channel overrides of the component format (OpenEXR only)
+    std::vector<std::pair<std::string, Struct::Type>> m_channel_formats;
     bool m_compensate;
+    bool m_sorted_splat;
+    /// Does develop() return a channel-first (CHW) tensor?
+    bool m_planar;
     ref<ImageBlock> m_storage;
     mutable std::mutex m_mutex;
     std::vector<std::string> m_channels;
+
+    /// Back buffer used by \ref write_snapshot()
+    mutable ref<ImageBlock> m_snapshot;
+    mutable std::mutex m_snapshot_mutex;
+
+    /// Streaming output (written from const methods like \ref write())
+    fs::path m_stream_filename;
+    uint32_t m_stream_tile_size;
+    mutable ref<TiledEXRWriter> m_writer;
+    mutable std::vector<StreamTile> m_tiles;
+    int32_t m_stream_border = -1;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
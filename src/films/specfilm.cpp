@@ -1,4 +1,5 @@
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/bitmapwriter.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/spectrum.h>
@@ -21,7 +22,7 @@ Spectral film (:monosp:`specfilm`)
 ----------------------------------
 
 .. pluginparameters::
- :extra-rows: 6
+ :extra-rows: 8
 
  * - width, height
    - |int|
@@ -53,6 +54,24 @@ Spectral film (:monosp:`specfilm`)
      in JIT variants and can make sample accumulation quite a bit more expensive.
      (Default: |false|, i.e. disabled)
 
+ * - sorted_splat
+   - |bool|
+   - If set to |true|, JIT variants accumulate the samples that a wavefront
+     renders into the same pixel with a segmented reduction and then update
+     every pixel once, instead of issuing one atomic addition per sample and
+     filter tap. This reduces atomic contention when rendering many samples per
+     pixel in each pass, at the cost of storing the wavefront's sample values
+     in memory. It only takes effect when the integrator generates pixel-major
+     wavefronts (e.g., :ref:`path <integrator-path>`). (Default: |false|, i.e. disabled)
+
+ * - sparse_bands
+   - |bool|
+   - If set to |true|, the SRFs are tabulated on the film's sampling grid together with the (at
+     most two) bands that are nonzero at each wavelength. Every wavelength sample is then only
+     weighted by the bands it actually falls in instead of evaluating all SRFs, which is much
+     cheaper for hyperspectral films with many narrow bands. This requires that no more than two
+     SRFs overlap at any wavelength. (Default: |false|, i.e. disabled)
+
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -148,6 +167,7 @@ public:
                    m_filter, m_flags, m_srf, set_crop_window)
     MI_IMPORT_TYPES(ImageBlock, Texture)
     using FloatStorage = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
 
     SpecFilm(const Properties &props) : Base(props) {
         if constexpr (!is_spectral_v<Spectrum>)
@@ -186,6 +206,8 @@ public:
                   " Found %s instead.", component_format);
 
         m_compensate = props.get<bool>("compensate", false);
+        m_sorted_splat = props.get<bool>("sorted_splat", false);
+        m_sparse_bands = props.get<bool>("sparse_bands", false);
 
         m_flags = FilmFlags::Spectral | FilmFlags::Special;
 
@@ -237,6 +259,59 @@ public:
         props.set_float("wavelength_min", (double) m_range.x());
         props.set_float("wavelength_max", (double) m_range.y());
         m_srf = PluginManager::instance()->create_object<Texture>(props);
+
+        if (m_sparse_bands)
+            compute_band_table(n_points);
+    }
+
+    /// Evaluate an SRF at the points of a regular grid spanning \c m_range
+    FloatStorage eval_grid(const Texture *srf, size_t n_points) const {
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        if constexpr (dr::is_jit_v<Float>) {
+            si.wavelengths = dr::linspace<Float>(m_range.x(), m_range.y(), n_points);
+            return srf->eval(si).x();
+        } else {
+            std::vector<ScalarFloat> values(n_points);
+            ScalarFloat step = (m_range.y() - m_range.x()) /
+                               (ScalarFloat) std::max(n_points - 1, (size_t) 1);
+            for (size_t i = 0; i < n_points; ++i) {
+                si.wavelengths = dr::fmadd((ScalarFloat) i, step, m_range.x());
+                values[i] = srf->eval(si).x();
+            }
+            return dr::load<FloatStorage>(values.data(), n_points);
+        }
+    }
+
+    /// Tabulate the (at most two) bands that are nonzero at each point of the sampling grid
+    void compute_band_table(size_t n_points) {
+        uint32_t n_bands = (uint32_t) m_srfs.size();
+        std::vector<uint32_t> band_index(2 * n_points, n_bands);
+        std::vector<ScalarFloat> band_weight(2 * n_points, 0.f);
+
+        for (uint32_t j = 0; j < n_bands; ++j) {
+            auto &&values = dr::migrate(eval_grid(m_srfs[j].get(), n_points),
+                                        AllocType::Host);
+            if constexpr (dr::is_jit_v<Float>)
+                dr::sync_thread();
+            const ScalarFloat *ptr = values.data();
+
+            for (size_t i = 0; i < n_points; ++i) {
+                if (ptr[i] == 0.f)
+                    continue;
+                size_t slot = 2 * i + (band_index[2 * i] == n_bands ? 0 : 1);
+                if (band_index[slot] != n_bands)
+                    Throw("SpecFilm: \"sparse_bands\" requires that at most two "
+                          "SRFs overlap at any wavelength, but more overlap at "
+                          "%f nm!", (double) (m_range.x() + (m_range.y() - m_range.x()) *
+                                              i / std::max(n_points - 1, (size_t) 1)));
+                band_index[slot] = j;
+                band_weight[slot] = ptr[i];
+            }
+        }
+
+        m_grid_size = (uint32_t) n_points;
+        m_band_index = dr::load<UInt32Storage>(band_index.data(), 2 * n_points);
+        m_band_weight = dr::load<FloatStorage>(band_weight.data(), 2 * n_points);
     }
 
     size_t prepare(const std::vector<std::string>& channels) override {
@@ -265,15 +340,17 @@ public:
                                  bool border) override {
         bool default_config = size == ScalarVector2u(0);
 
-        return new ImageBlock(default_config ? m_crop_size : size,
-                              default_config ? m_crop_offset : ScalarPoint2u(0),
-                              (uint32_t) m_channels.size(), m_filter.get(),
-                              border /* border */,
-                              normalize /* normalize */,
-                              dr::is_jit_v<Float> /* coalesce */,
-                              m_compensate /* compensate */,
-                              false /* warn_negative */,
-                              false /* warn_invalid */);
+        ref<ImageBlock> block = new ImageBlock(default_config ? m_crop_size : size,
+                                               default_config ? m_crop_offset : ScalarPoint2u(0),
+                                               (uint32_t) m_channels.size(), m_filter.get(),
+                                               border /* border */,
+                                               normalize /* normalize */,
+                                               dr::is_jit_v<Float> /* coalesce */,
+                                               m_compensate /* compensate */,
+                                               false /* warn_negative */,
+                                               false /* warn_invalid */);
+        block->set_sorted(m_sorted_splat);
+        return block;
     }
 
     void prepare_sample(const UnpolarizedSpectrum &spec, const Wavelength &wavelengths,
@@ -288,6 +365,11 @@ public:
         inv_spec = dr::select(dr::neq(inv_spec, 0.f), dr::rcp(inv_spec), 1.f);
         UnpolarizedSpectrum values = spec * inv_spec;
 
+        if (m_sparse_bands) {
+            prepare_sample_sparse(values, wavelengths, aovs);
+            return;
+        }
+
         for (size_t j = 0; j < m_srfs.size(); ++j) {
             UnpolarizedSpectrum weights = m_srfs[j]->eval(si);
             aovs[j] = dr::zeros<Float>();
@@ -299,6 +381,48 @@ public:
         }
     }
 
+    /**
+     * \brief Weight the sample by the tabulated bands that overlap its
+     * wavelengths, linearly interpolating between neighboring grid points
+     */
+    void prepare_sample_sparse(const UnpolarizedSpectrum &values,
+                               const Wavelength &wavelengths,
+                               Float *aovs) const {
+        uint32_t n_bands = (uint32_t) m_srfs.size(),
+                 last = std::max(m_grid_size, 2u) - 2u;
+        ScalarFloat scale = (ScalarFloat) (m_grid_size - 1) /
+                            (m_range.y() - m_range.x());
+
+        for (uint32_t j = 0; j < n_bands; ++j)
+            aovs[j] = dr::zeros<Float>();
+
+        for (size_t i = 0; i < Spectrum::Size; ++i) {
+            Float t = (wavelengths[i] - m_range.x()) * scale;
+            Mask in_range = t >= 0.f && t <= (ScalarFloat) (m_grid_size - 1);
+
+            UInt32 p0 = dr::minimum(UInt32(dr::maximum(t, 0.f)), last);
+            Float f = dr::clamp(t - Float(p0), 0.f, 1.f);
+
+            for (uint32_t q = 0; q < 4; ++q) {
+                UInt32 index = 2 * (p0 + (q >> 1)) + (q & 1);
+                UInt32 band = dr::gather<UInt32>(m_band_index, index, in_range);
+                Float weight = dr::gather<Float>(m_band_weight, index, in_range) *
+                               ((q >> 1) ? f : 1.f - f) * values[i];
+
+                if constexpr (!dr::is_jit_v<Float>) {
+                    if (in_range && band < n_bands)
+                        aovs[band] += weight;
+                } else {
+                    for (uint32_t j = 0; j < n_bands; ++j)
+                        aovs[j] += dr::select(in_range && dr::eq(band, j), weight, 0.f);
+                }
+            }
+        }
+
+        for (uint32_t j = 0; j < n_bands; ++j)
+            aovs[j] *= 1.f / Spectrum::Size;
+    }
+
     void put_block(const ImageBlock *block) override {
         Assert(m_storage != nullptr);
         std::lock_guard<std::mutex> lock(m_mutex);
@@ -408,6 +532,18 @@ public:
     }
 
     void write(const fs::path &path) const override {
+        write_bitmap(path, false);
+    }
+
+    void write_async(const fs::path &path) const override {
+        write_bitmap(path, true);
+    }
+
+    /**
+     * Develop the film, convert it to the component format, and write it (or
+     * submit it to the global \ref BitmapWriter when \c async is set)
+     */
+    void write_bitmap(const fs::path &path, bool async) const {
         fs::path filename = path;
         std::string proper_extension = ".exr";
 
@@ -435,11 +571,13 @@ public:
                 source->channel_count(),
                 channel_names);
             source->convert(target);
+            source = target;
+        }
 
-            target->write(filename, m_file_format);
-        } else {
+        if (async)
+            BitmapWriter::instance()->write(source, filename, m_file_format);
+        else
             source->write(filename, m_file_format);
-        }
     }
 
     void schedule_storage() override {
@@ -454,6 +592,8 @@ public:
             << "  crop_offset = " << m_crop_offset << "," << std::endl
             << "  sample_border = " << m_sample_border << "," << std::endl
             << "  compensate = " << m_compensate << "," << std::endl
+            << "  sorted_splat = " << m_sorted_splat << "," << std::endl
+            << "  sparse_bands = " << m_sparse_bands << "," << std::endl
             << "  filter = " << m_filter << "," << std::endl
             << "  file_format = " << m_file_format << "," << std::endl
             << "  pixel_format = " << m_pixel_format << "," << std::endl
@@ -472,12 +612,18 @@ protected:
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
     bool m_compensate;
+    bool m_sorted_splat;
+    bool m_sparse_bands;
     ref<ImageBlock> m_storage;
     mutable std::mutex m_mutex;
     std::vector<std::string> m_channels;
     std::vector<ref<Texture>> m_srfs;
     std::vector<std::string> m_names;
     ScalarVector2f m_range { dr::Infinity<ScalarFloat>, -dr::Infinity<ScalarFloat> };
+    /// Sparse band table: two (band, SRF value) entries per grid point
+    uint32_t m_grid_size = 0;
+    UInt32Storage m_band_index;
+    FloatStorage m_band_weight;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(SpecFilm, Film)
@@ -237,3 +237,204 @@ def test07_luminance_alpha_mono(variants_all):
     image = mi.TensorXf(film.bitmap())
 
     assert image.shape[2] == 2
+
+
+@pytest.mark.parametrize('pixel_format', ['rgb', 'rgba', 'xyz', 'luminance'])
+def test08_streaming(variant_scalar_rgb, pixel_format, tmpdir):
+    import numpy as np
+
+    rng = np.random.default_rng(seed=1234)
+    filename = str(tmpdir.join('streamed.exr'))
+    reference_filename = str(tmpdir.join('reference.exr'))
+
+    config = {
+        'type': 'hdrfilm',
+        'width': 37,
+        'height': 21,
+        'pixel_format': pixel_format,
+        'component_format': 'float32',
+        'filter': {'type': 'gaussian'}
+    }
+    reference = mi.load_dict(config)
+    streamed = mi.load_dict(dict(config, stream_filename=filename,
+                                 stream_tile_size=16))
+    reference.prepare(['aov.x'])
+    streamed.prepare(['aov.x'])
+
+    channels = 6 if pixel_format.endswith('a') else 5
+    block_size = 8
+    res = reference.size()
+    for by in range(0, res[1], block_size):
+        for bx in range(0, res[0], block_size):
+            size = [min(block_size, res[0] - bx), min(block_size, res[1] - by)]
+            block = mi.ImageBlock(size, [bx, by], channels, reference.rfilter())
+            for _ in range(4 * size[0] * size[1]):
+                pos = [bx + rng.uniform() * size[0], by + rng.uniform() * size[1]]
+                value = list(rng.uniform(size=channels))
+                value[channels - 2] = 1.0
+                block.put(pos, value)
+            reference.put_block(block)
+            streamed.put_block(block)
+
+    with pytest.raises(RuntimeError):
+        streamed.bitmap()
+
+    reference.write(reference_filename)
+    streamed.write(filename)
+
+    expected = mi.TensorXf(mi.Bitmap(reference_filename))
+    result = mi.TensorXf(mi.Bitmap(filename))
+    assert dr.allclose(result, expected, atol=1e-5)
+
+
+def test09_write_snapshot(variant_scalar_rgb, tmpdir):
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'width': 13,
+        'height': 9,
+        'component_format': 'float32',
+        'filter': {'type': 'box'}
+    })
+    film.prepare([])
+
+    block = film.create_block()
+    for y in range(film.size()[1]):
+        for x in range(film.size()[0]):
+            block.put([x + 0.5, y + 0.5], [x, y, 0.5, 1.0])
+    film.put_block(block)
+
+    snapshot_filename = str(tmpdir.join('snapshot.exr'))
+    filename = str(tmpdir.join('image.exr'))
+    film.write_snapshot(snapshot_filename)
+
+    # The snapshot is a copy: later contributions don't affect it
+    film.write(filename)
+    film.put_block(block)
+
+    snapshot = mi.TensorXf(mi.Bitmap(snapshot_filename))
+    assert dr.allclose(snapshot, mi.TensorXf(mi.Bitmap(filename)))
+
+    film.write_snapshot(snapshot_filename)
+    assert dr.allclose(mi.TensorXf(mi.Bitmap(snapshot_filename)), snapshot)
+
+
+@pytest.mark.parametrize('compression', ['none', 'zip', 'piz', 'dwaa'])
+def test10_channel_formats(variant_scalar_rgb, compression, tmpdir):
+    import numpy as np
+
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'width': 32,
+        'height': 16,
+        'component_format': 'float16',
+        'channel_formats': 'dd.y:float32, nn:float16',
+        'compression': compression,
+        'filter': {'type': 'box'}
+    })
+    aovs = ['nn.X', 'nn.Y', 'nn.Z', 'dd.y']
+    film.prepare(aovs)
+
+    block = film.create_block()
+    for y in range(film.size()[1]):
+        for x in range(film.size()[0]):
+            depth = 1.0 + 1e-4 * (x + y * film.size()[0])
+            block.put([x + 0.5, y + 0.5],
+                      [0.25, 0.5, 0.75, 1.0, 0.0, 0.0, 1.0, depth])
+    film.put_block(block)
+
+    filename = str(tmpdir.join('aovs.exr'))
+    film.write(filename)
+
+    # Mixed precision files are read in single precision
+    bitmap = mi.Bitmap(filename)
+    assert bitmap.component_format() == mi.Struct.Type.Float32
+    channels = dict(bitmap.split())
+
+    # Depth values are not representable in half precision
+    depth = np.array(channels['dd'], copy=False)[..., 0]
+    ref = 1.0 + 1e-4 * np.arange(32 * 16, dtype=np.float32).reshape(16, 32)
+    assert np.allclose(depth, ref, atol=1e-6, rtol=0)
+
+    normals = np.array(channels['nn'], copy=False)
+    assert np.allclose(normals, [0, 0, 1], atol=1e-2)
+    image = np.array(channels['<root>'], copy=False)
+    assert np.allclose(image, [0.25, 0.5, 0.75], atol=1e-2)
+
+
+def test11_invalid_compression(variant_scalar_rgb):
+    with pytest.raises(RuntimeError, match='compression'):
+        mi.load_dict({'type': 'hdrfilm', 'compression': 'lz4'})
+    with pytest.raises(RuntimeError, match='channel format'):
+        mi.load_dict({'type': 'hdrfilm', 'channel_formats': 'dd.y:double'})
+
+
+@pytest.mark.parametrize('pixel_format', ['RGBA', 'XYZ', 'luminance_alpha'])
+def test12_planar_tensor_layout(variants_all_rgb, pixel_format):
+    alpha = pixel_format in ['RGBA', 'luminance_alpha']
+
+    def develop(layout):
+        film = mi.load_dict({
+            'type': 'hdrfilm',
+            'pixel_format': pixel_format,
+            'width': 3,
+            'height': 5,
+            'tensor_layout': layout,
+            'rfilter': {'type': 'box'}
+        })
+        film.prepare(['aov.x'])
+        block = film.create_block()
+        for y in range(5):
+            for x in range(3):
+                v = [x, 2 * y, 0.1] + ([1.0] if alpha else []) + [0.5, 10 + x]
+                block.put([x + 0.5, y + 0.5], v)
+        film.put_block(block)
+        return film.develop()
+
+    hwc, chw = develop('hwc'), develop('chw')
+    h, w, c = hwc.shape
+    assert chw.shape == (c, h, w)
+
+    hwc, chw = hwc.array, chw.array
+    for k in range(c):
+        for i in range(h * w):
+            assert dr.allclose(chw[k * h * w + i], hwc[i * c + k])
+
+    with pytest.raises(RuntimeError, match='tensor_layout'):
+        mi.load_dict({'type': 'hdrfilm', 'tensor_layout': 'nchw'})
+
+
+@pytest.mark.parametrize('pixel_format', ['xyz', 'luminance_alpha'])
+@pytest.mark.parametrize('component_format', ['float16', 'float32', 'uint32'])
+def test13_write_developed(variant_scalar_rgb, pixel_format, component_format, tmpdir):
+    # Files are developed directly into the component format
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'pixel_format': pixel_format,
+        'component_format': component_format,
+        'width': 4,
+        'height': 3,
+        'rfilter': {'type': 'box'}
+    })
+    alpha = pixel_format == 'luminance_alpha'
+    film.prepare(['aov.x'])
+    block = film.create_block()
+    for y in range(3):
+        for x in range(4):
+            v = [x, 2 * y, 0.5] + ([1.0] if alpha else []) + [2.0, 10 + x]
+            block.put([x + 0.5, y + 0.5], v)
+    film.put_block(block)
+
+    filename = str(tmpdir.join('test_image.exr'))
+    film.write(filename)
+
+    bitmap = mi.Bitmap(filename)
+    formats = {
+        'float16': mi.Struct.Type.Float16,
+        'float32': mi.Struct.Type.Float32,
+        'uint32': mi.Struct.Type.UInt32
+    }
+    assert bitmap.component_format() == formats[component_format]
+
+    expected = mi.TensorXf(film.bitmap())
+    result = mi.TensorXf(bitmap.convert(component_format=mi.Struct.Type.Float32))
+    assert dr.allclose(result, expected, rtol=1e-3, atol=1 if component_format == 'uint32' else 1e-3)
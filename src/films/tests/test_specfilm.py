@@ -178,3 +178,32 @@ def test06_aovs(variants_all_spectral):
             }
         })
         film.prepare(['AOV', 'AOV'])
+
+
+def test07_sparse_bands(variants_all_spectral):
+    # Non-overlapping triangular bands that are exactly represented on the
+    # film's sampling grid
+    dic = { 'type': 'specfilm' }
+    for k in range(3):
+        dic['band_{}'.format(k)] = {
+            'type': 'spectrum',
+            'value': [(400+100*k, 0.0), (450+100*k, 1.0), (500+100*k, 0.0)]
+        }
+
+    film = mi.load_dict(dic)
+    film_sparse = mi.load_dict(dict(dic, sparse_bands=True))
+    film.prepare([])
+    film_sparse.prepare([])
+
+    wavelengths = mi.Wavelength([420, 480, 555, 690])
+    spec = mi.UnpolarizedSpectrum([1, 2, 3, 4])
+    ref = film.prepare_sample(spec, wavelengths, 4)
+    sparse = film_sparse.prepare_sample(spec, wavelengths, 4)
+    for j in range(4):
+        assert dr.allclose(ref[j], sparse[j])
+
+    # More than two overlapping bands are not supported
+    dic['band_3'] = { 'type': 'spectrum', 'value': [(400, 1.0), (700, 1.0)] }
+    dic['band_4'] = { 'type': 'spectrum', 'value': [(400, 1.0), (700, 1.0)] }
+    with pytest.raises(RuntimeError, match='sparse_bands'):
+        mi.load_dict(dict(dic, sparse_bands=True))
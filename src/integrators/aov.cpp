@@ -1,6 +1,7 @@
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
+#include <mitsuba/render/sensor.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -18,11 +19,22 @@ Arbitrary Output Variables integrator (:monosp:`aov`)
    - |string|
    - List of :monosp:`<name>:<type>` pairs denoting the enabled AOVs.
 
+ * - aov_spp
+   - |int|
+   - Number of samples per pixel used to compute the AOVs that do not come from a
+     nested integrator. These are evaluated for the first :monosp:`aov_spp` samples of
+     every pixel while the nested integrators use all samples. (Default: 0, i.e. all samples)
+
  * - (Nested plugin)
    - :paramtype:`integrator`
    - Sub-integrators (can have more than one) which will be sampled along the AOV integrator. Their
      respective output will be put into distinct images.
 
+ * - (Nested plugin)
+   - :paramtype:`sensor`
+   - Sensor describing the camera of the previous frame, required by the :monosp:`flow` AOV.
+     (Default: none)
+
 
 This integrator returns one or more AOVs (Arbitrary Output Variables) describing the visible
 surfaces.
@@ -73,21 +85,49 @@ Currently, the following AOVs types are available:
     - :monosp:`prim_index`: Primitive index (e.g. triangle index in the mesh).
     - :monosp:`shape_index`: Shape index.
     - :monosp:`boundary_test`: Boundary test.
+    - :monosp:`flow`: Optical flow, i.e. the 2D motion in pixels of the visible point between the
+      previous frame and the current one (see below).
 
 Note that integer-valued AOVs (e.g. :monosp:`prim_index`, :monosp:`shape_index`)
 are meaningless whenever there is only partial pixel coverage or when using a
 wide pixel reconstruction filter as it will result in fractional values.
 
+Geometric AOVs usually converge with far fewer samples than the images of the nested
+integrators. The :monosp:`aov_spp` parameter limits them to a few samples per pixel, which
+skips their ray intersection and evaluation for the remaining samples. Their contributions
+are reweighted such that the film still reports their average over the evaluated samples.
+This is exact for the :ref:`box <rfilter-box>` filter, but only approximate for wider
+reconstruction filters, whose weights differ between samples.
+
 The :monosp:`albedo` AOV will evaluate the diffuse reflectance
 (\ref BSDF::eval_diffuse_reflectance) of the material. Note that depending on
 the material, this value might only be an approximation.
+
+The :monosp:`flow` AOV projects the visible point into the image of the rendering sensor and of a
+nested sensor describing the camera of the previous frame, and returns the difference of the two
+pixel positions. Both sensors must implement :py:meth:`mitsuba.Endpoint.sample_direction` (e.g.
+:ref:`perspective <sensor-perspective>`), and the scene is assumed to be static apart from the
+camera. The nested sensor should use a film of the same resolution. Points that are not visible to
+the previous camera have zero flow. This AOV provides the
+motion vectors expected by the temporal mode of :py:class:`mitsuba.OptixDenoiser`:
+
+.. tabs::
+    .. code-tab:: xml
+
+        <integrator type="aov">
+            <string name="aovs" value="albedo:albedo,nn:sh_normal,flow:flow"/>
+            <integrator type="path" name="image"/>
+            <sensor type="perspective" name="previous_camera">
+                <!-- Camera parameters of the previous frame -->
+            </sensor>
+        </integrator>
  */
 
 template <typename Float, typename Spectrum>
 class AOVIntegrator final : public SamplingIntegrator<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(SamplingIntegrator)
-    MI_IMPORT_TYPES(Scene, Sampler, Medium, BSDFPtr)
+    MI_IMPORT_TYPES(Scene, Sampler, Sensor, Medium, BSDFPtr)
 
     enum class Type {
         Albedo,
@@ -103,6 +143,7 @@ public:
         dUVdy,
         PrimIndex,
         ShapeIndex,
+        Flow,
         IntegratorRGBA
     };
 
@@ -169,12 +210,23 @@ public:
             } else if (item[1] == "shape_index") {
                 m_aov_types.push_back(Type::ShapeIndex);
                 m_aov_names.push_back(item[0] + ".I");
+            } else if (item[1] == "flow") {
+                m_aov_types.push_back(Type::Flow);
+                m_aov_names.push_back(item[0] + ".X");
+                m_aov_names.push_back(item[0] + ".Y");
             } else {
                 Throw("Invalid AOV type \"%s\"!", item[1]);
             }
         }
 
         for (auto &kv : props.objects()) {
+            if (Sensor *sensor = dynamic_cast<Sensor *>(kv.second.get())) {
+                if (m_flow_sensor)
+                    Throw("Only a single sensor can be specified!");
+                m_flow_sensor = sensor;
+                continue;
+            }
+
             Base *integrator = dynamic_cast<Base *>(kv.second.get());
             if (!integrator)
                 Throw("Child objects must be of type 'SamplingIntegrator'!");
@@ -189,8 +241,28 @@ public:
             m_aov_names.push_back(kv.first + ".A");
         }
 
+        m_aov_spp = props.get<uint32_t>("aov_spp", 0);
+        m_has_geometric_aovs =
+            std::any_of(m_aov_types.begin(), m_aov_types.end(),
+                        [](Type type) { return type != Type::IntegratorRGBA; });
+
         if (m_aov_names.empty())
             Log(Warn, "No AOVs were specified!");
+
+        bool has_flow = std::find(m_aov_types.begin(), m_aov_types.end(),
+                                  Type::Flow) != m_aov_types.end();
+        if (has_flow && !m_flow_sensor)
+            Throw("The \"flow\" AOV requires a nested sensor describing the "
+                  "camera of the previous frame!");
+    }
+
+    using Base::render;
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed, uint32_t spp,
+                    bool develop, bool evaluate) override {
+        // The flow AOV projects into the image of the rendering sensor
+        m_sensor = sensor;
+        return Base::render(scene, sensor, seed, spp, develop, evaluate);
     }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
@@ -203,9 +275,23 @@ public:
 
         std::pair<Spectrum, Mask> result { 0.f, false };
 
-        SurfaceInteraction3f si = scene->ray_intersect(
-            ray, RayFlags::All | RayFlags::BoundaryTest, true, active);
-        dr::masked(si, !si.is_valid()) = dr::zeros<SurfaceInteraction3f>();
+        /* Only the first 'aov_spp' samples of every pixel evaluate the
+           geometric AOVs, which are reweighted to preserve their average */
+        Mask aov_active = active;
+        Float aov_weight = 1.f;
+        bool reweight = m_aov_spp > 0 && m_aov_spp < sampler->sample_count();
+        if (reweight) {
+            aov_active &= sampler->current_sample_index() < m_aov_spp;
+            aov_weight = dr::select(
+                aov_active, (ScalarFloat) sampler->sample_count() / m_aov_spp, 0.f);
+        }
+
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        if (m_has_geometric_aovs && dr::any_or<true>(aov_active)) {
+            si = scene->ray_intersect(
+                ray, RayFlags::All | RayFlags::BoundaryTest, true, aov_active);
+            dr::masked(si, !si.is_valid()) = dr::zeros<SurfaceInteraction3f>();
+        }
         size_t ctr = 0;
 
         auto spectrum_to_color3f = [](const Spectrum& spec, const Ray3f& ray, Mask active) {
@@ -225,6 +311,8 @@ public:
         };
 
         for (size_t i = 0; i < m_aov_types.size(); ++i) {
+            Float *aovs_start = aovs;
+
             switch (m_aov_types[i]) {
                 case Type::Albedo: {
                         Color3f rgb(0.f);
@@ -305,6 +393,24 @@ public:
                     *aovs++ = Float(dr::reinterpret_array<UInt32>(si.shape));
                     break;
 
+                case Type::Flow: {
+                        Vector2f flow(0.f);
+                        Mask valid = active && si.is_valid();
+                        if (m_sensor && dr::any_or<true>(valid)) {
+                            auto [ds_prev, w_prev] = m_flow_sensor->sample_direction(
+                                si, Point2f(0.5f), valid);
+                            auto [ds_cur, w_cur] = m_sensor->sample_direction(
+                                si, Point2f(0.5f), valid);
+                            valid &= dr::neq(ds_prev.pdf, 0.f) &&
+                                     dr::neq(ds_cur.pdf, 0.f);
+                            dr::masked(flow, valid) = ds_cur.uv - ds_prev.uv;
+                        }
+
+                        *aovs++ = flow.x();
+                        *aovs++ = flow.y();
+                    }
+                    break;
+
                 case Type::IntegratorRGBA: {
                         std::pair<Spectrum, Mask> result_sub =
                             m_integrators[ctr].first->sample(scene, sampler, ray, medium, aovs, active);
@@ -322,6 +428,11 @@ public:
                     }
                     break;
             }
+
+            if (reweight && m_aov_types[i] != Type::IntegratorRGBA) {
+                for (Float *aov = aovs_start; aov != aovs; ++aov)
+                    *aov *= aov_weight;
+            }
         }
 
         return result;
@@ -331,17 +442,39 @@ public:
         return m_aov_names;
     }
 
+    // Forward the rendering callbacks to the nested integrators
+    void render_begin(const Scene *scene, uint32_t n_passes) override {
+        for (auto &[integrator, n_aovs] : m_integrators)
+            integrator->render_begin(scene, n_passes);
+    }
+
+    void render_pass_end(uint32_t pass) override {
+        for (auto &[integrator, n_aovs] : m_integrators)
+            integrator->render_pass_end(pass);
+    }
+
+    bool needs_pass_callback() const override {
+        return std::any_of(m_integrators.begin(), m_integrators.end(),
+                           [](const auto &item) {
+                               return item.first->needs_pass_callback();
+                           });
+    }
+
     void traverse(TraversalCallback *callback) override {
         for (size_t i = 0; i < m_integrators.size(); ++i)
             callback->put_object("integrator_" + std::to_string(i),
                                  m_integrators[i].first.get(),
                                  +ParamFlags::Differentiable);
+        if (m_flow_sensor)
+            callback->put_object("flow_sensor", m_flow_sensor.get(),
+                                 +ParamFlags::NonDifferentiable);
     }
 
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "Scene[" << std::endl
             << "  aovs = " << m_aov_names << "," << std::endl
+            << "  aov_spp = " << m_aov_spp << "," << std::endl
             << "  integrators = [" << std::endl;
         for (size_t i = 0; i < m_integrators.size(); ++i) {
             oss << "    " << string::indent(m_integrators[i].first, 4);
@@ -359,6 +492,10 @@ private:
     std::vector<Type> m_aov_types;
     std::vector<std::string> m_aov_names;
     std::vector<std::pair<ref<Base>, size_t>> m_integrators;
+    uint32_t m_aov_spp;
+    bool m_has_geometric_aovs;
+    ref<Sensor> m_flow_sensor;
+    const Sensor *m_sensor = nullptr;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(AOVIntegrator, SamplingIntegrator)
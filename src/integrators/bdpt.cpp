@@ -0,0 +1,771 @@
+#include <mitsuba/core/arena.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-bdpt:
+
+Bidirectional path tracer (:monosp:`bdpt`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+ * - samples_per_pass
+   - |bool|
+   - If specified, divides the workload in successive passes with :paramtype:`samples_per_pass`
+     samples per pixel.
+
+This integrator implements bidirectional path tracing. For every sample, it
+traces one subpath starting from the sensor and one starting from a randomly
+chosen emitter, and then combines them using all of the following strategies:
+
+- camera subpaths that hit an emitter,
+- emitter sampling from every vertex of the camera subpath,
+- connections between every vertex of the camera subpath and every vertex of
+  the light subpath,
+- connections between every vertex of the light subpath and the sensor, which
+  are splatted onto the image like in the :ref:`particle tracer
+  <integrator-ptracer>`.
+
+The contributions are weighted using multiple importance sampling (power
+heuristic), which makes this integrator well-suited for scenes with caustics
+and indirectly lit regions that are difficult to handle using :ref:`path
+<integrator-path>` or :ref:`ptracer <integrator-ptracer>` alone.
+
+In vectorized variants, each vertex of a subpath is stored as a separate set
+of arrays spanning the entire wavefront (structure-of-arrays layout), and each
+bounce is evaluated by its own kernel. Once both subpaths are complete, all
+connection strategies are collected into a single batch of shadow rays, which
+is traced and splatted with one call. Since this batch grows quadratically
+with :paramtype:`max_depth`, the :paramtype:`samples_per_pass` parameter can
+be used to bound memory usage.
+
+Light subpaths are only traced from area emitters. Paths ending on point,
+spot, directional or environment emitters are handled by the unidirectional
+strategies (emitter and BSDF sampling from the camera subpath), which makes
+the contribution of such emitters equivalent to the :ref:`path tracer
+<integrator-path>`.
+
+.. note:: This integrator does not handle participating media, does not
+   support polarized variants, and assumes a pinhole camera model for the
+   connections to the sensor (e.g. the :ref:`perspective <sensor-perspective>`
+   sensor).
+
+.. tabs::
+    .. code-tab::  xml
+
+        <integrator type="bdpt">
+            <integer name="max_depth" value="8"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'bdpt',
+        'max_depth': 8
+
+ */
+
+template <typename Float, typename Spectrum>
+class BidirectionalPathIntegrator final : public AdjointIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(AdjointIntegrator, m_hide_emitters, m_rr_depth, m_max_depth)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, Sampler, ImageBlock, Emitter,
+                     EmitterPtr, BSDF, BSDFPtr)
+
+    /// Vertex of a camera or light subpath
+    struct Vertex {
+        SurfaceInteraction3f si;
+        /// Throughput of the subpath until it reaches this vertex
+        Spectrum beta;
+        /// Area density of sampling this vertex from its predecessor
+        Float pdf_fwd;
+        /// Area density of sampling this vertex from its successor
+        Float pdf_rev;
+        /// Was the subpath continued through a Dirac delta BSDF lobe?
+        Mask delta;
+        Mask valid;
+
+        DRJIT_STRUCT(Vertex, si, beta, pdf_fwd, pdf_rev, delta, valid)
+    };
+
+    /// Densities of a vertex entering the computation of the MIS weights
+    struct MISRecord {
+        Float pdf_fwd;
+        Float pdf_rev;
+        Mask delta;
+    };
+
+    /// Connection whose contribution is splatted unless the ray is occluded
+    struct Connection {
+        Ray3f ray;
+        Point2f pos;
+        Spectrum value;
+        Mask active;
+
+        DRJIT_STRUCT(Connection, ray, pos, value, active)
+    };
+
+    /* Subpaths and connections are per-sample temporaries, which are
+       allocated from the arena of the rendering thread */
+    using VertexVector     = ArenaVector<Vertex>;
+    using MISVector        = ArenaVector<MISRecord>;
+    using ConnectionVector = ArenaVector<Connection>;
+
+    BidirectionalPathIntegrator(const Properties &props) : Base(props) { }
+
+    void sample(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                ImageBlock *block, ScalarFloat sample_scale) const override {
+        if constexpr (is_polarized_v<Spectrum>) {
+            Throw("This integrator currently does not support polarized mode!");
+        }
+
+        if (unlikely(m_max_depth == 0))
+            return;
+
+        // Release the temporaries of this sample once it has been splatted
+        MemoryArena::Scope arena_scope;
+
+        size_t max_vertices = m_max_depth < 0 ? (size_t) -1
+                                              : (size_t) m_max_depth + 1;
+
+        // Normalization of the emitter selection PMF of sample_emitter()
+        ScalarFloat weight_sum = 0.f;
+        for (const auto &emitter : scene->emitters())
+            weight_sum += emitter->sampling_weight();
+        ScalarFloat inv_weight_sum = weight_sum > 0.f ? 1.f / weight_sum : 0.f;
+
+        // ------------------------- Camera subpath -------------------------
+
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        Point2f position_sample = sampler->next_2d();
+
+        Point2f aperture_sample(.5f);
+        if (sensor->needs_aperture_sample())
+            aperture_sample = sampler->next_2d();
+
+        Float wavelength_sample = 0.f;
+        if constexpr (is_spectral_v<Spectrum>)
+            wavelength_sample = sampler->next_1d();
+
+        auto [ray, ray_weight] = sensor->sample_ray(
+            time, wavelength_sample, position_sample, aperture_sample);
+
+        /* Image plane position of the camera subpath. The crop window is
+           already accounted for by the sensor, and `put` subtracts the
+           block's offset again. */
+        Point2f pos = position_sample * ScalarVector2f(block->size()) +
+                      block->offset();
+
+        Vertex z0 = dr::zeros<Vertex>();
+        z0.si.p           = ray.o;
+        z0.si.time        = ray.time;
+        z0.si.wavelengths = ray.wavelengths;
+        z0.beta           = ray_weight;
+        z0.pdf_fwd        = 1.f;
+        z0.valid          = true;
+
+        // Emission found by the camera subpath (strategies without connection)
+        Spectrum result = 0.f;
+
+        VertexVector camera;
+        camera.reserve(std::min(max_vertices, (size_t) 16));
+        camera.push_back(z0);
+        random_walk(scene, sampler, ray, ray_weight, 1.f, max_vertices,
+                    TransportMode::Radiance, camera, &result);
+
+        /* The walk cannot know the area density of the first vertex, which
+           is given by the sensor's directional importance */
+        if (camera.size() > 1)
+            camera[1].pdf_fwd = pdf_sensor(sensor, camera[1].si, camera[1].valid);
+
+        // -------------------------- Light subpath -------------------------
+
+        VertexVector light;
+        light.reserve(std::min(max_vertices, (size_t) 16));
+        if (max_vertices > 2) {
+            auto [emitter_idx, emitter_weight, _] =
+                scene->sample_emitter(sampler->next_1d());
+            EmitterPtr emitter =
+                dr::gather<EmitterPtr>(scene->emitters_dr(), emitter_idx);
+
+            // Only area emitters start light subpaths (see plugin documentation)
+            Mask active = has_flag(emitter->flags(), EmitterFlags::Surface) &&
+                          !has_flag(emitter->flags(), EmitterFlags::Infinite);
+
+            Point2f sample_pos = sampler->next_2d(),
+                    sample_dir = sampler->next_2d();
+
+            if (dr::any_or<true>(active)) {
+                auto [ps, pos_weight] =
+                    emitter->sample_position(time, sample_pos, active);
+
+                SurfaceInteraction3f si(ps, ray.wavelengths);
+                si.wi = warp::square_to_cosine_hemisphere(sample_dir);
+
+                Spectrum radiance = emitter->eval(si, active);
+                active &= dr::any(dr::neq(unpolarized_spectrum(radiance), 0.f));
+
+                Vertex y0;
+                y0.si      = si;
+                y0.beta    = radiance * emitter_weight * pos_weight;
+                y0.pdf_fwd = dr::rcp(emitter_weight) * ps.pdf;
+                y0.pdf_rev = 0.f;
+                y0.delta   = false;
+                y0.valid   = active;
+
+                // Note: the cosine cancels with the density of the direction
+                light.push_back(y0);
+                random_walk(scene, sampler, si.spawn_ray(si.to_world(si.wi)),
+                            y0.beta * dr::Pi<ScalarFloat>,
+                            Frame3f::cos_theta(si.wi) * dr::InvPi<ScalarFloat>,
+                            max_vertices - 1, TransportMode::Importance, light,
+                            nullptr, active);
+            }
+        }
+
+        // --------------------- Connection strategies ----------------------
+
+        ConnectionVector connections;
+
+        for (size_t t = 2; t <= camera.size(); ++t) {
+            // s = 0: the camera subpath hit an area emitter
+            if (t > 2 || !m_hide_emitters)
+                result += connect_emitter(scene, camera, t, inv_weight_sum);
+
+            // s = 1: emitter sampling at the last vertex of the camera subpath
+            if (t + 1 <= max_vertices)
+                connections.push_back(
+                    connect_nee(scene, sampler, camera, t, pos, inv_weight_sum,
+                                sample_scale));
+
+            // s > 1: connect the two subpaths
+            for (size_t s = 2; s <= light.size() && s + t <= max_vertices; ++s)
+                connections.push_back(
+                    connect_subpaths(light, camera, s, t, pos, sample_scale));
+        }
+
+        // t = 1: connect vertices of the light subpath to the sensor
+        for (size_t s = 2; s <= light.size() && s + 1 <= max_vertices; ++s)
+            connections.push_back(connect_sensor(sensor, sampler, light, s,
+                                                 z0.beta, block, sample_scale));
+
+        Float alpha = 0.f;
+        if (camera.size() > 1)
+            alpha = dr::select(camera[1].valid, Float(1.f), Float(0.f));
+
+        block->put(pos, ray.wavelengths, result * sample_scale, alpha,
+                   /* weight = */ 0.f);
+
+        trace_connections(scene, block, connections, dr::width(pos));
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        return tfm::format("BidirectionalPathIntegrator[\n"
+                           "  max_depth = %i,\n"
+                           "  rr_depth = %i\n"
+                           "]",
+                           m_max_depth, m_rr_depth);
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /**
+     * \brief Extend the subpath \c path (which already contains its endpoint)
+     * with vertices found by BSDF sampling, until it contains \c max_vertices
+     * vertices or all paths were terminated.
+     *
+     * \param pdf_dir
+     *     Solid angle density of sampling the direction of \c ray
+     *
+     * \param result
+     *     If not \c nullptr, the emission of environment emitters found by the
+     *     (camera) subpath is accumulated here.
+     */
+    void random_walk(const Scene *scene, Sampler *sampler, Ray3f ray,
+                     Spectrum beta, Float pdf_dir, size_t max_vertices,
+                     TransportMode mode, VertexVector &path,
+                     Spectrum *result, Mask active = true) const {
+        Float eta = 1.f;
+
+        // Information about the previous scattering event (for MIS)
+        Interaction3f prev_it = path.back().si;
+        Float prev_pdf  = 1.f;
+        Mask prev_delta = true;
+
+        for (uint32_t depth = 1; path.size() < max_vertices; ++depth) {
+            if (!dr::any(active))
+                break;
+
+            SurfaceInteraction3f si = scene->ray_intersect(
+                ray, scene->ray_flags(),
+                /* coherent = */ depth == 1 && mode == TransportMode::Radiance,
+                active);
+
+            // ----------------- Environment emitter hit -----------------
+
+            Mask escaped = active && !si.is_valid();
+            if (result && scene->environment() != nullptr &&
+                (depth > 1 || !m_hide_emitters) && dr::any_or<true>(escaped)) {
+                EmitterPtr emitter = si.emitter(scene, escaped);
+                DirectionSample3f ds(scene, si, prev_it);
+
+                Float em_pdf = 0.f;
+                if (dr::any_or<true>(!prev_delta))
+                    em_pdf = scene->pdf_emitter_direction(prev_it, ds,
+                                                          escaped && !prev_delta);
+
+                Float weight = dr::select(prev_delta, 1.f,
+                                          mis_weight(prev_pdf, em_pdf));
+                *result += beta * weight * emitter->eval(si, escaped);
+            }
+
+            active &= si.is_valid();
+
+            Vertex v;
+            v.si      = si;
+            v.beta    = beta;
+            v.pdf_fwd = to_area(pdf_dir, prev_it.p, si.p, si.n);
+            v.pdf_rev = 0.f;
+            v.delta   = false;
+            v.valid   = active;
+            path.push_back(v);
+
+            if (path.size() == max_vertices)
+                break;
+
+            // ----------------------- BSDF sampling ----------------------
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            BSDFContext ctx(mode);
+            auto [bs, bsdf_weight] =
+                bsdf->sample(ctx, si, sampler->next_1d(active),
+                             sampler->next_2d(active), active);
+            Vector3f wo = si.to_world(bs.wo);
+
+            if (mode == TransportMode::Importance)
+                bsdf_weight *= shading_correction(si, wo);
+
+            Mask delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+            Float pdf_rev = pdf_bsdf(si, bsdf, mode, wo, si.to_world(si.wi),
+                                     active && !delta);
+
+            // Dirac delta lobes are excluded from the MIS computation
+            pdf_dir = dr::select(delta, 0.f, bs.pdf);
+            pdf_rev = dr::select(delta, 0.f, pdf_rev);
+
+            Vertex &prev = path[path.size() - 2];
+            prev.pdf_rev = to_area(pdf_rev, si.p, prev.si.p, prev.si.n);
+            path.back().delta = active && delta;
+
+            prev_it    = si;
+            prev_pdf   = bs.pdf;
+            prev_delta = delta;
+
+            beta *= bsdf_weight;
+            eta  *= bs.eta;
+            ray   = si.spawn_ray(wo);
+
+            active &= dr::any(dr::neq(unpolarized_spectrum(beta), 0.f));
+
+            // Russian Roulette
+            if (depth >= (uint32_t) m_rr_depth) {
+                Float q = dr::minimum(
+                    dr::max(unpolarized_spectrum(beta)) * dr::sqr(eta), .95f);
+                active &= sampler->next_1d(active) < q;
+                beta *= dr::rcp(q);
+            }
+
+            // Evaluate each bounce in a separate kernel
+            if constexpr (dr::is_jit_v<Float>) {
+                dr::schedule(path.back(), prev.pdf_rev, ray, beta, eta, active,
+                             prev_it, prev_pdf, prev_delta);
+                if (result)
+                    dr::schedule(*result);
+                sampler->schedule_state();
+                dr::eval();
+            }
+        }
+    }
+
+    /// Contribution of camera subpaths whose vertex \c t - 1 lies on an area emitter
+    Spectrum connect_emitter(const Scene *scene,
+                             const VertexVector &camera, size_t t,
+                             ScalarFloat inv_weight_sum) const {
+        const Vertex &z = camera[t - 1];
+
+        EmitterPtr emitter = z.si.emitter(scene, z.valid);
+        Mask active = z.valid && dr::neq(emitter, nullptr);
+        if (dr::none_or<false>(active))
+            return 0.f;
+
+        Spectrum value = z.beta * emitter->eval(z.si, active);
+
+        if (t == 2)
+            return value;
+
+        /* Densities of sampling the light subpath in reverse, i.e. starting
+           from the emitter position and using cosine-weighted directions */
+        MISVector light, cam = records(camera, t);
+        cam[t - 1].pdf_rev =
+            pdf_emitter_origin(emitter, PositionSample3f(z.si), inv_weight_sum,
+                               active);
+        cam[t - 1].delta = false;
+        cam[t - 2].pdf_rev =
+            to_area(dr::maximum(Frame3f::cos_theta(z.si.wi), 0.f) *
+                        dr::InvPi<ScalarFloat>,
+                    z.si.p, camera[t - 2].si.p, camera[t - 2].si.n);
+
+        return value * mis_weight(light, cam);
+    }
+
+    /// Sample an emitter from vertex \c t - 1 of the camera subpath (s = 1)
+    Connection connect_nee(const Scene *scene, Sampler *sampler,
+                           const VertexVector &camera, size_t t,
+                           const Point2f &pos, ScalarFloat inv_weight_sum,
+                           ScalarFloat sample_scale) const {
+        const Vertex &z = camera[t - 1];
+        Connection c = dr::zeros<Connection>();
+
+        Mask active = z.valid;
+        Point2f sample = sampler->next_2d(active);
+        if (dr::none_or<false>(active))
+            return c;
+
+        BSDFPtr bsdf = z.si.bsdf();
+        active &= has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+        auto [ds, em_weight] =
+            scene->sample_emitter_direction(z.si, sample, false, active);
+        active &= dr::neq(ds.pdf, 0.f);
+        if (dr::none_or<false>(active))
+            return c;
+
+        BSDFContext ctx;
+        auto [bsdf_val, bsdf_pdf] =
+            bsdf->eval_pdf(ctx, z.si, z.si.to_local(ds.d), active);
+
+        // Unidirectional MIS for emitters that do not start light subpaths
+        Float weight = dr::select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+
+        Mask bidir = active &&
+                     has_flag(ds.emitter->flags(), EmitterFlags::Surface) &&
+                     !has_flag(ds.emitter->flags(), EmitterFlags::Infinite);
+
+        if (dr::any_or<true>(bidir)) {
+            /* Treat the sampled position as the endpoint of a light subpath,
+               as if it had been chosen by sample_emitter() */
+            MISRecord y0;
+            y0.pdf_fwd = pdf_emitter_origin(ds.emitter, PositionSample3f(ds),
+                                            inv_weight_sum, bidir);
+            y0.pdf_rev = to_area(bsdf_pdf, z.si.p, ds.p, ds.n);
+            y0.delta   = false;
+
+            MISVector light = { y0 }, cam = records(camera, t);
+            cam[t - 1].pdf_rev =
+                to_area(dr::maximum(-dr::dot(ds.n, ds.d), 0.f) *
+                            dr::InvPi<ScalarFloat>,
+                        ds.p, z.si.p, z.si.n);
+            cam[t - 1].delta = false;
+            if (t > 2)
+                cam[t - 2].pdf_rev = to_area(
+                    pdf_bsdf(z.si, bsdf, TransportMode::Radiance, ds.d,
+                             z.si.to_world(z.si.wi), bidir),
+                    z.si.p, camera[t - 2].si.p, camera[t - 2].si.n);
+
+            dr::masked(weight, bidir) = mis_weight(light, cam);
+        }
+
+        c.ray    = z.si.spawn_ray_to(ds.p);
+        c.pos    = pos;
+        c.value  = z.beta * bsdf_val * em_weight * weight * sample_scale;
+        c.active = active;
+        return c;
+    }
+
+    /// Connect vertex \c s - 1 of the light subpath to vertex \c t - 1 of the camera subpath
+    Connection connect_subpaths(const VertexVector &light,
+                                const VertexVector &camera, size_t s,
+                                size_t t, const Point2f &pos,
+                                ScalarFloat sample_scale) const {
+        const Vertex &y = light[s - 1], &z = camera[t - 1];
+        Connection c = dr::zeros<Connection>();
+
+        Mask active = y.valid && z.valid;
+        if (dr::none_or<false>(active))
+            return c;
+
+        BSDFPtr bsdf_y = y.si.bsdf(), bsdf_z = z.si.bsdf();
+        active &= has_flag(bsdf_y->flags(), BSDFFlags::Smooth) &&
+                  has_flag(bsdf_z->flags(), BSDFFlags::Smooth);
+
+        // Direction from the light vertex towards the camera vertex
+        Vector3f d = z.si.p - y.si.p;
+        Float dist_squared = dr::squared_norm(d);
+        d *= dr::rsqrt(dist_squared);
+
+        BSDFContext ctx_y(TransportMode::Importance), ctx_z;
+        auto [f_y, pdf_y] =
+            bsdf_y->eval_pdf(ctx_y, y.si, y.si.to_local(d), active);
+        auto [f_z, pdf_z] =
+            bsdf_z->eval_pdf(ctx_z, z.si, z.si.to_local(-d), active);
+
+        Spectrum value = y.beta * f_y * shading_correction(y.si, d) *
+                         z.beta * f_z * dr::rcp(dist_squared);
+        active &= dr::any(dr::neq(unpolarized_spectrum(value), 0.f));
+
+        MISVector lgt = records(light, s), cam = records(camera, t);
+        lgt[s - 1].pdf_rev = to_area(pdf_z, z.si.p, y.si.p, y.si.n);
+        lgt[s - 1].delta   = false;
+        lgt[s - 2].pdf_rev = to_area(
+            pdf_bsdf(y.si, bsdf_y, TransportMode::Importance, d,
+                     y.si.to_world(y.si.wi), active),
+            y.si.p, light[s - 2].si.p, light[s - 2].si.n);
+        cam[t - 1].pdf_rev = to_area(pdf_y, y.si.p, z.si.p, z.si.n);
+        cam[t - 1].delta   = false;
+        if (t > 2)
+            cam[t - 2].pdf_rev = to_area(
+                pdf_bsdf(z.si, bsdf_z, TransportMode::Radiance, -d,
+                         z.si.to_world(z.si.wi), active),
+                z.si.p, camera[t - 2].si.p, camera[t - 2].si.n);
+
+        c.ray    = y.si.spawn_ray_to(z.si.p);
+        c.pos    = pos;
+        c.value  = value * mis_weight(lgt, cam) * sample_scale;
+        c.active = active;
+        return c;
+    }
+
+    /// Connect vertex \c s - 1 of the light subpath to the sensor (t = 1)
+    Connection connect_sensor(const Sensor *sensor, Sampler *sampler,
+                              const VertexVector &light, size_t s,
+                              const Spectrum &sensor_beta,
+                              const ImageBlock *block,
+                              ScalarFloat sample_scale) const {
+        const Vertex &y = light[s - 1];
+        Connection c = dr::zeros<Connection>();
+
+        Mask active = y.valid;
+        Point2f sample = sampler->next_2d(active);
+        if (dr::none_or<false>(active))
+            return c;
+
+        BSDFPtr bsdf = y.si.bsdf();
+        active &= has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+        auto [sensor_ds, sensor_weight] =
+            sensor->sample_direction(y.si, sample, active);
+        active &= sensor_ds.pdf > 0.f;
+
+        BSDFContext ctx(TransportMode::Importance);
+        Spectrum f_y = bsdf->eval(ctx, y.si, y.si.to_local(sensor_ds.d), active);
+
+        Spectrum value = y.beta * f_y * shading_correction(y.si, sensor_ds.d) *
+                         sensor_weight * sensor_beta;
+        active &= dr::any(dr::neq(unpolarized_spectrum(value), 0.f));
+
+        MISVector lgt = records(light, s),
+                               cam = { MISRecord{ 1.f, 1.f, false } };
+        lgt[s - 1].pdf_rev =
+            dr::mean(unpolarized_spectrum(sensor_weight)) *
+            dr::abs(dr::dot(y.si.n, sensor_ds.d));
+        lgt[s - 1].delta = false;
+        lgt[s - 2].pdf_rev = to_area(
+            pdf_bsdf(y.si, bsdf, TransportMode::Importance, sensor_ds.d,
+                     y.si.to_world(y.si.wi), active),
+            y.si.p, light[s - 2].si.p, light[s - 2].si.n);
+
+        c.ray    = y.si.spawn_ray_to(sensor_ds.p);
+        c.pos    = sensor_ds.uv + block->offset();
+        c.value  = value * mis_weight(lgt, cam) * sample_scale;
+        c.active = active;
+        return c;
+    }
+
+    /**
+     * \brief Trace the shadow rays of all connections and splat the
+     * contributions of the unoccluded ones.
+     *
+     * In JIT variants, the connections are first gathered into a single
+     * wavefront, so that all visibility tests are performed by one kernel.
+     */
+    void trace_connections(const Scene *scene, ImageBlock *block,
+                           const ConnectionVector &connections,
+                           size_t width) const {
+        if (connections.empty())
+            return;
+
+        if constexpr (dr::is_jit_v<Float>) {
+            Connection batch =
+                dr::zeros<Connection>(connections.size() * width);
+
+            UInt32 index = dr::arange<UInt32>((uint32_t) width);
+            for (size_t i = 0; i < connections.size(); ++i)
+                dr::scatter(batch, connections[i],
+                            index + (uint32_t) (i * width));
+            dr::eval(batch);
+
+            Mask active = batch.active && !scene->ray_test(batch.ray, batch.active);
+            block->put(batch.pos, batch.ray.wavelengths, batch.value,
+                       /* alpha = */ 0.f, /* weight = */ 0.f, active);
+        } else {
+            DRJIT_MARK_USED(width);
+            for (const Connection &c : connections) {
+                if (c.active && !scene->ray_test(c.ray, c.active))
+                    block->put(c.pos, c.ray.wavelengths, c.value,
+                               /* alpha = */ 0.f, /* weight = */ 0.f);
+            }
+        }
+    }
+
+    /**
+     * \brief Compute the MIS weight (power heuristic) of the strategy that
+     * combines \c light.size() light and \c camera.size() camera vertices
+     *
+     * The densities of the connection vertices and their predecessors must
+     * already account for the connection [Veach 1997, Sec. 10.2].
+     */
+    Float mis_weight(const MISVector &light,
+                     const MISVector &camera) const {
+        size_t s = light.size(), t = camera.size();
+        if (s + t == 2)
+            return 1.f;
+
+        // Delta lobes have a zero density, which must not enter the ratios
+        auto ratio = [](const Float &pdf_num, const Float &pdf_den) {
+            return dr::sqr(dr::select(dr::neq(pdf_num, 0.f), pdf_num, 1.f) /
+                           dr::select(dr::neq(pdf_den, 0.f), pdf_den, 1.f));
+        };
+
+        // Strategies that sample fewer vertices from the camera
+        Float sum = 0.f, r = 1.f;
+        for (size_t i = t - 1; i > 0; --i) {
+            r *= ratio(camera[i].pdf_rev, camera[i].pdf_fwd);
+            dr::masked(sum, !camera[i].delta && !camera[i - 1].delta) += r;
+        }
+
+        // Strategies that sample fewer vertices from the emitter
+        r = 1.f;
+        for (size_t i = s; i-- > 0;) {
+            r *= ratio(light[i].pdf_rev, light[i].pdf_fwd);
+            Mask delta_prev = i > 0 ? light[i - 1].delta : Mask(false);
+            dr::masked(sum, !light[i].delta && !delta_prev) += r;
+        }
+
+        return dr::rcp(1.f + sum);
+    }
+
+    /// Compute a multiple importance sampling weight using the power heuristic
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        Float w = pdf_a / (pdf_a + pdf_b);
+        return dr::select(dr::isfinite(w), w, 0.f);
+    }
+
+    /// Copy the densities of the first \c n vertices of a subpath
+    static MISVector records(const VertexVector &path,
+                                          size_t n) {
+        MISVector result(n);
+        for (size_t i = 0; i < n; ++i)
+            result[i] = MISRecord{ path[i].pdf_fwd, path[i].pdf_rev,
+                                   path[i].delta };
+        return result;
+    }
+
+    /// Convert a solid angle density at \c p_from into an area density at \c p_to
+    static Float to_area(const Float &pdf, const Point3f &p_from,
+                         const Point3f &p_to, const Normal3f &n_to) {
+        Vector3f d = p_to - p_from;
+        Float inv_dist_squared = dr::rcp(dr::squared_norm(d));
+        Float value = pdf * dr::abs(dr::dot(n_to, d)) *
+                      dr::sqrt(inv_dist_squared) * inv_dist_squared;
+        return dr::select(dr::isfinite(value), value, 0.f);
+    }
+
+    /// Solid angle density of sampling \c wo given \c wi (both in world space)
+    static Float pdf_bsdf(const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                          TransportMode mode, const Vector3f &wi,
+                          const Vector3f &wo, Mask active) {
+        SurfaceInteraction3f si_rev = si;
+        si_rev.wi = si.to_local(wi);
+        BSDFContext ctx(mode);
+        return bsdf->pdf(ctx, si_rev, si.to_local(wo), active);
+    }
+
+    /// Adjoint BSDF for shading normals -- [Veach, p. 155]
+    static Float shading_correction(const SurfaceInteraction3f &si,
+                                    const Vector3f &wo) {
+        Vector3f wo_local = si.to_local(wo);
+
+        // Using geometric normals
+        Float wi_dot_geo_n = dr::dot(si.n, si.to_world(si.wi)),
+              wo_dot_geo_n = dr::dot(si.n, wo);
+
+        // Prevent light leaks due to shading normals
+        Mask valid = (wi_dot_geo_n * Frame3f::cos_theta(si.wi) > 0.f) &&
+                     (wo_dot_geo_n * Frame3f::cos_theta(wo_local) > 0.f);
+
+        return dr::select(
+            valid,
+            dr::abs((Frame3f::cos_theta(si.wi) * wo_dot_geo_n) /
+                    (Frame3f::cos_theta(wo_local) * wi_dot_geo_n)),
+            0.f);
+    }
+
+    /// Area density of sampling \c ps as the origin of a light subpath
+    static Float pdf_emitter_origin(const EmitterPtr &emitter,
+                                    const PositionSample3f &ps,
+                                    ScalarFloat inv_weight_sum, Mask active) {
+        return Float(emitter->sampling_weight()) * inv_weight_sum *
+               emitter->pdf_position(ps, active);
+    }
+
+    /// Area density of sampling the first vertex \c si of a camera subpath
+    static Float pdf_sensor(const Sensor *sensor, const SurfaceInteraction3f &si,
+                            Mask active) {
+        /* For a pinhole camera, the directional importance equals the solid
+           angle density of sample_ray(), and sample_direction() already
+           divides it by the squared distance */
+        auto [ds, weight] = sensor->sample_direction(si, Point2f(.5f), active);
+        return dr::select(ds.pdf > 0.f,
+                          dr::mean(unpolarized_spectrum(weight)) *
+                              dr::abs(dr::dot(si.n, ds.d)),
+                          0.f);
+    }
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(BidirectionalPathIntegrator, AdjointIntegrator);
+MI_EXPORT_PLUGIN(BidirectionalPathIntegrator, "Bidirectional path tracer integrator");
+NAMESPACE_END(mitsuba)
@@ -120,7 +120,7 @@ public:
         MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
         SurfaceInteraction3f si = scene->ray_intersect(
-            ray, +RayFlags::All, /* coherent = */ true, active);
+            ray, scene->ray_flags(), /* coherent = */ true, active);
         Mask valid_ray = active && si.is_valid();
 
         Spectrum result(0.f);
@@ -145,27 +145,44 @@ public:
         Mask sample_emitter = active && has_flag(flags, BSDFFlags::Smooth);
 
         if (dr::any_or<true>(sample_emitter)) {
-            for (size_t i = 0; i < m_emitter_samples; ++i) {
-                Mask active_e = sample_emitter;
-                DirectionSample3f ds;
-                Spectrum emitter_val;
-                std::tie(ds, emitter_val) = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
-                active_e &= dr::neq(ds.pdf, 0.f);
-                if (dr::none_or<false>(active_e))
-                    continue;
-
-                // Query the BSDF for that emitter-sampled direction
-                Vector3f wo = si.to_local(ds.d);
-
-                /* Determine BSDF value and probability of having sampled
-                   that same direction using BSDF sampling. */
-                auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
-                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
-
-                Float mis = dr::select(ds.delta, Float(1.f), mis_weight(
-                    ds.pdf * m_frac_lum, bsdf_pdf * m_frac_bsdf) * m_weight_lum);
-                result[active_e] += mis * bsdf_val * emitter_val;
+            /* In scalar variants, the shadow rays of several emitter samples
+               are traced together using \ref Scene::ray_test_batch() */
+            constexpr size_t BatchSize = dr::is_jit_v<Float> ? 1 : 16;
+            DirectionSample3f ds[BatchSize];
+            Spectrum emitter_val[BatchSize];
+            Ray3f rays[BatchSize];
+            Mask active_e[BatchSize], occluded[BatchSize];
+
+            for (size_t i = 0; i < m_emitter_samples; i += BatchSize) {
+                size_t count = std::min(BatchSize, m_emitter_samples - i);
+
+                for (size_t j = 0; j < count; ++j) {
+                    active_e[j] = sample_emitter;
+                    std::tie(ds[j], emitter_val[j]) = scene->sample_emitter_direction(
+                        si, sampler->next_2d(active_e[j]), false, active_e[j]);
+                    active_e[j] &= dr::neq(ds[j].pdf, 0.f);
+                    rays[j] = si.spawn_ray_to(ds[j].p);
+                }
+
+                scene->ray_test_batch(rays, active_e, occluded, count);
+
+                for (size_t j = 0; j < count; ++j) {
+                    active_e[j] &= !occluded[j];
+                    if (dr::none_or<false>(active_e[j]))
+                        continue;
+
+                    // Query the BSDF for that emitter-sampled direction
+                    Vector3f wo = si.to_local(ds[j].d);
+
+                    /* Determine BSDF value and probability of having sampled
+                       that same direction using BSDF sampling. */
+                    auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e[j]);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                    Float mis = dr::select(ds[j].delta, Float(1.f), mis_weight(
+                        ds[j].pdf * m_frac_lum, bsdf_pdf * m_frac_bsdf) * m_weight_lum);
+                    result[active_e[j]] += mis * bsdf_val * emitter_val[j];
+                }
             }
         }
 
@@ -180,7 +197,9 @@ public:
 
             // Trace the ray in the sampled direction and intersect against the scene
             SurfaceInteraction3f si_bsdf =
-                scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)), active_b);
+                scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)),
+                                     scene->ray_flags(),
+                                     /* coherent = */ false, active_b);
 
             // Retain only rays that hit an emitter
             EmitterPtr emitter = si_bsdf.emitter(scene, active_b);
@@ -18,9 +18,24 @@ Moment integrator (:monosp:`moment`)
    - Sub-integrators (can have more than one) which will be sampled along the AOV integrator. Their
      respective XYZ output will be put into distinct images.
 
+ * - variance
+   - |bool|
+   - Output the per-pixel sample variance instead of the second moment. (Default: |false|)
+
 This integrator returns one AOVs recording the second moment of the samples of the nested
 integrator.
 
+With :monosp:`variance` enabled, the AOVs named :monosp:`var_*` instead contain the
+unbiased sample variance of every pixel, which the image blocks update with Welford's
+streaming algorithm and merge across passes and threads with its parallel formulation
+:cite:`Chan1982Updating`. The variance computed from the second moment (as
+:math:`E[X^2] - E[X]^2`) cancels catastrophically in single precision once many
+samples with a large mean are accumulated, which this avoids. Every sample counts
+towards the pixel that contains it, irrespective of the reconstruction filter. The
+statistics take :math:`2n+1` values per pixel for :math:`n` channels in addition to the
+AOVs, and films with a special channel layout (e.g. :ref:`specfilm <film-specfilm>`)
+do not support this mode.
+
 .. tabs::
     .. code-tab:: xml
 
@@ -44,6 +59,8 @@ public:
     MI_IMPORT_TYPES(Scene, Sampler, Medium)
 
     MomentIntegrator(const Properties &props) : Base(props) {
+        m_variance = props.get<bool>("variance", false);
+
         // Get the nested integrators and their AOVs
         for (auto &kv : props.objects()) {
             Base *integrator = dynamic_cast<Base *>(kv.second.get());
@@ -59,10 +76,10 @@ public:
             m_aov_names.push_back(kv.first + ".Z");
         }
 
-        // For every AOV, add a corresponding "m2_" AOV
+        // For every AOV, add a corresponding "m2_" (or "var_") AOV
         size_t aov_count = m_aov_names.size();
         for (size_t i = 0; i < aov_count; i++)
-            m_aov_names.push_back("m2_" + m_aov_names[i]);
+            m_aov_names.push_back((m_variance ? "var_" : "m2_") + m_aov_names[i]);
     }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
@@ -99,9 +116,11 @@ public:
 
             *aovs++ = xyz.x(); *aovs++ = xyz.y(); *aovs++ = xyz.z();
 
-            // Write second moment AOVs
+            /* Write second moment AOVs (the image block computes the
+               variance from the samples of the first half in variance mode) */
             for (size_t j = 0; j < m_integrators[i].second + 3; j++)
-                *(aovs - j + offset - 1) = dr::sqr(*(aovs - j - 1));
+                *(aovs - j + offset - 1) =
+                    m_variance ? Float(0.f) : dr::sqr(*(aovs - j - 1));
 
             if (i == 0)
                 result = result_sub;
@@ -114,6 +133,11 @@ public:
         return m_aov_names;
     }
 
+    std::tuple<uint32_t, uint32_t, uint32_t> variance_aovs() const override {
+        uint32_t count = m_variance ? (uint32_t) m_aov_names.size() / 2 : 0u;
+        return { 0u, count, count };
+    }
+
     void traverse(TraversalCallback *callback) override {
         for (size_t i = 0; i < m_integrators.size(); ++i)
             callback->put_object("integrator_" + std::to_string(i),
@@ -125,6 +149,7 @@ public:
         std::ostringstream oss;
         oss << "Scene[" << std::endl
             << "  aovs = " << m_aov_names << "," << std::endl
+            << "  variance = " << m_variance << "," << std::endl
             << "  integrators = [" << std::endl;
         for (size_t i = 0; i < m_integrators.size(); ++i) {
             oss << "    " << string::indent(m_integrators[i].first, 4);
@@ -139,6 +164,7 @@ public:
 
     MI_DECLARE_CLASS()
 private:
+    bool m_variance;
     std::vector<std::string> m_aov_names;
     std::vector<std::pair<ref<Base>, size_t>> m_integrators;
 };
@@ -1,9 +1,15 @@
+#include <array>
+#include <optional>
 #include <tuple>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/stats.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
+#include <mitsuba/render/guiding.h>
 #include <mitsuba/render/integrator.h>
+#include <mitsuba/render/lpe.h>
+#include <mitsuba/render/mueller.h>
 #include <mitsuba/render/records.h>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -35,6 +41,118 @@ Path tracer (:monosp:`path`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - adaptive_threshold
+   - |float|
+   - Enables adaptive sampling when set to a positive value. Pixels whose
+     relative standard error falls below this threshold stop receiving
+     samples, and the freed budget is spent on the remaining pixels. The
+     parameters :monosp:`adaptive_min_spp` (Default: 16) and
+     :monosp:`adaptive_max_spp` (Default: 4 times the sample count) bound
+     the number of samples per pixel. This parameter is shared by all
+     sampling-based integrators. (Default: 0, i.e. disabled)
+
+ * - time_budget
+   - |float|
+   - Wall-clock time in seconds to spend on a render. The samples are then
+     taken in rounds (scalar variants) or passes (JIT variants) whose size
+     is chosen from the measured throughput of the previous ones, so that
+     the budget is used up without exceeding the sample count of the
+     sampler, which becomes an upper bound. Combined with adaptive
+     sampling, the render stops early once all pixels have converged.
+     Scalar variants interrupt a round that would exceed the budget, and
+     JIT variants skip a pass that is not expected to finish in time. This
+     parameter is shared by all sampling-based integrators.
+     (Default: 0, i.e. disabled)
+
+ * - numa
+   - |bool|
+   - Pin the rendering threads of scalar variants to NUMA nodes. The threads
+     of each node accumulate their samples into a separate copy of the image
+     that is allocated in node-local memory, which reduces cross-socket
+     traffic on multi-socket machines at the cost of one image buffer per
+     node. This parameter is shared by all sampling-based integrators and
+     has no effect on machines with a single node. (Default: |false|)
+
+ * - priority_offset_x, priority_offset_y, priority_width, priority_height
+   - |int|
+   - Region of interest (in pixels of the film, like its crop window) whose
+     image blocks scalar variants render first. When the render does not
+     need to stop after every pass (e.g. to save its state or to train
+     guiding), all passes over the blocks of the region are rendered before
+     the rest of the image, so that the region converges first. Otherwise,
+     the region comes first in every pass. The image is identical to a
+     render without a region. These parameters are shared by all
+     sampling-based integrators. (Default: 0, i.e. disabled)
+
+ * - filter_importance_sampling
+   - |bool|
+   - Distribute the camera samples of every pixel according to the
+     reconstruction filter of the film and add each of them to its pixel
+     alone, instead of splatting it over the footprint of the filter. This
+     reduces the accesses to the image (and the atomic operations of JIT
+     variants) by the area of the footprint, e.g. 16 times for the
+     :ref:`gaussian <rfilter-gaussian>` filter. Filters with negative lobes
+     produce negative sample weights. The :monosp:`sample_border` parameter
+     of the film is ignored in this mode. This parameter is shared by all
+     sampling-based integrators. (Default: |false|)
+
+ * - guiding
+   - |bool|
+   - Learn the distribution of incident radiance during the first rendering
+     passes and use it to guide the sampling of directions (see below).
+     Requires multiple passes, i.e. :monosp:`samples_per_pass` must be
+     smaller than the sample count. (Default: |false|)
+
+ * - guiding_passes
+   - |int|
+   - Number of initial passes whose paths are used to train the guiding
+     field. Subsequent passes only sample from it. (Default: 4)
+
+ * - guiding_prob
+   - |float|
+   - Probability of sampling a direction from the guiding field rather than
+     from the BSDF. (Default: 0.5)
+
+ * - guiding_grid
+   - |int|
+   - Resolution of the regular grid of cells along each axis of the scene's
+     bounding box. (Default: 16)
+
+ * - guiding_bins
+   - |int|
+   - Resolution of the directional histogram of every cell along each
+     axis. (Default: 16)
+
+ * - adrrs
+   - |bool|
+   - Replace the throughput-based Russian roulette by adjoint-driven Russian
+     roulette and splitting, which terminates or splits paths based on an
+     estimate of their contribution to the image (see below). Like guiding,
+     this requires multiple passes. (Default: |false|)
+
+ * - adrrs_window
+   - |float|
+   - Ratio between the upper and lower bound of the weight window. Paths
+     whose expected contribution falls inside of the window are traced
+     normally. (Default: 5)
+
+ * - adrrs_max_split
+   - |int|
+   - Maximum number of paths that a single path is split into. (Default: 8)
+
+ * - ray_cones
+   - |bool|
+   - Track the footprint of the path as a ray cone and use it to compute the
+     texture coordinate partials at every vertex (see below). (Default:
+     |false|)
+
+ * - lpe
+   - |string|
+   - Comma-separated list of :monosp:`name:expression` pairs of light path
+     expressions, whose contributions are written to additional RGB image
+     channels named :monosp:`name.R`, :monosp:`name.G` and :monosp:`name.B`
+     (see below). (Default: none)
+
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
 
@@ -67,6 +185,88 @@ relies on multiple importance sampling to combine BSDF and emitter samples. The
 main difference in comparison to the former plugin is that it considers light
 paths of arbitrary length to compute both direct and indirect illumination.
 
+Scenes that are mostly lit indirectly (e.g. interiors illuminated through a
+small opening) are challenging for this strategy, since BSDF sampling is
+oblivious to where the light comes from. When :monosp:`guiding` is enabled,
+the rendering passes are split into a training phase and a rendering phase.
+During training, the radiance arriving at the first vertices of every path is
+recorded into a *guiding field*: a regular grid over the scene whose cells
+store histograms over the sphere of directions. After every training pass,
+these histograms are turned into sampling densities, and subsequent passes
+draw directions from them with probability :monosp:`guiding_prob` (using
+one-sample multiple importance sampling with the BSDF). Surfaces whose BSDF
+has Dirac delta components are never guided. All passes, including the
+training passes, contribute to the final image.
+
+The standard Russian roulette only looks at the path throughput, which wastes
+work on paths that carry little light to the sensor in heavily occluded
+scenes, while under-sampling the important ones. When :monosp:`adrrs` is
+enabled, every vertex instead compares the expected contribution of the path
+(its throughput times the average incident radiance that the guiding field
+recorded in the vertex's cell) to an estimate of the pixel value obtained in
+the same way at the first vertex :cite:`Vorba2016Adjoint`. Paths whose ratio
+falls below the weight window are terminated with a matching probability,
+and paths above the window are split: the vertex is revisited by additional
+paths (that share its incident ray and only differ in the sampled
+continuation), each carrying an equal share of the weight. The guiding field
+is trained during the first :monosp:`guiding_passes` passes, which use the
+standard Russian roulette, and directions are only drawn from it when
+:monosp:`guiding` is also set.
+
+Filtered texture lookups (e.g. :ref:`bitmap <texture-bitmap>` textures with
+:monosp:`trilinear` filtering) select their resolution from the texture
+coordinate partials of the surface interaction. By default, these are not
+available along paths. When :monosp:`ray_cones` is enabled, the footprint of
+every path is tracked with a *ray cone* :cite:`AkenineMoller2019Texture`,
+defined by a width and a spread angle. The initial cone is derived from the
+ray differentials of the sensor. The width grows linearly with the traveled
+distance, and the footprint at every vertex determines the texture
+coordinate partials. At non-specular vertices, the spread angle increases by
+the apex angle of the cone whose solid angle matches the inverse density of
+the sampled direction: rough and diffuse surfaces widen the cone much more
+than glossy ones. Specular vertices keep the spread angle (the curvature of
+the surface is ignored). Secondary bounces thus look up coarse texture
+levels, which avoids cache thrashing at full resolution.
+
+Compositing workflows often need the image split into components, e.g. direct
+and indirect, diffuse and specular illumination, or the light of individual
+emitters. The :monosp:`lpe` parameter computes such components in the same
+render using *light path expressions*: regular expressions over the
+scattering events of a path, from the sensor (:monosp:`C`, optional) to the
+emitter (:monosp:`L`). The events are :monosp:`D` (diffuse reflection),
+:monosp:`G` (glossy reflection), :monosp:`S` (specular reflection) and
+:monosp:`T` (transmission), and they are classified by the BSDF lobe that was
+sampled at the vertex. They can be combined with :monosp:`.` (any event), sets
+like :monosp:`[DG]` or :monosp:`[^D]`, alternatives (:monosp:`|`), parentheses
+and the repetition operators :monosp:`*`, :monosp:`+` and :monosp:`?`. The
+emitter event :monosp:`L'prefix'` only matches emitters whose identifier
+starts with :monosp:`prefix`. For example,
+
+.. code-block:: text
+
+    direct:C.L, indirect:C..+L, caustics:C D S+ L, key:C.*L'key'
+
+splits the illumination into direct and indirect light, extracts caustics on
+diffuse surfaces, and isolates the light of the emitters whose identifier
+starts with :monosp:`key`. Every expression is compiled into a deterministic
+automaton, and the path tracer stores the states of all automata in a single
+32 bit integer per path. Emitter samples are split between the events by
+evaluating the BSDF separately for its diffuse, glossy and transmissive lobes,
+which relies on the BSDF honoring the component flags of its context. Null
+events are ignored, and expressions that match the same path both receive its
+contribution.
+
+At most 16 expressions are supported. When the path tracer is nested in an
+:ref:`aov <integrator-aov>` integrator, the channels are prefixed by the name
+of the nested integrator.
+
+In JIT variants, the random walk is compiled into a single megakernel by
+default. Neighboring paths that hit surfaces with different BSDFs then
+execute different shading code, which makes the SIMD lanes (LLVM) or warps
+(CUDA) diverge after the first bounce. In scenes with many materials, the
+:ref:`wavefront path tracer <integrator-wavefront>` computes the same
+estimate while grouping the paths by BSDF before shading them.
+
 .. note:: This integrator does not handle participating media
 
 .. tabs::
@@ -88,26 +288,111 @@ template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
-    MI_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
+    MI_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr,
+                    GuidingField, LightPathExpressions)
+    using LPEEvent = typename LightPathExpressions::Event;
+
+    PathIntegrator(const Properties &props) : Base(props) {
+        m_guiding        = props.get<bool>("guiding", false);
+        m_guiding_passes = props.get<uint32_t>("guiding_passes", 4);
+        m_guiding_prob   = props.get<ScalarFloat>("guiding_prob", .5f);
+        m_guiding_grid   = props.get<uint32_t>("guiding_grid", 16);
+        m_guiding_bins   = props.get<uint32_t>("guiding_bins", 16);
+
+        if (m_guiding_prob < 0.f || m_guiding_prob > 1.f)
+            Throw("\"guiding_prob\" must be in the range [0, 1]!");
+
+        m_adrrs           = props.get<bool>("adrrs", false);
+        m_adrrs_window    = props.get<ScalarFloat>("adrrs_window", 5.f);
+        m_adrrs_max_split = props.get<uint32_t>("adrrs_max_split", 8);
+
+        if (m_adrrs_window < 1.f)
+            Throw("\"adrrs_window\" must be at least 1!");
+        if (m_adrrs_max_split < 1)
+            Throw("\"adrrs_max_split\" must be at least 1!");
+
+        m_ray_cones = props.get<bool>("ray_cones", false);
+
+        if (props.has_property("lpe")) {
+            m_lpe = new LightPathExpressions(props.string("lpe"));
+            for (const std::string &name : m_lpe->names()) {
+                m_aov_names.push_back(name + ".R");
+                m_aov_names.push_back(name + ".G");
+                m_aov_names.push_back(name + ".B");
+            }
+        }
+    }
+
+    std::vector<std::string> aov_names() const override { return m_aov_names; }
 
-    PathIntegrator(const Properties &props) : Base(props) { }
+    void render_begin(const Scene *scene, uint32_t n_passes) override {
+        // Resolve the light groups of the light path expressions
+        if (m_lpe)
+            m_lpe->set_emitters(scene->emitters());
+
+        m_guiding_field = nullptr;
+        m_guiding_train = false;
+        if (!m_guiding && !m_adrrs)
+            return;
+
+        if (n_passes < 2) {
+            Log(Warn, "Path guiding and adjoint-driven Russian roulette "
+                      "require multiple rendering passes (set "
+                      "\"samples_per_pass\" to a fraction of the sample "
+                      "count), disabling them.");
+            return;
+        }
+
+        m_guiding_field = new GuidingField(scene->bbox(), m_guiding_grid,
+                                           m_guiding_bins);
+        m_guiding_train = m_guiding_passes > 0;
+    }
+
+    void render_pass_end(uint32_t pass) override {
+        if (!m_guiding_train)
+            return;
+
+        m_guiding_field->update();
+        m_guiding_train = pass + 1 < m_guiding_passes;
+    }
+
+    bool needs_pass_callback() const override { return m_guiding || m_adrrs; }
 
     std::pair<Spectrum, Bool> sample(const Scene *scene,
                                      Sampler *sampler,
                                      const RayDifferential3f &ray_,
                                      const Medium * /* medium */,
-                                     Float * /* aovs */,
+                                     Float *aovs,
                                      Bool active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
-        if (unlikely(m_max_depth == 0))
+        const LightPathExpressions *lpe = m_lpe.get();
+        size_t lpe_count = lpe ? lpe->size() : 0;
+
+        if (unlikely(m_max_depth == 0)) {
+            for (size_t i = 0; i < 3 * lpe_count; ++i)
+                *aovs++ = 0.f;
             return { 0.f, false };
+        }
+
+        /* Sample from and/or train the guiding field? Its radiance estimates
+           drive the Russian roulette and splitting once training is over,
+           since the recorded vertices assume a single path per sample. */
+        const GuidingField *guiding = m_guiding_field.get();
+        bool guide = m_guiding && guiding && guiding->ready(),
+             train = guiding && m_guiding_train,
+             adrrs = m_adrrs && guiding && guiding->ready() && !train;
+
+        std::optional<typename GuidingField::Vertices> vertices;
+        if (train)
+            vertices.emplace(dr::width(ray_));
 
         // --------------------- Configure loop state ----------------------
 
         Ray3f ray                     = Ray3f(ray_);
         Spectrum throughput           = 1.f;
         Spectrum result               = 0.f;
+        Mask depolarized              = false; // see spec_mul()
         Float eta                     = 1.f;
         UInt32 depth                  = 0;
 
@@ -120,6 +405,71 @@ public:
         Bool          prev_bsdf_delta = true;
         BSDFContext   bsdf_ctx;
 
+        // Width and spread angle of the ray cone (if enabled)
+        Float cone_width              = 0.f;
+        Float cone_spread             = 0.f;
+        if (m_ray_cones && ray_.has_differentials) {
+            cone_width  = dr::norm(ray_.o_x - ray_.o);
+            cone_spread = dr::unit_angle(ray_.d, dr::normalize(ray_.d_x));
+        }
+
+        /* State of the adjoint-driven Russian roulette and splitting. A split
+           path stores its vertex (via the incident ray and the state before
+           the vertex) and revisits it once the current path terminates. */
+        Float pixel_estimate          = 0.f;
+        UInt32 splits                 = 0;
+        Bool resumed                  = false;
+        Ray3f split_ray               = dr::zeros<Ray3f>();
+        Spectrum split_throughput     = 0.f;
+        Float split_eta               = 1.f;
+        UInt32 split_depth            = 0;
+        Interaction3f split_prev_si   = dr::zeros<Interaction3f>();
+        Float split_prev_bsdf_pdf     = 1.f;
+        Bool split_prev_bsdf_delta    = true;
+        Float split_cone_width        = 0.f;
+        Float split_cone_spread       = 0.f;
+
+        /* Light path expressions: per-expression radiance and the packed state
+           of all automata (which a split path restores along with the rest) */
+        std::array<Spectrum, LightPathExpressions::MaxCount> lpe_result;
+        for (size_t i = 0; i < lpe_count; ++i)
+            lpe_result[i] = 0.f;
+        UInt32 lpe_state              = lpe ? lpe->initial_state() : 0u;
+        UInt32 split_lpe_state        = lpe_state;
+
+        // Add a contribution to the expressions selected by a bit mask
+        auto accumulate_lpe = [&](const UInt32 &mask, const Spectrum &value,
+                                  Mask active_lpe) {
+            for (size_t i = 0; i < lpe_count; ++i)
+                dr::masked(lpe_result[i],
+                           active_lpe && dr::neq(mask & (1u << i), 0u)) += value;
+        };
+
+        // Restart terminated paths from their pending split vertex
+        auto resume_split = [&](Mask alive) {
+            Mask restart = !alive && splits > 0u;
+            dr::masked(ray, restart)             = split_ray;
+            dr::masked(throughput, restart)      = split_throughput;
+            dr::masked(eta, restart)             = split_eta;
+            dr::masked(depth, restart)           = split_depth;
+            dr::masked(prev_si, restart)         = split_prev_si;
+            dr::masked(prev_bsdf_pdf, restart)   = split_prev_bsdf_pdf;
+            dr::masked(prev_bsdf_delta, restart) = split_prev_bsdf_delta;
+            dr::masked(cone_width, restart)      = split_cone_width;
+            dr::masked(cone_spread, restart)     = split_cone_spread;
+            dr::masked(lpe_state, restart)       = split_lpe_state;
+            dr::masked(splits, restart)         -= 1u;
+            if constexpr (is_polarized_v<Spectrum> && !dr::is_array_v<Float>)
+                dr::masked(depolarized, restart) = mueller::is_depolarizer(throughput);
+            resumed = restart;
+            return alive || restart;
+        };
+
+        // Only compute the surface interaction fields needed by the scene
+        uint32_t ray_flags = scene->ray_flags();
+        if (m_ray_cones)
+            ray_flags |= RayFlags::UV | RayFlags::dPdUV;
+
         /* Set up a Dr.Jit loop. This optimizes away to a normal loop in scalar
            mode, and it generates either a a megakernel (default) or
            wavefront-style renderer in JIT variants. This can be controlled by
@@ -130,14 +480,23 @@ public:
            debugging. The subsequent list registers all variables that encode
            the loop state variables. This is crucial: omitting a variable may
            lead to undefined behavior. */
-        dr::Loop<Bool> loop("Path Tracer", sampler, ray, throughput, result,
-                            eta, depth, valid_ray, prev_si, prev_bsdf_pdf,
-                            prev_bsdf_delta, active);
+        dr::Loop<Bool> loop("Path Tracer");
+        loop.put(ray, throughput, result, eta, depth, valid_ray, prev_si,
+                 prev_bsdf_pdf, prev_bsdf_delta, pixel_estimate, splits,
+                 resumed, split_ray, split_throughput, split_eta, split_depth,
+                 split_prev_si, split_prev_bsdf_pdf, split_prev_bsdf_delta,
+                 cone_width, cone_spread, split_cone_width, split_cone_spread,
+                 lpe_state, split_lpe_state, active);
+        for (size_t i = 0; i < lpe_count; ++i)
+            loop.put(lpe_result[i]);
+        sampler->loop_put(loop);
+        loop.init();
 
         /* Inform the loop about the maximum number of loop iterations.
            This accelerates wavefront-style rendering by avoiding costly
-           synchronization points that check the 'active' flag. */
-        loop.set_max_iterations(m_max_depth);
+           synchronization points that check the 'active' flag. Split paths
+           revisit vertices, hence there is no such bound for them. */
+        loop.set_max_iterations(adrrs ? (uint32_t) -1 : m_max_depth);
 
         while (loop(active)) {
             /* dr::Loop implicitly masks all code in the loop using the 'active'
@@ -145,7 +504,7 @@ public:
 
             SurfaceInteraction3f si =
                 scene->ray_intersect(ray,
-                                     /* ray_flags = */ +RayFlags::All,
+                                     /* ray_flags = */ ray_flags,
                                      /* coherent = */ dr::eq(depth, 0u));
 
             // ---------------------- Direct emission ----------------------
@@ -163,21 +522,90 @@ public:
                     em_pdf = scene->pdf_emitter_direction(prev_si, ds,
                                                           !prev_bsdf_delta);
 
-                // Compute MIS weight for emitter sample from previous bounce
-                Float mis_bsdf = mis_weight(prev_bsdf_pdf, em_pdf);
+                /* Compute MIS weight for emitter sample from previous bounce.
+                   A resumed split path already accounted for this emission. */
+                Float mis_bsdf = dr::select(resumed, 0.f,
+                                            mis_weight(prev_bsdf_pdf, em_pdf));
 
                 // Accumulate, being careful with polarization (see spec_fma)
-                result = spec_fma(
-                    throughput,
-                    ds.emitter->eval(si, prev_bsdf_pdf > 0.f) * mis_bsdf,
-                    result);
+                Spectrum emitted =
+                    ds.emitter->eval(si, prev_bsdf_pdf > 0.f) * mis_bsdf;
+                result = spec_fma(throughput, emitted, result, depolarized);
+
+                if (lpe)
+                    accumulate_lpe(lpe->accept(lpe_state, ds.emitter),
+                                   spec_mul(throughput, emitted, depolarized),
+                                   true);
             }
 
+            resumed = false;
+
             // Continue tracing the path at this point?
             Bool active_next = (depth + 1 < m_max_depth) && si.is_valid();
 
-            if (dr::none_or<false>(active_next))
-                break; // early exit for scalar mode
+            if (dr::none_or<false>(active_next)) {
+                // Early exit for scalar mode (unless a split path is pending)
+                active = resume_split(false);
+                if (dr::none_or<false>(active))
+                    break;
+                continue;
+            }
+
+            // ------------ Adjoint-driven Russian roulette & splitting ------------
+
+            Mask active_adrrs = false;
+            if (adrrs) {
+                Float estimate = guiding->radiance(si.p, active_next);
+
+                // Estimate the pixel value at the first vertex
+                dr::masked(pixel_estimate, active_next && dr::eq(depth, 0u)) =
+                    dr::mean(unpolarized_spectrum(result)) + estimate;
+
+                // Expected contribution relative to the center of the window
+                Float ratio = dr::mean(unpolarized_spectrum(throughput)) *
+                              estimate / pixel_estimate;
+                active_adrrs = active_next && depth > 0u && estimate > 0.f &&
+                               pixel_estimate > 0.f;
+
+                ScalarFloat lower = 2.f / (1.f + m_adrrs_window),
+                            upper = m_adrrs_window * lower;
+
+                Mask rr_active = active_adrrs && ratio < lower;
+                if (dr::any_or<true>(rr_active)) {
+                    Mask rr_continue = sampler->next_1d(rr_active) < ratio;
+                    throughput[rr_active && rr_continue] *=
+                        dr::rcp(dr::detach(ratio));
+                    active_next &= !rr_active || rr_continue;
+                }
+
+                // Only one split vertex can be pending at a time
+                Mask split = active_adrrs && ratio > upper && dr::eq(splits, 0u);
+                if (dr::any_or<true>(split)) {
+                    UInt32 n = UInt32(dr::minimum(dr::detach(ratio),
+                                                  (ScalarFloat) m_adrrs_max_split));
+                    split &= n > 1u;
+                    throughput[split] *= dr::rcp(Float(n));
+
+                    dr::masked(split_ray, split)             = ray;
+                    dr::masked(split_throughput, split)      = throughput;
+                    dr::masked(split_eta, split)             = eta;
+                    dr::masked(split_depth, split)           = depth;
+                    dr::masked(split_prev_si, split)         = prev_si;
+                    dr::masked(split_prev_bsdf_pdf, split)   = prev_bsdf_pdf;
+                    dr::masked(split_prev_bsdf_delta, split) = prev_bsdf_delta;
+                    dr::masked(split_cone_width, split)      = cone_width;
+                    dr::masked(split_cone_spread, split)     = cone_spread;
+                    dr::masked(split_lpe_state, split)       = lpe_state;
+                    dr::masked(splits, split)                = n - 1u;
+                }
+            }
+
+            // Texture footprint of the ray cone at this vertex
+            Float vertex_cone_width = 0.f;
+            if (m_ray_cones) {
+                vertex_cone_width = dr::fmadd(cone_spread, si.t, cone_width);
+                si.compute_uv_partials(cone_ray(ray, vertex_cone_width));
+            }
 
             BSDFPtr bsdf = si.bsdf(ray);
 
@@ -214,6 +642,31 @@ public:
 
             auto [bsdf_val, bsdf_pdf, bsdf_sample, bsdf_weight]
                 = bsdf->eval_pdf_sample(bsdf_ctx, si, wo, sample_1, sample_2);
+            stats_count(StatsCounter::BSDFSample, active_next);
+
+            // ------------------------ Path guiding ------------------------
+
+            // Dirac delta lobes are neither guided nor used for training
+            Mask active_guide = active_next &&
+                !has_flag(bsdf->flags(), BSDFFlags::Delta);
+
+            if (guide) {
+                Float guide_1 = sampler->next_1d();
+                Point2f guide_2 = sampler->next_2d();
+
+                // Mix BSDF and guided sampling using one-sample MIS
+                if (dr::any_or<true>(active_guide)) {
+                    std::tie(bsdf_sample, bsdf_weight, std::ignore) =
+                        guiding->sample_bsdf(bsdf_ctx, bsdf, si, bsdf_sample,
+                                             bsdf_weight, guide_1, guide_2,
+                                             m_guiding_prob, active_guide);
+
+                    // The emitter sample must be weighted against the mixture
+                    bsdf_pdf = guiding->pdf_bsdf(si, ds.d, bsdf_pdf,
+                                                 m_guiding_prob,
+                                                 active_guide && active_em);
+                }
+            }
 
             // --------------- Emitter sampling contribution ----------------
 
@@ -226,7 +679,34 @@ public:
 
                 // Accumulate, being careful with polarization (see spec_fma)
                 result[active_em] = spec_fma(
-                    throughput, bsdf_val * em_weight * mis_em, result);
+                    throughput, spec_mul(bsdf_val, em_weight) * mis_em, result,
+                    depolarized);
+
+                /* Split the emitter sample between the events of the light
+                   path expressions by evaluating the lobes separately */
+                if (lpe) {
+                    for (LPEEvent event : { LPEEvent::Diffuse, LPEEvent::Glossy,
+                                            LPEEvent::Transmission }) {
+                        uint32_t flags = LightPathExpressions::event_flags(event);
+                        Mask active_lpe =
+                            active_em && has_flag(bsdf->flags(), flags);
+                        if (dr::none_or<false>(active_lpe))
+                            continue;
+
+                        BSDFContext lpe_ctx(bsdf_ctx.mode, flags);
+                        Spectrum lpe_val = si.to_world_mueller(
+                            bsdf->eval(lpe_ctx, si, wo, active_lpe), -wo, si.wi);
+                        UInt32 accepted = lpe->accept(
+                            lpe->advance(lpe_state, event, active_lpe),
+                            ds.emitter, active_lpe);
+                        accumulate_lpe(
+                            accepted,
+                            spec_mul(throughput,
+                                     spec_mul(lpe_val, em_weight) * mis_em,
+                                     depolarized),
+                            active_lpe);
+                    }
+                }
             }
 
             // ---------------------- BSDF sampling ----------------------
@@ -251,8 +731,16 @@ public:
 
             // ------ Update loop variables based on current interaction ------
 
-            throughput *= bsdf_weight;
+            throughput = spec_mul(throughput, bsdf_weight, depolarized, &depolarized);
             eta *= bsdf_sample.eta;
+
+            if (lpe)
+                lpe_state = lpe->advance(lpe_state, bsdf_sample.sampled_type);
+
+            if (train)
+                vertices->put(depth, guiding->bin_index(si.p, ray.d), result,
+                              throughput, bsdf_sample.pdf, active_guide);
+
             valid_ray |= active && si.is_valid() &&
                          !has_flag(bsdf_sample.sampled_type, BSDFFlags::Null);
 
@@ -261,6 +749,18 @@ public:
             prev_bsdf_pdf = bsdf_sample.pdf;
             prev_bsdf_delta = has_flag(bsdf_sample.sampled_type, BSDFFlags::Delta);
 
+            /* Widen the ray cone by the apex angle of a cone whose solid angle
+               matches the inverse density of the sampled direction */
+            if (m_ray_cones) {
+                Float spread = dr::minimum(
+                    dr::safe_sqrt(dr::InvPi<Float> / bsdf_sample.pdf),
+                    .5f * dr::Pi<Float>);
+                cone_width = vertex_cone_width;
+                cone_spread = dr::minimum(
+                    cone_spread + dr::select(prev_bsdf_delta, 0.f, spread),
+                    .5f * dr::Pi<Float>);
+            }
+
             // -------------------- Stopping criterion ---------------------
 
             dr::masked(depth, si.is_valid()) += 1;
@@ -268,7 +768,7 @@ public:
             Float throughput_max = dr::max(unpolarized_spectrum(throughput));
 
             Float rr_prob = dr::minimum(throughput_max * dr::sqr(eta), .95f);
-            Mask rr_active = depth >= m_rr_depth,
+            Mask rr_active = depth >= m_rr_depth && !active_adrrs,
                  rr_continue = sampler->next_1d() < rr_prob;
 
             /* Differentiable variants of the renderer require the the russian
@@ -278,6 +778,23 @@ public:
 
             active = active_next && (!rr_active || rr_continue) &&
                      dr::neq(throughput_max, 0.f);
+
+            if (adrrs)
+                active = resume_split(active);
+        }
+
+        stats_path_length(depth, true);
+
+        // Deposit the radiance that arrived at the recorded vertices
+        if (train)
+            vertices->finish(guiding, dr::select(valid_ray, result, 0.f), true);
+
+        for (size_t i = 0; i < lpe_count; ++i) {
+            Color3f rgb = spectrum_to_color3f(
+                dr::select(valid_ray, lpe_result[i], 0.f), ray_, valid_ray);
+            *aovs++ = rgb.r();
+            *aovs++ = rgb.g();
+            *aovs++ = rgb.b();
         }
 
         return {
@@ -292,8 +809,28 @@ public:
     std::string to_string() const override {
         return tfm::format("PathIntegrator[\n"
             "  max_depth = %u,\n"
-            "  rr_depth = %u\n"
-            "]", m_max_depth, m_rr_depth);
+            "  rr_depth = %u,\n"
+            "  guiding = %s,\n"
+            "  adrrs = %s,\n"
+            "  ray_cones = %s,\n"
+            "  lpe = %s\n"
+            "]", m_max_depth, m_rr_depth, m_guiding, m_adrrs, m_ray_cones,
+            m_lpe ? string::indent(m_lpe.get()) : "none");
+    }
+
+    /**
+     * \brief Return a ray with differentials whose offset rays are displaced
+     * by the given cone width (measured at the intersection) in the plane
+     * perpendicular to \c ray
+     */
+    RayDifferential3f cone_ray(const Ray3f &ray, const Float &width) const {
+        RayDifferential3f result(ray);
+        Frame3f frame(ray.d);
+        result.o_x = dr::fmadd(frame.s, width, ray.o);
+        result.o_y = dr::fmadd(frame.t, width, ray.o);
+        result.d_x = result.d_y = ray.d;
+        result.has_differentials = true;
+        return result;
     }
 
     /// Compute a multiple importance sampling weight using the power heuristic
@@ -304,19 +841,100 @@ public:
         return dr::detach<true>(dr::select(dr::isfinite(w), w, 0.f));
     }
 
+    /// Convert the radiance of a light path expression into an RGB color
+    Color3f spectrum_to_color3f(const Spectrum &spec, const RayDifferential3f &ray,
+                                Mask active) const {
+        DRJIT_MARK_USED(active);
+        UnpolarizedSpectrum spec_u = unpolarized_spectrum(spec);
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            return spec_u.x();
+        } else if constexpr (is_rgb_v<Spectrum>) {
+            return spec_u;
+        } else {
+            static_assert(is_spectral_v<Spectrum>);
+            /// Note: this assumes that sensor used sample_rgb_spectrum() to generate 'ray.wavelengths'
+            auto pdf = pdf_rgb_spectrum(ray.wavelengths);
+            spec_u *= dr::select(dr::neq(pdf, 0.f), dr::rcp(pdf), 0.f);
+            return spectrum_to_srgb(spec_u, ray.wavelengths, active);
+        }
+    }
+
     /**
-     * \brief Perform a Mueller matrix multiplication in polarized modes, and a
-     * fused multiply-add otherwise.
+     * \brief Perform a Mueller matrix multiplication in polarized modes, and an
+     * elementwise multiplication otherwise.
+     *
+     * Until a path encounters its first polarizing interaction, its
+     * throughput is usually an ideal depolarizer (e.g. after a diffuse
+     * surface), which is indicated by \c a_depolarized. Its product with
+     * another Mueller matrix then reduces to scaling the first row of \c b,
+     * and the product with a depolarizing \c b to scaling the first column of
+     * \c a. Scalar variants take these shortcuts (exactly reproducing the
+     * full product) and update \c depolarized (if specified) for the result.
+     * Vectorized variants would evaluate all cases and use the full product.
+     */
+    Spectrum spec_mul(const Spectrum &a, const Spectrum &b,
+                      Mask a_depolarized = false,
+                      Mask *depolarized = nullptr) const {
+        if constexpr (is_polarized_v<Spectrum> && !dr::is_array_v<Float>) {
+            Spectrum result = dr::zeros<Spectrum>();
+            bool b_depolarized = !a_depolarized && mueller::is_depolarizer(b);
+
+            if (a_depolarized) {
+                for (size_t j = 0; j < 4; ++j)
+                    result(0, j) = a(0, 0) * b(0, j);
+            } else if (b_depolarized) {
+                for (size_t i = 0; i < 4; ++i)
+                    result(i, 0) = a(i, 0) * b(0, 0);
+            } else {
+                result = a * b;
+            }
+
+            if (depolarized)
+                *depolarized = (a_depolarized || b_depolarized) &&
+                               mueller::is_depolarizer(result);
+            return result;
+        } else {
+            DRJIT_MARK_USED(a_depolarized);
+            DRJIT_MARK_USED(depolarized);
+            return a * b;
+        }
+    }
+
+    /**
+     * \brief Perform a Mueller matrix multiplication (see \ref spec_mul()) in
+     * polarized modes, and a fused multiply-add otherwise.
      */
     Spectrum spec_fma(const Spectrum &a, const Spectrum &b,
-                      const Spectrum &c) const {
+                      const Spectrum &c, Mask a_depolarized = false) const {
         if constexpr (is_polarized_v<Spectrum>)
-            return a * b + c;
-        else
+            return spec_mul(a, b, a_depolarized) + c;
+        else {
+            DRJIT_MARK_USED(a_depolarized);
             return dr::fmadd(a, b, c);
+        }
     }
 
     MI_DECLARE_CLASS()
+private:
+    bool m_guiding;
+    uint32_t m_guiding_passes;
+    ScalarFloat m_guiding_prob;
+    uint32_t m_guiding_grid;
+    uint32_t m_guiding_bins;
+    bool m_adrrs;
+    ScalarFloat m_adrrs_window;
+    uint32_t m_adrrs_max_split;
+    bool m_ray_cones;
+
+    /// Guiding field of the current render (if guiding or ADRRS is enabled)
+    ref<GuidingField> m_guiding_field;
+
+    /// Are paths of the current pass recorded into \ref m_guiding_field?
+    bool m_guiding_train = false;
+
+    /// Light path expressions (if any) and the names of their channels
+    ref<LightPathExpressions> m_lpe;
+    std::vector<std::string> m_aov_names;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(PathIntegrator, MonteCarloIntegrator)
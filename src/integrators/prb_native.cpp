@@ -0,0 +1,355 @@
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-prb_native:
+
+Native Path Replay Backpropagation (:monosp:`prb_native`)
+---------------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1
+     corresponds to :math:`\infty`). A value of 1 will only render directly
+     visible light sources. 2 will lead to single-bounce (direct-only)
+     illumination, and so on. (Default: 6)
+
+ * - rr_depth
+   - |int|
+   - Specifies the path depth, at which the implementation will begin to use
+     the *russian roulette* path termination criterion. For example, if set to
+     1, then path generation many randomly cease after encountering directly
+     visible surfaces. (Default: 5)
+
+This plugin contains the C++ implementation of the sampling loop of the
+:ref:`Path Replay Backpropagation <integrator-prb>` integrator. It estimates
+the same quantities with the same random numbers as the Python reference
+implementation, but avoids the cost of tracing the loop from Python, which
+dominates the time of each iteration of an optimization at small
+resolutions.
+
+The :monosp:`prb` integrator uses this plugin for its sampling loop, while the
+orchestration of the primal and differential phases (sample splatting,
+handling of the sensor and film derivatives) remains in Python. The plugin can
+also be used directly to render primal images, e.g. from the C++ API, and its
+``sample_adjoint()`` method can be invoked to propagate derivatives along
+individual rays in forward or reverse mode.
+
+The same limitations as for the :monosp:`prb` integrator apply: there is no
+reparameterization (gradients of geometric parameters are biased), sampling is
+detached, and polarized variants are not supported.
+
+.. tabs::
+
+    .. code-tab:: xml
+
+        <integrator type="prb_native">
+            <integer name="max_depth" value="8"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'prb_native',
+        'max_depth': 8
+
+ */
+
+template <typename Float, typename Spectrum>
+class PRBIntegrator : public CppADIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(CppADIntegrator)
+    MI_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    PRBIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_polarized_v<Spectrum>)
+            Throw("The PRB integrator does not support polarized variants!");
+
+        int max_depth = props.get<int>("max_depth", 6);
+        if (max_depth < 0 && max_depth != -1)
+            Throw("\"max_depth\" must be set to -1 (infinite) or a value >= 0");
+
+        m_max_depth = (uint32_t) max_depth; // This maps -1 to 2^32-1 bounces
+
+        int rr_depth = props.get<int>("rr_depth", 5);
+        if (rr_depth <= 0)
+            Throw("\"rr_depth\" must be set to a value greater than zero!");
+
+        m_rr_depth = (uint32_t) rr_depth;
+    }
+
+    std::tuple<Spectrum, Mask, Spectrum>
+    sample_adjoint(dr::ADMode mode,
+                   const Scene *scene,
+                   Sampler *sampler,
+                   const Ray3f &ray_,
+                   const Spectrum &delta_L_,
+                   const Spectrum &state_in,
+                   Mask active_) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active_);
+
+        // Rendering a primal image? (vs performing forward/reverse-mode AD)
+        bool primal = mode == dr::ADMode::Primal;
+
+        if constexpr (!dr::is_diff_v<Float>) {
+            if (!primal)
+                Throw("PRBIntegrator::sample_adjoint(): derivatives can only "
+                      "be propagated in differentiable variants!");
+        }
+
+        if constexpr (is_polarized_v<Spectrum>) {
+            Throw("The PRB integrator does not support polarized variants!");
+        } else {
+            // Standard BSDF evaluation context for path tracing
+            BSDFContext bsdf_ctx;
+
+            // --------------------- Configure loop state ----------------------
+
+            Ray3f ray           = dr::detach<true>(ray_);
+            UInt32 depth        = 0;        // Depth of current vertex
+            Spectrum L          = primal ? Spectrum(0.f) : state_in; // Radiance accumulator
+            Spectrum delta_L    = delta_L_; // Differential/adjoint radiance
+            Spectrum throughput = 1.f;      // Path throughput weight
+            Float eta           = 1.f;      // Index of refraction
+            Mask active         = active_;  // Active SIMD lanes
+
+            // Variables caching information from the previous bounce
+            SurfaceInteraction3f prev_si = dr::zeros<SurfaceInteraction3f>();
+            Float prev_bsdf_pdf          = 1.f;
+            Bool prev_bsdf_delta         = true;
+
+            dr::Loop<Bool> loop("Path Replay Backpropagation", sampler, ray,
+                                depth, L, delta_L, throughput, eta, active,
+                                prev_si, prev_bsdf_pdf, prev_bsdf_delta);
+
+            /* Inform the loop about the maximum number of loop iterations.
+               This accelerates wavefront-style rendering by avoiding costly
+               synchronization points that check the 'active' flag. */
+            loop.set_max_iterations(m_max_depth);
+
+            while (loop(active)) {
+                /* Compute a surface interaction that tracks derivatives arising
+                   from differentiable shape parameters (position, normals,
+                   etc.) In primal mode, this is just an ordinary ray tracing
+                   operation. */
+                SurfaceInteraction3f si;
+                {
+                    dr::resume_grad<Float> scope(!primal);
+                    si = scene->ray_intersect(ray,
+                                              /* ray_flags = */ +RayFlags::All,
+                                              /* coherent = */ dr::eq(depth, 0u));
+                }
+
+                // ---------------------- Direct emission ----------------------
+
+                Spectrum Le = 0.f;
+                if (dr::any_or<true>(dr::neq(si.emitter(scene), nullptr))) {
+                    DirectionSample3f ds(scene, si, prev_si);
+                    Float em_pdf = 0.f;
+
+                    if (dr::any_or<true>(!prev_bsdf_delta))
+                        em_pdf = scene->pdf_emitter_direction(prev_si, ds,
+                                                              !prev_bsdf_delta);
+
+                    // Compute MIS weight for emitter sample from previous bounce
+                    Float mis_bsdf = mis_weight(prev_bsdf_pdf, em_pdf);
+
+                    dr::resume_grad<Float> scope(!primal);
+                    Le = throughput * mis_bsdf * ds.emitter->eval(si);
+                }
+
+                // Should we continue tracing to reach one more vertex?
+                Bool active_next = (depth + 1 < m_max_depth) && si.is_valid();
+
+                /* Draw all random numbers of this vertex up front and
+                   unconditionally, in the same order as the Python reference
+                   implementation. This keeps the sample sequence identical
+                   even when the early exit below or the emitter sampling
+                   branch skip work on some iterations. */
+                Point2f sample_em = sampler->next_2d();
+                Float sample_1    = sampler->next_1d();
+                Point2f sample_2  = sampler->next_2d();
+                Float sample_rr   = sampler->next_1d();
+
+                if (dr::none_or<false>(active_next)) {
+                    // Early exit for scalar mode, which only computes primal estimates
+                    L += Le;
+                    dr::masked(depth, si.is_valid()) += 1;
+                    break;
+                }
+
+                BSDFPtr bsdf = si.bsdf(ray);
+
+                // ---------------------- Emitter sampling ----------------------
+
+                // Is emitter sampling even possible on the current vertex?
+                Mask active_em =
+                    active_next && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                Spectrum Lr_dir = 0.f;
+                if (dr::any_or<true>(active_em)) {
+                    // If so, randomly sample an emitter without derivative tracking
+                    auto [ds, em_weight] = scene->sample_emitter_direction(
+                        si, sample_em, true, active_em);
+                    active_em &= dr::neq(ds.pdf, 0.f);
+
+                    dr::resume_grad<Float> scope(!primal);
+
+                    if constexpr (dr::is_diff_v<Float>) {
+                        if (!primal) {
+                            /* Given the detached emitter sample, *recompute* its
+                               contribution with AD to enable light source
+                               optimization */
+                            ds.d = dr::replace_grad(ds.d, dr::normalize(ds.p - si.p));
+                            Spectrum em_val =
+                                scene->eval_emitter_direction(si, ds, active_em);
+                            em_weight = dr::replace_grad(
+                                em_weight, dr::select(dr::neq(ds.pdf, 0.f),
+                                                      em_val / ds.pdf, 0.f));
+                            dr::disable_grad(ds.d);
+                        }
+                    }
+
+                    // Evaluate BSDF * cos(theta) differentiably
+                    Vector3f wo = si.to_local(ds.d);
+                    auto [bsdf_value_em, bsdf_pdf_em] =
+                        bsdf->eval_pdf(bsdf_ctx, si, wo, active_em);
+                    Float mis_em = dr::select(ds.delta, 1.f,
+                                              mis_weight(ds.pdf, bsdf_pdf_em));
+                    Lr_dir = throughput * mis_em * bsdf_value_em * em_weight;
+                }
+
+                // ------------------ Detached BSDF sampling -------------------
+
+                auto [bsdf_sample, bsdf_weight] =
+                    bsdf->sample(bsdf_ctx, si, sample_1, sample_2, active_next);
+
+                // ---- Update loop variables based on current interaction -----
+
+                if (primal)
+                    L += Le + Lr_dir;
+                else
+                    L -= Le + Lr_dir;
+
+                ray = si.spawn_ray(si.to_world(bsdf_sample.wo));
+                eta *= bsdf_sample.eta;
+                throughput *= bsdf_weight;
+
+                // Information about the current vertex needed by the next iteration
+                prev_si = dr::detach<true>(si);
+                prev_bsdf_pdf = bsdf_sample.pdf;
+                prev_bsdf_delta = has_flag(bsdf_sample.sampled_type, BSDFFlags::Delta);
+
+                // -------------------- Stopping criterion ---------------------
+
+                // Don't run another iteration if the throughput has reached zero
+                Float throughput_max = dr::max(unpolarized_spectrum(throughput));
+                active_next &= dr::neq(throughput_max, 0.f);
+
+                /* Russian roulette stopping probability (must cancel out ior^2
+                   to obtain unitless throughput, enforces a minimum probability) */
+                Float rr_prob = dr::minimum(throughput_max * dr::sqr(eta), .95f);
+
+                // Apply only further along the path since, this introduces variance
+                Mask rr_active = depth >= m_rr_depth;
+                throughput[rr_active] *= dr::rcp(rr_prob);
+                Mask rr_continue = sample_rr < rr_prob;
+                active_next &= !rr_active || rr_continue;
+
+                // ------------------ Differential phase only ------------------
+
+                if constexpr (dr::is_diff_v<Float>) {
+                    if (!primal) {
+                        dr::resume_grad<Float> scope;
+
+                        /* 'L' stores the indirectly reflected radiance at the
+                           current vertex but does not track parameter
+                           derivatives. The following addresses this by
+                           canceling the detached BSDF value and replacing it
+                           with an equivalent term that has derivative tracking
+                           enabled. */
+
+                        // Recompute 'wo' to propagate derivatives to cosine term
+                        Vector3f wo = si.to_local(ray.d);
+
+                        // Re-evaluate BSDF * cos(theta) differentiably
+                        Spectrum bsdf_val = bsdf->eval(bsdf_ctx, si, wo, active_next);
+
+                        // Detached version of the above term and inverse
+                        Spectrum bsdf_val_det = bsdf_weight * bsdf_sample.pdf;
+                        Spectrum inv_bsdf_val_det = dr::select(
+                            dr::neq(bsdf_val_det, 0.f), dr::rcp(bsdf_val_det), 0.f);
+
+                        /* Differentiable version of the reflected indirect
+                           radiance. Minor optional tweak: indicate that the
+                           primal value of the second term is always 1. */
+                        Spectrum Lr_ind =
+                            L * dr::replace_grad(Spectrum(1.f),
+                                                 inv_bsdf_val_det * bsdf_val);
+
+                        // Differentiable Monte Carlo estimate of all contributions
+                        Spectrum Lo = Le + Lr_dir + Lr_ind;
+
+                        if (jit_flag(JitFlag::VCallRecord) && !dr::grad_enabled(Lo))
+                            Throw("The contribution computed by the differential "
+                                  "rendering phase is not attached to the AD "
+                                  "graph! Raising an exception since this is "
+                                  "usually indicative of a bug (for example, you "
+                                  "may have forgotten to call dr.enable_grad(..) "
+                                  "on one of the scene parameters, or you may be "
+                                  "trying to optimize a parameter that does not "
+                                  "generate derivatives in detached PRB.)");
+
+                        // Propagate derivatives from/to 'Lo' based on 'mode'
+                        if (mode == dr::ADMode::Backward) {
+                            dr::backward_from(delta_L * Lo);
+                        } else {
+                            dr::forward_to(Lo);
+                            delta_L += dr::grad(Lo);
+                        }
+                    }
+                }
+
+                dr::masked(depth, si.is_valid()) += 1;
+                active = active_next;
+            }
+
+            return {
+                primal ? L : delta_L, // Radiance/differential radiance
+                dr::neq(depth, 0u),   // Ray validity flag for alpha blending
+                L                     // State for the differential phase
+            };
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("PRBIntegrator[\n"
+            "  max_depth = %u,\n"
+            "  rr_depth = %u\n"
+            "]", m_max_depth, m_rr_depth);
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        Float w = pdf_a / (pdf_a + pdf_b);
+        return dr::detach<true>(dr::select(dr::isfinite(w), w, 0.f));
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    uint32_t m_max_depth;
+    uint32_t m_rr_depth;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(PRBIntegrator, CppADIntegrator)
+MI_EXPORT_PLUGIN(PRBIntegrator, "Path Replay Backpropagation integrator");
+NAMESPACE_END(mitsuba)
@@ -37,6 +37,14 @@ Particle tracer (:monosp:`ptracer`)
    - If specified, divides the workload in successive passes with :paramtype:`samples_per_pass`
      samples per pixel.
 
+ * - block_budget
+   - |int|
+   - Memory budget in MiB per thread for the private image blocks that workers
+     accumulate into in scalar variants. Every worker splats into its own
+     full-resolution block, and the blocks are summed in parallel once all samples
+     are done. When a block exceeds this budget, fewer blocks than threads are
+     allocated and workers take turns using them. (Default: 256)
+
 This integrator traces rays starting from light sources and attempts to connect them
 to the sensor at each bounce.
 It does not support media (volumes).
@@ -208,7 +216,8 @@ public:
 
         /* ---------------------- Path construction ------------------------- */
         // First intersection from the emitter to the scene
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        SurfaceInteraction3f si = scene->ray_intersect(
+            ray, scene->ray_flags(), /* coherent = */ false, active);
 
         active &= si.is_valid();
         if (m_max_depth >= 0)
@@ -259,7 +268,8 @@ public:
 
             // Intersect the BSDF ray against scene geometry (next vertex).
             ray = si.spawn_ray(si.to_world(bs.wo));
-            si = scene->ray_intersect(ray, active);
+            si = scene->ray_intersect(ray, scene->ray_flags(),
+                                      /* coherent = */ false, active);
 
             depth++;
             if (m_max_depth >= 0)
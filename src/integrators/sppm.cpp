@@ -0,0 +1,900 @@
+#include <mutex>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-sppm:
+
+Stochastic progressive photon mapping (:monosp:`sppm`)
+------------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1
+     corresponds to :math:`\infty`). A value of 1 will only render directly
+     visible light sources. 2 will lead to single-bounce (direct-only)
+     illumination, and so on. (Default: -1)
+
+ * - rr_depth
+   - |int|
+   - Specifies the path depth, at which the implementation will begin to use
+     the *russian roulette* path termination criterion. (Default: 5)
+
+ * - photon_count
+   - |int|
+   - Number of photons that are emitted in every pass. (Default: 250000)
+
+ * - initial_radius
+   - |float|
+   - Initial radius of the photon gathering disk around every visible point,
+     in world space units. The default value of 0 selects 0.5% of the
+     diagonal of the scene's bounding box. (Default: 0)
+
+ * - alpha
+   - |float|
+   - Radius reduction parameter, which must lie in :math:`(0, 1)`. Smaller
+     values shrink the gathering radius more aggressively. (Default: 0.7)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This integrator implements stochastic progressive photon mapping
+:cite:`Hachisuka2009Stochastic`. It is able to render light paths that are
+difficult or impossible to sample with the other integrators, e.g. caustics
+seen through a specular surface (*specular-diffuse-specular* paths).
+
+Rendering proceeds in a series of passes, whose count is given by the sample
+count of the sensor's sampler. Every pass
+
+1. traces one camera path per pixel through specular and glossy surfaces,
+   computes direct illumination along the way, and records a *visible point*
+   at the first diffuse surface,
+
+2. builds a spatial hash grid over the gathering disks of all visible points.
+   The grid is constructed in parallel on the host without any locks, using
+   a counting pass, a prefix sum and a scatter pass based on atomic cursors,
+
+3. emits :paramtype:`photon_count` photons in the same way as the
+   :ref:`particle tracer <integrator-ptracer>` and deposits their flux at all
+   visible points whose gathering disk contains an indirect photon hit. The
+   lookup visits the entries of a single grid cell, which keeps the gather
+   loop short and coherent,
+
+4. shrinks the gathering radius of every pixel based on the number of
+   photons it received, and accumulates the resulting flux estimate.
+
+The per-pixel state and the grid have a constant size, hence the memory
+usage does not grow with the number of passes, while the estimate converges
+to the correct solution as the radii shrink.
+
+Each pass uses a single camera path per pixel, hence the pixel estimates
+correspond to a box reconstruction filter irrespective of the film's filter.
+
+.. note:: This integrator only supports the RGB and monochrome variants.
+   It does not handle participating media and does not support
+   differentiation.
+
+.. tabs::
+    .. code-tab::  xml
+        :name: sppm-integrator
+
+        <integrator type="sppm">
+            <integer name="photon_count" value="1000000"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'sppm',
+        'photon_count': 1000000
+
+ */
+
+template <typename Float, typename Spectrum>
+class SPPMIntegrator final : public Integrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Integrator, should_stop, m_stop, m_timeout, m_render_timer,
+                   m_hide_emitters)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, BSDF, BSDFPtr,
+                    EmitterPtr)
+
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Camera path vertex at which photons are gathered
+    struct VisiblePoint {
+        SurfaceInteraction3f si;
+        /// Throughput of the camera path up to (excluding) the visible point
+        UnpolarizedSpectrum beta;
+        /// Gathering radius of the pixel in the current pass
+        Float radius;
+        /// Number of camera path segments up to the visible point
+        UInt32 depth;
+        Bool valid;
+
+        DRJIT_STRUCT(VisiblePoint, si, beta, radius, depth, valid)
+    };
+
+    /// Progressive estimate of a pixel that persists across passes
+    struct PixelState {
+        /// Sum of the direct illumination of all passes
+        UnpolarizedSpectrum ld;
+        /// Accumulated (radius-scaled) photon flux
+        UnpolarizedSpectrum tau;
+        /// Accumulated photon count
+        Float n;
+        Float radius;
+
+        DRJIT_STRUCT(PixelState, ld, tau, n, radius)
+    };
+
+    using VisiblePointStorage =
+        std::conditional_t<dr::is_jit_v<Float>, VisiblePoint,
+                           std::vector<VisiblePoint>>;
+
+    /// Spatial hash grid storing the visible points overlapping every cell
+    struct PhotonGrid {
+        /// Start of the entries of every hash table slot (plus one sentinel)
+        UInt32Storage offsets;
+        /// Visible point indices, grouped by hash table slot
+        UInt32Storage entries;
+        ScalarPoint3f origin = 0.f;
+        ScalarFloat inv_cell_size = 0.f;
+        ScalarVector3i resolution = 0;
+        uint32_t table_size = 1;
+
+        template <typename UInt>
+        static UInt hash(const UInt &x, const UInt &y, const UInt &z,
+                         uint32_t table_size) {
+            return ((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u)) %
+                   table_size;
+        }
+
+        /**
+         * \brief Rebuild the grid from host-side visible point positions
+         * and radii. Points with a zero radius are skipped.
+         */
+        void build(const ScalarFloat *x, const ScalarFloat *y,
+                   const ScalarFloat *z, const ScalarFloat *radius,
+                   size_t count) {
+            ScalarBoundingBox3f bbox;
+            ScalarFloat max_radius = 0.f;
+            for (size_t i = 0; i < count; ++i) {
+                if (!(radius[i] > 0.f))
+                    continue;
+                bbox.expand(ScalarPoint3f(x[i], y[i], z[i]));
+                max_radius = dr::maximum(max_radius, radius[i]);
+            }
+
+            table_size = (uint32_t) std::max(count, (size_t) 1);
+            resolution = 0;
+
+            std::vector<uint32_t> offsets_host(table_size + 1, 0u),
+                                  entries_host;
+
+            if (bbox.valid()) {
+                /* Cells of twice the maximum radius bound the number of cells
+                   overlapped by one disk to 8, while the resolution bound
+                   avoids integer overflow in scenes with a tiny radius */
+                ScalarFloat cell_size =
+                    dr::maximum(2.f * max_radius,
+                                dr::max(bbox.extents()) / ScalarFloat(1 << 20));
+                origin        = bbox.min - max_radius;
+                inv_cell_size = dr::rcp(cell_size);
+                resolution    = dr::maximum(
+                    ScalarVector3i(dr::ceil(
+                        (bbox.extents() + 2.f * max_radius) * inv_cell_size)),
+                    1);
+
+                auto for_each_cell = [&](size_t i, auto &&func) {
+                    ScalarPoint3f p(x[i], y[i], z[i]);
+                    ScalarVector3i lo = dr::clamp(ScalarVector3i(dr::floor(
+                                            (p - radius[i] - origin) * inv_cell_size)),
+                                            0, resolution - 1),
+                                   hi = dr::clamp(ScalarVector3i(dr::floor(
+                                            (p + radius[i] - origin) * inv_cell_size)),
+                                            0, resolution - 1);
+
+                    for (int32_t cz = lo.z(); cz <= hi.z(); ++cz)
+                        for (int32_t cy = lo.y(); cy <= hi.y(); ++cy)
+                            for (int32_t cx = lo.x(); cx <= hi.x(); ++cx)
+                                func(hash((uint32_t) cx, (uint32_t) cy,
+                                          (uint32_t) cz, table_size));
+                };
+
+                std::unique_ptr<std::atomic<uint32_t>[]> cursor(
+                    new std::atomic<uint32_t>[table_size]);
+                for (uint32_t i = 0; i < table_size; ++i)
+                    cursor[i].store(0u, std::memory_order_relaxed);
+
+                size_t grain_size = std::max(
+                    count / (4 * Thread::thread_count()), (size_t) 1);
+                ThreadEnvironment env;
+
+                // 1. Count the number of disks overlapping every slot
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, count, grain_size),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+                        for (size_t i = range.begin(); i != range.end(); ++i) {
+                            if (!(radius[i] > 0.f))
+                                continue;
+                            for_each_cell(i, [&](uint32_t h) {
+                                cursor[h].fetch_add(1u, std::memory_order_relaxed);
+                            });
+                        }
+                    }
+                );
+
+                // 2. Prefix sum, the counters turn into insertion cursors
+                for (uint32_t h = 0; h < table_size; ++h) {
+                    uint32_t n = cursor[h].load(std::memory_order_relaxed);
+                    cursor[h].store(offsets_host[h], std::memory_order_relaxed);
+                    offsets_host[h + 1] = offsets_host[h] + n;
+                }
+
+                // 3. Scatter the visible point indices into their slots
+                entries_host.resize(offsets_host[table_size]);
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, count, grain_size),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+                        for (size_t i = range.begin(); i != range.end(); ++i) {
+                            if (!(radius[i] > 0.f))
+                                continue;
+                            for_each_cell(i, [&](uint32_t h) {
+                                uint32_t slot = cursor[h].fetch_add(
+                                    1u, std::memory_order_relaxed);
+                                entries_host[slot] = (uint32_t) i;
+                            });
+                        }
+                    }
+                );
+            }
+
+            if (entries_host.empty())
+                entries_host.push_back(0u);
+
+            offsets = dr::load<UInt32Storage>(offsets_host.data(),
+                                              offsets_host.size());
+            entries = dr::load<UInt32Storage>(entries_host.data(),
+                                              entries_host.size());
+        }
+
+        /// Return the range of entries of the cell containing \c p
+        std::pair<UInt32, UInt32> cell_range(const Point3f &p,
+                                             Mask active) const {
+            Vector3i c = Vector3i(dr::floor((p - origin) * inv_cell_size));
+            active &= dr::all(c >= 0 && c < resolution);
+
+            UInt32 h = hash(UInt32(c.x()), UInt32(c.y()), UInt32(c.z()),
+                            table_size);
+
+            return { dr::gather<UInt32>(offsets, h, active),
+                     dr::gather<UInt32>(offsets, h + 1u, active) };
+        }
+    };
+
+    SPPMIntegrator(const Properties &props) : Base(props) {
+        int max_depth = props.get<int>("max_depth", -1);
+        if (max_depth < 0 && max_depth != -1)
+            Throw("\"max_depth\" must be set to -1 (infinite) or a value >= 0");
+        m_max_depth = (uint32_t) max_depth;
+
+        int rr_depth = props.get<int>("rr_depth", 5);
+        if (rr_depth <= 0)
+            Throw("\"rr_depth\" must be set to a value greater than zero!");
+        m_rr_depth = (uint32_t) rr_depth;
+
+        m_photon_count = props.get<uint32_t>("photon_count", 250000);
+        if (m_photon_count == 0)
+            Throw("\"photon_count\" must be greater than zero!");
+
+        m_initial_radius = props.get<ScalarFloat>("initial_radius", 0.f);
+        if (m_initial_radius < 0.f)
+            Throw("\"initial_radius\" must be a nonnegative value!");
+
+        m_alpha = props.get<ScalarFloat>("alpha", .7f);
+        if (!(m_alpha > 0.f && m_alpha < 1.f))
+            Throw("\"alpha\" must lie in the interval (0, 1)!");
+    }
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed, uint32_t spp,
+                    bool develop, bool evaluate) override {
+        ScopedPhase sp(ProfilerPhase::Render);
+        m_stop = false;
+
+        if constexpr (is_spectral_v<Spectrum> || is_polarized_v<Spectrum>)
+            Throw("The SPPM integrator only supports RGB and monochrome "
+                  "variants!");
+
+        Film *film = sensor->film();
+        ScalarVector2u crop_size = film->crop_size();
+        ScalarPoint2i crop_offset = film->crop_offset();
+        uint32_t channel_count = film->prepare({});
+
+        // Every pass traces one camera path per pixel
+        Sampler *sensor_sampler = sensor->sampler();
+        if (spp)
+            sensor_sampler->set_sample_count(spp);
+        uint32_t n_passes = sensor_sampler->sample_count();
+
+        size_t n_pixels = (size_t) crop_size.x() * (size_t) crop_size.y();
+
+        m_render_timer.reset();
+
+        // Special case: no emitters present in the scene.
+        if (unlikely(scene->emitters().empty() || m_max_depth == 0)) {
+            Log(Info, "Rendering finished (no emitters found, returning black image).");
+            TensorXf result;
+            if (develop) {
+                result = film->develop();
+                dr::schedule(result);
+            } else {
+                film->schedule_storage();
+            }
+            return result;
+        }
+
+        ScalarFloat initial_radius = m_initial_radius;
+        if (initial_radius == 0.f)
+            initial_radius = 5e-3f * dr::norm(scene->bbox().extents());
+
+        Log(Info, "Starting render job (%ux%u, %u pass%s, %u photons per pass)",
+            crop_size.x(), crop_size.y(), n_passes, n_passes == 1 ? "" : "es",
+            m_photon_count);
+
+        if (m_timeout > 0.f)
+            Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
+
+        ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+        uint32_t passes_done = 0;
+
+        ref<ImageBlock> block =
+            new ImageBlock(crop_size, crop_offset, channel_count);
+
+        if constexpr (dr::is_jit_v<Float>) {
+            UInt32 index = dr::arange<UInt32>((uint32_t) n_pixels);
+            Vector2f pixel(Float(index % crop_size.x()),
+                           Float(index / crop_size.x()));
+
+            PixelState state = dr::zeros<PixelState>(n_pixels);
+            state.radius = dr::full<Float>(initial_radius, n_pixels);
+
+            // Camera and photon paths use independent sample streams
+            ref<Sampler> sampler = sensor_sampler->clone(),
+                         photon_sampler = sensor_sampler->clone();
+            sampler->set_samples_per_wavefront(1);
+            photon_sampler->set_samples_per_wavefront(1);
+            sampler->seed(seed * 2u, (uint32_t) n_pixels);
+            photon_sampler->seed(seed * 2u + 1u, m_photon_count);
+
+            PhotonGrid grid;
+            for (uint32_t pass = 0; pass < n_passes && !should_stop(); ++pass) {
+                // 1. Camera pass
+                UnpolarizedSpectrum ld;
+                VisiblePoint vps =
+                    trace_camera(scene, sensor, sampler, pixel, state.radius,
+                                 ld, true);
+                state.ld += ld;
+                dr::eval(vps, state.ld);
+
+                // 2. Grid construction on the host
+                Float radius = dr::select(vps.valid, vps.radius, 0.f);
+                auto &&x_host = dr::migrate(vps.si.p.x(), AllocType::Host);
+                auto &&y_host = dr::migrate(vps.si.p.y(), AllocType::Host);
+                auto &&z_host = dr::migrate(vps.si.p.z(), AllocType::Host);
+                auto &&r_host = dr::migrate(radius, AllocType::Host);
+                dr::sync_thread();
+                grid.build(x_host.data(), y_host.data(), z_host.data(),
+                           r_host.data(), n_pixels);
+
+                // 3. Photon pass
+                UnpolarizedSpectrum phi = dr::zeros<UnpolarizedSpectrum>(n_pixels);
+                Float count = dr::zeros<Float>(n_pixels);
+                auto accumulate = [&](const UInt32 &vp_index,
+                                      const UnpolarizedSpectrum &value,
+                                      Mask active) {
+                    for (size_t k = 0; k < dr::size_v<UnpolarizedSpectrum>; ++k)
+                        dr::scatter_reduce(ReduceOp::Add, phi[k], value[k],
+                                           vp_index, active);
+                    dr::scatter_reduce(ReduceOp::Add, count, Float(1.f),
+                                       vp_index, active);
+                };
+                trace_photons(scene, sensor, photon_sampler, grid, vps,
+                              accumulate, true);
+
+                // 4. Progressive radius reduction
+                update(state, vps, phi, count);
+
+                sampler->advance();
+                photon_sampler->advance();
+                sampler->schedule_state();
+                photon_sampler->schedule_state();
+                dr::eval(state);
+
+                passes_done++;
+                progress->update(passes_done / (ScalarFloat) n_passes);
+            }
+
+            if (passes_done > 0) {
+                UnpolarizedSpectrum value = radiance(state, passes_done);
+                block->put(Point2f(pixel + .5f + ScalarVector2f(crop_offset)),
+                           to_values(value).data());
+            }
+        } else {
+            size_t n_threads = Thread::thread_count();
+            constexpr size_t Channels = dr::size_v<UnpolarizedSpectrum>;
+
+            std::vector<PixelState> states(n_pixels);
+            for (PixelState &s : states) {
+                s = dr::zeros<PixelState>();
+                s.radius = initial_radius;
+            }
+            std::vector<VisiblePoint> vps(n_pixels);
+
+            std::unique_ptr<std::atomic<ScalarFloat>[]> phi(
+                new std::atomic<ScalarFloat>[n_pixels * Channels]),
+                count(new std::atomic<ScalarFloat>[n_pixels]);
+
+            std::vector<ScalarFloat> x_host(n_pixels), y_host(n_pixels),
+                                     z_host(n_pixels), r_host(n_pixels);
+
+            size_t pixel_grain = std::max(n_pixels / (4 * n_threads), (size_t) 1),
+                   photon_grain = std::max(m_photon_count / (4 * n_threads), (size_t) 1),
+                   pixel_blocks = (n_pixels + pixel_grain - 1) / pixel_grain,
+                   photon_blocks = (m_photon_count + photon_grain - 1) / photon_grain;
+
+            auto accumulate = [&](uint32_t vp_index,
+                                  const UnpolarizedSpectrum &value,
+                                  bool active) {
+                if (!active)
+                    return;
+                for (size_t k = 0; k < Channels; ++k)
+                    atomic_add(phi[vp_index * Channels + k], value[k]);
+                atomic_add(count[vp_index], 1.f);
+            };
+
+            ThreadEnvironment env;
+            PhotonGrid grid;
+            for (uint32_t pass = 0; pass < n_passes && !should_stop(); ++pass) {
+                uint32_t pass_seed =
+                    (seed * n_passes + pass) * (uint32_t) (pixel_blocks + photon_blocks);
+
+                // 1. Camera pass
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, n_pixels, pixel_grain),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+                        ref<Sampler> sampler = sensor_sampler->clone();
+                        sampler->seed(pass_seed +
+                                      (uint32_t) (range.begin() / pixel_grain));
+
+                        for (size_t i = range.begin(); i != range.end(); ++i) {
+                            Vector2f pixel((ScalarFloat) (i % crop_size.x()),
+                                           (ScalarFloat) (i / crop_size.x()));
+                            UnpolarizedSpectrum ld;
+                            vps[i] = trace_camera(scene, sensor, sampler, pixel,
+                                                  states[i].radius, ld, true);
+                            states[i].ld += ld;
+                            sampler->advance();
+
+                            const VisiblePoint &vp = vps[i];
+                            x_host[i] = vp.si.p.x();
+                            y_host[i] = vp.si.p.y();
+                            z_host[i] = vp.si.p.z();
+                            r_host[i] = vp.valid ? vp.radius : 0.f;
+                        }
+                    }
+                );
+
+                // 2. Grid construction
+                grid.build(x_host.data(), y_host.data(), z_host.data(),
+                           r_host.data(), n_pixels);
+
+                // 3. Photon pass
+                for (size_t i = 0; i < n_pixels * Channels; ++i)
+                    phi[i].store(0.f, std::memory_order_relaxed);
+                for (size_t i = 0; i < n_pixels; ++i)
+                    count[i].store(0.f, std::memory_order_relaxed);
+
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, m_photon_count, photon_grain),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+                        ref<Sampler> sampler = sensor_sampler->clone();
+                        sampler->seed(pass_seed + (uint32_t) pixel_blocks +
+                                      (uint32_t) (range.begin() / photon_grain));
+
+                        for (size_t i = range.begin(); i != range.end(); ++i) {
+                            trace_photons(scene, sensor, sampler, grid, vps,
+                                          accumulate, true);
+                            sampler->advance();
+                        }
+                    }
+                );
+
+                // 4. Progressive radius reduction
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, n_pixels, pixel_grain),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        for (size_t i = range.begin(); i != range.end(); ++i) {
+                            UnpolarizedSpectrum phi_i;
+                            for (size_t k = 0; k < Channels; ++k)
+                                phi_i[k] = phi[i * Channels + k].load(
+                                    std::memory_order_relaxed);
+                            update(states[i], vps[i], phi_i,
+                                   count[i].load(std::memory_order_relaxed));
+                        }
+                    }
+                );
+
+                passes_done++;
+                progress->update(passes_done / (ScalarFloat) n_passes);
+            }
+
+            if (passes_done > 0) {
+                for (size_t i = 0; i < n_pixels; ++i) {
+                    Point2f pos((ScalarFloat) (i % crop_size.x()) + .5f,
+                                (ScalarFloat) (i / crop_size.x()) + .5f);
+                    UnpolarizedSpectrum value = radiance(states[i], passes_done);
+                    block->put(Point2f(pos + ScalarVector2f(crop_offset)),
+                               to_values(value).data());
+                }
+            }
+        }
+
+        film->put_block(block);
+
+        TensorXf result;
+        if (develop) {
+            result = film->develop();
+            dr::schedule(result);
+        } else {
+            film->schedule_storage();
+        }
+
+        if (evaluate) {
+            dr::eval();
+            dr::sync_thread();
+        }
+
+        if (!m_stop)
+            Log(Info, "Rendering finished. (took %s)",
+                util::time_string((float) m_render_timer.value(), true));
+
+        return result;
+    }
+
+    /**
+     * \brief Trace a camera path through specular and glossy surfaces and
+     * return the visible point at which photons are gathered.
+     *
+     * Emission and direct illumination found along the path are returned
+     * via \c ld.
+     */
+    VisiblePoint trace_camera(const Scene *scene, const Sensor *sensor,
+                              Sampler *sampler, const Vector2f &pixel,
+                              const Float &radius, UnpolarizedSpectrum &ld,
+                              Mask active) const {
+        ScalarVector2f scale = 1.f / ScalarVector2f(sensor->film()->crop_size());
+
+        Vector2f sample_pos = (pixel + sampler->next_2d(active)) * scale;
+
+        Point2f aperture_sample(.5f);
+        if (sensor->needs_aperture_sample())
+            aperture_sample = sampler->next_2d(active);
+
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d(active) * sensor->shutter_open_time();
+
+        auto [ray_, ray_weight] = sensor->sample_ray_differential(
+            time, 0.f, sample_pos, aperture_sample);
+
+        size_t width = dr::width(pixel);
+        Ray3f ray = Ray3f(ray_);
+        UnpolarizedSpectrum beta = unpolarized_spectrum(ray_weight),
+                            result = dr::zeros<UnpolarizedSpectrum>(width);
+        Float eta = dr::full<Float>(1.f, width);
+        UInt32 depth = dr::full<UInt32>(1u, width);
+        Mask specular = dr::full<Mask>(true, width);
+
+        VisiblePoint vp = dr::zeros<VisiblePoint>(width);
+        vp.radius = radius;
+
+        dr::Loop<Mask> loop("SPPM camera pass", sampler, ray, beta, result,
+                            eta, depth, specular, vp, active);
+
+        while (loop(active)) {
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+
+            // Emission seen directly or through a chain of specular surfaces
+            EmitterPtr emitter = si.emitter(scene);
+            Mask visible = active && specular && dr::neq(emitter, nullptr);
+            if (m_hide_emitters)
+                visible &= depth > 1u;
+            if (dr::any_or<true>(visible))
+                result[visible] += beta * unpolarized_spectrum(
+                                              emitter->eval(si, visible));
+
+            active &= si.is_valid();
+            if (m_max_depth != (uint32_t) -1)
+                active &= depth < m_max_depth;
+            if (dr::none_or<false>(active))
+                break;
+
+            BSDFContext ctx;
+            BSDFPtr bsdf = si.bsdf(ray);
+            UInt32 bsdf_flags = bsdf->flags();
+            Mask diffuse = has_flag(bsdf_flags, BSDFFlags::Diffuse),
+                 glossy  = has_flag(bsdf_flags, BSDFFlags::Glossy);
+
+            // ---------------------- Emitter sampling ----------------------
+
+            Mask active_em = active && (diffuse || glossy);
+            if (dr::any_or<true>(active_em)) {
+                auto [ds, em_weight] = scene->sample_emitter_direction(
+                    si, sampler->next_2d(active_em), true, active_em);
+                active_em &= dr::neq(ds.pdf, 0.f);
+
+                Spectrum bsdf_val =
+                    bsdf->eval(ctx, si, si.to_local(ds.d), active_em);
+                result[active_em] += beta * unpolarized_spectrum(bsdf_val * em_weight);
+            }
+
+            // -------------------- Visible point record --------------------
+
+            /* Photons are gathered at the first diffuse surface, or at a
+               glossy surface when the remaining depth would not allow
+               recording a visible point further along the path */
+            Mask record = active && diffuse;
+            if (m_max_depth != (uint32_t) -1)
+                record |= active && glossy && depth + 2u >= m_max_depth;
+
+            dr::masked(vp.si, record)    = si;
+            dr::masked(vp.beta, record)  = beta;
+            dr::masked(vp.depth, record) = depth;
+            vp.valid |= record;
+            active &= !record;
+
+            // ----------------------- BSDF sampling ------------------------
+
+            auto [bs, bsdf_weight] = bsdf->sample(
+                ctx, si, sampler->next_1d(active), sampler->next_2d(active), active);
+
+            beta *= unpolarized_spectrum(bsdf_weight);
+            eta *= bs.eta;
+            specular = has_flag(bs.sampled_type, BSDFFlags::Delta);
+            ray = si.spawn_ray(si.to_world(bs.wo));
+            depth++;
+
+            // Russian roulette
+            Float q = dr::minimum(dr::max(beta) * dr::sqr(eta), .95f);
+            Mask use_rr = depth > m_rr_depth;
+            if (dr::any_or<true>(use_rr)) {
+                dr::masked(active, use_rr) &= sampler->next_1d(active) < q;
+                dr::masked(beta, use_rr) *= dr::rcp(q);
+            }
+
+            active &= dr::any(dr::neq(beta, 0.f));
+        }
+
+        ld = result;
+        return vp;
+    }
+
+    /**
+     * \brief Emit photons and deposit their flux at the visible points
+     * that are close to every indirect photon hit.
+     *
+     * \c accumulate is invoked with the visible point index, the flux
+     * weighted by the BSDF of the visible point, and a mask.
+     */
+    template <typename Accumulate>
+    void trace_photons(const Scene *scene, const Sensor *sensor,
+                       Sampler *sampler, const PhotonGrid &grid,
+                       const VisiblePointStorage &vps, Accumulate &&accumulate,
+                       Mask active) const {
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d(active) * sensor->shutter_open_time();
+        Float wavelength_sample  = sampler->next_1d(active);
+        Point2f direction_sample = sampler->next_2d(active),
+                position_sample  = sampler->next_2d(active);
+
+        auto [ray, ray_weight, emitter] = scene->sample_emitter_ray(
+            time, wavelength_sample, direction_sample, position_sample, active);
+        DRJIT_MARK_USED(emitter);
+
+        UnpolarizedSpectrum beta = unpolarized_spectrum(ray_weight);
+        Float eta(1.f);
+        active &= dr::any(dr::neq(beta, 0.f));
+
+        for (uint32_t depth = 1;; ++depth) {
+            if (depth >= m_max_depth)
+                break;
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+            active &= si.is_valid();
+            if (dr::none_or<false>(active))
+                break;
+
+            // Direct illumination is handled by the camera pass
+            if (depth > 1)
+                deposit(grid, vps, si, -ray.d, beta, depth, accumulate, active);
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            BSDFContext ctx(TransportMode::Importance);
+            auto [bs, bsdf_val] = bsdf->sample(
+                ctx, si, sampler->next_1d(active), sampler->next_2d(active), active);
+
+            // Using geometric normals (the photon travels along 'ray.d')
+            Float wi_dot_geo_n = dr::dot(si.n, -ray.d),
+                  wo_dot_geo_n = dr::dot(si.n, si.to_world(bs.wo));
+
+            // Prevent light leaks due to shading normals
+            active &= (wi_dot_geo_n * Frame3f::cos_theta(si.wi) > 0.f) &&
+                      (wo_dot_geo_n * Frame3f::cos_theta(bs.wo) > 0.f);
+
+            // Adjoint BSDF for shading normals -- [Veach, p. 155]
+            Float correction = dr::abs((Frame3f::cos_theta(si.wi) * wo_dot_geo_n) /
+                                       (Frame3f::cos_theta(bs.wo) * wi_dot_geo_n));
+            beta *= unpolarized_spectrum(bsdf_val) * correction;
+            eta *= bs.eta;
+
+            // Russian roulette
+            if (depth >= m_rr_depth) {
+                Float q = dr::minimum(dr::max(beta) * dr::sqr(eta), .95f);
+                active &= sampler->next_1d(active) < q;
+                beta *= dr::rcp(q);
+            }
+
+            active &= dr::any(dr::neq(beta, 0.f));
+            ray = si.spawn_ray(si.to_world(bs.wo));
+
+            // Launch one kernel per bounce, the gather loop is its bottleneck
+            if constexpr (dr::is_jit_v<Float>) {
+                dr::schedule(ray, beta, eta, active);
+                sampler->schedule_state();
+                dr::eval();
+                if (!dr::any(active))
+                    break;
+            } else {
+                if (!active)
+                    break;
+            }
+        }
+    }
+
+    /**
+     * \brief Visit the visible points stored in the grid cell of the photon
+     * hit \c si and accumulate the photon's contribution to those whose
+     * gathering disk contains it.
+     */
+    template <typename Accumulate>
+    void deposit(const PhotonGrid &grid, const VisiblePointStorage &vps,
+                 const SurfaceInteraction3f &si, const Vector3f &wi,
+                 const UnpolarizedSpectrum &beta, const UInt32 &depth,
+                 Accumulate &&accumulate, Mask active) const {
+        auto [index, end] = grid.cell_range(si.p, active);
+        active &= index < end;
+
+        dr::Loop<Mask> loop("SPPM photon gather", index, active);
+
+        while (loop(active)) {
+            UInt32 vp_index = dr::gather<UInt32>(grid.entries, index, active);
+            VisiblePoint vp = fetch(vps, vp_index, active);
+
+            Mask inside = active && vp.valid &&
+                          dr::squared_norm(vp.si.p - si.p) < dr::sqr(vp.radius);
+            if (m_max_depth != (uint32_t) -1)
+                inside &= vp.depth + depth <= m_max_depth;
+
+            if (dr::any_or<true>(inside)) {
+                // Evaluate the BSDF without the foreshortening factor
+                BSDFPtr bsdf = vp.si.bsdf();
+                Vector3f wo = vp.si.to_local(wi);
+                Float cos_theta = dr::abs(Frame3f::cos_theta(wo));
+                inside &= cos_theta > 0.f;
+
+                UnpolarizedSpectrum bsdf_val = unpolarized_spectrum(
+                    bsdf->eval(BSDFContext(), vp.si, wo, inside));
+
+                accumulate(vp_index, beta * bsdf_val / cos_theta, inside);
+            }
+
+            index++;
+            active &= index < end;
+        }
+    }
+
+    void update(PixelState &state, const VisiblePoint &vp,
+                const UnpolarizedSpectrum &phi, const Float &count) const {
+        Mask valid = count > 0.f;
+
+        Float n_new = state.n + m_alpha * count,
+              radius_new = state.radius * dr::sqrt(n_new / (state.n + count));
+
+        dr::masked(state.tau, valid) =
+            (state.tau + vp.beta * phi) * dr::sqr(radius_new / state.radius);
+        dr::masked(state.n, valid) = n_new;
+        dr::masked(state.radius, valid) = radius_new;
+    }
+
+    UnpolarizedSpectrum radiance(const PixelState &state,
+                                 uint32_t passes) const {
+        ScalarFloat photons = (ScalarFloat) passes * (ScalarFloat) m_photon_count;
+        return state.ld / (ScalarFloat) passes +
+               state.tau / (photons * dr::Pi<ScalarFloat> * dr::sqr(state.radius));
+    }
+
+    /// Image block channels (RGB, alpha, weight) of a pixel estimate
+    static std::array<Float, 5> to_values(const UnpolarizedSpectrum &value) {
+        Color3f rgb;
+        if constexpr (is_monochromatic_v<Spectrum>)
+            rgb = value.x();
+        else
+            rgb = Color3f(value[0], value[1], value[2]);
+
+        /* The block layout is either (R, G, B, W) or (R, G, B, A, W), both
+           alpha and weight are 1 for every pixel */
+        return { rgb.x(), rgb.y(), rgb.z(), Float(1.f), Float(1.f) };
+    }
+
+    static VisiblePoint fetch(const VisiblePointStorage &vps,
+                              const UInt32 &index, Mask active) {
+        if constexpr (dr::is_jit_v<Float>) {
+            return dr::gather<VisiblePoint>(vps, index, active);
+        } else {
+            DRJIT_MARK_USED(active);
+            return vps[index];
+        }
+    }
+
+    static void atomic_add(std::atomic<ScalarFloat> &target, ScalarFloat value) {
+        ScalarFloat current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value,
+                                             std::memory_order_relaxed))
+            ;
+    }
+
+    std::string to_string() const override {
+        return tfm::format("SPPMIntegrator[\n"
+            "  max_depth = %u,\n"
+            "  rr_depth = %u,\n"
+            "  photon_count = %u,\n"
+            "  initial_radius = %f,\n"
+            "  alpha = %f\n"
+            "]", m_max_depth, m_rr_depth, m_photon_count, m_initial_radius,
+            m_alpha);
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    uint32_t m_max_depth;
+    uint32_t m_rr_depth;
+    uint32_t m_photon_count;
+    ScalarFloat m_initial_radius;
+    ScalarFloat m_alpha;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SPPMIntegrator, Integrator)
+MI_EXPORT_PLUGIN(SPPMIntegrator, "Stochastic progressive photon mapping integrator");
+NAMESPACE_END(mitsuba)
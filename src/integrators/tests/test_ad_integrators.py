@@ -952,6 +952,98 @@ def test04_render_custom_op(variants_all_ad_rgb):
         mi.util.write_bitmap(filename, error)
         assert False
 
+def test05_sample_passes(variants_all_ad_rgb):
+    config = DiffuseAlbedoConfig()
+    config.initialize()
+    sensor = config.scene.sensors()[0]
+
+    integrator = mi.load_dict({'type': 'prb', 'samples_per_pass': 3})
+    assert integrator.sample_passes(sensor, spp=8) == [3, 3, 2]
+    assert integrator.sample_passes(sensor, spp=2) == [2]
+
+    # A generous memory budget renders all samples at once
+    integrator = mi.load_dict({'type': 'prb', 'memory_budget': 2.0**20})
+    assert integrator.sample_passes(sensor, spp=64) == [64]
+
+    with pytest.raises(Exception, match='samples_per_pass'):
+        mi.load_dict({'type': 'prb', 'samples_per_pass': -1})
+
+
+@pytest.mark.slow
+def test06_rendering_backward_passes(variants_all_ad_rgb):
+    config = DiffuseAlbedoConfig()
+    config.initialize()
+
+    import mitsuba
+    importlib.reload(mitsuba.ad.integrators)
+    config.integrator_dict['type'] = 'prb'
+    config.integrator_dict['samples_per_pass'] = config.spp // 4
+    integrator = mi.load_dict(config.integrator_dict)
+
+    filename = join(output_dir, f"test_{config.name}_image_fwd_ref.exr")
+    image_fwd_ref = mi.TensorXf(mi.Bitmap(filename))
+
+    image_adj = mi.TensorXf(1.0, image_fwd_ref.shape)
+
+    theta = mi.Float(0.0)
+    dr.enable_grad(theta)
+    config.update(theta)
+
+    integrator.render_backward(
+        config.scene, grad_in=image_adj, seed=0, spp=config.spp, params=theta)
+
+    # The gradients of all passes accumulate into the same parameter
+    grad = dr.grad(theta)[0] / dr.width(image_fwd_ref)
+    grad_ref = dr.mean(image_fwd_ref)[0]
+
+    error = dr.abs(grad - grad_ref) / dr.maximum(dr.abs(grad_ref), 1e-3)
+    assert error < config.error_mean_threshold_bwd
+
+
+@pytest.mark.parametrize('integrator_name', ['prb', 'direct_reparam'])
+def test07_rendering_forward_batch(variants_all_ad_rgb, integrator_name):
+    import mitsuba
+    importlib.reload(mitsuba.ad.integrators)
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': integrator_name},
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, 0, 3], target=[0, 0, 0], up=[0, 1, 0]),
+            'film': {'type': 'hdrfilm', 'width': 8, 'height': 8,
+                     'rfilter': {'type': 'box'}},
+            'sampler': {'type': 'independent', 'sample_count': 4},
+        },
+        'floor': {'type': 'rectangle', 'bsdf': {'type': 'diffuse'}},
+        'light': {'type': 'constant'},
+    })
+
+    params = mi.traverse(scene)
+    keys = ['floor.bsdf.reflectance.value', 'light.radiance.value']
+    params.keep(keys)
+    tangents = [{keys[0]: 1.0}, {keys[1]: 1.0}, {keys[0]: 0.5, keys[1]: 2.0}]
+
+    for k in keys:
+        dr.enable_grad(params[k])
+    params.update()
+
+    integrator = scene.integrator()
+    grads = integrator.render_forward_batch(scene, params, tangents, seed=0)
+    assert len(grads) == 3
+
+    # Each gradient image should match a separate forward-mode pass
+    for tangent, grad in zip(tangents, grads):
+        for k in keys:
+            dr.set_grad(params[k], tangent.get(k, 0.0))
+        grad_ref = integrator.render_forward(scene, params, seed=0)
+        assert dr.allclose(grad, grad_ref, rtol=1e-4, atol=1e-5)
+
+    with pytest.raises(Exception, match='unknown parameter'):
+        integrator.render_forward_batch(scene, params, [{'foo': 1.0}])
+
+
 # -------------------------------------------------------------------
 #                      Generate reference images
 # -------------------------------------------------------------------
@@ -0,0 +1,77 @@
+import pytest
+import numpy as np
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import simple_scene
+
+
+def create_flow_scene(previous_x):
+    # The previous camera is translated by 'previous_x' along the x axis
+    previous_camera = simple_scene(res=32, fov=40)['sensor']
+    previous_camera['to_world'] = mi.ScalarTransform4f.look_at(
+        origin=[previous_x, 0, 2], target=[previous_x, 0, 0], up=[0, 1, 0])
+
+    integrator = {
+        'type': 'aov',
+        'aovs': 'flow:flow',
+        'previous_camera': previous_camera,
+    }
+    return mi.load_dict(simple_scene(integrator, spp=4, res=32, fov=40,
+                                     floor=None, emitter=None,
+                                     sphere={'type': 'sphere', 'radius': 0.5}))
+
+
+def test01_flow_static_camera(variants_all_rgb):
+    image = mi.render(create_flow_scene(0))
+    assert dr.allclose(image, 0, atol=1e-4)
+
+
+def test02_flow_moving_camera(variants_all_rgb):
+    image = np.array(mi.render(create_flow_scene(0.05)))
+    flow_x, flow_y = image[..., 0], image[..., 1]
+
+    # The center of the image sees the front of the sphere at a distance of
+    # 1.5, whose projection moves by 'dx / 1.5 / tan(fov / 2)' half film widths
+    expected = 0.05 / 1.5 / np.tan(np.radians(20)) * 16
+    center = flow_x[15:17, 15:17]
+    assert np.allclose(np.abs(center), expected, rtol=5e-2)
+    assert np.all(np.sign(center) == np.sign(center[0, 0]))
+    assert np.allclose(flow_y[15:17, 15:17], 0, atol=1e-3)
+
+    # The flow grows linearly with the camera motion
+    image_2 = np.array(mi.render(create_flow_scene(0.1)))
+    assert np.allclose(image_2[15:17, 15:17, 0], 2 * center, rtol=5e-2)
+
+    # The background has no flow
+    assert np.allclose(flow_x[0, 0], 0)
+
+
+def test03_flow_requires_sensor(variant_scalar_rgb):
+    with pytest.raises(Exception) as e:
+        mi.load_dict({'type': 'aov', 'aovs': 'flow:flow'})
+    e.match('requires a nested sensor')
+
+
+def test04_aov_spp(variants_all_rgb):
+    def render(aov_spp):
+        integrator = {
+            'type': 'aov',
+            'aovs': 'dd:depth,nn:sh_normal',
+            'aov_spp': aov_spp,
+            'image': {'type': 'path', 'max_depth': 2},
+        }
+        scene = mi.load_dict(simple_scene(integrator, spp=16, res=32, sphere=None))
+        return mi.TensorXf(mi.render(scene, seed=0))
+
+    image_ref, image = render(0), render(4)
+
+    # Channels: RGB, depth, shading normal, and RGBA of the nested integrator
+    assert image.shape[2] == 11
+
+    # The geometric AOVs keep their average over the evaluated samples
+    assert dr.allclose(image[..., 3:7], image_ref[..., 3:7], rtol=1e-2, atol=1e-3)
+
+    # The nested integrator still uses all samples
+    assert dr.allclose(image[..., :3], image_ref[..., :3])
+    assert dr.allclose(image[..., 7:], image_ref[..., 7:])
@@ -0,0 +1,65 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import specular_scene, rmse
+
+
+def render(integrator, spp, max_depth=6, **objects):
+    scene = mi.load_dict(specular_scene(
+        {'type': integrator, 'max_depth': max_depth}, spp=spp, **objects))
+    return mi.render(scene, seed=1)
+
+
+def assert_converges(spp=128, **kwargs):
+    # Every pixel must converge to the path traced reference, with at most
+    # the noise level of the path tracer
+    image_ref = render('path', 2048, **kwargs)
+    image = render('bdpt', spp, **kwargs)
+    image_path = render('path', spp, **kwargs)
+
+    assert rmse(image, image_ref) < 1.5 * rmse(image_path, image_ref) + 1e-3
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=2e-2)
+
+
+@pytest.mark.parametrize('max_depth', [1, 2, 6])
+def test01_matches_path(variants_all_rgb, max_depth):
+    assert_converges(max_depth=max_depth)
+
+
+def test02_caustic_variance(variants_all_rgb):
+    # A small light above the dielectric sphere only illuminates the floor
+    # below it through a caustic, which emitter sampling cannot reach. Light
+    # subpaths find it far more often than camera subpaths.
+    light = {
+        'type': 'rectangle',
+        'to_world': mi.ScalarTransform4f.translate([-0.6, 0, 2.5])
+                                        .rotate([1, 0, 0], 180).scale(0.05),
+        'emitter': {'type': 'area', 'radiance': 800.0},
+    }
+    kwargs = dict(light=light, emitter=None, sphere=None)
+
+    image_ref = render('bdpt', 4096, **kwargs)
+    image = render('bdpt', 64, **kwargs)
+    image_path = render('path', 64, **kwargs)
+
+    assert rmse(image, image_ref) < 0.7 * rmse(image_path, image_ref)
+    assert dr.allclose(dr.mean(image_ref.array),
+                       dr.mean(render('path', 4096, **kwargs).array), rtol=5e-2)
+
+
+@pytest.mark.parametrize('emitter', ['point', 'constant'])
+def test03_unidirectional_emitters(variants_all_rgb, emitter):
+    # Emitters other than area lights do not start light subpaths
+    if emitter == 'point':
+        light = {'type': 'point', 'position': [0, 0, 3], 'intensity': 10.0}
+    else:
+        light = {'type': 'constant', 'radiance': 0.5}
+    assert_converges(light=light, emitter=None)
+
+
+def test04_hide_emitters(variants_all_rgb):
+    integrator = {'type': 'bdpt', 'hide_emitters': True}
+    scene = mi.load_dict(specular_scene(integrator, spp=4, floor=None,
+                                        sphere=None, sphere_2=None))
+    assert dr.allclose(mi.render(scene).array, 0.0)
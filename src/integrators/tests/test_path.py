@@ -0,0 +1,255 @@
+import pytest
+import numpy as np
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import simple_scene, rmse
+
+
+def create_skylight_scene(integrator, spp):
+    """
+    The floor of simple_scene() inside a black box, whose only opening is a
+    skylight of 0.4x0.4 units through which the camera looks at the floor.
+    The floor only receives light from the small solid angle of the opening.
+    """
+    T = mi.ScalarTransform4f
+    black = {'type': 'diffuse', 'reflectance': {'type': 'rgb', 'value': 0}}
+    box = {}
+    for name, to_world in [
+        ('ceiling_0', T.translate([-0.6, 0, 1]).scale([0.4, 1, 1])),
+        ('ceiling_1', T.translate([0.6, 0, 1]).scale([0.4, 1, 1])),
+        ('ceiling_2', T.translate([0, -0.6, 1]).scale([0.2, 0.4, 1])),
+        ('ceiling_3', T.translate([0, 0.6, 1]).scale([0.2, 0.4, 1])),
+        ('wall_0', T.translate([-1, 0, 0.5]).rotate([0, 1, 0], 90).scale([0.5, 1, 1])),
+        ('wall_1', T.translate([1, 0, 0.5]).rotate([0, 1, 0], 90).scale([0.5, 1, 1])),
+        ('wall_2', T.translate([0, -1, 0.5]).rotate([1, 0, 0], 90).scale([1, 0.5, 1])),
+        ('wall_3', T.translate([0, 1, 0.5]).rotate([1, 0, 0], 90).scale([1, 0.5, 1]))]:
+        box[name] = {'type': 'rectangle', 'to_world': to_world, 'bsdf': black}
+
+    return mi.load_dict(simple_scene(integrator, spp=spp, fov=20, sphere=None, **box))
+
+
+@pytest.mark.parametrize('integrator', ['path', 'volpath'])
+def test01_guiding_reduces_variance(variants_all_rgb, integrator):
+    def render(guiding, spp=64):
+        return mi.render(create_skylight_scene({
+            'type': integrator,
+            'samples_per_pass': 4,
+            'guiding': guiding,
+            'guiding_passes': 4,
+            'guiding_grid': 4,
+            'guiding_bins': 8,
+        }, spp), seed=1)
+
+    image_ref = render(False, spp=4096)
+    image, image_unguided = render(True), render(False)
+
+    # Guided directions find the skylight far more often
+    assert rmse(image, image_ref) < 0.6 * rmse(image_unguided, image_ref)
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+
+def test02_guiding_single_pass(variant_scalar_rgb):
+    # Guiding is disabled when the render only consists of a single pass
+    integrator = {'type': 'path', 'guiding': True}
+    image = mi.render(mi.load_dict(simple_scene(integrator, spp=4)), seed=1)
+    image_ref = mi.render(mi.load_dict(simple_scene(spp=4)), seed=1)
+    assert np.array_equal(np.array(image), np.array(image_ref))
+
+
+def guided_path(**kwargs):
+    return {
+        'type': 'path',
+        'samples_per_pass': 4,
+        'guiding_passes': 4,
+        'guiding_grid': 4,
+        'guiding_bins': 8,
+        **kwargs
+    }
+
+
+@pytest.mark.parametrize('max_split', [1, 8])
+def test03_adrrs_matches_reference(variants_all_rgb, max_split):
+    def render(spp, **kwargs):
+        scene = mi.load_dict(simple_scene(guided_path(**kwargs), spp=spp))
+        return mi.render(scene, seed=1)
+
+    image_ref = render(4096)
+    image = render(64, adrrs=True, adrrs_max_split=max_split)
+
+    # Roulette and splitting must not bias any pixel, nor add noise
+    assert rmse(image, image_ref) < 1.2 * rmse(render(64), image_ref) + 1e-3
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=2e-2)
+
+
+def test04_adrrs_with_guiding(variants_all_rgb):
+    def render(spp, **kwargs):
+        return mi.render(create_skylight_scene(guided_path(**kwargs), spp),
+                         seed=1)
+
+    image_ref = render(4096)
+    image = render(64, guiding=True, adrrs=True)
+    assert rmse(image, image_ref) < 0.6 * rmse(render(64), image_ref)
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+
+def test05_adrrs_invalid_parameters(variant_scalar_rgb):
+    with pytest.raises(RuntimeError, match='adrrs_window'):
+        mi.load_dict({'type': 'path', 'adrrs': True, 'adrrs_window': 0.5})
+
+
+def test06_ray_cones_create(variant_scalar_rgb):
+    integrator = mi.load_dict({'type': 'path', 'ray_cones': True})
+    assert 'ray_cones' in str(integrator)
+
+
+def test07_ray_cones_prefilter(variants_all_rgb):
+    # Fine checkerboard with trilinear filtering on the floor of simple_scene()
+    i, j = np.indices((64, 64))
+    checker = np.where((i // 2 + j // 2) % 2 == 0, 0.9, 0.1)
+    checker = mi.Bitmap(checker.reshape(64, 64, 1).astype(np.float32))
+    floor = {
+        'type': 'rectangle',
+        'bsdf': {
+            'type': 'diffuse',
+            'reflectance': {
+                'type': 'bitmap',
+                'bitmap': checker,
+                'filter_type': 'trilinear',
+                'raw': True
+            }
+        },
+    }
+
+    def render(ray_cones, spp):
+        integrator = {'type': 'path', 'max_depth': 4, 'ray_cones': ray_cones}
+        scene = mi.load_dict(simple_scene(integrator, spp=spp, floor=floor))
+        return mi.render(scene, seed=1)
+
+    image, image_ref = render(True, 64), render(True, 4096)
+    image_unfiltered, image_unfiltered_ref = render(False, 64), render(False, 4096)
+
+    # The cone footprints select coarse mip levels that average the checkers,
+    # which removes most of the noise while preserving the mean
+    assert rmse(image, image_ref) < 0.7 * rmse(image_unfiltered, image_unfiltered_ref)
+    assert dr.allclose(dr.mean(image_ref.array), dr.mean(image_unfiltered_ref.array),
+                       rtol=5e-2)
+
+
+def create_lpe_scene(lpe, max_depth=6, environment=False):
+    """
+    simple_scene() with a conductor sphere, lit by two colored point lights
+    and optionally the environment
+    """
+    sphere = {
+        'type': 'sphere',
+        'center': [0.6, 0, 0.4],
+        'radius': 0.3,
+        'bsdf': {'type': 'conductor'},
+    }
+    lights = {
+        'key_light': {
+            'type': 'point',
+            'position': [1, -1, 2],
+            'intensity': {'type': 'rgb', 'value': [4, 3, 2]},
+        },
+        'fill_light': {
+            'type': 'point',
+            'position': [-1, 1, 1],
+            'intensity': {'type': 'rgb', 'value': [1, 1, 2]},
+        },
+    }
+    if not environment:
+        lights['emitter'] = None
+    integrator = {'type': 'path', 'max_depth': max_depth, 'lpe': lpe}
+    return mi.load_dict(simple_scene(integrator, res=16, fov=40,
+                                     sphere=sphere, **lights))
+
+
+def render_components(scene, count):
+    image = np.array(mi.render(scene, seed=0))
+    return image[..., 0:3], [image[..., 3 + 3 * i:6 + 3 * i] for i in range(count)]
+
+
+def test08_lpe_create(variant_scalar_rgb):
+    integrator = mi.load_dict({'type': 'path', 'lpe': 'direct: C D L, spec:CS+L'})
+    assert integrator.aov_names() == ['direct.R', 'direct.G', 'direct.B',
+                                      'spec.R', 'spec.G', 'spec.B']
+
+    for expr in ['C D', 'C [X] L', 'C (D L', 'C D L G', 'D C L', "C L'key"]:
+        with pytest.raises(RuntimeError, match='Invalid light path expression'):
+            mi.load_dict({'type': 'path', 'lpe': 'x:' + expr})
+
+    with pytest.raises(RuntimeError, match='name:expression'):
+        mi.load_dict({'type': 'path', 'lpe': 'C D L'})
+
+
+def test09_lpe_direct_indirect(variants_all_rgb):
+    lpe = 'direct:C.L, indirect:C..+L'
+    beauty, (direct, indirect) = render_components(create_lpe_scene(lpe), 2)
+    assert np.allclose(direct + indirect, beauty, rtol=1e-4, atol=1e-5)
+    assert np.max(indirect) > 0
+
+    # The direct component is the image of paths that stop at their first
+    # vertex, which consume the same random numbers up to that point
+    beauty_direct, _ = render_components(create_lpe_scene(lpe, max_depth=2), 2)
+    assert np.allclose(direct, beauty_direct, rtol=1e-4, atol=1e-5)
+
+
+def test10_lpe_events(variants_all_rgb):
+    scene = create_lpe_scene(
+        'diffuse:C D .* L, specular:C S .* L, caustic:C D S+ L', environment=True)
+    beauty, (diffuse, specular, caustic) = render_components(scene, 3)
+
+    # The camera sees the sphere, and the floor sees the environment via it
+    assert np.max(specular) > 0 and np.max(caustic) > 0
+    assert np.allclose(diffuse + specular, beauty, rtol=1e-4, atol=1e-5)
+    assert np.all(diffuse >= caustic - 1e-5)
+
+
+def test11_lpe_light_groups(variants_all_rgb):
+    scene = create_lpe_scene("key:C.*L'key', fill:C.*L'fill'")
+    beauty, (key, fill) = render_components(scene, 2)
+    assert np.allclose(key + fill, beauty, rtol=1e-4, atol=1e-5)
+
+    # Each group only receives the color of its own light
+    assert np.all(key[..., 0] >= key[..., 2] - 1e-5)
+    assert np.all(fill[..., 2] >= fill[..., 0] - 1e-5)
+    assert np.max(key) > 0 and np.max(fill) > 0
+
+
+def render_polarized(sphere_bsdf, integrator={'type': 'path', 'max_depth': 5}):
+    scene = simple_scene(integrator, fov=40, emitter={
+        'type': 'constant', 'radiance': {'type': 'rgb', 'value': 0.1}},
+        light={'type': 'point', 'position': [1, -1, 3],
+               'intensity': {'type': 'rgb', 'value': 20}})
+    scene['sphere']['bsdf'] = sphere_bsdf
+    scene['sensor']['film']['pixel_format'] = 'rgb'
+    return np.array(mi.render(mi.load_dict(scene), seed=1))
+
+
+@pytest.mark.parametrize('bsdf', ['diffuse', 'conductor'])
+def test12_polarized_intensity(variant_scalar_mono_polarized, bsdf):
+    # Paths that only hit diffuse surfaces never need the Mueller algebra.
+    # A single conductor reflection polarizes the light, but the intensity
+    # still equals the unpolarized one: the shortcuts on the depolarizing
+    # segments around it must reproduce the full Mueller products.
+    image = render_polarized({'type': bsdf})
+
+    if 'scalar_mono' not in mi.variants():
+        pytest.skip('Mitsuba variant "scalar_mono" is not enabled!')
+    mi.set_variant('scalar_mono')
+    image_ref = render_polarized({'type': bsdf})
+    assert np.allclose(image, image_ref, rtol=1e-5, atol=1e-6)
+
+
+def test13_polarized_stokes(variant_scalar_mono_polarized):
+    # A conductor polarizes the light reflected by the diffuse floor
+    integrator = {'type': 'stokes',
+                  'integrator': {'type': 'path', 'max_depth': 5}}
+    image = render_polarized({'type': 'conductor'}, integrator)
+
+    # The intensity matches the first Stokes component
+    assert np.allclose(image[..., :3], image[..., -12:-9], rtol=1e-4, atol=1e-5)
+    # .. and the paths via the sphere are linearly polarized
+    assert np.any(np.abs(image[..., -9:-3]) > 1e-3)
@@ -0,0 +1,100 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import simple_scene, rmse
+
+
+def create_scene(integrator, spp=64):
+    return mi.load_dict(simple_scene(integrator, spp=spp))
+
+
+def assert_matches_path(integrator):
+    # Every pixel converges to the path traced reference, with the noise
+    # level of the path tracer
+    def render(integrator, spp):
+        return mi.render(create_scene(integrator, spp), seed=1)
+
+    path = {'type': 'path', 'max_depth': 4}
+    image_ref = render(path, 2048)
+    image = render(integrator, 64)
+    assert rmse(image, image_ref) < 1.5 * rmse(render(path, 64), image_ref) + 1e-3
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=2e-2)
+
+
+def test01_create(variant_scalar_rgb):
+    integrator = mi.load_dict({'type': 'prb_native', 'max_depth': 8})
+    assert 'max_depth = 8' in str(integrator)
+
+    with pytest.raises(RuntimeError, match='max_depth'):
+        mi.load_dict({'type': 'prb_native', 'max_depth': -2})
+
+    with pytest.raises(RuntimeError, match='rr_depth'):
+        mi.load_dict({'type': 'prb_native', 'rr_depth': 0})
+
+
+def test02_primal_matches_path(variants_all_rgb):
+    assert_matches_path({'type': 'prb_native', 'max_depth': 4})
+
+
+def test03_scalar_primal_only(variant_scalar_rgb):
+    scene = create_scene({'type': 'prb_native'})
+    integrator = scene.integrator()
+    sampler = mi.load_dict({'type': 'independent'})
+    ray = mi.Ray3f([0, 0, 2], [0, 0, -1])
+
+    L, valid, state = integrator.sample_adjoint(
+        dr.ADMode.Primal, scene, sampler, ray, 0, 0)
+    assert valid
+    assert dr.all(L > 0)
+
+    with pytest.raises(RuntimeError, match='differentiable variants'):
+        integrator.sample_adjoint(dr.ADMode.Forward, scene, sampler, ray, 0, L)
+
+
+def test04_gradients_match_python(variants_all_ad_rgb):
+    key = 'floor.bsdf.reflectance.value'
+
+    def forward_gradient(integrator):
+        scene = create_scene(integrator)
+        params = mi.traverse(scene)
+        dr.enable_grad(params[key])
+        dr.set_grad(params[key], 1)
+        params.update()
+        image = mi.render(scene, params, seed=0)
+        return dr.mean(dr.forward_to(image).array)
+
+    grad = forward_gradient({'type': 'prb', 'max_depth': 4})
+    grad_ref = forward_gradient({'type': 'prb_basic', 'max_depth': 4})
+    assert grad > 0
+    assert dr.allclose(grad, grad_ref, rtol=5e-2)
+
+
+def test05_polarized_fallback(variant_llvm_ad_spectral_polarized):
+    # 'prb_native' rejects polarized variants, 'prb' runs its Python loop
+    with pytest.raises(RuntimeError, match='polarized'):
+        mi.load_dict({'type': 'prb_native'})
+
+    scene = create_scene({'type': 'prb', 'max_depth': 4})
+    assert scene.integrator().kernel is None
+    assert_matches_path({'type': 'prb', 'max_depth': 4})
+
+
+def test06_scalar_sample_sequence(variant_scalar_rgb):
+    # Every vertex draws the same six dimensions as the Python reference,
+    # even when the path terminates at that vertex
+    scene = create_scene({'type': 'prb_native', 'max_depth': 1})
+    ray = mi.Ray3f([0, 0, 2], [0, 0, -1])
+
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0)
+    scene.integrator().sample_adjoint(
+        dr.ADMode.Primal, scene, sampler, ray, 0, 0)
+
+    sampler_ref = mi.load_dict({'type': 'independent'})
+    sampler_ref.seed(0)
+    for _ in range(2):
+        sampler_ref.next_2d()
+        sampler_ref.next_1d()
+
+    assert sampler.next_1d() == sampler_ref.next_1d()
@@ -236,3 +236,19 @@ def test07_adjoint_integrator_trampoline(variants_all_ad_rgb):
     mi.load_dict({
         'type': 'myptracer'
     })
+
+
+def test08_block_budget(variant_scalar_rgb):
+    # Sharing a single private block between workers must not change the result
+    scene, integrator = create_test_scene()
+    shared = mi.load_dict({
+        'type': 'ptracer',
+        'samples_per_pass': 16,
+        'rr_depth': 9,
+        'max_depth': 4,
+        'block_budget': 0,
+    })
+
+    image = integrator.render(scene, seed=0, spp=4, develop=True)
+    image_shared = shared.render(scene, seed=0, spp=4, develop=True)
+    assert dr.allclose(image, image_shared, rtol=1e-4, atol=1e-5)
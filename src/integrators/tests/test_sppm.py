@@ -0,0 +1,42 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import specular_scene, rmse
+
+
+def render(integrator, spp, max_depth=-1, **kwargs):
+    scene = mi.load_dict(specular_scene(
+        {'type': integrator, 'max_depth': max_depth, **kwargs}, spp=spp,
+        emitter=None))
+    return mi.render(scene, seed=1)
+
+
+def render_sppm(passes, max_depth=-1):
+    return render('sppm', passes, max_depth, photon_count=50000,
+                  initial_radius=0.1)
+
+
+@pytest.mark.parametrize('max_depth', [2, 4])
+def test01_matches_path(variants_all_rgb, max_depth):
+    image_ref = render('path', 2048, max_depth)
+    image = render_sppm(64, max_depth)
+
+    mean_ref = dr.mean(image_ref.array)
+    assert rmse(image, image_ref) < 0.15 * mean_ref
+    assert dr.allclose(dr.mean(image.array), mean_ref, rtol=5e-2)
+
+
+def test02_progressive_convergence(variants_all_rgb):
+    # The gathering radii shrink from pass to pass, which reduces both
+    # the bias and the noise of every pixel
+    image_ref = render('path', 2048, 4)
+    error_4 = rmse(render_sppm(4, 4), image_ref)
+    error_64 = rmse(render_sppm(64, 4), image_ref)
+    assert error_64 < 0.7 * error_4
+
+
+def test03_no_emitters(variants_all_rgb):
+    scene = mi.load_dict(specular_scene({'type': 'sppm'}, spp=2,
+                                        light=None, emitter=None))
+    assert dr.allclose(mi.render(scene).array, 0.0)
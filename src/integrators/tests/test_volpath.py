@@ -0,0 +1,63 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import simple_scene, rmse
+
+
+def render_fog(spp, emitter='point', integrator='volpath', **kwargs):
+    """
+    Renders the floor of simple_scene() inside a cube of thin fog, lit by a
+    light in the fog
+    """
+    point = {'type': 'point', 'position': [0.3, 0.2, 0.5], 'intensity': 5.0}
+    lights = {'light': point, 'emitter': None}
+    if emitter == 'spot':
+        lights['light'] = {
+            'type': 'spot', 'cutoff_angle': 40,
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, 0, 0.9], target=[0, 0, -1], up=[0, 1, 0]),
+            'intensity': 10.0,
+        }
+    elif emitter == 'mixed':
+        # Emitters without a fixed position are sampled at free-flight collisions
+        lights['emitter'] = {'type': 'constant', 'radiance': 0.2}
+
+    fog = {
+        'type': 'cube',
+        'bsdf': {'type': 'null'},
+        'interior': {'type': 'homogeneous', 'albedo': 0.8, 'sigma_t': 0.3},
+    }
+    scene = simple_scene({'type': integrator, 'max_depth': 8, **kwargs},
+                         spp=spp, fov=45, sphere=None, fog=fog, **lights)
+    return mi.render(mi.load_dict(scene), seed=1)
+
+
+@pytest.mark.parametrize('emitter', ['point', 'spot', 'mixed'])
+def test01_equiangular_matches_free_flight(variants_all_rgb, emitter):
+    image_ref = render_fog(4096, emitter)
+    image = render_fog(128, emitter, equiangular=True)
+    image_free = render_fog(128, emitter)
+
+    # Every pixel converges to the reference, with at most the noise of
+    # free-flight sampling
+    assert rmse(image, image_ref) < 1.2 * rmse(image_free, image_ref) + 1e-3
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=2e-2)
+
+
+def test02_equiangular_single_scattering(variants_all_rgb):
+    # Single scattering from a point light in thin fog is where equi-angular
+    # sampling shines: free-flight collisions rarely occur close to the light
+    image_ref = render_fog(4096, max_depth=2)
+    image = render_fog(128, max_depth=2, equiangular=True)
+    assert rmse(image, image_ref) < 0.7 * rmse(render_fog(128, max_depth=2), image_ref)
+
+
+def test03_homogeneous_shadow_transmittance(variants_all_rgb):
+    # Analytic transmittance of homogeneous media matches the ratio tracking
+    # of volpathmis, without its noise
+    image_ref = render_fog(4096, integrator='volpathmis')
+    image = render_fog(128)
+    assert rmse(image, image_ref) < rmse(render_fog(128, integrator='volpathmis'),
+                                         image_ref)
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=2e-2)
@@ -0,0 +1,39 @@
+import pytest
+import numpy as np
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import specular_scene, rmse
+
+
+def render(integrator, max_depth, spp):
+    scene = mi.load_dict(specular_scene(
+        {'type': integrator, 'max_depth': max_depth}, spp=spp))
+    return mi.render(scene, seed=1)
+
+
+def test01_primary_rays_match_path(variants_all_rgb):
+    # Camera rays are generated from the same sampler state: with only
+    # directly visible emission, both integrators produce the same image
+    image = render('wavefront', 1, 16)
+    image_ref = render('path', 1, 16)
+    assert np.allclose(np.array(image), np.array(image_ref), atol=1e-5)
+
+
+@pytest.mark.parametrize('max_depth', [2, 6])
+def test02_matches_path(variants_all_rgb, max_depth):
+    # Secondary bounces use different random numbers. Every pixel must still
+    # converge to the reference, with the noise level of the path tracer
+    image_ref = render('path', max_depth, 2048)
+    image = render('wavefront', max_depth, 128)
+    image_path = render('path', max_depth, 128)
+
+    assert rmse(image, image_ref) < 1.5 * rmse(image_path, image_ref) + 1e-3
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=2e-2)
+
+
+def test03_hide_emitters(variants_all_rgb):
+    integrator = {'type': 'wavefront', 'hide_emitters': True}
+    scene = mi.load_dict(specular_scene(integrator, spp=4, floor=None,
+                                        sphere=None, sphere_2=None))
+    assert dr.allclose(mi.render(scene).array, 0.0)
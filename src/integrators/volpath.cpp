@@ -1,8 +1,11 @@
+#include <optional>
 #include <random>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/stats.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
+#include <mitsuba/render/guiding.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/medium.h>
@@ -35,6 +38,38 @@ Volumetric path tracer (:monosp:`volpath`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - guiding, guiding_passes, guiding_prob, guiding_grid, guiding_bins
+   - |bool|, |int|, |float|, |int|, |int|
+   - Guide the sampling of directions at surfaces using a learned
+     distribution of incident radiance. These parameters have the same
+     meaning as in the :ref:`path tracer <integrator-path>`. Scattering
+     events in participating media are not guided. (Default: |false|, 4,
+     0.5, 16, 16)
+
+ * - transmittance_estimator
+   - |string|
+   - Estimator for the transmittance along shadow rays through participating media.
+     ``ratio`` performs ratio tracking against the medium's majorant, weighting
+     every tentative collision by the probability of a null collision instead of
+     terminating the ray. ``residual`` instead uses residual ratio tracking
+     :cite:`Novak2014Residual`: the per-cell lower bounds of the majorant grid
+     of :ref:`heterogeneous media <medium-heterogeneous>` (or the extinction of
+     homogeneous media) act as a control extinction whose transmittance is
+     evaluated analytically, so that only the small residual is tracked.
+     With either estimator, the transmittance of homogeneous media is
+     evaluated analytically. (Default: ``ratio``)
+
+ * - equiangular
+   - |bool|
+   - Use equi-angular sampling :cite:`Kulla2012Importance` to compute single
+     scattering from point-like emitters (e.g. :ref:`point <emitter-point>`
+     and :ref:`spot <emitter-spot>` lights) in homogeneous media: every ray
+     segment through such a medium samples a distance proportionally to the
+     inverse squared distance to the emitter, which converges much faster
+     than free-flight sampling in thin media, e.g. fog lit by lamps. Other
+     emitters are still sampled at free-flight collisions.
+     (Default: |false|)
+
 This plugin provides a volumetric path tracer that can be used to compute approximate solutions
 of the radiative transfer equation. Its implementation makes use of multiple importance sampling
 to combine BSDF and phase function sampling with direct illumination sampling strategies. On
@@ -47,6 +82,12 @@ has a :ref:`null <bsdf-null>` or :ref:`thin dielectric <bsdf-thindielectric>` BS
 to it (as compared to, say, a :ref:`dielectric <bsdf-dielectric>` or
 :ref:`roughdielectric <bsdf-roughdielectric>` BSDF).
 
+Media can be made emissive by nesting a :ref:`volume light <emitter-volumelight>`
+into them. Direct illumination then importance samples positions within
+bright regions of the medium, and paths that did not sample emitters at their
+previous vertex (e.g. camera rays) gather the emission at every tentative
+collision instead.
+
 .. note:: This integrator does not implement good sampling strategies to render
     participating media with a spectrally varying extinction coefficient. For these cases,
     it is better to use the more advanced :ref:`volumetric path tracer with
@@ -74,11 +115,58 @@ class VolumetricPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
     MI_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
-                     Medium, MediumPtr, PhaseFunctionContext)
+                     Medium, MediumPtr, PhaseFunctionContext, GuidingField)
 
     VolumetricPathIntegrator(const Properties &props) : Base(props) {
+        m_guiding        = props.get<bool>("guiding", false);
+        m_guiding_passes = props.get<uint32_t>("guiding_passes", 4);
+        m_guiding_prob   = props.get<ScalarFloat>("guiding_prob", .5f);
+        m_guiding_grid   = props.get<uint32_t>("guiding_grid", 16);
+        m_guiding_bins   = props.get<uint32_t>("guiding_bins", 16);
+
+        if (m_guiding_prob < 0.f || m_guiding_prob > 1.f)
+            Throw("\"guiding_prob\" must be in the range [0, 1]!");
+
+        std::string estimator = props.string("transmittance_estimator", "ratio");
+        if (estimator == "residual")
+            m_residual_tracking = true;
+        else if (estimator == "ratio")
+            m_residual_tracking = false;
+        else
+            Throw("Invalid transmittance estimator \"%s\", must be one of: "
+                  "\"ratio\" or \"residual\"!", estimator);
+
+        m_equiangular = props.get<bool>("equiangular", false);
+    }
+
+    void render_begin(const Scene *scene, uint32_t n_passes) override {
+        m_guiding_field = nullptr;
+        m_guiding_train = false;
+        if (!m_guiding)
+            return;
+
+        if (n_passes < 2) {
+            Log(Warn, "Path guiding requires multiple rendering passes (set "
+                      "\"samples_per_pass\" to a fraction of the sample "
+                      "count), disabling it.");
+            return;
+        }
+
+        m_guiding_field = new GuidingField(scene->bbox(), m_guiding_grid,
+                                           m_guiding_bins);
+        m_guiding_train = m_guiding_passes > 0;
     }
 
+    void render_pass_end(uint32_t pass) override {
+        if (!m_guiding_train)
+            return;
+
+        m_guiding_field->update();
+        m_guiding_train = pass + 1 < m_guiding_passes;
+    }
+
+    bool needs_pass_callback() const override { return m_guiding; }
+
     MI_INLINE
     Float index_spectrum(const UnpolarizedSpectrum &spec, const UInt32 &idx) const {
         Float m = spec[0];
@@ -99,6 +187,15 @@ public:
                                      Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
+        // Sample from and/or train the guiding field at surfaces?
+        const GuidingField *guiding = m_guiding_field.get();
+        bool guide = guiding && guiding->ready(),
+             train = guiding && m_guiding_train;
+
+        std::optional<typename GuidingField::Vertices> vertices;
+        if (train)
+            vertices.emplace(dr::width(ray_));
+
         // If there is an environment emitter and emitters are visible: all rays will be valid
         // Otherwise, it will depend on whether a valid interaction is sampled
         Mask valid_ray = !m_hide_emitters && dr::neq(scene->environment(), nullptr);
@@ -154,7 +251,7 @@ public:
             Mask active_medium  = active && dr::neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
             Mask act_null_scatter = false, act_medium_scatter = false,
-                 escaped_medium = false;
+                 escaped_medium = false, equiangular = false;
 
             // If the medium does not have a spectrally varying extinction,
             // we can perform a few optimizations to speed up rendering
@@ -167,7 +264,15 @@ public:
 
             if (dr::any_or<true>(active_medium)) {
                 mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = mei.t;
+
+                // Equi-angular sampling needs the full segment up to the next surface
+                if (m_equiangular)
+                    equiangular = not_spectral && medium->is_homogeneous() &&
+                                  medium->use_emitter_sampling() &&
+                                  (depth + 1 < (uint32_t) m_max_depth);
+
+                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() &&
+                                         mei.is_valid() && !equiangular) = mei.t;
                 Mask intersect = needs_intersection && active_medium;
                 if (dr::any_or<true>(intersect))
                     dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
@@ -180,13 +285,43 @@ public:
                     dr::masked(throughput, is_spectral) *= dr::select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
                 }
 
+                if (dr::any_or<true>(equiangular)) {
+                    Spectrum contrib = sample_equiangular(scene, sampler, ray, si, mei,
+                                                          medium, channel, equiangular);
+                    dr::masked(result, equiangular) += throughput * contrib;
+                    valid_ray |= equiangular &&
+                                 dr::any(dr::neq(unpolarized_spectrum(contrib), 0.f));
+                }
+
                 escaped_medium = active_medium && !mei.is_valid();
                 active_medium &= mei.is_valid();
 
+                /* Gather the emission of volume emitters at every tentative
+                   collision, unless the previous vertex already sampled it */
+                Mask active_emission = active_medium && specular_chain;
+                if (dr::any_or<true>(active_emission)) {
+                    EmitterPtr emitter = mei.medium->emitter();
+                    active_emission &= dr::neq(emitter, nullptr);
+                    if (dr::any_or<true>(active_emission)) {
+                        SurfaceInteraction3f si_e = dr::zeros<SurfaceInteraction3f>();
+                        si_e.p           = mei.p;
+                        si_e.time        = mei.time;
+                        si_e.wavelengths = mei.wavelengths;
+                        Spectrum emitted = emitter->eval(si_e, active_emission);
+
+                        // The free-flight weight of spectral media already divides by the majorant
+                        Float inv_majorant = dr::rcp(index_spectrum(mei.combined_extinction, channel));
+                        dr::masked(result, active_emission) +=
+                            throughput * emitted * dr::select(is_spectral, 1.f, inv_majorant);
+                        valid_ray |= active_emission;
+                    }
+                }
+
                 // Handle null and real scatter events
                 Mask null_scatter = sampler->next_1d(active_medium) >= index_spectrum(mei.sigma_t, channel) / index_spectrum(mei.combined_extinction, channel);
 
                 act_null_scatter |= null_scatter && active_medium;
+                stats_count(StatsCounter::NullCollision, null_scatter && active_medium);
                 act_medium_scatter |= !act_null_scatter && active_medium;
 
                 if (dr::any_or<true>(is_spectral && act_null_scatter))
@@ -226,6 +361,11 @@ public:
                 Mask active_e = act_medium_scatter && sample_emitters;
                 if (dr::any_or<true>(active_e)) {
                     auto [emitted, ds] = sample_emitter(mei, scene, sampler, medium, channel, active_e);
+
+                    // Point-like emitters were already accounted for by equi-angular sampling
+                    if (m_equiangular)
+                        dr::masked(emitted, equiangular && has_flag(ds.emitter->flags(),
+                                                                    EmitterFlags::DeltaPosition)) = 0.f;
                     Float phase_val = phase->eval(phase_ctx, mei, ds.d, active_e);
                     dr::masked(result, active_e) += throughput * phase_val * emitted *
                                                     mis_weight(ds.pdf, dr::select(ds.delta, 0.f, phase_val));
@@ -277,6 +417,9 @@ public:
                 BSDFPtr bsdf  = si.bsdf(ray);
                 Mask active_e = active_surface && has_flag(bsdf->flags(), BSDFFlags::Smooth) && (depth + 1 < (uint32_t) m_max_depth);
 
+                // Dirac delta lobes are neither guided nor used for training
+                Mask active_guide = active_surface && !has_flag(bsdf->flags(), BSDFFlags::Delta);
+
                 if (likely(dr::any_or<true>(active_e))) {
                     auto [emitted, ds] = sample_emitter(si, scene, sampler, medium, channel, active_e);
 
@@ -288,17 +431,36 @@ public:
                     // Determine probability of having sampled that same
                     // direction using BSDF sampling.
                     Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
+                    if (guide)
+                        bsdf_pdf = guiding->pdf_bsdf(si, ds.d, bsdf_pdf, m_guiding_prob,
+                                                     active_e && active_guide);
                     result[active_e] += throughput * bsdf_val * mis_weight(ds.pdf, dr::select(ds.delta, 0.f, bsdf_pdf)) * emitted;
                 }
 
                 // ----------------------- BSDF sampling ----------------------
                 auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active_surface),
                                                    sampler->next_2d(active_surface), active_surface);
+                stats_count(StatsCounter::BSDFSample, active_surface);
+
+                // Mix BSDF and guided sampling using one-sample MIS
+                if (guide) {
+                    Float guide_1 = sampler->next_1d(active_surface);
+                    Point2f guide_2 = sampler->next_2d(active_surface);
+                    if (dr::any_or<true>(active_guide))
+                        std::tie(bs, bsdf_val, std::ignore) = guiding->sample_bsdf(
+                            ctx, bsdf, si, bs, bsdf_val, guide_1, guide_2,
+                            m_guiding_prob, active_guide);
+                }
+
                 bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
                 dr::masked(throughput, active_surface) *= bsdf_val;
                 dr::masked(eta, active_surface) *= bs.eta;
 
+                if (train)
+                    vertices->put(depth, guiding->bin_index(si.p, si.to_world(bs.wo)),
+                                  result, throughput, bs.pdf, active_guide);
+
                 Ray3f bsdf_ray                  = si.spawn_ray(si.to_world(bs.wo));
                 dr::masked(ray, active_surface) = bsdf_ray;
                 needs_intersection |= active_surface;
@@ -319,6 +481,13 @@ public:
             }
             active &= (active_surface | active_medium);
         }
+
+        stats_path_length(depth, true);
+
+        // Deposit the radiance that arrived at the recorded surface vertices
+        if (train)
+            vertices->finish(guiding, result, true);
+
         return { result, valid_ray };
     }
 
@@ -329,8 +498,6 @@ public:
     sample_emitter(const Interaction &ref_interaction, const Scene *scene,
                    Sampler *sampler, MediumPtr medium,
                    UInt32 channel, Mask active) const {
-        Spectrum transmittance(1.0f);
-
         auto [ds, emitter_val] = scene->sample_emitter_direction(ref_interaction, sampler->next_2d(active), false, active);
         dr::masked(emitter_val, dr::eq(ds.pdf, 0.f)) = 0.f;
         active &= dr::neq(ds.pdf, 0.f);
@@ -339,6 +506,90 @@ public:
             return { emitter_val, ds };
         }
 
+        Spectrum transmittance = eval_transmittance(ref_interaction, ds, scene,
+                                                    sampler, medium, channel, active);
+        return { transmittance * emitter_val, ds };
+    }
+
+    /**
+     * \brief Equi-angular sampling of single scattering from point-like emitters
+     *
+     * Samples a distance along the segment of \c ray in a homogeneous medium
+     * up to the surface \c si, proportionally to the inverse squared distance
+     * to the position of an emitter with the EmitterFlags::DeltaPosition flag.
+     * Returns the contribution of that emitter via the sampled position
+     * (relative to the path throughput). When another emitter is chosen, the
+     * contribution is zero: those are sampled at free-flight collisions.
+     */
+    Spectrum sample_equiangular(const Scene *scene, Sampler *sampler,
+                                const Ray3f &ray, const SurfaceInteraction3f &si,
+                                const MediumInteraction3f &mei, MediumPtr medium,
+                                UInt32 channel, Mask active) const {
+        auto [index, emitter_weight, index_sample] =
+            scene->sample_emitter(sampler->next_1d(active), active);
+        DRJIT_MARK_USED(index_sample);
+        active &= emitter_weight > 0.f;
+
+        EmitterPtr emitter = dr::gather<EmitterPtr>(scene->emitters_dr(), index, active);
+        active &= dr::neq(emitter, nullptr) &&
+                  has_flag(emitter->flags(), EmitterFlags::DeltaPosition);
+
+        // Position of the emitter (which doesn't depend on the reference point)
+        Point2f sample_dir = sampler->next_2d(active);
+        Interaction3f it = dr::zeros<Interaction3f>();
+        it.p           = ray.o;
+        it.time        = ray.time;
+        it.wavelengths = ray.wavelengths;
+        Point3f p_emitter = emitter->sample_direction(it, sample_dir, active).first.p;
+
+        // Parameterize the segment by the angle subtended at the emitter
+        Float delta = dr::dot(p_emitter - ray.o, ray.d),
+              dist  = dr::norm(p_emitter - ray.o - delta * ray.d),
+              t_max = dr::minimum(si.t, ray.maxt);
+        active &= dist > 0.f;
+
+        Float theta_a = dr::atan2(-delta, dist),
+              theta_b = dr::select(dr::isfinite(t_max),
+                                   dr::atan2(t_max - delta, dist),
+                                   .5f * dr::Pi<Float>),
+              theta   = dr::lerp(theta_a, theta_b, sampler->next_1d(active)),
+              t       = delta + dist * dr::tan(theta),
+              pdf     = dist / ((theta_b - theta_a) * (dr::sqr(dist) + dr::sqr(t - delta)));
+        active &= pdf > 0.f && t >= 0.f && t < t_max;
+
+        MediumInteraction3f mei_ea = mei;
+        mei_ea.t      = t;
+        mei_ea.p      = ray(t);
+        mei_ea.medium = medium;
+        std::tie(mei_ea.sigma_s, mei_ea.sigma_n, mei_ea.sigma_t) =
+            medium->get_scattering_coefficients(mei_ea, active);
+        mei_ea.combined_extinction = mei_ea.sigma_t;
+
+        // Connect the sampled position to the same emitter
+        auto [ds, emitter_val] = emitter->sample_direction(mei_ea, sample_dir, active);
+        active &= dr::neq(ds.pdf, 0.f);
+        if (dr::none_or<false>(active))
+            return 0.f;
+
+        Spectrum emitted = emitter_val * emitter_weight *
+                           eval_transmittance(mei_ea, ds, scene, sampler, medium,
+                                              channel, active);
+
+        PhaseFunctionContext phase_ctx(sampler);
+        Float phase_val = medium->phase_function()->eval(phase_ctx, mei_ea, ds.d, active);
+
+        UnpolarizedSpectrum weight = dr::exp(-t * mei_ea.sigma_t) * mei_ea.sigma_s *
+                                     (phase_val / pdf);
+        return dr::select(active, emitted * weight, 0.f);
+    }
+
+    /// Estimates the transmittance between an interaction and an emitter sample
+    template <typename Interaction>
+    Spectrum eval_transmittance(const Interaction &ref_interaction,
+                                const DirectionSample3f &ds, const Scene *scene,
+                                Sampler *sampler, MediumPtr medium,
+                                UInt32 channel, Mask active) const {
+        Spectrum transmittance(1.0f);
         Ray3f ray = ref_interaction.spawn_ray(ds.d);
 
         // Potentially escaping the medium if this is the current medium's boundary
@@ -366,37 +617,87 @@ public:
             Mask active_medium  = active && dr::neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
 
-            if (dr::any_or<true>(active_medium)) {
-                auto mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = dr::minimum(mei.t, remaining_dist);
-                Mask intersect = needs_intersection && active_medium;
+            /* The transmittance of homogeneous media is evaluated analytically
+               up to the next surface, which replaces tracking altogether */
+            Mask homogeneous = active_medium && medium->is_homogeneous();
+            if (dr::any_or<true>(homogeneous)) {
+                Mask intersect = needs_intersection && homogeneous;
                 if (dr::any_or<true>(intersect))
                     dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                needs_intersection &= !homogeneous;
+
+                MediumInteraction3f mei = dr::zeros<MediumInteraction3f>();
+                mei.p           = ray.o;
+                mei.wi          = -ray.d;
+                mei.sh_frame    = Frame3f(mei.wi);
+                mei.time        = ray.time;
+                mei.wavelengths = ray.wavelengths;
+                mei.medium      = medium;
+                UnpolarizedSpectrum sigma_t = medium->get_majorant(mei, homogeneous);
+                Float t = dr::minimum(remaining_dist, si.t);
+                dr::masked(transmittance, homogeneous) *= dr::exp(-t * sigma_t);
+
+                escaped_medium |= homogeneous;
+                active_medium &= !homogeneous;
+            }
 
-                dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
-                needs_intersection &= !active_medium;
-
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
-                Mask not_spectral = !is_spectral && active_medium;
-                if (dr::any_or<true>(is_spectral)) {
-                    Float t      = dr::minimum(remaining_dist, dr::minimum(mei.t, si.t)) - mei.mint;
-                    UnpolarizedSpectrum tr  = dr::exp(-t * mei.combined_extinction);
-                    UnpolarizedSpectrum free_flight_pdf = dr::select(si.t < mei.t || mei.t > remaining_dist, tr, tr * mei.combined_extinction);
-                    Float tr_pdf = index_spectrum(free_flight_pdf, channel);
-                    dr::masked(transmittance, is_spectral) *= dr::select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
+            if (dr::any_or<true>(active_medium)) {
+                MediumInteraction3f mei;
+                Mask is_spectral, not_spectral;
+
+                if (m_residual_tracking) {
+                    // Find the next surface first: the control optical depth is integrated up to it
+                    Mask intersect = needs_intersection && active_medium;
+                    if (dr::any_or<true>(intersect))
+                        dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    needs_intersection &= !active_medium;
+
+                    Ray3f medium_ray = ray;
+                    medium_ray.maxt = dr::minimum(remaining_dist, si.t);
+
+                    UnpolarizedSpectrum control, control_depth;
+                    std::tie(mei, control, control_depth) = medium->sample_interaction_residual(
+                        medium_ray, sampler->next_1d(active_medium), active_medium);
+                    DRJIT_MARK_USED(control);
+                    dr::masked(transmittance, active_medium) *= dr::exp(-control_depth);
+
+                    // Collisions are weighted by the residual null extinction
+                    is_spectral = false;
+                    not_spectral = active_medium;
+                } else {
+                    mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
+                    dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = dr::minimum(mei.t, remaining_dist);
+                    Mask intersect = needs_intersection && active_medium;
+                    if (dr::any_or<true>(intersect))
+                        dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+
+                    dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
+                    needs_intersection &= !active_medium;
+
+                    is_spectral = medium->has_spectral_extinction() && active_medium;
+                    not_spectral = !is_spectral && active_medium;
+                    if (dr::any_or<true>(is_spectral)) {
+                        Float t      = dr::minimum(remaining_dist, dr::minimum(mei.t, si.t)) - mei.mint;
+                        UnpolarizedSpectrum tr  = dr::exp(-t * mei.combined_extinction);
+                        UnpolarizedSpectrum free_flight_pdf = dr::select(si.t < mei.t || mei.t > remaining_dist, tr, tr * mei.combined_extinction);
+                        Float tr_pdf = index_spectrum(free_flight_pdf, channel);
+                        dr::masked(transmittance, is_spectral) *= dr::select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
+                    }
                 }
 
                 // Handle exceeding the maximum distance by medium sampling
                 dr::masked(total_dist, active_medium && (mei.t > remaining_dist) && mei.is_valid()) = ds.dist;
                 dr::masked(mei.t, active_medium && (mei.t > remaining_dist)) = dr::Infinity<Float>;
 
-                escaped_medium = active_medium && !mei.is_valid();
+                escaped_medium |= active_medium && !mei.is_valid();
                 active_medium &= mei.is_valid();
                 is_spectral &= active_medium;
                 not_spectral &= active_medium;
 
                 dr::masked(total_dist, active_medium) += mei.t;
 
+                stats_count(StatsCounter::NullCollision, active_medium);
+
                 if (dr::any_or<true>(active_medium)) {
                     dr::masked(ray.o, active_medium)    = mei.p;
                     dr::masked(si.t, active_medium) = si.t - mei.t;
@@ -438,7 +739,7 @@ public:
                 dr::masked(medium, has_medium_trans) = si.target_medium(ray.d);
             }
         }
-        return { transmittance * emitter_val, ds };
+        return transmittance;
     }
 
     //! @}
@@ -447,9 +748,14 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricSimplePathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  guiding = %s,\n"
+                           "  transmittance_estimator = %s,\n"
+                           "  equiangular = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth, m_guiding,
+                           m_residual_tracking ? "residual" : "ratio",
+                           m_equiangular);
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -460,6 +766,24 @@ public:
     };
 
     MI_DECLARE_CLASS()
+private:
+    bool m_guiding;
+    uint32_t m_guiding_passes;
+    ScalarFloat m_guiding_prob;
+    uint32_t m_guiding_grid;
+    uint32_t m_guiding_bins;
+
+    /// Estimate transmittance of shadow rays using residual ratio tracking?
+    bool m_residual_tracking;
+
+    /// Sample point-like emitters equi-angularly in homogeneous media?
+    bool m_equiangular;
+
+    /// Guiding field of the current render (if guiding is enabled)
+    ref<GuidingField> m_guiding_field;
+
+    /// Are paths of the current pass recorded into \ref m_guiding_field?
+    bool m_guiding_train = false;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(VolumetricPathIntegrator, MonteCarloIntegrator);
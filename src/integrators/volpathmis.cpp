@@ -39,6 +39,13 @@ Volumetric path tracer with spectral MIS (:monosp:`volpathmis`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - tracking
+   - |string|
+   - Technique used to sample free-flight distances in participating media.
+     ``delta`` performs delta tracking against a majorant that is shared by
+     all channels, while ``decomposition`` performs decomposition tracking
+     against per-channel majorants (see below). (Default: ``delta``)
+
 This plugin provides a volumetric path tracer that can be used to compute approximate solutions
 of the radiative transfer equation. Its implementation performs MIS both for directional sampling
 as well as free-flight distance sampling. In particular, this integrator is well suited
@@ -49,6 +56,19 @@ and is only marginally slower than the :ref:`simple volumetric path tracer <inte
 Similar to the simple volumetric path tracer, this integrator has special
 support for index-matched transmission events.
 
+Chromatic media, whose extinction differs strongly between channels, cause
+many null collisions when all channels are tracked against a single majorant.
+With ``tracking`` set to ``decomposition``, free-flight distances are instead
+sampled according to the majorant of the channel that drives the path, using
+the per-channel grids of local majorants that media such as
+:ref:`heterogeneous <medium-heterogeneous>` build in RGB modes. The extinction
+is furthermore decomposed into the per-cell lower bound (the control
+component) and a residual :cite:`Kutz2017Spectral`. Collisions with the control
+component are always real and only need to look up the albedo, which avoids
+most lookups of the extinction in dense media. The spectral MIS weights are
+computed from the majorants of all channels, which are accumulated while
+traversing the grid.
+
 .. warning:: This integrator does not support forward-mode differentiation.
 
 .. tabs::
@@ -107,7 +127,16 @@ public:
         std::conditional_t<SpectralMis, dr::Matrix<Float, dr::array_size_v<UnpolarizedSpectrum>>,
                            UnpolarizedSpectrum>;
 
-    VolpathMisIntegratorImpl(const Properties &props) : Base(props) {}
+    VolpathMisIntegratorImpl(const Properties &props) : Base(props) {
+        std::string tracking = props.string("tracking", "delta");
+        if (tracking == "decomposition")
+            m_decomposition_tracking = true;
+        else if (tracking == "delta")
+            m_decomposition_tracking = false;
+        else
+            Throw("Invalid tracking technique \"%s\", must be one of: "
+                  "\"delta\" or \"decomposition\"!", tracking);
+    }
 
     MI_INLINE
     Float index_spectrum(const UnpolarizedSpectrum &spec, const UInt32 &idx) const {
@@ -206,19 +235,44 @@ public:
                 not_spectral = !is_spectral && active_medium;
             }
 
+            Mask control_collision = false;
             if (dr::any_or<true>(active_medium)) {
-                mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = mei.t;
-                Mask intersect = needs_intersection && active_medium;
-                if (dr::any_or<true>(intersect))
-                    dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
-                needs_intersection &= !active_medium;
-                dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
+                if (m_decomposition_tracking) {
+                    // Find the next surface first: the majorants are integrated up to it
+                    Mask intersect = needs_intersection && active_medium;
+                    if (dr::any_or<true>(intersect))
+                        dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    needs_intersection &= !active_medium;
+
+                    Ray3f medium_ray = ray;
+                    medium_ray.maxt = si.t;
+                    UnpolarizedSpectrum optical_depth;
+                    std::tie(mei, optical_depth, control_collision) =
+                        medium->sample_interaction_decomposition(
+                            medium_ray, sampler->next_2d(active_medium), channel,
+                            active_medium);
 
-                if (dr::any_or<true>(is_spectral)) {
-                    auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mei, si, is_spectral);
-                    update_weights(p_over_f, free_flight_pdf, tr, channel, is_spectral);
-                    update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
+                    if (dr::any_or<true>(is_spectral)) {
+                        UnpolarizedSpectrum tr = dr::exp(-optical_depth);
+                        UnpolarizedSpectrum free_flight_pdf =
+                            dr::select(mei.is_valid(), tr * mei.combined_extinction, tr);
+                        update_weights(p_over_f, free_flight_pdf, tr, channel, is_spectral);
+                        update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
+                    }
+                } else {
+                    mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
+                    dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = mei.t;
+                    Mask intersect = needs_intersection && active_medium;
+                    if (dr::any_or<true>(intersect))
+                        dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    needs_intersection &= !active_medium;
+                    dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
+
+                    if (dr::any_or<true>(is_spectral)) {
+                        auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mei, si, is_spectral);
+                        update_weights(p_over_f, free_flight_pdf, tr, channel, is_spectral);
+                        update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
+                    }
                 }
                 escaped_medium = active_medium && !mei.is_valid();
                 active_medium &= mei.is_valid();
@@ -227,7 +281,13 @@ public:
             }
 
             if (dr::any_or<true>(active_medium)) {
-                Mask null_scatter = sampler->next_1d(active_medium) >= index_spectrum(mei.sigma_t, channel) / index_spectrum(mei.combined_extinction, channel);
+                Float scatter_prob = index_spectrum(mei.sigma_t, channel) / index_spectrum(mei.combined_extinction, channel);
+                if (m_decomposition_tracking) {
+                    // Collisions with the residual component are real with probability sigma_t / (sigma_t + sigma_n)
+                    scatter_prob = dr::select(control_collision, 1.f,
+                        index_spectrum(mei.sigma_t, channel) / index_spectrum(mei.sigma_t + mei.sigma_n, channel));
+                }
+                Mask null_scatter = sampler->next_1d(active_medium) >= scatter_prob;
                 act_null_scatter |= null_scatter && active_medium;
                 act_medium_scatter |= !act_null_scatter && active_medium;
                 last_event_was_null = act_null_scatter;
@@ -420,20 +480,42 @@ public:
             Mask active_surface = active && !active_medium;
 
             if (dr::any_or<true>(active_medium)) {
-                auto mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = dr::minimum(mei.t, remaining_dist);
-                Mask intersect = needs_intersection && active_medium;
-                if (dr::any_or<true>(intersect))
-                    dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
-                dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
-                needs_intersection &= !active_medium;
+                MediumInteraction3f mei;
+                UnpolarizedSpectrum tr, free_flight_pdf;
+                if (m_decomposition_tracking) {
+                    Mask intersect = needs_intersection && active_medium;
+                    if (dr::any_or<true>(intersect))
+                        dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    needs_intersection &= !active_medium;
+
+                    /* Shadow rays only pass through null collisions, which
+                       all belong to the residual component (sample.y() = 1) */
+                    Ray3f medium_ray = ray;
+                    medium_ray.maxt = dr::minimum(remaining_dist, si.t);
+                    UnpolarizedSpectrum optical_depth;
+                    std::tie(mei, optical_depth, std::ignore) =
+                        medium->sample_interaction_decomposition(
+                            medium_ray, Point2f(sampler->next_1d(active_medium), 1.f),
+                            channel, active_medium);
+                    tr = dr::exp(-optical_depth);
+                    free_flight_pdf = dr::select(mei.is_valid(), tr * mei.combined_extinction, tr);
+                } else {
+                    mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
+                    dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = dr::minimum(mei.t, remaining_dist);
+                    Mask intersect = needs_intersection && active_medium;
+                    if (dr::any_or<true>(intersect))
+                        dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
+                    needs_intersection &= !active_medium;
+
+                    Float t = dr::minimum(remaining_dist, dr::minimum(mei.t, si.t)) - mei.mint;
+                    tr = dr::exp(-t * mei.combined_extinction);
+                    free_flight_pdf = dr::select(si.t < mei.t || mei.t > remaining_dist, tr, tr * mei.combined_extinction);
+                }
 
                 Mask is_spectral = medium->has_spectral_extinction() && active_medium;
                 Mask not_spectral = !is_spectral && active_medium;
                 if (dr::any_or<true>(is_spectral)) {
-                    Float t      = dr::minimum(remaining_dist, dr::minimum(mei.t, si.t)) - mei.mint;
-                    UnpolarizedSpectrum tr  = dr::exp(-t * mei.combined_extinction);
-                    UnpolarizedSpectrum free_flight_pdf = dr::select(si.t < mei.t || mei.t > remaining_dist, tr, tr * mei.combined_extinction);
                     update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
                     update_weights(p_over_f_uni, free_flight_pdf, tr, channel, is_spectral);
                 }
@@ -560,12 +642,18 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricMisPathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  tracking = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth,
+                           m_decomposition_tracking ? "decomposition" : "delta");
     }
 
     MI_DECLARE_CLASS()
+
+protected:
+    /// Use decomposition tracking against per-channel majorants
+    bool m_decomposition_tracking;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(VolumetricMisPathIntegrator, MonteCarloIntegrator);
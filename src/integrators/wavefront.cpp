@@ -0,0 +1,388 @@
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-wavefront:
+
+Wavefront path tracer (:monosp:`wavefront`)
+-------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1
+     corresponds to :math:`\infty`). A value of 1 will only render directly
+     visible light sources. 2 will lead to single-bounce (direct-only)
+     illumination, and so on. (Default: -1)
+
+ * - rr_depth
+   - |int|
+   - Specifies the path depth, at which the implementation will begin to use
+     the *russian roulette* path termination criterion. (Default: 5)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This integrator computes the same quantity as the :ref:`path tracer
+<integrator-path>`, but organizes the computation differently in JIT
+variants. Instead of expressing the random walk as a single loop that is
+compiled into one megakernel, it launches separate kernels for every bounce:
+
+1. All rays of the current bounce are intersected with the scene, and the
+   emission of the surfaces they hit is accumulated.
+
+2. Paths that terminated are removed from the queue of active paths
+   (*compaction*), so that subsequent kernels only process live paths.
+
+3. The remaining paths are grouped by the BSDF they hit, and every BSDF is
+   shaded by its own kernel (emitter sampling, BSDF sampling and russian
+   roulette). Since all lanes of such a kernel call the same BSDF, no
+   virtual function call is needed and the lanes do not diverge.
+
+In deep-bounce scenes with many materials, this keeps the SIMD lanes (LLVM)
+or warps (CUDA) fully occupied, at the cost of a few synchronizations per
+bounce and of storing the path state in memory between kernels. Scalar
+variants trace paths one at a time and behave like the standard path tracer.
+
+Since paths are reordered, random numbers beyond the first bounce are drawn
+from a per-path PCG32 generator that is seeded using the sensor's sampler,
+rather than from the sampler itself. As a consequence, the stratification
+provided by samplers other than :ref:`independent <sampler-independent>` only
+applies to the first bounce.
+
+.. note:: This integrator does not handle participating media and does not
+   support differentiation.
+
+.. tabs::
+    .. code-tab::  xml
+        :name: wavefront-integrator
+
+        <integrator type="wavefront">
+            <integer name="max_depth" value="8"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'wavefront',
+        'max_depth': 8
+
+ */
+
+template <typename Float, typename Spectrum>
+class WavefrontPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MI_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    using PCG32 = mitsuba::PCG32<UInt32>;
+
+    /// State of a path that is carried from one bounce to the next
+    struct PathState {
+        /// Index of the path within the wavefront passed to \ref sample()
+        UInt32 lane;
+        Ray3f ray;
+        Spectrum throughput;
+        Float eta;
+        Bool alive;
+        PCG32 rng;
+
+        // Information about the previous bounce
+        Interaction3f prev_si;
+        Float prev_bsdf_pdf;
+        Bool prev_bsdf_delta;
+
+        DRJIT_STRUCT(PathState, lane, ray, throughput, eta, alive, rng,
+                     prev_si, prev_bsdf_pdf, prev_bsdf_delta)
+    };
+
+    WavefrontPathIntegrator(const Properties &props) : Base(props) { }
+
+    std::pair<Spectrum, Bool> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray_,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Bool active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if (unlikely(m_max_depth == 0))
+            return { 0.f, false };
+
+        size_t width = dr::width(ray_);
+
+        // Per-path outputs, indexed by PathState::lane
+        Spectrum result = dr::zeros<Spectrum>(width);
+        Bool valid_ray = dr::full<Bool>(
+            !m_hide_emitters && scene->environment() != nullptr, width);
+
+        // Seed the per-path random number generators using the sampler
+        UInt64 initstate = UInt64(dr::reinterpret_array<UInt32>(
+            dr::float32_array_t<Float>(sampler->next_1d(active))));
+
+        PathState state;
+        if constexpr (dr::is_jit_v<Float>)
+            state.lane = dr::arange<UInt32>(width);
+        else
+            state.lane = 0u;
+        state.ray             = Ray3f(ray_);
+        state.throughput      = dr::full<Spectrum>(1.f, width);
+        state.eta             = dr::full<Float>(1.f, width);
+        state.alive           = active;
+        state.rng             = PCG32(width, initstate);
+        state.prev_si         = dr::zeros<Interaction3f>(width);
+        state.prev_bsdf_pdf   = dr::full<Float>(1.f, width);
+        state.prev_bsdf_delta = dr::full<Bool>(true, width);
+
+        for (uint32_t depth = 0; depth < (uint32_t) m_max_depth; ++depth) {
+            // Remove terminated paths from the queue
+            if (!compact(state, nullptr, state.alive))
+                break;
+
+            SurfaceInteraction3f si =
+                scene->ray_intersect(state.ray,
+                                     /* ray_flags = */ scene->ray_flags(),
+                                     /* coherent = */ depth == 0);
+
+            // ---------------------- Direct emission ----------------------
+
+            EmitterPtr emitter = si.emitter(scene);
+            Mask active_e = dr::neq(emitter, nullptr);
+
+            if (dr::any_or<true>(active_e)) {
+                DirectionSample3f ds(scene, si, state.prev_si);
+                Float em_pdf = 0.f;
+
+                if (dr::any_or<true>(!state.prev_bsdf_delta))
+                    em_pdf = scene->pdf_emitter_direction(
+                        state.prev_si, ds, active_e && !state.prev_bsdf_delta);
+
+                // Compute MIS weight for emitter sample from previous bounce
+                Float mis_bsdf = mis_weight(state.prev_bsdf_pdf, em_pdf);
+
+                accumulate(result, state.lane,
+                           state.throughput *
+                               emitter->eval(si, active_e &&
+                                                     state.prev_bsdf_pdf > 0.f) *
+                               mis_bsdf,
+                           active_e);
+            }
+
+            // Continue tracing the paths that hit a surface?
+            if (depth + 1 >= (uint32_t) m_max_depth)
+                break;
+
+            if (!compact(state, &si, si.is_valid()))
+                break;
+
+            // ------------------ Shade (per material) ---------------------
+
+            if constexpr (dr::is_jit_v<Float>) {
+                constexpr JitBackend backend = dr::backend_v<Float>;
+                const char *domain = BSDFPtr::CallSupport::Domain;
+
+                UInt32 bsdf_id =
+                    dr::reinterpret_array<UInt32>(si.bsdf(state.ray));
+                uint32_t bsdf_count = jit_registry_get_max(backend, domain);
+
+                // Count the paths per BSDF to skip unused ones without a sync
+                UInt32 counts = dr::zeros<UInt32>(bsdf_count + 1);
+                dr::scatter_reduce(ReduceOp::Add, counts, UInt32(1), bsdf_id);
+                auto &&counts_host = dr::migrate(counts, AllocType::Host);
+                dr::sync_thread();
+                const uint32_t *count = counts_host.data();
+
+                // Launch a separate shading kernel for every BSDF
+                for (uint32_t id = 1; id <= bsdf_count; ++id) {
+                    const BSDF *bsdf =
+                        (const BSDF *) jit_registry_get_ptr(backend, domain, id);
+                    if (!bsdf || count[id] == 0)
+                        continue;
+
+                    UInt32 sel = dr::compress(dr::eq(bsdf_id, id));
+
+                    PathState sub = dr::gather<PathState>(state, sel);
+                    SurfaceInteraction3f sub_si =
+                        dr::gather<SurfaceInteraction3f>(si, sel);
+
+                    shade(scene, bsdf, sub_si, sub, result, valid_ray, depth);
+
+                    dr::scatter(state, sub, sel);
+                    dr::eval(state);
+                }
+            } else {
+                shade(scene, si.bsdf(state.ray), si, state, result, valid_ray,
+                      depth);
+            }
+        }
+
+        return {
+            /* spec  = */ dr::select(valid_ray, result, 0.f),
+            /* valid = */ valid_ray
+        };
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        return tfm::format("WavefrontPathIntegrator[\n"
+            "  max_depth = %u,\n"
+            "  rr_depth = %u\n"
+            "]", m_max_depth, m_rr_depth);
+    }
+
+    MI_DECLARE_CLASS()
+protected:
+    /**
+     * \brief Perform emitter sampling, BSDF sampling and russian roulette for
+     * paths that all hit the same BSDF
+     */
+    void shade(const Scene *scene, const BSDF *bsdf,
+               const SurfaceInteraction3f &si, PathState &state,
+               Spectrum &result, Bool &valid_ray, uint32_t depth) const {
+        BSDFContext bsdf_ctx;
+        PCG32 &rng = state.rng;
+
+        // ---------------------- Emitter sampling ----------------------
+
+        // The flags are uniform across the queue, so this test is free
+        Mask active_em = has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+        DirectionSample3f ds = dr::zeros<DirectionSample3f>();
+        Spectrum em_weight = dr::zeros<Spectrum>();
+        Vector3f wo = dr::zeros<Vector3f>();
+
+        if (dr::any_or<true>(active_em)) {
+            Point2f sample_em(next_float(rng), next_float(rng));
+            std::tie(ds, em_weight) = scene->sample_emitter_direction(
+                si, sample_em, true, active_em);
+            active_em &= dr::neq(ds.pdf, 0.f);
+            wo = si.to_local(ds.d);
+        }
+
+        // ------ Evaluate BSDF * cos(theta) and sample direction -------
+
+        Float sample_1 = next_float(rng);
+        Point2f sample_2(next_float(rng), next_float(rng));
+
+        auto [bsdf_val, bsdf_pdf, bsdf_sample, bsdf_weight]
+            = bsdf->eval_pdf_sample(bsdf_ctx, si, wo, sample_1, sample_2);
+
+        // --------------- Emitter sampling contribution ----------------
+
+        if (dr::any_or<true>(active_em)) {
+            bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+            // Compute the MIS weight
+            Float mis_em =
+                dr::select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+
+            accumulate(result, state.lane,
+                       state.throughput * (bsdf_val * em_weight * mis_em),
+                       active_em);
+        }
+
+        // ---------------------- BSDF sampling ----------------------
+
+        bsdf_weight = si.to_world_mueller(bsdf_weight, -bsdf_sample.wo, si.wi);
+        state.ray = si.spawn_ray(si.to_world(bsdf_sample.wo));
+
+        // ------ Update path state based on current interaction ------
+
+        state.throughput *= bsdf_weight;
+        state.eta *= bsdf_sample.eta;
+
+        Mask non_null = !has_flag(bsdf_sample.sampled_type, BSDFFlags::Null);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::scatter(valid_ray, Bool(true), state.lane, non_null);
+        else
+            valid_ray |= non_null;
+
+        state.prev_si = si;
+        state.prev_bsdf_pdf = bsdf_sample.pdf;
+        state.prev_bsdf_delta =
+            has_flag(bsdf_sample.sampled_type, BSDFFlags::Delta);
+
+        // -------------------- Stopping criterion ---------------------
+
+        Float throughput_max = dr::max(unpolarized_spectrum(state.throughput));
+        state.alive = dr::neq(throughput_max, 0.f);
+
+        if (depth + 1 >= (uint32_t) m_rr_depth) {
+            Float rr_prob = dr::minimum(throughput_max * dr::sqr(state.eta), .95f);
+            Mask rr_continue = next_float(rng) < rr_prob;
+            state.throughput *= dr::rcp(rr_prob);
+            state.alive &= rr_continue;
+        }
+    }
+
+    /**
+     * \brief Keep the entries of \c state (and of \c si, if provided) where
+     * \c mask is set
+     *
+     * Returns \c false when no entries remain. In scalar variants, this
+     * simply reports whether the path is still active.
+     */
+    bool compact(PathState &state, SurfaceInteraction3f *si, Mask mask) const {
+        if constexpr (dr::is_jit_v<Float>) {
+            UInt32 index = dr::compress(mask);
+            if (index.size() == 0)
+                return false;
+
+            state = dr::gather<PathState>(state, index);
+            if (si) {
+                *si = dr::gather<SurfaceInteraction3f>(*si, index);
+                dr::eval(state, *si);
+            } else {
+                dr::eval(state);
+            }
+            return true;
+        } else {
+            DRJIT_MARK_USED(state);
+            DRJIT_MARK_USED(si);
+            return mask;
+        }
+    }
+
+    /// Add \c value to the output of the given paths
+    void accumulate(Spectrum &result, const UInt32 &lane, const Spectrum &value,
+                    Mask active) const {
+        if constexpr (dr::is_jit_v<Float>) {
+            dr::scatter_reduce(ReduceOp::Add, result, value, lane, active);
+        } else {
+            DRJIT_MARK_USED(lane);
+            if (active)
+                result += value;
+        }
+    }
+
+    /// Draw a uniformly distributed sample in the precision of \c Float
+    static Float next_float(PCG32 &rng) {
+        if constexpr (std::is_same_v<ScalarFloat, double>)
+            return rng.next_float64();
+        else
+            return rng.next_float32();
+    }
+
+    /// Compute a multiple importance sampling weight using the power heuristic
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        Float w = pdf_a / (pdf_a + pdf_b);
+        return dr::select(dr::isfinite(w), w, 0.f);
+    }
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(WavefrontPathIntegrator, MonteCarloIntegrator)
+MI_EXPORT_PLUGIN(WavefrontPathIntegrator, "Wavefront path tracer integrator");
+NAMESPACE_END(mitsuba)
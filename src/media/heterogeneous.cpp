@@ -46,6 +46,12 @@ Heterogeneous medium (:monosp:`heterogeneous`)
      render time. This can reduce render time up to 50% when rendering objects
      with subsurface scattering.
 
+ * - majorant_cell_size
+   - |int|
+   - Edge length (in voxels of the extinction volume) of the cells of a coarse
+     grid of local majorants that is used for free-flight sampling. Set it to 0
+     to use a single global majorant instead. (Default: 16)
+
  * - (Nested plugin)
    - |phase|
    - A nested phase function that describes the directional scattering properties of
@@ -53,6 +59,12 @@ Heterogeneous medium (:monosp:`heterogeneous`)
      isotropic.
    - |exposed|, |differentiable|
 
+ * - (Nested plugin)
+   - |emitter|
+   - An optional nested :ref:`volume light <emitter-volumelight>` that makes
+     the medium emissive.
+   - |exposed|, |differentiable|
+
 
 This plugin provides a flexible heterogeneous medium implementation, which acquires its data
 from nested volume instances. These can be constant, use a procedural function, or fetch data from
@@ -68,6 +80,21 @@ meters and the coefficients are in inverse millimeters, set scale to 1000.
 Both the albedo and the extinction coefficient can either be constant or textured,
 and both parameters are allowed to be spectrally varying.
 
+Free-flight distances are sampled using delta tracking :cite:`Novak2014Residual`,
+which requires a majorant that bounds the extinction coefficient. Using the
+maximum of the entire volume can produce a very large number of null
+collisions in sparse data sets, e.g. smoke plumes surrounded by empty space.
+The medium therefore builds a coarse grid that stores the maximum extinction
+over blocks of :paramtype:`majorant_cell_size` voxels at load time (and whenever the
+volume data changes). Free-flight sampling traverses this grid using a 3D DDA
+and only tracks against the local majorant of every cell, skipping empty cells
+entirely. The traversal is further clipped to the bounds of the non-empty cells,
+and it jumps across larger empty regions at once using a precomputed distance
+to the nearest non-empty cell. In RGB modes, the cells of an extinction volume with three channels
+additionally bound each channel separately, which lets the decomposition
+tracking of the :ref:`volpathmis <integrator-volpathmis>` integrator sample
+chromatic media according to the majorant of a single channel.
+
 .. tabs::
     .. code-tab:: xml
         :name: lst-heterogeneous
@@ -149,7 +176,13 @@ template <typename Float, typename Spectrum>
 class HeterogeneousMedium final : public Medium<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(Medium, m_is_homogeneous, m_has_spectral_extinction,
-                    m_phase_function)
+                    m_phase_function, m_majorant_grid, m_control_grid,
+                    m_majorant_grid_rgb, m_control_grid_rgb,
+                    m_majorant_resolution, m_majorant_to_grid,
+                    m_majorant_bound, m_majorant_skip, has_majorant_grid,
+                    eval_majorant_grid, update_empty_space)
+    using typename Base::FloatStorage;
+    using typename Base::UInt32Storage;
     MI_IMPORT_TYPES(Scene, Sampler, Texture, Volume)
 
     HeterogeneousMedium(const Properties &props) : Base(props) {
@@ -160,7 +193,11 @@ public:
         m_scale = props.get<ScalarFloat>("scale", 1.0f);
         m_has_spectral_extinction = props.get<bool>("has_spectral_extinction", true);
 
-        m_max_density = dr::opaque<Float>(m_scale * m_sigmat->max());
+        m_majorant_cell_size = props.get<int>("majorant_cell_size", 16);
+        if (m_majorant_cell_size < 0)
+            Throw("The majorant cell size must be non-negative!");
+
+        update_majorants();
 
         dr::set_attr(this, "is_homogeneous", m_is_homogeneous);
         dr::set_attr(this, "has_spectral_extinction", m_has_spectral_extinction);
@@ -174,13 +211,81 @@ public:
     }
 
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override {
+        update_majorants();
+    }
+
+    /// Recompute the global majorant and the grid of local majorants
+    void update_majorants() {
         m_max_density = dr::opaque<Float>(m_scale * m_sigmat->max());
+
+        ScalarVector3i res = m_sigmat->resolution();
+        m_majorant_resolution = 0;
+        m_control_grid = FloatStorage();
+        m_majorant_grid_rgb = FloatStorage();
+        m_control_grid_rgb  = FloatStorage();
+        m_majorant_skip     = UInt32Storage();
+        if (m_majorant_cell_size == 0 || dr::prod(res) <= 1)
+            return;
+
+        ScalarVector3i cells = dr::maximum(
+            (res + m_majorant_cell_size - 1) / m_majorant_cell_size, 1);
+        const size_t n_cells = (size_t) dr::prod(cells);
+
+        /* Lower bounds serve as control extinction for residual ratio
+           tracking. Microflake media rescale the extinction by the projected
+           area, which lower bounds of the density don't account for. */
+        const bool control =
+            !has_flag(m_phase_function->flags(), PhaseFunctionFlags::Microflake);
+
+        /* In RGB modes, the channels of chromatic media are bounded separately
+           for decomposition tracking. The channel-uniform bounds follow. */
+        const bool per_channel = is_rgb_v<Spectrum> && m_sigmat->channel_count() == 3;
+
+        std::unique_ptr<ScalarFloat[]> majorants(new ScalarFloat[n_cells]);
+        auto reduce = [&](bool maximum) {
+            if (per_channel) {
+                std::unique_ptr<ScalarFloat[]> values(new ScalarFloat[n_cells * 3]);
+                if (maximum)
+                    m_sigmat->max_per_cell_per_channel(cells, values.get());
+                else
+                    m_sigmat->min_per_cell_per_channel(cells, values.get());
+                for (size_t i = 0; i < n_cells; ++i) {
+                    ScalarFloat *v = values.get() + 3 * i;
+                    for (size_t c = 0; c < 3; ++c)
+                        v[c] *= m_scale;
+                    majorants[i] = maximum ? dr::maximum(v[0], dr::maximum(v[1], v[2]))
+                                           : dr::minimum(v[0], dr::minimum(v[1], v[2]));
+                }
+                (maximum ? m_majorant_grid_rgb : m_control_grid_rgb) =
+                    dr::load<FloatStorage>(values.get(), n_cells * 3);
+            } else {
+                if (maximum)
+                    m_sigmat->max_per_cell(cells, majorants.get());
+                else
+                    m_sigmat->min_per_cell(cells, majorants.get());
+                for (size_t i = 0; i < n_cells; ++i)
+                    majorants[i] *= m_scale;
+            }
+            (maximum ? m_majorant_grid : m_control_grid) =
+                dr::load<FloatStorage>(majorants.get(), n_cells);
+        };
+
+        reduce(true);
+        update_empty_space(cells, majorants.get());
+        if (control)
+            reduce(false);
+        m_majorant_resolution = cells;
+        m_majorant_to_grid    = ScalarTransform4f::scale(ScalarVector3f(cells)) *
+                                m_sigmat->to_local();
+        m_majorant_bound      = m_scale * m_sigmat->max();
     }
 
     UnpolarizedSpectrum
-    get_majorant(const MediumInteraction3f & /* mi */,
+    get_majorant(const MediumInteraction3f &mi,
                  Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        if (has_majorant_grid())
+            return eval_majorant_grid(mi.p, active);
         return m_max_density;
     }
 
@@ -194,10 +299,16 @@ public:
             sigmat *= m_phase_function->projected_area(mi, active);
 
         auto sigmas = sigmat * m_albedo->eval(mi, active);
-        auto sigman = m_max_density - sigmat;
+        auto sigman = get_majorant(mi, active) - sigmat;
         return { sigmas, sigman, sigmat };
     }
 
+    UnpolarizedSpectrum get_albedo(const MediumInteraction3f &mi,
+                                   Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        return m_albedo->eval(mi, active);
+    }
+
     std::tuple<Mask, Float, Float>
     intersect_aabb(const Ray3f &ray) const override {
         return m_sigmat->bbox().ray_intersect(ray);
@@ -209,6 +320,7 @@ public:
             << "  albedo  = " << string::indent(m_albedo) << std::endl
             << "  sigma_t = " << string::indent(m_sigmat) << std::endl
             << "  scale   = " << string::indent(m_scale) << std::endl
+            << "  majorant_resolution = " << m_majorant_resolution << std::endl
             << "]";
         return oss.str();
     }
@@ -217,6 +329,7 @@ public:
 private:
     ref<Volume> m_sigmat, m_albedo;
     ScalarFloat m_scale;
+    int m_majorant_cell_size;
 
     Float m_max_density;
 };
@@ -53,6 +53,12 @@ Homogeneous medium (:monosp:`homogeneous`)
      isotropic.
    - |exposed|, |differentiable|
 
+ * - (Nested plugin)
+   - |emitter|
+   - An optional nested :ref:`volume light <emitter-volumelight>` that makes
+     the medium emissive.
+   - |exposed|, |differentiable|
+
 This class implements a homogeneous participating medium with support for arbitrary
 phase functions. This medium can be used to model effects such as fog or subsurface scattering.
 
@@ -178,6 +184,12 @@ public:
         return { sigmas & active, sigman, sigmat & active };
     }
 
+    UnpolarizedSpectrum get_albedo(const MediumInteraction3f &mi,
+                                   Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        return m_albedo->eval(mi, active) & active;
+    }
+
     std::tuple<Mask, Float, Float>
     intersect_aabb(const Ray3f & /* ray */) const override {
         return { true, 0.f, dr::Infinity<Float> };
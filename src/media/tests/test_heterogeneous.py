@@ -0,0 +1,176 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import os
+
+
+def create_scene(tmp_file, majorant_cell_size, estimator='ratio', integrator=None):
+    if integrator is None:
+        integrator = {
+            'type': 'volpath',
+            'max_depth': 8,
+            'transmittance_estimator': estimator,
+        }
+    return mi.load_dict({
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'perspective',
+            'fov': 40,
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, 0, 4], target=[0, 0, 0], up=[0, 1, 0]),
+            'sampler': {'type': 'independent', 'sample_count': 256},
+            'film': {
+                'type': 'hdrfilm',
+                'width': 8, 'height': 8,
+                'rfilter': {'type': 'box'}
+            },
+        },
+        'cube': {
+            'type': 'cube',
+            'bsdf': {'type': 'null'},
+            'interior': {
+                'type': 'heterogeneous',
+                'albedo': 0.8,
+                'scale': 4.0,
+                'majorant_cell_size': majorant_cell_size,
+                'sigma_t': {
+                    'type': 'gridvolume',
+                    'filename': tmp_file,
+                    'to_world': mi.ScalarTransform4f.translate(-1).scale(2),
+                },
+            },
+        },
+        'emitter': {'type': 'constant'},
+    })
+
+
+def write_sparse_grid(tmpdir):
+    # A dense blob in one corner of an otherwise mostly empty volume
+    tmp_file = os.path.join(str(tmpdir), "sparse.vol")
+    grid = dr.full(mi.TensorXf, 0.01, [16, 16, 16])
+    grid[10:14, 2:8, 9:15] = 1.0
+    mi.VolumeGrid(grid).write(tmp_file)
+    return tmp_file
+
+
+def test01_majorant_grid_matches_global(variants_all_rgb, tmpdir):
+    tmp_file = write_sparse_grid(tmpdir)
+    image = mi.render(create_scene(tmp_file, 4))
+    image_ref = mi.render(create_scene(tmp_file, 0))
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+
+def test02_majorant_lookup(variants_vec_rgb, tmpdir):
+    tmp_file = write_sparse_grid(tmpdir)
+    medium = create_scene(tmp_file, 4).shapes()[0].interior_medium()
+
+    # Empty cell, occupied cell, and a point outside of the grid
+    mei = dr.zeros(mi.MediumInteraction3f, 3)
+    mei.p = mi.Point3f([-0.75, 0.25, 0.0], [0.75, -0.25, 0.0], [-0.75, 0.25, 5.0])
+    majorant = medium.get_majorant(mei)[0]
+    assert dr.allclose(majorant, [0.04, 4.0, 4.0])
+
+
+@pytest.mark.parametrize('majorant_cell_size', [0, 4])
+def test03_residual_ratio_tracking(variants_all_rgb, tmpdir, majorant_cell_size):
+    tmp_file = write_sparse_grid(tmpdir)
+    image = mi.render(create_scene(tmp_file, majorant_cell_size, 'residual'))
+    image_ref = mi.render(create_scene(tmp_file, majorant_cell_size, 'ratio'))
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+
+def test04_residual_control_bounds(variants_vec_rgb, tmpdir):
+    tmp_file = write_sparse_grid(tmpdir)
+    medium = create_scene(tmp_file, 4).shapes()[0].interior_medium()
+
+    # A ray through the empty part of the volume only sees the control extinction
+    ray = mi.Ray3f(mi.Point3f(-0.75, 0.75, 2.0), mi.Vector3f(0, 0, -1))
+    mei, control, control_depth = medium.sample_interaction_residual(ray, 0.5, True)
+    assert dr.allclose(control_depth[0], 0.04 * 2.0, rtol=1e-3)
+    assert dr.none(mei.is_valid())
+
+
+def write_chromatic_grid(tmpdir):
+    # Like write_sparse_grid(), but the extinction differs between channels
+    tmp_file = os.path.join(str(tmpdir), "chromatic.vol")
+    grid = dr.zeros(mi.TensorXf, [16, 16, 16, 3])
+    for c, (empty, dense) in enumerate([(0.01, 1.0), (0.02, 0.5), (0.04, 0.25)]):
+        grid[:, :, :, c] = empty
+        grid[10:14, 2:8, 9:15, c] = dense
+    mi.VolumeGrid(grid).write(tmp_file)
+    return tmp_file
+
+
+@pytest.mark.parametrize('majorant_cell_size', [0, 4])
+def test05_decomposition_tracking(variants_all_rgb, tmpdir, majorant_cell_size):
+    tmp_file = write_chromatic_grid(tmpdir)
+    image, image_ref = [mi.render(create_scene(tmp_file, majorant_cell_size, integrator={
+        'type': 'volpathmis',
+        'max_depth': 8,
+        'tracking': tracking
+    })) for tracking in ['decomposition', 'delta']]
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+
+def test06_channel_majorants(variants_vec_rgb, tmpdir):
+    tmp_file = write_chromatic_grid(tmpdir)
+    medium = create_scene(tmp_file, 4).shapes()[0].interior_medium()
+
+    # A ray through the empty part of the volume accumulates the majorant of every channel
+    ray = mi.Ray3f(mi.Point3f(-0.75, 0.75, 2.0), mi.Vector3f(0, 0, -1))
+    for channel in range(3):
+        mei, optical_depth, control = medium.sample_interaction_decomposition(
+            ray, mi.Point2f(0.5, 0.5), channel, True)
+        assert dr.allclose(optical_depth, mi.Color3f(0.08, 0.16, 0.32), rtol=1e-3)
+        assert dr.none(mei.is_valid())
+
+    # Collisions with the control component are real and carry the albedo
+    ray = mi.Ray3f(mi.Point3f(0.75, -0.25, 0.0), mi.Vector3f(0, 0, 1))
+    mei, optical_depth, control = medium.sample_interaction_decomposition(
+        ray, mi.Point2f(0.5, 0.0), 0, True)
+    assert dr.all(mei.is_valid() & control)
+    assert dr.allclose(mei.sigma_s, 0.8 * mei.sigma_t)
+    assert dr.allclose(mei.sigma_n, 0.0)
+
+
+def write_empty_grid(tmpdir):
+    # Like write_sparse_grid(), but the space around the blobs is truly empty
+    tmp_file = os.path.join(str(tmpdir), "empty.vol")
+    grid = dr.zeros(mi.TensorXf, [32, 32, 32])
+    grid[20:28, 4:16, 18:30] = 1.0
+    grid[3:5, 25:27, 2:4] = 2.0
+    mi.VolumeGrid(grid).write(tmp_file)
+    return tmp_file
+
+
+@pytest.mark.parametrize('majorant_cell_size', [1, 2])
+def test07_empty_space_skipping(variants_all_rgb, tmpdir, majorant_cell_size):
+    tmp_file = write_empty_grid(tmpdir)
+    image = mi.render(create_scene(tmp_file, majorant_cell_size))
+    image_ref = mi.render(create_scene(tmp_file, 0))
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+
+def test08_empty_space_free_flight(variants_vec_rgb, tmpdir):
+    tmp_file = write_empty_grid(tmpdir)
+    medium = create_scene(tmp_file, 1).shapes()[0].interior_medium()
+
+    # Rays through the empty part of the volume never collide
+    n = 1000
+    ray = mi.Ray3f(mi.Point3f(-0.25, 0.75, 2.0), mi.Vector3f(0, 0, -1))
+    mei = medium.sample_interaction(ray, dr.linspace(mi.Float, 0, 1, n, False), 0, True)
+    assert dr.none(mei.is_valid())
+
+    # Tentative collisions along a diagonal ray lie within the cells around the blob
+    o = mi.Point3f(-1.0, -1.0, -1.0)
+    d = dr.normalize(mi.Vector3f(0.75, -0.25, 0.5) - o)
+    ray = mi.Ray3f(o, d)
+    mei = medium.sample_interaction(ray, dr.linspace(mi.Float, 0, 1, n, False), 0, True)
+    valid = mei.is_valid()
+    assert dr.any(valid)
+    p = dr.select(valid, mei.p, mi.Point3f(0.75, -0.25, 0.5))
+    eps = 2 / 32 + 1e-4
+    assert dr.all((p.x >= 0.125 - eps) & (p.x <= 0.875 + eps))
+    assert dr.all((p.y >= -0.75 - eps) & (p.y <= 0.0 + eps))
+    assert dr.all((p.z >= 0.25 - eps) & (p.z <= 0.75 + eps))
@@ -1,19 +1,35 @@
 #include <mitsuba/core/argparser.h>
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/bitmapwriter.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/plugin.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/sstream.h>
+#include <mitsuba/core/stats.h>
+#include <mitsuba/core/trace.h>
 #include <mitsuba/core/thread.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
+#include <mitsuba/render/animation.h>
+#include <mitsuba/render/autotune.h>
+#include <mitsuba/render/distributed.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <thread>
+
 #if !defined(_WIN32)
 #  include <signal.h>
 #else
@@ -45,7 +61,8 @@ Options:
         Be more verbose. (can be specified multiple times)
 
     -t <count>, --threads <count>
-        Render with the specified number of threads.
+        Render with the specified number of threads. This limit also applies
+        to the parallel scene loading and the construction of the Embree BVH.
 
     -D <key>=<value>, --define <key>=<value>
         Define a constant that can referenced as "$key" within the scene
@@ -55,6 +72,24 @@ Options:
         Index of the sensor to render with (following the declaration order
         in the scene file). Default value: 0.
 
+    -b, --batch
+        Render all sensors of the scene at once (sharing a single kernel
+        launch in JIT modes) and write the image of sensor 'i' to
+        "<filename>_<i>". All sensors must have an 'hdrfilm' of the same
+        resolution.
+
+    --trace <filename>
+        Record a timeline of scene loading (parsing and creation of each
+        object), rendered blocks and profiler phases on all threads, and
+        write it to "filename" in the Chrome trace event format (viewable
+        with chrome://tracing or Perfetto). Ranges shorter than 10
+        microseconds are omitted to keep the size of the trace manageable.
+
+    --stats
+        Collect render statistics (number of traced rays, BSDF and emitter
+        samples, null collisions, path lengths) and print them after
+        each render.
+
     -u, --update
         When specified, Mitsuba will update the scene's XML description
         to the latest version.
@@ -65,6 +100,78 @@ Options:
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
 
+    -k <filename>, --keyframes <filename>
+        Render an animation: load the scene once and render one image per
+        frame, whose parameters are set by the keyframes of "filename" (one
+        line "<frame> <parameter> <value>" per keyframe, using the
+        parameter names of mi.traverse(), e.g. "0 sensor.to_world look_at
+        0 -4 1 0 0 0 0 0 1"). Only the animated parameters are updated
+        between frames, and the image of frame 'i' is written to
+        "<filename>_<i>" while the next frame is rendered.
+
+    -f <first>:<last>, --frames <first>:<last>
+        Range of frames of an animation (-k) to render. Default: from the
+        first to the last keyframe.
+
+    -c <seconds>, --checkpoint-interval <seconds>
+        Periodically write the partially rendered image to the output file
+        while rendering is in progress (only supported in scalar modes).
+
+    -r <filename>, --resume <filename>
+        Save the render state to "filename" after every completed pass. If
+        the file already exists, rendering continues with the first
+        incomplete pass. Use the 'samples_per_pass' integrator parameter to
+        save the state more often (only supported in scalar modes).
+
+    -w <host:port>;<host:port>;.., --workers <host:port>;<host:port>;..
+        Distribute the tiles of the render over the given worker machines
+        (started with -l). Files referenced by the scene must be reachable
+        under the same path on the workers. Tiles of unreachable or
+        lost workers are rendered locally (only supported in scalar modes).
+
+    -l <port>, --listen <port>
+        Run as a render worker: accept jobs from a machine started with -w
+        on the given TCP port until the process is terminated. Workers
+        only accept local connections unless --bind is specified.
+
+    --job-server <port>
+        Keep scenes loaded between renders: accept render requests on the
+        given TCP port until the process is terminated. Every request is a
+        line with the arguments of a render ("<scene file> [-D key=value]
+        [-s index] [-b] [-o filename]"), which is answered by a line that
+        starts with "OK" or "ERROR" once the image is written. Scenes are
+        cached by file and parameters (after -D arguments of the command
+        line), so later requests reuse their acceleration data structures
+        and, in JIT modes, their compiled kernels. A cached scene is loaded
+        again when its file was modified. The request "clear" discards the
+        cached scenes. The server has no authentication and only accepts
+        local connections unless --bind is specified.
+
+    --job-dir <directory>
+        Directory of the scene and output files of --job-server requests:
+        requests referencing files outside of it are rejected. Default: the
+        current working directory.
+
+    --job-cache <count>
+        Maximum number of scenes kept loaded by --job-server. Once it is
+        reached, the least recently rendered scene is discarded. Default: 4
+
+    --bind <address>
+        Address of the network interface on which -l and --job-server
+        listen, e.g. "0.0.0.0" for all of them. Default: "127.0.0.1", which
+        only accepts connections from the local machine.
+
+    --autotune
+        Before rendering, find the settings that maximize the throughput
+        of the scene on this machine (thread count, LLVM vector width,
+        samples per pass, and image block size in scalar modes) using
+        short calibration renders, and render with them. The result is
+        cached per scene and machine, so later runs skip the calibration.
+        Settings specified with -t or -V are not tuned.
+
+    --autotune-cache <filename>
+        Cache file of --autotune (default: "~/.mitsuba/autotune.txt")
+
  === The following options are only relevant for JIT (CUDA/LLVM) modes ===
 
     -O [0-5]
@@ -81,6 +188,21 @@ Options:
         series of wavefronts. Specify twice to unroll both loops *and*
         virtual function calls.
 
+    --kernel-cache <directory>
+        Store compiled kernels in "<directory>/.drjit" instead of the
+        default location in the user's home directory, e.g. to share
+        precompiled kernels between the machines of a render farm.
+
+    --kernel-stats
+        Report the number of launched kernels, the fraction of them that
+        were found in the kernel cache, and the time spent compiling.
+
+    --warmup
+        Trace and compile the kernels of the render without rendering the
+        image (only a pixel is evaluated, and no output is written). Later
+        renders of the same scene configuration then load the compiled
+        kernels from the cache.
+
     -V <width>
         Override the vector width of the LLVM backend ('width' must be
         a power of two). Values of 4/8/16 cause SSE/NEON, AVX, or AVX512
@@ -105,7 +227,138 @@ void scene_static_accel_shutdown() {
 }
 
 template <typename Float, typename Spectrum>
-void render(Object *scene_, size_t sensor_i, fs::path filename) {
+void serve(SocketStream *stream, const RenderJob &job) {
+    ref<RenderWorker<Float, Spectrum>> worker =
+        new RenderWorker<Float, Spectrum>(stream, job);
+    worker->run();
+}
+
+/**
+ * Create a batch sensor that tiles all sensors of the scene side by side, so
+ * that they are rendered in a single pass
+ */
+template <typename Float, typename Spectrum>
+ref<Sensor<Float, Spectrum>> create_batch_sensor(Scene<Float, Spectrum> *scene) {
+    MI_IMPORT_TYPES(Film, Sensor, ReconstructionFilter)
+
+    const auto &sensors = scene->sensors();
+    Film *film = sensors[0]->film();
+    ScalarVector2u size = film->size();
+
+    Properties props("batch");
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        Film *film_i = sensors[i]->film();
+        if (std::string(film_i->class_()->name()) != "HDRFilm")
+            Throw("Batch rendering requires all sensors to use an \"hdrfilm\"!");
+        if (film_i->size() != size || film_i->crop_size() != size)
+            Throw("Batch rendering requires all sensors to have films of the "
+                  "same resolution (without crop windows)!");
+        props.set_object("sensor_" + std::to_string(i), sensors[i].get());
+    }
+
+    bool alpha = has_flag(film->flags(), FilmFlags::Alpha);
+    Properties film_props("hdrfilm");
+    film_props.set_int("width", (int) (size.x() * sensors.size()));
+    film_props.set_int("height", (int) size.y());
+    if constexpr (is_monochromatic_v<Spectrum>)
+        film_props.set_string("pixel_format", alpha ? "luminance_alpha" : "luminance");
+    else
+        film_props.set_string("pixel_format", alpha ? "rgba" : "rgb");
+    film_props.set_object(
+        "rfilter", const_cast<ReconstructionFilter *>(film->rfilter()));
+
+    props.set_object("film", PluginManager::instance()->create_object<Film>(film_props).get());
+    props.set_object("sampler", sensors[0]->sampler());
+    return PluginManager::instance()->create_object<Sensor>(props);
+}
+
+/**
+ * Scatter the tiles of a rendered batch sensor into the films of the
+ * individual sensors and write them to "<filename>_<i>"
+ */
+template <typename Float, typename Spectrum>
+void write_batch(Scene<Float, Spectrum> *scene,
+                 const Film<Float, Spectrum> *batch_film,
+                 const fs::path &filename) {
+    MI_IMPORT_TYPES(ImageBlock)
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    TensorXf raw = batch_film->develop(true);
+    uint32_t height  = (uint32_t) raw.shape(0),
+             total   = (uint32_t) raw.shape(1),
+             channels = (uint32_t) raw.shape(2);
+
+    const auto &sensors = scene->sensors();
+    uint32_t width = total / (uint32_t) sensors.size();
+
+    fs::path base = filename, extension = filename.extension();
+    base.replace_extension("");
+
+    std::vector<std::string> aovs = scene->integrator()->aov_names();
+    UInt32Storage index = dr::arange<UInt32Storage>(height * width * channels),
+                  channel = index % channels,
+                  pixel   = index / channels,
+                  x       = pixel % width,
+                  y       = pixel / width;
+
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        auto film = sensors[i]->film();
+        if (film->prepare(aovs) != channels)
+            Throw("Batch rendering: the film of sensor %zu has an incompatible "
+                  "channel layout!", i);
+        film->clear();
+
+        UInt32Storage source =
+            (y * total + x + (uint32_t) i * width) * channels + channel;
+        size_t shape[3] = { height, width, channels };
+        TensorXf tile(dr::gather<FloatStorage>(raw.array(), source), 3, shape);
+
+        ref<ImageBlock> block = new ImageBlock(tile, ScalarPoint2i(0),
+                                               film->rfilter(), false);
+        film->put_block(block);
+
+        fs::path path(base.string() + "_" + std::to_string(i));
+        if (!extension.empty())
+            path.replace_extension(extension);
+        film->write_async(path);
+    }
+}
+
+/**
+ * Apply the fastest settings of the renderer for a scene (--autotune), which
+ * are found by calibration renders unless they are in the cache file
+ */
+template <typename Float, typename Spectrum>
+void autotune(Object *scene_, size_t sensor_i, const std::string &source,
+              const std::string &variant, const std::string &defines,
+              fs::path cache_file, bool tune_thread_count,
+              bool tune_vector_width) {
+    auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (sensor_i >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+
+    if (!dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(scene->integrator())) {
+        Log(Warn, "The integrator \"%s\" does not support autotuning, "
+                  "ignoring the --autotune argument.",
+            scene->integrator() ? scene->integrator()->class_()->name() : "none");
+        return;
+    }
+
+    ref<Autotuner<Float, Spectrum>> tuner = new Autotuner<Float, Spectrum>(
+        cache_file, tune_thread_count, tune_vector_width);
+    std::string scene_key = Autotuner<Float, Spectrum>::scene_key(
+        source, variant, defines, (uint32_t) sensor_i);
+    tuner->tune(scene, scene->sensors()[sensor_i].get(), scene_key);
+}
+
+template <typename Float, typename Spectrum>
+void render(Object *scene_, size_t sensor_i, bool batch, bool warmup,
+            fs::path filename,
+            float checkpoint_interval, fs::path state_file,
+            const RenderJob &job, const std::vector<std::string> &workers) {
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
     if (!scene)
         Throw("Root element of the input file must be a <scene> tag!");
@@ -113,29 +366,173 @@ void render(Object *scene_, size_t sensor_i, fs::path filename) {
         Throw("No sensor specified for scene: %s", scene);
     if (sensor_i >= scene->sensors().size())
         Throw("Specified sensor index is out of bounds!");
-    auto film = scene->sensors()[sensor_i]->film();
+
+    ref<Sensor<Float, Spectrum>> sensor = scene->sensors()[sensor_i];
+    if (batch) {
+        if (!workers.empty())
+            Throw("Batch rendering (-b) cannot be combined with render "
+                  "workers (-w)!");
+        sensor = create_batch_sensor(scene);
+    }
+    auto film = sensor->film();
 
     auto integrator = scene->integrator();
     if (!integrator)
         Throw("No integrator specified for scene: %s", scene);
 
+    if (warmup) {
+        auto *sampling_integrator =
+            dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(integrator);
+        if (!sampling_integrator) {
+            Log(Warn, "The integrator \"%s\" does not support kernel "
+                      "warm-up, skipping the render.",
+                integrator->class_()->name());
+            return;
+        }
+        sampling_integrator->set_warmup(true);
+        integrator->render(scene, sensor.get(), 0 /* seed */, 0 /* spp */,
+                           false /* develop */, true /* evaluate */);
+        sampling_integrator->set_warmup(false);
+        return;
+    }
+
     /* critical section */ {
         std::lock_guard<std::mutex> guard(develop_callback_mutex);
         develop_callback = [&]() { film->write(filename); };
     }
 
-    integrator->render(scene, (uint32_t) sensor_i,
-                       0 /* seed */,
-                       0 /* spp */,
-                       false /* develop */,
-                       true /* evaluate */);
+    if (!state_file.empty()) {
+        auto *sampling_integrator =
+            dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(integrator);
+        if (sampling_integrator)
+            sampling_integrator->set_state_file(state_file);
+        else
+            Log(Warn, "The integrator \"%s\" does not support resumable "
+                      "renders, ignoring the -r/--resume argument.",
+                integrator->class_()->name());
+    }
+
+    if (checkpoint_interval > 0.f && dr::is_jit_v<Float>) {
+        Log(Warn, "Checkpoints are only supported in scalar modes, ignoring "
+                  "the -c/--checkpoint-interval argument.");
+        checkpoint_interval = 0.f;
+    }
+
+    /* Periodically develop a snapshot of the film on a background thread.
+       The film copies its storage before developing it, so render workers
+       are only blocked for the duration of that copy. */
+    std::thread checkpoint_thread;
+    std::mutex checkpoint_mutex;
+    std::condition_variable checkpoint_cv;
+    bool render_done = false;
+
+    if (checkpoint_interval > 0.f) {
+        ThreadEnvironment env;
+        checkpoint_thread = std::thread([&, env]() mutable {
+            ScopedSetThreadEnvironment set_env(env);
+            auto interval = std::chrono::duration<float>(checkpoint_interval);
+            std::unique_lock<std::mutex> lock(checkpoint_mutex);
+            while (!checkpoint_cv.wait_for(lock, interval,
+                                           [&] { return render_done; })) {
+                lock.unlock();
+                try {
+                    film->write_snapshot(filename);
+                } catch (const std::exception &e) {
+                    Log(Warn, "Could not write a checkpoint: %s", e.what());
+                }
+                lock.lock();
+            }
+        });
+    }
+
+    auto stop_checkpoints = [&]() {
+        if (!checkpoint_thread.joinable())
+            return;
+        /* locked */ {
+            std::lock_guard<std::mutex> guard(checkpoint_mutex);
+            render_done = true;
+        }
+        checkpoint_cv.notify_all();
+        checkpoint_thread.join();
+    };
+
+    try {
+        if (!workers.empty()) {
+            ref<RenderCoordinator<Float, Spectrum>> coordinator =
+                new RenderCoordinator<Float, Spectrum>(scene, job, workers);
+            coordinator->render();
+        } else {
+            integrator->render(scene, sensor.get(),
+                               0 /* seed */,
+                               0 /* spp */,
+                               false /* develop */,
+                               true /* evaluate */);
+        }
+    } catch (...) {
+        stop_checkpoints();
+        std::lock_guard<std::mutex> guard(develop_callback_mutex);
+        develop_callback = nullptr;
+        throw;
+    }
+
+    stop_checkpoints();
 
     /* critical section */ {
         std::lock_guard<std::mutex> guard(develop_callback_mutex);
         develop_callback = nullptr;
     }
 
-    film->write(filename);
+    // The image is encoded and written while the next scene is loaded
+    if (batch)
+        write_batch(scene, film, filename);
+    else
+        film->write_async(filename);
+}
+
+/**
+ * Render the frames of an animation (-k) of a scene that is loaded once,
+ * and write the image of frame 'i' to "<filename>_<i>"
+ */
+template <typename Float, typename Spectrum>
+void render_animation(Object *scene, const fs::path &keyframes,
+                      const std::string &frames, size_t sensor_i, bool batch,
+                      fs::path filename, float checkpoint_interval) {
+    ref<Animation<Float, Spectrum>> animation =
+        new Animation<Float, Spectrum>(scene, keyframes);
+
+    auto [first, last] = animation->frame_range();
+    if (!frames.empty()) {
+        std::vector<std::string> range = string::tokenize(frames, ":");
+        if (range.empty() || range.size() > 2)
+            Throw("-f/--frames: expected a frame range \"<first>:<last>\"!");
+        try {
+            first = std::stoi(range[0]);
+            last  = std::stoi(range.back());
+        } catch (const std::exception &) {
+            Throw("-f/--frames: could not parse the frame range \"%s\"!", frames);
+        }
+        if (first > last)
+            Throw("-f/--frames: the first frame must not be after the last one!");
+    }
+
+    fs::path base = filename, extension = filename.extension();
+    base.replace_extension("");
+
+    for (int frame = first; frame <= last; ++frame) {
+        Log(Info, "Rendering frame %i (%i/%i) ..", frame, frame - first + 1,
+            last - first + 1);
+        animation->set_frame((dr::scalar_t<Float>) frame);
+
+        fs::path path(tfm::format("%s_%04i", base.string(), frame));
+        if (!extension.empty())
+            path.replace_extension(extension);
+
+        /* The film of the frame is developed before the next one is
+           rendered, while encoding and writing it overlaps with that render */
+        render<Float, Spectrum>(scene, sensor_i, batch, false /* warmup */,
+                                path, checkpoint_interval, fs::path(),
+                                RenderJob(), std::vector<std::string>());
+    }
 }
 
 #if !defined(_WIN32)
@@ -149,6 +546,193 @@ void hup_signal_handler(int signal) {
 }
 #endif
 
+/**
+ * Resolve a file name of a job server request relative to the job directory
+ * 'root' (an absolute path without symbolic links), and reject files that lie
+ * outside of it. The file itself does not need to exist.
+ */
+fs::path job_path(const fs::path &root, const fs::path &filename) {
+    fs::path path = filename.is_absolute() ? filename : root / filename;
+
+    if (fs::exists(path)) {
+        path = fs::absolute(path);
+    } else {
+        fs::path dir = path.parent_path(), name = path.filename();
+        if (name.empty() || name.string() == "." || name.string() == "..")
+            Throw("Invalid file name \"%s\"!", filename.string());
+        if (!fs::is_directory(dir))
+            Throw("Directory of \"%s\" does not exist!", filename.string());
+        path = fs::absolute(dir) / name;
+    }
+
+    fs::path::string_type root_str = root.native(), path_str = path.native();
+    if (root_str.empty() || root_str.back() != fs::preferred_separator)
+        root_str += fs::preferred_separator;
+    if (path_str.compare(0, root_str.size(), root_str) != 0)
+        Throw("\"%s\" is outside of the job directory \"%s\"!",
+              filename.string(), root.string());
+
+    return path;
+}
+
+/// Scene loaded by the job server mode
+struct CachedScene {
+    ref<Object> scene;
+    int64_t mtime;
+    size_t size;
+    uint64_t last_use;
+};
+
+/**
+ * Serve render requests of the job server mode (--job-server), which
+ * keeps up to 'cache_size' loaded scenes in memory between renders
+ */
+void run_job_server(uint16_t port, const std::string &address,
+                    const fs::path &root, size_t cache_size,
+                    const std::string &mode,
+                    const xml::ParameterList &base_params, bool update) {
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver();
+
+    // Loaded scenes, keyed by the file name and the parameters
+    std::map<std::string, CachedScene> scenes;
+    uint64_t timestamp = 0;
+
+    ref<ServerSocket> server = new ServerSocket(port, address);
+    Log(Info, "Waiting for render requests on %s, port %u (job directory: "
+        "\"%s\") ..", server->address(), server->port(), root.string());
+
+    while (true) {
+        ref<SocketStream> stream = server->accept();
+        Log(Info, "Accepted a connection from %s.", stream->peer());
+
+        while (true) {
+            std::string line;
+            try {
+                line = stream->read_line();
+            } catch (const std::exception &) {
+                break; // The connection was closed by the client
+            }
+
+            line = string::trim(line);
+            if (line.empty())
+                continue;
+
+            if (line == "clear") {
+                scenes.clear();
+                stream->write_line("OK");
+                continue;
+            }
+
+            std::string reply = "OK";
+            try {
+                // Parse the request like the arguments of a render
+                std::vector<std::string> tokens = string::tokenize(line, " \t");
+                std::vector<const char *> args = { "mitsuba" };
+                for (const std::string &token : tokens)
+                    args.push_back(token.c_str());
+
+                ArgParser parser;
+                using StringVec   = std::vector<std::string>;
+                auto arg_define   = parser.add(StringVec{ "-D", "--define" }, true);
+                auto arg_sensor_i = parser.add(StringVec{ "-s", "--sensor" }, true);
+                auto arg_batch    = parser.add(StringVec{ "-b", "--batch" }, false);
+                auto arg_output   = parser.add(StringVec{ "-o", "--output" }, true);
+                auto arg_extra    = parser.add("", true);
+                parser.parse((int) args.size(), args.data());
+
+                if (!*arg_extra || arg_extra->next())
+                    Throw("Expected exactly one scene file per request!");
+
+                xml::ParameterList params = base_params;
+                while (arg_define && *arg_define) {
+                    std::string value = arg_define->as_string();
+                    auto sep = value.find('=');
+                    if (sep == std::string::npos)
+                        Throw("-D/--define: expect key=value pair!");
+                    params.emplace_back(value.substr(0, sep), value.substr(sep + 1), false);
+                    arg_define = arg_define->next();
+                }
+
+                fs::path filename = job_path(root, arg_extra->as_string());
+                if (!fs::is_regular_file(filename))
+                    Throw("Scene file \"%s\" does not exist!", filename.string());
+                int64_t mtime = fs::last_write_time(filename);
+                size_t size = fs::file_size(filename);
+
+                fs::path output = filename;
+                if (*arg_output)
+                    output = job_path(root, arg_output->as_string());
+
+                std::string key = filename.string();
+                for (const auto &[name, value, used] : params)
+                    key += "\n" + name + "=" + value;
+
+                ref<FileResolver> fr2 = new FileResolver(*fr);
+                fs::path scene_dir = filename.parent_path();
+                if (!fr2->contains(scene_dir))
+                    fr2->append(scene_dir);
+                thread->set_file_resolver(fr2);
+
+                auto it = scenes.find(key);
+                if (it != scenes.end() &&
+                    (it->second.mtime != mtime || it->second.size != size)) {
+                    Log(Info, "Scene \"%s\" was modified, loading it again.",
+                        filename.string());
+                    scenes.erase(it);
+                    it = scenes.end();
+                }
+
+                if (it == scenes.end()) {
+                    // Discard the least recently rendered scenes before loading
+                    while (!scenes.empty() && scenes.size() >= cache_size) {
+                        auto oldest = std::min_element(
+                            scenes.begin(), scenes.end(),
+                            [](const auto &a, const auto &b) {
+                                return a.second.last_use < b.second.last_use;
+                            });
+                        scenes.erase(oldest);
+                    }
+
+                    std::vector<ref<Object>> parsed =
+                        xml::load_file(filename, mode, params, update, true);
+                    if (parsed.size() != 1)
+                        Throw("Root element of the input file is expanded into "
+                              "multiple objects, only a single object is expected!");
+                    it = scenes.emplace(key, CachedScene{ parsed[0], mtime, size, 0 }).first;
+                } else {
+                    Log(Info, "Reusing the loaded scene \"%s\".", filename.string());
+                }
+                it->second.last_use = ++timestamp;
+
+                size_t sensor_i = (*arg_sensor_i ? arg_sensor_i->as_int() : 0);
+                MI_INVOKE_VARIANT(mode, render, it->second.scene.get(), sensor_i,
+                                  (bool) *arg_batch, false /* warmup */, output,
+                                  0.f /* checkpoint_interval */, fs::path(),
+                                  RenderJob(), std::vector<std::string>());
+
+                // Only reply once the image is written
+                BitmapWriter::instance()->flush();
+                Profiler::print_report();
+            } catch (const std::exception &e) {
+                std::string message = e.what();
+                std::replace(message.begin(), message.end(), '\n', ' ');
+                Log(Warn, "Render request \"%s\" failed: %s", line, message);
+                reply = "ERROR " + message;
+            }
+            thread->set_file_resolver(fr);
+
+            try {
+                stream->write_line(reply);
+            } catch (const std::exception &) {
+                break;
+            }
+        }
+
+        Log(Info, "Closed the connection to %s.", stream->peer());
+    }
+}
+
 int main(int argc, char *argv[]) {
     Jit::static_initialization();
     Class::static_initialization();
@@ -165,7 +749,22 @@ int main(int argc, char *argv[]) {
     auto arg_verbose   = parser.add(StringVec{ "-v", "--verbose" }, false);
     auto arg_define    = parser.add(StringVec{ "-D", "--define" }, true);
     auto arg_sensor_i  = parser.add(StringVec{ "-s", "--sensor" }, true);
+    auto arg_batch     = parser.add(StringVec{ "-b", "--batch" }, false);
+    auto arg_stats     = parser.add(StringVec{ "--stats" }, false);
+    auto arg_trace     = parser.add(StringVec{ "--trace" }, true);
     auto arg_output    = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_keyframes = parser.add(StringVec{ "-k", "--keyframes" }, true);
+    auto arg_frames    = parser.add(StringVec{ "-f", "--frames" }, true);
+    auto arg_checkpt   = parser.add(StringVec{ "-c", "--checkpoint-interval" }, true);
+    auto arg_resume    = parser.add(StringVec{ "-r", "--resume" }, true);
+    auto arg_workers   = parser.add(StringVec{ "-w", "--workers" }, true);
+    auto arg_listen    = parser.add(StringVec{ "-l", "--listen" }, true);
+    auto arg_server    = parser.add(StringVec{ "--job-server" }, true);
+    auto arg_job_dir   = parser.add(StringVec{ "--job-dir" }, true);
+    auto arg_job_cache = parser.add(StringVec{ "--job-cache" }, true);
+    auto arg_bind      = parser.add(StringVec{ "--bind" }, true);
+    auto arg_autotune  = parser.add(StringVec{ "--autotune" });
+    auto arg_atcache   = parser.add(StringVec{ "--autotune-cache" }, true);
     auto arg_update    = parser.add(StringVec{ "-u", "--update" }, false);
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
@@ -177,6 +776,9 @@ int main(int argc, char *argv[]) {
     auto arg_wavefront = parser.add(StringVec{ "-W" });
     auto arg_source    = parser.add(StringVec{ "-S" });
     auto arg_vec_width = parser.add(StringVec{ "-V" }, true);
+    auto arg_kcache    = parser.add(StringVec{ "--kernel-cache" }, true);
+    auto arg_kstats    = parser.add(StringVec{ "--kernel-stats" });
+    auto arg_warmup    = parser.add(StringVec{ "--warmup" });
 
     xml::ParameterList params;
     std::string error_msg, mode;
@@ -252,14 +854,16 @@ int main(int argc, char *argv[]) {
         bool cuda = string::starts_with(mode, "cuda_");
         bool llvm = string::starts_with(mode, "llvm_");
 
+        fs::path kernel_cache = (*arg_kcache ? arg_kcache->as_string() : "");
+
 #if defined(MI_ENABLE_CUDA)
         if (cuda)
-            jit_init((uint32_t) JitBackend::CUDA);
+            Jit::init_backend((uint32_t) JitBackend::CUDA, kernel_cache);
 #endif
 
 #if defined(MI_ENABLE_LLVM)
         if (llvm)
-            jit_init((uint32_t) JitBackend::LLVM);
+            Jit::init_backend((uint32_t) JitBackend::LLVM, kernel_cache);
 #endif
 
 #if defined(MI_ENABLE_LLVM) || defined(MI_ENABLE_CUDA)
@@ -282,6 +886,9 @@ int main(int argc, char *argv[]) {
             if (*arg_source)
                 jit_set_flag(JitFlag::PrintIR, true);
 
+            if (*arg_kstats)
+                jit_set_flag(JitFlag::KernelHistory, true);
+
             if (*arg_vec_width && llvm) {
                 uint32_t width = arg_vec_width->as_int();
                 if (!math::is_power_of_two(width))
@@ -302,15 +909,37 @@ int main(int argc, char *argv[]) {
 #endif
 
         if (!cuda && !llvm &&
-            (*arg_optim_lev || *arg_wavefront || *arg_source || *arg_vec_width))
+            (*arg_optim_lev || *arg_wavefront || *arg_source || *arg_vec_width ||
+             *arg_kcache || *arg_kstats || *arg_warmup))
             Throw("Specified an argument that only makes sense in a JIT (LLVM/CUDA) mode!");
 
         Profiler::static_initialization();
         color_management_static_initialization(cuda, llvm);
 
+        fs::path trace_file = (*arg_trace ? arg_trace->as_string() : "");
+        if (!trace_file.empty())
+            Trace::start(10.f);
+
         MI_INVOKE_VARIANT(mode, scene_static_accel_initialization);
 
         size_t sensor_i  = (*arg_sensor_i ? arg_sensor_i->as_int() : 0);
+        float checkpoint_interval =
+            (*arg_checkpt ? (float) arg_checkpt->as_float() : 0.f);
+        if (checkpoint_interval < 0.f)
+            Throw("-c/--checkpoint-interval: expected a positive number of seconds!");
+        fs::path state_file = (*arg_resume ? arg_resume->as_string() : "");
+        std::vector<std::string> workers;
+        if (*arg_workers)
+            workers = string::tokenize(arg_workers->as_string(), ";");
+
+        if (*arg_frames && !*arg_keyframes)
+            Throw("-f/--frames: the frames of an animation require keyframes (-k)!");
+        if (*arg_keyframes && (!workers.empty() || !state_file.empty() || *arg_warmup))
+            Throw("Animations (-k) cannot be combined with render workers (-w), "
+                  "resumable renders (-r) or kernel warm-up (--warmup)!");
+        if (*arg_autotune && (!workers.empty() || *arg_warmup))
+            Throw("Autotuning (--autotune) cannot be combined with render "
+                  "workers (-w) or kernel warm-up (--warmup)!");
 
         // Append the mitsuba directory to the FileResolver search path list
         ref<Thread> thread = Thread::thread();
@@ -328,6 +957,47 @@ int main(int argc, char *argv[]) {
             }
         }
 
+        if ((*arg_job_dir || *arg_job_cache) && !*arg_server)
+            Throw("--job-dir and --job-cache require a job server (--job-server)!");
+        if (*arg_bind && !*arg_server && !*arg_listen)
+            Throw("--bind requires a render worker (-l) or a job server (--job-server)!");
+        std::string bind_address = (*arg_bind ? arg_bind->as_string() : "127.0.0.1");
+
+        if (*arg_listen && !*arg_help) {
+            Log(Info, "%s", util::info_build((int) Thread::thread_count()));
+            ref<ServerSocket> server =
+                new ServerSocket((uint16_t) arg_listen->as_int(), bind_address);
+            Log(Info, "Waiting for render jobs on %s, port %u ..",
+                server->address(), server->port());
+
+            while (true) {
+                ref<SocketStream> stream = server->accept();
+                Log(Info, "Accepted a connection from %s.", stream->peer());
+                try {
+                    RenderJob job = RenderJob::read(stream);
+                    MI_INVOKE_VARIANT(job.variant, serve, stream.get(), job);
+                    Log(Info, "Finished the job of %s.", stream->peer());
+                } catch (const std::exception &e) {
+                    Log(Warn, "Render job of %s failed: %s", stream->peer(), e.what());
+                }
+                thread->set_file_resolver(fr);
+            }
+        }
+
+        if (*arg_server && !*arg_help) {
+            Log(Info, "%s", util::info_build((int) Thread::thread_count()));
+            fs::path job_dir = (*arg_job_dir ? fs::path(arg_job_dir->as_string())
+                                             : fs::current_path());
+            if (!fs::is_directory(job_dir))
+                Throw("--job-dir: \"%s\" is not a directory!", job_dir.string());
+            int job_cache = (*arg_job_cache ? arg_job_cache->as_int() : 4);
+            if (job_cache < 1)
+                Throw("--job-cache: expected a positive number of scenes!");
+            run_job_server((uint16_t) arg_server->as_int(), bind_address,
+                           fs::absolute(job_dir), (size_t) job_cache, mode,
+                           params, *arg_update);
+        }
+
         if (!*arg_extra || *arg_help) {
             help((int) Thread::thread_count());
         } else {
@@ -362,9 +1032,60 @@ int main(int argc, char *argv[]) {
                 Throw("Root element of the input file is expanded into "
                       "multiple objects, only a single object is expected!");
 
-            MI_INVOKE_VARIANT(mode, render, parsed[0].get(), sensor_i, filename);
+            RenderJob job;
+            if (!workers.empty())
+                job = RenderJob::from_file(arg_extra->as_string(), mode, params,
+                                           (uint32_t) sensor_i);
+
+            if (*arg_autotune) {
+                std::string defines;
+                for (const auto &[key, value, used] : params)
+                    defines += key + "=" + value + ";";
+                // The key covers the scene description, not the files it references
+                std::string source = RenderJob::from_file(
+                    arg_extra->as_string(), mode, params, (uint32_t) sensor_i).scene;
+                fs::path cache_file =
+                    *arg_atcache ? arg_atcache->as_string() : fs::path();
+                MI_INVOKE_VARIANT(mode, autotune, parsed[0].get(), sensor_i,
+                                  source, mode, defines, cache_file,
+                                  !*arg_threads, !*arg_vec_width);
+            }
+
+            if (*arg_stats) {
+                Statistics::set_enabled(true);
+                Statistics::reset();
+            }
+
+            if (*arg_keyframes)
+                MI_INVOKE_VARIANT(mode, render_animation, parsed[0].get(),
+                                  fs::path(arg_keyframes->as_string()),
+                                  std::string(*arg_frames ? arg_frames->as_string() : ""),
+                                  sensor_i, (bool) *arg_batch, filename,
+                                  checkpoint_interval);
+            else
+                MI_INVOKE_VARIANT(mode, render, parsed[0].get(), sensor_i,
+                                  (bool) *arg_batch, (bool) *arg_warmup, filename,
+                                  checkpoint_interval, state_file, job, workers);
+
+            // Covers the kernels of both scene loading and rendering
+            if (*arg_kstats)
+                Log(Info, "Kernel statistics: %s", Jit::kernel_stats().to_string());
+
+            if (*arg_stats)
+                Log(Info, "%s", Statistics::to_string());
+
+            // Summary of the built-in sampling profiler (if enabled)
+            Profiler::print_report();
             arg_extra = arg_extra->next();
         }
+
+        if (!trace_file.empty()) {
+            Trace::stop();
+            Trace::write(trace_file);
+        }
+
+        // Report errors that occurred while writing images
+        BitmapWriter::instance()->flush();
     } catch (const std::exception &e) {
         error_msg = std::string("Caught a critical exception: ") + e.what();
     } catch (...) {
@@ -401,6 +1122,9 @@ int main(int argc, char *argv[]) {
     MI_INVOKE_VARIANT(mode, scene_static_accel_shutdown);
     color_management_static_shutdown();
     Profiler::static_shutdown();
+    Trace::static_shutdown();
+    Statistics::static_shutdown();
+    BitmapWriter::static_shutdown();
     Bitmap::static_shutdown();
     Logger::static_shutdown();
     Thread::static_shutdown();
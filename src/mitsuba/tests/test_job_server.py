@@ -0,0 +1,132 @@
+import os
+import re
+import shutil
+import socket
+import subprocess
+import time
+
+import pytest
+import mitsuba as mi
+
+
+SCENE_XML = """<scene version="3.0.0">
+    <integrator type="path"/>
+    <sensor type="perspective">
+        <film type="hdrfilm">
+            <integer name="width" value="%i"/>
+            <integer name="height" value="4"/>
+        </film>
+        <sampler type="independent">
+            <integer name="sample_count" value="2"/>
+        </sampler>
+    </sensor>
+    <emitter type="constant"/>
+</scene>
+"""
+
+
+def find_executable():
+    # The executable is placed next to the 'python' directory of the build
+    build_dir = os.path.dirname(os.path.dirname(os.path.dirname(mi.__file__)))
+    for candidate in [os.path.join(build_dir, 'mitsuba'), shutil.which('mitsuba')]:
+        if candidate and os.path.isfile(candidate):
+            return candidate
+    pytest.skip('The mitsuba executable could not be found!')
+
+
+@pytest.fixture
+def job_server(variant_scalar_rgb, tmp_path):
+    job_dir = tmp_path / 'jobs'
+    job_dir.mkdir()
+    log_file = tmp_path / 'log.txt'
+
+    with open(log_file, 'w') as log:
+        process = subprocess.Popen(
+            [find_executable(), '-m', 'scalar_rgb', '--job-server', '0',
+             '--job-dir', str(job_dir), '--job-cache', '1'],
+            stdout=log, stderr=subprocess.STDOUT)
+
+    try:
+        # Wait for the server to report the port it listens on
+        port = None
+        for _ in range(600):
+            match = re.search(r'port (\d+)', log_file.read_text())
+            if match:
+                port = int(match.group(1))
+                break
+            assert process.poll() is None, log_file.read_text()
+            time.sleep(0.05)
+        assert port is not None
+
+        connection = socket.create_connection(('127.0.0.1', port))
+        stream = connection.makefile('rw')
+
+        def request(line):
+            stream.write(line + '\n')
+            stream.flush()
+            return stream.readline().strip()
+
+        yield job_dir, log_file, request
+        connection.close()
+    finally:
+        process.kill()
+        process.wait()
+
+
+def test01_render(job_server):
+    job_dir, log_file, request = job_server
+    (job_dir / 'scene.xml').write_text(SCENE_XML % 4)
+
+    assert request('scene.xml -o out.exr') == 'OK'
+    assert mi.Bitmap(str(job_dir / 'out.exr')).width() == 4
+
+    # The second request reuses the loaded scene
+    assert request('%s -o out2.exr' % (job_dir / 'scene.xml')) == 'OK'
+    assert (job_dir / 'out2.exr').exists()
+    assert log_file.read_text().count('Reusing the loaded scene') == 1
+
+    assert request('clear') == 'OK'
+    assert request('missing.xml').startswith('ERROR')
+    assert request('-s').startswith('ERROR')
+
+
+def test02_job_directory(job_server, tmp_path):
+    job_dir, log_file, request = job_server
+    (job_dir / 'scene.xml').write_text(SCENE_XML % 4)
+    (tmp_path / 'other.xml').write_text(SCENE_XML % 4)
+
+    # Scene and output files must be located in the job directory
+    assert request('../other.xml -o out.exr').startswith('ERROR')
+    assert request('%s -o out.exr' % (tmp_path / 'other.xml')).startswith('ERROR')
+    assert request('scene.xml -o ../out.exr').startswith('ERROR')
+    assert request('scene.xml -o %s' % (tmp_path / 'out.exr')).startswith('ERROR')
+    assert not (tmp_path / 'out.exr').exists()
+    assert not (job_dir / 'out.exr').exists()
+
+    # .. also when a symbolic link points outside of it
+    if hasattr(os, 'symlink'):
+        os.symlink(str(tmp_path), str(job_dir / 'link'))
+        assert request('link/other.xml').startswith('ERROR')
+        assert request('scene.xml -o link/out.exr').startswith('ERROR')
+        assert not (tmp_path / 'out.exr').exists()
+
+
+def test03_cache_invalidation(job_server):
+    job_dir, log_file, request = job_server
+    scene = job_dir / 'scene.xml'
+    scene.write_text(SCENE_XML % 4)
+    os.utime(str(scene), (1000000000, 1000000000))
+    assert request('scene.xml -o out.exr') == 'OK'
+
+    # A modified scene file is loaded again
+    scene.write_text(SCENE_XML % 8)
+    os.utime(str(scene), (1000000100, 1000000100))
+    assert request('scene.xml -o out.exr') == 'OK'
+    assert mi.Bitmap(str(job_dir / 'out.exr')).width() == 8
+    assert 'was modified' in log_file.read_text()
+
+    # The cache only holds a single scene (--job-cache 1)
+    (job_dir / 'scene2.xml').write_text(SCENE_XML % 4)
+    assert request('scene2.xml -o out2.exr') == 'OK'
+    assert request('scene.xml -o out.exr') == 'OK'
+    assert log_file.read_text().count('Reusing the loaded scene') == 0
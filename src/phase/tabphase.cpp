@@ -20,6 +20,17 @@ Lookup table phase function (:monosp:`tabphase`)
      cosine of the scattering angle.
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - sampling
+   - |string|
+   - Sampling technique, either ``cdf`` (default), which inverts the CDF of
+     the tabulated values, or ``table``, which interpolates a precomputed
+     inverse CDF (see below).
+
+ * - table_size
+   - |int|
+   - Number of entries of the inverse CDF table used by the ``table``
+     sampling technique. (Default: 1024)
+
 This plugin implements a generic phase function model for isotropic media
 parametrized by a lookup table giving values of the phase function as a
 function of the cosine of the scattering angle.
@@ -33,6 +44,18 @@ function of the cosine of the scattering angle.
      scattering.
    * Lookup table points are regularly spaced between -1 and 1.
    * Phase function values are automatically normalized.
+
+The default sampling technique locates the sample in the CDF of the tabulated
+values with a search that is bounded by a guide table, and exactly matches the
+tabulated phase function. Measured phase functions, e.g. of aerosols, often
+have very sharp forward peaks. For these, the ``table`` technique precomputes
+the inverse CDF at :monosp:`table_size` uniformly spaced points of the sample
+space, and samples in constant time by interpolating it linearly. The phase
+function is then represented by its resampled version with equal probability
+per table interval: its nodes are concentrated where the phase function is
+large, while the resolution of low values (e.g. backward scattering) decreases.
+Evaluation and sampling remain consistent with each other, but gradients with
+respect to the :monosp:`values` parameter are not propagated in this mode.
 */
 
 template <typename Float, typename Spectrum>
@@ -41,6 +64,8 @@ public:
     MI_IMPORT_BASE(PhaseFunction, m_flags, m_components)
     MI_IMPORT_TYPES(PhaseFunctionContext)
 
+    using FloatStorage = DynamicBuffer<Float>;
+
     TabulatedPhaseFunction(const Properties &props) : Base(props) {
         if (props.type("values") == Properties::Type::String) {
             std::vector<std::string> values_str =
@@ -62,6 +87,21 @@ public:
             Throw("'values' must be a string");
         }
 
+        std::string sampling = props.string("sampling", "cdf");
+        if (sampling == "table")
+            m_table_sampling = true;
+        else if (sampling != "cdf")
+            Throw("Invalid sampling technique \"%s\", must be one of: \"cdf\" "
+                  "or \"table\"!", sampling);
+
+        int table_size = props.get<int>("table_size", 1024);
+        if (table_size < 2)
+            Throw("The \"table_size\" parameter must be at least 2!");
+        m_table_size = (uint32_t) table_size;
+
+        if (m_table_sampling)
+            update_table();
+
         m_flags = +PhaseFunctionFlags::Anisotropic;
         dr::set_attr(this, "flags", m_flags);
         m_components.push_back(m_flags);
@@ -73,6 +113,8 @@ public:
 
     void parameters_changed(const std::vector<std::string> & /*keys*/) override {
         m_distr.update();
+        if (m_table_sampling)
+            update_table();
     }
 
     std::pair<Vector3f, Float> sample(const PhaseFunctionContext & /* ctx */,
@@ -84,7 +126,11 @@ public:
 
         // Sample a direction in physics convention.
         // We sample cos θ' = cos(π - θ) = -cos θ.
-        Float cos_theta_prime = m_distr.sample(sample2.x());
+        Float cos_theta_prime, table_pdf = 0.f;
+        if (m_table_sampling)
+            std::tie(cos_theta_prime, table_pdf) = sample_table(sample2.x(), active);
+        else
+            cos_theta_prime = m_distr.sample(sample2.x(), active);
         Float sin_theta_prime =
             dr::safe_sqrt(1.f - cos_theta_prime * cos_theta_prime);
         auto [sin_phi, cos_phi] =
@@ -97,10 +143,11 @@ public:
         wo = -mi.to_world(wo);
 
         // Retrieve the PDF value from the physics convention-sampled angle
-        Float pdf = m_distr.eval_pdf_normalized(cos_theta_prime, active) *
-                    dr::InvTwoPi<ScalarFloat>;
+        Float pdf = m_table_sampling
+                        ? table_pdf
+                        : m_distr.eval_pdf_normalized(cos_theta_prime, active);
 
-        return { wo, pdf };
+        return { wo, pdf * dr::InvTwoPi<ScalarFloat> };
     }
 
     Float eval(const PhaseFunctionContext & /* ctx */,
@@ -113,21 +160,78 @@ public:
         // This parameterization differs from the convention used internally by
         // Mitsuba and is the reason for the minus sign below.
         Float cos_theta = -dot(wo, mi.wi);
-        return m_distr.eval_pdf_normalized(cos_theta, active) *
-               dr::InvTwoPi<ScalarFloat>;
+        Float pdf = m_table_sampling
+                        ? eval_table(cos_theta, active)
+                        : m_distr.eval_pdf_normalized(cos_theta, active);
+        return pdf * dr::InvTwoPi<ScalarFloat>;
     }
 
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "TabulatedPhaseFunction[" << std::endl
-            << "  distr = " << string::indent(m_distr) << std::endl
+            << "  distr = " << string::indent(m_distr) << "," << std::endl
+            << "  sampling = " << (m_table_sampling ? "table" : "cdf") << "," << std::endl
+            << "  table_size = " << m_table_size << std::endl
             << "]";
         return oss.str();
     }
 
     MI_DECLARE_CLASS()
 private:
+    /// Tabulate the inverse CDF at uniformly spaced points of the sample space
+    void update_table() {
+        FloatStorage pdf = dr::migrate(dr::detach(m_distr.pdf()), AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        ContinuousDistribution<ScalarFloat> distr(ScalarVector2f(-1.f, 1.f),
+                                                  pdf.data(), pdf.size());
+
+        std::vector<ScalarFloat> table(m_table_size);
+        for (uint32_t i = 0; i < m_table_size; ++i)
+            table[i] = distr.sample((ScalarFloat) i / (m_table_size - 1));
+        m_table = dr::load<FloatStorage>(table.data(), table.size());
+        m_table_range = ScalarVector2f(table.front(), table.back());
+    }
+
+    /// Density of the resampled phase function within table interval \c index
+    Float table_pdf(const UInt32 &index, Mask active) const {
+        Float c0 = dr::gather<Float>(m_table, index, active),
+              c1 = dr::gather<Float>(m_table, index + 1u, active);
+        return dr::rcp((m_table_size - 1) *
+                       dr::maximum(c1 - c0, dr::Epsilon<ScalarFloat>));
+    }
+
+    /// Sample cos θ' in constant time by interpolating the inverse CDF table
+    std::pair<Float, Float> sample_table(Float sample, Mask active) const {
+        Float x = sample * (ScalarFloat) (m_table_size - 1);
+        UInt32 index = dr::minimum(UInt32(x), m_table_size - 2);
+        Float t = x - Float(index);
+
+        Float c0 = dr::gather<Float>(m_table, index, active),
+              c1 = dr::gather<Float>(m_table, index + 1u, active);
+        return { dr::fmadd(t, c1 - c0, c0), table_pdf(index, active) };
+    }
+
+    /// Evaluate the density of the resampled phase function at cos θ'
+    Float eval_table(Float cos_theta, Mask active) const {
+        active &= cos_theta >= m_table_range.x() && cos_theta <= m_table_range.y();
+
+        UInt32 index = dr::binary_search<UInt32>(
+            0, m_table_size - 2,
+            [&](UInt32 i) DRJIT_INLINE_LAMBDA {
+                return dr::gather<Float>(m_table, i + 1u, active) < cos_theta;
+            }
+        );
+
+        return dr::select(active, table_pdf(index, active), 0.f);
+    }
+
     ContinuousDistribution<Float> m_distr;
+    bool m_table_sampling = false;
+    uint32_t m_table_size;
+    /// Inverse CDF of cos θ' at uniformly spaced points of the sample space
+    FloatStorage m_table;
+    ScalarVector2f m_table_range;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(TabulatedPhaseFunction, PhaseFunction)
@@ -61,3 +61,70 @@ def test03_chi2_skewed(variants_vec_backends_once_rgb, tmpdir):
     )
 
     assert chi2.run()
+
+
+@pytest.mark.slow
+def test04_chi2_precomputed(variants_vec_backends_once_rgb, tmpdir):
+    tmp_file = os.path.join(str(tmpdir), "sggx.vol")
+    grid = mi.TensorXf([1.0, 0.35, 0.32, 0.52, 0.44, 0.2], [1, 1, 1, 6])
+    mi.VolumeGrid(grid).write(tmp_file)
+
+    sample_func, pdf_func = mi.chi2.PhaseFunctionAdapter("sggx",
+         f"""<boolean name="precompute" value="true"/>
+             <volume type="gridvolume" name="S">
+                 <string name="filename" value="{tmp_file}"/>
+             </volume>
+         """)
+
+    chi2 = mi.chi2.ChiSquareTest(
+        domain=mi.chi2.SphericalDomain(),
+        sample_func=sample_func,
+        pdf_func=pdf_func,
+        sample_dim=3
+    )
+
+    assert chi2.run()
+
+
+def test05_precomputed_matches(variants_vec_rgb):
+    import numpy as np
+
+    # Random positive definite matrices S = A A^T + 0.1 I per voxel
+    rng = np.random.default_rng(0)
+    a = rng.normal(size=(3, 4, 5, 3, 3))
+    s = np.einsum('...ij,...kj->...ik', a, a) + 0.1 * np.eye(3)
+    data = np.stack([s[..., 0, 0], s[..., 1, 1], s[..., 2, 2],
+                     s[..., 0, 1], s[..., 0, 2], s[..., 1, 2]], axis=-1)
+
+    def load(precompute):
+        return mi.load_dict({
+            'type': 'sggx',
+            'precompute': precompute,
+            'S': {
+                'type': 'gridvolume',
+                'grid': mi.VolumeGrid(mi.TensorXf(data.astype(np.float32))),
+                'filter_type': 'nearest'
+            }
+        })
+
+    reference, precomputed = load(False), load(True)
+
+    n = 1000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    mi_ = dr.zeros(mi.MediumInteraction3f, n)
+    mi_.p = mi.Point3f(sampler.next_1d(), sampler.next_1d(), sampler.next_1d())
+    mi_.wi = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+    mi_.sh_frame = mi.Frame3f(mi_.wi)
+    wo = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+
+    ctx = mi.PhaseFunctionContext(sampler)
+    assert dr.allclose(precomputed.projected_area(mi_),
+                       reference.projected_area(mi_), rtol=1e-2)
+    assert dr.allclose(precomputed.eval(ctx, mi_, wo),
+                       reference.eval(ctx, mi_, wo), rtol=1e-2, atol=1e-4)
+
+    # Sampled directions are consistent with the evaluated density
+    sample = sampler.next_2d()
+    wo_s, pdf = precomputed.sample(ctx, mi_, sampler.next_1d(), sample)
+    assert dr.allclose(pdf, precomputed.eval(ctx, mi_, wo_s), rtol=1e-3)
@@ -133,3 +133,47 @@ def test_traverse(variant_scalar_rgb):
     mei.wi = np.array([0, 0, -1])
     wo = [0, 0, 1]
     assert dr.allclose(phase.eval(ctx, mei, wo), dr.inv_two_pi * 1.5 / ref_integral)
+
+
+def test_chi2_table(variants_vec_backends_once_rgb):
+    # Sharp forward peak, sampled through the inverse CDF table
+    sample_func, pdf_func = mi.chi2.PhaseFunctionAdapter(
+        "tabphase", "<string name='values' value='0.1, 0.1, 0.2, 0.5, 4.0, 30.0'/>"
+                    "<string name='sampling' value='table'/>"
+                    "<integer name='table_size' value='64'/>"
+    )
+
+    chi2 = mi.chi2.ChiSquareTest(
+        domain=mi.chi2.SphericalDomain(),
+        sample_func=sample_func,
+        pdf_func=pdf_func,
+        sample_dim=3,
+    )
+
+    assert chi2.run()
+
+
+def test_table_matches_cdf(variant_scalar_rgb):
+    import numpy as np
+
+    values = "0.1, 0.1, 0.2, 0.5, 4.0, 30.0"
+    ref = mi.load_dict({"type": "tabphase", "values": values})
+    tab = mi.load_dict({"type": "tabphase", "values": values,
+                        "sampling": "table", "table_size": 4096})
+
+    ctx = mi.PhaseFunctionContext(None)
+    mei = mi.MediumInteraction3f()
+    mei.sh_frame = mi.Frame3f([0, 0, 1])
+    mei.wi = [0, 0, -1]
+
+    # Sampling and evaluation are consistent
+    for u in np.linspace(0.01, 0.99, 25):
+        wo, pdf = tab.sample(ctx, mei, 0, (u, 0.3))
+        assert dr.allclose(pdf, tab.eval(ctx, mei, wo), rtol=1e-3)
+
+    # The resampled phase function approximates the tabulated one where it is large
+    wo = [0, 0, 1]
+    assert dr.allclose(tab.eval(ctx, mei, wo), ref.eval(ctx, mei, wo), rtol=2e-2)
+
+    with pytest.raises(RuntimeError, match="sampling technique"):
+        mi.load_dict({"type": "tabphase", "values": values, "sampling": "foo"})
@@ -1,9 +1,12 @@
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/bitmapwriter.h>
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/stats.h>
+#include <mitsuba/core/trace.h>
 #include <mitsuba/python/python.h>
 
 // core
@@ -15,18 +18,25 @@ MI_PY_DECLARE(Struct);
 MI_PY_DECLARE(Appender);
 MI_PY_DECLARE(ArgParser);
 MI_PY_DECLARE(Bitmap);
+MI_PY_DECLARE(BitmapWriter);
 MI_PY_DECLARE(Formatter);
 MI_PY_DECLARE(FileResolver);
 MI_PY_DECLARE(Logger);
+MI_PY_DECLARE(MemoryTracker);
 MI_PY_DECLARE(MemoryMappedFile);
+MI_PY_DECLARE(TensorFile);
 MI_PY_DECLARE(Stream);
 MI_PY_DECLARE(DummyStream);
 MI_PY_DECLARE(FileStream);
 MI_PY_DECLARE(MemoryStream);
 MI_PY_DECLARE(ZStream);
+MI_PY_DECLARE(BlockZStream);
 MI_PY_DECLARE(ProgressReporter);
 MI_PY_DECLARE(rfilter);
+MI_PY_DECLARE(Statistics);
+MI_PY_DECLARE(Trace);
 MI_PY_DECLARE(Thread);
+MI_PY_DECLARE(TileCache);
 MI_PY_DECLARE(Timer);
 MI_PY_DECLARE(util);
 
@@ -105,16 +115,23 @@ PYBIND11_MODULE(mitsuba_ext, m) {
     MI_PY_IMPORT(rfilter);
     MI_PY_IMPORT(Stream);
     MI_PY_IMPORT(Bitmap);
+    MI_PY_IMPORT(BitmapWriter);
     MI_PY_IMPORT(Formatter);
     MI_PY_IMPORT(FileResolver);
     MI_PY_IMPORT(Logger);
+    MI_PY_IMPORT(MemoryTracker);
     MI_PY_IMPORT(MemoryMappedFile);
+    MI_PY_IMPORT(TensorFile);
     MI_PY_IMPORT(DummyStream);
     MI_PY_IMPORT(FileStream);
     MI_PY_IMPORT(MemoryStream);
     MI_PY_IMPORT(ZStream);
+    MI_PY_IMPORT(BlockZStream);
     MI_PY_IMPORT(ProgressReporter);
+    MI_PY_IMPORT(Statistics);
+    MI_PY_IMPORT(Trace);
     MI_PY_IMPORT(Thread);
+    MI_PY_IMPORT(TileCache);
     MI_PY_IMPORT(Timer);
     MI_PY_IMPORT(util);
 
@@ -131,6 +148,7 @@ PYBIND11_MODULE(mitsuba_ext, m) {
     auto atexit = py::module_::import("atexit");
     atexit.attr("register")(py::cpp_function([]() {
         Thread::wait_for_tasks();
+        BitmapWriter::static_shutdown();
     }));
 
     /* Register a cleanup callback function that is invoked when
@@ -138,6 +156,9 @@ PYBIND11_MODULE(mitsuba_ext, m) {
     py::cpp_function cleanup_callback(
         [](py::handle weakref) {
             Profiler::static_shutdown();
+            Trace::static_shutdown();
+            Statistics::static_shutdown();
+            BitmapWriter::static_shutdown();
             Bitmap::static_shutdown();
             Logger::static_shutdown();
             Thread::static_shutdown();
@@ -62,6 +62,7 @@ MI_PY_DECLARE(BoundingSphere);
 MI_PY_DECLARE(Frame);
 MI_PY_DECLARE(Ray);
 MI_PY_DECLARE(DiscreteDistribution);
+MI_PY_DECLARE(AliasDistribution);
 MI_PY_DECLARE(DiscreteDistribution2D);
 MI_PY_DECLARE(ContinuousDistribution);
 MI_PY_DECLARE(IrregularContinuousDistribution);
@@ -82,6 +83,7 @@ MI_PY_DECLARE(xml);
 MI_PY_DECLARE(quad);
 
 // render
+MI_PY_DECLARE(Animation);
 MI_PY_DECLARE(BSDFSample);
 MI_PY_DECLARE(BSDF);
 MI_PY_DECLARE(Emitter);
@@ -97,6 +99,9 @@ MI_PY_DECLARE(PreliminaryIntersection);
 MI_PY_DECLARE(Medium);
 MI_PY_DECLARE(mueller);
 MI_PY_DECLARE(MicrofacetDistribution);
+#if defined(MI_ENABLE_OIDN)
+MI_PY_DECLARE(OIDNDenoiser);
+#endif // defined(MI_ENABLE_OIDN)
 #if defined(MI_ENABLE_CUDA)
 MI_PY_DECLARE(OptixDenoiser);
 #endif // defined(MI_ENABLE_CUDA)
@@ -156,6 +161,7 @@ PYBIND11_MODULE(MODULE_NAME, m) {
     MI_PY_IMPORT(BoundingSphere);
     MI_PY_IMPORT(Frame);
     MI_PY_IMPORT(DiscreteDistribution);
+    MI_PY_IMPORT(AliasDistribution);
     MI_PY_IMPORT(DiscreteDistribution2D);
     MI_PY_IMPORT(ContinuousDistribution);
     MI_PY_IMPORT(IrregularContinuousDistribution);
@@ -192,8 +198,12 @@ PYBIND11_MODULE(MODULE_NAME, m) {
     MI_PY_IMPORT(fresnel);
     MI_PY_IMPORT(ImageBlock);
     MI_PY_IMPORT(Integrator);
+    MI_PY_IMPORT(Animation);
     MI_PY_IMPORT_SUBMODULE(mueller);
     MI_PY_IMPORT(MicrofacetDistribution);
+#if defined(MI_ENABLE_OIDN)
+    MI_PY_IMPORT(OIDNDenoiser);
+#endif // defined(MI_ENABLE_OIDN)
 #if defined(MI_ENABLE_CUDA)
     MI_PY_IMPORT(OptixDenoiser);
 #endif // defined(MI_ENABLE_CUDA)
@@ -3,6 +3,8 @@ from __future__ import annotations as __annotations__ # Delayed parsing of type
 import mitsuba as mi
 import drjit as dr
 import gc
+import os
+import sys
 
 
 class ADIntegrator(mi.CppADIntegrator):
@@ -23,6 +25,18 @@ class ADIntegrator(mi.CppADIntegrator):
          the *russian roulette* path termination criterion. For example, if set to
          1, then path generation many randomly cease after encountering directly
          visible surfaces. (Default: 5)
+     * - samples_per_pass
+       - |int|
+       - Maximum number of samples per pixel that radiative backpropagation
+         integrators process at once in their backward pass. Larger sample
+         counts are split into several passes that accumulate their
+         gradients into the scene parameters. (Default: 0, i.e. chosen
+         automatically according to ``memory_budget``)
+     * - memory_budget
+       - |float|
+       - Amount of memory (in MiB) that a single pass of the backward pass
+         may use when ``samples_per_pass`` is not specified. (Default: 0,
+         i.e. 75% of the currently free device memory)
     """
 
     def __init__(self, props = mi.Properties()):
@@ -39,6 +53,14 @@ class ADIntegrator(mi.CppADIntegrator):
         if self.rr_depth <= 0:
             raise Exception("\"rr_depth\" must be set to a value greater than zero!")
 
+        self.samples_per_pass = props.get('samples_per_pass', 0)
+        if self.samples_per_pass < 0:
+            raise Exception("\"samples_per_pass\" must be a positive value (or 0)!")
+
+        self.memory_budget = props.get('memory_budget', 0.0)
+        if self.memory_budget < 0:
+            raise Exception("\"memory_budget\" must be a positive value (or 0)!")
+
         # Warn about potential bias due to shapes entering/leaving the frame
         self.sample_border_warning = True
 
@@ -123,6 +145,18 @@ class ADIntegrator(mi.CppADIntegrator):
                        sensor: Union[int, mi.Sensor] = 0,
                        seed: int = 0,
                        spp: int = 0) -> mi.TensorXf:
+        return self.render_forward_batch(scene, params, [None], sensor,
+                                         seed, spp)[0]
+
+    def render_forward_batch(self: mi.SamplingIntegrator,
+                             scene: mi.Scene,
+                             params: Any,
+                             tangents: Sequence[Optional[Mapping[str, Any]]],
+                             sensor: Union[int, mi.Sensor] = 0,
+                             seed: int = 0,
+                             spp: int = 0) -> List[mi.TensorXf]:
+        # The computation graph of the rendering step is recorded once and
+        # then traversed for every tangent
 
         if isinstance(sensor, int):
             sensor = scene.sensors()[sensor]
@@ -185,9 +219,7 @@ class ADIntegrator(mi.CppADIntegrator):
                 film.put_block(block)
                 result_img = film.develop()
 
-                dr.forward_to(result_img)
-
-        return dr.grad(result_img)
+                return _forward_tangents(params, tangents, result_img)
 
     def render_backward(self: mi.SamplingIntegrator,
                         scene: mi.Scene,
@@ -328,6 +360,8 @@ class ADIntegrator(mi.CppADIntegrator):
 
         pos += mi.Vector2i(film.crop_offset())
 
+        sampler.set_pixel_position(mi.Point2u(pos))
+
         # Cast to floating point and add random offset
         pos_f = mi.Vector2f(pos) + sampler.next_2d()
 
@@ -462,6 +496,67 @@ class ADIntegrator(mi.CppADIntegrator):
 
         return sampler, spp
 
+    def sample_footprint(self) -> int:
+        """
+        Rough estimate of the device memory (in bytes) needed per Monte Carlo
+        sample by the differential phase of this integrator.
+
+        Wavefront-style loops (i.e. when ``dr.JitFlag.LoopRecord`` is
+        disabled) keep the state of every path vertex in memory, while
+        recorded loops only store the state of the current one. Subclasses
+        with unusually large loop states can override this estimate.
+        """
+        vertices = 1 if dr.flag(dr.JitFlag.LoopRecord) else min(self.max_depth, 16)
+        return 1024 * max(vertices, 1)
+
+    def sample_passes(self, sensor: mi.Sensor, spp: int = 0) -> List[int]:
+        """
+        Split the samples per pixel of a differential rendering into passes
+        whose wavefronts fit into the memory budget.
+
+        The number of samples of each pass is given by the
+        ``samples_per_pass`` parameter when specified. Otherwise, it is
+        derived from ``memory_budget`` (or the currently free device memory)
+        and the estimate returned by ``sample_footprint()``.
+
+        Returns a list containing the number of samples per pixel of each
+        pass, which sums up to the requested sample count.
+        """
+
+        if spp == 0:
+            spp = sensor.sampler().sample_count()
+
+        if self.samples_per_pass > 0:
+            spp_per_pass = self.samples_per_pass
+        else:
+            budget = self.memory_budget * 2**20
+            if budget == 0:
+                free = _free_device_memory()
+                if free is None:
+                    return [spp]
+                budget = 0.75 * free
+
+            film = sensor.film()
+            film_size = film.crop_size()
+            if film.sample_border():
+                film_size += 2 * film.rfilter().border_size()
+
+            pass_size = dr.prod(film_size) * self.sample_footprint()
+            spp_per_pass = int(budget // pass_size)
+
+            if spp_per_pass == 0:
+                mi.Log(mi.LogLevel.Warn,
+                       'The backward pass of a single sample per pixel is '
+                       'expected to exceed the memory budget (%.1f MiB). '
+                       'Consider reducing the film resolution.' % (budget / 2**20))
+                spp_per_pass = 1
+
+        n_passes = (spp + spp_per_pass - 1) // spp_per_pass
+
+        # Distribute the samples evenly among the passes
+        return [spp // n_passes + (1 if i < spp % n_passes else 0)
+                for i in range(n_passes)]
+
     def _splat_to_block(block: mi.ImageBlock,
                        film: mi.Film,
                        pos: mi.Point2f,
@@ -604,7 +699,8 @@ class RBIntegrator(ADIntegrator):
         for an efficient way of obtaining all parameter derivatives at once, or
         simply use the ``mi.render()`` abstraction that hides both
         ``Integrator.render_forward()`` and ``Integrator.render_backward()`` behind
-        a unified interface.
+        a unified interface. ``Integrator.render_forward_batch()`` evaluates
+        the derivatives along several directions at a reduced cost.
 
         Before calling this function, you must first enable gradient tracking and
         furthermore associate concrete input gradients with one or more scene
@@ -646,10 +742,44 @@ class RBIntegrator(ADIntegrator):
             scene specification takes precedence if ``spp=0``.
         """
 
+        return self.render_forward_batch(scene, params, [None], sensor,
+                                         seed, spp)[0]
+
+    def render_forward_batch(self: mi.SamplingIntegrator,
+                             scene: mi.Scene,
+                             params: Any,
+                             tangents: Sequence[Optional[Mapping[str, Any]]],
+                             sensor: Union[int, mi.Sensor] = 0,
+                             seed: int = 0,
+                             spp: int = 0) -> List[mi.TensorXf]:
+        """
+        Evaluates the forward-mode derivative of the rendering step along
+        several tangent directions.
+
+        This function is equivalent to a sequence of calls to
+        ``Integrator.render_forward()`` (one for each entry of ``tangents``)
+        with the same seed, but it only performs the primal pass of the
+        radiative backpropagation once. The subsequent forward-mode passes
+        then replay the same paths. For ``K`` tangents, this amounts to ``K +
+        1`` instead of ``2 K`` path tracing passes.
+
+        Parameter ``tangents`` (``Sequence[dict]``):
+            List of tangent directions. Each entry maps names of parameters of
+            ``params`` (which must then be a ``mi.SceneParameters`` instance)
+            to their input gradient. Parameters with gradient tracking that
+            are not listed receive a zero gradient. An entry set to ``None``
+            keeps the gradients currently associated with the parameters.
+
+        See ``Integrator.render_forward()`` for a description of the other
+        parameters.
+
+        Returns → list[mi.TensorXf]:
+            The gradient images, one for each tangent direction.
+        """
+
         if isinstance(sensor, int):
             sensor = scene.sensors()[sensor]
 
-        film = sensor.film()
         aovs = self.aovs()
 
         # Disable derivatives in all of the following
@@ -689,6 +819,62 @@ class RBIntegrator(ADIntegrator):
                 active=mi.Bool(True)
             )
 
+            dr.schedule(L, valid, state_out)
+            if reparam is not None:
+                rng = mi.PCG32(reparam.rng)
+
+            result = []
+            for i, tangent in enumerate(tangents):
+                last = i + 1 == len(tangents)
+                result.append(self._render_forward_pass(
+                    scene, params, tangent, sensor, spp,
+                    sampler if last else sampler.clone(), reparam,
+                    ray, weight, pos, det, L, valid, state_out, last))
+
+                # Replay the same auxiliary rays for all tangents
+                if reparam is not None and not last:
+                    reparam.rng = mi.PCG32(rng)
+
+            # Explicitly delete any remaining unused variables
+            del sampler, ray, weight, pos, L, valid, params, state_out
+
+            # Probably a little overkill, but why not.. If there are any
+            # DrJit arrays to be collected by Python's cyclic GC, then
+            # freeing them may enable loop simplifications in dr.eval().
+            gc.collect()
+
+        return result
+
+    def _render_forward_pass(self: mi.SamplingIntegrator,
+                             scene: mi.Scene,
+                             params: Any,
+                             tangent: Optional[Mapping[str, Any]],
+                             sensor: mi.Sensor,
+                             spp: int,
+                             sampler: mi.Sampler,
+                             reparam: Optional[_ReparamWrapper],
+                             ray: mi.Ray3f,
+                             weight: mi.Spectrum,
+                             pos: mi.Vector2f,
+                             det: mi.Float,
+                             L: mi.Spectrum,
+                             valid: mi.Bool,
+                             state_out: Any,
+                             last: bool) -> mi.TensorXf:
+        """
+        Helper of ``render_forward_batch()`` that computes the gradient image
+        of a single tangent direction, replaying the paths of the primal pass
+        (``L``, ``valid`` and ``state_out``). The computation graph of the
+        sample positions is only released when ``last`` is set.
+        """
+
+        film = sensor.film()
+        flags = dr.ADFlag.Default if last else dr.ADFlag.ClearInterior
+
+        with dr.suspend_grad():
+            with dr.resume_grad():
+                _set_tangent(params, tangent)
+
             # Launch the Monte Carlo sampling process in forward mode (2)
             δL, valid_2, state_out_2 = self.sample(
                 mode=dr.ADMode.Forward,
@@ -733,12 +919,15 @@ class RBIntegrator(ADIntegrator):
 
                     # Compute the derivative of the reparameterized image ..
                     tensor = sample_pos_deriv.tensor()
-                    dr.forward_to(tensor, flags=dr.ADFlag.ClearInterior | dr.ADFlag.ClearEdges)
+                    dr.forward_to(tensor, flags=dr.ADFlag.ClearInterior |
+                                  dr.ADFlag.ClearEdges if last else
+                                  dr.ADFlag.ClearInterior)
 
                     dr.schedule(tensor, dr.grad(tensor))
 
                     # Done with this part, let's detach the image-space position
-                    dr.disable_grad(pos)
+                    if last:
+                        dr.disable_grad(pos)
                     del tensor
 
             # Prepare an ImageBlock as specified by the film
@@ -757,15 +946,10 @@ class RBIntegrator(ADIntegrator):
             )
 
             # Perform the weight division and return an image tensor
+            film.clear()
             film.put_block(block)
 
-            # Explicitly delete any remaining unused variables
-            del sampler, ray, weight, pos, L, valid, δL, valid_2, params, \
-                state_out, state_out_2, block
-
-            # Probably a little overkill, but why not.. If there are any
-            # DrJit arrays to be collected by Python's cyclic GC, then
-            # freeing them may enable loop simplifications in dr.eval().
+            del sampler, δL, valid_2, state_out_2, block
             gc.collect()
 
             result_grad = film.develop()
@@ -776,9 +960,11 @@ class RBIntegrator(ADIntegrator):
                     film.clear()
                     film.put_block(sample_pos_deriv)
                     reparam_result = film.develop()
-                    dr.forward_to(reparam_result)
+                    dr.forward_to(reparam_result, flags=flags)
                     result_grad += dr.grad(reparam_result)
 
+            dr.eval(result_grad)
+
         return result_grad
 
     def render_backward(self: mi.SamplingIntegrator,
@@ -836,11 +1022,46 @@ class RBIntegrator(ADIntegrator):
             Optional parameter to override the number of samples per pixel for the
             differential rendering step. The value provided within the original
             scene specification takes precedence if ``spp=0``.
+
+        To bound the memory used by the wavefront, the samples are processed
+        in several passes when needed (see ``ADIntegrator.sample_passes()``).
+        Each pass renders an independent image with fewer samples per pixel and
+        accumulates its share of the gradients into the scene parameters.
         """
 
         if isinstance(sensor, int):
             sensor = scene.sensors()[sensor]
 
+        passes = self.sample_passes(sensor, spp)
+        if len(passes) == 1:
+            return self._render_backward_pass(scene, params, grad_in,
+                                              sensor, seed, spp)
+
+        spp = sum(passes)
+        mi.Log(mi.LogLevel.Debug,
+               'render_backward(): splitting %i samples per pixel into '
+               '%i passes.' % (spp, len(passes)))
+
+        for i, spp_i in enumerate(passes):
+            # Decorrelate the passes from each other and from other seeds
+            seed_i = seed if i == 0 else hash((seed, i)) & 0xffffffff
+
+            # The image is a weighted average of the images of all passes
+            self._render_backward_pass(scene, params, grad_in * (spp_i / spp),
+                                       sensor, seed_i, spp_i)
+
+    def _render_backward_pass(self: mi.SamplingIntegrator,
+                              scene: mi.Scene,
+                              params: Any,
+                              grad_in: mi.TensorXf,
+                              sensor: mi.Sensor,
+                              seed: int,
+                              spp: int) -> None:
+        """
+        Back-propagate the gradient image through a single rendering pass (see
+        ``render_backward()`` for a description of the parameters).
+        """
+
         film = sensor.film()
         aovs = self.aovs()
 
@@ -1062,6 +1283,53 @@ def render_forward(self: mi.Integrator,
 
         return dr.grad(image)
 
+def render_forward_batch(self: mi.Integrator,
+                         scene: mi.Scene,
+                         params: Any,
+                         tangents: Sequence[Optional[Mapping[str, Any]]],
+                         sensor: Union[int, mi.Sensor] = 0,
+                         seed: int = 0,
+                         spp: int = 0) -> List[mi.TensorXf]:
+    """
+    Evaluates the forward-mode derivative of the rendering step along several
+    tangent directions.
+
+    This function is equivalent to a sequence of calls to
+    ``Integrator.render_forward()`` (one for each entry of ``tangents``) with
+    the same seed, but it amortizes the cost of the primal simulation over all
+    of them: the default implementation records the computation graph of the
+    rendering step once and traverses it for each tangent, which only
+    re-evaluates the derivative computations. Radiative backpropagation
+    integrators instead perform a single primal pass that is replayed by the
+    forward-mode pass of each tangent.
+
+    Parameter ``tangents`` (``Sequence[dict]``):
+        List of tangent directions. Each entry maps names of parameters of
+        ``params`` (which must then be a ``mi.SceneParameters`` instance) to
+        their input gradient. Parameters with gradient tracking that are not
+        listed receive a zero gradient. An entry set to ``None`` keeps the
+        gradients currently associated with the parameters.
+
+    See ``Integrator.render_forward()`` for a description of the other
+    parameters.
+
+    Returns → list[mi.TensorXf]:
+        The gradient images, one for each tangent direction.
+    """
+
+    # Recorded loops cannot be differentiated, so let's disable them
+    with dr.scoped_set_flag(dr.JitFlag.LoopRecord, False):
+        image = self.render(
+            scene=scene,
+            sensor=sensor,
+            seed=seed,
+            spp=spp,
+            develop=True,
+            evaluate=False
+        )
+
+        return _forward_tangents(params, tangents, image)
+
 def render_backward(self: mi.Integrator,
                     scene: mi.Scene,
                     params: Any,
@@ -1146,9 +1414,11 @@ def render_backward(self: mi.Integrator,
 # Monkey-patch render_forward/backward into the Integrator base class
 mi.Integrator.render_backward = render_backward
 mi.Integrator.render_forward = render_forward
+mi.Integrator.render_forward_batch = render_forward_batch
 
 del render_backward
 del render_forward
+del render_forward_batch
 
 # ------------------------------------------------------------------------------
 
@@ -1222,6 +1492,89 @@ class _ReparamWrapper:
 #  Helper functions used by various differentiable integrators
 # ---------------------------------------------------------------------------
 
+def _set_tangent(params: Any, tangent: Optional[Mapping[str, Any]]):
+    """
+    Associate the input gradients of a tangent direction (see
+    ``Integrator.render_forward_batch()``) with the differentiable parameters
+    of ``params``. Does nothing if ``tangent`` is ``None``.
+    """
+    if tangent is None:
+        return
+
+    if not isinstance(params, mi.SceneParameters):
+        raise Exception('render_forward_batch(): tangent directions require '
+                        'an instance of mi.SceneParameters!')
+
+    for k in tangent:
+        if k not in params:
+            raise Exception(f'render_forward_batch(): unknown parameter "{k}"!')
+
+    for k in params.keys():
+        value = params[k]
+        if dr.is_diff_v(value) and dr.grad_enabled(value):
+            dr.set_grad(value, tangent.get(k, 0.0))
+
+
+def _forward_tangents(params: Any,
+                      tangents: Sequence[Optional[Mapping[str, Any]]],
+                      output: Any) -> List[Any]:
+    """
+    Propagate each tangent direction of ``tangents`` to ``output``, whose
+    computation graph is kept until the last traversal. Returns the list of
+    output gradients.
+    """
+    result = []
+    for i, tangent in enumerate(tangents):
+        last = i + 1 == len(tangents)
+        _set_tangent(params, tangent)
+
+        grad = dr.forward_to(output, flags=dr.ADFlag.Default if last
+                             else dr.ADFlag.ClearInterior)
+        dr.eval(grad)
+        result.append(grad)
+
+        # Gradients accumulate at the output, reset them for the next tangent
+        if not last:
+            dr.set_grad(output, 0.0)
+
+    return result
+
+
+def _free_device_memory():
+    """
+    Return the amount of free memory (in bytes) of the device used by the
+    current variant, or ``None`` when it cannot be determined.
+    """
+
+    # Return cached allocations to the system so that they count as free
+    dr.flush_malloc_cache()
+
+    if mi.variant().startswith('cuda_'):
+        import ctypes
+        try:
+            cuda = ctypes.CDLL('nvcuda.dll' if sys.platform == 'win32'
+                               else 'libcuda.so.1')
+            ctx = ctypes.c_void_p()
+            if cuda.cuDevicePrimaryCtxRetain(ctypes.byref(ctx), 0) != 0:
+                return None
+            try:
+                free, total = ctypes.c_size_t(), ctypes.c_size_t()
+                cuda.cuCtxPushCurrent_v2(ctx)
+                result = cuda.cuMemGetInfo_v2(ctypes.byref(free),
+                                              ctypes.byref(total))
+                cuda.cuCtxPopCurrent_v2(ctypes.byref(ctypes.c_void_p()))
+            finally:
+                cuda.cuDevicePrimaryCtxRelease_v2(0)
+            return free.value if result == 0 else None
+        except (OSError, AttributeError):
+            return None
+    else:
+        try:
+            return os.sysconf('SC_AVPHYS_PAGES') * os.sysconf('SC_PAGE_SIZE')
+        except (ValueError, OSError, AttributeError):
+            return None
+
+
 def mis_weight(pdf_a, pdf_b):
     """
     Compute the Multiple Importance Sampling (MIS) weight given the densities
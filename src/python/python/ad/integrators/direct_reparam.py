@@ -41,6 +41,14 @@ class DirectReparamIntegrator(ADIntegrator):
        - Should antithetic sampling be enabled to improve convergence when
          sampling the auxiliary rays. (Default: False)
 
+     * - reparam_group_size
+       - |int|
+       - Number of consecutive samples (e.g. the samples of a pixel) that share
+         the auxiliary rays of the reparameterization when their rays start at
+         the same position. Each of them then only traces a fraction of the
+         ``reparam_rays`` auxiliary rays, at the cost of a slight smoothing of
+         the warp field. (Default: 1, i.e. no sharing)
+
     This plugin implements a reparameterized direct illumination integrator.
 
     It is functionally equivalent with `prb_reparam` when `max_depth` and
@@ -79,6 +87,11 @@ class DirectReparamIntegrator(ADIntegrator):
         # Enable antithetic sampling in the reparameterization?
         self.reparam_antithetic = props.get('reparam_antithetic', False)
 
+        # Number of consecutive samples sharing their auxiliary rays
+        self.reparam_group_size = props.get('reparam_group_size', 1)
+        if self.reparam_group_size < 1:
+            raise Exception("\"reparam_group_size\" must be at least 1!")
+
         self.params = None
 
     def reparam(self,
@@ -103,6 +116,7 @@ class DirectReparamIntegrator(ADIntegrator):
                                         kappa=self.reparam_kappa,
                                         exponent=self.reparam_exp,
                                         antithetic=self.reparam_antithetic,
+                                        group_size=self.reparam_group_size,
                                         unroll=False,
                                         active=active)
 
@@ -42,8 +42,12 @@ class PRBIntegrator(RBIntegrator):
     - Detached sampling. This means that the properties of ideal specular
       objects (e.g., the IOR of a glass vase) cannot be optimized.
 
-    See ``prb_basic.py`` for an even more reduced implementation that removes
-    the first two features.
+    The sampling loop itself is implemented in C++ by the :ref:`prb_native
+    <integrator-prb_native>` plugin, which avoids the cost of tracing it from
+    Python. Polarized variants are not supported by that plugin and fall back
+    to the Python implementation of the loop below. See ``prb_basic.py`` for
+    an even more reduced (pure Python) implementation that removes the first
+    two features.
 
     See the papers :cite:`Vicini2021` and :cite:`Zeltner2021MonteCarlo`
     for details on PRB, attached/detached sampling, and reparameterizations.
@@ -56,6 +60,19 @@ class PRBIntegrator(RBIntegrator):
             'max_depth': 8
     """
 
+    def __init__(self, props=mi.Properties()):
+        super().__init__(props)
+
+        # The sampling loop is implemented natively by the 'prb_native'
+        # plugin, except in polarized variants, which it does not support
+        self.kernel = None
+        if not mi.is_polarized:
+            self.kernel = mi.load_dict({
+                'type': 'prb_native',
+                'max_depth': props.get('max_depth', 6),
+                'rr_depth': self.rr_depth
+            })
+
     def sample(self,
                mode: dr.ADMode,
                scene: mi.Scene,
@@ -72,6 +89,17 @@ class PRBIntegrator(RBIntegrator):
         the role of the various parameters and return values.
         """
 
+        if self.kernel is not None:
+            return self.kernel.sample_adjoint(
+                mode=mode,
+                scene=scene,
+                sampler=sampler,
+                ray=ray,
+                δL=mi.Spectrum(δL if δL is not None else 0),
+                state_in=mi.Spectrum(state_in if state_in is not None else 0),
+                active=active
+            )
+
         # Rendering a primal image? (vs performing forward/reverse-mode AD)
         primal = mode == dr.ADMode.Primal
 
@@ -59,6 +59,14 @@ class PRBReparamIntegrator(RBIntegrator):
        - Unroll the loop tracing auxiliary rays in the reparameterization?
          (Default: False)
 
+     * - reparam_group_size
+       - |int|
+       - Number of consecutive samples (e.g. the samples of a pixel) that share
+         the auxiliary rays of the reparameterization when their rays start at
+         the same position. Each of them then only traces a fraction of the
+         ``reparam_rays`` auxiliary rays, at the cost of a slight smoothing of
+         the warp field. (Default: 1, i.e. no sharing)
+
     This class implements a reparameterized Path Replay Backpropagation (PRB)
     integrator with the following properties:
 
@@ -249,6 +257,11 @@ class PRBReparamIntegrator(RBIntegrator):
         # Unroll the loop tracing auxiliary rays in the reparameterization?
         self.reparam_unroll = props.get('reparam_unroll', False)
 
+        # Number of consecutive samples sharing their auxiliary rays
+        self.reparam_group_size = props.get('reparam_group_size', 1)
+        if self.reparam_group_size < 1:
+            raise Exception("\"reparam_group_size\" must be at least 1!")
+
     def reparam(self,
                 scene: mi.Scene,
                 rng: mi.PCG32,
@@ -271,6 +284,7 @@ class PRBReparamIntegrator(RBIntegrator):
                                         kappa=self.reparam_kappa,
                                         exponent=self.reparam_exp,
                                         antithetic=self.reparam_antithetic,
+                                        group_size=self.reparam_group_size,
                                         unroll=self.reparam_unroll,
                                         active=active)
 
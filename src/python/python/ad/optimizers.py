@@ -223,9 +223,22 @@ class Adam(Optimizer):
 
     Enabling ``mask_updates`` avoids these two issues. This is similar to
     `PyTorch's SparseAdam optimizer <https://pytorch.org/docs/1.9.0/generated/torch.optim.SparseAdam.html>`_.
+
+    Even with masked updates, each step still reads and writes the entire
+    optimizer state. For very large and sparsely observed parameters (e.g. an
+    8K texture seen from a single viewpoint), the ``tile_size`` parameter
+    instead restricts the step to the *tiles* of the parameter that received
+    at least one nonzero gradient: tensors of shape ``(height, width, ...)``
+    are divided into square tiles of ``tile_size`` x ``tile_size`` texels,
+    and other arrays into runs of ``tile_size**2`` entries. The entries of
+    the touched tiles are compacted and then updated using gather/scatter
+    operations, so that the cost of the update scales with the observed part
+    of the parameter. All entries of a touched tile are updated, including
+    those with a zero gradient.
     """
     def __init__(self, lr, beta_1=0.9, beta_2=0.999, epsilon=1e-8,
-                 mask_updates=False, uniform=False, params: dict=None):
+                 mask_updates=False, uniform=False, tile_size=0,
+                 params: dict=None):
         """
         Parameter ``lr``:
             learning rate
@@ -246,17 +259,23 @@ class Adam(Optimizer):
             the second moment estimates at the current step instead of the
             per-element second moments.
 
+        Parameter ``tile_size``:
+            if nonzero, only the tiles of ``tile_size`` x ``tile_size``
+            texels that received nonzero gradients are updated (see above).
+            This implies masked updates at the granularity of tiles.
+
         Parameter ``params`` (:py:class:`dict`):
             Optional dictionary-like object containing parameters to optimize.
         """
         assert 0 <= beta_1 < 1 and 0 <= beta_2 < 1 \
-            and lr > 0 and epsilon > 0
+            and lr > 0 and epsilon > 0 and tile_size >= 0
 
         self.beta_1 = beta_1
         self.beta_2 = beta_2
         self.epsilon = epsilon
         self.mask_updates = mask_updates
         self.uniform = uniform
+        self.tile_size = tile_size
         self.t = defaultdict(lambda: 0)
         super().__init__(lr, params)
 
@@ -277,6 +296,10 @@ class Adam(Optimizer):
                 # Reset state if data size has changed
                 self.reset(k)
 
+            if self.tile_size > 0 and (p.IsTensor or dr.depth_v(p) == 1):
+                self.variables[k] = self._step_tiled(k, p, g_p, lr_t)
+                continue
+
             m_tp, v_tp = self.state[k]
             m_t = self.beta_1 * m_tp + (1 - self.beta_1) * g_p
             v_t = self.beta_2 * v_tp + (1 - self.beta_2) * dr.sqr(g_p)
@@ -301,6 +324,41 @@ class Adam(Optimizer):
 
         dr.eval()
 
+    def _step_tiled(self, key, p, g_p, lr_t):
+        """Take a gradient step restricted to the touched tiles of a parameter"""
+        m_tp, v_tp = self.state[key]
+        shape = dr.shape(p)
+
+        # Work on the detached flat arrays underlying tensors
+        flat = (lambda x: x.array) if p.IsTensor else (lambda x: x)
+        m_t, v_t = flat(m_tp), flat(v_tp)
+        u = flat(dr.detach(p, preserve_type=False))
+        g = flat(dr.detach(g_p, preserve_type=False))
+
+        index = _touched_entries(g, shape, self.tile_size)
+        Array = type(m_t)
+        g_i = dr.gather(Array, g, index)
+        m_i = self.beta_1 * dr.gather(Array, m_t, index) + (1 - self.beta_1) * g_i
+        v_i = self.beta_2 * dr.gather(Array, v_t, index) + (1 - self.beta_2) * dr.sqr(g_i)
+        dr.scatter(m_t, m_i, index)
+        dr.scatter(v_t, v_i, index)
+
+        if self.uniform:
+            step = lr_t * m_i / (dr.sqrt(dr.max(v_t)) + self.epsilon)
+        else:
+            step = lr_t * m_i / (dr.sqrt(v_i) + self.epsilon)
+        dr.scatter(u, dr.gather(Array, u, index) - step, index)
+
+        if p.IsTensor:
+            m_t, v_t = type(m_tp)(m_t, shape), type(v_tp)(v_t, shape)
+        self.state[key] = (m_t, v_t)
+        dr.schedule(self.state[key])
+
+        u = type(p)(u, shape) if p.IsTensor else type(p)(u)
+        dr.enable_grad(u)
+        dr.schedule(u)
+        return u
+
     def reset(self, key):
         """Zero-initializes the internal state associated with a parameter"""
         p = self.variables[key]
@@ -311,9 +369,249 @@ class Adam(Optimizer):
 
     def __repr__(self):
         return ('Adam[\n'
+                '  variables = %s,\n'
+                '  lr = %s,\n'
+                '  betas = (%g, %g),\n'
+                '  eps = %g,\n'
+                '  tile_size = %i\n'
+                ']' % (list(self.keys()), dict(self.lr, default=self.lr_default),
+                       self.beta_1, self.beta_2, self.epsilon, self.tile_size))
+
+
+
+class FusedAdam(Adam):
+    """
+    Variant of the :py:class:`mitsuba.ad.Adam` optimizer that updates all
+    parameters at once.
+
+    The regular optimizer processes parameters one by one, which generates
+    separate kernels (and several small host-device copies) for each of them.
+    When optimizing hundreds of parameters, the optimizer step can then take
+    as long as the rendering itself. This optimizer instead packs the values
+    and moment estimates of all parameters into flat buffers. Each parameter
+    exposed by the optimizer is a differentiable (lazy) *gather* from the
+    packed buffer of values, hence the gradients of all parameters are
+    directly accumulated into a single gradient buffer during the backward
+    pass, and a step updates all parameters within a single kernel launch.
+
+    A few differences to :py:class:`mitsuba.ad.Adam` result from this
+    layout:
+
+    - The gradient of an individual parameter must be specified (or queried)
+      through the parameter returned by the optimizer, e.g.
+      ``dr.backward(loss)`` or ``dr.set_grad(opt[key], ...)``. The gradients
+      are stored in the packed buffer, not in the parameter itself.
+    - Values assigned via ``opt[key] = value`` are written to the packed
+      buffer in a batch, the next time that one of them is accessed, that the
+      parameters are iterated via ``items()`` (e.g. by
+      ``SceneParameters.update(opt)``), or that ``step()`` is called.
+    - The ``UniformAdam`` variant and tiled updates are not supported.
+
+    Finally, ``step()`` optionally takes the scene parameters, which are then
+    overwritten with the updated values and notified with a single batched
+    ``SceneParameters.update()`` call.
+    """
+    def __init__(self, lr, beta_1=0.9, beta_2=0.999, epsilon=1e-8,
+                 mask_updates=False, params: dict=None):
+        """
+        Parameter ``lr``:
+            learning rate
+
+        Parameter ``beta_1``:
+            controls the exponential averaging of first order gradient moments
+
+        Parameter ``beta_2``:
+            controls the exponential averaging of second order gradient moments
+
+        Parameter ``mask_updates``:
+            if enabled, parameters and state variables will only be updated in a
+            given iteration if it received nonzero gradients in that iteration
+
+        Parameter ``params`` (:py:class:`dict`):
+            Optional dictionary-like object containing parameters to optimize.
+        """
+        # Offset, size, type and shape of each parameter in the packed buffers
+        self.layout = None
+        self.pending = {}
+        super().__init__(lr, beta_1=beta_1, beta_2=beta_2, epsilon=epsilon,
+                         mask_updates=mask_updates, params=params)
+
+    def __getitem__(self, key: str):
+        if key in self.pending:
+            self._sync()
+        return self.variables[key]
+
+    def __setitem__(self, key: str, value):
+        if self.layout is not None and key in self.layout and \
+           dr.shape(self.variables[key]) == dr.shape(value):
+            if not (dr.is_diff_v(value) and dr.is_float_v(value)):
+                raise Exception('Optimizer.__setitem__(): value should be differentiable!')
+            # Defer the write to the packed buffer (see _sync())
+            self.pending[key] = dr.detach(value, True)
+        else:
+            self.pending.pop(key, None)
+            super().__setitem__(key, value)
+            self.layout = None
+
+    def __delitem__(self, key: str) -> None:
+        self.pending.pop(key, None)
+        super().__delitem__(key)
+        self.layout = None
+
+    def items(self):
+        self._sync()
+        return super().items()
+
+    def step(self, params: mi.SceneParameters = None):
+        """
+        Take a gradient step
+
+        Parameter ``params`` (:py:class:`mitsuba.SceneParameters`):
+            Optional scene parameters that should receive the updated values.
+            All modified scene objects are then notified at once.
+        """
+        self._sync()
+
+        if len(self.variables) > 0:
+            g = dr.detach(dr.grad(self.flat), preserve_type=False)
+
+            if dr.width(g) == dr.width(self.flat):
+                # Per-parameter learning rates, including the bias correction
+                lr_t = []
+                for k in self.layout.keys():
+                    self.t[k] += 1
+                    lr_scale = dr.sqrt(1 - self.beta_2 ** self.t[k]) / (1 - self.beta_1 ** self.t[k])
+                    lr_t.append(self.lr[k] * lr_scale)
+                lr_t = dr.gather(type(g), type(g)(lr_t), self.segment)
+
+                m_t = self.beta_1 * self.m + (1 - self.beta_1) * g
+                v_t = self.beta_2 * self.v + (1 - self.beta_2) * dr.sqr(g)
+                step = lr_t * m_t / (dr.sqrt(v_t) + self.epsilon)
+                if self.mask_updates:
+                    nonzero = dr.neq(g, 0.)
+                    m_t = dr.select(nonzero, m_t, self.m)
+                    v_t = dr.select(nonzero, v_t, self.v)
+                    step = dr.select(nonzero, step, 0.)
+
+                self.m, self.v = m_t, v_t
+                u = dr.detach(self.flat, preserve_type=False) - step
+                dr.schedule(self.m, self.v, u)
+                self._set_flat(u)
+
+        if params is not None:
+            params.update(self)
+        else:
+            dr.eval()
+
+    def reset(self, key):
+        """Zero-initializes the internal state associated with a parameter"""
+        super().reset(key)
+        if self.layout is not None and key in self.layout:
+            self.layout = None
+
+    def __repr__(self):
+        return ('FusedAdam[\n'
                 '  variables = %s,\n'
                 '  lr = %s,\n'
                 '  betas = (%g, %g),\n'
                 '  eps = %g\n'
                 ']' % (list(self.keys()), dict(self.lr, default=self.lr_default),
                        self.beta_1, self.beta_2, self.epsilon))
+
+    def _sync(self):
+        """Pack the parameters (if needed) and apply the pending writes"""
+        if self.layout is None:
+            self._pack()
+        if len(self.pending) == 0:
+            return
+
+        flat = dr.detach(self.flat, preserve_type=False)
+        for k, value in self.pending.items():
+            offset, size, _, _ = self.layout[k]
+            index = dr.arange(dr.uint32_array_t(type(flat)), offset, offset + size)
+            dr.scatter(flat, _flatten(dr.detach(value, preserve_type=False)), index)
+        self.pending.clear()
+        self._set_flat(flat)
+
+    def _pack(self):
+        """(Re-)build the packed buffers from the individual parameters"""
+        self.layout, offset = {}, 0
+        for k, p in self.variables.items():
+            size = dr.width(_flatten(p))
+            self.layout[k] = (offset, size, type(p), dr.shape(p))
+            offset += size
+
+        Float = dr.detached_t(mi.Float)
+        UInt32 = dr.uint32_array_t(Float)
+        flat = dr.zeros(Float, offset)
+        self.m, self.v = dr.zeros(Float, offset), dr.zeros(Float, offset)
+        self.segment = dr.zeros(UInt32, offset)
+
+        for i, (k, (offset, size, _, _)) in enumerate(self.layout.items()):
+            index = dr.arange(UInt32, offset, offset + size)
+            m_t, v_t = self.state[k]
+            dr.scatter(flat, Float(_flatten(dr.detach(self.variables[k], False))), index)
+            dr.scatter(self.m, Float(_flatten(m_t)), index)
+            dr.scatter(self.v, Float(_flatten(v_t)), index)
+            dr.scatter(self.segment, i, index)
+
+        dr.schedule(self.m, self.v, self.segment)
+        self._set_flat(flat)
+
+    def _set_flat(self, flat):
+        """Use new values for the packed buffer and expose them as parameters"""
+        self.flat = mi.Float(flat)
+        dr.enable_grad(self.flat)
+        dr.schedule(self.flat)
+
+        UInt32 = dr.uint32_array_t(type(flat))
+        for k, (offset, size, tp, shape) in self.layout.items():
+            index = dr.arange(UInt32, offset, offset + size)
+            self.variables[k] = _unflatten(tp, shape, dr.gather(mi.Float, self.flat, index))
+            self.state[k] = (
+                _unflatten(dr.detached_t(tp), shape, dr.gather(type(self.m), self.m, index)),
+                _unflatten(dr.detached_t(tp), shape, dr.gather(type(self.v), self.v, index))
+            )
+
+
+def _flatten(x):
+    """Flat array holding the entries of a (tensor or nested) Dr.Jit array"""
+    return x.array if x.IsTensor else dr.ravel(x)
+
+
+def _unflatten(tp, shape, flat):
+    """Inverse of _flatten()"""
+    return tp(flat, shape) if tp.IsTensor else dr.unravel(tp, flat)
+
+def _touched_entries(g, shape, tile_size):
+    """
+    Return the indices of the entries of the flat gradient array ``g`` that
+    lie in a tile containing at least one nonzero gradient.
+
+    Parameters of shape ``(height, width, ...)`` are divided into square tiles
+    of ``tile_size`` x ``tile_size`` texels (spanning all channels), other
+    parameters into runs of ``tile_size**2`` consecutive entries.
+    """
+    UInt32 = dr.uint32_array_t(type(g))
+    idx = dr.arange(UInt32, dr.width(g))
+
+    if len(shape) >= 2:
+        channels = 1
+        for s in shape[2:]:
+            channels *= s
+        tiles_x = (shape[1] + tile_size - 1) // tile_size
+        tiles_y = (shape[0] + tile_size - 1) // tile_size
+        texel = idx // channels
+        y = texel // shape[1]
+        x = texel - y * shape[1]
+        tile = (y // tile_size) * tiles_x + x // tile_size
+        tile_count = tiles_x * tiles_y
+    else:
+        run = tile_size * tile_size
+        tile = idx // run
+        tile_count = (dr.width(g) + run - 1) // run
+
+    # Flag the touched tiles, then select all of their entries
+    touched = dr.zeros(UInt32, tile_count)
+    dr.scatter(touched, 1, tile, dr.neq(g, 0))
+    return dr.compress(dr.neq(dr.gather(UInt32, touched, tile), 0))
@@ -13,7 +13,8 @@ def _sample_warp_field(scene: mi.Scene,
                        ray_frame: mi.Frame3f,
                        flip: mi.Bool,
                        kappa: float,
-                       exponent: float):
+                       exponent: float,
+                       active: mi.Bool = True):
     """
     Helper function for reparameterizing rays based on the paper
 
@@ -54,6 +55,10 @@ def _sample_warp_field(scene: mi.Scene,
     Parameter ``exponent`` (``float``):
         Power exponent applied on the computed harmonic weights.
 
+    Parameter ``active`` (``mitsuba.Bool``):
+        Mask of lanes that trace an auxiliary ray. The returned values are
+        zero on the other lanes.
+
     The function returns a tuple ``(Z, dZ, V, div)`` containing
 
     Return value ``Z`` (``mitsuba.Float``)
@@ -92,7 +97,8 @@ def _sample_warp_field(scene: mi.Scene,
     # Propagation of such gradients guarantees the correct evaluation of 'V_direct'.
     si = scene.ray_intersect(aux_ray,
                              ray_flags=mi.RayFlags.All | mi.RayFlags.FollowShape | mi.RayFlags.BoundaryTest,
-                             coherent=False)
+                             coherent=False,
+                             active=active)
 
     # Convert into a direction at 'ray.o'. When no surface was intersected,
     # copy the original direction
@@ -114,6 +120,7 @@ def _sample_warp_field(scene: mi.Scene,
         w_denom = inv_vmf_density - 1 + B
         w_denom_rcp = dr.select(w_denom > 1e-4, dr.rcp(w_denom), 0.0)  # 1 / (D + B)
         w = dr.power(w_denom_rcp, exponent) * inv_vmf_density
+        w = dr.select(active, w, 0.0)
 
         # Analytic weight gradient w.r.t. `ray.d` (detaching inv_vmf_density gradient)
         tmp1 = inv_vmf_density * w * w_denom_rcp * kappa * exponent
@@ -123,6 +130,36 @@ def _sample_warp_field(scene: mi.Scene,
     return w, d_w_omega, w * V_direct, dr.dot(d_w_omega, V_direct)
 
 
+def _coherent_lanes(ray: mi.Ray3f, group_size: int):
+    """
+    Helper function that returns the lanes whose ray starts at the same
+    position as the first lane of their group of ``group_size`` consecutive
+    lanes. Only these lanes can pool their auxiliary rays, since the warp
+    field is a directional quantity that depends on the ray origin.
+    """
+    n = dr.width(ray.o)
+    leader = (dr.arange(mi.UInt32, n) // group_size) * group_size
+    o_leader = dr.gather(mi.Point3f, ray.o, leader)
+    return dr.norm(ray.o - o_leader) <= \
+        mi.math.RayEpsilon * (1.0 + dr.norm(o_leader))
+
+
+def _pool(value, group_size: int, shared: mi.Bool):
+    """
+    Helper function that sums ``value`` over the ``shared`` lanes of each group
+    of ``group_size`` consecutive lanes. The other lanes keep their own value.
+    The operation is symmetric and therefore also maps the gradients of the
+    pooled values back to the per-lane values.
+    """
+    if group_size == 1:
+        return value
+    n = dr.width(value)
+    index = dr.arange(mi.UInt32, n) // group_size
+    pooled = dr.zeros(type(value), (n + group_size - 1) // group_size)
+    dr.scatter_reduce(dr.ReduceOp.Add, pooled, value, index, shared)
+    return dr.select(shared, dr.gather(type(value), pooled, index), value)
+
+
 class _ReparameterizeOp(dr.CustomOp):
     """
     Dr.Jit custom operation that reparameterizes rays based on the paper
@@ -133,9 +170,13 @@ class _ReparameterizeOp(dr.CustomOp):
 
     This is needed to to avoid bias caused by the discontinuous visibility
     function in gradient-based geometric optimization.
+
+    When ``group_size > 1``, groups of consecutive lanes sharing the same ray
+    origin split the ``num_rays`` auxiliary rays between them and pool the
+    resulting sums (see :py:func:`reparameterize_ray`).
     """
     def eval(self, scene, rng, params, ray, num_rays, kappa, exponent,
-             antithetic, unroll, active):
+             antithetic, unroll, group_size, active):
         # Stash all of this information for the forward/backward passes
         self.scene = scene
         self.rng = rng
@@ -147,6 +188,19 @@ class _ReparameterizeOp(dr.CustomOp):
         self.active = active
         self.antithetic = antithetic
         self.unroll = unroll
+        self.group_size = group_size
+
+        # Number of auxiliary rays traced by each lane
+        if group_size > 1:
+            self.shared = _coherent_lanes(self.ray, group_size) & active
+            count = -(-num_rays // group_size)
+            if antithetic:
+                count += count & 1
+            self.lane_rays = dr.select(self.shared, mi.UInt32(count),
+                                       mi.UInt32(num_rays))
+        else:
+            self.shared = None
+            self.lane_rays = num_rays
 
         # The reparameterization is simply the identity in primal mode
         return self.ray.d, dr.full(mi.Float, 1, dr.width(ray))
@@ -178,7 +232,7 @@ class _ReparameterizeOp(dr.CustomOp):
         loop.set_max_iterations(self.num_rays)
         loop.set_eval_stride(self.num_rays)
 
-        while loop(self.active & (it < self.num_rays)):
+        while loop(self.active & (it < self.lane_rays)):
             ray = mi.Ray3f(self.ray)
             dr.enable_grad(ray.o)
             dr.set_grad(ray.o, ray_grad_o)
@@ -210,6 +264,12 @@ class _ReparameterizeOp(dr.CustomOp):
             grad_div_lhs += dr.grad(div_lhs_i)
             it += 1
 
+        # Sum the contributions of the auxiliary rays of neighboring lanes
+        Z, dZ, grad_V, grad_div_lhs = [
+            _pool(v, self.group_size, self.shared)
+            for v in (Z, dZ, grad_V, grad_div_lhs)
+        ]
+
         inv_Z = dr.rcp(dr.maximum(Z, 1e-8))
         V_theta  = grad_V * inv_Z
         div_V_theta = (grad_div_lhs - dr.dot(V_theta, dZ)) * inv_Z
@@ -246,7 +306,7 @@ class _ReparameterizeOp(dr.CustomOp):
             loop.set_max_iterations(self.num_rays)
             loop.set_eval_stride(self.num_rays)
 
-            while loop(self.active & (it < self.num_rays)):
+            while loop(self.active & (it < self.lane_rays)):
                 rng_state_backup = rng_clone.state
 
                 sample = mi.Point2f(rng_clone.next_float32(),
@@ -266,6 +326,9 @@ class _ReparameterizeOp(dr.CustomOp):
                 dZ += dZ_i
                 it += 1
 
+            Z = _pool(Z, self.group_size, self.shared)
+            dZ = _pool(dZ, self.group_size, self.shared)
+
         # Un-normalized values
         V = dr.zeros(mi.Vector3f, dr.width(Z))
         div_V_1 = dr.zeros(mi.Float, dr.width(Z))
@@ -282,8 +345,9 @@ class _ReparameterizeOp(dr.CustomOp):
         dr.enqueue(dr.ADMode.Backward, direction, divergence)
         dr.traverse(mi.Float, dr.ADMode.Backward)
 
-        grad_V = dr.grad(V)
-        grad_div_V_1 = dr.grad(div_V_1)
+        # Every auxiliary ray of a group contributes to all pooled values
+        grad_V = _pool(dr.grad(V), self.group_size, self.shared)
+        grad_div_V_1 = _pool(dr.grad(div_V_1), self.group_size, self.shared)
 
         it = mi.UInt32(0)
         ray_grad_o = mi.Point3f(0)
@@ -297,7 +361,7 @@ class _ReparameterizeOp(dr.CustomOp):
         loop.set_max_iterations(self.num_rays)
         loop.set_eval_stride(self.num_rays)
 
-        while loop(self.active & (it < self.num_rays)):
+        while loop(self.active & (it < self.lane_rays)):
             ray = mi.Ray3f(self.ray)
             dr.enable_grad(ray.o)
             dr.enable_grad(ray.d)
@@ -356,7 +420,8 @@ class _ReparameterizeOp(dr.CustomOp):
             warp_fields.append(_sample_warp_field(self.scene, sample,
                                                   ray, ray_frame,
                                                   mi.Bool(False), self.kappa,
-                                                  self.exponent))
+                                                  self.exponent,
+                                                  self.active & (i < self.lane_rays)))
 
         Z = mi.Float(0.0)
         dZ = mi.Vector3f(0.0)
@@ -364,6 +429,9 @@ class _ReparameterizeOp(dr.CustomOp):
             Z += Z_i
             dZ += dZ_i
 
+        Z = _pool(Z, self.group_size, self.shared)
+        dZ = _pool(dZ, self.group_size, self.shared)
+
         # Un-normalized values
         V = dr.zeros(mi.Vector3f, dr.width(Z))
         div_V_1 = dr.zeros(mi.Float, dr.width(Z))
@@ -380,8 +448,8 @@ class _ReparameterizeOp(dr.CustomOp):
         dr.enqueue(dr.ADMode.Backward, direction, divergence)
         dr.traverse(mi.Float, dr.ADMode.Backward)
 
-        grad_V = dr.grad(V)
-        grad_div_V_1 = dr.grad(div_V_1)
+        grad_V = _pool(dr.grad(V), self.group_size, self.shared)
+        grad_div_V_1 = _pool(dr.grad(div_V_1), self.group_size, self.shared)
 
         for _, _, V_i, div_V_1_i in warp_fields:
             dr.set_grad(V_i, grad_V)
@@ -416,6 +484,7 @@ def reparameterize_ray(scene: mitsuba.Scene,
                        exponent: float=3.0,
                        antithetic: bool=False,
                        unroll: bool=False,
+                       group_size: int=1,
                        active: mitsuba.Bool = True
 ) -> Tuple[mitsuba.Vector3f, mitsuba.Float]:
     """
@@ -451,6 +520,18 @@ def reparameterize_ray(scene: mitsuba.Scene,
     Parameter ``unroll`` (``bool``):
         Should the loop tracing auxiliary rays be unrolled? (Default: False)
 
+    Parameter ``group_size`` (``int``):
+        Number of consecutive lanes that share their auxiliary rays. Lanes of
+        a group whose ray starts at the same position as the first one (e.g.
+        the camera rays of the samples of a pixel) each trace only
+        ``ceil(num_rays / group_size)`` auxiliary rays and pool the resulting
+        warp field estimates, which reduces the ray budget of the
+        reparameterization by this factor while keeping ``num_rays`` rays per
+        estimate. This smooths the warp field over the directions of the
+        group, which introduces a small bias when these directions are not
+        close to each other. The other lanes trace all ``num_rays`` rays.
+        (Default: 1, i.e. disabled)
+
     Parameter ``active`` (``mitsuba.Bool``):
         Boolean array specifying the active lanes
 
@@ -459,5 +540,8 @@ def reparameterize_ray(scene: mitsuba.Scene,
         determinant of the change of variables.
     """
 
+    if group_size < 1:
+        raise Exception("reparameterize_ray(): 'group_size' must be at least 1!")
+
     return dr.custom(_ReparameterizeOp, scene, rng, params, ray, num_rays,
-                     kappa, exponent, antithetic, unroll, active)
+                     kappa, exponent, antithetic, unroll, group_size, active)
@@ -0,0 +1,626 @@
+"""
+Benchmark suite for the core rendering kernels of Mitsuba.
+
+The suite covers acceleration data structure construction and traversal,
+``ImageBlock.put()``, bitmap loading and conversion, ``StructConverter``, the
+``sample()``/``eval()``/``pdf()`` methods of the BSDF, phase function and
+emitter plugins over randomized inputs, and end-to-end renders of reference
+scenes. Each benchmark is run for every requested variant and the
+timings are written to a machine-readable JSON file, which makes it possible
+to track performance regressions between releases.
+
+Usage::
+
+    python -m mitsuba.benchmark -m scalar_rgb -m llvm_ad_rgb -o results.json
+
+    # Shading cost of all BSDF, phase function and emitter plugins
+    python -m mitsuba.benchmark -m llvm_ad_rgb -k '^(bsdf|phase|emitter)'
+
+In JIT variants, the first run of each benchmark (which includes tracing and
+kernel compilation) is reported separately from the subsequent runs. In
+scalar variants, the micro-benchmarks of individual plugin methods are driven
+by a Python loop and therefore include its interpreter overhead.
+"""
+
+from __future__ import annotations as __annotations__ # Delayed parsing of type annotations
+
+import json
+import os
+import re
+import sys
+import tempfile
+import time
+
+import drjit as dr
+import mitsuba as mi
+
+import typing
+if typing.TYPE_CHECKING:
+    from typing import Callable, Optional
+
+#: Registered benchmarks as ``(name, function)`` tuples, see :py:func:`benchmark`
+BENCHMARKS = []
+
+#: BSDF plugins whose ``sample()``, ``eval()`` and ``pdf()`` methods are benchmarked
+BSDF_PLUGINS = {
+    'diffuse':        {'type': 'diffuse'},
+    'conductor':      {'type': 'conductor'},
+    'dielectric':     {'type': 'dielectric'},
+    'thindielectric': {'type': 'thindielectric'},
+    'plastic':        {'type': 'plastic'},
+    'pplastic':       {'type': 'pplastic', 'alpha': 0.2},
+    'roughconductor': {'type': 'roughconductor', 'alpha': 0.2},
+    'roughdielectric':{'type': 'roughdielectric', 'alpha': 0.2},
+    'roughplastic':   {'type': 'roughplastic', 'alpha': 0.2},
+    'principled':     {'type': 'principled', 'roughness': 0.3, 'metallic': 0.5},
+    'principledthin': {'type': 'principledthin', 'roughness': 0.3},
+    'twosided':       {'type': 'twosided', 'bsdf': {'type': 'diffuse'}},
+    'blendbsdf':      {'type': 'blendbsdf', 'weight': 0.5,
+                       'a': {'type': 'diffuse'},
+                       'b': {'type': 'roughconductor', 'alpha': 0.2}},
+    'mask':           {'type': 'mask', 'opacity': 0.5,
+                       'bsdf': {'type': 'diffuse'}},
+    'null':           {'type': 'null'},
+}
+
+#: Phase function plugins whose ``sample()`` and ``eval()`` methods are benchmarked
+PHASE_PLUGINS = {
+    'isotropic':  {'type': 'isotropic'},
+    'hg':         {'type': 'hg', 'g': 0.6},
+    'rayleigh':   {'type': 'rayleigh'},
+    'tabphase':   {'type': 'tabphase', 'values': '0.5, 1.0, 1.5, 3.0'},
+    'blendphase': {'type': 'blendphase', 'weight': 0.5,
+                   'a': {'type': 'isotropic'}, 'b': {'type': 'hg', 'g': 0.6}},
+}
+
+#: Emitter plugins whose ``sample_direction()``, ``eval_direction()`` and
+#: ``pdf_direction()`` methods are benchmarked. Emitters with ``'shape': True``
+#: are attached to a rectangle in the plane ``z=0``.
+EMITTER_PLUGINS = {
+    'point':           {'type': 'point'},
+    'spot':            {'type': 'spot', 'cutoff_angle': 60},
+    'projector':       {'type': 'projector', 'fov': 90},
+    'directional':     {'type': 'directional', 'direction': [0, 0, -1]},
+    'constant':        {'type': 'constant'},
+    'envmap':          {'type': 'envmap'},
+    'area':            {'type': 'area', 'shape': True},
+    'directionalarea': {'type': 'directionalarea', 'shape': True},
+}
+
+
+def benchmark(name: str):
+    """
+    Decorator that registers a benchmark.
+
+    The decorated function receives a ``scale`` factor for the problem size
+    and returns a tuple ``(run, ops)``. The callable ``run()`` performs the
+    timed work and returns the JIT variables that must be evaluated, and
+    ``ops`` is the number of elementary operations (rays, samples, pixels,
+    ...) processed by a single run. The setup work done before returning is
+    not timed.
+    """
+    def decorator(func):
+        BENCHMARKS.append((name, func))
+        return func
+    return decorator
+
+
+def _size(n: int, scale: float, scalar_n: Optional[int] = None) -> int:
+    """Problem size of a benchmark, reduced in scalar variants"""
+    if scalar_n is not None and not dr.is_jit_v(mi.Float):
+        n = scalar_n
+    return max(int(n * scale), 1)
+
+
+def _sample(n: int, dim: int, seed: int = 0):
+    """Return ``dim`` arrays of ``n`` uniform samples (JIT variants)"""
+    rng = mi.PCG32(size=n, initstate=seed)
+    return [rng.next_float32() for _ in range(dim)]
+
+
+def _grid_mesh(res: int) -> mi.Mesh:
+    """Create a wavy height field with ``2 * res^2`` triangles"""
+    import numpy as np
+
+    x, y = np.meshgrid(np.linspace(-1, 1, res + 1), np.linspace(-1, 1, res + 1))
+    z = 0.1 * np.sin(8 * x) * np.cos(8 * y)
+    vertices = np.stack([x, y, z], axis=-1).reshape(-1, 3).astype(np.float32)
+
+    i, j = np.meshgrid(np.arange(res), np.arange(res))
+    v0 = (j * (res + 1) + i).ravel()
+    v1, v2, v3 = v0 + 1, v0 + res + 1, v0 + res + 2
+    faces = np.concatenate([np.stack([v0, v1, v3], axis=-1),
+                            np.stack([v0, v3, v2], axis=-1)]).astype(np.uint32)
+
+    mesh = mi.Mesh('grid', vertices.shape[0], faces.shape[0])
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = type(params['vertex_positions'])(vertices.ravel())
+    params['faces'] = type(params['faces'])(faces.ravel())
+    params.update()
+    return mesh
+
+
+def _accel_name() -> str:
+    """Name of the acceleration data structure used by the current variant"""
+    if mi.variant().startswith('cuda_'):
+        return 'optix'
+    return 'embree' if mi.MI_ENABLE_EMBREE else 'kdtree'
+
+
+# ------------------------------------------------------------------------------
+#  Acceleration data structures
+# ------------------------------------------------------------------------------
+
+@benchmark('accel.build')
+def bench_accel_build(scale):
+    res = _size(512, scale ** 0.5)
+    mesh = _grid_mesh(res)
+
+    def run():
+        mi.load_dict({'type': 'scene', 'mesh': mesh})
+
+    return run, 2 * res * res
+
+
+@benchmark('accel.traverse')
+def bench_accel_traverse(scale):
+    res = _size(512, scale ** 0.5, scalar_n=256)
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'depth'},
+        'mesh': _grid_mesh(256),
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, -2, 2], target=[0, 0, 0], up=[0, 0, 1]),
+            'film': {'type': 'hdrfilm', 'width': res, 'height': res,
+                     'rfilter': {'type': 'box'}},
+            'sampler': {'type': 'independent', 'sample_count': 4},
+        },
+    })
+
+    return (lambda: mi.render(scene, seed=1)), res * res * 4
+
+
+# ------------------------------------------------------------------------------
+#  Image reconstruction and bitmaps
+# ------------------------------------------------------------------------------
+
+@benchmark('imageblock.put')
+def bench_imageblock_put(scale):
+    n = _size(1 << 20, scale, scalar_n=20000)
+    rfilter = mi.load_dict({'type': 'gaussian'})
+    block = mi.ImageBlock([512, 512], [0, 0], channel_count=5, rfilter=rfilter)
+
+    if dr.is_jit_v(mi.Float):
+        u, v, value = _sample(n, 3)
+        pos = mi.Point2f(u, v) * 512
+        values = [value, value, value, mi.Float(1), mi.Float(1)]
+
+        def run():
+            block.clear()
+            block.put(pos, values)
+            return block.tensor()
+    else:
+        def run():
+            block.clear()
+            for i in range(n):
+                block.put([(i * 0.618034) % 512, (i * 0.414214) % 512],
+                          [1, 1, 1, 1, 1])
+
+    return run, n
+
+
+def _bitmap(res: int) -> mi.Bitmap:
+    import numpy as np
+    data = np.random.default_rng(0).random((res, res, 3), dtype=np.float32)
+    return mi.Bitmap(data, mi.Bitmap.PixelFormat.RGB)
+
+
+@benchmark('bitmap.read_exr')
+def bench_bitmap_read_exr(scale):
+    res = _size(2048, scale ** 0.5)
+    filename = os.path.join(tempfile.mkdtemp(), 'benchmark.exr')
+    _bitmap(res).write(filename)
+    return (lambda: mi.Bitmap(filename)), res * res
+
+
+@benchmark('bitmap.read_png')
+def bench_bitmap_read_png(scale):
+    res = _size(2048, scale ** 0.5)
+    filename = os.path.join(tempfile.mkdtemp(), 'benchmark.png')
+    _bitmap(res).convert(component_format=mi.Struct.Type.UInt8,
+                         srgb_gamma=True).write(filename)
+    return (lambda: mi.Bitmap(filename)), res * res
+
+
+@benchmark('bitmap.convert')
+def bench_bitmap_convert(scale):
+    res = _size(2048, scale ** 0.5)
+    bitmap = _bitmap(res)
+
+    def run():
+        bitmap.convert(pixel_format=mi.Bitmap.PixelFormat.RGBA,
+                       component_format=mi.Struct.Type.UInt8, srgb_gamma=True)
+
+    return run, res * res
+
+
+@benchmark('struct.convert')
+def bench_struct_convert(scale):
+    n = _size(1 << 22, scale)
+    source, target = mi.Struct(), mi.Struct()
+    for name in ['r', 'g', 'b']:
+        source.append(name, mi.Struct.Type.Float32)
+        target.append(name, mi.Struct.Type.Float16)
+    converter = mi.StructConverter(source, target)
+    data = bytes(source.size() * n)
+    return (lambda: converter.convert(data)), n
+
+
+# ------------------------------------------------------------------------------
+#  BSDF plugins
+# ------------------------------------------------------------------------------
+
+def _directions(n: int, u1, u2, hemisphere: bool = False):
+    """
+    Return ``n`` directions on the (upper hemi-)sphere as a JIT array of
+    vectors, or as a list of scalar vectors (low-discrepancy sequence)
+    """
+    warp = (mi.warp.square_to_cosine_hemisphere if hemisphere
+            else mi.warp.square_to_uniform_sphere)
+    if dr.is_jit_v(mi.Float):
+        return warp(mi.Point2f(u1, u2))
+    return [warp(mi.Point2f((i * u1) % 1, (i * u2) % 1)) for i in range(n)]
+
+
+def _bsdf_benchmark(plugin: str, mode: str):
+    def func(scale):
+        n = _size(1 << 20, scale, scalar_n=20000)
+        bsdf = mi.load_dict(BSDF_PLUGINS[plugin])
+        ctx = mi.BSDFContext()
+
+        if dr.is_jit_v(mi.Float):
+            u1, u2, u3, u4, u5 = _sample(n, 5)
+            si = dr.zeros(mi.SurfaceInteraction3f, n)
+            si.wi = _directions(n, u1, u2, hemisphere=True)
+            wo = _directions(n, u4, u5)
+            dr.eval(si, wo)
+
+            if mode == 'sample':
+                run = lambda: bsdf.sample(ctx, si, u3, mi.Point2f(u4, u5))
+            elif mode == 'eval':
+                run = lambda: bsdf.eval(ctx, si, wo)
+            else:
+                run = lambda: bsdf.pdf(ctx, si, wo)
+        else:
+            si = [dr.zeros(mi.SurfaceInteraction3f) for _ in range(n)]
+            for si_i, wi in zip(si, _directions(n, 0.618034, 0.414214, True)):
+                si_i.wi = wi
+            wo = _directions(n, 0.732051, 0.236068)
+
+            if mode == 'sample':
+                def run():
+                    for i in range(n):
+                        bsdf.sample(ctx, si[i], (i * 0.618034) % 1,
+                                    [(i * 0.414214) % 1, (i * 0.732051) % 1])
+            elif mode == 'eval':
+                def run():
+                    for i in range(n):
+                        bsdf.eval(ctx, si[i], wo[i])
+            else:
+                def run():
+                    for i in range(n):
+                        bsdf.pdf(ctx, si[i], wo[i])
+
+        return run, n
+    return func
+
+
+def _phase_benchmark(plugin: str, mode: str):
+    def func(scale):
+        n = _size(1 << 20, scale, scalar_n=20000)
+        phase = mi.load_dict(PHASE_PLUGINS[plugin])
+        ctx = mi.PhaseFunctionContext(None)
+
+        def interaction(wi, size=None):
+            mei = (dr.zeros(mi.MediumInteraction3f, size) if size
+                   else dr.zeros(mi.MediumInteraction3f))
+            mei.wi = wi
+            mei.sh_frame = mi.Frame3f(wi)
+            return mei
+
+        if dr.is_jit_v(mi.Float):
+            u1, u2, u3, u4, u5 = _sample(n, 5)
+            mei = interaction(_directions(n, u1, u2), n)
+            wo = _directions(n, u4, u5)
+            dr.eval(mei, wo)
+
+            if mode == 'sample':
+                run = lambda: phase.sample(ctx, mei, u3, mi.Point2f(u4, u5))
+            else:
+                run = lambda: phase.eval(ctx, mei, wo)
+        else:
+            mei = [interaction(wi) for wi in _directions(n, 0.618034, 0.414214)]
+            wo = _directions(n, 0.732051, 0.236068)
+
+            if mode == 'sample':
+                def run():
+                    for i in range(n):
+                        phase.sample(ctx, mei[i], (i * 0.618034) % 1,
+                                     [(i * 0.414214) % 1, (i * 0.732051) % 1])
+            else:
+                def run():
+                    for i in range(n):
+                        phase.eval(ctx, mei[i], wo[i])
+
+        return run, n
+    return func
+
+
+def _emitter(plugin: str) -> mi.Emitter:
+    """Instantiate an emitter within a scene, which defines its bounds"""
+    emitter = dict(EMITTER_PLUGINS[plugin])
+    scene = {'type': 'scene', 'sphere': {'type': 'sphere'}}
+    if emitter.pop('shape', False):
+        scene['shape'] = {'type': 'rectangle', 'emitter': emitter}
+    else:
+        if plugin == 'envmap':
+            import numpy as np
+            emitter['bitmap'] = mi.Bitmap(np.random.default_rng(0).random(
+                (64, 128, 3), dtype=np.float32))
+        scene['emitter'] = emitter
+    return mi.load_dict(scene).emitters()[0]
+
+
+def _emitter_benchmark(plugin: str, mode: str):
+    def func(scale):
+        n = _size(1 << 20, scale, scalar_n=20000)
+        emitter = _emitter(plugin)
+
+        # Reference points above the emitters
+        def interaction(p, size=None):
+            it = (dr.zeros(mi.Interaction3f, size) if size
+                  else dr.zeros(mi.Interaction3f))
+            it.p = p
+            return it
+
+        if dr.is_jit_v(mi.Float):
+            u1, u2, u3, u4 = _sample(n, 4)
+            it = interaction(mi.Point3f(2 * u1 - 1, 2 * u2 - 1, 2), n)
+            sample = mi.Point2f(u3, u4)
+            ds, _ = emitter.sample_direction(it, sample)
+            dr.eval(it, ds)
+
+            if mode == 'sample':
+                run = lambda: emitter.sample_direction(it, sample)
+            elif mode == 'eval':
+                run = lambda: emitter.eval_direction(it, ds)
+            else:
+                run = lambda: emitter.pdf_direction(it, ds)
+        else:
+            it = [interaction(mi.Point3f((i * 0.618034) % 2 - 1,
+                                         (i * 0.414214) % 2 - 1, 2))
+                  for i in range(n)]
+            samples = [mi.Point2f((i * 0.732051) % 1, (i * 0.236068) % 1)
+                       for i in range(n)]
+            ds = [emitter.sample_direction(it[i], samples[i])[0]
+                  for i in range(n)]
+
+            if mode == 'sample':
+                def run():
+                    for i in range(n):
+                        emitter.sample_direction(it[i], samples[i])
+            elif mode == 'eval':
+                def run():
+                    for i in range(n):
+                        emitter.eval_direction(it[i], ds[i])
+            else:
+                def run():
+                    for i in range(n):
+                        emitter.pdf_direction(it[i], ds[i])
+
+        return run, n
+    return func
+
+
+for _plugin in BSDF_PLUGINS:
+    for _mode in ['sample', 'eval', 'pdf']:
+        benchmark(f'bsdf.{_mode}.{_plugin}')(_bsdf_benchmark(_plugin, _mode))
+
+for _plugin in PHASE_PLUGINS:
+    for _mode in ['sample', 'eval']:
+        benchmark(f'phase.{_mode}.{_plugin}')(_phase_benchmark(_plugin, _mode))
+
+for _plugin in EMITTER_PLUGINS:
+    for _mode in ['sample', 'eval', 'pdf']:
+        benchmark(f'emitter.{_mode}.{_plugin}')(_emitter_benchmark(_plugin, _mode))
+
+
+# ------------------------------------------------------------------------------
+#  End-to-end renders
+# ------------------------------------------------------------------------------
+
+@benchmark('render.cbox.path')
+def bench_render_cbox(scale):
+    res = _size(256, scale ** 0.5, scalar_n=128)
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = res
+    scene_dict['sensor']['film']['height'] = res
+    scene_dict['integrator'] = {'type': 'path', 'max_depth': 8}
+    scene = mi.load_dict(scene_dict)
+    return (lambda: mi.render(scene, spp=16)), res * res * 16
+
+
+@benchmark('render.cbox.volpath')
+def bench_render_cbox_volpath(scale):
+    res = _size(256, scale ** 0.5, scalar_n=128)
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = res
+    scene_dict['sensor']['film']['height'] = res
+    scene_dict['integrator'] = {'type': 'volpath', 'max_depth': 8}
+    scene_dict['sensor']['medium'] = {
+        'type': 'homogeneous',
+        'albedo': 0.8,
+        'sigma_t': 0.5,
+    }
+    scene = mi.load_dict(scene_dict)
+    return (lambda: mi.render(scene, spp=16)), res * res * 16
+
+
+# ------------------------------------------------------------------------------
+
+def _sync(result) -> None:
+    if result is not None:
+        dr.eval(result)
+    if dr.is_jit_v(mi.Float):
+        dr.sync_thread()
+
+
+def run_benchmarks(variants: list[str],
+                   pattern: str = '.*',
+                   repeat: int = 5,
+                   scale: float = 1.0,
+                   log: Callable = None) -> dict:
+    """
+    Run the benchmarks whose name matches the regular expression ``pattern``
+    for each of the given variants and return the results as a dictionary
+    (see :py:func:`main()` for its layout).
+
+    Each benchmark is run once to trace and compile the involved kernels,
+    followed by ``repeat`` timed runs.
+    """
+    regexp = re.compile(pattern)
+    results = []
+
+    for variant in variants:
+        with mi.variant_context(variant):
+            for name, func in BENCHMARKS:
+                if not regexp.search(name):
+                    continue
+
+                entry = { 'name': name, 'variant': variant }
+                if name.startswith('accel.'):
+                    entry['accel'] = _accel_name()
+
+                try:
+                    run, ops = func(scale)
+
+                    # Record the kernels launched by the first run
+                    kernels = None
+                    if dr.is_jit_v(mi.Float):
+                        history_flag = dr.flag(dr.JitFlag.KernelHistory)
+                        dr.set_flag(dr.JitFlag.KernelHistory, True)
+                        dr.kernel_history() # Clears the history
+                    try:
+                        t0 = time.perf_counter()
+                        _sync(run())
+                        first = time.perf_counter() - t0
+                        if dr.is_jit_v(mi.Float):
+                            kernels = [k for k in dr.kernel_history()
+                                       if k['type'] == dr.KernelType.JIT]
+                    finally:
+                        if dr.is_jit_v(mi.Float):
+                            dr.set_flag(dr.JitFlag.KernelHistory, history_flag)
+
+                    if kernels is not None:
+                        entry['kernels'] = len(kernels)
+                        entry['kernel_ops'] = sum(k.get('operation_count', 0)
+                                                  for k in kernels)
+
+                    times = []
+                    for _ in range(repeat):
+                        t0 = time.perf_counter()
+                        _sync(run())
+                        times.append(time.perf_counter() - t0)
+                    times.sort()
+
+                    median = times[len(times) // 2]
+                    entry.update({
+                        'ops': ops,
+                        'first': first,
+                        'times': times,
+                        'min': times[0],
+                        'median': median,
+                        'ops_per_second': ops / median if median > 0 else 0.0
+                    })
+                except Exception as e:
+                    entry['error'] = str(e)
+
+                if log is not None:
+                    log(entry)
+                results.append(entry)
+
+    return {
+        'mitsuba_version': mi.__version__,
+        'drjit_version': dr.__version__,
+        'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+        'platform': sys.platform,
+        'repeat': repeat,
+        'scale': scale,
+        'results': results,
+    }
+
+
+def main(args: Optional[list[str]] = None) -> None:
+    """
+    Command line interface of the benchmark suite.
+
+    The written JSON file contains the Mitsuba and Dr.Jit versions, a time
+    stamp, and a list ``results`` with one entry per benchmark and variant.
+    Each entry records the benchmark ``name``, the ``variant``, the number of
+    processed ``ops``, the duration of the ``first`` run (including kernel
+    compilation), the sorted ``times`` of the timed runs, their ``min`` and
+    ``median``, and the corresponding ``ops_per_second``. In JIT variants,
+    entries also contain the number of ``kernels`` launched by the first run
+    and their total number of IR operations (``kernel_ops``), which tracks
+    the size of the generated code. Failed benchmarks instead contain an
+    ``error`` message.
+    """
+    import argparse
+    parser = argparse.ArgumentParser(prog='python -m mitsuba.benchmark',
+                                     description=__doc__.split('\n\n')[0].strip())
+    parser.add_argument('-m', '--variant', action='append', dest='variants',
+                        help='Variant to benchmark (may be specified multiple '
+                             'times, defaults to all compiled variants)')
+    parser.add_argument('-k', '--filter', default='.*',
+                        help='Only run the benchmarks matching this regular '
+                             'expression')
+    parser.add_argument('-r', '--repeat', type=int, default=5,
+                        help='Number of timed runs per benchmark')
+    parser.add_argument('-s', '--scale', type=float, default=1.0,
+                        help='Scale factor of the problem sizes')
+    parser.add_argument('-o', '--output', default='benchmark.json',
+                        help='Output JSON file')
+    parser.add_argument('-l', '--list', action='store_true',
+                        help='List the available benchmarks and exit')
+    args = parser.parse_args(args)
+
+    if args.list:
+        for name, _ in BENCHMARKS:
+            print(name)
+        return
+
+    variants = args.variants if args.variants else mi.variants()
+
+    def log(entry):
+        if 'error' in entry:
+            status = 'failed: ' + entry['error']
+        else:
+            status = '%10.3f ms  (%.3g ops/s, first run: %.3f ms' % (
+                entry['median'] * 1e3, entry['ops_per_second'], entry['first'] * 1e3)
+            if 'kernels' in entry:
+                status += ', %i kernel(s) with %i ops' % (entry['kernels'],
+                                                         entry['kernel_ops'])
+            status += ')'
+        print('%-14s %-32s %s' % (entry['variant'], entry['name'], status))
+
+    report = run_benchmarks(variants, args.filter, args.repeat, args.scale, log)
+
+    with open(args.output, 'w') as f:
+        json.dump(report, f, indent=2)
+    print(f'Wrote {args.output}')
+
+
+if __name__ == '__main__':
+    main()
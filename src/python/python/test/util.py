@@ -173,3 +173,123 @@ def check_vectorization(kernel, arg_dims = [], width = 125, atol=1e-6,
         # Compare results
         for i in range(len(results_scalar)):
             assert dr.allclose(results_vec[i], results_scalar[i], atol=atol)
+
+
+def simple_scene(integrator={'type': 'path'}, spp=16, res=8, fov=30, **objects):
+    """
+    Returns the dictionary of a small scene for integrator tests: a camera
+    looking down at a diffuse floor (the square [-1, 1]^2 at z=0, albedo 0.5)
+    from a distance of 2, a diffuse sphere on the floor (albedo 0.8), and a
+    constant environment of unit radiance. The film uses a box filter, so
+    that every sample only contributes to its own pixel.
+
+    Parameter ``integrator`` (dict):
+        Integrator of the scene.
+
+    Parameter ``spp`` (int):
+        Sample count of the (independent) sampler.
+
+    Parameter ``res`` (int or tuple):
+        Film resolution, either as a single value or as (width, height).
+
+    Parameter ``fov`` (float):
+        Field of view of the camera. Above 53 degrees, the border of the image
+        sees the environment instead of the floor.
+
+    Remaining keyword arguments add objects to the scene or replace the
+    default ``floor``, ``sphere`` and ``emitter`` entries (``None`` removes
+    them).
+    """
+    import mitsuba as mi
+
+    width, height = (res, res) if isinstance(res, int) else res
+    scene = {
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'perspective',
+            'fov': fov,
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, 0, 2], target=[0, 0, 0], up=[0, 1, 0]),
+            'sampler': {'type': 'independent', 'sample_count': spp},
+            'film': {
+                'type': 'hdrfilm',
+                'width': width, 'height': height,
+                'rfilter': {'type': 'box'}
+            },
+        },
+        'floor': {
+            'type': 'rectangle',
+            'bsdf': {'type': 'diffuse', 'reflectance': {'type': 'rgb', 'value': 0.5}},
+        },
+        'sphere': {
+            'type': 'sphere',
+            'center': [0.6, 0, 0.4],
+            'radius': 0.3,
+            'bsdf': {'type': 'diffuse', 'reflectance': {'type': 'rgb', 'value': 0.8}},
+        },
+        'emitter': {'type': 'constant', 'radiance': 1.0},
+    }
+
+    for key, value in objects.items():
+        if value is None:
+            scene.pop(key, None)
+        else:
+            scene[key] = value
+
+    return scene
+
+
+def specular_scene(integrator={'type': 'path'}, spp=16, res=8, **objects):
+    """
+    Variant of :py:func:`simple_scene` with a wider field of view, whose
+    sphere is a rough conductor next to a second, dielectric sphere. The
+    scene is lit by an area light above the floor and a dim environment.
+    Keyword arguments are handled as by :py:func:`simple_scene`.
+    """
+    import mitsuba as mi
+
+    T = mi.ScalarTransform4f
+    specular = {
+        'sphere': {
+            'type': 'sphere',
+            'center': [0.6, 0, 0.4],
+            'radius': 0.3,
+            'bsdf': {'type': 'roughconductor', 'alpha': 0.3},
+        },
+        'sphere_2': {
+            'type': 'sphere',
+            'center': [-0.6, 0, 0.4],
+            'radius': 0.3,
+            'bsdf': {'type': 'dielectric'},
+        },
+        'light': {
+            'type': 'rectangle',
+            'to_world': T.translate([0, 0, 3]).rotate([1, 0, 0], 180).scale(0.5),
+            'emitter': {'type': 'area', 'radiance': 8.0},
+        },
+        'emitter': {'type': 'constant', 'radiance': 0.2},
+    }
+    specular.update(objects)
+    return simple_scene(integrator, spp, res, fov=60, **specular)
+
+
+def rmse(image, image_ref):
+    """Root mean square error between two images (or arrays)"""
+    import numpy as np
+    return np.sqrt(np.mean((np.array(image) - np.array(image_ref))**2))
+
+
+def pixel_sample_counts(scene, sensor=0):
+    """
+    Returns the number of samples that the last render of ``scene`` took in
+    each pixel of the film of sensor ``sensor`` (an array of shape (height,
+    width)). This is the accumulated weight of the film, which requires a box
+    reconstruction filter, e.g. that of :py:func:`simple_scene`.
+    """
+    import numpy as np
+    import mitsuba as mi
+
+    film = scene.sensors()[sensor].film()
+    alpha = mi.has_flag(film.flags(), mi.FilmFlags.Alpha)
+    return np.array(film.develop(raw=True))[..., 4 if alpha else 3]
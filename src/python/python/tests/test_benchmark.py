@@ -0,0 +1,54 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def test01_run_benchmarks(variants_all_rgb):
+    from mitsuba.benchmark import run_benchmarks
+
+    # Tiny problem sizes: only check that the benchmarks keep working
+    report = run_benchmarks([mi.variant()], pattern='accel|imageblock|struct|'
+                            'bsdf.*diffuse|render.cbox.path', repeat=1,
+                            scale=1e-3)
+
+    results = report['results']
+    assert len(results) == 8
+    for entry in results:
+        assert 'error' not in entry, entry
+        assert entry['variant'] == mi.variant()
+        assert entry['ops'] > 0 and entry['min'] >= 0
+
+
+def test02_json_output(variant_scalar_rgb, tmp_path):
+    import json
+    from mitsuba.benchmark import main
+
+    filename = str(tmp_path / 'results.json')
+    main(['-m', 'scalar_rgb', '-k', 'struct', '-r', '2', '-s', '1e-3',
+          '-o', filename])
+
+    with open(filename) as f:
+        report = json.load(f)
+    assert report['mitsuba_version'] == mi.__version__
+    assert [e['name'] for e in report['results']] == ['struct.convert']
+    assert len(report['results'][0]['times']) == 2
+
+
+def test03_plugins(variants_all_rgb):
+    from mitsuba.benchmark import run_benchmarks, BSDF_PLUGINS, \
+        PHASE_PLUGINS, EMITTER_PLUGINS
+
+    report = run_benchmarks([mi.variant()], pattern='^(bsdf|phase|emitter)',
+                            repeat=1, scale=1e-4)
+
+    results = report['results']
+    assert len(results) == 3 * len(BSDF_PLUGINS) + 2 * len(PHASE_PLUGINS) + \
+        3 * len(EMITTER_PLUGINS)
+    for entry in results:
+        assert 'error' not in entry, entry
+        assert entry['ops'] > 0
+        if dr.is_jit_v(mi.Float):
+            # Some methods return constants, which do not launch kernels
+            assert entry['kernels'] >= 0 and entry['kernel_ops'] >= 0
+        else:
+            assert 'kernels' not in entry
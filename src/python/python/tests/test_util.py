@@ -2,6 +2,9 @@ import pytest
 import drjit as dr
 import mitsuba as mi
 
+from mitsuba.scalar_rgb.test.util import simple_scene, rmse
+
+
 def test01_traverse_flags(variants_vec_backends_once_rgb):
     class MyBSDF(mi.BSDF):
         def __init__(self, props):
@@ -312,3 +315,198 @@ def test06_variant_context():
     except RuntimeError:
         pass
     assert mi.variant() == "scalar_rgb"
+
+
+def test07_recorded_render(variants_all_ad_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'path'},
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, 0, 4], target=[0, 0, 0], up=[0, 1, 0]),
+            'film': {'type': 'hdrfilm', 'width': 8, 'height': 8},
+        },
+        'shape': {
+            'type': 'sphere',
+            'bsdf': {'type': 'diffuse'},
+        },
+        'emitter': {'type': 'constant'},
+    })
+
+    key = 'shape.bsdf.reflectance.value'
+    recording = mi.RecordedRender(scene, key, spp=4)
+
+    with pytest.raises(KeyError):
+        recording({'emitter.radiance.value': 1.0})
+
+    params = mi.traverse(scene)
+    for i, value in enumerate([0.2, 0.4, 0.8]):
+        if dr.is_jit_v(mi.Float) and i == 2:
+            dr.set_flag(dr.JitFlag.KernelHistory, True)
+            dr.kernel_history()
+
+        image = recording({key: mi.Color3f(value)}, seed=i)
+        dr.eval(image)
+
+        if dr.is_jit_v(mi.Float) and i == 2:
+            # Only the value changed, the render kernel must come from the cache
+            history = dr.kernel_history([dr.KernelType.JIT])
+            dr.set_flag(dr.JitFlag.KernelHistory, False)
+            assert len(history) > 0
+            assert all(h['cache_hit'] for h in history)
+
+        assert dr.allclose(params[key], value)
+        image_ref = mi.render(scene, spp=4, seed=i)
+        assert dr.allclose(image, image_ref)
+
+
+def test08_scene_parameters_transaction(variants_all_ad_rgb):
+    class MyBSDF(mi.BSDF):
+        calls = []
+
+        def __init__(self, props):
+            mi.BSDF.__init__(self, props)
+            self.a = mi.Float(1)
+            self.b = mi.Float(2)
+
+        def traverse(self, callback):
+            callback.put_parameter("a", self.a, mi.ParamFlags.Differentiable)
+            callback.put_parameter("b", self.b, mi.ParamFlags.Differentiable)
+
+        def parameters_changed(self, keys):
+            MyBSDF.calls.append(set(keys))
+
+        def to_string(self, *args, **kwargs):
+            return "MyBSDF[]"
+
+    mi.register_bsdf("mybsdf_transaction", MyBSDF)
+    bsdf = mi.load_dict({"type": "mybsdf_transaction"})
+    params = mi.traverse(bsdf)
+
+    with params.transaction():
+        assert params.update({"a": 3.0}) == []
+        with params.transaction():
+            params["b"] = 4.0
+            params.update()
+        assert MyBSDF.calls == []
+
+    # A single notification with the keys of all updates
+    assert MyBSDF.calls == [{"a", "b"}]
+    assert dr.allclose(params["a"], 3.0) and dr.allclose(params["b"], 4.0)
+
+    # No update when the transaction fails
+    MyBSDF.calls = []
+    with pytest.raises(RuntimeError):
+        with params.transaction():
+            params["a"] = 5.0
+            raise RuntimeError("failed")
+    assert MyBSDF.calls == []
+    params.update()
+    assert MyBSDF.calls == [{"a"}]
+
+
+@pytest.mark.slow
+def test09_multi_device_render(variants_all_ad_rgb):
+    scene = {
+        'type': 'scene',
+        'sensor': {
+            'type': 'perspective',
+            'film': {'type': 'hdrfilm', 'width': 8, 'height': 6},
+            'sampler': {'type': 'independent', 'sample_count': 5},
+        },
+        'emitter': {'type': 'constant', 'radiance': 1.0},
+    }
+    key = 'emitter.radiance.value'
+
+    with mi.MultiDeviceRender(scene, devices=2, keys=[key]) as renderer:
+        # The passes of both devices are combined into the full image
+        image = renderer.render()
+        assert image.shape == (6, 8, 3)
+        assert dr.allclose(mi.TensorXf(image), 1.0)
+
+        renderer.update({key: 2.0})
+        image = renderer.render(seed=3, spp=3)
+        assert dr.allclose(mi.TensorXf(image), 2.0)
+
+        # Gradients of all devices are summed
+        grads = renderer.render_backward(grad_in=image * 0 + 1, spp=4)
+        assert dr.allclose(mi.Float(grads[key].ravel()), 6 * 8 * 3)
+
+        with pytest.raises(Exception, match='MultiDeviceRender'):
+            renderer.update({'foo': 1.0})
+
+
+def test10_scene_reloader(variants_all_rgb, tmp_path):
+    filename = str(tmp_path / 'scene.xml')
+
+    def write(reflectance, radius=None):
+        radius = '' if radius is None else f'<float name="radius" value="{radius}"/>'
+        with open(filename, 'w') as f:
+            f.write(f"""<scene version="3.0.0">
+                <bsdf type="diffuse" id="mat">
+                    <rgb name="reflectance" value="{reflectance}"/>
+                </bsdf>
+                <shape type="sphere" id="sphere">
+                    {radius}
+                    <ref id="mat"/>
+                </shape>
+            </scene>""")
+
+    write(0.2)
+    reloader = mi.SceneReloader(filename)
+    scene = reloader.scene
+
+    # Nothing changed
+    assert reloader.reload() == []
+    assert reloader.scene is scene
+
+    # A material edit is applied to the loaded scene
+    write(0.7)
+    keys = reloader.reload()
+    assert len(keys) == 1 and keys[0].endswith('reflectance.value')
+    assert reloader.scene is scene
+    params = mi.traverse(scene)
+    assert dr.allclose(params[keys[0]], 0.7)
+
+    # New properties require a complete reload
+    write(0.7, radius=2)
+    assert reloader.reload() is None
+    assert reloader.scene is not scene
+    assert dr.allclose(reloader.scene.bbox().extents(), 4)
+
+
+def batch_scene(spp, fovs=(30, 45, 60), widths=None):
+    # The field of view differs per sensor, so that mixed up tiles are caught
+    scene = simple_scene({'type': 'path', 'max_depth': 3}, spp=spp, res=(8, 6))
+    sensor = scene.pop('sensor')
+    for i, fov in enumerate(fovs):
+        film = dict(sensor['film'], width=widths[i] if widths else 8)
+        scene[f'sensor_{i}'] = dict(sensor, fov=fov, film=film)
+    return mi.load_dict(scene)
+
+
+@pytest.mark.parametrize('sensors', [None, [2, 0]])
+def test11_render_batch(variants_all_rgb, sensors):
+    scene, scene_ref = batch_scene(256), batch_scene(4096)
+    images = mi.render_batch(scene, sensors=sensors)
+    indices = sensors if sensors else [0, 1, 2]
+    assert len(images) == len(indices)
+
+    for image, i in zip(images, indices):
+        assert image.shape == (6, 8, 3)
+
+        # Every tile converges to the image of its own sensor, with the noise
+        # level of a separate render
+        image_ref = mi.render(scene_ref, sensor=i, seed=1)
+        error = rmse(image, image_ref)
+        assert error < 1.5 * rmse(mi.render(scene, sensor=i, seed=1), image_ref) + 1e-3
+        for j in range(3):
+            if j != i:
+                assert error < 0.5 * rmse(image, mi.render(scene_ref, sensor=j))
+
+
+def test12_render_batch_mismatched_resolution(variant_scalar_rgb):
+    scene = batch_scene(4, fovs=[30, 45], widths=[8, 4])
+    with pytest.raises(Exception, match='same resolution'):
+        mi.render_batch(scene)
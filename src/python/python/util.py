@@ -29,6 +29,7 @@ class SceneParameters(Mapping):
         self.hierarchy  = hierarchy  if hierarchy  is not None else {}
         self.update_candidates = {}
         self.nodes_to_update = {}
+        self.transaction_depth = 0
 
         self.set_property = mi.set_property
         self.get_property = mi.get_property
@@ -205,6 +206,10 @@ class SceneParameters(Mapping):
                 if k in self:
                     self[k] = v
 
+        # Defer the notifications until the end of the transaction
+        if self.transaction_depth > 0:
+            return []
+
         update_candidate_keys = list(self.update_candidates.keys())
         for key in update_candidate_keys:
             # Candidate objects might have been modified inplace, we must check
@@ -231,6 +236,38 @@ class SceneParameters(Mapping):
 
         return out
 
+    @contextlib.contextmanager
+    def transaction(self):
+        """
+        Context manager that groups several updates into a single update pass.
+
+        Within the ``with`` block, calls to
+        :py:meth:`~mitsuba.SceneParameters.update()` only write the provided
+        values and keep track of the modified parameters. When the outermost
+        block exits, a single update pass then notifies every modified object
+        once (children before their parents) with the union of its modified
+        keys. Expensive refresh steps, such as rebuilding the acceleration
+        data structure, the emitter sampling structures, or the sampling
+        warp of an environment map, thus run at most once.
+
+        .. code-block:: python
+
+            with params.transaction():
+                params.update(opt_geometry)
+                params.update(opt_lights)
+                params['emitter.scale'] = 2.0
+
+        No update is performed when the block exits with an exception.
+        """
+        self.transaction_depth += 1
+        try:
+            yield self
+        finally:
+            self.transaction_depth -= 1
+
+        if self.transaction_depth == 0:
+            self.update()
+
     def keep(self, keys: None | str | list[str]) -> None:
         """
         Reduce the size of the dictionary by only keeping elements,
@@ -522,6 +559,579 @@ def render(scene: mi.Scene,
     return dr.custom(_RenderOp, scene, sensor, params, integrator,
                      (seed, seed_grad), (spp, spp_grad))
 
+def render_batch(scene: mi.Scene,
+                 sensors: Optional[list] = None,
+                 params: Any = None,
+                 integrator: mi.Integrator = None,
+                 seed: int = 0,
+                 seed_grad: int = 0,
+                 spp: int = 0,
+                 spp_grad: int = 0) -> list:
+    """
+    Render several sensors at once and return one image per sensor.
+
+    The sensors are tiled side by side into a :ref:`batch sensor
+    <sensor-batch>`, which is rendered using a single call to
+    :py:func:`mitsuba.render()`. In JIT variants, this traces all viewpoints
+    using one kernel launch instead of one per sensor, which amortizes kernel
+    compilation and scene upload over the entire batch. The resulting image
+    is then split into separate images.
+
+    All sensors must use films of the same resolution. The reconstruction
+    filter, pixel format and sampler of the first sensor are used for the
+    entire batch. Note that reconstruction filters that are wider than a
+    pixel will blur across the boundaries of neighboring tiles.
+
+    Parameter ``sensors`` (``list``):
+        List of sensors (or sensor indices) to render. By default, all sensors
+        of the scene are rendered.
+
+    The remaining parameters have the same meaning as in
+    :py:func:`mitsuba.render()`.
+
+    Returns a list containing the rendered image of every sensor.
+    """
+
+    if sensors is None:
+        sensors = scene.sensors()
+    sensors = [scene.sensors()[s] if isinstance(s, int) else s for s in sensors]
+    if len(sensors) == 0:
+        raise Exception('No sensor specified! Add a sensor in the scene '
+                        'description or provide sensors directly as argument.')
+
+    film = sensors[0].film()
+    width, height = film.crop_size()
+    for sensor in sensors:
+        if dr.any(sensor.film().crop_size() != film.crop_size()):
+            raise Exception('render_batch(): all sensors must use films of '
+                            'the same resolution!')
+
+    alpha = mi.has_flag(film.flags(), mi.FilmFlags.Alpha)
+    if mi.is_monochromatic:
+        pixel_format = 'luminance_alpha' if alpha else 'luminance'
+    else:
+        pixel_format = 'rgba' if alpha else 'rgb'
+
+    batch_dict = {
+        'type': 'batch',
+        'film': {
+            'type': 'hdrfilm',
+            'width': width * len(sensors),
+            'height': height,
+            'pixel_format': pixel_format,
+            'rfilter': film.rfilter(),
+        },
+        'sampler': sensors[0].sampler(),
+    }
+    for i, sensor in enumerate(sensors):
+        batch_dict[f'sensor_{i}'] = sensor
+
+    image = render(scene, params=params, sensor=mi.load_dict(batch_dict),
+                   integrator=integrator, seed=seed, seed_grad=seed_grad,
+                   spp=spp, spp_grad=spp_grad)
+
+    return [image[:, i * width:(i + 1) * width, :] for i in range(len(sensors))]
+
+class RecordedRender:
+    """
+    Re-render a scene many times while only a few parameters change.
+
+    Values that are written to a scene parameter from Python (e.g. during a
+    parameter sweep) normally enter the rendering kernel as *literal*
+    constants. Every new value therefore produces a different kernel that must
+    be compiled from scratch. This class instead stores the selected
+    parameters as opaque variables, so that they become kernel inputs. The
+    structure of the traced program then stays the same from one call to the
+    next, and each new rendering reuses the kernel that was compiled by the
+    first call (tracing still happens, but code generation and compilation
+    are skipped).
+
+    The sensor, integrator and sample count are fixed at construction time,
+    since they influence the structure of the kernel. The seed remains a free
+    parameter. Scalar parameters that are not JIT arrays (e.g. integers or
+    flags) cannot be made opaque, and changing them still leads to a new
+    kernel.
+
+    .. code-block:: python
+
+        recording = mi.RecordedRender(scene, ['bsdf.reflectance.value'], spp=64)
+        for v in dr.linspace(mi.Float, 0, 1, 100):
+            image = recording({ 'bsdf.reflectance.value': mi.Color3f(v) })
+
+    Parameter ``scene`` (``mi.Scene``):
+        Reference to the scene being rendered.
+
+    Parameter ``keys`` (``str``, ``[str]``):
+        Keys (or regular expressions, see
+        :py:meth:`~mitsuba.SceneParameters.keep()`) of the scene parameters
+        that will be modified between renderings.
+
+    The parameters ``sensor``, ``integrator`` and ``spp`` have the same
+    meaning as in :py:func:`mitsuba.render()`.
+    """
+
+    def __init__(self,
+                 scene: mi.Scene,
+                 keys: Union[str, list[str]],
+                 sensor: Union[int, mi.Sensor] = 0,
+                 integrator: mi.Integrator = None,
+                 spp: int = 0) -> None:
+        self.scene = scene
+        self.sensor = sensor
+        self.integrator = integrator
+        self.spp = spp
+
+        self.params = traverse(scene)
+        self.params.keep(keys)
+        if len(self.params) == 0:
+            raise Exception(f'RecordedRender: no scene parameter matches {keys}!')
+
+        for k in self.params.keys():
+            self.params[k] = self._opaque(self.params[k], self.params[k])
+        self.params.update()
+
+    @staticmethod
+    def _opaque(value, current):
+        if not dr.is_jit_v(current):
+            return value
+        value = type(current)(value)
+        dr.make_opaque(value)
+        return value
+
+    def __call__(self, values: dict = None, seed: int = 0) -> mi.TensorXf:
+        """
+        Update the given parameters and render the scene.
+
+        Parameter ``values`` (``dict``):
+            Optional dictionary mapping parameter keys to their new values.
+
+        Parameter ``seed`` (``int``)
+            Seed of the random number generator, see
+            :py:func:`mitsuba.render()`.
+        """
+        if values is not None:
+            for k, v in values.items():
+                if k not in self.params:
+                    raise KeyError(f'RecordedRender: parameter "{k}" was not '
+                                   'selected when the recording was created!')
+                self.params[k] = self._opaque(v, self.params[k])
+            self.params.update()
+
+        return render(self.scene, sensor=self.sensor,
+                      integrator=self.integrator, seed=seed, spp=self.spp)
+
+class SceneReloader:
+    """
+    Apply edits of a scene's XML file to an already loaded scene.
+
+    Reloading a scene with :py:func:`mitsuba.load_file()` after a small edit
+    (e.g. of a single material) reads every mesh and texture again and
+    rebuilds the acceleration data structure. Instead, :py:meth:`reload()`
+    parses the file into per-object properties (see
+    :py:func:`mitsuba.xml_to_props()`) and compares them with the properties
+    of the previous version, matching objects by their identifiers. Changed
+    values are written into the corresponding scene parameters (see
+    :py:func:`mitsuba.traverse()`), so that only the affected objects and their
+    dependents are updated through their ``parameters_changed()`` callbacks.
+
+    The file is loaded again from scratch when an edit cannot be expressed as
+    a parameter update: when objects are added, removed, or change their type,
+    when references between objects change, or when a modified property is not
+    exposed as a scene parameter (e.g. the filename of a mesh). Parameters
+    passed as keyword arguments to :py:func:`mitsuba.load_file()` are not
+    supported, since the file is compared without them.
+
+    .. code-block:: python
+
+        reloader = mi.SceneReloader('scene.xml')
+        image = mi.render(reloader.scene)
+        # .. edit scene.xml ..
+        reloader.reload()
+        image = mi.render(reloader.scene)
+
+    Parameter ``filename`` (``str``):
+        Path of the XML scene description.
+    """
+
+    def __init__(self, filename: str) -> None:
+        self.filename = filename
+        self._load()
+
+    def _load(self) -> None:
+        self.scene = mi.load_file(self.filename)
+        self.props = self._parse()
+
+    def _parse(self) -> dict:
+        return { props.id(): (cls, props)
+                 for cls, props in mi.xml_to_props(self.filename) }
+
+    @staticmethod
+    def _structure(props: mi.Properties) -> tuple:
+        return (props.plugin_name(),
+                sorted((n, props.type(n)) for n in props.property_names()),
+                props.named_references())
+
+    def _plan(self, props: dict) -> Union[tuple, None]:
+        """
+        Return the scene parameters along with a dictionary mapping the keys
+        of the modified ones to their new values, or ``None`` if the edit
+        requires a complete reload
+        """
+        if props.keys() != self.props.keys():
+            return None
+
+        changes = []
+        for id, (cls, new) in props.items():
+            cls_old, old = self.props[id]
+            if cls != cls_old or self._structure(new) != self._structure(old):
+                return None
+            for name in new.property_names():
+                if new.as_string(name) != old.as_string(name):
+                    changes.append((id, name, new))
+
+        if len(changes) == 0:
+            return None, {}
+
+        params = traverse(self.scene)
+        nodes = { node.id(): node for node in params.hierarchy.keys() }
+
+        def is_ancestor(node, owner):
+            while owner is not None:
+                if owner is node:
+                    return True
+                owner = params.hierarchy[owner][0] if owner in params.hierarchy else None
+            return False
+
+        def find_key(node, suffix, direct):
+            keys = [k for k, v in params.properties.items()
+                    if (k == suffix or k.endswith('.' + suffix)) and
+                    (v[2] is node if direct else v[2] is not node and is_ancestor(node, v[2]))]
+            return keys[0] if len(keys) == 1 else None
+
+        values = {}
+        for id, name, new in changes:
+            node = nodes.get(id, None)
+            if node is None:
+                return None
+
+            if new.type(name) == mi.Properties.Type.Object:
+                # Inline objects (e.g. RGB textures): copy all their parameters
+                child_params = traverse(new[name])
+                if len(child_params) == 0:
+                    return None
+                for k in child_params.keys():
+                    key = find_key(node, f'{name}.{k}', direct=False)
+                    if key is None:
+                        return None
+                    values[key] = child_params[k]
+            else:
+                key = find_key(node, name, direct=True)
+                if key is None:
+                    return None
+                try:
+                    values[key] = type(params[key])(new[name])
+                except Exception:
+                    return None
+
+        return params, values
+
+    def reload(self) -> Union[list[str], None]:
+        """
+        Parse the file again and apply the edits to :py:attr:`scene`.
+
+        Returns the keys of the updated scene parameters, or ``None`` if the
+        scene had to be loaded from scratch (in which case :py:attr:`scene`
+        refers to a new object).
+        """
+        props = self._parse()
+        plan = self._plan(props)
+
+        if plan is None:
+            mi.Log(mi.LogLevel.Info, f'SceneReloader: reloading "{self.filename}" '
+                   'from scratch.')
+            self._load()
+            return None
+
+        params, values = plan
+        if len(values) > 0:
+            for k, v in values.items():
+                params[k] = v
+            params.update()
+
+        self.props = props
+        return list(values.keys())
+
+
+class MultiDeviceRender:
+    """
+    Render a scene on several devices at once.
+
+    Every device is driven by a separate worker process that loads its own
+    replica of the scene. Each rendering request splits the samples per pixel
+    between the devices, which render independent passes using different
+    seeds. The raw (weighted) film contents of the passes are then summed in
+    a fixed order and developed, so that the result does not depend on which
+    device finishes first. The backward pass is split in the same way, and
+    the parameter gradients of all devices are summed.
+
+    In CUDA variants, the worker of each device only sees this device
+    (through the ``CUDA_VISIBLE_DEVICES`` environment variable). In other
+    variants, the workers simply run in parallel on the host.
+
+    .. code-block:: python
+
+        with mi.MultiDeviceRender('scene.xml', devices=8,
+                                  keys=['bsdf.reflectance.value']) as r:
+            image = r.render(spp=1024)
+            grads = r.render_backward(grad_in=dr.ones_like(image))
+
+    Since the scene is replicated, parameter values must be transferred to
+    the workers using :py:meth:`update()`, and images and gradients are
+    returned as NumPy arrays.
+
+    Parameter ``scene`` (``str``, ``dict``):
+        Filename or dictionary of the scene (scene objects cannot be shared
+        between processes).
+
+    Parameter ``devices`` (``int``, ``[int]``):
+        Number of devices, or list of device indices to render on.
+
+    Parameter ``keys`` (``[str]``):
+        Keys (or regular expressions, see
+        :py:meth:`~mitsuba.SceneParameters.keep()`) of the scene parameters
+        that can be updated and differentiated. (Default: none)
+
+    Parameter ``variant`` (``str``):
+        Variant of the workers. (Default: the current variant)
+    """
+
+    def __init__(self,
+                 scene: Union[str, dict],
+                 devices: Union[int, list[int]],
+                 keys: Optional[list[str]] = None,
+                 variant: Optional[str] = None) -> None:
+        import multiprocessing, os
+
+        if variant is None:
+            variant = mi.variant()
+        if variant is None:
+            raise Exception('MultiDeviceRender: no variant specified!')
+        if isinstance(devices, int):
+            devices = list(range(devices))
+        if len(devices) == 0:
+            raise Exception('MultiDeviceRender: at least one device is required!')
+
+        self.workers = []
+        context = multiprocessing.get_context('spawn')
+        visible = os.environ.get('CUDA_VISIBLE_DEVICES')
+        try:
+            for device in devices:
+                if variant.startswith('cuda'):
+                    os.environ['CUDA_VISIBLE_DEVICES'] = str(device)
+                conn, child_conn = context.Pipe()
+                process = context.Process(
+                    target=_multi_device_worker, daemon=True,
+                    args=(child_conn, variant, scene, keys))
+                process.start()
+                self.workers.append((process, conn))
+        finally:
+            if visible is None:
+                os.environ.pop('CUDA_VISIBLE_DEVICES', None)
+            else:
+                os.environ['CUDA_VISIBLE_DEVICES'] = visible
+
+        # Wait until all replicas of the scene are loaded
+        try:
+            self.sample_count = self._receive([True] * len(self.workers))[0]
+        except Exception:
+            self.close()
+            raise
+
+    def _gather(self, requests: list) -> list:
+        """
+        Send the given requests (one per worker, or ``None`` to skip a worker)
+        and return the results in device order
+        """
+        for (_, conn), request in zip(self.workers, requests):
+            if request is not None:
+                conn.send(request)
+        return self._receive([r is not None for r in requests])
+
+    def _receive(self, pending: list) -> list:
+        """
+        Wait for the replies of the workers flagged in ``pending`` and return
+        them in device order (``None`` for the other workers)
+        """
+        results, error = [], None
+        for (_, conn), p in zip(self.workers, pending):
+            if not p:
+                results.append(None)
+                continue
+            success, result = conn.recv()
+            if not success and error is None:
+                error = result
+            results.append(result if success else None)
+
+        if error is not None:
+            raise Exception(f'MultiDeviceRender: {error}')
+        return results
+
+    def _passes(self, spp: int, seed: int) -> list:
+        """
+        Split the sample count between the devices. Returns a list of
+        ``(spp, seed)`` pairs (``None`` for devices that do not render) and
+        the total sample count.
+        """
+        if spp == 0:
+            spp = self.sample_count
+        n = len(self.workers)
+        passes = []
+        for i in range(n):
+            spp_i = spp // n + (1 if i < spp % n else 0)
+            seed_i = seed if i == 0 else hash((seed, i)) & 0xffffffff
+            passes.append((spp_i, seed_i) if spp_i > 0 else None)
+        return passes, spp
+
+    def update(self, values: dict) -> None:
+        """
+        Set the given scene parameters on all devices.
+
+        Parameter ``values`` (``dict``):
+            Dictionary mapping parameter keys to their new values.
+        """
+        import numpy as np
+        values = { k: np.array(v) for k, v in values.items() }
+        self._gather([('update', values)] * len(self.workers))
+
+    def render(self, sensor: int = 0, seed: int = 0, spp: int = 0):
+        """
+        Render the scene using all devices and return the developed image as
+        a NumPy array. See :py:func:`mitsuba.render()` for the meaning of the
+        parameters.
+        """
+        passes, _ = self._passes(spp, seed)
+        raw = self._gather([None if p is None else ('render', (sensor, *p))
+                            for p in passes])
+
+        # Sum the raw film contents in device order
+        total = None
+        for r in raw:
+            if r is not None:
+                total = r if total is None else total + r
+
+        requests = [None] * len(self.workers)
+        requests[0] = ('develop', (sensor, total))
+        return self._gather(requests)[0]
+
+    def render_backward(self, grad_in, sensor: int = 0, seed: int = 0,
+                        spp: int = 0) -> dict:
+        """
+        Evaluate the reverse-mode derivative of the rendering step with all
+        devices, see :py:meth:`mitsuba.Integrator.render_backward()`.
+
+        Returns a dictionary mapping the keys of the differentiable parameters
+        to their gradients (NumPy arrays), summed over all devices.
+        """
+        import numpy as np
+        grad_in = np.array(grad_in)
+        passes, spp = self._passes(spp, seed)
+        grads = self._gather([
+            None if p is None else
+            ('backward', (sensor, *p, grad_in * (p[0] / spp)))
+            for p in passes])
+
+        result = {}
+        for g in grads:
+            if g is None:
+                continue
+            for k, v in g.items():
+                result[k] = v if k not in result else result[k] + v
+        return result
+
+    def close(self) -> None:
+        """Shut down the worker processes"""
+        for process, conn in self.workers:
+            try:
+                conn.send(None)
+            except Exception:
+                pass
+        for process, conn in self.workers:
+            process.join(timeout=10)
+            if process.is_alive():
+                process.terminate()
+            conn.close()
+        self.workers = []
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+def _multi_device_worker(conn, variant: str, scene: Union[str, dict],
+                         keys: Optional[list[str]]) -> None:
+    """
+    Main loop of the worker processes of :py:class:`MultiDeviceRender`
+    """
+    import numpy as np
+    import traceback
+
+    try:
+        mi.set_variant(variant)
+        scene = mi.load_file(scene) if isinstance(scene, str) else mi.load_dict(scene)
+        params = traverse(scene)
+        params.keep(keys if keys else [])
+        sensors = scene.sensors()
+        conn.send((True, sensors[0].sampler().sample_count()))
+    except Exception:
+        conn.send((False, traceback.format_exc()))
+        return
+
+    while True:
+        request = conn.recv()
+        if request is None:
+            break
+        command, args = request
+
+        try:
+            if command == 'update':
+                for k, v in args.items():
+                    params[k] = type(params[k])(v)
+                params.update()
+                result = None
+            elif command == 'render':
+                sensor, spp, seed = args
+                scene.integrator().render(scene, sensors[sensor], seed=seed,
+                                          spp=spp, develop=False)
+                result = np.array(sensors[sensor].film().develop(raw=True))
+            elif command == 'develop':
+                sensor, raw = args
+                film = sensors[sensor].film()
+                film.prepare(scene.integrator().aov_names())
+                film.clear()
+                film.put_block(mi.ImageBlock(mi.TensorXf(raw),
+                                             film.crop_offset(),
+                                             film.rfilter(), border=False))
+                result = np.array(film.develop())
+            elif command == 'backward':
+                sensor, spp, seed, grad_in = args
+                for k in params.keys():
+                    dr.enable_grad(params[k])
+                params.update()
+                scene.integrator().render_backward(
+                    scene, params, mi.TensorXf(grad_in), sensors[sensor],
+                    seed=seed, spp=spp)
+                result = {}
+                for k in params.keys():
+                    result[k] = np.array(dr.grad(params[k]))
+                    dr.disable_grad(params[k])
+                params.update()
+            else:
+                raise Exception(f'unknown command "{command}"')
+            conn.send((True, result))
+        except Exception:
+            conn.send((False, traceback.format_exc()))
+
 # ------------------------------------------------------------------------------
 
 def convert_to_bitmap(data, uint8_srgb=True):
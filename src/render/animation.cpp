@@ -0,0 +1,333 @@
+#include <mitsuba/render/animation.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/transform.h>
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Collects the parameters of a scene graph, named like mitsuba.traverse()
+struct AnimationTraversal : public TraversalCallback {
+    struct Parameter {
+        void *ptr;
+        const std::type_info *type;
+        Object *node;
+    };
+
+    /// State that is shared by the callbacks of all nodes
+    struct Shared {
+        std::unordered_map<std::string, Parameter> parameters;
+        std::unordered_map<Object *, std::pair<Object *, uint32_t>> hierarchy;
+        std::unordered_set<std::string> prefixes;
+    };
+
+    AnimationTraversal(Shared &shared, Object *node, Object *parent,
+                       const std::string &name, uint32_t depth)
+        : shared(shared), node(node), name(name), depth(depth) {
+        if (!name.empty()) {
+            size_t ctr = 1;
+            while (shared.prefixes.count(this->name) != 0)
+                this->name = name + "_" + std::to_string(ctr++);
+            shared.prefixes.insert(this->name);
+        }
+        shared.hierarchy[node] = { parent, depth };
+    }
+
+    void put_object(const std::string &child_name, Object *child,
+                    uint32_t) override {
+        if (!child || shared.hierarchy.count(child) != 0)
+            return;
+        AnimationTraversal cb(shared, child, node, prefixed(child_name), depth + 1);
+        child->traverse(&cb);
+    }
+
+protected:
+    void put_parameter_impl(const std::string &param_name, void *ptr, uint32_t,
+                            const std::type_info &type) override {
+        shared.parameters[prefixed(param_name)] = { ptr, &type, node };
+    }
+
+    std::string prefixed(const std::string &s) const {
+        return name.empty() ? s : name + "." + s;
+    }
+
+    Shared &shared;
+    Object *node;
+    std::string name;
+    uint32_t depth;
+};
+
+/// Number of values of a keyframe of the given type (zero if it cannot be animated)
+MI_VARIANT size_t animation_value_count(const std::type_info &type) {
+    MI_IMPORT_TYPES()
+    if (type == typeid(Float) || type == typeid(ScalarFloat) ||
+        type == typeid(Color1f))
+        return 1;
+    if (type == typeid(Point3f) || type == typeid(Vector3f) ||
+        type == typeid(Color3f) || type == typeid(ScalarPoint3f) ||
+        type == typeid(ScalarVector3f) || type == typeid(ScalarColor3f))
+        return 3;
+    if (type == typeid(Transform4f) || type == typeid(ScalarTransform4f))
+        return 16;
+    return 0;
+}
+
+/// Overwrite the parameter \c ptr if it has the type \c T
+template <typename T, typename... Args>
+bool animation_assign(void *ptr, const std::type_info &type, Args&&... args) {
+    if (type != typeid(T))
+        return false;
+    T &value = *(T *) ptr;
+    value = T(std::forward<Args>(args)...);
+    dr::make_opaque(value);
+    return true;
+}
+
+MI_VARIANT Animation<Float, Spectrum>::Animation(Object *root,
+                                                 const fs::path &filename)
+    : m_root(root) {
+    auto fs = Thread::thread()->file_resolver();
+    fs::path file_path = fs->resolve(filename);
+    std::ifstream is(file_path.native());
+    if (!is)
+        Throw("\"%s\": could not open file!", file_path);
+
+    Log(Info, "Loading keyframes from \"%s\" ..", file_path);
+
+    // Parse the keyframes and group them by parameter
+    std::unordered_map<std::string, size_t> track_index;
+    std::vector<std::vector<std::pair<ScalarFloat, std::vector<ScalarFloat>>>> keys;
+    size_t line_number = 0;
+    std::string line;
+    while (std::getline(is, line)) {
+        line_number++;
+        line = string::trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> tokens = string::tokenize(line, " \t");
+        if (tokens.size() < 3)
+            Throw("\"%s\": line %zu must contain a frame number, a parameter "
+                  "name and its value!", file_path, line_number);
+
+        Track track;
+        track.name = tokens[1];
+        track.look_at = tokens[2] == "look_at";
+
+        std::vector<ScalarFloat> values;
+        ScalarFloat frame;
+        try {
+            frame = string::stof<ScalarFloat>(tokens[0]);
+            for (size_t i = track.look_at ? 3 : 2; i < tokens.size(); ++i)
+                values.push_back(string::stof<ScalarFloat>(tokens[i]));
+        } catch (const std::exception &) {
+            Throw("\"%s\": could not parse line %zu!", file_path, line_number);
+        }
+
+        auto it = track_index.find(track.name);
+        if (it == track_index.end()) {
+            it = track_index.emplace(track.name, m_tracks.size()).first;
+            m_tracks.push_back(track);
+            keys.emplace_back();
+        } else if (m_tracks[it->second].look_at != track.look_at) {
+            Throw("\"%s\": line %zu: all keyframes of the transformation "
+                  "\"%s\" must use the same form (a matrix or look_at)!",
+                  file_path, line_number, track.name);
+        }
+        keys[it->second].emplace_back(frame, std::move(values));
+    }
+
+    if (m_tracks.empty())
+        Throw("\"%s\": the file does not specify any keyframes!", file_path);
+
+    // Look up the animated parameters
+    AnimationTraversal::Shared shared;
+    AnimationTraversal cb(shared, root, nullptr, "", 0);
+    root->traverse(&cb);
+
+    for (size_t i = 0; i < m_tracks.size(); ++i) {
+        Track &track = m_tracks[i];
+        auto it = shared.parameters.find(track.name);
+        if (it == shared.parameters.end())
+            Throw("\"%s\": unknown parameter \"%s\"!", file_path, track.name);
+
+        track.ptr  = it->second.ptr;
+        track.type = it->second.type;
+        track.size = animation_value_count<Float, Spectrum>(*track.type);
+        if (track.size == 0)
+            Throw("\"%s\": the parameter \"%s\" cannot be animated (only "
+                  "scalars, 3D vectors, colors and transformations are "
+                  "supported)!", file_path, track.name);
+        if (track.look_at) {
+            if (track.size != 16)
+                Throw("\"%s\": the parameter \"%s\" is not a transformation "
+                      "and cannot be specified using look_at!",
+                      file_path, track.name);
+            track.size = 9;
+        }
+
+        std::stable_sort(keys[i].begin(), keys[i].end(),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (size_t j = 0; j < keys[i].size(); ++j) {
+            const auto &[frame, values] = keys[i][j];
+            if (values.size() != track.size)
+                Throw("\"%s\": the keyframe of \"%s\" at frame %g must "
+                      "contain %zu values (found %zu)!", file_path,
+                      track.name, frame, track.size, values.size());
+            if (j > 0 && frame == track.frames.back())
+                Throw("\"%s\": the parameter \"%s\" has multiple keyframes at "
+                      "frame %g!", file_path, track.name, frame);
+            track.frames.push_back(frame);
+            track.values.insert(track.values.end(), values.begin(), values.end());
+        }
+
+        /* Objects to notify when the parameter changes: the owner receives
+           the name of the parameter, and every ancestor the name of the
+           child on the path to the owner (like SceneParameters.update()) */
+        std::string node_key = track.name;
+        Object *node = it->second.node;
+        while (node) {
+            auto [parent, depth] = shared.hierarchy[node];
+            std::string key = node_key;
+            if (parent) {
+                size_t sep = node_key.rfind('.');
+                key = node_key.substr(sep + 1);
+                node_key = node_key.substr(0, sep);
+            }
+            track.nodes.emplace_back(node, depth, key);
+            node = parent;
+        }
+    }
+}
+
+MI_VARIANT Animation<Float, Spectrum>::~Animation() { }
+
+MI_VARIANT std::pair<int, int> Animation<Float, Spectrum>::frame_range() const {
+    ScalarFloat first = m_tracks[0].frames.front(),
+                last  = m_tracks[0].frames.back();
+    for (const Track &track : m_tracks) {
+        first = std::min(first, track.frames.front());
+        last  = std::max(last, track.frames.back());
+    }
+    return { (int) std::floor(first), (int) std::ceil(last) };
+}
+
+MI_VARIANT bool Animation<Float, Spectrum>::write(Track &track, ScalarFloat frame) {
+    // Interpolate the values of the enclosing keyframes
+    size_t count = track.frames.size(),
+           index = std::upper_bound(track.frames.begin(), track.frames.end(),
+                                    frame) - track.frames.begin();
+    const ScalarFloat *v0 = track.values.data(), *v1 = v0;
+    ScalarFloat t = 0.f;
+    if (index == count) {
+        v0 = v1 = v0 + (count - 1) * track.size;
+    } else if (index > 0) {
+        v0 += (index - 1) * track.size;
+        v1  = v0 + track.size;
+        t   = (frame - track.frames[index - 1]) /
+              (track.frames[index] - track.frames[index - 1]);
+    }
+
+    std::vector<ScalarFloat> v(track.size);
+    for (size_t i = 0; i < track.size; ++i)
+        v[i] = dr::lerp(v0[i], v1[i], t);
+
+    // Skip parameters that keep their value (e.g. after their last keyframe)
+    if (v == track.current)
+        return false;
+    track.current = v;
+
+    const std::type_info &type = *track.type;
+    bool success = false;
+    if (track.size == 1) {
+        success = animation_assign<Float>(track.ptr, type, v[0]) ||
+                  animation_assign<ScalarFloat>(track.ptr, type, v[0]) ||
+                  animation_assign<Color1f>(track.ptr, type, v[0]);
+    } else if (track.size == 3) {
+        success = animation_assign<Point3f>(track.ptr, type, v[0], v[1], v[2]) ||
+                  animation_assign<Vector3f>(track.ptr, type, v[0], v[1], v[2]) ||
+                  animation_assign<Color3f>(track.ptr, type, v[0], v[1], v[2]) ||
+                  animation_assign<ScalarPoint3f>(track.ptr, type, v[0], v[1], v[2]) ||
+                  animation_assign<ScalarVector3f>(track.ptr, type, v[0], v[1], v[2]) ||
+                  animation_assign<ScalarColor3f>(track.ptr, type, v[0], v[1], v[2]);
+    } else {
+        ScalarTransform4f trafo;
+        if (track.look_at) {
+            trafo = ScalarTransform4f::look_at(ScalarPoint3f(v[0], v[1], v[2]),
+                                               ScalarPoint3f(v[3], v[4], v[5]),
+                                               ScalarVector3f(v[6], v[7], v[8]));
+        } else {
+            ScalarMatrix4f m;
+            for (size_t i = 0; i < 4; ++i)
+                for (size_t j = 0; j < 4; ++j)
+                    m.entry(i, j) = v[i * 4 + j];
+            trafo = ScalarTransform4f(m);
+        }
+        success = animation_assign<Transform4f>(track.ptr, type, trafo) ||
+                  animation_assign<ScalarTransform4f>(track.ptr, type, trafo);
+    }
+
+    if (!success)
+        Throw("Animation: unsupported type of the parameter \"%s\"!", track.name);
+    return true;
+}
+
+MI_VARIANT void Animation<Float, Spectrum>::set_frame(ScalarFloat frame) {
+    // Objects to notify, with their depth in the scene graph and the modified keys
+    std::vector<std::tuple<uint32_t, Object *, std::vector<std::string>>> updates;
+
+    for (Track &track : m_tracks) {
+        if (!write(track, frame))
+            continue;
+
+        for (const auto &[node, depth, key] : track.nodes) {
+            auto it = std::find_if(updates.begin(), updates.end(),
+                                   [node = node](const auto &u) { return std::get<1>(u) == node; });
+            if (it == updates.end()) {
+                updates.emplace_back(depth, node, std::vector<std::string>());
+                it = updates.end() - 1;
+            }
+            std::vector<std::string> &keys = std::get<2>(*it);
+            if (!string::contains(keys, key))
+                keys.push_back(key);
+        }
+    }
+
+    // Notify the objects from the bottom to the top of the scene graph
+    std::stable_sort(updates.begin(), updates.end(),
+                     [](const auto &a, const auto &b) { return std::get<0>(a) > std::get<0>(b); });
+    for (auto &[depth, node, keys] : updates)
+        node->parameters_changed(keys);
+
+    if constexpr (dr::is_jit_v<Float>)
+        dr::eval();
+}
+
+MI_VARIANT std::vector<std::string> Animation<Float, Spectrum>::parameters() const {
+    std::vector<std::string> result;
+    for (const Track &track : m_tracks)
+        result.push_back(track.name);
+    return result;
+}
+
+MI_VARIANT std::string Animation<Float, Spectrum>::to_string() const {
+    auto [first, last] = frame_range();
+    std::ostringstream oss;
+    oss << "Animation[" << std::endl
+        << "  frames = [" << first << ", " << last << "]," << std::endl
+        << "  parameters = [" << std::endl;
+    for (size_t i = 0; i < m_tracks.size(); ++i)
+        oss << "    \"" << m_tracks[i].name << "\" (" << m_tracks[i].frames.size()
+            << " keyframes)" << (i + 1 < m_tracks.size() ? "," : "") << std::endl;
+    oss << "  ]" << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(Animation, Object)
+MI_INSTANTIATE_CLASS(Animation)
+NAMESPACE_END(mitsuba)
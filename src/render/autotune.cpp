@@ -0,0 +1,356 @@
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/autotune.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Samples per pixel of the calibration renders
+static constexpr uint32_t MI_AUTOTUNE_SPP_SCALAR = 1;
+static constexpr uint32_t MI_AUTOTUNE_SPP_JIT    = 8;
+
+/// 64-bit FNV-1a hash, which (unlike std::hash) is stable across platforms
+static uint64_t fnv1a(const std::string &str, uint64_t hash = 0xcbf29ce484222325ull) {
+    for (char c : str) {
+        hash ^= (uint8_t) c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string AutotuneConfig::to_string() const {
+    std::ostringstream oss;
+    oss << "AutotuneConfig[";
+    if (vector_width)
+        oss << "vector_width=" << vector_width << ", ";
+    if (samples_per_pass)
+        oss << "samples_per_pass=" << samples_per_pass << ", ";
+    if (block_size)
+        oss << "block_size=" << block_size << ", ";
+    if (thread_count)
+        oss << "thread_count=" << thread_count << ", ";
+    oss << tfm::format("%.4g samples/s]", samples_per_second);
+    return oss.str();
+}
+
+MI_VARIANT Autotuner<Float, Spectrum>::Autotuner(const fs::path &cache_file,
+                                                 bool tune_thread_count,
+                                                 bool tune_vector_width)
+    : m_cache_file(cache_file.empty() ? default_cache_file() : cache_file),
+      m_tune_thread_count(tune_thread_count),
+      m_tune_vector_width(tune_vector_width && dr::is_llvm_v<Float>) { }
+
+MI_VARIANT Autotuner<Float, Spectrum>::~Autotuner() { }
+
+MI_VARIANT fs::path Autotuner<Float, Spectrum>::default_cache_file() {
+#if defined(_WIN32)
+    const char *home = std::getenv("USERPROFILE");
+#else
+    const char *home = std::getenv("HOME");
+#endif
+    fs::path dir = fs::path(home ? home : ".") / ".mitsuba";
+    return dir / "autotune.txt";
+}
+
+MI_VARIANT std::string Autotuner<Float, Spectrum>::host_key() {
+    char name[256] = "unknown";
+#if defined(_WIN32)
+    DWORD size = (DWORD) sizeof(name);
+    if (!GetComputerNameA(name, &size))
+        strcpy(name, "unknown");
+#else
+    if (gethostname(name, sizeof(name) - 1) != 0)
+        strcpy(name, "unknown");
+    name[sizeof(name) - 1] = '\0';
+#endif
+
+    std::string key = tfm::format("%s-%i", name, util::core_count());
+
+#if defined(MI_ENABLE_LLVM)
+    if constexpr (dr::is_llvm_v<Float>)
+        key += std::string("-") + jit_llvm_target_cpu();
+#endif
+
+    // The key is a single token of the cache file
+    for (char &c : key) {
+        if (std::isspace((unsigned char) c))
+            c = '_';
+    }
+    return key;
+}
+
+MI_VARIANT std::string
+Autotuner<Float, Spectrum>::scene_key(const std::string &scene_source,
+                                      const std::string &variant,
+                                      const std::string &parameters,
+                                      uint32_t sensor_index) {
+    uint64_t hash = fnv1a(scene_source);
+    hash = fnv1a(variant, hash);
+    hash = fnv1a(parameters, hash);
+    hash = fnv1a(std::to_string(sensor_index), hash);
+    return tfm::format("%016llx", (unsigned long long) hash);
+}
+
+MI_VARIANT void Autotuner<Float, Spectrum>::apply(const AutotuneConfig &config,
+                                                  Scene *scene,
+                                                  Sensor *sensor) {
+    if (config.thread_count)
+        Thread::set_thread_count(config.thread_count);
+
+#if defined(MI_ENABLE_LLVM)
+    if constexpr (dr::is_llvm_v<Float>) {
+        if (config.vector_width) {
+            std::string target_cpu = jit_llvm_target_cpu(),
+                        target_features = jit_llvm_target_features();
+            jit_llvm_set_target(target_cpu.c_str(), target_features.c_str(),
+                                config.vector_width);
+        }
+    }
+#endif
+
+    auto *integrator = dynamic_cast<SamplingIntegrator *>(scene->integrator());
+    if (!integrator)
+        return;
+
+    if (config.block_size)
+        integrator->set_block_size(config.block_size);
+
+    if (config.samples_per_pass) {
+        // Use the largest divisor of the sample count that doesn't exceed the setting
+        uint32_t spp = sensor->sampler()->sample_count(),
+                 spp_per_pass = std::min(config.samples_per_pass, spp);
+        while (spp_per_pass > 1 && spp % spp_per_pass != 0)
+            spp_per_pass--;
+        integrator->set_samples_per_pass(spp_per_pass);
+    }
+}
+
+MI_VARIANT double Autotuner<Float, Spectrum>::measure(const AutotuneConfig &config,
+                                                      Scene *scene, Sensor *sensor,
+                                                      uint32_t spp) {
+    apply(config, scene, sensor);
+    auto *integrator = static_cast<SamplingIntegrator *>(scene->integrator());
+
+    // Compile the kernels of this configuration, which isn't part of the measurement
+    if constexpr (dr::is_jit_v<Float>) {
+        integrator->set_warmup(true);
+        integrator->render(scene, sensor, 0 /* seed */, spp,
+                           false /* develop */, true /* evaluate */);
+        integrator->set_warmup(false);
+        dr::sync_thread();
+    }
+
+    Timer timer;
+    integrator->render(scene, sensor, 0 /* seed */, spp, false /* develop */,
+                       true /* evaluate */);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    double seconds = std::max((double) timer.value(), 1.0) / 1000.0;
+    ScalarVector2u size = sensor->film()->crop_size();
+    double result = (double) dr::prod(size) * spp / seconds;
+
+    AutotuneConfig measured = config;
+    measured.samples_per_second = result;
+    Log(Info, "Autotuner: %s", measured.to_string());
+    return result;
+}
+
+MI_VARIANT AutotuneConfig Autotuner<Float, Spectrum>::tune(Scene *scene,
+                                                           Sensor *sensor,
+                                                           const std::string &scene_key) {
+    auto *integrator = dynamic_cast<SamplingIntegrator *>(scene->integrator());
+    if (!integrator)
+        Throw("Autotuner: the integrator \"%s\" is not supported, only "
+              "sampling integrators can be tuned!",
+              scene->integrator() ? scene->integrator()->class_()->name() : "none");
+
+    std::string key = host_key() + " " + scene_key;
+    AutotuneConfig best;
+    if (load(key, best)) {
+        Log(Info, "Autotuner: using the cached settings %s.", best.to_string());
+        apply(best, scene, sensor);
+        return best;
+    }
+
+    // Settings of the integrator that are restored before applying the result
+    uint32_t sample_count = sensor->sampler()->sample_count(),
+             block_size = integrator->block_size(),
+             samples_per_pass = integrator->samples_per_pass();
+
+    uint32_t thread_count = (uint32_t) Thread::thread_count(),
+             spp = dr::is_jit_v<Float> ? MI_AUTOTUNE_SPP_JIT : MI_AUTOTUNE_SPP_SCALAR;
+
+    /* The candidates of every setting, starting with the current value.
+       Settings are explored one at a time, keeping the best value of the
+       previous ones, which needs far fewer calibration renders than the
+       full grid. */
+    std::vector<std::vector<uint32_t>> candidates(4);
+    AutotuneConfig config;
+    config.thread_count = thread_count;
+    if (m_tune_thread_count && thread_count >= 4)
+        candidates[3] = { thread_count, thread_count / 2 };
+
+    if constexpr (dr::is_jit_v<Float>) {
+        config.samples_per_pass = spp;
+        candidates[1] = { spp, 4, 2, 1 };
+#if defined(MI_ENABLE_LLVM)
+        if constexpr (dr::is_llvm_v<Float>) {
+            config.vector_width = jit_llvm_vector_width();
+            if (m_tune_vector_width) {
+                candidates[0] = { config.vector_width, 2 * config.vector_width };
+                if (config.vector_width > 4)
+                    candidates[0].push_back(config.vector_width / 2);
+            }
+        }
+#endif
+    } else {
+        config.block_size = block_size ? block_size : 32;
+        candidates[2] = { config.block_size, 8, 16, 32, 64 };
+    }
+
+    Log(Info, "Autotuner: calibrating the settings of the scene (%u samples "
+              "per pixel per configuration) ..", spp);
+
+    std::vector<std::string> visited;
+    auto evaluate = [&](const AutotuneConfig &c) {
+        std::string id = c.to_string();
+        for (const std::string &v : visited)
+            if (v == id)
+                return;
+        visited.push_back(id);
+
+        AutotuneConfig c2 = c;
+        c2.samples_per_second = measure(c, scene, sensor, spp);
+        if (c2.samples_per_second > best.samples_per_second)
+            best = c2;
+    };
+
+    best = config;
+    evaluate(config);
+
+    uint32_t AutotuneConfig::*fields[4] = {
+        &AutotuneConfig::vector_width, &AutotuneConfig::samples_per_pass,
+        &AutotuneConfig::block_size, &AutotuneConfig::thread_count
+    };
+
+    for (size_t i = 0; i < 4; ++i) {
+        AutotuneConfig base = best;
+        for (uint32_t value : candidates[i]) {
+            AutotuneConfig c = base;
+            c.*fields[i] = value;
+            c.samples_per_second = 0.0;
+            evaluate(c);
+        }
+    }
+
+    // Restore the original settings before applying the best ones
+    sensor->sampler()->set_sample_count(sample_count);
+    integrator->set_block_size(block_size);
+    integrator->set_samples_per_pass(samples_per_pass);
+    apply(best, scene, sensor);
+
+    Log(Info, "Autotuner: the fastest settings are %s.", best.to_string());
+    try {
+        store(key, best);
+    } catch (const std::exception &e) {
+        Log(Warn, "Autotuner: could not update the cache file \"%s\": %s",
+            m_cache_file.string(), e.what());
+    }
+
+    return best;
+}
+
+MI_VARIANT bool Autotuner<Float, Spectrum>::load(const std::string &key,
+                                                 AutotuneConfig &config) const {
+    std::ifstream is(m_cache_file.native());
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream iss(line);
+        std::string host, scene;
+        AutotuneConfig c;
+        if (!(iss >> host >> scene >> c.vector_width >> c.samples_per_pass >>
+              c.block_size >> c.thread_count >> c.samples_per_second))
+            continue; // Ignore malformed entries
+
+        if (host + " " + scene == key) {
+            config = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+MI_VARIANT void Autotuner<Float, Spectrum>::store(const std::string &key,
+                                                  const AutotuneConfig &config) const {
+    std::vector<std::string> lines;
+    /* read existing entries */ {
+        std::ifstream is(m_cache_file.native());
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.compare(0, key.size() + 1, key + " ") != 0)
+                lines.push_back(line);
+        }
+    }
+
+    if (lines.empty())
+        lines.push_back("# host  scene  vector_width  samples_per_pass  "
+                        "block_size  threads  samples/s");
+    lines.push_back(tfm::format("%s %u %u %u %u %.6g", key, config.vector_width,
+                                config.samples_per_pass, config.block_size,
+                                config.thread_count, config.samples_per_second));
+
+    fs::path dir = m_cache_file.parent_path();
+    if (!dir.empty() && !fs::exists(dir) && !fs::create_directory(dir))
+        Throw("could not create the directory \"%s\"", dir.string());
+
+    // Write to a temporary file first, so that concurrent runs never read partial files
+    fs::path tmp = m_cache_file;
+    tmp.replace_extension(".tmp");
+    /* write */ {
+        std::ofstream os(tmp.native());
+        for (const std::string &line : lines)
+            os << line << std::endl;
+        if (!os)
+            Throw("could not write \"%s\"", tmp.string());
+    }
+
+    if (!fs::rename(tmp, m_cache_file))
+        Throw("could not rename \"%s\"", tmp.string());
+
+    Log(Debug, "Autotuner: stored the settings in \"%s\".", m_cache_file.string());
+}
+
+MI_VARIANT std::string Autotuner<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "Autotuner[" << std::endl
+        << "  cache_file = \"" << m_cache_file << "\"," << std::endl
+        << "  tune_thread_count = " << m_tune_thread_count << "," << std::endl
+        << "  tune_vector_width = " << m_tune_vector_width << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(Autotuner, Object)
+MI_INSTANTIATE_CLASS(Autotuner)
+NAMESPACE_END(mitsuba)
@@ -40,6 +40,32 @@ MI_VARIANT Spectrum BSDF<Float, Spectrum>::eval_diffuse_reflectance(
     return eval(ctx, si, wo, active) * dr::Pi<Float>;
 }
 
+MI_VARIANT std::string BSDF<Float, Spectrum>::merge_key() const {
+    return "";
+}
+
+MI_VARIANT ref<BSDF<Float, Spectrum>>
+BSDF<Float, Spectrum>::merge(const std::vector<ref<BSDF>> & /* instances */) const {
+    return nullptr;
+}
+
+MI_VARIANT ref<BSDF<Float, Spectrum>> BSDF<Float, Spectrum>::flatten() {
+    return this;
+}
+
+MI_VARIANT const typename BSDF<Float, Spectrum>::Texture *
+BSDF<Float, Spectrum>::opacity_texture() const {
+    return nullptr;
+}
+
+MI_VARIANT uint32_t BSDF<Float, Spectrum>::ray_flags() const {
+    uint32_t flags = RayFlags::Minimal | RayFlags::ShadingFrame;
+    if (has_flag(m_flags, BSDFFlags::Anisotropic) ||
+        has_flag(m_flags, BSDFFlags::NeedsDifferentials))
+        flags |= RayFlags::UV | RayFlags::dPdUV;
+    return flags;
+}
+
 template <typename Index>
 std::string type_mask_to_string(Index type_mask) {
     std::ostringstream oss;
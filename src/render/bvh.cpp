@@ -0,0 +1,437 @@
+#include <mitsuba/render/bvh.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MI_VARIANT ShapeBVH<Float, Spectrum>::ShapeBVH(const Properties &props) {
+    /* BVH construction: Number of bins used to evaluate the surface area
+       heuristic along each axis */
+    m_bin_count = props.get<uint32_t>("bvh_bins", 16);
+
+    /* BVH construction: A node containing this many or fewer primitives
+       becomes a leaf when this is cheaper according to the SAH */
+    m_max_leaf_size = props.get<uint32_t>("bvh_max_leaf_size", 8);
+
+    /* BVH construction: Relative cost of a shape intersection operation in
+       the surface area heuristic. */
+    m_intersection_cost = props.get<ScalarFloat>("bvh_intersection_cost", 1.f);
+
+    /* BVH construction: Relative cost of a BVH traversal operation in the
+       surface area heuristic. */
+    m_traversal_cost = props.get<ScalarFloat>("bvh_traversal_cost", 1.f);
+
+    if (m_bin_count < 2)
+        Throw("\"bvh_bins\" must be at least 2!");
+    if (m_max_leaf_size < 1)
+        Throw("\"bvh_max_leaf_size\" must be at least 1!");
+
+    m_primitive_map.push_back(0);
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::clear() {
+    m_shapes.clear();
+    m_primitive_map.clear();
+    m_primitive_map.push_back(0);
+    m_bbox.reset();
+    m_nodes.clear();
+    m_nodes.shrink_to_fit();
+    m_indices.clear();
+    m_indices.shrink_to_fit();
+    m_instances.clear();
+    m_instance_index.clear();
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::add_shape(Shape *shape) {
+    Assert(!ready());
+    m_primitive_map.push_back(m_primitive_map.back() +
+                              shape->primitive_count());
+    m_shapes.push_back(shape);
+    m_bbox.expand(shape->bbox());
+}
+
+MI_VARIANT std::vector<typename ShapeBVH<Float, Spectrum>::ScalarBoundingBox3f>
+ShapeBVH<Float, Spectrum>::primitive_bboxes() const {
+    Size prim_count = primitive_count();
+    std::vector<ScalarBoundingBox3f> result(prim_count);
+
+    dr::parallel_for(
+        dr::blocked_range<Size>(0u, prim_count, 4096u),
+        [&](const dr::blocked_range<Size> &range) {
+            for (Size i = range.begin(); i != range.end(); ++i)
+                result[i] = bbox(i);
+        }
+    );
+
+    return result;
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::build() {
+    Timer timer;
+    Size prim_count = primitive_count();
+    Log(Info, "Building a SAH BVH (%i primitives) ..", prim_count);
+
+    m_nodes.clear();
+    m_indices.resize(prim_count);
+
+    if (prim_count == 0) {
+        Log(Info, "Finished. (empty BVH)");
+        return;
+    }
+
+    std::vector<ScalarBoundingBox3f> prim_bbox = primitive_bboxes();
+    std::vector<ScalarPoint3f> centroids(prim_count);
+    for (Size i = 0; i < prim_count; ++i) {
+        m_indices[i] = i;
+        centroids[i] = prim_bbox[i].center();
+    }
+
+    // Build a binary hierarchy and collapse it into four-wide nodes
+    prepare_instances();
+
+    std::vector<BuildNode> nodes;
+    nodes.reserve(2 * (prim_count / std::max(m_max_leaf_size / 2, 1u)) + 1);
+    Index root = build_recursive(nodes, prim_bbox, centroids, 0, prim_count, 0);
+
+    m_nodes.reserve(nodes.size() / 2 + 1);
+    if (nodes[root].count > 0) {
+        // Degenerate case: the whole hierarchy consists of a single leaf
+        Node node;
+        for (size_t k = 0; k < 3; ++k) {
+            node.bbox_min[k] = dr::Infinity<ScalarFloat>;
+            node.bbox_max[k] = -dr::Infinity<ScalarFloat>;
+            node.bbox_min[k][0] = nodes[root].bbox.min[k];
+            node.bbox_max[k][0] = nodes[root].bbox.max[k];
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            node.child[i] = (Index) -1;
+            node.count[i] = 0;
+        }
+        node.child[0] = nodes[root].offset;
+        node.count[0] = nodes[root].count;
+        m_nodes.push_back(node);
+    } else {
+        collapse(nodes, root);
+    }
+    m_nodes.shrink_to_fit();
+
+    Log(Info, "Finished. (%s of storage, took %s)",
+        util::mem_string(m_indices.size() * sizeof(Index) +
+                         m_nodes.size() * sizeof(Node)),
+        util::time_string((float) timer.value())
+    );
+}
+
+MI_VARIANT typename ShapeBVH<Float, Spectrum>::Index
+ShapeBVH<Float, Spectrum>::build_recursive(
+    std::vector<BuildNode> &nodes,
+    const std::vector<ScalarBoundingBox3f> &prim_bbox,
+    const std::vector<ScalarPoint3f> &centroids, Index begin, Index end,
+    uint32_t depth) {
+    /// Bin of the surface area heuristic
+    struct Bin {
+        ScalarBoundingBox3f bbox;
+        Size count = 0;
+    };
+
+    Size count = end - begin;
+
+    ScalarBoundingBox3f bbox, centroid_bbox;
+    for (Index i = begin; i < end; ++i) {
+        bbox.expand(prim_bbox[m_indices[i]]);
+        centroid_bbox.expand(centroids[m_indices[i]]);
+    }
+
+    Index node_index = (Index) nodes.size();
+    nodes.push_back({ bbox, 0, 0, begin, count });
+
+    // Leaf cost for the surface area heuristic
+    ScalarFloat leaf_cost = count * m_intersection_cost;
+
+    if (count <= 1 || depth + 1 >= MI_BVH_MAXDEPTH)
+        return node_index;
+
+    ScalarVector3f extents = centroid_bbox.extents();
+    ScalarFloat inv_area = 1.f / dr::maximum(bbox.surface_area(),
+                                             dr::Epsilon<ScalarFloat>);
+
+    // Find the best split among the bin boundaries along all axes
+    ScalarFloat best_cost = dr::Infinity<ScalarFloat>;
+    uint32_t best_axis = 0, best_bin = 0;
+    std::unique_ptr<Bin[]> bins(new Bin[m_bin_count]);
+    std::unique_ptr<ScalarFloat[]> right_cost(new ScalarFloat[m_bin_count]);
+
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        if (!(extents[axis] > 0.f))
+            continue;
+
+        for (uint32_t b = 0; b < m_bin_count; ++b)
+            bins[b] = Bin();
+
+        ScalarFloat scale = m_bin_count / extents[axis],
+                    start = centroid_bbox.min[axis];
+        for (Index i = begin; i < end; ++i) {
+            Index prim = m_indices[i];
+            uint32_t b = std::min(
+                (uint32_t) ((centroids[prim][axis] - start) * scale),
+                m_bin_count - 1);
+            bins[b].bbox.expand(prim_bbox[prim]);
+            bins[b].count++;
+        }
+
+        // Sweep from the right to compute the cost of the right partitions
+        ScalarBoundingBox3f acc;
+        Size acc_count = 0;
+        for (uint32_t b = m_bin_count - 1; b > 0; --b) {
+            acc.expand(bins[b].bbox);
+            acc_count += bins[b].count;
+            right_cost[b] = acc_count > 0 ? acc.surface_area() * acc_count : 0.f;
+        }
+
+        // .. and from the left to find the cheapest split
+        acc.reset();
+        acc_count = 0;
+        for (uint32_t b = 0; b + 1 < m_bin_count; ++b) {
+            acc.expand(bins[b].bbox);
+            acc_count += bins[b].count;
+            if (acc_count == 0 || acc_count == count)
+                continue;
+            ScalarFloat cost =
+                m_traversal_cost +
+                m_intersection_cost * inv_area *
+                    (acc.surface_area() * acc_count + right_cost[b + 1]);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = b;
+            }
+        }
+    }
+
+    bool found_split = best_cost != dr::Infinity<ScalarFloat>;
+    if (count <= m_max_leaf_size && (!found_split || leaf_cost <= best_cost))
+        return node_index;
+
+    Index *indices = m_indices.data();
+    Index mid;
+    if (found_split) {
+        ScalarFloat scale = m_bin_count / extents[best_axis],
+                    start = centroid_bbox.min[best_axis];
+        mid = (Index) (std::partition(
+                           indices + begin, indices + end,
+                           [&](Index prim) {
+                               uint32_t b = std::min(
+                                   (uint32_t) ((centroids[prim][best_axis] - start) * scale),
+                                   m_bin_count - 1);
+                               return b <= best_bin;
+                           }) - indices);
+    } else {
+        // All centroids coincide: fall back to an object median split
+        mid = begin + count / 2;
+    }
+
+    if (mid == begin || mid == end)
+        mid = begin + count / 2;
+
+    Index left  = build_recursive(nodes, prim_bbox, centroids, begin, mid, depth + 1),
+          right = build_recursive(nodes, prim_bbox, centroids, mid, end, depth + 1);
+
+    BuildNode &node = nodes[node_index];
+    node.left  = left;
+    node.right = right;
+    node.count = 0;
+
+    return node_index;
+}
+
+MI_VARIANT typename ShapeBVH<Float, Spectrum>::Index
+ShapeBVH<Float, Spectrum>::collapse(const std::vector<BuildNode> &nodes,
+                                    Index index) {
+    Index result = (Index) m_nodes.size();
+    m_nodes.emplace_back();
+
+    // Gather up to four children by opening the largest inner nodes
+    Index children[4] = { nodes[index].left, nodes[index].right, 0, 0 };
+    uint32_t child_count = 2;
+    while (child_count < 4) {
+        int32_t best = -1;
+        ScalarFloat best_area = -1.f;
+        for (uint32_t i = 0; i < child_count; ++i) {
+            const BuildNode &c = nodes[children[i]];
+            if (c.count == 0 && c.bbox.surface_area() > best_area) {
+                best = (int32_t) i;
+                best_area = c.bbox.surface_area();
+            }
+        }
+        if (best < 0)
+            break;
+        Index opened = children[best];
+        children[best] = nodes[opened].left;
+        children[child_count++] = nodes[opened].right;
+    }
+
+    Node node;
+    for (size_t k = 0; k < 3; ++k) {
+        node.bbox_min[k] = dr::Infinity<ScalarFloat>;
+        node.bbox_max[k] = -dr::Infinity<ScalarFloat>;
+    }
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i >= child_count) {
+            node.child[i] = (Index) -1;
+            node.count[i] = 0;
+            continue;
+        }
+
+        const BuildNode &c = nodes[children[i]];
+        for (size_t k = 0; k < 3; ++k) {
+            node.bbox_min[k][i] = c.bbox.min[k];
+            node.bbox_max[k][i] = c.bbox.max[k];
+        }
+
+        if (c.count > 0) {
+            node.child[i] = c.offset;
+            node.count[i] = c.count;
+        } else {
+            node.child[i] = collapse(nodes, children[i]);
+            node.count[i] = 0;
+        }
+    }
+
+    // 'm_nodes' may have been reallocated by the recursive calls
+    m_nodes[result] = node;
+    return result;
+}
+
+MI_VARIANT typename ShapeBVH<Float, Spectrum>::ScalarFloat
+ShapeBVH<Float, Spectrum>::sah_cost() const {
+    if (m_nodes.empty())
+        return 0.f;
+
+    /* Every child is visited with a probability proportional to its surface
+       area. Each node is referenced by exactly one parent, hence the nodes
+       can be processed in any order (the root is always visited). */
+    double area_rcp = 1.0 / (double) m_bbox.surface_area(),
+           cost     = m_traversal_cost;
+    for (const Node &node : m_nodes) {
+        for (size_t i = 0; i < 4; ++i) {
+            if (node.child[i] == (Index) -1)
+                continue;
+            ScalarBoundingBox3f bbox(
+                ScalarPoint3f(node.bbox_min[0][i], node.bbox_min[1][i], node.bbox_min[2][i]),
+                ScalarPoint3f(node.bbox_max[0][i], node.bbox_max[1][i], node.bbox_max[2][i]));
+            ScalarFloat weight = node.count[i] > 0
+                                     ? m_intersection_cost * node.count[i]
+                                     : m_traversal_cost;
+            cost += weight * bbox.surface_area() * area_rcp;
+        }
+    }
+    return (ScalarFloat) cost;
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::refit() {
+    if (m_nodes.empty())
+        return;
+
+    ScopedPhase phase(ProfilerPhase::InitAccel);
+    Timer timer;
+
+    std::vector<ScalarBoundingBox3f> prim_bbox = primitive_bboxes();
+
+    // Update leaf children in parallel
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, m_nodes.size(), 1024),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t n = range.begin(); n != range.end(); ++n) {
+                Node &node = m_nodes[n];
+                for (uint32_t i = 0; i < 4; ++i) {
+                    if (node.count[i] == 0)
+                        continue;
+                    ScalarBoundingBox3f bbox;
+                    for (Index j = node.child[i]; j < node.child[i] + node.count[i]; ++j)
+                        bbox.expand(prim_bbox[m_indices[j]]);
+                    for (size_t k = 0; k < 3; ++k) {
+                        node.bbox_min[k][i] = bbox.min[k];
+                        node.bbox_max[k][i] = bbox.max[k];
+                    }
+                }
+            }
+        }
+    );
+
+    // Children are stored after their parents, propagate bounds bottom-up
+    for (size_t n = m_nodes.size(); n-- > 0; ) {
+        Node &node = m_nodes[n];
+        for (uint32_t i = 0; i < 4; ++i) {
+            if (node.count[i] != 0 || node.child[i] == (Index) -1)
+                continue;
+            const Node &child = m_nodes[node.child[i]];
+            for (size_t k = 0; k < 3; ++k) {
+                node.bbox_min[k][i] = dr::min(child.bbox_min[k]);
+                node.bbox_max[k][i] = dr::max(child.bbox_max[k]);
+            }
+        }
+    }
+
+    m_bbox.reset();
+    for (Shape *shape : m_shapes)
+        m_bbox.expand(shape->bbox());
+
+    // The transformations of the instances may have changed
+    prepare_instances();
+
+    Log(Debug, "Refit BVH with %zu nodes (took %s)", m_nodes.size(),
+        util::time_string((float) timer.value()));
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::prepare_instances() {
+    m_instances.clear();
+    m_instance_index.clear();
+
+#if !defined(MI_ENABLE_EMBREE)
+    for (Size i = 0; i < shape_count(); ++i) {
+        const ShapeGroup<Float, Spectrum> *shapegroup =
+            m_shapes[i]->instanced_shapegroup();
+        if (!shapegroup)
+            continue;
+
+        if (m_instance_index.empty())
+            m_instance_index.resize(shape_count(), (Index) -1);
+        m_instance_index[i] = (Index) m_instances.size();
+
+        const ScalarTransform4f &to_object = m_shapes[i]->to_object_scalar();
+        InstanceRecord inst;
+        for (size_t col = 0; col < 4; ++col) {
+            alignas(alignof(FloatP)) ScalarFloat column[4];
+            for (size_t row = 0; row < 3; ++row)
+                column[row] = to_object.matrix.entry(row, col);
+            column[3] = 0.f;
+            inst.to_object[col] = dr::load_aligned<FloatP>(column);
+        }
+        inst.shapegroup = shapegroup;
+        m_instances.push_back(inst);
+    }
+
+    if (!m_instances.empty())
+        Log(Debug, "Two-level traversal of %zu instances", m_instances.size());
+#endif
+}
+
+MI_VARIANT std::string ShapeBVH<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "ShapeBVH[" << std::endl
+        << "  nodes = " << m_nodes.size() << "," << std::endl
+        << "  shapes = [" << std::endl;
+    for (auto shape : m_shapes)
+        oss << "    " << string::indent(shape, 4)
+            << "," << std::endl;
+    oss << "  ]" << std::endl << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(ShapeBVH, Object)
+MI_INSTANTIATE_CLASS(ShapeBVH)
+NAMESPACE_END(mitsuba)
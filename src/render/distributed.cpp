@@ -0,0 +1,492 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/distributed.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/spiral.h>
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Identifies the protocol spoken between coordinator and workers
+static constexpr uint32_t MI_DISTRIBUTED_MAGIC   = 0x5244494D; // "MIDR"
+static constexpr uint32_t MI_DISTRIBUTED_VERSION = 1;
+
+/// Messages exchanged after the job description
+enum class Message : uint32_t {
+    /// Worker -> coordinator: scene loaded (thread count, channel count)
+    Ready = 1,
+    /// Coordinator -> worker: render a tile
+    Tile = 2,
+    /// Worker -> coordinator: rendered block of a tile
+    Block = 3,
+    /// Coordinator -> worker: no more tiles
+    Done = 4,
+    /// Worker -> coordinator: the job failed (error message)
+    Error = 5
+};
+
+/// A tile request, as produced by \ref Spiral::next_tile()
+struct TileRequest {
+    uint32_t id;
+    int32_t offset[2];
+    uint32_t size[2];
+    uint32_t block_id;
+    uint32_t block_size;
+};
+
+static Message read_message(Stream *stream) {
+    uint32_t message = 0;
+    stream->read(message);
+    return (Message) message;
+}
+
+static void write_tile(Stream *stream, const TileRequest &tile) {
+    stream->write((uint32_t) Message::Tile);
+    stream->write(tile.id);
+    stream->write_array(tile.offset, 2);
+    stream->write_array(tile.size, 2);
+    stream->write(tile.block_id);
+    stream->write(tile.block_size);
+}
+
+static TileRequest read_tile(Stream *stream) {
+    TileRequest tile;
+    stream->read(tile.id);
+    stream->read_array(tile.offset, 2);
+    stream->read_array(tile.size, 2);
+    stream->read(tile.block_id);
+    stream->read(tile.block_size);
+    return tile;
+}
+
+// -----------------------------------------------------------------------------
+
+RenderJob RenderJob::from_file(const fs::path &filename,
+                               const std::string &variant,
+                               const xml::ParameterList &parameters,
+                               uint32_t sensor_index) {
+    std::ifstream is(filename.native(), std::ios::binary);
+    if (!is.good())
+        Throw("RenderJob: could not open \"%s\"!", filename.string());
+    std::ostringstream oss;
+    oss << is.rdbuf();
+
+    RenderJob job;
+    job.variant = variant;
+    job.scene = oss.str();
+    job.scene_dir = fs::absolute(filename).parent_path();
+    job.parameters = parameters;
+    job.sensor_index = sensor_index;
+    return job;
+}
+
+void RenderJob::write(Stream *stream) const {
+    stream->write(MI_DISTRIBUTED_MAGIC);
+    stream->write(MI_DISTRIBUTED_VERSION);
+    stream->write(variant);
+    stream->write(scene);
+    stream->write(scene_dir.string());
+    stream->write((uint32_t) parameters.size());
+    for (auto &[key, value, used] : parameters) {
+        stream->write(key);
+        stream->write(value);
+    }
+    stream->write(sensor_index);
+    stream->write(seed);
+    stream->write(spp);
+}
+
+RenderJob RenderJob::read(Stream *stream) {
+    uint32_t magic = 0, version = 0;
+    stream->read(magic);
+    stream->read(version);
+    if (magic != MI_DISTRIBUTED_MAGIC)
+        Throw("RenderJob: invalid message, the peer is not a Mitsuba coordinator!");
+    if (version != MI_DISTRIBUTED_VERSION)
+        Throw("RenderJob: incompatible protocol version %u (expected %u)!",
+              version, MI_DISTRIBUTED_VERSION);
+
+    RenderJob job;
+    std::string scene_dir;
+    uint32_t parameter_count = 0;
+    stream->read(job.variant);
+    stream->read(job.scene);
+    stream->read(scene_dir);
+    job.scene_dir = scene_dir;
+    stream->read(parameter_count);
+    for (uint32_t i = 0; i < parameter_count; ++i) {
+        std::string key, value;
+        stream->read(key);
+        stream->read(value);
+        job.parameters.emplace_back(key, value, false);
+    }
+    stream->read(job.sensor_index);
+    stream->read(job.seed);
+    stream->read(job.spp);
+    return job;
+}
+
+// -----------------------------------------------------------------------------
+
+/// Prepare a sensor for rendering and return the seed as used by render()
+template <typename Film>
+static uint32_t prepare_film(Film *film, const std::vector<std::string> &aovs,
+                             uint32_t seed) {
+    film->prepare(aovs);
+    auto film_size = film->crop_size();
+    if (film->sample_border())
+        film_size += 2 * film->rfilter()->border_size();
+    return seed * dr::prod(film_size);
+}
+
+MI_VARIANT RenderWorker<Float, Spectrum>::RenderWorker(SocketStream *stream,
+                                                      const RenderJob &job)
+    : m_stream(stream), m_job(job) {
+    if constexpr (dr::is_jit_v<Float>)
+        Throw("RenderWorker: only scalar variants are supported!");
+
+    try {
+        // Resolve relative paths within the scene like the coordinator does
+        ref<FileResolver> fr = new FileResolver(*Thread::thread()->file_resolver());
+        if (!fr->contains(job.scene_dir))
+            fr->append(job.scene_dir);
+        Thread::thread()->set_file_resolver(fr);
+
+        std::vector<ref<Object>> objects =
+            xml::load_string(job.scene, job.variant, job.parameters);
+        if (objects.size() != 1 || !(m_scene = dynamic_cast<Scene *>(objects[0].get())))
+            Throw("The job does not describe a single <scene>!");
+        if (job.sensor_index >= m_scene->sensors().size())
+            Throw("Sensor index %u is out of bounds!", job.sensor_index);
+
+        m_sensor = m_scene->sensors()[job.sensor_index];
+        m_integrator = dynamic_cast<SamplingIntegrator *>(m_scene->integrator());
+        if (!m_integrator)
+            Throw("Only sampling integrators can render in distributed mode!");
+
+        if (job.spp)
+            m_sensor->sampler()->set_sample_count(job.spp);
+        m_job.spp = m_sensor->sampler()->sample_count();
+        m_seed = prepare_film(m_sensor->film(), m_integrator->aov_names(), job.seed);
+    } catch (const std::exception &e) {
+        m_stream->write((uint32_t) Message::Error);
+        m_stream->write(std::string(e.what()));
+        throw;
+    }
+
+    ref<ImageBlock> block = m_sensor->film()->create_block(ScalarVector2u(1));
+    m_stream->write((uint32_t) Message::Ready);
+    m_stream->write((uint32_t) Thread::thread_count());
+    m_stream->write((uint32_t) block->channel_count());
+}
+
+MI_VARIANT RenderWorker<Float, Spectrum>::~RenderWorker() { }
+
+MI_VARIANT void RenderWorker<Float, Spectrum>::run() {
+    std::deque<TileRequest> queue;
+    std::mutex queue_mutex, write_mutex;
+    std::condition_variable queue_cv;
+    bool done = false, failed = false;
+    std::string error;
+
+    Film *film = m_sensor->film();
+    uint32_t thread_count = (uint32_t) Thread::thread_count();
+    ThreadEnvironment env;
+    std::vector<std::thread> threads;
+
+    for (uint32_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, env]() mutable {
+            ScopedSetThreadEnvironment set_env(env);
+            ref<Sampler> sampler = m_sensor->sampler()->fork();
+            ref<ImageBlock> block = film->create_block(
+                ScalarVector2u(MI_BLOCK_SIZE), false /* normalize */,
+                true /* border */);
+
+            while (true) {
+                TileRequest tile;
+                /* locked */ {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    queue_cv.wait(lock, [&] { return done || !queue.empty(); });
+                    if (queue.empty())
+                        break;
+                    tile = queue.front();
+                    queue.pop_front();
+                }
+
+                block->set_size(ScalarVector2u(tile.size[0], tile.size[1]));
+                block->set_offset(ScalarPoint2i(tile.offset[0], tile.offset[1]));
+                m_integrator->render_tile(m_scene, m_sensor, sampler, block,
+                                          m_seed, m_job.spp, tile.block_id,
+                                          tile.block_size);
+
+                const TensorXf &tensor = block->tensor();
+                std::lock_guard<std::mutex> guard(write_mutex);
+                if (failed)
+                    continue;
+                try {
+                    m_stream->write((uint32_t) Message::Block);
+                    m_stream->write(tile.id);
+                    m_stream->write((uint64_t) tensor.size());
+                    m_stream->write_array(tensor.data(), tensor.size());
+                } catch (const std::exception &e) {
+                    failed = true;
+                    error = e.what();
+                }
+            }
+        });
+    }
+
+    // Receive tile requests until the coordinator is done
+    try {
+        while (true) {
+            Message message = read_message(m_stream);
+            if (message == Message::Done)
+                break;
+            if (message != Message::Tile)
+                Throw("RenderWorker: unexpected message %u!", (uint32_t) message);
+            TileRequest tile = read_tile(m_stream);
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(tile);
+            queue_cv.notify_one();
+        }
+    } catch (const std::exception &e) {
+        std::lock_guard<std::mutex> guard(write_mutex);
+        failed = true;
+        error = e.what();
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.clear();
+    }
+
+    /* locked */ {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        done = true;
+    }
+    queue_cv.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+
+    m_stream->close();
+    if (failed)
+        Throw("RenderWorker: lost the connection to the coordinator: %s", error);
+}
+
+// -----------------------------------------------------------------------------
+
+MI_VARIANT RenderCoordinator<Float, Spectrum>::RenderCoordinator(
+    Scene *scene, const RenderJob &job, const std::vector<std::string> &workers)
+    : m_scene(scene), m_job(job), m_workers(workers) { }
+
+MI_VARIANT RenderCoordinator<Float, Spectrum>::~RenderCoordinator() { }
+
+MI_VARIANT void RenderCoordinator<Float, Spectrum>::render() {
+    if constexpr (dr::is_jit_v<Float>) {
+        Throw("RenderCoordinator: only scalar variants are supported!");
+    } else {
+        if (m_job.sensor_index >= m_scene->sensors().size())
+            Throw("Specified sensor index is out of bounds!");
+        Sensor *sensor = m_scene->sensors()[m_job.sensor_index];
+        Film *film = sensor->film();
+        auto *integrator = dynamic_cast<SamplingIntegrator *>(m_scene->integrator());
+        if (!integrator)
+            Throw("Only sampling integrators can render in distributed mode!");
+
+        if (m_job.spp)
+            sensor->sampler()->set_sample_count(m_job.spp);
+        m_job.spp = sensor->sampler()->sample_count();
+        uint32_t seed = prepare_film(film, integrator->aov_names(), m_job.seed);
+
+        ScalarVector2u film_size = film->crop_size();
+        ScalarVector2i border_offset(0);
+        if (film->sample_border()) {
+            film_size += 2 * film->rfilter()->border_size();
+            border_offset = ScalarVector2i((int32_t) film->rfilter()->border_size());
+        }
+
+        Spiral spiral(film_size, film->crop_offset(), MI_BLOCK_SIZE, 1);
+        size_t channels = film->create_block(ScalarVector2u(1))->channel_count();
+
+        // Tiles given back by lost workers, handed out before new ones
+        std::deque<TileRequest> retry;
+        std::mutex mutex;
+        uint32_t next_id = 0;
+
+        auto next_tile = [&](TileRequest &tile) -> bool {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!retry.empty()) {
+                tile = retry.front();
+                retry.pop_front();
+                return true;
+            }
+            auto [offset, size, block_id, block_size] = spiral.next_tile();
+            if (dr::prod(size) == 0)
+                return false;
+            offset -= border_offset;
+            tile = TileRequest{ next_id++, { offset.x(), offset.y() },
+                                { size.x(), size.y() }, block_id, block_size };
+            return true;
+        };
+
+        ref<ProgressReporter> progress;
+        Logger *logger = mitsuba::Thread::thread()->logger();
+        if (logger && Info >= logger->log_level())
+            progress = new ProgressReporter("Rendering");
+        uint64_t pixels_done = 0, pixels_total = dr::prod(film_size);
+
+        auto tile_done = [&](const TileRequest &tile) {
+            if (!progress)
+                return;
+            std::lock_guard<std::mutex> lock(mutex);
+            pixels_done += (uint64_t) tile.size[0] * tile.size[1];
+            progress->update(pixels_done / (float) pixels_total);
+        };
+
+        Log(Info, "Starting distributed render job (%ux%u, %u sample%s, %zu worker%s)",
+            film_size.x(), film_size.y(), m_job.spp, m_job.spp == 1 ? "" : "s",
+            m_workers.size(), m_workers.size() == 1 ? "" : "s");
+        Timer timer;
+
+        ThreadEnvironment env;
+        std::vector<std::thread> threads;
+        for (const std::string &address : m_workers) {
+            threads.emplace_back([&, env, address]() mutable {
+                ScopedSetThreadEnvironment set_env(env);
+                std::unordered_map<uint32_t, TileRequest> in_flight;
+                ref<SocketStream> stream;
+
+                try {
+                    auto sep = address.rfind(':');
+                    if (sep == std::string::npos)
+                        Throw("expected an address of the form host:port");
+                    stream = new SocketStream(address.substr(0, sep),
+                                              (uint16_t) std::stoi(address.substr(sep + 1)));
+                    m_job.write(stream);
+
+                    Message message = read_message(stream);
+                    if (message == Message::Error) {
+                        std::string error;
+                        stream->read(error);
+                        Throw("the worker could not load the scene: %s", error);
+                    }
+
+                    uint32_t worker_threads = 0, worker_channels = 0;
+                    stream->read(worker_threads);
+                    stream->read(worker_channels);
+                    if (message != Message::Ready || worker_channels != channels)
+                        Throw("the worker's scene does not match (wrong channel count)");
+
+                    Log(Info, "Connected to worker %s (%u threads).",
+                        stream->peer(), worker_threads);
+
+                    ref<ImageBlock> block = film->create_block(
+                        ScalarVector2u(MI_BLOCK_SIZE), false /* normalize */,
+                        true /* border */);
+
+                    // Keep two tiles per worker thread in flight to hide latency
+                    size_t max_in_flight = 2 * (size_t) std::max(worker_threads, 1u);
+                    while (true) {
+                        TileRequest tile;
+                        while (in_flight.size() < max_in_flight && next_tile(tile)) {
+                            write_tile(stream, tile);
+                            in_flight[tile.id] = tile;
+                        }
+                        if (in_flight.empty())
+                            break;
+
+                        message = read_message(stream);
+                        if (message != Message::Block)
+                            Throw("unexpected message %u", (uint32_t) message);
+
+                        uint32_t id = 0;
+                        uint64_t count = 0;
+                        stream->read(id);
+                        stream->read(count);
+                        auto it = in_flight.find(id);
+                        if (it == in_flight.end())
+                            Throw("received an unknown tile");
+                        tile = it->second;
+
+                        block->set_size(ScalarVector2u(tile.size[0], tile.size[1]));
+                        block->set_offset(ScalarPoint2i(tile.offset[0], tile.offset[1]));
+                        if (count != block->tensor().size())
+                            Throw("received a block of the wrong size");
+                        stream->read_array(block->tensor().data(), count);
+
+                        film->put_block(block);
+                        in_flight.erase(it);
+                        tile_done(tile);
+                    }
+
+                    stream->write((uint32_t) Message::Done);
+                    stream->close();
+                } catch (const std::exception &e) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    Log(Warn, "Lost worker %s: %s. Reassigning %zu tile%s.",
+                        address, e.what(), in_flight.size(),
+                        in_flight.size() == 1 ? "" : "s");
+                    for (auto &[id, tile] : in_flight)
+                        retry.push_back(tile);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads)
+            thread.join();
+
+        /* Render the tiles of workers that were lost after the others
+           finished (or all tiles, if no worker was reachable) locally */
+        std::vector<TileRequest> remaining;
+        for (TileRequest tile; next_tile(tile);)
+            remaining.push_back(tile);
+
+        if (!remaining.empty()) {
+            Log(Info, "Rendering %zu remaining tile%s locally.", remaining.size(),
+                remaining.size() == 1 ? "" : "s");
+
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, remaining.size(), 1),
+                [&](const dr::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = sensor->sampler()->fork();
+                    ref<ImageBlock> block = film->create_block(
+                        ScalarVector2u(MI_BLOCK_SIZE), false /* normalize */,
+                        true /* border */);
+
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        const TileRequest &tile = remaining[i];
+                        block->set_size(ScalarVector2u(tile.size[0], tile.size[1]));
+                        block->set_offset(ScalarPoint2i(tile.offset[0], tile.offset[1]));
+                        integrator->render_tile(m_scene, sensor, sampler, block,
+                                                seed, m_job.spp, tile.block_id,
+                                                tile.block_size);
+                        film->put_block(block);
+                        tile_done(tile);
+                    }
+                }
+            );
+        }
+
+        Log(Info, "Rendering finished. (took %s)",
+            util::time_string((float) timer.value(), true));
+    }
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(RenderWorker, Object)
+MI_IMPLEMENT_CLASS_VARIANT(RenderCoordinator, Object)
+MI_INSTANTIATE_CLASS(RenderWorker)
+MI_INSTANTIATE_CLASS(RenderCoordinator)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,224 @@
+#include <mitsuba/render/emittercache.h>
+#include <mitsuba/core/math.h>
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MI_VARIANT EmitterCache<Float, Spectrum>::EmitterCache(
+    const ScalarBoundingBox3f &bbox, const std::vector<ref<Emitter>> &emitters,
+    uint32_t resolution, uint32_t entry_count, uint32_t training_passes)
+    : m_bbox(bbox), m_emitter_count((uint32_t) emitters.size()),
+      m_training_passes(training_passes) {
+    if (resolution == 0 || entry_count == 0)
+        Throw("EmitterCache: the resolution and entry count must be positive!");
+    if (m_emitter_count == 0)
+        Throw("EmitterCache: the scene does not contain any emitters!");
+
+    if (!m_bbox.valid())
+        m_bbox = ScalarBoundingBox3f(ScalarPoint3f(0.f), ScalarPoint3f(1.f));
+
+    ScalarFloat extent = dr::maximum(dr::max(m_bbox.extents()), 1e-6f);
+    m_inv_cell_size = resolution / extent;
+    m_entry_count = math::round_to_power_of_two(entry_count);
+
+    size_t size = (size_t) m_entry_count * m_emitter_count;
+    if constexpr (dr::is_jit_v<Float>) {
+        m_train = dr::zeros<FloatStorage>(2 * size);
+    } else {
+        m_train_scalar = std::unique_ptr<std::atomic<ScalarFloat>[]>(
+            new std::atomic<ScalarFloat>[2 * size]);
+        for (size_t i = 0; i < 2 * size; ++i)
+            m_train_scalar[i].store(0.f, std::memory_order_relaxed);
+    }
+
+    // No entry holds a distribution until the first update
+    m_prob = dr::zeros<FloatStorage>(size);
+    m_cdf  = dr::zeros<FloatStorage>(size);
+
+    for (uint32_t i = 0; i < m_emitter_count; ++i)
+        m_index_map[emitters[i].get()] = i;
+
+    if constexpr (dr::is_jit_v<Float>) {
+        // Map the JIT registry identifiers of the emitters to their indices
+        std::vector<uint32_t> ids(m_emitter_count);
+        uint32_t max_id = 0;
+        for (uint32_t i = 0; i < m_emitter_count; ++i) {
+            ids[i] = jit_registry_get_id(dr::backend_v<Float>, emitters[i].get());
+            max_id = std::max(max_id, ids[i]);
+        }
+
+        std::vector<uint32_t> registry_map(max_id + 1, 0u);
+        for (uint32_t i = 0; i < m_emitter_count; ++i)
+            registry_map[ids[i]] = i;
+
+        m_registry_map =
+            dr::load<UInt32Storage>(registry_map.data(), registry_map.size());
+    }
+
+    Log(Debug, "Emitter cache: %u entries, %u emitters, cell size %.4g",
+        m_entry_count, m_emitter_count, 1.f / m_inv_cell_size);
+}
+
+MI_VARIANT EmitterCache<Float, Spectrum>::~EmitterCache() { }
+
+/// Lock-free accumulation into an atomic floating point value
+template <typename T> static void atomic_add(std::atomic<T> &target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value,
+                                         std::memory_order_relaxed))
+        ;
+}
+
+MI_VARIANT typename EmitterCache<Float, Spectrum>::UInt32
+EmitterCache<Float, Spectrum>::entry(const Point3f &p, Mask active) const {
+    Point3i cell = dr::floor2int<Point3i>((p - m_bbox.min) * m_inv_cell_size);
+
+    // Spatial hash of the cell coordinates
+    UInt32 hash = (UInt32(cell.x()) * 73856093u) ^
+                  (UInt32(cell.y()) * 19349663u) ^
+                  (UInt32(cell.z()) * 83492791u);
+
+    return dr::select(active, hash & (m_entry_count - 1u), 0u);
+}
+
+MI_VARIANT void EmitterCache<Float, Spectrum>::record(const UInt32 &entry,
+                                                     const UInt32 &index,
+                                                     const Float &value,
+                                                     Mask active) const {
+    active &= dr::isfinite(value) && value >= 0.f;
+    UInt32 slot = 2u * (entry * m_emitter_count + index);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        dr::scatter_reduce(ReduceOp::Add, m_train, value, slot, active);
+        dr::scatter_reduce(ReduceOp::Add, m_train, Float(1.f), slot + 1u,
+                           active);
+    } else {
+        if (!active)
+            return;
+        atomic_add(m_train_scalar[slot], value);
+        atomic_add(m_train_scalar[slot + 1], 1.f);
+    }
+}
+
+MI_VARIANT void EmitterCache<Float, Spectrum>::update() {
+    size_t size = (size_t) m_entry_count * m_emitter_count;
+    std::unique_ptr<ScalarFloat[]> train(new ScalarFloat[2 * size]);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        auto &&data = dr::migrate(m_train, AllocType::Host);
+        dr::sync_thread();
+        memcpy(train.get(), data.data(), 2 * size * sizeof(ScalarFloat));
+    } else {
+        for (size_t i = 0; i < 2 * size; ++i)
+            train[i] = m_train_scalar[i].load(std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<ScalarFloat[]> prob(new ScalarFloat[size]),
+                                   cdf(new ScalarFloat[size]);
+    size_t valid_count = 0;
+
+    for (uint32_t i = 0; i < m_entry_count; ++i) {
+        const ScalarFloat *in = train.get() + 2 * (size_t) i * m_emitter_count;
+        ScalarFloat *p = prob.get() + (size_t) i * m_emitter_count,
+                    *c = cdf.get() + (size_t) i * m_emitter_count;
+
+        // Average contribution of every emitter
+        double sum = 0.0;
+        for (uint32_t j = 0; j < m_emitter_count; ++j) {
+            ScalarFloat count = in[2 * j + 1];
+            p[j] = count > 0.f ? in[2 * j] / count : 0.f;
+            sum += (double) p[j];
+        }
+
+        // Entries without visible samples only use the default strategy
+        if (!(sum > 0.0)) {
+            memset(p, 0, m_emitter_count * sizeof(ScalarFloat));
+            memset(c, 0, m_emitter_count * sizeof(ScalarFloat));
+            continue;
+        }
+
+        double accum = 0.0;
+        for (uint32_t j = 0; j < m_emitter_count; ++j) {
+            p[j] = (ScalarFloat) (p[j] / sum);
+            accum += (double) p[j];
+            c[j] = (ScalarFloat) accum;
+        }
+        c[m_emitter_count - 1] = 1.f;
+        valid_count++;
+    }
+
+    m_prob = dr::load<FloatStorage>(prob.get(), size);
+    m_cdf  = dr::load<FloatStorage>(cdf.get(), size);
+    m_update_count++;
+
+    Log(Debug, "Emitter cache: %zu of %u entries hold a distribution",
+        valid_count, m_entry_count);
+}
+
+MI_VARIANT typename EmitterCache<Float, Spectrum>::Mask
+EmitterCache<Float, Spectrum>::valid(const UInt32 &entry, Mask active) const {
+    return active && dr::gather<Float>(m_cdf, (entry + 1u) * m_emitter_count - 1u,
+                                       active) > 0.f;
+}
+
+MI_VARIANT std::tuple<typename EmitterCache<Float, Spectrum>::UInt32, Float, Float>
+EmitterCache<Float, Spectrum>::sample_emitter(const UInt32 &entry, Float sample,
+                                             Mask active) const {
+    MI_MASK_ARGUMENT(active);
+
+    UInt32 offset = entry * m_emitter_count;
+
+    // Choose an emitter from the cumulative distribution of the entry
+    UInt32 index = dr::binary_search<UInt32>(
+        0u, m_emitter_count - 1, [&](UInt32 idx) DRJIT_INLINE_LAMBDA {
+            return dr::gather<Float>(m_cdf, offset + idx, active) < sample;
+        });
+
+    Float cdf_0 = dr::gather<Float>(m_cdf, offset + index - 1, active && index > 0),
+          cdf_1 = dr::gather<Float>(m_cdf, offset + index, active),
+          pmf   = cdf_1 - cdf_0;
+
+    // Re-scale the uniform variate for reuse
+    sample -= cdf_0;
+    dr::masked(sample, pmf > 0.f) /= pmf;
+
+    return { index, dr::select(active, pmf, 0.f),
+             dr::clamp(sample, 0.f, dr::OneMinusEpsilon<Float>) };
+}
+
+MI_VARIANT Float EmitterCache<Float, Spectrum>::pdf_emitter(const UInt32 &entry,
+                                                           const UInt32 &index,
+                                                           Mask active) const {
+    return dr::gather<Float>(m_prob, entry * m_emitter_count + index, active);
+}
+
+MI_VARIANT typename EmitterCache<Float, Spectrum>::UInt32
+EmitterCache<Float, Spectrum>::emitter_index(const EmitterPtr &emitter,
+                                            Mask active) const {
+    if constexpr (dr::is_jit_v<Float>) {
+        return dr::gather<UInt32>(m_registry_map,
+                                  dr::reinterpret_array<UInt32>(emitter),
+                                  active);
+    } else {
+        auto it = m_index_map.find(emitter);
+        if (!active || it == m_index_map.end())
+            return 0u;
+        return it->second;
+    }
+}
+
+MI_VARIANT std::string EmitterCache<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "EmitterCache[" << std::endl
+        << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+        << "  entry_count = " << m_entry_count << "," << std::endl
+        << "  emitter_count = " << m_emitter_count << "," << std::endl
+        << "  training_passes = " << m_training_passes << "," << std::endl
+        << "  update_count = " << m_update_count << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(EmitterCache, Object)
+MI_INSTANTIATE_CLASS(EmitterCache)
+NAMESPACE_END(mitsuba)
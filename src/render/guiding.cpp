@@ -0,0 +1,369 @@
+#include <mitsuba/render/guiding.h>
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Fraction of the density of every cell that is spread uniformly over the sphere
+static constexpr float UniformFraction = 0.1f;
+
+MI_VARIANT GuidingField<Float, Spectrum>::GuidingField(const ScalarBoundingBox3f &bbox,
+                                                       uint32_t grid_resolution,
+                                                       uint32_t bin_resolution)
+    : m_bbox(bbox), m_grid_resolution(grid_resolution),
+      m_bin_resolution(bin_resolution) {
+    if (grid_resolution == 0 || bin_resolution == 0)
+        Throw("GuidingField: the grid and bin resolutions must be positive!");
+
+    if (!m_bbox.valid())
+        m_bbox = ScalarBoundingBox3f(ScalarPoint3f(0.f), ScalarPoint3f(1.f));
+
+    // Avoid divisions by zero for flat scenes (e.g. a single plane)
+    ScalarVector3f extents = m_bbox.extents();
+    ScalarFloat min_extent = dr::maximum(dr::max(extents) * 1e-4f, 1e-6f);
+    extents = dr::maximum(extents, min_extent);
+    m_bbox.max = m_bbox.min + extents;
+    m_inv_extents = dr::rcp(extents);
+
+    m_cell_count = grid_resolution * grid_resolution * grid_resolution;
+    m_bin_count  = bin_resolution * bin_resolution;
+
+    reset();
+
+    // Start out with uniform densities
+    size_t size = (size_t) m_cell_count * m_bin_count;
+    std::unique_ptr<ScalarFloat[]> cdf(new ScalarFloat[size]);
+    for (uint32_t i = 0; i < m_cell_count; ++i)
+        for (uint32_t j = 0; j < m_bin_count; ++j)
+            cdf[(size_t) i * m_bin_count + j] = (j + 1) / (ScalarFloat) m_bin_count;
+    m_prob = dr::full<FloatStorage>(1.f / m_bin_count, size);
+    m_cdf  = dr::load<FloatStorage>(cdf.get(), size);
+    m_radiance = dr::zeros<FloatStorage>(m_cell_count);
+}
+
+MI_VARIANT GuidingField<Float, Spectrum>::~GuidingField() { }
+
+MI_VARIANT void GuidingField<Float, Spectrum>::reset() {
+    size_t size = (size_t) m_cell_count * m_bin_count;
+    if constexpr (dr::is_jit_v<Float>) {
+        m_train = dr::zeros<FloatStorage>(size);
+        m_train_cell = dr::zeros<FloatStorage>(2 * (size_t) m_cell_count);
+    } else {
+        m_train_scalar = std::unique_ptr<std::atomic<ScalarFloat>[]>(
+            new std::atomic<ScalarFloat>[size]);
+        for (size_t i = 0; i < size; ++i)
+            m_train_scalar[i].store(0.f, std::memory_order_relaxed);
+
+        m_train_cell_scalar = std::unique_ptr<std::atomic<ScalarFloat>[]>(
+            new std::atomic<ScalarFloat>[2 * (size_t) m_cell_count]);
+        for (size_t i = 0; i < 2 * (size_t) m_cell_count; ++i)
+            m_train_cell_scalar[i].store(0.f, std::memory_order_relaxed);
+    }
+}
+
+/// Lock-free accumulation into an atomic floating point value
+template <typename T> static void atomic_add(std::atomic<T> &target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value,
+                                         std::memory_order_relaxed))
+        ;
+}
+
+MI_VARIANT typename GuidingField<Float, Spectrum>::UInt32
+GuidingField<Float, Spectrum>::cell_index(const Point3f &p, Mask active) const {
+    int32_t res = (int32_t) m_grid_resolution;
+    Point3i pi = Point3i((p - m_bbox.min) * m_inv_extents * (ScalarFloat) res);
+    pi = dr::clamp(pi, 0, res - 1);
+    return dr::select(active,
+                      UInt32((pi.z() * res + pi.y()) * res + pi.x()), 0u);
+}
+
+MI_VARIANT typename GuidingField<Float, Spectrum>::UInt32
+GuidingField<Float, Spectrum>::bin_index(const Point3f &p, const Vector3f &d,
+                                         Mask active) const {
+    int32_t res = (int32_t) m_bin_resolution;
+
+    // Equal-area cylindrical coordinates of the direction
+    Float u = (dr::clamp(d.z(), -1.f, 1.f) + 1.f) * .5f,
+          v = dr::atan2(d.y(), d.x()) * dr::InvTwoPi<Float>;
+    dr::masked(v, v < 0.f) += 1.f;
+
+    Int32 bx = dr::clamp(Int32(u * (ScalarFloat) res), 0, res - 1),
+          by = dr::clamp(Int32(v * (ScalarFloat) res), 0, res - 1);
+
+    return cell_index(p, active) * m_bin_count + UInt32(by * res + bx);
+}
+
+MI_VARIANT void GuidingField<Float, Spectrum>::record(const UInt32 &index,
+                                                     const Float &value,
+                                                     Mask active) const {
+    active &= dr::isfinite(value) && value > 0.f;
+
+    if constexpr (dr::is_jit_v<Float>) {
+        dr::scatter_reduce(ReduceOp::Add, m_train, value, index, active);
+    } else {
+        if (!active)
+            return;
+        atomic_add(m_train_scalar[index], value);
+    }
+}
+
+MI_VARIANT void GuidingField<Float, Spectrum>::record_radiance(const UInt32 &index,
+                                                              const Float &radiance,
+                                                              Mask active) const {
+    active &= dr::isfinite(radiance) && radiance >= 0.f;
+    UInt32 cell = index / m_bin_count;
+
+    if constexpr (dr::is_jit_v<Float>) {
+        dr::scatter_reduce(ReduceOp::Add, m_train_cell, radiance, 2u * cell, active);
+        dr::scatter_reduce(ReduceOp::Add, m_train_cell, Float(1.f), 2u * cell + 1u,
+                           active);
+    } else {
+        if (!active)
+            return;
+        atomic_add(m_train_cell_scalar[2 * cell], radiance);
+        atomic_add(m_train_cell_scalar[2 * cell + 1], 1.f);
+    }
+}
+
+MI_VARIANT void GuidingField<Float, Spectrum>::update() {
+    size_t size = (size_t) m_cell_count * m_bin_count;
+    std::unique_ptr<ScalarFloat[]> train(new ScalarFloat[size]);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        auto &&data = dr::migrate(m_train, AllocType::Host);
+        dr::sync_thread();
+        memcpy(train.get(), data.data(), size * sizeof(ScalarFloat));
+    } else {
+        for (size_t i = 0; i < size; ++i)
+            train[i] = m_train_scalar[i].load(std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<ScalarFloat[]> prob(new ScalarFloat[size]),
+                                   cdf(new ScalarFloat[size]);
+
+    ScalarFloat uniform = 1.f / m_bin_count;
+    for (uint32_t i = 0; i < m_cell_count; ++i) {
+        const ScalarFloat *in = train.get() + (size_t) i * m_bin_count;
+        ScalarFloat *p = prob.get() + (size_t) i * m_bin_count,
+                    *c = cdf.get() + (size_t) i * m_bin_count;
+
+        double sum = 0.0;
+        for (uint32_t j = 0; j < m_bin_count; ++j)
+            sum += (double) in[j];
+
+        // Mix with a uniform density so that no direction is left out entirely
+        double accum = 0.0;
+        for (uint32_t j = 0; j < m_bin_count; ++j) {
+            if (sum > 0.0)
+                p[j] = (ScalarFloat) ((1.0 - UniformFraction) * in[j] / sum +
+                                      UniformFraction * uniform);
+            else
+                p[j] = uniform;
+            accum += (double) p[j];
+            c[j] = (ScalarFloat) accum;
+        }
+
+        // Normalize away round-off errors
+        for (uint32_t j = 0; j < m_bin_count; ++j) {
+            p[j] = (ScalarFloat) (p[j] / accum);
+            c[j] = (ScalarFloat) (c[j] / accum);
+        }
+        c[m_bin_count - 1] = 1.f;
+    }
+
+    m_prob = dr::load<FloatStorage>(prob.get(), size);
+    m_cdf  = dr::load<FloatStorage>(cdf.get(), size);
+
+    // Average incident radiance of every cell
+    std::unique_ptr<ScalarFloat[]> train_cell(new ScalarFloat[2 * (size_t) m_cell_count]),
+                                   radiance(new ScalarFloat[m_cell_count]);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        auto &&data = dr::migrate(m_train_cell, AllocType::Host);
+        dr::sync_thread();
+        memcpy(train_cell.get(), data.data(),
+               2 * (size_t) m_cell_count * sizeof(ScalarFloat));
+    } else {
+        for (size_t i = 0; i < 2 * (size_t) m_cell_count; ++i)
+            train_cell[i] = m_train_cell_scalar[i].load(std::memory_order_relaxed);
+    }
+
+    for (uint32_t i = 0; i < m_cell_count; ++i) {
+        ScalarFloat count = train_cell[2 * i + 1];
+        radiance[i] = count > 0.f ? train_cell[2 * i] / count : 0.f;
+    }
+
+    m_radiance = dr::load<FloatStorage>(radiance.get(), m_cell_count);
+    m_ready = true;
+}
+
+MI_VARIANT std::pair<typename GuidingField<Float, Spectrum>::Vector3f,
+                     typename GuidingField<Float, Spectrum>::Float>
+GuidingField<Float, Spectrum>::sample(const Point3f &p, const Point2f &sample_,
+                                      Mask active) const {
+    MI_MASK_ARGUMENT(active);
+
+    Point2f sample = dr::clamp(sample_, dr::Smallest<Float>,
+                               dr::OneMinusEpsilon<Float>);
+    UInt32 offset = cell_index(p, active) * m_bin_count;
+
+    // Choose a bin from the cumulative distribution of the cell
+    UInt32 bin = dr::binary_search<UInt32>(
+        0u, m_bin_count - 1, [&](UInt32 idx) DRJIT_INLINE_LAMBDA {
+            return dr::gather<Float>(m_cdf, offset + idx, active) < sample.x();
+        });
+
+    Float cdf_0 = dr::gather<Float>(m_cdf, offset + bin - 1, active && bin > 0),
+          cdf_1 = dr::gather<Float>(m_cdf, offset + bin, active);
+
+    // Re-scale the uniform variate to the interior of the bin
+    sample.x() -= cdf_0;
+    dr::masked(sample.x(), dr::neq(cdf_1, cdf_0)) /= cdf_1 - cdf_0;
+
+    Float inv_res = 1.f / (ScalarFloat) m_bin_resolution;
+    UInt32 bx = bin % m_bin_resolution,
+           by = bin / m_bin_resolution;
+
+    Float cos_theta = (Float(bx) + sample.x()) * inv_res * 2.f - 1.f,
+          sin_theta = dr::safe_sqrt(1.f - dr::sqr(cos_theta));
+    auto [sin_phi, cos_phi] =
+        dr::sincos((Float(by) + sample.y()) * inv_res * dr::TwoPi<Float>);
+
+    Vector3f d(sin_theta * cos_phi, sin_theta * sin_phi, cos_theta);
+    Float pdf = (cdf_1 - cdf_0) * (m_bin_count * dr::InvFourPi<ScalarFloat>);
+
+    return { d, dr::select(active, pdf, 0.f) };
+}
+
+MI_VARIANT typename GuidingField<Float, Spectrum>::Float
+GuidingField<Float, Spectrum>::pdf(const Point3f &p, const Vector3f &d,
+                                   Mask active) const {
+    MI_MASK_ARGUMENT(active);
+    Float prob = dr::gather<Float>(m_prob, bin_index(p, d, active), active);
+    return prob * (m_bin_count * dr::InvFourPi<ScalarFloat>);
+}
+
+MI_VARIANT typename GuidingField<Float, Spectrum>::Float
+GuidingField<Float, Spectrum>::radiance(const Point3f &p, Mask active) const {
+    MI_MASK_ARGUMENT(active);
+    return dr::gather<Float>(m_radiance, cell_index(p, active), active);
+}
+
+MI_VARIANT std::tuple<typename GuidingField<Float, Spectrum>::BSDFSample3f,
+                      typename GuidingField<Float, Spectrum>::Spectrum,
+                      typename GuidingField<Float, Spectrum>::Mask>
+GuidingField<Float, Spectrum>::sample_bsdf(const BSDFContext &ctx,
+                                           const BSDFPtr &bsdf,
+                                           const SurfaceInteraction3f &si,
+                                           const BSDFSample3f &bs_,
+                                           const Spectrum &weight_,
+                                           Float sample1, const Point2f &sample2,
+                                           ScalarFloat prob, Mask active) const {
+    MI_MASK_ARGUMENT(active);
+
+    BSDFSample3f bs(bs_);
+    Spectrum weight(weight_);
+    Mask guided = active && sample1 < prob;
+
+    // Draw a direction from the field and evaluate the BSDF for it
+    auto [d_guide, pdf_guide] = sample(si.p, sample2, guided);
+    Vector3f wo_guide = si.to_local(d_guide);
+    auto [value_guide, pdf_bsdf_guide] =
+        bsdf->eval_pdf(ctx, si, wo_guide, guided);
+
+    // Evaluate the density of the field for the BSDF-sampled direction
+    Float pdf_guide_bsdf = pdf(si.p, si.to_world(bs.wo), active && !guided);
+
+    Float pdf_b = dr::select(guided, pdf_bsdf_guide, bs.pdf),
+          pdf_g = dr::select(guided, pdf_guide, pdf_guide_bsdf),
+          pdf_mix = prob * pdf_g + (1.f - prob) * pdf_b;
+
+    Float inv_pdf_mix = dr::select(pdf_mix > 0.f, dr::rcp(pdf_mix), 0.f);
+    dr::masked(weight, guided) = value_guide * inv_pdf_mix;
+    dr::masked(weight, active && !guided) = weight * bs.pdf * inv_pdf_mix;
+
+    dr::masked(bs.wo, guided) = wo_guide;
+    dr::masked(bs.eta, guided) = 1.f;
+    dr::masked(bs.sampled_type, guided) =
+        dr::select(Frame3f::cos_theta(wo_guide) > 0.f,
+                   UInt32(+BSDFFlags::GlossyReflection),
+                   UInt32(+BSDFFlags::GlossyTransmission));
+    dr::masked(bs.pdf, active) = pdf_mix;
+
+    return { bs, weight, guided };
+}
+
+MI_VARIANT typename GuidingField<Float, Spectrum>::Float
+GuidingField<Float, Spectrum>::pdf_bsdf(const SurfaceInteraction3f &si,
+                                        const Vector3f &d,
+                                        const Float &bsdf_pdf,
+                                        ScalarFloat prob, Mask active) const {
+    Float pdf_guide = pdf(si.p, d, active);
+    return dr::select(active, prob * pdf_guide + (1.f - prob) * bsdf_pdf,
+                      bsdf_pdf);
+}
+
+MI_VARIANT GuidingField<Float, Spectrum>::Vertices::Vertices(size_t width) {
+    if constexpr (dr::is_jit_v<Float>)
+        lane = dr::arange<UInt32>(width);
+    else
+        lane = 0u;
+
+    size_t size = width * MaxTrainingVertices;
+    vertex_index    = dr::zeros<UInt32Storage>(size);
+    vertex_radiance = dr::zeros<FloatStorage>(size);
+    vertex_scale    = dr::zeros<FloatStorage>(size);
+    vertex_pdf      = dr::zeros<FloatStorage>(size);
+}
+
+MI_VARIANT void GuidingField<Float, Spectrum>::Vertices::put(
+    const UInt32 &depth, const UInt32 &index, const Spectrum &radiance,
+    const Spectrum &throughput, const Float &pdf, Mask active) {
+    Float lum = dr::mean(unpolarized_spectrum(throughput));
+    active &= depth < MaxTrainingVertices && lum > 0.f && pdf > 0.f;
+
+    UInt32 slot = lane * MaxTrainingVertices + depth;
+    dr::scatter(vertex_index, index, slot, active);
+    dr::scatter(vertex_radiance, dr::mean(unpolarized_spectrum(radiance)),
+                slot, active);
+    dr::scatter(vertex_scale, dr::rcp(lum * pdf), slot, active);
+    dr::scatter(vertex_pdf, pdf, slot, active);
+}
+
+MI_VARIANT void GuidingField<Float, Spectrum>::Vertices::finish(
+    const GuidingField *field, const Spectrum &radiance, Mask active) {
+    Float lum = dr::mean(unpolarized_spectrum(radiance));
+
+    for (uint32_t i = 0; i < MaxTrainingVertices; ++i) {
+        UInt32 slot = lane * MaxTrainingVertices + i;
+        Float scale = dr::gather<Float>(vertex_scale, slot, active);
+        Mask valid = active && scale > 0.f;
+
+        // Radiance that arrived at the vertex along the sampled direction
+        Float incident =
+            lum - dr::gather<Float>(vertex_radiance, slot, valid);
+        UInt32 index = dr::gather<UInt32>(vertex_index, slot, valid);
+
+        incident = dr::maximum(incident, 0.f) * scale;
+        field->record(index, incident, valid);
+
+        // Undo the division by the density to obtain the incident radiance
+        field->record_radiance(
+            index, incident * dr::gather<Float>(vertex_pdf, slot, valid), valid);
+    }
+}
+
+MI_VARIANT std::string GuidingField<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "GuidingField[" << std::endl
+        << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+        << "  grid_resolution = " << m_grid_resolution << "," << std::endl
+        << "  bin_resolution = " << m_bin_resolution << "," << std::endl
+        << "  ready = " << m_ready << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(GuidingField, Object)
+MI_INSTANTIATE_CLASS(GuidingField)
+NAMESPACE_END(mitsuba)
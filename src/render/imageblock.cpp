@@ -2,9 +2,109 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/profiler.h>
 #include <drjit/loop.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Merge the sample statistics of two disjoint sets of samples
+ *
+ * Updates the sample count \c n_a, the means \c mean_a and the sums of
+ * squared deviations from the mean \c m2_a (of \c count channels) of the
+ * first set so that they also account for the second one, following the
+ * parallel formulation of Welford's algorithm by Chan et al.
+ */
+template <typename Value>
+static void merge_variance(Value &n_a, Value *mean_a, Value *m2_a,
+                           const Value &n_b, const Value *mean_b,
+                           const Value *m2_b, uint32_t count) {
+    Value n = n_a + n_b,
+          w_b = dr::select(n > 0.f, n_b / n, 0.f);
+
+    for (uint32_t k = 0; k < count; ++k) {
+        Value delta = mean_b[k] - mean_a[k];
+        mean_a[k] = dr::fmadd(delta, w_b, mean_a[k]);
+        m2_a[k] += m2_b[k] + dr::sqr(delta) * n_a * w_b;
+    }
+
+    n_a = n;
+}
+
+/**
+ * \brief Splat a sample in scalar variants using a reconstruction filter whose
+ * footprint spans at most <tt>Size - 1</tt> pixels along each axis
+ *
+ * The separable 1D weights are evaluated once (from the discretized filter)
+ * into fixed-size arrays, after which the weighted sample values are
+ * accumulated as an outer product. Also computes the normalization from the
+ * same weights instead of evaluating the filter a second time.
+ */
+template <uint32_t Size, typename Filter, typename ScalarFloat,
+          typename ScalarPoint2f, typename ScalarVector2u>
+static void put_separable(ScalarFloat *data, const ScalarVector2u &size,
+                          uint32_t channel_count, const Filter *rfilter,
+                          const ScalarPoint2f &pos_f, uint32_t count_max,
+                          bool normalize, const ScalarFloat *values) {
+    ScalarFloat radius = rfilter->radius();
+    int32_t x0 = dr::ceil2int<int32_t>(pos_f.x() - radius),
+            y0 = dr::ceil2int<int32_t>(pos_f.y() - radius);
+
+    ScalarFloat weights_x[Size], weights_y[Size];
+    ScalarFloat rel_x = (ScalarFloat) x0 - pos_f.x(),
+                rel_y = (ScalarFloat) y0 - pos_f.y();
+    for (uint32_t i = 0; i < Size; ++i) {
+        weights_x[i] = rfilter->eval_discretized(rel_x + (ScalarFloat) i);
+        weights_y[i] = rfilter->eval_discretized(rel_y + (ScalarFloat) i);
+    }
+
+    if (unlikely(normalize)) {
+        ScalarFloat wx = 0.f, wy = 0.f;
+        for (uint32_t i = 0; i < count_max; ++i) {
+            wx += weights_x[i];
+            wy += weights_y[i];
+        }
+
+        ScalarFloat factor = wx * wy;
+        if (unlikely(factor == 0))
+            return;
+        factor = dr::rcp(factor);
+
+        for (uint32_t i = 0; i < Size; ++i)
+            weights_x[i] *= factor;
+    }
+
+    // Interval specifying the pixels covered by the filter
+    int32_t x_start = std::max(x0, 0),
+            y_start = std::max(y0, 0),
+            x_end = std::min({ x0 + (int32_t) Size - 1,
+                               dr::floor2int<int32_t>(pos_f.x() + radius),
+                               (int32_t) size.x() - 1 }),
+            y_end = std::min({ y0 + (int32_t) Size - 1,
+                               dr::floor2int<int32_t>(pos_f.y() + radius),
+                               (int32_t) size.y() - 1 });
+
+    if (x_start > x_end || y_start > y_end)
+        return;
+
+    ScalarFloat *values_y = (ScalarFloat *) alloca(sizeof(ScalarFloat) * channel_count);
+
+    for (int32_t y = y_start; y <= y_end; ++y) {
+        ScalarFloat weight_y = weights_y[y - y0];
+        for (uint32_t k = 0; k < channel_count; ++k)
+            values_y[k] = values[k] * weight_y;
+
+        ScalarFloat *ptr =
+            data + ((size_t) y * size.x() + (size_t) x_start) * channel_count;
+
+        for (int32_t x = x_start; x <= x_end; ++x) {
+            ScalarFloat weight_x = weights_x[x - x0];
+            for (uint32_t k = 0; k < channel_count; ++k)
+                ptr[k] = dr::fmadd(values_y[k], weight_x, ptr[k]);
+            ptr += channel_count;
+        }
+    }
+}
+
 MI_VARIANT
 ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2u &size,
                                         const ScalarPoint2i &offset,
@@ -16,7 +116,9 @@ ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2u &size,
     : m_offset(offset), m_size(0), m_channel_count(channel_count),
       m_rfilter(rfilter), m_normalize(normalize), m_coalesce(coalesce),
       m_compensate(compensate), m_warn_negative(warn_negative),
-      m_warn_invalid(warn_invalid) {
+      m_warn_invalid(warn_invalid), m_sorted(false), m_sample_group(1),
+      m_variance_source(0), m_variance_target(0), m_variance_count(0),
+      m_variance_weight(0) {
 
     // Detect if a box filter is being used, and just discard it in that case
     if (rfilter && rfilter->is_box_filter())
@@ -38,7 +140,10 @@ ImageBlock<Float, Spectrum>::ImageBlock(const TensorXf &tensor,
                                         bool warn_negative, bool warn_invalid)
     : m_offset(offset), m_rfilter(rfilter), m_normalize(normalize),
       m_coalesce(coalesce), m_compensate(compensate),
-      m_warn_negative(warn_negative), m_warn_invalid(warn_invalid) {
+      m_warn_negative(warn_negative), m_warn_invalid(warn_invalid),
+      m_sorted(false), m_sample_group(1),
+      m_variance_source(0), m_variance_target(0), m_variance_count(0),
+      m_variance_weight(0) {
 
     if (tensor.ndim() != 3)
 		Throw("ImageBlock(const TensorXf&): expected a 3D tensor (height x width x channels)!");
@@ -63,6 +168,7 @@ ImageBlock<Float, Spectrum>::ImageBlock(const TensorXf &tensor,
         m_tensor = TensorXf(tensor.array().copy(), 3, tensor.shape().data());
     else
         m_tensor = TensorXf(tensor.array(), 3, tensor.shape().data());
+    update_memory();
 }
 
 MI_VARIANT ImageBlock<Float, Spectrum>::~ImageBlock() { }
@@ -79,6 +185,8 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::clear() {
 
     if (m_compensate)
         m_tensor_compensation = TensorXf(dr::zeros<Array>(size_flat), 3, shape);
+
+    clear_variance();
 }
 
 MI_VARIANT void
@@ -99,6 +207,20 @@ ImageBlock<Float, Spectrum>::set_size(const ScalarVector2u &size) {
         m_tensor_compensation = TensorXf(dr::zeros<Array>(size_flat), 3, shape);
 
     m_size = size;
+    clear_variance();
+}
+
+MI_VARIANT void
+ImageBlock<Float, Spectrum>::set_rfilter(const ReconstructionFilter *rfilter) {
+    // Detect if a box filter is being used, and just discard it in that case
+    if (rfilter && rfilter->is_box_filter())
+        rfilter = nullptr;
+
+    if (!rfilter && m_border_size != 0)
+        Throw("ImageBlock::set_rfilter(): the box filter cannot be used with "
+              "a block that has a border region!");
+
+    m_rfilter = rfilter;
 }
 
 MI_VARIANT typename ImageBlock<Float, Spectrum>::TensorXf &ImageBlock<Float, Spectrum>::tensor() {
@@ -109,6 +231,8 @@ MI_VARIANT typename ImageBlock<Float, Spectrum>::TensorXf &ImageBlock<Float, Spe
             comp = dr::zeros<Float>(comp.size());
         }
     }
+    if (m_variance_count)
+        develop_variance();
     return m_tensor;
 }
 
@@ -139,6 +263,16 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put_block(const ImageBlock *block)
         Throw("ImageBlock::put_block(): mismatched channel counts! (%u, "
               "expected %u)", block->channel_count(), channel_count());
 
+    if (block->variance_count()) {
+        if (!m_variance_count)
+            set_variance(block->m_variance_source, block->m_variance_target,
+                         block->m_variance_count, block->m_variance_weight);
+        else if (m_variance_source != block->m_variance_source ||
+                 m_variance_target != block->m_variance_target ||
+                 m_variance_count != block->m_variance_count)
+            Throw("ImageBlock::put_block(): mismatched variance channels!");
+    }
+
     ScalarVector2u source_size   = block->size() + 2 * block->border_size(),
                    target_size   =        size() + 2 *        border_size();
 
@@ -169,6 +303,57 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put_block(const ImageBlock *block)
             source_size, channel_count()
         );
     }
+
+    if (!block->variance_count())
+        return;
+
+    // Merge the variance statistics of the pixels covered by both blocks
+    uint32_t count  = m_variance_count,
+             stride = 2 * count + 1;
+    ScalarVector2i rel = block->offset() - offset();
+    ScalarVector2u bsize = block->size();
+
+    if constexpr (dr::is_jit_v<Float>) {
+        UInt32 i = dr::arange<UInt32>(dr::prod(bsize));
+        Point2i p;
+        p.y() = Int32(i / bsize.x());
+        p.x() = Int32(i) - p.y() * (int32_t) bsize.x() + rel.x();
+        p.y() += rel.y();
+        Mask active = dr::all(p >= 0 && p < Point2i(m_size));
+
+        UInt32 source = i * stride,
+               target = UInt32(dr::fmadd(p.y(), (int32_t) m_size.x(), p.x())) * stride;
+
+        const Float &src = block->m_variance.array();
+        Float &dst = m_variance.array();
+        std::vector<Float> a(stride), b(stride);
+        for (uint32_t k = 0; k < stride; ++k) {
+            a[k] = dr::gather<Float>(dst, target + k, active);
+            b[k] = dr::gather<Float>(src, source + k, active);
+        }
+
+        merge_variance(a[0], a.data() + 1, a.data() + 1 + count,
+                       b[0], b.data() + 1, b.data() + 1 + count, count);
+
+        for (uint32_t k = 0; k < stride; ++k)
+            dr::scatter(dst, a[k], target + k, active);
+    } else {
+        const ScalarFloat *src = block->m_variance.data();
+        ScalarFloat *dst = m_variance.data();
+
+        for (uint32_t y = 0; y < bsize.y(); ++y) {
+            for (uint32_t x = 0; x < bsize.x(); ++x) {
+                ScalarPoint2i p = ScalarPoint2i(x, y) + rel;
+                if (dr::any(p < 0 || p >= ScalarPoint2i(m_size)))
+                    continue;
+
+                const ScalarFloat *b = src + (y * bsize.x() + x) * stride;
+                ScalarFloat *a = dst + (p.y() * m_size.x() + p.x()) * stride;
+                merge_variance(a[0], a + 1, a + 1 + count,
+                               b[0], b + 1, b + 1 + count, count);
+            }
+        }
+    }
 }
 
 MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
@@ -203,6 +388,18 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
         }
     }
 
+    if (m_variance_count)
+        put_variance(pos, values, active);
+
+    // ===================================================================
+    //  Sorted accumulation of groups of samples sharing a pixel
+    // ===================================================================
+
+    if constexpr (JIT) {
+        if (m_sorted && m_sample_group > 1 && put_sorted(pos, values, active))
+            return;
+    }
+
     // ===================================================================
     //  Fast special case for the box filter
     // ===================================================================
@@ -257,6 +454,33 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
         }
     }
 
+    // ===================================================================
+    // Fast path for scalar variants and filters with a small footprint
+    // ===================================================================
+
+    if constexpr (!JIT) {
+        uint32_t count_max = dr::ceil2int<uint32_t>(2.f * radius);
+        Point2f pos_f = pos + ((int) m_border_size - m_offset - .5f);
+        ScalarFloat *data = m_tensor.array().data();
+
+        #define MI_PUT_SEPARABLE(N)                                            \
+            case N:                                                            \
+                if (likely(active))                                            \
+                    put_separable<N + 1>(data, size, m_channel_count,          \
+                                         m_rfilter.get(), pos_f, count_max,    \
+                                         m_normalize, values);                 \
+                return;
+
+        switch (count_max) {
+            MI_PUT_SEPARABLE(1) MI_PUT_SEPARABLE(2) MI_PUT_SEPARABLE(3)
+            MI_PUT_SEPARABLE(4) MI_PUT_SEPARABLE(5) MI_PUT_SEPARABLE(6)
+            MI_PUT_SEPARABLE(7) MI_PUT_SEPARABLE(8)
+            default: break;
+        }
+
+        #undef MI_PUT_SEPARABLE
+    }
+
     // ===================================================================
     // 1. Non-coalesced accumulation method (see ImageBlock constructor)
     // ===================================================================
@@ -531,6 +755,110 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
     }
 }
 
+MI_VARIANT bool ImageBlock<Float, Spectrum>::put_sorted(const Point2f &pos,
+                                                        const Float *values,
+                                                        Mask active) {
+    if constexpr (dr::is_jit_v<Float>) {
+        uint32_t group = m_sample_group;
+
+        size_t width = dr::width(pos, active);
+        for (uint32_t k = 0; k < m_channel_count; ++k)
+            width = std::max(width, dr::width(values[k]));
+
+        // Fall back to the regular implementation when the wavefront does
+        // not follow the expected layout, or when derivatives are tracked
+        if (m_normalize || width < group || width % group != 0)
+            return false;
+
+        if constexpr (dr::is_diff_v<Float>) {
+            if (dr::grad_enabled(pos) || dr::grad_enabled(m_tensor))
+                return false;
+            for (uint32_t k = 0; k < m_channel_count; ++k)
+                if (dr::grad_enabled(values[k]))
+                    return false;
+        }
+
+        // Per-lane sample values (zero on inactive lanes). Selecting with an
+        // 'arange'-based mask broadcasts literal inputs to the wavefront size.
+        Mask all_lanes = dr::arange<UInt32>((uint32_t) width) < (uint32_t) width,
+             valid = active && all_lanes;
+
+        std::vector<Float> v(m_channel_count);
+        for (uint32_t k = 0; k < m_channel_count; ++k) {
+            v[k] = dr::select(valid, values[k], 0.f);
+            dr::schedule(v[k]);
+        }
+
+        // Evaluate the wavefront once, since it is read by every reduction below
+        Point2f pos_e = dr::select(all_lanes, pos, 0.f);
+        dr::schedule(pos_e, valid);
+        dr::eval();
+
+        // The pixel of a group is that of its first lane
+        uint32_t group_count = (uint32_t) (width / group);
+        UInt32 first = dr::arange<UInt32>(group_count) * group;
+        Point2i pixel = dr::floor2int<Point2i>(dr::gather<Point2f>(pos_e, first));
+        Mask active_g = dr::block_sum(dr::select(valid, 1.f, 0.f), group) > 0.f;
+
+        if (!m_rfilter) {
+            // Box filter: one update per pixel and channel
+            Point2u p = Point2u(pixel - m_offset);
+            UInt32 index = dr::fmadd(p.y(), m_size.x(), p.x()) * m_channel_count;
+            active_g &= dr::all(p < m_size);
+
+            for (uint32_t k = 0; k < m_channel_count; ++k)
+                accum(dr::block_sum(v[k], group), index++, active_g);
+
+            return true;
+        }
+
+        // General filter: traverse the footprint around each group's pixel
+        // like the coalesced method, and reduce every tap over the group
+        ScalarVector2u size = m_size + 2 * m_border_size;
+        uint32_t n = dr::ceil2int<uint32_t>(m_rfilter->radius() - .5f),
+                 count = 2 * n + 1;
+
+        Point2i pos_i_local = pixel - int(n) + ((int) m_border_size - m_offset);
+        UInt32 x = UInt32(pos_i_local.x()),
+               y = UInt32(pos_i_local.y()),
+               index = dr::fmadd(y, size.x(), x) * m_channel_count;
+
+        // Per-lane filter weights relative to the top left pixel of the footprint
+        Point2f rel_f = Point2f(dr::floor2int<Point2i>(pos_e) - int(n)) + .5f - pos_e;
+        std::vector<Float> weights_x(count), weights_y(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            weights_x[i] = m_rfilter->eval(rel_f.x());
+            weights_y[i] = m_rfilter->eval(rel_f.y());
+            rel_f += 1;
+        }
+
+        for (uint32_t ys = 0; ys < count; ++ys) {
+            Mask active_1 = active_g && y < size.y();
+
+            for (uint32_t xs = 0; xs < count; ++xs) {
+                Mask active_2 = active_1 && x < size.x();
+                Float weight = weights_y[ys] * weights_x[xs];
+
+                for (uint32_t k = 0; k < m_channel_count; ++k)
+                    accum(dr::block_sum(v[k] * weight, group), index++, active_2);
+
+                x++;
+            }
+
+            x -= count;
+            y += 1;
+            index += (size.x() - count) * m_channel_count;
+        }
+
+        return true;
+    } else {
+        DRJIT_MARK_USED(pos);
+        DRJIT_MARK_USED(values);
+        DRJIT_MARK_USED(active);
+        return false;
+    }
+}
+
 MI_VARIANT void ImageBlock<Float, Spectrum>::read(const Point2f &pos_,
                                                    Float *values,
                                                    Mask active) const {
@@ -753,6 +1081,161 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::read(const Point2f &pos_,
     }
 }
 
+MI_VARIANT void ImageBlock<Float, Spectrum>::set_variance(uint32_t source,
+                                                          uint32_t target,
+                                                          uint32_t count,
+                                                          uint32_t weight) {
+    if (count > 0 && (source + count > m_channel_count ||
+                      target + count > m_channel_count ||
+                      weight >= m_channel_count))
+        Throw("ImageBlock::set_variance(): channel index out of range!");
+
+    m_variance_source = source;
+    m_variance_target = target;
+    m_variance_count = count;
+    m_variance_weight = weight;
+    clear_variance();
+}
+
+MI_VARIANT void ImageBlock<Float, Spectrum>::clear_variance() {
+    using Array = typename TensorXf::Array;
+
+    if (!m_variance_count) {
+        m_variance = TensorXf();
+    } else {
+        size_t stride = 2 * m_variance_count + 1,
+               shape[3] = { m_size.y(), m_size.x(), stride };
+        m_variance = TensorXf(dr::zeros<Array>(stride * dr::prod(m_size)), 3, shape);
+    }
+
+    update_memory();
+}
+
+MI_VARIANT void ImageBlock<Float, Spectrum>::update_memory() {
+    size_t size = (m_tensor.size() + m_tensor_compensation.size() +
+                   m_variance.size()) * sizeof(ScalarFloat);
+    m_memory.set_bytes(size, dr::is_cuda_v<Float>);
+}
+
+MI_VARIANT void ImageBlock<Float, Spectrum>::put_variance(const Point2f &pos,
+                                                          const Float *values,
+                                                          Mask active) {
+    uint32_t count  = m_variance_count,
+             stride = 2 * count + 1;
+    const Float *v = values + m_variance_source;
+
+    if constexpr (dr::is_jit_v<Float>) {
+        uint32_t group = m_sample_group;
+        size_t width = dr::width(pos, active);
+        for (uint32_t k = 0; k < count; ++k)
+            width = std::max(width, dr::width(v[k]));
+
+        if (width % group != 0)
+            Throw("ImageBlock::put(): recording the variance requires "
+                  "wavefronts that consist of whole sample groups!");
+
+        // Statistics of the samples of every group (at the pixel of its first lane)
+        Float n_b;
+        std::vector<Float> mean_b(count), m2_b(count, 0.f);
+        Point2f pos_b;
+
+        if (group == 1) {
+            n_b = dr::select(active, 1.f, 0.f);
+            for (uint32_t k = 0; k < count; ++k)
+                mean_b[k] = v[k];
+            pos_b = pos;
+        } else {
+            uint32_t group_count = (uint32_t) (width / group);
+            UInt32 lane = dr::arange<UInt32>((uint32_t) width);
+            Mask valid = active && lane < (uint32_t) width;
+
+            n_b = dr::block_sum(dr::select(valid, 1.f, 0.f), group);
+            Float inv_n = dr::select(n_b > 0.f, dr::rcp(n_b), 0.f);
+
+            UInt32 lane_group = lane / group;
+            for (uint32_t k = 0; k < count; ++k) {
+                mean_b[k] = dr::block_sum(dr::select(valid, v[k], 0.f), group) * inv_n;
+                Float delta = v[k] - dr::gather<Float>(mean_b[k], lane_group);
+                m2_b[k] = dr::block_sum(dr::select(valid, dr::sqr(delta), 0.f), group);
+            }
+
+            pos_b = dr::gather<Point2f>(dr::select(valid, pos, 0.f),
+                                        dr::arange<UInt32>(group_count) * group);
+        }
+
+        Point2u p = Point2u(dr::floor2int<Point2i>(pos_b) - m_offset);
+        Mask active_b = n_b > 0.f && dr::all(p < m_size);
+        UInt32 index = dr::fmadd(p.y(), m_size.x(), p.x()) * stride;
+
+        Float &data = m_variance.array();
+        std::vector<Float> a(stride);
+        for (uint32_t k = 0; k < stride; ++k)
+            a[k] = dr::gather<Float>(data, index + k, active_b);
+
+        merge_variance(a[0], a.data() + 1, a.data() + 1 + count,
+                       n_b, mean_b.data(), m2_b.data(), count);
+
+        for (uint32_t k = 0; k < stride; ++k)
+            dr::scatter(data, a[k], index + k, active_b);
+    } else {
+        Point2u p = Point2u(dr::floor2int<Point2i>(pos) - m_offset);
+        if (!active || dr::any(p >= m_size))
+            return;
+
+        // Welford's update with a single sample
+        ScalarFloat *a = m_variance.data() + (p.y() * m_size.x() + p.x()) * stride,
+                    n = a[0] + 1.f;
+        for (uint32_t k = 0; k < count; ++k) {
+            ScalarFloat delta = v[k] - a[1 + k];
+            a[1 + k] += delta / n;
+            a[1 + count + k] += delta * (v[k] - a[1 + k]);
+        }
+        a[0] = n;
+    }
+}
+
+MI_VARIANT void ImageBlock<Float, Spectrum>::develop_variance() {
+    uint32_t count  = m_variance_count,
+             stride = 2 * count + 1;
+    ScalarVector2u size = m_size + 2 * m_border_size;
+
+    if constexpr (dr::is_jit_v<Float>) {
+        UInt32 i = dr::arange<UInt32>(dr::prod(m_size)),
+               y = i / m_size.x(),
+               x = dr::fnmadd(y, m_size.x(), i),
+               index = dr::fmadd(y + m_border_size, size.x(), x + m_border_size) *
+                       m_channel_count;
+
+        const Float &stats = m_variance.array();
+        Float &data = m_tensor.array();
+
+        Float n = dr::gather<Float>(stats, i * stride),
+              weight = dr::gather<Float>(data, index + m_variance_weight),
+              scale = dr::select(n > 1.f, weight / (n - 1.f), 0.f);
+
+        for (uint32_t k = 0; k < count; ++k)
+            dr::scatter(data,
+                        dr::gather<Float>(stats, i * stride + 1 + count + k) * scale,
+                        index + m_variance_target + k);
+    } else {
+        const ScalarFloat *stats = m_variance.data();
+        ScalarFloat *data = m_tensor.data();
+
+        for (uint32_t y = 0; y < m_size.y(); ++y) {
+            for (uint32_t x = 0; x < m_size.x(); ++x) {
+                const ScalarFloat *a = stats + (y * m_size.x() + x) * stride;
+                ScalarFloat *pixel =
+                    data + ((y + m_border_size) * size.x() + x + m_border_size) *
+                               m_channel_count;
+                ScalarFloat n = a[0],
+                            scale = n > 1.f ? pixel[m_variance_weight] / (n - 1.f) : 0.f;
+                for (uint32_t k = 0; k < count; ++k)
+                    pixel[m_variance_target + k] = a[1 + count + k] * scale;
+            }
+        }
+    }
+}
+
 MI_VARIANT std::string ImageBlock<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
 
@@ -764,6 +1247,9 @@ MI_VARIANT std::string ImageBlock<Float, Spectrum>::to_string() const {
         << "  normalize = " << m_normalize << "," << std::endl
         << "  coalesce = " << m_coalesce << "," << std::endl
         << "  compensate = " << m_compensate << "," << std::endl
+        << "  sorted = " << m_sorted << "," << std::endl
+        << "  sample_group = " << m_sample_group << "," << std::endl
+        << "  variance_count = " << m_variance_count << "," << std::endl
         << "  warn_negative = " << m_warn_negative << "," << std::endl
         << "  warn_invalid = " << m_warn_invalid << "," << std::endl
         << "  rfilter = " << (m_rfilter ? string::indent(m_rfilter) : "BoxFilter[]")
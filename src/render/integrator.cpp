@@ -1,13 +1,19 @@
+#include <chrono>
 #include <mutex>
+#include <condition_variable>
 
 #include <drjit/morton.h>
+#include <mitsuba/core/arena.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/zstream.h>
+#include <mitsuba/render/emittercache.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/sampler.h>
@@ -64,6 +70,30 @@ MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Propert
         m_block_size = block_size;
     }
 
+    m_adaptive_blocks = props.get<bool>("adaptive_blocks", true);
+    m_numa = props.get<bool>("numa", false);
+    m_filter_sampling = props.get<bool>("filter_importance_sampling", false);
+
+    // Region of interest that is rendered before the rest of the image
+    m_priority_offset = ScalarPoint2i(props.get<int>("priority_offset_x", 0),
+                                      props.get<int>("priority_offset_y", 0));
+    m_priority_size = ScalarVector2u(props.get<uint32_t>("priority_width", 0),
+                                     props.get<uint32_t>("priority_height", 0));
+
+    // Adaptive sampling (disabled unless a target relative error is given)
+    m_adaptive_threshold = props.get<ScalarFloat>("adaptive_threshold", 0.f);
+    m_adaptive_min_spp = props.get<uint32_t>("adaptive_min_spp", 16);
+    m_adaptive_max_spp = props.get<uint32_t>("adaptive_max_spp", 0);
+    if (m_adaptive_threshold < 0.f)
+        Throw("\"adaptive_threshold\" must be a nonnegative value!");
+    if (m_adaptive_min_spp < 2)
+        Throw("\"adaptive_min_spp\" must be at least 2!");
+
+    // Wall-clock time to spend on every render (disabled unless positive)
+    m_time_budget = props.get<ScalarFloat>("time_budget", 0.f);
+    if (m_time_budget < 0.f)
+        Throw("\"time_budget\" must be a nonnegative value!");
+
     m_samples_per_pass = props.get<uint32_t>("samples_per_pass", (uint32_t) -1);
     if (m_samples_per_pass != (uint32_t) -1) {
         Log(Warn, "The 'samples_per_pass' is deprecated, as a poor choice of "
@@ -75,6 +105,13 @@ MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Propert
 
 MI_VARIANT SamplingIntegrator<Float, Spectrum>::~SamplingIntegrator() { }
 
+MI_VARIANT void
+SamplingIntegrator<Float, Spectrum>::set_state_file(const fs::path &path,
+                                                    bool resume) {
+    m_state_file = path;
+    m_state_resume = resume;
+}
+
 MI_VARIANT typename SamplingIntegrator<Float, Spectrum>::TensorXf
 SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                                             Sensor *sensor,
@@ -85,10 +122,15 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
     ScopedPhase sp(ProfilerPhase::Render);
     m_stop = false;
 
-    // Render on a larger film if the 'high quality edges' feature is enabled
+    /* With filter importance sampling, every sample is added to a single
+       pixel with a box weight, hence the image blocks need no border */
     Film *film = sensor->film();
+    bool filter_sampling = m_filter_sampling && !film->rfilter()->is_box_filter(),
+         sample_border   = film->sample_border() && !filter_sampling;
+
+    // Render on a larger film if the 'high quality edges' feature is enabled
     ScalarVector2u film_size = film->crop_size();
-    if (film->sample_border())
+    if (sample_border)
         film_size += 2 * film->rfilter()->border_size();
 
     // Potentially adjust the number of samples per pixel if spp != 0
@@ -110,9 +152,43 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
     // Determine output channels and prepare the film with this information
     size_t n_channels = film->prepare(aov_names());
 
+    ScalarFloat adaptive_threshold = m_adaptive_threshold;
+    if (adaptive_threshold > 0.f &&
+        has_flag(film->flags(), FilmFlags::Special)) {
+        Log(Warn, "render(): adaptive sampling is not supported by the film "
+                  "\"%s\", disabling it.", film->class_()->name());
+        adaptive_threshold = 0.f;
+    }
+
+    /* Blocks record the per-pixel variance of the AOVs selected by
+       variance_aovs(), which follow the R, G, B, [A], W channels */
+    uint32_t var_source, var_target, var_count;
+    std::tie(var_source, var_target, var_count) = variance_aovs();
+    if (var_count && has_flag(film->flags(), FilmFlags::Special)) {
+        Log(Warn, "render(): recording the variance is not supported by the "
+                  "film \"%s\", disabling it.", film->class_()->name());
+        var_count = 0;
+    }
+    uint32_t base_channels =
+        (uint32_t) (n_channels - aov_names().size());
+    auto record_variance = [&](ImageBlock *block) {
+        if (var_count)
+            block->set_variance(base_channels + var_source,
+                                base_channels + var_target, var_count,
+                                base_channels - 1 /* weight */);
+    };
+
     // Start the render timer (used for timeouts & log messages)
     m_render_timer.reset();
 
+    /* With a time budget, the number of samples of the passes is chosen
+       from the measured throughput of the previous ones, and the render
+       stops when the budget is used up (at the latest when it expires) */
+    bool budgeted = m_time_budget > 0.f && !m_warmup;
+    auto out_of_time = [&]() {
+        return budgeted && m_render_timer.value() > 1000.f * m_time_budget;
+    };
+
     TensorXf result;
     if constexpr (!dr::is_jit_v<Float>) {
         // Render on the CPU using a spiral pattern
@@ -125,6 +201,22 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
 
         if (m_timeout > 0.f)
             Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
+        if (budgeted)
+            Log(Info, "Time budget specified: %.2f seconds.", m_time_budget);
+
+        /* Pin the workers to NUMA nodes, and let the workers of each node
+           accumulate into a film-sized image block placed in local memory */
+        uint32_t n_nodes = 0;
+        if (m_numa) {
+            n_nodes = std::min((uint32_t) Thread::numa_nodes().size(), n_threads);
+            if (n_nodes > 1)
+                Log(Info, "NUMA-aware rendering: %u nodes, %u threads per node.",
+                    n_nodes, n_threads / n_nodes);
+            else
+                n_nodes = 0;
+        }
+        std::vector<ref<ImageBlock>> node_blocks(n_nodes);
+        std::unique_ptr<std::mutex[]> node_mutex(new std::mutex[n_nodes]);
 
         // If no block size was specified, find size that is good for parallelization
         uint32_t block_size = m_block_size;
@@ -139,7 +231,29 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
             }
         }
 
-        Spiral spiral(film_size, film->crop_offset(), block_size, n_passes);
+        /* Adaptive sampling and time budgets render the image in rounds of
+           'round_spp' samples per pixel */
+        bool adaptive = adaptive_threshold > 0.f,
+             progressive = adaptive || budgeted;
+        std::vector<PixelStatistics> stats;
+        uint32_t round_spp = spp_per_pass, spp_done = 0;
+        uint64_t budget = (uint64_t) spp * dr::prod(film_size);
+
+        ScalarPoint2i stats_origin(film->crop_offset());
+        if (sample_border)
+            stats_origin -= film->rfilter()->border_size();
+
+        if (adaptive) {
+            stats.resize(dr::prod(film_size));
+            round_spp = std::min(m_adaptive_min_spp, spp);
+        }
+
+        // The first round of a time budget measures the throughput
+        if (budgeted)
+            round_spp = 1;
+
+        if (progressive)
+            n_passes = 1;
 
         std::mutex mutex;
         ref<ProgressReporter> progress;
@@ -147,61 +261,262 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         if (logger && Info >= logger->log_level())
             progress = new ProgressReporter("Rendering");
 
-        // Total number of blocks to be handled, including multiple passes.
-        uint32_t total_blocks = spiral.block_count() * n_passes,
-                 blocks_done = 0;
-
-        // Grain size for parallelization
-        uint32_t grain_size = std::max(total_blocks / (4 * n_threads), 1u);
+        // Total number of samples to be taken, including multiple passes.
+        uint64_t total_samples = progressive ? budget
+                                          : (uint64_t) dr::prod(film_size) *
+                                                n_passes * spp_per_pass,
+                 samples_done = 0;
 
         // Avoid overlaps in RNG seeding RNG when a seed is manually specified
         seed *= dr::prod(film_size);
 
-        ThreadEnvironment env;
-        dr::parallel_for(
-            dr::blocked_range<uint32_t>(0, total_blocks, grain_size),
-            [&](const dr::blocked_range<uint32_t> &range) {
-                ScopedSetThreadEnvironment set_env(env);
-                // Fork a non-overlapping sampler for the current worker
-                ref<Sampler> sampler = sensor->sampler()->fork();
+        // Save the render state after each pass, possibly resuming from it
+        bool save = !m_state_file.empty();
+        uint32_t passes_done = 0;
+        if (save && progressive) {
+            Log(Warn, "render(): the render state cannot be saved when "
+                      "adaptive sampling or a time budget is enabled.");
+            save = false;
+        }
 
-                ref<ImageBlock> block = film->create_block(
-                    ScalarVector2u(block_size) /* size */,
-                    false /* normalize */,
-                    true /* border */);
+        if (save && m_state_resume && fs::exists(m_state_file)) {
+            passes_done = load_state(film, seed, spp, spp_per_pass, n_channels);
+            samples_done = (uint64_t) dr::prod(film_size) * passes_done *
+                           spp_per_pass;
+            Log(Info, "Resuming from \"%s\" (%u/%u pass%s done).",
+                m_state_file.string(), passes_done, n_passes,
+                n_passes == 1 ? "" : "es");
+        }
 
-                std::unique_ptr<Float[]> aovs(new Float[n_channels]);
+        render_begin(scene, n_passes);
+        EmitterCache *emitter_cache = scene->emitter_cache();
+        bool pass_callback = needs_pass_callback() ||
+                             (emitter_cache && emitter_cache->training());
+        uint32_t pass_index = 0;
+
+        for (uint32_t round = 0; passes_done < n_passes; ++round) {
+            Timer round_timer;
+            uint64_t samples_before = samples_done;
+
+            /* Resumed renders generate the remaining passes with the block
+               identifiers (and thus seeds) of an uninterrupted render */
+            Spiral spiral(film_size, film->crop_offset(), block_size,
+                          n_passes - passes_done);
+
+            // Split expensive blocks and let idle workers pick up the pieces
+            if (m_adaptive_blocks)
+                spiral.set_adaptive(n_threads);
+
+            // Refine the region of interest (if any) first
+            if (dr::prod(m_priority_size) > 0)
+                spiral.set_priority_region(m_priority_offset, m_priority_size);
+
+            /* Wait for all workers at the end of each pass to save the state
+               or to notify the integrator */
+            if (save || pass_callback)
+                spiral.set_pass_barrier(true);
+
+            // Every round of adaptive sampling uses a distinct range of seeds
+            uint32_t round_seed =
+                seed + round * spiral.block_count() * block_size * block_size;
+
+            ThreadEnvironment env;
+            do {
+                dr::parallel_for(
+                    dr::blocked_range<uint32_t>(0, n_threads, 1),
+                    [&](const dr::blocked_range<uint32_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+
+                        std::unique_ptr<ScopedNumaAffinity> affinity;
+                        ImageBlock *node_block = nullptr;
+                        uint32_t node = 0;
+                        if (n_nodes) {
+                            node = range.begin() * n_nodes / n_threads;
+                            affinity.reset(new ScopedNumaAffinity(node));
+
+                            // The first worker of a node allocates (and first touches) its block
+                            std::lock_guard<std::mutex> lock(node_mutex[node]);
+                            if (!node_blocks[node])
+                                node_blocks[node] = film->create_block(
+                                    ScalarVector2u(0) /* crop size */,
+                                    false /* normalize */,
+                                    !filter_sampling /* border */);
+                            node_block = node_blocks[node].get();
+                        }
+
+                        // Fork a non-overlapping sampler for the current worker
+                        ref<Sampler> sampler = sensor->sampler()->fork();
+
+                        ref<ImageBlock> block = film->create_block(
+                            ScalarVector2u(block_size) /* size */,
+                            false /* normalize */,
+                            !filter_sampling /* border */);
+                        if (filter_sampling)
+                            block->set_rfilter(nullptr);
+                        record_variance(block.get());
+
+                        std::unique_ptr<Float[]> aovs(new Float[n_channels]);
+
+                        // Render tiles until the spiral is exhausted
+                        while (!should_stop() && !out_of_time()) {
+                            auto [offset, size, block_id, tile_size] = spiral.next_tile();
+                            if (dr::prod(size) == 0)
+                                break;
+
+                            if (sample_border)
+                                offset -= film->rfilter()->border_size();
+
+                            block->set_size(size);
+                            block->set_offset(offset);
+
+                            auto start = std::chrono::steady_clock::now();
+                            {
+                                ScopedTraceEvent trace("render_block", "render");
+                                if (adaptive)
+                                    render_block_adaptive(scene, sensor, sampler, block,
+                                                          aovs.get(), round_spp,
+                                                          round_seed, block_id,
+                                                          tile_size, stats.data(),
+                                                          stats_origin, film_size.x(),
+                                                          adaptive_threshold);
+                                else
+                                    render_block(scene, sensor, sampler, block,
+                                                 aovs.get(), round_spp, round_seed,
+                                                 block_id, tile_size);
+                            }
+
+                            if (node_block) {
+                                std::lock_guard<std::mutex> lock(node_mutex[node]);
+                                node_block->put_block(block);
+                            } else {
+                                film->put_block(block);
+                            }
+
+                            std::chrono::duration<float, std::milli> elapsed =
+                                std::chrono::steady_clock::now() - start;
+                            spiral.record_time(block_id, tile_size, elapsed.count());
+
+                            /* Critical section: update progress bar */
+                            if (progress) {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                samples_done +=
+                                    (uint64_t) dr::prod(size) * round_spp;
+                                progress->update(std::min(
+                                    samples_done / (float) total_samples, 1.f));
+                            }
+                        }
+                    }
+                );
+
+                // Merge the per-node blocks into the film
+                for (ref<ImageBlock> &node_block : node_blocks) {
+                    if (!node_block)
+                        continue;
+                    film->put_block(node_block);
+                    node_block->clear();
+                }
 
-                // Render up to 'grain_size' image blocks
-                for (uint32_t i = range.begin();
-                     i != range.end() && !should_stop(); ++i) {
-                    auto [offset, size, block_id] = spiral.next_block();
-                    Assert(dr::prod(size) != 0);
+                if (!(save || pass_callback) || should_stop() || out_of_time())
+                    break;
 
-                    if (film->sample_border())
-                        offset -= film->rfilter()->border_size();
+                // All workers are done with the pass
+                if (pass_callback) {
+                    if (emitter_cache && emitter_cache->training())
+                        emitter_cache->update();
+                    render_pass_end(pass_index++);
+                }
 
-                    block->set_size(size);
-                    block->set_offset(offset);
+                // Save the render state
+                if (save) {
+                    passes_done = n_passes - spiral.passes_left() + 1;
+                    save_state(film, seed, spp, spp_per_pass, passes_done);
+                }
+            } while (spiral.next_pass());
+
+            if (!progressive || should_stop() || out_of_time())
+                break;
+
+            // Count the samples taken so far and the unconverged pixels
+            uint64_t samples_used = 0, active = dr::prod(film_size);
+            spp_done += round_spp;
+            if (adaptive) {
+                active = 0;
+                for (const PixelStatistics &ps : stats) {
+                    samples_used += ps.count;
+                    active += ps.converged ? 0 : 1;
+                }
 
-                    render_block(scene, sensor, sampler, block, aovs.get(),
-                                 spp_per_pass, seed, block_id, block_size);
+                if (active == 0 || samples_used >= budget) {
+                    Log(Info, "Adaptive sampling: %.1f samples per pixel on "
+                              "average, %.2f%% of pixels unconverged.",
+                        samples_used / (double) stats.size(),
+                        100.0 * active / (double) stats.size());
+                    break;
+                }
 
-                    film->put_block(block);
+                // Spend the remaining budget on the unconverged pixels
+                round_spp = (uint32_t) std::min<uint64_t>(
+                    m_adaptive_min_spp,
+                    std::max<uint64_t>((budget - samples_used) / active, 1));
+            } else {
+                samples_used = (uint64_t) spp_done * active;
+                if (spp_done >= spp)
+                    break;
+                round_spp = spp - spp_done;
+            }
 
-                    /* Critical section: update progress bar */
-                    if (progress) {
-                        std::lock_guard<std::mutex> lock(mutex);
-                        blocks_done++;
-                        progress->update(blocks_done / (float) total_blocks);
-                    }
+            if (budgeted) {
+                /* Fit the next round into the remaining time, based on the
+                   throughput of the last one */
+                double round_time = std::max((double) round_timer.value(), 1.0),
+                       remaining  = 1000.0 * m_time_budget - m_render_timer.value(),
+                       throughput = (double) (samples_used - samples_before) / round_time;
+                uint64_t affordable =
+                    (uint64_t) std::max(remaining * throughput / (double) active, 0.0);
+                if (affordable == 0) {
+                    Log(Info, "Time budget: %.1f samples per pixel on average "
+                              "(%.2f seconds unused).",
+                        samples_used / (double) dr::prod(film_size),
+                        std::max(remaining, 0.0) / 1000.0);
+                    break;
                 }
+                round_spp = (uint32_t) std::min<uint64_t>(round_spp, affordable);
             }
-        );
+
+            samples_done = samples_used;
+        }
 
         if (develop)
             result = film->develop();
     } else {
+        if (!m_state_file.empty())
+            Log(Warn, "render(): the render state is only saved in scalar "
+                      "variants.");
+
+        if (dr::prod(m_priority_size) > 0)
+            Log(Warn, "render(): priority regions are only supported in "
+                      "scalar variants.");
+
+        /* Adaptive sampling renders passes of 'adaptive_min_spp' samples and
+           masks out pixels that have converged after each pass */
+        bool adaptive = adaptive_threshold > 0.f;
+        uint32_t max_spp = m_adaptive_max_spp > 0 ? m_adaptive_max_spp : 4 * spp;
+        if (adaptive) {
+            spp_per_pass = std::min(m_adaptive_min_spp, spp);
+            n_passes = (max_spp + spp_per_pass - 1) / spp_per_pass;
+        }
+
+        /* A time budget splits the render into passes of about 2^20 samples
+           (unless specified otherwise), and stops before a pass that would
+           not fit into the remaining time */
+        if (budgeted && !adaptive && m_samples_per_pass == (uint32_t) -1) {
+            spp_per_pass = (uint32_t) std::min<uint64_t>(
+                std::max<uint64_t>((1u << 20) / dr::prod(film_size), 1), spp);
+            while (spp % spp_per_pass != 0)
+                spp_per_pass--;
+            n_passes = spp / spp_per_pass;
+        }
+
         size_t wavefront_size = (size_t) film_size.x() *
                                 (size_t) film_size.y() * (size_t) spp_per_pass,
                wavefront_size_limit = 0xffffffffu;
@@ -222,6 +537,14 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                 wavefront_size, n_passes);
         }
 
+        /* Launch sizes are not part of the generated code: warm-up renders
+           evaluate only one or two pixels using the very same kernels */
+        if (m_warmup) {
+            wavefront_size = std::max<size_t>(spp_per_pass, 2);
+            Log(Info, "Warming up the kernel cache (evaluating %zu samples).",
+                wavefront_size);
+        }
+
         dr::sync_thread(); // Separate from scene initialization (for timings)
 
         Log(Info, "Starting render job (%ux%u, %u sample%s%s)",
@@ -243,6 +566,12 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         // Allocate a large image block that will receive the entire rendering
         ref<ImageBlock> block = film->create_block();
         block->set_offset(film->crop_offset());
+        if (filter_sampling)
+            block->set_rfilter(nullptr);
+
+        // Samples of a pixel occupy consecutive lanes (see 'idx' below)
+        block->set_sample_group(spp_per_pass);
+        record_variance(block.get());
 
         // Only use the ImageBlock coalescing feature when rendering enough samples
         block->set_coalesce(block->coalesce() && spp_per_pass >= 4);
@@ -257,32 +586,110 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         else
             idx /= dr::opaque<UInt32>(spp_per_pass);
 
+        // Per-pixel sample statistics for adaptive sampling
+        uint32_t pixel_count = dr::prod(film_size);
+        uint64_t budget = (uint64_t) spp * pixel_count;
+        Float stats_sum, stats_sum2, stats_count;
+        Bool converged;
+        if (adaptive) {
+            stats_sum = dr::zeros<Float>(pixel_count);
+            stats_sum2 = dr::zeros<Float>(pixel_count);
+            stats_count = dr::zeros<Float>(pixel_count);
+            converged = dr::full<Bool>(false, pixel_count);
+        }
+
         // Compute the position on the image plane
         Vector2u pos;
         pos.y() = idx / film_size[0];
         pos.x() = dr::fnmadd(film_size[0], pos.y(), idx);
 
-        if (film->sample_border())
+        if (sample_border)
             pos -= film->rfilter()->border_size();
 
         pos += film->crop_offset();
 
+        sampler->set_pixel_position(Point2u(pos));
+
         // Scale factor that will be applied to ray differentials
         ScalarFloat diff_scale_factor = dr::rsqrt((ScalarFloat) spp);
 
         Timer timer;
         std::unique_ptr<Float[]> aovs(new Float[n_channels]);
 
+        render_begin(scene, n_passes);
+        EmitterCache *emitter_cache = scene->emitter_cache();
+        bool pass_callback = needs_pass_callback() ||
+                             (emitter_cache && emitter_cache->training());
+
         // Potentially render multiple passes
+        Timer pass_timer;
         for (size_t i = 0; i < n_passes; i++) {
+            Mask active = true;
+            if (adaptive)
+                active = !dr::gather<Bool>(converged, idx);
+
             render_sample(scene, sensor, sampler, block, aovs.get(), pos,
-                          diff_scale_factor);
+                          diff_scale_factor, active);
+
+            if (adaptive) {
+                Float value = luminance(
+                    Color3f(aovs.get()[0], aovs.get()[1], aovs.get()[2]));
+                dr::scatter_reduce(ReduceOp::Add, stats_sum, value, idx, active);
+                dr::scatter_reduce(ReduceOp::Add, stats_sum2, dr::sqr(value),
+                                   idx, active);
+                dr::scatter_reduce(ReduceOp::Add, stats_count, Float(1.f), idx,
+                                   active);
+            }
 
             if (n_passes > 1) {
                 sampler->advance(); // Will trigger a kernel launch of size 1
                 sampler->schedule_state();
                 dr::eval(block->tensor());
             }
+
+            if (pass_callback) {
+                if (emitter_cache && emitter_cache->training())
+                    emitter_cache->update();
+                render_pass_end((uint32_t) i);
+            }
+
+            if (adaptive) {
+                // Relative standard error of the per-pixel estimates
+                Float n        = dr::maximum(stats_count, 2.f),
+                      mean     = stats_sum / n,
+                      variance = dr::maximum(stats_sum2 / n - dr::sqr(mean), 0.f) *
+                                 n / (n - 1.f),
+                      error    = dr::sqrt(variance / n) /
+                                 dr::maximum(dr::abs(mean), 1e-3f);
+
+                converged = (stats_count >= (ScalarFloat) m_adaptive_min_spp &&
+                             error < adaptive_threshold) ||
+                            stats_count >= (ScalarFloat) max_spp;
+
+                Float samples_used = dr::sum(stats_count),
+                      active_count = dr::sum(dr::select(converged, 0.f, 1.f));
+                dr::eval(converged, samples_used, active_count);
+
+                if (dr::slice(active_count) == 0.f ||
+                    dr::slice(samples_used) >= (ScalarFloat) budget) {
+                    Log(Info, "Adaptive sampling: %.1f samples per pixel on "
+                              "average, %.2f%% of pixels unconverged.",
+                        dr::slice(samples_used) / pixel_count,
+                        100.f * dr::slice(active_count) / pixel_count);
+                    break;
+                }
+            }
+
+            if (budgeted && i + 1 < n_passes) {
+                // Assume that the next pass takes as long as the last one
+                dr::sync_thread();
+                float pass_time = (float) pass_timer.reset();
+                if (m_render_timer.value() + pass_time > 1000.f * m_time_budget) {
+                    Log(Info, "Time budget: stopping after %zu of %u passes.",
+                        i + 1, n_passes);
+                    break;
+                }
+            }
         }
 
         film->put_block(block);
@@ -324,6 +731,23 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
     return result;
 }
 
+MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_begin(const Scene *,
+                                                                   uint32_t) { }
+
+MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_pass_end(uint32_t) { }
+
+MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_tile(
+    const Scene *scene, const Sensor *sensor, Sampler *sampler,
+    ImageBlock *block, uint32_t seed, uint32_t sample_count,
+    uint32_t block_id, uint32_t block_size) const {
+    if constexpr (dr::is_jit_v<Float>)
+        Throw("render_tile(): only supported in scalar variants!");
+
+    std::unique_ptr<Float[]> aovs(new Float[block->channel_count()]);
+    render_block(scene, sensor, sampler, block, aovs.get(), sample_count,
+                 seed, block_id, block_size);
+}
+
 MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *scene,
                                                                    const Sensor *sensor,
                                                                    Sampler *sampler,
@@ -346,6 +770,9 @@ MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *s
         // Clear block (it's being reused)
         block->clear();
 
+        // Temporaries allocated from the thread's arena are released per block
+        MemoryArena::Scope arena_scope;
+
         for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
             sampler->seed(seed + i);
 
@@ -353,11 +780,92 @@ MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *s
             if (dr::any(pos >= block->size()))
                 continue;
 
-            Point2f pos_f = Point2f(Point2i(pos) + block->offset());
+            Point2i pos_i = Point2i(pos) + block->offset();
+            sampler->set_pixel_position(Point2u(pos_i));
+
+            Point2f pos_f = Point2f(pos_i);
+            for (uint32_t j = 0; j < sample_count && !should_stop(); ++j) {
+                render_sample(scene, sensor, sampler, block, aovs, pos_f,
+                              diff_scale_factor);
+                sampler->advance();
+            }
+        }
+    } else {
+        DRJIT_MARK_USED(scene);
+        DRJIT_MARK_USED(sensor);
+        DRJIT_MARK_USED(sampler);
+        DRJIT_MARK_USED(block);
+        DRJIT_MARK_USED(aovs);
+        DRJIT_MARK_USED(sample_count);
+        DRJIT_MARK_USED(seed);
+        DRJIT_MARK_USED(block_id);
+        DRJIT_MARK_USED(block_size);
+        Throw("Not implemented for JIT arrays.");
+    }
+}
+
+MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block_adaptive(
+    const Scene *scene, const Sensor *sensor, Sampler *sampler,
+    ImageBlock *block, Float *aovs, uint32_t sample_count, uint32_t seed,
+    uint32_t block_id, uint32_t block_size, PixelStatistics *stats,
+    const ScalarPoint2i &stats_origin, uint32_t stats_width,
+    ScalarFloat threshold) const {
+
+    if constexpr (!dr::is_array_v<Float>) {
+        uint32_t pixel_count = block_size * block_size,
+                 max_spp = m_adaptive_max_spp > 0
+                               ? m_adaptive_max_spp
+                               : 4 * sensor->sampler()->sample_count();
+
+        // Avoid overlaps in RNG seeding RNG when a seed is manually specified
+        seed += block_id * pixel_count;
+
+        // Scale down ray differentials when tracing multiple rays per pixel
+        Float diff_scale_factor =
+            dr::rsqrt((Float) sensor->sampler()->sample_count());
+
+        // Clear block (it's being reused)
+        block->clear();
+
+        // Temporaries allocated from the thread's arena are released per block
+        MemoryArena::Scope arena_scope;
+
+        for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+            Point2u pos = dr::morton_decode<Point2u>(i);
+            if (dr::any(pos >= block->size()))
+                continue;
+
+            Point2i pos_i = Point2i(pos) + block->offset(),
+                    rel = pos_i - stats_origin;
+            PixelStatistics &ps = stats[rel.y() * stats_width + rel.x()];
+            if (ps.converged)
+                continue;
+
+            sampler->seed(seed + i);
+            sampler->set_pixel_position(Point2u(pos_i));
+
+            Point2f pos_f = Point2f(pos_i);
             for (uint32_t j = 0; j < sample_count && !should_stop(); ++j) {
                 render_sample(scene, sensor, sampler, block, aovs, pos_f,
                               diff_scale_factor);
                 sampler->advance();
+
+                // Welford's online update of the luminance mean and variance
+                Float value = luminance(Color3f(aovs[0], aovs[1], aovs[2])),
+                      delta = value - ps.mean;
+                ps.count++;
+                ps.mean += delta / ps.count;
+                ps.m2 += delta * (value - ps.mean);
+            }
+
+            if (ps.count >= max_spp) {
+                ps.converged = true;
+            } else if (ps.count >= m_adaptive_min_spp) {
+                // Relative standard error of the pixel estimate
+                Float variance = ps.m2 / (ps.count - 1),
+                      error = dr::sqrt(variance / ps.count) /
+                              dr::maximum(dr::abs(ps.mean), 1e-3f);
+                ps.converged = error < threshold;
             }
         }
     } else {
@@ -370,6 +878,9 @@ MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *s
         DRJIT_MARK_USED(seed);
         DRJIT_MARK_USED(block_id);
         DRJIT_MARK_USED(block_size);
+        DRJIT_MARK_USED(stats);
+        DRJIT_MARK_USED(stats_origin);
+        DRJIT_MARK_USED(stats_width);
         Throw("Not implemented for JIT arrays.");
     }
 }
@@ -387,11 +898,26 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
     const bool has_alpha = has_flag(film->flags(), FilmFlags::Alpha);
     const bool box_filter = film->rfilter()->is_box_filter();
 
+    /* Importance sample the reconstruction filter if the block accumulates
+       samples with a box weight (i.e. the blocks of \ref render()) */
+    const bool filter_sampling =
+        m_filter_sampling && !box_filter && !block->rfilter();
+
     ScalarVector2f scale = 1.f / ScalarVector2f(film->crop_size()),
                    offset = -ScalarVector2f(film->crop_offset()) * scale;
 
-    Vector2f sample_pos   = pos + sampler->next_2d(active),
-             adjusted_pos = dr::fmadd(sample_pos, scale, offset);
+    Vector2f sample_pos;
+    Float filter_weight = 1.f;
+    if (filter_sampling) {
+        auto [filter_offset, weight] =
+            film->rfilter()->sample(sampler->next_2d(active), active);
+        sample_pos = pos + .5f + filter_offset;
+        filter_weight = weight;
+    } else {
+        sample_pos = pos + sampler->next_2d(active);
+    }
+
+    Vector2f adjusted_pos = dr::fmadd(sample_pos, scale, offset);
 
     Point2f aperture_sample(.5f);
     if (sensor->needs_aperture_sample())
@@ -444,8 +970,15 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
         }
     }
 
-    // With box filter, ignore random offset to prevent numerical instabilities
-    block->put(box_filter ? pos : sample_pos, aovs, active);
+    // Weight all channels (including the sample weight) by the filter
+    if (filter_sampling) {
+        for (uint32_t i = 0; i < block->channel_count(); ++i)
+            aovs[i] *= filter_weight;
+    }
+
+    /* With box filter (or filter importance sampling), ignore random offset
+       to prevent numerical instabilities */
+    block->put(box_filter || filter_sampling ? pos : sample_pos, aovs, active);
 }
 
 MI_VARIANT std::pair<Spectrum, typename SamplingIntegrator<Float, Spectrum>::Mask>
@@ -458,6 +991,115 @@ SamplingIntegrator<Float, Spectrum>::sample(const Scene * /* scene */,
     NotImplementedError("sample");
 }
 
+/// Identifies render state files written by SamplingIntegrator::save_state()
+static constexpr uint32_t MI_RENDER_STATE_MAGIC = 0x5453524D; // "MRST"
+static constexpr uint32_t MI_RENDER_STATE_VERSION = 1;
+
+MI_VARIANT void SamplingIntegrator<Float, Spectrum>::save_state(
+    const Film *film, uint32_t seed, uint32_t spp, uint32_t spp_per_pass,
+    uint32_t passes_done) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        TensorXf data = film->develop(true /* raw */);
+
+        // Write to a temporary file so that the previous state survives a crash
+        fs::path temp = fs::path(m_state_file.string() + ".tmp");
+        /* scope */ {
+            ref<FileStream> file = new FileStream(temp, FileStream::ETruncReadWrite);
+            file->set_byte_order(Stream::ELittleEndian);
+            file->write(MI_RENDER_STATE_MAGIC);
+            file->write(MI_RENDER_STATE_VERSION);
+
+            ref<ZStream> stream = new ZStream(file);
+            stream->set_byte_order(Stream::ELittleEndian);
+            stream->write(seed);
+            stream->write(spp);
+            stream->write(spp_per_pass);
+            stream->write(passes_done);
+            stream->write((uint32_t) sizeof(ScalarFloat));
+            for (size_t i = 0; i < 3; ++i)
+                stream->write((uint32_t) data.shape(i));
+            stream->write_array(data.data(), data.size());
+            stream->close();
+            file->close();
+        }
+
+        if (fs::exists(m_state_file))
+            fs::remove(m_state_file);
+        if (!fs::rename(temp, m_state_file))
+            Throw("Could not write the render state \"%s\"!",
+                  m_state_file.string());
+
+        Log(Debug, "Saved the render state after %u pass%s to \"%s\".",
+            passes_done, passes_done == 1 ? "" : "es", m_state_file.string());
+    } else {
+        DRJIT_MARK_USED(film);
+        DRJIT_MARK_USED(seed);
+        DRJIT_MARK_USED(spp);
+        DRJIT_MARK_USED(spp_per_pass);
+        DRJIT_MARK_USED(passes_done);
+        NotImplementedError("save_state");
+    }
+}
+
+MI_VARIANT uint32_t SamplingIntegrator<Float, Spectrum>::load_state(
+    Film *film, uint32_t seed, uint32_t spp, uint32_t spp_per_pass,
+    size_t channels) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        ref<FileStream> file = new FileStream(m_state_file);
+        file->set_byte_order(Stream::ELittleEndian);
+
+        uint32_t magic = 0, version = 0;
+        file->read(magic);
+        file->read(version);
+        if (magic != MI_RENDER_STATE_MAGIC)
+            Throw("\"%s\" is not a render state file!", m_state_file.string());
+        if (version != MI_RENDER_STATE_VERSION)
+            Throw("Unsupported version %u of the render state \"%s\"!",
+                  version, m_state_file.string());
+
+        ref<ZStream> stream = new ZStream(file);
+        stream->set_byte_order(Stream::ELittleEndian);
+
+        uint32_t state_seed, state_spp, state_spp_per_pass, passes_done,
+            float_size, shape[3];
+        stream->read(state_seed);
+        stream->read(state_spp);
+        stream->read(state_spp_per_pass);
+        stream->read(passes_done);
+        stream->read(float_size);
+        for (size_t i = 0; i < 3; ++i)
+            stream->read(shape[i]);
+
+        ScalarVector2u size = film->crop_size();
+
+        if (state_seed != seed || state_spp != spp ||
+            state_spp_per_pass != spp_per_pass)
+            Throw("The render state \"%s\" was saved with a different seed or "
+                  "sample count!", m_state_file.string());
+        if (float_size != sizeof(ScalarFloat) || shape[0] != size.y() ||
+            shape[1] != size.x() || shape[2] != channels)
+            Throw("The render state \"%s\" does not match the film (variant, "
+                  "size or channels differ)!", m_state_file.string());
+        if (passes_done > spp / spp_per_pass)
+            Throw("The render state \"%s\" is corrupt!", m_state_file.string());
+
+        // Merge the saved pixels into the (cleared) film storage
+        ref<ImageBlock> block = new ImageBlock(
+            size, ScalarPoint2i(film->crop_offset()), (uint32_t) channels);
+        stream->read_array(block->tensor().data(), block->tensor().size());
+        film->put_block(block);
+
+        return passes_done;
+    } else {
+        DRJIT_MARK_USED(film);
+        DRJIT_MARK_USED(seed);
+        DRJIT_MARK_USED(spp);
+        DRJIT_MARK_USED(spp_per_pass);
+        DRJIT_MARK_USED(channels);
+        NotImplementedError("load_state");
+    }
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::MonteCarloIntegrator(const Properties &props)
@@ -483,10 +1125,42 @@ MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::~MonteCarloIntegrator() { }
 
 // -----------------------------------------------------------------------------
 
+MI_VARIANT CppADIntegrator<Float, Spectrum>::CppADIntegrator(const Properties &props)
+    : Base(props) { }
+
+MI_VARIANT CppADIntegrator<Float, Spectrum>::~CppADIntegrator() { }
+
+MI_VARIANT std::tuple<Spectrum, typename CppADIntegrator<Float, Spectrum>::Mask, Spectrum>
+CppADIntegrator<Float, Spectrum>::sample_adjoint(dr::ADMode /* mode */,
+                                                 const Scene * /* scene */,
+                                                 Sampler * /* sampler */,
+                                                 const Ray3f & /* ray */,
+                                                 const Spectrum & /* delta_L */,
+                                                 const Spectrum & /* state_in */,
+                                                 Mask /* active */) const {
+    NotImplementedError("sample_adjoint");
+}
+
+MI_VARIANT std::pair<Spectrum, typename CppADIntegrator<Float, Spectrum>::Mask>
+CppADIntegrator<Float, Spectrum>::sample(const Scene *scene,
+                                         Sampler *sampler,
+                                         const RayDifferential3f &ray,
+                                         const Medium * /* medium */,
+                                         Float * /* aovs */,
+                                         Mask active) const {
+    auto result =
+        sample_adjoint(dr::ADMode::Primal, scene, sampler, Ray3f(ray),
+                       dr::zeros<Spectrum>(), dr::zeros<Spectrum>(), active);
+    return { std::get<0>(result), std::get<1>(result) };
+}
+
+// -----------------------------------------------------------------------------
+
 MI_VARIANT AdjointIntegrator<Float, Spectrum>::AdjointIntegrator(const Properties &props)
     : Base(props) {
 
     m_samples_per_pass = props.get<uint32_t>("samples_per_pass", (uint32_t) -1);
+    m_block_budget = (size_t) props.get<uint32_t>("block_budget", 256) << 20;
 
     m_rr_depth = props.get<int>("rr_depth", 5);
     if (m_rr_depth <= 0)
@@ -581,6 +1255,61 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
         // Start the render timer (used for timeouts & log messages)
         m_render_timer.reset();
 
+        /* Splats land on arbitrary pixels, hence every worker accumulates
+           into a private full-resolution block taken from a shared pool.
+           Blocks are only merged once all samples are done. The number of
+           blocks is bounded by the per-thread memory budget, beyond which
+           workers wait for a block to be returned to the pool. */
+        auto create_block = [&]() {
+            ref<ImageBlock> block = film->create_block(
+                ScalarVector2u(0) /* use crop size */,
+                true /* normalize */,
+                false /* border */);
+            block->set_offset(film->crop_offset());
+            block->clear();
+            return block;
+        };
+
+        std::vector<ref<ImageBlock>> blocks = { create_block() };
+        std::vector<ImageBlock *> free_blocks = { blocks[0].get() };
+        std::condition_variable block_cv;
+        size_t blocks_created = 1;
+
+        size_t block_bytes = blocks[0]->tensor().size() * sizeof(ScalarFloat);
+        size_t max_blocks = std::max(
+            (size_t) 1, std::min(n_threads + 1, (n_threads * m_block_budget) /
+                                                    std::max(block_bytes, (size_t) 1)));
+
+        auto acquire_block = [&]() -> ImageBlock * {
+            /* locked */ {
+                std::unique_lock<std::mutex> lock(mutex);
+                block_cv.wait(lock, [&] {
+                    return !free_blocks.empty() || blocks_created < max_blocks;
+                });
+                if (!free_blocks.empty()) {
+                    ImageBlock *block = free_blocks.back();
+                    free_blocks.pop_back();
+                    return block;
+                }
+                blocks_created++;
+            }
+
+            // Allocate the new block outside of the lock
+            ref<ImageBlock> block = create_block();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            blocks.push_back(block);
+            return block.get();
+        };
+
+        auto release_block = [&](ImageBlock *block) {
+            /* locked */ {
+                std::lock_guard<std::mutex> lock(mutex);
+                free_blocks.push_back(block);
+            }
+            block_cv.notify_one();
+        };
+
         ThreadEnvironment env;
         dr::parallel_for(
             dr::blocked_range<size_t>(0, total_samples, grain_size),
@@ -590,15 +1319,8 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
                 // Fork a non-overlapping sampler for the current worker
                 ref<Sampler> sampler = sensor->sampler()->clone();
 
-                ref<ImageBlock> block = film->create_block(
-                    ScalarVector2u(0) /* use crop size */,
-                    true /* normalize */,
-                    false /* border */);
-
-                block->set_offset(film->crop_offset());
-
-                // Clear block (it's being reused)
-                block->clear();
+                ImageBlock *block = acquire_block();
+                MemoryArena::Scope arena_scope;
 
                 sampler->seed(seed +
                               (uint32_t) range.begin() / (uint32_t) grain_size);
@@ -616,17 +1338,35 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
                         progress->update(samples_done / (ScalarFloat) total_samples);
                     }
                 }
-                total_samples += ctr;
-
-                // When all samples are done for this range, commit to the film
                 /* locked */ {
                     std::lock_guard<std::mutex> lock(mutex);
+                    samples_done += ctr;
                     progress->update(samples_done / (ScalarFloat) total_samples);
-                    film->put_block(block);
                 }
+
+                release_block(block);
             }
         );
 
+        // Reduce the private blocks in parallel and commit them to the film
+        /* scope */ {
+            TensorXf &target = blocks[0]->tensor();
+            ScalarFloat *dst = target.array().data();
+
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, target.size(), 1 << 14),
+                [&](const dr::blocked_range<size_t> &range) {
+                    for (size_t j = 1; j < blocks.size(); ++j) {
+                        const ScalarFloat *src = blocks[j]->tensor().array().data();
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                            dst[i] += src[i];
+                    }
+                }
+            );
+
+            film->put_block(blocks[0]);
+        }
+
         if (develop)
             result = film->develop();
     } else {
@@ -723,11 +1463,13 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
 MI_IMPLEMENT_CLASS_VARIANT(Integrator, Object, "integrator")
 MI_IMPLEMENT_CLASS_VARIANT(SamplingIntegrator, Integrator)
 MI_IMPLEMENT_CLASS_VARIANT(MonteCarloIntegrator, SamplingIntegrator)
+MI_IMPLEMENT_CLASS_VARIANT(CppADIntegrator, SamplingIntegrator)
 MI_IMPLEMENT_CLASS_VARIANT(AdjointIntegrator, Integrator)
 
 MI_INSTANTIATE_CLASS(Integrator)
 MI_INSTANTIATE_CLASS(SamplingIntegrator)
 MI_INSTANTIATE_CLASS(MonteCarloIntegrator)
+MI_INSTANTIATE_CLASS(CppADIntegrator)
 MI_INSTANTIATE_CLASS(AdjointIntegrator)
 
 NAMESPACE_END(mitsuba)
@@ -1,9 +1,66 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/mmap.h>
+#include <algorithm>
+#include <random>
+
+#if defined(_WIN32)
+#  include <process.h>
+#  define getpid _getpid
+#else
+#  include <unistd.h>
+#endif
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Header of a cached kd-tree file, followed by the node and index arrays
+struct KDTreeCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t node_size;
+    uint32_t scalar_size;
+    uint64_t key;
+    uint32_t node_count;
+    uint32_t index_count;
+};
+
+static constexpr uint32_t kdtree_cache_version = 1;
+
+/// Hash a memory region in parallel (64-bit FNV-1a over 1 MiB chunks)
+static uint64_t hash_memory(const void *ptr, size_t size) {
+    constexpr size_t chunk_size = 1 << 20;
+    size_t chunk_count = (size + chunk_size - 1) / chunk_size;
+    std::vector<uint64_t> chunk_hash(chunk_count);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, chunk_count, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                const uint8_t *start = (const uint8_t *) ptr + i * chunk_size;
+                size_t n = std::min(chunk_size, size - i * chunk_size);
+                uint64_t h = 0xcbf29ce484222325ull;
+                size_t j = 0;
+                for (; j + 8 <= n; j += 8) {
+                    uint64_t word;
+                    memcpy(&word, start + j, 8);
+                    h = (h ^ word) * 0x100000001b3ull;
+                }
+                for (; j < n; ++j)
+                    h = (h ^ start[j]) * 0x100000001b3ull;
+                chunk_hash[i] = h;
+            }
+        }
+    );
+
+    uint64_t result = size;
+    for (uint64_t h : chunk_hash)
+        result = (uint64_t) hash_combine((size_t) result, (size_t) h);
+    return result;
+}
+
 template <typename B, typename I, typename C, typename D>
 thread_local typename TShapeKDTree<B, I, C, D>::LocalBuildContext
     TShapeKDTree<B, I, C, D>::BuildTask::m_local = {};
@@ -48,6 +105,18 @@ MI_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(const Properties &props)
     if (props.has_property("kd_exact_primitive_threshold"))
         set_exact_primitive_threshold(props.get<int>("kd_exact_primitive_threshold"));
 
+    /* kd-tree construction: Directory used to cache built kd-trees across
+       runs. Disabled when empty. */
+    std::string cache_dir = props.string("kd_cache_dir", "");
+    if (!cache_dir.empty()) {
+        m_cache_dir = cache_dir;
+        m_cache_enabled = true;
+    }
+
+    /* kd-tree traversal: Store the triangles of each leaf in packed batches
+       of four, which are intersected using SIMD instructions. */
+    m_packed_leaves = props.get<bool>("kd_packed_leaves", true);
+
     m_primitive_map.push_back(0);
 }
 
@@ -60,6 +129,9 @@ MI_VARIANT void ShapeKDTree<Float, Spectrum>::clear() {
     m_indices.release();
     m_node_count = 0;
     m_index_count = 0;
+    m_sah_cost = dr::NaN<ScalarFloat>;
+    m_batches.clear();
+    m_leaf_batches.reset();
 }
 
 MI_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
@@ -67,15 +139,110 @@ MI_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
     Log(Info, "Building a SAH kd-tree (%i primitives) ..",
         primitive_count());
 
+    /* Only the initial build consults the cache: later rebuilds are caused
+       by parameter updates, which would otherwise flood the cache directory */
+    bool use_cache = m_cache_enabled && primitive_count() > 0;
+    m_cache_enabled = false;
+
+    uint64_t key = 0;
+    if (use_cache) {
+        key = cache_key();
+        if (cache_load(key)) {
+            pack_leaves();
+            Log(Info, "Loaded cached kd-tree. (took %s)",
+                util::time_string((float) timer.value()));
+            return;
+        }
+    }
+
     Base::build();
 
+    if (use_cache)
+        cache_store(key);
+
+    pack_leaves();
+
     Log(Info, "Finished. (%s of storage, took %s)",
-        util::mem_string(m_index_count * sizeof(Index) +
-                        m_node_count * sizeof(KDNode)),
+        util::mem_string(memory()),
         util::time_string((float) timer.value())
     );
 }
 
+MI_VARIANT void ShapeKDTree<Float, Spectrum>::pack_leaves() {
+    m_batches.clear();
+    m_leaf_batches.reset();
+    if (!m_packed_leaves || m_index_count == 0)
+        return;
+
+    using InputFloat = typename Mesh::InputFloat;
+    m_leaf_batches.reset(new LeafBatches[m_index_count]);
+
+    for (Size i = 0; i < m_node_count; ++i) {
+        const KDNode &node = m_nodes[i];
+        if (!node.leaf() || node.primitive_count() == 0)
+            continue;
+
+        Index *start = m_indices.get() + node.primitive_offset(),
+              *end   = start + node.primitive_count();
+
+        // Triangles come first, other shapes are intersected one by one
+        Index *mid = std::stable_partition(start, end, [&](Index prim) {
+            return m_shapes[find_shape(prim)]->is_mesh();
+        });
+
+        LeafBatches &lb = m_leaf_batches[node.primitive_offset()];
+        lb.offset    = (Index) m_batches.size();
+        lb.triangles = (Size) (mid - start);
+        lb.count     = (lb.triangles + 3) / 4;
+
+        for (Size j = 0; j < lb.triangles; j += 4) {
+            alignas(alignof(FloatP)) ScalarFloat buf[9][4];
+            TriangleBatch batch;
+
+            for (Size k = 0; k < 4; ++k) {
+                if (j + k >= lb.triangles) {
+                    // Vertices of unused lanes are NaN, which fails all tests
+                    for (size_t c = 0; c < 9; ++c)
+                        buf[c][k] = dr::NaN<ScalarFloat>;
+                    batch.shape_index[k] = batch.prim_index[k] = (Index) -1;
+                    continue;
+                }
+
+                Index prim = start[j + k],
+                      shape_index = find_shape(prim);
+                const Mesh *mesh = (const Mesh *) m_shapes[shape_index].get();
+
+                // Read the host buffers directly (also valid in LLVM variants)
+                const uint32_t *faces = (const uint32_t *) mesh->faces_buffer().data();
+                const InputFloat *positions =
+                    (const InputFloat *) mesh->vertex_positions_buffer().data();
+
+                ScalarPoint3f p[3];
+                for (size_t v = 0; v < 3; ++v) {
+                    const InputFloat *ptr = positions + 3 * (size_t) faces[3 * (size_t) prim + v];
+                    p[v] = ScalarPoint3f(ptr[0], ptr[1], ptr[2]);
+                }
+
+                ScalarVector3f e1 = p[1] - p[0], e2 = p[2] - p[0];
+                for (size_t c = 0; c < 3; ++c) {
+                    buf[c][k]     = p[0][c];
+                    buf[3 + c][k] = e1[c];
+                    buf[6 + c][k] = e2[c];
+                }
+                batch.shape_index[k] = shape_index;
+                batch.prim_index[k]  = prim;
+            }
+
+            for (size_t c = 0; c < 3; ++c) {
+                batch.p0[c] = dr::load_aligned<FloatP>(buf[c]);
+                batch.e1[c] = dr::load_aligned<FloatP>(buf[3 + c]);
+                batch.e2[c] = dr::load_aligned<FloatP>(buf[6 + c]);
+            }
+            m_batches.push_back(batch);
+        }
+    }
+}
+
 MI_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     Assert(!ready());
     m_primitive_map.push_back(m_primitive_map.back() +
@@ -84,6 +251,131 @@ MI_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     m_bbox.expand(shape->bbox());
 }
 
+MI_VARIANT uint64_t ShapeKDTree<Float, Spectrum>::cache_key() const {
+    const SurfaceAreaHeuristic3f &cm = Base::cost_model();
+    size_t key = hash(std::make_tuple(
+        cm.query_cost(), cm.traversal_cost(), cm.empty_space_bonus(),
+        Base::max_depth(), Base::min_max_bins(), Base::clip_primitives(),
+        Base::retract_bad_splits(), Base::max_bad_refines(),
+        Base::stop_primitives(), Base::exact_primitive_threshold(),
+        (uint32_t) sizeof(ScalarFloat)));
+
+    for (const ref<Shape> &shape : m_shapes) {
+        key = hash_combine(key, hash(std::string(shape->class_()->name())));
+        key = hash_combine(key, (size_t) shape->primitive_count());
+
+        if (shape->is_mesh()) {
+            // Hash the raw vertex and index buffers
+            Mesh *mesh = (Mesh *) shape.get();
+            auto &positions = mesh->vertex_positions_buffer();
+            auto &faces = mesh->faces_buffer();
+            key = hash_combine(key, hash_memory(
+                positions.data(),
+                dr::width(positions) * sizeof(typename Mesh::InputFloat)));
+            key = hash_combine(key, hash_memory(
+                faces.data(), dr::width(faces) * sizeof(uint32_t)));
+        } else {
+            // Other shapes are identified through their primitive bounds
+            for (Size i = 0; i < shape->primitive_count(); ++i) {
+                ScalarBoundingBox3f bbox = shape->bbox(i);
+                key = hash_combine(key, hash_memory(&bbox, sizeof(bbox)));
+            }
+        }
+    }
+
+    return (uint64_t) key;
+}
+
+MI_VARIANT bool ShapeKDTree<Float, Spectrum>::cache_load(uint64_t key) {
+    fs::path filename =
+        m_cache_dir / tfm::format("kdtree_%016llx.bin", (unsigned long long) key);
+    if (!fs::exists(filename))
+        return false;
+
+    try {
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(filename);
+        const uint8_t *ptr = (const uint8_t *) mmap->data();
+
+        KDTreeCacheHeader header;
+        if (mmap->size() < sizeof(header) + sizeof(ScalarBoundingBox3f))
+            Throw("file is truncated");
+        memcpy(&header, ptr, sizeof(header));
+        ptr += sizeof(header);
+
+        if (memcmp(header.magic, "MIKD", 4) != 0 ||
+            header.version != kdtree_cache_version ||
+            header.node_size != sizeof(KDNode) ||
+            header.scalar_size != sizeof(ScalarFloat) ||
+            header.key != key)
+            Throw("incompatible file header");
+
+        size_t expected_size = sizeof(header) + sizeof(ScalarBoundingBox3f) +
+                               header.node_count * sizeof(KDNode) +
+                               header.index_count * sizeof(Index);
+        if (mmap->size() != expected_size)
+            Throw("file is truncated");
+
+        memcpy(&m_bbox, ptr, sizeof(ScalarBoundingBox3f));
+        ptr += sizeof(ScalarBoundingBox3f);
+
+        m_node_count  = header.node_count;
+        m_index_count = header.index_count;
+        m_nodes.reset(new KDNode[m_node_count]);
+        m_indices.reset(new Index[m_index_count]);
+        memcpy(m_nodes.get(), ptr, m_node_count * sizeof(KDNode));
+        ptr += m_node_count * sizeof(KDNode);
+        memcpy(m_indices.get(), ptr, m_index_count * sizeof(Index));
+    } catch (const std::exception &e) {
+        Log(Warn, "Ignoring kd-tree cache file \"%s\": %s", filename, e.what());
+        m_nodes.reset();
+        m_indices.reset();
+        m_node_count = m_index_count = 0;
+        return false;
+    }
+
+    return true;
+}
+
+MI_VARIANT void ShapeKDTree<Float, Spectrum>::cache_store(uint64_t key) const {
+    std::string name = tfm::format("kdtree_%016llx.bin", (unsigned long long) key);
+
+    /* Concurrent jobs may build the same entry: every writer uses its own
+       temporary file, which is then renamed atomically */
+    std::random_device random;
+    fs::path filename = m_cache_dir / name,
+             filename_tmp = m_cache_dir / tfm::format("%s.%d.%08x.tmp", name,
+                                                      (int) getpid(), random());
+
+    try {
+        if (!fs::exists(m_cache_dir) && !fs::create_directory(m_cache_dir))
+            Throw("could not create the cache directory");
+
+        KDTreeCacheHeader header;
+        memcpy(header.magic, "MIKD", 4);
+        header.version     = kdtree_cache_version;
+        header.node_size   = (uint32_t) sizeof(KDNode);
+        header.scalar_size = (uint32_t) sizeof(ScalarFloat);
+        header.key         = key;
+        header.node_count  = m_node_count;
+        header.index_count = m_index_count;
+
+        {
+            ref<FileStream> stream = new FileStream(filename_tmp, FileStream::ETruncReadWrite);
+            stream->write(&header, sizeof(header));
+            stream->write(&m_bbox, sizeof(ScalarBoundingBox3f));
+            stream->write(m_nodes.get(), m_node_count * sizeof(KDNode));
+            stream->write(m_indices.get(), m_index_count * sizeof(Index));
+            stream->close();
+        }
+
+        if (!fs::rename(filename_tmp, filename))
+            Throw("could not rename the temporary file");
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not write kd-tree cache file \"%s\": %s", filename, e.what());
+        fs::remove(filename_tmp);
+    }
+}
+
 MI_VARIANT std::string ShapeKDTree<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
     oss << "ShapeKDTreeKDTree[" << std::endl
@@ -0,0 +1,491 @@
+#include <mitsuba/render/lighttree.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/render/mesh.h>
+#include <drjit/loop.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Number of floating point values stored per node
+static constexpr uint32_t NodeStride = 12;
+
+/// Flag marking leaf nodes in the child array
+static constexpr uint32_t LeafFlag = 0x80000000u;
+
+/// Depth value of emitters that are not part of the tree
+static constexpr uint32_t InvalidDepth = 0xFFFFFFFFu;
+
+/// Compute cos(max(0, a - b)) given the sines and cosines of two angles
+template <typename Float>
+static Float cos_sub_clamped(const Float &sin_a, const Float &cos_a,
+                             const Float &sin_b, const Float &cos_b) {
+    return dr::select(cos_a > cos_b, 1.f, cos_a * cos_b + sin_a * sin_b);
+}
+
+MI_VARIANT LightTree<Float, Spectrum>::LightTree(const std::vector<ref<Emitter>> &emitters) {
+    uint32_t emitter_count = (uint32_t) emitters.size();
+
+    std::vector<LightBounds> bounds;
+    for (uint32_t i = 0; i < emitter_count; ++i) {
+        const Emitter *emitter = emitters[i].get();
+
+        m_index_map[emitter] = i;
+
+        if (has_flag(emitter->flags(), EmitterFlags::Infinite)) {
+            m_infinite.push_back(i);
+            continue;
+        }
+
+        LightBounds lb = emitter_bounds(emitter);
+        lb.emitter = i;
+        bounds.push_back(lb);
+    }
+
+    m_tree_count = (uint32_t) bounds.size();
+    uint32_t infinite_count = (uint32_t) m_infinite.size();
+
+    if (infinite_count > 0)
+        m_infinite_prob = m_tree_count > 0
+            ? (ScalarFloat) infinite_count / (ScalarFloat) (infinite_count + 1)
+            : 1.f;
+
+    std::vector<uint32_t> trails(emitter_count, 0u),
+                          depths(emitter_count, InvalidDepth);
+
+    if (m_tree_count > 0) {
+        m_node_count = 2 * m_tree_count - 1;
+        m_nodes_host.resize((size_t) m_node_count * NodeStride);
+        m_children_host.resize(m_node_count);
+
+        uint32_t next_node = 1;
+        build(bounds, 0, m_tree_count, 0, 0, 0, next_node, trails, depths);
+    } else {
+        // Keep the node arrays non-empty so that gathers remain valid
+        m_nodes_host.resize(NodeStride, 0.f);
+        m_children_host.resize(1, LeafFlag);
+    }
+
+    m_nodes = dr::load<FloatStorage>(m_nodes_host.data(), m_nodes_host.size());
+    m_children = dr::load<UInt32Storage>(m_children_host.data(), m_children_host.size());
+    m_trail = dr::load<UInt32Storage>(trails.data(), trails.size());
+    m_depth = dr::load<UInt32Storage>(depths.data(), depths.size());
+
+    if (infinite_count > 0)
+        m_infinite_dr = dr::load<UInt32Storage>(m_infinite.data(), infinite_count);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        // Map the JIT registry identifiers of the emitters to their indices
+        std::vector<uint32_t> ids(emitter_count);
+        uint32_t max_id = 0;
+        for (uint32_t i = 0; i < emitter_count; ++i) {
+            ids[i] = jit_registry_get_id(dr::backend_v<Float>, emitters[i].get());
+            max_id = std::max(max_id, ids[i]);
+        }
+
+        std::vector<uint32_t> registry_map(max_id + 1, 0u);
+        for (uint32_t i = 0; i < emitter_count; ++i)
+            registry_map[ids[i]] = i;
+
+        m_registry_map =
+            dr::load<UInt32Storage>(registry_map.data(), registry_map.size());
+    }
+
+    Log(Debug, "Light tree: %u emitters, %u infinite emitters, %u nodes, depth %u",
+        m_tree_count, infinite_count, m_node_count, m_max_depth);
+}
+
+MI_VARIANT LightTree<Float, Spectrum>::~LightTree() { }
+
+MI_VARIANT typename LightTree<Float, Spectrum>::LightBounds
+LightTree<Float, Spectrum>::emitter_bounds(const Emitter *emitter) const {
+    LightBounds lb;
+    lb.bbox  = emitter->bbox();
+    lb.power = estimate_power(emitter) * emitter->sampling_weight();
+
+    // Bound the emission directions of meshes by the cone of their normals
+    const Mesh *mesh = dynamic_cast<const Mesh *>(emitter->shape());
+    if (!mesh || mesh->face_count() == 0)
+        return lb;
+
+    auto &&faces     = dr::migrate(mesh->faces_buffer(), AllocType::Host);
+    auto &&positions = dr::migrate(mesh->vertex_positions_buffer(), AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    const uint32_t *f = faces.data();
+    const ScalarFloat *v = positions.data();
+
+    auto face_normal = [&](size_t i) {
+        ScalarPoint3f p[3];
+        for (size_t k = 0; k < 3; ++k) {
+            const ScalarFloat *ptr = v + 3 * (size_t) f[3 * i + k];
+            p[k] = ScalarPoint3f(ptr[0], ptr[1], ptr[2]);
+        }
+        // Unnormalized: the length is proportional to the area
+        return dr::cross(p[1] - p[0], p[2] - p[0]);
+    };
+
+    size_t face_count = mesh->face_count();
+    ScalarVector3f axis(0.f);
+    for (size_t i = 0; i < face_count; ++i)
+        axis += face_normal(i);
+
+    ScalarFloat length = dr::norm(axis);
+    if (!(length > 0.f))
+        return lb;
+    axis /= length;
+
+    // Emission is two-sided from the perspective of the tree (see 'importance')
+    ScalarFloat cos_theta_o = 1.f;
+    for (size_t i = 0; i < face_count; ++i) {
+        ScalarVector3f n = face_normal(i);
+        ScalarFloat n_length = dr::norm(n);
+        if (n_length > 0.f)
+            cos_theta_o = dr::minimum(cos_theta_o,
+                                      dr::abs(dr::dot(n, axis)) / n_length);
+    }
+
+    lb.axis = axis;
+    lb.cos_theta_o = cos_theta_o;
+    lb.cos_theta_e = 0.f;
+    return lb;
+}
+
+MI_VARIANT typename LightTree<Float, Spectrum>::ScalarFloat
+LightTree<Float, Spectrum>::estimate_power(const Emitter *emitter) const {
+    constexpr uint32_t SampleCount = 1024;
+    using PCG32 = mitsuba::PCG32<UInt32>;
+
+    auto eval = [&](PCG32 &rng) {
+        Float wavelength_sample = rng.next_float32();
+        Point2f sample2(rng.next_float32(), rng.next_float32()),
+                sample3(rng.next_float32(), rng.next_float32());
+
+        auto [ray, weight] = emitter->sample_ray(0.f, wavelength_sample,
+                                                 sample2, sample3);
+        DRJIT_MARK_USED(ray);
+
+        Float value = dr::mean(unpolarized_spectrum(weight));
+        return dr::select(dr::isfinite(value) && value > 0.f, value, 0.f);
+    };
+
+    ScalarFloat power = 0.f;
+    try {
+        if constexpr (dr::is_jit_v<Float>) {
+            PCG32 rng(SampleCount);
+            power = dr::slice(dr::sum(eval(rng)));
+        } else {
+            PCG32 rng;
+            for (uint32_t i = 0; i < SampleCount; ++i)
+                power += eval(rng);
+        }
+    } catch (const std::exception &e) {
+        // Emitters that cannot emit rays are assumed to be as bright as the
+        // others, which keeps the tree unbiased (all bounds are conservative)
+        Log(Warn, "Light tree: could not estimate the power of emitter "
+                  "\"%s\" (%s), assuming unit power.", emitter->id(), e.what());
+        return 1.f;
+    }
+
+    return power / (ScalarFloat) SampleCount;
+}
+
+MI_VARIANT typename LightTree<Float, Spectrum>::LightBounds
+LightTree<Float, Spectrum>::merge(const LightBounds &a, const LightBounds &b) {
+    if (!(a.power > 0.f))
+        return LightBounds { b.emitter, ScalarBoundingBox3f::merge(a.bbox, b.bbox),
+                             b.axis, b.cos_theta_o, b.cos_theta_e, b.power };
+    if (!(b.power > 0.f))
+        return LightBounds { a.emitter, ScalarBoundingBox3f::merge(a.bbox, b.bbox),
+                             a.axis, a.cos_theta_o, a.cos_theta_e, a.power };
+
+    LightBounds result;
+    result.bbox  = ScalarBoundingBox3f::merge(a.bbox, b.bbox);
+    result.power = a.power + b.power;
+    result.cos_theta_e = dr::minimum(a.cos_theta_e, b.cos_theta_e);
+
+    // Compute a cone that bounds the cones of both inputs
+    ScalarFloat theta_a = dr::safe_acos(a.cos_theta_o),
+                theta_b = dr::safe_acos(b.cos_theta_o),
+                theta_d = dr::safe_acos(dr::dot(a.axis, b.axis));
+
+    if (dr::minimum(theta_d + theta_b, dr::Pi<ScalarFloat>) <= theta_a) {
+        result.axis = a.axis;
+        result.cos_theta_o = a.cos_theta_o;
+    } else if (dr::minimum(theta_d + theta_a, dr::Pi<ScalarFloat>) <= theta_b) {
+        result.axis = b.axis;
+        result.cos_theta_o = b.cos_theta_o;
+    } else {
+        ScalarFloat theta_o = .5f * (theta_a + theta_d + theta_b);
+        ScalarVector3f w = dr::cross(a.axis, b.axis);
+        ScalarFloat w_length = dr::norm(w);
+
+        if (theta_o >= dr::Pi<ScalarFloat> || !(w_length > 1e-6f)) {
+            result.axis = a.axis;
+            result.cos_theta_o = -1.f;
+        } else {
+            // Rotate the axis of 'a' towards 'b' (Rodrigues' rotation formula)
+            ScalarFloat theta_r = theta_o - theta_a;
+            auto [sin_r, cos_r] = dr::sincos(theta_r);
+            w /= w_length;
+            result.axis = dr::normalize(a.axis * cos_r +
+                                        dr::cross(w, a.axis) * sin_r +
+                                        w * (dr::dot(w, a.axis) * (1.f - cos_r)));
+            result.cos_theta_o = dr::cos(theta_o);
+        }
+    }
+
+    return result;
+}
+
+MI_VARIANT void LightTree<Float, Spectrum>::build(
+    std::vector<LightBounds> &bounds, uint32_t start, uint32_t end,
+    uint32_t node, uint32_t trail, uint32_t depth, uint32_t &next_node,
+    std::vector<uint32_t> &trails, std::vector<uint32_t> &depths) {
+
+    LightBounds lb = bounds[start];
+    for (uint32_t i = start + 1; i < end; ++i)
+        lb = merge(lb, bounds[i]);
+
+    ScalarFloat *ptr = m_nodes_host.data() + (size_t) node * NodeStride;
+    for (size_t k = 0; k < 3; ++k) {
+        ptr[k]     = lb.bbox.min[k];
+        ptr[k + 3] = lb.bbox.max[k];
+        ptr[k + 6] = lb.axis[k];
+    }
+    ptr[9]  = lb.cos_theta_o;
+    ptr[10] = lb.cos_theta_e;
+    ptr[11] = lb.power;
+
+    if (end - start == 1) {
+        m_children_host[node] = LeafFlag | lb.emitter;
+        trails[lb.emitter] = trail;
+        depths[lb.emitter] = depth;
+        m_max_depth = std::max(m_max_depth, depth);
+        return;
+    }
+
+    // Split at the median centroid along the axis of largest extent. This
+    // keeps the tree balanced, so that the trails fit into 32 bits.
+    ScalarBoundingBox3f centroids;
+    for (uint32_t i = start; i < end; ++i)
+        centroids.expand(bounds[i].bbox.center());
+    uint32_t axis = centroids.major_axis(),
+             mid  = (start + end) / 2;
+
+    std::nth_element(bounds.begin() + start, bounds.begin() + mid,
+                     bounds.begin() + end,
+                     [axis](const LightBounds &a, const LightBounds &b) {
+                         return a.bbox.center()[axis] < b.bbox.center()[axis];
+                     });
+
+    uint32_t left = next_node;
+    next_node += 2;
+    m_children_host[node] = left;
+
+    build(bounds, start, mid, left, trail, depth + 1, next_node, trails, depths);
+    build(bounds, mid, end, left + 1, trail | (1u << depth), depth + 1,
+          next_node, trails, depths);
+}
+
+MI_VARIANT Float LightTree<Float, Spectrum>::importance(const Interaction3f &ref,
+                                                       const UInt32 &node,
+                                                       Mask active) const {
+    UInt32 base = node * NodeStride;
+    auto fetch = [&](uint32_t offset) {
+        return dr::gather<Float>(m_nodes, base + offset, active);
+    };
+
+    Point3f p_min(fetch(0), fetch(1), fetch(2)),
+            p_max(fetch(3), fetch(4), fetch(5));
+    Vector3f axis(fetch(6), fetch(7), fetch(8));
+    Float cos_theta_o = fetch(9),
+          cos_theta_e = fetch(10),
+          power       = fetch(11);
+
+    Point3f center = .5f * (p_min + p_max);
+    Vector3f d = ref.p - center;
+    Float dist2  = dr::squared_norm(d),
+          radius2 = .25f * dr::squared_norm(p_max - p_min);
+
+    // Avoid excessive importance values near (or within) the bounds
+    Float dist2_clamped = dr::maximum(dist2, dr::sqrt(radius2));
+
+    // Direction from the bounds towards the reference point
+    Vector3f wi = dr::select(dist2 > 0.f, d * dr::rsqrt(dist2), axis);
+
+    // Angle subtended by the bounding sphere of the node
+    Float sin2_theta_b = radius2 / dist2,
+          cos_theta_b = dr::select(sin2_theta_b >= 1.f, -1.f,
+                                   dr::safe_sqrt(1.f - sin2_theta_b)),
+          sin_theta_b = dr::safe_sqrt(1.f - dr::sqr(cos_theta_b));
+
+    // Minimum angle between the emission cone and the reference direction
+    Float cos_theta_w = dr::abs(dr::dot(axis, wi)),
+          sin_theta_w = dr::safe_sqrt(1.f - dr::sqr(cos_theta_w)),
+          sin_theta_o = dr::safe_sqrt(1.f - dr::sqr(cos_theta_o)),
+          cos_theta_x = cos_sub_clamped(sin_theta_w, cos_theta_w,
+                                        sin_theta_o, cos_theta_o),
+          sin_theta_x = dr::safe_sqrt(1.f - dr::sqr(cos_theta_x)),
+          cos_theta_p = cos_sub_clamped(sin_theta_x, cos_theta_x,
+                                        sin_theta_b, cos_theta_b);
+
+    Float result = dr::select(cos_theta_p > cos_theta_e,
+                              power * cos_theta_p / dist2_clamped, 0.f);
+
+    // Account for the foreshortening at surface interactions
+    Float cos_theta_i = dr::abs(dr::dot(wi, ref.n)),
+          sin_theta_i = dr::safe_sqrt(1.f - dr::sqr(cos_theta_i)),
+          cos_theta_ip = cos_sub_clamped(sin_theta_i, cos_theta_i,
+                                         sin_theta_b, cos_theta_b);
+
+    dr::masked(result, dr::squared_norm(ref.n) > 0.f) *= cos_theta_ip;
+
+    return dr::select(active, result, 0.f);
+}
+
+MI_VARIANT typename LightTree<Float, Spectrum>::UInt32
+LightTree<Float, Spectrum>::emitter_index(const EmitterPtr &emitter,
+                                          Mask active) const {
+    if constexpr (dr::is_jit_v<Float>) {
+        return dr::gather<UInt32>(m_registry_map,
+                                  dr::reinterpret_array<UInt32>(emitter),
+                                  active);
+    } else {
+        auto it = m_index_map.find(emitter);
+        if (!active || it == m_index_map.end())
+            return 0u;
+        return it->second;
+    }
+}
+
+MI_VARIANT std::tuple<typename LightTree<Float, Spectrum>::UInt32, Float, Float>
+LightTree<Float, Spectrum>::sample_emitter(const Interaction3f &ref,
+                                           Float sample, Mask active) const {
+    uint32_t infinite_count = (uint32_t) m_infinite.size();
+
+    UInt32 index = 0;
+    Float pmf = 0.f;
+
+    // Choose between the infinite emitters and the tree
+    Mask pick_infinite = false;
+    if (infinite_count > 0) {
+        pick_infinite = active && sample < m_infinite_prob;
+
+        Float sample_infinite = sample / m_infinite_prob * infinite_count;
+        UInt32 slot = dr::minimum(UInt32(sample_infinite), infinite_count - 1u);
+
+        dr::masked(index, pick_infinite) =
+            dr::gather<UInt32>(m_infinite_dr, slot, pick_infinite);
+        dr::masked(pmf, pick_infinite) = m_infinite_prob / infinite_count;
+        dr::masked(sample, pick_infinite) = sample_infinite - Float(slot);
+
+        if (m_tree_count > 0)
+            dr::masked(sample, !pick_infinite) =
+                (sample - m_infinite_prob) / (1.f - m_infinite_prob);
+    }
+
+    if (m_tree_count == 0)
+        return { index, pmf, sample };
+
+    // Descend from the root, choosing children by their importance
+    Mask active_tree = active && !pick_infinite;
+    UInt32 node = 0,
+           child = dr::gather<UInt32>(m_children, node, active_tree);
+    Float pmf_tree = 1.f;
+
+    dr::Loop<Mask> loop("LightTree::sample_emitter", node, child, sample,
+                        pmf_tree, active_tree);
+    loop.set_max_iterations(m_max_depth);
+
+    while (loop(active_tree && dr::eq(child & LeafFlag, 0u))) {
+        Float imp_left  = importance(ref, child, active_tree),
+              imp_right = importance(ref, child + 1u, active_tree),
+              imp_total = imp_left + imp_right;
+
+        Mask valid = imp_total > 0.f;
+        Float prob_left = imp_left / imp_total;
+        Mask right = valid && sample >= prob_left;
+
+        sample = dr::select(right, (sample - prob_left) / (1.f - prob_left),
+                            sample / prob_left);
+        sample = dr::minimum(sample, dr::OneMinusEpsilon<Float>);
+        pmf_tree *= dr::select(right, 1.f - prob_left, prob_left);
+        node = dr::select(right, child + 1u, child);
+
+        pmf_tree = dr::select(valid, pmf_tree, 0.f);
+        active_tree &= valid;
+        child = dr::gather<UInt32>(m_children, node, active_tree);
+    }
+
+    Mask found = active && !pick_infinite && dr::neq(child & LeafFlag, 0u) &&
+                 pmf_tree > 0.f;
+
+    dr::masked(index, found) = child & ~LeafFlag;
+    dr::masked(pmf, found) = pmf_tree * (1.f - m_infinite_prob);
+
+    return { index, pmf, sample };
+}
+
+MI_VARIANT Float LightTree<Float, Spectrum>::pdf_emitter(const Interaction3f &ref,
+                                                        const EmitterPtr &emitter,
+                                                        Mask active) const {
+    uint32_t infinite_count = (uint32_t) m_infinite.size();
+
+    UInt32 index = emitter_index(emitter, active),
+           depth = dr::gather<UInt32>(m_depth, index, active),
+           trail = dr::gather<UInt32>(m_trail, index, active);
+
+    Mask is_infinite = dr::eq(depth, InvalidDepth);
+    Float pmf = dr::select(active && is_infinite && infinite_count > 0,
+                           m_infinite_prob / dr::maximum(infinite_count, 1u),
+                           0.f);
+
+    if (m_tree_count == 0)
+        return pmf;
+
+    // Retrace the path from the root to the emitter's leaf
+    Mask active_tree = active && !is_infinite;
+    UInt32 node = 0, level = 0;
+    Float pmf_tree = 1.f;
+
+    dr::Loop<Mask> loop("LightTree::pdf_emitter", node, level, pmf_tree,
+                        active_tree);
+    loop.set_max_iterations(m_max_depth);
+
+    while (loop(active_tree && level < depth)) {
+        UInt32 child = dr::gather<UInt32>(m_children, node, active_tree);
+
+        Float imp_left  = importance(ref, child, active_tree),
+              imp_right = importance(ref, child + 1u, active_tree),
+              imp_total = imp_left + imp_right;
+
+        Mask right = dr::neq((trail >> level) & 1u, 0u);
+        pmf_tree *= dr::select(imp_total > 0.f,
+                               dr::select(right, imp_right, imp_left) / imp_total,
+                               0.f);
+
+        node = dr::select(right, child + 1u, child);
+        level++;
+    }
+
+    dr::masked(pmf, active && !is_infinite) =
+        pmf_tree * (1.f - m_infinite_prob);
+
+    return pmf;
+}
+
+MI_VARIANT std::string LightTree<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "LightTree[" << std::endl
+        << "  emitter_count = " << m_tree_count << "," << std::endl
+        << "  infinite_count = " << m_infinite.size() << "," << std::endl
+        << "  node_count = " << m_node_count << "," << std::endl
+        << "  max_depth = " << m_max_depth << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(LightTree, Object)
+MI_INSTANTIATE_CLASS(LightTree)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,418 @@
+#include <mitsuba/render/lpe.h>
+#include <mitsuba/core/string.h>
+#include <algorithm>
+#include <map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+static constexpr uint32_t EventCount = 4;
+static constexpr uint32_t AllEvents  = (1u << EventCount) - 1u;
+
+/// Nondeterministic automaton built from an expression (Thompson's construction)
+struct LPENFA {
+    struct Node {
+        /// Events (bit mask) that lead from this node to \c next
+        uint32_t events = 0;
+        int next = -1;
+        std::vector<int> epsilon;
+    };
+
+    /// Start and end node of a sub-automaton
+    struct Fragment { int start, end; };
+
+    std::vector<Node> nodes;
+
+    int add() {
+        nodes.emplace_back();
+        return (int) nodes.size() - 1;
+    }
+
+    Fragment symbol(uint32_t events) {
+        int a = add(), b = add();
+        nodes[a].events = events;
+        nodes[a].next = b;
+        return { a, b };
+    }
+
+    Fragment empty() {
+        int a = add();
+        return { a, a };
+    }
+
+    Fragment concat(Fragment f1, Fragment f2) {
+        nodes[f1.end].epsilon.push_back(f2.start);
+        return { f1.start, f2.end };
+    }
+
+    Fragment alternative(Fragment f1, Fragment f2) {
+        int s = add(), e = add();
+        nodes[s].epsilon = { f1.start, f2.start };
+        nodes[f1.end].epsilon.push_back(e);
+        nodes[f2.end].epsilon.push_back(e);
+        return { s, e };
+    }
+
+    Fragment repeat(Fragment f, bool allow_zero, bool allow_many) {
+        int s = add(), e = add();
+        nodes[s].epsilon.push_back(f.start);
+        if (allow_zero)
+            nodes[s].epsilon.push_back(e);
+        if (allow_many)
+            nodes[f.end].epsilon.push_back(f.start);
+        nodes[f.end].epsilon.push_back(e);
+        return { s, e };
+    }
+
+    /// Sorted set of nodes reachable from \c set via epsilon transitions
+    std::vector<int> closure(std::vector<int> set) const {
+        std::vector<bool> visited(nodes.size(), false);
+        std::vector<int> stack = set;
+        for (int n : set)
+            visited[n] = true;
+        while (!stack.empty()) {
+            int n = stack.back();
+            stack.pop_back();
+            for (int m : nodes[n].epsilon) {
+                if (!visited[m]) {
+                    visited[m] = true;
+                    set.push_back(m);
+                    stack.push_back(m);
+                }
+            }
+        }
+        std::sort(set.begin(), set.end());
+        return set;
+    }
+};
+
+/// Recursive descent parser of the expression syntax
+struct LPEParser {
+    const std::string &expr;
+    size_t pos = 0;
+    LPENFA &nfa;
+
+    LPEParser(const std::string &expr, LPENFA &nfa) : expr(expr), nfa(nfa) { }
+
+    [[noreturn]] void error(const std::string &msg) const {
+        Throw("Invalid light path expression \"%s\": %s (at position %zu)",
+              expr, msg, pos);
+    }
+
+    char peek() {
+        while (pos < expr.size() && (expr[pos] == ' ' || expr[pos] == '\t'))
+            pos++;
+        return pos < expr.size() ? expr[pos] : '\0';
+    }
+
+    static uint32_t event_bit(char c) {
+        switch (c) {
+            case 'D': return 1u << 0;
+            case 'G': return 1u << 1;
+            case 'S': return 1u << 2;
+            case 'T': return 1u << 3;
+            default:  return 0u;
+        }
+    }
+
+    LPENFA::Fragment parse_alternative() {
+        LPENFA::Fragment f = parse_concat();
+        while (peek() == '|') {
+            pos++;
+            f = nfa.alternative(f, parse_concat());
+        }
+        return f;
+    }
+
+    LPENFA::Fragment parse_concat() {
+        LPENFA::Fragment f = nfa.empty();
+        while (true) {
+            char c = peek();
+            if (c == '\0' || c == '|' || c == ')' || c == 'L')
+                return f;
+            f = nfa.concat(f, parse_repeat());
+        }
+    }
+
+    LPENFA::Fragment parse_repeat() {
+        LPENFA::Fragment f = parse_atom();
+        while (true) {
+            char c = peek();
+            if (c == '*')
+                f = nfa.repeat(f, true, true);
+            else if (c == '+')
+                f = nfa.repeat(f, false, true);
+            else if (c == '?')
+                f = nfa.repeat(f, true, false);
+            else
+                return f;
+            pos++;
+        }
+    }
+
+    LPENFA::Fragment parse_atom() {
+        char c = peek();
+        if (uint32_t bit = event_bit(c); bit != 0) {
+            pos++;
+            return nfa.symbol(bit);
+        } else if (c == '.') {
+            pos++;
+            return nfa.symbol(AllEvents);
+        } else if (c == '[') {
+            pos++;
+            bool negate = peek() == '^';
+            if (negate)
+                pos++;
+            uint32_t events = 0;
+            while (peek() != ']') {
+                uint32_t bit = event_bit(peek());
+                if (bit == 0)
+                    error("expected an event or ']'");
+                events |= bit;
+                pos++;
+            }
+            pos++;
+            if (negate)
+                events = ~events & AllEvents;
+            if (events == 0)
+                error("the set of events is empty");
+            return nfa.symbol(events);
+        } else if (c == '(') {
+            pos++;
+            LPENFA::Fragment f = parse_alternative();
+            if (peek() != ')')
+                error("expected ')'");
+            pos++;
+            return f;
+        } else if (c == 'C') {
+            error("the sensor event 'C' may only appear at the beginning");
+        } else {
+            error(c == '\0' ? "unexpected end of the expression"
+                            : tfm::format("unexpected character '%c'", c));
+        }
+    }
+
+    /// Parse the complete expression and return the light group
+    std::pair<LPENFA::Fragment, std::string> parse() {
+        if (peek() == 'C')
+            pos++;
+        LPENFA::Fragment f = parse_alternative();
+        if (peek() != 'L')
+            error("expected the emitter event 'L'");
+        pos++;
+
+        std::string group;
+        if (peek() == '\'') {
+            size_t end = expr.find('\'', pos + 1);
+            if (end == std::string::npos)
+                error("unterminated light group");
+            group = expr.substr(pos + 1, end - pos - 1);
+            pos = end + 1;
+        }
+        if (peek() != '\0')
+            error("the expression must end with the emitter event 'L'");
+        return { f, group };
+    }
+};
+
+MI_VARIANT LightPathExpressions<Float, Spectrum>::LightPathExpressions(
+    const std::string &spec) {
+    std::vector<uint32_t> transitions, accepting;
+
+    for (const std::string &token : string::tokenize(spec, ",")) {
+        size_t colon = token.find(':');
+        if (colon == std::string::npos)
+            Throw("Light path expressions must be specified as "
+                  "\"name:expression\" pairs (got \"%s\")!", token);
+        std::string name = string::trim(token.substr(0, colon)),
+                    expr = string::trim(token.substr(colon + 1));
+        if (name.empty())
+            Throw("The light path expression \"%s\" has no name!", expr);
+        if (m_names.size() == MaxCount)
+            Throw("At most %zu light path expressions are supported!", MaxCount);
+
+        LPENFA nfa;
+        LPEParser parser(expr, nfa);
+        auto [fragment, group] = parser.parse();
+
+        // Convert the NFA into a DFA (subset construction)
+        std::map<std::vector<int>, uint32_t> index;
+        std::vector<std::vector<int>> states = { nfa.closure({ fragment.start }) };
+        index[states[0]] = 0;
+        uint32_t offset = (uint32_t) accepting.size();
+
+        for (size_t i = 0; i < states.size(); ++i) {
+            bool accept = std::binary_search(states[i].begin(), states[i].end(),
+                                             fragment.end);
+            accepting.push_back(accept ? 1u << m_names.size() : 0u);
+
+            for (uint32_t e = 0; e < EventCount; ++e) {
+                std::vector<int> next;
+                for (int n : states[i]) {
+                    const LPENFA::Node &node = nfa.nodes[n];
+                    if (node.events & (1u << e))
+                        next.push_back(node.next);
+                }
+                next = nfa.closure(next);
+
+                auto it = index.find(next);
+                uint32_t target;
+                if (it == index.end()) {
+                    target = (uint32_t) states.size();
+                    index[next] = target;
+                    states.push_back(next);
+                } else {
+                    target = it->second;
+                }
+                transitions.push_back(target);
+            }
+        }
+
+        // Number of bits needed to store the index of a state
+        uint32_t count = (uint32_t) states.size(), bits = 1;
+        while (bits < 32 && (1u << bits) < count)
+            bits++;
+
+        m_names.push_back(name);
+        m_expressions.push_back(expr);
+        m_groups.push_back(group);
+        m_state_count.push_back(count);
+        m_state_offset.push_back(m_state_bits);
+        m_state_mask.push_back(bits == 32 ? 0xFFFFFFFFu : (1u << bits) - 1u);
+        m_table_offset.push_back(offset);
+        m_state_bits += bits;
+
+        if (m_state_bits > 32)
+            Throw("The light path expressions require more than 32 bits of "
+                  "state per path, use fewer or simpler expressions!");
+    }
+
+    if (m_names.empty())
+        Throw("No light path expressions were specified!");
+
+    m_transitions = dr::load<UInt32Storage>(transitions.data(), transitions.size());
+    m_accepting   = dr::load<UInt32Storage>(accepting.data(), accepting.size());
+
+    set_emitters({});
+}
+
+MI_VARIANT LightPathExpressions<Float, Spectrum>::~LightPathExpressions() { }
+
+MI_VARIANT void LightPathExpressions<Float, Spectrum>::set_emitters(
+    const std::vector<ref<Emitter>> &emitters) {
+    std::vector<uint32_t> masks(emitters.size(), 0u);
+    for (size_t i = 0; i < emitters.size(); ++i) {
+        const std::string &id = emitters[i]->id();
+        for (size_t j = 0; j < m_groups.size(); ++j)
+            if (id.compare(0, m_groups[j].size(), m_groups[j]) == 0)
+                masks[i] |= 1u << j;
+    }
+
+    m_light_map.clear();
+    for (size_t i = 0; i < emitters.size(); ++i)
+        m_light_map[emitters[i].get()] = masks[i];
+
+    if constexpr (dr::is_jit_v<Float>) {
+        // Map the JIT registry identifiers of the emitters to their masks
+        uint32_t max_id = 0;
+        std::vector<uint32_t> ids(emitters.size());
+        for (size_t i = 0; i < emitters.size(); ++i) {
+            ids[i] = jit_registry_get_id(dr::backend_v<Float>, emitters[i].get());
+            max_id = std::max(max_id, ids[i]);
+        }
+
+        std::vector<uint32_t> registry_map(max_id + 1, 0u);
+        for (size_t i = 0; i < emitters.size(); ++i)
+            registry_map[ids[i]] = masks[i];
+
+        m_registry_map =
+            dr::load<UInt32Storage>(registry_map.data(), registry_map.size());
+    }
+}
+
+MI_VARIANT uint32_t LightPathExpressions<Float, Spectrum>::event_flags(Event event) {
+    switch (event) {
+        case Event::Diffuse:  return +BSDFFlags::DiffuseReflection;
+        case Event::Glossy:   return +BSDFFlags::GlossyReflection;
+        case Event::Specular: return BSDFFlags::DeltaReflection |
+                                     BSDFFlags::Delta1DReflection;
+        default:              return +BSDFFlags::Transmission;
+    }
+}
+
+MI_VARIANT typename LightPathExpressions<Float, Spectrum>::UInt32
+LightPathExpressions<Float, Spectrum>::advance_symbol(const UInt32 &state,
+                                                      const UInt32 &symbol,
+                                                      Mask active) const {
+    UInt32 result = 0u;
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        UInt32 s = (state >> m_state_offset[i]) & m_state_mask[i];
+        UInt32 next = dr::gather<UInt32>(
+            m_transitions, (m_table_offset[i] + s) * EventCount + symbol, active);
+        result |= next << m_state_offset[i];
+    }
+    return dr::select(active, result, state);
+}
+
+MI_VARIANT typename LightPathExpressions<Float, Spectrum>::UInt32
+LightPathExpressions<Float, Spectrum>::advance(const UInt32 &state,
+                                               const UInt32 &sampled_type,
+                                               Mask active) const {
+    // Null events (e.g. index-matched boundaries) leave the state unchanged
+    active &= !has_flag(sampled_type, BSDFFlags::Null);
+
+    UInt32 symbol = dr::select(
+        has_flag(sampled_type, BSDFFlags::Transmission), (uint32_t) Event::Transmission,
+        dr::select(has_flag(sampled_type, event_flags(Event::Specular)),
+                   (uint32_t) Event::Specular,
+                   dr::select(has_flag(sampled_type, BSDFFlags::GlossyReflection),
+                              (uint32_t) Event::Glossy,
+                              (uint32_t) Event::Diffuse)));
+
+    return advance_symbol(state, symbol, active);
+}
+
+MI_VARIANT typename LightPathExpressions<Float, Spectrum>::UInt32
+LightPathExpressions<Float, Spectrum>::advance(const UInt32 &state, Event event,
+                                               Mask active) const {
+    return advance_symbol(state, UInt32((uint32_t) event), active);
+}
+
+MI_VARIANT typename LightPathExpressions<Float, Spectrum>::UInt32
+LightPathExpressions<Float, Spectrum>::accept(const UInt32 &state,
+                                              const EmitterPtr &emitter,
+                                              Mask active) const {
+    UInt32 lights;
+    if constexpr (dr::is_jit_v<Float>) {
+        lights = dr::gather<UInt32>(m_registry_map,
+                                    dr::reinterpret_array<UInt32>(emitter),
+                                    active);
+    } else {
+        auto it = m_light_map.find(emitter);
+        lights = (active && it != m_light_map.end()) ? it->second : 0u;
+    }
+
+    active &= dr::neq(lights, 0u);
+
+    UInt32 result = 0u;
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        UInt32 s = (state >> m_state_offset[i]) & m_state_mask[i];
+        result |= dr::gather<UInt32>(m_accepting, m_table_offset[i] + s, active);
+    }
+
+    return dr::select(active, result & lights, 0u);
+}
+
+MI_VARIANT std::string LightPathExpressions<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "LightPathExpressions[" << std::endl;
+    for (size_t i = 0; i < m_names.size(); ++i)
+        oss << "  " << m_names[i] << " = \"" << m_expressions[i] << "\" ("
+            << m_state_count[i] << " states)," << std::endl;
+    oss << "  state_bits = " << m_state_bits << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(LightPathExpressions, Object)
+MI_INSTANTIATE_CLASS(LightPathExpressions)
+NAMESPACE_END(mitsuba)
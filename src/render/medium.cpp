@@ -1,5 +1,6 @@
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/render/emitter.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/phase.h>
 #include <mitsuba/render/scene.h>
@@ -19,6 +20,17 @@ MI_VARIANT Medium<Float, Spectrum>::Medium(const Properties &props) : m_id(props
             m_phase_function = phase;
             props.mark_queried(name);
         }
+
+        auto *emitter = dynamic_cast<Emitter *>(obj.get());
+        if (emitter) {
+            if (m_emitter)
+                Throw("Only a single emitter can be specified per medium");
+            if (!has_flag(emitter->flags(), EmitterFlags::Medium))
+                Throw("The emitter nested into a medium must be a volume "
+                      "emitter (e.g. \"volumelight\")!");
+            m_emitter = emitter;
+            props.mark_queried(name);
+        }
     }
     if (!m_phase_function) {
         // Create a default isotropic phase function
@@ -29,12 +41,23 @@ MI_VARIANT Medium<Float, Spectrum>::Medium(const Properties &props) : m_id(props
     m_sample_emitters = props.get<bool>("sample_emitters", true);
     dr::set_attr(this, "use_emitter_sampling", m_sample_emitters);
     dr::set_attr(this, "phase_function", m_phase_function.get());
+    dr::set_attr(this, "emitter", m_emitter.get());
 }
 
 MI_VARIANT Medium<Float, Spectrum>::~Medium() {}
 
 MI_VARIANT void Medium<Float, Spectrum>::traverse(TraversalCallback *callback) {
     callback->put_object("phase_function", m_phase_function.get(), +ParamFlags::Differentiable);
+    if (m_emitter)
+        callback->put_object("emitter", m_emitter.get(), +ParamFlags::Differentiable);
+}
+
+MI_VARIANT typename Medium<Float, Spectrum>::UnpolarizedSpectrum
+Medium<Float, Spectrum>::get_albedo(const MediumInteraction3f &mi,
+                                    Mask active) const {
+    auto [sigma_s, sigma_n, sigma_t] = get_scattering_coefficients(mi, active);
+    DRJIT_MARK_USED(sigma_n);
+    return dr::select(dr::neq(sigma_t, 0.f), sigma_s / sigma_t, 0.f);
 }
 
 MI_VARIANT
@@ -59,6 +82,27 @@ Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
     mint = dr::maximum(0.f, mint);
     maxt = dr::minimum(ray.maxt, maxt);
 
+    if (has_majorant_grid()) {
+        auto [sampled_t, majorant, control, control_depth] = sample_majorant_grid(
+            ray, mint, maxt, sample, channel, MajorantGridMode::Delta, active);
+        DRJIT_MARK_USED(control);
+        DRJIT_MARK_USED(control_depth);
+
+        Mask valid_mi   = active && (sampled_t <= maxt);
+        mei.t           = dr::select(valid_mi, sampled_t, dr::Infinity<Float>);
+        mei.p           = ray(sampled_t);
+        mei.medium      = this;
+        mei.mint        = mint;
+        mei.combined_extinction = majorant;
+
+        std::tie(mei.sigma_s, mei.sigma_n, mei.sigma_t) =
+            get_scattering_coefficients(mei, valid_mi);
+
+        // Null collisions make up the difference to the local majorant
+        mei.sigma_n = mei.combined_extinction - mei.sigma_t;
+        return mei;
+    }
+
     auto combined_extinction = get_majorant(mei, active);
     Float m                  = combined_extinction[0];
     if constexpr (is_rgb_v<Spectrum>) { // Handle RGB rendering
@@ -95,6 +139,405 @@ Medium<Float, Spectrum>::eval_tr_and_pdf(const MediumInteraction3f &mi,
     return { tr, pdf };
 }
 
+MI_VARIANT typename Medium<Float, Spectrum>::Float
+Medium<Float, Spectrum>::eval_majorant_grid(const Point3f &p_, Mask active) const {
+    Point3f p = m_majorant_to_grid * p_;
+    Point3i cell = Point3i(dr::floor(p));
+
+    Mask inside = active && dr::all(cell >= 0 && cell < m_majorant_resolution);
+    UInt32 index = UInt32((cell.z() * m_majorant_resolution.y() + cell.y()) *
+                              m_majorant_resolution.x() + cell.x());
+
+    return dr::select(inside,
+                      dr::gather<Float>(m_majorant_grid, index, inside),
+                      m_majorant_bound);
+}
+
+MI_VARIANT void
+Medium<Float, Spectrum>::update_empty_space(const ScalarVector3i &cells,
+                                            const ScalarFloat *majorants) {
+    // Skip distances are capped, which bounds the cost of the transform below
+    const uint32_t max_skip = 16;
+    const size_t n_cells = (size_t) dr::prod(cells);
+
+    std::unique_ptr<uint32_t[]> dist(new uint32_t[n_cells]),
+                                tmp(new uint32_t[n_cells]);
+    m_majorant_occupied = ScalarBoundingBox3f();
+    bool has_empty = false;
+    for (int32_t z = 0; z < cells.z(); ++z) {
+        for (int32_t y = 0; y < cells.y(); ++y) {
+            for (int32_t x = 0; x < cells.x(); ++x) {
+                size_t i = ((size_t) z * cells.y() + y) * cells.x() + x;
+                if (majorants[i] > 0.f) {
+                    dist[i] = 0;
+                    m_majorant_occupied.expand(ScalarPoint3f(x, y, z));
+                    m_majorant_occupied.expand(ScalarPoint3f(x + 1, y + 1, z + 1));
+                } else {
+                    dist[i] = max_skip;
+                    has_empty = true;
+                }
+            }
+        }
+    }
+
+    m_majorant_skip = UInt32Storage();
+    if (!has_empty || !m_majorant_occupied.valid())
+        return;
+
+    /* Chebyshev distance transform: the L-infinity distance separates into
+       successive 1D min-max passes along the three axes */
+    const size_t strides[3] = { 1, (size_t) cells.x(), (size_t) cells.x() * cells.y() };
+    for (int axis = 0; axis < 3; ++axis) {
+        const int32_t length = cells[axis];
+        for (int32_t z = 0; z < cells.z(); ++z) {
+            for (int32_t y = 0; y < cells.y(); ++y) {
+                for (int32_t x = 0; x < cells.x(); ++x) {
+                    size_t i = ((size_t) z * cells.y() + y) * cells.x() + x;
+                    int32_t pos = ScalarVector3i(x, y, z)[axis];
+                    uint32_t value = dist[i];
+                    for (int32_t o = 1; o < (int32_t) max_skip && (uint32_t) o < value; ++o) {
+                        if (pos - o >= 0)
+                            value = std::min(value, std::max((uint32_t) o,
+                                                             dist[i - o * strides[axis]]));
+                        if (pos + o < length)
+                            value = std::min(value, std::max((uint32_t) o,
+                                                             dist[i + o * strides[axis]]));
+                    }
+                    tmp[i] = value;
+                }
+            }
+        }
+        std::swap(dist, tmp);
+    }
+
+    m_majorant_skip = dr::load<UInt32Storage>(dist.get(), n_cells);
+}
+
+MI_VARIANT std::tuple<typename Medium<Float, Spectrum>::Float,
+                      typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
+                      typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
+                      typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
+Medium<Float, Spectrum>::sample_majorant_grid(const Ray3f &ray, Float mint,
+                                              Float maxt, Float sample,
+                                              UInt32 channel,
+                                              MajorantGridMode mode,
+                                              Mask active) const {
+    MI_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+
+    // Residual and decomposition tracking need lower bounds (otherwise, they are zero)
+    const bool residual = mode == MajorantGridMode::Residual,
+               decomposition = mode == MajorantGridMode::Decomposition,
+               has_control = mode != MajorantGridMode::Delta &&
+                             m_control_grid.size() > 0;
+
+    // Only decomposition tracking accounts for majorants that differ between channels
+    constexpr size_t n_channels = dr::array_size_v<UnpolarizedSpectrum>;
+    const bool per_channel = is_rgb_v<Spectrum> && decomposition &&
+                             m_majorant_grid_rgb.size() > 0;
+
+    // Majorant of the channel that drives the sampling
+    auto channel_value = [&](const UnpolarizedSpectrum &value) {
+        Float v = value[0];
+        if constexpr (is_rgb_v<Spectrum>) {
+            dr::masked(v, dr::eq(channel, 1u)) = value[1];
+            dr::masked(v, dr::eq(channel, 2u)) = value[2];
+        } else {
+            DRJIT_MARK_USED(channel);
+        }
+        return v;
+    };
+
+    // Transform the ray into grid coordinates (this preserves distances 't')
+    Ray3f grid_ray(m_majorant_to_grid * ray.o, m_majorant_to_grid * ray.d,
+                   ray.time, ray.wavelengths);
+
+    ScalarBoundingBox3f grid_bbox(ScalarPoint3f(0.f),
+                                  ScalarPoint3f(m_majorant_resolution));
+    auto [grid_hit, t_enter, t_exit] = grid_bbox.ray_intersect(grid_ray);
+    t_enter = dr::select(grid_hit, dr::clamp(t_enter, mint, maxt), maxt);
+    t_exit  = dr::select(grid_hit, dr::clamp(t_exit, mint, maxt), maxt);
+
+    // Only the cells with a nonzero majorant need to be traversed
+    Float t_occ_enter = t_exit, t_occ_exit = t_exit;
+    if (m_majorant_occupied.valid()) {
+        auto [occ_hit, occ_enter, occ_exit] = m_majorant_occupied.ray_intersect(grid_ray);
+        t_occ_enter = dr::select(occ_hit, dr::clamp(occ_enter, t_enter, t_exit), t_exit);
+        t_occ_exit  = dr::select(occ_hit, dr::clamp(occ_exit, t_occ_enter, t_exit), t_exit);
+    }
+    const bool has_skip = m_majorant_skip.size() > 0;
+
+    // Remaining optical depth until the sampled collision
+    Float tau       = -dr::log(1.f - sample),
+          t         = mint,
+          sampled_t = dr::Infinity<Float>;
+    UnpolarizedSpectrum majorant = m_majorant_bound,
+                        control  = 0.f,
+                        depth    = 0.f;
+    Mask done = !active;
+
+    /* Advance 't' through a segment of constant majorant 'mu' and control
+       extinction 'ctrl', whose optical depth is accumulated up to the
+       sampled collision */
+    auto march = [&](const Float &t_end, const UnpolarizedSpectrum &mu,
+                     const UnpolarizedSpectrum &ctrl, const Mask &valid) {
+        Float mu_c = channel_value(mu),
+              optical_depth = mu_c * (t_end - t);
+        Mask valid_seg = valid && !done,
+             hit = valid_seg && tau < optical_depth;
+        dr::masked(sampled_t, hit) = t + tau / mu_c;
+        dr::masked(majorant, hit)  = mu;
+        if (has_control)
+            dr::masked(control, hit) = ctrl;
+        if (residual || decomposition) {
+            Float length = dr::select(hit, sampled_t, t_end) - t;
+            dr::masked(depth, valid_seg) += (residual ? ctrl : mu) * length;
+        }
+        done |= hit;
+        dr::masked(tau, valid && !done) -= optical_depth;
+        dr::masked(t, valid && !done) = t_end;
+    };
+
+    // Outside of the grid (before entering it), then across its empty margin
+    march(t_enter, m_majorant_bound, 0.f, active);
+    march(t_occ_enter, 0.f, 0.f, active);
+
+    Point3f o = grid_ray.o;
+    Vector3f d = grid_ray.d;
+    Mask positive = d >= 0.f, parallel = dr::eq(d, 0.f);
+
+    Point3i cell = dr::clamp(Point3i(dr::floor(o + d * t)), 0,
+                             m_majorant_resolution - 1);
+    Vector3i step = dr::select(positive, 1, -1);
+    Vector3f t_delta = dr::select(parallel, dr::Infinity<Float>, dr::abs(dr::rcp(d))),
+             t_next  = dr::select(parallel, dr::Infinity<Float>,
+                                  (Vector3f(cell) + dr::select(positive, 1.f, 0.f) - o) / d);
+
+    Mask in_grid = active && !done && t < t_occ_exit;
+
+    dr::Loop<Mask> loop("Majorant grid traversal", cell, t_next, t, tau,
+                        sampled_t, majorant, control, depth, done, in_grid);
+
+    while (loop(in_grid)) {
+        UInt32 index = UInt32((cell.z() * m_majorant_resolution.y() + cell.y()) *
+                                  m_majorant_resolution.x() + cell.x());
+        UnpolarizedSpectrum mu, ctrl = 0.f;
+        if (per_channel) {
+            for (size_t c = 0; c < n_channels; ++c) {
+                UInt32 index_c = index * (uint32_t) n_channels + (uint32_t) c;
+                mu[c] = dr::gather<Float>(m_majorant_grid_rgb, index_c, in_grid);
+                if (has_control)
+                    ctrl[c] = dr::gather<Float>(m_control_grid_rgb, index_c, in_grid);
+            }
+        } else {
+            mu = dr::gather<Float>(m_majorant_grid, index, in_grid);
+            if (has_control)
+                ctrl = dr::gather<Float>(m_control_grid, index, in_grid);
+        }
+        if (residual)
+            mu -= ctrl;
+
+        /* All cells within a Chebyshev distance of 'skip - 1' are empty:
+           jump to the exit of that cube at once instead of stepping */
+        Mask jump = false;
+        if (has_skip) {
+            UInt32 skip = dr::gather<UInt32>(m_majorant_skip, index, in_grid);
+            jump = in_grid && skip > 1u;
+        }
+
+        march(dr::maximum(dr::minimum(dr::min(t_next), t_occ_exit), t), mu, ctrl,
+              in_grid && !jump);
+
+        // Step into the neighboring cell across the closest boundary
+        Mask step_x = t_next.x() <= t_next.y() && t_next.x() <= t_next.z(),
+             step_y = !step_x && t_next.y() <= t_next.z(),
+             step_z = !step_x && !step_y;
+        step_x &= !jump; step_y &= !jump; step_z &= !jump;
+
+        dr::masked(cell.x(), step_x) += step.x();
+        dr::masked(cell.y(), step_y) += step.y();
+        dr::masked(cell.z(), step_z) += step.z();
+        dr::masked(t_next.x(), step_x) += t_delta.x();
+        dr::masked(t_next.y(), step_y) += t_delta.y();
+        dr::masked(t_next.z(), step_z) += t_delta.z();
+
+        if (has_skip && dr::any_or<true>(jump)) {
+            Float radius = Float(dr::gather<UInt32>(m_majorant_skip, index, jump) - 1u);
+            Vector3f t_cube = dr::select(
+                parallel, dr::Infinity<Float>,
+                (Vector3f(cell) + dr::select(positive, 1.f + radius, -radius) - o) / d);
+            dr::masked(t, jump) = dr::minimum(dr::min(t_cube), t_occ_exit);
+
+            // Locate the cell at the new position, guarding against round-off
+            Point3i cell_j = dr::clamp(Point3i(dr::floor(o + d * t)), 0,
+                                       m_majorant_resolution - 1);
+            Vector3f t_next_j = dr::select(
+                parallel, dr::Infinity<Float>,
+                (Vector3f(cell_j) + dr::select(positive, 1.f, 0.f) - o) / d);
+            Mask behind = t_next_j <= t;
+            cell_j   = dr::select(behind, cell_j + step, cell_j);
+            t_next_j = dr::select(behind, t_next_j + t_delta, t_next_j);
+            dr::masked(cell, jump)   = cell_j;
+            dr::masked(t_next, jump) = t_next_j;
+        }
+
+        in_grid &= !done && t < t_occ_exit &&
+                   dr::all(cell >= 0 && cell < m_majorant_resolution);
+    }
+
+    // Empty remainder of the grid, then outside of it (after leaving it)
+    march(t_exit, 0.f, 0.f, active);
+    march(maxt, m_majorant_bound, 0.f, active);
+
+    return { sampled_t, majorant, control, depth };
+}
+
+MI_VARIANT
+std::tuple<typename Medium<Float, Spectrum>::MediumInteraction3f,
+           typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
+           typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
+Medium<Float, Spectrum>::sample_interaction_residual(const Ray3f &ray,
+                                                     Float sample,
+                                                     Mask active) const {
+    MI_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+
+    MediumInteraction3f mei = dr::zeros<MediumInteraction3f>();
+    mei.wi          = -ray.d;
+    mei.sh_frame    = Frame3f(mei.wi);
+    mei.time        = ray.time;
+    mei.wavelengths = ray.wavelengths;
+
+    auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+    aabb_its &= (dr::isfinite(mint) || dr::isfinite(maxt));
+    active &= aabb_its;
+    dr::masked(mint, !active) = 0.f;
+    dr::masked(maxt, !active) = dr::Infinity<Float>;
+
+    mint = dr::maximum(0.f, mint);
+    maxt = dr::minimum(ray.maxt, maxt);
+
+    Float sampled_t, majorant;
+    UnpolarizedSpectrum control, control_depth;
+
+    if (has_majorant_grid()) {
+        UnpolarizedSpectrum residual_majorant;
+        std::tie(sampled_t, residual_majorant, control, control_depth) =
+            sample_majorant_grid(ray, mint, maxt, sample, 0u,
+                                 MajorantGridMode::Residual, active);
+        majorant = residual_majorant[0];
+    } else if (m_is_homogeneous) {
+        // The extinction itself is the ideal control: no collisions needed
+        mei.medium    = this;
+        mei.p         = ray(mint);
+        auto [sigma_s, sigma_n, sigma_t] = get_scattering_coefficients(mei, active);
+        DRJIT_MARK_USED(sigma_s);
+        DRJIT_MARK_USED(sigma_n);
+        sampled_t     = dr::Infinity<Float>;
+        majorant      = 0.f;
+        control       = sigma_t;
+        control_depth = dr::select(active, sigma_t * (maxt - mint), 0.f);
+    } else {
+        // Plain ratio tracking against a single (channel-uniform) majorant
+        majorant      = dr::max(get_majorant(mei, active));
+        sampled_t     = mint + (-dr::log(1 - sample) / majorant);
+        control       = 0.f;
+        control_depth = 0.f;
+    }
+
+    Mask valid_mi   = active && (sampled_t <= maxt);
+    mei.t           = dr::select(valid_mi, sampled_t, dr::Infinity<Float>);
+    mei.p           = ray(sampled_t);
+    mei.medium      = this;
+    mei.mint        = mint;
+    mei.combined_extinction = majorant;
+
+    std::tie(mei.sigma_s, mei.sigma_n, mei.sigma_t) =
+        get_scattering_coefficients(mei, valid_mi);
+
+    // Null extinction with respect to the residual majorant
+    mei.sigma_n = mei.combined_extinction - (mei.sigma_t - control);
+    return { mei, control, control_depth };
+}
+
+MI_VARIANT
+std::tuple<typename Medium<Float, Spectrum>::MediumInteraction3f,
+           typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
+           typename Medium<Float, Spectrum>::Mask>
+Medium<Float, Spectrum>::sample_interaction_decomposition(const Ray3f &ray,
+                                                          const Point2f &sample,
+                                                          UInt32 channel,
+                                                          Mask active) const {
+    MI_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+
+    MediumInteraction3f mei = dr::zeros<MediumInteraction3f>();
+    mei.wi          = -ray.d;
+    mei.sh_frame    = Frame3f(mei.wi);
+    mei.time        = ray.time;
+    mei.wavelengths = ray.wavelengths;
+
+    auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+    aabb_its &= (dr::isfinite(mint) || dr::isfinite(maxt));
+    active &= aabb_its;
+    dr::masked(mint, !active) = 0.f;
+    dr::masked(maxt, !active) = dr::Infinity<Float>;
+
+    mint = dr::maximum(0.f, mint);
+    maxt = dr::minimum(ray.maxt, maxt);
+
+    auto channel_value = [&](const UnpolarizedSpectrum &value) {
+        Float v = value[0];
+        if constexpr (is_rgb_v<Spectrum>) {
+            dr::masked(v, dr::eq(channel, 1u)) = value[1];
+            dr::masked(v, dr::eq(channel, 2u)) = value[2];
+        }
+        return v;
+    };
+
+    Float sampled_t;
+    UnpolarizedSpectrum majorant, control, optical_depth;
+
+    if (has_majorant_grid()) {
+        std::tie(sampled_t, majorant, control, optical_depth) =
+            sample_majorant_grid(ray, mint, maxt, sample.x(), channel,
+                                 MajorantGridMode::Decomposition, active);
+    } else {
+        majorant  = get_majorant(mei, active);
+        sampled_t = mint + (-dr::log(1 - sample.x()) / channel_value(majorant));
+        dr::masked(sampled_t, !(sampled_t <= maxt)) = dr::Infinity<Float>;
+
+        // The extinction of homogeneous media is its own control
+        control       = m_is_homogeneous ? majorant : UnpolarizedSpectrum(0.f);
+        optical_depth = dr::select(
+            active && majorant > 0.f,
+            majorant * (dr::minimum(sampled_t, maxt) - mint), 0.f);
+    }
+
+    Mask valid_mi   = active && (sampled_t <= maxt);
+    mei.t           = dr::select(valid_mi, sampled_t, dr::Infinity<Float>);
+    mei.p           = ray(sampled_t);
+    mei.medium      = this;
+    mei.mint        = mint;
+    mei.combined_extinction = majorant;
+
+    // Select the component that produced the collision
+    Mask is_control  = valid_mi && (sample.y() * channel_value(majorant) <
+                                    channel_value(control)),
+         is_residual = valid_mi && !is_control;
+
+    // Collisions with the control component don't need the extinction
+    UnpolarizedSpectrum albedo = get_albedo(mei, is_control);
+    auto [sigma_s, sigma_n, sigma_t] = get_scattering_coefficients(mei, is_residual);
+    DRJIT_MARK_USED(sigma_n);
+
+    UnpolarizedSpectrum sigma_r = sigma_t - control;
+    mei.sigma_t = dr::select(is_control, control, sigma_r);
+    mei.sigma_s = dr::select(is_control, albedo * control,
+                             dr::select(dr::neq(sigma_t, 0.f),
+                                        sigma_s * sigma_r / sigma_t, 0.f));
+    mei.sigma_n = dr::select(is_control, 0.f, majorant - sigma_t);
+
+    return { mei, optical_depth, is_control };
+}
+
 MI_IMPLEMENT_CLASS_VARIANT(Medium, Object, "medium")
 MI_INSTANTIATE_CLASS(Medium)
 NAMESPACE_END(mitsuba)
@@ -1,13 +1,18 @@
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
+#include <mitsuba/render/texture.h>
+#include <drjit/half.h>
+#include <nanothread/nanothread.h>
 
 #if defined(MI_ENABLE_EMBREE)
     #include <embree3/rtcore.h>
@@ -29,6 +34,39 @@ MI_VARIANT Mesh<Float, Spectrum>::Mesh(const Properties &props) : Base(props) {
 
     m_face_normals = props.get<bool>("face_normals", false);
     m_flip_normals = props.get<bool>("flip_normals", false);
+
+    /* When set to ``true``, vertex normals and texture coordinates are stored
+       in a compact quantized form (octahedral normals, half-precision UVs)
+       that uses 8 instead of 20 bytes per vertex. Default: ``false`` */
+    m_quantize = props.get<bool>("quantize", false);
+
+    /* When set to ``true``, per-vertex tangent frames are precomputed from
+       the texture coordinates, which makes the shading frame (and hence
+       normal and bump mapping) continuous across faces. Default: ``false`` */
+    m_tangents = props.get<bool>("tangents", false);
+
+    /* When set to ``true``, triangles are sampled using an alias table with
+       O(1) lookups instead of a binary search over the area CDF. This does
+       not preserve the stratification of the input sample. Default: ``false`` */
+    m_alias_sampling = props.get<bool>("alias_sampling", false);
+
+    /* Strategy used to sample directions towards the mesh when it is an
+       emitter: uniform area sampling, uniform sampling of the spherical
+       triangle subtended by the chosen face, or a variant of the latter
+       that also accounts for the cosine at the reference point.
+       Default: ``area`` */
+    std::string direction_sampling =
+        props.string("direction_sampling", "area");
+    if (direction_sampling == "area")
+        m_direction_sampling = DirectionSampling::Area;
+    else if (direction_sampling == "solid_angle")
+        m_direction_sampling = DirectionSampling::SolidAngle;
+    else if (direction_sampling == "projected_solid_angle")
+        m_direction_sampling = DirectionSampling::ProjectedSolidAngle;
+    else
+        Throw("Invalid direction sampling strategy \"%s\", must be one of: "
+              "\"area\", \"solid_angle\", or \"projected_solid_angle\"!",
+              direction_sampling);
 }
 
 MI_VARIANT
@@ -50,18 +88,155 @@ Mesh<Float, Spectrum>::Mesh(const std::string &name, ScalarSize vertex_count,
     initialize();
 }
 
+MI_VARIANT
+Mesh<Float, Spectrum>::Mesh(const std::string &name,
+                            const FloatStorage &vertex_positions,
+                            const DynamicBuffer<UInt32> &faces,
+                            const FloatStorage &vertex_normals,
+                            const FloatStorage &vertex_texcoords,
+                            const Properties &props) : Mesh(props) {
+    m_name = name;
+
+    size_t position_count = dr::width(vertex_positions),
+           index_count    = dr::width(faces);
+    if (position_count % 3 != 0)
+        Throw("Mesh(\"%s\"): the vertex position buffer must contain three "
+              "entries per vertex (got %zu)!", name, position_count);
+    if (index_count % 3 != 0)
+        Throw("Mesh(\"%s\"): the face buffer must contain three entries per "
+              "face (got %zu)!", name, index_count);
+
+    m_vertex_count = (ScalarSize) (position_count / 3);
+    m_face_count = (ScalarSize) (index_count / 3);
+
+    if (dr::width(vertex_normals) != 0 &&
+        dr::width(vertex_normals) != position_count)
+        Throw("Mesh(\"%s\"): expected %zu vertex normal entries (got %zu)!",
+              name, position_count, dr::width(vertex_normals));
+    if (dr::width(vertex_texcoords) != 0 &&
+        dr::width(vertex_texcoords) != 2 * (size_t) m_vertex_count)
+        Throw("Mesh(\"%s\"): expected %zu texture coordinate entries (got %zu)!",
+              name, 2 * (size_t) m_vertex_count, dr::width(vertex_texcoords));
+
+    // JIT arrays are reference counted: this doesn't copy the underlying memory
+    m_vertex_positions = vertex_positions;
+    m_vertex_normals = vertex_normals;
+    m_vertex_texcoords = vertex_texcoords;
+    m_faces = faces;
+
+    recompute_bbox();
+    initialize();
+}
+
 MI_VARIANT
 void Mesh<Float, Spectrum>::initialize() {
 #if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
     m_vertex_positions_ptr = m_vertex_positions.data();
     m_faces_ptr = m_faces.data();
 #endif
+    if (m_tangents && has_vertex_texcoords())
+        recompute_vertex_tangents();
+    if (m_quantize && !m_quantized)
+        quantize_attributes();
     if (m_emitter || m_sensor)
         ensure_pmf_built();
+    update_memory();
     mark_dirty();
     Base::initialize();
 }
 
+MI_VARIANT void Mesh<Float, Spectrum>::update_memory() {
+    size_t size =
+        (dr::width(m_vertex_positions) + dr::width(m_vertex_normals) +
+         dr::width(m_vertex_texcoords) + dr::width(m_vertex_tangents)) * sizeof(InputFloat) +
+        (dr::width(m_faces) + dr::width(m_vertex_normals_quantized) +
+         dr::width(m_vertex_texcoords_quantized) + dr::width(m_vertex_corner_offsets) +
+         dr::width(m_vertex_corners)) * sizeof(ScalarIndex);
+#if defined(MI_ENABLE_CUDA)
+    size += dr::width(m_optix_faces) * sizeof(ScalarIndex);
+#endif
+    for (const auto &[name, attribute] : m_mesh_attributes)
+        size += dr::width(attribute.buf) * sizeof(InputFloat);
+
+    m_memory.set_bytes(size, dr::is_cuda_v<Float>);
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::quantize_attributes() {
+    auto&& vertex_normals   = dr::migrate(m_vertex_normals, AllocType::Host);
+    auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    if (dr::width(vertex_normals) != 0) {
+        const InputFloat *ptr = vertex_normals.data();
+        std::unique_ptr<uint32_t[]> data(new uint32_t[m_vertex_count]);
+
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            InputNormal3f n = dr::load<InputNormal3f>(ptr + 3 * i);
+            n /= dr::abs(n.x()) + dr::abs(n.y()) + dr::abs(n.z());
+            InputFloat x = n.x(), y = n.y();
+            if (n.z() < 0.f) {
+                x = (1.f - dr::abs(n.y())) * dr::sign(n.x());
+                y = (1.f - dr::abs(n.x())) * dr::sign(n.y());
+            }
+            uint32_t qx = (uint32_t) dr::round(dr::clamp(x * .5f + .5f, 0.f, 1.f) * 65535.f),
+                     qy = (uint32_t) dr::round(dr::clamp(y * .5f + .5f, 0.f, 1.f) * 65535.f);
+            data[i] = qx | (qy << 16);
+        }
+
+        m_vertex_normals_quantized =
+            dr::load<DynamicBuffer<UInt32>>(data.get(), m_vertex_count);
+        m_vertex_normals = FloatStorage();
+    }
+
+    if (dr::width(vertex_texcoords) != 0) {
+        const InputFloat *ptr = vertex_texcoords.data();
+        std::unique_ptr<uint32_t[]> data(new uint32_t[m_vertex_count]);
+
+        for (ScalarSize i = 0; i < m_vertex_count; ++i)
+            data[i] = (uint32_t) dr::half::float32_to_float16(ptr[2 * i + 0]) |
+                      ((uint32_t) dr::half::float32_to_float16(ptr[2 * i + 1]) << 16);
+
+        m_vertex_texcoords_quantized =
+            dr::load<DynamicBuffer<UInt32>>(data.get(), m_vertex_count);
+        m_vertex_texcoords = FloatStorage();
+    }
+
+    m_quantized = true;
+}
+
+MI_VARIANT typename Mesh<Float, Spectrum>::FloatStorage
+Mesh<Float, Spectrum>::decoded_vertex_normals() const {
+    if (!m_quantized || dr::width(m_vertex_normals_quantized) == 0)
+        return m_vertex_normals;
+
+    using UInt32Storage = DynamicBuffer<UInt32>;
+    using NormalStorage = Normal<FloatStorage, 3>;
+    UInt32Storage index = dr::arange<UInt32Storage>(m_vertex_count);
+    NormalStorage n = vertex_normal(index);
+
+    FloatStorage result = dr::empty<FloatStorage>(m_vertex_count * 3);
+    for (size_t i = 0; i < 3; ++i)
+        dr::scatter(result, n[i], index * 3 + (uint32_t) i);
+    return result;
+}
+
+MI_VARIANT typename Mesh<Float, Spectrum>::FloatStorage
+Mesh<Float, Spectrum>::decoded_vertex_texcoords() const {
+    if (!m_quantized || dr::width(m_vertex_texcoords_quantized) == 0)
+        return m_vertex_texcoords;
+
+    using UInt32Storage = DynamicBuffer<UInt32>;
+    using PointStorage = Point<FloatStorage, 2>;
+    UInt32Storage index = dr::arange<UInt32Storage>(m_vertex_count);
+    PointStorage uv = vertex_texcoord(index);
+
+    FloatStorage result = dr::empty<FloatStorage>(m_vertex_count * 2);
+    for (size_t i = 0; i < 2; ++i)
+        dr::scatter(result, uv[i], index * 2 + (uint32_t) i);
+    return result;
+}
+
 MI_VARIANT Mesh<Float, Spectrum>::~Mesh() { }
 
 MI_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
@@ -71,8 +246,11 @@ MI_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
     callback->put_parameter("face_count",       m_face_count,       +ParamFlags::NonDifferentiable);
     callback->put_parameter("faces",            m_faces,            +ParamFlags::NonDifferentiable);
     callback->put_parameter("vertex_positions", m_vertex_positions, ParamFlags::Differentiable | ParamFlags::Discontinuous);
-    callback->put_parameter("vertex_normals",   m_vertex_normals,   ParamFlags::Differentiable | ParamFlags::Discontinuous);
-    callback->put_parameter("vertex_texcoords", m_vertex_texcoords, +ParamFlags::Differentiable);
+    // Quantized normals and texture coordinates cannot be edited
+    if (!m_quantized) {
+        callback->put_parameter("vertex_normals",   m_vertex_normals,   ParamFlags::Differentiable | ParamFlags::Discontinuous);
+        callback->put_parameter("vertex_texcoords", m_vertex_texcoords, +ParamFlags::Differentiable);
+    }
 
     // We arbitrarily chose to show all attributes as being differentiable here.
     for (auto &[name, attribute]: m_mesh_attributes)
@@ -80,14 +258,31 @@ MI_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std::string> &keys) {
+    // The vertex-to-face adjacency must be rebuilt when the topology changes
+    if (keys.empty() || string::contains(keys, "faces")) {
+        m_vertex_corner_offsets = DynamicBuffer<UInt32>();
+        m_vertex_corners = DynamicBuffer<UInt32>();
+        m_faces_changed = true;
+
+#if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
+        m_faces_ptr = m_faces.data();
+#endif
+        mark_dirty();
+    }
+
     if (keys.empty() || string::contains(keys, "vertex_positions")) {
         recompute_bbox();
 
         if (has_vertex_normals())
             recompute_vertex_normals();
 
-        if (!m_area_pmf.empty())
+        if (has_vertex_tangents())
+            recompute_vertex_tangents();
+
+        if (!m_area_pmf.empty()) {
             m_area_pmf = DiscreteDistribution<Float>();
+            m_area_alias = AliasDistribution<Float>();
+        }
 
         if (m_parameterization)
             m_parameterization = nullptr;
@@ -97,7 +292,12 @@ MI_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std:
         m_faces_ptr = m_faces.data();
 #endif
         mark_dirty();
+    } else if (has_vertex_tangents() &&
+               (string::contains(keys, "vertex_normals") ||
+                string::contains(keys, "vertex_texcoords"))) {
+        recompute_vertex_tangents();
     }
+    update_memory();
     Base::parameters_changed();
 }
 
@@ -142,11 +342,179 @@ MI_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) co
         util::time_string((float) timer.value()));
 }
 
+MI_VARIANT void Mesh<Float, Spectrum>::write_bundle(
+    const std::string &filename, const std::vector<ref<Mesh>> &meshes) {
+    ref<FileStream> stream =
+        new FileStream(filename, FileStream::ETruncReadWrite);
+
+    Timer timer;
+    Log(Info, "Writing %zu meshes to bundle \"%s\" ..", meshes.size(), filename);
+
+    auto align = [](uint64_t offset) {
+        return (offset + detail::mesh_bundle_alignment - 1) /
+               detail::mesh_bundle_alignment * detail::mesh_bundle_alignment;
+    };
+
+    detail::MeshBundleHeader header;
+    memcpy(header.magic, "MIBUNDLE", 8);
+    header.version    = detail::mesh_bundle_version;
+    header.mesh_count = (uint32_t) meshes.size();
+
+    // Lay out the page-aligned buffers after the table of contents
+    std::vector<detail::MeshBundleEntry> entries(meshes.size());
+    uint64_t offset = align(sizeof(detail::MeshBundleHeader) +
+                            entries.size() * sizeof(detail::MeshBundleEntry));
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh *mesh = meshes[i].get();
+        detail::MeshBundleEntry &entry = entries[i];
+        memset(&entry, 0, sizeof(detail::MeshBundleEntry));
+
+        if (!mesh->m_mesh_attributes.empty())
+            Log(Warn, "write_bundle(): the attributes of mesh \"%s\" are "
+                      "not stored!", mesh->m_name);
+
+        strncpy(entry.name, mesh->m_name.c_str(), sizeof(entry.name) - 1);
+        entry.vertex_count = mesh->m_vertex_count;
+        entry.face_count   = mesh->m_face_count;
+        entry.flags = (mesh->has_vertex_normals() ? 1 : 0) |
+                      (mesh->has_vertex_texcoords() ? 2 : 0) |
+                      (mesh->m_face_normals ? 4 : 0);
+        for (size_t k = 0; k < 3; ++k) {
+            entry.bbox_min[k] = (float) mesh->m_bbox.min[k];
+            entry.bbox_max[k] = (float) mesh->m_bbox.max[k];
+        }
+
+        auto place = [&](uint64_t &target, uint64_t size) {
+            target = offset;
+            offset = align(offset + size);
+        };
+        place(entry.positions, entry.vertex_count * 3 * sizeof(InputFloat));
+        if (entry.flags & 1)
+            place(entry.normals, entry.vertex_count * 3 * sizeof(InputFloat));
+        if (entry.flags & 2)
+            place(entry.texcoords, entry.vertex_count * 2 * sizeof(InputFloat));
+        place(entry.faces, entry.face_count * 3 * sizeof(ScalarIndex));
+    }
+
+    stream->write(&header, sizeof(detail::MeshBundleHeader));
+    stream->write(entries.data(), entries.size() * sizeof(detail::MeshBundleEntry));
+
+    std::unique_ptr<uint8_t[]> zeros(new uint8_t[detail::mesh_bundle_alignment]());
+    auto write_at = [&](uint64_t target, const void *ptr, size_t size) {
+        stream->write(zeros.get(), (size_t) (target - stream->tell()));
+        stream->write(ptr, size);
+    };
+
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh *mesh = meshes[i].get();
+        const detail::MeshBundleEntry &entry = entries[i];
+
+        auto&& vertex_positions = dr::migrate(mesh->m_vertex_positions, AllocType::Host);
+        auto&& vertex_normals   = dr::migrate(mesh->decoded_vertex_normals(), AllocType::Host);
+        auto&& vertex_texcoords = dr::migrate(mesh->decoded_vertex_texcoords(), AllocType::Host);
+        auto&& faces = dr::migrate(mesh->m_faces, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        write_at(entry.positions, vertex_positions.data(),
+                 entry.vertex_count * 3 * sizeof(InputFloat));
+        if (entry.normals)
+            write_at(entry.normals, vertex_normals.data(),
+                     entry.vertex_count * 3 * sizeof(InputFloat));
+        if (entry.texcoords)
+            write_at(entry.texcoords, vertex_texcoords.data(),
+                     entry.vertex_count * 2 * sizeof(InputFloat));
+        write_at(entry.faces, faces.data(),
+                 entry.face_count * 3 * sizeof(ScalarIndex));
+    }
+
+    Log(Info, "\"%s\": wrote %zu meshes (%s in %s)", filename, meshes.size(),
+        util::mem_string(stream->size()),
+        util::time_string((float) timer.value()));
+}
+
+/// Array of per-element values that is stored in the records of a PLY file
+struct PLYField {
+    const void *data;
+    /// Bytes per element
+    size_t size;
+};
+
+/// Interleave the fields of a range of elements into packed PLY records
+static void encode_ply_records(uint8_t *out, const std::vector<PLYField> &fields,
+                               bool list_prefix, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        // Faces start with their number of vertices
+        if (list_prefix)
+            *out++ = 3;
+        for (const PLYField &field : fields) {
+            memcpy(out, (const uint8_t *) field.data + i * field.size, field.size);
+            out += field.size;
+        }
+    }
+}
+
+/**
+ * Write the records of \c count elements to a stream. The records are encoded
+ * into large buffers on the thread pool, and the next buffer is encoded while
+ * the previous one is written.
+ */
+static void write_ply_records(Stream *stream, const std::vector<PLYField> &fields,
+                              bool list_prefix, size_t count) {
+    size_t record_size = list_prefix ? 1 : 0;
+    for (const PLYField &field : fields)
+        record_size += field.size;
+
+    // Records per buffer (about 16 MiB)
+    size_t batch_size = std::max((size_t) 1, ((size_t) 16 << 20) / record_size);
+    batch_size = std::min(batch_size, std::max(count, (size_t) 1));
+
+    std::unique_ptr<uint8_t[]> buffers[2] = {
+        std::unique_ptr<uint8_t[]>(new uint8_t[batch_size * record_size]),
+        std::unique_ptr<uint8_t[]>(new uint8_t[batch_size * record_size])
+    };
+
+    auto encode = [&fields, list_prefix, record_size](uint8_t *out, size_t begin,
+                                                     size_t end) {
+        dr::parallel_for(
+            dr::blocked_range<size_t>(begin, end, 16384),
+            [&](const dr::blocked_range<size_t> &range) {
+                encode_ply_records(out + (range.begin() - begin) * record_size,
+                                   fields, list_prefix, range.begin(),
+                                   range.end());
+            }
+        );
+    };
+
+    encode(buffers[0].get(), 0, std::min(batch_size, count));
+    for (size_t begin = 0, k = 0; begin < count; begin += batch_size, k ^= 1) {
+        size_t end = std::min(begin + batch_size, count),
+               next_end = std::min(end + batch_size, count);
+
+        Task *task = nullptr;
+        if (end < count)
+            task = dr::do_async([&encode, &buffers, k, end, next_end]() {
+                encode(buffers[k ^ 1].get(), end, next_end);
+            });
+
+        try {
+            stream->write(buffers[k].get(), (end - begin) * record_size);
+        } catch (...) {
+            // The task still references the buffers
+            if (task)
+                task_wait_and_release(task);
+            throw;
+        }
+
+        if (task)
+            task_wait_and_release(task);
+    }
+}
+
 MI_VARIANT void Mesh<Float, Spectrum>::write_ply(Stream *stream) const {
     auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
-    auto&& vertex_normals   = dr::migrate(m_vertex_normals, AllocType::Host);
-    auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
-    auto&& faces = dr::migrate(m_faces, AllocType::Host);
+    auto&& vertex_normals   = dr::migrate(decoded_vertex_normals(), AllocType::Host);
+    auto&& vertex_texcoords = dr::migrate(decoded_vertex_texcoords(), AllocType::Host);
 
     std::vector<std::pair<std::string, MeshAttribute>> vertex_attributes;
     std::vector<std::pair<std::string, MeshAttribute>> face_attributes;
@@ -158,8 +526,8 @@ MI_VARIANT void Mesh<Float, Spectrum>::write_ply(Stream *stream) const {
                     { name.substr(7), attribute.migrate(AllocType::Host) });
                 break;
             case MeshAttributeType::Face:
-                face_attributes.push_back(
-                    { name.substr(5), attribute.migrate(AllocType::Host) });
+                // Migrated once the vertex buffers are available (see below)
+                face_attributes.push_back({ name.substr(5), attribute });
                 break;
         }
     }
@@ -202,59 +570,36 @@ MI_VARIANT void Mesh<Float, Spectrum>::write_ply(Stream *stream) const {
 
     stream->write_line("end_header");
 
-    // Write vertices data
-    const InputFloat* position_ptr = vertex_positions.data();
-    const InputFloat* normal_ptr   = vertex_normals.data();
-    const InputFloat* texcoord_ptr = vertex_texcoords.data();
-
-    std::vector<const InputFloat*> vertex_attributes_ptr;
+    // Vertex records: positions, normals, texture coordinates and attributes
+    std::vector<PLYField> vertex_fields;
+    vertex_fields.push_back({ vertex_positions.data(), 3 * sizeof(InputFloat) });
+    if (has_vertex_normals())
+        vertex_fields.push_back({ vertex_normals.data(), 3 * sizeof(InputFloat) });
+    if (has_vertex_texcoords())
+        vertex_fields.push_back({ vertex_texcoords.data(), 2 * sizeof(InputFloat) });
     for (const auto&[name, attribute]: vertex_attributes)
-        vertex_attributes_ptr.push_back(attribute.buf.data());
-
-    for (size_t i = 0; i < m_vertex_count; i++) {
-        // Write positions
-        stream->write(position_ptr, 3 * sizeof(InputFloat));
-        position_ptr += 3;
-        // Write normals
-        if (has_vertex_normals()) {
-            stream->write(normal_ptr, 3 * sizeof(InputFloat));
-            normal_ptr += 3;
-        }
-        // Write texture coordinates
-        if (has_vertex_texcoords()) {
-            stream->write(texcoord_ptr, 2 * sizeof(InputFloat));
-            texcoord_ptr += 2;
-        }
+        vertex_fields.push_back({ attribute.buf.data(), attribute.size * sizeof(InputFloat) });
 
-        for (size_t j = 0; j < vertex_attributes_ptr.size(); ++j) {
-            const auto&[name, attribute] = vertex_attributes[j];
-            stream->write(vertex_attributes_ptr[j], attribute.size * sizeof(InputFloat));
-            vertex_attributes_ptr[j] += attribute.size;
-        }
-    }
+    /* Copy the face buffers to the host while the vertex records are
+       written. Only copies into pinned memory are asynchronous in CUDA. */
+    AllocType face_alloc =
+        dr::is_cuda_v<Float> ? AllocType::HostPinned : AllocType::Host;
+    auto&& faces = dr::migrate(m_faces, face_alloc);
+    for (auto &[name, attribute] : face_attributes)
+        attribute = attribute.migrate(face_alloc);
 
-    const ScalarIndex* face_ptr = faces.data();
+    write_ply_records(stream, vertex_fields, false, m_vertex_count);
+
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
 
-    std::vector<const InputFloat*> face_attributes_ptr;
+    // Face records: vertex count (see 'list_prefix'), indices and attributes
+    std::vector<PLYField> face_fields;
+    face_fields.push_back({ faces.data(), 3 * sizeof(ScalarIndex) });
     for (const auto&[name, attribute]: face_attributes)
-        face_attributes_ptr.push_back(attribute.buf.data());
-
-    // Write faces data
-    uint8_t vertex_indices_count = 3;
-    for (size_t i = 0; i < m_face_count; i++) {
-        // Write vertex count
-        stream->write(&vertex_indices_count, sizeof(uint8_t));
-
-        // Write positions
-        stream->write(face_ptr, 3 * sizeof(ScalarIndex));
-        face_ptr += 3;
-
-        for (size_t j = 0; j < face_attributes_ptr.size(); ++j) {
-            const auto&[name, attribute] = face_attributes[j];
-            stream->write(face_attributes_ptr[j], attribute.size * sizeof(InputFloat));
-            face_attributes_ptr[j] += attribute.size;
-        }
-    }
+        face_fields.push_back({ attribute.buf.data(), attribute.size * sizeof(InputFloat) });
+
+    write_ply_records(stream, face_fields, true, m_face_count);
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
@@ -262,81 +607,154 @@ MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
         Throw("Storing new normals in a Mesh that didn't have normals at "
               "construction time is not implemented yet.");
 
+    // Quantized normals are recomputed in full precision and re-encoded
+    if (m_quantized) {
+        m_vertex_normals = dr::zeros<FloatStorage>(m_vertex_count * 3);
+        m_vertex_normals_quantized = DynamicBuffer<UInt32>();
+        m_quantized = false;
+        recompute_vertex_normals();
+        quantize_attributes();
+        return;
+    }
+
     /* Weighting scheme based on "Computing Vertex Normals from Polygonal Facets"
-       by Grit Thuermer and Charles A. Wuethrich, JGT 1998, Vol 3 */
+       by Grit Thuermer and Charles A. Wuethrich, JGT 1998, Vol 3.
 
-    if constexpr (!dr::is_dynamic_v<Float>) {
-        size_t invalid_counter = 0;
-        std::vector<InputNormal3f> normals(m_vertex_count, dr::zeros<InputNormal3f>());
-
-        for (ScalarSize i = 0; i < m_face_count; ++i) {
-            auto fi = face_indices(i);
-            Assert(fi[0] < m_vertex_count &&
-                   fi[1] < m_vertex_count &&
-                   fi[2] < m_vertex_count);
-
-            InputPoint3f v[3] = { vertex_position(fi[0]),
-                                  vertex_position(fi[1]),
-                                  vertex_position(fi[2]) };
-
-            InputVector3f side_0 = v[1] - v[0],
-                          side_1 = v[2] - v[0];
-            InputNormal3f n = dr::cross(side_0, side_1);
-            InputFloat length_sqr = dr::squared_norm(n);
-            if (likely(length_sqr > 0)) {
-                n *= dr::rsqrt(length_sqr);
-
-                // Use DrJit to compute the face angles at the same time
-                auto side1 = transpose(dr::Array<dr::Packet<InputFloat, 3>, 3>{ side_0, v[2] - v[1], v[0] - v[2] });
-                auto side2 = transpose(dr::Array<dr::Packet<InputFloat, 3>, 3>{ side_1, v[0] - v[1], v[1] - v[2] });
-                InputVector3f face_angles = unit_angle(dr::normalize(side1), dr::normalize(side2));
+       The angle-weighted face normals are first computed for every face
+       corner and then summed per vertex by walking the vertex-to-face
+       adjacency, which avoids atomic scatters and makes the result
+       independent of the thread schedule. */
 
-                for (size_t j = 0; j < 3; ++j)
-                    normals[fi[j]] += n * face_angles[j];
-            }
-        }
+    build_vertex_adjacency();
 
-        for (ScalarSize i = 0; i < m_vertex_count; i++) {
-            InputNormal3f n = normals[i];
-            InputFloat length = dr::norm(n);
-            if (likely(length != 0.f)) {
-                n /= length;
-            } else {
-                n = InputNormal3f(1, 0, 0); // Choose some bogus value
-                invalid_counter++;
+    if constexpr (!dr::is_dynamic_v<Float>) {
+        std::unique_ptr<InputNormal3f[]> corner_normals(
+            new InputNormal3f[3 * (size_t) m_face_count]);
+
+        dr::parallel_for(
+            dr::blocked_range<ScalarSize>(0, m_face_count, 4096),
+            [&](const dr::blocked_range<ScalarSize> &range) {
+                for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                    auto fi = face_indices(i);
+                    InputPoint3f v[3] = { vertex_position(fi[0]),
+                                          vertex_position(fi[1]),
+                                          vertex_position(fi[2]) };
+
+                    InputVector3f side_0 = v[1] - v[0],
+                                  side_1 = v[2] - v[0];
+                    InputNormal3f n = dr::cross(side_0, side_1);
+                    InputFloat length_sqr = dr::squared_norm(n);
+                    InputVector3f face_angles(0.f);
+
+                    if (likely(length_sqr > 0)) {
+                        n *= dr::rsqrt(length_sqr);
+
+                        // Use DrJit to compute the face angles at the same time
+                        auto side1 = transpose(dr::Array<dr::Packet<InputFloat, 3>, 3>{ side_0, v[2] - v[1], v[0] - v[2] });
+                        auto side2 = transpose(dr::Array<dr::Packet<InputFloat, 3>, 3>{ side_1, v[0] - v[1], v[1] - v[2] });
+                        face_angles = unit_angle(dr::normalize(side1), dr::normalize(side2));
+                    }
+
+                    for (size_t j = 0; j < 3; ++j)
+                        corner_normals[3 * i + j] = n * face_angles[j];
+                }
             }
-
-            dr::store(m_vertex_normals.data() + 3 * i, n);
-        }
+        );
+
+        const ScalarIndex *offsets = m_vertex_corner_offsets.data(),
+                          *corners = m_vertex_corners.data();
+        std::atomic<size_t> invalid_counter(0);
+
+        dr::parallel_for(
+            dr::blocked_range<ScalarSize>(0, m_vertex_count, 4096),
+            [&](const dr::blocked_range<ScalarSize> &range) {
+                size_t invalid = 0;
+                for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                    InputNormal3f n = dr::zeros<InputNormal3f>();
+                    for (ScalarIndex k = offsets[i]; k < offsets[i + 1]; ++k)
+                        n += corner_normals[corners[k]];
+
+                    InputFloat length = dr::norm(n);
+                    if (likely(length != 0.f)) {
+                        n /= length;
+                    } else {
+                        n = InputNormal3f(1, 0, 0); // Choose some bogus value
+                        invalid++;
+                    }
+
+                    dr::store(m_vertex_normals.data() + 3 * i, n);
+                }
+                invalid_counter += invalid;
+            }
+        );
 
         if (invalid_counter > 0)
             Log(Warn, "\"%s\": computed vertex normals (%i invalid vertices!)",
-                m_name, invalid_counter);
+                m_name, (size_t) invalid_counter);
     } else {
-        // The following is JITed into two separate kernel launches
+        Vector3f normals;
 
-        // --------------------- Kernel 1 starts here ---------------------
-        Vector3u fi = face_indices(dr::arange<UInt32>(m_face_count));
+        if (dr::grad_enabled(m_vertex_positions)) {
+            /* Recorded loops can't be differentiated: accumulate the face
+               normals using a scatter, whose adjoint is a gather */
+            Vector3u fi = face_indices(dr::arange<UInt32>(m_face_count));
 
-        Vector3f v[3] = { vertex_position(fi[0]),
-                          vertex_position(fi[1]),
-                          vertex_position(fi[2]) };
+            Vector3f v[3] = { vertex_position(fi[0]),
+                              vertex_position(fi[1]),
+                              vertex_position(fi[2]) };
 
-        Vector3f n = dr::normalize(dr::cross(v[1] - v[0], v[2] - v[0]));
+            Vector3f n = dr::normalize(dr::cross(v[1] - v[0], v[2] - v[0]));
 
-        Vector3f normals = dr::zeros<Vector3f>(m_vertex_count);
-        for (int i = 0; i < 3; ++i) {
-            Vector3f d0 = dr::normalize(v[(i + 1) % 3] - v[i]);
-            Vector3f d1 = dr::normalize(v[(i + 2) % 3] - v[i]);
-            Float face_angle = dr::safe_acos(dr::dot(d0, d1));
+            normals = dr::zeros<Vector3f>(m_vertex_count);
+            for (int i = 0; i < 3; ++i) {
+                Vector3f d0 = dr::normalize(v[(i + 1) % 3] - v[i]);
+                Vector3f d1 = dr::normalize(v[(i + 2) % 3] - v[i]);
+                Float face_angle = dr::safe_acos(dr::dot(d0, d1));
 
-            Vector3f nn = n * face_angle;
-            for (int j = 0; j < 3; ++j)
-                dr::scatter_reduce(ReduceOp::Add, normals[j], nn[j], fi[i]);
+                Vector3f nn = n * face_angle;
+                for (int j = 0; j < 3; ++j)
+                    dr::scatter_reduce(ReduceOp::Add, normals[j], nn[j], fi[i]);
+            }
+        } else {
+            // --------------------- Kernel 1 starts here ---------------------
+
+            // Angle-weighted face normal of every face corner
+            UInt32 corner = dr::arange<UInt32>(3 * m_face_count),
+                   face   = corner / 3,
+                   k0     = corner - face * 3,
+                   k1     = dr::select(dr::eq(k0, 2u), 0u, k0 + 1u),
+                   k2     = dr::select(dr::eq(k0, 0u), 2u, k0 - 1u);
+
+            Point3f p0 = vertex_position(dr::gather<UInt32>(m_faces, face * 3 + k0)),
+                    p1 = vertex_position(dr::gather<UInt32>(m_faces, face * 3 + k1)),
+                    p2 = vertex_position(dr::gather<UInt32>(m_faces, face * 3 + k2));
+
+            Vector3f n = dr::cross(p1 - p0, p2 - p0);
+            Float length_sqr = dr::squared_norm(n),
+                  face_angle = dr::safe_acos(dr::dot(dr::normalize(p1 - p0),
+                                                     dr::normalize(p2 - p0)));
+
+            Vector3f corner_normals = dr::select(
+                length_sqr > 0.f, n * (dr::rsqrt(length_sqr) * face_angle), 0.f);
+            dr::eval(corner_normals);
+
+            // --------------------- Kernel 2 starts here ---------------------
+
+            // Sum the contributions of the corners adjacent to every vertex
+            UInt32 vertex = dr::arange<UInt32>(m_vertex_count),
+                   k      = dr::gather<UInt32>(m_vertex_corner_offsets, vertex),
+                   k_end  = dr::gather<UInt32>(m_vertex_corner_offsets, vertex + 1u);
+
+            normals = dr::zeros<Vector3f>(m_vertex_count);
+            dr::Loop<Mask> loop("Mesh::recompute_vertex_normals()", k, normals);
+            while (loop(k < k_end)) {
+                UInt32 c = dr::gather<UInt32>(m_vertex_corners, k);
+                for (size_t j = 0; j < 3; ++j)
+                    normals[j] += dr::gather<Float>(corner_normals[j], c);
+                k++;
+            }
         }
 
-        // --------------------- Kernel 2 starts here ---------------------
-
         normals = dr::normalize(normals);
 
         // Disconnect the vertex normal buffer from any pre-existing AD
@@ -353,6 +771,132 @@ MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
     }
 }
 
+MI_VARIANT void Mesh<Float, Spectrum>::build_vertex_adjacency() {
+    size_t corner_count = 3 * (size_t) m_face_count;
+    if (dr::width(m_vertex_corner_offsets) == (size_t) m_vertex_count + 1 &&
+        dr::width(m_vertex_corners) == corner_count)
+        return; // already built!
+
+    auto&& faces = dr::migrate(m_faces, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+    const ScalarIndex *idx = faces.data();
+
+    // Counting sort of the face corners by vertex
+    std::unique_ptr<ScalarIndex[]> offsets(new ScalarIndex[m_vertex_count + 1]()),
+                                   corners(new ScalarIndex[corner_count]);
+    for (size_t i = 0; i < corner_count; ++i) {
+        if (unlikely(idx[i] >= m_vertex_count))
+            Throw("\"%s\": face %zu references vertex %u, but the mesh only "
+                  "has %u vertices!", m_name, i / 3, idx[i], m_vertex_count);
+        offsets[idx[i] + 1]++;
+    }
+
+    for (ScalarSize i = 0; i < m_vertex_count; ++i)
+        offsets[i + 1] += offsets[i];
+
+    std::unique_ptr<ScalarIndex[]> cursor(new ScalarIndex[m_vertex_count]);
+    memcpy(cursor.get(), offsets.get(), m_vertex_count * sizeof(ScalarIndex));
+    for (size_t i = 0; i < corner_count; ++i)
+        corners[cursor[idx[i]]++] = (ScalarIndex) i;
+
+    m_vertex_corner_offsets =
+        dr::load<DynamicBuffer<UInt32>>(offsets.get(), m_vertex_count + 1);
+    m_vertex_corners =
+        dr::load<DynamicBuffer<UInt32>>(corners.get(), corner_count);
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_tangents() {
+    if (!has_vertex_texcoords())
+        Throw("recompute_vertex_tangents(): the mesh \"%s\" has no texture "
+              "coordinates!", m_name);
+
+    using InputVector4f = dr::Array<InputFloat, 4>;
+
+    auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
+    auto&& vertex_normals   = dr::migrate(decoded_vertex_normals(), AllocType::Host);
+    auto&& vertex_texcoords = dr::migrate(decoded_vertex_texcoords(), AllocType::Host);
+    auto&& faces            = dr::migrate(m_faces, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    const InputFloat *p_ptr  = vertex_positions.data(),
+                     *uv_ptr = vertex_texcoords.data();
+    const uint32_t *f_ptr = faces.data();
+    bool has_normals = dr::width(vertex_normals) != 0;
+
+    /* Accumulate the UV parameterization derivatives of all adjacent faces,
+       weighted by their area. The weighted average preserves the lengths of
+       dp_du and dp_dv that matter e.g. for bump mapping. Also accumulate face
+       normals, which are used when the mesh has no vertex normals. */
+    std::vector<InputVector3f> dp_du(m_vertex_count, dr::zeros<InputVector3f>()),
+                               dp_dv(m_vertex_count, dr::zeros<InputVector3f>()),
+                               normals(m_vertex_count, dr::zeros<InputVector3f>());
+    std::vector<InputFloat> weights(m_vertex_count, 0.f);
+
+    for (ScalarSize i = 0; i < m_face_count; ++i) {
+        const uint32_t *fi = f_ptr + 3 * i;
+
+        InputPoint3f p0 = dr::load<InputPoint3f>(p_ptr + 3 * fi[0]),
+                     p1 = dr::load<InputPoint3f>(p_ptr + 3 * fi[1]),
+                     p2 = dr::load<InputPoint3f>(p_ptr + 3 * fi[2]);
+        InputVector2f uv0 = dr::load<InputVector2f>(uv_ptr + 2 * fi[0]),
+                      uv1 = dr::load<InputVector2f>(uv_ptr + 2 * fi[1]),
+                      uv2 = dr::load<InputVector2f>(uv_ptr + 2 * fi[2]);
+
+        InputVector3f dp0 = p1 - p0, dp1 = p2 - p0;
+        InputVector2f duv0 = uv1 - uv0, duv1 = uv2 - uv0;
+
+        InputVector3f n = dr::cross(dp0, dp1);
+        InputFloat weight = .5f * dr::norm(n),
+                   det = dr::fmsub(duv0.x(), duv1.y(), duv0.y() * duv1.x());
+
+        for (size_t j = 0; j < 3; ++j)
+            normals[fi[j]] += n;
+
+        if (det == 0.f || weight == 0.f)
+            continue;
+
+        InputFloat scale = weight / det;
+        InputVector3f du = dr::fmsub(duv1.y(), dp0, duv0.y() * dp1) * scale,
+                      dv = dr::fnmadd(duv1.x(), dp0, duv0.x() * dp1) * scale;
+
+        for (size_t j = 0; j < 3; ++j) {
+            dp_du[fi[j]] += du;
+            dp_dv[fi[j]] += dv;
+            weights[fi[j]] += weight;
+        }
+    }
+
+    std::unique_ptr<InputFloat[]> data(new InputFloat[m_vertex_count * 4]);
+    for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+        InputNormal3f n = has_normals
+            ? InputNormal3f(dr::load<InputNormal3f>(vertex_normals.data() + 3 * i))
+            : InputNormal3f(normals[i]);
+        InputFloat length = dr::norm(n);
+        InputVector4f value = dr::zeros<InputVector4f>();
+
+        if (likely(length > 0.f && weights[i] > 0.f)) {
+            n /= length;
+
+            // Gram-Schmidt orthogonalization against the vertex normal
+            InputFloat inv_weight = dr::rcp(weights[i]);
+            InputVector3f t = dr::fnmadd(n, dr::dot(n, dp_du[i]), dp_du[i]) * inv_weight,
+                          b = dr::fnmadd(n, dr::dot(n, dp_dv[i]), dp_dv[i]) * inv_weight;
+
+            if (dr::squared_norm(t) > 0.f) {
+                InputFloat sign = dr::dot(dr::cross(n, t), b) < 0.f ? -1.f : 1.f;
+                value = InputVector4f(t.x(), t.y(), t.z(), sign * dr::norm(b));
+            }
+        }
+
+        dr::store(data.get() + 4 * i, value);
+    }
+
+    m_vertex_tangents =
+        dr::load<FloatStorage>(data.get(), m_vertex_count * 4);
+}
+
 MI_VARIANT void Mesh<Float, Spectrum>::recompute_bbox() {
     auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
     if constexpr (dr::is_jit_v<Float>)
@@ -394,6 +938,9 @@ MI_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
         table[i] = .5f * dr::norm(dr::cross(p1 - p0, p2 - p0));
     }
 
+    if (m_alias_sampling)
+        m_area_alias = AliasDistribution<Float>(table.data(), m_face_count);
+
     m_area_pmf = DiscreteDistribution<Float>(
         table.data(),
         m_face_count
@@ -403,70 +950,229 @@ MI_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
 MI_VARIANT
 ref<Mesh<Float, Spectrum>>
 Mesh<Float, Spectrum>::merge(const Mesh *other) const {
-    if (other->emitter() != m_emitter || other->sensor() != m_sensor ||
-        other->bsdf() != m_bsdf ||
-        other->interior_medium() != m_interior_medium ||
-        other->exterior_medium() != m_exterior_medium ||
-        other->has_vertex_normals() != has_vertex_normals() ||
-        other->has_vertex_texcoords() != has_vertex_texcoords() ||
-        other->has_face_normals() != has_face_normals() ||
-        other->has_mesh_attributes() || has_mesh_attributes())
-        Throw("Mesh::merge(): the two meshes are incompatible (%s and %s)!",
-              to_string(), other->to_string());
+    return merge(std::vector<ref<Mesh>>{ const_cast<Mesh *>(this),
+                                         const_cast<Mesh *>(other) });
+}
+
+MI_VARIANT
+ref<Mesh<Float, Spectrum>>
+Mesh<Float, Spectrum>::merge(const std::vector<ref<Mesh>> &meshes) {
+    if (meshes.empty())
+        Throw("Mesh::merge(): the list of meshes is empty!");
+
+    const Mesh *first = meshes[0].get();
+    if (meshes.size() == 1)
+        return const_cast<Mesh *>(first);
+
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh *other = meshes[i].get();
+        if (other->emitter() != first->m_emitter ||
+            other->sensor() != first->m_sensor ||
+            other->bsdf() != first->m_bsdf ||
+            other->interior_medium() != first->m_interior_medium ||
+            other->exterior_medium() != first->m_exterior_medium ||
+            other->has_vertex_normals() != first->has_vertex_normals() ||
+            other->has_vertex_texcoords() != first->has_vertex_texcoords() ||
+            other->has_face_normals() != first->has_face_normals() ||
+            other->has_mesh_attributes())
+            Throw("Mesh::merge(): the two meshes are incompatible (%s and %s)!",
+                  first->to_string(), other->to_string());
+    }
 
     Properties props;
-    if (m_bsdf)
-        props.set_object("bsdf", (Object *) m_bsdf.get());
-    if (m_interior_medium)
-        props.set_object("interior", (Object *) m_interior_medium.get());
-    if (m_exterior_medium)
-        props.set_object("exterior", (Object *) m_exterior_medium.get());
-    if (m_sensor)
-        props.set_object("sensor", (Object *) m_sensor.get());
-    if (m_emitter)
-        props.set_object("emitter", (Object *) m_emitter.get());
-    props.set_bool("face_normals", m_face_normals);
-
-    ref<Mesh> result = new Mesh(
-        m_name + " + " + other->m_name, m_vertex_count + other->vertex_count(),
-        m_face_count + other->face_count(), props, has_vertex_normals(),
-        has_vertex_texcoords());
+    if (first->m_bsdf)
+        props.set_object("bsdf", (Object *) first->m_bsdf.get());
+    if (first->m_interior_medium)
+        props.set_object("interior", (Object *) first->m_interior_medium.get());
+    if (first->m_exterior_medium)
+        props.set_object("exterior", (Object *) first->m_exterior_medium.get());
+    if (first->m_sensor)
+        props.set_object("sensor", (Object *) first->m_sensor.get());
+    if (first->m_emitter)
+        props.set_object("emitter", (Object *) first->m_emitter.get());
+    props.set_bool("face_normals", first->m_face_normals);
+    props.set_bool("quantize", first->m_quantize);
+    props.set_bool("tangents", first->m_tangents);
+    props.set_bool("alias_sampling", first->m_alias_sampling);
+    switch (first->m_direction_sampling) {
+        case DirectionSampling::SolidAngle:
+            props.set_string("direction_sampling", "solid_angle");
+            break;
+        case DirectionSampling::ProjectedSolidAngle:
+            props.set_string("direction_sampling", "projected_solid_angle");
+            break;
+        default:
+            break;
+    }
 
-    result->m_vertex_positions =
-        dr::concat(m_vertex_positions, other->m_vertex_positions);
+    bool has_normals   = first->has_vertex_normals(),
+         has_texcoords = first->has_vertex_texcoords();
 
-    if (has_vertex_normals())
-        result->m_vertex_normals =
-            dr::concat(m_vertex_normals, other->m_vertex_normals);
+    /* Compute the offsets of all inputs in the merged buffers up front, so
+       that everything is allocated once and can be copied in parallel */
+    std::vector<ScalarSize> vertex_offset(meshes.size() + 1, 0),
+                            face_offset(meshes.size() + 1, 0);
+    ScalarBoundingBox3f bbox;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        vertex_offset[i + 1] = vertex_offset[i] + meshes[i]->m_vertex_count;
+        face_offset[i + 1]   = face_offset[i] + meshes[i]->m_face_count;
+        bbox.expand(meshes[i]->m_bbox);
+    }
 
-    if (has_vertex_texcoords())
+    ScalarSize vertex_count = vertex_offset.back(),
+               face_count   = face_offset.back();
+
+    std::string name = meshes.size() == 2
+        ? first->m_name + " + " + meshes[1]->m_name
+        : tfm::format("%s + %zu others", first->m_name, meshes.size() - 1);
+
+    // Fetch the input buffers (this only copies data in GPU variants)
+    std::vector<FloatStorage> positions(meshes.size()), normals(meshes.size()),
+                              texcoords(meshes.size());
+    std::vector<DynamicBuffer<UInt32>> faces(meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh *mesh = meshes[i].get();
+        positions[i] = dr::migrate(mesh->m_vertex_positions, AllocType::Host);
+        if (has_normals)
+            normals[i] = dr::migrate(mesh->decoded_vertex_normals(), AllocType::Host);
+        if (has_texcoords)
+            texcoords[i] = dr::migrate(mesh->decoded_vertex_texcoords(), AllocType::Host);
+        faces[i] = dr::migrate(mesh->m_faces, AllocType::Host);
+    }
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    std::unique_ptr<InputFloat[]> positions_out(new InputFloat[vertex_count * 3]),
+        normals_out(has_normals ? new InputFloat[vertex_count * 3] : nullptr),
+        texcoords_out(has_texcoords ? new InputFloat[vertex_count * 2] : nullptr);
+    std::unique_ptr<ScalarIndex[]> faces_out(new ScalarIndex[face_count * 3]);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, meshes.size(), 64),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                ScalarSize v_offset = vertex_offset[i],
+                           v_count  = vertex_offset[i + 1] - v_offset,
+                           f_offset = face_offset[i],
+                           f_count  = face_offset[i + 1] - f_offset;
+
+                memcpy(positions_out.get() + v_offset * 3, positions[i].data(),
+                       v_count * 3 * sizeof(InputFloat));
+                if (has_normals)
+                    memcpy(normals_out.get() + v_offset * 3, normals[i].data(),
+                           v_count * 3 * sizeof(InputFloat));
+                if (has_texcoords)
+                    memcpy(texcoords_out.get() + v_offset * 2, texcoords[i].data(),
+                           v_count * 2 * sizeof(InputFloat));
+
+                const ScalarIndex *src = faces[i].data();
+                ScalarIndex *dst = faces_out.get() + f_offset * 3;
+                for (ScalarSize j = 0; j < f_count * 3; ++j)
+                    dst[j] = src[j] + v_offset;
+            }
+        }
+    );
+
+    ref<Mesh> result = new Mesh(props);
+    result->m_name = name;
+    result->m_vertex_count = vertex_count;
+    result->m_face_count = face_count;
+    result->m_vertex_positions =
+        dr::load<FloatStorage>(positions_out.get(), vertex_count * 3);
+    if (has_normals)
+        result->m_vertex_normals =
+            dr::load<FloatStorage>(normals_out.get(), vertex_count * 3);
+    if (has_texcoords)
         result->m_vertex_texcoords =
-            dr::concat(m_vertex_texcoords, other->m_vertex_texcoords);
+            dr::load<FloatStorage>(texcoords_out.get(), vertex_count * 2);
+    result->m_faces =
+        dr::load<DynamicBuffer<UInt32>>(faces_out.get(), face_count * 3);
+    result->m_bbox = bbox;
+    result->initialize();
+
+    return result;
+}
 
-    result->m_faces = dr::concat(m_faces, other->m_faces);
-    result->m_bbox = m_bbox;
-    result->m_bbox.expand(other->m_bbox);
+MI_VARIANT size_t Mesh<Float, Spectrum>::topology_hash() const {
+    auto&& faces            = dr::migrate(m_faces, AllocType::Host);
+    auto&& vertex_texcoords = dr::migrate(decoded_vertex_texcoords(), AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
 
-    if constexpr (dr::is_jit_v<Float>) {
-        UInt32 threshold = dr::opaque<UInt32>(face_count() * 3),
-               offset    = dr::opaque<UInt32>(vertex_count()),
-               index     = dr::arange<UInt32>(result->face_count() * 3);
+    int flags = (has_vertex_normals() ? 1 : 0) + (has_vertex_texcoords() ? 2 : 0) +
+                (m_face_normals ? 4 : 0) + (m_flip_normals ? 8 : 0);
 
-        result->m_faces = dr::select(index < threshold, result->m_faces,
-                                     result->m_faces + offset);
+    size_t value = hash_combine(hash(m_vertex_count), hash(m_face_count));
+    value = hash_combine(value, hash(flags));
+    value = hash_combine(value, hash(faces.data(), m_face_count * 3 * sizeof(ScalarIndex)));
+    if (has_vertex_texcoords())
+        value = hash_combine(value, hash(vertex_texcoords.data(),
+                                         m_vertex_count * 2 * sizeof(InputFloat)));
+    return value;
+}
 
-        dr::eval(result->m_faces, result->m_vertex_positions,
-                 result->m_vertex_normals, result->m_vertex_texcoords);
-    } else {
-        uint32_t  offset = vertex_count(),
-                 *ptr    = result->m_faces.data() + face_count() * 3;
-        for (size_t i = 0; i < other->face_count() * 3; ++i)
-            *ptr++ += offset;
+MI_VARIANT std::optional<typename Mesh<Float, Spectrum>::ScalarTransform4f>
+Mesh<Float, Spectrum>::instance_transform(const Mesh *other) const {
+    if (other->m_vertex_count != m_vertex_count ||
+        other->m_face_count != m_face_count ||
+        other->has_vertex_normals() != has_vertex_normals() ||
+        other->has_vertex_texcoords() != has_vertex_texcoords() ||
+        other->m_face_normals != m_face_normals ||
+        other->m_flip_normals != m_flip_normals)
+        return std::nullopt;
+
+    ScalarTransform4f transform =
+        other->m_to_world.scalar() * m_to_world.scalar().inverse();
+
+    /* A mirroring transformation would flip the geometric normals of the
+       instance relative to the winding order of the faces of 'other' */
+    ScalarVector3f x = transform * ScalarVector3f(1.f, 0.f, 0.f),
+                   y = transform * ScalarVector3f(0.f, 1.f, 0.f),
+                   z = transform * ScalarVector3f(0.f, 0.f, 1.f);
+    if (!(dr::dot(dr::cross(x, y), z) > 0.f))
+        return std::nullopt;
+
+    auto&& faces             = dr::migrate(m_faces, AllocType::Host);
+    auto&& other_faces       = dr::migrate(other->m_faces, AllocType::Host);
+    auto&& positions         = dr::migrate(m_vertex_positions, AllocType::Host);
+    auto&& other_positions   = dr::migrate(other->m_vertex_positions, AllocType::Host);
+    auto&& normals           = dr::migrate(decoded_vertex_normals(), AllocType::Host);
+    auto&& other_normals     = dr::migrate(other->decoded_vertex_normals(), AllocType::Host);
+    auto&& texcoords         = dr::migrate(decoded_vertex_texcoords(), AllocType::Host);
+    auto&& other_texcoords   = dr::migrate(other->decoded_vertex_texcoords(), AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    if (memcmp(faces.data(), other_faces.data(),
+               m_face_count * 3 * sizeof(ScalarIndex)) != 0)
+        return std::nullopt;
+
+    if (has_vertex_texcoords() &&
+        memcmp(texcoords.data(), other_texcoords.data(),
+               m_vertex_count * 2 * sizeof(InputFloat)) != 0)
+        return std::nullopt;
+
+    // Vertex positions differ by the rounding errors of both transformations
+    ScalarFloat eps = 1e-4f * dr::max(other->m_bbox.extents()) + 1e-6f;
+    for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+        ScalarPoint3f p = transform * ScalarPoint3f(
+            dr::load<InputPoint3f>(positions.data() + i * 3));
+        ScalarPoint3f q(dr::load<InputPoint3f>(other_positions.data() + i * 3));
+        if (!(dr::max(dr::abs(p - q)) <= eps))
+            return std::nullopt;
     }
 
-    result->initialize();
+    if (has_vertex_normals()) {
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            ScalarNormal3f n = dr::normalize(transform * ScalarNormal3f(
+                dr::load<InputNormal3f>(normals.data() + i * 3)));
+            ScalarNormal3f m(dr::load<InputNormal3f>(other_normals.data() + i * 3));
+            if (!(dr::max(dr::abs(n - m)) <= 1e-3f))
+                return std::nullopt;
+        }
+    }
 
-    return result;
+    return transform;
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::build_parameterization() {
@@ -483,7 +1189,7 @@ MI_VARIANT void Mesh<Float, Spectrum>::build_parameterization() {
                  props, false, false);
     mesh->m_faces = m_faces;
 
-    auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+    auto&& vertex_texcoords = dr::migrate(decoded_vertex_texcoords(), AllocType::Host);
     if constexpr (dr::is_jit_v<Float>)
         dr::sync_thread();
 
@@ -522,25 +1228,20 @@ MI_VARIANT Float Mesh<Float, Spectrum>::surface_area() const {
     return m_area_pmf.sum();
 }
 
-MI_VARIANT typename Mesh<Float, Spectrum>::PositionSample3f
-Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask active) const {
-    ensure_pmf_built();
-
-    using Index = dr::replace_scalar_t<Float, ScalarIndex>;
-    Index face_idx;
-    Point2f sample = sample_;
-
-    std::tie(face_idx, sample.y()) =
-        m_area_pmf.sample_reuse(sample.y(), active);
-
-    Vector3u fi = face_indices(face_idx, active);
-
-    Point3f p0 = vertex_position(fi[0], active),
-            p1 = vertex_position(fi[1], active),
-            p2 = vertex_position(fi[2], active);
+MI_VARIANT std::pair<typename Mesh<Float, Spectrum>::UInt32, Float>
+Mesh<Float, Spectrum>::sample_face(Float sample, Mask active) const {
+    if (m_alias_sampling)
+        return m_area_alias.sample_reuse(sample, active);
+    else
+        return m_area_pmf.sample_reuse(sample, active);
+}
 
+MI_VARIANT typename Mesh<Float, Spectrum>::PositionSample3f
+Mesh<Float, Spectrum>::face_position_sample(const Vector3u &fi, const Point3f &p0,
+                                            const Point3f &p1, const Point3f &p2,
+                                            const Point2f &b, Float time,
+                                            Mask active) const {
     Vector3f e0 = p1 - p0, e1 = p2 - p0;
-    Point2f b = warp::square_to_uniform_triangle(sample);
 
     PositionSample3f ps;
     ps.p     = dr::fmadd(e0, b.x(), dr::fmadd(e1, b.y(), p0));
@@ -578,6 +1279,158 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
     return ps;
 }
 
+MI_VARIANT typename Mesh<Float, Spectrum>::PositionSample3f
+Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask active) const {
+    ensure_pmf_built();
+
+    UInt32 face_idx;
+    Point2f sample = sample_;
+    std::tie(face_idx, sample.y()) = sample_face(sample.y(), active);
+
+    Vector3u fi = face_indices(face_idx, active);
+
+    Point3f p0 = vertex_position(fi[0], active),
+            p1 = vertex_position(fi[1], active),
+            p2 = vertex_position(fi[2], active);
+
+    return face_position_sample(fi, p0, p1, p2,
+                                warp::square_to_uniform_triangle(sample),
+                                time, active);
+}
+
+/// Solid angle of a spherical triangle (Van Oosterom and Strackee)
+template <typename Vector3f>
+static auto spherical_triangle_solid_angle(const Vector3f &a, const Vector3f &b,
+                                           const Vector3f &c) {
+    return 2.f * dr::atan2(dr::abs(dr::dot(a, dr::cross(b, c))),
+                           1.f + dr::dot(a, b) + dr::dot(b, c) + dr::dot(c, a));
+}
+
+/* Spherical triangle sampling loses precision when the solid angle subtended
+   by a face is tiny or close to a hemisphere, area sampling is used instead */
+template <typename Float>
+static auto use_solid_angle_sampling(const Float &solid_angle) {
+    return solid_angle >= 3e-4f && solid_angle <= 6.22f;
+}
+
+MI_VARIANT typename Mesh<Float, Spectrum>::DirectionSample3f
+Mesh<Float, Spectrum>::sample_direction(const Interaction3f &it, const Point2f &sample_,
+                                        Mask active) const {
+    if (m_direction_sampling == DirectionSampling::Area)
+        return Base::sample_direction(it, sample_, active);
+
+    MI_MASK_ARGUMENT(active);
+    ensure_pmf_built();
+
+    UInt32 face_idx;
+    Point2f sample = sample_;
+    std::tie(face_idx, sample.y()) = sample_face(sample.y(), active);
+
+    Vector3u fi = face_indices(face_idx, active);
+
+    Point3f p0 = vertex_position(fi[0], active),
+            p1 = vertex_position(fi[1], active),
+            p2 = vertex_position(fi[2], active);
+
+    Vector3f a = dr::normalize(p0 - it.p),
+             b = dr::normalize(p1 - it.p),
+             c = dr::normalize(p2 - it.p);
+
+    Float solid_angle = spherical_triangle_solid_angle(a, b, c);
+    Mask spherical = active && use_solid_angle_sampling(solid_angle);
+
+    // Uniform area sampling (fallback)
+    Point2f bary = warp::square_to_uniform_triangle(sample);
+    Float warp_pdf = 1.f;
+
+    if (dr::any_or<true>(spherical)) {
+        Point2f sample_st = sample;
+
+        /* Warp the sample by a bilinear approximation of the cosine at the
+           reference point, whose corners map to the vertices (b, b, a, c) */
+        if (m_direction_sampling == DirectionSampling::ProjectedSolidAngle) {
+            Mask has_normal = dr::any(dr::neq(it.n, 0.f));
+            Float w_a = dr::maximum(dr::abs_dot(it.n, a), .01f),
+                  w_b = dr::maximum(dr::abs_dot(it.n, b), .01f),
+                  w_c = dr::maximum(dr::abs_dot(it.n, c), .01f);
+
+            Point2f sample_w = warp::square_to_bilinear(w_b, w_b, w_a, w_c, sample).first;
+            Float pdf_w = warp::square_to_bilinear_pdf(w_b, w_b, w_a, w_c, sample_w) /
+                          (.25f * (w_a + 2.f * w_b + w_c));
+
+            dr::masked(sample_st, has_normal) = sample_w;
+            dr::masked(warp_pdf, spherical && has_normal) = pdf_w;
+        }
+
+        Vector3f d = warp::square_to_spherical_triangle(a, b, c, sample_st).first;
+
+        // Find the barycentric coordinates of the sampled direction
+        Ray3f ray(it.p, d, it.time, Wavelength(0));
+        Point2f uv = dr::clamp(std::get<1>(moeller_trumbore(ray, p0, p1, p2)), 0.f, 1.f);
+        Float uv_sum = uv.x() + uv.y();
+        dr::masked(uv, uv_sum > 1.f) = uv / uv_sum;
+
+        dr::masked(bary, spherical) = uv;
+    }
+
+    DirectionSample3f ds(face_position_sample(fi, p0, p1, p2, bary, it.time, active));
+    ds.prim_index = face_idx;
+    ds.d = ds.p - it.p;
+
+    Float dist_squared = dr::squared_norm(ds.d);
+    ds.dist = dr::sqrt(dist_squared);
+    ds.d /= ds.dist;
+
+    Float x = dist_squared / dr::abs_dot(ds.d, ds.n);
+    Float pdf_area = ds.pdf * dr::select(dr::isfinite(x), x, 0.f),
+          pdf_face = m_area_pmf.eval_pmf_normalized(face_idx, active);
+
+    ds.pdf = dr::select(spherical, pdf_face * warp_pdf / solid_angle, pdf_area);
+
+    return ds;
+}
+
+MI_VARIANT Float Mesh<Float, Spectrum>::pdf_direction(const Interaction3f &it,
+                                                      const DirectionSample3f &ds,
+                                                      Mask active) const {
+    if (m_direction_sampling == DirectionSampling::Area)
+        return Base::pdf_direction(it, ds, active);
+
+    MI_MASK_ARGUMENT(active);
+    ensure_pmf_built();
+
+    Vector3u fi = face_indices(ds.prim_index, active);
+
+    Vector3f a = dr::normalize(vertex_position(fi[0], active) - it.p),
+             b = dr::normalize(vertex_position(fi[1], active) - it.p),
+             c = dr::normalize(vertex_position(fi[2], active) - it.p);
+
+    Float solid_angle = spherical_triangle_solid_angle(a, b, c);
+    Mask spherical = active && use_solid_angle_sampling(solid_angle);
+
+    Float warp_pdf = 1.f;
+    if (m_direction_sampling == DirectionSampling::ProjectedSolidAngle &&
+        dr::any_or<true>(spherical)) {
+        Mask has_normal = dr::any(dr::neq(it.n, 0.f));
+        Float w_a = dr::maximum(dr::abs_dot(it.n, a), .01f),
+              w_b = dr::maximum(dr::abs_dot(it.n, b), .01f),
+              w_c = dr::maximum(dr::abs_dot(it.n, c), .01f);
+
+        Point2f sample_w = warp::spherical_triangle_to_square(a, b, c, ds.d).first;
+        Float pdf_w = warp::square_to_bilinear_pdf(w_b, w_b, w_a, w_c, sample_w) /
+                      (.25f * (w_a + 2.f * w_b + w_c));
+
+        dr::masked(warp_pdf, spherical && has_normal) = pdf_w;
+    }
+
+    Float dp = dr::abs_dot(ds.d, ds.n),
+          pdf_area = m_area_pmf.normalization() *
+                     dr::select(dr::neq(dp, 0.f), dr::sqr(ds.dist) / dp, 0.f),
+          pdf_face = m_area_pmf.eval_pmf_normalized(ds.prim_index, active);
+
+    return dr::select(spherical, pdf_face * warp_pdf / solid_angle, pdf_area);
+}
+
 MI_VARIANT
 
 typename Mesh<Float, Spectrum>::SurfaceInteraction3f
@@ -803,6 +1656,26 @@ Mesh<Float, Spectrum>::compute_surface_interaction(const Ray3f &ray,
         si.sh_frame.n = si.n;
     }
 
+    // Interpolate precomputed tangent frames (if available)
+    if (has_vertex_tangents() &&
+        likely(has_flag(ray_flags, RayFlags::dPdUV))) {
+        using Vector4f = dr::Array<Float, 4>;
+        Vector4f t0 = vertex_tangent(fi[0], active),
+                 t1 = vertex_tangent(fi[1], active),
+                 t2 = vertex_tangent(fi[2], active);
+
+        Vector4f t = dr::fmadd(t2, b2, dr::fmadd(t1, b1, t0 * b0));
+        Vector3f dp_du(t.x(), t.y(), t.z());
+        dp_du = dr::fnmadd(si.sh_frame.n, dr::dot(si.sh_frame.n, dp_du), dp_du);
+
+        Float length_sqr = dr::squared_norm(dp_du);
+        Mask valid = length_sqr > 0.f;
+
+        si.dp_du[valid] = dp_du;
+        si.dp_dv[valid] = dr::cross(si.sh_frame.n, dp_du) *
+                          (t.w() * dr::rsqrt(length_sqr));
+    }
+
     if (m_flip_normals) {
         si.n = -si.n;
         si.sh_frame.n = -si.sh_frame.n;
@@ -1129,6 +2002,38 @@ MI_VARIANT size_t Mesh<Float, Spectrum>::face_data_bytes() const {
     return face_data_bytes;
 }
 
+MI_VARIANT bool Mesh<Float, Spectrum>::update_cutout() {
+    /* The geometry of instanced meshes is shared, and the map is only
+       refreshed for the shapes of the scene itself */
+    auto *opacity = (m_bsdf && !m_is_instance) ? m_bsdf->opacity_texture() : nullptr;
+    std::vector<bool> cutout;
+    ScalarVector2i resolution(0);
+    if (opacity && has_vertex_texcoords()) {
+        cutout = opacity->zero_mask();
+        resolution = opacity->resolution();
+    }
+
+    bool changed = cutout != m_cutout || (!cutout.empty() &&
+                                          resolution != m_cutout_resolution);
+    m_cutout = std::move(cutout);
+    m_cutout_resolution = resolution;
+
+#if defined(MI_ENABLE_EMBREE)
+    if (!m_cutout.empty()) {
+        m_cutout_faces = m_faces.data();
+        if (m_quantized)
+            m_cutout_texcoords = m_vertex_texcoords_quantized.data();
+        else
+            m_cutout_texcoords = m_vertex_texcoords.data();
+    }
+#endif
+
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    return changed;
+}
+
 #if defined(MI_ENABLE_EMBREE)
 MI_VARIANT RTCGeometry Mesh<Float, Spectrum>::embree_geometry(RTCDevice device) {
     RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
@@ -1139,16 +2044,153 @@ MI_VARIANT RTCGeometry Mesh<Float, Spectrum>::embree_geometry(RTCDevice device)
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
                                m_faces.data(), 0, 3 * sizeof(ScalarIndex),
                                m_face_count);
+    m_faces_changed = false;
+
+    /* Skip the fully transparent regions of the surface (e.g. cutouts of a
+       mask BSDF) during traversal, instead of re-tracing rays from there */
+    update_cutout();
+    if (!m_cutout.empty()) {
+        rtcSetGeometryUserData(geom, (void *) this);
+        rtcSetGeometryIntersectFilterFunction(geom, embree_cutout_filter);
+        rtcSetGeometryOccludedFilterFunction(geom, embree_cutout_filter);
+    }
 
+    rtcSetGeometryBuildQuality(geom, this->embree_build_quality());
     rtcCommitGeometry(geom);
     return geom;
 }
+
+MI_VARIANT bool Mesh<Float, Spectrum>::embree_update_geometry(RTCGeometry geom) {
+    // The vertex and index buffers may have been reallocated by the last update
+    rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3,
+                               m_vertex_positions.data(), 0, 3 * sizeof(InputFloat),
+                               m_vertex_count);
+    rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
+                               m_faces.data(), 0, 3 * sizeof(ScalarIndex),
+                               m_face_count);
+    rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+    rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0);
+
+    // A refit keeps the hierarchy of the old faces, rebuild it instead
+    if (m_faces_changed)
+        return false;
+
+    rtcSetGeometryBuildQuality(geom, this->embree_build_quality(true));
+    rtcCommitGeometry(geom);
+    update_cutout();
+    return true;
+}
+
+MI_VARIANT void
+Mesh<Float, Spectrum>::embree_cutout_filter(const RTCFilterFunctionNArguments *args) {
+    const Mesh *mesh = (const Mesh *) args->geometryUserPtr;
+    if (mesh->m_cutout.empty())
+        return;
+
+    auto texcoord = [mesh](ScalarIndex index) {
+        if (mesh->m_quantized) {
+            uint32_t value = ((const uint32_t *) mesh->m_cutout_texcoords)[index];
+            return InputVector2f(decode_half(value & 0xffffu),
+                                 decode_half(value >> 16));
+        }
+        const InputFloat *ptr = (const InputFloat *) mesh->m_cutout_texcoords;
+        return InputVector2f(ptr[2 * index], ptr[2 * index + 1]);
+    };
+
+    ScalarVector2i res = mesh->m_cutout_resolution;
+    for (uint32_t i = 0; i < args->N; ++i) {
+        if (args->valid[i] == 0)
+            continue;
+
+        const ScalarIndex *face =
+            mesh->m_cutout_faces + 3 * RTCHitN_primID(args->hit, args->N, i);
+        InputFloat b1 = RTCHitN_u(args->hit, args->N, i),
+                   b2 = RTCHitN_v(args->hit, args->N, i),
+                   b0 = 1.f - b1 - b2;
+        InputVector2f uv = texcoord(face[0]) * b0 + texcoord(face[1]) * b1 +
+                           texcoord(face[2]) * b2;
+
+        // The map only covers the UV square, whatever the wrap mode
+        if (!(uv.x() >= 0.f && uv.x() < 1.f && uv.y() >= 0.f && uv.y() < 1.f))
+            continue;
+
+        int x = std::min((int) (uv.x() * res.x()), res.x() - 1),
+            y = std::min((int) (uv.y() * res.y()), res.y() - 1);
+        if (mesh->m_cutout[y * res.x() + x])
+            args->valid[i] = 0;
+    }
+}
 #endif
 
 #if defined(MI_ENABLE_CUDA)
 static const uint32_t triangle_input_flags = OPTIX_GEOMETRY_FLAG_DISABLE_ANYHIT;
 
-MI_VARIANT void Mesh<Float, Spectrum>::optix_prepare_geometry() { }
+MI_VARIANT void Mesh<Float, Spectrum>::optix_prepare_geometry() {
+    update_cutout();
+}
+
+MI_VARIANT const DynamicBuffer<typename Mesh<Float, Spectrum>::UInt32> &
+Mesh<Float, Spectrum>::optix_faces() const {
+    if (m_cutout.empty()) {
+        m_optix_faces = DynamicBuffer<UInt32>();
+        return m_faces;
+    }
+
+    /* Replace the triangles whose texture coordinates lie entirely inside of
+       fully transparent cells by degenerate ones, which OptiX never reports
+       as hits. The primitive indices of the other triangles are unchanged. */
+    auto &&faces = dr::migrate(m_faces, AllocType::Host);
+    FloatStorage texcoords;
+    DynamicBuffer<UInt32> texcoords_quantized;
+    if (m_quantized)
+        texcoords_quantized = dr::migrate(m_vertex_texcoords_quantized, AllocType::Host);
+    else
+        texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    auto texcoord = [&](ScalarIndex index) {
+        if (m_quantized) {
+            uint32_t value = texcoords_quantized.data()[index];
+            return InputVector2f(decode_half(value & 0xffffu),
+                                 decode_half(value >> 16));
+        }
+        return InputVector2f(texcoords.data()[2 * index],
+                             texcoords.data()[2 * index + 1]);
+    };
+
+    ScalarVector2i res = m_cutout_resolution;
+    std::unique_ptr<ScalarIndex[]> result(new ScalarIndex[m_face_count * 3]);
+    size_t transparent_count = 0;
+    for (ScalarSize i = 0; i < m_face_count; ++i) {
+        const ScalarIndex *face = faces.data() + 3 * i;
+        InputVector2f uv0 = texcoord(face[0]),
+                      uv1 = texcoord(face[1]),
+                      uv2 = texcoord(face[2]),
+                      lo  = dr::minimum(dr::minimum(uv0, uv1), uv2),
+                      hi  = dr::maximum(dr::maximum(uv0, uv1), uv2);
+
+        // The map only covers the UV square, whatever the wrap mode
+        bool transparent = dr::all(lo >= 0.f) && dr::all(hi < 1.f);
+        if (transparent) {
+            ScalarVector2i c0 = dr::minimum(ScalarVector2i(lo * InputVector2f(res)), res - 1),
+                           c1 = dr::minimum(ScalarVector2i(hi * InputVector2f(res)), res - 1);
+            for (int y = c0.y(); transparent && y <= c1.y(); ++y)
+                for (int x = c0.x(); transparent && x <= c1.x(); ++x)
+                    transparent = m_cutout[y * res.x() + x];
+        }
+
+        for (size_t k = 0; k < 3; ++k)
+            result[3 * i + k] = transparent ? face[0] : face[k];
+        transparent_count += transparent;
+    }
+
+    Log(Debug, "\"%s\": %zu of %u triangles are fully transparent.", m_name,
+        transparent_count, m_face_count);
+
+    m_optix_faces = dr::load<DynamicBuffer<UInt32>>(result.get(), m_face_count * 3);
+    return m_optix_faces;
+}
 
 MI_VARIANT void Mesh<Float, Spectrum>::optix_build_input(OptixBuildInput &build_input) const {
     m_vertex_buffer_ptr = (void*) m_vertex_positions.data(); // triggers dr::eval()
@@ -1158,7 +2200,7 @@ MI_VARIANT void Mesh<Float, Spectrum>::optix_build_input(OptixBuildInput &build_
     build_input.triangleArray.numVertices      = m_vertex_count;
     build_input.triangleArray.vertexBuffers    = (CUdeviceptr*) &m_vertex_buffer_ptr;
     build_input.triangleArray.numIndexTriplets = m_face_count;
-    build_input.triangleArray.indexBuffer      = (CUdeviceptr) m_faces.data();
+    build_input.triangleArray.indexBuffer      = (CUdeviceptr) optix_faces().data();
     build_input.triangleArray.flags            = &triangle_input_flags;
     build_input.triangleArray.numSbtRecords    = 1;
 }
@@ -0,0 +1,278 @@
+#include <mitsuba/render/oidndenoiser.h>
+#include <mitsuba/core/thread.h>
+#include <OpenImageDenoise/oidn.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+static void oidn_check(void *device) {
+    const char *message = nullptr;
+    if (oidnGetDeviceError((OIDNDevice) device, &message) != OIDN_ERROR_NONE)
+        Throw("OIDNDenoiser: %s", message ? message : "unknown error");
+}
+
+MI_VARIANT OIDNDenoiser<Float, Spectrum>::OIDNDenoiser(
+    const ScalarVector2u &input_size, bool albedo, bool normals)
+    : m_input_size(input_size), m_albedo(albedo), m_normals(normals),
+      m_device(nullptr), m_filter(nullptr) {
+    if constexpr (dr::is_cuda_v<Float>)
+        Throw("OIDNDenoiser is only available in scalar and LLVM modes, use "
+              "the OptixDenoiser in CUDA mode!");
+
+    if (normals && !albedo)
+        Throw("The denoiser cannot use normals to guide its process without "
+              "also providing albedo information!");
+
+    OIDNDevice device = oidnNewDevice(OIDN_DEVICE_TYPE_CPU);
+    m_device = device;
+    oidnSetDevice1i(device, "numThreads", (int) Thread::thread_count());
+    oidnCommitDevice(device);
+    oidn_check(device);
+
+    OIDNFilter filter = oidnNewFilter(device, "RT");
+    m_filter = filter;
+    oidnSetFilter1b(filter, "hdr", true);
+    oidn_check(device);
+}
+
+MI_VARIANT OIDNDenoiser<Float, Spectrum>::~OIDNDenoiser() {
+    if (m_filter)
+        oidnReleaseFilter((OIDNFilter) m_filter);
+    if (m_device)
+        oidnReleaseDevice((OIDNDevice) m_device);
+}
+
+MI_VARIANT
+void OIDNDenoiser<Float, Spectrum>::denoise(const Image &noisy,
+                                            const Image &albedo,
+                                            const Image &normals,
+                                            const Transform4f &to_sensor,
+                                            float *output) const {
+    size_t width = m_input_size.x(), height = m_input_size.y(),
+           pixel_count = width * height;
+    OIDNFilter filter = (OIDNFilter) m_filter;
+
+    // Share an image with OIDN (only the first 3 channels of every pixel are used)
+    auto set_image = [&](const char *name, const float *data, size_t stride) {
+        oidnSetSharedFilterImage(filter, name, const_cast<float *>(data),
+                                 OIDN_FORMAT_FLOAT3, width, height, 0,
+                                 stride * sizeof(float),
+                                 stride * width * sizeof(float));
+    };
+
+    /* OIDN accepts normals in any coordinate frame, so they are only copied
+       when a (non-identity) transform must be applied */
+    std::unique_ptr<float[]> normals_buf;
+    const float *normals_data = normals.data;
+    size_t normals_stride = normals.pixel_stride;
+    if (m_normals) {
+        ScalarMatrix4f m;
+        if constexpr (dr::is_jit_v<Float>) {
+            for (size_t i = 0; i < 4; ++i)
+                for (size_t j = 0; j < 4; ++j)
+                    m.entry(i, j) = dr::slice(to_sensor.matrix.entry(i, j));
+        } else {
+            m = to_sensor.matrix;
+        }
+
+        if (!dr::all_nested(dr::eq(m, dr::identity<ScalarMatrix4f>()))) {
+            ScalarTransform4f trafo(m);
+            normals_buf = std::unique_ptr<float[]>(new float[pixel_count * 3]);
+            for (size_t i = 0; i < pixel_count; ++i) {
+                const float *n = normals.data + i * normals.pixel_stride;
+                ScalarNormal3f value = trafo * ScalarNormal3f(n[0], n[1], n[2]);
+                for (size_t k = 0; k < 3; ++k)
+                    normals_buf[i * 3 + k] = value[k];
+            }
+            normals_data = normals_buf.get();
+            normals_stride = 3;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    set_image("color", noisy.data, noisy.pixel_stride);
+    if (m_albedo)
+        set_image("albedo", albedo.data, albedo.pixel_stride);
+    if (m_normals)
+        set_image("normal", normals_data, normals_stride);
+    set_image("output", output, noisy.channels);
+
+    oidnCommitFilter(filter);
+    oidnExecuteFilter(filter);
+    oidn_check(m_device);
+
+    // OIDN does not denoise alpha, copy it from the noisy input
+    if (noisy.channels == 4) {
+        for (size_t i = 0; i < pixel_count; ++i)
+            output[i * 4 + 3] = noisy.data[i * noisy.pixel_stride + 3];
+    }
+}
+
+MI_VARIANT
+typename OIDNDenoiser<Float, Spectrum>::TensorXf
+OIDNDenoiser<Float, Spectrum>::operator()(const TensorXf &noisy,
+                                          const TensorXf &albedo,
+                                          const TensorXf &normals,
+                                          const Transform4f &to_sensor) const {
+    using TensorArray = typename TensorXf::Array;
+
+    validate_input(noisy, albedo, normals);
+
+    TensorArray output_data = dr::empty<TensorArray>(noisy.size());
+
+    if constexpr (dr::is_jit_v<Float>) {
+        // All tensors must be evaluated and ready before OIDN reads them
+        dr::schedule(noisy, output_data);
+        if (m_albedo)
+            dr::schedule(albedo);
+        if (m_normals)
+            dr::schedule(normals);
+        dr::eval();
+        dr::sync_thread();
+    }
+
+    auto image = [](const TensorXf &tensor) {
+        Image result;
+        if (tensor.ndim() == 3) {
+            result.data = (const float *) tensor.array().data();
+            result.channels = (uint32_t) tensor.shape(2);
+            result.pixel_stride = tensor.shape(2);
+        }
+        return result;
+    };
+
+    denoise(image(noisy), image(albedo), image(normals), to_sensor,
+            (float *) output_data.data());
+
+    size_t shape[3] = { noisy.shape(0), noisy.shape(1), noisy.shape(2) };
+    return TensorXf(std::move(output_data), 3, shape);
+}
+
+MI_VARIANT
+ref<Bitmap> OIDNDenoiser<Float, Spectrum>::operator()(
+    const ref<Bitmap> &noisy, const std::string &albedo_ch,
+    const std::string &normals_ch, const Transform4f &to_sensor,
+    const std::string &noisy_ch) const {
+    if (noisy->size() != m_input_size)
+        Throw("The denoiser was created for inputs of size %u x %u (width x "
+              "height), but the bitmap has size %u x %u!", m_input_size.x(),
+              m_input_size.y(), noisy->width(), noisy->height());
+
+    // Layers are referenced in place, which requires single precision
+    ref<Bitmap> converted;
+    const Bitmap *source = noisy.get();
+    if (noisy->component_format() != Struct::Type::Float32) {
+        converted = noisy->convert(noisy->pixel_format(), Struct::Type::Float32,
+                                   false);
+        source = converted.get();
+    }
+
+    const Struct *struct_ = source->struct_();
+    auto field_index = [&](const std::string &name) -> int {
+        for (size_t i = 0; i < struct_->field_count(); ++i)
+            if ((*struct_)[i].name == name)
+                return (int) i;
+        return -1;
+    };
+
+    /* Locate the 3 (or 4 with alpha) consecutive channels of a layer that
+       are named <layer>.R/G/B(/A) or <layer>.X/Y/Z(/A) */
+    bool xyz = false;
+    auto find_layer = [&](const std::string &layer, bool with_alpha) {
+        std::string prefix = layer == "<root>" ? "" : layer + ".";
+        for (const char *suffixes : { "RGB", "XYZ" }) {
+            int index = field_index(prefix + suffixes[0]);
+            if (index < 0 || field_index(prefix + suffixes[1]) != index + 1 ||
+                field_index(prefix + suffixes[2]) != index + 2)
+                continue;
+
+            Image result;
+            result.data = (const float *) source->data() + index;
+            result.pixel_stride = source->channel_count();
+            result.channels = 3;
+            if (with_alpha && field_index(prefix + "A") == index + 3)
+                result.channels = 4;
+            if (with_alpha)
+                xyz = suffixes[0] == 'X';
+            return result;
+        }
+        Throw("Could not find layer with channel name '%s' in Bitmap:\n%s",
+              layer, noisy->to_string());
+    };
+
+    if (m_albedo && albedo_ch.empty())
+        Throw("The denoiser was created with albedo guiding enabled. An albedo "
+              "layer must be specified!");
+    if (m_normals && normals_ch.empty())
+        Throw("The denoiser was created with normals guiding enabled. A normal "
+              "layer must be specified!");
+
+    Image noisy_img = find_layer(noisy_ch, true), albedo_img, normals_img;
+    if (m_albedo)
+        albedo_img = find_layer(albedo_ch, false);
+    if (m_normals)
+        normals_img = find_layer(normals_ch, false);
+
+    using PixelFormat = Bitmap::PixelFormat;
+    PixelFormat pixel_format =
+        noisy_img.channels == 4 ? (xyz ? PixelFormat::XYZA : PixelFormat::RGBA)
+                                : (xyz ? PixelFormat::XYZ : PixelFormat::RGB);
+
+    // The denoiser writes its result directly into the output bitmap
+    ref<Bitmap> output = new Bitmap(pixel_format, Struct::Type::Float32,
+                                    noisy->size());
+    denoise(noisy_img, albedo_img, normals_img, to_sensor,
+            (float *) output->data());
+
+    return output;
+}
+
+MI_VARIANT
+std::string OIDNDenoiser<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "OIDNDenoiser[" << std::endl
+        << "  input_size = " << m_input_size << "," << std::endl
+        << "  albedo = " << m_albedo << "," << std::endl
+        << "  normals = " << m_normals << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_VARIANT
+void OIDNDenoiser<Float, Spectrum>::validate_input(
+    const TensorXf &noisy, const TensorXf &albedo,
+    const TensorXf &normals) const {
+    if ((albedo.ndim() == 0) && m_albedo)
+        Throw("The denoiser was created with albedo guiding enabled. An albedo "
+              "layer must be specified!");
+    if ((normals.ndim() == 0) && m_normals)
+        Throw("The denoiser was created with normals guiding enabled. A normal "
+              "layer must be specified!");
+
+    auto check_resolution = [](const TensorXf &tensor,
+                               const ScalarVector2u &expected_size) {
+        if (tensor.ndim() != 0 &&
+            (tensor.ndim() != 3 || expected_size.x() != tensor.shape(1) ||
+             expected_size.y() != tensor.shape(0)))
+            Throw(
+                "The denoiser was created for inputs of size %u x %u (width x "
+                "height). At least one of the input arguments does not have "
+                "this size. You must create a new denoiser object for inputs "
+                "of different sizes!",
+                expected_size.x(), expected_size.y());
+    };
+    check_resolution(noisy, m_input_size);
+    check_resolution(albedo, m_input_size);
+    check_resolution(normals, m_input_size);
+
+    if (noisy.ndim() != 3 || (noisy.shape(2) != 3 && noisy.shape(2) != 4))
+        Throw("The noisy input must have at least 3 channels and at most 4!");
+    if (m_albedo && (albedo.shape(2) != 3))
+        Throw("The albedo must have exactly 3 channels!");
+    if (m_normals && (normals.shape(2) != 3))
+        Throw("The normals must have exactly 3 channels!");
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(OIDNDenoiser, Object, "denoiser")
+MI_INSTANTIATE_CLASS(OIDNDenoiser)
+
+NAMESPACE_END(mitsuba)
@@ -1,5 +1,6 @@
 #if defined(MI_ENABLE_CUDA)
 
+#include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
 
 #include <drjit-core/optix.h>
@@ -20,6 +21,7 @@ void optix_initialize() {
     L(optixAccelComputeMemoryUsage);
     L(optixAccelBuild);
     L(optixAccelCompact);
+    L(optixConvertPointerToTraversableHandle);
     L(optixBuiltinISModuleGet);
     L(optixDenoiserCreate);
     L(optixDenoiserDestroy);
@@ -32,6 +34,35 @@ void optix_initialize() {
     L(optixTaskExecute);
     L(optixProgramGroupCreate);
     L(optixSbtRecordPackHeader);
+    L(optixDeviceContextSetCacheEnabled);
+    L(optixDeviceContextSetCacheLocation);
+
+    #undef L
+
+    /* Keep the OptiX modules compiled from Mitsuba's PTX code in OptiX's disk
+       cache, next to the Dr.Jit kernels when a custom cache is used. Every
+       process can then skip the module compilation of previous runs. */
+    OptixDeviceContext context = jit_optix_context();
+    const fs::path &cache_dir = Jit::cache_dir();
+    if (!cache_dir.empty()) {
+        fs::path location = cache_dir / ".optix";
+        if (!fs::exists(location))
+            fs::create_directory(location);
+        jit_optix_check(optixDeviceContextSetCacheLocation(
+            context, location.string().c_str()));
+    }
+    jit_optix_check(optixDeviceContextSetCacheEnabled(context, 1));
+
+    #define L(name) name = (decltype(name)) jit_cuda_lookup(#name);
+
+    L(cuStreamCreate);
+    L(cuStreamDestroy_v2);
+    L(cuStreamSynchronize);
+    L(cuStreamWaitEvent);
+    L(cuEventCreate);
+    L(cuEventDestroy_v2);
+    L(cuEventRecord);
+    L(cuEventQuery);
 
     #undef L
 }
@@ -4,6 +4,14 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+#define cuda_check(call) cuda_check_impl(call, #call)
+
+static void cuda_check_impl(CUresult result, const char *call) {
+    if (result != 0)
+        Throw("OptixDenoiser: CUDA call \"%s\" failed (error %i)!", call,
+              result);
+}
+
 MI_VARIANT
 static OptixImage2D optixImage2DfromTensor(
     const typename OptixDenoiser<Float, Spectrum>::TensorXf &tensor,
@@ -42,28 +50,106 @@ MI_VARIANT OptixDenoiser<Float, Spectrum>::OptixDenoiser(
     jit_optix_check(optixDenoiserComputeMemoryResources(
         m_denoiser, input_size.x(), input_size.y(), &sizes));
 
-    CUstream stream = jit_cuda_stream();
+    /* The denoiser runs on its own stream so that it can overlap with
+       rendering. State and scratch memory are set up once on that stream
+       and reused by every frame (which the stream orders sequentially). */
+    cuda_check(cuStreamCreate(&m_stream, CU_STREAM_NON_BLOCKING));
+    cuda_check(cuEventCreate(&m_inputs_ready, CU_EVENT_DISABLE_TIMING));
+
     m_state_size = (uint32_t) sizes.stateSizeInBytes;
     m_state = jit_malloc(AllocType::Device, m_state_size);
     m_scratch_size = (uint32_t) sizes.withoutOverlapScratchSizeInBytes;
     m_scratch = jit_malloc(AllocType::Device, m_scratch_size);
-    jit_optix_check(optixDenoiserSetup(m_denoiser, stream, input_size.x(),
+    m_hdr_intensity = jit_malloc(AllocType::Device, sizeof(float));
+
+    // The allocations above are ordered on the Dr.Jit stream
+    cuda_check(cuEventRecord(m_inputs_ready, jit_cuda_stream()));
+    cuda_check(cuStreamWaitEvent(m_stream, m_inputs_ready, 0));
+    jit_optix_check(optixDenoiserSetup(m_denoiser, m_stream, input_size.x(),
                                        input_size.y(), m_state, m_state_size,
                                        m_scratch, m_scratch_size));
-    m_hdr_intensity = jit_malloc(AllocType::Device, sizeof(float));
 }
 
 MI_VARIANT OptixDenoiser<Float, Spectrum>::~OptixDenoiser() {
+    scoped_optix_context guard;
+
+    // Wait for frames that are still in flight before releasing memory
+    cuStreamSynchronize(m_stream);
+    for (Frame &frame : m_pending)
+        cuEventDestroy_v2(frame.done);
+    m_pending.clear();
+
     if (m_denoiser != nullptr)
         jit_optix_check(optixDenoiserDestroy(m_denoiser));
     jit_free(m_hdr_intensity);
     jit_free(m_state);
     jit_free(m_scratch);
+    cuEventDestroy_v2(m_inputs_ready);
+    cuStreamDestroy_v2(m_stream);
 }
 
 MI_VARIANT
 typename OptixDenoiser<Float, Spectrum>::TensorXf
 OptixDenoiser<Float, Spectrum>::operator()(
+    const TensorXf &noisy, bool denoise_alpha, const TensorXf &albedo,
+    const TensorXf &normals, const Transform4f &to_sensor, const TensorXf &flow,
+    const TensorXf &previous_denoised) const {
+    Frame frame = launch(noisy, denoise_alpha, albedo, normals, to_sensor,
+                         flow, previous_denoised);
+    return finish(frame);
+}
+
+MI_VARIANT
+void OptixDenoiser<Float, Spectrum>::submit(
+    const TensorXf &noisy, bool denoise_alpha, const TensorXf &albedo,
+    const TensorXf &normals, const Transform4f &to_sensor, const TensorXf &flow,
+    const TensorXf &previous_denoised) {
+    using TensorArray = typename TensorXf::Array;
+
+    TensorXf flow_(flow), previous(previous_denoised);
+    if (m_temporal && noisy.ndim() == 3) {
+        if (flow_.ndim() == 0) {
+            size_t shape[3] = { noisy.shape(0), noisy.shape(1), 2 };
+            flow_ = TensorXf(dr::zeros<TensorArray>(shape[0] * shape[1] * 2),
+                             3, shape);
+        }
+        if (previous.ndim() == 0)
+            previous = m_previous.ndim() != 0 ? m_previous : noisy;
+    }
+
+    Frame frame = launch(noisy, denoise_alpha, albedo, normals, to_sensor,
+                         flow_, previous);
+    if (m_temporal)
+        m_previous = frame.output;
+    m_pending.push_back(std::move(frame));
+}
+
+MI_VARIANT
+typename OptixDenoiser<Float, Spectrum>::TensorXf
+OptixDenoiser<Float, Spectrum>::result() {
+    if (m_pending.empty())
+        Throw("OptixDenoiser::result(): no frame is pending!");
+    Frame frame = std::move(m_pending.front());
+    m_pending.pop_front();
+    return finish(frame);
+}
+
+MI_VARIANT
+typename OptixDenoiser<Float, Spectrum>::TensorXf
+OptixDenoiser<Float, Spectrum>::finish(Frame &frame) const {
+    scoped_optix_context guard;
+    cuda_check(cuStreamWaitEvent(jit_cuda_stream(), frame.done, 0));
+    cuda_check(cuEventDestroy_v2(frame.done));
+
+    /* Any later reuse of the inputs' memory by Dr.Jit is now ordered after
+       the denoiser, so they can be released */
+    frame.inputs.clear();
+    return std::move(frame.output);
+}
+
+MI_VARIANT
+typename OptixDenoiser<Float, Spectrum>::Frame
+OptixDenoiser<Float, Spectrum>::launch(
     const TensorXf &noisy, bool denoise_alpha, const TensorXf &albedo,
     const TensorXf &normals, const Transform4f &to_sensor, const TensorXf &flow,
     const TensorXf &previous_denoised) const {
@@ -84,16 +170,11 @@ OptixDenoiser<Float, Spectrum>::operator()(
     TensorArray output_data = dr::empty<TensorArray>(noisy.size());
     layers.output.data = output_data.data();
 
-    CUstream stream = jit_cuda_stream();
-
     OptixDenoiserParams params = {};
     params.blendFactor = 0.0f;
     params.hdrAverageColor = nullptr;
     params.denoiseAlpha = denoise_alpha;
     params.hdrIntensity = m_hdr_intensity;
-    jit_optix_check(optixDenoiserComputeIntensity(
-        m_denoiser, stream, &layers.input, m_hdr_intensity, m_scratch,
-        m_scratch_size));
 
     dr::schedule(noisy);
 
@@ -142,12 +223,25 @@ OptixDenoiser<Float, Spectrum>::operator()(
             previous_denoised, input_pixel_format);
     }
 
-    jit_optix_check(optixDenoiserInvoke(m_denoiser, stream, &params, m_state,
+    // Let the denoiser stream wait for the inputs computed by Dr.Jit
+    cuda_check(cuEventRecord(m_inputs_ready, jit_cuda_stream()));
+    cuda_check(cuStreamWaitEvent(m_stream, m_inputs_ready, 0));
+
+    jit_optix_check(optixDenoiserComputeIntensity(
+        m_denoiser, m_stream, &layers.input, m_hdr_intensity, m_scratch,
+        m_scratch_size));
+    jit_optix_check(optixDenoiserInvoke(m_denoiser, m_stream, &params, m_state,
                                         m_state_size, &guide_layer, &layers, 1,
                                         0, 0, m_scratch, m_scratch_size));
 
+    Frame frame;
+    cuda_check(cuEventCreate(&frame.done, CU_EVENT_DISABLE_TIMING));
+    cuda_check(cuEventRecord(frame.done, m_stream));
+
     size_t shape[3] = { noisy.shape(0), noisy.shape(1), noisy.shape(2) };
-    return TensorXf(std::move(output_data), 3, shape);
+    frame.output = TensorXf(std::move(output_data), 3, shape);
+    frame.inputs = { noisy, albedo, new_normals, flow, previous_denoised };
+    return frame;
 }
 
 MI_VARIANT
@@ -270,7 +364,8 @@ std::string OptixDenoiser<Float, Spectrum>::to_string() const {
         << "  input_size = " << m_input_size << "," << std::endl
         << "  albedo = " << m_options.guideAlbedo << "," << std::endl
         << "  normals = " << m_options.guideNormal << "," << std::endl
-        << "  temporal = " << m_temporal << std::endl
+        << "  temporal = " << m_temporal << "," << std::endl
+        << "  pending = " << m_pending.size() << std::endl
         << "]";
     return oss.str();
 }
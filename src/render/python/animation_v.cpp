@@ -0,0 +1,12 @@
+#include <mitsuba/render/animation.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(Animation) {
+    MI_PY_IMPORT_TYPES(Animation)
+    MI_PY_CLASS(Animation, Object)
+        .def(py::init<Object *, const fs::path &>(), "root"_a, "filename"_a,
+             D(Animation, Animation))
+        .def_method(Animation, frame_range)
+        .def_method(Animation, set_frame, "frame"_a)
+        .def_method(Animation, parameters);
+}
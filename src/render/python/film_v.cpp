@@ -38,6 +38,14 @@ public:
         PYBIND11_OVERRIDE_PURE(void, Film, write, path);
     }
 
+    void write_snapshot(const fs::path &path) const override {
+        PYBIND11_OVERRIDE(void, Film, write_snapshot, path);
+    }
+
+    void write_async(const fs::path &path) const override {
+        PYBIND11_OVERRIDE(void, Film, write_async, path);
+    }
+
     void schedule_storage() override {
         PYBIND11_OVERRIDE_PURE(void, Film, schedule_storage,);
     }
@@ -84,6 +92,8 @@ MI_PY_EXPORT(Film) {
         .def_method(Film, develop, "raw"_a = false)
         .def_method(Film, bitmap, "raw"_a = false)
         .def_method(Film, write, "path"_a)
+        .def_method(Film, write_snapshot, "path"_a)
+        .def_method(Film, write_async, "path"_a)
         .def_method(Film, sample_border)
         // Make sure to return a copy of those members as they might also be
         // exposed by-references via `mi.traverse`. In which case the return
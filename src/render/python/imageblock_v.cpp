@@ -50,9 +50,17 @@ MI_PY_EXPORT(ImageBlock) {
         .def_method(ImageBlock, set_coalesce)
         .def_method(ImageBlock, compensate)
         .def_method(ImageBlock, set_compensate)
+        .def_method(ImageBlock, sorted)
+        .def_method(ImageBlock, set_sorted, "value"_a)
+        .def_method(ImageBlock, sample_group)
+        .def_method(ImageBlock, set_sample_group, "value"_a)
+        .def_method(ImageBlock, set_variance, "source"_a, "target"_a,
+                    "count"_a, "weight"_a)
+        .def_method(ImageBlock, variance_count)
         .def_method(ImageBlock, width)
         .def_method(ImageBlock, height)
         .def_method(ImageBlock, rfilter)
+        .def_method(ImageBlock, set_rfilter, "rfilter"_a)
         .def_method(ImageBlock, normalize)
         .def_method(ImageBlock, set_normalize)
         .def_method(ImageBlock, warn_invalid)
@@ -156,25 +156,6 @@ public:
     }
 };
 
-/**
- * \brief Abstract integrator that should **exclusively** be used to trampoline
- * Python AD integrators for primal renderings
- */
-template <typename Float, typename Spectrum>
-class CppADIntegrator
-    : public SamplingIntegrator<Float, Spectrum> {
-    protected:
-    MI_IMPORT_BASE(SamplingIntegrator)
-
-    CppADIntegrator(const Properties &props) : Base(props) {}
-    virtual ~CppADIntegrator() {}
-
-    MI_DECLARE_CLASS()
-};
-
-MI_IMPLEMENT_CLASS_VARIANT(CppADIntegrator, SamplingIntegrator)
-MI_INSTANTIATE_CLASS(CppADIntegrator)
-
 MI_VARIANT class PyADIntegrator : public CppADIntegrator<Float, Spectrum> {
 public:
     MI_IMPORT_TYPES(Scene, Sensor, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
@@ -252,7 +233,6 @@ MI_PY_EXPORT(Integrator) {
     MI_PY_IMPORT_TYPES()
     using PySamplingIntegrator = PySamplingIntegrator<Float, Spectrum>;
     using PyAdjointIntegrator = PyAdjointIntegrator<Float, Spectrum>;
-    using CppADIntegrator = CppADIntegrator<Float, Spectrum>;
     using PyADIntegrator = PyADIntegrator<Float, Spectrum>;
 
     MI_PY_CLASS(Integrator, Object)
@@ -298,6 +278,8 @@ MI_PY_EXPORT(Integrator) {
             },
             "scene"_a, "sampler"_a, "ray"_a, "medium"_a = nullptr,
             "active"_a = true, D(SamplingIntegrator, sample))
+        .def_method(SamplingIntegrator, set_state_file, "path"_a,
+                    "resume"_a = true)
         .def_readwrite("hide_emitters", &PySamplingIntegrator::m_hide_emitters);
 
     MI_PY_REGISTER_OBJECT("register_integrator", Integrator)
@@ -305,8 +287,19 @@ MI_PY_EXPORT(Integrator) {
     MI_PY_CLASS(MonteCarloIntegrator, SamplingIntegrator);
 
     py::class_<CppADIntegrator, SamplingIntegrator, ref<CppADIntegrator>,
-               PyADIntegrator>(m, "CppADIntegrator")
-        .def(py::init<const Properties &>());
+               PyADIntegrator>(m, "CppADIntegrator", D(CppADIntegrator))
+        .def(py::init<const Properties &>())
+        .def(
+            "sample_adjoint",
+            [](const CppADIntegrator *integrator, drjit::ADMode mode,
+               const Scene *scene, Sampler *sampler, const Ray3f &ray,
+               const Spectrum &delta_L, const Spectrum &state_in, Mask active) {
+                py::gil_scoped_release release;
+                return integrator->sample_adjoint(mode, scene, sampler, ray,
+                                                  delta_L, state_in, active);
+            },
+            "mode"_a, "scene"_a, "sampler"_a, "ray"_a, "δL"_a, "state_in"_a,
+            "active"_a = true, D(CppADIntegrator, sample_adjoint));
 
     MI_PY_TRAMPOLINE_CLASS(PyAdjointIntegrator, AdjointIntegrator, Integrator)
         .def(py::init<const Properties &>())
@@ -26,6 +26,10 @@ public:
         PYBIND11_OVERRIDE_PURE(Return, Medium, get_scattering_coefficients, mi, active);
     }
 
+    UnpolarizedSpectrum get_albedo(const MediumInteraction3f &mi, Mask active = true) const override {
+        PYBIND11_OVERRIDE(UnpolarizedSpectrum, Medium, get_albedo, mi, active);
+    }
+
     std::string to_string() const override {
         PYBIND11_OVERRIDE_PURE(std::string, Medium, to_string, );
     }
@@ -41,6 +45,9 @@ template <typename Ptr, typename Cls> void bind_medium_generic(Cls &cls) {
     cls.def("phase_function",
             [](Ptr ptr) { return ptr->phase_function(); },
             D(Medium, phase_function))
+       .def("emitter",
+            [](Ptr ptr) { return ptr->emitter(); },
+            D(Medium, emitter))
        .def("use_emitter_sampling",
             [](Ptr ptr) { return ptr->use_emitter_sampling(); },
             D(Medium, use_emitter_sampling))
@@ -65,6 +72,17 @@ template <typename Ptr, typename Cls> void bind_medium_generic(Cls &cls) {
                 return ptr->sample_interaction(ray, sample, channel, active); },
             "ray"_a, "sample"_a, "channel"_a, "active"_a,
             D(Medium, sample_interaction))
+       .def("sample_interaction_residual",
+            [](Ptr ptr, const Ray3f &ray, Float sample, Mask active) {
+                return ptr->sample_interaction_residual(ray, sample, active); },
+            "ray"_a, "sample"_a, "active"_a,
+            D(Medium, sample_interaction_residual))
+       .def("sample_interaction_decomposition",
+            [](Ptr ptr, const Ray3f &ray, const Point2f &sample, UInt32 channel,
+               Mask active) {
+                return ptr->sample_interaction_decomposition(ray, sample, channel, active); },
+            "ray"_a, "sample"_a, "channel"_a, "active"_a,
+            D(Medium, sample_interaction_decomposition))
        .def("eval_tr_and_pdf",
             [](Ptr ptr, const MediumInteraction3f &mi,
                const SurfaceInteraction3f &si, Mask active) {
@@ -75,7 +93,12 @@ template <typename Ptr, typename Cls> void bind_medium_generic(Cls &cls) {
             [](Ptr ptr, const MediumInteraction3f &mi, Mask active = true) {
                 return ptr->get_scattering_coefficients(mi, active); },
             "mi"_a, "active"_a=true,
-            D(Medium, get_scattering_coefficients));
+            D(Medium, get_scattering_coefficients))
+       .def("get_albedo",
+            [](Ptr ptr, const MediumInteraction3f &mi, Mask active = true) {
+                return ptr->get_albedo(mi, active); },
+            "mi"_a, "active"_a=true,
+            D(Medium, get_albedo));
 
     if constexpr (dr::is_array_v<Ptr>)
         bind_drjit_ptr_array(cls);
@@ -88,6 +111,7 @@ MI_PY_EXPORT(Medium) {
     auto medium = MI_PY_TRAMPOLINE_CLASS(PyMedium, Medium, Object)
             .def(py::init<const Properties &>())
             .def_method(Medium, id)
+            .def_method(Medium, is_emitter)
             .def_property("m_sample_emitters",
                 [](PyMedium &medium){ return medium.m_sample_emitters; },
                 [](PyMedium &medium, bool value){
@@ -0,0 +1,44 @@
+#if defined(MI_ENABLE_OIDN)
+
+#include <mitsuba/render/oidndenoiser.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(OIDNDenoiser) {
+    MI_PY_IMPORT_TYPES(OIDNDenoiser)
+    MI_PY_CLASS(OIDNDenoiser, Object)
+        .def(py::init<const ScalarVector2u &, bool, bool>(),
+             "input_size"_a, "albedo"_a = false, "normals"_a = false,
+             D(OIDNDenoiser, OIDNDenoiser))
+        .def(
+            "__call__",
+            [](const OIDNDenoiser &denoiser, const TensorXf &noisy,
+               const TensorXf &albedo, const TensorXf &normals,
+               const py::object &transform) {
+                Transform4f to_sensor;
+                if (!transform.is(py::none()))
+                    to_sensor = transform.cast<Transform4f>();
+
+                py::gil_scoped_release release;
+                return denoiser(noisy, albedo, normals, to_sensor);
+            },
+            "noisy"_a, "albedo"_a = TensorXf(), "normals"_a = TensorXf(),
+            "to_sensor"_a = py::none(), D(OIDNDenoiser, operator_call))
+        .def(
+            "__call__",
+            [](const OIDNDenoiser &denoiser, const ref<Bitmap> &noisy,
+               const std::string &albedo_ch, const std::string &normals_ch,
+               const py::object &transform, const std::string &noisy_ch) {
+                Transform4f to_sensor;
+                if (!transform.is(py::none()))
+                    to_sensor = transform.cast<Transform4f>();
+
+                py::gil_scoped_release release;
+                return denoiser(noisy, albedo_ch, normals_ch, to_sensor,
+                                noisy_ch);
+            },
+            "noisy"_a, "albedo_ch"_a = "", "normals_ch"_a = "",
+            "to_sensor"_a = py::none(), "noisy_ch"_a = "<root>",
+            D(OIDNDenoiser, operator_call, 2));
+}
+
+#endif // defined(MI_ENABLE_OIDN)
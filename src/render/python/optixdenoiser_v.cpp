@@ -45,7 +45,27 @@ MI_PY_EXPORT(OptixDenoiser) {
             "noisy"_a, "denoise_alpha"_a = true, "albedo_ch"_a = "",
             "normals_ch"_a = "", "to_sensor"_a = py::none(), "flow_ch"_a = "",
             "previous_denoised_ch"_a = "", "noisy_ch"_a = "<root>",
-            D(OptixDenoiser, operator_call, 2));
+            D(OptixDenoiser, operator_call, 2))
+        .def(
+            "submit",
+            [](OptixDenoiser &denoiser, const TensorXf &noisy,
+               bool denoise_alpha, const TensorXf &albedo,
+               const TensorXf &normals, const py::object &transform,
+               const TensorXf &flow, const TensorXf &previous_denoised) {
+                Transform4f to_sensor;
+                if (!transform.is(py::none()))
+                    to_sensor = transform.cast<Transform4f>();
+
+                denoiser.submit(noisy, denoise_alpha, albedo, normals,
+                                to_sensor, flow, previous_denoised);
+            },
+            "noisy"_a, "denoise_alpha"_a = true, "albedo"_a = TensorXf(),
+            "normals"_a = TensorXf(), "to_sensor"_a = py::none(),
+            "flow"_a = TensorXf(), "previous_denoised"_a = TensorXf(),
+            D(OptixDenoiser, submit))
+        .def_method(OptixDenoiser, result)
+        .def_method(OptixDenoiser, pending)
+        .def_method(OptixDenoiser, reset);
 }
 
 #endif // defined(MI_ENABLE_CUDA)
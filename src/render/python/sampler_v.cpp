@@ -33,6 +33,10 @@ public:
         PYBIND11_OVERRIDE(void, Sampler, set_sample_count, spp);
     }
 
+    void set_pixel_position(const Point2u &pos) override {
+        PYBIND11_OVERRIDE(void, Sampler, set_pixel_position, pos);
+    }
+
     void schedule_state() override { PYBIND11_OVERRIDE(void, Sampler, schedule_state); }
 
     void loop_put(dr::Loop<Mask> &loop) override {
@@ -56,6 +60,7 @@ MI_PY_EXPORT(Sampler) {
         .def_method(Sampler, wavefront_size)
         .def_method(Sampler, set_samples_per_wavefront, "samples_per_wavefront"_a)
         .def_method(Sampler, set_sample_count, "spp"_a)
+        .def_method(Sampler, set_pixel_position, "pos"_a)
         .def_method(Sampler, advance)
         .def_method(Sampler, schedule_state)
         .def_method(Sampler, loop_put, "loop"_a)
@@ -59,6 +59,28 @@ MI_PY_EXPORT(Scene) {
         .def("ray_test",
              py::overload_cast<const Ray3f &, Mask, Mask>(&Scene::ray_test, py::const_),
              "ray"_a, "coherent"_a, "active"_a = true, D(Scene, ray_test, 2))
+        .def("ray_test_batch",
+             [](const Scene &scene, const std::vector<Ray3f> &rays) {
+                 size_t count = rays.size();
+                 std::unique_ptr<Mask[]> active(new Mask[count]),
+                                         occluded(new Mask[count]);
+                 for (size_t i = 0; i < count; ++i)
+                     active[i] = true;
+                 scene.ray_test_batch(rays.data(), active.get(),
+                                      occluded.get(), count);
+                 return std::vector<Mask>(occluded.get(), occluded.get() + count);
+             }, "rays"_a, D(Scene, ray_test_batch))
+        .def("ray_intersect_preliminary_batch",
+             [](const Scene &scene, const std::vector<Ray3f> &rays) {
+                 size_t count = rays.size();
+                 std::unique_ptr<Mask[]> active(new Mask[count]);
+                 for (size_t i = 0; i < count; ++i)
+                     active[i] = true;
+                 std::vector<PreliminaryIntersection3f> result(count);
+                 scene.ray_intersect_preliminary_batch(
+                     rays.data(), active.get(), result.data(), count);
+                 return result;
+             }, "rays"_a, D(Scene, ray_intersect_preliminary_batch))
 #if !defined(MI_ENABLE_EMBREE)
         .def("ray_intersect_naive",
             &Scene::ray_intersect_naive,
@@ -126,5 +148,34 @@ MI_PY_EXPORT(Scene) {
              },
              D(Scene, integrator))
         .def_method(Scene, shapes_grad_enabled)
+        .def_method(Scene, ray_flags)
+        .def("accel_stats",
+             [](const Scene &scene) {
+                 const AccelStats &stats = scene.accel_stats();
+                 py::dict result;
+                 result["backend"]         = stats.backend;
+                 result["build_time"]      = stats.build_time;
+                 result["memory"]          = stats.memory;
+                 result["node_count"]      = stats.node_count;
+                 result["primitive_count"] = stats.primitive_count;
+                 result["sah_cost"]        = stats.sah_cost;
+                 return result;
+             },
+             D(Scene, accel_stats))
+        .def("accel_traversal_stats",
+             [](const Scene &scene, uint32_t ray_count, uint32_t seed) {
+                 TraversalStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = scene.accel_traversal_stats(ray_count, seed);
+                 }
+                 py::dict result;
+                 result["ray_count"]          = stats.ray_count;
+                 result["nodes_per_ray"]      = stats.nodes_per_ray;
+                 result["primitives_per_ray"] = stats.primitives_per_ray;
+                 result["hit_fraction"]       = stats.hit_fraction;
+                 return result;
+             },
+             "ray_count"_a = 65536, "seed"_a = 0, D(Scene, accel_traversal_stats))
         .def("__repr__", &Scene::to_string);
 }
@@ -15,17 +15,102 @@
 MI_VARIANT class PyMesh : public Mesh<Float, Spectrum> {
 public:
     MI_IMPORT_TYPES(Mesh)
+    using FloatStorage = typename Mesh::FloatStorage;
     PyMesh(const Properties &props) : Mesh(props) { }
     PyMesh(const std::string &name, uint32_t vertex_count, uint32_t face_count,
            const Properties &props = Properties(),
            bool has_vertex_normals = false, bool has_vertex_texcoords = false)
         : Mesh(name, vertex_count, face_count, props, has_vertex_normals,
                has_vertex_texcoords) {}
+    PyMesh(const std::string &name, const FloatStorage &vertex_positions,
+           const DynamicBuffer<UInt32> &faces,
+           const FloatStorage &vertex_normals,
+           const FloatStorage &vertex_texcoords,
+           const Properties &props)
+        : Mesh(name, vertex_positions, faces, vertex_normals, vertex_texcoords,
+               props) {}
     std::string to_string() const override {
         PYBIND11_OVERRIDE(std::string, Mesh, to_string,);
     }
 };
 
+/**
+ * \brief Convert an array-like Python object into a Dr.Jit buffer
+ *
+ * Objects implementing the NumPy (``__array_interface__``) or CUDA
+ * (``__cuda_array_interface__``) array interface, as well as CPU tensors
+ * exporting DLPack capsules, are mapped without a copy when they are
+ * contiguous and store values of the right type on the right device. The
+ * Python object is then kept alive until Dr.Jit releases the mapped
+ * variable. Everything else is copied.
+ */
+template <typename Buffer>
+Buffer adopt_buffer(py::object obj, bool allow_map = true) {
+    using Scalar = dr::scalar_t<Buffer>;
+
+    if (obj.is_none())
+        return Buffer();
+    if (py::isinstance<Buffer>(obj))
+        return py::cast<Buffer>(obj); // References the same JIT variable
+
+    if constexpr (dr::is_jit_v<Buffer>) {
+        constexpr bool is_cuda = dr::is_cuda_v<Buffer>;
+        const char *interface = is_cuda ? "__cuda_array_interface__"
+                                        : "__array_interface__";
+
+        // Zero-copy NumPy view of CPU tensors that only implement DLPack
+        if (!is_cuda && !py::hasattr(obj, interface) && py::hasattr(obj, "__dlpack__")) {
+            try {
+                obj = py::module_::import("numpy").attr("from_dlpack")(obj);
+            } catch (const py::error_already_set &) { }
+        }
+
+        if (allow_map && py::hasattr(obj, interface)) {
+            py::dict desc = obj.attr(interface);
+            std::string typestr = py::cast<std::string>(desc["typestr"]);
+            uintptr_t ptr = py::cast<uintptr_t>(py::tuple(desc["data"])[0]);
+            bool contiguous = !desc.contains("strides") || desc["strides"].is_none();
+
+            size_t size = 1;
+            for (py::handle dim : py::tuple(desc["shape"]))
+                size *= py::cast<size_t>(dim);
+
+            /* Accept little-endian (or byte-order agnostic) values of the
+               right size, and take signed 32 bit integers as indices */
+            char kind = std::is_floating_point_v<Scalar> ? 'f' : 'u';
+            bool type_matches =
+                typestr.size() == 3 && typestr[0] != '>' &&
+                (typestr[1] == kind || (kind == 'u' && typestr[1] == 'i')) &&
+                (size_t) (typestr[2] - '0') == sizeof(Scalar);
+
+            if (type_matches && contiguous && size > 0 &&
+                ptr % sizeof(Scalar) == 0) {
+                Buffer result = dr::map<Buffer>((void *) ptr, size, false);
+
+                // Release the Python object once the mapped variable is freed
+                jit_var_set_callback(
+                    result.index(),
+                    [](uint32_t /* index */, int free, void *payload) {
+                        if (free) {
+                            py::gil_scoped_acquire guard;
+                            Py_DECREF((PyObject *) payload);
+                        }
+                    },
+                    (void *) obj.release().ptr());
+
+                return result;
+            }
+        }
+    }
+
+    DRJIT_MARK_USED(allow_map);
+
+    // Layout or type mismatch: copy (and convert) the flattened values
+    if (py::hasattr(obj, "reshape"))
+        obj = obj.attr("reshape")(-1);
+    return py::cast<Buffer>(py::type::of<Buffer>()(obj));
+}
+
 template <typename Ptr, typename Cls> void bind_shape_generic(Cls &cls) {
     MI_PY_IMPORT_TYPES()
 
@@ -44,6 +129,8 @@ template <typename Ptr, typename Cls> void bind_shape_generic(Cls &cls) {
             D(Shape, exterior_medium))
        .def("bsdf", [](Ptr shape) { return shape->bsdf(); },
             D(Shape, bsdf))
+       .def("bsdf_index", [](Ptr shape) { return shape->bsdf_index(); },
+            D(Shape, bsdf_index))
        .def("sensor", [](Ptr shape) { return shape->sensor(); },
             D(Shape, sensor))
        .def("emitter", [](Ptr shape) { return shape->emitter(); },
@@ -150,6 +237,8 @@ MI_PY_EXPORT(Shape) {
             &Shape::bbox, py::const_), D(Shape, bbox, 3), "index"_a, "clip"_a)
         .def_method(Shape, id)
         .def_method(Shape, is_mesh)
+        .def_method(Shape, has_motion)
+        .def_method(Shape, update_tessellation, "sensors"_a)
         .def_method(Shape, parameters_grad_enabled)
         .def_method(Shape, primitive_count)
         .def_method(Shape, effective_primitive_count);
@@ -166,6 +255,7 @@ MI_PY_EXPORT(Shape) {
 
     using PyMesh = PyMesh<Float, Spectrum>;
     using ScalarSize = typename Mesh::ScalarSize;
+    using FloatStorage = typename Mesh::FloatStorage;
     MI_PY_TRAMPOLINE_CLASS(PyMesh, Mesh, Shape)
         .def(py::init<const Properties&>(), "props"_a)
         .def(py::init<const std::string &, ScalarSize, ScalarSize,
@@ -174,17 +264,42 @@ MI_PY_EXPORT(Shape) {
              py::arg_v("props", Properties(), "Properties()"),
              "has_vertex_normals"_a = false, "has_vertex_texcoords"_a = false,
              D(Mesh, Mesh))
+        .def(py::init([](const std::string &name, py::object vertex_positions,
+                         py::object faces, py::object vertex_normals,
+                         py::object vertex_texcoords, const Properties &props) {
+                 /* Embree reads the vertex buffer using 16 byte loads, which
+                    requires padding that external buffers don't guarantee */
+#if defined(MI_ENABLE_EMBREE)
+                 bool map_positions = dr::is_cuda_v<Float>;
+#else
+                 bool map_positions = true;
+#endif
+                 return new PyMesh(
+                     name,
+                     adopt_buffer<FloatStorage>(vertex_positions, map_positions),
+                     adopt_buffer<DynamicBuffer<UInt32>>(faces),
+                     adopt_buffer<FloatStorage>(vertex_normals),
+                     adopt_buffer<FloatStorage>(vertex_texcoords), props);
+             }),
+             "name"_a, "vertex_positions"_a, "faces"_a,
+             "vertex_normals"_a = py::none(), "vertex_texcoords"_a = py::none(),
+             py::arg_v("props", Properties(), "Properties()"),
+             D(Mesh, Mesh, 2))
         .def_method(Mesh, initialize)
         .def_method(Mesh, vertex_count)
         .def_method(Mesh, face_count)
         .def_method(Mesh, has_vertex_normals)
         .def_method(Mesh, has_vertex_texcoords)
+        .def_method(Mesh, quantized)
+        .def_method(Mesh, quantize_attributes)
         .def("write_ply",
              py::overload_cast<const std::string &>(&Mesh::write_ply, py::const_),
              "filename"_a, D(Mesh, write_ply))
         .def("write_ply",
              py::overload_cast<Stream *>(&Mesh::write_ply, py::const_),
              "stream"_a, D(Mesh, write_ply, 2))
+        .def_static("write_bundle", &Mesh::write_bundle, "filename"_a,
+                    "meshes"_a, D(Mesh, write_bundle))
         .def("add_attribute", &Mesh::add_attribute, "name"_a, "size"_a, "buffer"_a,
              D(Mesh, add_attribute), py::return_value_policy::reference_internal)
         .def("vertex_position", [](const Mesh &m, UInt32 index, Mask active) {
@@ -9,6 +9,17 @@ MI_PY_EXPORT(Spiral) {
             D(Spiral, Spiral))
         .def_method(Spiral, max_block_size)
         .def_method(Spiral, block_count)
+        .def_method(Spiral, passes_left)
         .def_method(Spiral, reset)
-        .def_method(Spiral, next_block);
+        .def_method(Spiral, set_priority_region, "offset"_a, "size"_a)
+        .def_method(Spiral, priority_block_count)
+        .def_method(Spiral, is_priority_block, "block_id"_a, "block_size"_a)
+        .def_method(Spiral, next_block)
+        .def_method(Spiral, set_pass_barrier, "value"_a)
+        .def_method(Spiral, next_pass)
+        .def_method(Spiral, set_adaptive, "worker_count"_a,
+                    "min_block_size"_a = 4, "split_threshold"_a = 2.f)
+        .def_method(Spiral, next_tile)
+        .def_method(Spiral, record_time, "block_id"_a, "block_size"_a,
+                    "time"_a);
 }
@@ -65,6 +65,36 @@ MI_PY_EXPORT(Volume) {
                 return max_values;
             },
             D(Volume, max_per_channel))
+        .def("max_per_cell",
+            [] (const Volume *volume, const ScalarVector3i &cells) {
+                std::vector<ScalarFloat> max_values(dr::prod(cells));
+                volume->max_per_cell(cells, max_values.data());
+                return max_values;
+            },
+            "cells"_a, D(Volume, max_per_cell))
+        .def("min_per_cell",
+            [] (const Volume *volume, const ScalarVector3i &cells) {
+                std::vector<ScalarFloat> min_values(dr::prod(cells));
+                volume->min_per_cell(cells, min_values.data());
+                return min_values;
+            },
+            "cells"_a, D(Volume, min_per_cell))
+        .def("max_per_cell_per_channel",
+            [] (const Volume *volume, const ScalarVector3i &cells) {
+                std::vector<ScalarFloat> max_values(
+                    dr::prod(cells) * std::max<uint32_t>(volume->channel_count(), 1));
+                volume->max_per_cell_per_channel(cells, max_values.data());
+                return max_values;
+            },
+            "cells"_a, D(Volume, max_per_cell_per_channel))
+        .def("min_per_cell_per_channel",
+            [] (const Volume *volume, const ScalarVector3i &cells) {
+                std::vector<ScalarFloat> min_values(
+                    dr::prod(cells) * std::max<uint32_t>(volume->channel_count(), 1));
+                volume->min_per_cell_per_channel(cells, min_values.data());
+                return min_values;
+            },
+            "cells"_a, D(Volume, min_per_cell_per_channel))
         .def_method(Volume, eval, "it"_a, "active"_a = true)
         .def_method(Volume, eval_1, "it"_a, "active"_a = true)
         .def_method(Volume, eval_3, "it"_a, "active"_a = true)
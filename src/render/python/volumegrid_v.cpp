@@ -56,11 +56,18 @@ MI_PY_EXPORT(VolumeGrid) {
             D(VolumeGrid, set_max_per_channel))
         .def_method(VolumeGrid, bytes_per_voxel)
         .def_method(VolumeGrid, buffer_size)
-        .def("write", py::overload_cast<Stream *>(&VolumeGrid::write, py::const_),
-            "stream"_a, D(VolumeGrid, write), py::call_guard<py::gil_scoped_release>())
-        .def("write", py::overload_cast<const fs::path &>(
-                &VolumeGrid::write, py::const_), "path"_a, D(VolumeGrid, write, 2),
-                py::call_guard<py::gil_scoped_release>())
+        .def_method(VolumeGrid, brick_size)
+        .def_method(VolumeGrid, brick_count)
+        .def_method(VolumeGrid, brick_min)
+        .def_method(VolumeGrid, brick_max)
+        .def_method(VolumeGrid, compute_brick_bounds, "brick_size"_a,
+                    py::call_guard<py::gil_scoped_release>())
+        .def("write", py::overload_cast<Stream *, uint32_t>(&VolumeGrid::write, py::const_),
+            "stream"_a, "brick_size"_a = 0, D(VolumeGrid, write),
+            py::call_guard<py::gil_scoped_release>())
+        .def("write", py::overload_cast<const fs::path &, uint32_t>(
+                &VolumeGrid::write, py::const_), "path"_a, "brick_size"_a = 0,
+                D(VolumeGrid, write, 2), py::call_guard<py::gil_scoped_release>())
 
         .def(py::init<const fs::path &>(), "path"_a,
             py::call_guard<py::gil_scoped_release>())
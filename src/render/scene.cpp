@@ -1,15 +1,27 @@
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/stats.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emittercache.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/integrator.h>
+#include <mitsuba/render/lighttree.h>
+#include <mitsuba/render/texture.h>
+#include <nanothread/nanothread.h>
+#include <unordered_set>
 
 #if defined(MI_ENABLE_EMBREE)
 #  include "scene_embree.inl"
 #else
 #  include <mitsuba/render/kdtree.h>
+#  include <mitsuba/render/bvh.h>
 #  include "scene_native.inl"
 #endif
 
@@ -20,6 +32,15 @@
 NAMESPACE_BEGIN(mitsuba)
 
 MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
+    // Volume emitters are added to the list via the media that contain them
+    auto add_medium_emitter = [&](const Medium *medium) {
+        if (!medium || !medium->is_emitter())
+            return;
+        Emitter *emitter = const_cast<Emitter *>(medium->emitter());
+        if (std::find(m_emitters.begin(), m_emitters.end(), emitter) == m_emitters.end())
+            m_emitters.push_back(emitter);
+    };
+
     for (auto &[k, v] : props.objects()) {
         Scene *scene           = dynamic_cast<Scene *>(v.get());
         Shape *shape           = dynamic_cast<Shape *>(v.get());
@@ -36,6 +57,8 @@ MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
                 m_emitters.push_back(shape->emitter());
             if (shape->is_sensor())
                 m_sensors.push_back(shape->sensor());
+            add_medium_emitter(shape->interior_medium());
+            add_medium_emitter(shape->exterior_medium());
             if (shape->is_shapegroup()) {
                 m_shapegroups.push_back((ShapeGroup*)shape);
             } else {
@@ -45,8 +68,10 @@ MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
             if (mesh)
                 mesh->set_scene(this);
         } else if (emitter) {
-            // Surface emitters will be added to the list when attached to a shape
-            if (!has_flag(emitter->flags(), EmitterFlags::Surface))
+            // Surface and volume emitters will be added to the list when
+            // attached to a shape or medium
+            if (!has_flag(emitter->flags(), EmitterFlags::Surface) &&
+                !has_flag(emitter->flags(), EmitterFlags::Medium))
                 m_emitters.push_back(emitter);
 
             if (emitter->is_environment()) {
@@ -64,8 +89,29 @@ MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
     }
 
     // Create sensors' shapes (environment sensors)
-    for (Sensor *sensor: m_sensors)
+    for (Sensor *sensor: m_sensors) {
         sensor->set_scene(this);
+        add_medium_emitter(sensor->medium());
+    }
+
+    // Adaptively tessellated shapes depend on the sensors
+    bool tessellation_changed = false;
+    for (Shape *shape : m_shapes)
+        tessellation_changed |= shape->update_tessellation(m_sensors);
+    if (tessellation_changed) {
+        m_bbox.reset();
+        for (Shape *shape : m_shapes)
+            m_bbox.expand(shape->bbox());
+    }
+
+    if (props.get<bool>("flatten_bsdfs", false))
+        flatten_bsdfs();
+
+    if (props.get<bool>("merge_bsdfs", false))
+        merge_bsdfs();
+
+    if (props.get<bool>("instance_meshes", false))
+        instance_meshes();
 
     if constexpr (dr::is_cuda_v<Float>)
         accel_init_gpu(props);
@@ -84,35 +130,270 @@ MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
     m_emitters_dr = dr::load<DynamicBuffer<EmitterPtr>>(
         m_emitters.data(), m_emitters.size());
 
+    m_use_light_tree = props.get<bool>("light_tree", false);
+    m_use_emitter_cache = props.get<bool>("emitter_cache", false);
+    m_emitter_cache_resolution = props.get<uint32_t>("emitter_cache_resolution", 32);
+    m_emitter_cache_entries = props.get<uint32_t>("emitter_cache_entries", 16384);
+    m_emitter_cache_passes = props.get<uint32_t>("emitter_cache_passes", 4);
+    m_use_alias_sampling = props.get<bool>("alias_sampling", false);
     update_emitter_sampling_distribution();
 
     m_shapes_grad_enabled = false;
+    update_ray_flags();
+
+    auto [host_memory, device_memory] = MemoryTracker::total();
+    Log(Info, "Scene loaded: %s of host memory and %s of device memory are in use.",
+        util::mem_string(host_memory), util::mem_string(device_memory));
+    Log(Debug, "%s", MemoryTracker::to_string());
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::flatten_bsdfs() {
+    // BSDFs may be shared by several shapes, flatten each of them only once
+    std::unordered_map<const BSDF *, ref<BSDF>> flattened;
+    size_t count = 0;
+    for (Shape *shape : m_shapes) {
+        BSDF *bsdf = shape->bsdf();
+        auto it = flattened.find(bsdf);
+        if (it == flattened.end())
+            it = flattened.emplace(bsdf, bsdf->flatten()).first;
+        if (it->second.get() != bsdf) {
+            shape->set_bsdf(it->second.get());
+            count++;
+        }
+    }
+
+    if (count > 0)
+        Log(Info, "Flattened the BSDFs of %zu shapes.", count);
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::merge_bsdfs() {
+    // Group the distinct BSDFs of all shapes by plugin and configuration
+    std::map<std::string, std::vector<ref<BSDF>>> groups;
+    for (Shape *shape : m_shapes) {
+        BSDF *bsdf = shape->bsdf();
+        std::string key = bsdf->merge_key();
+        if (key.empty())
+            continue;
+        auto &group = groups[bsdf->class_()->name() + ":" + key];
+        if (std::find_if(group.begin(), group.end(), [&](const ref<BSDF> &b) {
+                return b.get() == bsdf; }) == group.end())
+            group.push_back(bsdf);
+    }
+
+    std::unordered_map<const BSDF *, std::pair<ref<BSDF>, uint32_t>> merged;
+    size_t instance_count = 0, merged_count = 0;
+    for (auto &[key, group] : groups) {
+        if (group.size() < 2)
+            continue;
+        ref<BSDF> bsdf = group[0]->merge(group);
+        if (!bsdf)
+            continue;
+        for (size_t i = 0; i < group.size(); ++i)
+            merged[group[i].get()] = { bsdf, (uint32_t) i };
+        instance_count += group.size();
+        merged_count++;
+    }
+
+    for (Shape *shape : m_shapes) {
+        auto it = merged.find(shape->bsdf());
+        if (it != merged.end())
+            shape->set_bsdf(it->second.first.get(), it->second.second);
+    }
+
+    if (merged_count > 0)
+        Log(Info, "Merged %zu BSDF instances into %zu BSDFs.", instance_count,
+            merged_count);
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::instance_meshes() {
+    struct Prototype {
+        Mesh *mesh;
+        size_t index;
+        std::vector<std::pair<size_t, ScalarTransform4f>> copies;
+    };
+
+    /* Identical meshes must also agree in their materials and media, the
+       candidates of each group are verified against the prototypes */
+    std::unordered_map<size_t, std::vector<Prototype>> groups;
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        Mesh *mesh = dynamic_cast<Mesh *>(m_shapes[i].get());
+        if (!mesh || mesh->is_emitter() || mesh->is_sensor() ||
+            mesh->has_mesh_attributes())
+            continue;
+
+        size_t key = hash_combine(mesh->topology_hash(), hash(mesh->bsdf()));
+        key = hash_combine(key, hash(mesh->bsdf_index()));
+        key = hash_combine(key, hash(mesh->interior_medium()));
+        key = hash_combine(key, hash(mesh->exterior_medium()));
+
+        std::vector<Prototype> &prototypes = groups[key];
+        bool found = false;
+        for (Prototype &prototype : prototypes) {
+            const Mesh *other = prototype.mesh;
+            if (other->bsdf() != mesh->bsdf() ||
+                other->bsdf_index() != mesh->bsdf_index() ||
+                other->interior_medium() != mesh->interior_medium() ||
+                other->exterior_medium() != mesh->exterior_medium())
+                continue;
+
+            std::optional<ScalarTransform4f> transform =
+                other->instance_transform(mesh);
+            if (transform) {
+                prototype.copies.emplace_back(i, *transform);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            prototypes.push_back(Prototype{ mesh, i, {} });
+    }
+
+    PluginManager *pmgr = PluginManager::instance();
+    std::unordered_map<const Object *, ref<Shape>> replaced;
+    size_t instance_count = 0, group_count = 0;
+
+    auto create_instance = [&](ShapeGroup *group, const std::string &id,
+                               const ScalarTransform4f &transform) {
+        Properties props("instance");
+        props.set_id(id);
+        props.set_object("shapegroup", group);
+        props.set_transform("to_world", transform);
+        return pmgr->create_object<Shape>(props);
+    };
+
+    for (auto &[key, prototypes] : groups) {
+        for (Prototype &prototype : prototypes) {
+            if (prototype.copies.empty())
+                continue;
+
+            Mesh *mesh = prototype.mesh;
+            Properties props("shapegroup");
+            props.set_id(mesh->id() + "_shapegroup");
+            props.set_object("mesh", mesh);
+            ref<ShapeGroup> group = pmgr->create_object<ShapeGroup>(props);
+            m_shapegroups.push_back(group);
+
+            // The prototype stays in place, all copies reference its geometry
+            ref<Shape> instance =
+                create_instance(group, mesh->id(), ScalarTransform4f());
+            replaced[mesh] = instance;
+            m_shapes[prototype.index] = instance;
+
+            for (auto &[index, transform] : prototype.copies) {
+                Shape *copy = m_shapes[index];
+                instance = create_instance(group, copy->id(), transform);
+                replaced[copy] = instance;
+                m_shapes[index] = instance;
+            }
+
+            instance_count += prototype.copies.size() + 1;
+            group_count++;
+        }
+    }
+
+    for (ref<Object> &child : m_children) {
+        auto it = replaced.find(child.get());
+        if (it != replaced.end())
+            child = it->second.get();
+    }
+
+    if (group_count > 0)
+        Log(Info, "Replaced %zu duplicate meshes by instances of %zu shape groups.",
+            instance_count, group_count);
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::update_ray_flags() {
+    /// Collects the objects that are reachable from the shapes of the scene
+    struct ObjectCollector : public TraversalCallback {
+        void put_object(const std::string &, Object *obj, uint32_t) override {
+            if (obj && objects.insert(obj).second)
+                obj->traverse(this);
+        }
+
+        std::unordered_set<Object *> objects;
+
+    protected:
+        void put_parameter_impl(const std::string &, void *, uint32_t,
+                                const std::type_info &) override { }
+    };
+
+    ObjectCollector collector;
+    for (Shape *shape : m_shapes)
+        collector.put_object("", shape, 0);
+    for (ShapeGroup *group : m_shapegroups) {
+        for (const ref<Shape> &shape : group->shapes())
+            collector.put_object("", shape.get(), 0);
+    }
+
+    uint32_t flags = RayFlags::Minimal | RayFlags::ShadingFrame;
+    for (Object *obj : collector.objects) {
+        const Class *class_ = obj->class_();
+
+        /* Plugins implemented in Python don't declare their own class and
+           can't report their requirements, all fields are then computed */
+        if (class_->derives_from(MI_CLASS(BSDF))) {
+            flags |= class_ == MI_CLASS(BSDF) ? +RayFlags::All
+                                              : ((BSDF *) obj)->ray_flags();
+        } else if (class_->derives_from(MI_CLASS(Texture))) {
+            if (class_ == MI_CLASS(Texture) ||
+                ((Texture *) obj)->is_spatially_varying())
+                flags |= RayFlags::UV;
+        }
+    }
+
+    if (flags != m_ray_flags)
+        Log(Debug, "Scene: surface interactions use the ray flags 0x%x.", flags);
+    m_ray_flags = flags;
 }
 
 MI_VARIANT
 void Scene<Float, Spectrum>::update_emitter_sampling_distribution() {
+    m_emitter_weights.resize(m_emitters.size());
+    for (size_t i = 0; i < m_emitters.size(); ++i)
+        m_emitter_weights[i] = m_emitters[i]->sampling_weight();
+
+    build_emitter_distribution();
+
+    // Build a spatial hierarchy for emitter sampling in direct illumination
+    if (m_use_light_tree && m_emitters.size() > 1)
+        m_light_tree = new LightTree(m_emitters);
+    else
+        m_light_tree = nullptr;
+
+    // The contributions learned by the emitter cache are tied to the emitters
+    update_emitter_cache();
+
+    // Clear emitter's dirty flag
+    for (auto &e : m_emitters)
+        e->set_dirty(false);
+}
+
+MI_VARIANT
+void Scene<Float, Spectrum>::build_emitter_distribution() {
     // Check if we need to use non-uniform emitter sampling.
     bool non_uniform_sampling = false;
-    for (auto &e : m_emitters) {
-        if (e->sampling_weight() != ScalarFloat(1.0)) {
+    for (ScalarFloat weight : m_emitter_weights) {
+        if (weight != ScalarFloat(1.0)) {
             non_uniform_sampling = true;
             break;
         }
     }
-    size_t n_emitters = m_emitters.size();
+    size_t n_emitters = m_emitter_weights.size();
+    m_emitter_distr = nullptr;
+    m_emitter_alias = nullptr;
     if (non_uniform_sampling) {
-        std::unique_ptr<ScalarFloat[]> sample_weights(new ScalarFloat[n_emitters]);
-        for (size_t i = 0; i < n_emitters; ++i)
-            sample_weights[i] = m_emitters[i]->sampling_weight();
-        m_emitter_distr = std::make_unique<DiscreteDistribution<Float>>(
-            sample_weights.get(), n_emitters);
+        // Vose alias table: O(1) lookups instead of a binary search
+        if (m_use_alias_sampling)
+            m_emitter_alias = std::make_unique<AliasDistribution<Float>>(
+                m_emitter_weights.data(), n_emitters);
+        else
+            m_emitter_distr = std::make_unique<DiscreteDistribution<Float>>(
+                m_emitter_weights.data(), n_emitters);
     } else {
         // By default use uniform sampling with constant PMF
         m_emitter_pmf = m_emitters.empty() ? 0.f : (1.f / n_emitters);
     }
-    // Clear emitter's dirty flag
-    for (auto &e : m_emitters)
-        e->set_dirty(false);
 }
 
 MI_VARIANT Scene<Float, Spectrum>::~Scene() {
@@ -142,6 +423,7 @@ MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, uint32_t ray_flags, Mask coherent, Mask active) const {
     MI_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
     DRJIT_MARK_USED(coherent);
+    stats_count(StatsCounter::RayIntersect, active);
 
     if constexpr (dr::is_cuda_v<Float>)
         return ray_intersect_gpu(ray, ray_flags, active);
@@ -152,6 +434,7 @@ Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, uint32_t ray_flags, Mask
 MI_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary(const Ray3f &ray, Mask coherent, Mask active) const {
     DRJIT_MARK_USED(coherent);
+    stats_count(StatsCounter::RayIntersect, active);
     if constexpr (dr::is_cuda_v<Float>)
         return ray_intersect_preliminary_gpu(ray, active);
     else
@@ -162,6 +445,7 @@ MI_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask coherent, Mask active) const {
     MI_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
     DRJIT_MARK_USED(coherent);
+    stats_count(StatsCounter::RayTest, active);
 
     if constexpr (dr::is_cuda_v<Float>)
         return ray_test_gpu(ray, active);
@@ -169,6 +453,60 @@ Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask coherent, Mask active) c
         return ray_test_cpu(ray, coherent, active);
 }
 
+/// Number of rays per task when the batched ray tracing functions run in parallel
+static constexpr size_t BatchGrainSize = 1024;
+
+/// Invoke 'func(begin, end)' on the chunks of a batch, in parallel for large ones
+template <typename Func> static void for_each_chunk(size_t count, Func func) {
+    if (count <= BatchGrainSize) {
+        func((size_t) 0, count);
+        return;
+    }
+
+    ThreadEnvironment env;
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, count, BatchGrainSize),
+        [&](const dr::blocked_range<size_t> &range) {
+            ScopedSetThreadEnvironment set_env(env);
+            func(range.begin(), range.end());
+        }
+    );
+}
+
+MI_VARIANT void
+Scene<Float, Spectrum>::ray_test_batch(const Ray3f *rays, const Mask *active,
+                                       Mask *occluded, size_t count) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        ScopedPhase sp(ProfilerPhase::RayTest);
+        for (size_t i = 0; i < count; ++i)
+            stats_count(StatsCounter::RayTest, active[i]);
+        for_each_chunk(count, [&](size_t begin, size_t end) {
+            ray_test_batch_cpu(rays + begin, active + begin, occluded + begin,
+                               end - begin);
+        });
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            occluded[i] = ray_test(rays[i], active[i]);
+    }
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::ray_intersect_preliminary_batch(
+    const Ray3f *rays, const Mask *active, PreliminaryIntersection3f *result,
+    size_t count) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        ScopedPhase sp(ProfilerPhase::RayIntersect);
+        for (size_t i = 0; i < count; ++i)
+            stats_count(StatsCounter::RayIntersect, active[i]);
+        for_each_chunk(count, [&](size_t begin, size_t end) {
+            ray_intersect_preliminary_batch_cpu(rays + begin, active + begin,
+                                                result + begin, end - begin);
+        });
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            result[i] = ray_intersect_preliminary(rays[i], false, active[i]);
+    }
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_naive(const Ray3f &ray, Mask active) const {
     MI_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
@@ -200,6 +538,11 @@ Scene<Float, Spectrum>::sample_emitter(Float index_sample, Mask active) const {
         return {index, dr::rcp(pmf), reused_sample};
     }
 
+    if (m_emitter_alias != nullptr) {
+        auto [index, reused_sample, pmf] = m_emitter_alias->sample_reuse_pmf(index_sample);
+        return {index, dr::rcp(pmf), reused_sample};
+    }
+
     uint32_t emitter_count = (uint32_t) m_emitters.size();
     ScalarFloat emitter_count_f = (ScalarFloat) emitter_count;
     Float index_sample_scaled = index_sample * emitter_count_f;
@@ -211,10 +554,12 @@ Scene<Float, Spectrum>::sample_emitter(Float index_sample, Mask active) const {
 
 MI_VARIANT Float Scene<Float, Spectrum>::pdf_emitter(UInt32 index,
                                                       Mask active) const {
-    if (m_emitter_distr == nullptr)
-        return m_emitter_pmf;
-    else
+    if (m_emitter_distr != nullptr)
         return m_emitter_distr->eval_pmf_normalized(index, active);
+    else if (m_emitter_alias != nullptr)
+        return m_emitter_alias->eval_pmf_normalized(index, active);
+    else
+        return m_emitter_pmf;
 }
 
 MI_VARIANT std::tuple<typename Scene<Float, Spectrum>::Ray3f, Spectrum,
@@ -260,6 +605,7 @@ MI_VARIANT std::pair<typename Scene<Float, Spectrum>::DirectionSample3f, Spectru
 Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const Point2f &sample_,
                                                  bool test_visibility, Mask active) const {
     MI_MASKED_FUNCTION(ProfilerPhase::SampleEmitterDirection, active);
+    stats_count(StatsCounter::EmitterSample, active);
 
     Point2f sample(sample_);
     DirectionSample3f ds;
@@ -272,16 +618,66 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
 
     size_t emitter_count = m_emitters.size();
     if (emitter_count > 1 || (emitter_count == 1 && !vcall_inline)) {
+        /* Once the emitter cache is trained, cells with a learned
+           distribution draw from it with probability 'prob' */
+        const EmitterCache *cache = m_emitter_cache.get();
+        ScalarFloat prob = EmitterCache::learned_prob();
+        UInt32 entry = 0;
+        Mask learned = false, from_cache = false;
+        if (cache) {
+            entry = cache->entry(ref.p, active);
+            if (cache->ready()) {
+                learned = cache->valid(entry, active);
+                from_cache = learned && sample.x() < prob;
+                dr::masked(sample.x(), from_cache) = sample.x() / prob;
+                dr::masked(sample.x(), learned && !from_cache) =
+                    (sample.x() - prob) / (1.f - prob);
+            }
+        }
+
         // Randomly pick an emitter
-        auto [index, emitter_weight, sample_x_re] = sample_emitter(sample.x(), active);
-        sample.x() = sample_x_re;
+        UInt32 index;
+        Float emitter_weight, emitter_pmf;
+        if (m_light_tree) {
+            std::tie(index, emitter_pmf, sample.x()) =
+                m_light_tree->sample_emitter(ref, sample.x(), active && !from_cache);
+            active &= from_cache || emitter_pmf > 0.f;
+            emitter_weight = dr::select(active, dr::rcp(emitter_pmf), 0.f);
+        } else {
+            std::tie(index, emitter_weight, sample.x()) =
+                sample_emitter(sample.x(), active && !from_cache);
+            emitter_pmf = pdf_emitter(index, active);
+        }
+
+        if (cache && cache->ready() && dr::any_or<true>(learned)) {
+            auto [index_c, pmf_c, sample_c] =
+                cache->sample_emitter(entry, sample.x(), from_cache);
+            dr::masked(index, from_cache) = index_c;
+            dr::masked(sample.x(), from_cache) = sample_c;
+
+            // Probability of the mixture of both strategies
+            Float pmf_d;
+            if (m_light_tree)
+                pmf_d = m_light_tree->pdf_emitter(
+                    ref, dr::gather<EmitterPtr>(m_emitters_dr, index, learned),
+                    learned);
+            else
+                pmf_d = pdf_emitter(index, learned);
+
+            dr::masked(emitter_pmf, learned) =
+                prob * cache->pdf_emitter(entry, index, learned) +
+                (1.f - prob) * pmf_d;
+            active &= !learned || emitter_pmf > 0.f;
+            dr::masked(emitter_weight, learned) =
+                dr::select(active, dr::rcp(emitter_pmf), 0.f);
+        }
 
         // Sample a direction towards the emitter
         EmitterPtr emitter = dr::gather<EmitterPtr>(m_emitters_dr, index, active);
         std::tie(ds, spec) = emitter->sample_direction(ref, sample, active);
 
         // Account for the discrete probability of sampling this emitter
-        ds.pdf *= pdf_emitter(index, active);
+        ds.pdf *= emitter_pmf;
         spec *= emitter_weight;
 
         active &= dr::neq(ds.pdf, 0.f);
@@ -289,6 +685,15 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
         // Mark occluded samples as invalid if requested by the user
         if (test_visibility && dr::any_or<true>(active)) {
             Mask occluded = ray_test(ref.spawn_ray_to(ds.p), active);
+
+            // Train the emitter cache with the visible contribution
+            if (cache && cache->training())
+                cache->record(entry, index,
+                              dr::select(occluded, 0.f,
+                                         dr::mean(unpolarized_spectrum(spec)) *
+                                             emitter_pmf),
+                              active);
+
             dr::masked(spec, occluded) = 0.f;
             dr::masked(ds.pdf, occluded) = 0.f;
         }
@@ -318,10 +723,29 @@ Scene<Float, Spectrum>::pdf_emitter_direction(const Interaction3f &ref,
                                               Mask active) const {
     MI_MASK_ARGUMENT(active);
     Float emitter_pmf;
-    if (m_emitter_distr == nullptr)
-        emitter_pmf = m_emitter_pmf;
-    else
+    if (m_light_tree)
+        emitter_pmf = m_light_tree->pdf_emitter(ref, ds.emitter, active);
+    else if (m_emitter_distr != nullptr)
         emitter_pmf = ds.emitter->sampling_weight() * m_emitter_distr->normalization();
+    else if (m_emitter_alias != nullptr)
+        emitter_pmf = ds.emitter->sampling_weight() * m_emitter_alias->normalization();
+    else
+        emitter_pmf = m_emitter_pmf;
+
+    // Mixture with the distribution of the emitter cache (if trained)
+    const EmitterCache *cache = m_emitter_cache.get();
+    if (cache && cache->ready()) {
+        UInt32 entry = cache->entry(ref.p, active);
+        Mask learned = cache->valid(entry, active);
+        if (dr::any_or<true>(learned)) {
+            ScalarFloat prob = EmitterCache::learned_prob();
+            UInt32 index = cache->emitter_index(ds.emitter, learned);
+            dr::masked(emitter_pmf, learned) =
+                prob * cache->pdf_emitter(entry, index, learned) +
+                (1.f - prob) * emitter_pmf;
+        }
+    }
+
     return ds.emitter->pdf_direction(ref, ds, active) * emitter_pmf;
 }
 
@@ -344,11 +768,21 @@ MI_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std
     if (m_environment)
         m_environment->set_scene(this); // TODO use parameters_changed({"scene"})
 
-    bool accel_is_dirty = false;
+    bool accel_is_dirty = false, emissive_shapes_dirty = false;
+
+    /* Ray tracing skips the fully transparent regions of masked meshes, and
+       their opacity textures may have changed. In contrast to Embree, which
+       checks the map during traversal, OptiX must then rebuild the GAS. */
+    for (auto &s : m_shapes) {
+        if (s->is_mesh() && ((Mesh *) s.get())->update_cutout() &&
+            dr::is_cuda_v<Float>)
+            s->mark_dirty();
+    }
+
     for (auto &s : m_shapes) {
         if (s->dirty()) {
             accel_is_dirty = true;
-            break;
+            emissive_shapes_dirty |= s->is_emitter();
         }
     }
 
@@ -366,6 +800,9 @@ MI_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std
             accel_parameters_changed_cpu();
     }
 
+    // Textures and BSDF flags may have changed
+    update_ray_flags();
+
     // Check whether any shape parameters have gradient tracking enabled
     m_shapes_grad_enabled = false;
     for (auto &s : m_shapes) {
@@ -374,14 +811,41 @@ MI_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std
             break;
     }
 
-    // Check if emitters were modified and we potentially need to update
-    // the emitter sampling distribution.
-    for (auto &e : m_emitters) {
-        if (e->dirty()) {
-            update_emitter_sampling_distribution();
-            break;
+    /* Check if emitters were modified and only rebuild the emitter sampling
+       structures that depend on the modified state: the emitter distribution
+       only depends on the sampling weights, while the light tree also
+       depends on the emitters' power and geometry. */
+    bool emitters_dirty = emissive_shapes_dirty,
+         weights_dirty  = false;
+    for (size_t i = 0; i < m_emitters.size(); ++i) {
+        Emitter *e = m_emitters[i];
+        if (!e->dirty())
+            continue;
+        emitters_dirty = true;
+        if (e->sampling_weight() != m_emitter_weights[i]) {
+            m_emitter_weights[i] = e->sampling_weight();
+            weights_dirty = true;
         }
+        e->set_dirty(false);
     }
+
+    if (weights_dirty)
+        build_emitter_distribution();
+
+    if (m_use_light_tree && emitters_dirty && m_emitters.size() > 1)
+        m_light_tree = new LightTree(m_emitters);
+
+    if (emitters_dirty)
+        update_emitter_cache();
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::update_emitter_cache() {
+    if (m_use_emitter_cache && m_emitters.size() > 1)
+        m_emitter_cache = new EmitterCache(
+            m_bbox, m_emitters, m_emitter_cache_resolution,
+            m_emitter_cache_entries, m_emitter_cache_passes);
+    else
+        m_emitter_cache = nullptr;
 }
 
 MI_VARIANT std::string Scene<Float, Spectrum>::to_string() const {
@@ -399,6 +863,42 @@ MI_VARIANT std::string Scene<Float, Spectrum>::to_string() const {
     return oss.str();
 }
 
+MI_VARIANT TraversalStats
+Scene<Float, Spectrum>::accel_traversal_stats(uint32_t ray_count,
+                                              uint32_t seed) const {
+    if constexpr (dr::is_cuda_v<Float>) {
+        DRJIT_MARK_USED(ray_count);
+        DRJIT_MARK_USED(seed);
+        Throw("accel_traversal_stats(): not supported by the OptiX backend!");
+    } else {
+        return accel_traversal_stats_cpu(ray_count, seed);
+    }
+}
+
+std::string AccelStats::to_string() const {
+    std::ostringstream oss;
+    oss << "AccelStats[" << std::endl
+        << "  backend = \"" << backend << "\"," << std::endl
+        << "  build_time = " << util::time_string(build_time) << "," << std::endl
+        << "  memory = " << util::mem_string(memory) << "," << std::endl
+        << "  node_count = " << node_count << "," << std::endl
+        << "  primitive_count = " << primitive_count << "," << std::endl
+        << "  sah_cost = " << sah_cost << std::endl
+        << "]";
+    return oss.str();
+}
+
+std::string TraversalStats::to_string() const {
+    std::ostringstream oss;
+    oss << "TraversalStats[" << std::endl
+        << "  ray_count = " << ray_count << "," << std::endl
+        << "  nodes_per_ray = " << nodes_per_ray << "," << std::endl
+        << "  primitives_per_ray = " << primitives_per_ray << "," << std::endl
+        << "  hit_fraction = " << hit_fraction << std::endl
+        << "]";
+    return oss.str();
+}
+
 MI_VARIANT void Scene<Float, Spectrum>::static_accel_initialization() {
     if constexpr (dr::is_cuda_v<Float>)
         Scene::static_accel_initialization_gpu();
@@ -1,26 +1,39 @@
 #include <embree3/rtcore.h>
+#include <atomic>
 #include <nanothread/nanothread.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
 static_assert(sizeof(RTCIntersectContext) == 24 /* Dr.Jit assumes this */);
 
+/// Maximum number of threads that may join a BVH build (\ref accel_init_cpu)
 static uint32_t embree_threads = 0;
 static RTCDevice embree_device = nullptr;
+/// Memory currently allocated by the Embree device (in bytes)
+static std::atomic<int64_t> embree_memory { 0 };
 
 template <typename Float>
 struct EmbreeState {
     MI_IMPORT_CORE_TYPES()
     RTCScene accel;
     std::vector<int> geometries;
+    /// Primitive count of every shape at the time of the last build
+    std::vector<uint32_t> primitive_counts;
     DynamicBuffer<UInt32> shapes_registry_ids;
     bool is_nested_scene = false;
+    /// Embree memory allocated on behalf of this scene (see \ref embree_memory)
+    int64_t memory = 0;
 };
 
 static void embree_error_callback(void * /*user_ptr */, RTCError code, const char *str) {
     Log(Warn, "Embree device error %i: %s.", (int) code, str);
 }
 
+static bool embree_memory_callback(void * /* user_ptr */, ssize_t bytes, bool /* post */) {
+    embree_memory += (int64_t) bytes;
+    return true;
+}
+
 /// Wraps rtcOccluded16 when Dr.Jit operates on vectors of length 32
 void rtcOccluded32(const int *valid, RTCScene scene,
                    RTCIntersectContext *context, uint32_t *in) {
@@ -83,11 +96,18 @@ void rtcIntersect32(const int *valid, RTCScene scene,
 MI_VARIANT void
 Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
     if (!embree_device) {
-        embree_threads = std::max((uint32_t) 1, pool_size());
-        std::string config_str = tfm::format(
-            "threads=%i,user_threads=%i", embree_threads, embree_threads);
+        /* Embree does not spawn worker threads of its own ('threads=1').
+           Instead, the workers of the nanothread pool join the BVH builds
+           (rtcJoinCommitScene), so that a single pool and thread limit
+           ('-t', Thread::set_thread_count()) is shared by the builds, the
+           parallel scene loading and the rendering. */
+        embree_threads = (uint32_t) std::max(
+            { 1, util::core_count(), (int) pool_size() + 1 });
+        std::string config_str =
+            tfm::format("threads=1,user_threads=%i", embree_threads);
         embree_device = rtcNewDevice(config_str.c_str());
         rtcSetDeviceErrorFunction(embree_device, embree_error_callback, nullptr);
+        rtcSetDeviceMemoryMonitorFunction(embree_device, embree_memory_callback, nullptr);
     }
 
     Timer timer;
@@ -103,15 +123,44 @@ Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
         }
     }
 
+    RTCBuildQuality quality;
+    std::string quality_str = props.string("embree_build_quality", "high");
+    if (quality_str == "low")
+        quality = RTC_BUILD_QUALITY_LOW;
+    else if (quality_str == "medium")
+        quality = RTC_BUILD_QUALITY_MEDIUM;
+    else if (quality_str == "high")
+        quality = RTC_BUILD_QUALITY_HIGH;
+    else
+        Throw("Invalid \"embree_build_quality\" value \"%s\", must be one "
+              "of: \"low\", \"medium\", or \"high\"!", quality_str);
+
+    /* Shapes that are frequently rebuilt benefit from the two-level BVH of
+       dynamic Embree scenes, where each geometry has its own BVH */
+    bool dynamic = false;
+    for (Shape *shape : m_shapes)
+        dynamic |= shape->embree_build_mode() == EmbreeBuildMode::Dynamic;
+
+    int flags = RTC_SCENE_FLAG_NONE;
+    if (props.get<bool>("embree_dynamic", dynamic))
+        flags |= RTC_SCENE_FLAG_DYNAMIC;
+    if (props.get<bool>("embree_compact", false))
+        flags |= RTC_SCENE_FLAG_COMPACT;
+    if (props.get<bool>("embree_robust", false))
+        flags |= RTC_SCENE_FLAG_ROBUST;
+
     s.accel = rtcNewScene(embree_device);
-    rtcSetSceneBuildQuality(s.accel, RTC_BUILD_QUALITY_HIGH);
-    rtcSetSceneFlags(s.accel, RTC_SCENE_FLAG_NONE);
+    rtcSetSceneBuildQuality(s.accel, quality);
+    rtcSetSceneFlags(s.accel, (RTCSceneFlags) flags);
+
+    int64_t memory = embree_memory;
 
     ScopedPhase phase(ProfilerPhase::InitAccel);
     accel_parameters_changed_cpu();
 
-    Log(Info, "Embree ready. (took %s)",
-        util::time_string((float) timer.value()));
+    Log(Info, "Embree ready. (took %s, %s)",
+        util::time_string((float) timer.value()),
+        util::mem_string((size_t) std::max(embree_memory - memory, (int64_t) 0)));
 
     if constexpr (dr::is_llvm_v<Float>) {
         // Get shapes registry ids
@@ -132,33 +181,70 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
         dr::sync_thread();
 
     EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
+    Timer timer;
+    int64_t memory = embree_memory;
+
+    /* When only vertex positions moved since the last build (same shapes,
+       same primitive counts), update the existing geometries in place so
+       that Embree refits their BVHs instead of rebuilding them */
+    bool same_topology = s.geometries.size() == m_shapes.size() &&
+                         s.primitive_counts.size() == m_shapes.size();
+    for (size_t i = 0; same_topology && i < m_shapes.size(); ++i)
+        same_topology = s.primitive_counts[i] == m_shapes[i]->primitive_count();
+
+    bool refit = same_topology;
+    for (size_t i = 0; refit && i < m_shapes.size(); ++i)
+        refit = m_shapes[i]->embree_update_geometry(
+            rtcGetGeometry(s.accel, s.geometries[i]));
+
+    if (!refit) {
+        for (int geo : s.geometries)
+            rtcDetachGeometry(s.accel, geo);
+        s.geometries.clear();
+
+        for (Shape *shape : m_shapes) {
+            RTCGeometry geom = shape->embree_geometry(embree_device);
+            s.geometries.push_back(rtcAttachGeometry(s.accel, geom));
+            rtcReleaseGeometry(geom);
+        }
 
-    for (int geo : s.geometries)
-        rtcDetachGeometry(s.accel, geo);
-    s.geometries.clear();
-
-    for (Shape *shape : m_shapes) {
-        RTCGeometry geom = shape->embree_geometry(embree_device);
-        s.geometries.push_back(rtcAttachGeometry(s.accel, geom));
-        rtcReleaseGeometry(geom);
+        s.primitive_counts.resize(m_shapes.size());
+        for (size_t i = 0; i < m_shapes.size(); ++i)
+            s.primitive_counts[i] = m_shapes[i]->primitive_count();
     }
 
     // Ensure shape data pointers are fully evaluated before building the BVH
     if constexpr (dr::is_llvm_v<Float>)
         dr::sync_thread();
 
-    // Avoid getting in a deadlock when building a nested scene while rendering
+    /* Avoid getting in a deadlock when building a nested scene while
+       rendering. Otherwise, the current threads of the pool (and the calling
+       thread) join the build. */
     if (s.is_nested_scene) {
         rtcCommitScene(s.accel);
     } else {
+        uint32_t join_count = std::min(pool_size() + 1, embree_threads);
         dr::parallel_for(
-            dr::blocked_range<size_t>(0, embree_threads, 1),
+            dr::blocked_range<size_t>(0, join_count, 1),
             [&](const dr::blocked_range<size_t> &) {
                 rtcJoinCommitScene(s.accel);
             }
         );
     }
 
+    /* Embree does not expose its node count and SAH cost. The memory is
+       approximated by the allocations made while (re)building the scene,
+       which may include those of other scenes built concurrently. */
+    s.memory = std::max(s.memory + embree_memory - memory, (int64_t) 0);
+    m_accel_stats.backend    = "embree";
+    m_accel_stats.build_time = (float) timer.value();
+    m_accel_stats.memory     = (size_t) s.memory;
+    m_accel_stats.primitive_count = 0;
+    for (const Shape *shape : m_shapes)
+        m_accel_stats.primitive_count += shape->primitive_count();
+    m_accel_memory.set(m_accel_stats.memory);
+    Log(Debug, "%s", m_accel_stats.to_string());
+
     /* Set up a callback on the handle variable to release the Embree
        acceleration data structure (IAS) when this variable is freed. This
        ensures that the lifetime of the IAS goes beyond the one of the Scene
@@ -186,6 +272,11 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
     clear_shapes_dirty();
 }
 
+MI_VARIANT TraversalStats
+Scene<Float, Spectrum>::accel_traversal_stats_cpu(uint32_t, uint32_t) const {
+    Throw("accel_traversal_stats(): not supported by the Embree backend!");
+}
+
 MI_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     if constexpr (dr::is_llvm_v<Float>) {
         // Ensure all ray tracing kernels are terminated before releasing the scene
@@ -213,11 +304,14 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
 
     if constexpr (!dr::is_jit_v<Float>) {
         DRJIT_MARK_USED(active);
-        DRJIT_MARK_USED(coherent);
 
         RTCIntersectContext context;
         rtcInitIntersectContext(&context);
 
+        // Let Embree optimize for consecutive coherent queries
+        if (coherent)
+            context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
         PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
 
         using Vector3s = Vector<Single, 3>;
@@ -358,11 +452,14 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask coherent, Mask activ
 
     if constexpr (!dr::is_jit_v<Float>) {
         DRJIT_MARK_USED(active);
-        DRJIT_MARK_USED(coherent);
 
         RTCIntersectContext context;
         rtcInitIntersectContext(&context);
 
+        // Let Embree optimize for consecutive coherent queries
+        if (coherent)
+            context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
         using Vector3s = Vector<Single, 3>;
 
         RTCRay ray2;
@@ -425,6 +522,160 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask coherent, Mask activ
     }
 }
 
+MI_VARIANT void
+Scene<Float, Spectrum>::ray_test_batch_cpu(const Ray3f *rays, const Mask *active,
+                                           Mask *occluded, size_t count) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        using Single = dr::float32_array_t<Float>;
+        EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
+
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+
+        /* Trace the active rays in packets of 16 using Embree's packet
+           interface (SIMD traversal across rays). Unused lanes of the last
+           packet are disabled via the 'valid' mask. */
+        constexpr size_t N = 16;
+        RTC_ALIGN(64) RTCRay16 packet;
+        RTC_ALIGN(64) int valid[N];
+        size_t index[N];
+
+        for (size_t i = 0; i < count; ) {
+            size_t n = 0;
+            for (; i < count && n < N; ++i) {
+                occluded[i] = false;
+                if (!active[i])
+                    continue;
+
+                const Ray3f &ray = rays[i];
+                float ray_maxt = (float) dr::minimum(Single(ray.maxt),
+                                                     dr::Largest<Single>);
+
+                packet.org_x[n] = (float) ray.o.x();
+                packet.org_y[n] = (float) ray.o.y();
+                packet.org_z[n] = (float) ray.o.z();
+                packet.tnear[n] = 0.f;
+                packet.dir_x[n] = (float) ray.d.x();
+                packet.dir_y[n] = (float) ray.d.y();
+                packet.dir_z[n] = (float) ray.d.z();
+                packet.time[n]  = (float) ray.time;
+                packet.tfar[n]  = ray_maxt;
+                packet.mask[n]  = 0;
+                packet.id[n]    = (unsigned int) n;
+                packet.flags[n] = 0;
+                valid[n] = -1;
+                index[n++] = i;
+            }
+
+            if (n == 0)
+                continue;
+
+            for (size_t j = n; j < N; ++j)
+                valid[j] = 0;
+
+            rtcOccluded16(valid, s.accel, &context, &packet);
+
+            // Embree sets 'tfar' to -infinity for occluded rays
+            for (size_t j = 0; j < n; ++j)
+                occluded[index[j]] = packet.tfar[j] < 0.f;
+        }
+    } else {
+        DRJIT_MARK_USED(rays);
+        DRJIT_MARK_USED(active);
+        DRJIT_MARK_USED(occluded);
+        DRJIT_MARK_USED(count);
+        Throw("ray_test_batch_cpu() should only be called in scalar mode.");
+    }
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::ray_intersect_preliminary_batch_cpu(
+    const Ray3f *rays, const Mask *active, PreliminaryIntersection3f *result,
+    size_t count) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        using Single = dr::float32_array_t<Float>;
+        EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
+
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+
+        // Trace the active rays in packets of 16 (see ray_test_batch_cpu())
+        constexpr size_t N = 16;
+        RTC_ALIGN(64) RTCRayHit16 packet;
+        RTC_ALIGN(64) int valid[N];
+        float rays_maxt[N];
+        size_t index[N];
+
+        for (size_t i = 0; i < count; ) {
+            size_t n = 0;
+            for (; i < count && n < N; ++i) {
+                result[i] = dr::zeros<PreliminaryIntersection3f>();
+                if (!active[i])
+                    continue;
+
+                const Ray3f &ray = rays[i];
+                float ray_maxt = (float) dr::minimum(Single(ray.maxt),
+                                                     dr::Largest<Single>);
+
+                packet.ray.org_x[n] = (float) ray.o.x();
+                packet.ray.org_y[n] = (float) ray.o.y();
+                packet.ray.org_z[n] = (float) ray.o.z();
+                packet.ray.tnear[n] = 0.f;
+                packet.ray.dir_x[n] = (float) ray.d.x();
+                packet.ray.dir_y[n] = (float) ray.d.y();
+                packet.ray.dir_z[n] = (float) ray.d.z();
+                packet.ray.time[n]  = (float) ray.time;
+                packet.ray.tfar[n]  = ray_maxt;
+                packet.ray.mask[n]  = 0;
+                packet.ray.id[n]    = (unsigned int) n;
+                packet.ray.flags[n] = 0;
+                packet.hit.geomID[n] = RTC_INVALID_GEOMETRY_ID;
+                packet.hit.instID[0][n] = RTC_INVALID_GEOMETRY_ID;
+                valid[n] = -1;
+                rays_maxt[n] = ray_maxt;
+                index[n++] = i;
+            }
+
+            if (n == 0)
+                continue;
+
+            for (size_t j = n; j < N; ++j)
+                valid[j] = 0;
+
+            rtcIntersect16(valid, s.accel, &context, &packet);
+
+            for (size_t j = 0; j < n; ++j) {
+                if (packet.ray.tfar[j] == rays_maxt[j])
+                    continue;
+
+                PreliminaryIntersection3f &pi = result[index[j]];
+
+                // We get level 0 because we only support one level of instancing
+                uint32_t shape_index = packet.hit.geomID[j],
+                         inst_index  = packet.hit.instID[0][j];
+                bool hit_instance = inst_index != RTC_INVALID_GEOMETRY_ID;
+
+                ShapePtr shape = m_shapes[hit_instance ? inst_index : shape_index];
+                if (hit_instance)
+                    pi.instance = shape;
+                else
+                    pi.shape = shape;
+
+                pi.shape_index = shape_index;
+                pi.t = packet.ray.tfar[j];
+                pi.prim_index = packet.hit.primID[j];
+                pi.prim_uv = Point2f(packet.hit.u[j], packet.hit.v[j]);
+            }
+        }
+    } else {
+        DRJIT_MARK_USED(rays);
+        DRJIT_MARK_USED(active);
+        DRJIT_MARK_USED(result);
+        DRJIT_MARK_USED(count);
+        Throw("ray_intersect_preliminary_batch_cpu() should only be called in "
+              "scalar mode.");
+    }
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_naive_cpu(const Ray3f &ray,
                                                 Mask active) const {
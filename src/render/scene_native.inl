@@ -1,21 +1,81 @@
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/warp.h>
+
 NAMESPACE_BEGIN(mitsuba)
 
 template <typename Float, typename Spectrum>
 struct NativeState {
     MI_IMPORT_CORE_TYPES()
-    ShapeKDTree<Float, Spectrum> *accel;
+    /// Exactly one of 'accel' (kd-tree) and 'bvh' is set
+    ShapeKDTree<Float, Spectrum> *accel = nullptr;
+    ShapeBVH<Float, Spectrum> *bvh = nullptr;
     DynamicBuffer<UInt32> shapes_registry_ids;
+    /// Primitive count of every shape at the time of the last build
+    std::vector<uint32_t> primitive_counts;
+
+    /// Trace a single ray through whichever acceleration data structure is in use
+    template <bool ShadowRay, bool Count = false>
+    MI_INLINE auto ray_intersect_scalar(
+        const typename ShapeKDTree<Float, Spectrum>::ScalarRay3f &ray,
+        TraversalCounters *counters = nullptr) const {
+        if (bvh)
+            return bvh->template ray_intersect_scalar<ShadowRay, Count>(ray, counters);
+        else
+            return accel->template ray_intersect_scalar<ShadowRay, Count>(ray, counters);
+    }
+
+    /**
+     * \brief Trace a packet of rays, sharing the kd-tree traversal across
+     * lanes (the BVH traces the rays one by one)
+     */
+    template <bool ShadowRay, size_t Width>
+    MI_INLINE void ray_intersect_packet(
+        typename ShapeKDTree<Float, Spectrum>::ScalarRay3f *rays,
+        const bool *valid,
+        PreliminaryIntersection<dr::scalar_t<Float>, Shape<Float, Spectrum>> *pi) const {
+        if (bvh) {
+            for (size_t i = 0; i < Width; ++i) {
+                if (valid[i])
+                    pi[i] = bvh->template ray_intersect_scalar<ShadowRay>(rays[i]);
+            }
+        } else {
+            accel->template ray_intersect_packet<ShadowRay, Width>(rays, valid, pi);
+        }
+    }
+
+    /// Release the acceleration data structure
+    void release() {
+        if (bvh) {
+            bvh->clear();
+            bvh->dec_ref();
+        } else {
+            accel->clear();
+            accel->dec_ref();
+        }
+    }
 };
 
 MI_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
-    ShapeKDTree *kdtree = new ShapeKDTree(props);
-    kdtree->inc_ref();
+    m_accel = new NativeState<Float, Spectrum>();
+    NativeState<Float, Spectrum> &s = *(NativeState<Float, Spectrum> *) m_accel;
+
+    /* Select the native acceleration data structure: a SAH kd-tree
+       ("kdtree", the default) or a four-wide SAH BVH ("bvh"). The BVH
+       traverses instances as the top level of a two-level hierarchy instead
+       of splitting their overlapping bounds. */
+    std::string accel_type = props.string("accel_type", "kdtree");
+    if (accel_type == "bvh") {
+        s.bvh = new ShapeBVH<Float, Spectrum>(props);
+        s.bvh->inc_ref();
+    } else if (accel_type == "kdtree") {
+        s.accel = new ShapeKDTree(props);
+        s.accel->inc_ref();
+    } else {
+        Throw("Scene: unsupported acceleration data structure \"%s\", must "
+              "be \"kdtree\" or \"bvh\"!", accel_type);
+    }
 
     if constexpr (dr::is_llvm_v<Float>) {
-        m_accel = new NativeState<Float, Spectrum>();
-        NativeState<Float, Spectrum> &s = *(NativeState<Float, Spectrum> *) m_accel;
-        s.accel = kdtree;
-
         // Get shapes registry ids
         if (!m_shapes.empty()) {
             std::unique_ptr<uint32_t[]> data(new uint32_t[m_shapes.size()]);
@@ -26,8 +86,6 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &props)
         } else {
             s.shapes_registry_ids = dr::zeros<DynamicBuffer<UInt32>>();
         }
-    } else {
-        m_accel = kdtree;
     }
 
     accel_parameters_changed_cpu();
@@ -38,17 +96,52 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
     if constexpr (dr::is_llvm_v<Float>)
         dr::sync_thread();
 
-    ShapeKDTree *kdtree;
-    if constexpr (dr::is_llvm_v<Float>)
-        kdtree = ((NativeState<Float, Spectrum> *) m_accel)->accel;
-    else
-        kdtree = (ShapeKDTree *) m_accel;
+    NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
+
+    /* When only vertex positions moved since the last build (same shapes,
+       same primitive counts), the BVH can be refit in place instead of
+       being rebuilt. The kd-tree splits primitives and must be rebuilt. */
+    bool same_topology = s->primitive_counts.size() == m_shapes.size();
+    for (size_t i = 0; same_topology && i < m_shapes.size(); ++i)
+        same_topology = s->primitive_counts[i] == m_shapes[i]->primitive_count();
+
+    s->primitive_counts.resize(m_shapes.size());
+    for (size_t i = 0; i < m_shapes.size(); ++i)
+        s->primitive_counts[i] = m_shapes[i]->primitive_count();
 
-    kdtree->clear();
-    for (Shape *shape : m_shapes)
-        kdtree->add_shape(shape);
     ScopedPhase phase(ProfilerPhase::InitAccel);
-    kdtree->build();
+    Timer timer;
+    if (s->bvh && same_topology && s->bvh->ready()) {
+        s->bvh->refit();
+    } else if (s->bvh) {
+        s->bvh->clear();
+        for (Shape *shape : m_shapes)
+            s->bvh->add_shape(shape);
+        s->bvh->build();
+    } else {
+        s->accel->clear();
+        for (Shape *shape : m_shapes)
+            s->accel->add_shape(shape);
+        s->accel->build();
+    }
+
+    AccelStats &stats = m_accel_stats;
+    stats.build_time = (float) timer.value();
+    if (s->bvh) {
+        stats.backend         = "bvh";
+        stats.memory          = s->bvh->memory();
+        stats.node_count      = s->bvh->node_count();
+        stats.primitive_count = s->bvh->primitive_count();
+        stats.sah_cost        = (float) s->bvh->sah_cost();
+    } else {
+        stats.backend         = "kdtree";
+        stats.memory          = s->accel->memory();
+        stats.node_count      = s->accel->node_count();
+        stats.primitive_count = s->accel->primitive_count();
+        stats.sah_cost        = (float) s->accel->sah_cost();
+    }
+    m_accel_memory.set(stats.memory);
+    Log(Debug, "%s", stats.to_string());
 
     /* Set up a callback on the handle variable to release the Embree
        acceleration data structure (IAS) when this variable is freed. This
@@ -59,7 +152,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
         // Prevents the IAS to be released when updating the scene parameters
         if (m_accel_handle.index())
             jit_var_set_callback(m_accel_handle.index(), nullptr, nullptr);
-        m_accel_handle = dr::opaque<UInt64>(kdtree);
+        m_accel_handle = dr::opaque<UInt64>(m_accel);
         jit_var_set_callback(
             m_accel_handle.index(),
             [](uint32_t /* index */, int free, void *payload) {
@@ -69,8 +162,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
                         Log(Debug, "Free KDTree..");
                         NativeState<Float, Spectrum> *s =
                             (NativeState<Float, Spectrum> *) payload;
-                        s->accel->clear();
-                        s->accel->dec_ref();
+                        s->release();
                         delete s;
                     });
                     Thread::register_task(task);
@@ -83,6 +175,49 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
     clear_shapes_dirty();
 }
 
+MI_VARIANT TraversalStats
+Scene<Float, Spectrum>::accel_traversal_stats_cpu(uint32_t ray_count,
+                                                  uint32_t seed) const {
+    using ScalarRay3f = typename ShapeKDTree::ScalarRay3f;
+    const NativeState<Float, Spectrum> *s =
+        (const NativeState<Float, Spectrum> *) m_accel;
+
+    TraversalStats stats;
+    if (m_shapes.empty() || ray_count == 0)
+        return stats;
+
+    // Chords between uniformly distributed points on the bounding sphere
+    ScalarBoundingSphere3f sphere = m_bbox.bounding_sphere();
+    sphere.radius = dr::maximum(sphere.radius, dr::Epsilon<ScalarFloat>);
+
+    PCG32<uint32_t> rng;
+    rng.seed(1, PCG32_DEFAULT_STATE, seed);
+    auto sample_sphere = [&]() {
+        ScalarPoint2f sample(rng.next_float32(), rng.next_float32());
+        return sphere.center + warp::square_to_uniform_sphere(sample) * sphere.radius;
+    };
+
+    TraversalCounters counters;
+    size_t hits = 0;
+    for (uint32_t i = 0; i < ray_count; ++i) {
+        ScalarPoint3f o = sample_sphere();
+        ScalarVector3f d = sample_sphere() - o;
+        if (dr::squared_norm(d) == 0.f)
+            d = -(o - sphere.center);
+
+        ScalarRay3f ray(o, dr::normalize(d), dr::Infinity<ScalarFloat>, 0.f,
+                        wavelength_t<Spectrum>());
+        hits += s->template ray_intersect_scalar<false, true>(ray, &counters)
+                    .is_valid();
+    }
+
+    stats.ray_count          = ray_count;
+    stats.nodes_per_ray      = (float) ((double) counters.nodes / ray_count);
+    stats.primitives_per_ray = (float) ((double) counters.primitives / ray_count);
+    stats.hit_fraction       = (float) ((double) hits / ray_count);
+    return stats;
+}
+
 MI_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     if constexpr (dr::is_llvm_v<Float>) {
         // Ensure all ray tracing kernels are terminated before releasing the scene
@@ -93,7 +228,9 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
            ray tracing calls are pending. */
         m_accel_handle = 0;
     } else {
-        ((ShapeKDTree *) m_accel)->dec_ref();
+        NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
+        s->release();
+        delete s;
     }
 
     m_accel = nullptr;
@@ -116,21 +253,23 @@ template <typename ScalarFloat> struct RayHitT {
 #  pragma pack(pop)
 #endif
 
+/**
+ * Bit of the intersection context flags that Dr.Jit sets for coherent rays.
+ * The context passed to the trace function has the layout of Embree's
+ * RTCIntersectContext, whose first member holds these flags.
+ */
+static constexpr uint32_t CoherentContextFlag = 1u;
+
 template <typename Float, typename Spectrum, bool ShadowRay, size_t Width>
 void kdtree_trace_func_wrapper(const int *valid, void *ptr,
-                               void* /* context */, uint8_t *args) {
+                               void *context, uint8_t *args) {
     MI_IMPORT_TYPES()
     using ScalarRay3f = Ray<ScalarPoint3f, Spectrum>;
-    using ShapeKDTree = ShapeKDTree<Float, Spectrum>;
 
-    NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) ptr;
-    const ShapeKDTree *kdtree = s->accel;
+    const NativeState<Float, Spectrum> *s = (const NativeState<Float, Spectrum> *) ptr;
     using RayHit = RayHitT<ScalarFloat>;
 
-    for (size_t i = 0; i < Width; i++) {
-        if (valid[i] == 0)
-            continue;
-
+    auto load_ray = [&](size_t i) {
         ScalarPoint3f ray_o;
         ray_o[0] = ((ScalarFloat*) &args[offsetof(RayHit, o_x) * Width])[i];
         ray_o[1] = ((ScalarFloat*) &args[offsetof(RayHit, o_y) * Width])[i];
@@ -141,17 +280,19 @@ void kdtree_trace_func_wrapper(const int *valid, void *ptr,
         ray_d[1] = ((ScalarFloat*) &args[offsetof(RayHit, d_y) * Width])[i];
         ray_d[2] = ((ScalarFloat*) &args[offsetof(RayHit, d_z) * Width])[i];
 
-        ScalarFloat& ray_maxt = ((ScalarFloat*) &args[offsetof(RayHit, tfar) * Width])[i];
-        ScalarFloat& ray_time = ((ScalarFloat*) &args[offsetof(RayHit, time) * Width])[i];
+        ScalarFloat ray_maxt = ((ScalarFloat*) &args[offsetof(RayHit, tfar) * Width])[i];
+        ScalarFloat ray_time = ((ScalarFloat*) &args[offsetof(RayHit, time) * Width])[i];
 
-        ScalarRay3f ray = ScalarRay3f(ray_o, ray_d, ray_maxt, ray_time, wavelength_t<Spectrum>());
+        return ScalarRay3f(ray_o, ray_d, ray_maxt, ray_time, wavelength_t<Spectrum>());
+    };
+
+    auto store_hit = [&](size_t i, const auto &pi) {
+        ScalarFloat& ray_maxt = ((ScalarFloat*) &args[offsetof(RayHit, tfar) * Width])[i];
 
         if constexpr (ShadowRay) {
-            bool hit = kdtree->template ray_intersect_scalar<true>(ray).is_valid();
-            if (hit)
+            if (pi.is_valid())
                 ray_maxt = 0.f;
         } else {
-            auto pi = kdtree->template ray_intersect_scalar<false>(ray);
             if (pi.is_valid()) {
                 ScalarFloat& prim_u = ((ScalarFloat*) &args[offsetof(RayHit, u) * Width])[i];
                 ScalarFloat& prim_v = ((ScalarFloat*) &args[offsetof(RayHit, v) * Width])[i];
@@ -169,6 +310,35 @@ void kdtree_trace_func_wrapper(const int *valid, void *ptr,
                                       : (uint32_t) -1;
             }
         }
+    };
+
+    bool coherent = Width > 1 && context &&
+                    (*(const uint32_t *) context & CoherentContextFlag) != 0;
+
+    if (coherent) {
+        // Coherent rays share a single traversal of the acceleration data structure
+        ScalarRay3f rays[Width];
+        bool active[Width];
+        PreliminaryIntersection<ScalarFloat, Shape> pi[Width];
+
+        for (size_t i = 0; i < Width; i++) {
+            active[i] = valid[i] != 0;
+            if (active[i])
+                rays[i] = load_ray(i);
+        }
+
+        s->template ray_intersect_packet<ShadowRay, Width>(rays, active, pi);
+
+        for (size_t i = 0; i < Width; i++) {
+            if (active[i])
+                store_hit(i, pi[i]);
+        }
+    } else {
+        for (size_t i = 0; i < Width; i++) {
+            if (valid[i] == 0)
+                continue;
+            store_hit(i, s->template ray_intersect_scalar<ShadowRay>(load_ray(i)));
+        }
     }
 }
 
@@ -178,8 +348,10 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
                                                       Mask active) const {
     if constexpr (!dr::is_array_v<Float>) {
         DRJIT_MARK_USED(coherent);
-        const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
-        return kdtree->template ray_intersect_preliminary<false>(ray, active);
+        DRJIT_MARK_USED(active);
+        const NativeState<Float, Spectrum> *s =
+            (const NativeState<Float, Spectrum> *) m_accel;
+        return s->template ray_intersect_scalar<false>(ray);
     } else {
         NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
         void *func_ptr = nullptr,
@@ -266,8 +438,10 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray,
                                      Mask coherent, Mask active) const {
     if constexpr (!dr::is_jit_v<Float>) {
         DRJIT_MARK_USED(coherent);
-        const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
-        return kdtree->template ray_intersect_preliminary<true>(ray, active).is_valid();
+        DRJIT_MARK_USED(active);
+        const NativeState<Float, Spectrum> *s =
+            (const NativeState<Float, Spectrum> *) m_accel;
+        return s->template ray_intersect_scalar<true>(ray).is_valid();
     } else {
         void *func_ptr = nullptr, *scene_ptr = m_accel;
 
@@ -306,16 +480,36 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray,
     }
 }
 
+MI_VARIANT void
+Scene<Float, Spectrum>::ray_test_batch_cpu(const Ray3f *rays, const Mask *active,
+                                           Mask *occluded, size_t count) const {
+    // The kd-tree has no packet traversal, trace the rays one by one
+    for (size_t i = 0; i < count; ++i)
+        occluded[i] = active[i] && ray_test_cpu(rays[i], false, active[i]);
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::ray_intersect_preliminary_batch_cpu(
+    const Ray3f *rays, const Mask *active, PreliminaryIntersection3f *result,
+    size_t count) const {
+    // The kd-tree has no packet traversal, trace the rays one by one
+    for (size_t i = 0; i < count; ++i) {
+        if constexpr (!dr::is_jit_v<Float>)
+            result[i] = active[i]
+                ? ray_intersect_preliminary_cpu(rays[i], false, true)
+                : dr::zeros<PreliminaryIntersection3f>();
+        else
+            result[i] = ray_intersect_preliminary_cpu(rays[i], false, active[i]);
+    }
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_naive_cpu(const Ray3f &ray, Mask active) const {
-    const ShapeKDTree *kdtree;
-    if constexpr (dr::is_llvm_v<Float>)
-        kdtree = ((NativeState<Float, Spectrum> *) m_accel)->accel;
-    else
-        kdtree = (const ShapeKDTree *) m_accel;
+    const NativeState<Float, Spectrum> *s =
+        (const NativeState<Float, Spectrum> *) m_accel;
 
     PreliminaryIntersection3f pi =
-        kdtree->template ray_intersect_naive<false>(ray, active);
+        s->bvh ? s->bvh->template ray_intersect_naive<false>(ray, active)
+               : s->accel->template ray_intersect_naive<false>(ray, active);
 
     return pi.compute_surface_interaction(ray, +RayFlags::All, active);
 }
@@ -29,7 +29,10 @@ struct OptixSceneState {
     OptixShaderBindingTable sbt = {};
     OptixAccelData accel;
     OptixTraversableHandle ias_handle = 0ull;
-    void* ias_buffer = nullptr;
+    /// The "master" IAS (unless the scene consists of a single GAS)
+    OptixAccelData::HandleData ias;
+    /// Refit the acceleration structures when only the geometry moved?
+    bool allow_update = false;
     size_t config_index;
     uint32_t sbt_jit_index;
     bool own_sbt;
@@ -57,13 +60,15 @@ struct OptixConfig {
 };
 
 // Array storing previously initialized optix configurations
-static constexpr int32_t OPTIX_CONFIG_COUNT = 32;
+static constexpr int32_t OPTIX_CONFIG_COUNT = 64;
 static OptixConfig optix_configs[OPTIX_CONFIG_COUNT] = {};
 
 size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
-                         bool has_bspline_curves, bool has_linear_curves) {
+                         bool has_bspline_curves, bool has_linear_curves,
+                         bool has_motion) {
     // Compute config index in optix_configs based on required set of features
     size_t config_index =
+        (has_motion ? 32 : 0) +
         (has_bspline_curves ? 16 : 0) +
         (has_linear_curves ? 8 : 0) +
         (has_instances ? 4 : 0) +
@@ -72,9 +77,12 @@ size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
 
     OptixConfig &config = optix_configs[config_index];
 
-    // Initialize Optix config if necessary
+    /* Initialize Optix config if necessary. Configurations are shared by
+       all scenes of the process, and the compiled module is additionally
+       kept in OptiX's disk cache (see optix_initialize()). */
     if (!config.main_module) {
         Log(Debug, "Initialize Optix configuration (index=%zu)..", config_index);
+        Timer timer;
 
         config.context = jit_optix_context();
 
@@ -92,7 +100,7 @@ size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
         module_compile_options.debugLevel       = OPTIX_COMPILE_DEBUG_LEVEL_MINIMAL;
     #endif
 
-        config.pipeline_compile_options.usesMotionBlur     = false;
+        config.pipeline_compile_options.usesMotionBlur     = has_motion;
         config.pipeline_compile_options.numPayloadValues   = 6;
         config.pipeline_compile_options.numAttributeValues = 2; // the minimum legal value
         config.pipeline_compile_options.pipelineLaunchParamsVariableName = "params";
@@ -293,6 +301,11 @@ size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
             config.program_groups, PROGRAM_GROUP_COUNT
         );
         jit_set_scope(JitBackend::CUDA, scope);
+
+        Log(Debug, "Optix configuration initialized in %s.",
+            util::time_string((float) timer.value()));
+    } else {
+        Log(Debug, "Re-use Optix configuration (index=%zu)..", config_index);
     }
 
     return config_index;
@@ -308,6 +321,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
 
         m_accel = new OptixSceneState();
         OptixSceneState &s = *(OptixSceneState *) m_accel;
+        s.allow_update = props.get<bool>("optix_allow_update", false);
 
         // Check if another scene was passed to the constructor
         Scene *other_scene = nullptr;
@@ -367,6 +381,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
             bool has_instances = false;
             bool has_bspline_curves = false;
             bool has_linear_curves = false;
+            bool has_motion = false;
 
             for (auto& shape : m_shapes) {
                 has_meshes           |= shape->is_mesh();
@@ -374,6 +389,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
                 has_instances        |= shape->is_instance();
                 has_bspline_curves   |= shape->is_bspline_curve();
                 has_linear_curves    |= shape->is_linear_curve();
+                has_motion           |= shape->has_motion();
             }
 
             for (auto& shape : m_shapegroups) {
@@ -384,7 +400,8 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
             }
 
             s.config_index = init_optix_config(has_meshes, has_others,
-                has_instances, has_bspline_curves, has_linear_curves);
+                has_instances, has_bspline_curves, has_linear_curves,
+                has_motion);
             const OptixConfig &config = optix_configs[s.config_index];
 
             // =====================================================
@@ -438,10 +455,11 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
         dr::sync_thread();
         OptixSceneState &s = *(OptixSceneState *) m_accel;
         const OptixConfig &config = optix_configs[s.config_index];
+        Timer timer;
 
         if (!m_shapes.empty()) {
             // Build geometry acceleration structures for all the shapes
-            build_gas(config.context, m_shapes, s.accel);
+            build_gas(config.context, m_shapes, s.accel, s.allow_update);
             for (auto& shapegroup: m_shapegroups)
                 shapegroup->optix_build_gas(config.context);
 
@@ -453,64 +471,46 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
             if (config.pipeline_compile_options.traversableGraphFlags == OPTIX_TRAVERSABLE_GRAPH_FLAG_ALLOW_SINGLE_GAS) {
                 if (ias.size() != 1)
                     Throw("OPTIX_TRAVERSABLE_GRAPH_FLAG_ALLOW_SINGLE_GAS used but found multiple IASs.");
-                s.ias_buffer = nullptr;
                 s.ias_handle = ias[0].traversableHandle;
             } else {
                 // Build a "master" IAS that contains all the IAS of the scene (meshes,
                 // custom shapes, instances, ...)
-                OptixAccelBuildOptions accel_options = {};
-                accel_options.buildFlags = OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
-                accel_options.operation  = OPTIX_BUILD_OPERATION_BUILD;
-                accel_options.motionOptions.numKeys = 0;
-
                 size_t ias_data_size = ias.size() * sizeof(OptixInstance);
                 void* d_ias = jit_malloc(AllocType::HostPinned, ias_data_size);
                 jit_memcpy_async(JitBackend::CUDA, d_ias, ias.data(), ias_data_size);
 
-                OptixBuildInput build_input;
+                std::vector<OptixBuildInput> build_inputs(1);
+                OptixBuildInput &build_input = build_inputs[0];
                 build_input.type = OPTIX_BUILD_INPUT_TYPE_INSTANCES;
                 build_input.instanceArray.instances =
                     (CUdeviceptr) jit_malloc_migrate(d_ias, AllocType::Device, 1);
                 build_input.instanceArray.numInstances = (unsigned int) ias.size();
 
-                OptixAccelBufferSizes buffer_sizes;
-                jit_optix_check(optixAccelComputeMemoryUsage(
-                    config.context,
-                    &accel_options,
-                    &build_input,
-                    1,
-                    &buffer_sizes
-                ));
-
-                if (s.ias_buffer)
-                    jit_free(s.ias_buffer);
-
-                void* d_temp_buffer
-                    = jit_malloc(AllocType::Device, buffer_sizes.tempSizeInBytes);
-                s.ias_buffer
-                    = jit_malloc(AllocType::Device, buffer_sizes.outputSizeInBytes);
-
                 scoped_optix_context guard;
 
-                jit_optix_check(optixAccelBuild(
-                    config.context,
-                    (CUstream) jit_cuda_stream(),
-                    &accel_options,
-                    &build_input,
-                    1, // num build inputs
-                    (CUdeviceptr)d_temp_buffer,
-                    buffer_sizes.tempSizeInBytes,
-                    (CUdeviceptr)s.ias_buffer,
-                    buffer_sizes.outputSizeInBytes,
-                    &s.ias_handle,
-                    0, // emitted property list
-                    0  // num emitted properties
-                ));
-
-                jit_free(d_temp_buffer);
+                // The IAS is refit in place when the instance count is unchanged
+                build_accel(config.context, build_inputs,
+                            { (uint32_t) ias.size() }, s.allow_update, s.ias);
+                s.ias_handle = s.ias.handle;
             }
         }
 
+        /* OptiX does not expose its node count and SAH cost. The memory only
+           covers the acceleration structures of the top-level scene and not
+           those of the shape groups. The build time includes the synchronization
+           with the device. */
+        dr::sync_thread();
+        m_accel_stats.backend    = "optix";
+        m_accel_stats.build_time = (float) timer.value();
+        m_accel_stats.memory     = s.accel.meshes.size + s.accel.bspline_curves.size +
+                                   s.accel.linear_curves.size +
+                                   s.accel.custom_shapes.size + s.ias.size;
+        m_accel_stats.primitive_count = 0;
+        for (const Shape *shape : m_shapes)
+            m_accel_stats.primitive_count += shape->primitive_count();
+        m_accel_memory.set(0, m_accel_stats.memory);
+        Log(Debug, "%s", m_accel_stats.to_string());
+
         /* Set up a callback on the handle variable to release the OptiX scene
            state when this variable is freed. This ensures that the lifetime of
            the pipeline goes beyond the one of the Scene instance if there are
@@ -531,7 +531,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
                     // TODO should also free build_input.instanceArray.instances
                 }
             },
-            (void *) s.ias_buffer
+            (void *) s.ias.buffer
         );
 
         clear_shapes_dirty();
@@ -24,6 +24,17 @@ MI_VARIANT Shape<Float, Spectrum>::Shape(const Properties &props) : m_id(props.i
         (ScalarTransform4f) props.get<ScalarTransform4f>("to_world", ScalarTransform4f());
     m_to_object = m_to_world.scalar().inverse();
 
+    std::string embree_build = props.string("embree_build", "refit");
+    if (embree_build == "refit")
+        m_embree_build_mode = EmbreeBuildMode::Refit;
+    else if (embree_build == "static")
+        m_embree_build_mode = EmbreeBuildMode::Static;
+    else if (embree_build == "dynamic")
+        m_embree_build_mode = EmbreeBuildMode::Dynamic;
+    else
+        Throw("Invalid \"embree_build\" value \"%s\", must be one of: "
+              "\"static\", \"dynamic\", or \"refit\"!", embree_build);
+
     for (auto &[name, obj] : props.objects(false)) {
         Emitter *emitter = dynamic_cast<Emitter *>(obj.get());
         Sensor *sensor   = dynamic_cast<Sensor *>(obj.get());
@@ -73,10 +84,18 @@ MI_VARIANT Shape<Float, Spectrum>::Shape(const Properties &props) : m_id(props.i
     dr::set_attr(this, "emitter", m_emitter.get());
     dr::set_attr(this, "sensor", m_sensor.get());
     dr::set_attr(this, "bsdf", m_bsdf.get());
+    dr::set_attr(this, "bsdf_index", m_bsdf_index);
     dr::set_attr(this, "interior_medium", m_interior_medium.get());
     dr::set_attr(this, "exterior_medium", m_exterior_medium.get());
 }
 
+MI_VARIANT void Shape<Float, Spectrum>::set_bsdf(BSDF *bsdf, uint32_t index) {
+    m_bsdf = bsdf;
+    m_bsdf_index = index;
+    dr::set_attr(this, "bsdf", m_bsdf.get());
+    dr::set_attr(this, "bsdf_index", m_bsdf_index);
+}
+
 MI_VARIANT Shape<Float, Spectrum>::~Shape() {
 #if defined(MI_ENABLE_CUDA)
     if constexpr (dr::is_cuda_v<Float>)
@@ -317,6 +336,20 @@ MI_VARIANT RTCGeometry Shape<Float, Spectrum>::embree_geometry(RTCDevice device)
         Throw("embree_geometry() should only be called in CPU mode.");
     }
 }
+
+MI_VARIANT bool Shape<Float, Spectrum>::embree_update_geometry(RTCGeometry /* geom */) {
+    return false;
+}
+
+MI_VARIANT RTCBuildQuality
+Shape<Float, Spectrum>::embree_build_quality(bool update) const {
+    switch (m_embree_build_mode) {
+        case EmbreeBuildMode::Static:  return RTC_BUILD_QUALITY_HIGH;
+        case EmbreeBuildMode::Dynamic: return RTC_BUILD_QUALITY_LOW;
+        default:
+            return update ? RTC_BUILD_QUALITY_REFIT : RTC_BUILD_QUALITY_MEDIUM;
+    }
+}
 #endif
 
 #if defined(MI_ENABLE_CUDA)
@@ -407,6 +440,16 @@ Shape<Float, Spectrum>::ray_intersect_preliminary_scalar(const ScalarRay3f & /*r
     NotImplementedError("ray_intersect_preliminary_scalar");
 }
 
+MI_VARIANT
+std::tuple<typename Shape<Float, Spectrum>::ScalarFloat,
+           typename Shape<Float, Spectrum>::ScalarPoint2f,
+           typename Shape<Float, Spectrum>::ScalarUInt32,
+           typename Shape<Float, Spectrum>::ScalarUInt32>
+Shape<Float, Spectrum>::ray_intersect_primitive_scalar(ScalarIndex /*prim_index*/,
+                                                       const ScalarRay3f &ray) const {
+    return ray_intersect_preliminary_scalar(ray);
+}
+
 #define MI_DEFAULT_RAY_INTERSECT_PACKET(N)                                    \
     MI_VARIANT std::tuple<typename Shape<Float, Spectrum>::FloatP##N,         \
                            typename Shape<Float, Spectrum>::Point2fP##N,       \
@@ -438,6 +481,12 @@ bool Shape<Float, Spectrum>::ray_test_scalar(const ScalarRay3f & /*ray*/) const
     NotImplementedError("ray_intersect_test_scalar");
 }
 
+MI_VARIANT
+bool Shape<Float, Spectrum>::ray_test_primitive_scalar(ScalarIndex /*prim_index*/,
+                                                       const ScalarRay3f &ray) const {
+    return ray_test_scalar(ray);
+}
+
 MI_VARIANT typename Shape<Float, Spectrum>::SurfaceInteraction3f
 Shape<Float, Spectrum>::compute_surface_interaction(const Ray3f & /*ray*/,
                                                     const PreliminaryIntersection3f &/*pi*/,
@@ -26,8 +26,6 @@ MI_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
             ShapeGroup *shapegroup = dynamic_cast<ShapeGroup *>(kv.second.get());
             if (shapegroup)
                 Throw("Nested ShapeGroup is not permitted");
-            if (shape->is_emitter())
-                Throw("Instancing of emitters is not supported");
             if (shape->is_sensor())
                 Throw("Instancing of sensors is not supported");
             else {
@@ -6,68 +6,234 @@ NAMESPACE_BEGIN(mitsuba)
 
 Spiral::Spiral(const Vector2u &size, const Vector2u &offset,
                uint32_t block_size, uint32_t passes)
-    : m_size(size), m_offset(offset), m_passes_left(passes),
-      m_block_size(block_size) {
+    : m_size(size), m_offset(offset), m_pass_count(passes),
+      m_passes_left(passes), m_pass_barrier(false),
+      m_block_size(block_size), m_priority_count(0), m_region_first(false),
+      m_region_done(false), m_worker_count(0), m_min_block_size(1),
+      m_split_threshold(0.f), m_total_cost(0.f) {
 
     m_blocks = (size + (block_size - 1)) / block_size;
     m_block_count = dr::prod(m_blocks);
+    m_block_cost.resize(m_block_count, 0.f);
+
+    // Reimplementation of the spiraling block generator by Adam Arbree.
+    Point2i position(m_blocks / 2);
+    Direction direction = Direction::Right;
+    uint32_t steps_left = 1, spiral_size = 1;
+
+    for (uint32_t i = 0; i < m_block_count; ++i) {
+        m_positions.push_back(position);
+        m_order.push_back(i);
+        if (i + 1 == m_block_count)
+            break;
+
+        // Advance to the next block's position along the spiral.
+        do {
+            switch (direction) {
+                case Direction::Right: ++position.x(); break;
+                case Direction::Down:  ++position.y(); break;
+                case Direction::Left:  --position.x(); break;
+                case Direction::Up:    --position.y(); break;
+            }
+
+            if (--steps_left == 0) {
+                direction = Direction(((int) direction + 1) % 4);
+                if (direction == Direction::Left ||
+                    direction == Direction::Right)
+                    ++spiral_size;
+                steps_left = spiral_size;
+            }
+        } while (dr::any(position < 0 || position >= m_blocks));
+    }
+
+    m_priority.resize(m_block_count, false);
 
     reset();
 }
 
 void Spiral::reset() {
-    m_block_counter = 0;
-    direction = Direction::Right;
-    m_position = Vector2u(m_blocks / 2);
-    m_steps_left = 1;
-    m_spiral_size = 1;
+    // The blocks of the priority region (if any) occupy the start of 'm_order'
+    m_block_counter = m_region_first && m_region_done ? m_priority_count : 0;
+    m_block_end = m_region_first && !m_region_done ? m_priority_count
+                                                   : m_block_count;
+}
+
+void Spiral::set_priority_region(const Vector2i &offset, const Vector2u &size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Vector2i region_min = offset - Vector2i(m_offset),
+             region_max = region_min + Vector2i(size);
+
+    std::vector<uint32_t> rest;
+    m_order.clear();
+    m_priority_count = 0;
+    for (uint32_t i = 0; i < m_block_count; ++i) {
+        Vector2i block_min = Vector2i(m_positions[i]) * (int32_t) m_block_size,
+                 block_max = block_min + (int32_t) m_block_size;
+        m_priority[i] = dr::all(block_min < region_max && block_max > region_min) &&
+                        dr::prod(size) > 0;
+        if (m_priority[i]) {
+            m_order.push_back(i);
+            m_priority_count++;
+        } else {
+            rest.push_back(i);
+        }
+    }
+    m_order.insert(m_order.end(), rest.begin(), rest.end());
+
+    m_region_first = m_priority_count > 0 &&
+                     m_priority_count < m_block_count && !m_pass_barrier;
+    m_region_done = false;
+    reset();
+}
+
+uint32_t Spiral::spiral_index(uint32_t block_id, uint32_t block_size) const {
+    // Recover the identifier of the spiral block containing this tile
+    while (block_size < m_block_size) {
+        block_id /= 4;
+        block_size *= 2;
+    }
+    return block_id % m_block_count;
+}
+
+bool Spiral::is_priority_block(uint32_t block_id, uint32_t block_size) const {
+    return m_priority[spiral_index(block_id, block_size)];
 }
 
 std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t> Spiral::next_block() {
-    // Reimplementation of the spiraling block generator by Adam Arbree.
     std::lock_guard<std::mutex> lock(m_mutex);
+    return next_block_unlocked();
+}
 
-    if (m_block_counter == m_block_count) {
-        if (m_passes_left > 1) {
+std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t>
+Spiral::next_block_unlocked() {
+    if (m_block_counter == m_block_end) {
+        if (m_passes_left > 1 && !m_pass_barrier) {
             --m_passes_left;
             reset();
+        } else if (m_region_first && !m_region_done) {
+            // All passes over the priority region are done, continue with the rest
+            m_region_done = true;
+            m_passes_left = m_pass_count;
+            reset();
         } else {
             return { 0, 0, (uint32_t) -1 };
         }
     }
 
     // Calculate a unique identifier per block
-    uint32_t block_id =
-        m_block_counter + (m_passes_left - 1) * m_block_count;
+    uint32_t index = m_order[m_block_counter],
+             block_id = index + (m_passes_left - 1) * m_block_count;
 
-    Vector2u offset = m_position * m_block_size,
+    Vector2u offset = Vector2u(m_positions[index]) * m_block_size,
              size   = dr::minimum(m_block_size, m_size - offset);
 
     Assert(dr::all(offset <= m_size));
 
     ++m_block_counter;
 
-    if (m_block_counter != m_block_count) {
-        // Prepare the next block's position along the spiral.
-        do {
-            switch (direction) {
-                case Direction::Right: ++m_position.x(); break;
-                case Direction::Down:  ++m_position.y(); break;
-                case Direction::Left:  --m_position.x(); break;
-                case Direction::Up:    --m_position.y(); break;
-            }
+    return { offset + m_offset, size, block_id };
+}
 
-            if (--m_steps_left == 0) {
-                direction = Direction(((int) direction + 1) % 4);
-                if (direction == Direction::Left ||
-                    direction == Direction::Right)
-                    ++m_spiral_size;
-                m_steps_left = m_spiral_size;
-            }
-        } while (dr::any(m_position < 0 || m_position >= m_blocks));
+void Spiral::set_pass_barrier(bool value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pass_barrier = value;
+
+    // A pass barrier requires every pass to cover the whole image
+    m_region_first = m_priority_count > 0 &&
+                     m_priority_count < m_block_count && !m_pass_barrier;
+    m_region_done = false;
+    reset();
+}
+
+bool Spiral::next_pass() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_passes_left <= 1)
+        return false;
+    --m_passes_left;
+    reset();
+    return true;
+}
+
+void Spiral::set_adaptive(uint32_t worker_count, uint32_t min_block_size,
+                          float split_threshold) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_worker_count = worker_count;
+    m_min_block_size = std::max(min_block_size, 1u);
+    m_split_threshold = split_threshold;
+}
+
+std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t, uint32_t>
+Spiral::next_tile() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Idle workers first take over sub-tiles left behind by split blocks
+    if (!m_tiles.empty()) {
+        Tile tile = m_tiles.front();
+        m_tiles.pop_front();
+        return tile;
     }
 
-    return { offset + m_offset, size, block_id };
+    auto [offset, size, block_id] = next_block_unlocked();
+    Tile tile { offset, size, block_id, m_block_size };
+
+    if (m_worker_count == 0 || dr::prod(size) == 0)
+        return tile;
+
+    uint32_t levels = 0;
+
+    // Split blocks that were expensive during earlier passes
+    if (m_total_cost > 0.f) {
+        float mean = m_total_cost / (float) m_block_count,
+              cost = m_block_cost[spiral_index(block_id, m_block_size)];
+        for (float t = m_split_threshold * mean; cost > t && t > 0.f; t *= 4.f)
+            levels++;
+    }
+
+    // Split blocks near the end of the render so that no worker stays idle
+    if ((m_passes_left == 1 || m_pass_barrier) &&
+        m_block_end - m_block_counter < m_worker_count)
+        levels = std::max(levels, 1u);
+
+    // Don't split below the minimum block size
+    while (levels > 0 && (m_block_size >> levels) < m_min_block_size)
+        levels--;
+
+    if (levels == 0)
+        return tile;
+
+    split_tile(tile, levels);
+    tile = m_tiles.front();
+    m_tiles.pop_front();
+    return tile;
+}
+
+void Spiral::split_tile(const Tile &tile, uint32_t levels) {
+    auto [offset, size, block_id, block_size] = tile;
+
+    if (levels == 0) {
+        m_tiles.push_back(tile);
+        return;
+    }
+
+    uint32_t half = block_size / 2;
+
+    // Visit the quadrants in Morton order to preserve the seeding scheme
+    for (uint32_t i = 0; i < 4; ++i) {
+        Vector2u rel(half * (i & 1), half * (i >> 1));
+        if (dr::any(rel >= size))
+            continue;
+
+        Tile child { offset + Vector2i(rel), dr::minimum(half, size - rel),
+                     block_id * 4 + i, half };
+        split_tile(child, levels - 1);
+    }
+}
+
+void Spiral::record_time(uint32_t block_id, uint32_t block_size, float time) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_block_cost[spiral_index(block_id, block_size)] += time;
+    m_total_cost += time;
 }
 
 MI_IMPLEMENT_CLASS(Spiral, Object)
@@ -462,3 +462,85 @@ def test07_masked_updates(variants_all_ad_rgb, opt):
 
         prev_x = mi.Float(params['x'])
         prev_state = [mi.Float(vv) for vv in ensure_iterable(opt.state['x'])]
+
+
+@pytest.mark.parametrize('uniform', [False, True])
+def test08_tiled_updates(variants_all_ad_rgb, uniform):
+    # A 4x6 RGB image, of which a single texel of the top-left 2x2 tile and
+    # a single texel of the bottom-right one receive a gradient
+    shape = (4, 6, 3)
+    x = dr.full(mi.TensorXf, 1.0, shape)
+
+    opt = mi.ad.Adam(lr=0.1, params={ 'x': x }, tile_size=2, uniform=uniform)
+    opt_ref = mi.ad.Adam(lr=0.1, params={ 'x': mi.TensorXf(x) }, uniform=uniform)
+
+    g = dr.zeros(mi.Float, dr.prod(shape))
+    dr.scatter(g, mi.Float([1.0, -2.0]), mi.UInt32([(0 * 6 + 1) * 3 + 0,
+                                                    (3 * 6 + 5) * 3 + 2]))
+    g = mi.TensorXf(g, shape)
+
+    for _ in range(3):
+        dr.set_grad(opt['x'], g)
+        dr.set_grad(opt_ref['x'], g)
+        opt.step()
+        opt_ref.step()
+
+    value, value_ref = opt['x'].array, opt_ref['x'].array
+    m = opt.state['x'][0].array
+
+    idx = dr.arange(mi.UInt32, dr.prod(shape)) // 3
+    y, x = idx // 6, idx % 6
+    touched = ((y < 2) & (x < 2)) | ((y >= 2) & (x >= 4))
+
+    # Touched tiles follow the dense update, the others remain unchanged
+    assert dr.allclose(dr.select(touched, value_ref, 1.0), value)
+    assert dr.all(dr.eq(m, 0) | touched)
+    assert value[3] < 1.0 and value[71] > 1.0
+
+
+@pytest.mark.parametrize('mask_updates', [False, True])
+def test09_fused_adam(variants_all_ad_rgb, mask_updates):
+    def create_params():
+        return {
+            'a': mi.Float([1.0, 2.0, 3.0]),
+            'b': dr.full(mi.TensorXf, 0.5, (2, 2, 3)),
+            'c': mi.Color3f(0.1, 0.2, 0.3),
+        }
+
+    lr = { 'a': 0.1, 'b': 0.05, 'c': 0.2 }
+    opt = mi.ad.FusedAdam(lr=0.1, mask_updates=mask_updates, params=create_params())
+    opt_ref = mi.ad.Adam(lr=0.1, mask_updates=mask_updates, params=create_params())
+    opt.set_learning_rate(lr)
+    opt_ref.set_learning_rate(lr)
+
+    def loss(opt):
+        return dr.sum(dr.sqr(opt['a'] - 2.0)) + \
+               dr.sum(dr.sqr(opt['b'].array - 1.0) * dr.arange(mi.Float, 12)) + \
+               dr.sum(dr.sum(opt['c']))
+
+    for it in range(4):
+        for o in (opt, opt_ref):
+            dr.backward(loss(o))
+            o.step()
+
+        # Values assigned to the optimizer are written back to the packed buffer
+        if it == 1:
+            for o in (opt, opt_ref):
+                o['a'] = dr.clamp(o['a'], 0.0, 2.5)
+
+    for k in ('a', 'b', 'c'):
+        value, value_ref = opt[k], opt_ref[k]
+        if value.IsTensor:
+            value, value_ref = value.array, value_ref.array
+        assert dr.allclose(value, value_ref)
+        for m, m_ref in zip(opt.state[k], opt_ref.state[k]):
+            if m.IsTensor:
+                m, m_ref = m.array, m_ref.array
+            assert dr.allclose(m, m_ref)
+
+    # A change of size invalidates the packed layout
+    opt['a'] = mi.Float([1.0, 2.0])
+    assert dr.width(opt['a']) == 2
+    dr.backward(loss(opt))
+    opt.step()
+    assert dr.width(opt['a']) == 2
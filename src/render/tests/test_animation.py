@@ -0,0 +1,116 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def write_keyframes(tmp_path, lines):
+    fname = str(tmp_path / 'keyframes.txt')
+    with open(fname, 'w') as f:
+        f.write('# frame parameter value\n')
+        for line in lines:
+            f.write(line + '\n')
+    return fname
+
+
+def create_scene():
+    return mi.load_dict({
+        'type': 'scene',
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, -4, 1], target=[0, 0, 0], up=[0, 0, 1]),
+            'sampler': {'type': 'independent', 'sample_count': 4},
+            'film': {'type': 'hdrfilm', 'width': 8, 'height': 8},
+        },
+        'sphere': {'type': 'sphere', 'bsdf': {'type': 'diffuse'}},
+        'light': {
+            'type': 'point',
+            'position': [0, -2, 2],
+            'intensity': {'type': 'rgb', 'value': [10, 10, 10]},
+        },
+    })
+
+
+def test01_interpolation(variants_all_rgb, tmp_path):
+    scene = create_scene()
+    fname = write_keyframes(tmp_path, [
+        '0  light.position         0 -2 2',
+        '10 light.position         2 -2 4',
+        '5  light.intensity.value  1 2 3',
+        '20 light.intensity.value  4 5 6',
+    ])
+    animation = mi.Animation(scene, fname)
+    assert animation.frame_range() == (0, 20)
+    assert sorted(animation.parameters()) == ['light.intensity.value',
+                                              'light.position']
+
+    params = mi.traverse(scene)
+    animation.set_frame(5)
+    assert dr.allclose(params['light.position'], [1, -2, 3])
+    assert dr.allclose(params['light.intensity.value'], [1, 2, 3])
+
+    # Outside of the keyframes of a parameter, its value remains constant
+    animation.set_frame(15)
+    assert dr.allclose(params['light.position'], [2, -2, 4])
+    assert dr.allclose(params['light.intensity.value'], [3, 4, 5])
+
+    animation.set_frame(-3)
+    assert dr.allclose(params['light.position'], [0, -2, 2])
+    assert dr.allclose(params['light.intensity.value'], [1, 2, 3])
+
+
+def test02_transforms(variants_all_rgb, tmp_path):
+    scene = create_scene()
+    fname = write_keyframes(tmp_path, [
+        '0 sensor.to_world look_at 0 -4 1 0 0 0 0 0 1',
+        '2 sensor.to_world look_at 4 -4 1 4 0 0 0 0 1',
+        '0 sphere.to_world 1 0 0 0  0 1 0 0  0 0 1 0  0 0 0 1',
+        '2 sphere.to_world 1 0 0 2  0 1 0 0  0 0 1 0  0 0 0 1',
+    ])
+    animation = mi.Animation(scene, fname)
+    animation.set_frame(1)
+
+    params = mi.traverse(scene)
+    ref = mi.ScalarTransform4f.look_at([2, -4, 1], [2, 0, 0], [0, 0, 1])
+    assert dr.allclose(params['sensor.to_world'].matrix, ref.matrix)
+    assert dr.allclose(params['sphere.to_world'].matrix,
+                       mi.ScalarTransform4f.translate([1, 0, 0]).matrix)
+
+    # The acceleration data structure was updated for the moved shape
+    si = scene.ray_intersect(mi.Ray3f([1.9, -5, 0], [0, 1, 0]))
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.p, [1.9, -dr.sqrt(1 - 0.9**2), 0])
+
+
+def test03_render(variants_vec_rgb, tmp_path):
+    fname = write_keyframes(tmp_path, [
+        '0 light.position 0 -2 2',
+        '4 light.position 2 -2 2',
+    ])
+    scene = create_scene()
+    animation = mi.Animation(scene, fname)
+    animation.set_frame(2)
+    image = mi.render(scene, seed=1)
+
+    # Equivalent to updating the parameters from Python
+    scene = create_scene()
+    params = mi.traverse(scene)
+    params['light.position'] = mi.Point3f(1, -2, 2)
+    params.update()
+    ref = mi.render(scene, seed=1)
+    assert dr.allclose(image, ref)
+
+
+def test04_errors(variant_scalar_rgb, tmp_path):
+    scene = create_scene()
+    for lines, message in [
+        (['0 light.color 1 1 1'], 'unknown parameter'),
+        (['0 light.position 1 1'], 'must contain 3 values'),
+        (['0 light.position look_at 0 0 0 0 0 1 0 1 0'], 'is not a transformation'),
+        (['0 light.position 1 1 1', '0 light.position 2 2 2'], 'multiple keyframes'),
+        (['0 sensor.to_world look_at 0 -4 1 0 0 0 0 0 1',
+          '2 sensor.to_world 1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1'], 'same form'),
+        (['x light.position 1 1 1'], 'could not parse'),
+    ]:
+        with pytest.raises(RuntimeError, match=message):
+            mi.Animation(scene, write_keyframes(tmp_path, lines))
@@ -3,6 +3,9 @@ import drjit as dr
 import mitsuba as mi
 import math
 import os
+import numpy as np
+
+from mitsuba.scalar_rgb.test.util import simple_scene
 
 
 def test01_construct(variant_scalar_rgb):
@@ -257,3 +260,138 @@ def test06_error_compensation(variants_any_cuda, compensate):
         print(2**24 + 1024)
         print(2**24)
         assert ib.tensor().array[0] ==  2**24 + (1024 if compensate else 0)
+
+
+@pytest.mark.parametrize("filter_name", ['lanczos', 'gaussian'])
+@pytest.mark.parametrize("normalize", [ False, True ])
+def test07_put_wide_filter(variant_scalar_rgb, filter_name, normalize):
+    # Wide filters take the separable fast path in scalar variants, check it
+    # against a brute force reference (including clipping at the boundary)
+    rfilter = mi.load_dict({ 'type' : filter_name, 'stddev' : 0.875 }
+                           if filter_name == 'gaussian' else
+                           { 'type' : filter_name })
+    size = mi.ScalarVector2u(9, 7)
+
+    for pos in [mi.Point2f(4.3, 3.6), mi.Point2f(0.7, 6.2), mi.Point2f(5, 2)]:
+        block = mi.ImageBlock(size=size, offset=[0, 0], channel_count=2,
+                              rfilter=rfilter, border=False,
+                              normalize=normalize, warn_negative=False)
+        block.put(pos=pos, values=[1, 2])
+
+        radius = rfilter.radius()
+        x0, y0 = [int(dr.ceil(pos[i] - .5 - radius)) for i in range(2)]
+        count = int(dr.ceil(2 * radius))
+        factor = 1.0
+        if normalize:
+            wx = sum(rfilter.eval_discretized(x0 + i - pos[0] + .5) for i in range(count))
+            wy = sum(rfilter.eval_discretized(y0 + i - pos[1] + .5) for i in range(count))
+            factor = 1.0 / (wx * wy)
+
+        data = block.tensor().array
+        for y in range(size[1]):
+            for x in range(size[0]):
+                w = rfilter.eval_discretized(x - pos[0] + .5) * \
+                    rfilter.eval_discretized(y - pos[1] + .5) * factor
+                index = (y * size[0] + x) * 2
+                assert dr.allclose(data[index], w, atol=1e-5)
+                assert dr.allclose(data[index + 1], 2 * w, atol=1e-5)
+
+
+@pytest.mark.parametrize("filter_name", ['box', 'gaussian'])
+def test08_put_sorted(variants_vec_rgb, filter_name):
+    # Sorted accumulation must match the regular implementation when groups
+    # of consecutive lanes sample the same pixel
+    rfilter = mi.load_dict({ 'type' : filter_name })
+    size, group = mi.ScalarVector2u(5, 4), 4
+
+    idx = dr.arange(mi.UInt32, dr.prod(size) * group) // group
+    rng = mi.PCG32(size=dr.width(idx))
+    pos = mi.Point2f(mi.Float(idx % size[0]) + rng.next_float32(),
+                     mi.Float(idx // size[0]) + rng.next_float32())
+    values = [rng.next_float32(), mi.Float(1)]
+    active = rng.next_float32() < 0.8
+
+    result = []
+    for sorted in [False, True]:
+        block = mi.ImageBlock(size=size, offset=[0, 0], channel_count=2,
+                              rfilter=rfilter, border=False)
+        block.set_sorted(sorted)
+        block.set_sample_group(group)
+        block.put(pos=pos, values=values, active=active)
+        result.append(block.tensor())
+
+    assert dr.allclose(result[0], result[1])
+
+
+@pytest.mark.parametrize("filter_name", ['box', 'gaussian'])
+def test09_variance(variants_all_rgb, filter_name):
+    # Streaming per-pixel variance of large values with a small spread
+    rfilter = mi.load_dict({ 'type' : filter_name })
+    size, group = mi.ScalarVector2u(3, 2), 16
+    n = dr.prod(size) * group
+
+    np.random.seed(0)
+    idx = np.arange(n) // group
+    pos = np.stack([idx % size[0], idx // size[0]], -1) + np.random.rand(n, 2)
+    values = 1000 + np.random.randn(n)
+
+    block = mi.ImageBlock(size=size, offset=[0, 0], channel_count=3,
+                          rfilter=rfilter, border=False)
+    block.set_variance(source=0, target=1, count=1, weight=2)
+    assert block.variance_count() == 1
+
+    if dr.is_jit_v(mi.Float):
+        # Two wavefronts with half of the samples of every pixel
+        half = group // 2
+        block.set_sample_group(half)
+        for i in range(2):
+            lanes = (np.arange(n) % group) // half == i
+            block.put(pos=mi.Point2f(pos[lanes, 0], pos[lanes, 1]),
+                      values=[mi.Float(values[lanes]), mi.Float(0), mi.Float(1)])
+    else:
+        for i in range(n):
+            block.put(pos=mi.Point2f(pos[i]),
+                      values=[float(values[i]), 0, 1])
+
+    data = np.array(block.tensor())
+    ref = np.var(values.reshape(-1, group), axis=1, ddof=1)
+    assert np.allclose(data[..., 1] / data[..., 2], ref.reshape(size[1], size[0]),
+                       rtol=1e-3)
+
+    # Merging into another block preserves the statistics
+    merged = mi.ImageBlock(size=size, offset=[0, 0], channel_count=3,
+                           rfilter=rfilter, border=False)
+    merged.put_block(block)
+    assert merged.variance_count() == 1
+    assert dr.allclose(merged.tensor(), block.tensor())
+
+
+def test10_moment_variance(variants_all_rgb):
+    def render(variance, spp=32, **objects):
+        integrator = {
+            'type': 'moment',
+            'variance': variance,
+            'nested': {'type': 'path', 'max_depth': 3},
+        }
+        scene = mi.load_dict(simple_scene(integrator, spp=spp, **objects))
+        return scene.integrator().aov_names(), np.array(mi.render(scene, seed=1))
+
+    names, image = render(variance=False)
+    assert names[-3:] == ['m2_nested.X', 'm2_nested.Y', 'm2_nested.Z']
+
+    # Sample variance computed from the first two moments
+    mean, m2 = image[..., -6:-3], image[..., -3:]
+    ref = (m2 - mean**2) * 32 / 31
+
+    names, image = render(variance=True)
+    assert names[-3:] == ['var_nested.X', 'var_nested.Y', 'var_nested.Z']
+    assert np.allclose(image[..., -6:-3], mean)
+    assert np.allclose(image[..., -3:], ref, rtol=1e-3, atol=1e-5)
+
+    # A bright environment seen by every pixel: all samples are identical,
+    # and the streaming variance is exactly zero instead of the cancellation
+    # error of the second moment
+    _, image = render(variance=True, spp=1024, floor=None, sphere=None,
+                      emitter={'type': 'constant', 'radiance': 1000.1})
+    assert np.allclose(image[..., -6:-3], 1000.1)
+    assert np.all(image[..., -3:] == 0)
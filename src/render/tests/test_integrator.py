@@ -0,0 +1,193 @@
+import os
+import threading
+import time
+
+import pytest
+import numpy as np
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import simple_scene, pixel_sample_counts
+
+
+# Pixels of simple_scene(fov=90) that see the environment instead of the floor
+environment_pixels = np.ones((8, 8), dtype=bool)
+environment_pixels[2:6, 2:6] = False
+
+
+def test01_adaptive_sample_counts(variants_all_rgb):
+    integrator = {'type': 'path', 'adaptive_threshold': 0.01, 'adaptive_min_spp': 4}
+    scene = mi.load_dict(simple_scene(integrator, spp=32, fov=90))
+    image = np.array(mi.render(scene))
+    counts = pixel_sample_counts(scene)
+
+    # The environment has zero variance: its pixels stop after the minimum
+    # sample count, and their budget is spent on the noisy floor instead
+    assert np.all(counts[environment_pixels] == 4)
+    assert np.all(counts[~environment_pixels] > 32)
+    assert np.allclose(image[environment_pixels], 1.0)
+
+    # Without a threshold, every pixel receives the same number of samples
+    scene = mi.load_dict(simple_scene({'type': 'path'}, spp=32, fov=90))
+    mi.render(scene)
+    assert np.all(pixel_sample_counts(scene) == 32)
+
+
+def test02_adaptive_matches_uniform(variants_all_rgb):
+    integrator = {'type': 'path', 'adaptive_threshold': 0.01, 'adaptive_min_spp': 4}
+    image = np.array(mi.render(mi.load_dict(simple_scene(integrator, spp=32, fov=90))))
+    image_ref = np.array(mi.render(mi.load_dict(simple_scene(spp=512, fov=90))))
+
+    # Redistributing the samples does not bias the estimate of the floor
+    floor, floor_ref = image[~environment_pixels], image_ref[~environment_pixels]
+    assert np.allclose(np.mean(floor), np.mean(floor_ref), rtol=2e-2)
+
+
+def create_resume_scene():
+    integrator = {'type': 'path', 'samples_per_pass': 1}
+    return mi.load_dict(simple_scene(integrator, spp=128, res=64))
+
+
+def test03_resume_interrupted(variant_scalar_rgb, tmp_path):
+    state_file = str(tmp_path / 'render.state')
+    image_ref = np.array(mi.render(create_resume_scene(), seed=3))
+
+    # Cancel a render once it saved the state of its first pass
+    scene = create_resume_scene()
+    integrator = scene.integrator()
+    integrator.set_state_file(state_file)
+    thread = threading.Thread(target=lambda: mi.render(scene, seed=3))
+    thread.start()
+    while not os.path.exists(state_file) and thread.is_alive():
+        time.sleep(1e-3)
+    integrator.cancel()
+    thread.join()
+    assert os.path.exists(state_file)
+    assert np.min(pixel_sample_counts(scene)) < 128
+
+    # The resumed render matches the uninterrupted one bit for bit
+    scene = create_resume_scene()
+    scene.integrator().set_state_file(state_file)
+    image = np.array(mi.render(scene, seed=3))
+    assert np.array_equal(image, image_ref)
+
+    # .. and so does a render that saves its state after every pass
+    os.remove(state_file)
+    scene = create_resume_scene()
+    scene.integrator().set_state_file(state_file)
+    assert np.array_equal(np.array(mi.render(scene, seed=3)), image_ref)
+
+    # Resuming from a completed render restores the image without sampling
+    scene = create_resume_scene()
+    scene.integrator().set_state_file(state_file)
+    assert np.array_equal(np.array(mi.render(scene, seed=3)), image_ref)
+
+
+def test04_resume_state_mismatch(variant_scalar_rgb, tmp_path):
+    state_file = str(tmp_path / 'render.state')
+
+    scene = create_resume_scene()
+    scene.integrator().set_state_file(state_file)
+    mi.render(scene, seed=3)
+
+    # A different seed cannot continue the saved render
+    scene = create_resume_scene()
+    scene.integrator().set_state_file(state_file)
+    with pytest.raises(RuntimeError, match='different seed'):
+        mi.render(scene, seed=4)
+
+    # .. unless the state is overwritten instead of resumed
+    scene.integrator().set_state_file(state_file, resume=False)
+    image = np.array(mi.render(scene, seed=4))
+    assert np.array_equal(image, np.array(mi.render(create_resume_scene(), seed=4)))
+
+
+@pytest.mark.parametrize('samples_per_pass', [-1, 2])
+def test05_numa_blocks(variant_scalar_rgb, samples_per_pass):
+    def create_scene(numa):
+        integrator = {'type': 'path', 'numa': numa,
+                      'samples_per_pass': samples_per_pass}
+        return mi.load_dict(simple_scene(integrator, spp=8, res=(32, 24)))
+
+    scene, scene_ref = create_scene(True), create_scene(False)
+    image_ref = np.array(mi.render(scene_ref))
+
+    # The per-node image blocks only change the order of the accumulation.
+    # Every sample is merged into the film exactly once, and a second render
+    # does not include leftovers of the previous one.
+    for _ in range(2):
+        image = np.array(mi.render(scene))
+        assert np.all(pixel_sample_counts(scene) == 8)
+        assert np.allclose(image, image_ref, rtol=1e-5, atol=1e-6)
+
+
+def create_budget_scene(time_budget, spp, adaptive_threshold=0.0):
+    integrator = {
+        'type': 'path',
+        'time_budget': time_budget,
+        'adaptive_threshold': adaptive_threshold,
+        'adaptive_min_spp': 4,
+    }
+    # Only the environment is visible, which makes every sample identical
+    return mi.load_dict(simple_scene(integrator, spp=spp, res=32, floor=None,
+                                     sphere=None,
+                                     emitter={'type': 'constant', 'radiance': 0.5}))
+
+
+def test06_time_budget_sample_count(variants_all_rgb):
+    # A generous budget renders the full sample count
+    scene = create_budget_scene(time_budget=60, spp=16)
+    assert np.allclose(np.array(mi.render(scene)), 0.5)
+    assert np.all(pixel_sample_counts(scene) == 16)
+
+    with pytest.raises(RuntimeError, match='time_budget'):
+        create_budget_scene(time_budget=-1, spp=16)
+
+
+def test07_time_budget_expires(variants_all_rgb):
+    # Far too many samples for the budget: the render stops in time, and
+    # every pixel still received at least one sample
+    scene = create_budget_scene(time_budget=0.5, spp=1 << 20)
+    start = time.time()
+    image = np.array(mi.render(scene))
+    assert time.time() - start < 10
+
+    counts = pixel_sample_counts(scene)
+    assert np.min(counts) >= 1 and np.max(counts) < 1 << 20
+    assert np.allclose(image, 0.5)
+
+
+def test08_time_budget_adaptive(variants_all_rgb):
+    # Adaptive sampling stops early once all pixels have converged
+    scene = create_budget_scene(time_budget=60, spp=1 << 16,
+                                adaptive_threshold=0.01)
+    start = time.time()
+    image = np.array(mi.render(scene))
+    assert time.time() - start < 30
+
+    counts = pixel_sample_counts(scene)
+    assert np.min(counts) >= 4 and np.max(counts) < 1 << 16
+    assert np.allclose(image, 0.5)
+
+
+def test09_adaptive_after_special_film(variant_scalar_spectral):
+    # Rendering a film without adaptive sampling support must not disable it
+    # for the other sensors of the scene
+    integrator = {'type': 'path', 'adaptive_threshold': 0.01, 'adaptive_min_spp': 4}
+    spec_sensor = simple_scene(spp=32, fov=90)['sensor']
+    spec_sensor['film'] = {
+        'type': 'specfilm', 'width': 8, 'height': 8,
+        'rfilter': {'type': 'box'},
+        'srf': {'type': 'spectrum', 'value': [(400, 1.0), (700, 1.0)]}
+    }
+    scene = mi.load_dict(simple_scene(integrator, spp=32, fov=90,
+                                      spec_sensor=spec_sensor))
+    special = [mi.has_flag(s.film().flags(), mi.FilmFlags.Special)
+               for s in scene.sensors()]
+    mi.render(scene, sensor=special.index(True))
+
+    sensor = special.index(False)
+    mi.render(scene, sensor=sensor)
+    counts = pixel_sample_counts(scene, sensor)
+    assert np.all(counts[environment_pixels] == 4)
+    assert np.all(counts[~environment_pixels] > 32)
@@ -113,3 +113,384 @@ def test02_depth_scalar_bunny(variant_scalar_rgb):
             res_shadow = scene.ray_test(r)
             assert dr.all(res_shadow == res_naive.is_valid())
             compare_results(res_naive, res)
+
+
+@fresolver_append_path
+def test03_bvh_matches_kdtree(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load(accel_type):
+        return mi.load_dict({
+            'type': 'scene',
+            'accel_type': accel_type,
+            'shape': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            }
+        })
+
+    scene_kd  = load('kdtree')
+    scene_bvh = load('bvh')
+    b = scene_kd.bbox()
+    assert dr.allclose(b.min, scene_bvh.bbox().min)
+    assert dr.allclose(b.max, scene_bvh.bbox().max)
+
+    n = 50
+    inv_n = 1.0 / (n - 1)
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2] - 1]
+            r = mi.Ray3f(o, [0, 0, 1])
+
+            res_kd  = scene_kd.ray_intersect(r)
+            res_bvh = scene_bvh.ray_intersect(r)
+            assert dr.all(scene_bvh.ray_test(r) == res_kd.is_valid())
+            compare_results(res_kd, res_bvh)
+
+
+@fresolver_append_path
+def test04_kdtree_cache(variant_scalar_rgb, tmpdir):
+    import os
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load():
+        return mi.load_dict({
+            'type': 'scene',
+            'kd_cache_dir': str(tmpdir),
+            'shape': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            }
+        })
+
+    scene_built = load()
+    files = os.listdir(str(tmpdir))
+    assert len(files) == 1 and files[0].startswith('kdtree_')
+
+    # The second scene is loaded from the cache and must behave identically
+    scene_cached = load()
+    assert os.listdir(str(tmpdir)) == files
+
+    b = scene_built.bbox()
+    n = 30
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2] - 1]
+            r = mi.Ray3f(o, [0, 0, 1])
+            compare_results(scene_built.ray_intersect(r),
+                            scene_cached.ray_intersect(r))
+
+
+@fresolver_append_path
+def test05_kdtree_coherent_packets(variants_vec_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+    if mi.variant().startswith('cuda'):
+        pytest.skip("Packet traversal is only used by the LLVM backend")
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'shape': {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+        }
+    })
+
+    # Parallel rays on a regular grid form coherent packets, which take the
+    # shared traversal path and must match the per-ray traversal exactly
+    b = scene.bbox()
+    n = 64
+    x, y = dr.meshgrid(dr.linspace(mi.Float, 0, 1, n),
+                       dr.linspace(mi.Float, 0, 1, n))
+    o = mi.Point3f(dr.lerp(b.min[0], b.max[0], x),
+                   dr.lerp(b.min[1], b.max[1], y),
+                   b.min[2] - 1)
+    ray = mi.Ray3f(o, mi.Vector3f(0, 0, 1))
+
+    res_coherent = scene.ray_intersect(ray, mi.RayFlags.All, coherent=True)
+    res_incoherent = scene.ray_intersect(ray, mi.RayFlags.All, coherent=False)
+    compare_results(res_coherent, res_incoherent)
+    assert dr.all(res_coherent.prim_index == res_incoherent.prim_index)
+
+    assert dr.all(scene.ray_test(ray, coherent=True) ==
+                  scene.ray_test(ray, coherent=False))
+
+
+@fresolver_append_path
+def test06_kdtree_packed_leaves(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load(packed):
+        return mi.load_dict({
+            'type': 'scene',
+            'kd_packed_leaves': packed,
+            'bunny': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            },
+            # Leaves that mix triangles with other shapes
+            'sphere': {
+                'type': 'sphere',
+                'center': [0, 0.1, 0],
+                'radius': 0.03
+            }
+        })
+
+    scene_packed = load(True)
+    scene_ref = load(False)
+
+    b = scene_ref.bbox()
+    n = 50
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2] - 1]
+            r = mi.Ray3f(o, [0, 0, 1])
+
+            res_packed = scene_packed.ray_intersect(r)
+            res_ref = scene_ref.ray_intersect(r)
+            compare_results(res_packed, res_ref, atol=1e-5)
+            if dr.all(res_ref.is_valid()):
+                assert dr.all(res_packed.prim_index == res_ref.prim_index)
+            assert dr.all(scene_packed.ray_test(r) == scene_ref.ray_test(r))
+
+
+@pytest.mark.parametrize("instance_count", [1, 3, 4, 6])
+def test07_bvh_instances(variant_scalar_rgb, instance_count):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # One instance per leaf, so that the top level has partially filled nodes
+    def load(accel_type):
+        scene = {
+            'type': 'scene',
+            'accel_type': accel_type,
+            'group': {
+                'type': 'shapegroup',
+                'rect': { 'type': 'rectangle' },
+                'sphere': {
+                    'type': 'sphere',
+                    'center': [0, 0, -1],
+                    'radius': 0.5
+                }
+            }
+        }
+        if accel_type == 'bvh':
+            scene['bvh_max_leaf_size'] = 1
+        for i in range(instance_count):
+            scene[f'instance_{i}'] = {
+                'type': 'instance',
+                'shapegroup': { 'type': 'ref', 'id': 'group' },
+                'to_world': mi.ScalarTransform4f.translate([2.5 * i, 0, 0]) @
+                            mi.ScalarTransform4f.rotate([0, 1, 0], 10 * i) @
+                            mi.ScalarTransform4f.scale(1 + 0.25 * i)
+            }
+        return mi.load_dict(scene)
+
+    scene_kd = load('kdtree')
+    scene_bvh = load('bvh')
+
+    b = scene_kd.bbox()
+    n = 40
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.max[2] + 1]
+            r = mi.Ray3f(o, [0, 0, -1])
+
+            res_kd = scene_kd.ray_intersect(r)
+            res_bvh = scene_bvh.ray_intersect(r)
+            compare_results(res_kd, res_bvh, atol=1e-5)
+            if dr.all(res_kd.is_valid()):
+                assert dr.allclose(res_kd.p, res_bvh.p, atol=1e-5)
+                assert dr.allclose(res_kd.n, res_bvh.n, atol=1e-5)
+            assert dr.all(scene_bvh.ray_test(r) == res_kd.is_valid())
+
+
+@fresolver_append_path
+def test08_accel_stats(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load(accel_type, **kwargs):
+        return mi.load_dict({
+            'type': 'scene',
+            'accel_type': accel_type,
+            'shape': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            },
+            **kwargs
+        })
+
+    for accel_type in ['kdtree', 'bvh']:
+        scene = load(accel_type)
+        stats = scene.accel_stats()
+        assert stats['backend'] == accel_type
+        assert stats['primitive_count'] == scene.shapes()[0].face_count()
+        assert stats['node_count'] > 1
+        assert stats['memory'] > 0
+        assert stats['build_time'] >= 0
+        assert stats['sah_cost'] > 1
+
+        traversal = scene.accel_traversal_stats(ray_count=1000, seed=1)
+        assert traversal['ray_count'] == 1000
+        assert traversal['nodes_per_ray'] >= 1
+        assert traversal['primitives_per_ray'] > 0
+        assert 0 < traversal['hit_fraction'] < 1
+        assert traversal == scene.accel_traversal_stats(ray_count=1000, seed=1)
+
+    # Large leaves require more intersection tests per ray
+    scene = load('bvh', bvh_max_leaf_size=64, bvh_traversal_cost=8.0)
+    traversal = scene.accel_traversal_stats(ray_count=1000, seed=1)
+    assert traversal['primitives_per_ray'] > \
+        load('bvh').accel_traversal_stats(ray_count=1000, seed=1)['primitives_per_ray']
+    assert scene.accel_stats()['node_count'] < load('bvh').accel_stats()['node_count']
+
+
+def test09_kdtree_parallel_nlogn(variant_scalar_rgb):
+    # Large enough for the parallel sorting and partitioning of edge events
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    import numpy as np
+
+    n = 100
+    x, y = np.meshgrid(np.linspace(0, 1, n + 1), np.linspace(0, 1, n + 1))
+    z = 0.1 * np.sin(20 * x) * np.cos(17 * y)
+    v = np.stack([x.ravel(), y.ravel(), z.ravel()], axis=1)
+
+    idx = np.arange((n + 1) * (n + 1)).reshape(n + 1, n + 1)
+    i00, i01 = idx[:-1, :-1].ravel(), idx[:-1, 1:].ravel()
+    i10, i11 = idx[1:, :-1].ravel(), idx[1:, 1:].ravel()
+    f = np.concatenate([np.stack([i00, i01, i10], axis=1),
+                        np.stack([i01, i11, i10], axis=1)])
+
+    def load(accel_type):
+        m = mi.Mesh("heightfield", v.shape[0], f.shape[0])
+        params = mi.traverse(m)
+        params['vertex_positions'] = mi.TensorXf(v.astype(np.float32)).array
+        params['faces'] = mi.TensorXf(f.astype(np.float32)).array
+        params.update()
+
+        props = mi.Properties("scene")
+        props["accel_type"] = accel_type
+        props["_unnamed_0"] = m
+        return mi.Scene(props)
+
+    scene_kd, scene_bvh = load('kdtree'), load('bvh')
+    assert scene_kd.accel_stats()['primitive_count'] == 2 * n * n
+
+    rng = np.random.default_rng(seed=0)
+    for o in rng.uniform(0, 1, size=(1000, 2)):
+        r = mi.Ray3f([o[0], o[1], 1], [0, 0, -1])
+        res_kd  = scene_kd.ray_intersect(r)
+        res_bvh = scene_bvh.ray_intersect(r)
+        assert dr.all(res_kd.is_valid())
+        assert dr.all(scene_kd.ray_test(r))
+        compare_results(res_kd, res_bvh, atol=1e-5)
+
+
+@fresolver_append_path
+def test10_kdtree_cache_concurrent(variant_scalar_rgb, tmpdir):
+    import os
+    from concurrent.futures import ThreadPoolExecutor
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load(_):
+        return mi.load_dict({
+            'type': 'scene',
+            'kd_cache_dir': str(tmpdir),
+            'shape': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            }
+        })
+
+    # Writers of the same entry don't share their temporary files
+    with ThreadPoolExecutor(4) as pool:
+        scenes = list(pool.map(load, range(8)))
+    files = os.listdir(str(tmpdir))
+    assert len(files) == 1 and files[0].endswith('.bin')
+
+    # The resulting entry is intact
+    scene_cached = load(0)
+    r = mi.Ray3f(scene_cached.bbox().center() - [0, 0, 1], [0, 0, 1])
+    compare_results(scenes[0].ray_intersect(r), scene_cached.ray_intersect(r))
+
+
+@pytest.mark.parametrize("shape_count", [1, 2, 3])
+def test11_bvh_partial_nodes(variant_scalar_rgb, shape_count):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # With one primitive per leaf, the root holds a single leaf (one shape)
+    # or 2-3 leaf children, the remaining lanes of the node are unused
+    def load(accel_type):
+        scene = {'type': 'scene', 'accel_type': accel_type}
+        if accel_type == 'bvh':
+            scene['bvh_max_leaf_size'] = 1
+        for i in range(shape_count):
+            scene[f'sphere_{i}'] = {
+                'type': 'sphere',
+                'center': [2.5 * i, 0, 0],
+                'radius': 1
+            }
+        return mi.load_dict(scene)
+
+    scene_kd, scene_bvh = load('kdtree'), load('bvh')
+    assert scene_bvh.accel_stats()['node_count'] == 1
+
+    b = scene_kd.bbox()
+    n = 20
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [(b.min[0] - 1) * (1 - x * inv_n) + (b.max[0] + 1) * x * inv_n,
+                 (b.min[1] - 1) * (1 - y * inv_n) + (b.max[1] + 1) * y * inv_n,
+                 b.min[2] - 1]
+            r = mi.Ray3f(o, [0, 0, 1])
+
+            res_kd  = scene_kd.ray_intersect(r)
+            res_bvh = scene_bvh.ray_intersect(r)
+            compare_results(res_kd, res_bvh, atol=1e-5)
+            assert dr.all(scene_bvh.ray_test(r) == res_kd.is_valid())
+
+
+@pytest.mark.parametrize("shape_count", [1, 3])
+def test12_bvh_traversal_counts(variant_scalar_rgb, shape_count):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = {'type': 'scene', 'accel_type': 'bvh', 'bvh_max_leaf_size': 1}
+    for i in range(shape_count):
+        scene[f'sphere_{i}'] = {
+            'type': 'sphere',
+            'center': [2.5 * i, 0, 0],
+            'radius': 1
+        }
+    scene = mi.load_dict(scene)
+    stats = scene.accel_stats()
+    assert stats['node_count'] == 1
+    assert stats['primitive_count'] == shape_count
+
+    # Every ray visits the root, and each visited leaf child holds a single
+    # sphere, which is tested exactly once
+    traversal = scene.accel_traversal_stats(ray_count=1000, seed=1)
+    assert dr.allclose(traversal['nodes_per_ray'] - traversal['primitives_per_ray'], 1)
+    assert traversal['hit_fraction'] <= traversal['primitives_per_ray'] <= shape_count
+    assert 0 < traversal['hit_fraction'] < 1
@@ -1008,3 +1008,464 @@ def test24_texture_attributes(variants_all_rgb):
 
 
 
+
+
+@fresolver_append_path
+def test25_quantized_attributes(variants_all_rgb):
+    def load(quantize):
+        return mi.load_dict({
+            "type" : "obj",
+            "filename" : "resources/data/common/meshes/rectangle.obj",
+            "quantize" : quantize
+        })
+
+    mesh = load(False)
+    mesh_q = load(True)
+    assert not mesh.quantized()
+    assert mesh_q.quantized()
+    assert mesh_q.has_vertex_normals() and mesh_q.has_vertex_texcoords()
+
+    params = mi.traverse(mesh_q)
+    assert 'vertex_normals' not in params
+    assert 'vertex_texcoords' not in params
+
+    index = dr.arange(mi.UInt32, mesh.vertex_count())
+    assert dr.allclose(mesh.vertex_normal(index), mesh_q.vertex_normal(index), atol=1e-4)
+    assert dr.allclose(mesh.vertex_texcoord(index), mesh_q.vertex_texcoord(index), atol=1e-3)
+
+    ray = mi.Ray3f(mi.Point3f(0.2, 0.3, 5), mi.Vector3f(0, 0, -1))
+    si = mesh.ray_intersect(ray)
+    si_q = mesh_q.ray_intersect(ray)
+    assert dr.allclose(si.n, si_q.n, atol=1e-4)
+    assert dr.allclose(si.sh_frame.n, si_q.sh_frame.n, atol=1e-4)
+    assert dr.allclose(si.uv, si_q.uv, atol=1e-3)
+
+
+@fresolver_append_path
+def test26_write_bundle(variants_all_rgb, tmp_path):
+    filepath = str(tmp_path / 'test_mesh-test26_write_bundle.mibundle')
+    meshes = [
+        mi.load_dict({
+            'type': 'ply',
+            'filename': 'resources/data/tests/ply/rectangle_normals_uv.ply'
+        }),
+        mi.load_dict({
+            'type': 'ply',
+            'filename': 'resources/data/common/meshes/bunny_lowres.ply',
+            'face_normals': True
+        })
+    ]
+    mi.Mesh.write_bundle(filepath, meshes)
+
+    names = ['rectangle_normals_uv.ply', 'bunny_lowres.ply']
+    for index, mesh in enumerate(meshes):
+        for key in [{'shape_index': index}, {'mesh_name': names[index]}]:
+            loaded = mi.load_dict(dict({'type': 'bundle', 'filename': filepath}, **key))
+            assert loaded.vertex_count() == mesh.vertex_count()
+            assert loaded.face_count() == mesh.face_count()
+            assert loaded.has_vertex_normals() == mesh.has_vertex_normals()
+            assert loaded.has_vertex_texcoords() == mesh.has_vertex_texcoords()
+            assert dr.allclose(loaded.bbox().min, mesh.bbox().min)
+            assert dr.allclose(loaded.bbox().max, mesh.bbox().max)
+
+            params, params_loaded = mi.traverse(mesh), mi.traverse(loaded)
+            for name in ['vertex_positions', 'vertex_normals', 'vertex_texcoords', 'faces']:
+                if name in params:
+                    assert dr.all(params_loaded[name] == params[name])
+
+    # Transformations are applied on top of the stored world-space buffers
+    loaded = mi.load_dict({
+        'type': 'bundle',
+        'filename': filepath,
+        'to_world': mi.ScalarTransform4f.translate([1, 2, 3])
+    })
+    assert dr.allclose(loaded.bbox().min, meshes[0].bbox().min + [1, 2, 3])
+
+    with pytest.raises(RuntimeError, match='out of range'):
+        mi.load_dict({'type': 'bundle', 'filename': filepath, 'shape_index': 2})
+
+
+def test27_obj_parallel_parse(variant_scalar_rgb, tmp_path):
+    # Large enough to be parsed as several chunks (> 4 MiB)
+    n = 400
+    lines = []
+    for y in range(n + 1):
+        for x in range(n + 1):
+            lines.append('v %f %f 0' % (x / n, y / n))
+            lines.append('vt %f %f' % (x / n, y / n))
+    for y in range(n):
+        for x in range(n):
+            i = y * (n + 1) + x + 1
+            lines.append('f %i/%i %i/%i %i/%i %i/%i' % (i, i, i + 1, i + 1,
+                         i + n + 2, i + n + 2, i + n + 1, i + n + 1))
+    filepath = str(tmp_path / 'test_mesh-test27_obj_parallel_parse.obj')
+    with open(filepath, 'w') as f:
+        f.write('\n'.join(lines))
+
+    mesh = mi.load_dict({'type': 'obj', 'filename': filepath, 'flip_tex_coords': False})
+
+    # Vertices that are shared across chunk boundaries must be merged
+    assert mesh.vertex_count() == (n + 1) ** 2
+    assert mesh.face_count() == 2 * n * n
+    assert dr.allclose(mesh.surface_area(), 1.0)
+
+    # Vertices are numbered in the order of their first occurrence
+    params = mi.traverse(mesh)
+    faces = params['faces']
+    positions = dr.unravel(mi.Point3f, params['vertex_positions'])
+    texcoords = dr.unravel(mi.Point2f, params['vertex_texcoords'])
+    assert dr.all(faces[0:6] == mi.UInt32([0, 1, 2, 0, 2, 3]))
+    assert dr.allclose(positions.x, texcoords.x) and dr.allclose(positions.y, texcoords.y)
+
+
+def write_serialized_v5(filepath, meshes):
+    """Write (name, positions, faces) tuples as a block-compressed serialized file"""
+    fs = mi.FileStream(filepath, mi.FileStream.ETruncReadWrite)
+    fs.set_byte_order(mi.Stream.ELittleEndian)
+    offsets = []
+    for name, positions, faces in meshes:
+        offsets.append(fs.tell())
+        fs.write_uint16(0x041C)
+        fs.write_uint16(0x0005)
+        zs = mi.BlockZStream(fs, block_size=16)
+        zs.set_byte_order(mi.Stream.ELittleEndian)
+        zs.write_uint32(0x1000) # Single precision, no normals/texcoords
+        zs.write(name.encode() + b'\0')
+        zs.write_uint64(len(positions))
+        zs.write_uint64(len(faces))
+        zs.write(positions.tobytes())
+        zs.write(faces.tobytes())
+        zs.close()
+    for offset in offsets:
+        fs.write_uint64(offset)
+    fs.write_uint32(len(meshes))
+    fs.close()
+
+
+def test28_serialized_block_compressed(variant_scalar_rgb, tmp_path):
+    import numpy as np
+    filepath = str(tmp_path / 'test_mesh-test28_serialized_block_compressed.serialized')
+    positions = np.array([[0, 0, 0], [1, 0, 0], [1, 1, 0], [0, 1, 0]], dtype=np.float32)
+    faces = np.array([[0, 1, 2], [0, 2, 3]], dtype=np.uint32)
+    write_serialized_v5(filepath, [('quad', positions, faces)])
+
+    mesh = mi.load_dict({'type': 'serialized', 'filename': filepath})
+    assert mesh.vertex_count() == 4 and mesh.face_count() == 2
+    params = mi.traverse(mesh)
+    assert dr.allclose(params['vertex_positions'], positions.ravel())
+    assert dr.all(params['faces'] == mi.UInt32(faces.ravel()))
+
+
+def test29_serialized_load_all(variants_all_rgb, tmp_path):
+    import numpy as np
+    filepath = str(tmp_path / 'test_mesh-test29_serialized_load_all.serialized')
+    faces = np.array([[0, 1, 2]], dtype=np.uint32)
+    meshes = []
+    for i in range(8):
+        positions = np.array([[i, 0, 0], [i + 1, 0, 0], [i, 1, 0]], dtype=np.float32)
+        meshes.append(('tri_%i' % i, positions, faces))
+    write_serialized_v5(filepath, meshes)
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'shape': {
+            'type': 'serialized',
+            'filename': filepath,
+            'load_all': True
+        }
+    })
+    shapes = scene.shapes()
+    assert len(shapes) == 8
+    assert sorted(s.id() for s in shapes) == sorted('shape_%i' % i for i in range(8))
+    for shape in shapes:
+        i = int(shape.id().split('_')[-1])
+        assert dr.allclose(shape.bbox().min, [i, 0, 0])
+
+    # Individual meshes are read from the cached mapping of the file
+    for i in [5, 2]:
+        mesh = mi.load_dict({'type': 'serialized', 'filename': filepath, 'shape_index': i})
+        assert dr.allclose(mesh.bbox().min, [i, 0, 0])
+
+    with pytest.raises(RuntimeError, match='out of range'):
+        mi.load_dict({'type': 'serialized', 'filename': filepath, 'shape_index': 8})
+
+
+def test30_vertex_tangents(variants_all_rgb, tmp_path):
+    # Strip bent around the Y axis, made of two quads sharing the column at x=0
+    angles = [-0.5, 0.0, 0.5]
+    filepath = str(tmp_path / 'test_mesh-test30_vertex_tangents.obj')
+    with open(filepath, 'w') as f:
+        for y in [0, 1]:
+            for i, a in enumerate(angles):
+                f.write('v %f %f %f\n' % (np.sin(a), y, np.cos(a)))
+                f.write('vt %f %f\n' % (i * 0.5, y))
+                f.write('vn %f %f %f\n' % (np.sin(a), 0, np.cos(a)))
+        for i in range(2):
+            for face in [(i, i + 1, i + 4), (i, i + 4, i + 3)]:
+                f.write('f %s\n' % ' '.join('%i/%i/%i' % ((k + 1,) * 3) for k in face))
+
+    def load(tangents):
+        return mi.load_dict({
+            'type': 'obj',
+            'filename': filepath,
+            'tangents': tangents
+        })
+
+    mesh = load(False)
+    mesh_t = load(True)
+    assert not mesh.has_vertex_tangents()
+    assert mesh_t.has_vertex_tangents()
+
+    # Hit the strip on both sides of the shared edge
+    ray = mi.Ray3f(mi.Point3f([-1e-3, 1e-3], [0.5, 0.5], [5, 5]), mi.Vector3f(0, 0, -1))
+    si = mesh.ray_intersect(ray)
+    si_t = mesh_t.ray_intersect(ray)
+    assert dr.allclose(si.p, si_t.p)
+    assert dr.allclose(si.sh_frame.n, si_t.sh_frame.n)
+
+    # Face tangents are discontinuous, interpolated tangents are not
+    def normalize(v):
+        v = np.array(v)
+        return v / np.linalg.norm(v, axis=0)
+
+    s = normalize(si.dp_du)
+    s_t = normalize(si_t.dp_du)
+    assert not np.allclose(s[:, 0], s[:, 1], atol=1e-2)
+    assert np.allclose(s_t[:, 0], s_t[:, 1], atol=1e-2)
+    assert np.allclose(s_t[:, 0], [1, 0, 0], atol=1e-2)
+
+    # The tangent frame is orthogonal to the shading normal and right-handed
+    assert dr.allclose(dr.dot(si_t.dp_du, si_t.sh_frame.n), 0, atol=1e-5)
+    assert dr.allclose(dr.dot(si_t.dp_dv, si_t.sh_frame.n), 0, atol=1e-5)
+    handedness = dr.dot(dr.cross(si.dp_du, si.dp_dv), si.sh_frame.n)
+    handedness_t = dr.dot(dr.cross(si_t.dp_du, si_t.dp_dv), si_t.sh_frame.n)
+    assert dr.all(handedness * handedness_t > 0)
+
+    # The shading frame follows the tangent
+    assert dr.allclose(si_t.sh_frame.s, dr.normalize(si_t.dp_du), atol=1e-5)
+
+
+@fresolver_append_path
+def test31_vertex_tangents_flat(variants_all_rgb):
+    # On a flat mesh, the precomputed tangents match the per-face derivatives
+    def load(tangents):
+        return mi.load_dict({
+            "type" : "obj",
+            "filename" : "resources/data/common/meshes/rectangle.obj",
+            "tangents" : tangents
+        })
+
+    mesh = load(False)
+    mesh_t = load(True)
+
+    ray = mi.Ray3f(mi.Point3f([0.2, -0.7], [0.3, 0.4], [5, 5]), mi.Vector3f(0, 0, -1))
+    si = mesh.ray_intersect(ray)
+    si_t = mesh_t.ray_intersect(ray)
+    assert dr.allclose(si.dp_du, si_t.dp_du, atol=1e-5)
+    assert dr.allclose(si.dp_dv, si_t.dp_dv, atol=1e-5)
+
+
+def test32_alias_sampling(variants_vec_rgb):
+    # Alias table triangle sampling produces the same area density
+    def load(alias_sampling):
+        return mi.load_dict({
+            "type" : "obj",
+            "filename" : "resources/data/common/meshes/sphere.obj",
+            "alias_sampling" : alias_sampling
+        })
+
+    mesh = load(False)
+    mesh_a = load(True)
+
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, 10000)
+    ps = mesh_a.sample_position(0, sampler.next_2d())
+    assert dr.allclose(ps.pdf, 1.0 / mesh.surface_area())
+    assert dr.allclose(mesh_a.pdf_position(ps), ps.pdf)
+
+    # Samples lie on the surface
+    ray = mi.Ray3f(ps.p + ps.n, -ps.n)
+    si = mesh_a.ray_intersect(ray)
+    assert dr.allclose(si.p, ps.p, atol=1e-3)
+
+
+@pytest.mark.parametrize('direction_sampling', ['solid_angle', 'projected_solid_angle'])
+def test33_spherical_triangle_sampling(variants_vec_rgb, direction_sampling):
+    # Solid angle sampling of emissive faces agrees with area sampling
+    def load(direction_sampling):
+        return mi.load_dict({
+            "type" : "obj",
+            "filename" : "resources/data/common/meshes/sphere.obj",
+            "direction_sampling" : direction_sampling,
+            "emitter" : {"type" : "area"}
+        })
+
+    mesh = load('area')
+    mesh_s = load(direction_sampling)
+
+    n = 200000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    sample = sampler.next_2d()
+
+    it = dr.zeros(mi.Interaction3f, n)
+    it.p = [0.2, -0.3, 1.6]
+    it.n = dr.normalize(mi.Vector3f(0.3, 0.2, -1))
+
+    ds = mesh_s.sample_direction(it, sample)
+    assert dr.allclose(ds.pdf, mesh_s.pdf_direction(it, ds), rtol=1e-3)
+
+    # Same expected (projected) solid angle estimates
+    def estimate(shape):
+        ds = shape.sample_direction(it, sample)
+        cos_theta = dr.abs_dot(ds.d, it.n)
+        return dr.mean(dr.select(ds.pdf > 0, cos_theta / ds.pdf, 0.0))
+
+    assert dr.allclose(estimate(mesh_s), estimate(mesh), rtol=2e-2)
+
+
+def test34_merge_many(variants_all_rgb):
+    # Merging many meshes yields a single mesh with correctly offset faces
+    n = 20
+    shapes = { 'type': 'merge' }
+    for i in range(n):
+        shapes['cube_%02i' % i] = {
+            'type': 'cube',
+            'to_world': mi.ScalarTransform4f().translate([3 * i, 0, 0])
+        }
+
+    scene = mi.load_dict({ 'type': 'scene', 'merged': shapes })
+    assert len(scene.shapes()) == 1
+
+    mesh = scene.shapes()[0]
+    cube = mi.load_dict({ 'type': 'cube' })
+    assert mesh.vertex_count() == n * cube.vertex_count()
+    assert mesh.face_count() == n * cube.face_count()
+    assert dr.allclose(mesh.bbox().min, [-1, -1, -1])
+    assert dr.allclose(mesh.bbox().max, [3 * (n - 1) + 1, 1, 1])
+
+    assert dr.all(dr.max(mesh.faces_buffer()) == mesh.vertex_count() - 1)
+
+    # Every cube is hit at its front face
+    x = [3 * i + 0.5 for i in range(n)]
+    ray = mi.Ray3f(mi.Point3f(x, 0.5, 5), mi.Vector3f(0, 0, -1))
+    si = scene.ray_intersect(ray)
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.t, 4)
+
+
+def test35_mesh_from_buffers(variants_all_rgb):
+    import numpy as np
+    import gc
+
+    positions = np.array([[0, 0, 0], [1, 0, 0], [1, 1, 0], [0, 1, 0]], dtype=np.float32)
+    faces = np.array([[0, 1, 2], [0, 2, 3]], dtype=np.uint32)
+    texcoords = np.array([[0, 0], [1, 0], [1, 1], [0, 1]], dtype=np.float64)
+
+    mesh = mi.Mesh("quad", positions, faces, vertex_texcoords=texcoords)
+    assert mesh.vertex_count() == 4
+    assert mesh.face_count() == 2
+    assert mesh.has_vertex_texcoords()
+    assert not mesh.has_vertex_normals()
+    assert dr.allclose(mesh.bbox().min, [0, 0, 0])
+    assert dr.allclose(mesh.bbox().max, [1, 1, 0])
+    assert dr.allclose(mesh.vertex_texcoord(2), [1, 1])
+
+    # The mesh keeps the external memory alive
+    del positions, faces, texcoords
+    gc.collect()
+
+    scene = mi.load_dict({ 'type': 'scene', 'quad': mesh })
+    si = scene.ray_intersect(mi.Ray3f([0.25, 0.75, 1], [0, 0, -1]))
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.t, 1)
+    assert dr.allclose(si.uv, [0.25, 0.75])
+
+    # Dr.Jit buffers are referenced as well
+    mesh2 = mi.Mesh("quad", mesh.vertex_positions_buffer(), mesh.faces_buffer())
+    assert mesh2.face_count() == 2
+
+    with pytest.raises(RuntimeError, match="three entries per vertex"):
+        mi.Mesh("invalid", np.zeros(5, dtype=np.float32), np.zeros(3, dtype=np.uint32))
+
+
+def test36_normal_weighting_scheme_vec(variants_vec_rgb):
+    # Same configuration as test04, with the gather-based JIT implementation
+    m = mi.Mesh("MyMesh", 5, 2, has_vertex_normals=True)
+    params = mi.traverse(m)
+
+    a, b = 1.0, 0.5
+    params['vertex_positions'] = mi.Float([0, 0, 0, -a, 1, 0, a, 1, 0, -b, 0, 1, b, 0, 1])
+    params['faces'] = mi.UInt32([0, 1, 2, 0, 3, 4])
+    params.update()
+
+    n0 = [0.0, 0.0, -1.0]
+    n1 = [0.0, 1.0, 0.0]
+    angle_0 = dr.pi / 2.0
+    angle_1 = dr.acos(3.0 / 5.0)
+    n2 = [n0[i] * angle_0 + n1[i] * angle_1 for i in range(3)]
+    norm = dr.sqrt(sum(v * v for v in n2))
+    n2 = [v / norm for v in n2]
+    expected = n2 + n0 + n0 + n1 + n1
+
+    assert dr.allclose(params['vertex_normals'], expected, atol=5e-4)
+
+    # The adjacency is rebuilt when the topology changes
+    params['faces'] = mi.UInt32([0, 1, 2, 0, 4, 3])
+    params.update()
+    n2 = [n0[i] * angle_0 - n1[i] * angle_1 for i in range(3)]
+    norm = dr.sqrt(sum(v * v for v in n2))
+    n2 = [v / norm for v in n2]
+    expected = n2 + n0 + n0 + [-v for v in n1] * 2
+
+    assert dr.allclose(params['vertex_normals'], expected, atol=5e-4)
+
+    # Differentiable positions use the scatter-based implementation
+    if dr.is_diff_v(mi.Float):
+        positions = mi.Float(params['vertex_positions'])
+        dr.enable_grad(positions)
+        params['vertex_positions'] = positions
+        params.update()
+        assert dr.allclose(dr.detach(params['vertex_normals']), expected, atol=5e-4)
+
+
+def test37_write_ply_batches(variants_all_rgb, tmp_path):
+    # Large enough for the records to span several encoding buffers
+    import numpy as np
+    np.random.seed(0)
+    vertex_count, face_count = 400000, 700000
+    filepath = str(tmp_path / 'test_mesh-test37_write_ply_batches.ply')
+
+    mesh = mi.Mesh("MyMesh", vertex_count, face_count,
+                   has_vertex_normals=True, has_vertex_texcoords=True)
+    params = mi.traverse(mesh)
+    Float = type(params['vertex_positions'])
+    UInt32 = type(params['faces'])
+
+    positions = np.random.uniform(size=3 * vertex_count)
+    normals = np.tile([0.0, 0.0, 1.0], vertex_count)
+    texcoords = np.random.uniform(size=2 * vertex_count)
+    faces = np.random.randint(0, vertex_count, size=3 * face_count)
+    vertex_colors = np.random.uniform(size=3 * vertex_count)
+    face_values = np.random.uniform(size=3 * face_count)
+
+    params['vertex_positions'] = Float(positions)
+    params['vertex_normals'] = Float(normals)
+    params['vertex_texcoords'] = Float(texcoords)
+    params['faces'] = UInt32(faces)
+    params.update()
+    mesh.add_attribute('vertex_color', 3, Float(vertex_colors))
+    mesh.add_attribute('face_value', 3, Float(face_values))
+
+    mesh.write_ply(filepath)
+    mesh_saved = mi.load_dict({
+        'type': 'ply',
+        'filename': filepath
+    })
+    params_saved = mi.traverse(mesh_saved)
+
+    assert dr.allclose(params_saved['vertex_positions'], Float(positions))
+    assert dr.allclose(params_saved['vertex_texcoords'], Float(texcoords))
+    assert dr.all(params_saved['faces'] == UInt32(faces))
+    assert dr.allclose(params_saved['vertex_color'], Float(vertex_colors))
+    assert dr.allclose(params_saved['face_value'], Float(face_values))
@@ -0,0 +1,73 @@
+import pytest
+import mitsuba as mi
+import drjit as dr
+
+from mitsuba.scalar_rgb.test.util import find_resource
+
+
+def skip_if_no_oidn():
+    if not hasattr(mi, 'OIDNDenoiser'):
+        pytest.skip('Mitsuba was compiled without Open Image Denoise support')
+
+
+def render_cbox(spp):
+    scene = mi.load_file(find_resource("resources/data/scenes/cbox/cbox-rgb.xml"), res=64)
+    sensor = scene.sensors()[0]
+    integrator = mi.load_dict({
+        'type': 'aov',
+        'aovs': 'albedo:albedo,sh_normal:sh_normal',
+        'img': {
+            'type': 'path',
+            'max_depth' : 6,
+        }
+    })
+    mi.render(scene, spp=spp, integrator=integrator, sensor=sensor)
+    return sensor.film().bitmap()
+
+
+def test01_denoiser_construct(variants_all_scalar):
+    skip_if_no_oidn()
+    input_res = [33, 18]
+
+    assert (
+        "OIDNDenoiser[\n  input_size = [33, 18],\n  albedo = 0,\n  " +
+        "normals = 0\n]" == str(mi.OIDNDenoiser(input_res))
+    )
+
+    with pytest.raises(Exception) as e:
+        mi.OIDNDenoiser(input_res, albedo=False, normals=True)
+    e.match("The denoiser cannot use normals to guide its process without " +
+            "also providing albedo information!")
+
+
+def test02_denoiser_denoise_tensor(variants_all_scalar):
+    skip_if_no_oidn()
+    noisy = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/noisy.exr")))
+    albedo = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/albedo.exr")))
+
+    denoiser = mi.OIDNDenoiser(noisy.shape[:2], True)
+    denoised = denoiser(noisy, albedo)
+    assert denoised.shape == noisy.shape
+
+    # Alpha is passed through unchanged
+    if noisy.shape[2] == 4:
+        assert dr.allclose(denoised[..., 3], noisy[..., 3])
+
+    with pytest.raises(Exception) as e:
+        denoiser(noisy)
+    e.match("An albedo layer must be specified")
+
+
+def test03_denoiser_reduces_error(variant_scalar_rgb):
+    skip_if_no_oidn()
+    ref = render_cbox(256).split()[0][1]
+    noisy = render_cbox(4)
+
+    denoiser = mi.OIDNDenoiser(noisy.size(), True, True)
+    denoised = denoiser(noisy, "albedo", "sh_normal")
+    assert denoised.pixel_format() == mi.Bitmap.PixelFormat.RGBA
+
+    ref = mi.TensorXf(ref)[..., :3]
+    error_noisy = dr.mean(dr.abs(mi.TensorXf(noisy.split()[0][1])[..., :3] - ref).array)
+    error_denoised = dr.mean(dr.abs(mi.TensorXf(denoised)[..., :3] - ref).array)
+    assert error_denoised[0] < error_noisy[0]
@@ -94,7 +94,7 @@ def test01_denoiser_construct(variants_any_cuda):
 
     assert (
         "OptixDenoiser[\n  input_size = [33, 18],\n  albedo = 0,\n  " +
-        "normals = 0,\n  temporal = 0\n]" == str(mi.OptixDenoiser(input_res))
+        "normals = 0,\n  temporal = 0,\n  pending = 0\n]" == str(mi.OptixDenoiser(input_res))
     )
 
     with pytest.raises(Exception) as e:
@@ -192,6 +192,33 @@ def test05_denoiser_denoise_temporal(variant_cuda_ad_rgb):
     assert dr.allclose(denoised_array, ref_array)
 
 
+@skip_if_wrong_driver_version
+def test06_denoiser_submit_temporal(variant_cuda_ad_rgb):
+    noisy = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/noisy.exr")))
+    albedo = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/albedo.exr")))
+    normals = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/normals.exr")))
+    flow = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/flow.exr")))
+    normals = fix_normals(mi.TensorXf(normals))
+
+    # The first submitted frame uses the noisy input as previous frame
+    denoiser = mi.OptixDenoiser(noisy.shape[:2], True, True, True)
+    ref = denoiser(noisy, False, albedo, normals, flow=flow, previous_denoised=noisy)
+    ref_2 = denoiser(noisy, False, albedo, normals, flow=flow, previous_denoised=ref)
+
+    denoiser = mi.OptixDenoiser(noisy.shape[:2], True, True, True)
+    denoiser.submit(noisy, False, albedo, normals, flow=flow)
+    denoiser.submit(noisy, False, albedo, normals, flow=flow)
+    assert denoiser.pending() == 2
+
+    assert dr.allclose(denoiser.result().array, ref.array)
+    assert dr.allclose(denoiser.result().array, ref_2.array)
+    assert denoiser.pending() == 0
+
+    with pytest.raises(Exception) as e:
+        denoiser.result()
+    e.match("no frame is pending")
+
+
 @skip_if_wrong_driver_version
 def test05_denoiser_denoise_multichannel_bitmap(variant_cuda_ad_rgb):
     ref = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/ref_normals.exr")))
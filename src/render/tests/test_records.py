@@ -92,7 +92,8 @@ def test04_direction_sample_construction_single(variant_scalar_rgb):
   delta = 0,
   emitter = nullptr,
   d = [0, 42, -1],
-  dist = 0.13
+  dist = 0.13,
+  prim_index = 0
 ]"""
 
     # Construct from two interactions: ds.d should start from the reference its.
@@ -269,6 +269,237 @@ def test_render(variant, scene_fname, integrator_type, jit_flags_key):
         assert False
 
 
+# List of stress scenes of the performance regression tests, see perf_scene()
+PERF_SCENES = ['instances', 'many_lights', 'dense_volume', 'hair', 'large_texture']
+
+# Recorded throughput (samples per second) for every hardware class, variant
+# and stress scene. Regenerate using "python test_renders.py --perf".
+PERF_BASELINES = join(dirname(__file__), 'perf_baselines.json')
+
+# Maximum tolerated relative throughput regression
+PERF_TOLERANCE = float(os.environ.get('MI_PERF_TOLERANCE', 0.2))
+
+# Film resolution and samples per pixel of the performance tests
+PERF_RES = 64
+PERF_SPP = {'scalar': 4, 'jit': 64}
+
+
+def perf_hardware_class():
+    """
+    Return the name under which throughput baselines are recorded. Machines
+    of a render farm should set the ``MI_PERF_HARDWARE`` environment variable
+    to a common name, as the default only distinguishes the platform, CPU and
+    thread count.
+    """
+    import platform
+    name = os.environ.get('MI_PERF_HARDWARE')
+    if name is None:
+        name = '%s-%s-%s-%ithreads' % (platform.system(), platform.machine(),
+                                       platform.processor() or 'cpu',
+                                       os.cpu_count())
+    return name
+
+
+def perf_scene(name, tmp_dir):
+    """Create the stress scene with the given name (see PERF_SCENES)"""
+    rng = np.random.default_rng(seed=0)
+    T = mi.ScalarTransform4f
+
+    scene = {
+        'type': 'scene',
+        'integrator': {'type': 'path', 'max_depth': 8},
+        'sensor': {
+            'type': 'perspective',
+            'fov': 45,
+            'to_world': T.look_at(origin=[0, -12, 6], target=[0, 0, 0], up=[0, 0, 1]),
+            'sampler': {'type': 'independent'},
+            'film': {
+                'type': 'hdrfilm',
+                'width': PERF_RES, 'height': PERF_RES,
+                'rfilter': {'type': 'box'}
+            },
+        },
+        'floor': {
+            'type': 'rectangle',
+            'to_world': T.translate([0, 0, -1]) @ T.scale(20),
+            'bsdf': {'type': 'diffuse'},
+        },
+    }
+
+    if name != 'many_lights':
+        scene['sun'] = {'type': 'directional', 'direction': [1, 1, -2],
+                        'irradiance': {'type': 'rgb', 'value': 3}}
+        scene['sky'] = {'type': 'constant', 'radiance': {'type': 'rgb', 'value': 0.2}}
+
+    if name == 'instances':
+        # Many overlapping instances of a shape group
+        scene['group'] = {
+            'type': 'shapegroup',
+            'cube': {'type': 'cube', 'to_world': T.scale(0.3),
+                     'bsdf': {'type': 'roughconductor'}},
+            'sphere': {'type': 'sphere', 'center': [0, 0, 0.5], 'radius': 0.3},
+        }
+        for i in range(4096):
+            p = rng.uniform([-8, -8, -1], [8, 8, 3])
+            scene[f'instance_{i}'] = {
+                'type': 'instance',
+                'shapegroup': {'type': 'ref', 'id': 'group'},
+                'to_world': T.translate(p.tolist()) @
+                            T.rotate(rng.normal(size=3).tolist(), rng.uniform(0, 360)),
+            }
+    elif name == 'many_lights':
+        # Hundreds of small area lights
+        for i in range(512):
+            p = rng.uniform([-8, -8, 0], [8, 8, 4])
+            scene[f'light_{i}'] = {
+                'type': 'sphere', 'center': p.tolist(), 'radius': 0.05,
+                'emitter': {'type': 'area', 'radiance': {
+                    'type': 'rgb', 'value': rng.uniform(0, 50, size=3).tolist()}},
+            }
+        scene['blocker'] = {'type': 'sphere', 'radius': 2,
+                            'bsdf': {'type': 'roughplastic'}}
+    elif name == 'dense_volume':
+        # Optically thick heterogeneous medium
+        density = rng.uniform(0, 1, size=(64, 64, 64, 1)).astype(np.float32)
+        scene['integrator'] = {'type': 'volpath', 'max_depth': 64}
+        scene['volume'] = {
+            'type': 'cube',
+            'to_world': T.scale(3),
+            'bsdf': {'type': 'null'},
+            'interior': {
+                'type': 'heterogeneous',
+                'albedo': 0.95,
+                'scale': 20,
+                'sigma_t': {'type': 'gridvolume', 'grid': mi.VolumeGrid(density),
+                            'to_world': T.translate([-3, -3, -3]) @ T.scale(6)},
+            },
+        }
+    elif name == 'hair':
+        # Thousands of thin curves covering a sphere
+        fname = join(str(tmp_dir), 'hair.txt')
+        with open(fname, 'w') as f:
+            for i in range(8192):
+                d = rng.normal(size=3)
+                d /= np.linalg.norm(d)
+                bend = rng.normal(size=3) * 0.2
+                for j in range(6):
+                    t = j / 5
+                    p = d * (2 + t) + bend * t * t
+                    f.write('%f %f %f %f\n' % (p[0], p[1], p[2], 0.01 * (1 - 0.8 * t)))
+                f.write('\n')
+        scene['hair'] = {'type': 'bsplinecurve', 'filename': fname,
+                         'bsdf': {'type': 'roughconductor', 'alpha': 0.3}}
+        scene['head'] = {'type': 'sphere', 'radius': 2}
+    elif name == 'large_texture':
+        # Incoherent lookups into a texture that does not fit into the caches
+        data = rng.uniform(size=(4096, 4096, 3)).astype(np.float32)
+        scene['texture'] = {'type': 'bitmap', 'bitmap': mi.Bitmap(data),
+                            'to_uv': T.scale([13, 17, 1])}
+        scene['floor']['bsdf'] = {
+            'type': 'diffuse',
+            'reflectance': {'type': 'ref', 'id': 'texture'}}
+        scene['sphere'] = {
+            'type': 'sphere', 'radius': 3,
+            'bsdf': {'type': 'principled',
+                     'base_color': {'type': 'ref', 'id': 'texture'}}}
+    else:
+        raise ValueError('Unknown performance scene "%s"' % name)
+
+    return mi.load_dict(scene)
+
+
+def perf_measure(scene, runs=3):
+    """
+    Return the throughput of the scene in samples per second (best of several
+    runs). A first render, which includes the compilation of the kernels in
+    JIT variants, is excluded from the measurement.
+    """
+    import time
+    is_jit = 'cuda' in mi.variant() or 'llvm' in mi.variant()
+    spp = PERF_SPP['jit' if is_jit else 'scalar']
+
+    def render(seed):
+        image = mi.render(scene, spp=spp, seed=seed)
+        dr.eval(image)
+        if is_jit:
+            dr.sync_thread()
+
+    render(0)
+    best = float('inf')
+    for i in range(runs):
+        start = time.perf_counter()
+        render(i + 1)
+        best = min(best, time.perf_counter() - start)
+
+    return PERF_RES * PERF_RES * spp / best
+
+
+def perf_variants():
+    """Variants whose throughput is tracked (double precision is excluded)"""
+    return [v for v in mi.variants() if not v.endswith('double')]
+
+
+def load_perf_baselines():
+    if not exists(PERF_BASELINES):
+        return {}
+    import json
+    with open(PERF_BASELINES) as f:
+        return json.load(f)
+
+
+@pytest.mark.slow
+@pytest.mark.perf
+@pytest.mark.parametrize("variant, scene_name",
+                         [(v, s) for v in perf_variants() for s in PERF_SCENES])
+def test_performance(variant, scene_name, tmp_path):
+    if os.environ.get('MI_PERF_TESTS', '0') == '0':
+        pytest.skip('Performance tests are disabled (set MI_PERF_TESTS=1)')
+
+    # Once enabled, a missing baseline is an error rather than a silent skip
+    hardware = perf_hardware_class()
+    baseline = load_perf_baselines().get(hardware, {}).get(variant, {}).get(scene_name)
+    if baseline is None:
+        pytest.fail('No throughput baseline for scene "%s", variant "%s" and '
+                    'hardware class "%s". Record one using "python '
+                    'test_renders.py --perf".' % (scene_name, variant, hardware))
+
+    mi.set_variant(variant)
+    throughput = perf_measure(perf_scene(scene_name, tmp_path))
+    print('%s (%s): %.3g samples/s, baseline: %.3g samples/s' %
+          (scene_name, variant, throughput, baseline))
+
+    assert throughput >= baseline * (1 - PERF_TOLERANCE), \
+        'Throughput regressed by %.1f%% (tolerance: %.1f%%)' % (
+            100 * (1 - throughput / baseline), 100 * PERF_TOLERANCE)
+
+
+def record_perf_baselines(scene=None, variant=None):
+    """Measure and store the throughput baselines of the current machine"""
+    import json
+    import tempfile
+
+    hardware = perf_hardware_class()
+    baselines = load_perf_baselines()
+    entry = baselines.setdefault(hardware, {})
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for variant_ in perf_variants():
+            if variant is not None and variant != variant_:
+                continue
+            mi.set_variant(variant_)
+            for scene_name in PERF_SCENES:
+                if scene is not None and scene != scene_name:
+                    continue
+                throughput = perf_measure(perf_scene(scene_name, tmp_dir))
+                entry.setdefault(variant_, {})[scene_name] = throughput
+                print(f'{hardware} - {variant_} - {scene_name}: {throughput:.3g} samples/s')
+
+    with open(PERF_BASELINES, 'w') as f:
+        json.dump(baselines, f, indent=2, sort_keys=True)
+        f.write('\n')
+    print(f'Saved throughput baselines to: {PERF_BASELINES}')
+
+
 def render_ref_images(scenes, spp, overwrite, scene=None, variant=None):
     if scene is not None:
         if not scene.endswith('.xml'):
@@ -335,5 +566,11 @@ if __name__ == '__main__':
                         help='Name of a specific scene to render. Otherwise, try to render reference images for all scenes.')
     parser.add_argument('--variant', default=None, type=str,
                         help='Name of a specific variant to render. Otherwise, try to render reference images for all variants.')
+    parser.add_argument('--perf', action='store_true',
+                        help='Record the throughput baselines of the performance tests on this machine instead of rendering reference images.')
     args = parser.parse_args()
-    render_ref_images(SCENES, **vars(args))
+    if args.perf:
+        record_perf_baselines(scene=args.scene, variant=args.variant)
+    else:
+        del args.perf
+        render_ref_images(SCENES, **vars(args))
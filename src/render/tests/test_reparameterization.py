@@ -164,6 +164,52 @@ def test02_reparameterization_backward_direction_gradient(variants_all_ad_rgb, r
     assert dr.allclose(res_grad / float(n_passes), ref, atol=atol)
 
 
+@pytest.mark.parametrize("unroll", [False, True])
+def test03_reparameterization_group_size(variants_all_ad_rgb, unroll):
+    # Lanes sharing their auxiliary rays should produce the same warp field
+    num_rays = 32
+    kappa = 1e6
+    exponent = 3.0
+    trans = mi.Vector3f([1.0, 0.0, 0.0])
+
+    scene = make_rectangle_mesh_scene()
+    params = mi.traverse(scene)
+    key = 'mesh.vertex_positions'
+    params.keep([key])
+
+    ray = mi.Ray3f([0, 1, -5], [0, 0, 1], 0.0, [])
+    ray = dr.gather(mi.Ray3f, ray, dr.zeros(mi.UInt32, 64))
+
+    def reparam_grad(group_size):
+        dr.enable_grad(params[key])
+        dr.set_grad(params[key], 0.0)
+        params.update()
+
+        d, det = mi.ad.reparameterize_ray(
+            scene=scene,
+            rng=mi.PCG32(size=64),
+            ray=ray,
+            params=params,
+            num_rays=num_rays,
+            kappa=kappa,
+            exponent=exponent,
+            unroll=unroll,
+            group_size=group_size
+        )
+
+        assert dr.all(dr.eq(det, 1.0))
+        dr.set_grad(d, trans)
+        dr.enqueue(dr.ADMode.Backward, d)
+        dr.traverse(mi.Float, dr.ADMode.Backward, dr.ADFlag.ClearVertices)
+        return dr.grad(params[key]) / 64
+
+    ref = reparam_grad(1)
+    assert dr.allclose(reparam_grad(4), ref, atol=1e-2)
+
+    with pytest.raises(Exception, match='group_size'):
+        mi.ad.reparameterize_ray(scene, mi.PCG32(), params, ray, group_size=0)
+
+
 if __name__ == '__main__':
     """
     Helper script to plot shape parameter gradients
@@ -246,3 +246,567 @@ def test09_test_emitter_sampling_weight_update(variants_all_backends_once):
     assert dr.allclose(scene.pdf_emitter(0), pdf[0])
     assert dr.allclose(scene.pdf_emitter(1), pdf[1])
     assert dr.allclose(scene.pdf_emitter(2), pdf[2])
+
+
+def test10_deforming_mesh_update(variants_all_backends_once):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'rect': {'type': 'rectangle'},
+    })
+
+    ray = mi.Ray3f([0.25, 0.25, 5], [0, 0, -1])
+    assert dr.allclose(scene.ray_intersect(ray).t, 5)
+
+    params = mi.traverse(scene)
+    key = 'rect.vertex_positions'
+
+    # Only move vertices, the topology is unchanged (refit path)
+    for z in [1.0, -2.0, 0.5]:
+        positions = dr.unravel(mi.Point3f, params[key])
+        positions.z = z
+        params[key] = dr.ravel(positions)
+        params.update()
+
+        si = scene.ray_intersect(ray)
+        assert dr.all(si.is_valid())
+        assert dr.allclose(si.t, 5 - z)
+
+
+def test11_light_tree_emitter_sampling(variants_all_backends_once):
+    scene_dict = {
+        'type': 'scene',
+        'light_tree': True,
+        'env': {'type': 'constant', 'radiance': {'type': 'rgb', 'value': 0.1}},
+    }
+    for i in range(6):
+        scene_dict[f'rect_{i}'] = {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([3.0 * i - 7.5, 0, 4])
+                        .rotate([1, 0, 0], 30 * i),
+            'emitter': {'type': 'area', 'radiance': {'type': 'rgb', 'value': 1 + i}},
+        }
+    scene = mi.load_dict(scene_dict)
+
+    it = dr.zeros(mi.SurfaceInteraction3f)
+    it.p = [1, 0.5, 0]
+    it.n = [0, 0, 1]
+
+    # The sampled density must match the one returned by 'pdf_emitter_direction'
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, 64 if dr.is_jit_v(mi.Float) else 1)
+    for _ in range(8 if dr.is_jit_v(mi.Float) else 64):
+        ds, weight = scene.sample_emitter_direction(it, sampler.next_2d(),
+                                                   test_visibility=False)
+        pdf = scene.pdf_emitter_direction(it, ds, ds.pdf > 0)
+        assert dr.allclose(dr.select(ds.pdf > 0, ds.pdf, 0), pdf, rtol=1e-3)
+        sampler.advance()
+
+
+def create_material_scene(merge_bsdfs):
+    scene_dict = {
+        'type': 'scene',
+        'merge_bsdfs': merge_bsdfs,
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, -10, 6], target=[0, 0, 0], up=[0, 0, 1]),
+            'sampler': {'type': 'independent', 'sample_count': 64},
+            'film': {'type': 'hdrfilm', 'width': 16, 'height': 16,
+                     'rfilter': {'type': 'box'}},
+        },
+        'env': {'type': 'constant', 'radiance': 1.0},
+        'textured': {
+            'type': 'sphere', 'center': [0, 2, 0],
+            'bsdf': {'type': 'diffuse', 'reflectance': {
+                'type': 'checkerboard', 'to_uv': mi.ScalarTransform4f.scale(4)}},
+        },
+    }
+    for i in range(4):
+        scene_dict[f'diffuse_{i}'] = {
+            'type': 'sphere', 'center': [2.5 * i - 4, 0, 0],
+            'bsdf': {'type': 'diffuse', 'reflectance': {
+                'type': 'rgb', 'value': [0.2 * i + 0.1, 0.5, 0.8 - 0.2 * i]}},
+        }
+        scene_dict[f'principled_{i}'] = {
+            'type': 'sphere', 'center': [2.5 * i - 4, -2.5, 0],
+            'bsdf': {'type': 'principled', 'metallic': 0.2 * i,
+                     'roughness': 0.3 + 0.1 * i,
+                     'base_color': {'type': 'rgb', 'value': [0.8, 0.2 * i, 0.3]}},
+        }
+    return mi.load_dict(scene_dict)
+
+
+def test12_merge_bsdfs(variants_all_rgb):
+    scene = create_material_scene(True)
+    shapes = {s.id(): s for s in scene.shapes()}
+
+    # Instances of the same plugin with constant parameters share one BSDF
+    for prefix in ['diffuse', 'principled']:
+        bsdfs = [shapes[f'{prefix}_{i}'].bsdf() for i in range(4)]
+        assert all(b == bsdfs[0] for b in bsdfs)
+        assert sorted(shapes[f'{prefix}_{i}'].bsdf_index() for i in range(4)) == [0, 1, 2, 3]
+
+    # Spatially varying textures can't be merged
+    assert shapes['textured'].bsdf() != shapes['diffuse_0'].bsdf()
+    assert shapes['textured'].bsdf_index() == 0
+
+    image = mi.render(scene, seed=1)
+    image_ref = mi.render(create_material_scene(False), seed=1)
+    assert dr.allclose(image.array, image_ref.array, rtol=1e-3, atol=1e-3)
+
+
+@pytest.mark.parametrize('wrap_mode', ['repeat', 'mirror', 'clamp'])
+@pytest.mark.parametrize('filter_type', ['bilinear', 'nearest'])
+def test13_merge_bitmaps(variants_vec_rgb, wrap_mode, filter_type):
+    import numpy as np
+    rng = np.random.default_rng(0)
+
+    def create_scene(merge_bsdfs):
+        scene_dict = {
+            'type': 'scene',
+            'merge_bsdfs': merge_bsdfs,
+            'sensor': {
+                'type': 'perspective',
+                'to_world': mi.ScalarTransform4f.look_at(
+                    origin=[0, -10, 6], target=[0, 0, 0], up=[0, 0, 1]),
+                'sampler': {'type': 'independent', 'sample_count': 16},
+                'film': {'type': 'hdrfilm', 'width': 16, 'height': 16,
+                         'rfilter': {'type': 'box'}},
+            },
+            'env': {'type': 'constant', 'radiance': 1.0},
+        }
+        for i, res in enumerate([(5, 7), (16, 3), (2, 2)]):
+            scene_dict[f'bitmap_{i}'] = {
+                'type': 'sphere', 'center': [2.5 * i - 2.5, 0, 0],
+                'bsdf': {'type': 'diffuse', 'reflectance': {
+                    'type': 'bitmap',
+                    'bitmap': mi.Bitmap(rng.uniform(size=res + (3,)).astype(np.float32)),
+                    'raw': True,
+                    'filter_type': filter_type,
+                    'wrap_mode': wrap_mode,
+                    'accel': False,
+                    'to_uv': mi.ScalarTransform4f.scale([1.5 + i, 2, 1]).translate([-0.2, 0.1, 0])}},
+            }
+        return mi.load_dict(scene_dict)
+
+    # Small bitmaps with the same configuration are packed into an atlas
+    scene = create_scene(True)
+    shapes = {s.id(): s for s in scene.shapes()}
+    bsdfs = [shapes[f'bitmap_{i}'].bsdf() for i in range(3)]
+    assert all(b == bsdfs[0] for b in bsdfs)
+    assert 'AtlasTexture' in str(bsdfs[0])
+
+    image = mi.render(scene, seed=1)
+    image_ref = mi.render(create_scene(False), seed=1)
+    assert dr.allclose(image.array, image_ref.array, rtol=1e-3, atol=1e-3)
+
+
+def test14_alias_emitter_sampling(variants_all_backends_once):
+    weights = [2.0, 1.0, 0.5]
+    scene = mi.load_dict({
+        'type': 'scene',
+        'alias_sampling': True,
+        'emitter_0': {'type':'point', 'sampling_weight': weights[0]},
+        'emitter_1': {'type':'constant', 'sampling_weight': weights[1]},
+        'emitter_2': {'type':'directional', 'sampling_weight': weights[2]},
+    })
+
+    distr = mi.AliasDistribution(weights)
+    for sample in [0.1, 0.4, 0.75, 0.95]:
+        index, weight, reused_sample = scene.sample_emitter(sample)
+        ref_index, ref_reused_sample, ref_pmf = distr.sample_reuse_pmf(sample)
+        assert dr.allclose(index, ref_index)
+        assert dr.allclose(weight, 1.0 / ref_pmf)
+        assert dr.allclose(reused_sample, ref_reused_sample)
+        assert dr.allclose(scene.pdf_emitter(index), ref_pmf)
+
+
+def test15_emitter_sampling_partial_update(variants_all_backends_once):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'emitter_0': {'type':'point'},
+        'emitter_1': {'type':'constant'},
+        'emitter_2': {'type':'point', 'position': [1, 2, 3]},
+    })
+    assert dr.allclose(scene.pdf_emitter(1), 1.0 / 3.0)
+
+    # Changing a sampling weight switches to non-uniform sampling
+    params = mi.traverse(scene)
+    params['emitter_1.sampling_weight'] = 2.0
+    params.update()
+    assert dr.allclose(scene.pdf_emitter(0), 0.25)
+    assert dr.allclose(scene.pdf_emitter(1), 0.5)
+
+    # Unrelated updates leave the emitter distribution untouched
+    params['emitter_2.position'] = [4, 5, 6]
+    params.update()
+    assert dr.allclose(scene.pdf_emitter(1), 0.5)
+    _, weight, _ = scene.sample_emitter(0.6)
+    assert dr.allclose(weight, 2.0)
+
+    # Going back to uniform weights restores uniform sampling
+    params['emitter_1.sampling_weight'] = 1.0
+    params.update()
+    assert dr.allclose(scene.pdf_emitter(1), 1.0 / 3.0)
+
+
+@fresolver_append_path
+def test16_instance_meshes(variants_all_rgb):
+    from mitsuba import ScalarTransform4f as T
+
+    def create_scene(instance_meshes):
+        scene_dict = {
+            'type': 'scene',
+            'instance_meshes': instance_meshes,
+            'different': {
+                'type': 'obj',
+                'filename': 'resources/data/common/meshes/rectangle.obj',
+                'to_world': T.translate([0, 0, -10]) @ T.scale(20)
+            },
+            'mirrored': {
+                'type': 'obj',
+                'filename': 'resources/data/common/meshes/sphere.obj',
+                'to_world': T.translate([0, 6, 0]) @ T.scale([-1, 1, 1])
+            }
+        }
+        for i in range(4):
+            scene_dict[f'sphere_{i}'] = {
+                'type': 'obj',
+                'filename': 'resources/data/common/meshes/sphere.obj',
+                'to_world': T.translate([3 * i, 0, 0]) @
+                            T.rotate([0, 0, 1], 30 * i) @
+                            T.scale(0.5 + 0.25 * i)
+            }
+        return mi.load_dict(scene_dict)
+
+    scene = create_scene(True)
+    shapes = {s.id(): s for s in scene.shapes()}
+    assert len(shapes) == 6
+
+    # The transformed copies of the sphere are instanced, other meshes are not
+    for i in range(4):
+        assert shapes[f'sphere_{i}'].class_().name() == 'Instance'
+    assert shapes['different'].class_().name() != 'Instance'
+    assert shapes['mirrored'].class_().name() != 'Instance'
+
+    scene_ref = create_scene(False)
+    x = [3 * i for i in range(4)] + [0, 0.5]
+    y = [0, 0, 0, 0, 6, 0.5]
+    ray = mi.Ray3f(mi.Point3f(x, y, 10), mi.Vector3f(0, 0, -1))
+    si = scene.ray_intersect(ray)
+    si_ref = scene_ref.ray_intersect(ray)
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.t, si_ref.t, rtol=1e-4)
+    assert dr.allclose(si.n, si_ref.n, atol=1e-4)
+    assert dr.allclose(si.sh_frame.n, si_ref.sh_frame.n, atol=1e-3)
+
+
+@pytest.mark.parametrize('mode', ['static', 'dynamic', 'refit'])
+def test17_embree_build_settings(variants_all_rgb, mode):
+    if not mi.MI_ENABLE_EMBREE or mi.variant().startswith('cuda'):
+        pytest.skip('Embree is not used by this variant')
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'embree_build_quality': 'low',
+        'embree_compact': True,
+        'embree_robust': True,
+        'rect': {'type': 'rectangle', 'embree_build': mode},
+    })
+
+    ray = mi.Ray3f([0.25, 0.25, 5], [0, 0, -1])
+    assert dr.allclose(scene.ray_intersect(ray).t, 5)
+
+    params = mi.traverse(scene)
+    positions = dr.unravel(mi.Point3f, params['rect.vertex_positions'])
+    positions.z = 1.0
+    params['rect.vertex_positions'] = dr.ravel(positions)
+    params.update()
+    assert dr.allclose(scene.ray_intersect(ray).t, 4)
+
+    with pytest.raises(RuntimeError, match='embree_build_quality'):
+        mi.load_dict({'type': 'scene', 'embree_build_quality': 'ultra'})
+
+    with pytest.raises(RuntimeError, match='embree_build'):
+        mi.load_dict({'type': 'rectangle', 'embree_build': 'fast'})
+
+
+def test18_embree_cutout(variants_all_rgb, tmpdir):
+    if not mi.MI_ENABLE_EMBREE or mi.variant().startswith('cuda'):
+        pytest.skip('Embree is not used by this variant')
+
+    import numpy as np
+    from os.path import join
+
+    mesh = mi.Mesh('quad', 4, 2, has_vertex_texcoords=True)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = [-1, -1, 0, 1, -1, 0, 1, 1, 0, -1, 1, 0]
+    params['vertex_texcoords'] = [0, 0, 1, 0, 1, 1, 0, 1]
+    params['faces'] = [0, 1, 2, 0, 2, 3]
+    params.update()
+    filename = join(str(tmpdir), 'quad.ply')
+    mesh.write_ply(filename)
+
+    # Fully transparent for u < 0.5, opaque elsewhere
+    opacity = np.zeros((4, 8, 1), dtype=np.float32)
+    opacity[:, 4:] = 1
+    scene = mi.load_dict({
+        'type': 'scene',
+        'leaf': {
+            'type': 'ply',
+            'filename': filename,
+            'bsdf': {
+                'type': 'mask',
+                'opacity': {'type': 'bitmap', 'bitmap': mi.Bitmap(opacity), 'raw': True},
+                'nested': {'type': 'diffuse'}
+            }
+        },
+        'floor': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -1])
+        }
+    })
+
+    # Rays through the transparent cells don't stop at the masked mesh
+    ray = mi.Ray3f(mi.Point3f([-0.75, -0.5, 0.5, 0.9], 0, 5), mi.Vector3f(0, 0, -1))
+    assert dr.allclose(scene.ray_intersect(ray).t, [6, 6, 5, 5])
+
+    # An update of the opacity texture is taken into account
+    params = mi.traverse(scene)
+    params['leaf.bsdf.opacity.data'] = dr.full(mi.TensorXf, 1, (4, 8, 1))
+    params.update()
+    assert dr.allclose(scene.ray_intersect(ray).t, 5)
+
+
+def test19_optix_accel_update(variants_any_cuda):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'optix_allow_update': True,
+        'rect': {'type': 'rectangle'},
+        'sphere': {'type': 'sphere', 'center': [3, 0, 0]},
+    })
+
+    ray = mi.Ray3f(mi.Point3f([0.25, 3], [0.25, 0], 5), mi.Vector3f(0, 0, -1))
+    assert dr.allclose(scene.ray_intersect(ray).t, [5, 4])
+
+    params = mi.traverse(scene)
+    key = 'rect.vertex_positions'
+
+    # Only vertices move, the acceleration data structures are refit
+    for z in [1.0, -2.0, 0.5]:
+        positions = dr.unravel(mi.Point3f, params[key])
+        positions.z = z
+        params[key] = dr.ravel(positions)
+        params.update()
+
+        si = scene.ray_intersect(ray)
+        assert dr.all(si.is_valid())
+        assert dr.allclose(si.t, [5 - z, 4])
+
+
+def test20_cutout_triangles(variants_all_rgb, tmpdir):
+    if not mi.MI_ENABLE_EMBREE and not mi.variant().startswith('cuda'):
+        pytest.skip('Cutouts are not skipped by the native kd-tree')
+
+    import numpy as np
+    from os.path import join
+
+    # Two quads, the left one is mapped to a transparent region of the texture
+    mesh = mi.Mesh('quads', 8, 4, has_vertex_texcoords=True)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = [-1, -1, 0, 0, -1, 0, 0, 1, 0, -1, 1, 0,
+                                  0, -1, 0, 1, -1, 0, 1, 1, 0, 0, 1, 0]
+    params['vertex_texcoords'] = [0.15, 0.1, 0.35, 0.1, 0.35, 0.9, 0.15, 0.9,
+                                  0.6, 0.1, 0.9, 0.1, 0.9, 0.9, 0.6, 0.9]
+    params['faces'] = [0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7]
+    params.update()
+    filename = join(str(tmpdir), 'quads.ply')
+    mesh.write_ply(filename)
+
+    opacity = np.zeros((4, 8, 1), dtype=np.float32)
+    opacity[:, 4:] = 1
+    scene = mi.load_dict({
+        'type': 'scene',
+        'leaf': {
+            'type': 'ply',
+            'filename': filename,
+            'bsdf': {
+                'type': 'mask',
+                'opacity': {'type': 'bitmap', 'bitmap': mi.Bitmap(opacity), 'raw': True},
+                'nested': {'type': 'diffuse'}
+            }
+        },
+        'floor': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -1])
+        }
+    })
+
+    ray = mi.Ray3f(mi.Point3f([-0.5, 0.5], 0, 5), mi.Vector3f(0, 0, -1))
+    si = scene.ray_intersect(ray)
+    assert dr.allclose(si.t, [6, 5])
+
+    # Removing the transparent triangles keeps the indices of the others
+    assert dr.all((si.t > 5.5) | (si.prim_index >= 2))
+
+
+def test21_ray_test_batch(variants_all_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': {'type': 'sphere', 'radius': 1},
+    })
+
+    rays = []
+    for i in range(20):
+        y = -1.5 + 3 * i / 19
+        rays.append(mi.Ray3f([-4, y, 0], [1, 0, 0]))
+    rays.append(mi.Ray3f(mi.Ray3f([-4, 0, 0], [1, 0, 0]), 2.0))
+
+    occluded = scene.ray_test_batch(rays)
+    assert len(occluded) == len(rays)
+    for i, ray in enumerate(rays):
+        assert dr.all(occluded[i] == scene.ray_test(ray))
+    assert dr.all(occluded[0] == False) and dr.all(occluded[10] == True)
+
+    # The last ray stops before reaching the sphere
+    assert dr.all(occluded[-1] == False)
+
+
+def create_occluded_emitter_scene(emitter_cache):
+    return mi.load_dict({
+        'type': 'scene',
+        'emitter_cache': emitter_cache,
+        'emitter_cache_resolution': 4,
+        'integrator': {'type': 'path', 'max_depth': 2, 'samples_per_pass': 8},
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, 0, 5], target=[0, 0, 0], up=[0, 1, 0]),
+            'sampler': {'type': 'independent', 'sample_count': 64},
+            'film': {'type': 'hdrfilm', 'width': 8, 'height': 8,
+                     'rfilter': {'type': 'box'}},
+        },
+        'floor': {'type': 'rectangle', 'bsdf': {'type': 'diffuse'}},
+        # Emitter facing the floor
+        'light': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, 2])
+                        .rotate([1, 0, 0], 180).scale(0.5),
+            'emitter': {'type': 'area', 'radiance': 1.0},
+        },
+        # Emitter hidden from the floor by a blocker
+        'blocker': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -1]).scale(2),
+        },
+        'hidden': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -2]).scale(0.5),
+            'emitter': {'type': 'area', 'radiance': 1.0},
+        },
+    })
+
+
+def test22_emitter_cache(variants_all_rgb):
+    scene = create_occluded_emitter_scene(True)
+    image = mi.render(scene)
+    image_ref = mi.render(create_occluded_emitter_scene(False))
+    assert dr.allclose(dr.mean(image.array), dr.mean(image_ref.array), rtol=5e-2)
+
+    it = dr.zeros(mi.SurfaceInteraction3f)
+    it.p = [0.2, 0.1, 0]
+    it.n = [0, 0, 1]
+
+    # Sampling densities must match the mixture, and the emitter below the
+    # floor (which is never visible) should be sampled less often
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, 64 if dr.is_jit_v(mi.Float) else 1)
+    hidden, total = 0, 0
+    for _ in range(8 if dr.is_jit_v(mi.Float) else 64):
+        ds, weight = scene.sample_emitter_direction(it, sampler.next_2d(),
+                                                   test_visibility=False)
+        pdf = scene.pdf_emitter_direction(it, ds, ds.pdf > 0)
+        assert dr.allclose(dr.select(ds.pdf > 0, ds.pdf, 0), pdf, rtol=1e-3)
+        hidden += dr.count(ds.p.z < 0)[0] if dr.is_jit_v(mi.Float) else int(ds.p.z < 0)
+        total += 64 if dr.is_jit_v(mi.Float) else 1
+        sampler.advance()
+
+    assert hidden < 0.4 * total
+
+
+def test23_ray_intersect_preliminary_batch(variants_all_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': {'type': 'sphere', 'radius': 1},
+        'rect': {'type': 'rectangle',
+                 'to_world': mi.ScalarTransform4f.translate([0, 0, -2])},
+    })
+
+    # Enough rays to be traced in parallel chunks
+    rays = []
+    for i in range(3000):
+        x = -1.5 + 3 * (i % 100) / 99
+        y = -1.5 + 3 * (i // 100) / 29
+        rays.append(mi.Ray3f([x, y, 4], [0, 0, -1]))
+
+    result = scene.ray_intersect_preliminary_batch(rays)
+    assert len(result) == len(rays)
+    for i in range(0, len(rays), 37):
+        pi = scene.ray_intersect_preliminary(rays[i])
+        assert dr.all(result[i].is_valid() == pi.is_valid())
+        if dr.all(pi.is_valid()):
+            assert dr.allclose(result[i].t, pi.t)
+            assert dr.all(result[i].prim_index == pi.prim_index)
+
+
+def test24_ray_flags(variants_all_rgb):
+    def ray_flags(bsdf, emitter=None):
+        shape = { 'type': 'sphere', 'bsdf': bsdf }
+        if emitter is not None:
+            shape['emitter'] = emitter
+        return mi.load_dict({ 'type': 'scene', 'shape': shape }).ray_flags()
+
+    minimal = mi.RayFlags.Minimal | mi.RayFlags.ShadingFrame
+    uv = minimal | mi.RayFlags.UV
+
+    # Untextured isotropic materials need neither UVs nor their partials
+    assert ray_flags({ 'type': 'diffuse' }) == minimal
+    assert ray_flags({ 'type': 'roughconductor', 'alpha': 0.2 }) == minimal
+
+    # Spatially varying textures of BSDFs and emitters need UVs
+    checkerboard = { 'type': 'checkerboard' }
+    assert ray_flags({ 'type': 'diffuse', 'reflectance': checkerboard }) == uv
+    assert ray_flags({ 'type': 'diffuse' },
+                     { 'type': 'area', 'radiance': checkerboard }) == uv
+
+    # Anisotropic BSDFs and normal maps follow the UV parameterization
+    full = uv | mi.RayFlags.dPdUV
+    assert ray_flags({ 'type': 'roughconductor', 'alpha_u': 0.1,
+                       'alpha_v': 0.3 }) == full
+    assert ray_flags({ 'type': 'bumpmap', 'bsdf': { 'type': 'diffuse' },
+                       'texture': checkerboard }) == full
+
+
+def test25_mesh_faces_update(variants_all_backends_once):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'rect': {'type': 'rectangle'},
+    })
+
+    # The grids avoid the diagonals shared by the two triangles
+    x, y = dr.meshgrid(dr.linspace(mi.Float, -0.9, 0.9, 16),
+                       dr.linspace(mi.Float, -0.85, 0.85, 15))
+    ray = mi.Ray3f(mi.Point3f(x, y, 5), mi.Vector3f(0, 0, -1))
+    prim = scene.ray_intersect(ray).prim_index
+    assert dr.all(scene.ray_intersect(ray).is_valid())
+
+    # Same face count, but the second triangle now repeats the first one
+    params = mi.traverse(scene)
+    faces = dr.unravel(mi.Point3u, params['rect.faces'])
+    first = dr.gather(mi.Point3u, faces, mi.UInt32(0, 0))
+    params['rect.faces'] = dr.ravel(first)
+    params.update()
+
+    si = scene.ray_intersect(ray)
+    assert dr.all(si.is_valid() == (prim == 0))
+    assert dr.allclose(dr.select(si.is_valid(), si.t, 5), 5)
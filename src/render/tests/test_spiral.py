@@ -77,3 +77,123 @@ def test03_normal_film(variant_scalar_rgb):
     # Resetting and re-querying the blocks should yield the exact same results.
     s.reset()
     check_first_blocks(extract_blocks(s), expected, n_total=110)
+
+
+def morton2(x, y):
+    result = 0
+    for i in range(16):
+        result |= ((x >> i) & 1) << (2 * i)
+        result |= ((y >> i) & 1) << (2 * i + 1)
+    return result
+
+
+def test04_adaptive_tiles(variant_scalar_rgb):
+    # Splitting must cover every pixel exactly once and preserve the seeding
+    f = make_film(100, 70)
+    s = mi.Spiral(f.size(), f.crop_offset(), 32, 2)
+    s.set_adaptive(worker_count=4, min_block_size=4)
+
+    coverage = np.zeros((70, 100), dtype=np.int32)
+    seeds = np.zeros((70, 100), dtype=np.int64)
+    split_seen = False
+
+    while True:
+        (bo, bs, bi, bsize) = s.next_tile()
+        if np.prod(bs) == 0:
+            break
+        split_seen |= bsize < 32
+        for y in range(bs[1]):
+            for x in range(bs[0]):
+                morton = morton2(x, y)
+                coverage[bo[1] + y, bo[0] + x] += 1
+                seeds[bo[1] + y, bo[0] + x] += bi * bsize * bsize + morton
+        # Pretend that the tile in the image center is very expensive
+        s.record_time(bi, bsize, 100.0 if bo[0] < 64 and bo[0] >= 32 else 1.0)
+
+    assert split_seen
+    assert np.all(coverage == 2)
+
+    # Compare against the seeds of an unsplit spiral
+    s = mi.Spiral(f.size(), f.crop_offset(), 32, 2)
+    ref = np.zeros((70, 100), dtype=np.int64)
+    for (bo, bs, bi) in extract_blocks(s):
+        for y in range(bs[1]):
+            for x in range(bs[0]):
+                morton = morton2(x, y)
+                ref[bo[1] + y, bo[0] + x] += bi * 32 * 32 + morton
+    assert np.all(seeds == ref)
+
+
+def test05_pass_barrier(variant_scalar_rgb):
+    f = make_film(100, 70)
+    ref = extract_blocks(mi.Spiral(f.size(), f.crop_offset(), 32, 3))
+
+    s = mi.Spiral(f.size(), f.crop_offset(), 32, 3)
+    s.set_pass_barrier(True)
+    blocks = []
+    for i in range(3):
+        assert s.passes_left() == 3 - i
+        blocks += extract_blocks(s)
+        assert len(blocks) == (i + 1) * s.block_count()
+        assert s.next_pass() == (i < 2)
+
+    # Block identifiers (and thus seeds) are the same as without the barrier
+    assert len(blocks) == len(ref)
+    for (b1, b2) in zip(blocks, ref):
+        assert dr.all(b1[0] == b2[0]) and dr.all(b1[1] == b2[1])
+        assert b1[2] == b2[2]
+
+
+def test06_priority_region(variant_scalar_rgb):
+    f = make_film(100, 70)
+    ref = extract_blocks(mi.Spiral(f.size(), f.crop_offset(), 32, 3))
+
+    s = mi.Spiral(f.size(), f.crop_offset(), 32, 3)
+    s.set_priority_region([70, 40], [10, 10])
+    assert s.priority_block_count() == 1
+    blocks = extract_blocks(s)
+
+    # All passes over the region come first
+    for b in blocks[:3]:
+        assert dr.all(b[0] == [64, 32])
+        assert s.is_priority_block(b[2], 32)
+    assert not any(s.is_priority_block(b[2], 32) for b in blocks[3:])
+
+    # The same blocks (and seeds) are generated as without a region
+    key = lambda b: b[2]
+    assert len(blocks) == len(ref)
+    for (b1, b2) in zip(sorted(blocks, key=key), sorted(ref, key=key)):
+        assert dr.all(b1[0] == b2[0]) and dr.all(b1[1] == b2[1])
+        assert b1[2] == b2[2]
+
+    # With a pass barrier, the region comes first within every pass
+    s = mi.Spiral(f.size(), f.crop_offset(), 32, 3)
+    s.set_priority_region([70, 40], [10, 10])
+    s.set_pass_barrier(True)
+    for i in range(3):
+        pass_blocks = extract_blocks(s)
+        assert len(pass_blocks) == s.block_count()
+        assert dr.all(pass_blocks[0][0] == [64, 32])
+        s.next_pass()
+
+
+def test07_priority_region_render(variant_scalar_rgb):
+    def render(**kwargs):
+        scene = mi.load_dict({
+            'type': 'scene',
+            'integrator': dict({'type': 'path', 'block_size': 8,
+                                 'samples_per_pass': 1}, **kwargs),
+            'sensor': {
+                'type': 'perspective',
+                'sampler': {'type': 'independent', 'sample_count': 4},
+                'film': {'type': 'hdrfilm', 'width': 32, 'height': 24,
+                         'rfilter': {'type': 'box'}},
+            },
+            'sphere': {'type': 'sphere', 'center': [0, 0, 3]},
+            'emitter': {'type': 'constant'},
+        })
+        return mi.render(scene, seed=0, spp=4)
+
+    image = render(priority_offset_x=4, priority_offset_y=4,
+                   priority_width=8, priority_height=8)
+    assert dr.allclose(image, render())
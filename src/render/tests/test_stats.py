@@ -0,0 +1,57 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import simple_scene
+
+
+def render_with_stats(integrator, enabled=True):
+    # The floor covers the entire image and every path leaves the scene
+    # after a single diffuse bounce
+    scene = mi.load_dict(simple_scene({'type': integrator, 'max_depth': 2},
+                                      spp=4, sphere=None))
+    mi.Statistics.set_enabled(enabled)
+    mi.Statistics.reset()
+    dr.eval(mi.render(scene))
+    mi.Statistics.set_enabled(False)
+
+
+samples = 8 * 8 * 4
+
+
+def test01_counters(variants_all_rgb):
+    render_with_stats('path')
+
+    # One camera ray and one continuation ray per sample, and one emitter
+    # sample (with its shadow ray) and BSDF sample at the floor
+    assert mi.Statistics.value(mi.StatsCounter.RayIntersect) == 2 * samples
+    assert mi.Statistics.value(mi.StatsCounter.RayTest) == samples
+    assert mi.Statistics.value(mi.StatsCounter.EmitterSample) == samples
+    assert mi.Statistics.value(mi.StatsCounter.BSDFSample) == samples
+    assert mi.Statistics.value(mi.StatsCounter.NullCollision) == 0
+
+    # All paths end after their first vertex
+    histogram = mi.Statistics.path_length_histogram()
+    assert len(histogram) == 32
+    assert histogram[1] == samples and sum(histogram) == samples
+    assert 'Rays (closest hit)' in mi.Statistics.to_string()
+
+    mi.Statistics.reset()
+    assert mi.Statistics.value(mi.StatsCounter.RayIntersect) == 0
+    assert sum(mi.Statistics.path_length_histogram()) == 0
+
+
+def test02_counters_volpath(variants_all_rgb):
+    render_with_stats('volpath')
+
+    assert mi.Statistics.value(mi.StatsCounter.RayIntersect) >= 2 * samples
+    assert mi.Statistics.value(mi.StatsCounter.EmitterSample) == samples
+    assert mi.Statistics.value(mi.StatsCounter.BSDFSample) == samples
+    assert mi.Statistics.value(mi.StatsCounter.NullCollision) == 0
+    assert sum(mi.Statistics.path_length_histogram()) == samples
+
+
+def test03_disabled(variants_all_rgb):
+    render_with_stats('path', enabled=False)
+    assert mi.Statistics.value(mi.StatsCounter.RayIntersect) == 0
+    assert sum(mi.Statistics.path_length_histogram()) == 0
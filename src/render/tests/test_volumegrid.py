@@ -46,3 +46,37 @@ def test03_max_per_channel(variants_all_scalar, tmpdir, np_rng):
     grid = mi.VolumeGrid(tmp_file)
     mi_max_per_channel = grid.max_per_channel()
     assert dr.allclose(np_max_per_channel, mi_max_per_channel)
+
+
+@pytest.mark.parametrize('brick_size', [1, 4, 32])
+def test04_chunked_read_write(variants_all_scalar, tmpdir, np_rng, brick_size):
+    tmp_file = os.path.join(str(tmpdir), "out.vol")
+    data = np_rng.random((5, 9, 17, 3))
+    data[:, :4] = 0.0
+    mi.VolumeGrid(data).write(tmp_file, brick_size=brick_size)
+
+    loaded = mi.VolumeGrid(tmp_file)
+    assert dr.allclose(np.array(loaded), data)
+    assert dr.allclose(loaded.max(), np.max(data))
+    assert dr.allclose(loaded.max_per_channel(), np.max(data, axis=(0, 1, 2)))
+    assert loaded.brick_size() == brick_size
+
+    # The value bounds of the bricks are stored in the file
+    count = loaded.brick_count()
+    assert dr.allclose(count, (np.array([17, 9, 5]) + brick_size - 1) // brick_size)
+    brick_min = np.array(loaded.brick_min()).reshape(count[2], count[1], count[0])
+    brick_max = np.array(loaded.brick_max()).reshape(count[2], count[1], count[0])
+    B = brick_size
+    for z in range(count[2]):
+        for y in range(count[1]):
+            for x in range(count[0]):
+                block = data[z*B:(z+1)*B, y*B:(y+1)*B, x*B:(x+1)*B]
+                assert dr.allclose(brick_min[z, y, x], np.min(block))
+                assert dr.allclose(brick_max[z, y, x], np.max(block))
+
+    # The same bounds can be computed for grids in memory
+    grid = mi.VolumeGrid(data)
+    assert grid.brick_size() == 0
+    grid.compute_brick_bounds(brick_size)
+    assert dr.allclose(grid.brick_min(), loaded.brick_min())
+    assert dr.allclose(grid.brick_max(), loaded.brick_max())
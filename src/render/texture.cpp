@@ -95,11 +95,48 @@ Texture<Float, Spectrum>::D65(ref<Texture> texture) {
     }
 }
 
+MI_VARIANT ref<Texture<Float, Spectrum>>
+Texture<Float, Spectrum>::merge(const std::vector<ref<Texture>> &textures) {
+    if constexpr (is_spectral_v<Spectrum>) {
+        DRJIT_MARK_USED(textures);
+        return nullptr;
+    } else {
+        if (textures.empty())
+            return nullptr;
+        std::string key = textures[0]->merge_key();
+        if (key.empty())
+            return nullptr;
+        for (size_t i = 1; i < textures.size(); ++i)
+            if (textures[i]->merge_key() != key)
+                return nullptr;
+        return textures[0]->merge_instances(textures);
+    }
+}
+
+MI_VARIANT std::string Texture<Float, Spectrum>::merge_key() const {
+    return is_spatially_varying() ? "" : "constant";
+}
+
+MI_VARIANT ref<Texture<Float, Spectrum>>
+Texture<Float, Spectrum>::merge_instances(const std::vector<ref<Texture>> &textures) const {
+    Properties props("merged");
+    for (size_t i = 0; i < textures.size(); ++i) {
+        if (textures[i]->is_spatially_varying())
+            return nullptr;
+        props.set_object("instance_" + std::to_string(i), textures[i].get());
+    }
+    return PluginManager::instance()->create_object<Texture>(props);
+}
+
 MI_VARIANT typename Texture<Float, Spectrum>::ScalarVector2i
 Texture<Float, Spectrum>::resolution() const {
     return ScalarVector2i(1, 1);
 }
 
+MI_VARIANT std::vector<bool> Texture<Float, Spectrum>::zero_mask() const {
+    return { };
+}
+
 MI_VARIANT typename Texture<Float, Spectrum>::ScalarFloat
 Texture<Float, Spectrum>::spectral_resolution() const {
     NotImplementedError("spectral_resolution");
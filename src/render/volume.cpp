@@ -56,6 +56,40 @@ Volume<Float, Spectrum>::max_per_channel(ScalarFloat * /*out*/) const {
     NotImplementedError("max_per_channel");
 }
 
+MI_VARIANT void
+Volume<Float, Spectrum>::max_per_cell(const ScalarVector3i &cells,
+                                      ScalarFloat *out) const {
+    std::fill(out, out + dr::prod(cells), max());
+}
+
+MI_VARIANT void
+Volume<Float, Spectrum>::min_per_cell(const ScalarVector3i &cells,
+                                      ScalarFloat *out) const {
+    std::fill(out, out + dr::prod(cells), 0.f);
+}
+
+MI_VARIANT void
+Volume<Float, Spectrum>::max_per_cell_per_channel(const ScalarVector3i &cells,
+                                                  ScalarFloat *out) const {
+    const size_t count = (size_t) dr::prod(cells),
+                 channels = std::max<size_t>(m_channel_count, 1);
+    std::unique_ptr<ScalarFloat[]> values(new ScalarFloat[count]);
+    max_per_cell(cells, values.get());
+    for (size_t i = 0; i < count; ++i)
+        std::fill(out + i * channels, out + (i + 1) * channels, values[i]);
+}
+
+MI_VARIANT void
+Volume<Float, Spectrum>::min_per_cell_per_channel(const ScalarVector3i &cells,
+                                                  ScalarFloat *out) const {
+    const size_t count = (size_t) dr::prod(cells),
+                 channels = std::max<size_t>(m_channel_count, 1);
+    std::unique_ptr<ScalarFloat[]> values(new ScalarFloat[count]);
+    min_per_cell(cells, values.get());
+    for (size_t i = 0; i < count; ++i)
+        std::fill(out + i * channels, out + (i + 1) * channels, values[i]);
+}
+
 MI_VARIANT typename Volume<Float, Spectrum>::ScalarVector3i
 Volume<Float, Spectrum>::resolution() const {
     return ScalarVector3i(1, 1, 1);
@@ -2,17 +2,58 @@
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/util.h>
+#include <mitsuba/core/zstream.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+/// Resolution of a brick of the grid (smaller at the boundary)
+inline Vector<uint32_t, 3> volume_brick_extent(const Vector<uint32_t, 3> &size,
+                                               const Vector<uint32_t, 3> &brick,
+                                               uint32_t brick_size) {
+    return dr::minimum(Vector<uint32_t, 3>(brick_size), size - brick * brick_size);
+}
+
+/// Copy the voxels of a brick between a grid and a contiguous buffer
+template <bool ToBuffer, typename Value>
+void volume_copy_brick(Value *grid, const Vector<uint32_t, 3> &size,
+                       uint32_t channels, const Vector<uint32_t, 3> &brick,
+                       uint32_t brick_size, float *buffer) {
+    Vector<uint32_t, 3> extent = volume_brick_extent(size, brick, brick_size),
+                        origin = brick * brick_size;
+    size_t row = (size_t) extent.x() * channels;
+
+    for (uint32_t z = 0; z < extent.z(); ++z) {
+        for (uint32_t y = 0; y < extent.y(); ++y) {
+            Value *ptr = grid + (((size_t) (origin.z() + z) * size.y() +
+                                  origin.y() + y) * size.x() + origin.x()) * channels;
+            for (size_t i = 0; i < row; ++i) {
+                if constexpr (ToBuffer)
+                    buffer[i] = (float) ptr[i];
+                else
+                    ptr[i] = (Value) buffer[i];
+            }
+            buffer += row;
+        }
+    }
+}
+NAMESPACE_END(detail)
+
 MI_VARIANT
 VolumeGrid<Float, Spectrum>::VolumeGrid(Stream *stream) { read(stream); }
 
 MI_VARIANT
 VolumeGrid<Float, Spectrum>::VolumeGrid(const fs::path &filename) {
-    ref<FileStream> fs = new FileStream(filename);
-    read(fs);
+    /* Read the file from a memory mapping: the voxels (or compressed bricks)
+       are then copied straight from the page cache */
+    ref<MemoryMappedFile> mmap = new MemoryMappedFile(filename);
+    ref<MemoryStream> ms = new MemoryStream(mmap->data(), mmap->size());
+    read(ms);
 }
 
 MI_VARIANT
@@ -21,6 +62,7 @@ VolumeGrid<Float, Spectrum>::VolumeGrid(ScalarVector3u size,
     : m_size(size), m_channel_count(channel_count),
       m_bbox(ScalarBoundingBox3f(ScalarPoint3f(0.f), ScalarPoint3f(1.f))),
       m_max_per_channel(channel_count, 0.f) {
+    m_memory.set(buffer_size());
     m_data = std::unique_ptr<ScalarFloat[]>(
         new ScalarFloat[dr::prod(m_size) * m_channel_count]);
 }
@@ -29,14 +71,13 @@ MI_VARIANT
 void VolumeGrid<Float, Spectrum>::read(Stream *stream) {
     char header[3];
     stream->read(header, 3);
-
     if (header[0] != 'V' || header[1] != 'O' || header[2] != 'L')
         Throw("Invalid volume file!");
     uint8_t version;
     stream->read(version);
-
-    if (version != 3)
-        Throw("Invalid version, currently only version 3 is supported (found %d)", version);
+    if (version != 3 && version != 4)
+        Throw("Invalid version, currently only versions 3 and 4 are supported "
+              "(found %d)", version);
 
     int32_t data_type;
     stream->read(data_type);
@@ -63,25 +104,176 @@ void VolumeGrid<Float, Spectrum>::read(Stream *stream) {
     m_bbox = ScalarBoundingBox3f(ScalarPoint3f(dims[0], dims[1], dims[2]),
                                  ScalarPoint3f(dims[3], dims[4], dims[5]));
 
-    m_max = -dr::Infinity<ScalarFloat>;
-    m_max_per_channel.resize(m_channel_count, -dr::Infinity<ScalarFloat>);
-
-    m_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * m_channel_count]);
-    size_t k = 0;
-    for (size_t i = 0; i < size; ++i) {
-        for (size_t j = 0; j < m_channel_count; ++j) {
-            float val;
-            stream->read(val);
-            m_data[k] = val;
-            m_max     = dr::maximum(m_max, val);
-            m_max_per_channel[j] = dr::maximum(m_max_per_channel[j], val);
-            ++k;
+    size_t count = size * m_channel_count;
+    m_memory.set(count * sizeof(ScalarFloat));
+    m_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[count]);
+    m_brick_size = 0;
+    m_brick_min.clear();
+    m_brick_max.clear();
+
+    if (version == 3) {
+        // Dense storage: read the voxels in bulk
+        if constexpr (std::is_same_v<ScalarFloat, float>) {
+            stream->read_array(m_data.get(), count);
+        } else {
+            const size_t chunk_size = 1 << 20;
+            std::unique_ptr<float[]> chunk(new float[chunk_size]);
+            for (size_t i = 0; i < count; i += chunk_size) {
+                size_t n = std::min(chunk_size, count - i);
+                stream->read_array(chunk.get(), n);
+                for (size_t j = 0; j < n; ++j)
+                    m_data[i + j] = (ScalarFloat) chunk[j];
+            }
         }
+        update_max();
+    } else {
+        // Chunked storage: a table of bricks followed by the compressed bricks
+        int32_t brick_size;
+        stream->read(brick_size);
+        if (brick_size <= 0)
+            Throw("Invalid brick size (found %d)", brick_size);
+        m_brick_size = (uint32_t) brick_size;
+
+        std::unique_ptr<float[]> max_per_channel(new float[m_channel_count]);
+        stream->read_array(max_per_channel.get(), m_channel_count);
+        m_max = -dr::Infinity<ScalarFloat>;
+        m_max_per_channel.resize(m_channel_count);
+        for (size_t i = 0; i < m_channel_count; ++i) {
+            m_max_per_channel[i] = (ScalarFloat) max_per_channel[i];
+            m_max = dr::maximum(m_max, m_max_per_channel[i]);
+        }
+
+        size_t bricks = dr::prod(brick_count());
+        std::vector<uint64_t> offset(bricks);
+        std::vector<uint32_t> compressed_size(bricks);
+        m_brick_min.resize(bricks);
+        m_brick_max.resize(bricks);
+        uint64_t payload_size = 0;
+        for (size_t i = 0; i < bricks; ++i) {
+            float bounds[2];
+            stream->read(offset[i]);
+            stream->read(compressed_size[i]);
+            stream->read_array(bounds, 2);
+            m_brick_min[i] = (ScalarFloat) bounds[0];
+            m_brick_max[i] = (ScalarFloat) bounds[1];
+            payload_size = std::max(payload_size, offset[i] + compressed_size[i]);
+        }
+
+        const uint8_t *payload;
+        std::unique_ptr<uint8_t[]> buffer;
+        auto ms = dynamic_cast<MemoryStream *>(stream);
+        if (ms && !ms->owns_buffer()) {
+            // Decompress the bricks straight from the memory mapping
+            size_t pos = ms->tell();
+            if (pos + payload_size > ms->size())
+                Throw("Volume file is truncated!");
+            payload = ms->raw_buffer() + pos;
+            ms->seek(pos + payload_size);
+        } else {
+            buffer = std::unique_ptr<uint8_t[]>(new uint8_t[payload_size]);
+            stream->read(buffer.get(), payload_size);
+            payload = buffer.get();
+        }
+
+        ScalarVector3u count3 = brick_count();
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, bricks, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                std::vector<float> voxels;
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarVector3u brick((uint32_t) (i % count3.x()),
+                                         (uint32_t) ((i / count3.x()) % count3.y()),
+                                         (uint32_t) (i / ((size_t) count3.x() * count3.y())));
+                    voxels.resize((size_t) dr::prod(detail::volume_brick_extent(
+                        m_size, brick, m_brick_size)) * m_channel_count);
+                    BlockZStream::decompress_block(payload + offset[i],
+                                                   compressed_size[i], voxels.data(),
+                                                   voxels.size() * sizeof(float));
+                    detail::volume_copy_brick<false>(m_data.get(), m_size,
+                                                     m_channel_count, brick,
+                                                     m_brick_size, voxels.data());
+                }
+            }
+        );
     }
+
     Log(Debug, "Loaded grid volume data from file: dimensions %s, max value %f",
         m_size, m_max);
 }
 
+MI_VARIANT
+void VolumeGrid<Float, Spectrum>::update_max() {
+    const size_t channels = m_channel_count,
+                 count    = dr::prod(m_size),
+                 grain    = std::max((size_t) 1, ((size_t) 1 << 18) / channels),
+                 blocks   = (count + grain - 1) / grain;
+
+    // Partial maxima of blocks of voxels, computed in parallel
+    std::vector<ScalarFloat> partial(blocks * channels, -dr::Infinity<ScalarFloat>);
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, blocks, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t b = range.begin(); b != range.end(); ++b) {
+                ScalarFloat *out = partial.data() + b * channels;
+                const ScalarFloat *ptr = m_data.get() + b * grain * channels;
+                size_t n = std::min(grain, count - b * grain);
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t c = 0; c < channels; ++c)
+                        out[c] = dr::maximum(out[c], *ptr++);
+            }
+        }
+    );
+
+    m_max = -dr::Infinity<ScalarFloat>;
+    m_max_per_channel.assign(channels, -dr::Infinity<ScalarFloat>);
+    for (size_t b = 0; b < blocks; ++b) {
+        for (size_t c = 0; c < channels; ++c) {
+            m_max_per_channel[c] = dr::maximum(m_max_per_channel[c],
+                                               partial[b * channels + c]);
+            m_max = dr::maximum(m_max, m_max_per_channel[c]);
+        }
+    }
+}
+
+MI_VARIANT
+typename VolumeGrid<Float, Spectrum>::ScalarVector3u
+VolumeGrid<Float, Spectrum>::brick_count() const {
+    if (m_brick_size == 0)
+        return ScalarVector3u(0);
+    return (m_size + (m_brick_size - 1)) / m_brick_size;
+}
+
+MI_VARIANT
+void VolumeGrid<Float, Spectrum>::compute_brick_bounds(uint32_t brick_size) {
+    if (brick_size == 0)
+        Throw("compute_brick_bounds(): the brick size must be positive!");
+    m_brick_size = brick_size;
+
+    ScalarVector3u count = brick_count();
+    size_t bricks = dr::prod(count);
+    m_brick_min.resize(bricks);
+    m_brick_max.resize(bricks);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, bricks, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            std::vector<float> voxels;
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                ScalarVector3u brick((uint32_t) (i % count.x()),
+                                     (uint32_t) ((i / count.x()) % count.y()),
+                                     (uint32_t) (i / ((size_t) count.x() * count.y())));
+                voxels.resize((size_t) dr::prod(detail::volume_brick_extent(
+                    m_size, brick, brick_size)) * m_channel_count);
+                detail::volume_copy_brick<true>(m_data.get(), m_size, m_channel_count,
+                                                brick, brick_size, voxels.data());
+                auto [lo, hi] = std::minmax_element(voxels.begin(), voxels.end());
+                m_brick_min[i] = (ScalarFloat) *lo;
+                m_brick_max[i] = (ScalarFloat) *hi;
+            }
+        }
+    );
+}
+
 MI_VARIANT
 void VolumeGrid<Float, Spectrum>::max_per_channel(ScalarFloat *out) const {
     for (size_t i=0; i<m_channel_count; ++i)
@@ -89,21 +281,21 @@ void VolumeGrid<Float, Spectrum>::max_per_channel(ScalarFloat *out) const {
 }
 
 MI_VARIANT
-void VolumeGrid<Float, Spectrum>::write(const fs::path &path) const {
+void VolumeGrid<Float, Spectrum>::write(const fs::path &path,
+                                        uint32_t brick_size) const {
     ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
-    write(fs);
+    write(fs, brick_size);
 }
 
 MI_VARIANT
-void VolumeGrid<Float, Spectrum>::write(Stream *stream) const {
+void VolumeGrid<Float, Spectrum>::write(Stream *stream, uint32_t brick_size) const {
     stream->write("VOL", 3);
-    stream->write(uint8_t(3)); // file format version
+    stream->write(uint8_t(brick_size == 0 ? 3 : 4)); // file format version
     stream->write(int32_t(1)); // data_type
     stream->write(int32_t(m_size.x()));
     stream->write(int32_t(m_size.y()));
     stream->write(int32_t(m_size.z()));
     stream->write(int32_t(m_channel_count));
-
     stream->write(float(m_bbox.min.x()));
     stream->write(float(m_bbox.min.y()));
     stream->write(float(m_bbox.min.z()));
@@ -111,15 +303,61 @@ void VolumeGrid<Float, Spectrum>::write(Stream *stream) const {
     stream->write(float(m_bbox.max.y()));
     stream->write(float(m_bbox.max.z()));
 
-    if constexpr (std::is_same<ScalarFloat, float>::value)
-        stream->write_array(m_data.get(), dr::prod(m_size) * m_channel_count);
-    else {
-        // Need to convert data to single precision before writing to disk
-        std::vector<float> output(dr::prod(m_size) * m_channel_count);
-        for (size_t i = 0; i < dr::prod(m_size) * m_channel_count; ++i)
-            output[i] = m_data[i];
-        stream->write_array(output.data(), dr::prod(m_size) * m_channel_count);
+    if (brick_size == 0) {
+        if constexpr (std::is_same<ScalarFloat, float>::value)
+            stream->write_array(m_data.get(), dr::prod(m_size) * m_channel_count);
+        else {
+            // Need to convert data to single precision before writing to disk
+            std::vector<float> output(dr::prod(m_size) * m_channel_count);
+            for (size_t i = 0; i < dr::prod(m_size) * m_channel_count; ++i)
+                output[i] = m_data[i];
+            stream->write_array(output.data(), dr::prod(m_size) * m_channel_count);
+        }
+        return;
     }
+
+    stream->write(int32_t(brick_size));
+    for (size_t i = 0; i < m_channel_count; ++i)
+        stream->write(float(m_max_per_channel[i]));
+
+    // Compress the bricks in parallel and compute their bounds
+    ScalarVector3u count = (m_size + (brick_size - 1)) / brick_size;
+    size_t bricks = dr::prod(count);
+    std::vector<std::vector<uint8_t>> compressed(bricks);
+    std::vector<float> brick_min(bricks), brick_max(bricks);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, bricks, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            std::vector<float> voxels;
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                ScalarVector3u brick((uint32_t) (i % count.x()),
+                                     (uint32_t) ((i / count.x()) % count.y()),
+                                     (uint32_t) (i / ((size_t) count.x() * count.y())));
+                voxels.resize((size_t) dr::prod(detail::volume_brick_extent(
+                    m_size, brick, brick_size)) * m_channel_count);
+                detail::volume_copy_brick<true>(m_data.get(), m_size, m_channel_count,
+                                                brick, brick_size, voxels.data());
+                auto [lo, hi] = std::minmax_element(voxels.begin(), voxels.end());
+                brick_min[i] = *lo;
+                brick_max[i] = *hi;
+                compressed[i] = BlockZStream::compress_block(
+                    voxels.data(), voxels.size() * sizeof(float));
+            }
+        }
+    );
+
+    uint64_t offset = 0;
+    for (size_t i = 0; i < bricks; ++i) {
+        stream->write(offset);
+        stream->write(uint32_t(compressed[i].size()));
+        stream->write(brick_min[i]);
+        stream->write(brick_max[i]);
+        offset += compressed[i].size();
+    }
+
+    for (size_t i = 0; i < bricks; ++i)
+        stream->write(compressed[i].data(), compressed[i].size());
 }
 
 MI_VARIANT
@@ -133,8 +371,11 @@ std::string VolumeGrid<Float, Spectrum>::to_string() const {
     for (uint32_t i=0; i<m_max_per_channel.size(); ++i)
         oss << m_max_per_channel[i] << ", ";
     oss << std::endl;
-    oss << "  ],"  << std::endl
-        << "  data = [ " << util::mem_string(buffer_size())
+    oss << "  ],"  << std::endl;
+    if (m_brick_size > 0)
+        oss << "  brick_size = " << m_brick_size << "," << std::endl
+            << "  brick_count = " << brick_count() << "," << std::endl;
+    oss << "  data = [ " << util::mem_string(buffer_size())
         << " of volume data ]" << std::endl
         << "]";
     return oss.str();
@@ -121,3 +121,55 @@ def test09_resampler_filter_only(variant_scalar_rgb):
     assert dr.allclose(b[0], (G(0) * a[0] + G(1) * (a[1] + a[2])) / (G(0) + 2*G(1)), atol=1e-4)
     assert dr.allclose(b[1], (G(0) * a[1] + G(1) * (a[0] + a[2])) / (G(0) + 2*G(1)), atol=1e-4)
     assert dr.allclose(b[2], (G(0) * a[2] + G(1) * (a[0] + a[1])) / (G(0) + 2*G(1)), atol=1e-4)
+
+
+@pytest.mark.parametrize('name', ['gaussian', 'mitchell', 'lanczos', 'tent'])
+def test10_sample(variants_vec_rgb, name):
+    f = mi.load_dict({'type': name})
+    r = f.radius()
+
+    # Reference integrals of the filter and of the filter times x^2
+    x = dr.linspace(mi.Float, -r, r, 100001)
+    fx = f.eval(x)
+    integral = dr.sum(fx)[0] * 2 * r / 100000
+    moment = dr.sum(fx * x * x)[0] * 2 * r / 100000
+
+    # Stratified samples
+    n = 256
+    u = (dr.arange(mi.Float, n * n) + 0.5) / (n * n)
+    sample = mi.Point2f(u, dr.fma(dr.arange(mi.Float, n * n) % n, 1 / n, 0.5 / n))
+    offset, weight = f.sample(sample)
+
+    assert dr.all(dr.abs(offset.x) <= r) and dr.all(dr.abs(offset.y) <= r)
+    assert dr.allclose(dr.mean(weight)[0], integral ** 2, rtol=1e-2)
+    assert dr.allclose(dr.mean(weight * offset.x * offset.x)[0],
+                       moment * integral, rtol=2e-2, atol=1e-4)
+
+
+def test11_render_filter_sampling(variants_all_rgb):
+    # Importance sampling the filter must converge to the splatted image
+    def render(filter_sampling):
+        scene = mi.load_dict({
+            'type': 'scene',
+            'integrator': {
+                'type': 'direct',
+                'filter_importance_sampling': filter_sampling
+            },
+            'sensor': {
+                'type': 'perspective',
+                'to_world': mi.ScalarTransform4f.look_at(
+                    origin=[0, 0, 4], target=[0, 0, 0], up=[0, 1, 0]),
+                'sampler': {'type': 'independent', 'sample_count': 1024},
+                'film': {
+                    'type': 'hdrfilm',
+                    'width': 8, 'height': 8,
+                    'rfilter': {'type': 'gaussian'}
+                }
+            },
+            'rect': {'type': 'rectangle', 'emitter': {'type': 'area'}},
+        })
+        return mi.render(scene, seed=0)
+
+    reference, image = render(False), render(True)
+    assert dr.allclose(dr.mean(dr.ravel(image)), dr.mean(dr.ravel(reference)), rtol=2e-2)
+    assert dr.allclose(image, reference, atol=0.1)
@@ -0,0 +1,162 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-philox:
+
+Counter-based sampler (:monosp:`philox`)
+----------------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel (Default: 4)
+
+ * - seed
+   - |int|
+   - Seed offset (Default: 0)
+
+ * - sample_offset
+   - |int|
+   - Index of the first sample generated for each pixel (Default: 0)
+
+Like the :ref:`independent <sampler-independent>` sampler, this plugin produces
+independent and uniformly distributed pseudorandom numbers. However, instead of
+advancing a random number generator, every sample component is computed as a
+pure function of the sequence (i.e. pixel), the sample index, and the
+dimension using the counter-based Philox4x32-10 generator by Salmon et al.
+:cite:`Salmon2011Parallel`.
+
+As a consequence, this sampler has no per-lane state: vectorized variants don't
+need to store, load, or scatter random number generator states across passes,
+which reduces the memory traffic of wavefront renderings with high sample
+counts. It also makes it possible to regenerate arbitrary subsets of the
+samples of a rendering. For instance, a distributed rendering can be split
+across machines by assigning each of them a different
+:monosp:`sample_offset`: a job with :monosp:`sample_offset=64` and
+:monosp:`sample_count=64` computes exactly the samples 64 to 127 of a
+rendering with 128 samples per pixel.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: philox-sampler
+
+        <sampler type="philox">
+            <integer name="sample_count" value="64"/>
+        </sampler>
+
+    .. code-tab:: python
+
+        'type': 'philox',
+        'sample_count': '64'
+
+ */
+
+template <typename Float, typename Spectrum>
+class PhiloxSampler final : public Sampler<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded,
+                   m_samples_per_wavefront, m_wavefront_size,
+                   m_dimension_index, current_sample_index)
+    MI_IMPORT_TYPES()
+
+    PhiloxSampler(const Properties &props) : Base(props) {
+        m_sample_offset = props.get<uint32_t>("sample_offset", 0);
+    }
+
+    ref<Sampler<Float, Spectrum>> fork() override {
+        PhiloxSampler *sampler = new PhiloxSampler(Properties());
+        sampler->m_sample_count          = m_sample_count;
+        sampler->m_samples_per_wavefront = m_samples_per_wavefront;
+        sampler->m_base_seed             = m_base_seed;
+        sampler->m_sample_offset         = m_sample_offset;
+        return sampler;
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        return new PhiloxSampler(*this);
+    }
+
+    void seed(uint32_t seed, uint32_t wavefront_size) override {
+        Base::seed(seed, wavefront_size);
+        m_seed = dr::opaque<UInt32>(seed);
+    }
+
+    Float next_1d(Mask /*active*/ = true) override {
+        Assert(seeded());
+        auto v = sample(m_dimension_index++);
+
+        if constexpr (std::is_same_v<ScalarFloat, double>)
+            return to_float64(v[0], v[1]);
+        else
+            return to_float32(v[0]);
+    }
+
+    Point2f next_2d(Mask /*active*/ = true) override {
+        Assert(seeded());
+        auto v = sample(m_dimension_index++);
+
+        if constexpr (std::is_same_v<ScalarFloat, double>)
+            return Point2f(to_float64(v[0], v[1]), to_float64(v[2], v[3]));
+        else
+            return Point2f(to_float32(v[0]), to_float32(v[1]));
+    }
+
+    void schedule_state() override {
+        Base::schedule_state();
+        dr::schedule(m_seed);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "PhiloxSampler [" << std::endl
+            << "  base_seed = " << m_base_seed << "," << std::endl
+            << "  sample_count = " << m_sample_count << "," << std::endl
+            << "  sample_offset = " << m_sample_offset << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    PhiloxSampler(const PhiloxSampler &sampler) : Base(sampler) {
+        m_sample_offset = sampler.m_sample_offset;
+        m_seed = sampler.m_seed;
+    }
+
+    /// Evaluate the generator for the current sample of every sequence
+    std::array<UInt32, 4> sample(const UInt32 &dimension) const {
+        UInt32 sequence_idx =
+            dr::arange<UInt32>(m_wavefront_size) / m_samples_per_wavefront;
+
+        return sample_philox4x32(current_sample_index() + m_sample_offset,
+                                 dimension, sequence_idx, m_seed,
+                                 UInt32(m_base_seed), UInt32(0x5851f42du));
+    }
+
+    static Float to_float32(const UInt32 &v) {
+        return dr::reinterpret_array<Float>(dr::sr<9>(v) | 0x3f800000u) - 1.f;
+    }
+
+    static Float to_float64(const UInt32 &lo, const UInt32 &hi) {
+        UInt64 v = UInt64(lo) | dr::sl<32>(UInt64(hi));
+        return dr::reinterpret_array<Float>(dr::sr<12>(v) | 0x3ff0000000000000ull) - 1.0;
+    }
+
+private:
+    /// Sample index offset (e.g. for distributed rendering)
+    uint32_t m_sample_offset;
+
+    /// Seed value passed to seed()
+    UInt32 m_seed;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(PhiloxSampler, Sampler)
+MI_EXPORT_PLUGIN(PhiloxSampler, "Philox Sampler");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,285 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/qmc.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-sobol:
+
+Sobol sampler (:monosp:`sobol`)
+-------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel. Should be a power of two (Default: 4)
+
+ * - seed
+   - |int|
+   - Seed offset (Default: 0)
+
+ * - decorrelation
+   - |string|
+   - Strategy used to decorrelate the sequences of different pixels. Must be
+     one of :monosp:`hash`, :monosp:`ordering`, or :monosp:`dither`
+     (Default: :monosp:`hash`)
+
+This plugin implements a sampler based on the Sobol' sequence randomized using
+the hash-based Owen scrambling technique introduced by Burley
+:cite:`Burley2020Practical`. Owen scrambling preserves the stratification of
+the underlying sequence while removing its regular structure, which leads to
+faster convergence than :ref:`ldsampler <sampler-ldsampler>` at a comparable
+cost.
+
+Every 1D or 2D sample dimension requested by the renderer draws from the first
+two dimensions of the Sobol' sequence, whose points form a (0, 2)-sequence in
+base 2. The sample order is shuffled independently for each dimension using a
+nested uniform scramble of the sample index, which decorrelates the dimensions
+without affecting the stratification of each individual one. All operations
+reduce to integer arithmetic evaluated without branches, which vectorizes well.
+
+By default (:monosp:`hash`), every pixel uses its own independently scrambled
+sequence, which produces a white-noise error distribution on the image plane.
+The two other strategies distribute the error as blue noise, which is
+perceptually less objectionable and easier to remove for denoisers:
+
+- :monosp:`ordering`: consecutive pixels consume consecutive blocks of a
+  single long sequence following the idea of Ahmed and Wonka
+  :cite:`Ahmed2020Screen`. The samples of two, four, ... neighboring pixels
+  then jointly stratify the integration domain. Neighboring pixels are
+  determined by the order in which the integrator seeds the per-pixel
+  sequences (Morton order within image blocks in scalar variants, scanline
+  order otherwise).
+
+- :monosp:`dither`: all pixels share the same scrambled point set, which is
+  toroidally shifted by the entries of a precomputed 256x256 blue-noise dither
+  mask (Cranley-Patterson rotation) following Georgiev and Fajardo
+  :cite:`Georgiev2016Blue`. Every dimension uses a differently offset copy
+  of the mask. This strategy is most effective at very low sample counts
+  (1-4 spp), e.g. for interactive previews. It requires the integrator to
+  report pixel positions, which all built-in sampling integrators do.
+
+The sample count is rounded up to the next power of two, as the stratification
+properties of the sequence are only maintained for such sample counts.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: sobol-sampler
+
+        <sampler type="sobol">
+            <integer name="sample_count" value="64"/>
+        </sampler>
+
+    .. code-tab:: python
+
+        'type': 'sobol',
+        'sample_count': '64'
+
+ */
+
+template <typename Float, typename Spectrum>
+class SobolSampler final : public Sampler<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded,
+                    m_samples_per_wavefront, m_wavefront_size, m_dimension_index,
+                    current_sample_index, compute_per_sequence_seed)
+    MI_IMPORT_TYPES()
+
+    using FloatStorage = DynamicBuffer<Float>;
+
+    SobolSampler(const Properties &props) : Base(props) {
+        std::string decorrelation = props.string("decorrelation", "hash");
+        if (decorrelation == "hash")
+            m_decorrelation = Decorrelation::Hash;
+        else if (decorrelation == "ordering")
+            m_decorrelation = Decorrelation::Ordering;
+        else if (decorrelation == "dither")
+            m_decorrelation = Decorrelation::Dither;
+        else
+            Throw("Invalid decorrelation strategy \"%s\", must be one of: "
+                  "\"hash\", \"ordering\", or \"dither\"!", decorrelation);
+
+        if constexpr (dr::is_jit_v<Float>) {
+            if (m_decorrelation == Decorrelation::Dither) {
+                std::unique_ptr<ScalarFloat[]> mask(new ScalarFloat[65536]);
+                for (size_t i = 0; i < 65536; ++i)
+                    mask[i] = (ScalarFloat) dither_matrix256[i] + .5f;
+                m_dither_mask = dr::load<FloatStorage>(mask.get(), 65536);
+            }
+        }
+
+        set_sample_count(m_sample_count);
+    }
+
+    void set_sample_count(uint32_t spp) override {
+        uint32_t res = math::round_to_power_of_two(std::max(spp, 1u));
+        if (spp != res)
+            Log(Warn, "Sample count should be a power of two, rounding to %i", res);
+        m_sample_count = res;
+    }
+
+    ref<Sampler<Float, Spectrum>> fork() override {
+        SobolSampler *sampler = new SobolSampler(Properties());
+        sampler->m_sample_count          = m_sample_count;
+        sampler->m_samples_per_wavefront = m_samples_per_wavefront;
+        sampler->m_base_seed             = m_base_seed;
+        sampler->m_decorrelation         = m_decorrelation;
+        sampler->m_dither_mask           = m_dither_mask;
+        return sampler;
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        return new SobolSampler(*this);
+    }
+
+    void seed(uint32_t seed, uint32_t wavefront_size) override {
+        Base::seed(seed, wavefront_size);
+
+        UInt32 sequence_idx = dr::arange<UInt32>(m_wavefront_size) /
+                              m_samples_per_wavefront;
+
+        if (m_decorrelation == Decorrelation::Hash) {
+            m_scramble_seed = compute_per_sequence_seed(seed);
+            m_index_offset = dr::zeros<UInt32>(m_wavefront_size);
+        } else {
+            // All pixels share one sequence
+            m_scramble_seed = sample_tea_32(dr::opaque<UInt32>(m_base_seed, 1),
+                                            UInt32(0x2c1b3c6d)).first;
+            if (m_decorrelation == Decorrelation::Ordering)
+                m_index_offset = (sequence_idx + dr::opaque<UInt32>(seed, 1)) *
+                                 m_sample_count;
+            else
+                m_index_offset = dr::zeros<UInt32>(m_wavefront_size);
+        }
+
+        /* Pseudorandom mask positions, used until the integrator reports
+           the actual pixel positions via set_pixel_position() */
+        if (m_decorrelation == Decorrelation::Dither) {
+            UInt32 hash = sample_tea_32(sequence_idx, dr::opaque<UInt32>(seed, 1)).first;
+            m_pixel_position = Point2u(hash & 0xFFu, (hash >> 8) & 0xFFu);
+        }
+    }
+
+    void set_pixel_position(const Point2u &pos) override {
+        if (m_decorrelation == Decorrelation::Dither)
+            m_pixel_position = pos;
+    }
+
+    Float next_1d(Mask /*active*/ = true) override {
+        Assert(seeded());
+
+        UInt32 sample_index = current_sample_index() + m_index_offset;
+        auto [shuffle_seed, scramble_seed] =
+            sample_tea_32(m_scramble_seed, m_dimension_index++);
+
+        Float value = owen_scrambled_sobol(sample_index, 0, shuffle_seed, scramble_seed);
+
+        if (m_decorrelation == Decorrelation::Dither)
+            value = rotate(value, dither_offset(scramble_seed));
+
+        return value;
+    }
+
+    Point2f next_2d(Mask /*active*/ = true) override {
+        Assert(seeded());
+
+        UInt32 sample_index = current_sample_index() + m_index_offset;
+        auto [shuffle_seed, scramble_seed_x] =
+            sample_tea_32(m_scramble_seed, m_dimension_index++);
+        UInt32 scramble_seed_y =
+            sample_tea_32(scramble_seed_x, UInt32(0x1b873593)).first;
+
+        // Both axes must be shuffled identically to preserve the 2D stratification
+        sample_index = nested_uniform_scramble(sample_index, shuffle_seed);
+
+        UInt32 x = nested_uniform_scramble(sobol_sample(sample_index, 0), scramble_seed_x),
+               y = nested_uniform_scramble(sobol_sample(sample_index, 1), scramble_seed_y);
+
+        Point2f value = dr::minimum(Point2f(Float(x), Float(y)) * Float(0x1p-32),
+                                    dr::OneMinusEpsilon<Float>);
+
+        if (m_decorrelation == Decorrelation::Dither)
+            value = Point2f(rotate(value.x(), dither_offset(scramble_seed_x)),
+                            rotate(value.y(), dither_offset(scramble_seed_y)));
+
+        return value;
+    }
+
+    void schedule_state() override {
+        Base::schedule_state();
+        dr::schedule(m_scramble_seed, m_index_offset, m_pixel_position);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SobolSampler [" << std::endl
+            << "  sample_count = " << m_sample_count << "," << std::endl
+            << "  decorrelation = " << decorrelation_name() << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    enum class Decorrelation { Hash, Ordering, Dither };
+
+    SobolSampler(const SobolSampler &sampler) : Base(sampler) {
+        m_decorrelation = sampler.m_decorrelation;
+        m_dither_mask = sampler.m_dither_mask;
+        m_scramble_seed = sampler.m_scramble_seed;
+        m_index_offset = sampler.m_index_offset;
+        m_pixel_position = sampler.m_pixel_position;
+    }
+
+    /// Look up the dither mask at the current pixel, offset by a per-dimension seed
+    Float dither_offset(const UInt32 &seed) const {
+        UInt32 x = (m_pixel_position.x() + seed) & 0xFFu,
+               y = (m_pixel_position.y() + (seed >> 8)) & 0xFFu,
+               index = (y << 8) | x;
+
+        if constexpr (dr::is_jit_v<Float>)
+            return dr::gather<Float>(m_dither_mask, index);
+        else
+            return (Float) dither_matrix256[index] + .5f;
+    }
+
+    /// Cranley-Patterson rotation of a sample value by the given offset
+    static Float rotate(const Float &value, const Float &offset) {
+        Float result = value + offset;
+        dr::masked(result, result >= 1.f) -= 1.f;
+        return dr::minimum(result, dr::OneMinusEpsilon<Float>);
+    }
+
+    const char *decorrelation_name() const {
+        switch (m_decorrelation) {
+            case Decorrelation::Ordering: return "ordering";
+            case Decorrelation::Dither:   return "dither";
+            default:                      return "hash";
+        }
+    }
+
+private:
+    /// Strategy used to decorrelate the sequences of different pixels
+    Decorrelation m_decorrelation;
+
+    /// Blue-noise dither mask mapped to [0, 1] (JIT variants only)
+    FloatStorage m_dither_mask;
+
+    /// Per-sequence scramble seed
+    UInt32 m_scramble_seed;
+
+    /// Offset of the per-pixel samples in the scrambled sequence
+    UInt32 m_index_offset;
+
+    /// Pixel position of each sequence (used for the dither mask lookups)
+    Point2u m_pixel_position;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SobolSampler, Sampler)
+MI_EXPORT_PLUGIN(SobolSampler, "Sobol Sampler");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,89 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+from .utils import check_deep_copy_sampler_scalar, check_deep_copy_sampler_wavefront
+
+
+def test01_philox_known_answers(variant_scalar_rgb):
+    # Known-answer tests of the Random123 reference implementation
+    assert mi.sample_philox4x32(0, 0, 0, 0, 0, 0) == \
+        [0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8]
+    m = 0xffffffff
+    assert mi.sample_philox4x32(m, m, m, m, m, m) == \
+        [0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd]
+    assert mi.sample_philox4x32(0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                0x03707344, 0xa4093822, 0x299f31d0) == \
+        [0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1]
+
+
+def test02_uniform(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type" : "philox",
+        "sample_count" : 64,
+    })
+    sampler.set_samples_per_wavefront(64)
+    sampler.seed(0, 64 * 1024)
+
+    for i in range(3):
+        v = np.array(sampler.next_1d())
+        assert np.all((v >= 0) & (v < 1))
+        assert np.abs(np.mean(v) - 0.5) < 0.01
+        assert np.abs(np.var(v) - 1 / 12) < 0.01
+
+        v2 = sampler.next_2d()
+        x, y = np.array(v2.x), np.array(v2.y)
+        assert np.abs(np.corrcoef(x, y)[0, 1]) < 0.02
+        assert np.abs(np.corrcoef(v, x)[0, 1]) < 0.02
+
+
+def test03_regenerate_sample_ranges(variants_vec_backends_once):
+    pixel_count = 256
+
+    def make_sampler(spp, samples_per_wavefront, sample_offset=0):
+        sampler = mi.load_dict({
+            "type" : "philox",
+            "sample_count" : spp,
+            "sample_offset" : sample_offset
+        })
+        sampler.set_samples_per_wavefront(samples_per_wavefront)
+        sampler.seed(3, pixel_count * samples_per_wavefront)
+        return sampler
+
+    # Reference: all 16 samples of each pixel in a single pass
+    sampler = make_sampler(16, 16)
+    sampler.next_1d()
+    ref = np.array(sampler.next_2d().y).reshape(pixel_count, 16)
+
+    # Multi-pass rendering with four samples per pass
+    sampler = make_sampler(16, 4)
+    for i in range(4):
+        sampler.next_1d()
+        value = np.array(sampler.next_2d().y).reshape(pixel_count, 4)
+        assert np.all(value == ref[:, 4 * i:4 * (i + 1)])
+        sampler.advance()
+
+    # Second half of the samples, e.g. computed by another machine
+    sampler = make_sampler(8, 8, sample_offset=8)
+    sampler.next_1d()
+    value = np.array(sampler.next_2d().y).reshape(pixel_count, 8)
+    assert np.all(value == ref[:, 8:])
+
+
+def test04_copy_sampler_scalar(variants_any_scalar):
+    sampler = mi.load_dict({
+        "type" : "philox",
+        "sample_count" : 1024
+    })
+
+    check_deep_copy_sampler_scalar(sampler)
+
+
+def test05_copy_sampler_wavefront(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type" : "philox",
+        "sample_count" : 1024
+    })
+
+    check_deep_copy_sampler_wavefront(sampler)
@@ -0,0 +1,145 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+from .utils import ( check_uniform_scalar_sampler, check_uniform_wavefront_sampler,
+                     check_deep_copy_sampler_scalar, check_deep_copy_sampler_wavefront )
+
+@pytest.mark.parametrize('decorrelation', ['hash', 'ordering'])
+def test01_sobol_scalar(variant_scalar_rgb, decorrelation):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+        "decorrelation" : decorrelation
+    })
+    sampler.seed(0)
+
+    check_uniform_scalar_sampler(sampler)
+
+
+@pytest.mark.parametrize('decorrelation', ['hash', 'ordering'])
+def test02_sobol_wavefront(variants_vec_backends_once, decorrelation):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+        "decorrelation" : decorrelation
+    })
+    sampler.seed(0, 1024)
+
+    check_uniform_wavefront_sampler(sampler)
+
+
+def test03_sobol_stratification(variant_scalar_rgb):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 16,
+    })
+    assert sampler.sample_count() == 16
+
+    # Every 2D dimension is a (0, 4, 2)-net: one sample per elementary interval
+    for seed in range(4):
+        sampler.seed(seed)
+        values = []
+        for i in range(16):
+            values.append([sampler.next_2d() for d in range(4)])
+            sampler.advance()
+        values = np.array(values)
+
+        for d in range(4):
+            for rx, ry in [(16, 1), (8, 2), (4, 4), (2, 8), (1, 16)]:
+                cells = np.int32(values[:, d, 0] * rx) * ry + np.int32(values[:, d, 1] * ry)
+                assert len(np.unique(cells)) == 16
+
+        # Different dimensions are decorrelated
+        assert not np.allclose(values[:, 0], values[:, 1])
+
+
+def test04_sobol_ordering(variants_vec_backends_once):
+    spp, pixel_count = 4, 16
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : spp,
+        "decorrelation" : "ordering"
+    })
+    sampler.set_samples_per_wavefront(spp)
+    sampler.seed(0, spp * pixel_count)
+
+    for dim in range(3):
+        v = np.array(sampler.next_1d())
+
+        # The samples of a group of 1, 2, 4, .. consecutive pixels are
+        # jointly stratified
+        for group in [1, 2, 4, 8, 16]:
+            n = spp * group
+            bins = np.int32(v * n).reshape(-1, n)
+            for b in bins:
+                assert len(np.unique(b)) == n
+
+    # With hashing, the pixels are scrambled independently
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : spp
+    })
+    sampler.set_samples_per_wavefront(spp)
+    sampler.seed(0, spp * pixel_count)
+    v = np.array(sampler.next_1d())
+    bins = np.int32(v * spp * pixel_count)
+    assert len(np.unique(bins)) < spp * pixel_count
+
+
+def test05_sobol_dither(variants_vec_backends_once):
+    res = 64
+
+    def sample_image(decorrelation):
+        sampler = mi.load_dict({
+            "type" : "sobol",
+            "sample_count" : 1,
+            "decorrelation" : decorrelation
+        })
+        sampler.set_samples_per_wavefront(1)
+        sampler.seed(0, res * res)
+
+        idx = dr.arange(mi.UInt32, res * res)
+        sampler.set_pixel_position(mi.Point2u(idx % res, idx // res))
+
+        sampler.next_2d()
+        return np.array(sampler.next_1d()).reshape(res, res)
+
+    def low_frequency_power(image):
+        spectrum = np.abs(np.fft.fft2(image - np.mean(image)))**2
+        freq = np.fft.fftfreq(res)
+        fx, fy = np.meshgrid(freq, freq)
+        return np.mean(spectrum[np.sqrt(fx**2 + fy**2) < 0.15])
+
+    dither, hashed = sample_image("dither"), sample_image("hash")
+
+    # The samples remain uniformly distributed
+    hist = np.histogram(dither, bins=16, range=(0, 1))[0]
+    assert np.all(np.abs(hist - res * res / 16) < res * res / 16 * 0.2)
+
+    # .. but their error is pushed towards high frequencies
+    assert low_frequency_power(dither) < 0.5 * low_frequency_power(hashed)
+
+    with pytest.raises(RuntimeError):
+        mi.load_dict({ "type" : "sobol", "decorrelation" : "foo" })
+
+
+def test06_copy_sampler_scalar(variants_any_scalar):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0)
+
+    check_deep_copy_sampler_scalar(sampler)
+
+
+def test07_copy_sampler_wavefront(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0, 1024)
+
+    check_deep_copy_sampler_wavefront(sampler)
@@ -28,6 +28,11 @@ This plugin can currently only be used in path tracing-style integrators, and
 it is incompatible with the particle tracer. The horizontal resolution of the
 film associated with this sensor must be a multiple of the number of
 sub-sensors.
+
+The Python function :py:func:`mitsuba.render_batch()` and the ``-b`` flag of
+the command line interface construct a batch sensor from existing sensors of
+identical resolution, render it in a single pass, and split the result into
+separate images, one per sub-sensor.
 */
 
 MI_VARIANT class BatchSensor final : public Sensor<Float, Spectrum> {
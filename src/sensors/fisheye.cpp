@@ -0,0 +1,281 @@
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/bbox.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-fisheye:
+
+Fisheye camera (:monosp:`fisheye`)
+----------------------------------
+
+.. pluginparameters::
+
+ * - to_world
+   - |transform|
+   - Specifies an optional camera-to-world transformation.
+     (Default: none (i.e. camera space = world space))
+   - |exposed|
+
+ * - fov
+   - |float|
+   - Field of view of the image circle in degrees, between 0 and 360.
+     (Default: 180)
+
+ * - mapping
+   - |string|
+   - Projection of the lens: :monosp:`equidistant` (the distance to the
+     image center is proportional to the angle to the optical axis) or
+     :monosp:`equisolid` (every pixel covers the same solid angle).
+     (Default: :monosp:`equidistant`)
+
+This plugin implements a pinhole camera with a fisheye projection that is
+centered on the positive Z axis of the camera. The field of view is mapped onto
+the largest circle that fits into the image, and the pixels outside of this
+circle are black. With a field of view of 180 degrees, the image covers a
+hemisphere (e.g. for dome projections), and with 360 degrees the full sphere
+of directions.
+
+The :monosp:`equisolid` mapping is the equal-area projection: since every
+pixel of the image circle covers the same solid angle, the samples that the
+renderer distributes uniformly over the image are also uniformly distributed
+in solid angle, and no part of the field of view is over-sampled. The
+:monosp:`equidistant` mapping matches most physical fisheye lenses, but
+compresses the directions near the border of wide image circles.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: fisheye-sensor
+
+        <sensor type="fisheye">
+            <float name="fov" value="180"/>
+            <string name="mapping" value="equisolid"/>
+            <transform name="to_world">
+                <look_at origin="0, 0, 0" target="0, 1, 0" up="0, 0, 1"/>
+            </transform>
+            <film type="hdrfilm">
+                <integer name="width" value="2048"/>
+                <integer name="height" value="2048"/>
+            </film>
+        </sensor>
+
+    .. code-tab:: python
+
+        'type': 'fisheye',
+        'fov': 180,
+        'mapping': 'equisolid',
+        'to_world': mi.ScalarTransform4f.look_at(
+            origin=[0, 0, 0],
+            target=[0, 1, 0],
+            up=[0, 0, 1]
+        ),
+        'film': {
+            'type': 'hdrfilm',
+            'width': 2048,
+            'height': 2048
+        }
+
+ */
+
+template <typename Float, typename Spectrum>
+class FisheyeCamera final : public Sensor<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sensor, m_to_world, m_film, m_resolution,
+                   m_needs_sample_3, sample_wavelengths)
+    MI_IMPORT_TYPES()
+
+    FisheyeCamera(const Properties &props) : Base(props) {
+        if (m_to_world.scalar().has_scale())
+            Throw("Scale factors in the camera-to-world transformation are not allowed!");
+
+        ScalarFloat fov = props.get<ScalarFloat>("fov", 180.f);
+        if (fov <= 0.f || fov > 360.f)
+            Throw("The field of view must be in the range (0, 360]!");
+        m_theta_max = dr::deg_to_rad(fov) * .5f;
+
+        std::string mapping = props.string("mapping", "equidistant");
+        if (mapping == "equidistant")
+            m_equisolid = false;
+        else if (mapping == "equisolid")
+            m_equisolid = true;
+        else
+            Throw("Invalid mapping \"%s\", must be \"equidistant\" or \"equisolid\"!",
+                  mapping);
+        m_sin_half_theta_max = dr::sin(m_theta_max * .5f);
+
+        m_needs_sample_3 = false;
+        update_film_transform();
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("to_world", *m_to_world.ptr(), +ParamFlags::NonDifferentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        Base::parameters_changed(keys);
+        if (keys.empty() || string::contains(keys, "to_world")) {
+            if (m_to_world.scalar().has_scale())
+                Throw("Scale factors in the camera-to-world transformation are not allowed!");
+        }
+        update_film_transform();
+    }
+
+    /// Precompute the image circle (in pixels of the full film)
+    void update_film_transform() {
+        ScalarVector2f film_size(m_film->size());
+        m_center = film_size * .5f;
+        m_radius = dr::min(film_size) * .5f;
+        m_crop_offset = ScalarVector2f(m_film->crop_offset());
+    }
+
+    /// Map an offset from the image center (in units of the circle radius) to a local direction
+    std::pair<Vector3f, Mask> offset_to_direction(const Vector2f &offset) const {
+        Float r = dr::norm(offset);
+        Mask valid = r <= 1.f;
+
+        Float theta;
+        if (m_equisolid)
+            theta = 2.f * dr::safe_asin(r * m_sin_half_theta_max);
+        else
+            theta = r * m_theta_max;
+
+        auto [sin_theta, cos_theta] = dr::sincos(theta);
+        Vector2f dir = dr::select(r > 0.f, offset / r, Vector2f(0.f));
+        Vector3f d(-sin_theta * dir.x(), -sin_theta * dir.y(), cos_theta);
+        return { dr::select(valid, d, Vector3f(0.f, 0.f, 1.f)), valid };
+    }
+
+    /**
+     * \brief Ratio between the image area (in pixels) and the solid angle
+     * of a differential region at the polar angle \c theta
+     */
+    Float area_per_solid_angle(const Float &theta) const {
+        ScalarFloat r2 = dr::square(m_radius);
+        if (m_equisolid)
+            return r2 / (4.f * dr::square(m_sin_half_theta_max));
+
+        Float sin_theta = dr::sin(theta);
+        return dr::select(sin_theta > 1e-6f,
+                          r2 * theta / (dr::square(m_theta_max) * sin_theta),
+                          r2 / dr::square(m_theta_max));
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        auto [ray, weight] = sample_ray_differential(
+            time, wavelength_sample, position_sample, aperture_sample, active);
+        return { Ray3f(ray), weight };
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f & /*aperture_sample*/,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(dr::zeros<SurfaceInteraction3f>(),
+                               wavelength_sample,
+                               active);
+        RayDifferential3f ray;
+        ray.time = time;
+        ray.wavelengths = wavelengths;
+
+        // Offset from the center of the image circle
+        Point2f pixel = dr::fmadd(position_sample, m_resolution, m_crop_offset);
+        Vector2f offset = (pixel - m_center) / m_radius;
+
+        Transform4f trafo = m_to_world.value();
+        auto [d, valid] = offset_to_direction(offset);
+        ray.o = trafo.translation();
+        ray.d = trafo * d;
+
+        ray.o_x = ray.o_y = ray.o;
+        ray.d_x = trafo * offset_to_direction(offset + Vector2f(1.f / m_radius, 0.f)).first;
+        ray.d_y = trafo * offset_to_direction(offset + Vector2f(0.f, 1.f / m_radius)).first;
+        ray.has_differentials = true;
+
+        return { ray, dr::select(valid, wav_weight, 0.f) };
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f & /*sample*/,
+                     Mask active) const override {
+        // Transform the reference point into the local coordinate system
+        Transform4f trafo = m_to_world.value();
+        Vector3f local_d(trafo.inverse().transform_affine(it.p));
+
+        Float dist     = dr::norm(local_d);
+        Float inv_dist = dr::rcp(dist);
+        local_d *= inv_dist;
+
+        // Invert the projection of the lens
+        Float theta     = dr::safe_acos(local_d.z()),
+              sin_theta = dr::safe_sqrt(1.f - dr::square(local_d.z()));
+        Float r;
+        if (m_equisolid)
+            r = dr::sin(theta * .5f) / m_sin_half_theta_max;
+        else
+            r = theta / m_theta_max;
+
+        Vector2f dir = dr::select(sin_theta > 0.f,
+                                  -Vector2f(local_d.x(), local_d.y()) / sin_theta,
+                                  Vector2f(0.f));
+
+        // Position relative to the crop window (in pixels)
+        DirectionSample3f ds = dr::zeros<DirectionSample3f>();
+        ds.uv = dr::fmadd(dir, r * m_radius, m_center) - m_crop_offset;
+        active &= dist > 0.f && theta <= m_theta_max &&
+                  dr::all(ds.uv >= 0.f && ds.uv <= m_resolution);
+
+        /* Solid angle density of the sampling strategy of
+           sample_ray(), which samples the crop window uniformly */
+        Float density = area_per_solid_angle(theta) / dr::prod(m_resolution);
+
+        ds.p    = trafo.translation();
+        ds.d    = (ds.p - it.p) * inv_dist;
+        ds.dist = dist;
+        ds.n    = trafo * Vector3f(0.f, 0.f, 1.f);
+        ds.pdf  = dr::select(active, Float(1.f), Float(0.f));
+
+        return { ds, Spectrum(dr::select(active, density * inv_dist * inv_dist, 0.f)) };
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        ScalarPoint3f p = m_to_world.scalar() * ScalarPoint3f(0.f);
+        return ScalarBoundingBox3f(p, p);
+    }
+
+    std::string to_string() const override {
+        using string::indent;
+
+        std::ostringstream oss;
+        oss << "FisheyeCamera[" << std::endl
+            << "  fov = " << dr::rad_to_deg(2.f * m_theta_max) << "," << std::endl
+            << "  mapping = " << (m_equisolid ? "equisolid" : "equidistant") << "," << std::endl
+            << "  film = " << indent(m_film) << "," << std::endl
+            << "  to_world = " << indent(m_to_world, 13) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    ScalarFloat m_theta_max;
+    ScalarFloat m_sin_half_theta_max;
+    bool m_equisolid;
+    ScalarVector2f m_center;
+    ScalarFloat m_radius;
+    ScalarVector2f m_crop_offset;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(FisheyeCamera, Sensor)
+MI_EXPORT_PLUGIN(FisheyeCamera, "Fisheye Camera");
+NAMESPACE_END(mitsuba)
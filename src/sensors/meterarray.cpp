@@ -0,0 +1,278 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-meterarray:
+
+Meter array (:monosp:`meterarray`)
+----------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Text file that lists one measurement point per line, as six
+     whitespace-separated numbers: the position and the normal (or
+     direction) in world coordinates. Lines starting with :monosp:`#` are
+     ignored.
+
+ * - mode
+   - |string|
+   - Quantity measured at every point: :monosp:`irradiance` (like the
+     :ref:`irradiancemeter <sensor-irradiancemeter>`, over the hemisphere
+     around the normal) or :monosp:`radiance` (like the
+     :ref:`radiancemeter <sensor-radiancemeter>`, along the given
+     direction). (Default: :monosp:`irradiance`)
+
+ * - srf
+   - |spectrum|
+   - Sensor Response Function that defines the :ref:`spectral sensitivity <explanation_srf_sensor>`
+     of the sensor (Default: :monosp:`none`)
+
+ * - points
+   - |tensor|
+   - Flat array of the positions of the measurement points. Without a
+     :monosp:`filename`, the film width determines their number, and they
+     are initialized to the origin (with normals facing +Z).
+   - |exposed|
+
+ * - normals
+   - |tensor|
+   - Flat array of the normals (or directions) of the measurement points.
+   - |exposed|
+
+This sensor records a large number of point measurements in a single render,
+e.g. the irradiance on the grid of a daylight analysis. Every measurement point
+corresponds to one pixel of a film with a height of one pixel, whose width must
+match the number of points. Compared to a scene containing one
+:ref:`irradiancemeter <sensor-irradiancemeter>` or
+:ref:`radiancemeter <sensor-radiancemeter>` per point, which have to be
+rendered one by one, the measurements of all points are computed by the same
+render call (i.e. in a single wavefront in JIT variants).
+
+The points can be loaded from a file or replaced from Python:
+
+.. code-block:: python
+
+    params = mi.traverse(sensor)
+    params['points'] = mi.Float(positions.ravel())
+    params['normals'] = mi.Float(normals.ravel())
+    params.update()
+
+The number of points must not change, and the film should use a box
+reconstruction filter.
+
+.. tabs::
+    .. code-tab:: xml
+
+        <sensor type="meterarray">
+            <string name="filename" value="grid.txt"/>
+            <film type="hdrfilm">
+                <integer name="width" value="500000"/>
+                <integer name="height" value="1"/>
+                <rfilter type="box"/>
+            </film>
+        </sensor>
+
+    .. code-tab:: python
+
+        'type': 'meterarray',
+        'filename': 'grid.txt',
+        'film': {
+            'type': 'hdrfilm',
+            'width': 500000,
+            'height': 1,
+            'rfilter': { 'type': 'box' }
+        }
+*/
+
+MI_VARIANT class MeterArray final : public Sensor<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sensor, m_film, m_needs_sample_2, m_needs_sample_3,
+                   sample_wavelengths)
+    MI_IMPORT_TYPES()
+    using FloatStorage = DynamicBuffer<Float>;
+
+    MeterArray(const Properties &props) : Base(props) {
+        std::string mode = props.string("mode", "irradiance");
+        if (mode == "irradiance")
+            m_radiance = false;
+        else if (mode == "radiance")
+            m_radiance = true;
+        else
+            Throw("Invalid mode \"%s\", must be \"irradiance\" or \"radiance\"!",
+                  mode);
+
+        if (props.has_property("to_world"))
+            Throw("Found a 'to_world' transformation -- this is not allowed. "
+                  "The points of the meter array are given in world space.");
+
+        std::vector<ScalarFloat> points, normals;
+        if (props.has_property("filename")) {
+            load_points(props.string("filename"), points, normals);
+        } else {
+            // Placeholder points facing +Z, to be replaced via traverse()
+            for (uint32_t i = 0; i < m_film->size().x(); ++i) {
+                points.insert(points.end(), { 0.f, 0.f, 0.f });
+                normals.insert(normals.end(), { 0.f, 0.f, 1.f });
+            }
+        }
+
+        m_count = (uint32_t) (points.size() / 3);
+        if (m_count == 0)
+            Throw("The meter array does not contain any points!");
+
+        if (m_film->size() != ScalarPoint2u(m_count, 1))
+            Throw("The film of the meter array must have a size of %u x 1 "
+                  "pixels, i.e. one pixel per point (currently %u x %u)!",
+                  m_count, m_film->size().x(), m_film->size().y());
+
+        if (m_film->rfilter()->radius() > .5f + math::RayEpsilon<Float>)
+            Log(Warn, "This sensor should only be used with a reconstruction filter "
+                      "of radius 0.5 or lower (e.g. default 'box' filter)");
+
+        m_points  = dr::load<FloatStorage>(points.data(), points.size());
+        m_normals = dr::load<FloatStorage>(normals.data(), normals.size());
+
+        m_needs_sample_2 = false;
+        m_needs_sample_3 = !m_radiance;
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("points", m_points, +ParamFlags::NonDifferentiable);
+        callback->put_parameter("normals", m_normals, +ParamFlags::NonDifferentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        Base::parameters_changed(keys);
+        if (dr::width(m_points) != 3 * m_count ||
+            dr::width(m_normals) != 3 * m_count)
+            Throw("The number of points and normals of the meter array must "
+                  "remain %u!", m_count);
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f &aperture_sample,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Look up the measurement point of the pixel
+        UInt32 index = dr::minimum(
+            UInt32(position_sample.x() * (ScalarFloat) m_count), m_count - 1);
+        Point3f p  = dr::gather<Point3f>(m_points, index, active);
+        Vector3f n = dr::normalize(dr::gather<Vector3f>(m_normals, index, active));
+
+        // 2. Sample spectrum
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(dr::zeros<SurfaceInteraction3f>(),
+                               wavelength_sample, active);
+
+        // 3. Set the direction (cosine-weighted for irradiance measurements)
+        Vector3f d = n;
+        Spectrum weight = wav_weight;
+        if (!m_radiance) {
+            d = Frame3f(n).to_world(
+                warp::square_to_cosine_hemisphere(aperture_sample));
+            weight = depolarizer<Spectrum>(wav_weight) * dr::Pi<ScalarFloat>;
+        }
+
+        RayDifferential3f ray(p + d * math::RayEpsilon<Float>, d, time,
+                              wavelengths);
+        ray.has_differentials = false;
+
+        return { ray, weight };
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        auto [ray, weight] = sample_ray_differential(
+            time, wavelength_sample, position_sample, aperture_sample, active);
+        return { Ray3f(ray), weight };
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        // Return an invalid bounding box
+        return ScalarBoundingBox3f();
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MeterArray[" << std::endl
+            << "  mode = " << (m_radiance ? "radiance" : "irradiance") << "," << std::endl
+            << "  count = " << m_count << "," << std::endl
+            << "  film = " << string::indent(m_film) << "," << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Parse a text file with one line "px py pz nx ny nz" per point
+    void load_points(const std::string &filename,
+                     std::vector<ScalarFloat> &points,
+                     std::vector<ScalarFloat> &normals) const {
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(filename);
+        if (!fs::exists(file_path))
+            Throw("\"%s\": file does not exist!", file_path);
+
+        Log(Info, "Loading measurement points from \"%s\" ..", file_path);
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path, false);
+        char *current = (char *) mmap->data(),
+             *end     = current + mmap->size(),
+             *tmp;
+        bool comment = false;
+        size_t counter = 0, line = 1;
+        while (current != end) {
+            char c = *current;
+            if (c == '#') {
+                comment = true;
+                current++;
+            } else if (c == '\n') {
+                if (counter != 0 && counter != 6)
+                    Throw("\"%s\": line %zu must contain 6 values (found %zu)!",
+                          file_path, line, counter);
+                comment = false;
+                counter = 0;
+                line++;
+                current++;
+            } else if (!comment && c != ' ' && c != '\t' && c != '\r') {
+                ScalarFloat value = string::parse_float<ScalarFloat>(current, end, &tmp);
+                current = tmp;
+                if (counter >= 6)
+                    Throw("\"%s\": line %zu contains more than 6 values!",
+                          file_path, line);
+                (counter < 3 ? points : normals).push_back(value);
+                counter++;
+            } else {
+                current++;
+            }
+        }
+
+        if (counter != 0 && counter != 6)
+            Throw("\"%s\": line %zu must contain 6 values (found %zu)!",
+                  file_path, line, counter);
+    }
+
+    FloatStorage m_points;
+    FloatStorage m_normals;
+    uint32_t m_count;
+    bool m_radiance;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(MeterArray, Sensor)
+MI_EXPORT_PLUGIN(MeterArray, "Meter array");
+NAMESPACE_END(mitsuba)
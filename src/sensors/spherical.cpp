@@ -0,0 +1,240 @@
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/bbox.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-spherical:
+
+Spherical panoramic camera (:monosp:`spherical`)
+------------------------------------------------
+
+.. pluginparameters::
+
+ * - to_world
+   - |transform|
+   - Specifies an optional camera-to-world transformation.
+     (Default: none (i.e. camera space = world space))
+   - |exposed|
+
+This plugin implements a pinhole camera that records the full sphere of
+directions around its position into an image in the equirectangular
+(latitude-longitude) format used by environment maps and VR panoramas. The
+center of the image looks along the positive Z axis of the camera, the
+horizontal axis spans 360 degrees of longitude, and the vertical axis spans
+180 degrees of latitude, from the positive Y axis ("up") at the top to the
+negative Y axis at the bottom. An aspect ratio of 2:1 yields square pixels.
+
+The pixels near the poles of an equirectangular image cover a much smaller
+solid angle than those at the horizon. Rather than sampling the pixels
+uniformly in image space (which concentrates samples near the poles in
+terms of solid angle), this sensor warps the sample positions within every
+row of pixels so that they are uniformly distributed in solid angle, which
+makes every pixel an unbiased estimate of the average radiance over its solid
+angle. The warp never moves a sample into another pixel, hence it is best used
+with the (default) :ref:`box <rfilter-box>` reconstruction filter. Large
+panoramas are split into image blocks like any other render, and the sensor
+also supports the :ref:`particle tracer <integrator-ptracer>`.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: spherical-sensor
+
+        <sensor type="spherical">
+            <transform name="to_world">
+                <look_at origin="0, 1, 0" target="0, 1, 1" up="0, 1, 0"/>
+            </transform>
+            <film type="hdrfilm">
+                <integer name="width" value="4096"/>
+                <integer name="height" value="2048"/>
+            </film>
+        </sensor>
+
+    .. code-tab:: python
+
+        'type': 'spherical',
+        'to_world': mi.ScalarTransform4f.look_at(
+            origin=[0, 1, 0],
+            target=[0, 1, 1],
+            up=[0, 1, 0]
+        ),
+        'film': {
+            'type': 'hdrfilm',
+            'width': 4096,
+            'height': 2048
+        }
+
+ */
+
+template <typename Float, typename Spectrum>
+class SphericalCamera final : public Sensor<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sensor, m_to_world, m_film, m_resolution,
+                   m_needs_sample_3, sample_wavelengths)
+    MI_IMPORT_TYPES()
+
+    SphericalCamera(const Properties &props) : Base(props) {
+        if (m_to_world.scalar().has_scale())
+            Throw("Scale factors in the camera-to-world transformation are not allowed!");
+
+        m_needs_sample_3 = false;
+        update_film_transform();
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("to_world", *m_to_world.ptr(), +ParamFlags::NonDifferentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        Base::parameters_changed(keys);
+        if (keys.empty() || string::contains(keys, "to_world")) {
+            if (m_to_world.scalar().has_scale())
+                Throw("Scale factors in the camera-to-world transformation are not allowed!");
+        }
+        update_film_transform();
+    }
+
+    /// Precompute the mapping from crop-relative to full-film coordinates
+    void update_film_transform() {
+        ScalarVector2f film_size(m_film->size());
+        m_film_size = film_size;
+        m_crop_scale = ScalarVector2f(m_film->crop_size()) / film_size;
+        m_crop_offset = ScalarVector2f(m_film->crop_offset()) / film_size;
+    }
+
+    /// Map coordinates in [0, 1]^2 of the full image to a local direction
+    Vector3f uv_to_direction(const Point2f &uv) const {
+        auto [sin_phi, cos_phi] = dr::sincos(dr::TwoPi<Float> * (uv.x() - .5f));
+        auto [sin_theta, cos_theta] = dr::sincos(dr::Pi<Float> * uv.y());
+        return Vector3f(-sin_theta * sin_phi, cos_theta, sin_theta * cos_phi);
+    }
+
+    /// Cosine of the polar angles bounding the pixel row that contains \c v
+    std::pair<Float, Float> row_bounds(const Float &v) const {
+        Float row = dr::clamp(dr::floor(v * m_film_size.y()), 0.f,
+                              m_film_size.y() - 1.f);
+        return { dr::cos(dr::Pi<Float> * row / m_film_size.y()),
+                 dr::cos(dr::Pi<Float> * (row + 1.f) / m_film_size.y()) };
+    }
+
+    /**
+     * \brief Warp a position in the full image so that the samples of every
+     * pixel row are uniformly distributed in solid angle
+     */
+    Point2f warp_row(const Point2f &uv) const {
+        auto [cos_0, cos_1] = row_bounds(uv.y());
+        Float t = uv.y() * m_film_size.y();
+        t -= dr::clamp(dr::floor(t), 0.f, m_film_size.y() - 1.f);
+        Float cos_theta = dr::lerp(cos_0, cos_1, t);
+        return { uv.x(), dr::acos(dr::clamp(cos_theta, -1.f, 1.f)) * dr::InvPi<Float> };
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        auto [ray, weight] = sample_ray_differential(
+            time, wavelength_sample, position_sample, aperture_sample, active);
+        return { Ray3f(ray), weight };
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f & /*aperture_sample*/,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(dr::zeros<SurfaceInteraction3f>(),
+                               wavelength_sample,
+                               active);
+        RayDifferential3f ray;
+        ray.time = time;
+        ray.wavelengths = wavelengths;
+
+        // Position on the full image, warped to be uniform in solid angle
+        Point2f uv = dr::fmadd(position_sample, m_crop_scale, m_crop_offset);
+
+        Transform4f trafo = m_to_world.value();
+        ray.o = trafo.translation();
+        ray.d = trafo * uv_to_direction(warp_row(uv));
+
+        ray.o_x = ray.o_y = ray.o;
+        ray.d_x = trafo * uv_to_direction(
+            warp_row(uv + Vector2f(1.f / m_film_size.x(), 0.f)));
+        ray.d_y = trafo * uv_to_direction(
+            uv + Vector2f(0.f, 1.f / m_film_size.y()));
+        ray.has_differentials = true;
+
+        return { ray, wav_weight };
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f & /*sample*/,
+                     Mask active) const override {
+        // Transform the reference point into the local coordinate system
+        Transform4f trafo = m_to_world.value();
+        Vector3f local_d(trafo.inverse().transform_affine(it.p));
+
+        Float dist     = dr::norm(local_d);
+        Float inv_dist = dr::rcp(dist);
+        local_d *= inv_dist;
+
+        // Position of the direction on the full image
+        Point2f uv(dr::atan2(-local_d.x(), local_d.z()) * dr::InvTwoPi<Float> + .5f,
+                   dr::safe_acos(local_d.y()) * dr::InvPi<Float>);
+
+        // Position relative to the crop window (in pixels)
+        DirectionSample3f ds = dr::zeros<DirectionSample3f>();
+        Point2f crop_uv = (uv - m_crop_offset) / m_crop_scale;
+        active &= dist > 0.f && dr::all(crop_uv >= 0.f && crop_uv <= 1.f);
+        ds.uv = crop_uv * m_resolution;
+
+        /* Solid angle density of the sampling strategy of sample_ray(): the
+           crop window is sampled uniformly, and every pixel row is mapped
+           uniformly onto the range of cosines of its polar angles */
+        auto [cos_0, cos_1] = row_bounds(uv.y());
+        Float area    = dr::prod(m_crop_scale),
+              density = dr::rcp(area * dr::TwoPi<Float> * m_film_size.y() *
+                                (cos_0 - cos_1));
+
+        ds.p    = trafo.translation();
+        ds.d    = (ds.p - it.p) * inv_dist;
+        ds.dist = dist;
+        ds.n    = trafo * Vector3f(0.f, 0.f, 1.f);
+        ds.pdf  = dr::select(active, Float(1.f), Float(0.f));
+
+        return { ds, Spectrum(dr::select(active, density * inv_dist * inv_dist, 0.f)) };
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        ScalarPoint3f p = m_to_world.scalar() * ScalarPoint3f(0.f);
+        return ScalarBoundingBox3f(p, p);
+    }
+
+    std::string to_string() const override {
+        using string::indent;
+
+        std::ostringstream oss;
+        oss << "SphericalCamera[" << std::endl
+            << "  film = " << indent(m_film) << "," << std::endl
+            << "  to_world = " << indent(m_to_world, 13) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    ScalarVector2f m_film_size;
+    ScalarVector2f m_crop_scale;
+    ScalarVector2f m_crop_offset;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SphericalCamera, Sensor)
+MI_EXPORT_PLUGIN(SphericalCamera, "Spherical Camera");
+NAMESPACE_END(mitsuba)
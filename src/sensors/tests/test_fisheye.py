@@ -0,0 +1,74 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_camera(fov=180, mapping='equidistant', width=64, height=64):
+    return mi.load_dict({
+        'type': 'fisheye',
+        'fov': fov,
+        'mapping': mapping,
+        'film': {
+            'type': 'hdrfilm',
+            'width': width,
+            'height': height,
+            'rfilter': {'type': 'box'}
+        }
+    })
+
+
+def test01_create(variant_scalar_rgb):
+    camera = create_camera()
+    assert camera is not None
+    assert not camera.needs_aperture_sample()
+
+    with pytest.raises(RuntimeError, match='field of view'):
+        create_camera(fov=400)
+
+    with pytest.raises(RuntimeError, match='Invalid mapping'):
+        create_camera(mapping='stereographic')
+
+
+@pytest.mark.parametrize('mapping', ['equidistant', 'equisolid'])
+def test02_sample_ray(variants_vec_spectral, mapping):
+    camera = create_camera(mapping=mapping)
+    uv = mi.Point2f([0.5, 1.0, 0.5, 0.0], [0.5, 0.5, 0.0, 0.0])
+    ray, weight = camera.sample_ray(0, 0.5, uv, 0)
+
+    # Center, border of the circle (90 degrees) and outside of the circle
+    assert dr.allclose(ray.d.x, [0, -1, 0, 0], atol=1e-5)
+    assert dr.allclose(ray.d.y, [0, 0, 1, 0], atol=1e-5)
+    assert dr.allclose(ray.d.z, [1, 0, 0, 1], atol=1e-5)
+    assert dr.all((weight[0] > 0) == mi.Bool([True, True, True, False]))
+
+
+def test03_equisolid(variant_scalar_rgb):
+    # Rings of equal area cover equal solid angles
+    camera = create_camera(mapping='equisolid')
+    cosines = []
+    for r in [0, dr.sqrt(0.25), dr.sqrt(0.5), dr.sqrt(0.75), 1]:
+        ray, _ = camera.sample_ray(0, 0.5, [0.5 + 0.5 * r, 0.5], 0)
+        cosines.append(ray.d.z)
+
+    for i in range(4):
+        assert dr.allclose(cosines[i] - cosines[i + 1], 0.25, atol=1e-5)
+
+
+@pytest.mark.parametrize('mapping', ['equidistant', 'equisolid'])
+def test04_sample_direction(variants_vec_rgb, mapping):
+    camera = create_camera(fov=200, mapping=mapping, width=32, height=16)
+    it = dr.zeros(mi.Interaction3f, 3)
+    it.p = mi.Point3f([0, 1, -1], [0, 0.5, 0.1], [2, 0.1, -1])
+
+    # The last point lies behind the 200 degree field of view
+    ds, weight = camera.sample_direction(it, 0)
+    assert dr.allclose(ds.pdf, [1, 1, 0])
+    assert dr.allclose(ds.uv.x[0], 16) and dr.allclose(ds.uv.y[0], 8)
+    assert dr.all((weight.x > 0) == mi.Bool([True, True, False]))
+
+    # Sampling the sensor through the returned pixel yields the same direction
+    ray, _ = camera.sample_ray(0, 0.5, ds.uv / mi.Vector2f(32, 16), 0)
+    for i in range(2):
+        assert dr.allclose(ray.d.x[i], -ds.d.x[i], atol=1e-4)
+        assert dr.allclose(ray.d.y[i], -ds.d.y[i], atol=1e-4)
+        assert dr.allclose(ray.d.z[i], -ds.d.z[i], atol=1e-4)
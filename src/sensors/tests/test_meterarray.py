@@ -0,0 +1,60 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_sensor(count, **kwargs):
+    return dict({
+        'type': 'meterarray',
+        'film': {
+            'type': 'hdrfilm',
+            'width': count,
+            'height': 1,
+            'rfilter': {'type': 'box'},
+        },
+    }, **kwargs)
+
+
+def test01_load_file(variant_scalar_rgb, tmp_path):
+    filename = str(tmp_path / 'points.txt')
+    with open(filename, 'w') as f:
+        f.write('# px py pz nx ny nz\n')
+        f.write('0 0 0 0 0 2\n')
+        f.write('1 2 3 1 0 0\n')
+        f.write('4 5 6 0 -1 0\n')
+
+    sensor = mi.load_dict(create_sensor(3, filename=filename, mode='radiance'))
+
+    for i, (o, d) in enumerate([([0, 0, 0], [0, 0, 1]), ([1, 2, 3], [1, 0, 0]),
+                                ([4, 5, 6], [0, -1, 0])]):
+        ray, _ = sensor.sample_ray(0, 0.5, [(i + 0.5) / 3, 0.5], [0.5, 0.5])
+        assert dr.allclose(ray.d, d)
+        assert dr.allclose(ray.o, mi.Point3f(o) + ray.d * mi.math.RayEpsilon)
+
+    with pytest.raises(RuntimeError, match='3 x 1 pixels'):
+        mi.load_dict(create_sensor(4, filename=filename))
+
+
+def test02_irradiance(variants_all_rgb):
+    count = 64
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'path'},
+        'sensor': create_sensor(count),
+        'emitter': {'type': 'constant', 'radiance': 1.0},
+    })
+
+    # Replace the placeholder points by a row of points facing along +X
+    params = mi.traverse(scene.sensors()[0])
+    x = dr.arange(mi.Float, count)
+    params['points'] = dr.ravel(mi.Point3f(x, 0, 0))
+    params['normals'] = dr.ravel(mi.Vector3f(1, 0, 0))
+    params.update()
+
+    # Every point receives an irradiance of pi from the constant emitter
+    image = mi.render(scene, spp=16)
+    assert dr.allclose(image, dr.pi, rtol=1e-3)
+
+    with pytest.raises(RuntimeError, match='must remain'):
+        params['points'] = mi.Float([0, 0, 0])
+        params.update()
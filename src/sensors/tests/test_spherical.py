@@ -0,0 +1,86 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_camera(width=64, height=32, to_world=mi.ScalarTransform4f()):
+    return mi.load_dict({
+        'type': 'spherical',
+        'to_world': to_world,
+        'film': {
+            'type': 'hdrfilm',
+            'width': width,
+            'height': height,
+            'rfilter': {'type': 'box'}
+        }
+    })
+
+
+def test01_create(variant_scalar_rgb):
+    camera = create_camera()
+    assert camera is not None
+    assert not camera.needs_aperture_sample()
+
+    with pytest.raises(RuntimeError, match='Scale factors'):
+        create_camera(to_world=mi.ScalarTransform4f.scale(2))
+
+
+def test02_sample_ray(variants_vec_spectral):
+    camera = create_camera()
+    uv = mi.Point2f([0.5, 0.75, 0.25, 0.5], [0.5, 0.5, 0.5, 0.0])
+    ray, weight = camera.sample_ray(0, 0.5, uv, 0)
+
+    assert dr.allclose(ray.o, [0, 0, 0])
+    assert dr.allclose(ray.d.x, [0, -1, 1, 0], atol=1e-2)
+    assert dr.allclose(ray.d.y, [0, 0, 0, 1], atol=1e-2)
+    assert dr.allclose(ray.d.z, [1, 0, 0, 0], atol=1e-2)
+    assert dr.allclose(dr.norm(ray.d), 1)
+
+
+def test03_uniform_solid_angle(variant_scalar_rgb):
+    # The samples of a pixel row are uniformly distributed in solid angle
+    camera = create_camera(width=8, height=4)
+    cosines = []
+    for i in range(5):
+        ray, _ = camera.sample_ray(0, 0.5, [0.5, 0.25 * i / 4], 0)
+        cosines.append(ray.d.y)
+
+    for i in range(4):
+        assert dr.allclose(cosines[i] - cosines[i + 1], cosines[0] - cosines[1],
+                           atol=1e-5)
+
+
+def test04_constant_environment(variants_all_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'path'},
+        'sensor': {
+            'type': 'spherical',
+            'sampler': {'type': 'independent', 'sample_count': 4},
+            'film': {
+                'type': 'hdrfilm',
+                'width': 16, 'height': 8,
+                'rfilter': {'type': 'box'}
+            }
+        },
+        'emitter': {'type': 'constant', 'radiance': 2.0}
+    })
+
+    image = mi.render(scene)
+    assert dr.allclose(image, 2.0)
+
+
+def test05_sample_direction(variants_vec_rgb):
+    camera = create_camera(width=8, height=4)
+    it = dr.zeros(mi.Interaction3f, 3)
+    it.p = mi.Point3f([0, 2, -2], [0, 0, 0], [2, 0, 0])
+
+    ds, weight = camera.sample_direction(it, 0)
+    assert dr.allclose(ds.pdf, 1)
+    assert dr.allclose(ds.uv.x, [4, 2, 6], atol=1e-4)
+    assert dr.allclose(ds.uv.y, 2, atol=1e-4)
+    assert dr.all(weight.x > 0)
+
+    # Sampling the sensor through the returned pixel yields the same direction
+    ray, _ = camera.sample_ray(0, 0.5, ds.uv / mi.Vector2f(8, 4), 0)
+    assert dr.allclose(ray.d, -ds.d, atol=1e-4)
@@ -34,6 +34,11 @@ B-spline curve (:monosp:`bsplinecurve`)
    - |string|
    - Filename of the curves to be loaded
 
+ * - split_depth
+   - |int|
+   - Maximum number of times each segment may be bisected to tighten its
+     bounding boxes (Default: 0, i.e. no splitting)
+
  * - to_world
    - |transform|
    - Specifies a linear object-to-world transformation. Note that the control
@@ -114,6 +119,17 @@ points and increasing radii::
             'filename': 'curves.txt'
         },
 
+Long and thin segments that run diagonally to the coordinate axes or that are
+strongly curved have loose axis-aligned bounding boxes, which makes the ray
+traversal of e.g. hair and fur expensive. When :monosp:`split_depth` is
+positive, every segment is therefore recursively bisected at load time as
+long as this substantially reduces the surface area of the bounding boxes of
+its halves (hence, depending on the orientation and curvature of the
+segment). The sub-segments reproduce the original curve exactly, but they
+are stored with separate control points, which are the ones exposed as
+scene parameters. The :math:`v` texture coordinate is distributed uniformly
+over all (sub-)segments.
+
 .. note:: In CUDA variants, the backfaces of the curves are culled. It is
           therefore impossible to intersect the curve with a ray which's origin
           is inside of the curve. In addition, prior to the NVIDIA v531.18
@@ -135,6 +151,7 @@ public:
 
     using InputFloat = float;
     using InputPoint3f = dr::replace_scalar_t<ScalarPoint3f, InputFloat>;
+    using InputPoint4f = Point<InputFloat, 4>;
     using FloatStorage = DynamicBuffer<dr::replace_scalar_t<Float, InputFloat>>;
 
     using UInt32Storage = DynamicBuffer<UInt32>;
@@ -253,17 +270,25 @@ public:
             fail("Empty B-spline file: no control points were read!");
         finish_curve();
 
-        m_control_point_count = vertices.size();
-
-        std::unique_ptr<ScalarIndex[]> indices = std::make_unique<ScalarIndex[]>(segment_count);
-        size_t segment_index = 0;
+        std::vector<ScalarIndex> indices;
+        indices.reserve(segment_count);
         for (size_t i = 0; i < curve_1st_idx.size(); ++i) {
             size_t next_curve_idx = i + 1 < curve_1st_idx.size() ? curve_1st_idx[i + 1] : vertices.size();
             size_t curve_segment_count = next_curve_idx - curve_1st_idx[i] - 3;
             for (size_t j = 0; j < curve_segment_count; ++j)
-                indices[segment_index++] = curve_1st_idx[i] + j;
+                indices.push_back((ScalarIndex) (curve_1st_idx[i] + j));
         }
-        m_indices = dr::load<UInt32Storage>(indices.get(), segment_count);
+
+        uint32_t split_depth = props.get<uint32_t>("split_depth", 0);
+        if (split_depth > 0) {
+            size_t original_count = indices.size();
+            split_segments(vertices, radius, indices, split_depth);
+            Log(Debug, "\"%s\": split %i segments into %i", m_name,
+                original_count, indices.size());
+        }
+
+        m_control_point_count = vertices.size();
+        m_indices = dr::load<UInt32Storage>(indices.data(), indices.size());
 
         std::unique_ptr<InputFloat[]> positions =
             std::make_unique<InputFloat[]>(m_control_point_count * 3);
@@ -620,6 +645,110 @@ private:
         *start_ = start;
     }
 
+    /// Bounding box of the convex hull of a segment's control points
+    static ScalarBoundingBox3f hull_bbox(const InputPoint4f *c) {
+        ScalarBoundingBox3f bbox;
+        ScalarFloat r = 0.f;
+        for (size_t i = 0; i < 4; ++i) {
+            bbox.expand(ScalarPoint3f(c[i].x(), c[i].y(), c[i].z()));
+            r = dr::maximum(r, (ScalarFloat) c[i].w());
+        }
+        bbox.min -= r;
+        bbox.max += r;
+        return bbox;
+    }
+
+    /**
+     * \brief Compute the control points of the sub-segment <tt>[a, a+h]</tt>
+     * of the segment with control points \c c
+     *
+     * The segment is converted into the power basis, reparameterized, and
+     * converted back into the uniform cubic B-spline basis.
+     */
+    static void sub_segment(const InputPoint4f *c, InputFloat a, InputFloat h,
+                            InputPoint4f *out) {
+        InputPoint4f k0 = (c[0] + 4.f * c[1] + c[2]) * (1.f / 6.f),
+                     k1 = (c[2] - c[0]) * .5f,
+                     k2 = (c[0] - 2.f * c[1] + c[2]) * .5f,
+                     k3 = (3.f * (c[1] - c[2]) + c[3] - c[0]) * (1.f / 6.f);
+
+        InputPoint4f d0 = k0 + a * (k1 + a * (k2 + a * k3)),
+                     d1 = h * (k1 + a * (2.f * k2 + 3.f * a * k3)),
+                     d2 = (h * h) * (k2 + 3.f * a * k3),
+                     d3 = (h * h * h) * k3;
+
+        out[0] = d0 - d1 + d2 * (2.f / 3.f);
+        out[1] = d0 - d2 * (1.f / 3.f);
+        out[2] = d0 + d1 + d2 * (2.f / 3.f);
+        out[3] = d0 + 2.f * d1 + d2 * (11.f / 3.f) + 6.f * d3;
+    }
+
+    /**
+     * \brief Recursively bisect all segments while this reduces the total
+     * surface area of their bounding boxes by a sufficient amount
+     *
+     * Sub-segments are appended to the control points with four separate
+     * control points each.
+     */
+    void split_segments(std::vector<InputPoint3f> &vertices,
+                        std::vector<InputFloat> &radius,
+                        std::vector<ScalarIndex> &indices,
+                        uint32_t max_depth) const {
+        /* Only split if the bounding boxes of the two halves have at most
+           this fraction of the surface area of the parent's */
+        const ScalarFloat threshold = .7f;
+
+        std::vector<InputPoint4f> points;
+        std::vector<ScalarIndex> result;
+        result.reserve(indices.size());
+
+        struct Item { InputPoint4f c[4]; uint32_t depth; };
+        std::vector<Item> stack;
+
+        for (ScalarIndex index : indices) {
+            Item root;
+            for (size_t i = 0; i < 4; ++i) {
+                const InputPoint3f &p = vertices[index + i];
+                root.c[i] = InputPoint4f(p.x(), p.y(), p.z(), radius[index + i]);
+            }
+            root.depth = 0;
+            stack.push_back(root);
+
+            while (!stack.empty()) {
+                Item item = stack.back(), left, right;
+                stack.pop_back();
+
+                if (item.depth < max_depth) {
+                    sub_segment(item.c, 0.f, .5f, left.c);
+                    sub_segment(item.c, .5f, .5f, right.c);
+                    if (hull_bbox(left.c).surface_area() + hull_bbox(right.c).surface_area() <
+                        threshold * hull_bbox(item.c).surface_area()) {
+                        left.depth = right.depth = item.depth + 1;
+                        stack.push_back(right);
+                        stack.push_back(left);
+                        continue;
+                    }
+                }
+
+                // Segments that were not split keep their control points
+                if (item.depth == 0) {
+                    result.push_back(index);
+                    continue;
+                }
+
+                result.push_back((ScalarIndex) (vertices.size() + points.size()));
+                for (size_t i = 0; i < 4; ++i)
+                    points.push_back(item.c[i]);
+            }
+        }
+
+        for (const InputPoint4f &c : points) {
+            vertices.emplace_back(c.x(), c.y(), c.z());
+            radius.push_back(c.w());
+        }
+        indices = std::move(result);
+    }
+
     void recompute_bbox() {
         auto&& control_points = dr::migrate(m_control_points, AllocType::Host);
         if constexpr (dr::is_jit_v<Float>)
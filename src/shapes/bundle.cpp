@@ -0,0 +1,296 @@
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/profiler.h>
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-bundle:
+
+Mesh bundle loader (:monosp:`bundle`)
+-------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the mesh bundle that should be loaded
+
+ * - shape_index
+   - |int|
+   - A bundle usually contains many meshes. This parameter specifies which one
+     should be loaded. (Default: 0, i.e. the first one)
+
+ * - mesh_name
+   - |string|
+   - Alternatively, the name of the mesh that should be loaded. When specified,
+     this parameter takes precedence over :monosp:`shape_index`.
+
+ * - face_normals
+   - |bool|
+   - When set to |true|, any existing or computed vertex normals are
+     discarded and *face normals* will instead be used during rendering.
+     This gives the rendered object a faceted appearance. (Default: |false|)
+
+ * - flip_normals
+   - |bool|
+   - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
+     the normals point outside)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation.
+     (Default: none, i.e. object space = world space)
+
+ * - vertex_count
+   - |int|
+   - Total number of vertices
+   - |exposed|
+
+ * - face_count
+   - |int|
+   - Total number of faces
+   - |exposed|
+
+ * - faces
+   - :paramtype:`uint32[]`
+   - Face indices buffer (flatten)
+   - |exposed|
+
+ * - vertex_positions
+   - :paramtype:`float[]`
+   - Vertex positions buffer (flatten) pre-multiplied by the object-to-world transformation.
+   - |exposed|, |differentiable|, |discontinuous|
+
+ * - vertex_normals
+   - :paramtype:`float[]`
+   - Vertex normals buffer (flatten)  pre-multiplied by the object-to-world transformation.
+   - |exposed|, |differentiable|, |discontinuous|
+
+ * - vertex_texcoords
+   - :paramtype:`float[]`
+   - Vertex texcoords buffer (flatten)
+   - |exposed|, |differentiable|
+
+A mesh bundle stores the geometry of an entire scene in a single file that is
+written by :code:`mi.Mesh.write_bundle()`, typically after loading the scene
+once from its original PLY/OBJ/serialized files. In contrast to the
+:ref:`serialized <shape-serialized>` format, the buffers are neither compressed
+nor converted: they are stored in native byte order and aligned to page
+boundaries. The plugin maps the file into memory and copies the buffers
+directly into the mesh, so that loading is limited by I/O bandwidth. The
+mappings of processes on the same machine share the operating system's page
+cache.
+
+The vertex positions and normals are stored in world space, and the bounding
+box of every mesh is stored alongside its buffers. Hence, when no
+:monosp:`to_world` transformation is specified, no per-vertex work is performed
+at all.
+
+Format description
+******************
+
+The file starts with a header and a table of contents, followed by the
+page-aligned (4 KiB) buffers. Offsets are specified in bytes from the start of
+the file, and an offset of zero denotes an absent buffer.
+
+.. list-table::
+    :widths: 20 80
+    :header-rows: 1
+
+    * - Type
+      - Content
+    * - :monosp:`char[8]`
+      - File format identifier: :code:`MIBUNDLE`
+    * - :monosp:`uint32`
+      - File version identifier. Currently set to :code:`1`
+    * - :monosp:`uint32`
+      - Number of meshes :math:`n`
+    * - :math:`n\times` :monosp:`entry`
+      - Name (:monosp:`char[64]`), vertex and face count (:monosp:`uint64`),
+        flags (:monosp:`uint32`, 1: vertex normals, 2: texture coordinates,
+        4: face normals), padding (:monosp:`uint32`), bounding box
+        (:monosp:`float[6]`), offsets of the positions, normals, texture
+        coordinates, and faces (:monosp:`uint64`)
+    * - :monosp:`array`
+      - The single precision and :monosp:`uint32` buffers of all meshes
+
+Mesh attributes are not stored in bundles.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: bundle
+
+        <shape type="bundle">
+            <string name="filename" value="scene.mibundle"/>
+            <string name="mesh_name" value="teapot"/>
+            <bsdf type='diffuse'/>
+        </shape>
+
+    .. code-tab:: python
+
+        'type': 'bundle',
+        'filename': 'scene.mibundle',
+        'mesh_name': 'teapot',
+        'material': {
+            'type': 'diffuse',
+        }
+ */
+
+template <typename Float, typename Spectrum>
+class BundleMesh final : public Mesh<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count,
+                   m_face_count, m_vertex_positions, m_vertex_normals,
+                   m_vertex_texcoords, m_faces, m_face_normals,
+                   recompute_vertex_normals, initialize)
+    MI_IMPORT_TYPES()
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
+    using typename Base::InputFloat;
+    using typename Base::FloatStorage;
+    using typename Base::InputPoint3f;
+    using typename Base::InputNormal3f;
+
+    BundleMesh(const Properties &props) : Base(props) {
+        auto fail = [&](const std::string &descr) {
+            Throw("Error while loading mesh bundle \"%s\": %s!", m_name, descr);
+        };
+
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        Log(Debug, "Loading mesh from \"%s\" ..", m_name);
+        if (!fs::exists(file_path))
+            fail("file not found");
+
+        ScopedPhase phase(ProfilerPhase::LoadGeometry);
+        Timer timer;
+
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
+        const uint8_t *data = (const uint8_t *) mmap->data();
+        size_t size = mmap->size();
+
+        detail::MeshBundleHeader header;
+        if (size < sizeof(header))
+            fail("file is truncated");
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, "MIBUNDLE", 8) != 0)
+            fail("encountered an invalid file format");
+        if (header.version != detail::mesh_bundle_version)
+            fail("encountered an incompatible file version");
+        if (size < sizeof(header) + (size_t) header.mesh_count *
+                                        sizeof(detail::MeshBundleEntry))
+            fail("file is truncated");
+
+        const detail::MeshBundleEntry *entries =
+            (const detail::MeshBundleEntry *) (data + sizeof(header));
+
+        // Select the requested mesh by name or by index
+        const detail::MeshBundleEntry *entry = nullptr;
+        if (props.has_property("mesh_name")) {
+            std::string mesh_name = props.string("mesh_name");
+            for (uint32_t i = 0; i < header.mesh_count; ++i) {
+                if (strncmp(entries[i].name, mesh_name.c_str(),
+                            sizeof(entries[i].name)) == 0) {
+                    entry = &entries[i];
+                    break;
+                }
+            }
+            if (!entry)
+                fail(tfm::format("no mesh named \"%s\"", mesh_name));
+        } else {
+            int shape_index = props.get<int>("shape_index", 0);
+            if (shape_index < 0 || (uint32_t) shape_index >= header.mesh_count)
+                fail(tfm::format("shape index is out of range! (requested %i "
+                                 "out of 0..%i)", shape_index,
+                                 (int) header.mesh_count - 1));
+            entry = &entries[shape_index];
+        }
+
+        m_name = std::string(entry->name, strnlen(entry->name, sizeof(entry->name)));
+        m_vertex_count = (ScalarSize) entry->vertex_count;
+        m_face_count   = (ScalarSize) entry->face_count;
+
+        bool has_normals   = (entry->flags & 1) != 0,
+             has_texcoords = (entry->flags & 2) != 0;
+        if (entry->flags & 4)
+            m_face_normals = true;
+
+        auto buffer = [&](uint64_t offset, size_t bytes) -> const void * {
+            if (offset == 0 || offset + bytes > size)
+                fail("buffer is out of bounds");
+            return data + offset;
+        };
+
+        const InputFloat *positions = (const InputFloat *)
+            buffer(entry->positions, m_vertex_count * 3 * sizeof(InputFloat));
+        const InputFloat *normals = has_normals ? (const InputFloat *)
+            buffer(entry->normals, m_vertex_count * 3 * sizeof(InputFloat)) : nullptr;
+        const InputFloat *texcoords = has_texcoords ? (const InputFloat *)
+            buffer(entry->texcoords, m_vertex_count * 2 * sizeof(InputFloat)) : nullptr;
+        const ScalarIndex *faces = (const ScalarIndex *)
+            buffer(entry->faces, m_face_count * 3 * sizeof(ScalarIndex));
+
+        if (m_to_world.scalar() == ScalarTransform4f()) {
+            // The buffers are already in world space: copy them as they are
+            m_bbox = ScalarBoundingBox3f(
+                ScalarPoint3f(entry->bbox_min[0], entry->bbox_min[1], entry->bbox_min[2]),
+                ScalarPoint3f(entry->bbox_max[0], entry->bbox_max[1], entry->bbox_max[2]));
+            m_vertex_positions = dr::load<FloatStorage>(positions, m_vertex_count * 3);
+            if (has_normals && !m_face_normals)
+                m_vertex_normals = dr::load<FloatStorage>(normals, m_vertex_count * 3);
+        } else {
+            std::unique_ptr<InputFloat[]> vertex_positions(new InputFloat[m_vertex_count * 3]);
+            std::unique_ptr<InputFloat[]> vertex_normals(
+                has_normals ? new InputFloat[m_vertex_count * 3] : nullptr);
+
+            for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+                InputPoint3f p = m_to_world.scalar().transform_affine(
+                    dr::load<InputPoint3f>(positions + 3 * i));
+                dr::store(vertex_positions.get() + 3 * i, p);
+                m_bbox.expand(p);
+
+                if (has_normals) {
+                    InputNormal3f n = dr::normalize(m_to_world.scalar().transform_affine(
+                        dr::load<InputNormal3f>(normals + 3 * i)));
+                    dr::store(vertex_normals.get() + 3 * i, n);
+                }
+            }
+
+            m_vertex_positions = dr::load<FloatStorage>(vertex_positions.get(), m_vertex_count * 3);
+            if (has_normals && !m_face_normals)
+                m_vertex_normals = dr::load<FloatStorage>(vertex_normals.get(), m_vertex_count * 3);
+        }
+
+        if (has_texcoords)
+            m_vertex_texcoords = dr::load<FloatStorage>(texcoords, m_vertex_count * 2);
+        m_faces = dr::load<DynamicBuffer<UInt32>>(faces, m_face_count * 3);
+
+        Log(Debug, "\"%s\": read %i faces, %i vertices (took %s)", m_name,
+            m_face_count, m_vertex_count,
+            util::time_string((float) timer.value()));
+
+        if (!m_face_normals && !has_normals) {
+            Timer timer2;
+            recompute_vertex_normals();
+            Log(Debug, "\"%s\": computed vertex normals (took %s)", m_name,
+                util::time_string((float) timer2.value()));
+        }
+
+        initialize();
+    }
+
+    MI_DECLARE_CLASS()
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(BundleMesh, Mesh)
+MI_EXPORT_PLUGIN(BundleMesh, "Mesh bundle")
+NAMESPACE_END(mitsuba)
@@ -1,8 +1,12 @@
+#include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/warp.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/render/emitter.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/shapegroup.h>
@@ -31,6 +35,16 @@ Instance (:monosp:`instance`)
    - Specifies a linear object-to-world transformation. (Default: none (i.e. object space = world space))
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - to_world_1, to_world_2, ...
+   - |transform|
+   - Optional additional keyframes of the object-to-world transformation for
+     motion blur (see below).
+   - |exposed|
+
+ * - motion_begin, motion_end
+   - |float|
+   - Time interval spanned by the keyframes. (Default: 0 and 1)
+
 This plugin implements a geometry instance used to efficiently replicate geometry many times. For
 details on how to create instances, refer to the :ref:`shape-shapegroup` plugin.
 
@@ -41,20 +55,70 @@ details on how to create instances, refer to the :ref:`shape-shapegroup` plugin.
     The Stanford bunny loaded a single time and instantiated 1365 times (equivalent to 100 million
     triangles)
 
+.. rubric:: Motion blur
+
+When keyframes ``to_world_1``, ``to_world_2``, etc. are specified in addition
+to ``to_world``, the instance moves during the exposure: the keyframes are
+distributed uniformly over the interval [``motion_begin``, ``motion_end``],
+and the transformation at the time of each ray (see the ``shutter_open`` and
+``shutter_close`` parameters of the sensor) is obtained by linearly
+interpolating the matrices of the two closest keyframes. Times outside of the
+interval are clamped to the first and last keyframe. This matches the motion
+blur support of Embree and OptiX, which is used to trace such instances in a
+single rendering pass.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: instance-motion
+
+        <shape type="instance">
+            <ref id="my_shape_group"/>
+            <transform name="to_world">
+                <translate x="0"/>
+            </transform>
+            <transform name="to_world_1">
+                <translate x="1"/>
+            </transform>
+        </shape>
+
+    .. code-tab:: python
+
+        'type': 'instance',
+        'shapegroup': my_shape_group,
+        'to_world': mi.ScalarTransform4f.translate([0, 0, 0]),
+        'to_world_1': mi.ScalarTransform4f.translate([1, 0, 0])
+
+.. rubric:: Emissive shape groups
+
+Shapes of a shape group may carry ``area`` emitters, e.g. to replicate the
+bulbs of street lamps or the panels of a LED wall. Every instance of such a
+group then acts as an emitter of its own, whose positions are sampled on the
+emissive shapes of the group (chosen proportionally to their surface area,
+e.g. using the area distribution of a mesh) and mapped through the
+transformation of the instance. The geometry, its sampling distributions and
+the emitters are shared by all instances, hence the memory usage only scales
+with the amount of unique geometry.
+
 .. warning::
 
     - Note that it is not possible to assign a different material to each instance — the material
       assignment specified within the shape group is the one that matters.
-    - Shape groups cannot be used to replicate shapes with attached emitters, sensors, or
-      subsurface scattering models.
+    - Shape groups cannot be used to replicate shapes with attached sensors or subsurface
+      scattering models.
+    - The emitters of instanced shapes are assumed to be diffuse area lights.
+      If a group contains several emissive shapes, the (differentiable)
+      re-evaluation of an emitter sample via ``Scene.eval_emitter_direction()``
+      uses the radiance of the first one.
 
  */
 
+template <typename Float, typename Spectrum> class InstanceEmitter;
+
 template <typename Float, typename Spectrum>
 class Instance final: public Shape<Float, Spectrum> {
 public:
-    MI_IMPORT_BASE(Shape, m_id, m_to_world, m_to_object, mark_dirty)
-    MI_IMPORT_TYPES(BSDF)
+    MI_IMPORT_BASE(Shape, m_id, m_to_world, m_to_object, m_emitter, mark_dirty)
+    MI_IMPORT_TYPES(BSDF, ShapePtr)
 
     using typename Base::ScalarSize;
     using ShapeGroup_ = ShapeGroup<Float, Spectrum>;
@@ -74,11 +138,50 @@ public:
         if (!m_shapegroup)
             Throw("A reference to a 'shapegroup' must be specified!");
 
+        // Keyframes of the transformation for motion blur
+        for (size_t i = 1; props.has_property("to_world_" + std::to_string(i)); ++i) {
+            if (m_motion_keys.empty())
+                m_motion_keys.push_back(m_to_world.scalar());
+            m_motion_keys.push_back(props.get<ScalarTransform4f>("to_world_" + std::to_string(i)));
+        }
+
+        m_motion_begin = props.get<ScalarFloat>("motion_begin", 0.f);
+        m_motion_end   = props.get<ScalarFloat>("motion_end", 1.f);
+        if (!(m_motion_end > m_motion_begin))
+            Throw("The motion interval must have a positive length!");
+
         dr::make_opaque(m_to_world, m_to_object);
+
+        // The emissive shapes of the group are sampled by an emitter of the instance
+        std::vector<ScalarFloat> areas;
+        for (const ref<Base> &shape : m_shapegroup->shapes()) {
+            if (!shape->is_emitter())
+                continue;
+            m_emissive_shapes.push_back(shape.get());
+            areas.push_back(dr::slice(shape->surface_area()));
+            m_emissive_area += areas.back();
+        }
+
+        if (!m_emissive_shapes.empty()) {
+            if (!(m_emissive_area > 0.f))
+                Throw("The emissive shapes of the shape group have no surface area!");
+            m_emissive_distr =
+                DiscreteDistribution<Float>(areas.data(), areas.size());
+            if constexpr (dr::is_jit_v<Float>)
+                m_emissive_shapes_dr = dr::load<DynamicBuffer<ShapePtr>>(
+                    m_emissive_shapes.data(), m_emissive_shapes.size());
+
+            m_emitter = new InstanceEmitter<Float, Spectrum>(this, m_emissive_shapes);
+            m_emitter->set_shape(this);
+            dr::set_attr(this, "emitter", m_emitter.get());
+        }
     }
 
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("to_world", *m_to_world.ptr(), +ParamFlags::Differentiable | ParamFlags::Discontinuous);
+        for (size_t i = 1; i < m_motion_keys.size(); ++i)
+            callback->put_parameter("to_world_" + std::to_string(i), m_motion_keys[i],
+                                    +ParamFlags::NonDifferentiable);
     }
 
     void parameters_changed(const std::vector<std::string> &keys) override {
@@ -86,11 +189,19 @@ public:
             // Update the scalar value of the matrix
             m_to_world = m_to_world.value();
             m_to_object = m_to_world.value().inverse();
+            if (!m_motion_keys.empty())
+                m_motion_keys[0] = m_to_world.scalar();
             mark_dirty();
         }
+        for (size_t i = 1; i < m_motion_keys.size(); ++i) {
+            if (keys.empty() || string::contains(keys, "to_world_" + std::to_string(i)))
+                mark_dirty();
+        }
         Base::parameters_changed();
     }
 
+    bool has_motion() const override { return !m_motion_keys.empty(); }
+
     ScalarBoundingBox3f bbox() const override {
         const ScalarBoundingBox3f &bbox = m_shapegroup->bbox();
 
@@ -98,14 +209,23 @@ public:
         if (!bbox.valid())
             return bbox;
 
+        /* Linearly interpolated transformations map the corners along
+           straight lines, hence the keyframes bound the entire motion */
         ScalarBoundingBox3f result;
-        for (int i = 0; i < 8; ++i)
+        for (int i = 0; i < 8; ++i) {
             result.expand(m_to_world.scalar() * bbox.corner(i));
+            for (const ScalarTransform4f &key : m_motion_keys)
+                result.expand(key * bbox.corner(i));
+        }
         return result;
     }
 
     ScalarSize primitive_count() const override { return 1; }
 
+    const ShapeGroup_ *instanced_shapegroup() const override {
+        return m_shapegroup.get();
+    }
+
     ScalarSize effective_primitive_count() const override {
         return m_shapegroup->primitive_count();
     }
@@ -124,6 +244,9 @@ public:
                                    dr::mask_t<FloatP> active) const {
         MI_MASK_ARGUMENT(active);
         if constexpr (!dr::is_array_v<FloatP>) {
+            if (!m_motion_keys.empty())
+                return m_shapegroup->ray_intersect_preliminary_scalar(
+                    motion_transform(ray.time).inverse().transform_affine(ray));
             return m_shapegroup->ray_intersect_preliminary_scalar(m_to_object.scalar().transform_affine(ray));
         } else {
             Throw("Instance::ray_intersect_preliminary() should only be called with scalar types.");
@@ -135,6 +258,9 @@ public:
         MI_MASK_ARGUMENT(active);
 
         if constexpr (!dr::is_array_v<FloatP>) {
+            if (!m_motion_keys.empty())
+                return m_shapegroup->ray_test_scalar(
+                    motion_transform(ray.time).inverse().transform_affine(ray));
             return m_shapegroup->ray_test_scalar(m_to_object.scalar().transform_affine(ray));
         } else {
             Throw("Instance::ray_test_impl() should only be called with scalar types.");
@@ -150,8 +276,13 @@ public:
                                                      Mask active) const override {
         MI_MASK_ARGUMENT(active);
 
-        const Transform4f& to_world  = m_to_world.value();
-        const Transform4f& to_object = m_to_object.value();
+        Transform4f to_world  = m_to_world.value(),
+                    to_object = m_to_object.value();
+
+        if (!m_motion_keys.empty()) {
+            to_world  = motion_transform(ray.time);
+            to_object = to_world.inverse();
+        }
 
         constexpr bool IsDiff = dr::is_diff_v<Float>;
         bool grad_enabled = dr::grad_enabled(to_world);
@@ -241,6 +372,63 @@ public:
     //! @}
     // =============================================================
 
+    // =============================================================
+    //! @{ \name Sampling routines (emissive shape groups)
+    // =============================================================
+
+    /**
+     * \brief Sample a position on the emissive shapes of the shape group
+     *
+     * A shape is chosen proportionally to its surface area in object space
+     * and sampled using its own routine (e.g. the area distribution of a
+     * mesh), after which the sample is mapped to world space. Returns the
+     * position sample along with the chosen shape.
+     */
+    std::pair<PositionSample3f, ShapePtr>
+    sample_emissive_position(Float time, const Point2f &sample_,
+                             Mask active) const {
+        Point2f sample(sample_);
+        UInt32 index;
+        std::tie(index, sample.y()) =
+            m_emissive_distr.sample_reuse(sample.y(), active);
+
+        ShapePtr shape;
+        if constexpr (dr::is_jit_v<Float>)
+            shape = dr::gather<ShapePtr>(m_emissive_shapes_dr, index, active);
+        else
+            shape = m_emissive_shapes[index];
+
+        PositionSample3f ps = shape->sample_position(time, sample, active);
+
+        auto [to_world, to_object] = transforms(time);
+        ps.p   = to_world.transform_affine(ps.p);
+        ps.n   = dr::normalize(to_world.transform_affine(ps.n));
+        ps.pdf = emissive_pdf(to_world, to_object, ps.n);
+
+        return { ps, shape };
+    }
+
+    PositionSample3f sample_position(Float time, const Point2f &sample,
+                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if (m_emissive_shapes.empty())
+            Throw("Instance::sample_position(): the shape group has no "
+                  "emissive shapes!");
+        return sample_emissive_position(time, sample, active).first;
+    }
+
+    Float pdf_position(const PositionSample3f &ps, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if (m_emissive_shapes.empty())
+            Throw("Instance::pdf_position(): the shape group has no "
+                  "emissive shapes!");
+        auto [to_world, to_object] = transforms(ps.time);
+        return emissive_pdf(to_world, to_object, ps.n);
+    }
+
+    //! @}
+    // =============================================================
+
     std::string to_string() const override {
         std::ostringstream oss;
             oss << "Instance[" << std::endl
@@ -255,9 +443,21 @@ public:
         DRJIT_MARK_USED(device);
         if constexpr (!dr::is_cuda_v<Float>) {
             RTCGeometry instance = m_shapegroup->embree_geometry(device);
-            rtcSetGeometryTimeStepCount(instance, 1);
-            dr::Matrix<ScalarFloat32, 4> matrix(m_to_world.scalar().matrix);
-            rtcSetGeometryTransform(instance, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, &matrix);
+            if (m_motion_keys.empty()) {
+                rtcSetGeometryTimeStepCount(instance, 1);
+                dr::Matrix<ScalarFloat32, 4> matrix(m_to_world.scalar().matrix);
+                rtcSetGeometryTransform(instance, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, &matrix);
+            } else {
+                // Embree linearly interpolates the keyframe matrices as well
+                rtcSetGeometryTimeStepCount(instance, (unsigned int) m_motion_keys.size());
+                for (size_t i = 0; i < m_motion_keys.size(); ++i) {
+                    dr::Matrix<ScalarFloat32, 4> matrix(m_motion_keys[i].matrix);
+                    rtcSetGeometryTransform(instance, (unsigned int) i,
+                                            RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, &matrix);
+                }
+                rtcSetGeometryTimeRange(instance, (float) m_motion_begin,
+                                        (float) m_motion_end);
+            }
             rtcCommitGeometry(instance);
             return instance;
         } else {
@@ -271,8 +471,49 @@ public:
                                    std::vector<OptixInstance>& instances,
                                    uint32_t instance_id,
                                    const ScalarTransform4f& transf) override {
+        if (m_motion_keys.empty()) {
+            m_shapegroup->optix_prepare_ias(context, instances, instance_id,
+                                            transf * m_to_world.scalar());
+            return;
+        }
+
+        /* Reference the geometry of the shape group through matrix motion
+           transforms, OptiX interpolates the keyframes at the ray time */
+        size_t offset = instances.size();
         m_shapegroup->optix_prepare_ias(context, instances, instance_id,
-                                        transf * m_to_world.scalar());
+                                        ScalarTransform4f());
+
+        release_motion_transforms();
+        size_t key_count = m_motion_keys.size(),
+               size = sizeof(OptixMatrixMotionTransform) +
+                      (key_count - 2) * 12 * sizeof(float);
+
+        for (size_t i = offset; i < instances.size(); ++i) {
+            std::unique_ptr<uint8_t[]> data(new uint8_t[size]());
+            OptixMatrixMotionTransform *motion =
+                (OptixMatrixMotionTransform *) data.get();
+            motion->child = instances[i].traversableHandle;
+            motion->motionOptions.numKeys   = (unsigned short) key_count;
+            motion->motionOptions.flags     = OPTIX_MOTION_FLAG_NONE;
+            motion->motionOptions.timeBegin = (float) m_motion_begin;
+            motion->motionOptions.timeEnd   = (float) m_motion_end;
+
+            float *keys = &motion->transform[0][0];
+            for (size_t k = 0; k < key_count; ++k) {
+                ScalarMatrix4f m = (transf * m_motion_keys[k]).matrix;
+                for (size_t j = 0; j < 12; ++j)
+                    keys[k * 12 + j] = (float) m(j / 4, j % 4);
+            }
+
+            void *ptr = jit_malloc(AllocType::Device, size);
+            jit_memcpy(JitBackend::CUDA, ptr, data.get(), size);
+            m_optix_motion_transforms.push_back(ptr);
+
+            jit_optix_check(optixConvertPointerToTraversableHandle(
+                context, (CUdeviceptr) ptr,
+                OPTIX_TRAVERSABLE_TYPE_MATRIX_MOTION_TRANSFORM,
+                &instances[i].traversableHandle));
+        }
     }
 
     virtual void optix_fill_hitgroup_records(std::vector<HitGroupSbtRecord> &,
@@ -289,11 +530,249 @@ public:
         return dr::grad_enabled(m_to_world) || m_shapegroup->parameters_grad_enabled();
     }
 
+#if defined(MI_ENABLE_CUDA)
+    ~Instance() { release_motion_transforms(); }
+#endif
+
     MI_DECLARE_CLASS()
+private:
+    /// Return the object-to-world and world-to-object transformations at the given time
+    std::pair<Transform4f, Transform4f> transforms(const Float &time) const {
+        if (m_motion_keys.empty())
+            return { m_to_world.value(), m_to_object.value() };
+        Transform4f to_world = motion_transform(time);
+        return { to_world, to_world.inverse() };
+    }
+
+    /**
+     * \brief Density per unit area (in world space) of the samples of \ref
+     * sample_emissive_position() at a position with normal \c n
+     *
+     * The shapes are assumed to sample positions uniformly with respect to
+     * their surface area, which is the case for all builtin shapes. The linear
+     * part \c A of the transformation scales surface elements with normal \c n
+     * by <tt>|det(A)| / |A^T n|</tt>.
+     */
+    Float emissive_pdf(const Transform4f &to_world, const Transform4f &to_object,
+                       const Normal3f &n) const {
+        const auto &m = to_world.matrix;
+        Float det = m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) -
+                    m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0)) +
+                    m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+
+        // The normal transformation of 'to_object' multiplies by A^T
+        return dr::norm(to_object.transform_affine(n)) /
+               (m_emissive_area * dr::abs(det));
+    }
+
+    /// Linearly interpolate the keyframes of the transformation at the given time
+    template <typename Value>
+    Transform<Point<Value, 4>> motion_transform(const Value &time) const {
+        using Matrix = dr::Matrix<Value, 4>;
+        ScalarFloat segments = (ScalarFloat) (m_motion_keys.size() - 1);
+
+        Value t = dr::clamp((time - m_motion_begin) *
+                                (segments / (m_motion_end - m_motion_begin)),
+                            0.f, segments);
+
+        // Blend the keyframes with piecewise linear "hat" weights
+        Matrix result = dr::zeros<Matrix>();
+        for (size_t i = 0; i < m_motion_keys.size(); ++i) {
+            Value weight = dr::maximum(1.f - dr::abs(t - (ScalarFloat) i), 0.f);
+            result += Matrix(m_motion_keys[i].matrix) * weight;
+        }
+
+        return Transform<Point<Value, 4>>(result);
+    }
+
+#if defined(MI_ENABLE_CUDA)
+    void release_motion_transforms() {
+        for (void *ptr : m_optix_motion_transforms)
+            jit_free(ptr);
+        m_optix_motion_transforms.clear();
+    }
+#endif
+
 private:
    ref<ShapeGroup_> m_shapegroup;
+
+   /// Keyframes of the transformation (empty if the instance doesn't move)
+   std::vector<ScalarTransform4f> m_motion_keys;
+   ScalarFloat m_motion_begin, m_motion_end;
+
+   /// Emissive shapes of the shape group and their total surface area (object space)
+   std::vector<const Base *> m_emissive_shapes;
+   DynamicBuffer<ShapePtr> m_emissive_shapes_dr;
+   DiscreteDistribution<Float> m_emissive_distr;
+   ScalarFloat m_emissive_area = 0.f;
+
+#if defined(MI_ENABLE_CUDA)
+   /// Device memory of the OptiX matrix motion transforms
+   std::vector<void *> m_optix_motion_transforms;
+#endif
+};
+
+/**
+ * \brief Emitter of an instance whose shape group contains emissive shapes
+ *
+ * Positions are sampled through \ref Instance::sample_emissive_position(),
+ * while the emitted radiance is evaluated by the (diffuse area) emitters of
+ * the shapes of the group, which are shared by all instances.
+ */
+template <typename Float, typename Spectrum>
+class InstanceEmitter final : public Emitter<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Emitter, m_flags, m_shape)
+    MI_IMPORT_TYPES(Shape, ShapePtr, EmitterPtr)
+
+    using Instance_ = Instance<Float, Spectrum>;
+
+    InstanceEmitter(const Instance_ *instance,
+                    const std::vector<const Shape *> &shapes)
+        : Base(Properties()), m_instance(instance) {
+        m_flags = +EmitterFlags::Surface;
+        for (const Shape *shape : shapes) {
+            m_emitters.push_back(shape->emitter());
+            if (has_flag(shape->emitter()->flags(), EmitterFlags::SpatiallyVarying))
+                m_flags |= +EmitterFlags::SpatiallyVarying;
+        }
+        dr::set_attr(this, "flags", m_flags);
+    }
+
+    Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        // Evaluate the emitter of the instanced shape that was hit
+        if constexpr (!dr::is_jit_v<Float>) {
+            const Base *emitter = si.shape ? si.shape->emitter() : nullptr;
+            return emitter ? emitter->eval(si, active) : dr::zeros<Spectrum>();
+        } else {
+            EmitterPtr emitter = si.shape->emitter(active);
+            return emitter->eval(si, active && dr::neq(emitter, nullptr));
+        }
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &sample2, const Point2f &sample3,
+                                          Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Sample spatial component
+        auto [ps, shape] =
+            m_instance->sample_emissive_position(time, sample2, active);
+        Float pos_weight =
+            dr::select(active && ps.pdf > 0.f, dr::rcp(ps.pdf), Float(0.f));
+
+        // 2. Sample directional component
+        Vector3f local = warp::square_to_cosine_hemisphere(sample3);
+
+        // 3. Sample spectral component
+        SurfaceInteraction3f si(ps, dr::zeros<Wavelength>());
+        EmitterPtr emitter = shape->emitter(active);
+        auto [wavelength, wav_weight] =
+            emitter->sample_wavelengths(si, wavelength_sample, active);
+        si.time = time;
+        si.wavelengths = wavelength;
+
+        // Note: some terms cancelled out with `warp::square_to_cosine_hemisphere_pdf`.
+        Spectrum weight = pos_weight * wav_weight * dr::Pi<ScalarFloat>;
+
+        return { si.spawn_ray(si.to_world(local)),
+                 depolarizer<Spectrum>(weight) };
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        auto [ps, shape] =
+            m_instance->sample_emissive_position(it.time, sample, active);
+
+        DirectionSample3f ds(ps);
+        ds.d = ds.p - it.p;
+
+        Float dist_squared = dr::squared_norm(ds.d);
+        ds.dist = dr::sqrt(dist_squared);
+        ds.d /= ds.dist;
+
+        Float dp = dr::dot(ds.d, ds.n);
+        active &= dp < 0.f && dr::neq(ds.pdf, 0.f);
+        ds.pdf = dr::select(active, ds.pdf * dist_squared / -dp, 0.f);
+        ds.emitter = this;
+
+        EmitterPtr emitter = shape->emitter(active);
+        Spectrum spec = emitter->eval_direction(it, ds, active) / ds.pdf;
+
+        return { ds, spec & active };
+    }
+
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
+                        Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        active &= dr::dot(ds.d, ds.n) < 0.f;
+        Float value = m_shape->pdf_direction(it, ds, active);
+        return dr::select(active, value, 0.f);
+    }
+
+    Spectrum eval_direction(const Interaction3f &it,
+                            const DirectionSample3f &ds,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        // 'ds' does not identify the emissive shape, use the first one
+        return m_emitters[0]->eval_direction(it, ds, active);
+    }
+
+    std::pair<PositionSample3f, Float>
+    sample_position(Float time, const Point2f &sample,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSamplePosition, active);
+        PositionSample3f ps =
+            m_instance->sample_emissive_position(time, sample, active).first;
+        Float weight = dr::select(active && ps.pdf > 0.f, dr::rcp(ps.pdf), Float(0.f));
+        return { ps, weight };
+    }
+
+    Float pdf_position(const PositionSample3f &ps, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return m_shape->pdf_position(ps, active);
+    }
+
+    std::pair<Wavelength, Spectrum>
+    sample_wavelengths(const SurfaceInteraction3f &si, Float sample,
+                       Mask active) const override {
+        // Use the emitter of the shape of 'si' if known, and the first one otherwise
+        if constexpr (!dr::is_jit_v<Float>) {
+            EmitterPtr emitter = si.shape ? si.shape->emitter() : nullptr;
+            if (!emitter)
+                emitter = m_emitters[0];
+            return emitter->sample_wavelengths(si, sample, active);
+        } else {
+            EmitterPtr emitter = si.shape->emitter(active);
+            emitter = dr::select(dr::neq(emitter, nullptr), emitter,
+                                 EmitterPtr(m_emitters[0]));
+            return emitter->sample_wavelengths(si, sample, active);
+        }
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_shape->bbox(); }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "InstanceEmitter[" << std::endl
+            << "  emitter_count = " << m_emitters.size() << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    const Instance_ *m_instance;
+    /// Emitters of the emissive shapes of the shape group
+    std::vector<const Base *> m_emitters;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(Instance, Shape)
+MI_IMPLEMENT_CLASS_VARIANT(InstanceEmitter, Emitter)
+MI_INSTANTIATE_CLASS(InstanceEmitter)
 MI_EXPORT_PLUGIN(Instance, "Instanced geometry")
 NAMESPACE_END(mitsuba)
@@ -0,0 +1,569 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/shape.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#if defined(MI_ENABLE_EMBREE)
+#include <embree3/rtcore.h>
+#else
+#include <mitsuba/render/kdtree.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-lazy:
+
+Deferred loading proxy (:monosp:`lazy`)
+---------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the mesh that is loaded on demand. Wavefront OBJ, PLY and
+     serialized files are supported and recognized by their extension.
+
+ * - shape_index
+   - |int|
+   - Index of the mesh within a serialized file (Default: 0)
+
+ * - bbox_min, bbox_max
+   - |point|
+   - Corners of a bounding box (in object space) that encloses the mesh.
+
+ * - memory_budget
+   - |float|
+   - Maximum amount of memory (in MiB) occupied by the meshes of all
+     :monosp:`lazy` shapes. When several shapes specify a budget, the smallest
+     one applies. A value of zero disables the budget. (Default: 0)
+
+ * - face_normals
+   - |bool|
+   - When set to |true|, any existing or computed vertex normals are
+     discarded and *face normals* will instead be used during rendering.
+     This gives the rendered object a faceted appearance. (Default: |false|)
+
+ * - flip_normals
+   - |bool|
+   - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:
+     |false|, i.e. the normals point outside)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation.
+     (Default: none, i.e. object space = world space)
+
+This plugin stands in for a mesh whose file is only read the first time a ray
+enters its bounding box. Scenes with large sets of geometry that is mostly
+off-screen or occluded thus load much faster and only keep the meshes that
+actually contribute to the image in memory. Since the file isn't read when the
+scene is created, the bounding box of the mesh must be provided.
+
+The proxy is registered as a single primitive of the scene's acceleration data
+structure (a user geometry when Embree is used). Upon the first intersection,
+the mesh is loaded and a dedicated acceleration data structure is built for
+it, after which rays are traced through it. Loading is thread-safe: the
+threads that hit the same proxy concurrently wait for a single load.
+
+When a :monosp:`memory_budget` is specified, the meshes that were least
+recently intersected are released once their combined size exceeds the
+budget, and loaded again when needed. The budget accounts for the vertex and
+index buffers of the meshes, but not for their acceleration data structures.
+
+.. note::
+
+    This plugin is currently only supported by the scalar variants: the
+    vectorized variants record their ray tracing and shading kernels before
+    any ray is traced, when the mesh data isn't yet known. Lazy shapes cannot
+    be emitters or sensors.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: lazy
+
+        <shape type="lazy">
+            <string name="filename" value="rock_017.ply"/>
+            <point name="bbox_min" x="-1" y="-1" z="0"/>
+            <point name="bbox_max" x="1" y="1" z="1.5"/>
+            <float name="memory_budget" value="4096"/>
+            <bsdf type="diffuse"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'type': 'lazy',
+        'filename': 'rock_017.ply',
+        'bbox_min': [-1, -1, 0],
+        'bbox_max': [1, 1, 1.5],
+        'memory_budget': 4096,
+        'bsdf': {
+            'type': 'diffuse'
+        }
+
+ */
+
+template <typename Float, typename Spectrum>
+class LazyShape final : public Shape<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Shape, m_to_world, m_is_instance, initialize,
+                   get_children_string, is_emitter, is_sensor)
+    MI_IMPORT_TYPES(Mesh, ShapeKDTree)
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarRay3f;
+
+    LazyShape(const Properties &props) : Base(props) {
+        if constexpr (dr::is_jit_v<Float>)
+            Throw("The lazy shape is currently only available in scalar variants!");
+
+        if (is_emitter() || is_sensor())
+            Throw("Lazy shapes cannot be emitters or sensors!");
+
+        FileResolver *fs = Thread::thread()->file_resolver();
+        m_filename = fs->resolve(props.string("filename"));
+        m_name = m_filename.filename().string();
+        if (!fs::exists(m_filename))
+            Throw("\"%s\": file does not exist!", m_filename);
+
+        std::string extension = string::to_lower(m_filename.extension().string());
+        if (extension == ".obj")
+            m_plugin = "obj";
+        else if (extension == ".ply")
+            m_plugin = "ply";
+        else if (extension == ".serialized")
+            m_plugin = "serialized";
+        else
+            Throw("\"%s\": unsupported file type \"%s\"!", m_name, extension);
+
+        m_shape_index = props.get<uint32_t>("shape_index", 0);
+        m_face_normals = props.get<bool>("face_normals", false);
+        m_flip_normals = props.get<bool>("flip_normals", false);
+
+        ScalarBoundingBox3f bbox(props.get<ScalarPoint3f>("bbox_min"),
+                                 props.get<ScalarPoint3f>("bbox_max"));
+        if (!bbox.valid())
+            Throw("\"%s\": invalid bounding box!", m_name);
+
+        // Bounding box of the transformed corners
+        const ScalarTransform4f &to_world = m_to_world.scalar();
+        for (int i = 0; i < 8; ++i)
+            m_bbox.expand(to_world * bbox.corner(i));
+
+        ScalarFloat budget = props.get<ScalarFloat>("memory_budget", 0.f);
+        if (budget < 0.f)
+            Throw("The memory budget must be non-negative!");
+        if (budget > 0.f) {
+            Cache &c = cache();
+            std::lock_guard<std::mutex> guard(c.mutex);
+            size_t bytes = (size_t) (budget * 1024.f * 1024.f);
+            c.budget = c.budget == 0 ? bytes : std::min(c.budget, bytes);
+        }
+
+        initialize();
+    }
+
+    ~LazyShape() {
+        // Release the geometry before the Embree device
+        release();
+#if defined(MI_ENABLE_EMBREE)
+        if (m_device)
+            rtcReleaseDevice(m_device);
+#endif
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarSize primitive_count() const override { return 1; }
+
+    /// Has the mesh been loaded (and not been released since)?
+    bool loaded() const { return (bool) std::atomic_load(&m_geometry); }
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const override {
+        std::shared_ptr<const Geometry> geometry = acquire();
+        if (!geometry)
+            return { dr::Infinity<ScalarFloat>, ScalarPoint2f(0.f),
+                     (ScalarUInt32) -1, 0 };
+
+#if defined(MI_ENABLE_EMBREE)
+        RTCRayHit rh = embree_ray(ray);
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+        rtcIntersect1(geometry->scene, &context, &rh);
+
+        if (rh.hit.geomID == RTC_INVALID_GEOMETRY_ID)
+            return { dr::Infinity<ScalarFloat>, ScalarPoint2f(0.f),
+                     (ScalarUInt32) -1, 0 };
+        return { rh.ray.tfar, ScalarPoint2f(rh.hit.u, rh.hit.v),
+                 (ScalarUInt32) -1, rh.hit.primID };
+#else
+        auto pi = geometry->kdtree->template ray_intersect_scalar<false>(ray);
+        return { pi.t, pi.prim_uv, (ScalarUInt32) -1, pi.prim_index };
+#endif
+    }
+
+    bool ray_test_scalar(const ScalarRay3f &ray) const override {
+        std::shared_ptr<const Geometry> geometry = acquire();
+        if (!geometry)
+            return false;
+
+#if defined(MI_ENABLE_EMBREE)
+        RTCRay r = embree_ray(ray).ray;
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+        rtcOccluded1(geometry->scene, &context, &r);
+        return r.tfar == -dr::Infinity<float>;
+#else
+        return geometry->kdtree->template ray_intersect_scalar<true>(ray).is_valid();
+#endif
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (active) {
+                auto [t, prim_uv, unused, prim_index] =
+                    ray_intersect_preliminary_scalar(ray);
+                pi.t = t;
+                pi.prim_uv = prim_uv;
+                pi.prim_index = prim_index;
+                pi.shape = this;
+            }
+        }
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if constexpr (!dr::is_jit_v<Float>)
+            return active && ray_test_scalar(ray);
+        else
+            return false;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     const PreliminaryIntersection3f &pi,
+                                                     uint32_t ray_flags,
+                                                     uint32_t recursion_depth,
+                                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Early exit when tracing isn't necessary
+        if (!m_is_instance && recursion_depth > 0)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        /* The mesh may have been released by another thread since the
+           intersection, in which case it is loaded again. The triangle
+           indices remain valid since the file is read deterministically. */
+        std::shared_ptr<const Geometry> geometry = acquire();
+        if (!geometry)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        SurfaceInteraction3f si = geometry->mesh->compute_surface_interaction(
+            ray, pi, ray_flags, 0, active);
+        si.shape = this;
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if (m_device != device) {
+            release();
+            rtcRetainDevice(device);
+            if (m_device)
+                rtcReleaseDevice(m_device);
+            m_device = device;
+        }
+
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+        rtcSetGeometryUserPrimitiveCount(geom, 1);
+        rtcSetGeometryUserData(geom, (void *) this);
+        rtcSetGeometryBoundsFunction(geom, embree_bbox, nullptr);
+        rtcSetGeometryIntersectFunction(geom, embree_intersect);
+        rtcSetGeometryOccludedFunction(geom, embree_occluded);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "LazyShape[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  loaded = " << loaded() << "," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Mesh loaded on demand, along with its acceleration data structure
+    struct Geometry {
+        ref<Mesh> mesh;
+#if defined(MI_ENABLE_EMBREE)
+        RTCScene scene = nullptr;
+        ~Geometry() { rtcReleaseScene(scene); }
+#else
+        ref<ShapeKDTree> kdtree;
+#endif
+    };
+
+    /// Memory budget shared by all lazy shapes
+    struct Cache {
+        std::mutex mutex;
+        /// Shapes whose geometry is currently loaded
+        std::vector<const LazyShape *> loaded;
+        /// Approximate memory usage and budget in bytes (zero: unlimited)
+        size_t usage = 0, budget = 0;
+        /// Incremented whenever a mesh is loaded, used to find the least recently used ones
+        std::atomic<uint64_t> epoch { 0 };
+    };
+
+    static Cache &cache() {
+        static Cache c;
+        return c;
+    }
+
+    /// Release the geometry of this shape and remove it from the cache
+    void release() const {
+        Cache &c = cache();
+        std::lock_guard<std::mutex> guard(c.mutex);
+        auto it = std::find(c.loaded.begin(), c.loaded.end(), this);
+        if (it != c.loaded.end()) {
+            c.loaded.erase(it);
+            c.usage -= m_bytes;
+        }
+        std::atomic_store(&m_geometry, std::shared_ptr<const Geometry>());
+    }
+
+    /// Return the geometry of this shape, loading it if necessary
+    std::shared_ptr<const Geometry> acquire() const {
+        Cache &c = cache();
+        uint64_t epoch = c.epoch.load(std::memory_order_relaxed);
+        if (m_last_used.load(std::memory_order_relaxed) != epoch)
+            m_last_used.store(epoch, std::memory_order_relaxed);
+
+        std::shared_ptr<const Geometry> geometry = std::atomic_load(&m_geometry);
+        if (likely(geometry) || m_failed)
+            return geometry;
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        geometry = std::atomic_load(&m_geometry);
+        if (geometry || m_failed)
+            return geometry;
+
+        try {
+            geometry = load();
+        } catch (const std::exception &e) {
+            // This runs within the ray tracing kernels, which must not throw
+            Log(Warn, "\"%s\": could not load the mesh, ignoring it: %s",
+                m_name, e.what());
+            m_failed.store(true);
+            return geometry;
+        }
+        std::atomic_store(&m_geometry, geometry);
+
+        // Release the least recently used meshes once the budget is exceeded
+        std::lock_guard<std::mutex> cache_guard(c.mutex);
+        m_last_used.store(c.epoch.fetch_add(1) + 1, std::memory_order_relaxed);
+        c.loaded.push_back(this);
+        c.usage += m_bytes;
+
+        while (c.budget != 0 && c.usage > c.budget && c.loaded.size() > 1) {
+            auto victim = std::min_element(
+                c.loaded.begin(), c.loaded.end(),
+                [this](const LazyShape *a, const LazyShape *b) {
+                    // Never release the mesh that was just loaded
+                    if (a == this || b == this)
+                        return b == this;
+                    return a->m_last_used.load(std::memory_order_relaxed) <
+                           b->m_last_used.load(std::memory_order_relaxed);
+                });
+            const LazyShape *shape = *victim;
+            c.loaded.erase(victim);
+            c.usage -= shape->m_bytes;
+
+            // Threads that are still using the mesh keep it alive until they are done
+            std::atomic_store(&shape->m_geometry, std::shared_ptr<const Geometry>());
+            Log(Debug, "\"%s\": released the mesh to stay within the memory budget",
+                shape->m_name);
+        }
+
+        return geometry;
+    }
+
+    /// Load the mesh and build its acceleration data structure
+    std::shared_ptr<const Geometry> load() const {
+        Timer timer;
+        Properties props(m_plugin);
+        props.set_string("filename", m_filename.string());
+        props.set_bool("face_normals", m_face_normals);
+        props.set_bool("flip_normals", m_flip_normals);
+        props.set_transform("to_world", m_to_world.scalar());
+        if (m_plugin == "serialized")
+            props.set_int("shape_index", (int) m_shape_index);
+
+        std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>();
+        geometry->mesh = PluginManager::instance()->create_object<Mesh>(props);
+        if (!geometry->mesh)
+            Throw("\"%s\" does not contain a triangle mesh!", m_name);
+        const Mesh *mesh = geometry->mesh.get();
+
+        if (!m_bbox.contains(mesh->bbox()))
+            Log(Warn, "\"%s\": the mesh extends beyond the specified bounding "
+                "box, hence some intersections may be missed.", m_name);
+
+#if defined(MI_ENABLE_EMBREE)
+        geometry->scene = rtcNewScene(m_device);
+        RTCGeometry geom = geometry->mesh->embree_geometry(m_device);
+        rtcAttachGeometry(geometry->scene, geom);
+        rtcReleaseGeometry(geom);
+        rtcCommitScene(geometry->scene);
+#else
+        geometry->kdtree = new ShapeKDTree(Properties());
+        geometry->kdtree->add_shape(geometry->mesh);
+        geometry->kdtree->build();
+#endif
+
+        m_bytes = (dr::width(mesh->vertex_positions_buffer()) +
+                   dr::width(mesh->vertex_normals_buffer()) +
+                   dr::width(mesh->vertex_texcoords_buffer())) * sizeof(InputFloat) +
+                  dr::width(mesh->faces_buffer()) * sizeof(uint32_t);
+
+        Log(Debug, "\"%s\": loaded %u triangles on demand (%s, took %s)", m_name,
+            mesh->face_count(), util::mem_string(m_bytes),
+            util::time_string((float) timer.value()));
+
+        return geometry;
+    }
+
+#if defined(MI_ENABLE_EMBREE)
+    static RTCRayHit embree_ray(const ScalarRay3f &ray) {
+        RTCRayHit rh;
+        rh.ray.org_x = (float) ray.o.x();
+        rh.ray.org_y = (float) ray.o.y();
+        rh.ray.org_z = (float) ray.o.z();
+        rh.ray.tnear = 0.f;
+        rh.ray.dir_x = (float) ray.d.x();
+        rh.ray.dir_y = (float) ray.d.y();
+        rh.ray.dir_z = (float) ray.d.z();
+        rh.ray.time  = (float) ray.time;
+        rh.ray.tfar  = (float) ray.maxt;
+        rh.ray.mask  = 0;
+        rh.ray.id    = 0;
+        rh.ray.flags = 0;
+        rh.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+        rh.hit.instID[0] = RTC_INVALID_GEOMETRY_ID;
+        return rh;
+    }
+
+    static void embree_bbox(const RTCBoundsFunctionArguments *args) {
+        const LazyShape *shape = (const LazyShape *) args->geometryUserPtr;
+        ScalarBoundingBox3f bbox = shape->bbox();
+        RTCBounds *bounds_o = args->bounds_o;
+        bounds_o->lower_x = (float) bbox.min.x();
+        bounds_o->lower_y = (float) bbox.min.y();
+        bounds_o->lower_z = (float) bbox.min.z();
+        bounds_o->upper_x = (float) bbox.max.x();
+        bounds_o->upper_y = (float) bbox.max.y();
+        bounds_o->upper_z = (float) bbox.max.z();
+    }
+
+    /// Convert an Embree ray into a Mitsuba ray starting at \c tnear
+    static ScalarRay3f mitsuba_ray(const RTCRay *rtc_ray) {
+        ScalarRay3f ray;
+        ray.d = ScalarVector3f(rtc_ray->dir_x, rtc_ray->dir_y, rtc_ray->dir_z);
+        ray.o = ScalarPoint3f(rtc_ray->org_x, rtc_ray->org_y, rtc_ray->org_z) +
+                ray.d * rtc_ray->tnear;
+        ray.maxt = rtc_ray->tfar - rtc_ray->tnear;
+        ray.time = rtc_ray->time;
+        return ray;
+    }
+
+    // The scalar variants only trace single rays, hence packets aren't supported
+    static void embree_intersect(const RTCIntersectFunctionNArguments *args) {
+        if (args->N != 1)
+            Throw("embree_intersect(): unsupported packet size!");
+        if (!args->valid[0])
+            return;
+
+        const LazyShape *shape = (const LazyShape *) args->geometryUserPtr;
+        RTCRayHit *rh = (RTCRayHit *) args->rayhit;
+        auto [t, uv, unused, prim_index] =
+            shape->ray_intersect_preliminary_scalar(mitsuba_ray(&rh->ray));
+        if (t == dr::Infinity<ScalarFloat>)
+            return;
+
+        rh->ray.tfar      = (float) (t + rh->ray.tnear);
+        rh->hit.u         = (float) uv.x();
+        rh->hit.v         = (float) uv.y();
+        rh->hit.geomID    = args->geomID;
+        rh->hit.primID    = prim_index;
+        rh->hit.instID[0] = args->context->instID[0];
+    }
+
+    static void embree_occluded(const RTCOccludedFunctionNArguments *args) {
+        if (args->N != 1)
+            Throw("embree_occluded(): unsupported packet size!");
+        if (!args->valid[0])
+            return;
+
+        const LazyShape *shape = (const LazyShape *) args->geometryUserPtr;
+        RTCRay *ray = (RTCRay *) args->ray;
+        if (shape->ray_test_scalar(mitsuba_ray(ray)))
+            ray->tfar = -dr::Infinity<float>;
+    }
+#endif
+
+private:
+    using InputFloat = typename Mesh::InputFloat;
+
+    std::string m_name;
+    fs::path m_filename;
+    std::string m_plugin;
+    uint32_t m_shape_index;
+    bool m_face_normals, m_flip_normals;
+    ScalarBoundingBox3f m_bbox;
+
+    /// Geometry loaded on demand (accessed atomically, \c nullptr if not loaded)
+    mutable std::shared_ptr<const Geometry> m_geometry;
+    /// Serializes the loading of the geometry
+    mutable std::mutex m_mutex;
+    /// Set when the file could not be loaded
+    mutable std::atomic<bool> m_failed { false };
+    /// Size of the loaded mesh in bytes
+    mutable size_t m_bytes = 0;
+    /// Cache epoch of the last intersection with this shape
+    mutable std::atomic<uint64_t> m_last_used { 0 };
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCDevice m_device = nullptr;
+#endif
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(LazyShape, Shape)
+MI_EXPORT_PLUGIN(LazyShape, "Deferred loading proxy");
+NAMESPACE_END(mitsuba)
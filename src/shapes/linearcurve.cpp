@@ -33,6 +33,11 @@ Linear curve (:monosp:`linearcurve`)
    - |string|
    - Filename of the curves to be loaded
 
+ * - split_depth
+   - |int|
+   - Maximum number of times each segment may be bisected to tighten its
+     bounding boxes (Default: 0, i.e. no splitting)
+
  * - to_world
    - |transform|
    - Specifies a linear object-to-world transformation. Note that the control
@@ -89,6 +94,14 @@ points and increasing radii::
      4.0 1.0 2.2 5
      4.0 0.0 2.3 6
 
+Long and thin segments that run diagonally to the coordinate axes have loose
+axis-aligned bounding boxes, which makes the ray traversal of e.g. hair and
+fur expensive. When :monosp:`split_depth` is positive, every segment is
+therefore recursively bisected at load time as long as this substantially
+reduces the surface area of the bounding boxes of its halves. The additional
+control points are exposed as scene parameters, and the :math:`v` texture
+coordinate is distributed uniformly over all (sub-)segments.
+
 .. tabs::
     .. code-tab:: xml
         :name: linearcurve
@@ -241,17 +254,25 @@ public:
             fail("Empty curve file: no control points were read!");
         finish_curve();
 
-        m_control_point_count = vertices.size();
-
-        std::unique_ptr<ScalarIndex[]> indices = std::make_unique<ScalarIndex[]>(segment_count);
-        size_t segment_index = 0;
+        std::vector<ScalarIndex> indices;
+        indices.reserve(segment_count);
         for (size_t i = 0; i < curve_1st_idx.size(); ++i) {
             size_t next_curve_idx = i + 1 < curve_1st_idx.size() ? curve_1st_idx[i + 1] : vertices.size();
             size_t curve_segment_count = next_curve_idx - curve_1st_idx[i] - 1;
             for (size_t j = 0; j < curve_segment_count; ++j)
-                indices[segment_index++] = curve_1st_idx[i] + j;
+                indices.push_back((ScalarIndex) (curve_1st_idx[i] + j));
         }
-        m_indices = dr::load<UInt32Storage>(indices.get(), segment_count);
+
+        uint32_t split_depth = props.get<uint32_t>("split_depth", 0);
+        if (split_depth > 0) {
+            size_t original_count = indices.size();
+            split_segments(vertices, radius, indices, split_depth);
+            Log(Debug, "\"%s\": split %i segments into %i", m_name,
+                original_count, indices.size());
+        }
+
+        m_control_point_count = vertices.size();
+        m_indices = dr::load<UInt32Storage>(indices.data(), indices.size());
 
         std::unique_ptr<InputFloat[]> positions =
             std::make_unique<InputFloat[]>(m_control_point_count * 3);
@@ -317,7 +338,8 @@ public:
         if (!m_is_instance && recursion_depth > 0)
             return dr::zeros<SurfaceInteraction3f>();
 
-        bool need_uv = has_flag(ray_flags, RayFlags::UV);
+        bool need_dp_duv = has_flag(ray_flags, RayFlags::dPdUV);
+        bool need_uv     = has_flag(ray_flags, RayFlags::UV) || need_dp_duv;
 
         SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
         si.t = dr::select(active, pi.t, dr::Infinity<Float>);
@@ -355,6 +377,16 @@ public:
             si.uv = Point2f(u, v);
         }
 
+        if (need_dp_duv) {
+            /* Rotating the radial vector around the segment axis gives the
+               derivative w.r.t. 'u', which an anisotropic BSDF (e.g. 'hair')
+               uses as the tangent of its shading frame */
+            Vector3f rad_vec = si.p - c;
+            si.dp_du = dr::TwoPi<Float> * (dr::dot(rad_vec, u_rad) * u_rot -
+                                           dr::dot(rad_vec, u_rot) * u_rad);
+            si.dp_dv = (p1 - p0) * (ScalarFloat) dr::width(m_indices);
+        }
+
         si.shape    = this;
         si.instance = nullptr;
 
@@ -466,6 +498,76 @@ private:
         *start_ = start;
     }
 
+    /**
+     * \brief Recursively bisect all segments while this reduces the total
+     * surface area of their bounding boxes by a sufficient amount
+     *
+     * The endpoints of the sub-segments of a split segment are appended to
+     * the control points as a new chain.
+     */
+    void split_segments(std::vector<InputPoint3f> &vertices,
+                        std::vector<InputFloat> &radius,
+                        std::vector<ScalarIndex> &indices,
+                        uint32_t max_depth) const {
+        /* Only split if the bounding boxes of the two halves have at most
+           this fraction of the surface area of the parent's */
+        const ScalarFloat threshold = .7f;
+
+        std::vector<ScalarIndex> result;
+        result.reserve(indices.size());
+        struct Item { InputFloat t0, t1; uint32_t depth; };
+        std::vector<Item> stack, leaves;
+
+        for (ScalarIndex index : indices) {
+            InputPoint3f p0 = vertices[index], p1 = vertices[index + 1];
+            InputFloat r0 = radius[index], r1 = radius[index + 1];
+
+            auto bbox = [&](InputFloat t0, InputFloat t1) {
+                ScalarBoundingBox3f b(ScalarPoint3f(dr::lerp(p0, p1, t0)));
+                b.expand(ScalarPoint3f(dr::lerp(p0, p1, t1)));
+                ScalarFloat r = dr::maximum(dr::lerp(r0, r1, t0), dr::lerp(r0, r1, t1));
+                b.min -= r;
+                b.max += r;
+                return b;
+            };
+
+            leaves.clear();
+            stack.push_back({ 0.f, 1.f, 0 });
+            while (!stack.empty()) {
+                Item item = stack.back();
+                stack.pop_back();
+
+                InputFloat tm = (item.t0 + item.t1) * .5f;
+                if (item.depth < max_depth &&
+                    bbox(item.t0, tm).surface_area() + bbox(tm, item.t1).surface_area() <
+                        threshold * bbox(item.t0, item.t1).surface_area()) {
+                    stack.push_back({ tm, item.t1, item.depth + 1 });
+                    stack.push_back({ item.t0, tm, item.depth + 1 });
+                } else {
+                    leaves.push_back(item);
+                }
+            }
+
+            // Segments that were not split keep their control points
+            if (leaves.size() == 1) {
+                result.push_back(index);
+                continue;
+            }
+
+            ScalarIndex first = (ScalarIndex) vertices.size();
+            vertices.push_back(p0);
+            radius.push_back(r0);
+            for (size_t i = 0; i < leaves.size(); ++i) {
+                InputFloat t = leaves[i].t1;
+                vertices.push_back(i + 1 < leaves.size() ? dr::lerp(p0, p1, t) : p1);
+                radius.push_back(i + 1 < leaves.size() ? dr::lerp(r0, r1, t) : r1);
+                result.push_back(first + (ScalarIndex) i);
+            }
+        }
+
+        indices = std::move(result);
+    }
+
     void recompute_bbox() {
         auto&& control_points = dr::migrate(m_control_points, AllocType::Host);
         if constexpr (dr::is_jit_v<Float>)
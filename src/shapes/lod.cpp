@@ -0,0 +1,291 @@
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-lod:
+
+Level of detail (:monosp:`lod`)
+-------------------------------
+
+.. pluginparameters::
+
+ * - level_0, level_1, ..
+   - |string|
+   - Filenames of the levels of detail, ordered from the finest
+     (:monosp:`level_0`) to the coarsest one. Wavefront OBJ, PLY and
+     serialized files are supported and recognized by their extension.
+
+ * - thresholds
+   - |string|
+   - Comma-separated list of decreasing projected sizes (in pixels) that
+     specifies when to switch to the next coarser level. Must contain one
+     entry less than the number of levels.
+
+ * - face_normals
+   - |bool|
+   - When set to |true|, any existing or computed vertex normals are
+     discarded and *face normals* will instead be used during rendering.
+     This gives the rendered object a faceted appearance. (Default: |false|)
+
+ * - flip_tex_coords
+   - |bool|
+   - Treat the vertical component of the texture as inverted? Only applies
+     to levels stored in OBJ files. (Default: |true|)
+
+ * - flip_normals
+   - |bool|
+   - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:
+     |false|, i.e. the normals point outside)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation.
+     (Default: none, i.e. object space = world space)
+
+This plugin holds several versions of the same mesh at decreasing resolutions
+and renders one of them, chosen according to the size of the object as seen
+from the sensors of the scene. Distant geometry can thus be represented by a
+much coarser mesh, which reduces the memory footprint as well as the build and
+traversal time of the acceleration data structure.
+
+Only the coarsest level is loaded when the shape is created. Once all sensors
+of the scene are known, the diameter of the bounding box is projected onto the
+film of each sensor, and the largest of these sizes :math:`s` (in pixels)
+selects the level: with thresholds :math:`t_0 > t_1 > \ldots`, level :math:`i`
+is the one for which :math:`t_{i-1} > s \ge t_i`. Only the selected level is
+then loaded. When the bounding box contains one of the sensors, the finest
+level is used. When the shape is not part of a scene (or the scene contains
+no sensors), the coarsest level is rendered.
+
+The levels are expected to have approximately the same extents. Their vertex
+normals and texture coordinates are used when present.
+
+.. note::
+
+    The level is chosen once for each :monosp:`lod` shape when the scene is
+    built. Shapes referenced by a :ref:`shape group <shape-shapegroup>` share
+    their geometry between all instances and are not refined.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: lod
+
+        <shape type="lod">
+            <string name="level_0" value="tree_high.ply"/>
+            <string name="level_1" value="tree_medium.ply"/>
+            <string name="level_2" value="tree_low.ply"/>
+            <string name="thresholds" value="256, 64"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'type': 'lod',
+        'level_0': 'tree_high.ply',
+        'level_1': 'tree_medium.ply',
+        'level_2': 'tree_low.ply',
+        'thresholds': '256, 64'
+
+ */
+
+template <typename Float, typename Spectrum>
+class LODMesh final : public Mesh<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count,
+                   m_face_count, m_vertex_positions, m_vertex_normals,
+                   m_vertex_texcoords, m_faces, m_face_normals, m_quantized,
+                   m_vertex_normals_quantized, m_vertex_texcoords_quantized,
+                   m_vertex_tangents, m_vertex_corner_offsets, m_vertex_corners,
+                   m_area_pmf, m_area_alias, m_parameterization, initialize)
+    MI_IMPORT_TYPES()
+
+    using typename Base::FloatStorage;
+
+    LODMesh(const Properties &props) : Base(props) {
+        m_flip_tex_coords = props.get<bool>("flip_tex_coords", true);
+
+        auto fr = Thread::thread()->file_resolver();
+        for (size_t i = 0; ; ++i) {
+            std::string name = "level_" + std::to_string(i);
+            if (!props.has_property(name))
+                break;
+            fs::path file_path = fr->resolve(props.string(name));
+            if (!fs::exists(file_path))
+                Throw("Error while loading level %i of \"%s\": file \"%s\" not "
+                      "found", i, props.id(), file_path.string());
+            m_filenames.push_back(file_path);
+        }
+
+        if (m_filenames.empty())
+            Throw("A level of detail shape requires at least one level "
+                  "(\"level_0\")!");
+
+        if (props.has_property("thresholds")) {
+            for (const std::string &value :
+                 string::tokenize(props.string("thresholds"), ", "))
+                m_thresholds.push_back(string::stof<ScalarFloat>(value));
+        }
+
+        if (m_thresholds.size() + 1 != m_filenames.size())
+            Throw("Expected %i thresholds for %i levels of detail, got %i!",
+                  m_filenames.size() - 1, m_filenames.size(),
+                  m_thresholds.size());
+        for (size_t i = 0; i < m_thresholds.size(); ++i) {
+            if (!(m_thresholds[i] > 0.f) ||
+                (i > 0 && !(m_thresholds[i] < m_thresholds[i - 1])))
+                Throw("The level of detail thresholds must be positive and "
+                      "decreasing!");
+        }
+
+        m_levels.resize(m_filenames.size());
+        select(m_filenames.size() - 1);
+    }
+
+    bool update_tessellation(const std::vector<ref<Sensor>> &sensors) override {
+        if (sensors.empty())
+            return false;
+
+        ScalarFloat size = projected_size(sensors);
+        size_t level = 0;
+        while (level < m_thresholds.size() && size < m_thresholds[level])
+            ++level;
+
+        if (level == m_level)
+            return false;
+
+        Log(Debug, "\"%s\": projected size of %.1f pixels, using level %i of %i",
+            m_name, size, level, m_filenames.size());
+        select(level);
+        return true;
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "LODMesh[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  level = " << m_level << "," << std::endl
+            << "  level_count = " << m_filenames.size() << "," << std::endl
+            << "  vertex_count = " << m_vertex_count << "," << std::endl
+            << "  face_count = " << m_face_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /**
+     * Largest size of the bounding box diameter on the film of the given
+     * sensors, estimated from the rays through the film center and its
+     * horizontal neighbor
+     */
+    ScalarFloat projected_size(const std::vector<ref<Sensor>> &sensors) const {
+        ScalarPoint3f center = m_bbox.center();
+        ScalarFloat radius = dr::norm(m_bbox.extents()) * .5f, size = 0.f;
+
+        for (const Sensor *sensor : sensors) {
+            ScalarVector2f res(sensor->film()->crop_size());
+            auto [ray0, weight0] = sensor->sample_ray(
+                0.f, .5f, Point2f(.5f, .5f), Point2f(.5f, .5f));
+            auto [ray1, weight1] = sensor->sample_ray(
+                0.f, .5f, Point2f(.5f + 1.f / res.x(), .5f), Point2f(.5f, .5f));
+            ScalarPoint3f o0 = dr::slice(ray0.o), o1 = dr::slice(ray1.o);
+            ScalarVector3f d0 = dr::slice(ray0.d), d1 = dr::slice(ray1.d);
+
+            if (m_bbox.contains(o0))
+                return dr::Infinity<ScalarFloat>;
+
+            // Footprint of a pixel at the distance of the closest point of the bounding sphere
+            ScalarFloat distance = dr::maximum(dr::norm(center - o0) - radius, 0.f),
+                        footprint = dr::norm(o1 - o0) + distance * dr::unit_angle(d0, d1);
+            if (footprint > 0.f)
+                size = dr::maximum(size, 2.f * radius / footprint);
+            else
+                return dr::Infinity<ScalarFloat>;
+        }
+
+        return size;
+    }
+
+    /// Load a level of detail (if needed) and use its geometry
+    void select(size_t level) {
+        ref<Base> &mesh = m_levels[level];
+        if (!mesh) {
+            ScopedPhase phase(ProfilerPhase::LoadGeometry);
+            const fs::path &file_path = m_filenames[level];
+            std::string extension = string::to_lower(file_path.extension().string());
+
+            std::string plugin;
+            if (extension == ".obj")
+                plugin = "obj";
+            else if (extension == ".ply")
+                plugin = "ply";
+            else if (extension == ".serialized")
+                plugin = "serialized";
+            else
+                Throw("\"%s\": unsupported file type \"%s\" for level %i!",
+                      m_name, extension, level);
+
+            Properties props(plugin);
+            props.set_string("filename", file_path.string());
+            props.set_bool("face_normals", m_face_normals);
+            props.set_transform("to_world", m_to_world.scalar());
+            if (plugin == "obj")
+                props.set_bool("flip_tex_coords", m_flip_tex_coords);
+
+            mesh = PluginManager::instance()->create_object<Base>(props);
+            if (!mesh)
+                Throw("\"%s\": level %i is not a triangle mesh!", m_name, level);
+        }
+
+        m_name = mesh->id().empty() ? m_filenames[level].filename().string()
+                                    : mesh->id();
+        m_bbox = mesh->bbox();
+        m_vertex_count = mesh->vertex_count();
+        m_face_count = mesh->face_count();
+        m_faces = mesh->faces_buffer();
+        m_vertex_positions = mesh->vertex_positions_buffer();
+        m_vertex_normals = mesh->vertex_normals_buffer();
+        m_vertex_texcoords = mesh->vertex_texcoords_buffer();
+
+        // Discard data derived from the previous level
+        m_quantized = false;
+        m_vertex_normals_quantized = DynamicBuffer<UInt32>();
+        m_vertex_texcoords_quantized = DynamicBuffer<UInt32>();
+        m_vertex_tangents = FloatStorage();
+        m_vertex_corner_offsets = DynamicBuffer<UInt32>();
+        m_vertex_corners = DynamicBuffer<UInt32>();
+        m_area_pmf = DiscreteDistribution<Float>();
+        m_area_alias = AliasDistribution<Float>();
+        m_parameterization = nullptr;
+
+        /* Keep the coarsest level around (it is always loaded), but release
+           the finer ones that are no longer used */
+        if (m_level != level && m_level + 1 < m_levels.size() &&
+            m_level != (size_t) -1)
+            m_levels[m_level] = nullptr;
+        m_level = level;
+
+        initialize();
+    }
+
+private:
+    std::vector<fs::path> m_filenames;
+    std::vector<ScalarFloat> m_thresholds;
+    /// Loaded levels of detail (the unused finer levels are not kept)
+    std::vector<ref<Base>> m_levels;
+    size_t m_level = (size_t) -1;
+    bool m_flip_tex_coords;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(LODMesh, Mesh)
+MI_EXPORT_PLUGIN(LODMesh, "Level of detail")
+NAMESPACE_END(mitsuba)
@@ -11,7 +11,7 @@ public:
     MI_IMPORT_TYPES(BSDF, Medium, Emitter, Sensor, Mesh)
 
     MergeShape(const Properties &props) {
-        std::unordered_map<Key, ref<Mesh>, key_hasher> tbl;
+        std::unordered_map<Key, std::vector<ref<Mesh>>, key_hasher> tbl;
         size_t visited = 0, ignored = 0;
         Timer timer;
 
@@ -34,17 +34,17 @@ public:
             key.has_texcoords = mesh->has_vertex_texcoords();
             key.has_face_normals = mesh->has_face_normals();
 
-            auto [it, success] = tbl.try_emplace(key, mesh);
-            if (!success)
-                it->second = it->second->merge(mesh);
+            tbl[key].push_back(mesh);
 
             visited++;
         }
 
+        // Merge each group at once instead of accumulating pairwise merges
         for (auto &kv : tbl) {
+            ref<Mesh> merged = Mesh::merge(kv.second);
             if (tbl.size() == 1)
-                kv.second->set_id(props.id());
-            m_objects.push_back(kv.second);
+                merged->set_id(props.id());
+            m_objects.push_back(merged);
         }
 
         Log(Info, "Collapsed %zu into %zu meshes. (took %s, %zu objects ignored)",
@@ -6,8 +6,13 @@
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/math.h>
+#include <nanothread/nanothread.h>
 
 #include <array>
+#include <atomic>
+#include <cstring>
+#include <exception>
 
 
 NAMESPACE_BEGIN(mitsuba)
@@ -20,7 +25,7 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
 -----------------------------------------
 
 .. pluginparameters::
- :extra-rows: 5
+ :extra-rows: 9
 
  * - filename
    - |string|
@@ -41,6 +46,33 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - quantize
+   - |bool|
+   - Store vertex normals (octahedral encoding, 2x16 bit) and texture coordinates
+     (half precision) in quantized form to reduce memory usage. Quantized normals
+     and texture coordinates are not exposed as scene parameters. (Default: |false|)
+
+ * - tangents
+   - |bool|
+   - Precompute per-vertex tangent frames from the texture coordinates (similar to
+     MikkTSpace), which makes the shading frame and hence normal and bump mapping
+     continuous across faces. (Default: |false|)
+
+ * - alias_sampling
+   - |bool|
+   - Sample triangles for emission using an alias table, which has constant instead
+     of logarithmic lookup cost in the number of faces but does not preserve the
+     stratification of the input sample. (Default: |false|)
+
+ * - direction_sampling
+   - |string|
+   - Strategy used to sample directions towards the mesh when it is an emitter:
+     :monosp:`area` samples positions uniformly, :monosp:`solid_angle` uniformly
+     samples the spherical triangle subtended by the chosen face, and
+     :monosp:`projected_solid_angle` additionally accounts for the cosine at the
+     shading point. The latter two strongly reduce noise due to large or nearby
+     emissive faces. (Default: :monosp:`area`)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
@@ -110,21 +142,10 @@ Loading an ordinary OBJ file is as simple as writing:
 
  */
 
-template <bool Negate, size_t N>
-void advance(const char **start_, const char *end, const char (&delim)[N]) {
-    const char *start = *start_;
-
-    while (true) {
-        bool is_delim = false;
-        for (size_t i = 0; i < N; ++i)
-            if (*start == delim[i])
-                is_delim = true;
-        if ((is_delim ^ Negate) || start == end)
-            break;
-        ++start;
-    }
-
-    *start_ = start;
+/// Skip spaces and tabs (and carriage returns if requested) without passing \c end
+MI_INLINE void skip_whitespace(const char *&cur, const char *end, bool skip_cr) {
+    while (cur != end && (*cur == ' ' || *cur == '\t' || (skip_cr && *cur == '\r')))
+        ++cur;
 }
 
 template <typename Float, typename Spectrum>
@@ -168,217 +189,361 @@ public:
 
         using ScalarIndex3 = std::array<ScalarIndex, 3>;
 
-        struct VertexBinding {
-            ScalarIndex3 key {{ 0, 0, 0 }};
-            ScalarIndex value { 0 };
-            VertexBinding *next { nullptr };
-        };
-
-        /// Temporary buffers for vertices, normals, and texture coordinates
-        std::vector<InputVector3f> vertices;
-        std::vector<InputNormal3f> normals;
-        std::vector<InputVector2f> texcoords;
-        std::vector<ScalarIndex3> triangles;
-        std::vector<VertexBinding> vertex_map;
-
- #if !defined(_WIN32)
+#if !defined(_WIN32)
         ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
         size_t file_size           = mmap->size();
-        const char *ptr            = (const char *) mmap->data();
+        const char *data           = (const char *) mmap->data();
 #else
         // Memory-mapped IO performs surprisingly poorly on Windows
         ref<FileStream> fs = new FileStream(file_path);
         size_t file_size = fs->size();
         std::unique_ptr<char[]> tmp(new char[file_size]);
         fs->read(tmp.get(), file_size);
-        const char *ptr = tmp.get();
+        const char *data = tmp.get();
 #endif
+        const char *eof = data + file_size;
+
+        /// Geometry parsed from a range of lines of the file
+        struct Chunk {
+            std::vector<InputVector3f> vertices;
+            std::vector<InputNormal3f> normals;
+            std::vector<InputVector2f> texcoords;
+            /// (position, texcoord, normal) keys of the triangle corners
+            std::vector<ScalarIndex3> corners;
+            ScalarBoundingBox3f bbox;
+            std::exception_ptr error;
+        };
 
-        size_t vertex_guess = file_size / 100;
-        const char *eof     = ptr + file_size;
-        char buf[1025];
-
-        vertices.reserve(vertex_guess);
-        normals.reserve(vertex_guess);
-        texcoords.reserve(vertex_guess);
-        triangles.reserve(vertex_guess * 2);
-        vertex_map.resize(vertex_guess);
-
-        ScalarIndex vertex_ctr = 0;
+        /* Split the file into chunks of at least 4 MiB on line boundaries,
+           which are parsed in parallel. Indices in OBJ files are global, so
+           the chunks can be concatenated afterwards. */
+        size_t chunk_count = std::max((size_t) 1,
+            std::min(file_size >> 22, (size_t) std::max(1u, pool_size()) * 4));
+        std::vector<const char *> chunk_start(chunk_count + 1, eof);
+        chunk_start[0] = data;
+        for (size_t i = 1; i < chunk_count; ++i) {
+            const char *p = std::max(data + file_size / chunk_count * i,
+                                     chunk_start[i - 1]);
+            p = (const char *) memchr(p, '\n', eof - p);
+            chunk_start[i] = p ? p + 1 : eof;
+        }
+        std::vector<Chunk> chunks(chunk_count);
 
         Timer timer;
 
-        while (ptr < eof) {
-            // Determine the offset of the next newline
-            const char *next = ptr;
-            advance<false>(&next, eof, "\n");
-
-            // Copy buf into a 0-terminated buffer
-            size_t size = next - ptr;
-            if (size >= sizeof(buf) - 1)
-                fail("file contains an excessively long line! (%i characters)", size);
-            memcpy(buf, ptr, size);
-            buf[size] = '\0';
-
-            // Skip whitespace
-            const char *cur = buf, *eol = buf + size;
-            advance<true>(&cur, eol, " \t\r");
-
-            bool parse_error = false;
-            if (cur[0] == 'v' && (cur[1] == ' ' || cur[1] == '\t')) {
-                // Vertex position
-                InputPoint3f p;
-                cur += 2;
-                for (size_t i = 0; i < 3; ++i) {
-                    const char *orig = cur;
-                    p[i] = string::strtof<InputFloat>(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                p = m_to_world.scalar().transform_affine(p);
-                if (unlikely(!all(dr::isfinite(p))))
-                    fail("mesh contains invalid vertex position data");
-                m_bbox.expand(p);
-                vertices.push_back(p);
-            } else if (cur[0] == 'v' && cur[1] == 'n' && (cur[2] == ' ' || cur[2] == '\t')) {
-                if (!m_face_normals) {
+        auto parse_chunk = [&](Chunk &chunk, const char *ptr, const char *end) {
+            size_t vertex_guess = (end - ptr) / 100;
+            chunk.vertices.reserve(vertex_guess);
+            chunk.normals.reserve(vertex_guess);
+            chunk.texcoords.reserve(vertex_guess);
+            chunk.corners.reserve(vertex_guess * 6);
+
+            while (ptr < end) {
+                // Determine the offset of the next newline
+                const char *eol = (const char *) memchr(ptr, '\n', end - ptr);
+                if (!eol)
+                    eol = end;
+
+                // Skip whitespace
+                const char *cur = ptr;
+                skip_whitespace(cur, eol, true);
+
+                bool parse_error = false;
+
+                // Parse a floating point value, staying within the line
+                auto parse_float = [&]() -> InputFloat {
+                    skip_whitespace(cur, eol, false);
+                    if (cur == eol || *cur == '\r') {
+                        parse_error = true;
+                        return 0.f;
+                    }
+                    return string::parse_float<InputFloat>(cur, eol, (char **) &cur);
+                };
+
+                if (eol - cur > 1 && cur[0] == 'v' && (cur[1] == ' ' || cur[1] == '\t')) {
+                    // Vertex position
+                    InputPoint3f p;
+                    cur += 2;
+                    for (size_t i = 0; i < 3; ++i)
+                        p[i] = parse_float();
+                    p = m_to_world.scalar().transform_affine(p);
+                    if (unlikely(!all(dr::isfinite(p))))
+                        fail("mesh contains invalid vertex position data");
+                    chunk.bbox.expand(p);
+                    chunk.vertices.push_back(p);
+                } else if (eol - cur > 2 && cur[0] == 'v' && cur[1] == 'n' &&
+                           (cur[2] == ' ' || cur[2] == '\t')) {
+                    if (!m_face_normals) {
+                        cur += 3;
+                        // Vertex normal
+                        InputNormal3f n;
+                        for (size_t i = 0; i < 3; ++i)
+                            n[i] = parse_float();
+                        n = dr::normalize(m_to_world.scalar().transform_affine(n));
+                        if (unlikely(!all(dr::isfinite(n))))
+                            fail("mesh contains invalid vertex normal data");
+                        chunk.normals.push_back(n);
+                    }
+                } else if (eol - cur > 2 && cur[0] == 'v' && cur[1] == 't' &&
+                           (cur[2] == ' ' || cur[2] == '\t')) {
+                    // Texture coordinate
+                    InputVector2f uv;
                     cur += 3;
-                    // Vertex normal
-                    InputNormal3f n;
-                    for (size_t i = 0; i < 3; ++i) {
-                        const char *orig = cur;
-                        n[i] = string::strtof<InputFloat>(cur, (char **) &cur);
-                        parse_error |= cur == orig;
+                    for (size_t i = 0; i < 2; ++i)
+                        uv[i] = parse_float();
+                    if (flip_tex_coords)
+                        uv.y() = 1.f - uv.y();
+
+                    chunk.texcoords.push_back(uv);
+                } else if (eol - cur > 1 && cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
+                    // Face specification (polygons are triangulated as a fan)
+                    cur += 2;
+                    size_t vertex_index = 0;
+                    size_t type_index = 0;
+                    ScalarIndex3 key {{ (ScalarIndex) 0, (ScalarIndex) 0, (ScalarIndex) 0 }};
+                    ScalarIndex3 first, prev;
+
+                    while (true) {
+                        skip_whitespace(cur, eol, false);
+                        if (cur == eol || *cur < '0' || *cur > '9')
+                            break;
+
+                        uint64_t value = 0;
+                        while (cur != eol && *cur >= '0' && *cur <= '9')
+                            value = value * 10 + (uint64_t) (*cur++ - '0');
+                        if (value > 0xFFFFFFFFull)
+                            parse_error = true;
+
+                        if (type_index < 3) {
+                            key[type_index] = (ScalarIndex) value;
+                        } else {
+                            parse_error = true;
+                            break;
+                        }
+
+                        while (cur != eol && *cur == '/') {
+                            type_index++;
+                            cur++;
+                        }
+
+                        if (cur == eol || *cur == ' ' || *cur == '\t' || *cur == '\r') {
+                            if (vertex_index == 0) {
+                                first = key;
+                            } else if (vertex_index >= 2) {
+                                chunk.corners.push_back(first);
+                                chunk.corners.push_back(prev);
+                                chunk.corners.push_back(key);
+                            }
+                            prev = key;
+                            vertex_index++;
+                            type_index = 0;
+                            key = ScalarIndex3{{ (ScalarIndex) 0, (ScalarIndex) 0,
+                                                 (ScalarIndex) 0 }};
+                        }
                     }
-                    n = dr::normalize(m_to_world.scalar().transform_affine(n));
-                    if (unlikely(!all(dr::isfinite(n))))
-                        fail("mesh contains invalid vertex normal data");
-                    normals.push_back(n);
                 }
-            } else if (cur[0] == 'v' && cur[1] == 't' && (cur[2] == ' ' || cur[2] == '\t')) {
-                // Texture coordinate
-                InputVector2f uv;
-                cur += 3;
-                for (size_t i = 0; i < 2; ++i) {
-                    const char *orig = cur;
-                    uv[i] = string::strtof<InputFloat>(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                if (flip_tex_coords)
-                    uv.y() = 1.f - uv.y();
-
-                texcoords.push_back(uv);
-            } else if (cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
-                // Face specification
-                cur += 2;
-                size_t vertex_index = 0;
-                size_t type_index = 0;
-                ScalarIndex3 key {{ (ScalarIndex) 0, (ScalarIndex) 0, (ScalarIndex) 0 }};
-                ScalarIndex3 tri;
-
-                while (true) {
-                    const char *next2;
-                    ScalarIndex value = (ScalarIndex) strtoul(cur, (char **) &next2, 10);
-                    if (cur == next2)
-                        break;
-
-                    if (type_index < 3) {
-                        key[type_index] = value;
-                    } else {
-                        parse_error = true;
-                        break;
-                    }
 
-                    while (*next2 == '/') {
-                        type_index++;
-                        next2++;
+                if (unlikely(parse_error))
+                    fail("could not parse line \"%s\"", std::string(ptr, eol));
+                ptr = eol + 1;
+            }
+        };
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, chunk_count, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    try {
+                        parse_chunk(chunks[i], chunk_start[i], chunk_start[i + 1]);
+                    } catch (...) {
+                        chunks[i].error = std::current_exception();
                     }
+                }
+            }
+        );
 
-                    if (*next2 == ' ' || *next2 == '\t' || *next2 == '\0' || *next2 == '\r') {
-                        type_index = 0;
-                        size_t map_index = key[0] - 1;
+        for (Chunk &chunk : chunks) {
+            if (chunk.error)
+                std::rethrow_exception(chunk.error);
+        }
 
-                        if (unlikely(map_index >= vertices.size()))
-                            fail("reference to invalid vertex %i!", key[0]);
-                        if (unlikely(vertex_map.size() < vertices.size()))
-                            vertex_map.resize(vertices.size());
+        // Concatenate the per-chunk buffers
+        auto concatenate = [&](auto member) {
+            using Vector = std::decay_t<decltype(chunks[0].*member)>;
+            std::vector<size_t> offset(chunk_count + 1, 0);
+            for (size_t i = 0; i < chunk_count; ++i)
+                offset[i + 1] = offset[i] + (chunks[i].*member).size();
+
+            Vector result(offset[chunk_count]);
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, chunk_count, 1),
+                [&](const dr::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        Vector &v = chunks[i].*member;
+                        std::copy(v.begin(), v.end(), result.begin() + offset[i]);
+                        Vector().swap(v);
+                    }
+                }
+            );
+            return result;
+        };
 
-                        // Hash table lookup
-                        VertexBinding *entry = &vertex_map[map_index];
-                        while (entry->key != key && entry->next != nullptr)
-                            entry = entry->next;
+        std::vector<InputVector3f> vertices  = concatenate(&Chunk::vertices);
+        std::vector<InputNormal3f> normals   = concatenate(&Chunk::normals);
+        std::vector<InputVector2f> texcoords = concatenate(&Chunk::texcoords);
+        std::vector<ScalarIndex3> corners    = concatenate(&Chunk::corners);
+        for (const Chunk &chunk : chunks)
+            m_bbox.expand(chunk.bbox);
+        chunks.clear();
+
+        size_t corner_count = corners.size();
+        // Corner and slot indices are stored using 32 bit integers
+        if (corner_count >= 0x80000000ull)
+            fail("mesh contains too many triangles");
+
+        /* Deduplicate vertices using a concurrent open-addressing hash table
+           that maps keys to the index of their first corner (plus one, zero
+           denotes an empty slot). The table does not need to store keys, as
+           they can be looked up in 'corners'. */
+        size_t capacity = math::round_to_power_of_two(
+            std::max(corner_count + corner_count / 2, (size_t) 16));
+        std::unique_ptr<std::atomic<uint32_t>[]> table(
+            new std::atomic<uint32_t>[capacity]);
+        std::unique_ptr<uint32_t[]> slots(new uint32_t[corner_count]);
+        std::unique_ptr<ScalarIndex[]> ids(new ScalarIndex[corner_count]);
+
+        const size_t block_size = 1 << 16;
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, capacity, block_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    table[i].store(0, std::memory_order_relaxed);
+            }
+        );
 
-                        ScalarIndex id;
-                        if (entry->key == key) {
-                            // Hit
-                            id = entry->value;
-                        } else {
-                            // Miss
-                            if (entry->key != ScalarIndex3{{0, 0, 0}}) {
-                                entry->next = new VertexBinding();
-                                entry = entry->next;
-                            }
-                            entry->key = key;
-                            id = entry->value = vertex_ctr++;
-                        }
+        auto hash = [](const ScalarIndex3 &key) {
+            uint64_t h = key[0] * 0x9E3779B97F4A7C15ull ^
+                         key[1] * 0xC2B2AE3D27D4EB4Full ^
+                         key[2] * 0x165667B19E3779F9ull;
+            return h ^ (h >> 32);
+        };
 
-                        if (vertex_index < 3) {
-                            tri[vertex_index] = id;
-                        } else {
-                            tri[1] = tri[2];
-                            tri[2] = id;
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, corner_count, block_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t c = range.begin(); c != range.end(); ++c) {
+                    const ScalarIndex3 &key = corners[c];
+                    uint32_t value = (uint32_t) c + 1;
+                    size_t slot = hash(key) & (capacity - 1);
+
+                    while (true) {
+                        uint32_t cur = table[slot].load(std::memory_order_acquire);
+                        if (cur == 0) {
+                            if (table[slot].compare_exchange_weak(cur, value))
+                                break;
+                            continue; // Lost the race, re-examine the slot
                         }
-                        vertex_index++;
-
-                        if (vertex_index >= 3)
-                            triangles.push_back(tri);
+                        if (corners[cur - 1] == key) {
+                            // Keep the first corner, as in a sequential parse
+                            while (value < cur &&
+                                   !table[slot].compare_exchange_weak(cur, value)) { }
+                            break;
+                        }
+                        slot = (slot + 1) & (capacity - 1);
                     }
-
-                    cur = next2;
+                    slots[c] = (uint32_t) slot;
                 }
             }
+        );
 
-            if (unlikely(parse_error))
-                fail("could not parse line \"%s\"", buf);
-            ptr = next + 1;
-        }
+        /* Number the vertices in the order of their first occurrence, which
+           matches the output of a sequential parse */
+        size_t block_count = (corner_count + block_size - 1) / block_size;
+        std::vector<ScalarIndex> block_offset(block_count + 1, 0);
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, block_count, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t b = range.begin(); b != range.end(); ++b) {
+                    ScalarIndex count = 0;
+                    size_t end = std::min(corner_count, (b + 1) * block_size);
+                    for (size_t c = b * block_size; c < end; ++c)
+                        count += table[slots[c]].load(std::memory_order_relaxed) == c + 1;
+                    block_offset[b + 1] = count;
+                }
+            }
+        );
+        for (size_t b = 0; b < block_count; ++b)
+            block_offset[b + 1] += block_offset[b];
 
-        m_vertex_count = vertex_ctr;
-        m_face_count = (ScalarSize) triangles.size();
+        m_vertex_count = block_offset[block_count];
+        m_face_count = (ScalarSize) (corner_count / 3);
 
         std::unique_ptr<float[]> vertex_positions(new float[m_vertex_count * 3]);
         std::unique_ptr<float[]> vertex_normals(new float[m_vertex_count * 3]);
         std::unique_ptr<float[]> vertex_texcoords(new float[m_vertex_count * 2]);
 
-        for (const auto& v_ : vertex_map) {
-            const VertexBinding *v = &v_;
-
-            while (v && v->key != ScalarIndex3{{0, 0, 0}}) {
-                InputFloat* position_ptr = vertex_positions.get() + v->value * 3;
-                InputFloat* normal_ptr   = vertex_normals.get() + v->value * 3;
-                InputFloat* texcoord_ptr = vertex_texcoords.get() + v->value * 2;
-                auto key = v->key;
-
-                dr::store(position_ptr, vertices[key[0] - 1]);
+        // Index of the first corner with an invalid reference (if any)
+        std::atomic<size_t> invalid_corner(corner_count);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, block_count, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t b = range.begin(); b != range.end(); ++b) {
+                    ScalarIndex id = block_offset[b];
+                    size_t end = std::min(corner_count, (b + 1) * block_size);
+                    for (size_t c = b * block_size; c < end; ++c) {
+                        if (table[slots[c]].load(std::memory_order_relaxed) != c + 1)
+                            continue;
+                        ids[c] = id;
+
+                        const ScalarIndex3 &key = corners[c];
+                        bool valid = key[0] - 1 < vertices.size() &&
+                                     (!key[1] || key[1] - 1 < texcoords.size()) &&
+                                     (m_face_normals || !key[2] ||
+                                      key[2] - 1 < normals.size());
+                        if (unlikely(!valid)) {
+                            size_t prev = invalid_corner.load();
+                            while (c < prev && !invalid_corner.compare_exchange_weak(prev, c)) { }
+                            continue;
+                        }
 
-                if (key[1]) {
-                    size_t map_index = key[1] - 1;
-                    if (unlikely(map_index >= texcoords.size()))
-                        fail("reference to invalid texture coordinate %i!", key[1]);
-                    dr::store(texcoord_ptr, texcoords[map_index]);
+                        dr::store(vertex_positions.get() + id * 3, vertices[key[0] - 1]);
+                        if (key[1])
+                            dr::store(vertex_texcoords.get() + id * 2, texcoords[key[1] - 1]);
+                        if (!m_face_normals && key[2])
+                            dr::store(vertex_normals.get() + id * 3, normals[key[2] - 1]);
+                        id++;
+                    }
                 }
+            }
+        );
 
-                if (!m_face_normals && key[2]) {
-                    size_t map_index = key[2] - 1;
-                    if (unlikely(map_index >= normals.size()))
-                        fail("reference to invalid normal %i!", key[2]);
-                    dr::store(normal_ptr, normals[key[2] - 1]);
-                }
+        if (invalid_corner != corner_count) {
+            const ScalarIndex3 &key = corners[invalid_corner];
+            if (key[0] - 1 >= vertices.size())
+                fail("reference to invalid vertex %i!", key[0]);
+            else if (key[1] && key[1] - 1 >= texcoords.size())
+                fail("reference to invalid texture coordinate %i!", key[1]);
+            else
+                fail("reference to invalid normal %i!", key[2]);
+        }
 
-                v = v->next;
+        // Resolve the vertex indices of the remaining corners
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, corner_count, block_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t c = range.begin(); c != range.end(); ++c) {
+                    uint32_t first = table[slots[c]].load(std::memory_order_relaxed);
+                    if (first != c + 1)
+                        ids[c] = ids[first - 1];
+                }
             }
-        }
+        );
+
+        table.reset();
+        slots.reset();
 
-        m_faces = dr::load<DynamicBuffer<UInt32>>(triangles.data(), m_face_count * 3);
+        m_faces = dr::load<DynamicBuffer<UInt32>>(ids.get(), m_face_count * 3);
         m_vertex_positions = dr::load<FloatStorage>(vertex_positions.get(), m_vertex_count * 3);
         if (!m_face_normals)
             m_vertex_normals   = dr::load<FloatStorage>(vertex_normals.get(), m_vertex_count * 3);
@@ -1,12 +1,14 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/profiler.h>
 #include <drjit/half.h>
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 #include <fstream>
@@ -21,7 +23,7 @@ PLY (Stanford Triangle Format) mesh loader (:monosp:`ply`)
 ----------------------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 4
+ :extra-rows: 8
 
  * - filename
    - |string|
@@ -38,6 +40,33 @@ PLY (Stanford Triangle Format) mesh loader (:monosp:`ply`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - quantize
+   - |bool|
+   - Store vertex normals (octahedral encoding, 2x16 bit) and texture coordinates
+     (half precision) in quantized form to reduce memory usage. Quantized normals
+     and texture coordinates are not exposed as scene parameters. (Default: |false|)
+
+ * - tangents
+   - |bool|
+   - Precompute per-vertex tangent frames from the texture coordinates (similar to
+     MikkTSpace), which makes the shading frame and hence normal and bump mapping
+     continuous across faces. (Default: |false|)
+
+ * - alias_sampling
+   - |bool|
+   - Sample triangles for emission using an alias table, which has constant instead
+     of logarithmic lookup cost in the number of faces but does not preserve the
+     stratification of the input sample. (Default: |false|)
+
+ * - direction_sampling
+   - |string|
+   - Strategy used to sample directions towards the mesh when it is an emitter:
+     :monosp:`area` samples positions uniformly, :monosp:`solid_angle` uniformly
+     samples the spherical triangle subtended by the chosen face, and
+     :monosp:`projected_solid_angle` additionally accounts for the cosine at the
+     shading point. The latter two strongly reduce noise due to large or nearby
+     emissive faces. (Default: :monosp:`area`)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
@@ -196,6 +225,27 @@ public:
             fail(e.what());
         }
 
+        /* Element records are decoded straight from memory: binary files are
+           memory-mapped, ASCII files were already expanded into a buffer */
+        ref<MemoryMappedFile> mapped_file;
+        const uint8_t *data;
+        size_t data_offset, data_size;
+        if (header.ascii) {
+            data        = ((MemoryStream *) stream.get())->raw_buffer();
+            data_offset = 0;
+            data_size   = stream->size();
+        } else {
+            data_offset = stream->tell();
+            stream->close();
+            try {
+                mapped_file = new MemoryMappedFile(file_path);
+            } catch (const std::exception &e) {
+                fail(e.what());
+            }
+            data      = (const uint8_t *) mapped_file->data();
+            data_size = mapped_file->size();
+        }
+
         bool has_vertex_normals = false;
         bool has_vertex_texcoords = false;
 
@@ -258,83 +308,79 @@ public:
                 for (auto& descr: vertex_attributes_descriptors)
                     descr.buf.resize(m_vertex_count * descr.dim);
 
-                std::unique_ptr<float[]> vertex_positions(new float[m_vertex_count * 3]);
-                std::unique_ptr<float[]> vertex_normals(new float[m_vertex_count * 3]);
-                std::unique_ptr<float[]> vertex_texcoords(new float[m_vertex_count * 2]);
-
-                InputFloat* position_ptr = vertex_positions.get();
-                InputFloat *normal_ptr   = vertex_normals.get();
-                InputFloat *texcoord_ptr = vertex_texcoords.get();
-
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
-                std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_packet_size]);
-
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    uint8_t *target = (uint8_t *) buf_o.get();
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), buf_o.get())))
-                        fail("incompatible contents -- is this a triangle mesh?");
-
-                    for (size_t j = 0; j < count; ++j) {
+                FloatStorage unused;
+                DecodeBuffer<FloatStorage> positions(m_vertex_positions, m_vertex_count * 3),
+                    normals(m_face_normals ? unused : m_vertex_normals,
+                            m_face_normals ? 0 : m_vertex_count * 3),
+                    texcoords(has_vertex_texcoords ? m_vertex_texcoords : unused,
+                              has_vertex_texcoords ? m_vertex_count * 2 : 0);
+                InputFloat *position_ptr = positions.ptr,
+                           *normal_ptr   = normals.ptr,
+                           *texcoord_ptr = texcoords.ptr;
+
+                size_t texcoord_offset =
+                    sizeof(InputFloat) * (m_face_normals ? 3 : 6);
+                size_t attribute_offset =
+                    sizeof(InputFloat) *
+                    (!m_face_normals
+                         ? (has_vertex_texcoords ? 8 : 6)
+                         : (has_vertex_texcoords ? 5 : 3));
+
+                std::vector<ScalarBoundingBox3f> packet_bbox(
+                    (el.count + elements_per_packet - 1) / elements_per_packet);
+                std::atomic<bool> invalid_position(false);
+
+                bool success = decode_elements(
+                    conv, data, data_offset, data_size, el.count,
+                    i_struct_size, o_struct_size, elements_per_packet,
+                    [&](size_t packet, size_t index, const uint8_t *target) {
                         InputPoint3f p = dr::load<InputPoint3f>(target);
                         p = m_to_world.scalar().transform_affine(p);
                         if (unlikely(!all(dr::isfinite(p))))
-                            fail("mesh contains invalid vertex position data");
-                        m_bbox.expand(p);
-                        dr::store(position_ptr, p);
-                        position_ptr += 3;
+                            invalid_position = true;
+                        packet_bbox[packet].expand(p);
+                        dr::store(position_ptr + index * 3, p);
 
                         if (has_vertex_normals) {
                             InputNormal3f n = dr::load<InputNormal3f>(
                                 target + sizeof(InputFloat) * 3);
                             n = dr::normalize(m_to_world.scalar().transform_affine(n));
-                            dr::store(normal_ptr, n);
-                            normal_ptr += 3;
+                            dr::store(normal_ptr + index * 3, n);
+                        } else if (!m_face_normals) {
+                            dr::store(normal_ptr + index * 3, InputNormal3f(0.f));
                         }
 
                         if (has_vertex_texcoords) {
                             InputVector2f uv = dr::load<InputVector2f>(
-                                target + (m_face_normals
-                                              ? sizeof(InputFloat) * 3
-                                              : sizeof(InputFloat) * 6));
-                            dr::store(texcoord_ptr, uv);
-                            texcoord_ptr += 2;
+                                target + texcoord_offset);
+                            dr::store(texcoord_ptr + index * 2, uv);
                         }
 
-                        size_t target_offset =
-                            sizeof(InputFloat) *
-                            (!m_face_normals
-                                 ? (has_vertex_texcoords ? 8 : 6)
-                                 : (has_vertex_texcoords ? 5 : 3));
-
-                        for (size_t k = 0; k < vertex_attributes_descriptors.size(); ++k) {
-                            auto& descr = vertex_attributes_descriptors[k];
-                            memcpy(descr.buf.data() + (i * elements_per_packet + j) * descr.dim,
+                        size_t target_offset = attribute_offset;
+                        for (auto &descr : vertex_attributes_descriptors) {
+                            memcpy(descr.buf.data() + index * descr.dim,
                                    target + target_offset,
                                    descr.dim * sizeof(InputFloat));
                             target_offset += descr.dim * sizeof(InputFloat);
                         }
+                    });
 
-                        target += o_struct_size;
-                    }
-                }
+                if (unlikely(!success))
+                    fail("incompatible contents -- is this a triangle mesh?");
+                if (unlikely(invalid_position))
+                    fail("mesh contains invalid vertex position data");
+
+                for (const ScalarBoundingBox3f &bbox : packet_bbox)
+                    m_bbox.expand(bbox);
 
                 for (auto& descr: vertex_attributes_descriptors)
                     add_attribute(descr.name, descr.dim, descr.buf);
 
-                m_vertex_positions = dr::load<FloatStorage>(vertex_positions.get(), m_vertex_count * 3);
+                positions.finalize();
                 if (!m_face_normals)
-                    m_vertex_normals = dr::load<FloatStorage>(vertex_normals.get(), m_vertex_count * 3);
+                    normals.finalize();
                 if (has_vertex_texcoords)
-                    m_vertex_texcoords = dr::load<FloatStorage>(vertex_texcoords.get(), m_vertex_count * 2);
+                    texcoords.finalize();
 
             } else if (el.name == "face") {
                 std::string field_name;
@@ -373,56 +419,39 @@ public:
                 for (auto& descr: face_attributes_descriptors)
                     descr.buf.resize(m_face_count * descr.dim);
 
-                std::unique_ptr<uint32_t[]> faces(new uint32_t[m_face_count * 3]);
-                ScalarIndex* face_ptr = faces.get();
-
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
-                std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_packet_size]);
+                DecodeBuffer<DynamicBuffer<UInt32>> faces(m_faces, m_face_count * 3);
+                ScalarIndex *face_ptr = faces.ptr;
 
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    uint8_t *target = (uint8_t *) buf_o.get();
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
-
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), buf_o.get())))
-                        fail("incompatible contents -- is this a triangle mesh?");
-
-                    for (size_t j = 0; j < count; ++j) {
+                bool success = decode_elements(
+                    conv, data, data_offset, data_size, el.count,
+                    i_struct_size, o_struct_size, elements_per_packet,
+                    [&](size_t /* packet */, size_t index, const uint8_t *target) {
                         ScalarIndex3 fi = dr::load<ScalarIndex3>(target);
-                        dr::store(face_ptr, fi);
-                        face_ptr += 3;
+                        dr::store(face_ptr + index * 3, fi);
 
                         size_t target_offset = sizeof(InputFloat) * 3;
-                        for (size_t k = 0; k < face_attributes_descriptors.size(); ++k) {
-                            auto& descr = face_attributes_descriptors[k];
-                            memcpy(descr.buf.data() + (i * elements_per_packet + j) * descr.dim,
+                        for (auto &descr : face_attributes_descriptors) {
+                            memcpy(descr.buf.data() + index * descr.dim,
                                    target + target_offset,
                                    descr.dim * sizeof(InputFloat));
                             target_offset += descr.dim * sizeof(InputFloat);
                         }
+                    });
 
-                        target += o_struct_size;
-                    }
-                }
+                if (unlikely(!success))
+                    fail("incompatible contents -- is this a triangle mesh?");
 
                 for (auto& descr: face_attributes_descriptors)
                     add_attribute(descr.name, descr.dim, descr.buf);
 
-                m_faces = dr::load<DynamicBuffer<UInt32>>(faces.get(), m_face_count * 3);
+                faces.finalize();
             } else {
                 Log(Warn, "\"%s\": skipping unknown element \"%s\"", m_name, el.name);
-                stream->seek(stream->tell() + el.struct_->size() * el.count);
+                data_offset += el.struct_->size() * el.count;
             }
         }
 
-        if (stream->tell() != stream->size())
+        if (data_offset != data_size)
             fail("invalid file -- trailing content");
 
         Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
@@ -443,6 +472,84 @@ public:
     }
 
 private:
+    /**
+     * \brief Convert \c count records in parallel, starting at
+     * <tt>data + offset</tt>, and invoke <tt>fn(packet, index, record)</tt> on
+     * every converted record. Advances \c offset past the element.
+     *
+     * Returns \c false if the data could not be converted.
+     */
+    template <typename Func>
+    bool decode_elements(const StructConverter *conv, const uint8_t *data,
+                         size_t &offset, size_t size, size_t count,
+                         size_t i_struct_size, size_t o_struct_size,
+                         size_t elements_per_packet, Func &&fn) {
+        if (offset + i_struct_size * count > size)
+            Throw("Error while loading PLY file \"%s\": file is truncated!", m_name);
+
+        const uint8_t *base = data + offset;
+        size_t packet_count = (count + elements_per_packet - 1) / elements_per_packet;
+        std::atomic<bool> success(true);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, packet_count, 16),
+            [&](const dr::blocked_range<size_t> &range) {
+                std::unique_ptr<uint8_t[]> buf_o(
+                    new uint8_t[o_struct_size * elements_per_packet]);
+
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    size_t start = i * elements_per_packet,
+                           n = std::min(elements_per_packet, count - start);
+
+                    if (unlikely(!conv->convert(n, base + start * i_struct_size,
+                                                buf_o.get()))) {
+                        success = false;
+                        return;
+                    }
+
+                    const uint8_t *target = buf_o.get();
+                    for (size_t j = 0; j < n; ++j) {
+                        fn(i, start + j, target);
+                        target += o_struct_size;
+                    }
+                }
+            }
+        );
+
+        offset += i_struct_size * count;
+        return success;
+    }
+
+    /**
+     * \brief Host memory that element records are decoded into. Scalar
+     * variants write directly into the final buffer, JIT variants go through
+     * a staging buffer that is uploaded by \ref finalize().
+     */
+    template <typename Storage> struct DecodeBuffer {
+        using Value = dr::scalar_t<Storage>;
+
+        DecodeBuffer(Storage &storage, size_t size)
+            : storage(storage), size(size) {
+            if constexpr (dr::is_jit_v<Storage>) {
+                staging.reset(new Value[size]);
+                ptr = staging.get();
+            } else {
+                storage = dr::empty<Storage>(size);
+                ptr = storage.data();
+            }
+        }
+
+        void finalize() {
+            if constexpr (dr::is_jit_v<Storage>)
+                storage = dr::load<Storage>(ptr, size);
+        }
+
+        Storage &storage;
+        size_t size;
+        std::unique_ptr<Value[]> staging;
+        Value *ptr;
+    };
+
     PLYHeader parse_ply_header(Stream *stream) {
         Struct::ByteOrder byte_order = Struct::host_byte_order();
         bool ply_tag_seen = false;
@@ -49,6 +49,15 @@ and has a surface normal that points into the positive Z-direction.
 To change the rectangle scale, rotation, or translation, use the
 :monosp:`to_world` parameter.
 
+When the rectangle is used as an area light, direct illumination samples are
+drawn uniformly within the solid angle it subtends as seen from the shading
+point, following the spherical rectangle construction of Ureña et
+al. :cite:`Urena2013Area`. This substantially reduces noise near large
+emitters, such as studio softboxes close to the lit geometry. Sheared
+rectangles and configurations where the solid angle is too small or too close
+to a hemisphere for this construction to be numerically robust fall back to
+uniform area sampling.
+
 
 The following XML snippet showcases a simple example of a textured rectangle:
 
@@ -105,9 +114,15 @@ public:
         Vector3f dp_dv = m_to_world.value() * Vector3f(0.f, 2.f, 0.f);
         Normal3f normal = dr::normalize(m_to_world.value() * Normal3f(0.f, 0.f, 1.f));
         m_frame = Frame3f(dp_du, dp_dv, normal);
+        m_corner = m_to_world.value().transform_affine(Point3f(-1.f, -1.f, 0.f));
         m_inv_surface_area = dr::rcp(surface_area());
 
-        dr::make_opaque(m_frame, m_inv_surface_area);
+        // Spherical rectangle sampling requires orthogonal edges
+        ScalarVector3f s = m_to_world.scalar() * ScalarVector3f(1.f, 0.f, 0.f),
+                       t = m_to_world.scalar() * ScalarVector3f(0.f, 1.f, 0.f);
+        m_rectangular = dr::abs(dr::dot(s, t)) <= 1e-5f * dr::norm(s) * dr::norm(t);
+
+        dr::make_opaque(m_frame, m_corner, m_inv_surface_area);
         mark_dirty();
     }
 
@@ -170,6 +185,77 @@ public:
         return m_inv_surface_area;
     }
 
+    DirectionSample3f sample_direction(const Interaction3f &it, const Point2f &sample,
+                                       Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        if (!m_rectangular)
+            return Base::sample_direction(it, sample, active);
+
+        SphericalRectangle sr = spherical_rectangle(it.p);
+        Mask solid_angle_sampling = use_solid_angle_sampling(sr.solid_angle);
+        Point2f uv = sample;
+
+        if (likely(dr::any_or<true>(solid_angle_sampling))) {
+            // Sample the 'x' coordinate by inverting the solid angle of a sub-rectangle
+            Float au = dr::fmadd(sample.x(), sr.solid_angle, -sr.k);
+            auto [sin_au, cos_au] = dr::sincos(au);
+            Float fu = (cos_au * sr.b0 - sr.b1) / sin_au,
+                  cu = dr::copysign(dr::rsqrt(dr::fmadd(fu, fu, dr::sqr(sr.b0))), fu);
+            cu = dr::clamp(cu, -dr::OneMinusEpsilon<Float>, dr::OneMinusEpsilon<Float>);
+
+            Float xu = -(cu * sr.z0) * dr::rsqrt(dr::fnmadd(cu, cu, 1.f));
+            xu = dr::clamp(xu, sr.x0, sr.x1);
+
+            // Sample the 'y' coordinate along the corresponding spherical arc
+            Float dd = dr::sqrt(dr::fmadd(xu, xu, dr::sqr(sr.z0))),
+                  h0 = sr.y0 * dr::rsqrt(dr::fmadd(dd, dd, dr::sqr(sr.y0))),
+                  h1 = sr.y1 * dr::rsqrt(dr::fmadd(dd, dd, dr::sqr(sr.y1))),
+                  hv = dr::fmadd(sample.y(), h1 - h0, h0),
+                  hv2 = dr::sqr(hv);
+            Float yv = dr::select(hv2 < 1.f - 1e-6f,
+                                  hv * dd * dr::rsqrt(1.f - hv2), sr.y1);
+
+            dr::masked(uv, solid_angle_sampling) =
+                Point2f((xu - sr.x0) / (sr.x1 - sr.x0),
+                        (yv - sr.y0) / (sr.y1 - sr.y0));
+        }
+
+        DirectionSample3f ds = dr::zeros<DirectionSample3f>();
+        ds.p     = m_corner + m_frame.s * uv.x() + m_frame.t * uv.y();
+        ds.n     = m_frame.n;
+        ds.uv    = uv;
+        ds.time  = it.time;
+        ds.delta = false;
+        ds.d     = ds.p - it.p;
+
+        Float dist_squared = dr::squared_norm(ds.d);
+        ds.dist = dr::sqrt(dist_squared);
+        ds.d /= ds.dist;
+
+        Float x = m_inv_surface_area * dist_squared / dr::abs_dot(ds.d, ds.n);
+        ds.pdf = dr::select(solid_angle_sampling, dr::rcp(sr.solid_angle),
+                            dr::select(dr::isfinite(x), x, 0.f));
+
+        return ds;
+    }
+
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
+                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        if (!m_rectangular)
+            return Base::pdf_direction(it, ds, active);
+
+        Float solid_angle = spherical_rectangle(it.p).solid_angle,
+              dp = dr::abs_dot(ds.d, ds.n),
+              pdf_area = dr::select(dr::neq(dp, 0.f),
+                                    m_inv_surface_area * dr::sqr(ds.dist) / dp, 0.f);
+
+        return dr::select(use_solid_angle_sampling(solid_angle),
+                          dr::rcp(solid_angle), pdf_area);
+    }
+
     SurfaceInteraction3f eval_parameterization(const Point2f &uv,
                                                uint32_t ray_flags,
                                                Mask active) const override {
@@ -351,8 +437,69 @@ public:
 
     MI_DECLARE_CLASS()
 private:
+    /// Spherical rectangle subtended by the shape as seen from a given point
+    struct SphericalRectangle {
+        /// Rectangle bounds in a local frame centered at the reference point
+        Float x0, y0, x1, y1, z0;
+        /// 'z' components of the edge plane normals and integration offset
+        Float b0, b1, k;
+        Float solid_angle;
+    };
+
+    /**
+     * \brief Compute the spherical rectangle subtended by the shape as seen
+     * from \c p (Ureña et al. 2013)
+     *
+     * The local frame is aligned with the rectangle edges and its 'z' axis is
+     * flipped as needed so that the rectangle lies at <tt>z = z0 <= 0</tt>.
+     */
+    SphericalRectangle spherical_rectangle(const Point3f &p) const {
+        Float ex_l = dr::norm(m_frame.s),
+              ey_l = dr::norm(m_frame.t);
+        Vector3f ex = m_frame.s / ex_l,
+                 ey = m_frame.t / ey_l,
+                 d  = m_corner - p;
+
+        SphericalRectangle sr;
+        sr.x0 = dr::dot(d, ex);
+        sr.y0 = dr::dot(d, ey);
+        sr.z0 = -dr::abs(dr::dot(d, m_frame.n));
+        sr.x1 = sr.x0 + ex_l;
+        sr.y1 = sr.y0 + ey_l;
+
+        Vector3f v00(sr.x0, sr.y0, sr.z0), v01(sr.x0, sr.y1, sr.z0),
+                 v10(sr.x1, sr.y0, sr.z0), v11(sr.x1, sr.y1, sr.z0);
+
+        Vector3f n0 = dr::normalize(dr::cross(v00, v10)),
+                 n1 = dr::normalize(dr::cross(v10, v11)),
+                 n2 = dr::normalize(dr::cross(v11, v01)),
+                 n3 = dr::normalize(dr::cross(v01, v00));
+
+        // Internal angles of the spherical quad
+        Float g0 = dr::unit_angle(-n0, n1),
+              g1 = dr::unit_angle(-n1, n2),
+              g2 = dr::unit_angle(-n2, n3),
+              g3 = dr::unit_angle(-n3, n0);
+
+        sr.b0 = n0.z();
+        sr.b1 = n2.z();
+        sr.k = g2 + g3;
+        sr.solid_angle = g0 + g1 + g2 + g3 - dr::TwoPi<Float>;
+        return sr;
+    }
+
+    /**
+     * Solid angle sampling loses precision when the subtended solid angle is
+     * tiny or close to a hemisphere, area sampling is used in these cases.
+     */
+    Mask use_solid_angle_sampling(const Float &solid_angle) const {
+        return solid_angle >= 3e-4f && solid_angle <= 6.22f;
+    }
+
     Frame3f m_frame;
+    Point3f m_corner;
     Float m_inv_surface_area;
+    bool m_rectangular;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(Rectangle, Shape)
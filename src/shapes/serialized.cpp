@@ -1,10 +1,16 @@
 #include <mitsuba/render/mesh.h>
-#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/zstream.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/xml.h>
+#include <nanothread/nanothread.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -16,7 +22,7 @@ Serialized mesh loader (:monosp:`serialized`)
 ---------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 5
+ :extra-rows: 9
 
  * - filename
    - |string|
@@ -27,6 +33,14 @@ Serialized mesh loader (:monosp:`serialized`)
    - A :monosp:`.serialized` file may contain several separate meshes. This parameter
      specifies which one should be loaded. (Default: 0, i.e. the first one)
 
+ * - load_all
+   - |bool|
+   - When set to |true|, all meshes of the file are loaded in parallel, and the
+     shape expands into one mesh per entry of the file. The meshes share the
+     BSDF, media, and transformation of the shape, and their identifiers are
+     suffixed by the shape index. Area emitters and sensors cannot be
+     attached to such a shape. (Default: |false|)
+
  * - face_normals
    - |bool|
    - When set to |true|, any existing or computed vertex normals are
@@ -38,6 +52,33 @@ Serialized mesh loader (:monosp:`serialized`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - quantize
+   - |bool|
+   - Store vertex normals (octahedral encoding, 2x16 bit) and texture coordinates
+     (half precision) in quantized form to reduce memory usage. Quantized normals
+     and texture coordinates are not exposed as scene parameters. (Default: |false|)
+
+ * - tangents
+   - |bool|
+   - Precompute per-vertex tangent frames from the texture coordinates (similar to
+     MikkTSpace), which makes the shading frame and hence normal and bump mapping
+     continuous across faces. (Default: |false|)
+
+ * - alias_sampling
+   - |bool|
+   - Sample triangles for emission using an alias table, which has constant instead
+     of logarithmic lookup cost in the number of faces but does not preserve the
+     stratification of the input sample. (Default: |false|)
+
+ * - direction_sampling
+   - |string|
+   - Strategy used to sample directions towards the mesh when it is an emitter:
+     :monosp:`area` samples positions uniformly, :monosp:`solid_angle` uniformly
+     samples the spherical triangle subtended by the chosen face, and
+     :monosp:`projected_solid_angle` additionally accounts for the cosine at the
+     shading point. The latter two strongly reduce noise due to large or nearby
+     emissive faces. (Default: :monosp:`area`)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
@@ -104,11 +145,13 @@ follows:
         * - :monosp:`uint16`
           - File format identifier: :code:`0x041C`
         * - :monosp:`uint16`
-          - File version identifier. Currently set to :code:`0x0004`
+          - File version identifier. Either :code:`0x0004` or :code:`0x0005`
         * - :math:`\rightarrow`
           - From this point on, the stream is compressed by the :monosp:`DEFLATE` algorithm.
         * - :math:`\rightarrow`
-          - The used encoding is that of the :monosp:`zlib` library.
+          - The used encoding is that of the :monosp:`zlib` library. In version
+            :code:`0x0005`, the data is instead split into independently compressed
+            blocks (see below).
         * - :monosp:`uint32`
           - An 32-bit integer whose bits can be used to specify the following flags:
 
@@ -142,6 +185,17 @@ follows:
             :monosp:`uint32` or in :monosp:`uint64` format (the latter is used when the number of
             vertices exceeds :code:`0xFFFFFFFF`).
 
+Block compression
+*****************
+
+Version :code:`0x0005` of the format stores the compressed part of every
+mesh as a sequence of independently compressed blocks, which the plugin
+decompresses in parallel. Each block is preceded by its uncompressed and
+compressed size (:monosp:`uint32`) and encoded by the :monosp:`zlib` library,
+and a block whose sizes are both zero marks the end of the data of the mesh.
+Such files can be written using :code:`mi.BlockZStream`; the content is
+otherwise identical to version :code:`0x0004`.
+
 Multiple shapes
 ***************
 
@@ -152,6 +206,12 @@ Hence, after each mesh, the stream briefly reverts back to an
 uncompressed format, followed by an uncompressed header, and so on.
 This is necessary for efficient read access to arbitrary sub-meshes.
 
+Scenes often reference many meshes of the same file. The plugin therefore
+maps each file into memory and parses its end-of-file dictionary only once,
+and all shapes referencing the file share this mapping while they are being
+loaded. Alternatively, the :monosp:`load_all` parameter loads every mesh of
+the file in parallel using a single shape declaration.
+
 End-of-file dictionary
 **********************
 In addition to the previous table, a :monosp:`.serialized` file also concludes with a brief summary
@@ -198,6 +258,108 @@ at the end of the file, which specifies the starting position of each sub-mesh:
 #define MI_FILEFORMAT_HEADER     0x041C
 #define MI_FILEFORMAT_VERSION_V3 0x0003
 #define MI_FILEFORMAT_VERSION_V4 0x0004
+#define MI_FILEFORMAT_VERSION_V5 0x0005
+
+NAMESPACE_BEGIN(detail)
+/// Memory-mapped serialized file along with its parsed end-of-file dictionary
+struct SerializedFile {
+    ref<MemoryMappedFile> mmap;
+    std::string name;
+    short version = 0;
+    /// Start of every mesh (pointing past its header)
+    std::vector<uint64_t> offsets;
+
+    SerializedFile(const fs::path &path)
+        : mmap(new MemoryMappedFile(path)), name(path.filename().string()) {
+        size_t size = mmap->size();
+        if (size < 2 * sizeof(short) + sizeof(uint32_t))
+            Throw("file is truncated");
+
+        ref<MemoryStream> stream = new MemoryStream(mmap->data(), size);
+        stream->set_byte_order(Stream::ELittleEndian);
+
+        short format = 0;
+        stream->read(format);
+        stream->read(version);
+
+        if (format != MI_FILEFORMAT_HEADER)
+            Throw("encountered an invalid file format");
+
+        if (version != MI_FILEFORMAT_VERSION_V3 &&
+            version != MI_FILEFORMAT_VERSION_V4 &&
+            version != MI_FILEFORMAT_VERSION_V5)
+            Throw("encountered an incompatible file version");
+
+        // The position of every substream is stored at the end of the file
+        stream->seek(size - sizeof(uint32_t));
+        uint32_t count = 0;
+        stream->read(count);
+
+        size_t entry_size = version >= MI_FILEFORMAT_VERSION_V4
+                                ? sizeof(uint64_t) : sizeof(uint32_t);
+        if (count == 0 || (size_t) count * entry_size + sizeof(uint32_t) > size) {
+            // No dictionary: the file contains a single mesh
+            offsets.push_back(sizeof(short) * 2);
+            return;
+        }
+
+        offsets.resize(count);
+        stream->seek(size - sizeof(uint32_t) - (size_t) count * entry_size);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint64_t offset = 0;
+            if (version >= MI_FILEFORMAT_VERSION_V4) {
+                stream->read(offset);
+            } else {
+                uint32_t offset_32 = 0;
+                stream->read(offset_32);
+                offset = offset_32;
+            }
+            offset += sizeof(short) * 2; // Skip the header
+            if (offset >= size)
+                Throw("encountered an invalid end-of-file dictionary");
+            offsets[i] = offset;
+        }
+    }
+
+    /// Return a stream that decompresses the given mesh
+    ref<Stream> open(uint32_t index) const {
+        ref<Stream> stream = new MemoryStream(
+            (uint8_t *) mmap->data() + offsets[index], mmap->size() - offsets[index]);
+        stream->set_byte_order(Stream::ELittleEndian);
+        if (version == MI_FILEFORMAT_VERSION_V5)
+            stream = new BlockZStream(stream);
+        else
+            stream = new ZStream(stream);
+        stream->set_byte_order(Stream::ELittleEndian);
+        return stream;
+    }
+};
+
+static std::mutex serialized_cache_mutex;
+static std::unordered_map<std::string, std::weak_ptr<SerializedFile>> serialized_cache;
+/// The most recently used file is kept open for the next shape referencing it
+static std::shared_ptr<SerializedFile> serialized_cache_last;
+
+/// Open a serialized file, or look it up if it is already mapped
+static std::shared_ptr<SerializedFile> serialized_open(const fs::path &path) {
+    std::string key = fs::absolute(path).string();
+    std::lock_guard<std::mutex> guard(serialized_cache_mutex);
+
+    std::shared_ptr<SerializedFile> file;
+    auto it = serialized_cache.find(key);
+    if (it != serialized_cache.end())
+        file = it->second.lock();
+
+    // Reopen files that were modified in the meantime
+    if (!file || file->mmap->size() != fs::file_size(path)) {
+        file = std::make_shared<SerializedFile>(path);
+        serialized_cache[key] = file;
+    }
+
+    serialized_cache_last = file;
+    return file;
+}
+NAMESPACE_END(detail)
 
 template <typename Float, typename Spectrum>
 class SerializedMesh final : public Mesh<Float, Spectrum> {
@@ -251,65 +413,95 @@ public:
         int shape_index = props.get<int>("shape_index", 0);
         if (shape_index < 0)
             fail("shape index must be nonnegative!");
+        bool load_all = props.get<bool>("load_all", false);
 
         m_name = tfm::format("%s@%i", file_path.filename(), shape_index);
 
-        ref<Stream> stream = new FileStream(file_path);
         ScopedPhase phase(ProfilerPhase::LoadGeometry);
-        Timer timer;
-        stream->set_byte_order(Stream::ELittleEndian);
+        std::shared_ptr<detail::SerializedFile> file;
+        try {
+            file = detail::serialized_open(file_path);
+        } catch (const std::exception &e) {
+            fail(e.what());
+        }
 
-        short format = 0, version = 0;
-        stream->read(format);
-        stream->read(version);
+        uint32_t count = (uint32_t) file->offsets.size();
+        if (shape_index >= (int) count)
+            fail(tfm::format("Unable to unserialize mesh, shape index is "
+                             "out of range! (requested %i out of 0..%i)",
+                             shape_index, count - 1));
 
-        if (format != MI_FILEFORMAT_HEADER)
-            fail("encountered an invalid file format!");
+        if (!load_all) {
+            load(*file, (uint32_t) shape_index);
+            return;
+        }
 
-        if (version != MI_FILEFORMAT_VERSION_V3 &&
-            version != MI_FILEFORMAT_VERSION_V4)
-            fail("encountered an incompatible file version!");
-
-        if (shape_index != 0) {
-            size_t file_size = stream->size();
-
-            /* Determine the position of the requested substream. This
-               is stored at the end of the file */
-            stream->seek(file_size - sizeof(uint32_t));
-
-            uint32_t count = 0;
-            stream->read(count);
-
-            if (shape_index > (int) count)
-                fail(tfm::format("Unable to unserialize mesh, shape index is "
-                                 "out of range! (requested %i out of 0..%i)",
-                                 shape_index, count - 1));
-
-            // Seek to the correct position
-            if (version == MI_FILEFORMAT_VERSION_V4) {
-                stream->seek(file_size -
-                             sizeof(uint64_t) * (count - shape_index) -
-                             sizeof(uint32_t));
-                size_t offset = 0;
-                stream->read(offset);
-                stream->seek(offset);
-            } else {
-                Assert(version == MI_FILEFORMAT_VERSION_V3);
-                stream->seek(file_size -
-                             sizeof(uint32_t) * (count - shape_index + 1));
-                uint32_t offset = 0;
-                stream->read(offset);
-                stream->seek(offset);
-            }
-            stream->skip(sizeof(short) * 2); // Skip the header
+        if (Base::is_emitter() || Base::is_sensor())
+            fail("area emitters and sensors cannot be attached to a shape "
+                 "with load_all=true");
+
+        std::string id = props.id();
+        Timer timer;
+        load(*file, 0);
+        set_id(id + "_0");
+
+        // Instantiate the remaining meshes in parallel
+        m_sub_meshes.resize(count - 1);
+        ThreadEnvironment env;
+        uint32_t backend = 0, scope = 0;
+#if defined(MI_ENABLE_LLVM) || defined(MI_ENABLE_CUDA)
+        if constexpr (dr::is_jit_v<Float>) {
+            backend = (uint32_t) dr::backend_v<Float>;
+            scope = jit_scope((JitBackend) backend);
         }
+#endif
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(1, count, 1),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                xml::ScopedSetJITScope set_scope(backend, scope);
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    ref<SerializedMesh> mesh = new SerializedMesh(props, *file, i);
+                    mesh->set_id(id + "_" + std::to_string(i));
+                    m_sub_meshes[i - 1] = mesh;
+                }
+            }
+        );
 
-        stream = new ZStream(stream);
-        stream->set_byte_order(Stream::ELittleEndian);
+        Log(Info, "\"%s\": loaded %u meshes (took %s)", file_path.filename(),
+            count, util::time_string((float) timer.value()));
+    }
+
+    std::vector<ref<Object>> expand() const override {
+        if (m_sub_meshes.empty())
+            return { };
+        std::vector<ref<Object>> result;
+        result.reserve(m_sub_meshes.size() + 1);
+        result.push_back((Object *) this);
+        for (auto &mesh : m_sub_meshes)
+            result.push_back((Object *) mesh.get());
+        return result;
+    }
+
+protected:
+    /// Construct one of the meshes of a file opened by a shape with load_all=true
+    SerializedMesh(const Properties &props, const detail::SerializedFile &file,
+                   uint32_t shape_index)
+        : Base(Properties(props)) {
+        load(file, shape_index);
+    }
+
+    /// Load the given mesh of a serialized file
+    void load(const detail::SerializedFile &file, uint32_t shape_index) {
+        Timer timer;
+        ref<Stream> stream = file.open(shape_index);
+        short version = file.version;
+        m_name = tfm::format("%s@%u", file.name, shape_index);
 
         uint32_t flags = 0;
         stream->read(flags);
-        if (version == MI_FILEFORMAT_VERSION_V4) {
+        if (version >= MI_FILEFORMAT_VERSION_V4) {
             char ch = 0;
             m_name = "";
             do {
@@ -355,23 +547,46 @@ public:
 
         stream->read(faces.get(), m_face_count * sizeof(ScalarIndex) * 3);
 
-        // Post-processing
-        InputFloat* position_ptr = vertex_positions.get();
-        InputFloat* normal_ptr   = vertex_normals.get();
-        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
-            InputPoint3f p = m_to_world.scalar().transform_affine(
-                dr::load<InputPoint3f>(position_ptr));
-            dr::store(position_ptr, p);
-            position_ptr += 3;
-            m_bbox.expand(p);
-
-            if (has_normals) {
-                InputNormal3f n = dr::load<InputNormal3f>(normal_ptr);
-                n = dr::normalize(m_to_world.scalar().transform_affine(n));
-                dr::store(normal_ptr, n);
-                normal_ptr += 3;
+        /* Post-processing: transform the vertices in parallel blocks. The
+           normal transformation (inverse transpose) is part of 'to_world' */
+        const auto &to_world = m_to_world.scalar();
+        InputFloat *position_ptr = vertex_positions.get(),
+                   *normal_ptr   = has_normals && !m_face_normals
+                                       ? vertex_normals.get() : nullptr;
+        const size_t block_size = 16384;
+        std::vector<ScalarBoundingBox3f> block_bbox(
+            (m_vertex_count + block_size - 1) / block_size);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, block_bbox.size(), 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t block = range.begin(); block != range.end(); ++block) {
+                    size_t start = block * block_size,
+                           end   = std::min(start + block_size, (size_t) m_vertex_count);
+                    ScalarBoundingBox3f bbox;
+
+                    for (size_t i = start; i < end; ++i) {
+                        InputPoint3f p = to_world.transform_affine(
+                            dr::load<InputPoint3f>(position_ptr + 3 * i));
+                        dr::store(position_ptr + 3 * i, p);
+                        bbox.expand(p);
+                    }
+
+                    if (normal_ptr) {
+                        for (size_t i = start; i < end; ++i) {
+                            InputNormal3f n = dr::normalize(to_world.transform_affine(
+                                dr::load<InputNormal3f>(normal_ptr + 3 * i)));
+                            dr::store(normal_ptr + 3 * i, n);
+                        }
+                    }
+
+                    block_bbox[block] = bbox;
+                }
             }
-        }
+        );
+
+        for (const ScalarBoundingBox3f &bbox : block_bbox)
+            m_bbox.expand(bbox);
 
         m_faces = dr::load<DynamicBuffer<UInt32>>(faces.get(), m_face_count * 3);
         m_vertex_positions = dr::load<FloatStorage>(vertex_positions.get(), m_vertex_count * 3);
@@ -432,6 +647,9 @@ public:
     }
 
     MI_DECLARE_CLASS()
+private:
+    /// Further meshes of the file (only when loading all of them)
+    std::vector<ref<SerializedMesh>> m_sub_meshes;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(SerializedMesh, Mesh)
@@ -0,0 +1,797 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/stream.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+#include <fstream>
+
+#if defined(MI_ENABLE_EMBREE)
+#include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-sphereset:
+
+Sphere set (:monosp:`sphereset`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the PLY point cloud to be loaded. Every vertex of the file
+     specifies one sphere using the :monosp:`x`, :monosp:`y`, :monosp:`z`,
+     and (optionally) :monosp:`radius` properties.
+
+ * - default_radius
+   - |float|
+   - Radius of the spheres whose vertex doesn't have a :monosp:`radius`
+     property (Default: 1)
+
+ * - flip_normals
+   - |bool|
+   - Should the normal vectors be flipped, i.e. point inside of the spheres?
+     (Default: |false|)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation that is
+     applied to the sphere centers. The radii are scaled by the length of the
+     transformed X axis, hence non-uniform scales and shears are not
+     permitted. (Default: none, i.e. object space = world space)
+
+ * - center
+   - |tensor|
+   - Sphere centers in structure-of-arrays layout, i.e. all x coordinates
+     followed by all y and z coordinates.
+   - |exposed|
+
+ * - radius
+   - |tensor|
+   - Sphere radii.
+   - |exposed|
+
+This shape plugin represents a large number of spheres (e.g. the particles of
+a fluid or granular material simulation) within a single shape. Every sphere
+is a separate primitive of the acceleration data structure, but the set only
+occupies a single shape slot in the scene, and the centers and radii are
+stored in structure-of-arrays layout without any per-sphere transformation.
+When Embree is used, all spheres are registered as one user geometry whose
+intersection callback tests a packet of rays against a sphere using SIMD
+instructions. Scenes with millions of particles thus load and render much
+faster than when instantiating each of them as a separate
+:ref:`sphere <shape-sphere>` plugin.
+
+The exposed :monosp:`center` and :monosp:`radius` parameters can also be
+used to replace the spheres by a different set (e.g. the next frame of a
+simulation) from Python, in which case the number of spheres may change.
+
+.. note:: This plugin is currently only supported by the CPU variants.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: sphereset
+
+        <shape type="sphereset">
+            <string name="filename" value="particles.ply"/>
+            <bsdf type="diffuse"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'type': 'sphereset',
+        'filename': 'particles.ply',
+        'bsdf': {
+            'type': 'diffuse'
+        }
+
+ */
+
+template <typename Float, typename Spectrum>
+class SphereSet final : public Shape<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Shape, m_to_world, m_is_instance, initialize, mark_dirty,
+                   get_children_string)
+    MI_IMPORT_TYPES()
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+    using FloatStorage = DynamicBuffer<Float>;
+
+    SphereSet(const Properties &props) : Base(props) {
+        if constexpr (dr::is_cuda_v<Float>)
+            Throw("The sphere set is currently only available in CPU variants!");
+
+        m_flip_normals = props.get<bool>("flip_normals", false);
+        ScalarFloat default_radius = props.get<ScalarFloat>("default_radius", 1.f);
+
+        FileResolver *fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+        if (!fs::exists(file_path))
+            Throw("\"%s\": file does not exist!", file_path);
+
+        Timer timer;
+        std::vector<ScalarFloat> center, radius;
+        load_ply(file_path, default_radius, center, radius);
+        size_t count = radius.size();
+
+        ScalarTransform4f to_world = m_to_world.scalar();
+        ScalarFloat scale = dr::norm(to_world * ScalarVector3f(1.f, 0.f, 0.f));
+        for (size_t i = 0; i < count; ++i) {
+            ScalarPoint3f p = to_world * ScalarPoint3f(
+                center[i], center[count + i], center[2 * count + i]);
+            for (size_t k = 0; k < 3; ++k)
+                center[k * count + i] = p[k];
+            radius[i] *= scale;
+        }
+
+        Log(Debug, "\"%s\": read %zu spheres (took %s)", m_name, count,
+            util::time_string((float) timer.value()));
+
+        m_center = dr::load<FloatStorage>(center.data(), center.size());
+        m_radius = dr::load<FloatStorage>(radius.data(), radius.size());
+
+        update();
+        initialize();
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("center", m_center, +ParamFlags::NonDifferentiable);
+        callback->put_parameter("radius", m_radius, +ParamFlags::NonDifferentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        if (keys.empty() || string::contains(keys, "center") ||
+            string::contains(keys, "radius")) {
+            if (dr::width(m_center) != 3 * dr::width(m_radius))
+                Throw("The sphere set must specify three center coordinates "
+                      "per radius (got %zu center coordinates and %zu radii)!",
+                      dr::width(m_center), dr::width(m_radius));
+            update();
+        }
+        Base::parameters_changed(keys);
+    }
+
+    /// Refresh the host pointers, bounds, and sampling table after an update
+    void update() {
+        dr::eval(m_center, m_radius);
+        dr::sync_thread();
+
+        m_count = (ScalarSize) dr::width(m_radius);
+        if (m_count == 0)
+            Throw("\"%s\": the sphere set is empty!", m_name);
+
+        m_center_ptr = m_center.data();
+        m_radius_ptr = m_radius.data();
+
+        m_bbox.reset();
+        std::unique_ptr<ScalarFloat[]> area(new ScalarFloat[m_count]);
+        for (ScalarIndex i = 0; i < m_count; ++i) {
+            ScalarFloat r = m_radius_ptr[i];
+            if (!(r >= 0.f) || !dr::isfinite(r))
+                Throw("\"%s\": sphere %u has an invalid radius (%f)!", m_name, i, r);
+            m_bbox.expand(bbox(i));
+            area[i] = 4.f * dr::Pi<ScalarFloat> * dr::sqr(r);
+        }
+
+        m_area_distr = DiscreteDistribution<Float>(area.get(), m_count);
+        m_inv_surface_area = m_area_distr.normalization();
+        mark_dirty();
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        ScalarPoint3f c = center_scalar(index);
+        ScalarFloat r = m_radius_ptr[index];
+        return ScalarBoundingBox3f(c - r, c + r);
+    }
+
+    ScalarSize primitive_count() const override { return m_count; }
+
+    Float surface_area() const override { return m_area_distr.sum(); }
+
+    // =============================================================
+    //! @{ \name Sampling routines
+    // =============================================================
+
+    PositionSample3f sample_position(Float time, const Point2f &sample_,
+                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        Point2f sample(sample_);
+        UInt32 index;
+        std::tie(index, sample.y()) =
+            m_area_distr.sample_reuse(sample.y(), active);
+
+        Point3f local = warp::square_to_uniform_sphere(sample);
+
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+        ps.p = dr::fmadd(local, dr::gather<Float>(m_radius, index, active),
+                         gather_3(m_center, index, active));
+        ps.n = m_flip_normals ? -local : local;
+        ps.time = time;
+        ps.delta = false;
+        ps.pdf = m_inv_surface_area;
+        ps.uv = sample;
+
+        return ps;
+    }
+
+    Float pdf_position(const PositionSample3f & /*ps*/, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        return m_inv_surface_area;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    /**
+     * \brief Intersect rays with the sphere \c index
+     *
+     * \c FloatP may be a scalar or a packet type, in which case the rays of
+     * a packet are all tested against the same sphere using SIMD
+     * instructions. Returns the intersection distance or infinity.
+     */
+    template <typename FloatP, typename Point3fP, typename Vector3fP>
+    FloatP intersect_sphere(ScalarIndex index, const Point3fP &o,
+                            const Vector3fP &d, const FloatP &maxt,
+                            dr::mask_t<FloatP> active) const {
+        ScalarPoint3f center = center_scalar(index);
+        ScalarFloat radius = m_radius_ptr[index];
+
+        /* Like the 'sphere' plugin, first move the ray origin into the plane
+           through the center that is perpendicular to the ray direction,
+           which improves the robustness of the quadratic. */
+        Vector3fP l = o - Point3fP(center);
+        FloatP A = dr::squared_norm(d),
+               plane_t = -dr::dot(l, d) / A;
+        Vector3fP p = dr::fmadd(d, plane_t, l);
+
+        FloatP B = 2.f * dr::dot(p, d),
+               C = dr::squared_norm(p) - dr::sqr(radius);
+
+        auto [solution_found, near_t, far_t] = math::solve_quadratic(A, B, C);
+        near_t += plane_t;
+        far_t += plane_t;
+
+        // Sphere doesn't intersect with the segment on the ray
+        dr::mask_t<FloatP> out_bounds = !(near_t <= maxt && far_t >= 0.f); // NaN-aware conditionals
+
+        // Sphere fully contains the segment of the ray
+        dr::mask_t<FloatP> in_bounds = near_t < 0.f && far_t > maxt;
+
+        active &= solution_found && !out_bounds && !in_bounds;
+
+        return dr::select(active, dr::select(near_t < 0.f, far_t, near_t),
+                          dr::Infinity<FloatP>);
+    }
+
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_primitive_scalar(ScalarIndex prim_index,
+                                   const ScalarRay3f &ray) const override {
+        ScalarFloat t = intersect_sphere<ScalarFloat>(prim_index, ray.o, ray.d,
+                                                      ray.maxt, true);
+        return { t, ScalarPoint2f(0.f), (ScalarUInt32) -1, prim_index };
+    }
+
+    bool ray_test_primitive_scalar(ScalarIndex prim_index,
+                                   const ScalarRay3f &ray) const override {
+        return intersect_sphere<ScalarFloat>(prim_index, ray.o, ray.d, ray.maxt,
+                                             true) != dr::Infinity<ScalarFloat>;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     const PreliminaryIntersection3f &pi,
+                                                     uint32_t ray_flags,
+                                                     uint32_t recursion_depth,
+                                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Early exit when tracing isn't necessary
+        if (!m_is_instance && recursion_depth > 0)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        // Fields requirement dependencies
+        bool need_dn_duv = has_flag(ray_flags, RayFlags::dNSdUV) ||
+                           has_flag(ray_flags, RayFlags::dNGdUV);
+        bool need_dp_duv = has_flag(ray_flags, RayFlags::dPdUV) || need_dn_duv;
+        bool need_uv     = has_flag(ray_flags, RayFlags::UV) || need_dp_duv;
+
+        Point3f center = gather_3(m_center, pi.prim_index, active);
+        Float radius = dr::gather<Float>(m_radius, pi.prim_index, active);
+
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        si.t = dr::select(active, pi.t, dr::Infinity<Float>);
+
+        // Re-project onto the sphere to improve accuracy
+        Vector3f local = dr::normalize(ray(pi.t) - center);
+        si.p = dr::fmadd(local, radius, center);
+
+        if (likely(need_uv)) {
+            Float rd_2  = dr::sqr(local.x()) + dr::sqr(local.y()),
+                  theta = unit_angle_z(local),
+                  phi   = dr::atan2(local.y(), local.x());
+
+            dr::masked(phi, phi < 0.f) += 2.f * dr::Pi<Float>;
+
+            si.uv = Point2f(phi * dr::InvTwoPi<Float>, theta * dr::InvPi<Float>);
+            if (likely(need_dp_duv)) {
+                si.dp_du = Vector3f(-local.y(), local.x(), 0.f);
+
+                Float rd      = dr::sqrt(rd_2),
+                      inv_rd  = dr::rcp(rd),
+                      cos_phi = local.x() * inv_rd,
+                      sin_phi = local.y() * inv_rd;
+
+                si.dp_dv = Vector3f(local.z() * cos_phi,
+                                    local.z() * sin_phi,
+                                    -rd);
+
+                Mask singularity_mask = active && dr::eq(rd, 0.f);
+                if (unlikely(dr::any_or<true>(singularity_mask)))
+                    si.dp_dv[singularity_mask] = Vector3f(1.f, 0.f, 0.f);
+
+                si.dp_du *= radius * (2.f * dr::Pi<Float>);
+                si.dp_dv *= radius * dr::Pi<Float>;
+            }
+        }
+
+        si.sh_frame.n = m_flip_normals ? -local : local;
+        si.n = si.sh_frame.n;
+
+        if (need_dn_duv) {
+            Float inv_radius =
+                (m_flip_normals ? -1.f : 1.f) * dr::rcp(radius);
+            si.dn_du = si.dp_du * inv_radius;
+            si.dn_dv = si.dp_dv * inv_radius;
+        }
+
+        si.shape    = this;
+        si.instance = nullptr;
+
+        if (unlikely(has_flag(ray_flags, RayFlags::BoundaryTest)))
+            si.boundary_test = dr::abs(dr::dot(si.sh_frame.n, -ray.d));
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+        rtcSetGeometryUserPrimitiveCount(geom, m_count);
+        rtcSetGeometryUserData(geom, (void *) this);
+        rtcSetGeometryBoundsFunction(geom, embree_bbox, nullptr);
+        rtcSetGeometryIntersectFunction(geom, embree_intersect);
+        rtcSetGeometryOccludedFunction(geom, embree_occluded);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SphereSet[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  sphere_count = " << m_count << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  surface_area = " << surface_area() << "," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    ScalarPoint3f center_scalar(ScalarIndex index) const {
+        return ScalarPoint3f(m_center_ptr[index],
+                             m_center_ptr[m_count + index],
+                             m_center_ptr[2 * m_count + index]);
+    }
+
+    Point3f gather_3(const FloatStorage &buffer, const UInt32 &index,
+                     Mask active) const {
+        return Point3f(dr::gather<Float>(buffer, index, active),
+                       dr::gather<Float>(buffer, index + m_count, active),
+                       dr::gather<Float>(buffer, index + 2 * m_count, active));
+    }
+
+    /// Property of the vertex element of a PLY file
+    struct PLYProperty {
+        std::string name;
+        std::string type;
+        size_t size;
+        bool is_list;
+    };
+
+    /// Decode a binary PLY value of the given type
+    static double decode(const uint8_t *ptr, const std::string &type,
+                         bool swap) {
+        uint8_t buf[8];
+        size_t size = type_size(type);
+        for (size_t i = 0; i < size; ++i)
+            buf[i] = ptr[swap ? size - 1 - i : i];
+
+        auto as = [&](auto value) {
+            memcpy(&value, buf, sizeof(value));
+            return (double) value;
+        };
+
+        if (type == "char" || type == "int8")         return as(int8_t());
+        else if (type == "uchar" || type == "uint8")  return as(uint8_t());
+        else if (type == "short" || type == "int16")  return as(int16_t());
+        else if (type == "ushort" || type == "uint16") return as(uint16_t());
+        else if (type == "int" || type == "int32")    return as(int32_t());
+        else if (type == "uint" || type == "uint32")  return as(uint32_t());
+        else if (type == "float" || type == "float32") return as(float());
+        else                                          return as(double());
+    }
+
+    /// Size in bytes of a PLY property type (0 if unknown)
+    static size_t type_size(const std::string &type) {
+        if (type == "char" || type == "int8" || type == "uchar" || type == "uint8")
+            return 1;
+        else if (type == "short" || type == "int16" || type == "ushort" || type == "uint16")
+            return 2;
+        else if (type == "int" || type == "int32" || type == "uint" ||
+                 type == "uint32" || type == "float" || type == "float32")
+            return 4;
+        else if (type == "double" || type == "float64")
+            return 8;
+        return 0;
+    }
+
+    /**
+     * \brief Load the vertices of an ASCII or binary PLY file
+     *
+     * Writes the centers in structure-of-arrays layout to \c center. Only the
+     * vertex element is decoded; preceding elements without list properties
+     * are skipped, and anything following it (e.g. faces) is ignored.
+     */
+    void load_ply(const fs::path &path, ScalarFloat default_radius,
+                  std::vector<ScalarFloat> &center,
+                  std::vector<ScalarFloat> &radius) const {
+        auto fail = [&](const char *descr, auto... args) {
+            Throw(("Error while loading PLY file \"%s\": " + std::string(descr) + "!")
+                      .c_str(), m_name, args...);
+        };
+
+        std::ifstream is(path.native(), std::ios::binary);
+        if (!is)
+            fail("could not open file");
+
+        struct Element {
+            std::string name;
+            size_t count;
+            std::vector<PLYProperty> props;
+        };
+
+        std::string line, format;
+        std::vector<Element> elements;
+
+        std::getline(is, line);
+        if (string::trim(line) != "ply")
+            fail("invalid file header");
+
+        while (true) {
+            if (!std::getline(is, line))
+                fail("unexpected end of file in the header");
+            std::istringstream iss(line);
+            std::string token;
+            iss >> token;
+
+            if (token == "format") {
+                iss >> format;
+            } else if (token == "element") {
+                Element el;
+                iss >> el.name >> el.count;
+                elements.push_back(el);
+            } else if (token == "property") {
+                if (elements.empty())
+                    fail("property declared outside of an element");
+                PLYProperty prop;
+                iss >> prop.type;
+                prop.is_list = prop.type == "list";
+                if (prop.is_list) {
+                    std::string count_type;
+                    iss >> count_type >> prop.type;
+                }
+                iss >> prop.name;
+                prop.size = type_size(prop.type);
+                if (prop.size == 0)
+                    fail("unknown property type \"%s\"", prop.type);
+                elements.back().props.push_back(prop);
+            } else if (token == "end_header") {
+                break;
+            } else if (token != "comment" && token != "obj_info" && !token.empty()) {
+                fail("unknown header entry \"%s\"", token);
+            }
+        }
+
+        bool ascii = format == "ascii",
+             big_endian = format == "binary_big_endian";
+        if (!ascii && !big_endian && format != "binary_little_endian")
+            fail("unknown format \"%s\"", format);
+        bool swap = big_endian != (Stream::host_byte_order() == Stream::EBigEndian);
+
+        for (const Element &el : elements) {
+            if (el.name != "vertex") {
+                // Skip elements preceding the vertices
+                if (ascii) {
+                    for (size_t i = 0; i < el.count; ++i)
+                        std::getline(is, line);
+                } else {
+                    size_t stride = 0;
+                    for (const PLYProperty &prop : el.props) {
+                        if (prop.is_list)
+                            fail("element \"%s\" with list properties must "
+                                 "follow the vertex element", el.name);
+                        stride += prop.size;
+                    }
+                    is.seekg(stride * el.count, std::ios::cur);
+                }
+                continue;
+            }
+
+            size_t index[4] = { (size_t) -1, (size_t) -1, (size_t) -1, (size_t) -1 },
+                   offset[4] = { 0, 0, 0, 0 }, stride = 0;
+            const char *names[4] = { "x", "y", "z", "radius" };
+            for (size_t j = 0; j < el.props.size(); ++j) {
+                const PLYProperty &prop = el.props[j];
+                if (prop.is_list)
+                    fail("vertex element may not contain list properties");
+                for (size_t k = 0; k < 4; ++k) {
+                    if (prop.name == names[k]) {
+                        index[k] = j;
+                        offset[k] = stride;
+                    }
+                }
+                stride += prop.size;
+            }
+
+            for (size_t k = 0; k < 3; ++k)
+                if (index[k] == (size_t) -1)
+                    fail("vertex element lacks the \"%s\" property", names[k]);
+
+            bool has_radius = index[3] != (size_t) -1;
+            size_t n = el.count;
+            center.resize(3 * n);
+            radius.resize(n);
+
+            std::vector<double> values(el.props.size());
+            std::unique_ptr<uint8_t[]> record(new uint8_t[stride]);
+            for (size_t i = 0; i < n; ++i) {
+                double v[4] = { 0.0, 0.0, 0.0, (double) default_radius };
+                if (ascii) {
+                    if (!std::getline(is, line))
+                        fail("file is truncated");
+                    std::istringstream iss(line);
+                    for (double &value : values)
+                        if (!(iss >> value))
+                            fail("could not parse vertex %zu", i);
+                    for (size_t k = 0; k < 4; ++k)
+                        if (index[k] != (size_t) -1)
+                            v[k] = values[index[k]];
+                } else {
+                    if (!is.read((char *) record.get(), stride))
+                        fail("file is truncated");
+                    for (size_t k = 0; k < 4; ++k)
+                        if (index[k] != (size_t) -1)
+                            v[k] = decode(record.get() + offset[k],
+                                          el.props[index[k]].type, swap);
+                }
+
+                for (size_t k = 0; k < 3; ++k)
+                    center[k * n + i] = (ScalarFloat) v[k];
+                radius[i] = (ScalarFloat) v[3];
+            }
+
+            if (!has_radius)
+                Log(Debug, "\"%s\": no radius property, using a radius of %f",
+                    m_name, default_radius);
+            return;
+        }
+
+        fail("file doesn't contain a vertex element");
+    }
+
+#if defined(MI_ENABLE_EMBREE)
+    static void embree_bbox(const RTCBoundsFunctionArguments *args) {
+        const SphereSet *shape = (const SphereSet *) args->geometryUserPtr;
+        ScalarBoundingBox3f bbox = shape->bbox(args->primID);
+        RTCBounds *bounds_o = args->bounds_o;
+        bounds_o->lower_x = (float) bbox.min.x();
+        bounds_o->lower_y = (float) bbox.min.y();
+        bounds_o->lower_z = (float) bbox.min.z();
+        bounds_o->upper_x = (float) bbox.max.x();
+        bounds_o->upper_y = (float) bbox.max.y();
+        bounds_o->upper_z = (float) bbox.max.z();
+    }
+
+    static void embree_intersect_scalar(const int *valid, const SphereSet *shape,
+                                        unsigned int geom_id, unsigned int prim_id,
+                                        unsigned int inst_id, RTCRay *rtc_ray,
+                                        RTCHit *rtc_hit) {
+        if (!valid[0])
+            return;
+
+        ScalarPoint3f o(rtc_ray->org_x, rtc_ray->org_y, rtc_ray->org_z);
+        ScalarVector3f d(rtc_ray->dir_x, rtc_ray->dir_y, rtc_ray->dir_z);
+        ScalarFloat tnear = rtc_ray->tnear;
+
+        ScalarFloat t = shape->intersect_sphere<ScalarFloat>(
+            prim_id, o + d * tnear, d, rtc_ray->tfar - tnear, true);
+        if (t == dr::Infinity<ScalarFloat>)
+            return;
+
+        if (rtc_hit) {
+            rtc_ray->tfar      = (float) (t + tnear);
+            rtc_hit->u         = 0.f;
+            rtc_hit->v         = 0.f;
+            rtc_hit->geomID    = geom_id;
+            rtc_hit->primID    = prim_id;
+            rtc_hit->instID[0] = inst_id;
+        } else {
+            rtc_ray->tfar = -dr::Infinity<float>;
+        }
+    }
+
+    /// Test a packet of \c N rays against one sphere using SIMD instructions
+    template <size_t N, typename RTCRay_, typename RTCHit_>
+    static void embree_intersect_packet(const int *valid, const SphereSet *shape,
+                                        unsigned int geom_id, unsigned int prim_id,
+                                        unsigned int inst_id, RTCRay_ *rtc_ray,
+                                        RTCHit_ *rtc_hit) {
+        using FloatP    = dr::Packet<ScalarFloat, N>;
+        using Float32P  = dr::Packet<float, N>;
+        using UInt32P   = dr::uint32_array_t<FloatP>;
+        using MaskP     = dr::mask_t<FloatP>;
+        using Point3fP  = Point<FloatP, 3>;
+        using Vector3fP = Vector<FloatP, 3>;
+
+        MaskP active = dr::neq(dr::load_aligned<UInt32P>(valid), 0);
+        if (dr::none(active))
+            return;
+
+        Point3fP o(dr::load_aligned<Float32P>(rtc_ray->org_x),
+                   dr::load_aligned<Float32P>(rtc_ray->org_y),
+                   dr::load_aligned<Float32P>(rtc_ray->org_z));
+        Vector3fP d(dr::load_aligned<Float32P>(rtc_ray->dir_x),
+                    dr::load_aligned<Float32P>(rtc_ray->dir_y),
+                    dr::load_aligned<Float32P>(rtc_ray->dir_z));
+        FloatP tnear = dr::load_aligned<Float32P>(rtc_ray->tnear),
+               tfar  = dr::load_aligned<Float32P>(rtc_ray->tfar);
+
+        FloatP t = shape->intersect_sphere<FloatP>(
+            prim_id, o + d * tnear, d, tfar - tnear, active);
+        active &= dr::neq(t, dr::Infinity<FloatP>);
+        if (dr::none(active))
+            return;
+
+        if (rtc_hit) {
+            Float32P zero(0.f);
+            dr::store_aligned(rtc_ray->tfar,      Float32P(dr::select(active, t + tnear, tfar)));
+            dr::store_aligned(rtc_hit->u,         dr::select(active, zero, dr::load_aligned<Float32P>(rtc_hit->u)));
+            dr::store_aligned(rtc_hit->v,         dr::select(active, zero, dr::load_aligned<Float32P>(rtc_hit->v)));
+            dr::store_aligned(rtc_hit->geomID,    dr::select(active, UInt32P(geom_id), dr::load_aligned<UInt32P>(rtc_hit->geomID)));
+            dr::store_aligned(rtc_hit->primID,    dr::select(active, UInt32P(prim_id), dr::load_aligned<UInt32P>(rtc_hit->primID)));
+            dr::store_aligned(rtc_hit->instID[0], dr::select(active, UInt32P(inst_id), dr::load_aligned<UInt32P>(rtc_hit->instID[0])));
+        } else {
+            dr::store_aligned(rtc_ray->tfar, Float32P(dr::select(active, -dr::Infinity<FloatP>, tfar)));
+        }
+    }
+
+    static void embree_intersect(const RTCIntersectFunctionNArguments *args) {
+        const SphereSet *shape = (const SphereSet *) args->geometryUserPtr;
+        unsigned int inst_id = args->context->instID[0];
+        switch (args->N) {
+            case 1:
+                embree_intersect_scalar(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    &((RTCRayHit *) args->rayhit)->ray,
+                    &((RTCRayHit *) args->rayhit)->hit);
+                break;
+
+            case 4:
+                embree_intersect_packet<4>(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    &((RTCRayHit4 *) args->rayhit)->ray,
+                    &((RTCRayHit4 *) args->rayhit)->hit);
+                break;
+
+            case 8:
+                embree_intersect_packet<8>(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    &((RTCRayHit8 *) args->rayhit)->ray,
+                    &((RTCRayHit8 *) args->rayhit)->hit);
+                break;
+
+            case 16:
+                embree_intersect_packet<16>(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    &((RTCRayHit16 *) args->rayhit)->ray,
+                    &((RTCRayHit16 *) args->rayhit)->hit);
+                break;
+
+            default:
+                Throw("embree_intersect(): unsupported packet size!");
+        }
+    }
+
+    static void embree_occluded(const RTCOccludedFunctionNArguments *args) {
+        const SphereSet *shape = (const SphereSet *) args->geometryUserPtr;
+        unsigned int inst_id = args->context->instID[0];
+        switch (args->N) {
+            case 1:
+                embree_intersect_scalar(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    (RTCRay *) args->ray, (RTCHit *) nullptr);
+                break;
+
+            case 4:
+                embree_intersect_packet<4>(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    (RTCRay4 *) args->ray, (RTCHit4 *) nullptr);
+                break;
+
+            case 8:
+                embree_intersect_packet<8>(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    (RTCRay8 *) args->ray, (RTCHit8 *) nullptr);
+                break;
+
+            case 16:
+                embree_intersect_packet<16>(
+                    args->valid, shape, args->geomID, args->primID, inst_id,
+                    (RTCRay16 *) args->ray, (RTCHit16 *) nullptr);
+                break;
+
+            default:
+                Throw("embree_occluded(): unsupported packet size!");
+        }
+    }
+#endif
+
+private:
+    std::string m_name;
+    bool m_flip_normals;
+
+    /// Number of spheres
+    ScalarSize m_count = 0;
+
+    /// Sphere centers (structure-of-arrays layout) and radii
+    FloatStorage m_center, m_radius;
+
+    /// Host pointers to the above buffers used by the intersection routines
+    const ScalarFloat *m_center_ptr = nullptr, *m_radius_ptr = nullptr;
+
+    ScalarBoundingBox3f m_bbox;
+
+    /// Discrete distribution used to sample a sphere by its surface area
+    DiscreteDistribution<Float> m_area_distr;
+    Float m_inv_surface_area;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SphereSet, Shape)
+MI_EXPORT_PLUGIN(SphereSet, "SphereSet intersection primitive");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,1062 @@
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/texture.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <nanothread/nanothread.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-subdivision:
+
+Subdivision surface (:monosp:`subdivision`)
+-------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of a Wavefront OBJ file containing the polygonal control cage
+
+ * - levels
+   - |int|
+   - Number of uniform Catmull-Clark subdivision steps applied to the cage
+     before the adaptive tessellation. Must be at least one. (Default: 2)
+
+ * - edge_length
+   - |float|
+   - Target length of the tessellated edges in pixels. A value of zero
+     disables the adaptive tessellation. (Default: 2)
+
+ * - max_rate
+   - |int|
+   - Maximum number of segments an edge of the subdivided cage is split
+     into by the adaptive tessellation. (Default: 32)
+
+ * - displacement
+   - |texture|
+   - Optional scalar displacement texture, which offsets the tessellated
+     surface along its normal. Requires texture coordinates.
+
+ * - displacement_scale
+   - |float|
+   - Scale factor applied to the values of the displacement texture
+     (Default: 1)
+
+ * - flip_tex_coords
+   - |bool|
+   - Treat the vertical component of the texture as inverted? (Default: |true|)
+
+ * - face_normals
+   - |bool|
+   - When set to |true|, face normals instead of the smooth vertex normals of
+     the tessellation are used during rendering. (Default: |false|)
+
+ * - flip_normals
+   - |bool|
+   - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:
+     |false|, i.e. the normals point outside)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation.
+     (Default: none, i.e. object space = world space)
+
+This plugin loads a polygonal control cage from a Wavefront OBJ file and
+renders the Catmull-Clark subdivision surface it defines
+:cite:`Catmull1978Recursively`. The cage may contain arbitrary polygons and
+boundaries. Texture coordinates are subdivided linearly, and discontinuities of
+the texture parameterization (seams) are preserved.
+
+The cage is first subdivided :monosp:`levels` times, after which all vertices
+are projected onto their limit positions. The resulting quadrilaterals are
+then tessellated adaptively once all sensors of the scene are known: every edge
+is split into as many segments as needed to make them approximately
+:monosp:`edge_length` pixels long as seen from the closest sensor (taking the
+maximum over all sensors). The patches are interpolated using Phong
+tessellation :cite:`Boubekeur2008Phong`, and neighboring patches share the
+vertices of their common edges, hence the tessellation is free of cracks even
+when the rates of adjacent faces differ. The tessellation runs in parallel and
+stores the final triangle mesh only. When the shape is not part of a scene (or
+the scene contains no sensors), the subdivided cage is used without further
+refinement.
+
+The subdivided control mesh only depends on the cage and the number of levels
+and is cached across shapes and scene reloads referencing the same file.
+
+When a :monosp:`displacement` texture is specified, each tessellated vertex is
+moved along the surface normal by the texture value times
+:monosp:`displacement_scale`, and the vertex normals are recomputed afterwards.
+The displacement texture should be continuous across the seams of the texture
+parameterization, which would otherwise open cracks in the surface.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: subdivision
+
+        <shape type="subdivision">
+            <string name="filename" value="cage.obj"/>
+            <integer name="levels" value="2"/>
+            <float name="edge_length" value="1"/>
+            <texture type="bitmap" name="displacement">
+                <string name="filename" value="height.exr"/>
+            </texture>
+            <float name="displacement_scale" value="0.05"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'type': 'subdivision',
+        'filename': 'cage.obj',
+        'levels': 2,
+        'edge_length': 1.0,
+        'displacement': {
+            'type': 'bitmap',
+            'filename': 'height.exr'
+        },
+        'displacement_scale': 0.05
+
+ */
+
+NAMESPACE_BEGIN(detail)
+
+using SubdivPoint3f  = Point<float, 3>;
+using SubdivVector3f = Vector<float, 3>;
+using SubdivVector2f = Vector<float, 2>;
+
+/// Polygon mesh with face-varying texture coordinates
+struct SubdivisionPolygons {
+    std::vector<SubdivPoint3f> positions;
+    /// Index of the first corner of every face (and one past the last face)
+    std::vector<uint32_t> face_offsets { 0 };
+    /// Vertex index of every face corner
+    std::vector<uint32_t> corners;
+    /// Texture coordinates of every face corner (empty if absent)
+    std::vector<SubdivVector2f> corner_uvs;
+
+    size_t face_count() const { return face_offsets.size() - 1; }
+};
+
+/// Subdivided control cage in object space, whose faces are all quadrilaterals
+struct SubdivisionControlMesh {
+    /// Limit positions and normals of the control vertices
+    std::vector<SubdivPoint3f> positions;
+    std::vector<SubdivVector3f> normals;
+    /// Vertex indices and texture coordinates of the quad corners (4 per face)
+    std::vector<uint32_t> quads;
+    std::vector<SubdivVector2f> quad_uvs;
+    /// Vertex indices of every edge (2 per edge, in increasing order)
+    std::vector<uint32_t> edges;
+    /// Edge following every quad corner (4 per face)
+    std::vector<uint32_t> quad_edges;
+    /// First quad corner referencing every edge
+    std::vector<uint32_t> edge_owner;
+    /// Do the texture coordinates of the faces sharing an edge differ?
+    std::vector<uint8_t> edge_seam;
+    /// Distinct (vertex, texture coordinate) pairs referenced by the corners
+    std::vector<uint32_t> corner_slots;
+    std::vector<uint32_t> slot_vertex;
+    std::vector<SubdivVector2f> slot_uvs;
+    /// Size of the cage file, used to detect modifications
+    size_t file_size = 0;
+
+    size_t vertex_count() const { return positions.size(); }
+    size_t quad_count() const { return quads.size() / 4; }
+    size_t edge_count() const { return edges.size() / 2; }
+};
+
+/// Compute the edges of a polygon mesh, and the number of faces sharing each
+static void subdivision_edges(const SubdivisionPolygons &mesh,
+                              std::vector<uint32_t> &edges,
+                              std::vector<uint32_t> &corner_edges,
+                              std::vector<uint32_t> &edge_faces) {
+    std::unordered_map<uint64_t, uint32_t> table;
+    table.reserve(mesh.corners.size());
+    corner_edges.resize(mesh.corners.size());
+
+    for (size_t f = 0; f < mesh.face_count(); ++f) {
+        uint32_t begin = mesh.face_offsets[f], end = mesh.face_offsets[f + 1];
+        for (uint32_t c = begin; c < end; ++c) {
+            uint32_t a = mesh.corners[c],
+                     b = mesh.corners[c + 1 < end ? c + 1 : begin];
+            if (a > b)
+                std::swap(a, b);
+            auto [it, inserted] = table.try_emplace(
+                ((uint64_t) a << 32) | b, (uint32_t) edge_faces.size());
+            if (inserted) {
+                edges.push_back(a);
+                edges.push_back(b);
+                edge_faces.push_back(0);
+            }
+            edge_faces[it->second]++;
+            corner_edges[c] = it->second;
+        }
+    }
+}
+
+/// Apply one step of Catmull-Clark subdivision, which produces a quad mesh
+static SubdivisionPolygons subdivision_step(const SubdivisionPolygons &mesh) {
+    std::vector<uint32_t> edges, corner_edges, edge_faces;
+    subdivision_edges(mesh, edges, corner_edges, edge_faces);
+
+    size_t vertex_count = mesh.positions.size(),
+           edge_count   = edge_faces.size(),
+           face_count   = mesh.face_count();
+    bool has_uvs = !mesh.corner_uvs.empty();
+    const SubdivPoint3f *p = mesh.positions.data();
+
+    std::vector<SubdivPoint3f> face_points(face_count, 0.f),
+                               edge_face_sum(edge_count, 0.f);
+    for (size_t f = 0; f < face_count; ++f) {
+        uint32_t begin = mesh.face_offsets[f], end = mesh.face_offsets[f + 1];
+        for (uint32_t c = begin; c < end; ++c)
+            face_points[f] += p[mesh.corners[c]];
+        face_points[f] /= (float) (end - begin);
+        for (uint32_t c = begin; c < end; ++c)
+            edge_face_sum[corner_edges[c]] += face_points[f];
+    }
+
+    std::vector<SubdivPoint3f> face_sum(vertex_count, 0.f),
+                               edge_sum(vertex_count, 0.f),
+                               boundary_sum(vertex_count, 0.f);
+    std::vector<uint32_t> face_valence(vertex_count, 0),
+                          edge_valence(vertex_count, 0),
+                          boundary_valence(vertex_count, 0);
+
+    for (size_t f = 0; f < face_count; ++f) {
+        for (uint32_t c = mesh.face_offsets[f]; c < mesh.face_offsets[f + 1]; ++c) {
+            face_sum[mesh.corners[c]] += face_points[f];
+            face_valence[mesh.corners[c]]++;
+        }
+    }
+
+    SubdivisionPolygons result;
+    result.positions.resize(vertex_count + edge_count + face_count);
+
+    for (size_t e = 0; e < edge_count; ++e) {
+        uint32_t a = edges[2 * e], b = edges[2 * e + 1];
+        SubdivPoint3f mid = (p[a] + p[b]) * .5f;
+        edge_sum[a] += mid;
+        edge_sum[b] += mid;
+        edge_valence[a]++;
+        edge_valence[b]++;
+
+        // Edges that are not shared by exactly two faces remain sharp
+        if (edge_faces[e] == 2) {
+            result.positions[vertex_count + e] =
+                (p[a] + p[b] + edge_face_sum[e]) * .25f;
+        } else {
+            result.positions[vertex_count + e] = mid;
+            boundary_sum[a] += p[b];
+            boundary_sum[b] += p[a];
+            boundary_valence[a]++;
+            boundary_valence[b]++;
+        }
+    }
+
+    for (size_t v = 0; v < vertex_count; ++v) {
+        SubdivPoint3f &q = result.positions[v];
+        float n = (float) edge_valence[v];
+        if (boundary_valence[v] == 0 && edge_valence[v] > 0)
+            q = (face_sum[v] / (float) face_valence[v] + edge_sum[v] * (2.f / n) +
+                 p[v] * (n - 3.f)) / n;
+        else if (boundary_valence[v] == 2)
+            q = p[v] * .75f + boundary_sum[v] * .125f;
+        else
+            q = p[v]; // Corners and non-manifold vertices are interpolated
+    }
+
+    for (size_t f = 0; f < face_count; ++f)
+        result.positions[vertex_count + edge_count + f] = face_points[f];
+
+    // Split every n-gon into n quadrilaterals
+    result.corners.reserve(4 * mesh.corners.size());
+    result.face_offsets.reserve(mesh.corners.size() + 1);
+    if (has_uvs)
+        result.corner_uvs.reserve(4 * mesh.corners.size());
+
+    for (size_t f = 0; f < face_count; ++f) {
+        uint32_t begin = mesh.face_offsets[f], end = mesh.face_offsets[f + 1],
+                 size = end - begin;
+
+        SubdivVector2f center_uv = 0.f;
+        if (has_uvs) {
+            for (uint32_t c = begin; c < end; ++c)
+                center_uv += mesh.corner_uvs[c];
+            center_uv /= (float) size;
+        }
+
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t c    = begin + i,
+                     next = begin + (i + 1) % size,
+                     prev = begin + (i + size - 1) % size;
+
+            result.corners.push_back(mesh.corners[c]);
+            result.corners.push_back((uint32_t) (vertex_count + corner_edges[c]));
+            result.corners.push_back((uint32_t) (vertex_count + edge_count + f));
+            result.corners.push_back((uint32_t) (vertex_count + corner_edges[prev]));
+            result.face_offsets.push_back((uint32_t) result.corners.size());
+
+            if (has_uvs) {
+                const SubdivVector2f *uv = mesh.corner_uvs.data();
+                result.corner_uvs.push_back(uv[c]);
+                result.corner_uvs.push_back((uv[c] + uv[next]) * .5f);
+                result.corner_uvs.push_back(center_uv);
+                result.corner_uvs.push_back((uv[prev] + uv[c]) * .5f);
+            }
+        }
+    }
+
+    return result;
+}
+
+/// Project the vertices of a subdivided quad mesh onto the limit surface
+static void subdivision_limit(const SubdivisionPolygons &mesh,
+                              SubdivisionControlMesh &result) {
+    std::vector<uint32_t> corner_edges, edge_faces;
+    subdivision_edges(mesh, result.edges, corner_edges, edge_faces);
+
+    size_t vertex_count = mesh.positions.size(),
+           edge_count   = edge_faces.size(),
+           quad_count   = mesh.face_count();
+    bool has_uvs = !mesh.corner_uvs.empty();
+    const SubdivPoint3f *p = mesh.positions.data();
+
+    std::vector<SubdivPoint3f> edge_sum(vertex_count, 0.f),
+                               diagonal_sum(vertex_count, 0.f),
+                               boundary_sum(vertex_count, 0.f);
+    std::vector<uint32_t> edge_valence(vertex_count, 0),
+                          boundary_valence(vertex_count, 0);
+
+    for (size_t e = 0; e < edge_count; ++e) {
+        uint32_t a = result.edges[2 * e], b = result.edges[2 * e + 1];
+        edge_sum[a] += p[b];
+        edge_sum[b] += p[a];
+        edge_valence[a]++;
+        edge_valence[b]++;
+        if (edge_faces[e] != 2) {
+            boundary_sum[a] += p[b];
+            boundary_sum[b] += p[a];
+            boundary_valence[a]++;
+            boundary_valence[b]++;
+        }
+    }
+
+    for (size_t c = 0; c < mesh.corners.size(); ++c)
+        diagonal_sum[mesh.corners[c]] += p[mesh.corners[c ^ 2]];
+
+    result.positions.resize(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        float n = (float) edge_valence[v];
+        if (boundary_valence[v] == 0 && edge_valence[v] > 0)
+            result.positions[v] = (p[v] * (n * n) + edge_sum[v] * 4.f +
+                                   diagonal_sum[v]) / (n * (n + 5.f));
+        else if (boundary_valence[v] == 2)
+            result.positions[v] = (p[v] * 4.f + boundary_sum[v]) / 6.f;
+        else
+            result.positions[v] = p[v];
+    }
+
+    // Area-weighted normals of the limit quads
+    result.normals.assign(vertex_count, 0.f);
+    for (size_t f = 0; f < quad_count; ++f) {
+        const uint32_t *q = mesh.corners.data() + 4 * f;
+        const SubdivPoint3f *lp = result.positions.data();
+        SubdivVector3f n = dr::cross(lp[q[2]] - lp[q[0]], lp[q[3]] - lp[q[1]]);
+        for (int k = 0; k < 4; ++k)
+            result.normals[q[k]] += n;
+    }
+    for (SubdivVector3f &n : result.normals) {
+        float length = dr::norm(n);
+        n = length > 0.f ? n / length : SubdivVector3f(0.f, 0.f, 1.f);
+    }
+
+    result.quads = mesh.corners;
+    result.quad_uvs = mesh.corner_uvs;
+    result.quad_edges = corner_edges;
+
+    // Find the owner of every edge and detect texture seams
+    result.edge_owner.assign(edge_count, (uint32_t) -1);
+    result.edge_seam.assign(edge_count, 0);
+    for (size_t c = 0; c < result.quads.size(); ++c) {
+        uint32_t e = corner_edges[c];
+        if (result.edge_owner[e] == (uint32_t) -1) {
+            result.edge_owner[e] = (uint32_t) c;
+        } else if (has_uvs) {
+            size_t o = result.edge_owner[e];
+            auto next = [](size_t i) { return (i & ~size_t(3)) | ((i + 1) & 3); };
+            // Compare the texture coordinates at the same edge endpoints
+            bool same_order = mesh.corners[o] == mesh.corners[c];
+            const SubdivVector2f &u0 = mesh.corner_uvs[o],
+                                 &u1 = mesh.corner_uvs[next(o)],
+                                 &v0 = mesh.corner_uvs[same_order ? c : next(c)],
+                                 &v1 = mesh.corner_uvs[same_order ? next(c) : c];
+            if (u0 != v0 || u1 != v1)
+                result.edge_seam[e] = 1;
+        }
+    }
+
+    // Corners with the same vertex and texture coordinates share an output vertex
+    result.corner_slots.resize(result.quads.size());
+    if (has_uvs) {
+        struct SlotHash {
+            size_t operator()(const std::pair<uint32_t, uint64_t> &k) const {
+                return hash_combine(std::hash<uint32_t>()(k.first),
+                                    std::hash<uint64_t>()(k.second));
+            }
+        };
+        std::unordered_map<std::pair<uint32_t, uint64_t>, uint32_t, SlotHash> table;
+        table.reserve(vertex_count);
+        for (size_t c = 0; c < result.quads.size(); ++c) {
+            uint64_t uv_bits;
+            memcpy(&uv_bits, &mesh.corner_uvs[c], sizeof(uint64_t));
+            auto [it, inserted] = table.try_emplace(
+                { mesh.corners[c], uv_bits }, (uint32_t) result.slot_vertex.size());
+            if (inserted) {
+                result.slot_vertex.push_back(mesh.corners[c]);
+                result.slot_uvs.push_back(mesh.corner_uvs[c]);
+            }
+            result.corner_slots[c] = it->second;
+        }
+    } else {
+        result.slot_vertex.resize(vertex_count);
+        for (size_t v = 0; v < vertex_count; ++v)
+            result.slot_vertex[v] = (uint32_t) v;
+        result.corner_slots = mesh.corners;
+    }
+}
+
+/// Parse the polygons, vertices, and texture coordinates of an OBJ cage
+static SubdivisionPolygons subdivision_load(const fs::path &path, bool flip_tex_coords) {
+    auto fail = [&](const char *descr, auto... args) {
+        Throw(("Error while loading subdivision cage \"%s\": " + std::string(descr))
+                  .c_str(), path.filename().string(), args...);
+    };
+
+    std::ifstream is(path.native());
+    if (!is)
+        fail("could not open file!");
+
+    SubdivisionPolygons mesh;
+    std::vector<SubdivVector2f> texcoords;
+    std::vector<uint32_t> corner_texcoords;
+    size_t line_number = 0;
+    std::string line;
+
+    while (std::getline(is, line)) {
+        line_number++;
+        line = string::trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream iss(line);
+        std::string type;
+        iss >> type;
+
+        if (type == "v") {
+            SubdivPoint3f p;
+            if (!(iss >> p.x() >> p.y() >> p.z()))
+                fail("could not parse vertex on line %zu!", line_number);
+            mesh.positions.push_back(p);
+        } else if (type == "vt") {
+            SubdivVector2f uv;
+            if (!(iss >> uv.x() >> uv.y()))
+                fail("could not parse texture coordinate on line %zu!", line_number);
+            if (flip_tex_coords)
+                uv.y() = 1.f - uv.y();
+            texcoords.push_back(uv);
+        } else if (type == "f") {
+            std::string token;
+            size_t size = 0;
+            while (iss >> token) {
+                // Supports the "v", "v/vt", "v//vn", and "v/vt/vn" forms
+                long v = std::strtol(token.c_str(), nullptr, 10), vt = 0;
+                size_t slash = token.find('/');
+                if (slash != std::string::npos && slash + 1 < token.size() &&
+                    token[slash + 1] != '/')
+                    vt = std::strtol(token.c_str() + slash + 1, nullptr, 10);
+
+                // Negative indices are relative to the end of the lists
+                if (v < 0)
+                    v += (long) mesh.positions.size() + 1;
+                if (vt < 0)
+                    vt += (long) texcoords.size() + 1;
+                if (v <= 0 || (size_t) v > mesh.positions.size())
+                    fail("reference to invalid vertex on line %zu!", line_number);
+                if (vt < 0 || (size_t) vt > texcoords.size())
+                    fail("reference to invalid texture coordinate on line %zu!",
+                         line_number);
+
+                mesh.corners.push_back((uint32_t) v - 1);
+                corner_texcoords.push_back((uint32_t) vt);
+                size++;
+            }
+            if (size < 3)
+                fail("face with less than three vertices on line %zu!", line_number);
+            mesh.face_offsets.push_back((uint32_t) mesh.corners.size());
+        }
+    }
+
+    if (mesh.face_count() == 0)
+        fail("the cage contains no faces!");
+
+    // Texture coordinates are only used if all corners reference one
+    bool has_uvs = !texcoords.empty() &&
+                   std::find(corner_texcoords.begin(), corner_texcoords.end(),
+                             0u) == corner_texcoords.end();
+    if (has_uvs) {
+        mesh.corner_uvs.resize(mesh.corners.size());
+        for (size_t c = 0; c < mesh.corners.size(); ++c)
+            mesh.corner_uvs[c] = texcoords[corner_texcoords[c] - 1];
+    }
+
+    return mesh;
+}
+
+static std::mutex subdivision_cache_mutex;
+static std::unordered_map<std::string, std::weak_ptr<const SubdivisionControlMesh>> subdivision_cache;
+/// The most recently used control mesh is kept alive for the next reload
+static std::shared_ptr<const SubdivisionControlMesh> subdivision_cache_last;
+
+/// Subdivide a cage, or look the result up if it was computed before
+static std::shared_ptr<const SubdivisionControlMesh>
+subdivision_open(const fs::path &path, uint32_t levels, bool flip_tex_coords) {
+    std::string key = tfm::format("%s:%u:%i", fs::absolute(path).string(),
+                                  levels, (int) flip_tex_coords);
+    size_t file_size = fs::file_size(path);
+    std::lock_guard<std::mutex> guard(subdivision_cache_mutex);
+
+    std::shared_ptr<const SubdivisionControlMesh> control;
+    auto it = subdivision_cache.find(key);
+    if (it != subdivision_cache.end())
+        control = it->second.lock();
+
+    // Reload cages that were modified in the meantime
+    if (!control || control->file_size != file_size) {
+        SubdivisionPolygons mesh = subdivision_load(path, flip_tex_coords);
+        for (uint32_t i = 0; i < levels; ++i)
+            mesh = subdivision_step(mesh);
+
+        auto result = std::make_shared<SubdivisionControlMesh>();
+        subdivision_limit(mesh, *result);
+        result->file_size = file_size;
+        control = result;
+        subdivision_cache[key] = control;
+    }
+
+    subdivision_cache_last = control;
+    return control;
+}
+
+NAMESPACE_END(detail)
+
+template <typename Float, typename Spectrum>
+class SubdivisionMesh final : public Mesh<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count,
+                   m_face_count, m_vertex_positions, m_vertex_normals,
+                   m_vertex_texcoords, m_faces, m_face_normals, m_quantized,
+                   m_vertex_normals_quantized, m_vertex_texcoords_quantized,
+                   m_area_pmf, m_area_alias, m_parameterization, initialize)
+    MI_IMPORT_TYPES(Texture)
+
+    using typename Base::ScalarSize;
+    using typename Base::InputFloat;
+    using typename Base::FloatStorage;
+    using typename Base::InputPoint3f;
+    using typename Base::InputVector2f;
+    using typename Base::InputVector3f;
+    using typename Base::InputNormal3f;
+    using ControlMesh = detail::SubdivisionControlMesh;
+
+    SubdivisionMesh(const Properties &props) : Base(props) {
+        bool flip_tex_coords = props.get<bool>("flip_tex_coords", true);
+        m_levels = props.get<uint32_t>("levels", 2);
+        m_edge_length = props.get<ScalarFloat>("edge_length", 2.f);
+        m_max_rate = props.get<uint32_t>("max_rate", 32);
+        m_displacement_scale = props.get<ScalarFloat>("displacement_scale", 1.f);
+        if (props.has_property("displacement"))
+            m_displacement = props.texture<Texture>("displacement");
+
+        if (m_levels == 0)
+            Throw("The number of subdivision levels must be at least one!");
+        if (m_max_rate == 0)
+            Throw("The maximum tessellation rate must be at least one!");
+        if (m_edge_length < 0.f)
+            Throw("The target edge length must be non-negative!");
+
+        auto fr = Thread::thread()->file_resolver();
+        fs::path file_path = fr->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        Log(Debug, "Loading subdivision cage from \"%s\" ..", m_name);
+        if (!fs::exists(file_path))
+            Throw("Error while loading subdivision cage \"%s\": file not found",
+                  m_name);
+
+        ScopedPhase phase(ProfilerPhase::LoadGeometry);
+        Timer timer;
+        m_control = detail::subdivision_open(file_path, m_levels, flip_tex_coords);
+
+        if (m_displacement && m_control->quad_uvs.empty())
+            Throw("\"%s\": displacement mapping requires texture coordinates!",
+                  m_name);
+
+        // Control vertices in world space
+        const ScalarTransform4f &to_world = m_to_world.scalar();
+        size_t vertex_count = m_control->vertex_count();
+        m_positions.resize(vertex_count);
+        m_normals.resize(vertex_count);
+        for (size_t v = 0; v < vertex_count; ++v) {
+            m_positions[v] = to_world * ScalarPoint3f(m_control->positions[v]);
+            m_normals[v] = dr::normalize(to_world * ScalarNormal3f(m_control->normals[v]));
+        }
+
+        tessellate(std::vector<uint32_t>(m_control->edge_count(), 1));
+
+        Log(Debug, "\"%s\": subdivided %i times (%i quads, took %s)", m_name,
+            m_levels, m_control->quad_count(),
+            util::time_string((float) timer.value()));
+    }
+
+    bool update_tessellation(const std::vector<ref<Sensor>> &sensors) override {
+        std::vector<uint32_t> rates = edge_rates(sensors);
+        if (rates == m_rates)
+            return false;
+
+        ScopedPhase phase(ProfilerPhase::LoadGeometry);
+        Timer timer;
+        tessellate(rates);
+        Log(Debug, "\"%s\": adaptively tessellated into %i triangles (took %s)",
+            m_name, m_face_count, util::time_string((float) timer.value()));
+        return true;
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SubdivisionMesh[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  levels = " << m_levels << "," << std::endl
+            << "  edge_length = " << m_edge_length << "," << std::endl
+            << "  max_rate = " << m_max_rate << "," << std::endl
+            << "  displacement = " << string::indent(m_displacement) << "," << std::endl
+            << "  vertex_count = " << m_vertex_count << "," << std::endl
+            << "  face_count = " << m_face_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Number of segments of every control edge needed to reach the target edge length
+    std::vector<uint32_t> edge_rates(const std::vector<ref<Sensor>> &sensors) const {
+        size_t edge_count = m_control->edge_count();
+        std::vector<uint32_t> rates(edge_count, 1);
+        if (m_edge_length == 0.f || m_max_rate == 1)
+            return rates;
+
+        /* Footprint of a pixel at distance 'd' from the sensor, estimated from
+           the rays through the film center and its horizontal neighbor */
+        struct Footprint { ScalarPoint3f origin; ScalarFloat offset, angle; };
+        std::vector<Footprint> footprints;
+        for (const Sensor *sensor : sensors) {
+            ScalarVector2f res(sensor->film()->crop_size());
+            auto [ray0, weight0] = sensor->sample_ray(
+                0.f, .5f, Point2f(.5f, .5f), Point2f(.5f, .5f));
+            auto [ray1, weight1] = sensor->sample_ray(
+                0.f, .5f, Point2f(.5f + 1.f / res.x(), .5f), Point2f(.5f, .5f));
+            ScalarPoint3f o0 = dr::slice(ray0.o), o1 = dr::slice(ray1.o);
+            ScalarVector3f d0 = dr::slice(ray0.d), d1 = dr::slice(ray1.d);
+            footprints.push_back({ o0, dr::norm(o1 - o0), dr::unit_angle(d0, d1) });
+        }
+
+        if (footprints.empty())
+            return rates;
+
+        const uint32_t *edges = m_control->edges.data();
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, edge_count, 16384),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t e = range.begin(); e != range.end(); ++e) {
+                    ScalarPoint3f a = m_positions[edges[2 * e]],
+                                  b = m_positions[edges[2 * e + 1]],
+                                  mid = (a + b) * .5f;
+                    ScalarFloat length = dr::norm(b - a), segments = 1.f;
+
+                    for (const Footprint &fp : footprints) {
+                        ScalarFloat size = fp.offset + dr::norm(mid - fp.origin) * fp.angle;
+                        if (size > 0.f)
+                            segments = dr::maximum(segments, length / (size * m_edge_length));
+                    }
+
+                    rates[e] = (uint32_t) dr::clamp(dr::ceil(segments), 1.f,
+                                                    (ScalarFloat) m_max_rate);
+                }
+            }
+        );
+
+        return rates;
+    }
+
+    /// Phong tessellation of a patch with the given interpolation weights
+    ScalarPoint3f phong(const uint32_t *vertices, const ScalarFloat *weights,
+                        size_t count) const {
+        ScalarPoint3f q = 0.f, r = 0.f;
+        for (size_t k = 0; k < count; ++k)
+            q += m_positions[vertices[k]] * weights[k];
+        for (size_t k = 0; k < count; ++k) {
+            const ScalarPoint3f &p = m_positions[vertices[k]];
+            ScalarVector3f n(m_normals[vertices[k]]);
+            r += (q - n * dr::dot(q - p, n)) * weights[k];
+        }
+        return dr::lerp(q, r, PhongShape);
+    }
+
+    ScalarNormal3f interpolate_normal(const uint32_t *vertices,
+                                      const ScalarFloat *weights,
+                                      size_t count) const {
+        ScalarNormal3f n = 0.f;
+        for (size_t k = 0; k < count; ++k)
+            n += m_normals[vertices[k]] * weights[k];
+        return dr::normalize(n);
+    }
+
+    /// Tessellate the control mesh using the given number of segments per edge
+    void tessellate(const std::vector<uint32_t> &rates) {
+        const ControlMesh &cm = *m_control;
+        size_t quad_count = cm.quad_count(), edge_count = cm.edge_count(),
+               slot_count = cm.slot_vertex.size();
+        bool has_uvs = !cm.quad_uvs.empty();
+
+        // Grid resolution of every quad
+        std::unique_ptr<uint32_t[]> grid(new uint32_t[2 * quad_count]);
+        for (size_t f = 0; f < quad_count; ++f) {
+            const uint32_t *e = cm.quad_edges.data() + 4 * f;
+            grid[2 * f + 0] = std::max(rates[e[0]], rates[e[2]]);
+            grid[2 * f + 1] = std::max(rates[e[1]], rates[e[3]]);
+        }
+
+        /* Vertex layout: corner slots, then the edge samples (shared by the
+           faces adjacent to an edge unless it is a texture seam), then the
+           interior vertices of every face */
+        std::unique_ptr<uint32_t[]> edge_offset(new uint32_t[edge_count]),
+                                    corner_offset(new uint32_t[4 * quad_count]),
+                                    interior_offset(new uint32_t[quad_count]),
+                                    triangle_offset(new uint32_t[quad_count + 1]);
+
+        uint64_t vertex_count = slot_count, triangle_count = 0;
+        for (size_t e = 0; e < edge_count; ++e) {
+            edge_offset[e] = (uint32_t) vertex_count;
+            if (!cm.edge_seam[e])
+                vertex_count += rates[e] - 1;
+        }
+        for (size_t c = 0; c < 4 * quad_count; ++c) {
+            uint32_t e = cm.quad_edges[c];
+            if (cm.edge_seam[e]) {
+                corner_offset[c] = (uint32_t) vertex_count;
+                vertex_count += rates[e] - 1;
+            } else {
+                corner_offset[c] = edge_offset[e];
+            }
+        }
+        for (size_t f = 0; f < quad_count; ++f) {
+            uint64_t ru = grid[2 * f], rv = grid[2 * f + 1];
+            interior_offset[f] = (uint32_t) vertex_count;
+            triangle_offset[f] = (uint32_t) triangle_count;
+            vertex_count += (ru - 1) * (rv - 1);
+            triangle_count += 2 * ru * rv;
+        }
+
+        if (vertex_count > 0xFFFFFFFFull || 3 * triangle_count > 0xFFFFFFFFull)
+            Throw("\"%s\": the tessellation is too large, reduce the maximum "
+                  "tessellation rate or increase the target edge length!", m_name);
+        triangle_offset[quad_count] = (uint32_t) triangle_count;
+
+        std::unique_ptr<InputFloat[]> positions(new InputFloat[vertex_count * 3]),
+                                      normals(new InputFloat[vertex_count * 3]),
+                                      texcoords(has_uvs ? new InputFloat[vertex_count * 2] : nullptr);
+        std::unique_ptr<uint32_t[]> faces(new uint32_t[triangle_count * 3]),
+                                    face_counts(new uint32_t[quad_count]);
+
+        auto store = [&](uint32_t index, const ScalarPoint3f &p,
+                         const ScalarNormal3f &n, const ScalarPoint2f &uv) {
+            dr::store(positions.get() + 3 * index, InputPoint3f(p));
+            dr::store(normals.get() + 3 * index, InputNormal3f(n));
+            if (has_uvs)
+                dr::store(texcoords.get() + 2 * index, InputVector2f(uv));
+        };
+
+        for (size_t s = 0; s < slot_count; ++s) {
+            uint32_t v = cm.slot_vertex[s];
+            store((uint32_t) s, m_positions[v], m_normals[v],
+                  has_uvs ? ScalarPoint2f(cm.slot_uvs[s]) : ScalarPoint2f(0.f));
+        }
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, quad_count, 256),
+            [&](const dr::blocked_range<size_t> &range) {
+                std::vector<uint32_t> ids;
+                for (size_t f = range.begin(); f != range.end(); ++f) {
+                    const uint32_t *q = cm.quads.data() + 4 * f;
+                    const ScalarPoint2f uv[4] = {
+                        has_uvs ? ScalarPoint2f(cm.quad_uvs[4 * f + 0]) : ScalarPoint2f(0.f),
+                        has_uvs ? ScalarPoint2f(cm.quad_uvs[4 * f + 1]) : ScalarPoint2f(0.f),
+                        has_uvs ? ScalarPoint2f(cm.quad_uvs[4 * f + 2]) : ScalarPoint2f(0.f),
+                        has_uvs ? ScalarPoint2f(cm.quad_uvs[4 * f + 3]) : ScalarPoint2f(0.f)
+                    };
+
+                    // Edge samples, which are written by the owner of the edge
+                    for (uint32_t k = 0; k < 4; ++k) {
+                        uint32_t c = (uint32_t) (4 * f + k), e = cm.quad_edges[c],
+                                 rate = rates[e];
+                        if (!cm.edge_seam[e] && cm.edge_owner[e] != c)
+                            continue;
+
+                        /* Samples are ordered from the smaller vertex index to
+                           the larger one, which makes the positions of the
+                           copies along texture seams bitwise identical */
+                        bool forward = q[k] < q[(k + 1) & 3];
+                        const uint32_t *endpoints = cm.edges.data() + 2 * e;
+                        ScalarPoint2f uv0 = uv[forward ? k : (k + 1) & 3],
+                                      uv1 = uv[forward ? (k + 1) & 3 : k];
+                        for (uint32_t i = 1; i < rate; ++i) {
+                            ScalarFloat t = (ScalarFloat) i / rate, w[2] = { 1.f - t, t };
+                            store(corner_offset[c] + i - 1, phong(endpoints, w, 2),
+                                  interpolate_normal(endpoints, w, 2),
+                                  dr::lerp(uv0, uv1, t));
+                        }
+                    }
+
+                    uint32_t ru = grid[2 * f], rv = grid[2 * f + 1];
+                    for (uint32_t j = 1; j < rv; ++j) {
+                        for (uint32_t i = 1; i < ru; ++i) {
+                            ScalarFloat u = (ScalarFloat) i / ru, v = (ScalarFloat) j / rv,
+                                        w[4] = { (1.f - u) * (1.f - v), u * (1.f - v),
+                                                 u * v, (1.f - u) * v };
+                            ScalarPoint2f tc = uv[0] * w[0] + uv[1] * w[1] +
+                                               uv[2] * w[2] + uv[3] * w[3];
+                            store(interior_offset[f] + (j - 1) * (ru - 1) + (i - 1),
+                                  phong(q, w, 4), interpolate_normal(q, w, 4), tc);
+                        }
+                    }
+
+                    /* Vertex on the boundary of the face grid: snap to the
+                       closest sample of the (possibly coarser) edge */
+                    auto edge_vertex = [&](uint32_t k, uint32_t i, uint32_t res) {
+                        uint32_t c = (uint32_t) (4 * f + k), rate = rates[cm.quad_edges[c]],
+                                 s = (2 * i * rate + res) / (2 * res);
+                        if (s == 0)
+                            return cm.corner_slots[c];
+                        else if (s == rate)
+                            return cm.corner_slots[4 * f + ((k + 1) & 3)];
+                        bool forward = q[k] < q[(k + 1) & 3];
+                        return corner_offset[c] + (forward ? s : rate - s) - 1;
+                    };
+
+                    ids.resize((size_t) (ru + 1) * (rv + 1));
+                    for (uint32_t j = 0; j <= rv; ++j) {
+                        for (uint32_t i = 0; i <= ru; ++i) {
+                            uint32_t id;
+                            if (j == 0)
+                                id = edge_vertex(0, i, ru);
+                            else if (i == ru)
+                                id = edge_vertex(1, j, rv);
+                            else if (j == rv)
+                                id = edge_vertex(2, ru - i, ru);
+                            else if (i == 0)
+                                id = edge_vertex(3, rv - j, rv);
+                            else
+                                id = interior_offset[f] + (j - 1) * (ru - 1) + (i - 1);
+                            ids[j * (ru + 1) + i] = id;
+                        }
+                    }
+
+                    // Triangulate the grid and drop triangles collapsed by the snapping
+                    uint32_t *out = faces.get() + 3 * (size_t) triangle_offset[f],
+                             count = 0;
+                    auto emit = [&](uint32_t a, uint32_t b, uint32_t c) {
+                        if (a == b || b == c || a == c)
+                            return;
+                        out[3 * count + 0] = a;
+                        out[3 * count + 1] = b;
+                        out[3 * count + 2] = c;
+                        count++;
+                    };
+                    for (uint32_t j = 0; j < rv; ++j) {
+                        for (uint32_t i = 0; i < ru; ++i) {
+                            uint32_t i00 = ids[j * (ru + 1) + i],
+                                     i10 = ids[j * (ru + 1) + i + 1],
+                                     i01 = ids[(j + 1) * (ru + 1) + i],
+                                     i11 = ids[(j + 1) * (ru + 1) + i + 1];
+                            emit(i00, i10, i11);
+                            emit(i00, i11, i01);
+                        }
+                    }
+                    face_counts[f] = count;
+                }
+            }
+        );
+
+        // Compact the triangles of all faces
+        std::unique_ptr<uint32_t[]> compact_offset(new uint32_t[quad_count + 1]);
+        compact_offset[0] = 0;
+        for (size_t f = 0; f < quad_count; ++f)
+            compact_offset[f + 1] = compact_offset[f] + face_counts[f];
+        triangle_count = compact_offset[quad_count];
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, quad_count, 4096),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t f = range.begin(); f != range.end(); ++f) {
+                    if (compact_offset[f] != triangle_offset[f])
+                        memmove(faces.get() + 3 * (size_t) compact_offset[f],
+                                faces.get() + 3 * (size_t) triangle_offset[f],
+                                3 * sizeof(uint32_t) * face_counts[f]);
+                }
+            }
+        );
+
+        if (m_displacement)
+            displace(positions.get(), normals.get(), texcoords.get(), faces.get(),
+                     (ScalarSize) vertex_count, (ScalarSize) triangle_count,
+                     rates, corner_offset.get());
+
+        m_bbox.reset();
+        for (size_t i = 0; i < vertex_count; ++i)
+            m_bbox.expand(ScalarPoint3f(dr::load<InputPoint3f>(positions.get() + 3 * i)));
+
+        m_vertex_count = (ScalarSize) vertex_count;
+        m_face_count = (ScalarSize) triangle_count;
+        m_faces = dr::load<DynamicBuffer<UInt32>>(faces.get(), m_face_count * 3);
+        m_vertex_positions = dr::load<FloatStorage>(positions.get(), m_vertex_count * 3);
+        if (!m_face_normals)
+            m_vertex_normals = dr::load<FloatStorage>(normals.get(), m_vertex_count * 3);
+        if (has_uvs)
+            m_vertex_texcoords = dr::load<FloatStorage>(texcoords.get(), m_vertex_count * 2);
+
+        // Discard data derived from the previous tessellation
+        m_quantized = false;
+        m_vertex_normals_quantized = DynamicBuffer<UInt32>();
+        m_vertex_texcoords_quantized = DynamicBuffer<UInt32>();
+        m_area_pmf = DiscreteDistribution<Float>();
+        m_area_alias = AliasDistribution<Float>();
+        m_parameterization = nullptr;
+        m_rates = rates;
+
+        initialize();
+    }
+
+    /// Offset the tessellated vertices along their normal and recompute the normals
+    void displace(InputFloat *positions, InputFloat *normals,
+                  const InputFloat *texcoords, const uint32_t *faces,
+                  ScalarSize vertex_count, ScalarSize face_count,
+                  const std::vector<uint32_t> &rates,
+                  const uint32_t *corner_offset) const {
+        const ControlMesh &cm = *m_control;
+        std::unique_ptr<float[]> heights(new float[vertex_count]);
+
+        if constexpr (dr::is_jit_v<Float>) {
+            FloatStorage uv_buf = dr::load<FloatStorage>(texcoords, vertex_count * 2);
+            SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>(vertex_count);
+            si.uv = Point2f(dr::gather<Point<dr::replace_scalar_t<Float, InputFloat>, 2>>(
+                uv_buf, dr::arange<UInt32>(vertex_count)));
+            FloatStorage values = FloatStorage(dr::detach(m_displacement->eval_1(si)));
+            auto &&values_host = dr::migrate(values, AllocType::Host);
+            dr::sync_thread();
+            memcpy(heights.get(), values_host.data(), sizeof(float) * vertex_count);
+        } else {
+            for (ScalarSize i = 0; i < vertex_count; ++i) {
+                SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+                si.uv = Point2f(texcoords[2 * i], texcoords[2 * i + 1]);
+                heights[i] = (float) m_displacement->eval_1(si);
+            }
+        }
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, vertex_count, 16384),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    InputPoint3f p = dr::load<InputPoint3f>(positions + 3 * i);
+                    InputVector3f n = dr::load<InputVector3f>(normals + 3 * i);
+                    p += n * (heights[i] * (float) m_displacement_scale);
+                    dr::store(positions + 3 * i, p);
+                }
+            }
+        );
+
+        /* Vertices duplicated along texture seams share the same position and
+           must share the same normal: accumulate into a representative */
+        std::unique_ptr<uint32_t[]> rep(new uint32_t[vertex_count]);
+        for (ScalarSize i = 0; i < vertex_count; ++i)
+            rep[i] = i;
+        std::vector<uint32_t> vertex_slot(cm.vertex_count(), (uint32_t) -1);
+        for (ScalarSize s = 0; s < (ScalarSize) cm.slot_vertex.size(); ++s) {
+            uint32_t &first = vertex_slot[cm.slot_vertex[s]];
+            if (first == (uint32_t) -1)
+                first = s;
+            rep[s] = first;
+        }
+        for (size_t c = 0; c < cm.quad_edges.size(); ++c) {
+            uint32_t e = cm.quad_edges[c];
+            if (!cm.edge_seam[e] || cm.edge_owner[e] == c)
+                continue;
+            for (uint32_t i = 0; i + 1 < rates[e]; ++i)
+                rep[corner_offset[c] + i] = corner_offset[cm.edge_owner[e]] + i;
+        }
+
+        std::unique_ptr<InputNormal3f[]> accum(new InputNormal3f[vertex_count]);
+        for (ScalarSize i = 0; i < vertex_count; ++i)
+            accum[i] = 0.f;
+        for (ScalarSize f = 0; f < face_count; ++f) {
+            const uint32_t *fi = faces + 3 * f;
+            InputPoint3f p0 = dr::load<InputPoint3f>(positions + 3 * fi[0]),
+                         p1 = dr::load<InputPoint3f>(positions + 3 * fi[1]),
+                         p2 = dr::load<InputPoint3f>(positions + 3 * fi[2]);
+            InputNormal3f n = dr::cross(p1 - p0, p2 - p0);
+            for (int k = 0; k < 3; ++k)
+                accum[rep[fi[k]]] += n;
+        }
+        for (ScalarSize i = 0; i < vertex_count; ++i) {
+            InputNormal3f n = accum[rep[i]];
+            float length = dr::norm(n);
+            if (length > 0.f)
+                dr::store(normals + 3 * i, InputNormal3f(n / length));
+        }
+    }
+
+private:
+    /// Shape parameter of the Phong tessellation
+    static constexpr ScalarFloat PhongShape = .75f;
+
+    std::shared_ptr<const ControlMesh> m_control;
+    /// Limit positions and normals of the control vertices in world space
+    std::vector<ScalarPoint3f> m_positions;
+    std::vector<ScalarNormal3f> m_normals;
+    /// Number of segments of every control edge in the current tessellation
+    std::vector<uint32_t> m_rates;
+    ref<Texture> m_displacement;
+    ScalarFloat m_displacement_scale;
+    ScalarFloat m_edge_length;
+    uint32_t m_levels;
+    uint32_t m_max_rate;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SubdivisionMesh, Mesh)
+MI_EXPORT_PLUGIN(SubdivisionMesh, "Subdivision surface")
+NAMESPACE_END(mitsuba)
@@ -1,3 +1,4 @@
+import os
 import pytest
 import drjit as dr
 import mitsuba as mi
@@ -293,3 +294,38 @@ def test08_instancing(variant_llvm_ad_rgb):
 
     assert dr.all(pi1.is_valid())
     assert dr.all(pi2.is_valid())
+
+
+def test09_split_segments(variant_scalar_rgb, tmpdir):
+    # Thin curve running diagonally to all coordinate axes
+    filename = os.path.join(str(tmpdir), "diagonal.txt")
+    with open(filename, "w") as f:
+        for i in range(5):
+            f.write(f"{i} {i} {i + 0.2 * (i % 2)} 0.02\n")
+
+    def load(split_depth):
+        return mi.load_dict({
+            "type" : "scene",
+            "foo" : {
+                "type" : "bsplinecurve",
+                "filename" : filename,
+                "split_depth" : split_depth
+            }
+        })
+
+    s, s_split = load(0), load(3)
+    assert s.shapes()[0].primitive_count() == 2
+    assert s_split.shapes()[0].primitive_count() > 2
+
+    # Splitting must not change the geometry
+    assert dr.allclose(s.bbox().min, s_split.bbox().min, atol=1e-4)
+    assert dr.allclose(s.bbox().max, s_split.bbox().max, atol=1e-4)
+
+    n = 40
+    for x in dr.linspace(Float, 0.5, 3.5, n):
+        for y in dr.linspace(Float, -0.1, 0.1, 5):
+            ray = mi.Ray3f(o=[x + y, x - y, -10], d=[0, 0, 1])
+            si, si_split = s.ray_intersect(ray), s_split.ray_intersect(ray)
+            assert si.is_valid() == si_split.is_valid()
+            if si.is_valid():
+                assert dr.allclose(si.p, si_split.p, atol=1e-3)
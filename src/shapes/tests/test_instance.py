@@ -216,3 +216,107 @@ def test03_ray_intersect_instance(variants_all_rgb, width):
         assert 'instance = nullptr' in str(pi)
     else:
         assert ('instance = [' + '0x0, ' * (width - 1) + '0x0]') in str(pi)
+
+
+@pytest.mark.parametrize("shape", shapes)
+def test04_motion_blur(variants_all_rgb, shape):
+    """Keyframed transformations are interpolated at the time of each ray"""
+    from mitsuba import ScalarTransform4f as T
+
+    keys = [T.translate([0, 0, 0]),
+            T.translate([4, 0, 0]),
+            T.translate([4, 4, 0]) @ T.scale(2)]
+
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'group_0' : {
+            'type' : 'shapegroup',
+            'shape' : shape
+        },
+        'instance' : {
+            'type' : 'instance',
+            'group' : {
+                'type' : 'ref',
+                'id' : 'group_0'
+            },
+            'to_world' : keys[0],
+            'to_world_1' : keys[1],
+            'to_world_2' : keys[2],
+            'motion_begin' : 1.0,
+            'motion_end' : 3.0
+        }
+    })
+
+    assert scene.shapes()[0].has_motion()
+    bbox = scene.bbox()
+    assert dr.allclose([bbox.min.x, bbox.min.y], [-1, -1])
+    assert dr.allclose([bbox.max.x, bbox.max.y], [6, 6])
+
+    def reference(to_world):
+        shape2 = shape.copy()
+        shape2['to_world'] = to_world
+        return mi.load_dict({ 'type' : 'scene', 'shape' : shape2 })
+
+    # Times between and outside of the keyframes
+    times = [0.0, 1.0, 1.5, 2.0, 2.5, 3.0, 4.0]
+    offsets = [[0, 0], [0, 0], [2, 0], [4, 0], [4, 2], [4, 4], [4, 4]]
+    scales = [1, 1, 1, 1, 1.5, 2, 2]
+
+    for time, offset, scale in zip(times, offsets, scales):
+        ref = reference(T.translate([offset[0], offset[1], 0]) @ T.scale(scale))
+        for dx, dy in [[0.1, 0.2], [-0.3, 0.4]]:
+            ray = mi.Ray3f([offset[0] + dx, offset[1] + dy, -12], [0.0, 0.0, 1.0], time, [])
+            si = scene.ray_intersect(ray)
+            si_ref = ref.ray_intersect(ray)
+            assert dr.all(si.is_valid() == si_ref.is_valid())
+            assert dr.allclose(si.t, si_ref.t, atol=1e-4)
+            assert dr.allclose(si.p, si_ref.p, atol=1e-4)
+            assert dr.allclose(si.n, si_ref.n, atol=1e-4)
+
+
+def test05_emitter(variants_all_rgb):
+    from mitsuba import ScalarTransform4f as T
+
+    to_world = T.translate([0.5, -0.2, 1.0]) @ T.rotate([1, 0, 0], 30) @ T.scale([2, 3, 1])
+    emitter = { 'type' : 'area', 'radiance' : { 'type' : 'rgb', 'value' : [1.0, 2.0, 3.0] } }
+
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'group_0' : {
+            'type' : 'shapegroup',
+            'light' : { 'type' : 'rectangle', 'emitter' : emitter },
+            'other' : { 'type' : 'sphere', 'center' : [10, 0, 0], 'radius' : 0.5 }
+        },
+        'instance' : {
+            'type' : 'instance',
+            'group' : { 'type' : 'ref', 'id' : 'group_0' },
+            'to_world' : to_world
+        }
+    })
+
+    ref = mi.load_dict({
+        'type' : 'scene',
+        'light' : { 'type' : 'rectangle', 'to_world' : to_world, 'emitter' : emitter }
+    })
+
+    assert len(scene.emitters()) == 1
+
+    it = dr.zeros(mi.Interaction3f)
+    it.p = [0.3, -1.0, 5.0]
+
+    for sample in [[0.3, 0.6], [0.9, 0.1]]:
+        ds, spec = scene.sample_emitter_direction(it, sample, False)
+        ds_ref, spec_ref = ref.sample_emitter_direction(it, sample, False)
+        assert dr.allclose(ds.p, ds_ref.p, atol=1e-5)
+        assert dr.allclose(ds.n, ds_ref.n, atol=1e-5)
+        assert dr.allclose(ds.pdf, ds_ref.pdf, rtol=1e-4)
+        assert dr.allclose(spec, spec_ref, rtol=1e-4)
+        assert dr.allclose(scene.pdf_emitter_direction(it, ds), ds.pdf, rtol=1e-4)
+
+        # Rays hitting the instance evaluate the emitter of the group
+        si = scene.ray_intersect(mi.Ray3f(it.p, ds.d))
+        assert dr.all(si.is_valid())
+        assert dr.allclose(si.emitter(scene).eval(si), [1.0, 2.0, 3.0])
+
+        ds_hit = mi.DirectionSample3f(scene, si, it)
+        assert dr.allclose(scene.pdf_emitter_direction(it, ds_hit), ds.pdf, rtol=1e-3)
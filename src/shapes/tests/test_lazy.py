@@ -0,0 +1,84 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from os.path import join
+
+
+def write_square(path, z):
+    """Write a PLY file with a unit square at height z"""
+    mesh = mi.Mesh("square", 4, 2)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = [-1, -1, z, 1, -1, z, 1, 1, z, -1, 1, z]
+    params['faces'] = [0, 1, 2, 0, 2, 3]
+    params.update()
+    mesh.write_ply(path)
+    return path
+
+
+def lazy_shape(path, z, **kwargs):
+    d = {
+        "type": "lazy",
+        "filename": path,
+        "bbox_min": [-1, -1, z],
+        "bbox_max": [1, 1, z]
+    }
+    d.update(kwargs)
+    return d
+
+
+def test01_create(variant_scalar_rgb, tmpdir):
+    path = write_square(join(str(tmpdir), "square.ply"), 0.0)
+    s = mi.load_dict(lazy_shape(path, 0.0, to_world=mi.ScalarTransform4f.translate([0, 0, 2])))
+    assert s.primitive_count() == 1
+    assert dr.allclose(s.bbox().min, [-1, -1, 2])
+    assert dr.allclose(s.bbox().max, [1, 1, 2])
+
+
+def test02_invalid(variant_scalar_rgb, tmpdir):
+    path = join(str(tmpdir), "missing.ply")
+    with pytest.raises(RuntimeError, match="does not exist"):
+        mi.load_dict(lazy_shape(path, 0.0))
+
+    path = write_square(join(str(tmpdir), "square.ply"), 0.0)
+    with pytest.raises(RuntimeError, match="emitters or sensors"):
+        mi.load_dict(lazy_shape(path, 0.0, emitter={"type": "area"}))
+
+
+def test03_ray_intersect(variant_scalar_rgb, tmpdir):
+    path = write_square(join(str(tmpdir), "square.ply"), 1.0)
+    scene = mi.load_dict({"type": "scene", "shape": lazy_shape(path, 1.0)})
+
+    ray = mi.Ray3f(o=[0.5, 0.25, 5], d=[0, 0, -1])
+    si = scene.ray_intersect(ray)
+    assert si.is_valid()
+    assert dr.allclose(si.t, 4)
+    assert dr.allclose(si.p, [0.5, 0.25, 1])
+    assert si.shape == scene.shapes()[0]
+    assert scene.ray_test(ray)
+
+    # Rays that miss the mesh (inside and outside of its bounding box)
+    for o in ([2, 0, 5], [0, 0, 0.5]):
+        ray = mi.Ray3f(o=o, d=[0, 0, -1])
+        assert not scene.ray_intersect(ray).is_valid()
+        assert not scene.ray_test(ray)
+
+
+def test04_memory_budget(variant_scalar_rgb, tmpdir):
+    heights = [0.0, 1.0, 2.0]
+    scene = mi.load_dict({
+        "type": "scene",
+        **{
+            "shape_%i" % i: lazy_shape(
+                write_square(join(str(tmpdir), "square_%i.ply" % i), z), z,
+                memory_budget=1e-4)
+            for i, z in enumerate(heights)
+        }
+    })
+
+    # The budget only fits one mesh at a time, which are reloaded as needed
+    for k in range(2):
+        for z in heights:
+            ray = mi.Ray3f(o=[0, 0, z + 0.5], d=[0, 0, -1])
+            si = scene.ray_intersect(ray)
+            assert si.is_valid() and dr.allclose(si.p, [0, 0, z])
@@ -1,3 +1,4 @@
+import os
 import pytest
 import drjit as dr
 import mitsuba as mi
@@ -179,3 +180,33 @@ def test08_instancing(variants_all_rgb):
 
     assert dr.all(pi1.is_valid())
     assert dr.all(pi2.is_valid())
+
+
+def test09_split_segments(variant_scalar_rgb, tmpdir):
+    # Thin curve running diagonally to all coordinate axes
+    filename = os.path.join(str(tmpdir), "diagonal.txt")
+    with open(filename, "w") as f:
+        f.write("0 0 0 0.02\n3 3 3 0.02\n")
+
+    def load(split_depth):
+        return mi.load_dict({
+            "type" : "scene",
+            "foo" : {
+                "type" : "linearcurve",
+                "filename" : filename,
+                "split_depth" : split_depth
+            }
+        })
+
+    s, s_split = load(0), load(3)
+    assert s.shapes()[0].primitive_count() == 1
+    assert s_split.shapes()[0].primitive_count() == 8
+
+    n = 40
+    for x in dr.linspace(Float, 0.1, 2.9, n):
+        for y in dr.linspace(Float, -0.05, 0.05, 5):
+            ray = mi.Ray3f(o=[x + y, x - y, -10], d=[0, 0, 1])
+            si, si_split = s.ray_intersect(ray), s_split.ray_intersect(ray)
+            assert si.is_valid() == si_split.is_valid()
+            if si.is_valid():
+                assert dr.allclose(si.p, si_split.p, atol=1e-3)
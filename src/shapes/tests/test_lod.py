@@ -0,0 +1,99 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from os.path import join
+
+
+def write_grid(path, n):
+    """Write a PLY file with a unit square in the XY plane split into n x n quads"""
+    positions, faces = [], []
+    for j in range(n + 1):
+        for i in range(n + 1):
+            positions += [2 * i / n - 1, 2 * j / n - 1, 0]
+    for j in range(n):
+        for i in range(n):
+            k = j * (n + 1) + i
+            faces += [k, k + 1, k + n + 2, k, k + n + 2, k + n + 1]
+
+    mesh = mi.Mesh("grid", (n + 1) ** 2, 2 * n * n)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = positions
+    params['faces'] = faces
+    params.update()
+    mesh.write_ply(path)
+    return path
+
+
+@pytest.fixture
+def levels(tmpdir):
+    return [write_grid(join(str(tmpdir), "grid_%i.ply" % n), n)
+            for n in (16, 4, 1)]
+
+
+def load_scene(levels, distance):
+    return mi.load_dict({
+        "type": "scene",
+        "shape": {
+            "type": "lod",
+            "level_0": levels[0],
+            "level_1": levels[1],
+            "level_2": levels[2],
+            "thresholds": "100, 10"
+        },
+        "sensor": {
+            "type": "perspective",
+            "fov": 45,
+            "to_world": mi.ScalarTransform4f.look_at(
+                origin=[0, 0, distance], target=[0, 0, 0], up=[0, 1, 0]),
+            "film": {"type": "hdrfilm", "width": 256, "height": 256}
+        }
+    })
+
+
+def test01_create(variant_scalar_rgb, levels):
+    s = mi.load_dict({
+        "type": "lod",
+        "level_0": levels[0],
+        "level_1": levels[1],
+        "level_2": levels[2],
+        "thresholds": "100, 10"
+    })
+
+    # Outside of a scene, the coarsest level is used
+    assert s.face_count() == 2
+    assert dr.allclose(s.bbox().min, [-1, -1, 0])
+    assert dr.allclose(s.bbox().max, [1, 1, 0])
+
+
+def test02_invalid_thresholds(variant_scalar_rgb, levels):
+    with pytest.raises(RuntimeError, match="Expected 2 thresholds"):
+        mi.load_dict({
+            "type": "lod",
+            "level_0": levels[0],
+            "level_1": levels[1],
+            "level_2": levels[2],
+            "thresholds": "100"
+        })
+
+    with pytest.raises(RuntimeError, match="decreasing"):
+        mi.load_dict({
+            "type": "lod",
+            "level_0": levels[0],
+            "level_1": levels[1],
+            "thresholds": "-1"
+        })
+
+
+@pytest.mark.parametrize("distance, face_count", [
+    (3.0, 512), (30.0, 32), (3000.0, 2)
+])
+def test03_selection(variants_all_rgb, levels, distance, face_count):
+    scene = load_scene(levels, distance)
+    shape = scene.shapes()[0]
+    assert shape.face_count() == face_count
+
+    ray = mi.Ray3f(o=[0.1, 0.2, distance], d=[0, 0, -1])
+    si = scene.ray_intersect(ray)
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.t, distance)
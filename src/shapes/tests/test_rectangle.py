@@ -284,3 +284,44 @@ def test09_eval_parameterization(variants_all_ad_rgb):
 
     si_after = shape.eval_parameterization(mi.Point2f(0.3, 0.6))
     assert dr.allclose(si_before.uv, si_after.uv)
+
+
+def test10_sample_direction(variants_vec_rgb):
+    # Directions are sampled uniformly in the solid angle of the rectangle
+    to_world = mi.ScalarTransform4f.translate([0.1, -0.2, 0.3]) @ \
+               mi.ScalarTransform4f.rotate([1, 1, 0], 30) @ \
+               mi.ScalarTransform4f.scale([2, 0.5, 1])
+    shape = mi.load_dict({'type': 'rectangle', 'to_world': to_world})
+    to_object = mi.Transform4f(to_world.inverse())
+
+    n = 100000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    sample = sampler.next_2d()
+
+    for p in [[0.3, 0.2, 0.5], [-1.5, 0.4, -0.3], [4, 3, 2]]:
+        it = dr.zeros(mi.Interaction3f, n)
+        it.p = p
+
+        ds = shape.sample_direction(it, sample)
+        assert dr.allclose(ds.pdf, shape.pdf_direction(it, ds))
+
+        # Sampled points lie on the rectangle
+        local = to_object @ ds.p
+        assert dr.all((dr.abs(local.x) <= 1 + 1e-4) & (dr.abs(local.y) <= 1 + 1e-4))
+        assert dr.allclose(local.z, 0, atol=1e-4)
+
+        # Reference solid angle estimated using area sampling
+        ps = shape.sample_position(0, sample)
+        d = ps.p - it.p
+        dist2 = dr.squared_norm(d)
+        solid_angle = dr.mean(dr.abs_dot(d, ps.n) * dr.rsqrt(dist2) / (dist2 * ps.pdf))
+        assert dr.allclose(ds.pdf, 1.0 / solid_angle, rtol=1e-2)
+
+    # Far away from the rectangle, sampling falls back to area sampling
+    it = dr.zeros(mi.Interaction3f, n)
+    it.p = [300, 0, 400]
+    ds = shape.sample_direction(it, sample)
+    ref = ds.dist**2 / (dr.abs_dot(ds.d, ds.n) * shape.surface_area())
+    assert dr.allclose(ds.pdf, ref, rtol=1e-3)
+    assert dr.allclose(ds.pdf, shape.pdf_direction(it, ds), rtol=1e-3)
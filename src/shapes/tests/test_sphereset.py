@@ -0,0 +1,143 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+import struct
+from os.path import join
+
+from drjit.scalar import ArrayXf as Float
+
+
+SPHERES = [
+    # x, y, z, radius
+    (0.0, 0.0, 0.0, 1.0),
+    (4.0, 0.0, 0.0, 0.5),
+    (0.0, 4.0, 0.0, 2.0),
+]
+
+
+def write_ply(path, spheres, binary=False, radius=True):
+    props = ["x", "y", "z"] + (["radius"] if radius else [])
+    header = "ply\nformat %s 1.0\nelement vertex %i\n" % (
+        "binary_little_endian" if binary else "ascii", len(spheres))
+    header += "".join("property float %s\n" % p for p in props)
+    header += "end_header\n"
+
+    with open(path, "wb") as f:
+        f.write(header.encode())
+        for s in spheres:
+            s = s[:len(props)]
+            if binary:
+                f.write(struct.pack("<%if" % len(props), *s))
+            else:
+                f.write((" ".join(str(v) for v in s) + "\n").encode())
+    return path
+
+
+@pytest.fixture
+def spheres_ply(tmpdir):
+    return write_ply(join(str(tmpdir), "spheres.ply"), SPHERES)
+
+
+def test01_create(variant_scalar_rgb, spheres_ply):
+    s = mi.load_dict({"type": "sphereset", "filename": spheres_ply})
+    assert s is not None
+    assert s.primitive_count() == 3
+
+    area = sum(4 * dr.pi * r * r for (_, _, _, r) in SPHERES)
+    assert dr.allclose(s.surface_area(), area)
+
+    b = s.bbox()
+    assert dr.allclose(b.min, [-1, -1, -1])
+    assert dr.allclose(b.max, [4.5, 6, 2])
+
+    b = s.bbox(1)
+    assert dr.allclose(b.min, [3.5, -0.5, -0.5])
+    assert dr.allclose(b.max, [4.5, 0.5, 0.5])
+
+
+def test02_binary_and_default_radius(variant_scalar_rgb, tmpdir):
+    path = write_ply(join(str(tmpdir), "spheres.ply"), SPHERES,
+                     binary=True, radius=False)
+    s = mi.load_dict({
+        "type": "sphereset",
+        "filename": path,
+        "default_radius": 0.25,
+        "to_world": mi.ScalarTransform4f.scale(2)
+    })
+
+    assert s.primitive_count() == 3
+    assert dr.allclose(s.bbox().min, [-0.5, -0.5, -0.5])
+    assert dr.allclose(s.bbox().max, [8.5, 8.5, 0.5])
+    assert dr.allclose(s.surface_area(), 3 * 4 * dr.pi * 0.25)
+
+
+def test03_missing_property(variant_scalar_rgb, tmpdir):
+    path = join(str(tmpdir), "invalid.ply")
+    with open(path, "w") as f:
+        f.write("ply\nformat ascii 1.0\nelement vertex 1\n"
+                "property float x\nproperty float y\nend_header\n0 0\n")
+
+    with pytest.raises(RuntimeError, match="lacks the \"z\" property"):
+        mi.load_dict({"type": "sphereset", "filename": path})
+
+
+def check_rays(spheres_ply):
+    scene = mi.load_dict({
+        "type": "scene",
+        "shape": {"type": "sphereset", "filename": spheres_ply}
+    })
+
+    # Rays towards the three spheres along the Z axis, and one missing all of them
+    rays = [([0, 0, 5], 4.0, 0), ([4, 0, 5], 4.5, 1), ([0, 4, 5], 3.0, 2),
+            ([2, 2, 5], None, None)]
+
+    for o, t, prim_index in rays:
+        ray = mi.Ray3f(o=o, d=[0, 0, -1])
+        si = scene.ray_intersect(ray)
+        if t is None:
+            assert dr.none(si.is_valid())
+            assert dr.none(scene.ray_test(ray))
+            continue
+
+        assert dr.all(si.is_valid())
+        assert dr.all(scene.ray_test(ray))
+        assert dr.allclose(si.t, t)
+        assert dr.all(si.prim_index == prim_index)
+        assert dr.allclose(si.n, [0, 0, 1])
+        assert dr.allclose(si.p, [o[0], o[1], 5 - t])
+
+
+def test04_ray_intersect(variant_scalar_rgb, spheres_ply):
+    check_rays(spheres_ply)
+
+
+def test05_ray_intersect_vec(variant_llvm_ad_rgb, spheres_ply):
+    check_rays(spheres_ply)
+
+
+def test06_update(variant_scalar_rgb, spheres_ply):
+    scene = mi.load_dict({
+        "type": "scene",
+        "shape": {"type": "sphereset", "filename": spheres_ply}
+    })
+
+    # Replace the spheres by a single one
+    params = mi.traverse(scene)
+    params["shape.center"] = Float([10, 0, 0])
+    params["shape.radius"] = Float([1])
+    params.update()
+
+    shape = scene.shapes()[0]
+    assert shape.primitive_count() == 1
+    assert dr.allclose(shape.surface_area(), 4 * dr.pi)
+
+    ray = mi.Ray3f(o=[10, 0, 5], d=[0, 0, -1])
+    si = scene.ray_intersect(ray)
+    assert si.is_valid() and dr.allclose(si.t, 4)
+
+    assert not scene.ray_test(mi.Ray3f(o=[0, 0, 5], d=[0, 0, -1]))
+
+    params["shape.radius"] = Float([1, 2])
+    with pytest.raises(RuntimeError, match="three center coordinates"):
+        params.update()
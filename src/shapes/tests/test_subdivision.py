@@ -0,0 +1,118 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from os.path import join
+
+
+CUBE_CAGE = """
+v -1 -1 -1
+v  1 -1 -1
+v  1  1 -1
+v -1  1 -1
+v -1 -1  1
+v  1 -1  1
+v  1  1  1
+v -1  1  1
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+f 1/1 4/4 3/3 2/2
+f 5/1 6/2 7/3 8/4
+f 1/1 2/2 6/3 5/4
+f 2/1 3/2 7/3 6/4
+f 3/1 4/2 8/3 7/4
+f 4/1 1/2 5/3 8/4
+"""
+
+
+@pytest.fixture
+def cage(tmpdir):
+    path = join(str(tmpdir), "cube_cage.obj")
+    with open(path, "w") as f:
+        f.write(CUBE_CAGE)
+    return path
+
+
+def test01_create(variant_scalar_rgb, cage):
+    s = mi.load_dict({"type": "subdivision", "filename": cage, "levels": 2})
+    assert s is not None
+
+    # 6 * 4^2 quads, split into two triangles each
+    assert s.face_count() == 192
+    assert s.has_vertex_texcoords()
+
+    # The limit surface of a cube cage is a rounded shape inside of the cage
+    b = s.bbox()
+    assert dr.allclose(b.center(), [0, 0, 0], atol=1e-5)
+    assert dr.all(b.max < 1) and dr.all(b.max > 0.75)
+    assert s.surface_area() < 24
+
+
+def test02_invalid_levels(variant_scalar_rgb, cage):
+    with pytest.raises(RuntimeError, match="at least one"):
+        mi.load_dict({"type": "subdivision", "filename": cage, "levels": 0})
+
+
+def test03_adaptive_rate(variant_scalar_rgb, cage):
+    def load(distance):
+        return mi.load_dict({
+            "type": "scene",
+            "shape": {
+                "type": "subdivision",
+                "filename": cage,
+                "edge_length": 4.0
+            },
+            "sensor": {
+                "type": "perspective",
+                "to_world": mi.ScalarTransform4f.look_at(
+                    origin=[0, 0, distance], target=[0, 0, 0], up=[0, 1, 0]),
+                "film": {"type": "hdrfilm", "width": 256, "height": 256}
+            }
+        })
+
+    near, far = load(3.0), load(300.0)
+    near_count = near.shapes()[0].face_count()
+    far_count = far.shapes()[0].face_count()
+    assert near_count > far_count
+    assert far_count == 192
+
+
+def test04_watertight(variant_scalar_rgb, cage):
+    scene = mi.load_dict({
+        "type": "scene",
+        "shape": {
+            "type": "subdivision",
+            "filename": cage,
+            "edge_length": 1.0,
+            "max_rate": 7
+        },
+        "sensor": {
+            "type": "perspective",
+            "to_world": mi.ScalarTransform4f.look_at(
+                origin=[0.5, 1, 2.5], target=[0, 0, 0], up=[0, 1, 0]),
+            "film": {"type": "hdrfilm", "width": 128, "height": 128}
+        }
+    })
+
+    # Rates differ between neighboring faces, but no ray may escape
+    sampler = mi.load_dict({"type": "independent"})
+    sampler.seed(0)
+    for i in range(1000):
+        d = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+        ray = mi.Ray3f(o=[0, 0, 0], d=d)
+        assert scene.ray_test(ray)
+
+
+def test05_displacement(variant_scalar_rgb, cage):
+    base = mi.load_dict({"type": "subdivision", "filename": cage})
+    s = mi.load_dict({
+        "type": "subdivision",
+        "filename": cage,
+        "displacement": {"type": "uniform", "value": 0.5},
+        "displacement_scale": 0.2
+    })
+
+    assert s.face_count() == base.face_count()
+    assert dr.allclose(s.bbox().max, base.bbox().max + 0.1, atol=1e-3)
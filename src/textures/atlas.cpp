@@ -0,0 +1,386 @@
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/srgb.h>
+#include <mitsuba/render/texture.h>
+#include <drjit/tensor.h>
+#include <drjit/texture.h>
+#include <algorithm>
+#include <numeric>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _texture-atlas:
+
+Texture atlas (:monosp:`atlas`)
+-------------------------------
+
+.. pluginparameters::
+
+ * - instance_0, instance_1, ...
+   - |texture|
+   - Bitmap textures of the merged BSDF instances. They must have the same
+     number of channels.
+
+ * - filter_type
+   - |string|
+   - Filter of the packed bitmaps, either ``bilinear`` (default) or
+     ``nearest``.
+
+ * - wrap_mode
+   - |string|
+   - Wrap mode of the packed bitmaps, i.e. ``repeat`` (default), ``mirror``,
+     or ``clamp``.
+
+ * - accel
+   - |bool|
+   - Use hardware accelerated texture lookups in CUDA mode. (Default: true)
+
+This plugin is used internally when several instances of the same material
+with small bitmap textures are merged into one (see the ``merge_bsdfs``
+property of the scene). It packs the texels of all bitmaps into a single
+texture, surrounding every bitmap with a border of one texel that reproduces
+its wrap mode, and stores the placement and the UV transformation of every
+bitmap in a per-instance buffer. A lookup gathers the entry of the instance
+whose index is stored in the intersected shape, so that a single texture
+evaluation serves all instances.
+
+The texels are copied when the atlas is created, hence changes to the
+parameters of the packed bitmaps aren't reflected by the atlas. It is only
+available in RGB and monochromatic variants. There is usually no reason to
+instantiate it directly.
+
+ */
+
+template <typename Float, typename Spectrum>
+class AtlasTexture final : public Texture<Float, Spectrum> {
+public:
+    MI_IMPORT_TYPES(Texture)
+    using FloatStorage = DynamicBuffer<Float>;
+
+    /// Largest width of the atlas
+    static constexpr uint32_t MaxWidth = 8192;
+
+    /// Number of floats per instance: offset, resolution and to_uv transform
+    static constexpr uint32_t Stride = 10;
+
+    AtlasTexture(const Properties &props) : Texture(props) {
+        if constexpr (is_spectral_v<Spectrum>)
+            Throw("The atlas texture is only supported in RGB and "
+                  "monochromatic variants!");
+
+        std::string filter_type = props.string("filter_type", "bilinear");
+        dr::FilterMode filter_mode;
+        if (filter_type == "nearest")
+            filter_mode = dr::FilterMode::Nearest;
+        else if (filter_type == "bilinear")
+            filter_mode = dr::FilterMode::Linear;
+        else
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\" or "
+                  "\"bilinear\"!", filter_type);
+
+        std::string wrap_mode = props.string("wrap_mode", "repeat");
+        if (wrap_mode == "repeat")
+            m_wrap_mode = dr::WrapMode::Repeat;
+        else if (wrap_mode == "mirror")
+            m_wrap_mode = dr::WrapMode::Mirror;
+        else if (wrap_mode == "clamp")
+            m_wrap_mode = dr::WrapMode::Clamp;
+        else
+            Throw("Invalid wrap mode \"%s\", must be one of: \"repeat\", "
+                  "\"mirror\", or \"clamp\"!", wrap_mode);
+
+        m_accel = props.get<bool>("accel", true);
+
+        // Fetch the texels and UV transformations of all instances
+        std::vector<Tile> tiles;
+        m_mean = 0.f;
+        for (size_t i = 0; ; ++i) {
+            std::string name = "instance_" + std::to_string(i);
+            if (!props.has_property(name))
+                break;
+            ref<Texture> texture = props.texture<Texture>(name);
+
+            ParameterCallback cb;
+            texture->traverse(&cb);
+            if (!cb.data || !cb.to_uv)
+                Throw("The texture \"%s\" is not a bitmap texture!", name);
+
+            Tile tile;
+            tile.res = ScalarVector2u((uint32_t) cb.data->shape(1),
+                                      (uint32_t) cb.data->shape(0));
+            tile.to_uv = *cb.to_uv;
+            if (i == 0)
+                m_channels = (uint32_t) cb.data->shape(2);
+            else if (m_channels != (uint32_t) cb.data->shape(2))
+                Throw("The bitmaps of an atlas must have the same number of "
+                      "channels!");
+
+            auto &&data = dr::migrate(cb.data->array(), AllocType::Host);
+            if constexpr (dr::is_jit_v<Float>)
+                dr::sync_thread();
+            const ScalarFloat *ptr = data.data();
+            tile.texels.assign(ptr, ptr + dr::prod(tile.res) * m_channels);
+
+            tiles.push_back(std::move(tile));
+            m_mean += dr::slice(texture->mean());
+        }
+
+        m_count = (uint32_t) tiles.size();
+        if (m_count == 0)
+            Throw("At least one texture must be specified!");
+        if (m_channels != 1 && m_channels != 3)
+            Throw("Only bitmaps with 1 or 3 channels can be packed into an "
+                  "atlas!");
+        m_mean /= (ScalarFloat) m_count;
+
+        ScalarVector2u size = pack(tiles);
+        std::vector<ScalarFloat> texels((size_t) dr::prod(size) * m_channels, 0.f);
+        std::vector<ScalarFloat> instances(m_count * Stride);
+        for (uint32_t i = 0; i < m_count; ++i) {
+            copy_tile(tiles[i], texels.data(), size.x());
+
+            const auto &m = tiles[i].to_uv.matrix;
+            ScalarFloat entry[Stride] = {
+                (ScalarFloat) tiles[i].offset.x() + 1.f,
+                (ScalarFloat) tiles[i].offset.y() + 1.f,
+                (ScalarFloat) tiles[i].res.x(), (ScalarFloat) tiles[i].res.y(),
+                m(0, 0), m(0, 1), m(0, 2), m(1, 0), m(1, 1), m(1, 2)
+            };
+            std::copy(entry, entry + Stride, instances.begin() + i * Stride);
+        }
+
+        m_inv_size = dr::rcp(ScalarVector2f(size));
+        m_instances = dr::load<FloatStorage>(instances.data(), instances.size());
+
+        size_t shape[3] = { (size_t) size.y(), (size_t) size.x(), m_channels };
+        m_texture = Texture2f(TensorXf(texels.data(), 3, shape), m_accel,
+                              m_accel, filter_mode, dr::WrapMode::Clamp);
+    }
+
+    UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<UnpolarizedSpectrum>();
+
+        if constexpr (is_spectral_v<Spectrum>) {
+            DRJIT_MARK_USED(si);
+            return dr::zeros<UnpolarizedSpectrum>();
+        } else if (m_channels == 1) {
+            return interpolate_1(si, active);
+        } else if constexpr (is_monochromatic_v<Spectrum>) {
+            return luminance(interpolate_3(si, active));
+        } else {
+            return interpolate_3(si, active);
+        }
+    }
+
+    Float eval_1(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Float>();
+
+        if (m_channels == 1)
+            return interpolate_1(si, active);
+        else
+            return luminance(interpolate_3(si, active));
+    }
+
+    Vector2f eval_1_grad(const SurfaceInteraction3f & /* si */, Mask /* active */) const override {
+        return 0.f;
+    }
+
+    Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (m_channels != 3) {
+            DRJIT_MARK_USED(si);
+            Throw("eval_3(): The atlas texture %s was queried for a RGB "
+                  "value, but it is monochromatic!", to_string());
+        }
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Color3f>();
+
+        return interpolate_3(si, active);
+    }
+
+    ScalarVector2i resolution() const override {
+        const size_t *shape = m_texture.shape();
+        return { (int) shape[1], (int) shape[0] };
+    }
+
+    Float mean() const override { return m_mean; }
+
+    bool is_spatially_varying() const override { return true; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "AtlasTexture[" << std::endl
+            << "  count = " << m_count << "," << std::endl
+            << "  resolution = \"" << resolution() << "\"," << std::endl
+            << "  mean = " << m_mean << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Texels of a packed bitmap and its placement in the atlas
+    struct Tile {
+        std::vector<ScalarFloat> texels;
+        ScalarVector2u res;
+        ScalarVector2u offset;
+        ScalarTransform3f to_uv;
+    };
+
+    /// Collects the texels and the UV transformation of a bitmap texture
+    struct ParameterCallback : public TraversalCallback {
+        TensorXf *data = nullptr;
+        ScalarTransform3f *to_uv = nullptr;
+
+        void put_object(const std::string &, Object *, uint32_t) override { }
+
+    protected:
+        void put_parameter_impl(const std::string &name, void *ptr, uint32_t,
+                                const std::type_info &type) override {
+            if (name == "data" && type == typeid(TensorXf))
+                data = (TensorXf *) ptr;
+            else if (name == "to_uv" && type == typeid(ScalarTransform3f))
+                to_uv = (ScalarTransform3f *) ptr;
+        }
+    };
+
+    /**
+     * \brief Place the tiles (including their border) on shelves of
+     * decreasing height and return the resolution of the atlas
+     */
+    ScalarVector2u pack(std::vector<Tile> &tiles) const {
+        std::vector<uint32_t> order(tiles.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return tiles[a].res.y() > tiles[b].res.y();
+        });
+
+        size_t area = 0;
+        uint32_t width = 0;
+        for (const Tile &tile : tiles) {
+            area += (size_t) (tile.res.x() + 2) * (tile.res.y() + 2);
+            width = std::max(width, tile.res.x() + 2);
+        }
+        width = std::max(width, (uint32_t) std::ceil(std::sqrt((double) area)));
+        if (width > MaxWidth)
+            Throw("The %u bitmaps don't fit into a texture atlas!", m_count);
+
+        uint32_t x = 0, y = 0, shelf_height = 0;
+        for (uint32_t i : order) {
+            ScalarVector2u res = tiles[i].res + 2u;
+            if (x + res.x() > width) {
+                x = 0;
+                y += shelf_height;
+                shelf_height = 0;
+            }
+            tiles[i].offset = ScalarVector2u(x, y);
+            x += res.x();
+            shelf_height = std::max(shelf_height, res.y());
+        }
+
+        uint32_t height = y + shelf_height;
+        if (height > MaxWidth)
+            Throw("The %u bitmaps don't fit into a texture atlas!", m_count);
+        return { width, height };
+    }
+
+    /// Copy the texels of a tile and fill its border according to the wrap mode
+    void copy_tile(const Tile &tile, ScalarFloat *texels, uint32_t width) const {
+        auto wrap = [&](int32_t i, int32_t res) {
+            if (m_wrap_mode == dr::WrapMode::Repeat)
+                return (i + res) % res;
+            // The border of mirrored textures repeats the edge texels
+            return std::clamp(i, 0, res - 1);
+        };
+
+        int32_t res_x = (int32_t) tile.res.x(), res_y = (int32_t) tile.res.y();
+        for (int32_t y = -1; y <= res_y; ++y) {
+            for (int32_t x = -1; x <= res_x; ++x) {
+                size_t src = ((size_t) wrap(y, res_y) * res_x + wrap(x, res_x)) * m_channels,
+                       dst = ((size_t) (tile.offset.y() + 1 + y) * width +
+                              (tile.offset.x() + 1 + x)) * m_channels;
+                for (uint32_t c = 0; c < m_channels; ++c)
+                    texels[dst + c] = tile.texels[src + c];
+            }
+        }
+    }
+
+    /// Map the UV coordinates of an instance into the atlas
+    Point2f atlas_uv(const SurfaceInteraction3f &si, Mask active) const {
+        UInt32 index = dr::minimum(UInt32(si.shape->bsdf_index(active)),
+                                   m_count - 1u) * Stride;
+        auto param = [&](uint32_t k) {
+            return dr::gather<Float>(m_instances, index + k, active);
+        };
+
+        Point2f uv(dr::fmadd(param(4), si.uv.x(), dr::fmadd(param(5), si.uv.y(), param(6))),
+                   dr::fmadd(param(7), si.uv.x(), dr::fmadd(param(8), si.uv.y(), param(9))));
+
+        switch (m_wrap_mode) {
+            case dr::WrapMode::Repeat:
+                uv -= dr::floor(uv);
+                break;
+
+            case dr::WrapMode::Mirror: {
+                    Point2f t = uv - 2.f * dr::floor(.5f * uv);
+                    uv = dr::select(t > 1.f, 2.f - t, t);
+                }
+                break;
+
+            default:
+                uv = dr::clamp(uv, 0.f, 1.f);
+                break;
+        }
+
+        Point2f offset(param(0), param(1)), res(param(2), param(3));
+        return dr::fmadd(uv, res, offset) * m_inv_size;
+    }
+
+    MI_INLINE Float interpolate_1(const SurfaceInteraction3f &si, Mask active) const {
+        Point2f uv = atlas_uv(si, active);
+
+        Float out;
+        if (m_accel)
+            m_texture.eval(uv, &out, active);
+        else
+            m_texture.eval_nonaccel(uv, &out, active);
+        return out;
+    }
+
+    MI_INLINE Color3f interpolate_3(const SurfaceInteraction3f &si, Mask active) const {
+        Point2f uv = atlas_uv(si, active);
+
+        Color3f out;
+        if (m_accel)
+            m_texture.eval(uv, out.data(), active);
+        else
+            m_texture.eval_nonaccel(uv, out.data(), active);
+        return out;
+    }
+
+protected:
+    Texture2f m_texture;
+    FloatStorage m_instances;
+    ScalarVector2f m_inv_size;
+    dr::WrapMode m_wrap_mode;
+    uint32_t m_channels;
+    uint32_t m_count;
+    bool m_accel;
+    ScalarFloat m_mean;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(AtlasTexture, Texture)
+MI_EXPORT_PLUGIN(AtlasTexture, "Texture atlas")
+NAMESPACE_END(mitsuba)
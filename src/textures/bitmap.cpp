@@ -1,15 +1,20 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/tilecache.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
 #include <drjit/tensor.h>
 #include <drjit/texture.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -21,7 +26,7 @@ Bitmap texture (:monosp:`bitmap`)
 ---------------------------------
 
 .. pluginparameters::
- :extra-rows: 7
+ :extra-rows: 10
 
  * - filename
    - |string|
@@ -43,6 +48,11 @@ Bitmap texture (:monosp:`bitmap`)
      - ``nearest``: disable filtering and interpolation. In this mode, the plugin
        performs nearest neighbor lookups of texture values.
 
+     - ``trilinear``: precompute a MIP pyramid when loading the texture, and
+       interpolate bilinearly between its two levels that best match the
+       footprint of the lookup. The footprint is estimated from the ray
+       differentials of camera rays; other lookups use the full resolution.
+
  * - wrap_mode
    - |string|
    - Controls the behavior of texture evaluations that fall outside of the
@@ -73,6 +83,35 @@ Bitmap texture (:monosp:`bitmap`)
      cause small differences as hardware interpolation methods typically have a
      loss of precision (not exactly 32-bit arithmetic). (Default: true)
 
+ * - tile_cache
+   - |bool|
+   - Load the image lazily in tiles through a global least-recently-used cache
+     instead of keeping it in memory. This enables scenes whose textures exceed
+     the available memory, and also performs mip-mapped (trilinear) filtering
+     based on the ray differentials of the surface interaction. Only supported in
+     scalar variants. See below for details. (Default: false)
+
+ * - tile_cache_size
+   - |int|
+   - Memory budget of the global tile cache in MiB. The cache is shared by
+     all textures, hence the most recently specified value applies.
+     (Default: 1024)
+
+ * - compression
+   - |string|
+   - Keep the texture in a block-compressed format with 4 bits per texel
+     instead of 32-bit floats per channel, which reduces its memory footprint
+     by 8x (one channel) or 24x (three channels). The following options are
+     available:
+
+     - ``none`` (default): store uncompressed floating point values.
+
+     - ``bc1``: BC1 (DXT1) blocks for textures with three channels.
+
+     - ``bc4``: BC4 blocks for textures with a single channel.
+
+     See below for details.
+
  * - data
    - |tensor|
    - Tensor array containing the texture data.
@@ -94,6 +133,32 @@ These conversions can alternatively be disabled with the :paramtype:`raw` flag,
 e.g. when textured data is already in linear space or does not represent colors
 at all.
 
+When :paramtype:`tile_cache` is enabled, tiled OpenEXR files (optionally with
+stored mip levels) are read tile by tile on demand, and tiles are evicted once
+the memory budget of the cache is exhausted. Other file formats are loaded in
+full resolution, and only their mip levels are cached. Colors are filtered
+before spectral upsampling in this mode, and the texture cannot be importance
+sampled or modified after loading (the ``data`` parameter is not exposed).
+
+Bitmap textures that load the same file with identical :paramtype:`raw`,
+:paramtype:`filter_type`, :paramtype:`wrap_mode` and :paramtype:`accel`
+settings share the converted texels, so that the file is only loaded, converted
+and uploaded to the device once. A texture receives its own copy of the data
+when its ``data`` parameter is modified (e.g. via :py:func:`mitsuba.traverse`),
+hence modifications never affect other instances. In scalar variants, the copy
+is already made when the parameters are traversed. Textures with trilinear
+filtering or compression aren't shared.
+
+When :paramtype:`compression` is specified, the texels are encoded into blocks
+of :math:`4\times 4` texels in the BC1 or BC4 layout when the texture is
+loaded, and every lookup decodes the blocks of the texels it accesses. Colors
+are clamped to :math:`[0, 1]` and quantized to 5-6 bits (BC1) or 8 bits (BC4)
+per block endpoint; unless :paramtype:`raw` is set, the endpoints are stored
+in the sRGB encoding to reduce banding in dark regions. Compressed textures
+only support bilinear and nearest filtering, cannot be importance sampled or
+modified after loading, and are not supported for colors in spectral
+variants (unless :paramtype:`raw` is set).
+
 .. tabs::
     .. code-tab:: xml
         :name: bitmap-texture
@@ -122,7 +187,27 @@ public:
         if (m_transform != ScalarTransform3f())
             dr::make_opaque(m_transform);
 
-        if (props.has_property("bitmap")) {
+        m_tile_cache = props.get<bool>("tile_cache", false);
+        if (m_tile_cache) {
+            if constexpr (dr::is_jit_v<Float>)
+                Throw("The \"tile_cache\" mode of the bitmap texture is only "
+                      "supported in scalar variants!");
+            if (props.has_property("bitmap"))
+                Throw("The \"tile_cache\" mode requires the texture to be "
+                      "loaded from a file (\"filename\").");
+        }
+
+        if (props.has_property("tile_cache_size"))
+            TileCache::instance()->set_memory_budget(
+                (size_t) props.get<uint32_t>("tile_cache_size") << 20);
+
+        fs::path tiled_path, file_path;
+        if (m_tile_cache) {
+            FileResolver* fs = Thread::thread()->file_resolver();
+            tiled_path = fs->resolve(props.string("filename"));
+            m_name = tiled_path.filename().string();
+            Log(Debug, "Opening tiled bitmap texture \"%s\" ..", m_name);
+        } else if (props.has_property("bitmap")) {
             // Creates a Bitmap texture directly from an existing Bitmap object
             if (props.has_property("filename"))
                 Throw("Cannot specify both \"bitmap\" and \"filename\".");
@@ -135,22 +220,22 @@ public:
             m_bitmap = b;
         } else {
             // Creates a Bitmap texture by loading an image from the filesystem
+            // The image is only loaded if its data isn't cached (see below)
             FileResolver* fs = Thread::thread()->file_resolver();
-            fs::path file_path = fs->resolve(props.string("filename"));
+            file_path = fs->resolve(props.string("filename"));
             m_name = file_path.filename().string();
-            Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
-            m_bitmap = new Bitmap(file_path);
         }
 
         std::string filter_mode_str = props.string("filter_type", "bilinear");
         dr::FilterMode filter_mode;
         if (filter_mode_str == "nearest")
             filter_mode = dr::FilterMode::Nearest;
-        else if (filter_mode_str == "bilinear")
+        else if (filter_mode_str == "bilinear" || filter_mode_str == "trilinear")
             filter_mode = dr::FilterMode::Linear;
         else
-            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", or "
-                  "\"bilinear\"!", filter_mode_str);
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", "
+                  "\"bilinear\", or \"trilinear\"!", filter_mode_str);
+        m_mipmap = filter_mode_str == "trilinear" && !m_tile_cache;
 
         std::string wrap_mode_str = props.string("wrap_mode", "repeat");
         typename dr::WrapMode wrap_mode;
@@ -164,6 +249,55 @@ public:
             Throw("Invalid wrap mode \"%s\", must be one of: \"repeat\", "
                   "\"mirror\", or \"clamp\"!", wrap_mode_str);
 
+        m_raw = props.get<bool>("raw", false);
+        m_accel = props.get<bool>("accel", true);
+
+        std::string compression_str = props.string("compression", "none");
+        if (compression_str == "none")
+            m_compression = Compression::None;
+        else if (compression_str == "bc1")
+            m_compression = Compression::BC1;
+        else if (compression_str == "bc4")
+            m_compression = Compression::BC4;
+        else
+            Throw("Invalid compression \"%s\", must be one of: \"none\", "
+                  "\"bc1\", or \"bc4\"!", compression_str);
+
+        if (m_compression != Compression::None && (m_tile_cache || m_mipmap))
+            Throw("Block compression can't be combined with the \"tile_cache\" "
+                  "mode or trilinear filtering!");
+
+        if (m_tile_cache) {
+            init_tiled(tiled_path, filter_mode, wrap_mode);
+            return;
+        }
+
+        /* Textures that load the same file with the same settings share the
+           converted data (also on the device). The pixel format of the
+           converted texels depends on the file, so both candidates are
+           looked up before loading it. */
+        bool cacheable = !file_path.empty() && !m_mipmap &&
+                         m_compression == Compression::None;
+        auto cache_key = [&](Bitmap::PixelFormat pixel_format) {
+            std::ostringstream oss;
+            oss << fs::absolute(file_path).string() << "|" << m_raw << "|"
+                << pixel_format << "|" << struct_type_v<ScalarFloat> << "|"
+                << filter_mode_str << "|" << wrap_mode_str << "|" << m_accel;
+            return oss.str();
+        };
+
+        if (cacheable && (cache_lookup(cache_key(Bitmap::PixelFormat::Y)) ||
+                          cache_lookup(cache_key(Bitmap::PixelFormat::RGB)))) {
+            Log(Debug, "Reusing the data of bitmap texture \"%s\"", m_name);
+            m_shared = true;
+            return;
+        }
+
+        if (!file_path.empty()) {
+            Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
+            m_bitmap = new Bitmap(file_path);
+        }
+
         /* Convert to linear RGB float bitmap, will be converted
            into spectral profile coefficients below (in place) */
         Bitmap::PixelFormat pixel_format = m_bitmap->pixel_format();
@@ -187,15 +321,12 @@ public:
 
         /* Should Mitsuba disable transformations to the stored color data?
            (e.g. sRGB to linear, spectral upsampling, etc.) */
-        m_raw = props.get<bool>("raw", false);
         if (m_raw) {
             /* Don't undo gamma correction in the conversion below.
                This is needed, e.g., for normal maps. */
             m_bitmap->set_srgb_gamma(false);
         }
 
-        m_accel = props.get<bool>("accel", true);
-
         // Convert the image into the working floating point representation
         m_bitmap =
             m_bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
@@ -215,18 +346,58 @@ public:
         size_t pixel_count = m_bitmap->pixel_count();
         bool exceed_unit_range = false;
 
+        /* Load the spectral upsampling model on this thread, since the worker
+           threads of the parallel conversions below lack its file resolver */
+        if (is_spectral_v<Spectrum> && !m_raw && m_bitmap->channel_count() == 3)
+            (void) srgb_model_fetch(ScalarColor3f(0.f));
+
+        /* Build the MIP pyramid from linear values (i.e. before the spectral
+           conversion below, which is done in place) */
+        if (m_mipmap)
+            build_mipmap(ptr, m_bitmap->size(),
+                         (uint32_t) m_bitmap->channel_count(),
+                         is_spectral_v<Spectrum> && !m_raw &&
+                             m_bitmap->channel_count() == 3);
+
         double mean = 0.0;
         if (m_bitmap->channel_count() == 3) {
             if (is_spectral_v<Spectrum> && !m_raw) {
-                for (size_t i = 0; i < pixel_count; ++i) {
-                    ScalarColor3f value = dr::load<ScalarColor3f>(ptr);
-                    if (!all(value >= 0 && value <= 1))
-                        exceed_unit_range = true;
-                    value = srgb_model_fetch(value);
-                    mean += (double) srgb_model_mean(value);
-                    dr::store(ptr, value);
-                    ptr += 3;
-                }
+                /* Convert all texels into spectral upsampling coefficients
+                   once, in parallel. Rendering then only evaluates the
+                   polynomial, without any lookups into the model's table. */
+                const size_t block_size = 16384,
+                             block_count = (pixel_count + block_size - 1) / block_size;
+                std::unique_ptr<double[]> block_mean(new double[block_count]);
+                std::atomic<bool> exceed_unit_range_atomic { false };
+
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, block_count, 1),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        for (size_t b = range.begin(); b != range.end(); ++b) {
+                            size_t start = b * block_size,
+                                   end = std::min(start + block_size, pixel_count);
+                            double sum = 0.0;
+                            bool exceed = false;
+                            for (size_t i = start; i < end; ++i) {
+                                ScalarFloat *p = ptr + 3 * i;
+                                ScalarColor3f value = dr::load<ScalarColor3f>(p);
+                                if (!all(value >= 0 && value <= 1))
+                                    exceed = true;
+                                value = srgb_model_fetch(value);
+                                sum += (double) srgb_model_mean(value);
+                                dr::store(p, value);
+                            }
+                            block_mean[b] = sum;
+                            if (exceed)
+                                exceed_unit_range_atomic = true;
+                        }
+                    }
+                );
+
+                // Sum in a fixed order to keep the result deterministic
+                for (size_t b = 0; b < block_count; ++b)
+                    mean += block_mean[b];
+                exceed_unit_range = exceed_unit_range_atomic;
             } else {
                 for (size_t i = 0; i < pixel_count; ++i) {
                     ScalarColor3f value = dr::load<ScalarColor3f>(ptr);
@@ -256,34 +427,95 @@ public:
 
         m_mean = Float(mean / pixel_count);
 
+        if (m_compression != Compression::None) {
+            init_compressed((const ScalarFloat *) m_bitmap->data(),
+                            m_bitmap->size(), m_bitmap->channel_count(),
+                            filter_mode, wrap_mode);
+            // The uncompressed texels are no longer needed
+            m_bitmap = nullptr;
+            update_memory();
+            return;
+        }
+
         size_t channels = m_bitmap->channel_count();
         ScalarVector2i res = ScalarVector2i(m_bitmap->size());
         size_t shape[3] = { (size_t) res.y(), (size_t) res.x(), channels };
-        m_texture = Texture2f(TensorXf(m_bitmap->data(), 3, shape), m_accel,
-                              m_accel, filter_mode, wrap_mode);
+        m_texture = std::make_shared<Texture2f>(
+            TensorXf(m_bitmap->data(), 3, shape), m_accel, m_accel,
+            filter_mode, wrap_mode);
+
+        // The converted texels are no longer needed
+        m_bitmap = nullptr;
+
+        if (cacheable)
+            cache_insert(cache_key(pixel_format));
+        update_memory();
     }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data",  m_texture.tensor(), +ParamFlags::Differentiable);
+        if (!m_tile_cache && m_compression == Compression::None) {
+            /* Modifications must not affect the textures sharing the data.
+               JIT arrays are reference-counted, hence writes go to an alias
+               of the texels, which is only copied by parameters_changed() if
+               it was modified. Host arrays instead have to be copied now. */
+            m_data_exposed = true;
+            if constexpr (dr::is_jit_v<Float>) {
+                m_data = m_texture->tensor();
+                callback->put_parameter("data", m_data, +ParamFlags::Differentiable);
+            } else {
+                make_unique();
+                callback->put_parameter("data", m_texture->tensor(), +ParamFlags::Differentiable);
+            }
+        }
         callback->put_parameter("to_uv", m_transform,        +ParamFlags::NonDifferentiable);
     }
 
     void
     parameters_changed(const std::vector<std::string> &keys = {}) override {
-        if (keys.empty() || string::contains(keys, "data")) {
-            const size_t channels = m_texture.shape()[2];
+        if (m_tile_cache || m_compression != Compression::None)
+            return;
+
+        // The texels can only have changed if they were exposed by traverse()
+        if (m_data_exposed && (keys.empty() || string::contains(keys, "data"))) {
+            TensorXf &data = dr::is_jit_v<Float> ? m_data : m_texture->tensor();
+            if constexpr (dr::is_jit_v<Float>) {
+                if (!data_modified())
+                    return;
+            }
+
+            const size_t channels = data.shape(2);
             if (channels != 1 && channels != 3)
                 Throw("parameters_changed(): The bitmap texture %s was changed "
                       "to have %d channels, only textures with 1 or 3 channels "
                       "are supported!",
                       to_string(), channels);
-            else if (m_texture.shape()[0] < 2 || m_texture.shape()[1] < 2)
+            else if (data.shape(0) < 2 || data.shape(1) < 2)
                 Throw("parameters_changed(): The bitmap texture %s was changed,"
                       " it must be at least 2x2 pixels in size!",
                       to_string());
 
-            m_texture.set_tensor(m_texture.tensor());
+            // Copy on write: the textures sharing the data keep the old texels
+            if (m_texture.use_count() > 1)
+                m_texture = std::make_shared<Texture2f>(
+                    data, m_accel, m_accel, m_texture->filter_mode(),
+                    m_texture->wrap_mode());
+            else
+                m_texture->set_tensor(data);
+
+            m_shared = false;
             rebuild_internals(true, m_distr2d != nullptr);
+
+            if (m_mipmap) {
+                /* In spectral modes, this averages the stored spectral
+                   upsampling coefficients, which only approximates the
+                   filtered color at coarse levels */
+                auto&& texels = dr::migrate(m_texture->value(), AllocType::Host);
+                if constexpr (dr::is_jit_v<Float>)
+                    dr::sync_thread();
+                build_mipmap(texels.data(), ScalarVector2u(resolution()),
+                             (uint32_t) channels, false);
+            }
+            update_memory();
         }
     }
 
@@ -291,7 +523,7 @@ public:
                              Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        const size_t channels = m_texture.shape()[2];
+        const size_t channels = channel_count();
         if (channels == 3 && is_spectral_v<Spectrum> && m_raw) {
             DRJIT_MARK_USED(si);
             Throw("The bitmap texture %s was queried for a spectrum, but "
@@ -325,7 +557,7 @@ public:
                  Mask active = true) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        const size_t channels = m_texture.shape()[2];
+        const size_t channels = channel_count();
         if (channels == 3 && is_spectral_v<Spectrum> && !m_raw) {
             DRJIT_MARK_USED(si);
             Throw("eval_1(): The bitmap texture %s was queried for a "
@@ -347,7 +579,10 @@ public:
                          Mask active = true) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        const size_t channels = m_texture.shape()[2];
+        if (m_tile_cache || m_compression != Compression::None)
+            NotImplementedError("eval_1_grad");
+
+        const size_t channels = m_texture->shape()[2];
         if (channels == 3 && is_spectral_v<Spectrum> && !m_raw) {
             DRJIT_MARK_USED(si);
             Throw(
@@ -359,7 +594,7 @@ public:
             if (dr::none_or<false>(active))
                 return dr::zeros<Vector2f>();
 
-            if (m_texture.filter_mode() == dr::FilterMode::Linear) {
+            if (m_texture->filter_mode() == dr::FilterMode::Linear) {
                 if constexpr (!dr::is_array_v<Mask>)
                     active = true;
 
@@ -374,9 +609,9 @@ public:
                     fetch_values[3] = &f11;
 
                     if (m_accel)
-                        m_texture.eval_fetch(uv, fetch_values, active);
+                        m_texture->eval_fetch(uv, fetch_values, active);
                     else
-                        m_texture.eval_fetch_nonaccel(uv, fetch_values, active);
+                        m_texture->eval_fetch_nonaccel(uv, fetch_values, active);
                 } else { // 3 channels
                     Color3f v00, v10, v01, v11;
                     dr::Array<Float *, 4> fetch_values;
@@ -386,9 +621,9 @@ public:
                     fetch_values[3] = v11.data();
 
                     if (m_accel)
-                        m_texture.eval_fetch(uv, fetch_values, active);
+                        m_texture->eval_fetch(uv, fetch_values, active);
                     else
-                        m_texture.eval_fetch_nonaccel(uv, fetch_values, active);
+                        m_texture->eval_fetch_nonaccel(uv, fetch_values, active);
 
                     f00 = luminance(v00);
                     f10 = luminance(v10);
@@ -426,7 +661,7 @@ public:
                    Mask active = true) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        const size_t channels = m_texture.shape()[2];
+        const size_t channels = channel_count();
         if (channels != 3) {
             DRJIT_MARK_USED(si);
             Throw("eval_3(): The bitmap texture %s was queried for a RGB "
@@ -451,6 +686,9 @@ public:
         if (dr::none_or<false>(active))
             return { dr::zeros<Point2f>(), dr::zeros<Float>() };
 
+        if (m_tile_cache || m_compression != Compression::None)
+            NotImplementedError("sample_position");
+
         if (!m_distr2d)
             init_distr();
 
@@ -459,13 +697,13 @@ public:
         ScalarVector2i res = resolution();
         ScalarVector2f inv_resolution = dr::rcp(ScalarVector2f(res));
 
-        if (m_texture.filter_mode() == dr::FilterMode::Nearest) {
+        if (m_texture->filter_mode() == dr::FilterMode::Nearest) {
             sample2 = (Point2f(pos) + sample2) * inv_resolution;
         } else {
             sample2 = (Point2f(pos) + 0.5f + warp::square_to_tent(sample2)) *
                       inv_resolution;
 
-            switch (m_texture.wrap_mode()) {
+            switch (m_texture->wrap_mode()) {
                 case dr::WrapMode::Repeat:
                     sample2[sample2 < 0.f] += 1.f;
                     sample2[sample2 > 1.f] -= 1.f;
@@ -490,11 +728,14 @@ public:
         if (dr::none_or<false>(active))
             return dr::zeros<Float>();
 
+        if (m_tile_cache || m_compression != Compression::None)
+            NotImplementedError("pdf_position");
+
         if (!m_distr2d)
             init_distr();
 
         ScalarVector2i res = resolution();
-        if (m_texture.filter_mode() == dr::FilterMode::Linear) {
+        if (m_texture->filter_mode() == dr::FilterMode::Linear) {
             // Scale to bitmap resolution and apply shift
             Point2f uv = dr::fmadd(pos_, res, -.5f);
 
@@ -505,13 +746,13 @@ public:
             Point2f w1 = uv - Point2f(uv_i),
                     w0 = 1.f - w1;
 
-            Float v00 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(0, 0)),
+            Float v00 = m_distr2d->pdf(m_texture->wrap(uv_i + Point2i(0, 0)),
                                        active),
-                  v10 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(1, 0)),
+                  v10 = m_distr2d->pdf(m_texture->wrap(uv_i + Point2i(1, 0)),
                                        active),
-                  v01 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(0, 1)),
+                  v01 = m_distr2d->pdf(m_texture->wrap(uv_i + Point2i(0, 1)),
                                        active),
-                  v11 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(1, 1)),
+                  v11 = m_distr2d->pdf(m_texture->wrap(uv_i + Point2i(1, 1)),
                                        active);
 
             Float v0 = dr::fmadd(w0.x(), v00, w1.x() * v10),
@@ -523,7 +764,7 @@ public:
             Point2f uv = pos_ * res;
 
             // Integer pixel positions for nearest-neighbor interpolation
-            Vector2i uv_i = m_texture.wrap(dr::floor2int<Vector2i>(uv));
+            Vector2i uv_i = m_texture->wrap(dr::floor2int<Vector2i>(uv));
 
             return m_distr2d->pdf(uv_i, active) * dr::prod(res);
         }
@@ -550,20 +791,109 @@ public:
     }
 
     ScalarVector2i resolution() const override {
-        const size_t *shape = m_texture.shape();
+        if (m_tile_cache)
+            return ScalarVector2i(m_tiled->size());
+        if (m_compression != Compression::None)
+            return ScalarVector2i(m_block_res);
+        const size_t *shape = m_texture->shape();
         return { (int) shape[1], (int) shape[0] };
     }
 
+    std::vector<bool> zero_mask() const override {
+        /* Texels can't be related to UV cells through a UV transformation,
+           mipmaps, tiles, or compressed blocks. Black spectral upsampling
+           coefficients don't evaluate to zero either. */
+        if (m_tile_cache || m_mipmap || m_compression != Compression::None ||
+            m_transform != ScalarTransform3f() ||
+            (channel_count() == 3 && is_spectral_v<Spectrum> && !m_raw))
+            return { };
+
+        auto &&data = dr::migrate(m_texture->value(), AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        ScalarVector2i res = resolution();
+        size_t channels = channel_count();
+        std::vector<bool> zero((size_t) dr::prod(res));
+        for (size_t i = 0; i < zero.size(); ++i) {
+            bool value = true;
+            for (size_t c = 0; c < channels; ++c)
+                value &= data.data()[i * channels + c] == 0.f;
+            zero[i] = value;
+        }
+
+        /* Bilinear lookups within a cell also involve the neighboring
+           texels. At the border, consider both the wrapped and the clamped
+           neighbors, which covers all wrap modes. */
+        int radius = m_texture->filter_mode() == dr::FilterMode::Linear ? 1 : 0;
+        std::vector<bool> result(zero.size());
+        for (int y = 0; y < res.y(); ++y) {
+            for (int x = 0; x < res.x(); ++x) {
+                bool value = true;
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    for (int dx = -radius; dx <= radius; ++dx) {
+                        int xc = dr::clamp(x + dx, 0, res.x() - 1),
+                            yc = dr::clamp(y + dy, 0, res.y() - 1),
+                            xw = (x + dx + res.x()) % res.x(),
+                            yw = (y + dy + res.y()) % res.y();
+                        value &= zero[yc * res.x() + xc] && zero[yw * res.x() + xw];
+                    }
+                }
+                result[y * res.x() + x] = value;
+            }
+        }
+
+        return result;
+    }
+
     Float mean() const override { return m_mean; }
 
     bool is_spatially_varying() const override { return true; }
 
+    std::string merge_key() const override {
+        // Only small textures without additional lookup structures are packed
+        if (m_tile_cache || m_mipmap || m_compression != Compression::None ||
+            dr::any(resolution() > (int) AtlasMaxResolution))
+            return "";
+
+        std::ostringstream oss;
+        oss << "bitmap:" << channel_count() << ","
+            << (int) m_texture->filter_mode() << ","
+            << (int) m_texture->wrap_mode() << "," << m_raw;
+        return oss.str();
+    }
+
+    ref<Base> merge_instances(const std::vector<ref<Base>> &textures) const override {
+        Properties props("atlas");
+        size_t texel_count = 0;
+        for (size_t i = 0; i < textures.size(); ++i) {
+            ScalarVector2i res = textures[i]->resolution() + 2;
+            texel_count += (size_t) dr::prod(res);
+            props.set_object("instance_" + std::to_string(i), textures[i].get());
+        }
+        if (texel_count > (size_t) AtlasMaxTexels)
+            return nullptr;
+
+        props.set_string("filter_type",
+            m_texture->filter_mode() == dr::FilterMode::Nearest ? "nearest" : "bilinear");
+        switch (m_texture->wrap_mode()) {
+            case dr::WrapMode::Repeat: props.set_string("wrap_mode", "repeat"); break;
+            case dr::WrapMode::Mirror: props.set_string("wrap_mode", "mirror"); break;
+            default: props.set_string("wrap_mode", "clamp"); break;
+        }
+        props.set_bool("accel", m_accel);
+        return PluginManager::instance()->create_object<Base>(props);
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "BitmapTexture[" << std::endl
             << "  name = \"" << m_name << "\"," << std::endl
             << "  resolution = \"" << resolution() << "\"," << std::endl
             << "  raw = " << (int) m_raw << "," << std::endl
+            << "  compression = " << (m_compression == Compression::BC1 ? "bc1" :
+                                      (m_compression == Compression::BC4 ? "bc4" : "none"))
+            << "," << std::endl
             << "  mean = " << m_mean << "," << std::endl
             << "  transform = " << string::indent(m_transform) << std::endl
             << "]";
@@ -573,6 +903,156 @@ public:
     MI_DECLARE_CLASS()
 
 protected:
+    /// Open the image through the global tile cache (scalar variants only)
+    void init_tiled(const fs::path &filename, dr::FilterMode filter_mode,
+                    dr::WrapMode wrap_mode) {
+        m_tiled = new TiledImage(filename, m_raw);
+        m_tile_bilinear = filter_mode == dr::FilterMode::Linear;
+
+        switch (wrap_mode) {
+            case dr::WrapMode::Repeat: m_tile_wrap = TiledImage::WrapMode::Repeat; break;
+            case dr::WrapMode::Mirror: m_tile_wrap = TiledImage::WrapMode::Mirror; break;
+            default: m_tile_wrap = TiledImage::WrapMode::Clamp; break;
+        }
+
+        if (!m_tiled->is_tiled())
+            Log(Warn, "BitmapTexture: \"%s\" is not a tiled OpenEXR file, "
+                "its full resolution will be kept in memory.", m_name);
+
+        float value[3];
+        m_tiled->mean(value);
+        if (m_tiled->channel_count() == 3) {
+            ScalarColor3f rgb(value[0], value[1], value[2]);
+            if (is_spectral_v<Spectrum> && !m_raw)
+                m_mean = Float(srgb_model_mean(srgb_model_fetch(rgb)));
+            else
+                m_mean = Float(luminance(rgb));
+        } else {
+            m_mean = Float(value[0]);
+        }
+    }
+
+    /// Data of bitmap textures that were loaded from files
+    struct CacheEntry {
+        std::weak_ptr<Texture2f> texture;
+        Float mean;
+    };
+
+    struct Cache {
+        std::mutex mutex;
+        std::unordered_map<std::string, CacheEntry> entries;
+    };
+
+    static Cache &cache() {
+        static Cache cache;
+        return cache;
+    }
+
+    /// Use the cached data of a file (if still referenced by another texture)
+    bool cache_lookup(const std::string &key) {
+        Cache &c = cache();
+        std::lock_guard<std::mutex> guard(c.mutex);
+
+        for (auto it = c.entries.begin(); it != c.entries.end();) {
+            if (it->second.texture.expired())
+                it = c.entries.erase(it);
+            else
+                ++it;
+        }
+
+        auto it = c.entries.find(key);
+        if (it == c.entries.end())
+            return false;
+        m_texture = it->second.texture.lock();
+        m_mean = it->second.mean;
+        return m_texture != nullptr;
+    }
+
+    /// Make the data of this texture available to other instances
+    void cache_insert(const std::string &key) const {
+        Cache &c = cache();
+        std::lock_guard<std::mutex> guard(c.mutex);
+        c.entries[key] = { m_texture, m_mean };
+    }
+
+    /**
+     * \brief Was the alias \ref m_data of the texels assigned or modified
+     * since it was exposed by \ref traverse()? (JIT variants only)
+     */
+    bool data_modified() const {
+        const TensorXf &current = m_texture->tensor();
+        if (m_data.ndim() != current.ndim())
+            return true;
+        for (size_t i = 0; i < m_data.ndim(); ++i) {
+            if (m_data.shape(i) != current.shape(i))
+                return true;
+        }
+        if constexpr (dr::is_diff_v<Float>) {
+            if (m_data.array().index_ad() != current.array().index_ad())
+                return true;
+        }
+        return m_data.array().index() != current.array().index();
+    }
+
+    /// Give this instance its own copy of texture data shared with others
+    void make_unique() {
+        if (m_texture.use_count() > 1)
+            m_texture = std::make_shared<Texture2f>(
+                m_texture->tensor(), m_accel, m_accel,
+                m_texture->filter_mode(), m_texture->wrap_mode());
+        if (m_shared) {
+            m_shared = false;
+            update_memory();
+        }
+    }
+
+    /**
+     * \brief Register the size of the texels with the \ref MemoryTracker
+     *
+     * Data that is shared with other instances loading the same file is only
+     * accounted for by the instance that loaded it.
+     */
+    void update_memory() {
+        size_t size = dr::width(m_mip_data) * sizeof(ScalarFloat) +
+                      dr::width(m_blocks) * sizeof(uint32_t);
+        if (m_texture && !m_shared)
+            size += dr::width(m_texture->value()) * sizeof(ScalarFloat);
+        m_memory.set_bytes(size, dr::is_cuda_v<Float>);
+    }
+
+    /// Return the number of channels of the texture (1 or 3)
+    size_t channel_count() const {
+        if (m_tile_cache)
+            return m_tiled->channel_count();
+        if (m_compression != Compression::None)
+            return m_compression == Compression::BC1 ? 3 : 1;
+        return m_texture->shape()[2];
+    }
+
+    /// Return the wrap mode of the texture
+    dr::WrapMode wrap_mode() const {
+        return m_compression != Compression::None ? m_block_wrap
+                                                  : m_texture->wrap_mode();
+    }
+
+    /**
+     * \brief Evaluate the tiled image with trilinear filtering, using the UV
+     * derivatives of the surface interaction to select the mip level
+     */
+    void eval_tiled(const SurfaceInteraction3f &si, float *out) const {
+        Point2f uv = m_transform.transform_affine(si.uv);
+        ScalarVector2f res(m_tiled->size());
+
+        // Footprint of the lookup in texels of the full-resolution level
+        Vector2f dx = m_transform.transform_affine(Vector2f(si.duv_dx)) * res,
+                 dy = m_transform.transform_affine(Vector2f(si.duv_dy)) * res;
+        float width = (float) dr::maximum(dr::norm(dx), dr::norm(dy));
+        float lod = width > 1.f ? dr::log2(width) : 0.f;
+
+        m_tiled->eval(ScalarPoint2f((float) uv.x(), (float) uv.y()), lod,
+                      m_tile_wrap, m_tile_bilinear, out);
+    }
+
     /**
      * \brief Evaluates the texture at the given surface interaction using
      * spectral upsampling
@@ -582,9 +1062,26 @@ protected:
         if constexpr (!dr::is_array_v<Mask>)
             active = true;
 
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (m_tile_cache) {
+                float out[3];
+                eval_tiled(si, out);
+                ScalarColor3f coeff =
+                    srgb_model_fetch(ScalarColor3f(out[0], out[1], out[2]));
+                return srgb_model_eval<UnpolarizedSpectrum>(coeff, si.wavelengths);
+            }
+        }
+
+        if (m_mipmap)
+            return eval_mip<UnpolarizedSpectrum>(
+                si, [&](const UInt32 &index, const Mask &active_) {
+                    Color3f coeff = dr::gather<Color3f>(m_mip_data, index, active_);
+                    return srgb_model_eval<UnpolarizedSpectrum>(coeff, si.wavelengths);
+                }, active);
+
         Point2f uv = m_transform.transform_affine(si.uv);
 
-        if (m_texture.filter_mode() == dr::FilterMode::Linear) {
+        if (m_texture->filter_mode() == dr::FilterMode::Linear) {
             Color3f v00, v10, v01, v11;
             dr::Array<Float *, 4> fetch_values;
             fetch_values[0] = v00.data();
@@ -593,9 +1090,9 @@ protected:
             fetch_values[3] = v11.data();
 
             if (m_accel)
-                m_texture.eval_fetch(uv, fetch_values, active);
+                m_texture->eval_fetch(uv, fetch_values, active);
             else
-                m_texture.eval_fetch_nonaccel(uv, fetch_values, active);
+                m_texture->eval_fetch_nonaccel(uv, fetch_values, active);
 
             UnpolarizedSpectrum c00, c10, c01, c11, c0, c1;
             c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, si.wavelengths);
@@ -617,9 +1114,9 @@ protected:
         } else {
             Color3f out;
             if (m_accel)
-                m_texture.eval(uv, out.data(), active);
+                m_texture->eval(uv, out.data(), active);
             else
-                m_texture.eval_nonaccel(uv, out.data(), active);
+                m_texture->eval_nonaccel(uv, out.data(), active);
 
             return srgb_model_eval<UnpolarizedSpectrum>(out, si.wavelengths);
         }
@@ -635,13 +1132,33 @@ protected:
         if constexpr (!dr::is_array_v<Mask>)
             active = true;
 
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (m_tile_cache) {
+                float out;
+                eval_tiled(si, &out);
+                return Float(out);
+            }
+        }
+
+        if (m_compression != Compression::None)
+            return eval_compressed<Float>(
+                si, [&](const UInt32 &index, const UInt32 &texel, const Mask &active_) {
+                    return decode_bc4(index, texel, active_);
+                }, active);
+
+        if (m_mipmap)
+            return eval_mip<Float>(
+                si, [&](const UInt32 &index, const Mask &active_) {
+                    return dr::gather<Float>(m_mip_data, index, active_);
+                }, active);
+
         Point2f uv = m_transform.transform_affine(si.uv);
 
         Float out;
         if (m_accel)
-            m_texture.eval(uv, &out, active);
+            m_texture->eval(uv, &out, active);
         else
-            m_texture.eval_nonaccel(uv, &out, active);
+            m_texture->eval_nonaccel(uv, &out, active);
 
         return out;
     }
@@ -656,23 +1173,422 @@ protected:
         if constexpr (!dr::is_array_v<Mask>)
             active = true;
 
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (m_tile_cache) {
+                float out[3];
+                eval_tiled(si, out);
+                return Color3f(out[0], out[1], out[2]);
+            }
+        }
+
+        if (m_compression != Compression::None)
+            return eval_compressed<Color3f>(
+                si, [&](const UInt32 &index, const UInt32 &texel, const Mask &active_) {
+                    return decode_bc1(index, texel, active_);
+                }, active);
+
+        if (m_mipmap)
+            return eval_mip<Color3f>(
+                si, [&](const UInt32 &index, const Mask &active_) {
+                    return dr::gather<Color3f>(m_mip_data, index, active_);
+                }, active);
+
         Point2f uv = m_transform.transform_affine(si.uv);
 
         Color3f out;
         if (m_accel)
-            m_texture.eval(uv, out.data(), active);
+            m_texture->eval(uv, out.data(), active);
         else
-            m_texture.eval_nonaccel(uv, out.data(), active);
+            m_texture->eval_nonaccel(uv, out.data(), active);
 
         return out;
     }
 
+    /**
+     * \brief Build the MIP pyramid by successively box filtering 2x2 texel
+     * blocks, down to a single texel
+     *
+     * When \c convert is set, the filtered RGB values of every level are
+     * converted into spectral upsampling coefficients.
+     */
+    void build_mipmap(const ScalarFloat *data, const ScalarVector2u &res,
+                      uint32_t channels, bool convert) {
+        std::vector<uint32_t> offsets, widths, heights;
+        size_t total = 0;
+        for (ScalarVector2u size = res; ; size = dr::maximum(size / 2u, 1u)) {
+            offsets.push_back((uint32_t) total);
+            widths.push_back(size.x());
+            heights.push_back(size.y());
+            total += (size_t) dr::prod(size);
+            if (dr::all(size == 1u))
+                break;
+        }
+
+        std::unique_ptr<ScalarFloat[]> buf(new ScalarFloat[total * channels]);
+        memcpy(buf.get(), data, (size_t) dr::prod(res) * channels * sizeof(ScalarFloat));
+
+        for (size_t l = 1; l < offsets.size(); ++l) {
+            const ScalarFloat *src = buf.get() + (size_t) offsets[l - 1] * channels;
+            ScalarFloat *dst = buf.get() + (size_t) offsets[l] * channels;
+            uint32_t src_w = widths[l - 1], src_h = heights[l - 1],
+                     dst_w = widths[l];
+
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, heights[l], 16),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                        uint32_t y0 = std::min(2 * y, src_h - 1),
+                                 y1 = std::min(2 * y + 1, src_h - 1);
+                        for (uint32_t x = 0; x < dst_w; ++x) {
+                            uint32_t x0 = std::min(2 * x, src_w - 1),
+                                     x1 = std::min(2 * x + 1, src_w - 1);
+                            for (uint32_t c = 0; c < channels; ++c)
+                                dst[((size_t) y * dst_w + x) * channels + c] =
+                                    .25f * (src[((size_t) y0 * src_w + x0) * channels + c] +
+                                            src[((size_t) y0 * src_w + x1) * channels + c] +
+                                            src[((size_t) y1 * src_w + x0) * channels + c] +
+                                            src[((size_t) y1 * src_w + x1) * channels + c]);
+                        }
+                    }
+                }
+            );
+        }
+
+        if (convert) {
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, total, 4096),
+                [&](const dr::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        ScalarFloat *ptr = buf.get() + i * 3;
+                        dr::store(ptr, srgb_model_fetch(dr::load<ScalarColor3f>(ptr)));
+                    }
+                }
+            );
+        }
+
+        m_mip_levels = (uint32_t) offsets.size();
+        m_mip_data = dr::load<FloatStorage>(buf.get(), total * channels);
+        m_mip_offset = dr::load<DynamicBuffer<UInt32>>(offsets.data(), offsets.size());
+        m_mip_width = dr::load<DynamicBuffer<UInt32>>(widths.data(), widths.size());
+        m_mip_height = dr::load<DynamicBuffer<UInt32>>(heights.data(), heights.size());
+    }
+
+    /// Wrap integer texel coordinates of a MIP level following the wrap mode
+    Vector2i wrap_mip(const Vector2i &p, const Vector2i &size) const {
+        switch (wrap_mode()) {
+            case dr::WrapMode::Repeat:
+                return p - size * dr::floor2int<Vector2i>(Vector2f(p) / Vector2f(size));
+
+            case dr::WrapMode::Mirror: {
+                Vector2i period = 2 * size;
+                Vector2i q = p - period * dr::floor2int<Vector2i>(Vector2f(p) / Vector2f(period));
+                return dr::select(q >= size, period - 1 - q, q);
+            }
+
+            default:
+                return dr::clamp(p, 0, size - 1);
+        }
+    }
+
+    /// Bilinearly interpolate a single level of the MIP pyramid
+    template <typename Value, typename Fetch>
+    Value eval_mip_level(const Point2f &uv, const UInt32 &level,
+                         const Fetch &fetch, const Mask &active) const {
+        UInt32 offset = dr::gather<UInt32>(m_mip_offset, level, active);
+        Vector2i size(Int32(dr::gather<UInt32>(m_mip_width, level, active)),
+                      Int32(dr::gather<UInt32>(m_mip_height, level, active)));
+
+        Point2f p = dr::fmadd(uv, Vector2f(size), -.5f);
+        Vector2i p0 = dr::floor2int<Vector2i>(p);
+        Point2f w1 = p - Point2f(p0), w0 = 1.f - w1;
+
+        Value result = dr::zeros<Value>();
+        for (int i = 0; i < 4; ++i) {
+            Vector2i q = wrap_mip(p0 + Vector2i(i & 1, i >> 1), size);
+            UInt32 index = offset + UInt32(q.y() * size.x() + q.x());
+            Float weight = ((i & 1) ? w1.x() : w0.x()) * ((i >> 1) ? w1.y() : w0.y());
+            result += fetch(index, active) * weight;
+        }
+        return result;
+    }
+
+    /**
+     * \brief Evaluate the MIP pyramid with trilinear filtering, using the UV
+     * partials of the surface interaction (if any) to select the level
+     */
+    template <typename Value, typename Fetch>
+    MI_INLINE Value eval_mip(const SurfaceInteraction3f &si, const Fetch &fetch,
+                             Mask active) const {
+        Point2f uv = m_transform.transform_affine(si.uv);
+
+        Float lod = 0.f;
+        if (si.has_uv_partials()) {
+            ScalarVector2f res(resolution());
+            Vector2f dx = m_transform.transform_affine(si.duv_dx) * res,
+                     dy = m_transform.transform_affine(si.duv_dy) * res;
+            Float width = dr::maximum(dr::norm(dx), dr::norm(dy));
+            lod = dr::minimum(dr::log2(dr::maximum(width, 1.f)),
+                              (ScalarFloat) (m_mip_levels - 1));
+            lod = dr::select(dr::isfinite(lod), lod, 0.f);
+        }
+
+        UInt32 level = dr::floor2int<UInt32>(lod);
+        Float t = lod - Float(level);
+
+        Value v0 = eval_mip_level<Value>(uv, level, fetch, active);
+        Mask blend = active && t > 0.f;
+        if (dr::none_or<false>(blend))
+            return v0;
+
+        UInt32 next = dr::minimum(level + 1, m_mip_levels - 1);
+        Value v1 = eval_mip_level<Value>(uv, next, fetch, blend);
+        return v0 * (1.f - t) + v1 * t;
+    }
+
+    /**
+     * \brief Encode the texels into blocks of 4x4 texels in the BC1 (three
+     * channels) or BC4 (one channel) layout
+     *
+     * Every block occupies two 32-bit words. Texels beyond the edge of the
+     * image replicate the last row/column, and colors are clamped to [0, 1].
+     */
+    void init_compressed(const ScalarFloat *data, const ScalarVector2u &res,
+                         size_t channels, dr::FilterMode filter_mode,
+                         dr::WrapMode wrap_mode) {
+        size_t expected = m_compression == Compression::BC1 ? 3 : 1;
+        if (channels != expected)
+            Throw("BitmapTexture: the \"%s\" compression requires a texture "
+                  "with %zu channel(s), but \"%s\" has %zu!",
+                  m_compression == Compression::BC1 ? "bc1" : "bc4", expected,
+                  m_name, channels);
+        if (is_spectral_v<Spectrum> && channels == 3 && !m_raw)
+            Throw("BitmapTexture: compressed color textures are only supported "
+                  "in spectral variants when \"raw\" is set!");
+
+        m_block_res = res;
+        m_block_count_x = (res.x() + 3) / 4;
+        m_block_wrap = wrap_mode;
+        m_block_bilinear = filter_mode == dr::FilterMode::Linear;
+
+        uint32_t block_count_y = (res.y() + 3) / 4;
+        std::vector<uint32_t> words(2 * (size_t) m_block_count_x * block_count_y);
+        ScalarFloat block[16 * 3];
+        bool clamped = false;
+
+        for (uint32_t by = 0; by < block_count_y; ++by) {
+            for (uint32_t bx = 0; bx < m_block_count_x; ++bx) {
+                for (uint32_t i = 0; i < 16; ++i) {
+                    uint32_t x = std::min(bx * 4 + (i & 3), res.x() - 1),
+                             y = std::min(by * 4 + (i >> 2), res.y() - 1);
+                    for (size_t c = 0; c < channels; ++c) {
+                        ScalarFloat value = data[((size_t) y * res.x() + x) * channels + c];
+                        if (!(value >= 0.f && value <= 1.f))
+                            clamped = true;
+                        value = dr::clamp(value, 0.f, 1.f);
+                        block[i * channels + c] =
+                            m_raw ? value : linear_to_srgb(value);
+                    }
+                }
+
+                uint32_t *out = words.data() + 2 * ((size_t) by * m_block_count_x + bx);
+                if (m_compression == Compression::BC1)
+                    encode_bc1(block, out);
+                else
+                    encode_bc4(block, out);
+            }
+        }
+
+        if (clamped && m_raw)
+            Log(Warn, "BitmapTexture: texture named \"%s\" contains values "
+                "outside of the [0, 1] range, which are clamped by the block "
+                "compression!", m_name);
+
+        m_blocks = dr::load<DynamicBuffer<UInt32>>(words.data(), words.size());
+    }
+
+    /// Encode a block of 4x4 colors along their principal axis (BC1)
+    static void encode_bc1(const ScalarFloat *block, uint32_t *out) {
+        ScalarColor3f mean(0.f);
+        for (uint32_t i = 0; i < 16; ++i)
+            mean += dr::load<ScalarColor3f>(block + 3 * i);
+        mean /= 16.f;
+
+        // Principal axis of the colors via power iteration on the covariance
+        ScalarFloat cov[3][3] = { };
+        for (uint32_t i = 0; i < 16; ++i) {
+            ScalarColor3f d = dr::load<ScalarColor3f>(block + 3 * i) - mean;
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    cov[r][c] += d[r] * d[c];
+        }
+        // Start from the channel with the largest variance
+        int k = 0;
+        for (int r = 1; r < 3; ++r)
+            if (cov[r][r] > cov[k][k])
+                k = r;
+        ScalarColor3f axis(0.f);
+        axis[k] = 1.f;
+        for (int it = 0; it < 8; ++it) {
+            ScalarColor3f next;
+            for (int r = 0; r < 3; ++r)
+                next[r] = cov[r][0] * axis[0] + cov[r][1] * axis[1] + cov[r][2] * axis[2];
+            ScalarFloat norm = dr::norm(next);
+            if (!(norm > 1e-12f)) {
+                axis = ScalarColor3f(0.f);
+                break;
+            }
+            axis = next / norm;
+        }
+
+        ScalarFloat t_min = 0.f, t_max = 0.f;
+        for (uint32_t i = 0; i < 16; ++i) {
+            ScalarFloat t = dr::dot(dr::load<ScalarColor3f>(block + 3 * i) - mean, axis);
+            t_min = std::min(t_min, t);
+            t_max = std::max(t_max, t);
+        }
+
+        // Inset the endpoints to reduce the error of the quantization
+        ScalarFloat inset = (t_max - t_min) / 16.f;
+        uint32_t c0 = pack_565(mean + axis * (t_max - inset)),
+                 c1 = pack_565(mean + axis * (t_min + inset));
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            ScalarColor3f e0 = unpack_565(c0), e1 = unpack_565(c1),
+                          d = e1 - e0;
+            ScalarFloat inv = 1.f / dr::squared_norm(d);
+            for (uint32_t i = 0; i < 16; ++i) {
+                ScalarColor3f value = dr::load<ScalarColor3f>(block + 3 * i);
+                ScalarFloat t = dr::clamp(dr::dot(value - e0, d) * inv, 0.f, 1.f);
+                // Codes of the palette {e0, e1, 2/3 e0 + 1/3 e1, 1/3 e0 + 2/3 e1}
+                const uint32_t codes[4] = { 0, 2, 3, 1 };
+                indices |= codes[(uint32_t) std::lround(t * 3.f)] << (2 * i);
+            }
+        }
+
+        out[0] = c0 | (c1 << 16);
+        out[1] = indices;
+    }
+
+    /// Encode a block of 4x4 scalar values between their extrema (BC4)
+    static void encode_bc4(const ScalarFloat *block, uint32_t *out) {
+        ScalarFloat lo = block[0], hi = block[0];
+        for (uint32_t i = 1; i < 16; ++i) {
+            lo = std::min(lo, block[i]);
+            hi = std::max(hi, block[i]);
+        }
+
+        uint32_t r0 = (uint32_t) std::lround(hi * 255.f),
+                 r1 = (uint32_t) std::lround(lo * 255.f);
+
+        uint64_t indices = 0;
+        if (r0 != r1) {
+            ScalarFloat v0 = r0 / 255.f, v1 = r1 / 255.f;
+            for (uint32_t i = 0; i < 16; ++i) {
+                ScalarFloat t = dr::clamp((v0 - block[i]) / (v0 - v1), 0.f, 1.f);
+                // Codes of the palette {v0, v1, (6 v0 + v1) / 7, ..., (v0 + 6 v1) / 7}
+                uint32_t j = (uint32_t) std::lround(t * 7.f),
+                         code = j == 0 ? 0 : (j == 7 ? 1 : j + 1);
+                indices |= (uint64_t) code << (3 * i);
+            }
+        }
+
+        out[0] = r0 | (r1 << 8) | (uint32_t) ((indices & 0xffffu) << 16);
+        out[1] = (uint32_t) (indices >> 16);
+    }
+
+    static uint32_t pack_565(const ScalarColor3f &c) {
+        ScalarColor3f v = dr::clamp(c, 0.f, 1.f);
+        return ((uint32_t) std::lround(v.r() * 31.f) << 11) |
+               ((uint32_t) std::lround(v.g() * 63.f) << 5) |
+                (uint32_t) std::lround(v.b() * 31.f);
+    }
+
+    template <typename UInt, typename Value = dr::float32_array_t<UInt>>
+    static Color<Value, 3> unpack_565(const UInt &c) {
+        return Color<Value, 3>(Value((c >> 11) & 31u) * (1.f / 31.f),
+                               Value((c >> 5) & 63u) * (1.f / 63.f),
+                               Value(c & 31u) * (1.f / 31.f));
+    }
+
+    static ScalarFloat linear_to_srgb(ScalarFloat v) {
+        return v <= 0.0031308f ? 12.92f * v
+                               : 1.055f * dr::pow(v, 1.f / 2.4f) - 0.055f;
+    }
+
+    template <typename Value> static Value srgb_to_linear(const Value &v) {
+        return dr::select(v <= 0.04045f, v * (1.f / 12.92f),
+                          dr::pow((v + 0.055f) * (1.f / 1.055f), 2.4f));
+    }
+
+    /// Decode the texel at position \c texel (0..15) of a BC1 block
+    Color3f decode_bc1(const UInt32 &index, const UInt32 &texel, const Mask &active) const {
+        UInt32 w0 = dr::gather<UInt32>(m_blocks, 2u * index, active),
+               w1 = dr::gather<UInt32>(m_blocks, 2u * index + 1u, active);
+
+        UInt32 code = (w1 >> (2u * texel)) & 3u;
+        Float t = dr::select(code < 2u, Float(code), Float(code - 1u) * (1.f / 3.f));
+        Color3f value = dr::lerp(unpack_565(w0 & 0xffffu), unpack_565(w0 >> 16), t);
+        return m_raw ? value : srgb_to_linear(value);
+    }
+
+    /// Decode the texel at position \c texel (0..15) of a BC4 block
+    Float decode_bc4(const UInt32 &index, const UInt32 &texel, const Mask &active) const {
+        UInt32 w0 = dr::gather<UInt32>(m_blocks, 2u * index, active),
+               w1 = dr::gather<UInt32>(m_blocks, 2u * index + 1u, active);
+
+        // The 48 index bits start in the upper half of the first word
+        UInt64 bits = UInt64(w0 >> 16) | (UInt64(w1) << 16);
+        UInt32 code = UInt32(bits >> UInt64(3u * texel)) & 7u;
+        Float t = dr::select(code < 2u, Float(code), Float(code - 1u) * (1.f / 7.f));
+
+        Float value = dr::lerp(Float(w0 & 0xffu), Float((w0 >> 8) & 0xffu), t) *
+                      (1.f / 255.f);
+        return m_raw ? value : srgb_to_linear(value);
+    }
+
+    /**
+     * \brief Evaluate the block-compressed texture with nearest or bilinear
+     * filtering, where \c decode returns the texel of a given block
+     */
+    template <typename Value, typename Decode>
+    MI_INLINE Value eval_compressed(const SurfaceInteraction3f &si,
+                                    const Decode &decode, Mask active) const {
+        Point2f uv = m_transform.transform_affine(si.uv);
+        Vector2i size(m_block_res);
+
+        auto fetch = [&](const Vector2i &p) {
+            Vector2u q = Vector2u(wrap_mip(p, size));
+            UInt32 index = (q.y() >> 2) * m_block_count_x + (q.x() >> 2),
+                   texel = ((q.y() & 3u) << 2) | (q.x() & 3u);
+            return decode(index, texel, active);
+        };
+
+        if (!m_block_bilinear)
+            return fetch(dr::floor2int<Vector2i>(uv * Vector2f(size)));
+
+        Point2f p = dr::fmadd(uv, Vector2f(size), -.5f);
+        Vector2i p0 = dr::floor2int<Vector2i>(p);
+        Point2f w1 = p - Point2f(p0), w0 = 1.f - w1;
+
+        Value v00 = fetch(p0),
+              v10 = fetch(p0 + Vector2i(1, 0)),
+              v01 = fetch(p0 + Vector2i(0, 1)),
+              v11 = fetch(p0 + Vector2i(1, 1));
+
+        Value v0 = dr::fmadd(w0.x(), v00, w1.x() * v10),
+              v1 = dr::fmadd(w0.x(), v01, w1.x() * v11);
+        return dr::fmadd(w0.y(), v0, w1.y() * v1);
+    }
+
     /**
      * \brief Recompute mean and 2D sampling distribution (if requested)
      * following an update
      */
     void rebuild_internals(bool init_mean, bool init_distr) {
-        auto&& data = dr::migrate(m_texture.value(), AllocType::Host);
+        auto&& data = dr::migrate(m_texture->value(), AllocType::Host);
 
         if constexpr (dr::is_jit_v<Float>)
             dr::sync_thread();
@@ -686,7 +1602,7 @@ protected:
         size_t pixel_count = (size_t) dr::prod(resolution());
         bool exceed_unit_range = false;
 
-        const size_t channels = m_texture.shape()[2];
+        const size_t channels = m_texture->shape()[2];
         if (channels == 3) {
             std::unique_ptr<ScalarFloat[]> importance_map(
                 init_distr ? new ScalarFloat[pixel_count] : nullptr);
@@ -743,13 +1659,46 @@ protected:
     }
 
 protected:
-    Texture2f m_texture;
+    /// Largest resolution of bitmaps that are packed into a texture atlas
+    static constexpr uint32_t AtlasMaxResolution = 512;
+    /// Largest number of texels of a texture atlas
+    static constexpr uint32_t AtlasMaxTexels = 8192 * 8192;
+
+    std::shared_ptr<Texture2f> m_texture;
     ScalarTransform3f m_transform;
     bool m_accel;
     bool m_raw;
     Float m_mean;
     ref<Bitmap> m_bitmap;
     std::string m_name;
+    /// Does this instance reuse the texels loaded by another one?
+    bool m_shared = false;
+    /// Were the texels exposed by \ref traverse()?
+    bool m_data_exposed = false;
+    /// Alias of the texels exposed by \ref traverse() (JIT variants only)
+    TensorXf m_data;
+    MemoryRecord m_memory { MemoryCategory::Texture };
+
+    // Optional: MIP pyramid for trilinear filtering (levels stored contiguously)
+    bool m_mipmap;
+    uint32_t m_mip_levels = 0;
+    FloatStorage m_mip_data;
+    DynamicBuffer<UInt32> m_mip_offset, m_mip_width, m_mip_height;
+
+    // Optional: block-compressed texels (two words per block of 4x4 texels)
+    enum class Compression { None, BC1, BC4 };
+    Compression m_compression;
+    DynamicBuffer<UInt32> m_blocks;
+    ScalarVector2u m_block_res;
+    uint32_t m_block_count_x = 0;
+    dr::WrapMode m_block_wrap;
+    bool m_block_bilinear;
+
+    // Optional: lazily loaded tiles (scalar variants only)
+    bool m_tile_cache;
+    ref<TiledImage> m_tiled;
+    TiledImage::WrapMode m_tile_wrap;
+    bool m_tile_bilinear;
 
     // Optional: distribution for importance sampling
     mutable std::mutex m_mutex;
@@ -0,0 +1,136 @@
+#include <mitsuba/core/properties.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/texture.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _texture-merged:
+
+Merged constant textures (:monosp:`merged`)
+-------------------------------------------
+
+.. pluginparameters::
+
+ * - instance_0, instance_1, ...
+   - |texture|
+   - Constant textures of the merged BSDF instances.
+
+This plugin is used internally by BSDFs that merge several instances of the
+same material into one (see the ``merge_bsdfs`` property of the scene). It
+stores the values of the constant textures of all instances in a single
+buffer and evaluates the value of the instance whose index is stored in the
+intersected shape, which avoids a separate evaluation per instance.
+
+It is only available in RGB and monochromatic variants, where the value of a
+constant texture doesn't depend on the wavelength. There is usually no reason
+to instantiate it directly.
+
+ */
+
+template <typename Float, typename Spectrum>
+class MergedTexture final : public Texture<Float, Spectrum> {
+public:
+    MI_IMPORT_TYPES(Texture)
+    using FloatStorage = DynamicBuffer<Float>;
+
+    MergedTexture(const Properties &props) : Texture(props) {
+        if constexpr (is_spectral_v<Spectrum>)
+            Throw("The merged texture is only supported in RGB and "
+                  "monochromatic variants!");
+
+        constexpr size_t n_channels = dr::array_size_v<UnpolarizedSpectrum>;
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+
+        std::vector<ScalarFloat> values, values_1;
+        m_mean = 0.f;
+        m_max  = -dr::Infinity<ScalarFloat>;
+        for (size_t i = 0; ; ++i) {
+            std::string name = "instance_" + std::to_string(i);
+            if (!props.has_property(name))
+                break;
+            ref<Texture> texture = props.texture<Texture>(name);
+            if (texture->is_spatially_varying())
+                Throw("Only constant textures can be merged, but \"%s\" is "
+                      "spatially varying!", name);
+
+            UnpolarizedSpectrum value = texture->eval(si);
+            ScalarFloat value_1 = dr::slice(dr::mean(value));
+            try {
+                value_1 = dr::slice(texture->eval_1(si));
+            } catch (const std::exception &) {
+                // Textures without a scalar evaluation use the average channel
+            }
+
+            for (size_t c = 0; c < n_channels; ++c) {
+                values.push_back(dr::slice(value[c]));
+                m_max = dr::maximum(m_max, values.back());
+            }
+            values_1.push_back(value_1);
+            m_mean += value_1;
+        }
+
+        m_count = values_1.size();
+        if (m_count == 0)
+            Throw("At least one texture must be specified!");
+        m_mean /= (ScalarFloat) m_count;
+
+        m_values   = dr::load<FloatStorage>(values.data(), values.size());
+        m_values_1 = dr::load<FloatStorage>(values_1.data(), values_1.size());
+    }
+
+    UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        return dr::gather<UnpolarizedSpectrum>(m_values, instance(si, active), active);
+    }
+
+    Float eval_1(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        return dr::gather<Float>(m_values_1, instance(si, active), active);
+    }
+
+    Vector2f eval_1_grad(const SurfaceInteraction3f & /* si */, Mask /* active */) const override {
+        return 0.f;
+    }
+
+    Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        if constexpr (is_monochromatic_v<Spectrum>)
+            return Color3f(eval_1(si, active));
+        else
+            return eval(si, active);
+    }
+
+    Float mean() const override { return m_mean; }
+
+    ScalarFloat max() const override { return m_max; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MergedTexture[" << std::endl
+            << "  count = " << m_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Index of the merged instance on the intersected shape
+    UInt32 instance(const SurfaceInteraction3f &si, Mask active) const {
+        return dr::minimum(UInt32(si.shape->bsdf_index(active)),
+                           (uint32_t) m_count - 1u);
+    }
+
+protected:
+    FloatStorage m_values;
+    FloatStorage m_values_1;
+    size_t m_count;
+    ScalarFloat m_mean;
+    ScalarFloat m_max;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(MergedTexture, Texture)
+MI_EXPORT_PLUGIN(MergedTexture, "Merged constant textures")
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,320 @@
+#include <mitsuba/render/texture.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/transform.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _texture-noise:
+
+Procedural noise texture (:monosp:`noise`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - color0, color1
+   - |spectrum| or |texture|
+   - Values that are blended according to the noise, which lies in the
+     range :math:`[0, 1]`. (Default: 0 and 1)
+   - |exposed|, |differentiable|
+
+ * - noise_type
+   - |string|
+   - Basis function of the noise. The following options are available:
+
+     - ``perlin`` (default): gradient noise on the integer lattice.
+
+     - ``worley``: distance to the closest of randomly placed feature points,
+       one per lattice cell (cellular noise).
+
+ * - octaves
+   - |int|
+   - Number of octaves of fractal Brownian motion (fBm) that are summed.
+     (Default: 1, i.e. a single octave)
+
+ * - lacunarity
+   - |float|
+   - Frequency ratio between successive octaves. (Default: 2)
+
+ * - gain
+   - |float|
+   - Amplitude ratio between successive octaves. (Default: 0.5)
+
+ * - warp
+   - |float|
+   - Strength of the domain warping, which offsets the lookup position by a
+     vector of Perlin noise before evaluating the noise. (Default: 0)
+
+ * - seed
+   - |int|
+   - Seed of the hash function that generates the lattice. (Default: 0)
+
+ * - coordinates
+   - |string|
+   - Domain of the noise, either ``uv`` (default) for the texture
+     coordinates of the surface, or ``position`` for the 3D position of the
+     surface interaction.
+
+ * - to_uv
+   - |transform|
+   - Specifies an optional 3x3 UV transformation matrix when evaluating the
+     noise in UV space. A 4x4 matrix can also be provided. In that case, the
+     last row and columns will be ignored. (Default: none)
+   - |exposed|
+
+ * - to_world
+   - |transform|
+   - Specifies an optional transformation from the noise space to world
+     space when evaluating the noise on 3D positions. (Default: none)
+
+This plugin evaluates procedural noise on the fly in every variant, which
+avoids baking procedural variation into large bitmaps. The lattice is
+generated by an integer hash function of the cell coordinates, so the
+evaluation only consists of arithmetic operations and vectorizes well. The
+noise has unit frequency, i.e. one lattice cell per unit length of the UV
+or position coordinates; use the transformations to set its scale.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: noise-texture
+
+        <texture type="noise">
+            <string name="noise_type" value="perlin"/>
+            <integer name="octaves" value="6"/>
+            <float name="warp" value="0.5"/>
+            <string name="coordinates" value="position"/>
+            <transform name="to_world">
+                <scale value="10"/>
+            </transform>
+            <rgb name="color0" value="0.1, 0.2, 0.05"/>
+            <rgb name="color1" value="0.5, 0.4, 0.3"/>
+        </texture>
+
+    .. code-tab:: python
+
+        'type': 'noise',
+        'noise_type': 'perlin',
+        'octaves': 6,
+        'warp': 0.5,
+        'coordinates': 'position',
+        'to_world': mi.ScalarTransform4f.scale(10),
+        'color0': [0.1, 0.2, 0.05],
+        'color1': [0.5, 0.4, 0.3]
+
+ */
+
+template <typename Float, typename Spectrum>
+class NoiseTexture final : public Texture<Float, Spectrum> {
+public:
+    MI_IMPORT_TYPES(Texture)
+
+    enum class NoiseType { Perlin, Worley };
+
+    NoiseTexture(const Properties &props) : Texture(props) {
+        m_color0 = props.texture<Texture>("color0", 0.f);
+        m_color1 = props.texture<Texture>("color1", 1.f);
+
+        std::string noise_type = props.string("noise_type", "perlin");
+        if (noise_type == "perlin")
+            m_noise_type = NoiseType::Perlin;
+        else if (noise_type == "worley")
+            m_noise_type = NoiseType::Worley;
+        else
+            Throw("Invalid noise type \"%s\", must be one of: \"perlin\" or "
+                  "\"worley\"!", noise_type);
+
+        m_octaves = props.get<uint32_t>("octaves", 1);
+        if (m_octaves < 1 || m_octaves > 16)
+            Throw("The number of octaves must be between 1 and 16!");
+        m_lacunarity = props.get<ScalarFloat>("lacunarity", 2.f);
+        m_gain = props.get<ScalarFloat>("gain", .5f);
+        m_warp = props.get<ScalarFloat>("warp", 0.f);
+        m_seed = props.get<uint32_t>("seed", 0);
+
+        std::string coordinates = props.string("coordinates", "uv");
+        if (coordinates == "uv")
+            m_use_position = false;
+        else if (coordinates == "position")
+            m_use_position = true;
+        else
+            Throw("Invalid coordinates \"%s\", must be one of: \"uv\" or "
+                  "\"position\"!", coordinates);
+
+        m_transform = props.get<ScalarTransform4f>("to_uv", ScalarTransform4f()).extract();
+        m_to_local = props.get<ScalarTransform4f>("to_world", ScalarTransform4f()).inverse();
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        callback->put_parameter("to_uv", m_transform,    +ParamFlags::NonDifferentiable);
+        callback->put_object("color0",   m_color0.get(), +ParamFlags::Differentiable);
+        callback->put_object("color1",   m_color1.get(), +ParamFlags::Differentiable);
+    }
+
+    UnpolarizedSpectrum eval(const SurfaceInteraction3f &it, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        Float t = noise(it);
+        return dr::lerp(m_color0->eval(it, active), m_color1->eval(it, active), t);
+    }
+
+    Float eval_1(const SurfaceInteraction3f &it, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        Float t = noise(it);
+        return dr::lerp(m_color0->eval_1(it, active), m_color1->eval_1(it, active), t);
+    }
+
+    Color3f eval_3(const SurfaceInteraction3f &it, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        Float t = noise(it);
+        return dr::lerp(m_color0->eval_3(it, active), m_color1->eval_3(it, active), t);
+    }
+
+    Float mean() const override {
+        return .5f * (m_color0->mean() + m_color1->mean());
+    }
+
+    bool is_spatially_varying() const override { return true; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "NoiseTexture[" << std::endl
+            << "  noise_type = " << (m_noise_type == NoiseType::Perlin ? "perlin" : "worley") << "," << std::endl
+            << "  octaves = " << m_octaves << "," << std::endl
+            << "  lacunarity = " << m_lacunarity << "," << std::endl
+            << "  gain = " << m_gain << "," << std::endl
+            << "  warp = " << m_warp << "," << std::endl
+            << "  seed = " << m_seed << "," << std::endl
+            << "  coordinates = " << (m_use_position ? "position" : "uv") << "," << std::endl
+            << "  color0 = " << string::indent(m_color0) << "," << std::endl
+            << "  color1 = " << string::indent(m_color1) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Evaluate the noise in the range [0, 1] at a surface interaction
+    Float noise(const SurfaceInteraction3f &it) const {
+        Point3f p;
+        if (m_use_position) {
+            p = m_to_local.transform_affine(it.p);
+        } else {
+            Point2f uv = m_transform.transform_affine(it.uv);
+            p = Point3f(uv.x(), uv.y(), 0.f);
+        }
+
+        if (m_warp != 0.f)
+            p += m_warp * Vector3f(perlin(p + Vector3f(17.1f, 3.7f, 9.2f), m_seed + 1u),
+                                   perlin(p + Vector3f(5.3f, 11.9f, 1.4f), m_seed + 2u),
+                                   perlin(p + Vector3f(8.6f, 2.2f, 13.5f), m_seed + 3u));
+
+        // Fractal Brownian motion, normalized by the total amplitude
+        Float sum = 0.f;
+        ScalarFloat amplitude = 1.f, frequency = 1.f, norm = 0.f;
+        for (uint32_t i = 0; i < m_octaves; ++i) {
+            Float value;
+            if (m_noise_type == NoiseType::Perlin)
+                value = dr::fmadd(perlin(p * frequency, m_seed + 4u * i), .5f, .5f);
+            else
+                value = worley(p * frequency, m_seed + 4u * i);
+            sum = dr::fmadd(value, amplitude, sum);
+            norm += amplitude;
+            amplitude *= m_gain;
+            frequency *= m_lacunarity;
+        }
+
+        return dr::clamp(sum / norm, 0.f, 1.f);
+    }
+
+    /// Integer hash of lattice cell coordinates (based on Chris Wellons' lowbias32)
+    static UInt32 hash(const Point3i &c, uint32_t seed) {
+        UInt32 h = (UInt32(c.x()) * 0x8da6b343u) ^ (UInt32(c.y()) * 0xd8163841u) ^
+                   (UInt32(c.z()) * 0xcb1ab31fu) ^ seed;
+        h ^= (h >> 16); h *= 0x7feb352du;
+        h ^= (h >> 15); h *= 0x846ca68bu;
+        h ^= (h >> 16);
+        return h;
+    }
+
+    /// Dot product of the offset with one of 12 cube edge gradients (Perlin 2002)
+    static Float gradient(const UInt32 &h, const Vector3f &d) {
+        UInt32 k = h & 15u;
+        Float u = dr::select(k < 8u, d.x(), d.y()),
+              v = dr::select(k < 4u, d.y(),
+                             dr::select(dr::eq(k, 12u) || dr::eq(k, 14u), d.x(), d.z()));
+        return dr::select(dr::eq(k & 1u, 0u), u, -u) +
+               dr::select(dr::eq(k & 2u, 0u), v, -v);
+    }
+
+    /// Gradient noise with values in the range [-1, 1]
+    static Float perlin(const Point3f &p, uint32_t seed) {
+        Point3f pf = dr::floor(p);
+        Point3i pi = Point3i(pf);
+        Vector3f d = p - pf;
+
+        // Quintic interpolation weights
+        Vector3f w = d * d * d * dr::fmadd(d, dr::fmadd(d, 6.f, -15.f), 10.f);
+
+        Float value[2][2][2];
+        for (int z = 0; z < 2; ++z)
+            for (int y = 0; y < 2; ++y)
+                for (int x = 0; x < 2; ++x)
+                    value[z][y][x] = gradient(
+                        hash(pi + Vector3i(x, y, z), seed),
+                        d - Vector3f((float) x, (float) y, (float) z));
+
+        Float v00 = dr::lerp(value[0][0][0], value[0][0][1], w.x()),
+              v01 = dr::lerp(value[0][1][0], value[0][1][1], w.x()),
+              v10 = dr::lerp(value[1][0][0], value[1][0][1], w.x()),
+              v11 = dr::lerp(value[1][1][0], value[1][1][1], w.x());
+
+        return dr::lerp(dr::lerp(v00, v01, w.y()), dr::lerp(v10, v11, w.y()), w.z());
+    }
+
+    /// Distance to the closest feature point, clamped to the range [0, 1]
+    static Float worley(const Point3f &p, uint32_t seed) {
+        Point3f pf = dr::floor(p);
+        Point3i pi = Point3i(pf);
+        Vector3f d = p - pf;
+
+        Float dist2 = dr::Infinity<Float>;
+        for (int z = -1; z <= 1; ++z) {
+            for (int y = -1; y <= 1; ++y) {
+                for (int x = -1; x <= 1; ++x) {
+                    Vector3i offset(x, y, z);
+                    UInt32 h = hash(pi + offset, seed);
+
+                    // Feature point of the cell from three bytes of the hash
+                    Vector3f feature(Float(h & 0xffu), Float((h >> 8) & 0xffu),
+                                     Float((h >> 16) & 0xffu));
+                    feature = dr::fmadd(feature, 1.f / 255.f, Vector3f(offset));
+
+                    dist2 = dr::minimum(dist2, dr::squared_norm(feature - d));
+                }
+            }
+        }
+
+        return dr::minimum(dr::sqrt(dist2), 1.f);
+    }
+
+protected:
+    ref<Texture> m_color0;
+    ref<Texture> m_color1;
+    NoiseType m_noise_type;
+    uint32_t m_octaves;
+    ScalarFloat m_lacunarity;
+    ScalarFloat m_gain;
+    ScalarFloat m_warp;
+    uint32_t m_seed;
+    bool m_use_position;
+    ScalarTransform3f m_transform;
+    ScalarTransform4f m_to_local;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(NoiseTexture, Texture)
+MI_EXPORT_PLUGIN(NoiseTexture, "Procedural noise texture")
+NAMESPACE_END(mitsuba)
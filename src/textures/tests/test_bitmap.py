@@ -230,3 +230,168 @@ def test05_eval_spectral(variants_vec_backends_once_spectral):
     expected = 0.5394
     assert dr.allclose(expected, spec, atol=1e-04)
     assert dr.allclose(expected, mono, atol=1e-04)
+
+
+@fresolver_append_path
+def test06_tile_cache(variant_scalar_rgb, np_rng):
+    # Lookups through the tile cache should match the in-memory texture at the
+    # finest mip level, and fall back to coarser levels for wide footprints
+    filename = 'resources/data/common/textures/carrot.png'
+    reference = mi.load_dict({ 'type' : 'bitmap', 'filename' : filename })
+    tiled = mi.load_dict({
+        'type' : 'bitmap',
+        'filename' : filename,
+        'tile_cache' : True
+    })
+
+    assert dr.all(reference.resolution() == tiled.resolution())
+    assert dr.allclose(reference.mean(), tiled.mean(), rtol=1e-1)
+
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    for uv in np_rng.random((20, 2)):
+        si.uv = mi.Point2f(uv)
+        assert dr.allclose(reference.eval_3(si), tiled.eval_3(si), atol=1e-4)
+
+    cache = mi.TileCache.instance()
+    misses = cache.misses()
+    si.duv_dx = [1, 0]
+    si.duv_dy = [0, 1]
+    assert dr.allclose(tiled.eval_3(si), tiled.eval_3(si))
+    assert cache.misses() > misses
+
+    with pytest.raises(RuntimeError):
+        tiled.sample_position(mi.Point2f(0.5))
+
+
+@fresolver_append_path
+def test07_trilinear(variants_all_rgb, np_rng):
+    # Without UV partials, trilinear lookups use the full resolution level.
+    # Wide footprints should select the coarsest (constant) level.
+    filename = 'resources/data/common/textures/carrot.png'
+    bilinear = mi.load_dict({ 'type' : 'bitmap', 'filename' : filename })
+    trilinear = mi.load_dict({
+        'type' : 'bitmap',
+        'filename' : filename,
+        'filter_type' : 'trilinear'
+    })
+
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    for uv in np_rng.random((10, 2)):
+        si.uv = mi.Point2f(uv)
+        assert dr.allclose(bilinear.eval_3(si), trilinear.eval_3(si), atol=1e-3)
+
+    si.duv_dx = mi.Vector2f(1, 0)
+    si.duv_dy = mi.Vector2f(0, 1)
+    si.uv = mi.Point2f(0.1, 0.2)
+    value = trilinear.eval_3(si)
+    si.uv = mi.Point2f(0.7, 0.4)
+    assert dr.allclose(value, trilinear.eval_3(si))
+    assert dr.allclose(mi.luminance(value), bilinear.mean(), rtol=1e-1)
+
+
+@pytest.mark.parametrize('filter_type', ['nearest', 'bilinear'])
+@pytest.mark.parametrize('wrap_mode', ['repeat', 'clamp', 'mirror'])
+def test08_compression(variants_all_rgb, np_rng, filter_type, wrap_mode):
+    import numpy as np
+
+    # Smooth ramps, which are well approximated by the block palettes
+    y, x = np.meshgrid(np.linspace(0, 1, 16), np.linspace(0, 1, 18), indexing='ij')
+    rgb = np.stack([x, y, 1 - 0.5 * (x + y)], axis=-1).astype(np.float32)
+    mono = (0.5 * (x + y))[..., None].astype(np.float32)
+
+    si = dr.zeros(mi.SurfaceInteraction3f, 1000)
+    uv = np_rng.random((2, 1000)) * 3 - 1
+    si.uv = mi.Point2f(mi.Float(uv[0]), mi.Float(uv[1]))
+
+    for data, compression, eval_fn, atol in [(rgb, 'bc1', 'eval_3', 0.06),
+                                             (mono, 'bc4', 'eval_1', 0.03)]:
+        params = {
+            'type': 'bitmap',
+            'bitmap': mi.Bitmap(data),
+            'raw': True,
+            'filter_type': filter_type,
+            'wrap_mode': wrap_mode
+        }
+        reference = mi.load_dict(params)
+        compressed = mi.load_dict(dict(params, compression=compression))
+
+        assert dr.all(reference.resolution() == compressed.resolution())
+        assert 'data' not in mi.traverse(compressed)
+        assert dr.allclose(getattr(compressed, eval_fn)(si),
+                           getattr(reference, eval_fn)(si), atol=atol)
+
+    with pytest.raises(RuntimeError):
+        mi.load_dict({'type': 'bitmap', 'bitmap': mi.Bitmap(rgb),
+                      'compression': 'bc4'})
+
+
+@fresolver_append_path
+def test09_compression_srgb(variants_vec_backends_once_rgb, np_rng):
+    # The endpoints of color textures are stored in the sRGB encoding
+    import numpy as np
+    filename = 'resources/data/common/textures/carrot.png'
+    reference = mi.load_dict({'type': 'bitmap', 'filename': filename})
+    compressed = mi.load_dict({'type': 'bitmap', 'filename': filename,
+                               'compression': 'bc1'})
+
+    si = dr.zeros(mi.SurfaceInteraction3f, 10000)
+    uv = np_rng.random((2, 10000))
+    si.uv = mi.Point2f(mi.Float(uv[0]), mi.Float(uv[1]))
+    error = np.abs(np.array(compressed.eval_3(si)) - np.array(reference.eval_3(si)))
+    assert np.mean(error) < 0.02
+    assert dr.allclose(reference.mean(), compressed.mean())
+
+    with pytest.raises(RuntimeError):
+        compressed.sample_position(mi.Point2f(0.5))
+
+
+@fresolver_append_path
+def test10_shared_data(variants_all_rgb, np_rng):
+    # Textures loading the same file with the same settings share their data
+    filename = 'resources/data/common/textures/carrot.png'
+    texture_1 = mi.load_dict({'type': 'bitmap', 'filename': filename})
+    texture_2 = mi.load_dict({'type': 'bitmap', 'filename': filename})
+    texture_raw = mi.load_dict({'type': 'bitmap', 'filename': filename,
+                                'raw': True})
+
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    for uv in np_rng.random((10, 2)):
+        si.uv = mi.Point2f(uv)
+        assert dr.allclose(texture_1.eval_3(si), texture_2.eval_3(si))
+    assert dr.allclose(texture_1.mean(), texture_2.mean())
+    assert not dr.allclose(texture_1.mean(), texture_raw.mean())
+
+    # Modifying one of them doesn't affect the other
+    value = texture_1.eval_3(si)
+    params = mi.traverse(texture_2)
+    params['data'] = dr.full(mi.TensorXf, 0.25, params['data'].shape)
+    params.update()
+    assert dr.allclose(texture_2.eval_3(si), 0.25)
+    assert dr.allclose(texture_1.eval_3(si), value)
+
+
+@fresolver_append_path
+def test11_shared_data_traverse(variants_vec_rgb):
+    def usage():
+        return sum(mi.MemoryTracker.usage(mi.MemoryCategory.Texture))
+
+    # Traversing shared textures doesn't copy their data
+    filename = 'resources/data/common/textures/carrot.png'
+    texture_1 = mi.load_dict({'type': 'bitmap', 'filename': filename})
+    before = usage()
+    texture_2 = mi.load_dict({'type': 'bitmap', 'filename': filename})
+    assert usage() == before
+
+    params_1, params_2 = mi.traverse(texture_1), mi.traverse(texture_2)
+    params_2.update()
+    assert usage() == before
+
+    # The data is copied once it is modified
+    size = dr.width(params_2['data'].array) * 4
+    params_2['data'] = params_2['data'] * 0.5
+    params_2.update()
+    assert usage() == before + size
+
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    si.uv = mi.Point2f(0.3, 0.6)
+    assert dr.allclose(texture_2.eval_3(si), texture_1.eval_3(si) * 0.5)
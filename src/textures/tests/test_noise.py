@@ -0,0 +1,105 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def random_interaction(n, seed=0, scale=8):
+    rng = np.random.default_rng(seed)
+    si = dr.zeros(mi.SurfaceInteraction3f, n)
+    uv = rng.uniform(-scale, scale, size=(2, n))
+    p = rng.uniform(-scale, scale, size=(3, n))
+    si.uv = mi.Point2f(mi.Float(uv[0]), mi.Float(uv[1]))
+    si.p = mi.Point3f(mi.Float(p[0]), mi.Float(p[1]), mi.Float(p[2]))
+    return si
+
+
+@pytest.mark.parametrize('noise_type', ['perlin', 'worley'])
+@pytest.mark.parametrize('octaves', [1, 5])
+@pytest.mark.parametrize('coordinates', ['uv', 'position'])
+def test01_range(variants_vec_rgb, noise_type, octaves, coordinates):
+    texture = mi.load_dict({
+        'type': 'noise',
+        'noise_type': noise_type,
+        'octaves': octaves,
+        'warp': 0.5,
+        'coordinates': coordinates
+    })
+
+    value = texture.eval_1(random_interaction(10000))
+    values = np.array(value)
+    assert np.all(values >= 0) and np.all(values <= 1)
+
+    # The noise actually varies and doesn't saturate
+    assert np.max(values) - np.min(values) > 0.15
+    assert 0.2 < np.mean(values) < 0.8
+
+    # The color values are blended according to the noise
+    texture = mi.load_dict({
+        'type': 'noise',
+        'noise_type': noise_type,
+        'octaves': octaves,
+        'warp': 0.5,
+        'coordinates': coordinates,
+        'color0': {'type': 'rgb', 'value': [1, 0, 0.5]},
+        'color1': {'type': 'rgb', 'value': [0, 1, 0.5]}
+    })
+    color = texture.eval_3(random_interaction(10000))
+    assert dr.allclose(color.x, 1 - value, atol=1e-5)
+    assert dr.allclose(color.y, value, atol=1e-5)
+    assert dr.allclose(color.z, 0.5)
+
+
+def test02_perlin_lattice(variants_vec_rgb):
+    # Gradient noise vanishes at the lattice points, i.e. the texture
+    # evaluates to 0.5 there
+    texture = mi.load_dict({'type': 'noise'})
+
+    si = dr.zeros(mi.SurfaceInteraction3f, 100)
+    x, y = np.meshgrid(np.arange(-5, 5), np.arange(-5, 5))
+    si.uv = mi.Point2f(mi.Float(x.ravel()), mi.Float(y.ravel()))
+    assert dr.allclose(texture.eval_1(si), 0.5, atol=1e-5)
+
+
+@pytest.mark.parametrize('noise_type', ['perlin', 'worley'])
+def test03_continuity(variants_vec_rgb, noise_type):
+    texture = mi.load_dict({
+        'type': 'noise',
+        'noise_type': noise_type,
+        'octaves': 3,
+        'coordinates': 'position'
+    })
+
+    si = random_interaction(10000, seed=1)
+    value = texture.eval_1(si)
+    si.p += mi.Vector3f(1e-3, -1e-3, 1e-3)
+    assert dr.allclose(texture.eval_1(si), value, atol=2e-2)
+
+
+def test04_seed_and_transform(variants_vec_rgb):
+    si = random_interaction(1000, seed=2)
+
+    # Different seeds produce different noise
+    a = mi.load_dict({'type': 'noise', 'seed': 0}).eval_1(si)
+    b = mi.load_dict({'type': 'noise', 'seed': 1}).eval_1(si)
+    assert np.mean(np.abs(np.array(a) - np.array(b))) > 0.01
+
+    # Scaling the UV coordinates changes the frequency of the noise
+    c = mi.load_dict({
+        'type': 'noise',
+        'to_uv': mi.ScalarTransform4f.scale([0.5, 0.5, 1])
+    })
+    si_half = mi.SurfaceInteraction3f(si)
+    si_half.uv *= 2
+    assert dr.allclose(c.eval_1(si_half), a, atol=1e-4)
+
+    # The position domain is placed by the to_world transformation
+    d = mi.load_dict({
+        'type': 'noise',
+        'coordinates': 'position',
+        'to_world': mi.ScalarTransform4f.translate([1, 2, 3])
+    })
+    si_shifted = mi.SurfaceInteraction3f(si)
+    si_shifted.p += mi.Vector3f(1, 2, 3)
+    e = mi.load_dict({'type': 'noise', 'coordinates': 'position'})
+    assert dr.allclose(d.eval_1(si_shifted), e.eval_1(si), atol=1e-4)
@@ -52,3 +52,21 @@ def test03_eval_3(variants_vec_backends_once_rgb, tmpdir):
     ref_values = mi.Color3f([0.9, 0.0, 0.0], [0.4, 0.0, 0.0], [0.2, 0.0, 0.0])
     assert dr.allclose(texture.eval_3(si), ref_values)
     assert dr.allclose(texture.max(), 0.9)
+
+
+def test04_max_per_cell(variants_all_rgb, tmpdir):
+    tmp_file = os.path.join(str(tmpdir), "out.vol")
+    grid = dr.zeros(mi.TensorXf, [8, 8, 8])
+    grid[:, :, 7] = 2.0
+    grid[0, 0, 0] = 0.5
+    mi.VolumeGrid(grid).write(tmp_file)
+    volume = mi.load_dict({'type': 'gridvolume', 'filename': tmp_file})
+
+    # Cells are stored in z-major order, and 'x' is the fastest axis
+    values = volume.max_per_cell([2, 2, 2])
+    assert dr.allclose(values, [0.5, 2.0, 0.0, 2.0, 0.0, 2.0, 0.0, 2.0])
+
+    # With wrap-around lookups, boundary cells use the global maximum
+    volume = mi.load_dict({'type': 'gridvolume', 'filename': tmp_file,
+                           'wrap_mode': 'repeat'})
+    assert dr.allclose(volume.max_per_cell([2, 2, 2]), 2.0)
@@ -1,4 +1,5 @@
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/memory.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
@@ -7,7 +8,9 @@
 #include <mitsuba/render/volume.h>
 #include <mitsuba/render/volumegrid.h>
 #include <drjit/dynamic.h>
+#include <drjit/half.h>
 #include <drjit/texture.h>
+#include <nanothread/nanothread.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -69,9 +72,32 @@ Grid-based volume data source (:monosp:`gridvolume`)
      cause small differences as hardware interpolation methods typically have a
      loss of precision (not exactly 32-bit arithmetic). (Default: true)
 
+ * - layout
+   - |string|
+   - Memory layout of the voxels used for lookups. The following options are
+     currently available:
+
+     - ``linear`` (default): look up voxels in the z-y-x order of the file.
+
+     - ``bricked``: additionally store the voxels in bricks of
+       :math:`8^3` voxels (see below).
+
+ * - storage
+   - |string|
+   - Format used to store the voxels (see below). The following options are
+     currently available:
+
+     - ``float32`` (default): single precision.
+
+     - ``float16``: half precision.
+
+     - ``uint8``: 8-bit fixed point, with an offset and a scale per channel
+       that map the range of the values of each channel onto 256 levels.
+
  * - data
    - |tensor|
-   - Tensor array containing the grid data.
+   - Tensor array containing the grid data (only when :paramtype:`storage` is
+     ``float32``).
    - |exposed|, |differentiable|
 
 This class implements access to volume data stored on a 3D grid using a
@@ -113,6 +139,38 @@ little endian encoding and is specified as follows:
        :code:`data[((zpos*yres + ypos)*xres + xpos)*channels + chan]`
        where (xpos, ypos, zpos, chan) denotes the lookup location.
 
+Version 4 of the format has the same header and stores the voxels in
+independently compressed bricks, which are decompressed in parallel while the
+file is loaded. Such files are written by :code:`mi.VolumeGrid.write(path,
+brick_size=...)`. After byte 48, the file contains the brick resolution
+:math:`B` (32 bit integer), the maximum of each channel (single precision),
+and a table with an entry per brick (in z-major order) consisting of the
+offset of the brick in the payload (64 bit integer), its compressed size in
+bytes (32 bit integer) and the minimum and maximum of its voxels (single
+precision). The payload follows: every brick stores its (at most
+:math:`B^3`) voxels in the order given above, compressed using zlib. The
+value bounds of the bricks are used to compute tight majorants without
+visiting the voxels.
+
+In the linear layout, the eight voxels of a trilinear lookup are spread over
+four rows of the grid, which are far apart in memory for large volumes. The
+steps of delta tracking along a ray therefore cause many cache misses on the
+CPU. The ``bricked`` layout instead stores the voxels of every block of
+:math:`8^3` voxels contiguously, so that consecutive lookups along a ray mostly
+hit the same few cache lines. This requires a second copy of the volume data,
+which is kept in sync when the ``data`` parameter changes. On the GPU, the
+linear layout should be preferred, since it uses hardware-accelerated texture
+lookups when :paramtype:`accel` is enabled.
+
+Density grids rarely need single precision. The ``float16`` and ``uint8``
+storage formats reduce the memory used by the voxels by a factor of 2 and 4,
+which also makes lookups more cache-friendly. The voxels are then packed into
+32-bit words and decoded after every fetch, on the CPU and on the GPU (the
+hardware texture units are not used, and :paramtype:`accel` has no effect).
+Such volumes can't be edited or differentiated, and they don't expose the
+:paramtype:`data` parameter. The 8-bit format is too coarse for the
+coefficients of spectral upsampling, which should use ``float16`` instead.
+
 .. tabs::
     .. code-tab:: xml
 
@@ -151,6 +209,13 @@ public:
     MI_IMPORT_BASE(Volume, update_bbox, m_to_local, m_bbox, m_channel_count)
     MI_IMPORT_TYPES(VolumeGrid)
 
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Base-2 logarithm of the edge length of the bricks of the bricked layout
+    static constexpr int BrickShift = 3;
+    static constexpr int BrickSize  = 1 << BrickShift;
+
     GridVolume(const Properties &props) : Base(props) {
         std::string filter_type_str = props.string("filter_type", "trilinear");
         dr::FilterMode filter_mode;
@@ -198,6 +263,29 @@ public:
 
         m_accel = props.get<bool>("accel", true);
 
+        std::string layout = props.string("layout", "linear");
+        if (layout == "bricked")
+            m_bricked = true;
+        else if (layout == "linear")
+            m_bricked = false;
+        else
+            Throw("Invalid layout \"%s\", must be one of: \"linear\" or "
+                  "\"bricked\"!", layout);
+
+        std::string storage = props.string("storage", "float32");
+        if (storage == "float32")
+            m_storage = Storage::Float32;
+        else if (storage == "float16")
+            m_storage = Storage::Float16;
+        else if (storage == "uint8")
+            m_storage = Storage::UInt8;
+        else
+            Throw("Invalid storage format \"%s\", must be one of: "
+                  "\"float32\", \"float16\", or \"uint8\"!", storage);
+
+        m_filter_mode = filter_mode;
+        m_wrap_mode = wrap_mode;
+
         ScalarVector3i res = m_volume_grid->size();
         ScalarUInt32 size = dr::prod(res);
 
@@ -232,8 +320,11 @@ public:
                 (size_t) res.x(),
                 4
             };
-            m_texture = Texture3f(TensorXf(scaled_data.get(), 4, shape),
-                                  m_accel, m_accel, filter_mode, wrap_mode);
+            if (m_storage == Storage::Float32)
+                m_texture = Texture3f(TensorXf(scaled_data.get(), 4, shape),
+                                      m_accel, m_accel, filter_mode, wrap_mode);
+            else
+                m_max = quantize(scaled_data.get(), shape)[3];
         } else {
             size_t shape[4] = {
                 (size_t) res.z(),
@@ -241,12 +332,23 @@ public:
                 (size_t) res.x(),
                 m_volume_grid->channel_count()
             };
-            m_texture = Texture3f(TensorXf(m_volume_grid->data(), 4, shape),
-                                  m_accel, m_accel, filter_mode, wrap_mode);
-            m_max = m_volume_grid->max();
-            m_max_per_channel.resize(m_volume_grid->channel_count());
-            m_volume_grid->max_per_channel(m_max_per_channel.data());
+            if (m_storage == Storage::Float32) {
+                m_texture = Texture3f(TensorXf(m_volume_grid->data(), 4, shape),
+                                      m_accel, m_accel, filter_mode, wrap_mode);
+                m_max = m_volume_grid->max();
+                m_max_per_channel.resize(m_volume_grid->channel_count());
+                m_volume_grid->max_per_channel(m_max_per_channel.data());
+            } else {
+                // Rounding can increase the values, bound the decoded ones
+                m_max_per_channel = quantize(m_volume_grid->data(), shape);
+                m_max = *std::max_element(m_max_per_channel.begin(),
+                                          m_max_per_channel.end());
+            }
             m_channel_count = (uint32_t) m_volume_grid->channel_count();
+            /* Chunked files provide value bounds that accelerate majorant
+               queries (they don't bound the rounded values of quantized voxels) */
+            m_brick_bounds = m_volume_grid->brick_size() > 0 &&
+                             m_storage == Storage::Float32;
         }
 
         if (props.get<bool>("use_grid_bbox", false)) {
@@ -258,15 +360,23 @@ public:
             m_fixed_max = true;
             m_max = props.get<ScalarFloat>("max_value");
         }
+
+        // The bricks of quantized voxels are created by quantize()
+        if (m_bricked && m_storage == Storage::Float32)
+            update_bricks();
+        update_memory();
     }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data", m_texture.tensor(), +ParamFlags::Differentiable);
+        // Quantized voxels cannot be edited
+        if (m_storage == Storage::Float32)
+            callback->put_parameter("data", m_texture.tensor(), +ParamFlags::Differentiable);
         Base::traverse(callback);
     }
 
     void parameters_changed(const std::vector<std::string> &keys) override {
-        if (keys.empty() || string::contains(keys, "data")) {
+        if (m_storage == Storage::Float32 &&
+            (keys.empty() || string::contains(keys, "data"))) {
             const size_t channels = nchannels();
             if (channels != 1 && channels != 3 && channels != 6)
                 Throw("parameters_changed(): The volume data %s was changed "
@@ -274,9 +384,13 @@ public:
                       "channels are supported!", to_string(), channels);
 
             m_texture.set_tensor(m_texture.tensor());
+            m_brick_bounds = false;
+            if (m_bricked)
+                update_bricks();
 
             if (!m_fixed_max)
                 m_max = (float) dr::max_nested(dr::detach(m_texture.value()));
+            update_memory();
         }
     }
 
@@ -388,8 +502,26 @@ public:
             out[i] = m_max_per_channel[i];
     }
 
+    void max_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, true);
+    }
+
+    void min_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, false);
+    }
+
+    void max_per_cell_per_channel(const ScalarVector3i &cells,
+                                  ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, true, true);
+    }
+
+    void min_per_cell_per_channel(const ScalarVector3i &cells,
+                                  ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, false, true);
+    }
+
     ScalarVector3i resolution() const override {
-        const size_t *shape = m_texture.shape();
+        const size_t *shape = this->shape();
         return { (int) shape[2], (int) shape[1], (int) shape[0] };
     };
 
@@ -400,7 +532,11 @@ public:
             << "  bbox = " << string::indent(m_bbox) << "," << std::endl
             << "  dimensions = " << resolution() << "," << std::endl
             << "  max = " << m_max << "," << std::endl
-            << "  channels = " << m_texture.shape()[3] << std::endl
+            << "  channels = " << shape()[3] << "," << std::endl
+            << "  layout = " << (m_bricked ? "bricked" : "linear") << "," << std::endl
+            << "  storage = " << (m_storage == Storage::Float32 ? "float32" :
+                                  (m_storage == Storage::Float16 ? "float16" : "uint8"))
+            << std::endl
             << "]";
         return oss.str();
     }
@@ -415,7 +551,7 @@ protected:
      * holds all scaling coefficients is omitted.
      */
     MI_INLINE size_t nchannels() const {
-        const size_t channels = m_texture.shape()[3];
+        const size_t channels = shape()[3];
         // When spectral upsampling is requested, a fourth channel is added to
         // the internal texture data to handle scaling coefficients.
         if (is_spectral_v<Spectrum> && channels == 4 && !m_raw)
@@ -424,6 +560,433 @@ protected:
         return channels;
     }
 
+    /// Shape (z, y, x, channels) of the stored voxel data
+    MI_INLINE const size_t *shape() const {
+        return m_storage == Storage::Float32 ? m_texture.shape() : m_shape;
+    }
+
+    /// Should lookups gather the voxels from \ref m_bricks or \ref m_quantized?
+    MI_INLINE bool gathered() const {
+        return m_bricked || m_storage != Storage::Float32;
+    }
+
+    /**
+     * \brief Computes the maximum (or minimum) over the voxels that influence
+     * each cell of a coarse grid, see \ref max_per_cell()
+     *
+     * When \c per_channel is set, the channels are reduced separately and
+     * \ref m_channel_count values are stored per cell.
+     */
+    void reduce_per_cell(const ScalarVector3i &cells, ScalarFloat *out,
+                         bool maximum, bool per_channel = false) const {
+        const size_t channels = shape()[3];
+        const ScalarVector3i res = resolution();
+
+        // With spectral upsampling, the last channel bounds the spectrum
+        const bool scale_only = is_spectral_v<Spectrum> && channels == 4 && !m_raw;
+        const bool clamped = m_wrap_mode == dr::WrapMode::Clamp;
+
+        /* Number of values per cell. Bounds that don't distinguish channels
+           (e.g. those of the bricks, or of upsampled spectra) are replicated */
+        const size_t out_channels = per_channel ? std::max<size_t>(m_channel_count, 1) : 1;
+        const bool separate = per_channel && !scale_only && out_channels == channels;
+        const size_t n_cells = (size_t) dr::prod(cells);
+
+        // Upsampled spectra can get arbitrarily close to zero
+        if (!maximum && scale_only) {
+            std::fill(out, out + n_cells * out_channels, 0.f);
+            return;
+        }
+
+        /* When the value bounds of the bricks of the grid are known, reduce
+           over the bricks overlapping each cell instead of visiting voxels */
+        const bool bricks = m_brick_bounds && clamped && !separate;
+
+        FloatStorage values;
+        std::vector<ScalarFloat> decoded;
+        const ScalarFloat *data;
+        if (m_storage == Storage::Float32) {
+            values = dr::migrate(m_texture.value(), AllocType::Host);
+            if constexpr (dr::is_jit_v<Float>)
+                dr::sync_thread();
+            data = values.data();
+        } else {
+            decoded = dequantize();
+            data = decoded.data();
+        }
+
+        std::vector<ScalarFloat> value(separate ? channels : 1);
+        auto reduce = [&](ScalarFloat &v, ScalarFloat x) {
+            v = maximum ? dr::maximum(v, x) : dr::minimum(v, x);
+        };
+
+        for (int cz = 0; cz < cells.z(); ++cz) {
+            for (int cy = 0; cy < cells.y(); ++cy) {
+                for (int cx = 0; cx < cells.x(); ++cx) {
+                    ScalarVector3i cell(cx, cy, cz);
+
+                    /* Voxels whose (trilinear) support overlaps the cell.
+                       Each voxel sits at the center of its footprint. */
+                    ScalarVector3f a = ScalarVector3f(cell) / ScalarVector3f(cells),
+                                   b = ScalarVector3f(cell + 1) / ScalarVector3f(cells);
+                    ScalarVector3i lo = ScalarVector3i(dr::floor(a * ScalarVector3f(res) - .5f)),
+                                   hi = ScalarVector3i(dr::floor(b * ScalarVector3f(res) - .5f)) + 1;
+
+                    std::fill(value.begin(), value.end(),
+                              maximum ? 0.f : dr::Infinity<ScalarFloat>);
+
+                    if (!clamped && (dr::any(lo < 0) || dr::any(hi >= res))) {
+                        // Lookups wrap around: fall back to the global bounds
+                        std::fill(value.begin(), value.end(), maximum ? m_max : 0.f);
+                    } else if (bricks) {
+                        const int brick_size = (int) m_volume_grid->brick_size();
+                        const ScalarVector3i count(m_volume_grid->brick_count());
+                        const auto &bounds = maximum ? m_volume_grid->brick_max()
+                                                     : m_volume_grid->brick_min();
+                        lo = dr::clamp(lo, 0, res - 1) / brick_size;
+                        hi = dr::clamp(hi, 0, res - 1) / brick_size;
+                        for (int z = lo.z(); z <= hi.z(); ++z)
+                            for (int y = lo.y(); y <= hi.y(); ++y)
+                                for (int x = lo.x(); x <= hi.x(); ++x)
+                                    reduce(value[0],
+                                           bounds[((size_t) z * count.y() + y) * count.x() + x]);
+                    } else {
+                        lo = dr::clamp(lo, 0, res - 1);
+                        hi = dr::clamp(hi, 0, res - 1);
+                        for (int z = lo.z(); z <= hi.z(); ++z)
+                            for (int y = lo.y(); y <= hi.y(); ++y)
+                                for (int x = lo.x(); x <= hi.x(); ++x) {
+                                    const ScalarFloat *voxel =
+                                        data + (((size_t) z * res.y() + y) * res.x() + x) * channels;
+                                    if (scale_only) {
+                                        reduce(value[0], voxel[3]);
+                                    } else {
+                                        for (size_t c = 0; c < channels; ++c)
+                                            reduce(value[separate ? c : 0], voxel[c]);
+                                    }
+                                }
+                    }
+
+                    for (size_t c = 0; c < out_channels; ++c)
+                        *out++ = value[separate ? c : 0];
+                }
+            }
+        }
+    }
+
+    /// Register the size of the texture data with the \ref MemoryTracker
+    void update_memory() {
+        m_memory.set_bytes((dr::width(m_texture.value()) + dr::width(m_bricks)) *
+                               sizeof(ScalarFloat) +
+                           dr::width(m_quantized) * sizeof(uint32_t),
+                           dr::is_cuda_v<Float>);
+    }
+
+    /// Rebuild the brick-ordered copy \ref m_bricks of the texture data
+    void update_bricks() {
+        size_t slots;
+        std::unique_ptr<uint32_t[]> index = brick_order(slots);
+        if (!index) {
+            m_bricks = FloatStorage();
+            return;
+        }
+
+        m_bricks = dr::gather<FloatStorage>(
+            m_texture.value(), dr::load<UInt32Storage>(index.get(), slots));
+    }
+
+    /**
+     * \brief Computes the position in the linear layout of every value of the
+     * bricked layout, and stores their number in \c slots
+     *
+     * Switches to the linear layout and returns \c nullptr when the bricks
+     * are too large to be indexed with 32-bit integers.
+     */
+    std::unique_ptr<uint32_t[]> brick_order(size_t &slots) {
+        const size_t channels = shape()[3];
+        const ScalarVector3i res = resolution();
+        m_brick_count = (res + BrickSize - 1) / BrickSize;
+
+        const size_t brick_voxels = (size_t) 1 << (3 * BrickShift);
+        slots = (size_t) dr::prod(m_brick_count) * brick_voxels * channels;
+        if (slots > (size_t) 0xFFFFFFFFu) {
+            Log(Warn, "GridVolume: the volume is too large for the bricked "
+                      "layout, using the linear layout instead.");
+            m_bricked = false;
+            return nullptr;
+        }
+
+        // Position of every value of the bricks in the linear layout
+        std::unique_ptr<uint32_t[]> index(new uint32_t[slots]);
+        uint32_t *ptr = index.get();
+        for (int bz = 0; bz < m_brick_count.z(); ++bz)
+            for (int by = 0; by < m_brick_count.y(); ++by)
+                for (int bx = 0; bx < m_brick_count.x(); ++bx)
+                    for (int lz = 0; lz < BrickSize; ++lz)
+                        for (int ly = 0; ly < BrickSize; ++ly)
+                            for (int lx = 0; lx < BrickSize; ++lx) {
+                                // Voxels of padding bricks repeat the boundary
+                                ScalarVector3i v = dr::minimum(
+                                    ScalarVector3i(bx, by, bz) * BrickSize +
+                                    ScalarVector3i(lx, ly, lz), res - 1);
+                                size_t offset =
+                                    (((size_t) v.z() * res.y() + v.y()) * res.x() + v.x()) * channels;
+                                for (size_t c = 0; c < channels; ++c)
+                                    *ptr++ = (uint32_t) (offset + c);
+                            }
+
+        return index;
+    }
+
+    /**
+     * \brief Stores the voxels \c data (given in the linear layout) in
+     * \ref m_quantized using the reduced-precision format \ref m_storage
+     *
+     * The voxels are ordered by bricks when the bricked layout is selected.
+     * Returns the largest decoded value of each channel.
+     */
+    std::vector<ScalarFloat> quantize(const ScalarFloat *data, const size_t shape[4]) {
+        std::copy(shape, shape + 4, m_shape);
+        const size_t channels = shape[3],
+                     count = shape[0] * shape[1] * shape[2] * channels;
+
+        std::vector<ScalarFloat> lo(channels, dr::Infinity<ScalarFloat>),
+                                 hi(channels, -dr::Infinity<ScalarFloat>);
+        for (size_t i = 0; i < count; i += channels) {
+            for (size_t c = 0; c < channels; ++c) {
+                lo[c] = dr::minimum(lo[c], data[i + c]);
+                hi[c] = dr::maximum(hi[c], data[i + c]);
+            }
+        }
+
+        // Map the range of every channel onto the 8-bit levels
+        m_quant_offset.assign(channels, 0.f);
+        m_quant_scale.assign(channels, 1.f);
+        if (m_storage == Storage::UInt8) {
+            for (size_t c = 0; c < channels; ++c) {
+                m_quant_offset[c] = lo[c];
+                m_quant_scale[c] = (hi[c] - lo[c]) / 255.f;
+            }
+        }
+
+        size_t slots = count;
+        std::unique_ptr<uint32_t[]> order;
+        if (m_bricked)
+            order = brick_order(slots);
+        if (!order)
+            slots = count;
+
+        const size_t per_word = m_storage == Storage::Float16 ? 2 : 4,
+                     bits = 32 / per_word,
+                     words = (slots + per_word - 1) / per_word;
+        std::unique_ptr<uint32_t[]> packed(new uint32_t[words]);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, words, 1 << 14),
+            [&](dr::blocked_range<size_t> range) {
+                for (size_t w = range.begin(); w != range.end(); ++w) {
+                    uint32_t word = 0;
+                    for (size_t k = 0; k < per_word; ++k) {
+                        size_t i = w * per_word + k;
+                        if (i >= slots)
+                            break;
+                        // Slots and voxels share the position of the channels
+                        size_t src = order ? order[i] : i;
+                        word |= encode(data[src], src % channels) << (k * bits);
+                    }
+                    packed[w] = word;
+                }
+            }
+        );
+
+        m_quantized = dr::load<UInt32Storage>(packed.get(), words);
+
+        // The encoding is monotonic, so the largest value remains the largest
+        for (size_t c = 0; c < channels; ++c)
+            hi[c] = decode(encode(hi[c], c), c);
+        return hi;
+    }
+
+    /// Decodes \ref m_quantized into the linear layout on the host
+    std::vector<ScalarFloat> dequantize() const {
+        auto&& packed = dr::migrate(m_quantized, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const uint32_t *words = packed.data();
+
+        const size_t channels = m_shape[3];
+        const ScalarVector3i res = resolution();
+        const size_t per_word = m_storage == Storage::Float16 ? 2 : 4,
+                     bits = 32 / per_word;
+        std::vector<ScalarFloat> result((size_t) dr::prod(res) * channels);
+
+        dr::parallel_for(
+            dr::blocked_range<int>(0, res.z(), 1),
+            [&](dr::blocked_range<int> range) {
+                for (int z = range.begin(); z != range.end(); ++z) {
+                    ScalarFloat *out = result.data() + (size_t) z * res.y() * res.x() * channels;
+                    for (int y = 0; y < res.y(); ++y) {
+                        for (int x = 0; x < res.x(); ++x) {
+                            size_t index = voxel_index(ScalarVector3i(x, y, z));
+                            for (size_t c = 0; c < channels; ++c) {
+                                size_t i = index + c;
+                                uint32_t value = (words[i / per_word] >> ((i % per_word) * bits)) &
+                                                 ((1u << bits) - 1u);
+                                *out++ = decode(value, c);
+                            }
+                        }
+                    }
+                }
+            }
+        );
+
+        return result;
+    }
+
+    /// Encodes a value of channel \c c using the format \ref m_storage
+    MI_INLINE uint32_t encode(ScalarFloat value, size_t c) const {
+        if (m_storage == Storage::Float16)
+            return (uint32_t) dr::half::float32_to_float16(value);
+
+        ScalarFloat scale = m_quant_scale[c],
+                    q = scale > 0.f ? (value - m_quant_offset[c]) / scale : 0.f;
+        return (uint32_t) dr::clamp(dr::round(q), 0.f, 255.f);
+    }
+
+    /// Decodes a value of channel \c c encoded by \ref encode()
+    MI_INLINE ScalarFloat decode(uint32_t value, size_t c) const {
+        if (m_storage == Storage::Float16)
+            return dr::half::float16_to_float32((uint16_t) value);
+        return dr::fmadd((ScalarFloat) value, m_quant_scale[c], m_quant_offset[c]);
+    }
+
+    /// Decodes IEEE half-precision values stored in the low 16 bits of \c value
+    static MI_INLINE Float decode_half(const UInt32 &value) {
+        // Shift exponent and mantissa, then rebias via a multiplication
+        Float result = dr::reinterpret_array<Float>((value & 0x7fffu) << 13) *
+                       Float(5.192296858534828e33f /* 2^112 */);
+        return dr::reinterpret_array<Float>(
+            dr::reinterpret_array<UInt32>(result) | ((value & 0x8000u) << 16));
+    }
+
+    /// Position of the values of voxel \c v in \ref m_bricks
+    template <typename Vector3i_>
+    MI_INLINE auto brick_index(const Vector3i_ &v) const {
+        using Int32_  = dr::value_t<Vector3i_>;
+        using UInt32_ = dr::uint32_array_t<Int32_>;
+        Vector3i_ brick = v >> BrickShift,
+                  local = v & (BrickSize - 1);
+        Int32_ b = (brick.z() * m_brick_count.y() + brick.y()) * m_brick_count.x() + brick.x(),
+               l = (((local.z() << BrickShift) | local.y()) << BrickShift) | local.x();
+        return UInt32_((b << (3 * BrickShift)) | l) * (uint32_t) shape()[3];
+    }
+
+    /**
+     * \brief Position of the values of voxel \c v in \ref m_bricks or
+     * \ref m_quantized, depending on the layout
+     */
+    template <typename Vector3i_>
+    MI_INLINE auto voxel_index(const Vector3i_ &v) const {
+        using UInt32_ = dr::uint32_array_t<dr::value_t<Vector3i_>>;
+        if (m_bricked)
+            return brick_index(v);
+        const ScalarVector3i res = resolution();
+        return UInt32_((v.z() * res.y() + v.y()) * res.x() + v.x()) *
+               (uint32_t) shape()[3];
+    }
+
+    /// Maps voxel coordinates outside of the grid according to the wrap mode
+    MI_INLINE Vector3i wrap(const Vector3i &v) const {
+        const ScalarVector3i res = resolution();
+        if (m_wrap_mode == dr::WrapMode::Repeat) {
+            Vector3i r = v % res;
+            return dr::select(r < 0, r + res, r);
+        } else if (m_wrap_mode == dr::WrapMode::Mirror) {
+            Vector3i r = v % (2 * res);
+            r = dr::select(r < 0, r + 2 * res, r);
+            return dr::select(r >= res, 2 * res - r - 1, r);
+        }
+        return dr::clamp(v, 0, res - 1);
+    }
+
+    /// Fetches the value at position \c index of channel \c c of the voxels
+    MI_INLINE Float fetch(const UInt32 &index, size_t c, Mask active) const {
+        if (m_storage == Storage::Float32)
+            return dr::gather<Float>(m_bricks, index, active);
+
+        if (m_storage == Storage::Float16) {
+            UInt32 word = dr::gather<UInt32>(m_quantized, index >> 1, active);
+            return decode_half(word >> ((index & 1u) << 4));
+        }
+
+        UInt32 word = dr::gather<UInt32>(m_quantized, index >> 2, active);
+        return dr::fmadd(Float((word >> ((index & 3u) << 3)) & 0xffu),
+                         m_quant_scale[c], m_quant_offset[c]);
+    }
+
+    /**
+     * \brief Counterpart of \c Texture3f::eval_fetch() that fetches the eight
+     * voxels of a trilinear lookup from \ref m_bricks or \ref m_quantized
+     */
+    MI_INLINE void fetch_gathered(const Point3f &p, const dr::Array<Float *, 8> &out,
+                                  Mask active) const {
+        const size_t channels = shape()[3];
+        const ScalarVector3i res = resolution();
+
+        Vector3i v0 = dr::floor2int<Vector3i>(dr::fmadd(p, ScalarVector3f(res), -.5f));
+        for (int k = 0; k < 8; ++k) {
+            Vector3i v = wrap(v0 + Vector3i(k & 1, (k >> 1) & 1, k >> 2));
+            UInt32 index = voxel_index(v);
+            for (size_t c = 0; c < channels; ++c)
+                out[k][c] = fetch(index + (uint32_t) c, c, active);
+        }
+    }
+
+    /**
+     * \brief Counterpart of \c Texture3f::eval() that looks up \ref m_bricks
+     * or \ref m_quantized
+     */
+    MI_INLINE void eval_gathered(const Point3f &p, Float *out, Mask active) const {
+        const size_t channels = shape()[3];
+        const ScalarVector3i res = resolution();
+
+        if (m_filter_mode == dr::FilterMode::Nearest) {
+            Vector3i v = wrap(dr::floor2int<Vector3i>(p * ScalarVector3f(res)));
+            UInt32 index = voxel_index(v);
+            for (size_t c = 0; c < channels; ++c)
+                out[c] = fetch(index + (uint32_t) c, c, active);
+            return;
+        }
+
+        Point3f x = dr::fmadd(p, ScalarVector3f(res), -.5f);
+        Vector3i v0 = dr::floor2int<Vector3i>(x);
+        Vector3f w1 = x - Point3f(v0),
+                 w0 = 1.f - w1;
+
+        for (size_t c = 0; c < channels; ++c)
+            out[c] = 0.f;
+
+        for (int k = 0; k < 8; ++k) {
+            Vector3i v = wrap(v0 + Vector3i(k & 1, (k >> 1) & 1, k >> 2));
+            Float w = ((k & 1) ? w1.x() : w0.x()) *
+                      ((k & 2) ? w1.y() : w0.y()) *
+                      ((k & 4) ? w1.z() : w0.z());
+            UInt32 index = voxel_index(v);
+            for (size_t c = 0; c < channels; ++c)
+                out[c] = dr::fmadd(w, fetch(index + (uint32_t) c, c, active), out[c]);
+        }
+    }
+
+    /// Evaluates the texture data at \c p using the selected layout
+    MI_INLINE void eval_texture(const Point3f &p, Float *out, Mask active) const {
+        if (gathered())
+            eval_gathered(p, out, active);
+        else if (m_accel)
+            m_texture.eval(p, out, active);
+        else
+            m_texture.eval_nonaccel(p, out, active);
+    }
+
     /**
      * \brief Evaluates the volume at the given interaction using spectral
      * upsampling
@@ -434,7 +997,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
 
-        if (m_texture.filter_mode() == dr::FilterMode::Linear) {
+        if (m_filter_mode == dr::FilterMode::Linear) {
             dr::Array<Float, 4> d000, d100, d010, d110, d001, d101, d011, d111;
             dr::Array<Float *, 8> fetch_values;
             fetch_values[0] = d000.data();
@@ -446,7 +1009,9 @@ protected:
             fetch_values[6] = d011.data();
             fetch_values[7] = d111.data();
 
-            if (m_accel)
+            if (gathered())
+                fetch_gathered(p, fetch_values, active);
+            else if (m_accel)
                 m_texture.eval_fetch(p, fetch_values, active);
             else
                 m_texture.eval_fetch_nonaccel(p, fetch_values, active);
@@ -490,10 +1055,7 @@ protected:
             return result;
         } else {
             dr::Array<Float, 4> v;
-            if (m_accel)
-                m_texture.eval(p, v.data(), active);
-            else
-                m_texture.eval_nonaccel(p, v.data(), active);
+            eval_texture(p, v.data(), active);
 
             return v.w() * srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(v), it.wavelengths);
         }
@@ -509,10 +1071,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
         Float result;
-        if (m_accel)
-            m_texture.eval(p, &result, active);
-        else
-            m_texture.eval_nonaccel(p, &result, active);
+        eval_texture(p, &result, active);
 
         return result;
     }
@@ -528,10 +1087,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
         Color3f result;
-        if (m_accel)
-            m_texture.eval(p, result.data(), active);
-        else
-            m_texture.eval_nonaccel(p, result.data(), active);
+        eval_texture(p, result.data(), active);
 
         return result;
     }
@@ -547,10 +1103,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
         dr::Array<Float, 6> result;
-        if (m_accel)
-            m_texture.eval(p, result.data(), active);
-        else
-            m_texture.eval_nonaccel(p, result.data(), active);
+        eval_texture(p, result.data(), active);
 
         return result;
     }
@@ -566,20 +1119,39 @@ protected:
         MI_MASK_ARGUMENT(active);
 
         Point3f p = m_to_local * it.p;
-        if (m_accel)
-            m_texture.eval(p, out, active);
-        else
-            m_texture.eval_nonaccel(p, out, active);
+        eval_texture(p, out, active);
     }
 
 protected:
+    /// Formats of the voxels, see the \c storage parameter
+    enum class Storage { Float32, Float16, UInt8 };
+
     Texture3f m_texture;
     bool m_accel;
     bool m_raw;
     ref<VolumeGrid> m_volume_grid;
     bool m_fixed_max = false;
+    /// Use the brick bounds of \ref m_volume_grid in \ref reduce_per_cell()
+    bool m_brick_bounds = false;
+    /// Use the bricked layout for lookups (see \ref update_bricks())
+    bool m_bricked;
+    /// Copy of the texture data, ordered by bricks of \ref BrickSize^3 voxels
+    FloatStorage m_bricks;
+    /// Number of bricks along each axis
+    ScalarVector3i m_brick_count = 0;
+    /// Format of the voxels. Unless it is \c Float32, \ref m_texture is unused
+    Storage m_storage;
+    /// Voxels in a reduced-precision format, packed into 32-bit words
+    UInt32Storage m_quantized;
+    /// Shape of the voxels in \ref m_quantized (z, y, x, channels)
+    size_t m_shape[4] = { 0, 0, 0, 0 };
+    /// Offset and scale of the 8-bit levels of each channel
+    std::vector<ScalarFloat> m_quant_offset, m_quant_scale;
+    dr::FilterMode m_filter_mode;
+    dr::WrapMode m_wrap_mode;
     ScalarFloat m_max;
     std::vector<ScalarFloat> m_max_per_channel;
+    MemoryRecord m_memory { MemoryCategory::Volume };
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(GridVolume, Volume)
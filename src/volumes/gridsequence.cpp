@@ -0,0 +1,651 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/srgb.h>
+#include <mitsuba/render/volume.h>
+#include <mitsuba/render/volumegrid.h>
+#include <drjit/dynamic.h>
+#include <drjit/texture.h>
+#include <nanothread/nanothread.h>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+.. _volume-gridsequencevolume:
+
+Grid-based volume sequence (:monosp:`gridsequencevolume`)
+---------------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename pattern of the frames, which contains a :code:`printf`-style
+     integer conversion that is replaced by the frame number, e.g.
+     :monosp:`smoke_%04d.vol`. Both versions of the :ref:`volume file format
+     <volume-gridvolume>` are supported.
+
+ * - frame_start
+   - |int|
+   - Number of the first frame of the sequence (Default: 0)
+
+ * - frame_end
+   - |int|
+   - Number of the last frame of the sequence. (Default: the last frame
+     before the first missing file)
+
+ * - frame
+   - |int|
+   - Frame that is currently loaded (Default: :monosp:`frame_start`)
+   - |exposed|
+
+ * - prefetch
+   - |int|
+   - Number of subsequent frames that are decoded on background threads while
+     the current frame is rendered. (Default: 1)
+
+ * - filter_type
+   - |string|
+   - Specifies how voxel values are interpolated, either ``trilinear``
+     (default) or ``nearest``.
+
+ * - wrap_mode
+   - |string|
+   - Controls the behavior of volume evaluations that fall outside of the
+     :math:`[0, 1]` range: ``clamp`` (default), ``repeat`` or ``mirror``.
+
+ * - raw
+   - |bool|
+   - Should the transformation to the stored color data (e.g. sRGB to linear,
+     spectral upsampling) be disabled? (Default: false)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional 4x4 transformation matrix that will be applied to
+     volume coordinates.
+
+ * - use_grid_bbox
+   - |bool|
+   - Apply the bounding box stored in the file of the first frame to the
+     volume coordinates. (Default: false)
+
+ * - accel
+   - |bool|
+   - Use hardware-accelerated texture lookups in CUDA mode. (Default: true)
+
+ * - max_value
+   - |float|
+   - Replaces the maximum of each frame by a fixed value.
+
+This plugin renders animated volumes, such as simulated smoke or explosions,
+that are stored as one :ref:`grid volume <volume-gridvolume>` file per frame.
+Switching to another frame only requires updating the :monosp:`frame`
+parameter, instead of recreating the enclosing medium:
+
+.. code-block:: python
+
+    params = mi.traverse(scene)
+    for frame in range(100):
+        params['medium.sigma_t.frame'] = frame
+        params.update()
+        img = mi.render(scene)
+
+While the current frame is rendered, the next :monosp:`prefetch` frames are
+read and decoded (including spectral upsampling) on the thread pool, so that a
+sequence that is rendered in order rarely waits for I/O. When subsequent frames
+have the same resolution, their voxels are copied into the texture of the
+previous frame, reusing its allocation on the device. The enclosing
+:ref:`heterogeneous <medium-heterogeneous>` medium recomputes its majorants
+whenever the frame changes.
+
+.. tabs::
+    .. code-tab:: xml
+
+        <medium type="heterogeneous">
+            <volume type="gridsequencevolume" name="sigma_t">
+                <string name="filename" value="smoke_%04d.vol"/>
+                <integer name="frame_start" value="1"/>
+                <integer name="frame_end" value="120"/>
+            </volume>
+        </medium>
+
+    .. code-tab:: python
+
+        'type': 'heterogeneous',
+        'sigma_t': {
+            'type': 'gridsequencevolume',
+            'filename': 'smoke_%04d.vol',
+            'frame_start': 1,
+            'frame_end': 120
+        }
+
+*/
+
+template <typename Float, typename Spectrum>
+class GridSequenceVolume final : public Volume<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Volume, update_bbox, m_to_local, m_bbox, m_channel_count)
+    MI_IMPORT_TYPES(VolumeGrid)
+
+    using FloatStorage = DynamicBuffer<Float>;
+
+    /// Voxels of a decoded frame, ready to be uploaded to the texture
+    struct Frame {
+        ref<VolumeGrid> grid;
+        /// Voxels after spectral upsampling (if applicable)
+        std::unique_ptr<ScalarFloat[]> converted;
+        /// Number of values stored per voxel (4 with spectral upsampling)
+        size_t channels = 0;
+        ScalarFloat max = 0.f;
+        std::vector<ScalarFloat> max_per_channel;
+
+        const ScalarFloat *data() const {
+            return converted ? converted.get() : grid->data();
+        }
+    };
+
+    /// A frame that is being decoded on the thread pool
+    struct PendingFrame {
+        Task *task;
+        std::shared_ptr<Frame> frame;
+    };
+
+    GridSequenceVolume(const Properties &props) : Base(props) {
+        std::string filter_type_str = props.string("filter_type", "trilinear");
+        if (filter_type_str == "nearest")
+            m_filter_mode = dr::FilterMode::Nearest;
+        else if (filter_type_str == "trilinear")
+            m_filter_mode = dr::FilterMode::Linear;
+        else
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\" or "
+                  "\"trilinear\"!", filter_type_str);
+
+        std::string wrap_mode_str = props.string("wrap_mode", "clamp");
+        if (wrap_mode_str == "repeat")
+            m_wrap_mode = dr::WrapMode::Repeat;
+        else if (wrap_mode_str == "mirror")
+            m_wrap_mode = dr::WrapMode::Mirror;
+        else if (wrap_mode_str == "clamp")
+            m_wrap_mode = dr::WrapMode::Clamp;
+        else
+            Throw("Invalid wrap mode \"%s\", must be one of: \"repeat\", "
+                  "\"mirror\", or \"clamp\"!", wrap_mode_str);
+
+        m_raw = props.get<bool>("raw", false);
+        m_accel = props.get<bool>("accel", true);
+
+        int prefetch = props.get<int>("prefetch", 1);
+        if (prefetch < 0)
+            Throw("The \"prefetch\" parameter must be non-negative!");
+        m_prefetch = (size_t) prefetch;
+
+        // Resolve the filenames of all frames upfront
+        std::string pattern = props.string("filename");
+        if (pattern.find('%') == std::string::npos)
+            Throw("The filename pattern \"%s\" must contain an integer "
+                  "conversion (e.g. \"%%04d\") for the frame number!", pattern);
+        FileResolver *fs = Thread::thread()->file_resolver();
+        m_frame_start = props.get<ScalarInt32>("frame_start", 0);
+
+        if (props.has_property("frame_end")) {
+            ScalarInt32 frame_end = props.get<ScalarInt32>("frame_end");
+            if (frame_end < m_frame_start)
+                Throw("The \"frame_end\" parameter must not be less than "
+                      "\"frame_start\"!");
+            for (ScalarInt32 frame = m_frame_start; frame <= frame_end; ++frame) {
+                fs::path path = fs->resolve(tfm::format(pattern.c_str(), frame));
+                if (!fs::exists(path))
+                    Log(Error, "\"%s\": file does not exist!", path);
+                m_paths.push_back(path);
+            }
+        } else {
+            for (ScalarInt32 frame = m_frame_start;; ++frame) {
+                fs::path path = fs->resolve(tfm::format(pattern.c_str(), frame));
+                if (!fs::exists(path))
+                    break;
+                m_paths.push_back(path);
+            }
+            if (m_paths.empty())
+                Log(Error, "\"%s\": file does not exist!",
+                    fs->resolve(tfm::format(pattern.c_str(), m_frame_start)));
+        }
+
+        if (props.has_property("max_value")) {
+            m_fixed_max = true;
+            m_max = props.get<ScalarFloat>("max_value");
+        }
+
+        m_frame = props.get<ScalarInt32>("frame", m_frame_start);
+        set_frame(m_frame);
+
+        if (props.get<bool>("use_grid_bbox", false)) {
+            m_to_local = m_current->grid->bbox_transform() * m_to_local;
+            update_bbox();
+        }
+    }
+
+    ~GridSequenceVolume() {
+        // The decoding tasks only hold on to their own frame
+        for (auto &kv : m_pending)
+            task_release(kv.second.task);
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        callback->put_parameter("frame", m_frame, +ParamFlags::NonDifferentiable);
+        Base::traverse(callback);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        if (keys.empty() || string::contains(keys, "frame")) {
+            if (m_frame != m_loaded_frame)
+                set_frame(m_frame);
+        }
+    }
+
+    UnpolarizedSpectrum eval(const Interaction3f &it,
+                             Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels == 3 && is_spectral_v<Spectrum> && m_raw)
+            Throw("The GridSequenceVolume texture %s was queried for a "
+                  "spectrum, but texture conversion into spectra was "
+                  "explicitly disabled! (raw=true)", to_string());
+        else if (channels != 3 && channels != 1)
+            Throw("The GridSequenceVolume texture %s was queried for a "
+                  "spectrum, but has a number of channels which is not 1 or 3",
+                  to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<UnpolarizedSpectrum>();
+
+        if (channels == 1)
+            return lookup<dr::Array<Float, 1>>(it, active).x();
+
+        if constexpr (is_monochromatic_v<Spectrum>)
+            return luminance(lookup<Color3f>(it, active));
+        else if constexpr (is_spectral_v<Spectrum>)
+            return interpolate_spectral(it, active);
+        else
+            return lookup<Color3f>(it, active);
+    }
+
+    Float eval_1(const Interaction3f &it, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels == 3 && is_spectral_v<Spectrum> && !m_raw)
+            Throw("eval_1(): The GridSequenceVolume texture %s was queried for "
+                  "a scalar value, but texture conversion into spectra was "
+                  "requested! (raw=false)", to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Float>();
+
+        if (channels == 1)
+            return lookup<dr::Array<Float, 1>>(it, active).x();
+        else if (channels == 3)
+            return luminance(lookup<Color3f>(it, active));
+        else // 6 channels
+            return dr::mean(lookup<dr::Array<Float, 6>>(it, active));
+    }
+
+    void eval_n(const Interaction3f &it, Float *out, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        Point3f p = m_to_local * it.p;
+        if (m_accel)
+            m_texture.eval(p, out, active);
+        else
+            m_texture.eval_nonaccel(p, out, active);
+    }
+
+    Vector3f eval_3(const Interaction3f &it,
+                    Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels != 3)
+            Throw("eval_3(): The GridSequenceVolume texture %s was queried for "
+                  "a 3D vector, but it has %s channel(s)", to_string(), channels);
+        else if (is_spectral_v<Spectrum> && !m_raw)
+            Throw("eval_3(): The GridSequenceVolume texture %s was queried for "
+                  "a 3D vector, but texture conversion into spectra was "
+                  "requested! (raw=false)", to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Vector3f>();
+
+        return lookup<Vector3f>(it, active);
+    }
+
+    dr::Array<Float, 6> eval_6(const Interaction3f &it,
+                               Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels != 6)
+            Throw("eval_6(): The GridSequenceVolume texture %s was queried for "
+                  "a 6D vector, but it has %s channel(s)", to_string(), channels);
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<dr::Array<Float, 6>>();
+
+        return lookup<dr::Array<Float, 6>>(it, active);
+    }
+
+    ScalarFloat max() const override { return m_max; }
+
+    void max_per_channel(ScalarFloat *out) const override {
+        for (size_t i = 0; i < m_max_per_channel.size(); ++i)
+            out[i] = m_max_per_channel[i];
+    }
+
+    void max_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, true);
+    }
+
+    void min_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, false);
+    }
+
+    ScalarVector3i resolution() const override {
+        const size_t *shape = m_texture.shape();
+        return { (int) shape[2], (int) shape[1], (int) shape[0] };
+    };
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "GridSequenceVolume[" << std::endl
+            << "  to_local = " << string::indent(m_to_local, 13) << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  frames = [" << m_frame_start << ", "
+            << m_frame_start + (ScalarInt32) m_paths.size() - 1 << "]," << std::endl
+            << "  frame = " << m_loaded_frame << "," << std::endl
+            << "  prefetch = " << m_prefetch << "," << std::endl
+            << "  dimensions = " << resolution() << "," << std::endl
+            << "  max = " << m_max << "," << std::endl
+            << "  channels = " << m_texture.shape()[3] << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Read a frame and apply spectral upsampling (runs on the thread pool)
+    static void decode(const fs::path &path, bool raw, Frame &frame) {
+        frame.grid = new VolumeGrid(path);
+        const VolumeGrid *grid = frame.grid.get();
+        size_t size = dr::prod(grid->size());
+        frame.channels = grid->channel_count();
+
+        if (is_spectral_v<Spectrum> && frame.channels == 3 && !raw) {
+            const ScalarFloat *ptr = grid->data();
+            frame.converted =
+                std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * 4]);
+            ScalarFloat *out = frame.converted.get();
+            ScalarFloat max = 0.f;
+            for (size_t i = 0; i < size; ++i) {
+                ScalarColor3f rgb = dr::load<ScalarColor3f>(ptr);
+                ScalarFloat scale = dr::max(rgb) * 2.f;
+                ScalarColor3f rgb_norm =
+                    rgb / dr::maximum((ScalarFloat) 1e-8, scale);
+                ScalarVector3f coeff = srgb_model_fetch(rgb_norm);
+                max = dr::maximum(max, scale);
+                dr::store(out, dr::concat(coeff, dr::Array<ScalarFloat, 1>(scale)));
+                ptr += 3;
+                out += 4;
+            }
+            frame.channels = 4;
+            frame.max = max;
+        } else {
+            frame.max = grid->max();
+            frame.max_per_channel.resize(frame.channels);
+            grid->max_per_channel(frame.max_per_channel.data());
+        }
+    }
+
+    /// Start decoding a frame on the thread pool (unless this already happened)
+    void prefetch(size_t index) {
+        if (m_pending.find(index) != m_pending.end())
+            return;
+        auto frame = std::make_shared<Frame>();
+        fs::path path = m_paths[index];
+        bool raw = m_raw;
+        Task *task = dr::do_async([frame, path, raw]() { decode(path, raw, *frame); });
+        m_pending[index] = PendingFrame{ task, frame };
+    }
+
+    /// Make \c frame the current frame and prefetch the following ones
+    void set_frame(ScalarInt32 frame) {
+        if (frame < m_frame_start ||
+            frame >= m_frame_start + (ScalarInt32) m_paths.size())
+            Throw("Frame %i is outside of the sequence [%i, %i]!", frame,
+                  m_frame_start, m_frame_start + (ScalarInt32) m_paths.size() - 1);
+        size_t index = (size_t) (frame - m_frame_start);
+        Timer timer;
+
+        std::shared_ptr<Frame> current;
+        auto it = m_pending.find(index);
+        if (it != m_pending.end()) {
+            PendingFrame pending = it->second;
+            m_pending.erase(it);
+            try {
+                task_wait(pending.task);
+            } catch (...) {
+                task_release(pending.task);
+                throw;
+            }
+            task_release(pending.task);
+            current = pending.frame;
+        } else {
+            current = std::make_shared<Frame>();
+            decode(m_paths[index], m_raw, *current);
+        }
+
+        // Discard prefetched frames that no longer follow the current one
+        for (auto it2 = m_pending.begin(); it2 != m_pending.end();) {
+            if (it2->first <= index || it2->first > index + m_prefetch) {
+                task_release(it2->second.task);
+                it2 = m_pending.erase(it2);
+            } else {
+                ++it2;
+            }
+        }
+        for (size_t i = index + 1; i <= index + m_prefetch && i < m_paths.size(); ++i)
+            prefetch(i);
+
+        upload(*current);
+        m_current = current;
+        m_frame = m_loaded_frame = frame;
+
+        Log(Debug, "Switched to frame %i of \"%s\" (took %s)", frame,
+            m_paths[index].filename(), util::time_string((float) timer.value()));
+    }
+
+    /// Copy the voxels of a frame into the texture
+    void upload(const Frame &frame) {
+        ScalarVector3u res = frame.grid->size();
+        size_t shape[4] = { (size_t) res.z(), (size_t) res.y(), (size_t) res.x(),
+                            frame.channels };
+        size_t count = dr::prod(res) * frame.channels;
+
+        bool same_shape = false;
+        if (m_current) {
+            const size_t *cur_shape = m_texture.shape();
+            same_shape = cur_shape[0] == shape[0] && cur_shape[1] == shape[1] &&
+                         cur_shape[2] == shape[2] && cur_shape[3] == shape[3];
+        }
+
+        if (same_shape) {
+            // Reuse the storage (and the CUDA texture object) of the previous frame
+            m_texture.set_value(dr::load<FloatStorage>(frame.data(), count));
+        } else {
+            m_texture = Texture3f(TensorXf(frame.data(), 4, shape), m_accel,
+                                  m_accel, m_filter_mode, m_wrap_mode);
+        }
+
+        if (!m_fixed_max)
+            m_max = frame.max;
+        m_max_per_channel = frame.max_per_channel;
+        m_channel_count = (uint32_t) frame.grid->channel_count();
+    }
+
+    /// Returns the number of channels (excluding the spectral scale)
+    MI_INLINE size_t nchannels() const {
+        const size_t channels = m_texture.shape()[3];
+        if (is_spectral_v<Spectrum> && channels == 4 && !m_raw)
+            return 3;
+        return channels;
+    }
+
+    /// Evaluates the texture with a fixed number of channels
+    template <typename Value>
+    MI_INLINE Value lookup(const Interaction3f &it, Mask active) const {
+        Point3f p = m_to_local * it.p;
+        Value result;
+        if (m_accel)
+            m_texture.eval(p, result.data(), active);
+        else
+            m_texture.eval_nonaccel(p, result.data(), active);
+        return result;
+    }
+
+    /// Evaluates the volume using spectral upsampling
+    UnpolarizedSpectrum interpolate_spectral(const Interaction3f &it,
+                                             Mask active) const {
+        Point3f p = m_to_local * it.p;
+
+        if (m_texture.filter_mode() == dr::FilterMode::Nearest) {
+            dr::Array<Float, 4> v = lookup<dr::Array<Float, 4>>(it, active);
+            return v.w() * srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(v), it.wavelengths);
+        }
+
+        dr::Array<Float, 4> d[8];
+        dr::Array<Float *, 8> fetch_values;
+        for (size_t k = 0; k < 8; ++k)
+            fetch_values[k] = d[k].data();
+
+        if (m_accel)
+            m_texture.eval_fetch(p, fetch_values, active);
+        else
+            m_texture.eval_fetch_nonaccel(p, fetch_values, active);
+
+        ScalarVector3i res = resolution();
+        p = dr::fmadd(p, res, -.5f);
+        Point3f w1 = p - Point3f(dr::floor2int<Vector3i>(p)),
+                w0 = 1.f - w1;
+
+        // Interpolate the spectra and the scale factors separately
+        UnpolarizedSpectrum v[8];
+        for (size_t k = 0; k < 8; ++k)
+            v[k] = srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(d[k]), it.wavelengths);
+
+        auto lerp3 = [&](auto f000, auto f100, auto f010, auto f110,
+                         auto f001, auto f101, auto f011, auto f111) {
+            auto f00 = dr::fmadd(w0.x(), f000, w1.x() * f100),
+                 f01 = dr::fmadd(w0.x(), f001, w1.x() * f101),
+                 f10 = dr::fmadd(w0.x(), f010, w1.x() * f110),
+                 f11 = dr::fmadd(w0.x(), f011, w1.x() * f111);
+            auto f0 = dr::fmadd(w0.y(), f00, w1.y() * f10),
+                 f1 = dr::fmadd(w0.y(), f01, w1.y() * f11);
+            return dr::fmadd(w0.z(), f0, w1.z() * f1);
+        };
+
+        Float scale = lerp3(d[0].w(), d[1].w(), d[2].w(), d[3].w(),
+                            d[4].w(), d[5].w(), d[6].w(), d[7].w());
+        return lerp3(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]) * scale;
+    }
+
+    /**
+     * \brief Computes the maximum (or minimum) over the voxels that influence
+     * each cell of a coarse grid, using the host copy of the current frame
+     */
+    void reduce_per_cell(const ScalarVector3i &cells, ScalarFloat *out,
+                         bool maximum) const {
+        const size_t channels = m_current->channels;
+        const ScalarVector3i res = resolution();
+        const ScalarFloat *data = m_current->data();
+
+        // With spectral upsampling, the last channel bounds the spectrum
+        const bool scale_only = is_spectral_v<Spectrum> && channels == 4 && !m_raw;
+        const bool clamped = m_wrap_mode == dr::WrapMode::Clamp;
+
+        // Upsampled spectra can get arbitrarily close to zero
+        if (!maximum && scale_only) {
+            std::fill(out, out + dr::prod(cells), 0.f);
+            return;
+        }
+
+        for (int cz = 0; cz < cells.z(); ++cz) {
+            for (int cy = 0; cy < cells.y(); ++cy) {
+                for (int cx = 0; cx < cells.x(); ++cx) {
+                    ScalarVector3i cell(cx, cy, cz);
+                    ScalarVector3f a = ScalarVector3f(cell) / ScalarVector3f(cells),
+                                   b = ScalarVector3f(cell + 1) / ScalarVector3f(cells);
+                    ScalarVector3i lo = ScalarVector3i(dr::floor(a * ScalarVector3f(res) - .5f)),
+                                   hi = ScalarVector3i(dr::floor(b * ScalarVector3f(res) - .5f)) + 1;
+
+                    ScalarFloat value;
+                    if (!clamped && (dr::any(lo < 0) || dr::any(hi >= res))) {
+                        // Lookups wrap around: fall back to the global bounds
+                        value = maximum ? m_max : 0.f;
+                    } else {
+                        lo = dr::clamp(lo, 0, res - 1);
+                        hi = dr::clamp(hi, 0, res - 1);
+                        value = maximum ? 0.f : dr::Infinity<ScalarFloat>;
+                        for (int z = lo.z(); z <= hi.z(); ++z)
+                            for (int y = lo.y(); y <= hi.y(); ++y)
+                                for (int x = lo.x(); x <= hi.x(); ++x) {
+                                    const ScalarFloat *voxel =
+                                        data + (((size_t) z * res.y() + y) * res.x() + x) * channels;
+                                    if (scale_only) {
+                                        value = dr::maximum(value, voxel[3]);
+                                    } else {
+                                        for (size_t c = 0; c < channels; ++c)
+                                            value = maximum ? dr::maximum(value, voxel[c])
+                                                            : dr::minimum(value, voxel[c]);
+                                    }
+                                }
+                    }
+
+                    *out++ = value;
+                }
+            }
+        }
+    }
+
+protected:
+    Texture3f m_texture;
+    dr::FilterMode m_filter_mode;
+    dr::WrapMode m_wrap_mode;
+    bool m_accel;
+    bool m_raw;
+    bool m_fixed_max = false;
+    ScalarFloat m_max;
+    std::vector<ScalarFloat> m_max_per_channel;
+
+    /// Resolved filenames of all frames
+    std::vector<fs::path> m_paths;
+    ScalarInt32 m_frame_start;
+    /// Requested frame (exposed as a parameter)
+    ScalarInt32 m_frame;
+    /// Frame whose voxels are stored in the texture
+    ScalarInt32 m_loaded_frame;
+    size_t m_prefetch;
+    /// Host copy of the current frame, used to compute majorants
+    std::shared_ptr<Frame> m_current;
+    /// Frames that are being decoded, by index in \ref m_paths
+    std::unordered_map<size_t, PendingFrame> m_pending;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(GridSequenceVolume, Volume)
+MI_EXPORT_PLUGIN(GridSequenceVolume, "GridSequenceVolume texture")
+
+NAMESPACE_END(mitsuba)
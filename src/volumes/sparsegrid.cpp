@@ -0,0 +1,773 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/srgb.h>
+#include <mitsuba/render/volume.h>
+#include <mitsuba/render/volumegrid.h>
+#include <drjit/dynamic.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+.. _volume-sparsegridvolume:
+
+Sparse grid-based volume data source (:monosp:`sparsegridvolume`)
+-----------------------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the volume to be loaded. Both sparse (:monosp:`SVL`, see
+     below) and dense (:monosp:`VOL`, see :ref:`gridvolume <volume-gridvolume>`)
+     files are supported.
+
+ * - grid
+   - :monosp:`VolumeGrid object`
+   - When creating a sparse volume at runtime, e.g. from Python or C++, an
+     existing dense ``VolumeGrid`` instance can be passed directly rather than
+     loading it from the filesystem with :paramtype:`filename`.
+
+ * - filter_type
+   - |string|
+   - Specifies how voxel values are interpolated. The following options are
+     currently available:
+
+     - ``trilinear`` (default): perform trilinear interpolation.
+
+     - ``nearest``: disable interpolation. In this mode, the plugin
+       performs nearest neighbor lookups of volume values.
+
+ * - brick_size
+   - |int|
+   - Resolution of the bricks that subdivide dense volumes. This parameter is
+     ignored for sparse files, which specify their own brick size.
+     (Default: 8)
+
+ * - raw
+   - |bool|
+   - Should the transformation to the stored color data (e.g. sRGB to linear,
+     spectral upsampling) be disabled? (Default: false)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional 4x4 transformation matrix that will be applied to volume coordinates.
+
+This plugin stores a volume as a sparse set of *bricks*, i.e. small dense
+blocks of :math:`B^3` voxels, together with a coarse index grid that maps each
+brick of the volume to its voxels. Bricks whose voxels are all zero are not
+stored at all, so that the memory usage scales with the number of active
+voxels rather than with the resolution of the volume. This is well-suited for
+simulations of smoke, clouds, or explosions, which are typically mostly empty.
+
+Lookups traverse the two levels of this hierarchy with two memory accesses:
+one into the index grid, and one into the voxels of the brick. Every stored
+brick additionally contains a copy of the first layer of voxels of its
+neighbors, so that trilinear interpolation never needs to visit more than one
+brick. The traversal is identical on the CPU and GPU. Evaluations that fall
+outside of the :math:`[0, 1]^3` range are clamped to the edge of the volume.
+
+The minimum and maximum value of each brick are tracked while loading the
+volume. The :ref:`heterogeneous <medium-heterogeneous>` medium uses them to
+compute tight majorants for delta tracking, and empty regions of the volume
+receive a majorant of zero.
+
+Dense :monosp:`VOL` files are converted while they are being read, keeping at
+most :math:`B` slices of the dense volume in memory at any point. To render
+very large volumes, it is preferable to store them in the following sparse
+file format, which uses a little endian encoding:
+
+.. list-table:: Sparse volume file format
+   :widths: 8 30
+   :header-rows: 1
+
+   * - Position
+     - Content
+   * - Bytes 1-3
+     - ASCII Bytes ’S’, ’V’, and ’L’
+   * - Byte 4
+     - File format version number (currently 1)
+   * - Bytes 5-16
+     - Number of voxels along the X, Y, and Z axes (32 bit integers)
+   * - Bytes 17-20
+     - Number of channels (32 bit integer, supported values: 1, 3 or 6)
+   * - Bytes 21-24
+     - Brick resolution :math:`B` (32 bit integer)
+   * - Bytes 25-48
+     - Axis-aligned bounding box of the data stored in single precision (order:
+       xmin, ymin, zmin, xmax, ymax, zmax)
+   * - Bytes 49-52
+     - Number of bricks :math:`n` stored in the file (32 bit integer)
+   * - Bytes 53-*
+     - :math:`n` bricks, each consisting of the brick index along the X, Y, and
+       Z axes (32 bit integers) followed by :math:`B^3` voxels in single
+       precision, ordered so that :code:`data[((z*B + y)*B + x)*channels + chan]`
+       refers to the voxel at position :code:`(bx*B + x, by*B + y, bz*B + z)`
+       of the volume. Voxels outside of the volume are ignored, and bricks that
+       are not stored in the file are treated as zero.
+
+.. tabs::
+    .. code-tab:: xml
+
+        <medium type="heterogeneous">
+            <volume type="sparsegridvolume" name="sigma_t">
+                <string name="filename" value="explosion.svl"/>
+            </volume>
+        </medium>
+
+    .. code-tab:: python
+
+        'type': 'heterogeneous',
+        'sigma_t': {
+            'type': 'sparsegridvolume',
+            'filename': 'explosion.svl'
+        }
+
+*/
+
+template <typename Float, typename Spectrum>
+class SparseGridVolume final : public Volume<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Volume, update_bbox, m_to_local, m_bbox, m_channel_count)
+    MI_IMPORT_TYPES(VolumeGrid)
+
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    SparseGridVolume(const Properties &props) : Base(props) {
+        std::string filter_type_str = props.string("filter_type", "trilinear");
+        if (filter_type_str == "nearest")
+            m_linear = false;
+        else if (filter_type_str == "trilinear")
+            m_linear = true;
+        else
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\" or "
+                  "\"trilinear\"!", filter_type_str);
+
+        m_raw = props.get<bool>("raw", false);
+        m_brick_size = props.get<uint32_t>("brick_size", 8);
+        if (m_brick_size < 2 || m_brick_size > 64)
+            Throw("The \"brick_size\" parameter must be between 2 and 64!");
+
+        Timer timer;
+        ScalarTransform4f bbox_transform;
+        CoreBricks bricks;
+
+        if (props.has_property("grid")) {
+            if (props.has_property("filename"))
+                Throw("Cannot specify both \"grid\" and \"filename\".");
+            ref<Object> other = props.object("grid");
+            VolumeGrid *volume_grid = dynamic_cast<VolumeGrid *>(other.get());
+            if (!volume_grid)
+                Throw("Property \"grid\" must be a VolumeGrid instance.");
+
+            ScalarVector3i res(volume_grid->size());
+            size_t channels = volume_grid->channel_count(),
+                   slice_size = (size_t) res.x() * res.y() * channels;
+            const ScalarFloat *data = volume_grid->data();
+            bricks = read_dense(res, (uint32_t) channels, [&](int z, float *out) {
+                const ScalarFloat *slice = data + (size_t) z * slice_size;
+                for (size_t i = 0; i < slice_size; ++i)
+                    out[i] = (float) slice[i];
+            });
+            bbox_transform = volume_grid->bbox_transform();
+        } else {
+            FileResolver *fs = Thread::thread()->file_resolver();
+            fs::path file_path = fs->resolve(props.string("filename"));
+            if (!fs::exists(file_path))
+                Log(Error, "\"%s\": file does not exist!", file_path);
+            ref<FileStream> stream = new FileStream(file_path);
+            ScalarBoundingBox3f bbox;
+            bricks = read_file(stream, bbox);
+            bbox_transform = ScalarTransform4f::scale(dr::rcp(bbox.extents())) *
+                             ScalarTransform4f::translate(-bbox.min);
+        }
+
+        build(bricks);
+
+        Log(Debug, "Loaded sparse volume: dimensions %s, %u of %u bricks "
+            "active, %s of voxel data (took %s)", m_res, m_brick_count,
+            dr::prod(m_brick_res), util::mem_string(m_data_size * sizeof(ScalarFloat)),
+            util::time_string((float) timer.value()));
+
+        if (props.get<bool>("use_grid_bbox", false)) {
+            m_to_local = bbox_transform * m_to_local;
+            update_bbox();
+        }
+
+        if (props.has_property("max_value"))
+            m_max = props.get<ScalarFloat>("max_value");
+    }
+
+    UnpolarizedSpectrum eval(const Interaction3f &it,
+                             Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels == 3 && is_spectral_v<Spectrum> && m_raw)
+            Throw("The SparseGridVolume texture %s was queried for a spectrum, "
+                  "but texture conversion into spectra was explicitly "
+                  "disabled! (raw=true)", to_string());
+        else if (channels != 3 && channels != 1)
+            Throw("The SparseGridVolume texture %s was queried for a spectrum, "
+                  "but has a number of channels which is not 1 or 3",
+                  to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<UnpolarizedSpectrum>();
+
+        Point3f p = m_to_local * it.p;
+        if (channels == 1) {
+            Float value;
+            interpolate(p, &value, active);
+            return value;
+        }
+
+        if constexpr (is_spectral_v<Spectrum>) {
+            return interpolate_spectral(p, it.wavelengths, active);
+        } else {
+            Color3f value;
+            interpolate(p, value.data(), active);
+            if constexpr (is_monochromatic_v<Spectrum>)
+                return luminance(value);
+            else
+                return value;
+        }
+    }
+
+    Float eval_1(const Interaction3f &it, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels == 3 && is_spectral_v<Spectrum> && !m_raw)
+            Throw("eval_1(): The SparseGridVolume texture %s was queried for a "
+                  "scalar value, but texture conversion into spectra was "
+                  "requested! (raw=false)", to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Float>();
+
+        Point3f p = m_to_local * it.p;
+        if (channels == 1) {
+            Float value;
+            interpolate(p, &value, active);
+            return value;
+        } else if (channels == 3) {
+            Color3f value;
+            interpolate(p, value.data(), active);
+            return luminance(value);
+        } else {
+            dr::Array<Float, 6> value;
+            interpolate(p, value.data(), active);
+            return dr::mean(value);
+        }
+    }
+
+    void eval_n(const Interaction3f &it, Float *out, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        interpolate(m_to_local * it.p, out, active);
+    }
+
+    Vector3f eval_3(const Interaction3f &it,
+                    Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels != 3)
+            Throw("eval_3(): The SparseGridVolume texture %s was queried for "
+                  "a 3D vector, but it has %s channel(s)", to_string(), channels);
+        else if (is_spectral_v<Spectrum> && !m_raw)
+            Throw("eval_3(): The SparseGridVolume texture %s was queried for "
+                  "a 3D vector, but texture conversion into spectra was "
+                  "requested! (raw=false)", to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Vector3f>();
+
+        Vector3f value;
+        interpolate(m_to_local * it.p, value.data(), active);
+        return value;
+    }
+
+    dr::Array<Float, 6> eval_6(const Interaction3f &it,
+                               Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        const size_t channels = nchannels();
+        if (channels != 6)
+            Throw("eval_6(): The SparseGridVolume texture %s was queried for "
+                  "a 6D vector, but it has %s channel(s)", to_string(), channels);
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<dr::Array<Float, 6>>();
+
+        dr::Array<Float, 6> value;
+        interpolate(m_to_local * it.p, value.data(), active);
+        return value;
+    }
+
+    ScalarFloat max() const override { return m_max; }
+
+    void max_per_channel(ScalarFloat *out) const override {
+        for (size_t i = 0; i < m_max_per_channel.size(); ++i)
+            out[i] = m_max_per_channel[i];
+    }
+
+    void max_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, true);
+    }
+
+    void min_per_cell(const ScalarVector3i &cells, ScalarFloat *out) const override {
+        reduce_per_cell(cells, out, false);
+    }
+
+    ScalarVector3i resolution() const override { return m_res; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SparseGridVolume[" << std::endl
+            << "  to_local = " << string::indent(m_to_local, 13) << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  dimensions = " << m_res << "," << std::endl
+            << "  brick_size = " << m_brick_size << "," << std::endl
+            << "  bricks = " << m_brick_count << " of " << dr::prod(m_brick_res) << "," << std::endl
+            << "  max = " << m_max << "," << std::endl
+            << "  channels = " << nchannels() << "," << std::endl
+            << "  data = [ " << util::mem_string(m_data_size * sizeof(ScalarFloat))
+            << " of voxel data ]" << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Voxels of the active bricks, before adding the neighbor voxels
+    struct CoreBricks {
+        ScalarVector3i res, brick_res;
+        uint32_t channels = 0;
+        /// Per brick of the volume: 0 if empty, else 1 + index into \c data
+        std::vector<uint32_t> index;
+        std::vector<std::unique_ptr<float[]>> data;
+        std::vector<ScalarVector3i> coords;
+    };
+
+    /// Allocate the (empty) brick table of a volume
+    CoreBricks init_bricks(const ScalarVector3i &res, uint32_t channels) const {
+        if (dr::any(res <= 0))
+            Throw("SparseGridVolume: invalid volume resolution %s!", res);
+        if (channels != 1 && channels != 3 && channels != 6)
+            Throw("SparseGridVolume: volumes with %u channels are not "
+                  "supported (must be 1, 3, or 6)!", channels);
+
+        CoreBricks result;
+        result.res = res;
+        result.channels = channels;
+        result.brick_res = (res + (int) m_brick_size - 1) / (int) m_brick_size;
+        result.index.resize((size_t) result.brick_res.x() * result.brick_res.y() *
+                            result.brick_res.z(), 0);
+        return result;
+    }
+
+    /**
+     * \brief Split a dense volume into bricks, discarding empty ones
+     *
+     * \c read_slice is called with increasing \c z and fills a slice of
+     * <tt>res.x() * res.y() * channels</tt> values.
+     */
+    template <typename ReadSlice>
+    CoreBricks read_dense(const ScalarVector3i &res, uint32_t channels,
+                          ReadSlice &&read_slice) const {
+        CoreBricks result = init_bricks(res, channels);
+        const int B = (int) m_brick_size;
+        const size_t slice_size = (size_t) res.x() * res.y() * channels,
+                     brick_voxels = (size_t) B * B * B * channels;
+        std::vector<float> slab((size_t) B * slice_size);
+
+        for (int bz = 0; bz < result.brick_res.z(); ++bz) {
+            int nz = std::min(B, res.z() - bz * B);
+            for (int z = 0; z < nz; ++z)
+                read_slice(bz * B + z, slab.data() + z * slice_size);
+
+            for (int by = 0; by < result.brick_res.y(); ++by) {
+                for (int bx = 0; bx < result.brick_res.x(); ++bx) {
+                    std::unique_ptr<float[]> brick(new float[brick_voxels]());
+                    bool active = false;
+                    for (int z = 0; z < nz; ++z) {
+                        for (int y = 0; y < B && by * B + y < res.y(); ++y) {
+                            for (int x = 0; x < B && bx * B + x < res.x(); ++x) {
+                                const float *src = slab.data() + z * slice_size +
+                                    (((size_t) by * B + y) * res.x() + bx * B + x) * channels;
+                                float *dst = brick.get() +
+                                    (((size_t) z * B + y) * B + x) * channels;
+                                for (uint32_t c = 0; c < channels; ++c) {
+                                    dst[c] = src[c];
+                                    active |= src[c] != 0.f;
+                                }
+                            }
+                        }
+                    }
+
+                    if (active)
+                        add_brick(result, ScalarVector3i(bx, by, bz), std::move(brick));
+                }
+            }
+        }
+
+        return result;
+    }
+
+    void add_brick(CoreBricks &bricks, const ScalarVector3i &coords,
+                   std::unique_ptr<float[]> &&data) const {
+        uint32_t &entry = bricks.index[
+            ((size_t) coords.z() * bricks.brick_res.y() + coords.y()) *
+                bricks.brick_res.x() + coords.x()];
+        if (entry != 0)
+            Throw("SparseGridVolume: brick %s is specified more than once!", coords);
+        bricks.data.push_back(std::move(data));
+        bricks.coords.push_back(coords);
+        entry = (uint32_t) bricks.data.size();
+    }
+
+    /// Load the bricks of a sparse (SVL) or dense (VOL) volume file
+    CoreBricks read_file(Stream *stream, ScalarBoundingBox3f &bbox) {
+        char header[3];
+        stream->read(header, 3);
+        bool sparse = header[0] == 'S' && header[1] == 'V' && header[2] == 'L',
+             dense  = header[0] == 'V' && header[1] == 'O' && header[2] == 'L';
+        if (!sparse && !dense)
+            Throw("SparseGridVolume: invalid volume file!");
+
+        uint8_t version;
+        stream->read(version);
+        if (version != (sparse ? 1 : 3))
+            Throw("SparseGridVolume: unsupported file version %d!", version);
+
+        if (dense) {
+            int32_t data_type;
+            stream->read(data_type);
+            if (data_type != 1)
+                Throw("SparseGridVolume: currently only type == 1 (Float32) "
+                      "data is supported (found type = %d)", data_type);
+        }
+
+        int32_t res[3], channels, brick_size = (int32_t) m_brick_size;
+        stream->read_array(res, 3);
+        stream->read(channels);
+        if (sparse) {
+            stream->read(brick_size);
+            if (brick_size < 2 || brick_size > 64)
+                Throw("SparseGridVolume: invalid brick size %d!", brick_size);
+            m_brick_size = (uint32_t) brick_size;
+        }
+
+        float dims[6];
+        stream->read_array(dims, 6);
+        bbox = ScalarBoundingBox3f(ScalarPoint3f(dims[0], dims[1], dims[2]),
+                                   ScalarPoint3f(dims[3], dims[4], dims[5]));
+
+        ScalarVector3i size(res[0], res[1], res[2]);
+        if (dense) {
+            size_t slice_size = (size_t) size.x() * size.y() * channels;
+            return read_dense(size, (uint32_t) channels, [&](int, float *out) {
+                stream->read_array(out, slice_size);
+            });
+        }
+
+        CoreBricks result = init_bricks(size, (uint32_t) channels);
+        uint32_t brick_count;
+        stream->read(brick_count);
+        size_t brick_voxels = (size_t) brick_size * brick_size * brick_size * channels;
+
+        for (uint32_t i = 0; i < brick_count; ++i) {
+            int32_t coords[3];
+            stream->read_array(coords, 3);
+            ScalarVector3i b(coords[0], coords[1], coords[2]);
+            if (dr::any(b < 0) || dr::any(b >= result.brick_res))
+                Throw("SparseGridVolume: brick %s is out of bounds!", b);
+            std::unique_ptr<float[]> data(new float[brick_voxels]);
+            stream->read_array(data.get(), brick_voxels);
+            add_brick(result, b, std::move(data));
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Build the index grid and the voxels of the bricks, which include
+     * the first layer of voxels of their neighbors
+     */
+    void build(const CoreBricks &bricks) {
+        const int B = (int) m_brick_size, B1 = B + 1;
+        const uint32_t channels = bricks.channels;
+        const bool spectral = is_spectral_v<Spectrum> && channels == 3 && !m_raw;
+
+        m_res = bricks.res;
+        m_brick_res = bricks.brick_res;
+        m_brick_count = (uint32_t) bricks.data.size();
+        m_channel_count = channels;
+        m_storage_channels = spectral ? 4 : channels;
+        m_brick_stride = (uint32_t) (B1 * B1 * B1) * m_storage_channels;
+
+        // Brick 0 is shared by all empty regions of the volume
+        size_t size = ((size_t) m_brick_count + 1) * m_brick_stride;
+        if (size > (size_t) std::numeric_limits<uint32_t>::max())
+            Throw("SparseGridVolume: the active voxels of the volume exceed "
+                  "the supported size (2^32 values)!");
+        m_data_size = size;
+
+        std::unique_ptr<ScalarFloat[]> data(new ScalarFloat[size]());
+        m_brick_min.assign(m_brick_count + 1, 0.f);
+        m_brick_max.assign(m_brick_count + 1, 0.f);
+        std::vector<ScalarFloat> max_per_channel(
+            (size_t) (m_brick_count + 1) * channels, -dr::Infinity<ScalarFloat>);
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, m_brick_count, 16),
+            [&](dr::blocked_range<uint32_t> range) {
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    const ScalarVector3i &b = bricks.coords[i];
+                    ScalarFloat *dst = data.get() + (size_t) (i + 1) * m_brick_stride;
+                    ScalarFloat *brick_max = max_per_channel.data() + (size_t) (i + 1) * channels;
+                    ScalarFloat vmin = dr::Infinity<ScalarFloat>,
+                                vmax = -dr::Infinity<ScalarFloat>;
+
+                    for (int z = 0; z < B1; ++z) {
+                        for (int y = 0; y < B1; ++y) {
+                            for (int x = 0; x < B1; ++x) {
+                                // Lookups are clamped to the edge of the volume
+                                ScalarVector3i g = dr::minimum(
+                                    b * B + ScalarVector3i(x, y, z), m_res - 1);
+                                ScalarVector3i gb = g / B, gl = g - gb * B;
+                                uint32_t src_id = bricks.index[
+                                    ((size_t) gb.z() * m_brick_res.y() + gb.y()) *
+                                        m_brick_res.x() + gb.x()];
+
+                                float voxel[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+                                if (src_id != 0) {
+                                    const float *src = bricks.data[src_id - 1].get() +
+                                        (((size_t) gl.z() * B + gl.y()) * B + gl.x()) * channels;
+                                    for (uint32_t c = 0; c < channels; ++c)
+                                        voxel[c] = src[c];
+                                }
+
+                                if (spectral) {
+                                    ScalarColor3f rgb(voxel[0], voxel[1], voxel[2]);
+                                    ScalarFloat scale = dr::max(rgb) * 2.f;
+                                    ScalarColor3f rgb_norm =
+                                        rgb / dr::maximum((ScalarFloat) 1e-8, scale);
+                                    ScalarVector3f coeff = srgb_model_fetch(rgb_norm);
+                                    dr::store(dst, dr::concat(
+                                        coeff, dr::Array<ScalarFloat, 1>(scale)));
+                                    vmin = dr::minimum(vmin, scale);
+                                    vmax = dr::maximum(vmax, scale);
+                                } else {
+                                    for (uint32_t c = 0; c < channels; ++c) {
+                                        dst[c] = (ScalarFloat) voxel[c];
+                                        vmin = dr::minimum(vmin, dst[c]);
+                                        vmax = dr::maximum(vmax, dst[c]);
+                                    }
+                                }
+
+                                for (uint32_t c = 0; c < channels; ++c)
+                                    brick_max[c] = dr::maximum(brick_max[c], (ScalarFloat) voxel[c]);
+
+                                dst += m_storage_channels;
+                            }
+                        }
+                    }
+
+                    m_brick_min[i + 1] = vmin;
+                    m_brick_max[i + 1] = vmax;
+                }
+            }
+        );
+
+        // Empty regions of the volume are zero-valued
+        bool has_empty = m_brick_count < bricks.index.size();
+        m_max = has_empty ? 0.f : -dr::Infinity<ScalarFloat>;
+        m_max_per_channel.assign(channels, m_max);
+        for (uint32_t i = 1; i <= m_brick_count; ++i) {
+            m_max = dr::maximum(m_max, m_brick_max[i]);
+            for (uint32_t c = 0; c < channels; ++c)
+                m_max_per_channel[c] = dr::maximum(
+                    m_max_per_channel[c], max_per_channel[(size_t) i * channels + c]);
+        }
+
+        m_index = dr::load<UInt32Storage>(bricks.index.data(), bricks.index.size());
+        m_data  = dr::load<FloatStorage>(data.get(), size);
+
+        for (int k = 0; k < 8; ++k)
+            m_corner_offset[k] =
+                ((uint32_t) (((k >> 2) & 1) * B1 + ((k >> 1) & 1)) * B1 +
+                 (uint32_t) (k & 1)) * m_storage_channels;
+    }
+
+    /// Returns the number of channels in the volume (excluding the spectral scale)
+    MI_INLINE size_t nchannels() const { return m_channel_count; }
+
+    /**
+     * \brief Traverse the index grid: returns the index of the first channel
+     * of the given voxel (which must lie within the volume)
+     */
+    MI_INLINE UInt32 voxel_index(const Vector3i &voxel, Mask active) const {
+        const int32_t B = (int32_t) m_brick_size, B1 = B + 1;
+        Vector3i brick = voxel / B,
+                 local = voxel - brick * B;
+
+        UInt32 brick_id = dr::gather<UInt32>(
+            m_index,
+            UInt32((brick.z() * m_brick_res.y() + brick.y()) * m_brick_res.x() + brick.x()),
+            active);
+
+        return brick_id * m_brick_stride +
+               UInt32((local.z() * B1 + local.y()) * B1 + local.x()) * m_storage_channels;
+    }
+
+    /**
+     * \brief Returns the index of the first corner used by trilinear
+     * interpolation at the local position \c p, along with the weights
+     */
+    MI_INLINE std::pair<UInt32, Vector3f> corners(const Point3f &p, Mask active) const {
+        ScalarVector3f res(m_res);
+        Point3f x = dr::clamp(dr::fmadd(p, res, -.5f), 0.f, res - 1.f);
+        Vector3i x_i = dr::minimum(dr::floor2int<Vector3i>(x), m_res - 1);
+        return { voxel_index(x_i, active), Vector3f(x - Point3f(x_i)) };
+    }
+
+    /// Trilinear interpolation of the values of the eight corners
+    template <typename Value>
+    MI_INLINE static Value trilerp(const Value *v, const Vector3f &w1) {
+        Vector3f w0 = 1.f - w1;
+        Value v00 = dr::fmadd(w0.x(), v[0], w1.x() * v[1]),
+              v10 = dr::fmadd(w0.x(), v[2], w1.x() * v[3]),
+              v01 = dr::fmadd(w0.x(), v[4], w1.x() * v[5]),
+              v11 = dr::fmadd(w0.x(), v[6], w1.x() * v[7]);
+        Value v0 = dr::fmadd(w0.y(), v00, w1.y() * v10),
+              v1 = dr::fmadd(w0.y(), v01, w1.y() * v11);
+        return dr::fmadd(w0.z(), v0, w1.z() * v1);
+    }
+
+    /// Evaluates all stored channels at the local position \c p
+    void interpolate(const Point3f &p, Float *out, Mask active) const {
+        if (!m_linear) {
+            Vector3i voxel = dr::clamp(
+                dr::floor2int<Vector3i>(p * ScalarVector3f(m_res)), 0, m_res - 1);
+            UInt32 index = voxel_index(voxel, active);
+            for (uint32_t c = 0; c < m_storage_channels; ++c)
+                out[c] = dr::gather<Float>(m_data, index + c, active);
+            return;
+        }
+
+        auto [index, w] = corners(p, active);
+        for (uint32_t c = 0; c < m_storage_channels; ++c) {
+            Float v[8];
+            for (int k = 0; k < 8; ++k)
+                v[k] = dr::gather<Float>(m_data, index + (m_corner_offset[k] + c), active);
+            out[c] = trilerp(v, w);
+        }
+    }
+
+    /// Evaluates the volume at the local position \c p using spectral upsampling
+    UnpolarizedSpectrum interpolate_spectral(const Point3f &p,
+                                             const Wavelength &wavelengths,
+                                             Mask active) const {
+        if (!m_linear) {
+            dr::Array<Float, 4> v;
+            interpolate(p, v.data(), active);
+            return v.w() * srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(v), wavelengths);
+        }
+
+        auto [index, w] = corners(p, active);
+        UnpolarizedSpectrum v[8];
+        Float scale[8];
+        for (int k = 0; k < 8; ++k) {
+            dr::Array<Float, 4> d;
+            for (uint32_t c = 0; c < 4; ++c)
+                d[c] = dr::gather<Float>(m_data, index + (m_corner_offset[k] + c), active);
+            v[k] = srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(d), wavelengths);
+            scale[k] = d.w();
+        }
+
+        return trilerp(v, w) * trilerp(scale, w);
+    }
+
+    /**
+     * \brief Bounds the values within each cell of a coarse grid using the
+     * per-brick bounds, see \ref max_per_cell()
+     */
+    void reduce_per_cell(const ScalarVector3i &cells, ScalarFloat *out,
+                         bool maximum) const {
+        const ScalarVector3i res = m_res;
+        const int B = (int) m_brick_size;
+        std::vector<uint32_t> index;
+        {
+            auto &&host = dr::migrate(m_index, AllocType::Host);
+            if constexpr (dr::is_jit_v<Float>)
+                dr::sync_thread();
+            index.assign(host.data(), host.data() + host.size());
+        }
+
+        for (int cz = 0; cz < cells.z(); ++cz) {
+            for (int cy = 0; cy < cells.y(); ++cy) {
+                for (int cx = 0; cx < cells.x(); ++cx) {
+                    ScalarVector3i cell(cx, cy, cz);
+
+                    // Voxels whose (trilinear) support overlaps the cell
+                    ScalarVector3f a = ScalarVector3f(cell) / ScalarVector3f(cells),
+                                   b = ScalarVector3f(cell + 1) / ScalarVector3f(cells);
+                    ScalarVector3i lo = ScalarVector3i(dr::floor(a * ScalarVector3f(res) - .5f)),
+                                   hi = ScalarVector3i(dr::floor(b * ScalarVector3f(res) - .5f)) + 1;
+                    lo = dr::clamp(lo, 0, res - 1) / B;
+                    hi = dr::clamp(hi, 0, res - 1) / B;
+
+                    ScalarFloat value = maximum ? 0.f : dr::Infinity<ScalarFloat>;
+                    for (int z = lo.z(); z <= hi.z(); ++z)
+                        for (int y = lo.y(); y <= hi.y(); ++y)
+                            for (int x = lo.x(); x <= hi.x(); ++x) {
+                                uint32_t id = index[
+                                    ((size_t) z * m_brick_res.y() + y) * m_brick_res.x() + x];
+                                value = maximum ? dr::maximum(value, m_brick_max[id])
+                                                : dr::minimum(value, m_brick_min[id]);
+                            }
+
+                    *out++ = value;
+                }
+            }
+        }
+    }
+
+protected:
+    /// Per brick of the volume: index of its voxels in \c m_data (0: empty)
+    UInt32Storage m_index;
+    /// Voxels of the active bricks, including the first layer of their neighbors
+    FloatStorage m_data;
+    ScalarVector3i m_res;
+    ScalarVector3i m_brick_res;
+    uint32_t m_brick_size;
+    uint32_t m_brick_count = 0;
+    /// Number of values stored per brick
+    uint32_t m_brick_stride = 0;
+    /// Number of values stored per voxel (4 with spectral upsampling)
+    uint32_t m_storage_channels = 0;
+    /// Offsets of the corners used by trilinear interpolation
+    uint32_t m_corner_offset[8];
+    size_t m_data_size = 0;
+    bool m_linear;
+    bool m_raw;
+    ScalarFloat m_max = 0.f;
+    std::vector<ScalarFloat> m_max_per_channel;
+    /// Bounds of the values stored in each brick (used for majorants)
+    std::vector<ScalarFloat> m_brick_min, m_brick_max;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SparseGridVolume, Volume)
+MI_EXPORT_PLUGIN(SparseGridVolume, "SparseGridVolume texture")
+
+NAMESPACE_END(mitsuba)
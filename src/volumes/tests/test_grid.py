@@ -1,6 +1,7 @@
 import pytest
 import drjit as dr
 import mitsuba as mi
+import numpy as np
 import os
 
 
@@ -114,3 +115,134 @@ def test06_eval_per_channel(variants_all_rgb, tmpdir):
     it.p = mi.Point3f(1.0)
     print(vol.eval_n(it))
     assert dr.allclose(vol.eval_n(it), [1.0, 2.0, 3.0, 4.0, 5.0, 6.0])
+
+
+def test07_chunked_majorants(variant_scalar_rgb, tmpdir, np_rng):
+    dense_file = os.path.join(str(tmpdir), "dense.vol")
+    chunked_file = os.path.join(str(tmpdir), "chunked.vol")
+    data = np_rng.random((12, 10, 14, 1))
+    data[4:] = 0.0
+    mi.VolumeGrid(data).write(dense_file)
+    mi.VolumeGrid(data).write(chunked_file, brick_size=4)
+
+    dense = mi.load_dict({'type': 'gridvolume', 'filename': dense_file})
+    chunked = mi.load_dict({'type': 'gridvolume', 'filename': chunked_file})
+
+    cells = mi.ScalarVector3i(3, 3, 3)
+    dense_max = np.array(dense.max_per_cell(cells))
+    chunked_max = np.array(chunked.max_per_cell(cells))
+    dense_min = np.array(dense.min_per_cell(cells))
+    chunked_min = np.array(chunked.min_per_cell(cells))
+
+    # The brick bounds are conservative, and remain zero in empty regions
+    assert np.all(chunked_max >= dense_max - 1e-6)
+    assert np.all(chunked_min <= dense_min + 1e-6)
+    assert np.all(chunked_max <= chunked.max() + 1e-6)
+    assert np.all(chunked_max.reshape(3, 3, 3)[2] == 0)
+
+
+def test08_majorants_per_channel(variant_scalar_rgb, np_rng):
+    data = np_rng.random((8, 6, 10, 3))
+    data[..., 1] *= 0.1
+    grid = mi.load_dict({'type': 'gridvolume', 'grid': mi.VolumeGrid(data)})
+
+    cells = mi.ScalarVector3i(3, 2, 4)
+    max_c = np.array(grid.max_per_cell_per_channel(cells)).reshape(-1, 3)
+    min_c = np.array(grid.min_per_cell_per_channel(cells)).reshape(-1, 3)
+
+    # Reducing over the channels yields the channel-uniform bounds
+    assert np.allclose(max_c.max(axis=1), grid.max_per_cell(cells))
+    assert np.allclose(min_c.min(axis=1), grid.min_per_cell(cells))
+    assert np.all(max_c[:, 1] <= 0.1 + 1e-6)
+    assert np.all(min_c <= max_c)
+
+
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+@pytest.mark.parametrize('channels', [1, 3, 6])
+def test09_bricked_layout(variants_all_rgb, np_rng, filter_type, channels):
+    # The resolution is not a multiple of the brick size
+    grid = mi.VolumeGrid(np_rng.random((13, 10, 19, channels)))
+    volumes = [mi.load_dict({
+        'type': 'gridvolume',
+        'grid': grid,
+        'filter_type': filter_type,
+        'accel': False,
+        'layout': layout
+    }) for layout in ['linear', 'bricked']]
+
+    # Includes positions outside of the volume, which are clamped
+    p = np_rng.uniform(-0.1, 1.1, size=(3, 1000))
+    it = dr.zeros(mi.Interaction3f, 1000)
+    it.p = mi.Point3f(mi.Float(p[0]), mi.Float(p[1]), mi.Float(p[2]))
+
+    linear, bricked = [vol.eval_n(it) for vol in volumes]
+    for c in range(channels):
+        assert dr.allclose(linear[c], bricked[c], atol=1e-5)
+
+
+def test10_bricked_layout_update(variants_all_rgb):
+    grid = dr.full(mi.TensorXf, 1, [9, 9, 9, 1])
+    vol = mi.load_dict({
+        'type': 'gridvolume',
+        'grid': mi.VolumeGrid(grid),
+        'layout': 'bricked'
+    })
+
+    # The bricks follow changes of the volume data
+    params = mi.traverse(vol)
+    params['data'] = dr.full(mi.TensorXf, 2, [9, 9, 9, 1])
+    params.update()
+
+    it = dr.zeros(mi.Interaction3f, 1)
+    it.p = mi.Point3f(0.95, 0.5, 0.05)
+    assert dr.allclose(vol.eval_1(it), 2.0)
+
+
+@pytest.mark.parametrize('storage', ['float16', 'uint8'])
+@pytest.mark.parametrize('layout', ['linear', 'bricked'])
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+def test11_quantized_storage(variants_all_rgb, np_rng, storage, layout, filter_type):
+    data = np_rng.random((13, 10, 19, 3))
+    data[..., 2] = data[..., 2] * 4 - 1
+    grid = mi.VolumeGrid(data)
+    volumes = [mi.load_dict({
+        'type': 'gridvolume',
+        'grid': grid,
+        'filter_type': filter_type,
+        'wrap_mode': 'repeat',
+        'accel': False,
+        'layout': layout,
+        'storage': s
+    }) for s in ['float32', storage]]
+    reference, quantized = volumes
+
+    # Includes positions outside of the volume, which are wrapped around
+    p = np_rng.uniform(-0.5, 1.5, size=(3, 1000))
+    it = dr.zeros(mi.Interaction3f, 1000)
+    it.p = mi.Point3f(mi.Float(p[0]), mi.Float(p[1]), mi.Float(p[2]))
+
+    # Error bound of the rounding of the largest values of each channel
+    tolerance = [1e-3, 1e-3, 2e-3] if storage == 'float16' else \
+                [0.5 / 255, 0.5 / 255, 2 / 255]
+    a, b = reference.eval_n(it), quantized.eval_n(it)
+    for c in range(3):
+        assert dr.allclose(a[c], b[c], rtol=0, atol=tolerance[c] * 1.01)
+
+    # The majorants bound the decoded values
+    assert quantized.max() >= data.max() - tolerance[2]
+    cells = mi.ScalarVector3i(3, 2, 4)
+    assert np.all(np.array(quantized.max_per_cell(cells)) >=
+                  np.array(reference.max_per_cell(cells)) - tolerance[2])
+
+    # Quantized voxels can't be edited
+    assert 'data' in mi.traverse(reference)
+    assert 'data' not in mi.traverse(quantized)
+
+
+def test12_quantized_storage_invalid(variant_scalar_rgb):
+    with pytest.raises(RuntimeError, match='Invalid storage format'):
+        mi.load_dict({
+            'type': 'gridvolume',
+            'grid': mi.VolumeGrid(np.ones((2, 2, 2, 1))),
+            'storage': 'int4'
+        })
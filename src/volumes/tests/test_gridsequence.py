@@ -0,0 +1,93 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+import os
+
+
+def write_frames(tmpdir, count, shape=(4, 5, 6, 1), start=0):
+    frames = []
+    for i in range(count):
+        data = np.full(shape, float(i + 1), dtype=np.float32)
+        data[0, 0, 0] = 0.0
+        mi.VolumeGrid(data).write(os.path.join(str(tmpdir), f'frame_{start + i:03d}.vol'))
+        frames.append(data)
+    return os.path.join(str(tmpdir), 'frame_%03d.vol'), frames
+
+
+def test01_frames(variants_all_rgb, tmpdir):
+    pattern, frames = write_frames(tmpdir, 4, start=2)
+    vol = mi.load_dict({
+        'type': 'gridsequencevolume',
+        'filename': pattern,
+        'frame_start': 2,
+        'prefetch': 2
+    })
+    assert vol.resolution() == mi.ScalarVector3i(6, 5, 4)
+
+    it = dr.zeros(mi.Interaction3f, 1)
+    it.p = mi.Point3f(0.5)
+    assert dr.allclose(vol.eval_1(it), 1.0)
+    assert dr.allclose(vol.max(), 1.0)
+
+    # Frames are switched by updating the exposed parameter (in or out of order)
+    params = mi.traverse(vol)
+    for frame in [3, 4, 5, 2, 5]:
+        params['frame'] = frame
+        params.update()
+        assert dr.allclose(vol.eval_1(it), frame - 1)
+        assert dr.allclose(vol.max(), frame - 1)
+
+    # The sequence ends before the first missing file
+    params['frame'] = 6
+    with pytest.raises(RuntimeError, match='outside of the sequence'):
+        params.update()
+
+
+def test02_matches_grid(variants_all_rgb, tmpdir, np_rng):
+    data = np_rng.random((6, 7, 8, 1)).astype(np.float32)
+    mi.VolumeGrid(data).write(os.path.join(str(tmpdir), 'seq_0.vol'), brick_size=4)
+    mi.VolumeGrid(data).write(os.path.join(str(tmpdir), 'single.vol'))
+
+    seq = mi.load_dict({
+        'type': 'gridsequencevolume',
+        'filename': os.path.join(str(tmpdir), 'seq_%d.vol'),
+        'frame_end': 0
+    })
+    grid = mi.load_dict({
+        'type': 'gridvolume',
+        'filename': os.path.join(str(tmpdir), 'single.vol')
+    })
+
+    it = dr.zeros(mi.Interaction3f, 100)
+    p = np_rng.random((3, 100))
+    it.p = mi.Point3f(mi.Float(p[0]), mi.Float(p[1]), mi.Float(p[2]))
+    assert dr.allclose(seq.eval_1(it), grid.eval_1(it))
+
+    cells = mi.ScalarVector3i(2, 3, 2)
+    assert dr.allclose(seq.max_per_cell(cells), grid.max_per_cell(cells))
+    assert dr.allclose(seq.min_per_cell(cells), grid.min_per_cell(cells))
+
+
+def test03_medium(variants_all_rgb, tmpdir):
+    pattern, _ = write_frames(tmpdir, 2)
+    medium = mi.load_dict({
+        'type': 'heterogeneous',
+        'sigma_t': {
+            'type': 'gridsequencevolume',
+            'filename': pattern
+        }
+    })
+
+    params = mi.traverse(medium)
+    assert 'sigma_t.frame' in params
+    params['sigma_t.frame'] = 1
+    params.update()
+    mei = dr.zeros(mi.MediumInteraction3f)
+    mei.p = mi.Point3f(0.5)
+    assert dr.allclose(medium.get_majorant(mei)[0], 2.0)
+
+
+def test04_invalid_pattern(variant_scalar_rgb, tmpdir):
+    with pytest.raises(RuntimeError, match='integer'):
+        mi.load_dict({'type': 'gridsequencevolume', 'filename': 'frame.vol'})
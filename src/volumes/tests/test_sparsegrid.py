@@ -0,0 +1,116 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+import os
+import struct
+
+
+def sparse_data(channels, seed=0):
+    # Mostly empty volume with a few dense clusters of voxels
+    rng = np.random.default_rng(seed)
+    data = np.zeros((13, 10, 19, channels), dtype=np.float32)
+    data[2:6, 1:4, 3:9] = rng.uniform(0.5, 2.0, size=(4, 3, 6, channels))
+    data[9:13, 6:10, 14:19] = rng.uniform(0.5, 2.0, size=(4, 4, 5, channels))
+    data[7, 5, 10] = 3.0
+    return data
+
+
+def random_interaction(n, seed=0):
+    rng = np.random.default_rng(seed)
+    it = dr.zeros(mi.Interaction3f, n)
+    # Includes positions outside of the volume, which are clamped
+    p = rng.uniform(-0.1, 1.1, size=(3, n))
+    it.p = mi.Point3f(mi.Float(p[0]), mi.Float(p[1]), mi.Float(p[2]))
+    return it
+
+
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+@pytest.mark.parametrize('channels', [1, 6])
+def test01_matches_dense_grid(variants_all_rgb, filter_type, channels):
+    grid = mi.VolumeGrid(mi.TensorXf(sparse_data(channels)))
+    params = {
+        'grid': grid,
+        'filter_type': filter_type
+    }
+    dense = mi.load_dict(dict(params, type='gridvolume', accel=False))
+    sparse = mi.load_dict(dict(params, type='sparsegridvolume', brick_size=4))
+
+    assert sparse.resolution() == dense.resolution()
+    assert dr.allclose(sparse.max(), dense.max())
+    assert dr.allclose(sparse.max_per_channel(), dense.max_per_channel())
+
+    it = random_interaction(1000)
+    if channels == 1:
+        assert dr.allclose(sparse.eval_1(it), dense.eval_1(it), atol=1e-5)
+    else:
+        assert dr.allclose(sparse.eval_6(it), dense.eval_6(it), atol=1e-5)
+
+
+def test02_sparse_file(variants_all_rgb, tmpdir):
+    data = sparse_data(1)
+    res_z, res_y, res_x, _ = data.shape
+    B = 4
+
+    # Write the non-empty bricks in the sparse format
+    bricks = []
+    for bz in range((res_z + B - 1) // B):
+        for by in range((res_y + B - 1) // B):
+            for bx in range((res_x + B - 1) // B):
+                brick = np.zeros((B, B, B, 1), dtype=np.float32)
+                block = data[bz*B:(bz+1)*B, by*B:(by+1)*B, bx*B:(bx+1)*B]
+                brick[:block.shape[0], :block.shape[1], :block.shape[2]] = block
+                if np.any(brick != 0):
+                    bricks.append((bx, by, bz, brick))
+
+    tmp_file = os.path.join(str(tmpdir), "out.svl")
+    with open(tmp_file, 'wb') as f:
+        f.write(b'SVL' + struct.pack('<B', 1))
+        f.write(struct.pack('<5i', res_x, res_y, res_z, 1, B))
+        f.write(struct.pack('<6f', 0, 0, 0, 1, 1, 1))
+        f.write(struct.pack('<I', len(bricks)))
+        for bx, by, bz, brick in bricks:
+            f.write(struct.pack('<3i', bx, by, bz))
+            f.write(brick.tobytes())
+
+    sparse = mi.load_dict({'type': 'sparsegridvolume', 'filename': tmp_file})
+    dense = mi.load_dict({'type': 'gridvolume', 'accel': False,
+                          'grid': mi.VolumeGrid(mi.TensorXf(data))})
+
+    it = random_interaction(1000, seed=1)
+    assert dr.allclose(sparse.eval_1(it), dense.eval_1(it), atol=1e-5)
+
+    # Dense files are converted while they are read
+    vol_file = os.path.join(str(tmpdir), "out.vol")
+    mi.VolumeGrid(mi.TensorXf(data)).write(vol_file)
+    sparse = mi.load_dict({'type': 'sparsegridvolume', 'filename': vol_file})
+    assert dr.allclose(sparse.eval_1(it), dense.eval_1(it), atol=1e-5)
+
+
+def test03_majorants(variant_scalar_rgb):
+    data = sparse_data(1)
+    sparse = mi.load_dict({
+        'type': 'sparsegridvolume',
+        'grid': mi.VolumeGrid(mi.TensorXf(data)),
+        'brick_size': 4
+    })
+
+    cells = mi.ScalarVector3i(4, 4, 4)
+    maxima = np.array(sparse.max_per_cell(cells)).reshape(4, 4, 4)
+    minima = np.array(sparse.min_per_cell(cells)).reshape(4, 4, 4)
+    assert np.all(maxima <= sparse.max() + 1e-6)
+    assert np.all(minima <= maxima)
+
+    # Empty regions of the volume have a majorant of zero
+    assert np.any(maxima == 0)
+
+    # The bounds are conservative
+    rng = np.random.default_rng(2)
+    for _ in range(500):
+        p = rng.uniform(0, 1, size=3)
+        it = dr.zeros(mi.Interaction3f)
+        it.p = mi.Point3f(p)
+        c = np.minimum((p * 4).astype(int), 3)
+        value = sparse.eval_1(it)
+        assert minima[c[2], c[1], c[0]] - 1e-5 <= value
+        assert value <= maxima[c[2], c[1], c[0]] + 1e-5